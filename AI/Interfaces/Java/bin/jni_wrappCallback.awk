@@ -89,6 +89,248 @@ function createNativeFileName(fileName_fn, isHeader_fn) {
 	return absFileName_fn;
 }
 
+# Returns the name of the primitive ARRAY parameter of a function,
+# if it gets an additional variant taking a direct java.nio buffer instead,
+# or "" otherwise.
+# Java arrays are copied by JNI in both directions on every call,
+# which for big arrays (map data, bulk unit data) costs far more than the call;
+# the buffer variant reads and writes the memory of the buffer in place.
+function getDirectArrayParam(funcIndex_da) {
+
+	directArr_da = "";
+
+	if (match(funcMetaInf[funcIndex_da], /ARRAY:[^ \t]+/)) {
+		arrName_da = substr(funcMetaInf[funcIndex_da], RSTART + 6, RLENGTH - 6);
+		size_params_da = split(funcParamListC[funcIndex_da], params_da, ",");
+		for (p_da=1; p_da <= size_params_da; p_da++) {
+			pName_da = params_da[p_da];
+			sub(/^.* /, "", pName_da);
+			if (pName_da != arrName_da) {
+				continue;
+			}
+
+			pType_da = params_da[p_da];
+			sub(/ [^ ]+$/, "", pType_da);
+			# jboolean and jchar do not match the C types in size,
+			# and there is no BooleanBuffer
+			if (match(convertCToJNIType(trim(pType_da), pName_da), /^j(byte|short|int|float)Array$/)) {
+				directArr_da = arrName_da;
+			}
+		}
+	}
+
+	return directArr_da;
+}
+
+# Awaits this format:	jfloatArray / jintArray
+# Returns this format:	java.nio.FloatBuffer / java.nio.IntBuffer
+function convertJNIArrayToJavaBufferType(jniType_jb) {
+
+	bufType_jb = jniType_jb;
+	sub(/^j/, "", bufType_jb);
+	sub(/Array$/, "", bufType_jb);
+
+	return "java.nio." capitalize(bufType_jb) "Buffer";
+}
+
+function printJNIFunction(i, directArr) {
+
+	fullName         = funcFullName[i];
+	retType          = funcRetTypeC[i];
+	paramList        = funcParamListC[i];
+	paramListNoTypes = removeParamTypes(paramList);
+	metaInf          = funcMetaInf[i];
+
+	javaName = fullName;
+	sub("^" bridgePrefix, "", javaName);
+	if (directArr != "") {
+		javaName = javaName "Direct";
+	}
+	gsub(/_/, "_1", javaName);
+	jni_funcName         = "Java_" myPkgC "_" myClass "_" javaName;
+	jni_retType          = convertCToJNIType(retType);
+	jni_paramList        = "";
+	size_params = split(paramList, params, ",");
+	for (p=1; p <= size_params; p++) {
+		pType_c   = params[p];
+		sub(/ [^ ]+$/, "", pType_c);
+		pType_c = trim(pType_c);
+
+		pName = params[p];
+		sub(/^.* /, "", pName);
+
+		pType_jni = convertCToJNIType(pType_c, pName);
+		isDirectBuffer[p] = (pName == directArr);
+		if (isDirectBuffer[p]) {
+			pType_jni = "jobject";
+		}
+
+		# these are later used for conversion
+		c_paramTypes[p] = pType_c;
+		c_paramNames[p] = pName;
+		jni_paramTypes[p] = pType_jni;
+		jni_paramNames[p] = pName;
+
+		jni_paramList = jni_paramList ", " pType_jni " " pName;
+	}
+	jni_paramListNoTypes = removeParamTypes(jni_paramList);
+	isVoidRet = match(jni_retType, /^void$/);
+
+	# print function declaration to *.h
+	#printFunctionComment_Common(outFile_nh, funcDocComment, i, "");
+	print("JNIEXPORT " jni_retType " JNICALL " jni_funcName "(JNIEnv* __env, jobject __obj" jni_paramList ");") >> outFile_nh;
+	print("") >> outFile_nh;
+
+	# print function definition to *.c
+	print("JNIEXPORT " jni_retType " JNICALL " jni_funcName "(JNIEnv* __env, jobject __obj" jni_paramList ") {") >> outFile_nc;
+	print("") >> outFile_nc;
+
+	if (!isVoidRet) {
+		print("\t" jni_retType " _ret;") >> outFile_nc;
+		print("") >> outFile_nc;
+	}
+
+	# Return value conversion - pre call
+	retType_isString = (match(retType, /^(const )?char*/) && (jni_retType == "jstring"));
+	retTypeConv = 0;
+	if (retType_isString) {
+		print("\t" retType " _retNative;") >> outFile_nc;
+		retTypeConv = 1;
+	}
+
+	hasRetParam = 0;
+	# Params conversion - pre call
+	for (p=1; p <= size_params; p++) {
+		pType_jni = jni_paramTypes[p];
+
+		if (isDirectBuffer[p]) {
+			# direct java.nio buffer, NULL if it is not direct
+			c_paramNames[p] = c_paramNames[p] "_native";
+			sub(" " jni_paramNames[p], " " c_paramNames[p], paramListNoTypes);
+
+			print("\t" c_paramTypes[p] " " c_paramNames[p] " = NULL;") >> outFile_nc;
+			print("\t" "if (" jni_paramNames[p] " != NULL) {") >> outFile_nc;
+			print("\t\t" c_paramNames[p] " = (" c_paramTypes[p] ") (*__env)->GetDirectBufferAddress(__env, " jni_paramNames[p] ");") >> outFile_nc;
+			# never let the callee write past the end of the buffer
+			sizeName = jni_paramNames[p + 1];
+			if (p < size_params && (sizeName == directArr "_sizeMax" || sizeName == directArr "_size")) {
+				print("\t\t" "if (" c_paramNames[p] " != NULL && " sizeName " > (*__env)->GetDirectBufferCapacity(__env, " jni_paramNames[p] ")) {") >> outFile_nc;
+				print("\t\t\t" sizeName " = (jint) (*__env)->GetDirectBufferCapacity(__env, " jni_paramNames[p] ");") >> outFile_nc;
+				print("\t\t" "}") >> outFile_nc;
+			}
+			print("\t" "}") >> outFile_nc;
+		} else if (pType_jni == "jstring") {
+			# jstring
+			c_paramNames[p] = c_paramNames[p] "_native";
+			sub(" " jni_paramNames[p], " " c_paramNames[p], paramListNoTypes);
+			print("\t" c_paramTypes[p] " " c_paramNames[p] " = (" c_paramTypes[p] ") (*__env)->GetStringUTFChars(__env, " jni_paramNames[p] ", NULL);") >> outFile_nc;
+		} else if (match(pType_jni, /^j.+Array$/)) {
+			# primitive arrray
+			c_paramNames[p] = c_paramNames[p] "_native";
+			sub(" " jni_paramNames[p], " " c_paramNames[p], paramListNoTypes);
+
+			capArrType = pType_jni;
+			sub(/^j/, "", capArrType);
+			sub(/Array$/, "", capArrType);
+			capArrType = capitalize(capArrType);
+
+			_isPrimitive = (capArrType != "Object");
+			_isString    = !_isPrimitive && match(c_paramTypes[p], /(const )?char\*\*/);
+
+			print("\t" c_paramTypes[p] " " c_paramNames[p] " = NULL;") >> outFile_nc;
+			print("\t" "if (" jni_paramNames[p] " != NULL) {") >> outFile_nc;
+			if (_isPrimitive) {
+				print("\t\t" c_paramNames[p] " = (" c_paramTypes[p] ") (*__env)->Get" capArrType "ArrayElements(__env, " jni_paramNames[p] ", NULL);") >> outFile_nc;
+			} else if (_isString) {
+				print("\t\t" "const int " c_paramNames[p] "_size = (int) (*__env)->GetArrayLength(__env, " jni_paramNames[p] ");") >> outFile_nc;
+				print("\t\t" c_paramNames[p] " = (" c_paramTypes[p] ") malloc(sizeof(char*) * " c_paramNames[p] "_size);") >> outFile_nc;
+			} else {
+				print("ERROR: do not know how to convert parameter type: " pType_jni);
+				exit(1);
+			}
+			print("\t" "}") >> outFile_nc;
+		} else if (pType_jni == "jobject") {
+			# StringBuffer
+			hasRetParam = 1;
+			cPaNa = c_paramNames[p];
+			c_paramNames[p] = cPaNa "_native";
+			sub(" " jni_paramNames[p], " " c_paramNames[p], paramListNoTypes);
+			print("\t" "char " c_paramNames[p] "[MAX_RESPONSE_SIZE];") >> outFile_nc;
+			retParamConversion = "\t" "jclass clazz = (*__env)->GetObjectClass(__env, " cPaNa ");" "\n";
+			retParamConversion = retParamConversion "\t" "jmethodID mid = (*__env)->GetMethodID(__env, clazz, \"append\", \"(Ljava/lang/String;)Ljava/lang/StringBuffer;\");" "\n"
+			retParamConversion = retParamConversion "\t" "jstring " cPaNa "_jStr = (*__env)->NewStringUTF(__env, " c_paramNames[p] ");" "\n";
+			retParamConversion = retParamConversion "\t" "(*__env)->CallObjectMethod(__env, " cPaNa ", mid, " cPaNa "_jStr);"
+		}
+	}
+
+	condRet = "";
+	if (!isVoidRet) {
+		if (retTypeConv) {
+			condRet = "_retNative = ";
+		} else {
+			condRet = "_ret = (" jni_retType ") ";
+		}
+	}
+	print("\t" condRet fullName "(" paramListNoTypes ");") >> outFile_nc;
+	if (hasRetParam) {
+		print(retParamConversion) >> outFile_nc;
+	}
+
+	# Params conversion - post call
+	for (p=1; p <= size_params; p++) {
+		pType_jni = jni_paramTypes[p];
+
+		if (isDirectBuffer[p]) {
+			# written in place, nothing to copy back
+		} else if (pType_jni == "jstring") {
+			# jstring
+			print("\t" "(*__env)->ReleaseStringUTFChars(__env, " jni_paramNames[p] ", " c_paramNames[p] ");") >> outFile_nc;
+		} else if (match(pType_jni, /^j.+Array$/)) {
+			# primitive arrray
+			capArrType = pType_jni;
+			sub(/^j/, "", capArrType);
+			sub(/Array$/, "", capArrType);
+			capArrType = capitalize(capArrType);
+
+			_isPrimitive = (capArrType != "Object");
+			_isString    = !_isPrimitive && match(c_paramTypes[p], /(const )?char\*\*/);
+
+			print("\t" "if (" jni_paramNames[p] " != NULL) {") >> outFile_nc;
+			if (_isPrimitive) {
+				_elementJNativeType = jni_paramTypes[p];
+				sub(/Array$/, "", _elementJNativeType); # jfloatArray -> jfloat
+				print("\t\t" "(*__env)->Release" capArrType "ArrayElements(__env, " jni_paramNames[p] ", (" _elementJNativeType "*) " c_paramNames[p] ", 0 /* copy back changes and release */);") >> outFile_nc;
+			} else if (_isString) {
+				print("\t\t" "const int " c_paramNames[p] "_size = (int) (*__env)->GetArrayLength(__env, " jni_paramNames[p] ");") >> outFile_nc;
+				print("\t\t" "int " c_paramNames[p] "_i;") >> outFile_nc;
+				print("\t\t" "jstring " c_paramNames[p] "_jStr;") >> outFile_nc;
+				print("\t\t" "for (" c_paramNames[p] "_i=0; " c_paramNames[p] "_i < " c_paramNames[p] "_size; ++" c_paramNames[p] "_i) {") >> outFile_nc;
+				print("\t\t\t" c_paramNames[p] "_jStr = (jstring) (*__env)->NewStringUTF(__env, " c_paramNames[p] "[" c_paramNames[p] "_i]);") >> outFile_nc;
+				print("\t\t\t" "(*__env)->SetObjectArrayElement(__env, " jni_paramNames[p] ", " c_paramNames[p] "_i, " c_paramNames[p] "_jStr);") >> outFile_nc;
+				print("\t\t\t" "(*__env)->DeleteLocalRef(__env, " c_paramNames[p] "_jStr);") >> outFile_nc;
+				print("\t\t" "}") >> outFile_nc;
+				print("\t\t" "free(" c_paramNames[p] ");") >> outFile_nc;
+			}
+			print("\t" "}") >> outFile_nc;
+		} else if (pType_jni == "jobject" ) {
+			# StringBuffer
+			print("\t" "(*__env)->DeleteLocalRef(__env, " cPaNa "_jStr);") >> outFile_nc;
+		}
+	}
+
+	# Return value conversion - post call
+	if (retType_isString) {
+		print("\t" "_ret = (*__env)->NewStringUTF(__env, _retNative);") >> outFile_nc;
+	}
+
+	if (!isVoidRet) {
+		print("") >> outFile_nc;
+		print("\t" "return _ret;") >> outFile_nc;
+	}
+	print("" "}") >> outFile_nc;
+	print("") >> outFile_nc;
+}
+
 function printNativeJNI() {
 
 	outFile_nh = createNativeFileName(jniBridge, 1);
@@ -117,178 +359,15 @@ function printNativeJNI() {
 
 	# print the wrapping functions
 	for (i=0; i < fi; i++) {
-		fullName         = funcFullName[i];
-		retType          = funcRetTypeC[i];
-		paramList        = funcParamListC[i];
-		paramListNoTypes = removeParamTypes(paramList);
-		metaInf          = funcMetaInf[i];
-
 		if (doWrapp(i)) {
-			javaName = fullName;
-			sub("^" bridgePrefix, "", javaName);
-			gsub(/_/, "_1", javaName);
-			jni_funcName         = "Java_" myPkgC "_" myClass "_" javaName;
-			jni_retType          = convertCToJNIType(retType);
-			jni_paramList        = "";
-			size_params = split(paramList, params, ",");
-			for (p=1; p <= size_params; p++) {
-				pType_c   = params[p];
-				sub(/ [^ ]+$/, "", pType_c);
-				pType_c = trim(pType_c);
-
-				pName = params[p];
-				sub(/^.* /, "", pName);
-
-				pType_jni = convertCToJNIType(pType_c, pName);
-
-				# these are later used for conversion
-				c_paramTypes[p] = pType_c;
-				c_paramNames[p] = pName;
-				jni_paramTypes[p] = pType_jni;
-				jni_paramNames[p] = pName;
-
-				jni_paramList = jni_paramList ", " pType_jni " " pName;
-			}
-			jni_paramListNoTypes = removeParamTypes(jni_paramList);
-			isVoidRet = match(jni_retType, /^void$/);
-
-			# print function declaration to *.h
-			#printFunctionComment_Common(outFile_nh, funcDocComment, i, "");
-			print("JNIEXPORT " jni_retType " JNICALL " jni_funcName "(JNIEnv* __env, jobject __obj" jni_paramList ");") >> outFile_nh;
-			print("") >> outFile_nh;
-
-			# print function definition to *.c
-			print("JNIEXPORT " jni_retType " JNICALL " jni_funcName "(JNIEnv* __env, jobject __obj" jni_paramList ") {") >> outFile_nc;
-			print("") >> outFile_nc;
-
-			if (!isVoidRet) {
-				print("\t" jni_retType " _ret;") >> outFile_nc;
-				print("") >> outFile_nc;
-			}
-
-			# Return value conversion - pre call
-			retType_isString = (match(retType, /^(const )?char*/) && (jni_retType == "jstring"));
-			retTypeConv = 0;
-			if (retType_isString) {
-				print("\t" retType " _retNative;") >> outFile_nc;
-				retTypeConv = 1;
-			}
-
-			hasRetParam = 0;
-			# Params conversion - pre call
-			for (p=1; p <= size_params; p++) {
-				pType_jni = jni_paramTypes[p];
-
-				if (pType_jni == "jstring") {
-					# jstring
-					c_paramNames[p] = c_paramNames[p] "_native";
-					sub(" " jni_paramNames[p], " " c_paramNames[p], paramListNoTypes);
-					print("\t" c_paramTypes[p] " " c_paramNames[p] " = (" c_paramTypes[p] ") (*__env)->GetStringUTFChars(__env, " jni_paramNames[p] ", NULL);") >> outFile_nc;
-				} else if (match(pType_jni, /^j.+Array$/)) {
-					# primitive arrray
-					c_paramNames[p] = c_paramNames[p] "_native";
-					sub(" " jni_paramNames[p], " " c_paramNames[p], paramListNoTypes);
-
-					capArrType = pType_jni;
-					sub(/^j/, "", capArrType);
-					sub(/Array$/, "", capArrType);
-					capArrType = capitalize(capArrType);
-
-					_isPrimitive = (capArrType != "Object");
-					_isString    = !_isPrimitive && match(c_paramTypes[p], /(const )?char\*\*/);
-
-					print("\t" c_paramTypes[p] " " c_paramNames[p] " = NULL;") >> outFile_nc;
-					print("\t" "if (" jni_paramNames[p] " != NULL) {") >> outFile_nc;
-					if (_isPrimitive) {
-						print("\t\t" c_paramNames[p] " = (" c_paramTypes[p] ") (*__env)->Get" capArrType "ArrayElements(__env, " jni_paramNames[p] ", NULL);") >> outFile_nc;
-					} else if (_isString) {
-						print("\t\t" "const int " c_paramNames[p] "_size = (int) (*__env)->GetArrayLength(__env, " jni_paramNames[p] ");") >> outFile_nc;
-						print("\t\t" c_paramNames[p] " = (" c_paramTypes[p] ") malloc(sizeof(char*) * " c_paramNames[p] "_size);") >> outFile_nc;
-					} else {
-						print("ERROR: do not know how to convert parameter type: " pType_jni);
-						exit(1);
-					}
-					print("\t" "}") >> outFile_nc;
-				} else if (pType_jni == "jobject") {
-					# StringBuffer
-					hasRetParam = 1;
-					cPaNa = c_paramNames[p];
-					c_paramNames[p] = cPaNa "_native";
-					sub(" " jni_paramNames[p], " " c_paramNames[p], paramListNoTypes);
-					print("\t" "char " c_paramNames[p] "[MAX_RESPONSE_SIZE];") >> outFile_nc;
-					retParamConversion = "\t" "jclass clazz = (*__env)->GetObjectClass(__env, " cPaNa ");" "\n";
-					retParamConversion = retParamConversion "\t" "jmethodID mid = (*__env)->GetMethodID(__env, clazz, \"append\", \"(Ljava/lang/String;)Ljava/lang/StringBuffer;\");" "\n"
-					retParamConversion = retParamConversion "\t" "jstring " cPaNa "_jStr = (*__env)->NewStringUTF(__env, " c_paramNames[p] ");" "\n";
-					retParamConversion = retParamConversion "\t" "(*__env)->CallObjectMethod(__env, " cPaNa ", mid, " cPaNa "_jStr);"
-				}
-			}
-
-			condRet = "";
-			if (!isVoidRet) {
-				if (retTypeConv) {
-					condRet = "_retNative = ";
-				} else {
-					condRet = "_ret = (" jni_retType ") ";
-				}
-			}
-			print("\t" condRet fullName "(" paramListNoTypes ");") >> outFile_nc;
-			if (hasRetParam) {
-				print(retParamConversion) >> outFile_nc;
-			}
-
-			# Params conversion - post call
-			for (p=1; p <= size_params; p++) {
-				pType_jni = jni_paramTypes[p];
-
-				if (pType_jni == "jstring") {
-					# jstring
-					print("\t" "(*__env)->ReleaseStringUTFChars(__env, " jni_paramNames[p] ", " c_paramNames[p] ");") >> outFile_nc;
-				} else if (match(pType_jni, /^j.+Array$/)) {
-					# primitive arrray
-					capArrType = pType_jni;
-					sub(/^j/, "", capArrType);
-					sub(/Array$/, "", capArrType);
-					capArrType = capitalize(capArrType);
-
-					_isPrimitive = (capArrType != "Object");
-					_isString    = !_isPrimitive && match(c_paramTypes[p], /(const )?char\*\*/);
-
-					print("\t" "if (" jni_paramNames[p] " != NULL) {") >> outFile_nc;
-					if (_isPrimitive) {
-						_elementJNativeType = jni_paramTypes[p];
-						sub(/Array$/, "", _elementJNativeType); # jfloatArray -> jfloat
-						print("\t\t" "(*__env)->Release" capArrType "ArrayElements(__env, " jni_paramNames[p] ", (" _elementJNativeType "*) " c_paramNames[p] ", 0 /* copy back changes and release */);") >> outFile_nc;
-					} else if (_isString) {
-						print("\t\t" "const int " c_paramNames[p] "_size = (int) (*__env)->GetArrayLength(__env, " jni_paramNames[p] ");") >> outFile_nc;
-						print("\t\t" "int " c_paramNames[p] "_i;") >> outFile_nc;
-						print("\t\t" "jstring " c_paramNames[p] "_jStr;") >> outFile_nc;
-						print("\t\t" "for (" c_paramNames[p] "_i=0; " c_paramNames[p] "_i < " c_paramNames[p] "_size; ++" c_paramNames[p] "_i) {") >> outFile_nc;
-						print("\t\t\t" c_paramNames[p] "_jStr = (jstring) (*__env)->NewStringUTF(__env, " c_paramNames[p] "[" c_paramNames[p] "_i]);") >> outFile_nc;
-						print("\t\t\t" "(*__env)->SetObjectArrayElement(__env, " jni_paramNames[p] ", " c_paramNames[p] "_i, " c_paramNames[p] "_jStr);") >> outFile_nc;
-						print("\t\t\t" "(*__env)->DeleteLocalRef(__env, " c_paramNames[p] "_jStr);") >> outFile_nc;
-						print("\t\t" "}") >> outFile_nc;
-						print("\t\t" "free(" c_paramNames[p] ");") >> outFile_nc;
-					}
-					print("\t" "}") >> outFile_nc;
-				} else if (pType_jni == "jobject" ) {
-					# StringBuffer
-					print("\t" "(*__env)->DeleteLocalRef(__env, " cPaNa "_jStr);") >> outFile_nc;
-				}
-			}
-
-			# Return value conversion - post call
-			if (retType_isString) {
-				print("\t" "_ret = (*__env)->NewStringUTF(__env, _retNative);") >> outFile_nc;
-			}
+			printJNIFunction(i, "");
 
-			if (!isVoidRet) {
-				print("") >> outFile_nc;
-				print("\t" "return _ret;") >> outFile_nc;
+			directArr = getDirectArrayParam(i);
+			if (directArr != "") {
+				printJNIFunction(i, directArr);
 			}
-			print("" "}") >> outFile_nc;
-			print("") >> outFile_nc;
 		} else {
-			print("Note: The following function is intentionally not wrapped: " fullName);
+			print("Note: The following function is intentionally not wrapped: " funcFullName[i]);
 		}
 	}
 
@@ -407,6 +486,11 @@ function printJavaClsAndInt() {
 			# print the private native function
 			print("\t" "private native " retType " " fullName "(" paramList ");") >> outFile_c;
 			print("") >> outFile_c;
+
+			directArr = getDirectArrayParam(i);
+			if (directArr != "") {
+				printJavaDirectBufferFunction(i, directArr);
+			}
 		}
 	}
 
@@ -420,6 +504,53 @@ function printJavaClsAndInt() {
 }
 
 
+# prints the variant of a function taking a direct java.nio buffer in place
+# of the array parameter <arrName>, see getDirectArrayParam()
+function printJavaDirectBufferFunction(i, arrName) {
+
+	fullNameD  = funcFullName[i];
+	sub("^" bridgePrefix, "", fullNameD);
+	directName = fullNameD "Direct";
+
+	size_params_j = split(funcParamListJ[i], params_j, ", ");
+	paramListD = "";
+	for (p=1; p <= size_params_j; p++) {
+		if (params_j[p] == "int _skirmishAIId") {
+			continue;
+		}
+		pName_j = params_j[p];
+		sub(/^.* /, "", pName_j);
+		if (pName_j == arrName) {
+			pType_j = params_j[p];
+			sub(/ [^ ]+$/, "", pType_j);
+			sub(/\[\]$/, "Array", pType_j);
+			params_j[p] = convertJNIArrayToJavaBufferType("j" pType_j) " " pName_j;
+		}
+		paramListD = paramListD ((paramListD == "") ? "" : ", ") params_j[p];
+	}
+	paramListDNoTypes = removeParamTypes(paramListD);
+	condRetD = (funcRetTypeJ[i] != "void") ? "return " : "";
+
+	docD = "\t" "/**" "\n";
+	docD = docD "\t" " * Same as " fullNameD "(), but " arrName " is read and written in place," "\n";
+	docD = docD "\t" " * without copying it through JNI; it has to be a direct buffer" "\n";
+	docD = docD "\t" " * (eg. from ByteBuffer.allocateDirect() in native order), otherwise it is" "\n";
+	docD = docD "\t" " * treated like null." "\n";
+	docD = docD "\t" " */";
+
+	print(docD) >> outFile_i;
+	print("\t" "public " funcRetTypeJ[i] " " directName "(" paramListD ");") >> outFile_i;
+	print("") >> outFile_i;
+
+	print("\t" "@Override") >> outFile_c;
+	print("\t" "public " funcRetTypeJ[i] " " directName "(" paramListD ") {") >> outFile_c;
+	print("\t\t" condRetD "this." directName "(this.skirmishAIId, " paramListDNoTypes ");") >> outFile_c;
+	print("\t" "}") >> outFile_c;
+	print("\t" "private native " funcRetTypeJ[i] " " directName "(int _skirmishAIId, " paramListD ");") >> outFile_c;
+	print("") >> outFile_c;
+}
+
+
 function wrappFunction(funcDef, commentEol) {
 
 	doParse = 1;
@@ -38,6 +38,9 @@ local SAFEWRAP = 1
 -- 2: always enabled
 
 local SAFEDRAW = false  -- requires SAFEWRAP to work
+
+-- charge the call-ins of each widget to it, see Spring.GetAddonProfile
+local PROFILE_WIDGETS = (Spring.GetConfigInt('LuaProfileWidgets', 0) ~= 0)
 local glPopAttrib  = gl.PopAttrib
 local glPushAttrib = gl.PushAttrib
 local section = 'widgets.lua'
@@ -723,6 +726,34 @@ local function SafeWrapWidget(widget)
 end
 
 
+local SpringBeginAddonProfile = Spring.BeginAddonProfile
+local SpringEndAddonProfile   = Spring.EndAddonProfile
+
+local function EndAddonProfile(...)
+  SpringEndAddonProfile()
+  return ...
+end
+
+-- wraps outside of SafeWrapWidget, so errors caught there still end the scope
+local function ProfileWrapWidget(widget)
+  if (not PROFILE_WIDGETS) then
+    return
+  end
+
+  local name = widget.whInfo.name
+
+  for _,ciName in ipairs(callInLists) do
+    local func = widget[ciName]
+    if (func) then
+      widget[ciName] = function(w, ...)
+        SpringBeginAddonProfile(name)
+        return EndAddonProfile(func(w, ...))
+      end
+    end
+  end
+end
+
+
 --------------------------------------------------------------------------------
 
 local function ArrayInsert(t, f, w)
@@ -758,6 +789,7 @@ function widgetHandler:InsertWidget(widget)
   end
 
   SafeWrapWidget(widget)
+  ProfileWrapWidget(widget)
 
   ArrayInsert(self.widgets, true, widget)
   for _,listname in ipairs(callInLists) do
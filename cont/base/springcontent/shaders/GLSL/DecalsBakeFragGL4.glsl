@@ -0,0 +1,43 @@
+#version 420 compatibility
+
+// resolves one scar like the loop in DecalsFragGL4 (minus parallax), the blend
+// state of CDecalsDrawerGL4::BakeDirtyTiles accumulates albedo, transmittance
+// and normal the same way the live shader does
+
+layout(binding=0) uniform sampler2D decalAtlasTex;
+layout(binding=1) uniform sampler2D heightMapTex; // corner heightmap
+
+uniform vec4 decalPosAlpha;
+uniform vec4 decalRotInvSize;
+uniform vec4 texCoords;
+uniform vec4 texNormalsCoords;
+
+uniform vec2 invHeightMapSize;
+uniform float heightFade;
+
+in vec2 worldPosXZ;
+in vec2 decalTexCoord;
+
+
+void main() {
+	mat2 rotMatrix = mat2(decalRotInvSize.x, -decalRotInvSize.y, decalRotInvSize.y, decalRotInvSize.x);
+	vec2 ntx = clamp(decalTexCoord, vec2(0.0), vec2(1.0));
+
+	// TEXTURING
+	vec4 albedoD = texture2D(decalAtlasTex, mix(texCoords.st, texCoords.pq, ntx));
+
+	// make transparent when terrain is higher or lower than the decal's pos
+	float groundHeight = texture2D(heightMapTex, (worldPosXZ / float(SQUARE_SIZE) + vec2(0.5)) * invHeightMapSize).x;
+	float relHeight = mix(decalPosAlpha.y, groundHeight, heightFade) - decalPosAlpha.y;
+
+	albedoD.a *= clamp(1.0 - abs(relHeight) * decalRotInvSize.z, 0.0, 1.0);
+	albedoD.a *= decalPosAlpha.w;
+
+	// NORMAL MAPPING
+	vec3 normalD = texture2D(decalAtlasTex, mix(texNormalsCoords.st, texNormalsCoords.pq, ntx)).rbg;
+	normalD = (normalD * 2.0) - 1.0;
+	normalD.xz = rotMatrix * normalD.xz;
+
+	gl_FragData[0] = albedoD;
+	gl_FragData[1] = vec4(normalD * 0.5 + 0.5, albedoD.a);
+}
@@ -0,0 +1,25 @@
+#version 420 compatibility
+
+// rasterises one explosion scar into a ground tile, see CDecalsDrawerGL4::BakeDirtyTiles
+
+uniform vec4 decalPosAlpha;
+uniform vec4 decalRotInvSize; // cos(rot), sin(rot), 1 / size.x, 1 / size.y
+uniform vec3 tileRect; // x1, z1, 1 / BAKED_TILE_SIZE
+
+out vec2 worldPosXZ;
+out vec2 decalTexCoord;
+
+
+void main() {
+	// inverse of the world- to decal-space transform in DecalsFragGL4
+	vec2 localPos = gl_Vertex.xy / decalRotInvSize.zw;
+	vec2 rotPos = vec2(
+		decalRotInvSize.x * localPos.x - decalRotInvSize.y * localPos.y,
+		decalRotInvSize.y * localPos.x + decalRotInvSize.x * localPos.y
+	);
+
+	worldPosXZ = decalPosAlpha.xz + rotPos;
+	decalTexCoord = gl_MultiTexCoord0.st;
+
+	gl_Position = vec4((worldPosXZ - tileRect.xy) * tileRect.z * 2.0 - 1.0, 0.0, 1.0);
+}
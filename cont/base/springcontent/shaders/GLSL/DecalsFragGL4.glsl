@@ -11,7 +11,9 @@
 //#define USE_PARALLAX
 //#define USE_SSBO
 //#define DEBUG
+//#define BAKED_DECALS
 
+#ifndef BAKED_DECALS
 struct SDecal {
 	vec3 pos;
 	float alpha;
@@ -46,6 +48,11 @@ layout(std140) uniform decalsUBO
 SDecal GetDecalInfo(int id) {
 	return decals[id];
 }
+#else
+// explosion scars pre-blended into ground tiles, see CDecalsDrawerGL4::BakeDirtyTiles
+layout(binding=5) uniform sampler2DArray bakedAlbedoTex;
+layout(binding=6) uniform sampler2DArray bakedNormalsTex;
+#endif
 
 layout(binding=0) uniform sampler2D decalAtlasTex;
 layout(binding=1) uniform sampler2D groundNormalsTex;
@@ -77,7 +84,11 @@ uniform float shadowDensity;
 layout(binding=2) uniform sampler2DShadow shadowTex;
 #endif
 
+#ifdef BAKED_DECALS
+flat in vec3 bakedTileInfo;
+#else
 flat in int decalGroupId;
+#endif
 
 
 vec3 ReconstructWorldPos() {
@@ -125,6 +136,7 @@ float GetShadowOcclusion(vec3 worldPos) {
 }
 
 
+#ifndef BAKED_DECALS
 float ParallaxMapping(inout vec2 ntx, const SDecal d, const mat2 rotMatrix, const vec3 eyeDir)
 {
 #ifdef USE_PARALLAX
@@ -201,6 +213,7 @@ float ParallaxMapping(inout vec2 ntx, const SDecal d, const mat2 rotMatrix, cons
 	return 1.0;
 #endif
 }
+#endif
 
 
 #ifdef DEBUG
@@ -219,7 +232,6 @@ const vec4 colors[8] = {
 
 void main() {
 	gl_FragColor = vec4(0.0);
-	SDecalGroup g = groups[decalGroupId];
 
 	// PROJECTION
 	vec3 worldPos = ReconstructWorldPos();
@@ -235,6 +247,18 @@ void main() {
 
 	vec4 albedo = vec4(vec3(0.0), 1.0);
 	vec3 normal = vec3(0., 1., 0.);
+
+#ifdef BAKED_DECALS
+	vec2 tileUV = (worldPos.xz - bakedTileInfo.xy) * (1.0 / float(BAKED_TILE_SIZE));
+
+	// the tile box also covers fragments of its neighbours
+	if (all(equal(tileUV, clamp(tileUV, vec2(0.0), vec2(1.0))))) {
+		albedo = texture(bakedAlbedoTex, vec3(tileUV, bakedTileInfo.z));
+		normal = texture(bakedNormalsTex, vec3(tileUV, bakedTileInfo.z)).rgb * 2.0 - 1.0;
+	}
+#else
+	SDecalGroup g = groups[decalGroupId];
+
 	for (int i = 0; i<MAX_DECALS_PER_GROUP; ++i) {
 		SDecal d = GetDecalInfo(g.ids[i]);
 		mat2 rotMatrix = mat2(d.rotMatrixElements.x, -d.rotMatrixElements.y, d.rotMatrixElements.y, d.rotMatrixElements.x);
@@ -273,6 +297,7 @@ void main() {
 		normalD.xz = rotMatrix * normalD.xz;
 		normal = mix(normal, normalD, albedoD.a);
 	}
+#endif
 
 	//if (albedo.a == 0.0) {
 	//	discard;
@@ -4,6 +4,14 @@
 //#define MAX_DECALS_PER_GROUP 48
 //#define MAX_DECALS_GROUPS 300
 
+#ifdef BAKED_DECALS
+// xz := tile mins, z := array layer, see CDecalsDrawerGL4::DrawBakedTiles
+layout(location = 1) in vec4 bakedTile;
+
+uniform vec2 tileHeights;
+
+flat out vec3 bakedTileInfo;
+#else
 struct SDecalGroup {
 	vec4 boundAABB[2];
 	int ids[MAX_DECALS_PER_GROUP];
@@ -15,16 +23,24 @@ layout(packed) uniform decalGroupsUBO
 	SDecalGroup groups[MAX_DECALS_GROUPS];
 };
 
+flat out int decalGroupId;
+#endif
+
 
 uniform vec3 camPos;
 uniform mat4 viewProjMatrix;
 
-flat out int decalGroupId;
-
 
 void main() {
+#ifdef BAKED_DECALS
+	bakedTileInfo = bakedTile.xyz;
+	vec3 mins = vec3(bakedTile.x, tileHeights.x, bakedTile.y);
+	vec3 maxs = vec3(bakedTile.x + float(BAKED_TILE_SIZE), tileHeights.y, bakedTile.y + float(BAKED_TILE_SIZE));
+	vec3 v = mix(mins, maxs, step(vec3(0.0), gl_Vertex.xyz));
+#else
 	decalGroupId = gl_InstanceID;
 	SDecalGroup g = groups[gl_InstanceID];
 	vec3 v = mix(g.boundAABB[0].xyz, g.boundAABB[1].xyz, step(vec3(0.0), gl_Vertex.xyz) );
+#endif
 	gl_Position = viewProjMatrix * vec4(v, 1.0);
 }
@@ -0,0 +1,14 @@
+#version 430 compatibility
+
+uniform sampler2D atlasTex;
+
+in vec4 vertColor;
+in vec2 vertTexCoord;
+
+void main() {
+	gl_FragColor = texture(atlasTex, vertTexCoord) * vertColor;
+
+	// fxVA is drawn with alpha-testing against zero
+	if (gl_FragColor.a <= 0.0)
+		discard;
+}
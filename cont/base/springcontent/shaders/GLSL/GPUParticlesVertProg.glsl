@@ -0,0 +1,126 @@
+#version 430 compatibility
+
+// evaluates CSimpleParticleSystem particles in closed form at their age,
+// see GPUParticleSystems; per-instance attributes hold the initial state
+layout(location = 0) in vec4 posDecay;
+layout(location = 1) in vec4 speedSize;
+layout(location = 2) in vec2 rotation;
+layout(location = 3) in uint emitterIdx;
+
+struct Emitter {
+	vec4 gravityAirdrag;
+	vec4 growthParams; // sizeMod, sizeGrowth, rotation acceleration
+	vec4 texCoords;
+	uvec4 info; // createFrame, numColors, directional
+	uint colors[MAX_COLORS];
+};
+
+layout(std430, binding = EMITTERS_SSBO_BINDING_IDX) readonly buffer EmittersBuffer {
+	Emitter emitters[];
+};
+
+uniform int gameFrame;
+uniform float frameTimeOffset;
+
+uniform vec3 cameraPos;
+uniform vec3 cameraRight;
+uniform vec3 cameraUp;
+uniform vec3 cameraFwd;
+
+out vec4 vertColor;
+out vec2 vertTexCoord;
+
+// quad corner signs in triangle-strip order
+const vec2 CORNERS[4] = vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));
+
+float IntPow(float x, uint n) {
+	float r = 1.0;
+
+	for (; n > 0u; n >>= 1u) {
+		if ((n & 1u) != 0u)
+			r *= x;
+		x *= x;
+	}
+
+	return r;
+}
+
+// sum of x^k for k in [0, n)
+float GeomSum(float x, float xn, float n) {
+	if (abs(1.0 - x) < 1e-5)
+		return n;
+
+	return ((1.0 - xn) / (1.0 - x));
+}
+
+vec3 Rotate(vec3 v, float angle, vec3 axis) {
+	const float ca = cos(angle);
+	const float sa = sin(angle);
+	return (v * ca + cross(axis, v) * sa + axis * dot(axis, v) * (1.0 - ca));
+}
+
+void main() {
+	const Emitter emitter = emitters[emitterIdx];
+
+	const uint age = uint(max(gameFrame - int(emitter.info.x), 0));
+	const float n = float(age);
+	const float life = n * posDecay.w;
+
+	if (life >= 1.0) {
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+
+	const vec3 gravity = emitter.gravityAirdrag.xyz;
+	const float airdrag = emitter.gravityAirdrag.w;
+
+	// speed += gravity; speed *= airdrag; every frame
+	const float dragN = IntPow(airdrag, age);
+	const float dragSum = GeomSum(airdrag, dragN, n);
+
+	vec3 gravDisp = gravity * (n * (n - 1.0) * 0.5);
+
+	if (abs(1.0 - airdrag) >= 1e-5)
+		gravDisp = gravity * (airdrag * (n - dragSum) / (1.0 - airdrag));
+
+	const vec3 speed = speedSize.xyz * dragN + gravity * (airdrag * dragSum);
+	const vec3 pos = posDecay.xyz + speedSize.xyz * dragSum + gravDisp;
+
+	// size = size * sizeMod + sizeGrowth; every frame
+	const float sizeModN = IntPow(emitter.growthParams.x, age);
+	const float size = speedSize.w * sizeModN + emitter.growthParams.y * GeomSum(emitter.growthParams.x, sizeModN, n);
+	const float rotVal = rotation.x + rotation.y * n + emitter.growthParams.z * (n * (n - 1.0) * 0.5);
+
+	vec3 right = cameraRight;
+	vec3 up = cameraUp;
+	vec3 fwd = cameraFwd;
+
+	if (emitter.info.z != 0u) {
+		const vec3 zdir = normalize(pos - cameraPos);
+		const vec3 ydir = cross(zdir, speed);
+
+		if (dot(ydir, ydir) > 0.001) {
+			up = normalize(ydir);
+			right = cross(up, zdir);
+			fwd = zdir;
+		}
+	}
+
+	const vec2 corner = CORNERS[gl_VertexID & 3];
+
+	vec3 offset = (right * corner.x + up * corner.y) * size;
+
+	if (abs(rotVal) > 0.01)
+		offset = Rotate(offset, rotVal, fwd);
+
+	const vec3 interPos = pos + speed * frameTimeOffset;
+
+	// same interpolation as CColorMap::GetColor
+	const float colorPos = life * float(emitter.info.y - 1u);
+	const uint colorIdx = uint(colorPos);
+
+	vertColor = mix(unpackUnorm4x8(emitter.colors[colorIdx]), unpackUnorm4x8(emitter.colors[colorIdx + 1u]), fract(colorPos));
+	vertTexCoord = mix(emitter.texCoords.xy, emitter.texCoords.zw, corner * 0.5 + 0.5);
+
+	gl_Position = gl_ModelViewProjectionMatrix * vec4(interPos + offset, 1.0);
+}
@@ -0,0 +1,159 @@
+#version 430 core
+
+// places the grass turfs of every visible grass square around the camera and
+// appends them as near meshes or far billboards, see CGrassDrawer::UpdateGPUTurfs
+
+layout(local_size_x = TURFS_WORKGROUP_SIZE, local_size_y = TURFS_WORKGROUP_SIZE, local_size_z = 1) in;
+
+struct DrawCommand {
+	uint count;
+	uint instanceCount;
+	uint first;
+	uint baseInstance;
+};
+
+// one byte per grass square
+layout(std430, binding = GRASS_MAP_SSBO_BINDING_IDX) readonly buffer GrassMapBuffer {
+	uint grassMap[];
+};
+
+// [0, turfCapacity) := meshes {pos, rotation}, [turfCapacity, 2 * turfCapacity) := billboards {pos, alpha}
+layout(std430, binding = TURFS_SSBO_BINDING_IDX) writeonly buffer TurfsBuffer {
+	vec4 turfs[];
+};
+
+// 0 := meshes, 1 := billboards
+layout(std430, binding = DRAW_CMDS_SSBO_BINDING_IDX) buffer DrawCommandsBuffer {
+	DrawCommand drawCmds[2];
+};
+
+uniform sampler2D heightMapTex; // corner heightmap
+
+uniform ivec4 squareWindow; // x1, z1, sizeX, sizeZ
+uniform ivec2 grassMapSize;
+uniform int numTurfs;
+uniform int turfCapacity;
+
+uniform vec3 cameraPos;
+uniform mat4 cameraViewProj;
+uniform vec4 grassParams; // maxGrassDist, maxDetailedDist, bladeHeight
+uniform float turfSize;
+
+const float PI = 3.14159265358979323846264;
+
+
+float GetHeight(vec2 pos) {
+	const ivec2 texSize = textureSize(heightMapTex, 0);
+	const vec2 texPos = clamp(pos / float(SQUARE_SIZE), vec2(0.0), vec2(texSize - 1));
+
+	const ivec2 p0 = ivec2(texPos);
+	const ivec2 p1 = min(p0 + 1, texSize - 1);
+	const vec2 f = texPos - vec2(p0);
+
+	const float h00 = texelFetch(heightMapTex, ivec2(p0.x, p0.y), 0).x;
+	const float h10 = texelFetch(heightMapTex, ivec2(p1.x, p0.y), 0).x;
+	const float h01 = texelFetch(heightMapTex, ivec2(p0.x, p1.y), 0).x;
+	const float h11 = texelFetch(heightMapTex, ivec2(p1.x, p1.y), 0).x;
+
+	return mix(mix(h00, h10, f.x), mix(h01, h11, f.x), f.y);
+}
+
+// approximates CGround::GetSlope
+float GetSlope(vec2 pos) {
+	const vec2 dx = vec2(float(SQUARE_SIZE), 0.0);
+	const vec2 dz = vec2(0.0, float(SQUARE_SIZE));
+	const vec3 n = normalize(vec3(GetHeight(pos - dx) - GetHeight(pos + dx), 2.0 * float(SQUARE_SIZE), GetHeight(pos - dz) - GetHeight(pos + dz)));
+	return (1.0 - n.y);
+}
+
+float linearstep(float edge0, float edge1, float x) {
+	return clamp((x - edge0) / (edge1 - edge0), 0.0, 1.0);
+}
+
+// stateless per-square sequence; turfs only have to be stable, not match the CPU path
+uint Hash(uint x) {
+	x ^= x >> 16u;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15u;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16u;
+	return x;
+}
+
+float NextFloat(inout uint state) {
+	state = Hash(state);
+	return (float(state >> 8u) * (1.0 / 16777216.0));
+}
+
+// Gribb-Hartmann planes of <viewProj> against a world-space sphere
+bool SphereInView(mat4 viewProj, vec3 center, float radius) {
+	const vec4 row0 = vec4(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+	const vec4 row1 = vec4(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+	const vec4 row2 = vec4(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+	const vec4 row3 = vec4(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+	const vec4 planes[6] = vec4[6](row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2);
+
+	for (int i = 0; i < 6; i++) {
+		if (dot(planes[i].xyz, center) + planes[i].w < -radius * length(planes[i].xyz))
+			return false;
+	}
+
+	return true;
+}
+
+void main(void)
+{
+	if (any(greaterThanEqual(gl_GlobalInvocationID.xy, uvec2(squareWindow.zw))))
+		return;
+
+	const ivec2 square = squareWindow.xy + ivec2(gl_GlobalInvocationID.xy);
+	const uint squareIdx = uint(square.y * grassMapSize.x + square.x);
+
+	if (((grassMap[squareIdx >> 2u] >> ((squareIdx & 3u) * 8u)) & 0xFFu) == 0u)
+		return;
+
+	const float maxGrassDist = grassParams.x;
+	const float maxDetailedDist = grassParams.y;
+	const float bladeHeight = grassParams.z;
+
+	// same reference point as GetGrassBlockCamDist
+	const vec2 squarePos = vec2(square) * float(GRASS_SQUARE_SIZE);
+	const float dist = distance(cameraPos, vec3(squarePos.x, GetHeight(squarePos), squarePos.y));
+
+	if (dist > maxGrassDist)
+		return;
+
+	const vec2 squareMid = squarePos + vec2(float(GRASS_SQUARE_SIZE) * 0.5);
+	const float squareRadius = float(GRASS_SQUARE_SIZE) * 0.75 + turfSize + bladeHeight * 2.0;
+
+	if (!SphereInView(cameraViewProj, vec3(squareMid.x, GetHeight(squareMid), squareMid.y), squareRadius))
+		return;
+
+	uint rng = Hash(squareIdx);
+
+	const float rDist = 1.0 + NextFloat(rng) * 0.5;
+	const float dStep = linearstep(maxDetailedDist, maxDetailedDist + 128.0 * rDist, dist);
+	const float gStep = linearstep(maxGrassDist, maxGrassDist + 127.0, dist + 128.0);
+
+	const bool drawMeshes = (dist < (maxDetailedDist + 128.0 * rDist));
+	const bool drawBillboards = (dist > maxDetailedDist);
+
+	// each square reserves all of its turfs at once, the buffers hold every square of the window
+	const uint meshSlot = drawMeshes? atomicAdd(drawCmds[0].instanceCount, uint(numTurfs)): 0u;
+	const uint billboardSlot = drawBillboards? atomicAdd(drawCmds[1].instanceCount, uint(numTurfs)): 0u;
+
+	for (int a = 0; a < numTurfs; a++) {
+		const vec2 turfPos = (vec2(square) + vec2(NextFloat(rng), NextFloat(rng))) * float(GRASS_SQUARE_SIZE);
+		const float turfRot = NextFloat(rng) * 2.0 * PI;
+
+		vec3 pos = vec3(turfPos.x, GetHeight(turfPos), turfPos.y);
+		pos.y -= GetSlope(turfPos) * 30.0;
+
+		// meshes sink into the ground while the billboards fade in
+		if (drawMeshes)
+			turfs[meshSlot + uint(a)] = vec4(pos.x, pos.y - 2.0 * bladeHeight * dStep, pos.z, turfRot);
+		if (drawBillboards)
+			turfs[uint(turfCapacity) + billboardSlot + uint(a)] = vec4(pos, min(1.0 - gStep, dStep));
+	}
+}
@@ -17,6 +17,13 @@ uniform vec3 sunDir;
 uniform vec3 ambientLightColor;
 uniform vec3 diffuseLightColor;
 
+#ifdef GPU_GRASS
+// written by GrassTurfsCompGL4, {pos, rotation} for meshes or {pos, alpha} for billboards
+layout(location = 6) in vec4 turfParams;
+
+uniform float billboardSize;
+#endif
+
 varying vec3 normal;
 varying vec4 shadingTexCoords;
 varying vec2 bladeTexCoords;
@@ -78,19 +85,40 @@ void main() {
 	vec2 texOffset = vec2(0.);
 	gl_FrontColor = gl_Color;
 
+	vec4 vertexPos = gl_Vertex;
+	vec3 vertexNormal = gl_Normal;
+	vec2 vertexTexCoord = gl_MultiTexCoord0.st;
+
 #ifndef DISTANCE_FAR
+	#ifdef GPU_GRASS
+	// per-turf equivalent of glTranslatef(pos) * glRotatef(rotation, 0, 1, 0)
+	float cosRot = cos(turfParams.w);
+	float sinRot = sin(turfParams.w);
+
+	mat4 turfMatrix = mat4(
+		cosRot, 0.0, -sinRot, 0.0,
+		   0.0, 1.0,     0.0, 0.0,
+		sinRot, 0.0,  cosRot, 0.0,
+		turfParams.xyz,       1.0
+	);
+	mat3 turfNormalMatrix = mat3(turfMatrix);
+	#else
+	mat4 turfMatrix = gl_ModelViewMatrix;
+	mat3 turfNormalMatrix = gl_NormalMatrix;
+	#endif
+
 	// mesh grass
-	normal = gl_NormalMatrix * gl_Normal;
-	vec4 worldPos = gl_ModelViewMatrix * gl_Vertex;
+	normal = turfNormalMatrix * vertexNormal;
+	vec4 worldPos = turfMatrix * vertexPos;
 
 	// anim
-	vec3 objPos = mat3(gl_ModelViewMatrix) * gl_Vertex.xyz;
-	worldPos.xyz += ApplyMainBending(objPos, windSpeed.xz, gl_MultiTexCoord0.s * 0.004 + 0.007) - objPos;
+	vec3 objPos = mat3(turfMatrix) * vertexPos.xyz;
+	worldPos.xyz += ApplyMainBending(objPos, windSpeed.xz, vertexTexCoord.s * 0.004 + 0.007) - objPos;
 	ApplyDetailBending(worldPos.xyz, normal,
-			gl_MultiTexCoord0.s,
+			vertexTexCoord.s,
 			frame / 30.0,
 			0.3,
-			gl_MultiTexCoord0.t * 0.4);
+			vertexTexCoord.t * 0.4);
 
 	// compute ambient & diffuse lighting per-vertex, specular is per-pixel
 	float fNdotL  = dot(normal, sunDir);
@@ -98,9 +126,18 @@ void main() {
 	diffuseTerm = max(diffuseTerm, ((-fNdotL) * 0.3 + 0.7) * 0.8); // back surface //TODO make constants customizable?
 	ambientDiffuseLightTerm = ambientLightColor + diffuseTerm * diffuseLightColor;
 #else
+	#ifdef GPU_GRASS
+	// quad corners of a triangle strip, same layout as CGrassDrawer::DrawBillboard
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+
+	vertexPos = vec4(turfParams.xyz, 1.0);
+	vertexNormal = vec3((corner * 2.0 - 1.0) * billboardSize, turfParams.w);
+	vertexTexCoord = vec2(corner.x / 16.0, 1.0 - corner.y);
+	#endif
+
 	// billboards
-	gl_FrontColor.a *= gl_Normal.z; // alpha blend far turfs
-	vec4 worldPos = /* gl_ModelViewMatrix * */ gl_Vertex; // MVM is empty in far draw pass
+	gl_FrontColor.a *= vertexNormal.z; // alpha blend far turfs
+	vec4 worldPos = /* gl_ModelViewMatrix * */ vertexPos; // MVM is empty in far draw pass
 
 	// get the camera angle on the billboard and select the corresponding sprite
 	float cosCamAngle = normalize(camPos.xyz - worldPos.xyz).y;
@@ -108,27 +145,27 @@ void main() {
 	texOffset.s = clamp(floor((ang + PI / 16.0 - PI / 2.0) / PI * 30.0), 0.0, 15.0) / 16.0;
 
 	// billboard size
-	vec2 billboardSize = gl_Normal.xy;
+	vec2 billboardExtents = vertexNormal.xy;
 
 	// cut of lower half in horizontal views (the fartexture is empty in lower 50% in horizontal view!)
-	billboardSize.y = max(billboardSize.y, billboardSize.y * cosCamAngle);
+	billboardExtents.y = max(billboardExtents.y, billboardExtents.y * cosCamAngle);
 
 	// span the billboard
-	worldPos.xyz += camRight * billboardSize.x;
-	worldPos.xyz += camUp    * billboardSize.y;
+	worldPos.xyz += camRight * billboardExtents.x;
+	worldPos.xyz += camUp    * billboardExtents.y;
 
 	// adjust texcoord for cut of billboard
-	texOffset.t = max((0.5 * cosCamAngle - 0.5), -gl_MultiTexCoord0.t);
+	texOffset.t = max((0.5 * cosCamAngle - 0.5), -vertexTexCoord.t);
 
 	// anim
-	float seed = fract(abs(dot(gl_Vertex.xyz, vec3(1.0))));
-	vec3 objPos = (worldPos.xyz - gl_Vertex.xyz);
+	float seed = fract(abs(dot(vertexPos.xyz, vec3(1.0))));
+	vec3 objPos = (worldPos.xyz - vertexPos.xyz);
 	worldPos.xyz += ApplyMainBending(objPos, windSpeed.xz, seed * 0.006 + 0.01) - objPos;
 	ApplyDetailBending(worldPos.xyz, vec3(1., 0., 1.),
 			seed,
 			frame / 30.0,
 			0.3,
-			0.5 * max(1.0 - gl_MultiTexCoord0.t, cosCamAngle));
+			0.5 * max(1.0 - vertexTexCoord.t, cosCamAngle));
 
 	// move up when looking down (to fix clipping issues)
 	worldPos.y   += 5.0 * cosCamAngle;
@@ -146,14 +183,14 @@ void main() {
 
 #ifdef SHADOW_GEN
 	{
-		bladeTexCoords = gl_MultiTexCoord0.st + texOffset;
+		bladeTexCoords = vertexTexCoord + texOffset;
 		gl_Position = gl_ProjectionMatrix * vertexShadowPos;
 		return;
 	}
 #endif
 
 	shadingTexCoords = worldPos.xzxz * vec4(mapSizePO2, mapSize);
-	bladeTexCoords   = gl_MultiTexCoord0.st + texOffset;
+	bladeTexCoords   = vertexTexCoord + texOffset;
 
 	gl_Position = gl_ProjectionMatrix * worldPos;
 
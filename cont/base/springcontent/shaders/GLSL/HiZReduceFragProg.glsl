@@ -0,0 +1,21 @@
+#version 430 compatibility
+
+// one max-depth reduction step of GL::HiZPyramid; destination texel d covers
+// the source texels [2d, 2d + 1], clamped to <srcSize> for odd source sizes
+
+uniform sampler2D srcTex; // restricted to the source level by the caller
+uniform ivec2 srcSize;
+
+layout(location = 0) out float fragDepth;
+
+void main() {
+	const ivec2 p0 = ivec2(gl_FragCoord.xy) * 2;
+	const ivec2 p1 = min(p0 + 1, srcSize - 1);
+
+	const float d00 = texelFetch(srcTex, ivec2(p0.x, p0.y), 0).x;
+	const float d10 = texelFetch(srcTex, ivec2(p1.x, p0.y), 0).x;
+	const float d01 = texelFetch(srcTex, ivec2(p0.x, p1.y), 0).x;
+	const float d11 = texelFetch(srcTex, ivec2(p1.x, p1.y), 0).x;
+
+	fragDepth = max(max(d00, d10), max(d01, d11));
+}
@@ -0,0 +1,7 @@
+#version 430 compatibility
+
+// full-viewport quad in [0, 1], see GL::HiZPyramid::Capture
+
+void main() {
+	gl_Position = vec4(gl_Vertex.xy * 2.0 - 1.0, 0.0, 1.0);
+}
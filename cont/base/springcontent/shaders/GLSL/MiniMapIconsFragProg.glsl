@@ -0,0 +1,16 @@
+#version 150
+
+uniform sampler2D iconTex;
+
+in vec2 vTexCoord;
+in vec4 vColor;
+
+out vec4 outColor;
+
+void main() {
+	outColor = texture(iconTex, vTexCoord) * vColor;
+
+	// same as alphaCtrl GL_GREATER 0.0 on the non-instanced path
+	if (outColor.a <= 0.0)
+		discard;
+}
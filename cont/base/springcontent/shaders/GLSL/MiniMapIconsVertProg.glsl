@@ -0,0 +1,19 @@
+#version 150 compatibility
+#extension GL_ARB_explicit_attrib_location : require
+
+// one instance per unit, the quad corners come from gl_VertexID; see CUnitIconBatches
+
+layout(location = 0) in vec4 posHalfSize; // top-down world-space {x, z}, half icon size
+layout(location = 1) in vec4 color;
+
+out vec2 vTexCoord;
+out vec4 vColor;
+
+void main() {
+	const vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+
+	vTexCoord = corner;
+	vColor = color;
+
+	gl_Position = gl_ModelViewProjectionMatrix * vec4(posHalfSize.xy + (corner * 2.0 - 1.0) * posHalfSize.zw, 0.0, 1.0);
+}
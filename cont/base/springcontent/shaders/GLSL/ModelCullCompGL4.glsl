@@ -0,0 +1,160 @@
+#version 430 core
+
+// culls the objects of one S3DModelCullSet bin and compacts the survivors
+// into per-model indirect draw-commands, see S3DModelVAO::SubmitCulled
+
+layout(local_size_x = CULL_WORKGROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+// only the prefix that is needed, std140 keeps the offsets of the full block
+layout(std140, binding = 0) uniform UniformMatrixBuffer {
+	mat4 screenView;
+	mat4 screenProj;
+	mat4 screenViewProj;
+
+	mat4 cameraView;
+	mat4 cameraProj;
+	mat4 cameraViewProj;
+	mat4 cameraBillboardView;
+
+	mat4 cameraViewInv;
+	mat4 cameraProjInv;
+	mat4 cameraViewProjInv;
+
+	mat4 shadowView;
+	mat4 shadowProj;
+	mat4 shadowViewProj;
+
+	mat4 reflectionView;
+	mat4 reflectionProj;
+	mat4 reflectionViewProj;
+};
+
+layout(std140, binding = 0) readonly buffer MatrixBuffer {
+	mat4 mat[];
+};
+
+// ModelUniformData, 32 words each; word 0 is {drawFlag, gpuDrawMask, id}
+layout(std430, binding = 1) readonly buffer UniformsBuffer {
+	uint uni[];
+};
+
+struct CullObject {
+	uvec4 instData; // matOffset, uniOffset, {teamIdx, drawFlag, u16 textureType}, draw-command index | (numLODs - 1) << 30
+	vec4 midPosRadius;
+};
+
+struct DrawCommand {
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	uint baseVertex;
+	uint baseInstance;
+};
+
+layout(std430, binding = CULL_OBJS_SSBO_BINDING_IDX) readonly buffer CullObjectsBuffer {
+	CullObject cullObjs[];
+};
+
+layout(std430, binding = INSTANCES_SSBO_BINDING_IDX) writeonly buffer InstancesBuffer {
+	uvec4 instances[];
+};
+
+layout(std430, binding = DRAW_CMDS_SSBO_BINDING_IDX) buffer DrawCommandsBuffer {
+	DrawCommand drawCmds[];
+};
+
+uniform int objsOffset;
+uniform int objsCount;
+uniform int passType; // 0 := opaque, 1 := alpha, 2 := shadow
+uniform int passMask;
+
+uniform vec4 lodParams; // player camera position, pixel radius of a unit-sized object at unit distance
+uniform vec2 lodPixelRadii; // see S3DModelVAO LOD_PIXEL_RADII
+
+// DrawFlags
+#define SO_OPAQUE_FLAG   1u
+#define SO_ALPHAF_FLAG   2u
+#define SO_REFLEC_FLAG   4u
+#define SO_REFRAC_FLAG   8u
+#define SO_SHADOW_FLAG  16u
+#define SO_FARTEX_FLAG  32u
+#define SO_DRICON_FLAG 128u
+
+// mirrors CUnitDrawer::ShouldDraw* and CFeatureDrawer::ShouldDraw*
+bool DrawFlagsPass(uint drawFlag, uint gpuDrawMask) {
+	const uint pm = uint(passMask);
+
+	if ((gpuDrawMask & pm) != pm)
+		return false;
+
+	switch (passType) {
+		case 2: return ((drawFlag & SO_SHADOW_FLAG) != 0u);
+		case 1: if (drawFlag == 0u || (drawFlag & (SO_DRICON_FLAG | SO_OPAQUE_FLAG)) != 0u) return false; break;
+		default: if (drawFlag == 0u || (drawFlag & (SO_DRICON_FLAG | SO_ALPHAF_FLAG | SO_FARTEX_FLAG)) != 0u) return false; break;
+	}
+
+	if (pm == SO_REFLEC_FLAG && (drawFlag & SO_REFLEC_FLAG) == 0u)
+		return false;
+	if (pm == SO_REFRAC_FLAG && (drawFlag & SO_REFRAC_FLAG) == 0u)
+		return false;
+
+	return true;
+}
+
+// Gribb-Hartmann planes of <viewProj> against a world-space sphere
+bool SphereInView(mat4 viewProj, vec3 center, float radius) {
+	const vec4 row0 = vec4(viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]);
+	const vec4 row1 = vec4(viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]);
+	const vec4 row2 = vec4(viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]);
+	const vec4 row3 = vec4(viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]);
+
+	const vec4 planes[6] = vec4[6](row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2);
+
+	for (int i = 0; i < 6; i++) {
+		if (dot(planes[i].xyz, center) + planes[i].w < -radius * length(planes[i].xyz))
+			return false;
+	}
+
+	return true;
+}
+
+void main(void)
+{
+	if (gl_GlobalInvocationID.x >= uint(objsCount))
+		return;
+
+	const CullObject cullObj = cullObjs[uint(objsOffset) + gl_GlobalInvocationID.x];
+
+	const uint uniWord = uni[cullObj.instData.y * 32u];
+	const uint drawFlag = (uniWord >> 0u) & 0xFFu;
+	const uint gpuDrawMask = (uniWord >> 8u) & 0xFFu;
+
+	if (!DrawFlagsPass(drawFlag, gpuDrawMask))
+		return;
+
+	const vec3 center = (mat[cullObj.instData.x] * vec4(cullObj.midPosRadius.xyz, 1.0)).xyz;
+
+	mat4 viewProj = cameraViewProj;
+	if (passType == 2)
+		viewProj = shadowViewProj;
+	else if (uint(passMask) == SO_REFLEC_FLAG)
+		viewProj = reflectionViewProj;
+
+	if (!SphereInView(viewProj, center, cullObj.midPosRadius.w))
+		return;
+
+	// LOD-levels follow the object's first draw-command, each with room for all instances
+	const float pxRadius = cullObj.midPosRadius.w * lodParams.w / max(distance(lodParams.xyz, center), 1.0);
+	const uint maxLOD = cullObj.instData.w >> 30u;
+	const uint lod = min(uint(pxRadius < lodPixelRadii.x) + uint(pxRadius < lodPixelRadii.y), maxLOD);
+
+	const uint cmdIdx = (cullObj.instData.w & 0x3FFFFFFFu) + lod;
+	const uint slot = atomicAdd(drawCmds[cmdIdx].instanceCount, 1u);
+
+	instances[drawCmds[cmdIdx].baseInstance + slot] = uvec4(
+		cullObj.instData.x,
+		cullObj.instData.y,
+		(cullObj.instData.z & 0xFFFF00FFu) | (drawFlag << 8u),
+		0u
+	);
+}
@@ -39,6 +39,24 @@
 #endif
 
 
+#ifdef CLUSTERED_DYNAMIC_LIGHTS
+  struct ClusterLight {
+    vec4 posRadius;
+    vec4 ambientColor;
+    vec4 diffuseColor;
+    vec4 specularColor;
+    vec4 spotDirCosCutoff;
+  };
+
+  layout(std430, binding = CLUSTER_LIGHTS_SSBO_BINDING_IDX) readonly buffer ClusterLightsBuffer { ClusterLight clusterLights[]; };
+  layout(std430, binding = CLUSTER_RANGES_SSBO_BINDING_IDX) readonly buffer ClusterRangesBuffer { uvec2 clusterRanges[]; };
+  layout(std430, binding = CLUSTER_INDICES_SSBO_BINDING_IDX) readonly buffer ClusterIndicesBuffer { uint clusterIndices[]; };
+
+  uniform vec4 clusterViewport;    // x, y, 1/w, 1/h
+  uniform vec4 clusterViewDepth;   // third row of the view matrix
+  uniform vec2 clusterDepthParams; // near, slices / log(far / near)
+#endif
+
 
 float GetShadowCoeff(float zBias) {
 	#if (USE_SHADOWS == 1)
@@ -89,6 +107,49 @@ vec3 DynamicLighting(vec3 normal, vec3 diffuse, vec3 specular) {
 	return rgb;
 }
 
+#ifdef CLUSTERED_DYNAMIC_LIGHTS
+uint GetClusterIndex() {
+	const vec2 tile = clamp((gl_FragCoord.xy - clusterViewport.xy) * clusterViewport.zw, 0.0, 0.9999) * vec2(CLUSTER_TILES_X, CLUSTER_TILES_Y);
+	const float depth = -dot(clusterViewDepth, vec4(vertexWorldPos.xyz, 1.0));
+	const float slice = clamp(log(max(depth, clusterDepthParams.x) / clusterDepthParams.x) * clusterDepthParams.y, 0.0, float(CLUSTER_SLICES - 1u));
+
+	return ((uint(slice) * CLUSTER_TILES_Y + uint(tile.y)) * CLUSTER_TILES_X + uint(tile.x));
+}
+
+// same model as DynamicLighting, over the lights assigned to this fragment's cluster
+vec3 ClusteredDynamicLighting(vec3 normal, vec3 diffuse, vec3 specular) {
+	const uvec2 range = clusterRanges[GetClusterIndex()];
+	const vec3 viewVec = -normalize(cameraDir);
+
+	vec3 rgb = vec3(0.0);
+
+	for (uint n = 0u; n < range.y; n++) {
+		const ClusterLight light = clusterLights[clusterIndices[range.x + n]];
+
+		vec3 lightVec = light.posRadius.xyz - vertexWorldPos.xyz;
+
+		float lightRadius   = light.posRadius.w;
+		float lightDistance = length(lightVec);
+		float lightScale    = float(lightDistance <= lightRadius);
+
+		vec3 lightDir = lightVec / lightDistance;
+		vec3 halfVec  = normalize(lightDir + viewVec);
+
+		float lightCosAngDiff = clamp(dot(normal, lightDir), 0.0, 1.0);
+		float lightCosAngSpec = clamp(dot(normal, halfVec), 0.0, 1.0);
+		float lightAttenuation = 1.0 - min(1.0, ((lightDistance * lightDistance) / (lightRadius * lightRadius)));
+
+		lightScale *= float(dot(-lightDir, light.spotDirCosCutoff.xyz) >= light.spotDirCosCutoff.w);
+
+		rgb += (lightScale *                                  light.ambientColor.rgb);
+		rgb += (lightScale * lightAttenuation * (diffuse.rgb * light.diffuseColor.rgb * lightCosAngDiff));
+		rgb += (lightScale * lightAttenuation * (specular.rgb * light.specularColor.rgb * pow(lightCosAngSpec, 4.0)));
+	}
+
+	return rgb;
+}
+#endif
+
 void main(void)
 {
 #ifdef use_normalmapping
@@ -134,6 +195,12 @@ void main(void)
 	gl_FragColor.rgb += DynamicLighting(normal, diffuse.rgb, specular);
 	#endif
 
+	#ifdef CLUSTERED_DYNAMIC_LIGHTS
+	#if (DEFERRED_MODE == 0)
+	gl_FragColor.rgb += ClusteredDynamicLighting(normal, diffuse.rgb, specular);
+	#endif
+	#endif
+
 	#if (DEFERRED_MODE == 1)
 	gl_FragData[GBUFFER_NORMTEX_IDX] = vec4((normal + vec3(1.0, 1.0, 1.0)) * 0.5, 1.0);
 	gl_FragData[GBUFFER_DIFFTEX_IDX] = vec4(mix(                         diffuse.rgb, teamColor.rgb,   diffuse.a), alpha);
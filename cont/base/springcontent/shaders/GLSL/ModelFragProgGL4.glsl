@@ -1,10 +1,24 @@
 #version 430 core
 
-layout(binding = 0) uniform sampler2D tex1;
-layout(binding = 1) uniform sampler2D tex2;
+#if (BINDLESS_MODEL_TEXTURES == 1)
+	#extension GL_ARB_bindless_texture : require
+
+	// {tex1, tex2} handles per textureType, see CS3OTextureHandler::BindTextureHandles
+	layout(std430, binding = TEX_HANDLES_SSBO_BINDING_IDX) readonly buffer TexHandlesBuffer {
+		uvec4 texHandles[];
+	};
+#else
+	layout(binding = 0) uniform sampler2D tex1;
+	layout(binding = 1) uniform sampler2D tex2;
+#endif
 
 #if (USE_SHADOWS == 1)
 	layout(binding = 2) uniform sampler2DShadow shadowTex;
+	layout(binding = 5) uniform sampler2DArrayShadow shadowCascadeTex;
+
+	// see CShadowHandler::SetCascadeUniforms, cascade 0 is shadowTex
+	uniform int numShadowCascades = 1;
+	uniform mat4 shadowCascadeMats[3];
 #endif
 
 layout(binding = 3) uniform samplerCube reflectTex;
@@ -54,6 +68,7 @@ in Data {
 	vec4 shadowVertexPos;
 	// Auxilary
 	float fogFactor;
+	flat uint textureType;
 };
 
 uniform int shadingMode = 0; //NORMAL_SHADING
@@ -75,6 +90,16 @@ float GetShadowMult(vec3 shadowCoord, float NdotL) {
 		float bias = cb * tan(acos(NdotL));
 		bias = clamp(bias, 0.0, 5.0 * cb);
 
+		// tightest cascade that contains the fragment wins, keep off its
+		// border so the filter footprint never samples outside of it
+		for (int i = 0; i < numShadowCascades - 1; i++) {
+			vec4 cascadeCoord = shadowCascadeMats[i] * worldPos;
+			cascadeCoord.xy += vec2(0.5);
+
+			if (all(lessThan(abs(cascadeCoord.xy - vec2(0.5)), vec2(0.49))))
+				return texture(shadowCascadeTex, vec4(cascadeCoord.xy, float(i), cascadeCoord.z - bias));
+		}
+
 		shadowCoord.z -= bias;
 
 		return texture(shadowTex, shadowCoord).r;
@@ -94,6 +119,11 @@ float GetShadowMult(vec3 shadowCoord, float NdotL) {
 
 void main(void)
 {
+	#if (BINDLESS_MODEL_TEXTURES == 1)
+		sampler2D tex1 = sampler2D(texHandles[textureType].xy);
+		sampler2D tex2 = sampler2D(texHandles[textureType].zw);
+	#endif
+
 	vec4 texColor1 = texture(tex1, uvCoord.xy);
 	vec4 texColor2 = texture(tex2, uvCoord.xy);
 
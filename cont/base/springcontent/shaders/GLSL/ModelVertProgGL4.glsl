@@ -10,7 +10,7 @@ layout (location = 5) in uint pieceIndex;
 layout (location = 6) in uvec4 instData;
 // u32 matOffset
 // u32 uniOffset
-// u32 {teamIdx, drawFlag, unused, unused}
+// u32 {teamIdx, drawFlag, u16 textureType}
 // u32 unused
 
 layout(std140, binding = 0) uniform UniformMatrixBuffer {
@@ -111,6 +111,7 @@ out Data {
 	vec4 shadowVertexPos;
 	// Auxilary
 	float fogFactor;
+	flat uint textureType;
 };
 out float gl_ClipDistance[3];
 
@@ -161,6 +162,7 @@ void main(void)
 	teamCol.a = teamColorAlpha;
 
 	uvCoord = uv;
+	textureType = (instData.z >> 16u);
 
 	shadowVertexPos = shadowView * worldPos;
 	shadowVertexPos.xy += vec2(0.5);  //no need for shadowParams anymore
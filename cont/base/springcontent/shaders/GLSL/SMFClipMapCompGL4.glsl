@@ -0,0 +1,136 @@
+#version 430 core
+
+// builds the vertices of every map patch at its LOD-level from the heightmap
+// texture, one workgroup row per patch; see CClipMapMeshDrawer::UpdateDraw
+
+layout(local_size_x = MESH_WORKGROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
+
+// {x, z} := patch corner in heightmap squares, z := lod | (borderMask << 8), w := first vertex
+layout(std430, binding = PATCHES_SSBO_BINDING_IDX) readonly buffer PatchesBuffer {
+	uvec4 patches[];
+};
+
+// interleaved {position, normal}; floats rather than vec3's to keep the std430 layout tight
+layout(std430, binding = VERTICES_SSBO_BINDING_IDX) writeonly buffer VerticesBuffer {
+	float verts[];
+};
+
+uniform sampler2D heightMapTex; // corner heightmap
+
+uniform vec4 lodParams; // camera x, camera z, squared camera height above the map, distance of the first LOD-level
+uniform float borderHeight;
+
+// same values as in CClipMapMeshDrawer
+const float MORPH_START = 0.75;
+const float MORPH_END = 0.95;
+
+
+float GetHeight(vec2 pos) {
+	const ivec2 texSize = textureSize(heightMapTex, 0);
+	const vec2 texPos = clamp(pos / float(SQUARE_SIZE), vec2(0.0), vec2(texSize - 1));
+
+	const ivec2 p0 = ivec2(texPos);
+	const ivec2 p1 = min(p0 + 1, texSize - 1);
+	const vec2 f = texPos - vec2(p0);
+
+	const float h00 = texelFetch(heightMapTex, ivec2(p0.x, p0.y), 0).x;
+	const float h10 = texelFetch(heightMapTex, ivec2(p1.x, p0.y), 0).x;
+	const float h01 = texelFetch(heightMapTex, ivec2(p0.x, p1.y), 0).x;
+	const float h11 = texelFetch(heightMapTex, ivec2(p1.x, p1.y), 0).x;
+
+	return mix(mix(h00, h10, f.x), mix(h01, h11, f.x), f.y);
+}
+
+vec3 GetNormal(vec2 pos) {
+	const vec2 dx = vec2(float(SQUARE_SIZE), 0.0);
+	const vec2 dz = vec2(0.0, float(SQUARE_SIZE));
+	return normalize(vec3(GetHeight(pos - dx) - GetHeight(pos + dx), 2.0 * float(SQUARE_SIZE), GetHeight(pos - dz) - GetHeight(pos + dz)));
+}
+
+// must match CClipMapMeshDrawer::GetLODDistance; a monotonic function of the
+// planar distance, so any point of a patch is at most its diagonal farther
+// than the closest point the CPU selected the LOD-level by
+float GetLODDistance(vec2 pos) {
+	const vec2 d = pos - lodParams.xy;
+	return sqrt(dot(d, d) + lodParams.z);
+}
+
+// 0 := vertex stays on its own grid, 1 := vertex sits on the next coarser one
+float GetMorphFactor(vec2 pos, uint lod) {
+	if (lod >= uint(NUM_LOD_LEVELS - 1))
+		return 0.0;
+
+	const float lodDist = lodParams.w * float(1u << lod);
+	return clamp((GetLODDistance(pos) - lodDist * MORPH_START) / (lodDist * (MORPH_END - MORPH_START)), 0.0, 1.0);
+}
+
+vec3 GetGridVertex(uvec2 patchCorner, uvec2 gridPos, uint lod) {
+	const float lodStep = float(1u << lod);
+
+	// odd vertices slide onto their even neighbours, fully morphed border
+	// vertices therefore coincide with those of a coarser adjacent patch
+	const vec2 basePos = (vec2(patchCorner) + vec2(gridPos) * lodStep) * float(SQUARE_SIZE);
+	const vec2 morphPos = vec2(gridPos) - fract(vec2(gridPos) * 0.5) * 2.0 * GetMorphFactor(basePos, lod);
+	const vec2 worldPos = (vec2(patchCorner) + morphPos * lodStep) * float(SQUARE_SIZE);
+
+	return vec3(worldPos.x, GetHeight(worldPos), worldPos.y);
+}
+
+void WriteVertex(uint vertIdx, vec3 pos, vec3 nrm) {
+	verts[vertIdx * 6u + 0u] = pos.x;
+	verts[vertIdx * 6u + 1u] = pos.y;
+	verts[vertIdx * 6u + 2u] = pos.z;
+	verts[vertIdx * 6u + 3u] = nrm.x;
+	verts[vertIdx * 6u + 4u] = nrm.y;
+	verts[vertIdx * 6u + 5u] = nrm.z;
+}
+
+void main(void)
+{
+	const uvec4 patchInfo = patches[gl_WorkGroupID.y];
+
+	const uint lod = patchInfo.z & 0xFFu;
+	const uint borderMask = patchInfo.z >> 8u;
+
+	const uint numQuads = uint(PATCH_SIZE) >> lod;
+	const uint numVerts = numQuads + 1u;
+	const uint numGridVerts = numVerts * numVerts;
+	const uint numBorderVerts = uint(bitCount(borderMask)) * numVerts * 2u;
+
+	const uint vertIdx = gl_GlobalInvocationID.x;
+
+	if (vertIdx >= (numGridVerts + numBorderVerts))
+		return;
+
+	if (vertIdx < numGridVerts) {
+		const vec3 pos = GetGridVertex(patchInfo.xy, uvec2(vertIdx % numVerts, vertIdx / numVerts), lod);
+
+		WriteVertex(patchInfo.w + vertIdx, pos, GetNormal(pos.xz));
+		return;
+	}
+
+	// border strips follow the grid in {L, R, T, B} order, upper row first
+	const uint borderVertIdx = vertIdx - numGridVerts;
+	const uint borderSlot = borderVertIdx / (numVerts * 2u);
+	const uint sideVertIdx = borderVertIdx % (numVerts * 2u);
+	const uint j = sideVertIdx % numVerts;
+
+	uint side = 0u;
+
+	for (uint s = 0u, n = 0u; s < 4u; s++) {
+		if ((borderMask & (1u << s)) == 0u)
+			continue;
+		if ((n++) == borderSlot)
+			side = s;
+	}
+
+	const uvec2 sideGridPos[4] = uvec2[4](uvec2(0u, j), uvec2(numQuads, j), uvec2(j, 0u), uvec2(j, numQuads));
+	const vec3 sideNormals[4] = vec3[4](vec3(-1.0, 0.0, 0.0), vec3(1.0, 0.0, 0.0), vec3(0.0, 0.0, -1.0), vec3(0.0, 0.0, 1.0));
+
+	vec3 pos = GetGridVertex(patchInfo.xy, sideGridPos[side], lod);
+
+	if (sideVertIdx >= numVerts)
+		pos.y = borderHeight;
+
+	WriteVertex(patchInfo.w + vertIdx, pos, sideNormals[side]);
+}
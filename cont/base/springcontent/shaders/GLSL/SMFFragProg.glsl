@@ -68,6 +68,13 @@ varying vec2 diffuseTexCoords;
 	uniform vec4 shadowParams;
 #endif
 
+#ifdef HAVE_SHADOW_CASCADES
+	// see CShadowHandler::SetCascadeUniforms, cascade 0 is shadowTex
+	uniform sampler2DArrayShadow shadowCascadeTex;
+	uniform int numShadowCascades;
+	uniform mat4 shadowCascadeMats[3];
+#endif
+
 #ifdef SMF_WATER_ABSORPTION
 	uniform vec3 waterMinColor;
 	uniform vec3 waterBaseColor;
@@ -107,6 +114,24 @@ varying vec2 diffuseTexCoords;
 	uniform sampler2D parallaxHeightTex;
 #endif
 
+#ifdef CLUSTERED_DYNAMIC_LIGHTS
+	struct ClusterLight {
+		vec4 posRadius;
+		vec4 ambientColor;
+		vec4 diffuseColor;
+		vec4 specularColor;
+		vec4 spotDirCosCutoff;
+	};
+
+	layout(std430, binding = CLUSTER_LIGHTS_SSBO_BINDING_IDX) readonly buffer ClusterLightsBuffer { ClusterLight clusterLights[]; };
+	layout(std430, binding = CLUSTER_RANGES_SSBO_BINDING_IDX) readonly buffer ClusterRangesBuffer { uvec2 clusterRanges[]; };
+	layout(std430, binding = CLUSTER_INDICES_SSBO_BINDING_IDX) readonly buffer ClusterIndicesBuffer { uint clusterIndices[]; };
+
+	uniform vec4 clusterViewport;    // x, y, 1/w, 1/h
+	uniform vec4 clusterViewDepth;   // third row of the view matrix
+	uniform vec2 clusterDepthParams; // near, slices / log(far / near)
+#endif
+
 
 /***********************************************************************/
 // Helper functions
@@ -293,6 +318,57 @@ vec3 DynamicLighting(vec3 normal, vec3 diffuseCol, vec3 specularCol, float specu
 	return light;
 }
 
+#ifdef CLUSTERED_DYNAMIC_LIGHTS
+uint GetClusterIndex() {
+	vec2 tile = clamp((gl_FragCoord.xy - clusterViewport.xy) * clusterViewport.zw, 0.0, 0.9999) * vec2(CLUSTER_TILES_X, CLUSTER_TILES_Y);
+	float depth = -dot(clusterViewDepth, vec4(vertexWorldPos.xyz, 1.0));
+	float slice = clamp(log(max(depth, clusterDepthParams.x) / clusterDepthParams.x) * clusterDepthParams.y, 0.0, float(CLUSTER_SLICES - 1u));
+
+	return ((uint(slice) * CLUSTER_TILES_Y + uint(tile.y)) * CLUSTER_TILES_X + uint(tile.x));
+}
+
+// same model as DynamicLighting, over the lights assigned to this fragment's cluster
+vec3 ClusteredDynamicLighting(vec3 normal, vec3 diffuseCol, vec3 specularCol, float specularExp) {
+	vec3 light = vec3(0.0);
+
+	#ifndef SMF_SPECULAR_LIGHTING
+		specularCol = vec3(0.5, 0.5, 0.5);
+	#endif
+
+	uvec2 range = clusterRanges[GetClusterIndex()];
+	vec3 viewVec = normalize(cameraPos - vertexWorldPos.xyz);
+
+	for (uint n = 0u; n < range.y; n++) {
+		ClusterLight lgt = clusterLights[clusterIndices[range.x + n]];
+
+		vec3 lightVec = lgt.posRadius.xyz - vertexWorldPos.xyz;
+
+		float lightRadius = lgt.posRadius.w;
+		float lightDistance = length(lightVec);
+		float lightScale = float(lightDistance <= lightRadius);
+
+		vec3 lightDir = lightVec / lightDistance;
+
+		float lightCosAngDiff = clamp(dot(normal, lightDir), 0.0, 1.0);
+		float lightCosAngSpec = clamp(dot(normal, normalize(lightDir + viewVec)), 0.001, 1.0);
+		float lightAttenuation = 1.0 - min(1.0, ((lightDistance * lightDistance) / (lightRadius * lightRadius)));
+
+		float lightSpecularPow = 0.0;
+	#ifdef SMF_SPECULAR_LIGHTING
+		lightSpecularPow = max(0.0, pow(lightCosAngSpec, specularExp));
+	#endif
+
+		lightScale *= float(dot(-lightDir, lgt.spotDirCosCutoff.xyz) >= lgt.spotDirCosCutoff.w);
+
+		light += (lightScale *                                       lgt.ambientColor.rgb);
+		light += (lightScale * lightAttenuation * (diffuseCol.rgb *  lgt.diffuseColor.rgb * lightCosAngDiff));
+		light += (lightScale * lightAttenuation * (specularCol.rgb * lgt.specularColor.rgb * lightSpecularPow));
+	}
+
+	return light;
+}
+#endif
+
 /***********************************************************************/
 // main()
 
@@ -407,8 +483,21 @@ void main() {
 			vertexShadowPos.xy *= (inversesqrt(abs(vertexShadowPos.xy) + shadowParams.zz) + shadowParams.ww);
 			vertexShadowPos.xy += shadowParams.xy;
 
+		float shadowSample = shadow2DProj(shadowTex, vertexShadowPos).r;
+
+		#ifdef HAVE_SHADOW_CASCADES
+		// tightest cascade containing the fragment replaces the full map
+		for (int i = numShadowCascades - 2; i >= 0; i--) {
+			vec4 cascadeShadowPos = shadowCascadeMats[i] * vertexWorldPos;
+			cascadeShadowPos.xy += vec2(0.5, 0.5);
+
+			if (all(lessThan(abs(cascadeShadowPos.xy - vec2(0.5, 0.5)), vec2(0.49, 0.49))))
+				shadowSample = texture(shadowCascadeTex, vec4(cascadeShadowPos.xy, float(i), cascadeShadowPos.z));
+		}
+		#endif
+
 		// same as ARB shader: shadowCoeff = 1 - (1 - shadowCoeff) * groundShadowDensity
-		shadowCoeff = mix(1.0, shadow2DProj(shadowTex, vertexShadowPos).r, groundShadowDensity);
+		shadowCoeff = mix(1.0, shadowSample, groundShadowDensity);
 	}
 	#endif
 
@@ -458,6 +547,9 @@ void main() {
 		#if (MAX_DYNAMIC_MAP_LIGHTS > 0)
 			gl_FragColor.rgb += DynamicLighting(normal, diffuseCol.rgb, specularCol.rgb, specularExp);
 		#endif
+		#ifdef CLUSTERED_DYNAMIC_LIGHTS
+			gl_FragColor.rgb += ClusteredDynamicLighting(normal, diffuseCol.rgb, specularCol.rgb, specularExp);
+		#endif
 	#endif
 
 
@@ -4,11 +4,22 @@
 	layout(depth_unchanged) out float gl_FragDepth;
 #endif
 
+#if (BINDLESS_MODEL_TEXTURES == 1)
+	#extension GL_ARB_bindless_texture : require
+
+	// {tex1, tex2} handles per textureType, see CS3OTextureHandler::BindTextureHandles
+	layout(std430, binding = TEX_HANDLES_SSBO_BINDING_IDX) readonly buffer TexHandlesBuffer {
+		uvec4 texHandles[];
+	};
+#else
+	layout(binding = 0) uniform sampler2D tex2;
+#endif
+
 uniform vec4 alphaCtrl = vec4(0.5, 1.0, 0.0, 0.0); // < 0.5
-layout(binding = 0) uniform sampler2D tex2;
 
 in Data {
 	vec4 uvCoord;
+	flat uint textureType;
 };
 
 bool AlphaDiscard(float a) {
@@ -19,6 +30,10 @@ bool AlphaDiscard(float a) {
 }
 
 void main() {
+	#if (BINDLESS_MODEL_TEXTURES == 1)
+		sampler2D tex2 = sampler2D(texHandles[textureType].zw);
+	#endif
+
 	if (AlphaDiscard(texture(tex2, uvCoord.xy).a))
 		discard;
 }
@@ -10,7 +10,7 @@ layout (location = 5) in uint pieceIndex;
 layout (location = 6) in uvec4 instData;
 // u32 matOffset
 // u32 uniOffset
-// u32 {teamIdx, drawFlag, unused, unused}
+// u32 {teamIdx, drawFlag, u16 textureType}
 // u32 unused
 
 layout(std140, binding = 0) uniform UniformMatrixBuffer {
@@ -92,6 +92,7 @@ uniform vec4 clipPlane1 = vec4(0.0, 0.0, 0.0, 1.0); //lower construction clip pl
 
 out Data {
 	vec4 uvCoord;
+	flat uint textureType;
 };
 out float gl_ClipDistance[2];
 
@@ -137,6 +138,7 @@ void main(void)
 	vec3 worldNormal = normalMatrix * normal;
 
 	uvCoord = uv;
+	textureType = (instData.z >> 16u);
 
 	TransformShadowCam(worldPos, worldNormal);
 }
\ No newline at end of file
@@ -118,6 +118,23 @@ CUnit* CAICallback::GetInLosAndRadarUnit(int unitId) const {
 	return GetInSensorRangeUnit(unitId, (LOS_INLOS | LOS_INRADAR));
 }
 
+// with AsyncSkirmishAIUpdates, Update events run concurrently with rendering
+// and unsynced Lua (see CEngineOutHandler::StartAsyncUpdate); calls that would
+// touch their state are ignored when made from the AI thread
+static bool AllowUnsyncedCall(const char* caller)
+{
+	static bool warned = false;
+
+	if (!eoh->IsAsyncUpdateThread())
+		return true;
+
+	if (!warned)
+		LOG_L(L_WARNING, "[AICallback::%s] ignored during asynchronous Update events (further calls are ignored silently)", caller);
+
+	warned = true;
+	return false;
+}
+
 
 CAICallback::CAICallback(int teamId): team(teamId)
 {}
@@ -133,6 +150,9 @@ void CAICallback::SendStartPos(bool ready, float3 startPos)
 
 void CAICallback::SendTextMsg(const char* text, int zone)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	const std::vector<uint8_t>& teamAIs = skirmishAIHandler.GetSkirmishAIsInTeam(this->team);
 	const SkirmishAIData* aiData = skirmishAIHandler.GetSkirmishAI(teamAIs[0]); // FIXME is there a better way?
 
@@ -144,11 +164,17 @@ void CAICallback::SendTextMsg(const char* text, int zone)
 
 void CAICallback::SetLastMsgPos(const float3& pos)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	eventHandler.LastMessagePosition(pos);
 }
 
 void CAICallback::AddNotification(const float3& pos, const float3& color, float alpha)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	minimap->AddNotification(pos, color, alpha);
 }
 
@@ -1000,41 +1026,65 @@ float CAICallback::GetElevation(float x, float z)
 
 void CAICallback::LineDrawerStartPath(const float3& pos, const float* color)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	lineDrawer.StartPath(pos, color);
 }
 
 void CAICallback::LineDrawerFinishPath()
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	lineDrawer.FinishPath();
 }
 
 void CAICallback::LineDrawerDrawLine(const float3& endPos, const float* color)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	lineDrawer.DrawLine(endPos,color);
 }
 
 void CAICallback::LineDrawerDrawLineAndIcon(int commandId, const float3& endPos, const float* color)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	lineDrawer.DrawLineAndIcon(commandId,endPos,color);
 }
 
 void CAICallback::LineDrawerDrawIconAtLastPos(int commandId)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	lineDrawer.DrawIconAtLastPos(commandId);
 }
 
 void CAICallback::LineDrawerBreak(const float3& endPos, const float* color)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	lineDrawer.Break(endPos,color);
 }
 
 void CAICallback::LineDrawerRestart()
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	lineDrawer.Restart();
 }
 
 void CAICallback::LineDrawerRestartSameColor()
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	lineDrawer.RestartSameColor();
 }
 
@@ -1043,22 +1093,34 @@ int CAICallback::CreateSplineFigure(const float3& pos1, const float3& pos2,
 		const float3& pos3, const float3& pos4, float width, int arrow,
 		int lifetime, int group)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return 0;
+
 	return geometricObjects->AddSpline(pos1, pos2, pos3, pos4, width, arrow, lifetime, group);
 }
 
 int CAICallback::CreateLineFigure(const float3& pos1, const float3& pos2,
 		float width, int arrow, int lifetime, int group)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return 0;
+
 	return geometricObjects->AddLine(pos1, pos2, width, arrow, lifetime, group);
 }
 
 void CAICallback::SetFigureColor(int group, float red, float green, float blue, float alpha)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	geometricObjects->SetColor(group, red, green, blue, alpha);
 }
 
 void CAICallback::DeleteFigureGroup(int group)
 {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	geometricObjects->DeleteGroup(group);
 }
 
@@ -1074,6 +1136,9 @@ void CAICallback::DrawUnit(
 	bool drawBorder,
 	int facing
 ) {
+	if (!AllowUnsyncedCall(__func__))
+		return;
+
 	CUnitDrawerData::TempDrawUnit tdu;
 	tdu.unitDef = unitDefHandler->GetUnitDefByName(unitName);
 
@@ -1491,6 +1556,9 @@ int CAICallback::HandleCommand(int commandId, void* data)
 		case AIHCDebugDrawId: {
 			AIHCDebugDraw* cmdData = static_cast<AIHCDebugDraw*>(data);
 
+			if (!AllowUnsyncedCall("HandleCommand(AIHCDebugDraw)"))
+				return 0;
+
 			switch (cmdData->cmdMode) {
 				case AIHCDebugDraw::AIHC_DEBUGDRAWER_MODE_ADD_GRAPH_POINT: {
 					debugDrawerAI->AddGraphPoint(this->team, cmdData->lineId, cmdData->x, cmdData->y);
@@ -1822,6 +1890,8 @@ const float3* CAICallback::GetStartPos()
 #define AICALLBACK_CALL_LUA(HandleName)                                                               \
 	const char* CAICallback::CallLua ## HandleName(const char* inData, int inSize, size_t* outSize) { \
 		if (lua ## HandleName == nullptr)                                                             \
+			return nullptr;                                                                           \
+		if (!AllowUnsyncedCall(__func__))                                                             \
 			return nullptr;                                                                           \
                                                                                                       \
 		return lua ## HandleName->RecvSkirmishAIMessage(team, inData, inSize, outSize);               \
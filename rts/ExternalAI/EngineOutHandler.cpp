@@ -19,11 +19,19 @@
 #include "Sim/Units/CommandAI/Command.h"
 #include "Sim/Weapons/WeaponDef.h"
 #include "Net/Protocol/NetProtocol.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
+#include "System/Platform/Threading.h"
 #include "System/TimeProfiler.h"
 #include "System/SafeUtil.h"
 
 
+CONFIG(bool, AsyncSkirmishAIUpdates).defaultValue(false).description(
+	"Run the per-frame Update event of native Skirmish AIs on a separate thread, overlapping the "
+	"rest of the engine's frame instead of the simulation. Commands given by the AIs still arrive "
+	"through the network, but drawing and Lua callbacks are ignored while inside the Update event."
+);
+
 CR_BIND(CEngineOutHandler, )
 CR_REG_METADATA(CEngineOutHandler, (
 	CR_IGNORED(hostSkirmishAIs),
@@ -80,7 +88,8 @@ void CEngineOutHandler::Destroy() {
 #define AI_SCOPED_TIMER()           \
 	if (activeSkirmishAIs.empty())  \
 		return;                     \
-	SCOPED_TIMER("AI");
+	SCOPED_TIMER("AI");             \
+	WaitForAsyncUpdate();
 
 #define DO_FOR_SKIRMISH_AIS(FUNC)            \
 	for (uint8_t aiID: activeSkirmishAIs) {  \
@@ -88,6 +97,43 @@ void CEngineOutHandler::Destroy() {
 	}
 
 
+void CEngineOutHandler::Init()
+{
+	activeSkirmishAIs.reserve(16);
+
+	if (!(asyncUpdates = configHandler->GetBool("AsyncSkirmishAIUpdates")))
+		return;
+
+	stopUpdates = false;
+	updateThread = std::move(spring::thread(&CEngineOutHandler::AsyncUpdateLoop, this));
+}
+
+void CEngineOutHandler::Kill()
+{
+	PreDestroy();
+
+	// release leftover active AI's
+	while (!activeSkirmishAIs.empty()) {
+		DestroySkirmishAI(activeSkirmishAIs.back());
+	}
+
+	activeSkirmishAIs.clear();
+
+	if (!updateThread.joinable())
+		return;
+
+	{
+		std::lock_guard<spring::mutex> lock(updateMutex);
+		stopUpdates = true;
+	}
+
+	updateCond.notify_all();
+	updateThread.join();
+
+	asyncUpdates = false;
+}
+
+
 void CEngineOutHandler::PostLoad()
 {
 	AI_SCOPED_TIMER();
@@ -126,11 +172,66 @@ void CEngineOutHandler::Save(std::ostream* s, const uint8_t skirmishAIId) {
 
 
 void CEngineOutHandler::Update() {
+	// handled by StartAsyncUpdate instead
+	if (asyncUpdates)
+		return;
+
 	AI_SCOPED_TIMER();
 	DO_FOR_SKIRMISH_AIS(Update(gs->frameNum))
 }
 
 
+void CEngineOutHandler::StartAsyncUpdate() {
+	if (!asyncUpdates)
+		return;
+
+	AI_SCOPED_TIMER();
+
+	{
+		std::lock_guard<spring::mutex> lock(updateMutex);
+		updateFrame = gs->frameNum;
+		updatePending = true;
+	}
+
+	updateCond.notify_all();
+}
+
+void CEngineOutHandler::WaitForAsyncUpdate() {
+	if (!updatePending)
+		return;
+	// callbacks made by an AI from its Update can reach us again
+	if (IsAsyncUpdateThread())
+		return;
+
+	std::unique_lock<spring::mutex> lock(updateMutex);
+	updateCond.wait(lock, [&]() { return (!updatePending); });
+}
+
+void CEngineOutHandler::AsyncUpdateLoop() {
+	Threading::SetThreadName("skirmishai");
+
+	std::unique_lock<spring::mutex> lock(updateMutex);
+
+	while (true) {
+		updateCond.wait(lock, [&]() { return (updatePending || stopUpdates); });
+
+		if (!updatePending)
+			break;
+
+		lock.unlock();
+
+		// AIs are not thread-safe with respect to each other either, run them in order
+		for (uint8_t aiID: activeSkirmishAIs) {
+			hostSkirmishAIs[aiID].Update(updateFrame);
+		}
+
+		lock.lock();
+		updatePending = false;
+		updateCond.notify_all();
+	}
+}
+
+
 
 // Do only if the unit is not allied, in which case we know
 // everything about it anyway, and do not need to be informed
@@ -487,6 +588,8 @@ bool CEngineOutHandler::SendLuaMessages(int aiTeam, const char* inData, std::vec
 	if (activeSkirmishAIs.empty())
 		return false;
 
+	WaitForAsyncUpdate();
+
 	unsigned int n = 0;
 
 	if (aiTeam != -1) {
@@ -522,6 +625,7 @@ bool CEngineOutHandler::SendLuaMessages(int aiTeam, const char* inData, std::vec
 
 void CEngineOutHandler::CreateSkirmishAI(const uint8_t skirmishAIId) {
 	SCOPED_TIMER("AI");
+	WaitForAsyncUpdate();
 	LOG_L(L_INFO, "[EOH::%s(id=%u)]", __func__, skirmishAIId);
 
 	const SkirmishAIData* aiData = skirmishAIHandler.GetSkirmishAI(skirmishAIId);
@@ -558,6 +662,7 @@ void CEngineOutHandler::CreateSkirmishAI(const uint8_t skirmishAIId) {
 
 void CEngineOutHandler::DestroySkirmishAI(const uint8_t skirmishAIId) {
 	SCOPED_TIMER("AI");
+	WaitForAsyncUpdate();
 	LOG_L(L_INFO, "[EOH::%s(id=%u)]", __func__, skirmishAIId);
 
 	const int teamID = hostSkirmishAIs[skirmishAIId].GetTeamId();
@@ -5,9 +5,11 @@
 
 #include "SkirmishAIWrapper.h"
 #include "System/Object.h"
+#include "System/Threading/SpringThreading.h"
 #include "Sim/Misc/GlobalConstants.h"
 
 #include <array>
+#include <atomic>
 #include <vector>
 #include <string>
 
@@ -31,17 +33,8 @@ public:
 	static void Create();
 	static void Destroy();
 
-	void Init() { activeSkirmishAIs.reserve(16); }
-	void Kill() {
-		PreDestroy();
-
-		// release leftover active AI's
-		while (!activeSkirmishAIs.empty()) {
-			DestroySkirmishAI(activeSkirmishAIs.back());
-		}
-
-		activeSkirmishAIs.clear();
-	}
+	void Init();
+	void Kill();
 
 	void PostLoad();
 	/** Called just before all the units are destroyed. */
@@ -49,6 +42,17 @@ public:
 
 	void Update();
 
+	/**
+	 * With AsyncSkirmishAIUpdates enabled, hands the Update event of the
+	 * frame that was just simulated to a separate thread; Update() is then
+	 * a no-op. Every other entry point first waits for it to finish, as
+	 * must any code that modifies the synced state (see WaitForAsyncUpdate).
+	 */
+	void StartAsyncUpdate();
+	void WaitForAsyncUpdate();
+
+	bool IsAsyncUpdateThread() const { return (asyncUpdates && std::this_thread::get_id() == updateThread.get_id()); }
+
 	/** Group should return false if it doenst want the unit for some reason. */
 	bool UnitAddedToGroup(const CUnit& unit, const CGroup& group);
 	/** No way to refuse giving up a unit. */
@@ -91,7 +95,10 @@ public:
 	 * @see CSkirmishAIHandler::SetLocalKillFlag()
 	 * @see DestroySkirmishAI()
 	 */
-	void BlockSkirmishAIEvents(const uint8_t skirmishAIId) { hostSkirmishAIs[skirmishAIId].SetBlockEvents(true); }
+	void BlockSkirmishAIEvents(const uint8_t skirmishAIId) {
+		WaitForAsyncUpdate();
+		hostSkirmishAIs[skirmishAIId].SetBlockEvents(true);
+	}
 	/**
 	 * Destructs a local Skirmish AI for real.
 	 * Do not call this if you want to kill a local AI, but use
@@ -105,6 +112,9 @@ public:
 	void Load(std::istream* s, const uint8_t skirmishAIId);
 	void Save(std::ostream* s, const uint8_t skirmishAIId);
 
+private:
+	void AsyncUpdateLoop();
+
 private:
 	/// Contains all local Skirmish AIs, indexed by their ID
 	std::array<CSkirmishAIWrapper, MAX_AIS > hostSkirmishAIs;
@@ -116,6 +126,17 @@ private:
 	std::array<std::vector<uint8_t>, MAX_TEAMS> teamSkirmishAIs;
 
 	std::vector<uint8_t> activeSkirmishAIs;
+
+	spring::thread updateThread;
+	spring::mutex updateMutex;
+	spring::condition_variable updateCond;
+
+	int updateFrame = 0;
+
+	bool asyncUpdates = false;
+	bool stopUpdates = false;
+
+	std::atomic<bool> updatePending = {false};
 };
 
 #define eoh CEngineOutHandler::GetInstance()
@@ -9,6 +9,21 @@
 extern "C" {
 #endif
 
+/**
+ * Fields that can be requested per unit through setUnitsDataQuery() and
+ * getUnitsData(). They are written to the data array in the order of their
+ * bits here, all as floats; position and velocity take three values each.
+ */
+enum UnitDataField {
+	UNIT_DATA_POS            = 1 << 0, // x, y, z
+	UNIT_DATA_VEL            = 1 << 1, // x, y, z
+	UNIT_DATA_HEALTH         = 1 << 2,
+	UNIT_DATA_MAX_HEALTH     = 1 << 3,
+	UNIT_DATA_BUILD_PROGRESS = 1 << 4,
+	UNIT_DATA_TEAM           = 1 << 5,
+	UNIT_DATA_DEF            = 1 << 6, // unit-def ID
+};
+
 
 /**
  * @brief Skirmish AI Callback function pointers.
@@ -1557,6 +1572,31 @@ struct SSkirmishAICallback {
 	 */
 	int               (CALLING_CONV *Map_getHeightMap)(int skirmishAIId, float* heights, int heights_sizeMax); //$ ARRAY:heights
 
+	/**
+	 * Incremented whenever the heightmap (and with it the slope map) changes,
+	 * eg. through terraforming or explosions.
+	 * @see getHeightMapDirtyRect()
+	 */
+	int               (CALLING_CONV *Map_getHeightMapUpdateNum)(int skirmishAIId);
+
+	/**
+	 * Returns the area of the heightmap changed after the update with the given
+	 * number (as returned by getHeightMapUpdateNum()) as 4 values:
+	 * x1, z1, x2, z2 in heightmap squares, with x2 and z2 exclusive.
+	 * Nothing changed if x1 >= x2; the whole map is returned if the changes
+	 * since then are not remembered anymore.
+	 * Lets an AI copy only the changed part with getHeightMapRect() instead
+	 * of the whole map.
+	 */
+	int               (CALLING_CONV *Map_getHeightMapDirtyRect)(int skirmishAIId, int sinceUpdateNum, int* rect, int rect_sizeMax); //$ ARRAY:rect
+
+	/**
+	 * Like getHeightMap(), but only the squares x1 <= x < x2, z1 <= z < z2,
+	 * row by row; the area is clamped to the map.
+	 * @return the number of values written, or required if heights is NULL
+	 */
+	int               (CALLING_CONV *Map_getHeightMapRect)(int skirmishAIId, int x1, int z1, int x2, int z2, float* heights, int heights_sizeMax); //$ ARRAY:heights
+
 	/**
 	 * Returns the height for the corners of the squares.
 	 * This is the same like the drawn map.
@@ -1588,6 +1628,14 @@ struct SSkirmishAICallback {
 	 */
 	int               (CALLING_CONV *Map_getSlopeMap)(int skirmishAIId, float* slopes, int slopes_sizeMax); //$ ARRAY:slopes
 
+	/**
+	 * Like getSlopeMap(), but only the squares x1 <= x < x2, z1 <= z < z2
+	 * (in slope map squares, ie. half the heightmap ones), row by row.
+	 * @see getHeightMapDirtyRect()
+	 * @see getHeightMapRect()
+	 */
+	int               (CALLING_CONV *Map_getSlopeMapRect)(int skirmishAIId, int x1, int z1, int x2, int z2, float* slopes, int slopes_sizeMax); //$ ARRAY:slopes
+
 	/**
 	 * @brief the level of sight map
 	 * mapDims.mapx >> losMipLevel
@@ -1607,6 +1655,29 @@ struct SSkirmishAICallback {
 	 */
 	int               (CALLING_CONV *Map_getLosMap)(int skirmishAIId, int* losValues, int losValues_sizeMax); //$ ARRAY:losValues
 
+	/**
+	 * Incremented whenever the LOS map of any ally-team changes.
+	 * @see getLosMapDirtyRect()
+	 */
+	int               (CALLING_CONV *Map_getLosMapUpdateNum)(int skirmishAIId);
+
+	/**
+	 * Returns the area of the LOS map changed after the update with the given
+	 * number (as returned by getLosMapUpdateNum()) as 4 values:
+	 * x1, z1, x2, z2 in LOS map squares, with x2 and z2 exclusive.
+	 * Nothing changed if x1 >= x2; the whole map is returned if the changes
+	 * since then are not remembered anymore.
+	 * @see getHeightMapDirtyRect()
+	 */
+	int               (CALLING_CONV *Map_getLosMapDirtyRect)(int skirmishAIId, int sinceUpdateNum, int* rect, int rect_sizeMax); //$ ARRAY:rect
+
+	/**
+	 * Like getLosMap(), but only the squares x1 <= x < x2, z1 <= z < z2,
+	 * row by row; the area is clamped to the map.
+	 * @return the number of values written, or required if losValues is NULL
+	 */
+	int               (CALLING_CONV *Map_getLosMapRect)(int skirmishAIId, int x1, int z1, int x2, int z2, int* losValues, int losValues_sizeMax); //$ ARRAY:losValues
+
 	/**
 	 * @brief the level of sight map
 	 * mapDims.mapx >> airMipLevel
@@ -1621,6 +1692,15 @@ struct SSkirmishAICallback {
 	 */
 	int               (CALLING_CONV *Map_getRadarMap)(int skirmishAIId, int* radarValues, int radarValues_sizeMax); //$ ARRAY:radarValues
 
+	/** @see getLosMapUpdateNum() */
+	int               (CALLING_CONV *Map_getRadarMapUpdateNum)(int skirmishAIId);
+
+	/** @see getLosMapDirtyRect() */
+	int               (CALLING_CONV *Map_getRadarMapDirtyRect)(int skirmishAIId, int sinceUpdateNum, int* rect, int rect_sizeMax); //$ ARRAY:rect
+
+	/** @see getLosMapRect() */
+	int               (CALLING_CONV *Map_getRadarMapRect)(int skirmishAIId, int x1, int z1, int x2, int z2, int* radarValues, int radarValues_sizeMax); //$ ARRAY:radarValues
+
 	/** @see getRadarMap() */
 	int               (CALLING_CONV *Map_getSonarMap)(int skirmishAIId, int* sonarValues, int sonarValues_sizeMax); //$ ARRAY:sonarValues
 
@@ -2273,6 +2353,32 @@ struct SSkirmishAICallback {
 
 	bool              (CALLING_CONV *Debug_GraphDrawer_isEnabled)(int skirmishAIId);
 
+	/**
+	 * Sets the units and fields (a combination of UNIT_DATA_* bits) returned
+	 * by getUnitsData(), until the next call to this function.
+	 * Lets an AI fetch the state of many units with one call, instead of one
+	 * call per unit and field.
+	 */
+	void              (CALLING_CONV *setUnitsDataQuery)(int skirmishAIId, int* unitIds, int unitIds_size, int fields); //$ ARRAY:unitIds
+
+	/**
+	 * Fills data with the fields set by setUnitsDataQuery(), unit after unit
+	 * in query order; each field as its single getter (eg. Unit_getHealth)
+	 * would return it, so units out of LOS yield the same default values.
+	 * @return the number of floats written, or the number required by the
+	 *         whole query if data is NULL
+	 */
+	int               (CALLING_CONV *getUnitsData)(int skirmishAIId, float* data, int data_sizeMax); //$ ARRAY:data
+
+	/**
+	 * Returns the units whose position, health, build progress or team changed
+	 * since the previous frame this was called in, including units that came
+	 * into or went out of LOS and radar (or died) since then.
+	 * The first call returns all visible units; repeated calls in one frame
+	 * return the same units.
+	 */
+	int               (CALLING_CONV *getChangedUnits)(int skirmishAIId, int* unitIds, int unitIds_sizeMax); //$ FETCHER:MULTI:IDs:Unit:unitIds
+
 };
 
 #if	defined(__cplusplus)
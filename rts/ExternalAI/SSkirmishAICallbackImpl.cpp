@@ -36,6 +36,7 @@
 #include "Sim/Weapons/Weapon.h"
 #include "Sim/Weapons/PlasmaRepulser.h"
 #include "Sim/Misc/CategoryHandler.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/Resource.h"
 #include "Sim/Misc/ResourceHandler.h"
 #include "Sim/Misc/ResourceMapAnalyzer.h"
@@ -59,6 +60,34 @@ static std::array<int, MAX_AIS> AI_TEAM_IDS = {{-1}};
 static std::vector<PointMarker> AI_TMP_POINT_MARKERS[MAX_AIS];
 static std::vector<LineMarker> AI_TMP_LINE_MARKERS[MAX_AIS];
 
+// per-AI state of setUnitsDataQuery and getChangedUnits
+struct UnitsDataQuery {
+	std::vector<int> unitIds;
+	int fields = 0;
+};
+
+struct ChangedUnitsTracker {
+	struct UnitState {
+		bool operator != (const UnitState& s) const {
+			return (pos.x != s.pos.x || pos.y != s.pos.y || pos.z != s.pos.z || health != s.health || buildProgress != s.buildProgress || team != s.team);
+		}
+
+		float3 pos;
+		float health;
+		float buildProgress;
+		int team;
+		int lastSeenFrame;
+	};
+
+	spring::unordered_map<int, UnitState> units;
+	std::vector<int> changedIds;
+
+	int lastUpdateFrame = -1;
+};
+
+static std::array<UnitsDataQuery, MAX_AIS> AI_UNITS_DATA_QUERIES;
+static std::array<ChangedUnitsTracker, MAX_AIS> AI_CHANGED_UNITS;
+
 static constexpr size_t MAX_NUM_MARKERS = 16384;
 
 
@@ -207,14 +236,13 @@ static float getRulesParamFloatValueByName(
 	float defaultValue
 ) {
 	float value = defaultValue;
-	const std::string key(rulesParamName);
-	const auto it = params.find(key);
+	const LuaRulesParams::Param* param = params.Find(rulesParamName);
 
-	if (it == params.end())
+	if (param == nullptr)
 		return value;
 
-	if (modParamIsVisible(it->second, losMask))
-		value = it->second.valueInt;
+	if (modParamIsVisible(*param, losMask))
+		value = param->valueInt;
 
 	return value;
 }
@@ -226,14 +254,13 @@ static const char* getRulesParamStringValueByName(
 	const char* defaultValue
 ) {
 	const char* value = defaultValue;
-	const std::string key(rulesParamName);
-	const auto it = params.find(key);
+	const LuaRulesParams::Param* param = params.Find(rulesParamName);
 
-	if (it == params.end())
+	if (param == nullptr)
 		return value;
 
-	if (modParamIsVisible(it->second, losMask))
-		value = it->second.valueString.c_str();
+	if (modParamIsVisible(*param, losMask))
+		value = param->valueString.c_str();
 
 	return value;
 }
@@ -1911,6 +1938,60 @@ EXPORT(int) skirmishAiCallback_Map_getHeightMap(int skirmishAIId, float* heights
 	return heightsSize;
 }
 
+// copies the squares x1 <= x < x2, z1 <= z < z2 (clamped) of a row-major map, row by row
+template<typename SrcType, typename DstType>
+static int copyMapRect(const SrcType* srcMap, const int2 mapSize, int x1, int z1, int x2, int z2, DstType* dst, int dstMaxSize) {
+	x1 = Clamp(x1, 0, mapSize.x);
+	z1 = Clamp(z1, 0, mapSize.y);
+	x2 = Clamp(x2, x1, mapSize.x);
+	z2 = Clamp(z2, z1, mapSize.y);
+
+	if (dst == nullptr)
+		return ((x2 - x1) * (z2 - z1));
+
+	int numValues = 0;
+
+	for (int z = z1; z < z2; z++) {
+		for (int x = x1; x < x2; x++) {
+			if (numValues >= dstMaxSize)
+				return numValues;
+
+			dst[numValues++] = srcMap[z * mapSize.x + x];
+		}
+	}
+
+	return numValues;
+}
+
+// writes {x1, z1, x2, z2} of a dirty rectangle, or of the whole map if it is not <known>
+static int copyDirtyRect(bool known, const SRectangle& dirtyRect, const int2 mapSize, int* rect, int rectMaxSize) {
+	if (rect == nullptr)
+		return 4;
+
+	const SRectangle r = known? dirtyRect: SRectangle(0, 0, mapSize.x, mapSize.y);
+	const int values[4] = {r.x1, r.z1, r.x2, r.z2};
+	const int numValues = Clamp(rectMaxSize, 0, 4);
+
+	std::copy(values, values + numValues, rect);
+	return numValues;
+}
+
+EXPORT(int) skirmishAiCallback_Map_getHeightMapUpdateNum(int skirmishAIId) {
+	return readMap->GetHeightMapUpdateNum();
+}
+
+EXPORT(int) skirmishAiCallback_Map_getHeightMapDirtyRect(int skirmishAIId, int sinceUpdateNum, int* rect, int rectMaxSize) {
+	SRectangle dirtyRect;
+
+	const bool known = readMap->GetHeightMapDirtyRect(sinceUpdateNum, dirtyRect);
+
+	return copyDirtyRect(known, dirtyRect, {mapDims.mapx, mapDims.mapy}, rect, rectMaxSize);
+}
+
+EXPORT(int) skirmishAiCallback_Map_getHeightMapRect(int skirmishAIId, int x1, int z1, int x2, int z2, float* heights, int heightsMaxSize) {
+	return copyMapRect(GetCallBack(skirmishAIId)->GetHeightMap(), {mapDims.mapx, mapDims.mapy}, x1, z1, x2, z2, heights, heightsMaxSize);
+}
+
 EXPORT(int) skirmishAiCallback_Map_getCornersHeightMap(int skirmishAIId,
 		float* cornerHeights, int cornerHeightsMaxSize) {
 
@@ -1957,6 +2038,10 @@ EXPORT(int) skirmishAiCallback_Map_getSlopeMap(int skirmishAIId,
 	return slopesSize;
 }
 
+EXPORT(int) skirmishAiCallback_Map_getSlopeMapRect(int skirmishAIId, int x1, int z1, int x2, int z2, float* slopes, int slopesMaxSize) {
+	return copyMapRect(GetCallBack(skirmishAIId)->GetSlopeMap(), {mapDims.hmapx, mapDims.hmapy}, x1, z1, x2, z2, slopes, slopesMaxSize);
+}
+
 #define GET_SENSOR_MAP(name, sensor)	\
 EXPORT(int) skirmishAiCallback_Map_get##name##Map(int skirmishAIId,	\
 		int* sensor##Values, int sensor##ValuesMaxSize) {	\
@@ -1999,6 +2084,37 @@ GET_SENSOR_MAP(Jammer, jammer)
 // skirmishAiCallback_Map_getSonarJammerMap
 GET_SENSOR_MAP(SonarJammer, sonarJammer)
 
+#define GET_SENSOR_MAP_UPDATES(name, sensor)	\
+EXPORT(int) skirmishAiCallback_Map_get##name##MapUpdateNum(int skirmishAIId) {	\
+	return losHandler->sensor.updateNum;	\
+}	\
+\
+EXPORT(int) skirmishAiCallback_Map_get##name##MapDirtyRect(int skirmishAIId,	\
+		int sinceUpdateNum, int* rect, int rectMaxSize) {	\
+\
+	const CLosMap& losMap = losHandler->sensor.losMaps[teamHandler.AllyTeam(AI_TEAM_IDS[skirmishAIId])];	\
+\
+	SRectangle dirtyRect;	\
+\
+	const bool known = losMap.GetDirtyRect(sinceUpdateNum, dirtyRect);	\
+\
+	return copyDirtyRect(known, dirtyRect, losHandler->sensor.size, rect, rectMaxSize);	\
+}	\
+\
+EXPORT(int) skirmishAiCallback_Map_get##name##MapRect(int skirmishAIId,	\
+		int x1, int z1, int x2, int z2, int* sensor##Values, int sensor##ValuesMaxSize) {	\
+\
+	const CLosMap& losMap = losHandler->sensor.losMaps[teamHandler.AllyTeam(AI_TEAM_IDS[skirmishAIId])];	\
+\
+	return copyMapRect(&losMap.front(), losHandler->sensor.size, x1, z1, x2, z2, sensor##Values, sensor##ValuesMaxSize);	\
+}
+
+// skirmishAiCallback_Map_getLosMap{UpdateNum,DirtyRect,Rect}
+GET_SENSOR_MAP_UPDATES(Los, los)
+
+// skirmishAiCallback_Map_getRadarMap{UpdateNum,DirtyRect,Rect}
+GET_SENSOR_MAP_UPDATES(Radar, radar)
+
 EXPORT(int) skirmishAiCallback_Map_getResourceMapRaw(
 	int skirmishAIId,
 	int resourceId,
@@ -3976,6 +4092,125 @@ EXPORT(int) skirmishAiCallback_getTeamUnits(int skirmishAIId, int* unitIds, int
 	return a;
 }
 
+static int getUnitsDataStride(int fields) {
+	int stride = 0;
+
+	stride += (((fields & UNIT_DATA_POS           ) != 0) * 3);
+	stride += (((fields & UNIT_DATA_VEL           ) != 0) * 3);
+	stride += (((fields & UNIT_DATA_HEALTH        ) != 0)    );
+	stride += (((fields & UNIT_DATA_MAX_HEALTH    ) != 0)    );
+	stride += (((fields & UNIT_DATA_BUILD_PROGRESS) != 0)    );
+	stride += (((fields & UNIT_DATA_TEAM          ) != 0)    );
+	stride += (((fields & UNIT_DATA_DEF           ) != 0)    );
+
+	return stride;
+}
+
+EXPORT(void) skirmishAiCallback_setUnitsDataQuery(int skirmishAIId, int* unitIds, int unitIdsSize, int fields) {
+	UnitsDataQuery& query = AI_UNITS_DATA_QUERIES[skirmishAIId];
+
+	query.unitIds.assign(unitIds, unitIds + std::max(unitIdsSize, 0));
+	query.fields = fields;
+}
+
+EXPORT(int) skirmishAiCallback_getUnitsData(int skirmishAIId, float* data, int dataMaxSize) {
+	const UnitsDataQuery& query = AI_UNITS_DATA_QUERIES[skirmishAIId];
+
+	const int stride = getUnitsDataStride(query.fields);
+	const int fields = query.fields;
+
+	if (stride == 0)
+		return 0;
+	if (data == nullptr)
+		return (query.unitIds.size() * stride);
+
+	// only write whole units
+	const int numUnits = std::min(int(query.unitIds.size()), dataMaxSize / stride);
+
+	for (int i = 0; i < numUnits; i++) {
+		const int unitId = query.unitIds[i];
+
+		float* unitData = &data[i * stride];
+
+		if ((fields & UNIT_DATA_POS) != 0) {
+			skirmishAiCallback_Unit_getPos(skirmishAIId, unitId, unitData);
+			unitData += 3;
+		}
+		if ((fields & UNIT_DATA_VEL) != 0) {
+			skirmishAiCallback_Unit_getVel(skirmishAIId, unitId, unitData);
+			unitData += 3;
+		}
+
+		if ((fields & UNIT_DATA_HEALTH        ) != 0) *(unitData++) = skirmishAiCallback_Unit_getHealth(skirmishAIId, unitId);
+		if ((fields & UNIT_DATA_MAX_HEALTH    ) != 0) *(unitData++) = skirmishAiCallback_Unit_getMaxHealth(skirmishAIId, unitId);
+		if ((fields & UNIT_DATA_BUILD_PROGRESS) != 0) *(unitData++) = skirmishAiCallback_Unit_getBuildProgress(skirmishAIId, unitId);
+		if ((fields & UNIT_DATA_TEAM          ) != 0) *(unitData++) = skirmishAiCallback_Unit_getTeam(skirmishAIId, unitId);
+		if ((fields & UNIT_DATA_DEF           ) != 0) *(unitData++) = skirmishAiCallback_Unit_getDef(skirmishAIId, unitId);
+	}
+
+	return (numUnits * stride);
+}
+
+static void updateChangedUnits(int skirmishAIId, ChangedUnitsTracker& tracker) {
+	const int teamId = AI_TEAM_IDS[skirmishAIId];
+	const int allyTeamId = teamHandler.AllyTeam(teamId);
+
+	const bool cheating = skirmishAiCallback_Cheats_isEnabled(skirmishAIId);
+
+	tracker.changedIds.clear();
+
+	for (const CUnit* u: unitHandler.GetActiveUnits()) {
+		if (!cheating && !teamHandler.AlliedTeams(u->team, teamId) && (u->losStatus[allyTeamId] & (LOS_INLOS | LOS_INRADAR)) == 0)
+			continue;
+
+		ChangedUnitsTracker::UnitState state;
+
+		skirmishAiCallback_Unit_getPos(skirmishAIId, u->id, &state.pos.x);
+
+		state.health = skirmishAiCallback_Unit_getHealth(skirmishAIId, u->id);
+		state.buildProgress = skirmishAiCallback_Unit_getBuildProgress(skirmishAIId, u->id);
+		state.team = skirmishAiCallback_Unit_getTeam(skirmishAIId, u->id);
+		state.lastSeenFrame = gs->frameNum;
+
+		const auto iter = tracker.units.find(u->id);
+
+		if (iter == tracker.units.end() || iter->second != state)
+			tracker.changedIds.push_back(u->id);
+
+		tracker.units[u->id] = state;
+	}
+
+	// units that died or left LOS and radar since the last update
+	for (auto iter = tracker.units.begin(); iter != tracker.units.end(); ) {
+		if (iter->second.lastSeenFrame == gs->frameNum) {
+			++iter;
+			continue;
+		}
+
+		tracker.changedIds.push_back(iter->first);
+		iter = tracker.units.erase(iter);
+	}
+
+	std::sort(tracker.changedIds.begin(), tracker.changedIds.end());
+}
+
+EXPORT(int) skirmishAiCallback_getChangedUnits(int skirmishAIId, int* unitIds, int unitIdsMaxSize) {
+	ChangedUnitsTracker& tracker = AI_CHANGED_UNITS[skirmishAIId];
+
+	// the delta is taken once per frame, so the size and fill calls of a wrapper agree
+	if (tracker.lastUpdateFrame != gs->frameNum) {
+		updateChangedUnits(skirmishAIId, tracker);
+		tracker.lastUpdateFrame = gs->frameNum;
+	}
+
+	const int numIds = std::min(int(tracker.changedIds.size()), unitIdsMaxSize);
+
+	if (unitIds != nullptr)
+		std::copy(tracker.changedIds.begin(), tracker.changedIds.begin() + numIds, unitIds);
+
+	return numIds;
+}
+
 
 //########### BEGINN Team
 EXPORT(bool) skirmishAiCallback_Team_hasAIController(int skirmishAIId, int teamId) {
@@ -5461,13 +5696,23 @@ static void skirmishAiCallback_init(SSkirmishAICallback* callback) {
 	callback->Map_getWidth = &skirmishAiCallback_Map_getWidth;
 	callback->Map_getHeight = &skirmishAiCallback_Map_getHeight;
 	callback->Map_getHeightMap = &skirmishAiCallback_Map_getHeightMap;
+	callback->Map_getHeightMapUpdateNum = &skirmishAiCallback_Map_getHeightMapUpdateNum;
+	callback->Map_getHeightMapDirtyRect = &skirmishAiCallback_Map_getHeightMapDirtyRect;
+	callback->Map_getHeightMapRect = &skirmishAiCallback_Map_getHeightMapRect;
 	callback->Map_getCornersHeightMap = &skirmishAiCallback_Map_getCornersHeightMap;
 	callback->Map_getMinHeight = &skirmishAiCallback_Map_getMinHeight;
 	callback->Map_getMaxHeight = &skirmishAiCallback_Map_getMaxHeight;
 	callback->Map_getSlopeMap = &skirmishAiCallback_Map_getSlopeMap;
+	callback->Map_getSlopeMapRect = &skirmishAiCallback_Map_getSlopeMapRect;
 	callback->Map_getLosMap = &skirmishAiCallback_Map_getLosMap;
+	callback->Map_getLosMapUpdateNum = &skirmishAiCallback_Map_getLosMapUpdateNum;
+	callback->Map_getLosMapDirtyRect = &skirmishAiCallback_Map_getLosMapDirtyRect;
+	callback->Map_getLosMapRect = &skirmishAiCallback_Map_getLosMapRect;
 	callback->Map_getAirLosMap = &skirmishAiCallback_Map_getAirLosMap;
 	callback->Map_getRadarMap = &skirmishAiCallback_Map_getRadarMap;
+	callback->Map_getRadarMapUpdateNum = &skirmishAiCallback_Map_getRadarMapUpdateNum;
+	callback->Map_getRadarMapDirtyRect = &skirmishAiCallback_Map_getRadarMapDirtyRect;
+	callback->Map_getRadarMapRect = &skirmishAiCallback_Map_getRadarMapRect;
 	callback->Map_getSonarMap = &skirmishAiCallback_Map_getSonarMap;
 	callback->Map_getSeismicMap = &skirmishAiCallback_Map_getSeismicMap;
 	callback->Map_getJammerMap = &skirmishAiCallback_Map_getJammerMap;
@@ -5655,6 +5900,9 @@ static void skirmishAiCallback_init(SSkirmishAICallback* callback) {
 	callback->Unit_Weapon_isShieldEnabled = &skirmishAiCallback_Unit_Weapon_isShieldEnabled;
 	callback->Unit_Weapon_getShieldPower = &skirmishAiCallback_Unit_Weapon_getShieldPower;
 	callback->Debug_GraphDrawer_isEnabled = &skirmishAiCallback_Debug_GraphDrawer_isEnabled;
+	callback->setUnitsDataQuery = &skirmishAiCallback_setUnitsDataQuery;
+	callback->getUnitsData = &skirmishAiCallback_getUnitsData;
+	callback->getChangedUnits = &skirmishAiCallback_getChangedUnits;
 }
 
 SSkirmishAICallback* skirmishAiCallback_GetInstance(CSkirmishAIWrapper* ai)
@@ -5676,6 +5924,9 @@ void skirmishAiCallback_Release(const CSkirmishAIWrapper* ai) {
 
 	AI_CHEAT_FLAGS[ai->GetSkirmishAIID()] = {false, false};
 	AI_TEAM_IDS[ai->GetSkirmishAIID()] = -1;
+
+	AI_UNITS_DATA_QUERIES[ai->GetSkirmishAIID()] = {};
+	AI_CHANGED_UNITS[ai->GetSkirmishAIID()] = {};
 }
 
 void skirmishAiCallback_BlockOrders(const CSkirmishAIWrapper* ai)
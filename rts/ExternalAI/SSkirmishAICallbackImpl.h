@@ -888,6 +888,12 @@ EXPORT(int              ) skirmishAiCallback_Map_getHeight(int skirmishAIId);
 
 EXPORT(int              ) skirmishAiCallback_Map_getHeightMap(int skirmishAIId, float* heights, int heights_sizeMax);
 
+EXPORT(int              ) skirmishAiCallback_Map_getHeightMapUpdateNum(int skirmishAIId);
+
+EXPORT(int              ) skirmishAiCallback_Map_getHeightMapDirtyRect(int skirmishAIId, int sinceUpdateNum, int* rect, int rect_sizeMax);
+
+EXPORT(int              ) skirmishAiCallback_Map_getHeightMapRect(int skirmishAIId, int x1, int z1, int x2, int z2, float* heights, int heights_sizeMax);
+
 EXPORT(int              ) skirmishAiCallback_Map_getCornersHeightMap(int skirmishAIId, float* cornerHeights, int cornerHeights_sizeMax);
 
 EXPORT(float            ) skirmishAiCallback_Map_getMinHeight(int skirmishAIId);
@@ -896,12 +902,26 @@ EXPORT(float            ) skirmishAiCallback_Map_getMaxHeight(int skirmishAIId);
 
 EXPORT(int              ) skirmishAiCallback_Map_getSlopeMap(int skirmishAIId, float* slopes, int slopes_sizeMax);
 
+EXPORT(int              ) skirmishAiCallback_Map_getSlopeMapRect(int skirmishAIId, int x1, int z1, int x2, int z2, float* slopes, int slopes_sizeMax);
+
 EXPORT(int              ) skirmishAiCallback_Map_getLosMap(int skirmishAIId, int* losValues, int losValues_sizeMax);
 
+EXPORT(int              ) skirmishAiCallback_Map_getLosMapUpdateNum(int skirmishAIId);
+
+EXPORT(int              ) skirmishAiCallback_Map_getLosMapDirtyRect(int skirmishAIId, int sinceUpdateNum, int* rect, int rect_sizeMax);
+
+EXPORT(int              ) skirmishAiCallback_Map_getLosMapRect(int skirmishAIId, int x1, int z1, int x2, int z2, int* losValues, int losValues_sizeMax);
+
 EXPORT(int              ) skirmishAiCallback_Map_getAirLosMap(int skirmishAIId, int* airLosValues, int airLosValues_sizeMax);
 
 EXPORT(int              ) skirmishAiCallback_Map_getRadarMap(int skirmishAIId, int* radarValues, int radarValues_sizeMax);
 
+EXPORT(int              ) skirmishAiCallback_Map_getRadarMapUpdateNum(int skirmishAIId);
+
+EXPORT(int              ) skirmishAiCallback_Map_getRadarMapDirtyRect(int skirmishAIId, int sinceUpdateNum, int* rect, int rect_sizeMax);
+
+EXPORT(int              ) skirmishAiCallback_Map_getRadarMapRect(int skirmishAIId, int x1, int z1, int x2, int z2, int* radarValues, int radarValues_sizeMax);
+
 EXPORT(int              ) skirmishAiCallback_Map_getSonarMap(int skirmishAIId, int* sonarValues, int sonarValues_sizeMax);
 
 EXPORT(int              ) skirmishAiCallback_Map_getSeismicMap(int skirmishAIId, int* seismicValues, int seismicValues_sizeMax);
@@ -1307,6 +1327,12 @@ EXPORT(float            ) skirmishAiCallback_Unit_Weapon_getShieldPower(int skir
 
 EXPORT(bool             ) skirmishAiCallback_Debug_GraphDrawer_isEnabled(int skirmishAIId);
 
+EXPORT(void             ) skirmishAiCallback_setUnitsDataQuery(int skirmishAIId, int* unitIds, int unitIds_size, int fields);
+
+EXPORT(int              ) skirmishAiCallback_getUnitsData(int skirmishAIId, float* data, int data_sizeMax);
+
+EXPORT(int              ) skirmishAiCallback_getChangedUnits(int skirmishAIId, int* unitIds, int unitIds_sizeMax);
+
 #if	defined(__cplusplus)
 } // extern "C"
 #endif
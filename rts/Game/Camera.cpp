@@ -730,6 +730,22 @@ bool CCamera::Frustum::IntersectSphere(const float3& cp, const float4& sp) const
 	return !(vec.dot(planes[FRUSTUM_PLANE_BCK]) > (zwPlaneOffsets[1] + sp.w));
 }
 
+float CCamera::Frustum::GetSphereCullRadius(const float3& cp, const float3& p) const
+{
+	// same planes as IntersectSphere, solved for the radius
+	const float3 vec = p - cp;
+
+	const float xyPlaneOffsets[2] = {scales.x, scales.y};
+
+	float radius = vec.dot(planes[FRUSTUM_PLANE_BCK]) - scales.w;
+
+	for (unsigned int i = FRUSTUM_PLANE_LFT; i < FRUSTUM_PLANE_FRN; i++) {
+		radius = std::max(radius, vec.dot(planes[i]) - xyPlaneOffsets[i >> 1]);
+	}
+
+	return radius;
+}
+
 bool CCamera::Frustum::IntersectAABB(const AABB& b) const
 {
 	// edge axes and normals are identical for AABBs
@@ -54,6 +54,8 @@ public:
 	struct Frustum {
 	public:
 		bool IntersectSphere(const float3& cp, const float4& sp) const;
+		// smallest radius for which IntersectSphere(cp, {p, radius}) holds
+		float GetSphereCullRadius(const float3& cp, const float3& p) const;
 		bool IntersectAABB(const AABB& b) const;
 
 	public:
@@ -117,6 +119,8 @@ public:
 	float3 CalcWindowCoordinates(const float3& objPos) const;
 
 	bool InView(const float3& point, float radius = 0.0f) const { return (frustum.IntersectSphere(pos, {point, radius})); }
+	/// InView(point, r) is true for all r >= GetInViewRadius(point)
+	float GetInViewRadius(const float3& point) const { return (frustum.GetSphereCullRadius(pos, point)); }
 	bool InView(const float3& mins, const float3& maxs) const { return (InView(AABB{mins, maxs})); }
 	bool InView(const AABB& aabb) const { return (InView(aabb.CalcCenter(), aabb.CalcRadius()) && frustum.IntersectAABB(aabb)); }
 
@@ -19,6 +19,9 @@ CONFIG(int, HostPortDefault).defaultValue(8452).minimumValue(0).maximumValue(655
 ClientSetup::ClientSetup()
 	: hostIP(configHandler->GetString("HostIPDefault"))
 	, hostPort(configHandler->GetInt("HostPortDefault"))
+	, relayHostPort(configHandler->GetInt("HostPortDefault"))
+	, demoStartFrame(0)
+	, demoKeyframe(-1)
 	, isHost(false)
 {
 }
@@ -45,6 +48,8 @@ void ClientSetup::LoadFromStartScript(const std::string& setup)
 	// Technical parameters
 	file.GetDef(hostIP,       hostIP, "GAME\\HostIP");
 	file.GetDef(hostPort,     IntToString(hostPort), "GAME\\HostPort");
+	file.GetDef(relayHostIP,   "", "GAME\\RelayHostIP");
+	file.GetDef(relayHostPort, IntToString(relayHostPort), "GAME\\RelayHostPort");
 
 	file.GetDef(myPlayerName, "", "GAME\\MyPlayerName");
 	file.GetDef(myPasswd,     "", "GAME\\MyPasswd");
@@ -61,6 +66,7 @@ void ClientSetup::LoadFromStartScript(const std::string& setup)
 	std::string sourceport;
 	std::string autohostip;
 	std::string autohostport;
+	std::string autohosttransport;
 
 	if (file.SGetValue(sourceport, "GAME\\SourcePort"))
 		configHandler->SetString("SourcePort", sourceport, true);
@@ -71,6 +77,10 @@ void ClientSetup::LoadFromStartScript(const std::string& setup)
 	if (file.SGetValue(autohostport, "GAME\\AutohostPort"))
 		configHandler->SetString("AutohostPort", autohostport, true);
 
+	if (file.SGetValue(autohosttransport, "GAME\\AutohostTransport"))
+		configHandler->SetString("AutohostTransport", autohosttransport, true);
+
 	file.GetDef(saveFile, "", "GAME\\SaveFile");
 	file.GetDef(demoFile, "", "GAME\\DemoFile");
+	file.GetDef(demoStartFrame, "0", "GAME\\DemoStartFrame");
 }
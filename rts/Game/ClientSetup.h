@@ -27,6 +27,16 @@ public:
 	//! if this client is the server player, the port over which we accept incoming connections
 	int hostPort;
 
+	//! if non-empty, the (dedicated) server relays the game hosted at this address to its own spectators
+	//! instead of hosting one; it joins upstream as a spectator using myPlayerName and myPasswd
+	std::string relayHostIP;
+	int relayHostPort;
+
+	//! if positive, demo playback starts from the last keyframe before this frame and skips ahead to it
+	int demoStartFrame;
+	//! index of the keyframe the loaded game state was taken from, set by PreGame (-1 if none)
+	int demoKeyframe;
+
 	bool isHost;
 };
 
@@ -36,6 +36,7 @@
 #include "Rendering/Env/MapRendering.h"
 #include "Rendering/Fonts/CFontTexture.h"
 #include "Rendering/Fonts/glFont.h"
+#include "Rendering/GL/GPUTimerQueries.h"
 #include "Rendering/CommandDrawer.h"
 #include "Rendering/LineDrawer.h"
 #include "Rendering/GlobalRendering.h"
@@ -48,7 +49,10 @@
 #include "Rendering/Units/UnitDrawer.h"
 #include "Rendering/UniformConstants.h"
 #include "Rendering/Map/InfoTexture/IInfoTextureHandler.h"
+#include "Rendering/Models/IModelParser.h"
+#include "Rendering/Textures/3DOTextureHandler.h"
 #include "Rendering/Textures/NamedTextures.h"
+#include "Rendering/Textures/S3OTextureHandler.h"
 #include "Lua/LuaGaia.h"
 #include "Lua/LuaHandle.h"
 #include "Lua/LuaInputReceiver.h"
@@ -66,6 +70,7 @@
 #include "Sim/Features/FeatureDef.h"
 #include "Sim/Features/FeatureDefHandler.h"
 #include "Sim/Features/FeatureHandler.h"
+#include "Sim/Features/FeatureMemPool.h"
 #include "Sim/Misc/CategoryHandler.h"
 #include "Sim/Misc/DamageArrayHandler.h"
 #include "Sim/Misc/GeometricObjects.h"
@@ -86,10 +91,12 @@
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/Projectile.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
+#include "Sim/Units/CommandAI/BuilderAreaCache.h"
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "Sim/Units/Scripts/UnitScriptFactory.h"
 #include "Sim/Units/Scripts/UnitScriptEngine.h"
 #include "Sim/Units/UnitHandler.h"
+#include "Sim/Units/UnitMemPool.h"
 #include "Sim/Units/UnitDefHandler.h"
 #include "Sim/Weapons/WeaponDefHandler.h"
 #include "Sim/Weapons/WeaponLoader.h"
@@ -114,10 +121,15 @@
 #include "System/SafeUtil.h"
 #include "System/SpringExitCode.h"
 #include "System/SpringMath.h"
+#include "System/StringUtil.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Log/ILog.h"
+#include "System/MemoryStats.h"
 #include "System/Platform/Misc.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Sound/ISound.h"
@@ -125,6 +137,9 @@
 #include "System/Sync/DumpState.h"
 #include "System/TimeProfiler.h"
 
+#include <fstream>
+#include <numeric>
+
 
 #undef CreateDirectory
 
@@ -141,16 +156,23 @@ CONFIG(int, ShowPlayerInfo).defaultValue(1).headlessValue(0);
 CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0f).description("Sets the opacity of the built-in Spring UI. Generally has no effect on LuaUI widgets. Can be set in-game using shift+, to decrease and shift+. to increase.");
 CONFIG(std::string, InputTextGeo).defaultValue("");
 
+CONFIG(int, DemoKeyframeInterval).defaultValue(0).minimumValue(0).description("Minutes between savestates embedded in recorded demos, which let playback skip ahead without simulating the game from its start. 0 disables them; each one briefly stalls the game while it is taken.");
 CONFIG(int, SmoothTimeOffset).defaultValue(0).headlessValue(0).description("Enables frametimeoffset smoothing, 0 = off (old version), -1 = forced 0.5,  1-20 smooth, recommended = 2-3");
 
 CGame* game = nullptr;
 
+std::string CGame::frameStatsFileName;
+
 
 CR_BIND(CGame, (std::string(""), std::string(""), nullptr))
 
 CR_REG_METADATA(CGame, (
 	CR_MEMBER(lastSimFrame),
 	CR_IGNORED(lastNumQueuedSimFrames),
+	CR_IGNORED(numJitterBufferFrames),
+	CR_IGNORED(netBufferUnderrun),
+	CR_IGNORED(simFrameTimes),
+	CR_IGNORED(numSimFrameTimes),
 	CR_IGNORED(numDrawFrames),
 
 	CR_IGNORED(frameStartTime),
@@ -204,8 +226,15 @@ CR_REG_METADATA(CGame, (
 
 	CR_MEMBER(speedControl),
 	CR_MEMBER(luaGCControl),
+	CR_IGNORED(demoKeyframeInterval),
+	CR_IGNORED(nextDemoKeyframe),
+	CR_IGNORED(winningAllyTeams),
+	CR_IGNORED(frameStats),
+	CR_IGNORED(frameStatsTimes),
+	CR_IGNORED(frameStatsPathRequests),
 
 	CR_IGNORED(jobDispatcher),
+	CR_IGNORED(simFrameGraph),
 	CR_IGNORED(curKeyChain),
 	CR_IGNORED(worldDrawer),
 	CR_IGNORED(saveFileHandler),
@@ -246,6 +275,7 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 	showSpeed = configHandler->GetBool("ShowSpeed");
 
 	speedControl = configHandler->GetInt("SpeedControl");
+	nextDemoKeyframe = (demoKeyframeInterval = configHandler->GetInt("DemoKeyframeInterval") * 60 * GAME_SPEED);
 
 	playerRoster.SetSortTypeByCode((PlayerRoster::SortType)configHandler->GetInt("ShowPlayerInfo"));
 
@@ -284,6 +314,12 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 
 CGame::~CGame()
 {
+	// the reporters reference the subsystems killed below
+	memoryStats.ClearReporters();
+
+	if (!frameStatsFileName.empty())
+		WriteFrameStats();
+
 	ENTER_SYNCED_CODE();
 	LOG("[Game::%s][1]", __func__);
 
@@ -343,6 +379,123 @@ void CGame::AddTimedJobs()
 
 		jobDispatcher.AddTimedJob(j);
 	}
+
+	{
+		JobDispatcher::Job j;
+
+		j.f = []() -> bool {
+			memoryStats.Update();
+			return true;
+		};
+
+		j.freq = 1.0f;
+		j.time = (1000.0f / j.freq) * (1 - j.startDirect);
+		j.name = "MemoryStats::Update";
+
+		jobDispatcher.AddTimedJob(j);
+	}
+}
+
+void CGame::AddMemoryStatsReporters()
+{
+	// [0] := unsynced, [1] := synced
+	extern const spring::unsynced_set<const luaContextData*>* LUAHANDLE_CONTEXTS[2];
+
+	const auto GetLuaAllocedBytes = [](bool synced) {
+		std::uint64_t allocedBytes = 0;
+
+		for (const luaContextData* lcd: *LUAHANDLE_CONTEXTS[synced]) {
+			allocedBytes += lcd->allocState.allocedBytes;
+		}
+
+		return allocedBytes;
+	};
+
+	memoryStats.AddReporter("path", []() { return ((pathManager != nullptr)? pathManager->GetMemFootPrint(): 0); });
+	memoryStats.AddReporter("los", []() { return std::uint64_t((losHandler != nullptr)? losHandler->GetMemFootPrint(): 0); });
+	memoryStats.AddReporter("quadfield", []() { return std::uint64_t(quadField.GetMemFootPrint()); });
+	memoryStats.AddReporter("projectiles", []() { return std::uint64_t(projectileHandler.GetMemFootPrint()); });
+	memoryStats.AddReporter("units", []() { return std::uint64_t(unitMemPool.alloc_size()); });
+	memoryStats.AddReporter("features", []() { return std::uint64_t(featureMemPool.alloc_size()); });
+
+	memoryStats.AddReporter("models", []() { return modelLoader.GetMemFootPrint(); });
+	memoryStats.AddReporter("models.gpu", []() { return modelLoader.GetGPUMemFootPrint(); });
+	memoryStats.AddReporter("textures", []() { return textureHandlerS3O.GetMemFootPrint(); });
+	memoryStats.AddReporter("textures.gpu", []() { return (textureHandlerS3O.GetGPUMemFootPrint() + textureHandler3DO.GetGPUMemFootPrint()); });
+
+	memoryStats.AddReporter("lua.synced", [=]() { return GetLuaAllocedBytes(true); });
+	memoryStats.AddReporter("lua.unsynced", [=]() { return GetLuaAllocedBytes(false); });
+
+	memoryStats.AddReporter("net.packetcache", []() { return ((gameServer != nullptr)? gameServer->GetPacketCacheBytes(): 0); });
+}
+
+void CGame::AddSimFrameStages()
+{
+	// coarse partitioning of the synced state, see JobGraph
+	enum {
+		SIM_RES_UNITS       = 1 << 0,
+		SIM_RES_FEATURES    = 1 << 1,
+		SIM_RES_PROJECTILES = 1 << 2,
+		SIM_RES_HEIGHTMAP   = 1 << 3,
+		SIM_RES_PATHING     = 1 << 4,
+		SIM_RES_LOS         = 1 << 5,
+		SIM_RES_GHOSTS      = 1 << 6,
+		SIM_RES_TEAMS       = 1 << 7,
+		SIM_RES_PLAYERS     = 1 << 8,
+	};
+
+	// NOTE:
+	//   anything that can end up in a Lua call-in (or a unit script) has
+	//   to claim all state, since gadgets are free to modify any of it
+	//   and also consume gsRNG; this includes the projectile and feature
+	//   updates (Explosion, FeatureDestroyed), interceptor tests
+	//   (AllowWeaponInterceptTarget) and FPS control (AimFromWeapon)
+	//   only stages declared anyThread may be handed to a worker, which
+	//   requires them to stay clear of Lua and of non-MT SCOPED_TIMERs
+	constexpr JobGraph::ResourceMask SIM_RES_ALL = JobGraph::ALL_RESOURCES;
+
+	simFrameGraph.Clear();
+	simFrameGraph.AddStage("Sim::GameFrame", SIM_RES_ALL, SIM_RES_ALL, false, [this]() {
+		SCOPED_TIMER("Sim::GameFrame");
+
+		// keep garbage-collection rate tied to sim-speed
+		// (fixed 30Hz gc is not enough while catching up)
+		if (luaGCControl == 0)
+			eventHandler.CollectGarbage(false);
+
+		eventHandler.GameFrame(gs->frameNum);
+	});
+
+	simFrameGraph.AddStage("GameHelper::Update", SIM_RES_ALL, SIM_RES_ALL, false, []() { helper->Update(); });
+	simFrameGraph.AddStage("ReadMap::Update", SIM_RES_HEIGHTMAP, SIM_RES_HEIGHTMAP, false, []() { readMap->Update(); });
+	simFrameGraph.AddStage("MapDamage::Update", SIM_RES_ALL, SIM_RES_ALL, false, []() { mapDamage->Update(); });
+	simFrameGraph.AddStage("PathManager::Update", SIM_RES_HEIGHTMAP | SIM_RES_PATHING, SIM_RES_PATHING, false, []() { pathManager->Update(); });
+	simFrameGraph.AddStage("UnitHandler::Update", SIM_RES_ALL, SIM_RES_ALL, false, []() { unitHandler.Update(); });
+	simFrameGraph.AddStage("ProjectileHandler::Update", SIM_RES_ALL, SIM_RES_ALL, false, []() { projectileHandler.Update(); });
+	simFrameGraph.AddStage("FeatureHandler::Update", SIM_RES_ALL, SIM_RES_ALL, false, []() { featureHandler.Update(); });
+	simFrameGraph.AddStage("UnitScriptEngine::Tick", SIM_RES_ALL, SIM_RES_ALL, false, []() {
+		SCOPED_TIMER("Sim::Script");
+		unitScriptEngine->Tick(33);
+	});
+	// terrain changed by builders, unit scripts and gadgets during the frame
+	simFrameGraph.AddStage("MapDamage::RecalcQueuedAreas", SIM_RES_ALL, SIM_RES_ALL, false, []() { mapDamage->RecalcQueuedAreas(); });
+	simFrameGraph.AddStage("EnvResourceHandler::Update", SIM_RES_ALL, SIM_RES_ALL, false, []() { envResHandler.Update(); });
+	// the team slow-update only moves resources between teams, so it can
+	// share a level with the LOS update (which writes nothing but LOS)
+	simFrameGraph.AddStage("TeamHandler::GameFrame", SIM_RES_TEAMS, SIM_RES_TEAMS, true, []() { teamHandler.GameFrame(gs->frameNum); });
+	simFrameGraph.AddStage("LosHandler::Update", SIM_RES_UNITS | SIM_RES_LOS, SIM_RES_LOS, true, []() { losHandler->Update(); });
+	// the (unsynced) ReadMap is told about squares entering LOS here, not from
+	// the possibly pooled LOS update; reads LOS so it is ordered after it
+	simFrameGraph.AddStage("LosHandler::FlushReadmapEvents", SIM_RES_LOS | SIM_RES_HEIGHTMAP, 0, false, []() { losHandler->FlushReadmapEvents(); });
+	// dead ghosts have to be updated in sim, after los,
+	// to make sure they represent the current knowledge correctly.
+	// should probably be split from drawer
+	simFrameGraph.AddStage("UnitDrawer::UpdateGhostedBuildings", SIM_RES_UNITS | SIM_RES_LOS | SIM_RES_GHOSTS, SIM_RES_GHOSTS, false, []() { CUnitDrawer::UpdateGhostedBuildings(); });
+	simFrameGraph.AddStage("InterceptHandler::Update", SIM_RES_ALL, SIM_RES_ALL, false, []() { interceptHandler.Update(false); });
+	simFrameGraph.AddStage("PlayerHandler::GameFrame", SIM_RES_ALL, SIM_RES_ALL, false, []() { playerHandler.GameFrame(gs->frameNum); });
+	simFrameGraph.Compile();
+
+	LOG("[Game::%s] %u sim-frame stages in %u levels", __func__, unsigned(simFrameGraph.GetNumStages()), unsigned(simFrameGraph.GetNumLevels()));
 }
 
 void CGame::Load(const std::string& mapFileName)
@@ -364,6 +517,7 @@ void CGame::Load(const std::string& mapFileName)
 
 	try {
 		LOG("[Game::%s][1] globalQuit=%d threaded=%d", __func__, globalQuit.load(), !Threading::IsMainThread());
+		ScopedOnceTimer timer("Game::Load (Map and Defs)");
 
 		LoadMap(mapFileName);
 		LoadDefs(defsParser);
@@ -380,6 +534,7 @@ void CGame::Load(const std::string& mapFileName)
 
 	try {
 		LOG("[Game::%s][2] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
+		ScopedOnceTimer timer("Game::Load (PreLoad)");
 
 		PreLoadSimulation(defsParser);
 		PreLoadRendering();
@@ -390,8 +545,12 @@ void CGame::Load(const std::string& mapFileName)
 
 	try {
 		LOG("[Game::%s][3] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
+		ScopedOnceTimer timer("Game::Load (PostLoad)");
 
 		PostLoadSimulation(defsParser);
+		// nothing loaded between here and LoadFinalize touches the map or pathing,
+		// so let the estimators precompute in the meantime instead of after them
+		StartFinalizePFS();
 		PostLoadRendering();
 	} catch (const content_error& e) {
 		LOG_L(L_WARNING, "[Game::%s][3] forced quit with exception \"%s\"", __func__, e.what());
@@ -400,6 +559,7 @@ void CGame::Load(const std::string& mapFileName)
 	if (!forcedQuit) {
 		try {
 			LOG("[Game::%s][4] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
+			ScopedOnceTimer timer("Game::Load (Interface)");
 
 			LoadInterface();
 		} catch (const content_error& e) {
@@ -411,6 +571,7 @@ void CGame::Load(const std::string& mapFileName)
 	if (!forcedQuit) {
 		try {
 			LOG("[Game::%s][5] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
+			ScopedOnceTimer timer("Game::Load (Finalize)");
 
 			LoadFinalize();
 		} catch (const content_error& e) {
@@ -422,6 +583,7 @@ void CGame::Load(const std::string& mapFileName)
 	if (!forcedQuit) {
 		try {
 			LOG("[Game::%s][6] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
+			ScopedOnceTimer timer("Game::Load (Lua)");
 
 			LoadLua(saveFileHandler != nullptr, false);
 		} catch (const content_error& e) {
@@ -432,6 +594,7 @@ void CGame::Load(const std::string& mapFileName)
 
 	try {
 		LOG("[Game::%s][7] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
+		ScopedOnceTimer timer("Game::Load (GamePreload)");
 
 		if (!globalQuit && saveFileHandler != nullptr) {
 			loadscreen->SetLoadMessage("Loading Saved Game");
@@ -473,8 +636,13 @@ void CGame::Load(const std::string& mapFileName)
 		}
 	}
 
+	// LoadFinalize is skipped on forced quit, the PFS must not outlive us
+	JoinFinalizePFS();
+
 	Watchdog::DeregisterThread(WDT_LOAD);
 	AddTimedJobs();
+	AddSimFrameStages();
+	AddMemoryStatsReporters();
 
 	if (forcedQuit)
 		spring::exitCode = spring::EXIT_CODE_NOLOAD;
@@ -606,6 +774,9 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 		featureDefHandler->Init(defsParser);
 	}
 
+	// decode {Unit,Weapon}Def sounds while the rest loads, not when first played
+	CommonDefHandler::PreloadSoundFiles();
+
 	CUnit::InitStatic();
 	CCommandAI::InitCommandDescriptionCache();
 	CUnitScriptFactory::InitStatic();
@@ -617,6 +788,7 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 	featureHandler.Init();
 	projectileHandler.Init();
 	CLosHandler::InitStatic();
+	CBuilderAreaCache::InitStatic();
 
 	readMap->InitHeightMapDigestVectors(losHandler->los.size);
 
@@ -649,6 +821,12 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 	envResHandler.LoadTidal(mapInfo->map.tidalStrength);
 	envResHandler.LoadWind(mapInfo->atmosphere.minWind, mapInfo->atmosphere.maxWind);
 
+	// let the resource-map analysis overlap with the remaining load stages
+	// rather than stalling the first AI that asks for it; nothing else uses
+	// it, and for saved games the analyzers are recreated by PostLoad anyway
+	if (saveFileHandler == nullptr && !gameSetup->hostDemo && !skirmishAIHandler.GetSkirmishAIsByPlayer(gu->myPlayerNum).empty())
+		resourceHandler->InitResourceMapAnalyzers();
+
 
 	inMapDrawerModel = new CInMapDrawModel();
 	inMapDrawer = new CInMapDraw();
@@ -815,13 +993,38 @@ void CGame::LoadSkirmishAIs()
 	}
 }
 
+void CGame::StartFinalizePFS()
+{
+	assert(!finalizePFSThread.joinable());
+
+	finalizePFSThread = std::move(spring::thread([this]() {
+		// reset FPU state for synced computations
+		streflop::streflop_init<streflop::Simple>();
+		Threading::SetThreadName("pfsfinalize");
+
+		ENTER_SYNCED_CODE();
+		finalizePFSTime = pathManager->Finalize();
+		LEAVE_SYNCED_CODE();
+	}));
+}
+
+void CGame::JoinFinalizePFS()
+{
+	if (!finalizePFSThread.joinable())
+		return;
+
+	finalizePFSThread.join();
+}
+
 void CGame::LoadFinalize()
 {
 	{
 		loadscreen->SetLoadMessage("[" + std::string(__func__) + "] finalizing PFS");
 
+		JoinFinalizePFS();
+
 		ENTER_SYNCED_CODE();
-		const std::uint64_t dt = pathManager->Finalize();
+		const std::uint64_t dt = finalizePFSTime;
 		const std::uint32_t cs = pathManager->GetPathCheckSum();
 		LEAVE_SYNCED_CODE();
 
@@ -835,6 +1038,23 @@ void CGame::LoadFinalize()
 	lastSimFrameTime = lastReadNetTime;
 	lastDrawFrameTime = lastReadNetTime;
 	updateDeltaSeconds = 0.0f;
+
+	// --replay-list demos double as benchmarks, time every subsystem while replaying them
+	if (gu->batchReplay) {
+		profiler.SetEnabled(true);
+		batchReplayStartTime = lastReadNetTime;
+	}
+
+	// as do --frame-stats games, so the totals can be compared between runs
+	if (!frameStatsFileName.empty()) {
+		profiler.SetEnabled(true);
+		frameStatsStartTime = lastReadNetTime;
+		frameStats.reserve(30 * 60 * GAME_SPEED);
+
+		// take the baseline totals, loading does not count towards the first frame
+		RecordFrameStats();
+		frameStats.clear();
+	}
 }
 
 
@@ -956,6 +1176,7 @@ void CGame::KillSimulation()
 	buildingMaskMap.Kill();
 
 	CLosHandler::KillStatic(gu->globalReload);
+	CBuilderAreaCache::KillStatic(gu->globalReload);
 	quadField.Kill();
 	moveDefHandler.Kill();
 	unitDefHandler->Kill();
@@ -1108,6 +1329,7 @@ bool CGame::Update()
 	ENTER_SYNCED_CODE();
 	SendClientProcUsage();
 	ClientReadNet(); // issues new SimFrame()s
+	SaveDemoKeyframe();
 
 	if (!gameOver) {
 		if (clientNet->NeedsReconnect())
@@ -1366,10 +1588,15 @@ bool CGame::Draw() {
 	if (UpdateUnsynced(currentTimePreUpdate))
 		return false;
 
+	// nobody watches a --replay-list demo, spend the time simulating it
+	if (gu->batchReplay)
+		return false;
+
 	const spring_time currentTimePreDraw = spring_gettime();
 
 	SCOPED_SPECIAL_TIMER("Draw");
 	globalRendering->SetGLTimeStamp(CGlobalRendering::FRAME_REF_TIME_QUERY_IDX);
+	GL::GPUTimerQueries::GetInstance().Update();
 
 	SetDrawMode(gameNormalDraw);
 
@@ -1589,6 +1816,35 @@ void CGame::StartPlaying()
 
 
 
+void CGame::SaveDemoKeyframe()
+{
+	if (demoKeyframeInterval <= 0 || gs->frameNum < nextDemoKeyframe)
+		return;
+
+	// keyframe frame numbers have to match those counted from the start of the stream
+	if (gameSetup->hostDemo || IsSavedGame())
+		return;
+
+	CDemoRecorder* recorder = clientNet->GetDemoRecorder();
+
+	if (recorder == nullptr || !recorder->IsValid())
+		return;
+
+	nextDemoKeyframe = gs->frameNum + demoKeyframeInterval;
+
+	// every packet recorded so far has been processed, so the state matches the stream position
+	CCregLoadSaveHandler saveHandler;
+	std::string state;
+
+	saveHandler.SaveInfo(gameSetup->mapName, gameSetup->modName);
+
+	if (!saveHandler.SaveGameState(state))
+		return;
+
+	recorder->AddKeyframe(gs->frameNum, std::move(state));
+}
+
+
 void CGame::SimFrame() {
 	ENTER_SYNCED_CODE();
 	ASSERT_SYNCED(gsRNG.GetGenState());
@@ -1650,46 +1906,31 @@ void CGame::SimFrame() {
 	{
 		SCOPED_SPECIAL_TIMER("Sim");
 
-		{
-			SCOPED_TIMER("Sim::GameFrame");
-
-			// keep garbage-collection rate tied to sim-speed
-			// (fixed 30Hz gc is not enough while catching up)
-			if (luaGCControl == 0)
-				eventHandler.CollectGarbage(false);
+		// see AddSimFrameStages; the schedule is identical on all clients
+		assert(!simFrameGraph.Empty());
+		simFrameGraph.Execute();
 
-			eventHandler.GameFrame(gs->frameNum);
-		}
-
-		helper->Update();
-		readMap->Update();
-		mapDamage->Update();
-		pathManager->Update();
-		unitHandler.Update();
-		projectileHandler.Update();
-		featureHandler.Update();
-		{
-			SCOPED_TIMER("Sim::Script");
-			unitScriptEngine->Tick(33);
-		}
-		envResHandler.Update();
-		losHandler->Update();
-		// dead ghosts have to be updated in sim, after los,
-		// to make sure they represent the current knowledge correctly.
-		// should probably be split from drawer
-		CUnitDrawer::UpdateGhostedBuildings();
-		interceptHandler.Update(false);
-
-		teamHandler.GameFrame(gs->frameNum);
-		playerHandler.GameFrame(gs->frameNum);
+		// everything synced Lua queued with SendToUnsyncedBatched this frame
+		if (luaGaia != nullptr)
+			luaGaia->DeliverBatchedMessages();
+		if (luaRules != nullptr)
+			luaRules->DeliverBatchedMessages();
 	}
 
+	// the frame's state is final now, AIs can read it while we draw
+	if (!skipping)
+		eoh->StartAsyncUpdate();
+
 	lastSimFrameTime = spring_gettime();
+	simFrameTimes[(numSimFrameTimes++) % simFrameTimes.size()] = (lastSimFrameTime - lastFrameTime).toMilliSecsf();
 	gu->avgSimFrameTime = mix(gu->avgSimFrameTime, (lastSimFrameTime - lastFrameTime).toMilliSecsf(), 0.05f);
 	gu->avgSimFrameTime = std::max(gu->avgSimFrameTime, 0.01f);
 
 	eventHandler.DbgTimingInfo(TIMING_SIM, lastFrameTime, lastSimFrameTime);
 
+	if (!frameStatsFileName.empty())
+		RecordFrameStats();
+
 	#ifdef HEADLESS
 	{
 		const float msecMaxSimFrameTime = 1000.0f / (GAME_SPEED * gs->wantedSpeedFactor);
@@ -1735,6 +1976,7 @@ void CGame::GameEnd(const std::vector<unsigned char>& winningAllyTeams, bool tim
 
 
 	gameOver = true;
+	this->winningAllyTeams = winningAllyTeams;
 	eventHandler.GameOver(winningAllyTeams);
 
 	CEndGameBox::Create(winningAllyTeams);
@@ -1934,6 +2176,152 @@ void CGame::EndSkip() {
 
 	LOG("Skipped %.1f seconds", skipSeconds);
 	#endif
+
+	// the server skips a --replay-list demo to its end right after starting it,
+	// so every frame has been simulated by the time this message arrives
+	if (!gu->batchReplay)
+		return;
+
+	WriteReplayStats();
+
+	// an empty script makes SpringApp load the next demo in the list
+	gameSetup->reloadScript = "";
+	gu->globalReload = true;
+}
+
+void CGame::WriteReplayStats() const
+{
+	const std::string fileName = "replays/" + FileSystem::GetBasename(gameSetup->demoName) + ".json";
+	const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+
+	std::ofstream out(filePath.c_str(), std::ios::out | std::ios::trunc);
+
+	if (!out.is_open()) {
+		LOG_L(L_ERROR, "[Game::%s] could not open \"%s\" for writing", __func__, filePath.c_str());
+		return;
+	}
+
+	out << "{\"demo\": " << Quote(gameSetup->demoName);
+	out << ", \"frames\": " << gs->frameNum;
+	out << ", \"wallTime\": " << (spring_gettime() - batchReplayStartTime).toMilliSecsf();
+	out << ", \"gameOver\": " << (gameOver? "true": "false");
+	out << ", \"winningAllyTeams\": [";
+
+	for (size_t i = 0; i < winningAllyTeams.size(); i++) {
+		out << ((i == 0)? "": ", ") << int(winningAllyTeams[i]);
+	}
+
+	out << "], \"teams\": [";
+
+	for (int i = 0, n = teamHandler.ActiveTeams() - int(gs->useLuaGaia); i < n; i++) {
+		const CTeam* team = teamHandler.Team(i);
+
+		out << ((i == 0)? "\n": ",\n") << "{\"teamID\": " << team->teamNum << ", \"allyTeamID\": " << teamHandler.AllyTeam(i);
+		out << ", \"statHistory\": [";
+
+		for (size_t j = 0; j < team->statHistory.size(); j++) {
+			out << ((j == 0)? "": ", ");
+			team->statHistory[j].OutputJSON(out);
+		}
+
+		out << "]}";
+	}
+
+	out << "\n], \"profile\": ";
+
+	profiler.OutputJSON(out);
+
+	out << "}\n";
+
+	LOG("[Game::%s] wrote stats of %d frames to \"%s\"", __func__, gs->frameNum, filePath.c_str());
+}
+
+void CGame::RecordFrameStats()
+{
+	// Draw also covers the frames drawn since the previous sim frame, Lua
+	// both the synced and the unsynced call-ins (including those from Draw)
+	const std::array<float, 3> times = {
+		profiler.GetTimeRecord("Sim").total.toMilliSecsf(),
+		profiler.GetTimeRecord("Draw").total.toMilliSecsf(),
+		profiler.GetTimeRecord("Lua::Callins::Synced").total.toMilliSecsf() + profiler.GetTimeRecord("Lua::Callins::Unsynced").total.toMilliSecsf(),
+	};
+	const uint64_t numPathRequests = profiler.GetCounter("Sim::Path::Requests");
+
+	// totals only drop if the profiler was reset (/debuginfo profiling)
+	frameStats.push_back({
+		gs->frameNum,
+		std::max(times[0] - frameStatsTimes[0], 0.0f),
+		std::max(times[1] - frameStatsTimes[1], 0.0f),
+		std::max(times[2] - frameStatsTimes[2], 0.0f),
+		uint32_t(std::max(numPathRequests, frameStatsPathRequests) - frameStatsPathRequests),
+	});
+
+	frameStatsTimes = times;
+	frameStatsPathRequests = numPathRequests;
+}
+
+void CGame::WriteFrameStats() const
+{
+	const std::string filePath = dataDirsAccess.LocateFile(frameStatsFileName, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+
+	std::ofstream out(filePath.c_str(), std::ios::out | std::ios::trunc);
+
+	if (!out.is_open()) {
+		LOG_L(L_ERROR, "[Game::%s] could not open \"%s\" for writing", __func__, filePath.c_str());
+		return;
+	}
+
+	// per-frame distribution of one column; percentiles by nearest rank
+	const auto OutputSummary = [&](const char* name, const auto& GetValue) {
+		std::vector<float> values;
+		values.reserve(frameStats.size());
+
+		for (const FrameStats& fs: frameStats) {
+			values.push_back(GetValue(fs));
+		}
+
+		std::sort(values.begin(), values.end());
+
+		const auto Percentile = [&](float p) { return (values.empty()? 0.0f: values[std::min(size_t(p * values.size()), values.size() - 1)]); };
+		const double total = std::accumulate(values.begin(), values.end(), 0.0);
+
+		out << Quote(name) << ": {\"total\": " << total;
+		out << ", \"mean\": " << (values.empty()? 0.0: total / values.size());
+		out << ", \"p50\": " << Percentile(0.50f);
+		out << ", \"p95\": " << Percentile(0.95f);
+		out << ", \"p99\": " << Percentile(0.99f);
+		out << ", \"max\": " << (values.empty()? 0.0f: values.back()) << "}";
+	};
+
+	out << "{\"frames\": " << gs->frameNum;
+	out << ", \"wallTime\": " << (spring_gettime() - frameStatsStartTime).toMilliSecsf();
+	out << ", \"gameOver\": " << (gameOver? "true": "false");
+	out << ",\n\"summary\": {";
+
+	OutputSummary("simTime", [](const FrameStats& fs) { return fs.simTime; });
+	out << ",\n";
+	OutputSummary("drawTime", [](const FrameStats& fs) { return fs.drawTime; });
+	out << ",\n";
+	OutputSummary("luaTime", [](const FrameStats& fs) { return fs.luaTime; });
+	out << ",\n";
+	OutputSummary("pathRequests", [](const FrameStats& fs) { return float(fs.numPathRequests); });
+
+	// [frame, sim ms, draw ms, Lua ms, path requests]
+	out << "},\n\"frameStats\": [";
+
+	for (size_t i = 0; i < frameStats.size(); i++) {
+		const FrameStats& fs = frameStats[i];
+
+		out << ((i == 0)? "\n": ",\n") << "[" << fs.frameNum << ", " << fs.simTime << ", " << fs.drawTime << ", " << fs.luaTime << ", " << fs.numPathRequests << "]";
+	}
+
+	out << "\n], \"profile\": ";
+
+	profiler.OutputJSON(out);
+
+	out << "}\n";
+
+	LOG("[Game::%s] wrote stats of %u frames to \"%s\"", __func__, unsigned(frameStats.size()), filePath.c_str());
 }
 
 
@@ -3,6 +3,7 @@
 #ifndef _GAME_H
 #define _GAME_H
 
+#include <array>
 #include <atomic>
 #include <string>
 #include <vector>
@@ -14,6 +15,7 @@
 #include "System/UnorderedMap.hpp"
 #include "System/creg/creg_cond.h"
 #include "System/Misc/SpringTime.h"
+#include "System/Threading/SpringThreading.h"
 
 class LuaParser;
 class ILoadSaveHandler;
@@ -31,6 +33,9 @@ public:
 	virtual ~CGame();
 	void KillLua(bool dtor);
 
+	/// non-empty makes every game record per-frame timings and write them to this file at exit
+	static void SetFrameStatsFile(const std::string& fileName) { frameStatsFileName = fileName; }
+
 public:
 	enum GameDrawMode {
 		gameNotDrawing     = 0,
@@ -47,6 +52,17 @@ public:
 		spring::unordered_map<int, int> packets;
 	};
 
+	/// profiler time (ms) and path requests between the end of a sim frame and that of its predecessor
+	struct FrameStats {
+		int frameNum;
+
+		float simTime;
+		float drawTime;
+		float luaTime;
+
+		uint32_t numPathRequests;
+	};
+
 public:
 	void Load(const std::string& mapName);
 
@@ -55,6 +71,8 @@ public:
 
 private:
 	void AddTimedJobs();
+	void AddSimFrameStages();
+	void AddMemoryStatsReporters();
 
 	void LoadMap(const std::string& mapName);
 	void LoadDefs(LuaParser* defsParser);
@@ -65,6 +83,8 @@ private:
 	void LoadInterface();
 	void LoadLua(bool onlySynced, bool onlyUnsynced);
 	void LoadSkirmishAIs();
+	void StartFinalizePFS();
+	void JoinFinalizePFS();
 	void LoadFinalize();
 	void PostLoad();
 
@@ -141,6 +161,10 @@ private:
 	void UpdateNetMessageProcessingTimeLeft();
 	void SimFrame();
 	void StartPlaying();
+	void SaveDemoKeyframe();
+	void WriteReplayStats() const;
+	void RecordFrameStats();
+	void WriteFrameStats() const;
 
 public:
 	GameDrawMode gameDrawMode = gameNotDrawing;
@@ -150,6 +174,15 @@ public:
 	int lastSimFrame = -1;
 	int lastNumQueuedSimFrames = -1;
 
+	/// frames the smoothing buffer keeps beyond its minimum, grown on underruns (see UpdateNumQueuedSimFrames)
+	float numJitterBufferFrames = 0.0f;
+	/// whether ClientReadNet ran out of frames to simulate since the last UpdateNumQueuedSimFrames
+	bool netBufferUnderrun = false;
+
+	/// durations (ms) of the SimFrame calls since the last NETMSG_CLIENT_STATS, newest 64 kept
+	std::array<float, 64> simFrameTimes = {};
+	unsigned int numSimFrameTimes = 0;
+
 	// number of Draw() calls per 1000ms
 	unsigned int numDrawFrames = 0;
 
@@ -163,6 +196,8 @@ public:
 	spring_time lastSimFrameNetPacketTime;
 	spring_time lastUnsyncedUpdateTime;
 	spring_time skipLastDrawTime;
+	spring_time batchReplayStartTime;
+	spring_time frameStatsStartTime;
 
 	float updateDeltaSeconds = 0.0f;
 	/// Time in seconds, stops at game end
@@ -209,8 +244,24 @@ public:
 	// 0 := 1/f rate, 1 := 30/s rate
 	int luaGCControl = 0;
 
+	// frames between savestates embedded in the demo, 0 if none are
+	int demoKeyframeInterval = 0;
+	int nextDemoKeyframe = 0;
+
+	/// allyteams passed to GameEnd, reported when replaying with --replay-list
+	std::vector<unsigned char> winningAllyTeams;
+
+	/// one entry per sim frame if frameStatsFileName is set, see RecordFrameStats
+	std::vector<FrameStats> frameStats;
+	/// profiler totals (ms) and path requests at the last RecordFrameStats call
+	std::array<float, 3> frameStatsTimes = {};
+	uint64_t frameStatsPathRequests = 0;
+
 private:
+	static std::string frameStatsFileName;
+
 	JobDispatcher jobDispatcher;
+	JobGraph simFrameGraph;
 
 	CTimedKeyChain curKeyChain;
 
@@ -222,6 +273,10 @@ private:
 	/// for reloading the savefile
 	ILoadSaveHandler* saveFileHandler;
 
+	/// precomputes the PFS while rendering and interface are loaded
+	spring::thread finalizePFSThread;
+	std::int64_t finalizePFSTime = 0;
+
 	std::atomic<bool> loadDone = {false};
 	std::atomic<bool> gameOver = {false};
 };
@@ -37,6 +37,7 @@
 #include "Sim/Weapons/Weapon.h"
 #include "System/EventHandler.h"
 #include "System/SpringMath.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/Sound/ISoundChannels.h"
 
 
@@ -365,6 +366,9 @@ static inline void QueryUnits(TFilter filter, TQuery& query)
 			continue;
 
 		for (const int qi: *qfQuery.quads) {
+			if (!quadField.GetQuad(qi).HasAllyTeamUnits(t))
+				continue;
+
 			const auto& allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
 
 			for (CUnit* u: allyTeamUnits) {
@@ -632,49 +636,219 @@ namespace {
 
 
 
-size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+namespace {
+	// scores the auto-target candidates of one weapon; only reads synced
+	// state and draws from the weapon's own RNG stream, so any number of
+	// these may run in parallel (script and Lua modifiers are left to the
+	// caller, see CGameHelper::GenerateWeaponTargets)
+	struct WeaponTargetScorer {
+	public:
+		WeaponTargetScorer(const CWeapon* w)
+			: weapon(w)
+			, weaponOwner(w->owner)
+			, lastAttacker(((w->owner->lastAttackFrame + 200) <= gs->frameNum) ? w->owner->lastAttacker : nullptr)
+			, weaponDef(w->weaponDef)
+			, weaponDmg(w->damages)
+			, aimPosHeight(w->aimFromPos.y)
+			// how much damage the weapon deals over 1 second
+			, secDamage(w->damages->GetDefault() * w->salvoSize / w->reloadTime * GAME_SPEED)
+			, heightMod(w->weaponDef->heightmod)
+			, baseRange(w->range)
+			, rangeBoost(w->autoTargetRangeBoost)
+			// find theoretical maximum range based on height above lowest point on map
+			, scanRadius(w->range + w->autoTargetRangeBoost + (w->aimFromPos.y - std::max(0.0f, readMap->GetCurrMinHeight())) * w->weaponDef->heightmod)
+			, paralyzer(w->damages->paralyzeDamageTime != 0)
+			, rng(GetSyncedRNGStream(RNG_STREAM_WEAPON, w->owner->id * MAX_WEAPONS_PER_UNIT + w->weaponNum))
+		{}
+
+		bool Score(CUnit* targetUnit, SWeaponTargetCandidate& candidate) {
+			// [0] := default, [1,2,3,4,5,6] := target is {unused, in bad category, crashing, last attacker, paralyzed, outside unboosted range}
+			constexpr float tgtPriorityMults[] = {1.0f, 10.0f, 100.0f, 1000.0f, 0.5f, 4.0f, 100000.0f};
+
+			if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
+				return false;
+
+			const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
+
+			float targetPriority = tgtPriorityMults[0];
+			float3 targetPos;
+
+			if (targetLOSState & LOS_INLOS) {
+				targetPos = targetUnit->aimPos;
+			} else if (targetLOSState & LOS_INRADAR) {
+				targetPos = weapon->GetUnitPositionWithError(targetUnit);
+				targetPriority *= tgtPriorityMults[1];
+			} else {
+				return false;
+			}
+
+			const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
+			const float sqDist2D = weaponOwner->pos.SqDistance2D(targetPos);
+
+			if (sqDist2D > Square(modRange))
+				return false;
+
+			const float dist2D = math::sqrt(sqDist2D);
+			const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
+			const float damageMul = weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple;
+
+			targetPriority *= rangeMul;
+			targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
+
+			if (targetLOSState & LOS_INLOS) {
+				targetPriority *= (secDamage + targetUnit->health);
+
+				if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
+					targetPriority *= tgtPriorityMults[5];
+
+			} else {
+				targetPriority *= (secDamage + 10000.0f);
+			}
+
+			if (targetLOSState & LOS_PREVLOS) {
+				targetPriority /= (damageMul * targetUnit->power * (0.7f + rng.NextFloat() * 0.6f));
+				targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
+				targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
+				targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
+			}
+
+			candidate.unit = targetUnit;
+			candidate.priority = targetPriority;
+			candidate.inLos = ((targetLOSState & LOS_INLOS) != 0);
+			return true;
+		}
+
+	public:
+		const CWeapon* weapon;
+		const CUnit* weaponOwner;
+		const CUnit* lastAttacker;
+
+		const      WeaponDef* weaponDef;
+		const DynDamageArray* weaponDmg;
+
+		const float3 testPos;
+
+		const float aimPosHeight;
+		const float secDamage;
+		const float heightMod;
+
+		const float  baseRange;
+		const float rangeBoost;
+		const float scanRadius;
+
+		const bool paralyzer;
+
+		CSyncedRNGStream rng;
+	};
+}
+
+
+void CGameHelper::UpdateVisibleEnemies(int allyTeam)
 {
-	const CUnit*  weaponOwner = weapon->owner;
-	const CUnit* lastAttacker = ((weaponOwner->lastAttackFrame + 200) <= gs->frameNum) ? weaponOwner->lastAttacker : nullptr;
+	VisibleEnemies& enemies = visibleEnemies[allyTeam];
+
+	if (enemies.frameNum == gs->frameNum)
+		return;
+
+	const int numQuads = quadField.GetNumQuadsX() * quadField.GetNumQuadsZ();
+
+	enemies.frameNum = gs->frameNum;
+	enemies.units.clear();
+	enemies.quadOffsets.clear();
+	enemies.quadOffsets.reserve(numQuads + 1);
+
+	for (int qi = 0; qi < numQuads; qi++) {
+		const CQuadField::Quad& quad = quadField.GetQuad(qi);
 
-	const      WeaponDef* weaponDef = weapon->weaponDef;
-	const DynDamageArray* weaponDmg = weapon->damages;
+		enemies.quadOffsets.push_back(enemies.units.size());
 
-	const float3& ownerPos = weaponOwner->pos;
-	const float3 testPos;
+		for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
+			if (teamHandler.Ally(allyTeam, t))
+				continue;
+			if (!quad.HasAllyTeamUnits(t))
+				continue;
 
-	const float aimPosHeight = weapon->aimFromPos.y;
-	const float minMapHeight = std::max(0.0f, readMap->GetCurrMinHeight());
+			for (CUnit* unit: quad.teamUnits[t]) {
+				if ((unit->losStatus[allyTeam] & (LOS_INLOS | LOS_INRADAR)) == 0)
+					continue;
 
-	// how much damage the weapon deals over 1 second
-	const float secDamage = weaponDmg->GetDefault() * weapon->salvoSize / weapon->reloadTime * GAME_SPEED;
-	const float heightMod = weaponDef->heightmod;
+				enemies.units.push_back(unit);
+			}
+		}
+	}
 
-	const float  baseRange = weapon->range;
-	const float rangeBoost = weapon->autoTargetRangeBoost;
-	// find theoretical maximum range based on height above lowest point on map
-	// const float scanRadius = weapon->GetRange2D(rangeBoost, (minMapHeight - aimPosHeight) * heightMod);
-	const float scanRadius = baseRange + rangeBoost + (aimPosHeight - minMapHeight) * heightMod;
+	enemies.quadOffsets.push_back(enemies.units.size());
+}
 
-	// [0] := default, [1,2,3,4,5,6] := target is {avoidee, in bad category, crashing, last attacker, paralyzed, outside unboosted range}
-	constexpr float tgtPriorityMults[] = {1.0f, 10.0f, 100.0f, 1000.0f, 0.5f, 4.0f, 100000.0f};
+void CGameHelper::GenerateWeaponTargetCandidates(const std::vector<CWeapon*>& weapons)
+{
+	if (weapons.empty())
+		return;
 
-	const bool paralyzer = (weaponDmg->paralyzeDamageTime != 0);
+	visibleEnemies.resize(teamHandler.ActiveAllyTeams());
+
+	// one shared index per allyteam instead of a QuadField scan per weapon
+	for (const CWeapon* weapon: weapons) {
+		UpdateVisibleEnemies(weapon->owner->allyteam);
+	}
+
+	// every weapon writes only its own candidates; the per-weapon RNG streams and
+	// the ID-sorted candidate order keep the result independent of thread count
+	for_mt_chunk(0, weapons.size(), [&](const int i) {
+		static thread_local std::vector<int> quads;
+		static thread_local std::vector<CUnit*> units;
+
+		CWeapon* weapon = weapons[i];
+		WeaponTargetScorer scorer(weapon);
+
+		const VisibleEnemies& enemies = visibleEnemies[weapon->owner->allyteam];
+
+		quads.clear();
+		units.clear();
+		quadField.GetQuads(quads, weapon->owner->pos, scorer.scanRadius);
+
+		for (const int qi: quads) {
+			units.insert(units.end(), enemies.units.begin() + enemies.quadOffsets[qi], enemies.units.begin() + enemies.quadOffsets[qi + 1]);
+		}
+
+		// units spanning several quads occur more than once
+		std::sort(units.begin(), units.end(), [](const CUnit* a, const CUnit* b) { return (a->id < b->id); });
+		units.erase(std::unique(units.begin(), units.end()), units.end());
+
+		weapon->autoTargetCandidates.clear();
+		weapon->haveAutoTargetCandidates = true;
+
+		for (CUnit* targetUnit: units) {
+			SWeaponTargetCandidate candidate;
+
+			if (!scorer.Score(targetUnit, candidate))
+				continue;
+
+			weapon->autoTargetCandidates.push_back(candidate);
+		}
+	});
+}
+
+void CGameHelper::GenerateWeaponTargetCandidates(const CWeapon* weapon, std::vector<SWeaponTargetCandidate>& candidates)
+{
+	WeaponTargetScorer scorer(weapon);
 
-	// copy on purpose since the below calls lua
 	QuadFieldQuery qfQuery;
-	quadField.GetQuads(qfQuery, ownerPos, scanRadius);
+	quadField.GetQuads(qfQuery, weapon->owner->pos, scorer.scanRadius);
 
-	targets.clear();
-	targets.reserve(32);
+	candidates.clear();
+	candidates.reserve(32);
 
 	const int tempNum = gs->GetTempNum();
 
 	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
-		if (teamHandler.Ally(weaponOwner->allyteam, t))
+		if (teamHandler.Ally(weapon->owner->allyteam, t))
 			continue;
 
 		for (const int qi: *qfQuery.quads) {
+			if (!quadField.GetQuad(qi).HasAllyTeamUnits(t))
+				continue;
+
 			const std::vector<CUnit*>& allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
 
 			for (CUnit* targetUnit: allyTeamUnits) {
@@ -683,67 +857,49 @@ size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* av
 
 				targetUnit->tempNum = tempNum;
 
-				if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
-					continue;
-
-				const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
-
-				float targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
-				float3 targetPos;
+				SWeaponTargetCandidate candidate;
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPos = targetUnit->aimPos;
-				} else if (targetLOSState & LOS_INRADAR) {
-					targetPos = weapon->GetUnitPositionWithError(targetUnit);
-					targetPriority *= tgtPriorityMults[1];
-				} else {
+				if (!scorer.Score(targetUnit, candidate))
 					continue;
-				}
-
-				const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
-				const float sqDist2D = ownerPos.SqDistance2D(targetPos);
 
-				if (sqDist2D > Square(modRange))
-					continue;
+				candidates.push_back(candidate);
+			}
+		}
+	}
+}
 
-				const float dist2D = math::sqrt(sqDist2D);
-				const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
-				const float damageMul = weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple;
+size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+{
+	const CUnit* weaponOwner = weapon->owner;
+	const WeaponDef* weaponDef = weapon->weaponDef;
 
-				targetPriority *= rangeMul;
-				targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
+	// [0] := default, [1] := target is avoidee
+	constexpr float tgtPriorityMults[] = {1.0f, 10.0f};
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPriority *= (secDamage + targetUnit->health);
+	// weapons not scored before the current SlowUpdate pass are scored here
+	// (into a local since the below calls scripts and Lua, which may recurse)
+	std::vector<SWeaponTargetCandidate> tmpCandidates;
 
-					if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
-						targetPriority *= tgtPriorityMults[5];
+	if (!weapon->haveAutoTargetCandidates)
+		GenerateWeaponTargetCandidates(weapon, tmpCandidates);
 
-					if (weapon->hasTargetWeight)
-						targetPriority *= weapon->TargetWeight(targetUnit);
+	const std::vector<SWeaponTargetCandidate>& candidates = weapon->haveAutoTargetCandidates? weapon->autoTargetCandidates: tmpCandidates;
 
-				} else {
-					targetPriority *= (secDamage + 10000.0f);
-				}
+	targets.clear();
+	targets.reserve(candidates.size());
 
-				if (targetLOSState & LOS_PREVLOS) {
-					targetPriority /= (damageMul * targetUnit->power * (0.7f + gsRNG.NextFloat() * 0.6f));
-					targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
-					targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
-					targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
-				}
+	for (const SWeaponTargetCandidate& candidate: candidates) {
+		CUnit* targetUnit = candidate.unit;
 
-				const bool allowTarget = eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority);
+		float targetPriority = candidate.priority * tgtPriorityMults[(targetUnit == avoidUnit) * 1];
 
-				// Lua call may have changed tempNum, so needs to be set again
-				targetUnit->tempNum = tempNum;
+		if (candidate.inLos && weapon->hasTargetWeight)
+			targetPriority *= weapon->TargetWeight(targetUnit);
 
-				if (!allowTarget)
-					continue;
+		if (!eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority))
+			continue;
 
-				targets.emplace_back(targetPriority, targetUnit);
-			}
-		}
+		targets.emplace_back(targetPriority, targetUnit);
 	}
 
 	std::stable_sort(targets.begin(), targets.end(), [](const std::pair<float, CUnit*>& a, const std::pair<float, CUnit*>& b) { return (a.first < b.first); });
@@ -996,12 +1152,8 @@ float3 CGameHelper::ClosestBuildPos(
 		// check for nearby blocking objects
 		for (int z = zmin; z < zmax; ++z) {
 			for (int x = xmin; x < xmax; ++x) {
-				const CSolidObject* solObj = groundBlockingObjectMap.GroundBlockedUnsafe(z * mapDims.mapx + x);
-
-				if (solObj == nullptr)
-					continue;
 				// immobile=true implies Feature or Building
-				if (!solObj->immobile)
+				if ((groundBlockingObjectMap.GetCellMaskUnsafe(z * mapDims.mapx + x) & CGroundBlockingObjectMap::CELL_MASK_IMMOBILE) == 0)
 					continue;
 
 				free = false;
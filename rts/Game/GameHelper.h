@@ -21,6 +21,7 @@ class CMobileCAI;
 struct UnitDef;
 struct MoveDef;
 struct BuildInfo;
+struct SWeaponTargetCandidate;
 
 struct CExplosionParams {
 	const float3 pos;
@@ -132,6 +133,9 @@ public:
 		bool synced = false
 	);
 
+	/// scores the auto-target candidates of <weapons> in parallel, for the following GenerateWeaponTargets calls
+	void GenerateWeaponTargetCandidates(const std::vector<CWeapon*>& weapons);
+	static void GenerateWeaponTargetCandidates(const CWeapon* weapon, std::vector<SWeaponTargetCandidate>& candidates);
 	static size_t GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
 
 	void Init();
@@ -188,6 +192,19 @@ private:
 	// note: size must be a power of two
 	std::array<std::vector<WaitingDamage>, 128> waitingDamages;
 
+	// enemy units in LOS or radar of an allyteam, grouped by QuadField quad
+	struct VisibleEnemies {
+		int frameNum = -1;
+
+		std::vector<CUnit*> units;
+		std::vector<size_t> quadOffsets; // quad i owns units[quadOffsets[i], quadOffsets[i + 1])
+	};
+
+	// rebuilt at most once per frame, only for GenerateWeaponTargetCandidates
+	std::vector<VisibleEnemies> visibleEnemies;
+
+	void UpdateVisibleEnemies(int allyTeam);
+
 public:
 	std::vector<int> targetUnitIDs; // GetEnemyUnits{NoLosTest}
 	std::vector<std::pair<float, CUnit*>> targetPairs; // GenerateWeaponTargets
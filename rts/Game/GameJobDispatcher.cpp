@@ -0,0 +1,166 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "GameJobDispatcher.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+#ifdef THREADPOOL
+// runs a level's thread-agnostic stages; mirrors ForTaskGroup in that it is
+// pushed once per worker and every copy pulls stages off a shared counter
+template<typename F>
+class StageTaskGroup: public ITaskGroup
+{
+public:
+	StageTaskGroup(bool pooled) : ITaskGroup(false, pooled) {}
+
+	void Enqueue(const std::vector<F*>& funcs) {
+		remainingTasks.store(funcs.size());
+		ctr.store(0);
+
+		// copy; stale queued slices may still peek at this after Execute
+		stageFuncs.assign(funcs.begin(), funcs.end());
+	}
+
+	bool IsSliceTask() const override { return true; }
+	bool ExecuteStep() override {
+		const size_t i = ctr.fetch_add(1, std::memory_order_relaxed);
+
+		if (i < stageFuncs.size()) {
+			(*stageFuncs[i])();
+			remainingTasks -= 1;
+			return true;
+		}
+
+		return false;
+	}
+
+private:
+	std::atomic<size_t> ctr;
+	std::vector<F*> stageFuncs;
+};
+#endif
+
+
+void JobGraph::AddStage(const char* name, ResourceMask reads, ResourceMask writes, bool anyThread, std::function<void()>&& f)
+{
+	stages.emplace_back();
+
+	Stage& s = stages.back();
+
+	s.f = std::move(f);
+	s.name = name;
+	s.reads = reads;
+	s.writes = writes;
+	s.anyThread = anyThread;
+
+	// invalidate any compiled schedule
+	levelStages.clear();
+	levelOffsets.clear();
+}
+
+void JobGraph::Compile()
+{
+	int numLevels = 0;
+
+	for (size_t i = 0; i < stages.size(); i++) {
+		Stage& si = stages[i];
+
+		si.level = 0;
+
+		// read-after-write, write-after-read and write-after-write all order
+		// the later stage behind the earlier one; nothing else does
+		for (size_t j = 0; j < i; j++) {
+			const Stage& sj = stages[j];
+
+			if (((si.reads | si.writes) & sj.writes) == 0 && (si.writes & sj.reads) == 0)
+				continue;
+
+			si.level = std::max(si.level, sj.level + 1);
+		}
+
+		numLevels = std::max(numLevels, si.level + 1);
+	}
+
+	levelStages.clear();
+	levelStages.reserve(stages.size());
+	levelOffsets.clear();
+	levelOffsets.reserve(numLevels + 1);
+
+	for (int level = 0; level < numLevels; level++) {
+		levelOffsets.push_back(levelStages.size());
+
+		for (size_t i = 0; i < stages.size(); i++) {
+			if (stages[i].level == level)
+				levelStages.push_back(i);
+		}
+	}
+
+	levelOffsets.push_back(levelStages.size());
+}
+
+void JobGraph::Execute()
+{
+	if (levelOffsets.empty())
+		Compile();
+
+	#ifndef THREADPOOL
+	for (const size_t i: levelStages) {
+		stages[i].f();
+	}
+	#else
+	// static, so TaskGroup's are recycled (see for_mt)
+	static TaskPool<StageTaskGroup, std::function<void()>> pool;
+	static std::vector<std::function<void()>*> anyThreadFuncs;
+
+	for (size_t level = 0, numLevels = GetNumLevels(); level < numLevels; level++) {
+		const size_t beg = levelOffsets[level    ];
+		const size_t end = levelOffsets[level + 1];
+
+		anyThreadFuncs.clear();
+
+		for (size_t k = beg; k < end; k++) {
+			Stage& s = stages[ levelStages[k] ];
+
+			if (!s.anyThread)
+				continue;
+
+			anyThreadFuncs.push_back(&s.f);
+		}
+
+		// common case; nothing to overlap
+		if ((end - beg) == 1 || anyThreadFuncs.empty() || !ThreadPool::HasThreads()) {
+			for (size_t k = beg; k < end; k++) {
+				stages[ levelStages[k] ].f();
+			}
+
+			continue;
+		}
+
+		// hand the thread-agnostic stages to the pool, run the
+		// rest here and then help out until all have finished
+		auto taskGroup = pool.GetTaskGroup();
+
+		taskGroup->Enqueue(anyThreadFuncs);
+		taskGroup->UpdateId();
+
+		for (size_t i = 1, n = std::min(anyThreadFuncs.size() + 1, size_t(ThreadPool::GetNumThreads())); i < n; ++i) {
+			taskGroup->wantedThread.store(i * (1 - ThreadPool::UseWorkStealing()));
+			ThreadPool::PushTaskGroup(taskGroup);
+		}
+
+		for (size_t k = beg; k < end; k++) {
+			Stage& s = stages[ levelStages[k] ];
+
+			if (s.anyThread)
+				continue;
+
+			s.f();
+		}
+
+		ThreadPool::WaitForFinished(taskGroup);
+	}
+	#endif
+}
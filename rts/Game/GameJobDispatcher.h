@@ -3,8 +3,10 @@
 #ifndef _GAME_JOB_DISPATCHER_H
 #define _GAME_JOB_DISPATCHER_H
 
+#include <cstdint>
 #include <functional>
 #include <queue>
+#include <vector>
 
 #include "System/Misc/SpringTime.h"
 
@@ -65,5 +67,62 @@ private:
 	std::priority_queue<Job, std::vector<Job>, std::greater<Job>> jobs;
 };
 
+
+
+// declarative graph of per-frame stages; each stage states which (coarse)
+// parts of the state it reads and writes, Compile() then places it on the
+// first level after every conflicting stage that was added before it
+//
+// levels are a pure function of the declaration order and the masks, so
+// every client derives the same schedule; stages sharing a level touch no
+// common written state and may therefore overlap without affecting sync
+class JobGraph {
+public:
+	typedef uint64_t ResourceMask;
+
+	static constexpr ResourceMask ALL_RESOURCES = ~ResourceMask(0);
+
+	struct Stage {
+		std::function<void()> f;
+
+		const char* name = "";
+
+		ResourceMask reads = 0;
+		ResourceMask writes = 0;
+
+		// stages that call into Lua or use (non-MT) SCOPED_TIMERs must
+		// stay on the thread that calls Execute, only the others may be
+		// handed to ThreadPool workers
+		bool anyThread = false;
+
+		int level = 0;
+	};
+
+public:
+	void AddStage(const char* name, ResourceMask reads, ResourceMask writes, bool anyThread, std::function<void()>&& f);
+	void Compile();
+	void Execute();
+	void Clear() {
+		stages.clear();
+		levelStages.clear();
+		levelOffsets.clear();
+	}
+
+	bool Empty() const { return stages.empty(); }
+
+	size_t GetNumStages() const { return stages.size(); }
+	size_t GetNumLevels() const { return (levelOffsets.empty()? 0: levelOffsets.size() - 1); }
+
+	const Stage& GetStage(size_t i) const { return stages[i]; }
+
+private:
+	std::vector<Stage> stages;
+
+	// stage indices sorted (stably) by level; level i spans
+	// levelStages[levelOffsets[i] .. levelOffsets[i + 1])
+	std::vector<size_t> levelStages;
+	std::vector<size_t> levelOffsets;
+};
+
 #endif
 
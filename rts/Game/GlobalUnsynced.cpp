@@ -50,6 +50,7 @@ CR_REG_METADATA(CGlobalUnsynced, (
 	CR_MEMBER(spectatingFullView),
 	CR_MEMBER(spectatingFullSelect),
 	CR_IGNORED(fpsMode),
+	CR_IGNORED(batchReplay),
 	CR_IGNORED(globalQuit),
 	CR_IGNORED(globalReload)
 ))
@@ -78,6 +79,7 @@ void CGlobalUnsynced::ResetState()
 	spectatingFullSelect = false;
 
 	fpsMode = false;
+	batchReplay = false;
 	globalQuit = false;
 	globalReload = false;
 
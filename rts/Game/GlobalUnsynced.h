@@ -162,6 +162,15 @@ public:
 	 */
 	bool fpsMode = false;
 
+	/**
+	 * @brief batchReplay
+	 *
+	 * if true, the current game is a demo of a --replay-list being
+	 * replayed to its end without drawing, after which its stats are
+	 * written out and the next demo of the list is loaded
+	 */
+	bool batchReplay = false;
+
 	/**
 	* @brief global quit
 	*
@@ -318,6 +318,10 @@ void CLoadScreen::SetLoadMessage(const std::string& text, bool replaceLast)
 
 	if (mtLoading)
 		return;
+	// messages can also come from helper threads (e.g. the PFS), only the
+	// load thread owns the GL context when not loading multi-threaded
+	if (!Threading::IsMainThread() && !Threading::IsGameLoadThread())
+		return;
 
 	Update();
 	Draw();
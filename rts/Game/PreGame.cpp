@@ -43,6 +43,7 @@
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Net/RawPacket.h"
 #include "System/Net/UnpackPacket.h"
@@ -437,6 +438,7 @@ void CPreGame::StartServerForDemo(const std::string& demoName)
 		tgame->remove("HostIP", false);
 		tgame->remove("HostPort", false);
 		tgame->remove("AutohostPort", false);
+		tgame->remove("AutohostTransport", false);
 		tgame->remove("SourcePort", false);
 		//tgame->remove("IsHost", false);
 
@@ -485,6 +487,7 @@ void CPreGame::ReadDataFromDemo(const std::string& demoName)
 		assert(gameData->GetSetupText() == scanner.GetSetupScript());
 
 		if (CGameSetup::LoadReceivedScript(gameData->GetSetupText(), true)) {
+			LoadDemoKeyframe(scanner);
 			StartServerForDemo(demoName);
 		} else {
 			throw content_error("Demo contains incorrect script");
@@ -494,6 +497,33 @@ void CPreGame::ReadDataFromDemo(const std::string& demoName)
 	assert(gameServer != nullptr);
 }
 
+void CPreGame::LoadDemoKeyframe(CDemoReader& demoReader)
+{
+	if (clientSetup->demoStartFrame <= 0)
+		return;
+
+	const int keyframe = demoReader.FindKeyframe(clientSetup->demoStartFrame);
+
+	std::string state;
+
+	if (!demoReader.ReadKeyframeState(keyframe, state))
+		return;
+
+	CCregLoadSaveHandler* handler = new CCregLoadSaveHandler();
+
+	if (!handler->LoadGameState(state)) {
+		LOG_L(L_WARNING, "[PreGame::%s] keyframe at frame %d saved by a different engine version", __func__, demoReader.GetKeyframes()[keyframe].frameNum);
+		delete handler;
+		return;
+	}
+
+	LOG("[PreGame::%s] starting demo from keyframe at frame %d", __func__, demoReader.GetKeyframes()[keyframe].frameNum);
+
+	// the server forwards the stream from where this keyframe was taken
+	saveFileHandler = handler;
+	clientSetup->demoKeyframe = keyframe;
+}
+
 void CPreGame::GameDataReceived(std::shared_ptr<const netcode::RawPacket> packet)
 {
 	ScopedOnceTimer timer("PreGame::GameDataReceived");
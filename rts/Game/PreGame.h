@@ -10,6 +10,7 @@
 #include "System/Misc/SpringTime.h"
 
 class ILoadSaveHandler;
+class CDemoReader;
 class GameData;
 class CGameSetup;
 class ClientSetup;
@@ -58,6 +59,8 @@ private:
 
 	/// reads out map, mod and script from demos (with or without a gameSetupScript)
 	void ReadDataFromDemo(const std::string& demoName);
+	/// loads the keyframe used to start at ClientSetup::demoStartFrame (if any) like a save-file
+	void LoadDemoKeyframe(CDemoReader& demoReader);
 
 	/// receive network traffic
 	void UpdateClientNet();
@@ -40,6 +40,8 @@
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
 
+#include <algorithm>
+
 #include <SDL_mouse.h>
 #include <SDL_keycode.h>
 
@@ -61,6 +63,10 @@ void CSelectedUnitsHandler::Init(unsigned numPlayers)
 	autoAddBuiltUnitsToSelectedGroup = configHandler->GetBool("AutoAddBuiltUnitsToSelectedGroup");
 
 	netSelected.resize(numPlayers);
+
+	selectedCommands.clear();
+	selectedCommandIDs.clear();
+	unitCommandIDs.clear();
 }
 
 
@@ -86,90 +92,145 @@ CSelectedUnitsHandler::AvailableCommandsStruct CSelectedUnitsHandler::GetAvailab
 {
 	possibleCommandsChanged = false;
 
-	int commandPage = 1000;
-	int foundGroup = -2;
-	int foundGroup2 = -2;
-
-	spring::unordered_map<int, int> states;
-	std::vector<SCommandDescription> commands;
+	AvailableCommandsStruct ac;
+	ac.commandPage = 1000;
 
 	for (const int unitID: selectedUnits) {
-		const CUnit* u = unitHandler.GetUnit(unitID);
-		const CCommandAI* cai = u->commandAI;
-		const CGroup* group = u->GetGroup();
+		ac.commandPage = std::min(ac.commandPage, (unitHandler.GetUnit(unitID)->commandAI)->lastSelectedCommandPage);
+	}
+
+	// hand the commands whose leader left the selection to another unit
+	size_t numLeaderless = 0;
 
-		for (const SCommandDescription* cmdDesc: cai->GetPossibleCommands()) {
-			states[cmdDesc->id] = cmdDesc->disabled ? 2 : 1;
+	for (const auto& p: selectedCommands) {
+		numLeaderless += (p.second.leaderID == -1);
+	}
+
+	for (auto it = unitCommandIDs.begin(); it != unitCommandIDs.end() && numLeaderless > 0; ++it) {
+		for (const int cmdID: it->second) {
+			SelectedCommand& sc = selectedCommands[cmdID];
+
+			if (sc.leaderID != -1)
+				continue;
+
+			sc.leaderID = it->first;
+			numLeaderless--;
 		}
+	}
 
-		if (cai->lastSelectedCommandPage < commandPage)
-			commandPage = cai->lastSelectedCommandPage;
+	// gather the descriptions, each from the leader of its command
+	spring::unordered_map<int, const SCommandDescription*> cmdDescs;
+	spring::unordered_set<int> leaderIDs;
 
-		if (foundGroup == -2 && group != nullptr)
-			foundGroup = group->id;
+	for (const auto& p: selectedCommands) {
+		if (!leaderIDs.insert(p.second.leaderID).second)
+			continue;
 
-		if (group == nullptr || foundGroup != group->id)
-			foundGroup = -1;
+		for (const SCommandDescription* cmdDesc: (unitHandler.GetUnit(p.second.leaderID)->commandAI)->GetPossibleCommands()) {
+			const auto cmdIter = selectedCommands.find(cmdDesc->id);
 
-		if (foundGroup2 == -2 && group != nullptr)
-			foundGroup2 = group->id;
+			if (cmdIter == selectedCommands.end() || cmdIter->second.leaderID != p.second.leaderID)
+				continue;
 
-		if (foundGroup2 >= 0 && group != nullptr && group->id != foundGroup2)
-			foundGroup2 = -1;
+			cmdDescs.emplace(cmdDesc->id, cmdDesc);
+		}
 	}
 
-	// load the first set (separating build and non-build commands)
-	for (const int unitID: selectedUnits) {
-		const CUnit* u = unitHandler.GetUnit(unitID);
-		const CCommandAI* cai = u->commandAI;
+	// first the build or the non-build commands, then the others
+	const auto addCommands = [&](bool buildCommands) {
+		for (const int cmdID: selectedCommandIDs) {
+			if ((cmdID < 0) != buildCommands)
+				continue;
 
-		for (const SCommandDescription* cmdDesc: cai->GetPossibleCommands()) {
-			if (buildIconsFirst) {
-				if (cmdDesc->id >= 0)
-					continue;
-			} else {
-				if (cmdDesc->id <  0)
-					continue;
-			}
+			const auto descIter = cmdDescs.find(cmdID);
 
-			if (cmdDesc->showUnique && selectedUnits.size() > 1)
+			if (descIter == cmdDescs.end())
+				continue;
+			if ((descIter->second)->showUnique && selectedUnits.size() > 1)
 				continue;
 
-			if (states[cmdDesc->id] > 0) {
-				commands.push_back(*cmdDesc);
-				states[cmdDesc->id] = 0;
-			}
+			ac.commands.push_back(*(descIter->second));
 		}
+	};
+
+	ac.commands.reserve(selectedCommandIDs.size());
+
+	addCommands( buildIconsFirst);
+	addCommands(!buildIconsFirst);
+	return ac;
+}
+
+
+void CSelectedUnitsHandler::AddUnitCommands(const CUnit* unit)
+{
+	std::vector<int>& cmdIDs = unitCommandIDs[unit->id];
+
+	assert(cmdIDs.empty());
+	commandsAddStamp++;
+
+	for (const SCommandDescription* cmdDesc: (unit->commandAI)->GetPossibleCommands()) {
+		SelectedCommand& sc = selectedCommands[cmdDesc->id];
+
+		if (sc.numUnits > 0 && sc.addStamp == commandsAddStamp)
+			continue;
+
+		cmdIDs.push_back(cmdDesc->id);
+		sc.addStamp = commandsAddStamp;
+
+		if ((sc.numUnits++) > 0)
+			continue;
+
+		sc.leaderID = unit->id;
+
+		selectedCommandIDs.push_back(cmdDesc->id);
+		possibleCommandsChanged = true;
 	}
+}
 
-	// load the second set (all those that have not already been included)
-	for (const int unitID: selectedUnits) {
-		const CUnit* u = unitHandler.GetUnit(unitID);
-		const CCommandAI* cai = u->commandAI;
+void CSelectedUnitsHandler::RemoveUnitCommands(int unitID)
+{
+	const auto iter = unitCommandIDs.find(unitID);
 
-		for (const SCommandDescription* cmdDesc: cai->GetPossibleCommands()) {
-			if (buildIconsFirst) {
-				if (cmdDesc->id < 0)
-					continue;
-			} else {
-				if (cmdDesc->id >= 0)
-					continue;
-			}
+	if (iter == unitCommandIDs.end())
+		return;
 
-			if (cmdDesc->showUnique && selectedUnits.size() > 1)
-				continue;
+	for (const int cmdID: iter->second) {
+		const auto cmdIter = selectedCommands.find(cmdID);
 
-			if (states[cmdDesc->id] > 0) {
-				commands.push_back(*cmdDesc);
-				states[cmdDesc->id] = 0;
+		assert(cmdIter != selectedCommands.end());
+
+		SelectedCommand& sc = cmdIter->second;
+
+		if ((--sc.numUnits) > 0) {
+			// the shown description changes
+			if (sc.leaderID == unitID) {
+				sc.leaderID = -1;
+				possibleCommandsChanged = true;
 			}
+
+			continue;
 		}
+
+		selectedCommands.erase(cmdIter);
+		selectedCommandIDs.erase(std::find(selectedCommandIDs.begin(), selectedCommandIDs.end(), cmdID));
+		possibleCommandsChanged = true;
 	}
 
-	AvailableCommandsStruct ac;
-	ac.commandPage = commandPage;
-	ac.commands = commands;
-	return ac;
+	unitCommandIDs.erase(iter);
+}
+
+void CSelectedUnitsHandler::UpdateUnitCommands(const CUnit* unit)
+{
+	// commands only this unit has become the last ones, which is also
+	// where they would end up if the selection was made again
+	RemoveUnitCommands(unit->id);
+	AddUnitCommands(unit);
+}
+
+void CSelectedUnitsHandler::SelectionSizeChanged(size_t prevSize)
+{
+	// showUnique commands are only available to single units
+	possibleCommandsChanged |= ((prevSize > 1) != (selectedUnits.size() > 1));
 }
 
 
@@ -299,6 +360,10 @@ void CSelectedUnitsHandler::HandleUnitBoxSelection(const float4& planeRight, con
 		maxTeam = teamHandler.ActiveTeams() - 1;
 	}
 
+	const bool removeSelected = KeyInput::GetKeyModState(KMOD_CTRL);
+
+	changedUnits.clear();
+
 	for (int team = minTeam; team <= maxTeam; team++) {
 		if (!gu->spectatingFullSelect && !myPlayer->CanControlTeam(team))
 			continue;
@@ -315,14 +380,20 @@ void CSelectedUnitsHandler::HandleUnitBoxSelection(const float4& planeRight, con
 			if (vec.dot4(planeBottom) >= 0.0f)
 				continue;
 
-			if (KeyInput::GetKeyModState(KMOD_CTRL) && (selectedUnits.find(u->id) != selectedUnits.end())) {
-				RemoveUnit(u);
-				continue;
-			}
+			changedUnits.push_back(u);
+		}
+	}
+
+	std::sort(changedUnits.begin(), changedUnits.end(), [](const CUnit* a, const CUnit* b) { return (a->GetSyncID() < b->GetSyncID()); });
 
-			AddUnit(unit = u);
-			numUnits++;
+	for (CUnit* u: changedUnits) {
+		if (removeSelected && u->isSelected) {
+			RemoveUnit(u);
+			continue;
 		}
+
+		AddUnit(unit = u);
+		numUnits++;
 	}
 
 	switch (numUnits) {
@@ -394,11 +465,13 @@ void CSelectedUnitsHandler::AddUnit(CUnit* unit)
 	if (unit->noSelect)
 		return;
 
-	if (selectedUnits.insert(unit->id).second)
+	if (selectedUnits.insert(unit->id).second) {
 		AddDeathDependence(unit, DEPENDENCE_SELECTED);
+		AddUnitCommands(unit);
+		SelectionSizeChanged(selectedUnits.size() - 1);
+	}
 
 	selectionChanged = true;
-	possibleCommandsChanged = true;
 
 	const CGroup* g = unit->GetGroup();
 
@@ -411,11 +484,13 @@ void CSelectedUnitsHandler::AddUnit(CUnit* unit)
 
 void CSelectedUnitsHandler::RemoveUnit(CUnit* unit)
 {
-	if (selectedUnits.erase(unit->id))
+	if (selectedUnits.erase(unit->id)) {
 		DeleteDeathDependence(unit, DEPENDENCE_SELECTED);
+		RemoveUnitCommands(unit->id);
+		SelectionSizeChanged(selectedUnits.size() + 1);
+	}
 
 	selectionChanged = true;
-	possibleCommandsChanged = true;
 	selectedGroup = -1;
 	unit->isSelected = false;
 }
@@ -423,6 +498,9 @@ void CSelectedUnitsHandler::RemoveUnit(CUnit* unit)
 
 void CSelectedUnitsHandler::ClearSelected()
 {
+	changedUnits.clear();
+	changedUnits.reserve(selectedUnits.size());
+
 	for (const int unitID: selectedUnits) {
 		CUnit* u = unitHandler.GetUnit(unitID);
 
@@ -432,14 +510,26 @@ void CSelectedUnitsHandler::ClearSelected()
 			continue;
 		}
 
+		changedUnits.push_back(u);
+	}
+
+	// newest first, each removal then erases the last listening entry
+	std::sort(changedUnits.begin(), changedUnits.end(), [](const CUnit* a, const CUnit* b) { return (a->GetSyncID() > b->GetSyncID()); });
+
+	for (CUnit* u: changedUnits) {
 		u->isSelected = false;
 		DeleteDeathDependence(u, DEPENDENCE_SELECTED);
 	}
 
 	selectedUnits.clear();
 	selectionChanged = true;
-	possibleCommandsChanged = true;
 	selectedGroup = -1;
+
+	possibleCommandsChanged |= !selectedCommands.empty();
+
+	selectedCommands.clear();
+	selectedCommandIDs.clear();
+	unitCommandIDs.clear();
 }
 
 
@@ -449,18 +539,26 @@ void CSelectedUnitsHandler::SelectGroup(int num)
 	selectedGroup = num;
 	CGroup* group = uiGroupHandlers[gu->myTeam].GetGroup(num);
 
+	changedUnits.clear();
+
 	for (const int unitID: group->units) {
 		CUnit* u = unitHandler.GetUnit(unitID);
 
-		if (!u->noSelect) {
-			u->isSelected = true;
-			selectedUnits.insert(u->id);
-			AddDeathDependence(u, DEPENDENCE_SELECTED);
-		}
+		if (!u->noSelect)
+			changedUnits.push_back(u);
+	}
+
+	std::sort(changedUnits.begin(), changedUnits.end(), [](const CUnit* a, const CUnit* b) { return (a->GetSyncID() < b->GetSyncID()); });
+
+	for (CUnit* u: changedUnits) {
+		u->isSelected = true;
+		selectedUnits.insert(u->id);
+		AddDeathDependence(u, DEPENDENCE_SELECTED);
+		AddUnitCommands(u);
 	}
 
 	selectionChanged = true;
-	possibleCommandsChanged = true;
+	SelectionSizeChanged(0);
 }
 
 
@@ -691,10 +789,14 @@ void CSelectedUnitsHandler::Draw()
 
 void CSelectedUnitsHandler::DependentDied(CObject* o)
 {
-	selectedUnits.erase(static_cast<CUnit*>(o)->id);
+	const int unitID = static_cast<CUnit*>(o)->id;
+
+	if (selectedUnits.erase(unitID)) {
+		RemoveUnitCommands(unitID);
+		SelectionSizeChanged(selectedUnits.size() + 1);
+	}
 
 	selectionChanged = true;
-	possibleCommandsChanged = true;
 }
 
 
@@ -864,7 +966,15 @@ int CSelectedUnitsHandler::GetDefaultCmd(const CUnit* unit, const CFeature* feat
 
 void CSelectedUnitsHandler::PossibleCommandChange(CUnit* sender)
 {
-	possibleCommandsChanged |= (sender == nullptr || selectedUnits.find(sender->id) != selectedUnits.end());
+	if (sender == nullptr) {
+		possibleCommandsChanged = true;
+		return;
+	}
+
+	if (selectedUnits.find(sender->id) == selectedUnits.end())
+		return;
+
+	UpdateUnitCommands(sender);
 }
 
 // CALLINFO:
@@ -991,6 +1101,8 @@ void CSelectedUnitsHandler::SendCommand(const Command& c)
 		selectedUnitIDs.resize(selectedUnits.size(), 0);
 
 		std::copy(selectedUnits.begin(), selectedUnits.end(), selectedUnitIDs.begin());
+		// sorted, so a large selection packs into few ID ranges
+		std::sort(selectedUnitIDs.begin(), selectedUnitIDs.end());
 
 		clientNet->Send(CBaseNetProtocol::Get().SendSelect(gu->myPlayerNum, selectedUnitIDs));
 		selectionChanged = false;
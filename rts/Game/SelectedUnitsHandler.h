@@ -9,6 +9,7 @@
 #include "Sim/Units/CommandAI/Command.h"
 #include "System/float4.h"
 #include "System/Object.h"
+#include "System/UnorderedMap.hpp"
 #include "System/UnorderedSet.hpp"
 
 class CUnit;
@@ -64,6 +65,12 @@ public:
 	void SelectUnits(const std::string& line);
 	void SelectCycle(const std::string& command);
 
+private:
+	void AddUnitCommands(const CUnit* unit);
+	void RemoveUnitCommands(int unitID);
+	void UpdateUnitCommands(const CUnit* unit);
+	void SelectionSizeChanged(size_t prevSize);
+
 private:
 	int selectedGroup = -1;
 	int soundMultiselID = 0;
@@ -80,8 +87,34 @@ public:
 	std::vector< std::vector<int> > netSelected;
 
 private:
+	struct SelectedCommand {
+		// number of selected units that have the command
+		int numUnits;
+		// selected unit whose description of the command is shown, -1 if
+		// it left the selection and the next GetAvailableCommands picks one
+		int leaderID;
+		// AddUnitCommands call that last counted the command, so IDs that
+		// a unit lists more than once are counted once
+		int addStamp;
+	};
+
+	// the commands of all selected units merged by ID, kept up to date as
+	// units enter and leave the selection so the GUI layout only has to be
+	// redone when this set changes rather than on every selection change
+	spring::unordered_map<int, SelectedCommand> selectedCommands;
+	// IDs of selectedCommands, in the order they first became available
+	std::vector<int> selectedCommandIDs;
+	// IDs each selected unit contributes to selectedCommands
+	spring::unordered_map<int, std::vector<int>> unitCommandIDs;
+
+	int commandsAddStamp = 0;
+
 	// buffer for SendCommand unordered_set->vector conversion
 	std::vector<int16_t> selectedUnitIDs;
+	// buffer for the units a (de)selection of many units changes, sorted
+	// so their death-dependence links are added and removed at the back
+	// of our sync-id ordered listening list instead of anywhere inside it
+	std::vector<CUnit*> changedUnits;
 };
 
 extern CSelectedUnitsHandler selectedUnitsHandler;
@@ -3,6 +3,7 @@
 
 #include "Action.h"
 #include "Game.h"
+#include "GameSetup.h"
 #include "GlobalUnsynced.h"
 #include "InMapDraw.h"
 #include "SelectedUnitsHandler.h"
@@ -538,7 +539,24 @@ public:
 	}
 
 	bool Execute(const SyncedAction& action) const final {
-		if (action.GetArgs().find_first_of("start") == 0) {
+		if (action.GetArgs().compare(0, 7, "reload ") == 0) {
+			// the server found a demo keyframe far enough ahead; restart playback from it
+			const std::string& playerName = playerHandler.Player(gu->myPlayerNum)->name;
+			std::ostringstream script;
+
+			script << "[GAME]\n{\n";
+			script << "\tDemoFile=" << gameSetup->demoName << ";\n";
+			script << "\tDemoStartFrame=" << action.GetArgs().substr(7) << ";\n";
+			// PreGame appends the suffix again
+			script << "\tMyPlayerName=" << playerName.substr(0, playerName.rfind(" (spec)")) << ";\n";
+			script << "\tIsHost=1;\n";
+			script << "}\n";
+
+			gameSetup->reloadScript = script.str();
+			gu->globalReload = true;
+			LOG("Reloading the demo to skip to frame %s", action.GetArgs().substr(7).c_str());
+		}
+		else if (action.GetArgs().find_first_of("start") == 0) {
 			std::istringstream buf(action.GetArgs().substr(6));
 			int targetFrame;
 			buf >> targetFrame;
@@ -7,8 +7,10 @@
 #include "Map/Ground.h"
 #include "Rendering/GlobalRendering.h"
 #include "Sim/Features/Feature.h"
+#include "Sim/Features/FeatureHandler.h"
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/GeometricObjects.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/QuadField.h"
@@ -19,8 +21,10 @@
 #include "Sim/Weapons/PlasmaRepulser.h"
 #include "Sim/Weapons/WeaponDef.h"
 #include "System/SpringMath.h"
+#include "System/Platform/Threading.h"
 
 #include <algorithm>
+#include <array>
 #include <vector>
 
 //////////////////////////////////////////////////////////////////////
@@ -36,11 +40,12 @@ inline static bool TestConeHelper(
 	const float3& tstDir,
 	const float length,
 	const float spread,
-	const CSolidObject* obj
+	const CSolidObject* obj,
+	const float3& cvPos
 ) {
 	const CollisionVolume* cv = &obj->collisionVolume;
 
-	const float3 cvRelVec = cv->GetWorldSpacePos(obj) - tstPos;
+	const float3 cvRelVec = cvPos - tstPos;
 
 	const float  cvRelDst = Clamp(cvRelVec.dot(tstDir), 0.0f, length);
 	const float  coneSize = cvRelDst * spread + 1.0f;
@@ -76,6 +81,16 @@ inline static bool TestConeHelper(
 	return ret;
 }
 
+inline static bool TestConeHelper(
+	const float3& tstPos,
+	const float3& tstDir,
+	const float length,
+	const float spread,
+	const CSolidObject* obj
+) {
+	return (TestConeHelper(tstPos, tstDir, length, spread, obj, obj->collisionVolume.GetWorldSpacePos(obj)));
+}
+
 /**
  * helper for TestTrajectoryCone
  * @return true if object <o> is in the firing trajectory, false otherwise
@@ -340,7 +355,54 @@ void TraceRayShields(
 }
 
 
-float GuiTraceRay(
+/**
+ * The same mouse ray is traced several times per frame (cursor, tooltip,
+ * shader uniforms, Lua's TraceScreenRay), so the main thread remembers its
+ * last few results until the next draw- or sim-frame. Hits are stored as
+ * object IDs and a result is only reused while its hit object still exists.
+ */
+struct GuiTraceRayResult {
+	bool Matches(
+		const float3& s,
+		const float3& d,
+		float l,
+		const CUnit* e,
+		bool r,
+		bool g,
+		bool w
+	) const {
+		if (drawFrame != globalRendering->drawFrame || simFrame != gs->frameNum)
+			return false;
+		if (allyTeam != gu->myAllyTeam || fullView != gu->spectatingFullView)
+			return false;
+
+		return (start == s && dir == d && length == l && excludeID == ((e != nullptr)? e->id: -1) && useRadar == r && groundOnly == g && ignoreWater == w);
+	}
+
+	float3 start;
+	float3 dir;
+	float length = 0.0f;
+	float rayDist = 0.0f;
+
+	unsigned int drawFrame = -1u;
+	int simFrame = -1;
+	int allyTeam = -1;
+
+	int excludeID = -1;
+	int hitUnitID = -1;
+	int hitFeatureID = -1;
+
+	bool useRadar = false;
+	bool groundOnly = false;
+	bool ignoreWater = false;
+	bool fullView = false;
+};
+
+static std::array<GuiTraceRayResult, 8> guiTraceRayResults;
+static unsigned int guiTraceRayResultIdx = 0;
+
+
+static float GuiTraceRayImpl(
 	const float3& start,
 	const float3& dir,
 	const float length,
@@ -351,11 +413,6 @@ float GuiTraceRay(
 	bool groundOnly,
 	bool ignoreWater
 ) {
-	hitUnit = nullptr;
-	hitFeature = nullptr;
-
-	if (dir == ZeroVector)
-		return -1.0f;
 
 	// ground and water-plane intersection
 	const float    guiRayLength = length;
@@ -475,6 +532,63 @@ float GuiTraceRay(
 	return minIngressDist;
 }
 
+float GuiTraceRay(
+	const float3& start,
+	const float3& dir,
+	const float length,
+	const CUnit* exclude,
+	const CUnit*& hitUnit,
+	const CFeature*& hitFeature,
+	bool useRadar,
+	bool groundOnly,
+	bool ignoreWater
+) {
+	hitUnit = nullptr;
+	hitFeature = nullptr;
+
+	if (dir == ZeroVector)
+		return -1.0f;
+
+	if (!Threading::IsMainThread())
+		return (GuiTraceRayImpl(start, dir, length, exclude, hitUnit, hitFeature, useRadar, groundOnly, ignoreWater));
+
+	for (const GuiTraceRayResult& r: guiTraceRayResults) {
+		if (!r.Matches(start, dir, length, exclude, useRadar, groundOnly, ignoreWater))
+			continue;
+
+		hitUnit = (r.hitUnitID != -1)? unitHandler.GetUnit(r.hitUnitID): nullptr;
+		hitFeature = (r.hitFeatureID != -1)? featureHandler.GetFeature(r.hitFeatureID): nullptr;
+
+		// hit object was deleted in the meantime, trace again
+		if ((hitUnit == nullptr && r.hitUnitID != -1) || (hitFeature == nullptr && r.hitFeatureID != -1))
+			break;
+
+		return r.rayDist;
+	}
+
+	GuiTraceRayResult& r = guiTraceRayResults[(guiTraceRayResultIdx++) % guiTraceRayResults.size()];
+
+	r.start = start;
+	r.dir = dir;
+	r.length = length;
+	r.rayDist = GuiTraceRayImpl(start, dir, length, exclude, hitUnit, hitFeature, useRadar, groundOnly, ignoreWater);
+
+	r.drawFrame = globalRendering->drawFrame;
+	r.simFrame = gs->frameNum;
+	r.allyTeam = gu->myAllyTeam;
+
+	r.excludeID = (exclude != nullptr)? exclude->id: -1;
+	r.hitUnitID = (hitUnit != nullptr)? hitUnit->id: -1;
+	r.hitFeatureID = (hitFeature != nullptr)? hitFeature->id: -1;
+
+	r.useRadar = useRadar;
+	r.groundOnly = groundOnly;
+	r.ignoreWater = ignoreWater;
+	r.fullView = gu->spectatingFullView;
+
+	return r.rayDist;
+}
+
 
 bool TestCone(
 	const float3& from,
@@ -540,6 +654,96 @@ bool TestCone(
 
 
 
+void TestCones(
+	const float3& from,
+	const float3* dirs,
+	const float* lengths,
+	size_t count,
+	float spread,
+	int allyteam,
+	int traceFlags,
+	CUnit* owner,
+	bool* blocked
+) {
+	// (quad, cone) pairs, ordered by quad so every quad is visited once
+	static std::vector<std::pair<int, unsigned int>> quadCones;
+
+	quadCones.clear();
+
+	for (size_t i = 0; i < count; i++) {
+		QuadFieldQuery qfQuery;
+		quadField.GetQuadsOnRay(qfQuery, from, dirs[i], lengths[i]);
+
+		// same as TestCone
+		blocked[i] = qfQuery.quads->empty();
+
+		for (const int quadIdx: *qfQuery.quads) {
+			quadCones.emplace_back(quadIdx, i);
+		}
+	}
+
+	std::sort(quadCones.begin(), quadCones.end());
+
+	const bool scanForAllies   = ((traceFlags & Collision::NOFRIENDLIES) == 0);
+	const bool scanForNeutrals = ((traceFlags & Collision::NONEUTRALS  ) == 0);
+	const bool scanForFeatures = ((traceFlags & Collision::NOFEATURES  ) == 0);
+
+	const auto testObject = [&](const CSolidObject* obj, size_t beg, size_t end) {
+		// world-space volume position is shared by all cones
+		const float3 cvPos = obj->collisionVolume.GetWorldSpacePos(obj);
+
+		for (size_t j = beg; j < end; j++) {
+			const unsigned int i = quadCones[j].second;
+
+			if (blocked[i])
+				continue;
+
+			blocked[i] = TestConeHelper(from, dirs[i], lengths[i], spread, obj, cvPos);
+		}
+	};
+
+	for (size_t beg = 0, end = 0; beg < quadCones.size(); beg = end) {
+		const CQuadField::Quad& quad = quadField.GetQuad(quadCones[beg].first);
+
+		for (end = beg + 1; end < quadCones.size() && quadCones[end].first == quadCones[beg].first; end++);
+
+		if (scanForAllies) {
+			for (const CUnit* u: quad.teamUnits[allyteam]) {
+				if (u == owner)
+					continue;
+				if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
+					continue;
+
+				testObject(u, beg, end);
+			}
+		}
+
+		if (scanForNeutrals) {
+			for (const CUnit* u: quad.units) {
+				if (!u->IsNeutral())
+					continue;
+				if (u == owner)
+					continue;
+				if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
+					continue;
+
+				testObject(u, beg, end);
+			}
+		}
+
+		if (scanForFeatures) {
+			for (const CFeature* f: quad.features) {
+				if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
+					continue;
+
+				testObject(f, beg, end);
+			}
+		}
+	}
+}
+
+
+
 bool TestTrajectoryCone(
 	const float3& from,
 	const float3& dir,
@@ -3,6 +3,7 @@
 #ifndef _TRACE_RAY_H
 #define _TRACE_RAY_H
 
+#include <cstddef>
 #include <vector>
 
 class float3;
@@ -88,6 +89,23 @@ namespace TraceRay {
 		int traceFlags,
 		CUnit* owner);
 
+	/**
+	 * TestCone for \<count\> cones sharing an apex, spread and owner;
+	 * the quads they cross are swept once each (in index order) and the
+	 * objects in them are tested against every cone crossing that quad.
+	 * @param blocked set to TestCone's result for each cone
+	 */
+	void TestCones(
+		const float3& from,
+		const float3* dirs,
+		const float* lengths,
+		size_t count,
+		float spread,
+		int allyteam,
+		int traceFlags,
+		CUnit* owner,
+		bool* blocked);
+
 	/**
 	 * @return true if there is an object (allied/neutral unit, feature)
 	 *  within the firing trajectory of \<owner\> (that might be hit)
@@ -12,6 +12,7 @@
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GlobalRenderingInfo.h"
 #include "Rendering/GL/RenderBuffers.h"
+#include "Sim/Features/FeatureHandler.h"
 #include "Sim/Features/FeatureMemPool.h"
 #include "Sim/Misc/GlobalConstants.h" // for GAME_SPEED
 #include "Sim/Misc/GlobalSynced.h"
@@ -30,6 +31,7 @@ ProfileDrawer* ProfileDrawer::instance = nullptr;
 
 static constexpr float MAX_THREAD_HIST_TIME = 0.5f; // secs
 static constexpr float MAX_FRAMES_HIST_TIME = 0.5f; // secs
+static constexpr float PROFILE_REFRESH_TIME = 250.0f; // msecs
 
 static constexpr float  MIN_X_COOR = 0.6f;
 static constexpr float  MAX_X_COOR = 0.99f;
@@ -313,9 +315,14 @@ static void DrawProfiler(TypedRenderBuffer<VA_TYPE_C   >& rb)
 {
 	font->SetTextColor(1.0f, 1.0f, 1.0f, 1.0f);
 
-	// this locks a mutex, so don't call it every frame
-	if ((globalRendering->drawFrame % 10) == 0)
+	// this locks a mutex and collects the queued timings of all threads,
+	// so only sample a few times per second rather than every frame
+	static spring_time lastRefreshTime = spring_gettime();
+
+	if ((spring_gettime() - lastRefreshTime).toMilliSecsf() >= PROFILE_REFRESH_TIME) {
+		lastRefreshTime = spring_gettime();
 		profiler.RefreshProfiles();
+	}
 
 	constexpr SColor winColor = SColor{ 0.0f, 0.0f, 0.5f, 0.5f };
 	constexpr float textSize = 0.5f;
@@ -457,10 +464,10 @@ static void DrawInfoText(TypedRenderBuffer<VA_TYPE_C   >& rb)
 	// background
 
 	rb.SafeAppend({{             0.01f - 10.0f * globalRendering->pixelX, 0.02f - 10.0f * globalRendering->pixelY, 0.0f}, bgColor}); // tl
-	rb.SafeAppend({{             0.01f - 10.0f * globalRendering->pixelX, 0.17f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // bl
-	rb.SafeAppend({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.17f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // br
+	rb.SafeAppend({{             0.01f - 10.0f * globalRendering->pixelX, 0.19f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // bl
+	rb.SafeAppend({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.19f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // br
 
-	rb.SafeAppend({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.17f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // br
+	rb.SafeAppend({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.19f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // br
 	rb.SafeAppend({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.02f - 10.0f * globalRendering->pixelY, 0.0f}, bgColor}); // tr
 	rb.SafeAppend({{             0.01f - 10.0f * globalRendering->pixelX, 0.02f - 10.0f * globalRendering->pixelY, 0.0f}, bgColor}); // tl
 
@@ -477,6 +484,7 @@ static void DrawInfoText(TypedRenderBuffer<VA_TYPE_C   >& rb)
 	constexpr const char* luaFmtStr = "[7] Lua-allocated memory: %.1fMB (%.1fK allocs : %.5u usecs : %.1u states)";
 	constexpr const char* gpuFmtStr = "[8] GPU-allocated memory: %.1fMB / %.1fMB";
 	constexpr const char* sopFmtStr = "[9] SOP-allocated memory: {U,F,P,W}={%.1f/%.1f, %.1f/%.1f, %.1f/%.1f, %.1f/%.1f}KB";
+	constexpr const char* ftrFmtStr = "[10] {Updating,Static}Features={%u, %u}";
 
 	const CProjectileHandler* ph = &projectileHandler;
 	const IPathManager* pm = pathManager;
@@ -517,7 +525,7 @@ static void DrawInfoText(TypedRenderBuffer<VA_TYPE_C   >& rb)
 	}
 
 	{
-		SLuaAllocState state = {{0}, {0}, {0}, {0}};
+		SLuaAllocState state = {{0}, {0}, {0}, {0}, {0}};
 		spring_lua_alloc_get_stats(&state);
 
 		const    float allocMegs = state.allocedBytes.load() / 1024.0f / 1024.0f;
@@ -546,6 +554,8 @@ static void DrawInfoText(TypedRenderBuffer<VA_TYPE_C   >& rb)
 		weaponMemPool.alloc_size() / 1024.0f,
 		weaponMemPool.freed_size() / 1024.0f
 	);
+
+	font->glFormat(0.01f, 0.20f, 0.5f, DBG_FONT_FLAGS, ftrFmtStr, featureHandler.GetNumUpdatingFeatures(), featureHandler.GetNumStaticFeatures());
 }
 
 
@@ -78,6 +78,8 @@
 #include "Rendering/Env/GrassDrawer.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/Fonts/glFont.h"
+#include "Rendering/GL/HiZPyramid.h"
+#include "Rendering/GL/StreamBuffer.h"
 #include "Rendering/Map/InfoTexture/IInfoTextureHandler.h"
 #include "Rendering/Map/InfoTexture/Modern/Path.h"
 #include "Rendering/Shaders/ShaderHandler.h"
@@ -85,20 +87,25 @@
 #include "Rendering/Textures/S3OTextureHandler.h"
 
 #include "Sim/MoveTypes/MoveDefHandler.h"
+#include "Sim/Path/PathRequestTracer.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitDefHandler.h"
 #include "Sim/Units/UnitHandler.h"
+#include "Sim/Units/Scripts/CobEngine.h"
 #include "Sim/Units/CommandAI/CommandDescription.h"
 
 #include "System/EventHandler.h"
 #include "System/GlobalConfig.h"
+#include "System/MemoryStats.h"
 #include "System/SafeUtil.h"
 #include "System/TimeProfiler.h"
 #include "System/Log/ILog.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/SimpleParser.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
@@ -245,7 +252,7 @@ public:
 
 class MapMeshDrawerActionExecutor : public IUnsyncedActionExecutor {
 public:
-	MapMeshDrawerActionExecutor() : IUnsyncedActionExecutor("mapmeshdrawer", "Switch map-mesh rendering modes: 0=GCM, 1=HLOD, 2=ROAM") {
+	MapMeshDrawerActionExecutor() : IUnsyncedActionExecutor("mapmeshdrawer", "Switch map-mesh rendering modes: 0=GCM, 1=HLOD, 2=ROAM, 3=ClipMap") {
 	}
 
 	bool Execute(const UnsyncedAction& action) const final {
@@ -1323,10 +1330,15 @@ public:
 
 class DebugGLActionExecutor : public IUnsyncedActionExecutor {
 public:
-	DebugGLActionExecutor() : IUnsyncedActionExecutor("DebugGL", "Enable/Disable OpenGL debug-context output") {
+	DebugGLActionExecutor() : IUnsyncedActionExecutor("DebugGL", "Enable/Disable OpenGL debug-context output, or print per-frame upload statistics with \"stats\"") {
 	}
 
 	bool Execute(const UnsyncedAction& action) const final {
+		if (action.GetArgs() == "stats") {
+			StreamRingArena::GetInstance().LogLastFrameStats();
+			return true;
+		}
+
 		// append zeros so all args can be safely omitted
 
 		int32_t enabled = -1;
@@ -3089,6 +3101,23 @@ public:
 
 
 
+class DebugCOBActionExecutor : public IUnsyncedActionExecutor {
+public:
+	DebugCOBActionExecutor(): IUnsyncedActionExecutor("DebugCOB", "Enable/Disable counting of executed COB opcodes, prints the counts when disabled") {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		if (cobEngine == nullptr)
+			return false;
+
+		cobEngine->SetOpcodeProfiling(!cobEngine->GetOpcodeProfiling());
+		LogSystemStatus("COB opcode profiling", cobEngine->GetOpcodeProfiling());
+		return true;
+	}
+};
+
+
+
 class CrashActionExecutor : public IUnsyncedActionExecutor {
 public:
 	CrashActionExecutor() : IUnsyncedActionExecutor("Crash", "Invoke an artificial crash through a NULL-pointer dereference (SIGSEGV)", true) {
@@ -3250,6 +3279,18 @@ public:
 	}
 };
 
+/// /DumpStateSnapshot, binary counterpart of /DumpState for the current frame
+class DumpStateSnapshotActionExecutor: public IUnsyncedActionExecutor {
+public:
+	DumpStateSnapshotActionExecutor(): IUnsyncedActionExecutor("DumpStateSnapshot", "dump game-state of the current frame to a binary file", true) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		DumpStateSnapshot(gu->myPlayerNum);
+		return true;
+	}
+};
+
 
 
 /// /save [-y ]<savename>
@@ -3351,7 +3392,7 @@ class DebugInfoActionExecutor : public IUnsyncedActionExecutor {
 public:
 	DebugInfoActionExecutor() : IUnsyncedActionExecutor(
 		"DebugInfo",
-		"Print debug info to the chat/log-file about either sound, profiling, or command-descriptions"
+		"Print debug info to the chat/log-file about either sound, profiling, command-descriptions, occlusion culling, or per-subsystem memory use"
 	) {
 	}
 
@@ -3368,8 +3409,106 @@ public:
 			case hashString("cmddescrs"): {
 				commandDescriptionCache.Dump(true);
 			} break;
+			case hashString("occlusion"): {
+				GL::HiZPyramid::GetInstance().PrintDebugInfo();
+			} break;
+			case hashString("memory"): {
+				memoryStats.Update();
+				memoryStats.PrintStats();
+			} break;
+			default: {
+				LOG_L(L_WARNING, "[DbgInfoAction::%s] unknown argument \"%s\" (use \"sound\", \"profiling\", \"cmddescrs\", \"occlusion\", or \"memory\")", __func__, args.c_str());
+			} break;
+		}
+
+		return true;
+	}
+};
+
+
+
+class ProfileTraceActionExecutor : public IUnsyncedActionExecutor {
+public:
+	ProfileTraceActionExecutor() : IUnsyncedActionExecutor(
+		"ProfileTrace",
+		"Start/stop recording a timeline of all profiler timers; stopping writes it as a Chrome trace to the given file (default profile-trace.json)"
+	) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		if (!profiler.IsTracing()) {
+			profiler.SetTracing(true);
+			LOG("[ProfileTraceAction::%s] recording timeline", __func__);
+			return true;
+		}
+
+		profiler.SetTracing(false);
+
+		const std::string& args = action.GetArgs();
+		const std::string path = dataDirsAccess.LocateFile(args.empty()? "profile-trace.json": args, FileQueryFlags::WRITE);
+
+		if (!profiler.WriteTrace(path)) {
+			LOG_L(L_WARNING, "[ProfileTraceAction::%s] could not write timeline to \"%s\"", __func__, path.c_str());
+			return true;
+		}
+
+		LOG("[ProfileTraceAction::%s] wrote timeline to \"%s\"", __func__, path.c_str());
+		return true;
+	}
+};
+
+
+
+class PathTraceActionExecutor : public IUnsyncedActionExecutor {
+public:
+	PathTraceActionExecutor() : IUnsyncedActionExecutor(
+		"PathTrace",
+		"Records RequestPath calls (capture, stop [file]) or replays a recorded trace against the active pathfinder (replay <trace> [results [reference-results]], requires cheats)"
+	) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		const std::vector<std::string>& args = _local_strSpaceTokenize(action.GetArgs());
+
+		if (args.empty())
+			return false;
+
+		switch (hashString(args[0].c_str())) {
+			case hashString("capture"): {
+				pathRequestTracer.StartCapture();
+				LOG("[PathTraceAction::%s] recording path requests", __func__);
+			} break;
+			case hashString("stop"): {
+				const std::string path = dataDirsAccess.LocateFile((args.size() > 1)? args[1]: "path-requests.txt", FileQueryFlags::WRITE);
+
+				unsigned int numRequests = 0;
+
+				if (!pathRequestTracer.StopCapture(path, numRequests)) {
+					LOG_L(L_WARNING, "[PathTraceAction::%s] could not write %u path requests to \"%s\"", __func__, numRequests, path.c_str());
+					break;
+				}
+
+				LOG("[PathTraceAction::%s] wrote %u path requests to \"%s\"", __func__, numRequests, path.c_str());
+			} break;
+			case hashString("replay"): {
+				// replayed requests may advance pathfinder state (QTPFS) outside the simulation
+				if (!gs->cheatEnabled) {
+					LOG_L(L_WARNING, "[PathTraceAction::%s] replays require cheats", __func__);
+					break;
+				}
+				if (args.size() < 2 || pathRequestTracer.IsCapturing()) {
+					LOG_L(L_WARNING, "[PathTraceAction::%s] expected a trace file and no capture in progress", __func__);
+					break;
+				}
+
+				const std::string tracePath = dataDirsAccess.LocateFile(args[1]);
+				const std::string resultsPath = (args.size() > 2)? dataDirsAccess.LocateFile(args[2], FileQueryFlags::WRITE): "";
+				const std::string referencePath = (args.size() > 3)? dataDirsAccess.LocateFile(args[3]): "";
+
+				pathRequestTracer.Replay(tracePath, resultsPath, referencePath);
+			} break;
 			default: {
-				LOG_L(L_WARNING, "[DbgInfoAction::%s] unknown argument \"%s\" (use \"sound\", \"profiling\", or \"cmddescrs\")", __func__, args.c_str());
+				return false;
 			} break;
 		}
 
@@ -3633,6 +3772,7 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<DebugColVolDrawerActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DebugPathDrawerActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DebugTraceRayDrawerActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<DebugCOBActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<MuteActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<SoundActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<SoundChannelEnableActionExecutor>());
@@ -3737,11 +3877,14 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<DestroyActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<SendActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DumpStateActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<DumpStateSnapshotActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<SaveActionExecutor>(true));
 	AddActionExecutor(AllocActionExecutor<SaveActionExecutor>(false));
 	AddActionExecutor(AllocActionExecutor<ReloadShadersActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<ReloadTexturesActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DebugInfoActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<ProfileTraceActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<PathTraceActionExecutor>());
 
 	// XXX are these redirects really required?
 	AddActionExecutor(AllocActionExecutor<RedirectToSyncedActionExecutor>("ATM"));
@@ -0,0 +1,123 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstring>
+
+#include "LuaAddonProfiler.h"
+#include "System/StringHash.h"
+#include "System/TimeProfiler.h"
+
+
+size_t LuaAddonProfiler::GetAddonIndex(const char* handleName, bool synced, const char* addonName, size_t addonNameLen)
+{
+	const uint32_t nameHash = hashString(addonName, addonNameLen);
+	const auto matches = [&](const AddonStats& as) {
+		return (as.name.size() == addonNameLen && std::memcmp(as.name.data(), addonName, addonNameLen) == 0);
+	};
+
+	const auto iter = addonIndices.find(nameHash);
+
+	if (iter != addonIndices.end() && matches(addons[iter->second]))
+		return iter->second;
+
+	if (iter != addonIndices.end()) {
+		const auto it = std::find_if(addons.begin(), addons.end(), matches);
+
+		if (it != addons.end())
+			return (it - addons.begin());
+	}
+
+	addons.emplace_back();
+
+	AddonStats& as = addons.back();
+	as.name.assign(addonName, addonNameLen);
+
+	{
+		// the profiler keeps its own copy of the name
+		const std::string timerName = std::string("Lua::") + handleName + (synced? "::Synced::": "::") + as.name;
+
+		CTimeProfiler::RegisterTimer(timerName.c_str());
+		as.timerHash = hashString(timerName.c_str());
+	}
+
+	if (iter == addonIndices.end())
+		addonIndices[nameHash] = addons.size() - 1;
+
+	return (addons.size() - 1);
+}
+
+
+void LuaAddonProfiler::Begin(const char* handleName, bool synced, const char* addonName, size_t addonNameLen, uint64_t allocSumBytes)
+{
+	if (scopes.size() >= MAX_SCOPE_DEPTH) {
+		for (const Scope& scope: scopes) {
+			addons[scope.addonIndex].depth = 0;
+		}
+
+		scopes.clear();
+	}
+
+	const size_t addonIndex = GetAddonIndex(handleName, synced, addonName, addonNameLen);
+
+	addons[addonIndex].depth += 1;
+	scopes.push_back({addonIndex, spring_gettime(), allocSumBytes});
+}
+
+bool LuaAddonProfiler::End(uint64_t allocSumBytes)
+{
+	if (scopes.empty())
+		return false;
+
+	const Scope scope = scopes.back();
+	const spring_time deltaTime = spring_gettime() - scope.startTime;
+
+	AddonStats& as = addons[scope.addonIndex];
+
+	scopes.pop_back();
+
+	if ((as.depth -= 1) > 0)
+		return true;
+
+	as.totalTime += deltaTime;
+	as.peakTime = std::max(as.peakTime, deltaTime);
+	as.allocBytes += (allocSumBytes - scope.startAllocBytes);
+	as.numCalls += 1;
+
+	profiler.AddTime(as.timerHash, scope.startTime, deltaTime);
+	return true;
+}
+
+
+void LuaAddonProfiler::Clear()
+{
+	// keep the names (and timer registrations), only reset the tallies
+	for (AddonStats& as: addons) {
+		as.totalTime = spring_notime;
+		as.peakTime = spring_notime;
+		as.allocBytes = 0;
+		as.numCalls = 0;
+		as.depth = 0;
+	}
+
+	scopes.clear();
+}
+
+
+std::vector<const LuaAddonProfiler::AddonStats*> LuaAddonProfiler::GetSortedStats() const
+{
+	std::vector<const AddonStats*> sortedStats;
+	sortedStats.reserve(addons.size());
+
+	for (const AddonStats& as: addons) {
+		if (as.numCalls == 0)
+			continue;
+
+		sortedStats.push_back(&as);
+	}
+
+	std::sort(sortedStats.begin(), sortedStats.end(), [](const AddonStats* a, const AddonStats* b) {
+		return (a->totalTime > b->totalTime);
+	});
+
+	return sortedStats;
+}
@@ -0,0 +1,68 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_ADDON_PROFILER_H
+#define LUA_ADDON_PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+#include "System/UnorderedMap.hpp"
+
+/**
+ * Call-in costs of the addons (widgets, gadgets) of a single LuaHandle. The
+ * engine only sees the call-ins of the handle itself, so the addon handler
+ * (written in Lua) brackets its dispatch to an addon with Begin and End; the
+ * time and the Lua bytes allocated in between are charged to that addon and
+ * also fed to the engine profiler as "Lua::<handle>::<addon>" timers, which
+ * makes them show up in the ProfileDrawer.
+ */
+class LuaAddonProfiler {
+public:
+	// scopes that are left open (by a call-in that raised an error) beyond
+	// this depth are dropped rather than tracked forever
+	static constexpr size_t MAX_SCOPE_DEPTH = 64;
+
+	struct AddonStats {
+		std::string name;
+		unsigned int timerHash = 0;
+
+		spring_time totalTime = spring_notime;
+		spring_time peakTime = spring_notime; // longest single call
+
+		uint64_t allocBytes = 0;
+		uint64_t numCalls = 0;
+
+		// open scopes of this addon, only the outermost one is charged
+		uint32_t depth = 0;
+	};
+
+public:
+	void Begin(const char* handleName, bool synced, const char* addonName, size_t addonNameLen, uint64_t allocSumBytes);
+	// false if there is no open scope
+	bool End(uint64_t allocSumBytes);
+
+	void Clear();
+
+	// sorted by total time, in descending order
+	std::vector<const AddonStats*> GetSortedStats() const;
+
+private:
+	struct Scope {
+		size_t addonIndex;
+		spring_time startTime;
+		uint64_t startAllocBytes;
+	};
+
+	size_t GetAddonIndex(const char* handleName, bool synced, const char* addonName, size_t addonNameLen);
+
+private:
+	std::vector<AddonStats> addons;
+	std::vector<Scope> scopes;
+
+	// keyed by hash of the addon name; collisions fall back to a linear search
+	spring::unsynced_map<uint32_t, size_t> addonIndices;
+};
+
+#endif // LUA_ADDON_PROFILER_H
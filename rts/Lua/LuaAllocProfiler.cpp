@@ -0,0 +1,92 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaAllocProfiler.h"
+#include "LuaContextData.h"
+#include "LuaInclude.h"
+
+
+void LuaAllocProfiler::Enable(lua_State* L, int hookPeriod)
+{
+	// replaces any hook set through debug.sethook on the main thread of the handle
+	lua_sethook(L, Hook, LUA_MASKCOUNT, std::max(1, hookPeriod));
+
+	pendingBytes = 0;
+	enabled = true;
+}
+
+void LuaAllocProfiler::Disable(lua_State* L)
+{
+	if (!enabled)
+		return;
+
+	lua_sethook(L, nullptr, 0, 0);
+
+	pendingBytes = 0;
+	enabled = false;
+}
+
+void LuaAllocProfiler::Clear()
+{
+	sites.clear();
+	sizeClassCounts.fill(0);
+
+	pendingBytes = 0;
+}
+
+
+std::vector<const LuaAllocProfiler::AllocSite*> LuaAllocProfiler::GetTopSites(size_t maxSites) const
+{
+	std::vector<const AllocSite*> topSites;
+	topSites.reserve(sites.size());
+
+	for (const auto& pair: sites) {
+		topSites.push_back(&pair.second);
+	}
+
+	const auto pred = [](const AllocSite* a, const AllocSite* b) { return (a->allocBytes > b->allocBytes); };
+	const auto iter = topSites.begin() + std::min(maxSites, topSites.size());
+
+	std::partial_sort(topSites.begin(), iter, topSites.end(), pred);
+	topSites.erase(iter, topSites.end());
+
+	return topSites;
+}
+
+
+void LuaAllocProfiler::Hook(lua_State* L, lua_Debug* ar)
+{
+	LuaAllocProfiler* profiler = GetLuaContextData(L)->allocProfiler;
+
+	if (profiler == nullptr)
+		return;
+
+	profiler->Sample(L);
+}
+
+void LuaAllocProfiler::Sample(lua_State* L)
+{
+	if (pendingBytes == 0)
+		return;
+
+	lua_Debug ar;
+
+	// level 0 is the function the count-hook interrupted
+	if (lua_getstack(L, 0, &ar) == 0 || lua_getinfo(L, "Sl", &ar) == 0)
+		return;
+
+	std::string key = ar.short_src;
+	key += ':';
+	key += std::to_string(ar.currentline);
+
+	AllocSite& site = sites[key];
+
+	if (site.numSamples == 0) {
+		site.source = ar.short_src;
+		site.line = ar.currentline;
+	}
+
+	site.numSamples += 1;
+	site.allocBytes += pendingBytes;
+
+	pendingBytes = 0;
+}
@@ -0,0 +1,75 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_ALLOC_PROFILER_H
+#define LUA_ALLOC_PROFILER_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/bitops.h"
+#include "System/UnorderedMap.hpp"
+
+struct lua_State;
+struct lua_Debug;
+
+/**
+ * Sampling allocation profiler of a single LuaHandle. The allocator feeds it a
+ * size-class histogram and a running byte count; a count-hook then charges the
+ * bytes allocated since its previous sample to the Lua function and line that
+ * is executing, since walking the Lua stack from inside the allocator itself
+ * is not safe (it may be reallocating that very stack).
+ */
+class LuaAllocProfiler {
+public:
+	static constexpr uint32_t NUM_SIZE_CLASSES = 32;
+	static constexpr int DEFAULT_HOOK_PERIOD = 1000; // VM instructions between samples
+
+	struct AllocSite {
+		std::string source;
+		int line = 0;
+
+		uint64_t numSamples = 0;
+		uint64_t allocBytes = 0;
+	};
+
+public:
+	void Enable(lua_State* L, int hookPeriod);
+	void Disable(lua_State* L);
+	void Clear();
+
+	bool IsEnabled() const { return enabled; }
+
+	// called by spring_lua_alloc for every allocation that grows a block
+	void RecordAlloc(size_t osize, size_t nsize) {
+		if (!enabled)
+			return;
+
+		sizeClassCounts[std::min(log_base_2(uint32_t(nsize)), NUM_SIZE_CLASSES - 1)] += 1;
+		pendingBytes += (nsize - osize);
+	}
+
+	const std::array<uint64_t, NUM_SIZE_CLASSES>& GetSizeClassCounts() const { return sizeClassCounts; }
+
+	// the <maxSites> sites that allocated the most bytes, in descending order
+	std::vector<const AllocSite*> GetTopSites(size_t maxSites) const;
+
+private:
+	static void Hook(lua_State* L, lua_Debug* ar);
+
+	void Sample(lua_State* L);
+
+private:
+	spring::unsynced_map<std::string, AllocSite> sites; // keyed by "source:line"
+
+	std::array<uint64_t, NUM_SIZE_CLASSES> sizeClassCounts = {};
+
+	// bytes allocated since the last sample, charged to the next one
+	uint64_t pendingBytes = 0;
+
+	bool enabled = false;
+};
+
+#endif // LUA_ALLOC_PROFILER_H
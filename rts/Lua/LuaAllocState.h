@@ -10,6 +10,7 @@ struct SLuaAllocState {
 	std::atomic<uint64_t> numLuaAllocs;
 	std::atomic<uint64_t> luaAllocTime;
 	std::atomic<uint64_t> numLuaStates;
+	std::atomic<uint64_t> allocSumBytes; // total grown bytes, never decreases
 };
 
 #endif
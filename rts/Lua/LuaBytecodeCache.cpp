@@ -0,0 +1,193 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaBytecodeCache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "LuaInclude.h"
+#include "Game/GameVersion.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/ILog.h"
+#include "System/Sync/SHA512.hpp"
+
+CONFIG(bool, LuaBytecodeCache).defaultValue(true).description("Cache compiled Lua gadgets, widgets and includes in the cache directory so they are only parsed again after their source changes.");
+
+
+namespace {
+	constexpr char CACHE_FILE_MAGIC[4] = {'S', 'L', 'B', 'C'};
+	constexpr uint32_t CACHE_FILE_VERSION = 1;
+
+	struct CacheFileHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t bytecodeSize;
+		uint8_t sourceHash[sha512::SHA_LEN];
+		uint8_t bytecodeHash[sha512::SHA_LEN];
+	};
+
+	struct BytecodeReader {
+		const char* data;
+		size_t size;
+	};
+
+
+	const std::string& GetCacheDir()
+	{
+		// empty if the cache is disabled or could not be created
+		static const std::string cacheDir = configHandler->GetBool("LuaBytecodeCache")?
+			dataDirsAccess.LocateDir(FileSystem::GetCacheDir() + "/luabytecode/", FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS):
+			"";
+		return cacheDir;
+	}
+
+	void CalcSourceHash(const char* code, size_t size, const char* chunkName, uint8_t hash[sha512::SHA_LEN])
+	{
+		// a different engine build may compile the same source differently;
+		// the lua_load header check only catches type-size and format changes
+		static const std::string buildTag = SpringVersion::GetFull() + " " + LUA_RELEASE;
+
+		const size_t chunkNameLen = std::strlen(chunkName);
+
+		std::vector<uint8_t> msg;
+		msg.reserve(buildTag.size() + 1 + chunkNameLen + 1 + size);
+		msg.insert(msg.end(), buildTag.begin(), buildTag.end());
+		msg.push_back(0);
+		msg.insert(msg.end(), chunkName, chunkName + chunkNameLen);
+		msg.push_back(0);
+		msg.insert(msg.end(), code, code + size);
+
+		sha512::calc_digest(msg.data(), msg.size(), hash);
+	}
+
+	std::string GetCacheFileName(const uint8_t sourceHash[sha512::SHA_LEN])
+	{
+		char hex[8 * 2 + 1];
+
+		for (int i = 0; i < 8; i++) {
+			snprintf(&hex[i * 2], 3, "%02x", sourceHash[i]);
+		}
+
+		return (GetCacheDir() + hex + ".luac");
+	}
+
+
+	const char* ReadBytecode(lua_State* L, void* data, size_t* size)
+	{
+		BytecodeReader* reader = static_cast<BytecodeReader*>(data);
+
+		// hand out the whole chunk at once, then signal its end
+		*size = reader->size;
+		reader->size = 0;
+		return reader->data;
+	}
+
+	int WriteBytecode(lua_State* L, const void* p, size_t size, void* data)
+	{
+		std::vector<char>* bytecode = static_cast<std::vector<char>*>(data);
+		bytecode->insert(bytecode->end(), static_cast<const char*>(p), static_cast<const char*>(p) + size);
+		return 0;
+	}
+
+
+	bool LoadCached(lua_State* L, const std::string& fileName, const uint8_t sourceHash[sha512::SHA_LEN], const char* chunkName)
+	{
+		std::ifstream file(fileName, std::ios::in | std::ios::binary);
+
+		if (!file.is_open())
+			return false;
+
+		CacheFileHeader header;
+
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+
+		if (std::memcmp(header.magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC)) != 0 || header.version != CACHE_FILE_VERSION)
+			return false;
+		// a 64-bit prefix of the hash names the file, the full one has to match
+		if (std::memcmp(header.sourceHash, sourceHash, sha512::SHA_LEN) != 0)
+			return false;
+
+		std::vector<char> bytecode(header.bytecodeSize);
+
+		if (!file.read(bytecode.data(), bytecode.size()))
+			return false;
+
+		// never hand a truncated or otherwise damaged chunk to the undumper
+		uint8_t bytecodeHash[sha512::SHA_LEN];
+		sha512::calc_digest(reinterpret_cast<const uint8_t*>(bytecode.data()), bytecode.size(), bytecodeHash);
+
+		if (std::memcmp(header.bytecodeHash, bytecodeHash, sha512::SHA_LEN) != 0)
+			return false;
+
+		if (bytecode.empty() || bytecode[0] != LUA_SIGNATURE[0])
+			return false;
+
+		BytecodeReader reader = {bytecode.data(), bytecode.size()};
+
+		if (lua_load(L, ReadBytecode, &reader, chunkName) != 0) {
+			lua_pop(L, 1);
+			return false;
+		}
+
+		return true;
+	}
+
+	void SaveCached(lua_State* L, const std::string& fileName, const uint8_t sourceHash[sha512::SHA_LEN])
+	{
+		std::vector<char> bytecode;
+
+		// dumps the function at the top of the stack, debug info included
+		if (lua_dump(L, WriteBytecode, &bytecode) != 0 || bytecode.empty())
+			return;
+
+		CacheFileHeader header;
+
+		std::memcpy(header.magic, CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+		std::memcpy(header.sourceHash, sourceHash, sha512::SHA_LEN);
+		sha512::calc_digest(reinterpret_cast<const uint8_t*>(bytecode.data()), bytecode.size(), header.bytecodeHash);
+
+		header.version = CACHE_FILE_VERSION;
+		header.bytecodeSize = bytecode.size();
+
+		std::ofstream file(fileName, std::ios::out | std::ios::binary);
+
+		if (!file.is_open())
+			return;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(bytecode.data(), bytecode.size());
+
+		if (!file.good())
+			LOG_L(L_WARNING, "[LuaBytecodeCache::%s] could not write \"%s\"", __func__, fileName.c_str());
+	}
+}
+
+
+int LuaBytecodeCache::LoadBuffer(lua_State* L, const char* code, size_t size, const char* chunkName)
+{
+	// precompiled input is loaded as-is, tiny chunks are not worth a file
+	if (size < MIN_CACHED_CHUNK_SIZE || code[0] == LUA_SIGNATURE[0] || GetCacheDir().empty())
+		return (luaL_loadbuffer(L, code, size, chunkName));
+
+	uint8_t sourceHash[sha512::SHA_LEN];
+	CalcSourceHash(code, size, chunkName, sourceHash);
+
+	const std::string fileName = GetCacheFileName(sourceHash);
+
+	if (LoadCached(L, fileName, sourceHash, chunkName))
+		return 0;
+
+	const int error = luaL_loadbuffer(L, code, size, chunkName);
+
+	if (error == 0)
+		SaveCached(L, fileName, sourceHash);
+
+	return error;
+}
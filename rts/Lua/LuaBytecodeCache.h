@@ -0,0 +1,27 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_BYTECODE_CACHE_H
+#define LUA_BYTECODE_CACHE_H
+
+#include <cstddef>
+
+struct lua_State;
+
+/**
+ * Keeps the compiled form of every sizable Lua chunk in the cache directory,
+ * keyed by the hash of its source, chunk name and the engine build. A cache
+ * hit only skips the parser; the loaded prototype (constants, debug info and
+ * all) is the one the compiler produced from identical input, so synced code
+ * behaves exactly as if it had been compiled afresh.
+ */
+class LuaBytecodeCache {
+public:
+	/// drop-in replacement for luaL_loadbuffer
+	static int LoadBuffer(lua_State* L, const char* code, size_t size, const char* chunkName);
+
+private:
+	// below this the file lookup costs more than compiling
+	static constexpr size_t MIN_CACHED_CHUNK_SIZE = 4096;
+};
+
+#endif // LUA_BYTECODE_CACHE_H
@@ -3,6 +3,8 @@
 #ifndef LUA_CONTEXT_DATA_H
 #define LUA_CONTEXT_DATA_H
 
+#include "Lua/LuaAddonProfiler.h"
+#include "Lua/LuaAllocProfiler.h"
 #include "Lua/LuaAllocState.h"
 #include "Lua/LuaGarbageCollectCtrl.h"
 #include "LuaMemPool.h"
@@ -29,6 +31,8 @@ public:
 	: owner(nullptr)
 	, luamutex(nullptr)
 	, memPool(LuaMemPool::AcquirePtr(sharedPool, stateOwned))
+	, allocProfiler(nullptr)
+	, addonProfiler(nullptr)
 	, parser(nullptr)
 
 	, synced(false)
@@ -45,7 +49,7 @@ public:
 	, readAllyTeam(0)
 	, selectTeam(CEventClient::NoAccessTeam)
 
-	, allocState{{0}, {0}, {0}, {0}}
+	, allocState{{0}, {0}, {0}, {0}, {0}}
 	{}
 
 	~luaContextData() {
@@ -79,6 +83,8 @@ public:
 	spring::recursive_mutex* luamutex;
 
 	LuaMemPool* memPool;
+	LuaAllocProfiler* allocProfiler; // owned by the handle, null for ownerless states
+	LuaAddonProfiler* addonProfiler; // ditto
 	LuaParser* parser;
 
 	bool synced;
@@ -3,6 +3,7 @@
 #ifndef SPRING_LUA_GARBAGE_COLLECT_CTRL_H
 #define SPRING_LUA_GARBAGE_COLLECT_CTRL_H
 
+#include <cstdint>
 #include <limits>
 
 struct SLuaGarbageCollectCtrl {
@@ -20,6 +21,17 @@ struct SLuaGarbageCollectCtrl {
 
 	float baseRunTimeMult = 0.0f;
 	float baseMemLoadMult = 0.0f;
+
+	// per-call budget of the adaptive controller, in milliseconds; 0 := off,
+	// CollectGarbage then follows baseRunTimeMult and the global memory load
+	float frameBudget = 0.0f;
+	// fraction of frameBudget spent per call, raised while the handle allocates
+	// more than collection frees and lowered again once collection keeps up
+	float budgetEffort = 1.0f;
+	float minBudgetEffort = 1.0f / 16.0f;
+
+	// allocState.allocSumBytes at the end of the previous call
+	uint64_t lastAllocSum = 0;
 };
 
 #endif
@@ -6,6 +6,7 @@
 #include "LuaRules.h"
 #include "LuaUI.h"
 
+#include "LuaBytecodeCache.h"
 #include "LuaCallInCheck.h"
 #include "LuaConfig.h"
 #include "LuaHashString.h"
@@ -28,8 +29,10 @@
 #include "Sim/Features/FeatureDef.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitDefHandler.h"
 #include "Sim/Weapons/Weapon.h"
 #include "Sim/Weapons/WeaponDef.h"
+#include "Sim/Weapons/WeaponDefHandler.h"
 #include "System/creg/SerializeLuaState.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
@@ -54,6 +57,7 @@
 
 CONFIG(float, LuaGarbageCollectionMemLoadMult).defaultValue(1.33f).minimumValue(1.0f).maximumValue(100.0f);
 CONFIG(float, LuaGarbageCollectionRunTimeMult).defaultValue(5.0f).minimumValue(1.0f).description("in milliseconds");
+CONFIG(float, LuaGarbageCollectionFrameBudget).defaultValue(0.0f).minimumValue(0.0f).maximumValue(100.0f).description("Milliseconds each Lua handle may spend per garbage-collection call; the share of it actually used follows the handle's allocation rate. 0 keeps the memory-load based schedule set by LuaGarbageCollection{MemLoad,RunTime}Mult.");
 
 
 static spring::unsynced_set<const luaContextData*>    SYNCED_LUAHANDLE_CONTEXTS;
@@ -104,9 +108,12 @@ CLuaHandle::CLuaHandle(const string& _name, int _order, bool _userMode, bool _sy
 {
 	D.owner = this;
 	D.synced = _synced;
+	D.allocProfiler = &allocProfiler;
+	D.addonProfiler = &addonProfiler;
 
 	D.gcCtrl.baseMemLoadMult = configHandler->GetFloat("LuaGarbageCollectionMemLoadMult");
 	D.gcCtrl.baseRunTimeMult = configHandler->GetFloat("LuaGarbageCollectionRunTimeMult");
+	D.gcCtrl.frameBudget = configHandler->GetFloat("LuaGarbageCollectionFrameBudget");
 
 	L = LUA_OPEN(&D);
 	L_GC = lua_newthread(L);
@@ -449,7 +456,7 @@ bool CLuaHandle::LoadCode(lua_State* L, const string& code, const string& debug)
 
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	const int error = luaL_loadbuffer(L, code.c_str(), code.size(), debug.c_str());
+	const int error = LuaBytecodeCache::LoadBuffer(L, code.c_str(), code.size(), debug.c_str());
 
 	if (error != 0) {
 		LOG_L(L_ERROR, "[%s::%s] error=%i (%s) debug=%s msg=%s", name.c_str(), __func__, error, LuaErrorString(error), debug.c_str(), lua_tostring(L, -1));
@@ -2557,7 +2564,10 @@ void CLuaHandle::CollectGarbage(bool forced)
 	const float gcMemLoadMult = D.gcCtrl.baseMemLoadMult;
 	const float gcRunTimeMult = D.gcCtrl.baseRunTimeMult;
 
-	if (!forced && spring_lua_alloc_skip_gc(gcMemLoadMult))
+	// the adaptive controller never skips calls, it varies their length instead
+	const bool gcAdaptive = (D.gcCtrl.frameBudget > 0.0f);
+
+	if (!forced && !gcAdaptive && spring_lua_alloc_skip_gc(gcMemLoadMult))
 		return;
 
 	LUA_CALL_IN_CHECK_NAMED(L, (GetLuaContextData(L)->synced)? "Lua::CollectGarbage::Synced": "Lua::CollectGarbage::Unsynced");
@@ -2567,6 +2577,7 @@ void CLuaHandle::CollectGarbage(bool forced)
 
 	// note: total footprint INCLUDING garbage, in KB
 	int  gcMemFootPrint = lua_gc(L_GC, LUA_GCCOUNT, 0);
+	int  gcMemFootPrintPre = gcMemFootPrint;
 	int  gcItersInBatch = 0;
 	int& gcStepsPerIter = D.gcCtrl.numStepsPerIter;
 
@@ -2577,7 +2588,8 @@ void CLuaHandle::CollectGarbage(bool forced)
 	// mean too much time is spent on it, must weigh the per-call period
 	const float gcSpeedFactor = Clamp(gs->speedFactor * (1 - gs->PreSimFrame()) * (1 - gs->paused), 1.0f, 50.0f);
 	const float gcBaseRunTime = smoothstep(10.0f, 100.0f, gcMemFootPrint / 1024);
-	const float gcLoopRunTime = Clamp((gcBaseRunTime * gcRunTimeMult) / gcSpeedFactor, D.gcCtrl.minLoopRunTime, D.gcCtrl.maxLoopRunTime);
+	const float gcFixedRunTime = Clamp((gcBaseRunTime * gcRunTimeMult) / gcSpeedFactor, D.gcCtrl.minLoopRunTime, D.gcCtrl.maxLoopRunTime);
+	const float gcLoopRunTime = gcAdaptive? std::min(D.gcCtrl.frameBudget * D.gcCtrl.budgetEffort, D.gcCtrl.maxLoopRunTime): gcFixedRunTime;
 
 	const spring_time startTime = spring_gettime();
 	const spring_time   endTime = startTime + spring_msecs(gcLoopRunTime);
@@ -2600,6 +2612,23 @@ void CLuaHandle::CollectGarbage(bool forced)
 			break;
 	}
 
+	if (gcAdaptive && !forced) {
+		// compare what the handle allocated since the previous call with what
+		// this one freed; grow the effort while garbage piles up faster than
+		// it is collected, decay it (avoiding needless per-frame cost) after
+		const uint64_t allocSum = D.allocState.allocSumBytes.load();
+		const uint64_t allocKB = (allocSum - D.gcCtrl.lastAllocSum) / 1024;
+		const int64_t freedKB = int64_t(gcMemFootPrintPre) - lua_gc(L_GC, LUA_GCCOUNT, 0);
+
+		if (freedKB < int64_t(allocKB)) {
+			D.gcCtrl.budgetEffort = std::min(D.gcCtrl.budgetEffort * 1.25f, 1.0f);
+		} else {
+			D.gcCtrl.budgetEffort = std::max(D.gcCtrl.budgetEffort * 0.8f, D.gcCtrl.minBudgetEffort);
+		}
+
+		D.gcCtrl.lastAllocSum = allocSum;
+	}
+
 	// don't collect garbage outside of CollectGarbage
 	lua_gc(L_GC, LUA_GCSTOP, 0);
 	SetHandleRunning(L_GC, false);
@@ -2641,6 +2670,10 @@ bool CLuaHandle::AddBasicCalls(lua_State* L)
 		HSTR_PUSH_CFUNC(L, "GetRegistry",     CallOutGetRegistry);
 		HSTR_PUSH_CFUNC(L, "GetCallInList",   CallOutGetCallInList);
 		HSTR_PUSH_CFUNC(L, "IsEngineMinVersion", CallOutIsEngineMinVersion);
+		HSTR_PUSH_CFUNC(L, "GetWatchUnitEvent",   CallOutGetWatchUnitEvent);
+		HSTR_PUSH_CFUNC(L, "SetWatchUnitEvent",   CallOutSetWatchUnitEvent);
+		HSTR_PUSH_CFUNC(L, "GetWatchDamageWeapon", CallOutGetWatchDamageWeapon);
+		HSTR_PUSH_CFUNC(L, "SetWatchDamageWeapon", CallOutSetWatchDamageWeapon);
 		// special team constants
 		HSTR_PUSH_NUMBER(L, "NO_ACCESS_TEAM",  CEventClient::NoAccessTeam);
 		HSTR_PUSH_NUMBER(L, "ALL_ACCESS_TEAM", CEventClient::AllAccessTeam);
@@ -2770,5 +2803,89 @@ int CLuaHandle::CallOutUpdateCallIn(lua_State* L)
 }
 
 
+static_assert(CSolidObject::DAMAGE_EXTSOURCE_CRUSHED < CEventClient::DAMAGE_WEAPON_FILTER_OFFSET, "");
+
+static int ParseDefFilterEvent(lua_State* L, const char* caller, int index)
+{
+	const char* eventName = luaL_checkstring(L, index);
+
+	if (strcmp(eventName, "UnitCreated"  ) == 0) return CEventClient::DEF_FILTER_UNIT_CREATED;
+	if (strcmp(eventName, "UnitFinished" ) == 0) return CEventClient::DEF_FILTER_UNIT_FINISHED;
+	if (strcmp(eventName, "UnitDestroyed") == 0) return CEventClient::DEF_FILTER_UNIT_DESTROYED;
+	if (strcmp(eventName, "UnitDamaged"  ) == 0) return CEventClient::DEF_FILTER_UNIT_DAMAGED;
+
+	luaL_error(L, "[%s] call-in \"%s\" can not be filtered by unitDefID", caller, eventName);
+	return -1;
+}
+
+// (defID, watch) at stack index 1 and 2; a nil defID (un)subscribes every def,
+// the first single-def change of an unfiltered client starts from nothing watched
+static void SetDefFilterMask(lua_State* L, std::vector<bool>& mask, size_t maskSize, int maskOffset)
+{
+	const bool watch = luaL_checkboolean(L, 2);
+
+	if (lua_isnoneornil(L, 1)) {
+		if (watch) {
+			mask.clear();
+		} else {
+			mask.assign(maskSize, false);
+		}
+		return;
+	}
+
+	const size_t maskIdx = luaL_checkint(L, 1) + maskOffset;
+
+	if (mask.empty())
+		mask.assign(maskSize, false);
+
+	if (maskIdx < mask.size())
+		mask[maskIdx] = watch;
+}
+
+
+int CLuaHandle::CallOutGetWatchUnitEvent(lua_State* L)
+{
+	const CLuaHandle* lh = GetHandle(L);
+	const int event = ParseDefFilterEvent(L, __func__, 1);
+
+	const std::vector<bool>& mask = lh->unitDefFilters[event];
+	const size_t maskIdx = luaL_checkint(L, 2);
+
+	lua_pushboolean(L, mask.empty() || (maskIdx < mask.size() && mask[maskIdx]));
+	return 1;
+}
+
+int CLuaHandle::CallOutSetWatchUnitEvent(lua_State* L)
+{
+	if (unitDefHandler == nullptr)
+		luaL_error(L, "[%s] no unitDefs loaded", __func__);
+
+	CLuaHandle* lh = GetHandle(L);
+	const int event = ParseDefFilterEvent(L, __func__, 1);
+
+	// shift the (defID, watch) arguments down to where SetDefFilterMask expects them
+	lua_remove(L, 1);
+	SetDefFilterMask(L, lh->unitDefFilters[event], unitDefHandler->NumUnitDefs() + 1, 0);
+	return 0;
+}
+
+int CLuaHandle::CallOutGetWatchDamageWeapon(lua_State* L)
+{
+	lua_pushboolean(L, GetHandle(L)->WantsDamageWeaponDef(luaL_checkint(L, 1)));
+	return 1;
+}
+
+int CLuaHandle::CallOutSetWatchDamageWeapon(lua_State* L)
+{
+	if (weaponDefHandler == nullptr)
+		luaL_error(L, "[%s] no weaponDefs loaded", __func__);
+
+	CLuaHandle* lh = GetHandle(L);
+
+	SetDefFilterMask(L, lh->damageWeaponDefFilter, weaponDefHandler->NumWeaponDefs() + DAMAGE_WEAPON_FILTER_OFFSET, DAMAGE_WEAPON_FILTER_OFFSET);
+	return 0;
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
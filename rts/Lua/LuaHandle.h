@@ -63,6 +63,9 @@ class CLuaHandle : public CEventClient
 
 	#undef PERMISSIONS_FUNCS
 
+		// permissions can be changed at any time, e.g. by Spring.SelectTeam
+		bool HasDynamicReadAccess() const override { return true; }
+
 		static bool GetHandleSynced(const lua_State* L) { return GetLuaContextData(L)->synced; }
 
 		bool GetUserMode() const { return userMode; }
@@ -314,6 +317,9 @@ class CLuaHandle : public CEventClient
 
 		lua_State* L;
 		lua_State* L_GC;
+		// declared before D, the allocator uses it until the state is closed
+		LuaAllocProfiler allocProfiler;
+		LuaAddonProfiler addonProfiler;
 		luaContextData D;
 
 		std::string killMsg;
@@ -339,6 +345,10 @@ class CLuaHandle : public CEventClient
 		static int CallOutGetCallInList(lua_State* L);
 		static int CallOutUpdateCallIn(lua_State* L);
 		static int CallOutIsEngineMinVersion(lua_State* L);
+		static int CallOutGetWatchUnitEvent(lua_State* L);
+		static int CallOutSetWatchUnitEvent(lua_State* L);
+		static int CallOutGetWatchDamageWeapon(lua_State* L);
+		static int CallOutSetWatchDamageWeapon(lua_State* L);
 
 	public: // static
 #if (!defined(UNITSYNC) && !defined(DEDICATED))
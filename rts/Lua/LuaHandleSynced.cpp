@@ -6,6 +6,7 @@
 
 #include "LuaUtils.h"
 #include "LuaArchive.h"
+#include "LuaBytecodeCache.h"
 #include "LuaCallInCheck.h"
 #include "LuaConfig.h"
 #include "LuaConstGL.h"
@@ -184,6 +185,48 @@ void CUnsyncedLuaHandle::RecvFromSynced(lua_State* srcState, int args)
 	RunCallIn(L, cmdStr, args, 0);
 }
 
+void CUnsyncedLuaHandle::RecvFromSyncedBatch()
+{
+	CSplitLuaHandle::MessageBatch& batch = base.messageBatch;
+
+	if (batch.GetNumMessages() == 0)
+		return;
+
+	if (!IsValid()) {
+		batch.Clear();
+		return;
+	}
+
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 4, __func__);
+
+	static const LuaHashString cmdStr(__func__);
+	static const LuaHashString recvStr("RecvFromSynced");
+
+	if (cmdStr.GetGlobalFunc(L)) {
+		lua_pushcfunction(L, NextSyncedMessage);
+		lua_pushnumber(L, batch.GetNumMessages());
+
+		// call the routine
+		RunCallIn(L, cmdStr, 2, 0);
+	} else {
+		// handlers without the batched call-in get one RecvFromSynced per message
+		while (recvStr.GetGlobalFunc(L)) {
+			const int numArgs = batch.Read(L);
+
+			if (numArgs < 0) {
+				lua_pop(L, 1);
+				break;
+			}
+
+			RunCallIn(L, recvStr, numArgs, 0);
+		}
+	}
+
+	// also ends the iterator if Lua kept a reference to it
+	batch.Clear();
+}
+
 
 bool CUnsyncedLuaHandle::DrawUnit(const CUnit* unit)
 {
@@ -329,6 +372,12 @@ bool CUnsyncedLuaHandle::DrawMaterial(const LuaMaterial* material)
 // Call-Outs
 //
 
+int CUnsyncedLuaHandle::NextSyncedMessage(lua_State* L)
+{
+	// nothing once the batch has been delivered
+	return std::max(GetUnsyncedHandle(L)->base.messageBatch.Read(L), 0);
+}
+
 
 /******************************************************************************/
 /******************************************************************************/
@@ -429,6 +478,7 @@ bool CSyncedLuaHandle::Init(const std::string& code, const std::string& file)
 
 	// add the custom file loader
 	LuaPushNamedCFunc(L, "SendToUnsynced", SendToUnsynced);
+	LuaPushNamedCFunc(L, "SendToUnsyncedBatched", SendToUnsyncedBatched);
 	LuaPushNamedCFunc(L, "CallAsTeam",     CSplitLuaHandle::CallAsTeam);
 	LuaPushNamedNumber(L, "COBSCALE",      COBSCALE);
 
@@ -1502,11 +1552,11 @@ int CSyncedLuaHandle::SyncedPairs(lua_State* L)
 }
 
 
-int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
+static int CheckSendToUnsyncedArgs(lua_State* L, const char* caller)
 {
 	const int args = lua_gettop(L);
 	if (args <= 0) {
-		luaL_error(L, "Incorrect arguments to SendToUnsynced()");
+		luaL_error(L, "Incorrect arguments to %s()", caller);
 	}
 
 	static const int supportedTypes =
@@ -1519,15 +1569,34 @@ int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
 	for (int i = 1; i <= args; i++) {
 		const int t = (1 << lua_type(L, i));
 		if (!(t & supportedTypes)) {
-			luaL_error(L, "Incorrect data type for SendToUnsynced(), arg %d", i);
+			luaL_error(L, "Incorrect data type for %s(), arg %d", caller, i);
 		}
 	}
 
+	return args;
+}
+
+int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
+{
+	const int args = CheckSendToUnsyncedArgs(L, __func__);
+
 	CUnsyncedLuaHandle* ulh = CSplitLuaHandle::GetUnsyncedHandle(L);
 	ulh->RecvFromSynced(L, args);
 	return 0;
 }
 
+int CSyncedLuaHandle::SendToUnsyncedBatched(lua_State* L)
+{
+	const int args = CheckSendToUnsyncedArgs(L, __func__);
+
+	// the generic-for over the unsynced iterator stops at a leading nil
+	if (lua_isnil(L, 1))
+		luaL_error(L, "Incorrect arguments to %s(), arg 1 must not be nil", __func__);
+
+	GetSyncedHandle(L)->base.messageBatch.Append(L, args);
+	return 0;
+}
+
 
 int CSyncedLuaHandle::AddSyncedActionFallback(lua_State* L)
 {
@@ -1689,6 +1758,71 @@ CSplitLuaHandle::~CSplitLuaHandle()
 }
 
 
+void CSplitLuaHandle::MessageBatch::Append(lua_State* L, int numArgs)
+{
+	WriteValue<uint32_t>(numArgs);
+
+	for (int i = 1; i <= numArgs; i++) {
+		const int type = lua_type(L, i);
+
+		data.push_back(type);
+
+		switch (type) {
+			case LUA_TBOOLEAN: {
+				data.push_back(lua_toboolean(L, i));
+			} break;
+			case LUA_TNUMBER: {
+				WriteValue<lua_Number>(lua_tonumber(L, i));
+			} break;
+			case LUA_TSTRING: {
+				size_t len = 0;
+				const char* str = lua_tolstring(L, i, &len);
+
+				WriteValue<uint32_t>(len);
+				data.insert(data.end(), str, str + len);
+			} break;
+			default: {
+				// nil
+			} break;
+		}
+	}
+
+	numMessages += 1;
+}
+
+int CSplitLuaHandle::MessageBatch::Read(lua_State* L)
+{
+	if (readPos >= data.size())
+		return -1;
+
+	const int numArgs = ReadValue<uint32_t>();
+
+	luaL_checkstack(L, numArgs, __func__);
+
+	for (int i = 0; i < numArgs; i++) {
+		switch (data[readPos++]) {
+			case LUA_TBOOLEAN: {
+				lua_pushboolean(L, data[readPos++]);
+			} break;
+			case LUA_TNUMBER: {
+				lua_pushnumber(L, ReadValue<lua_Number>());
+			} break;
+			case LUA_TSTRING: {
+				const uint32_t len = ReadValue<uint32_t>();
+
+				lua_pushlstring(L, reinterpret_cast<const char*>(&data[readPos]), len);
+				readPos += len;
+			} break;
+			default: {
+				lua_pushnil(L);
+			} break;
+		}
+	}
+
+	return numArgs;
+}
+
+
 bool CSplitLuaHandle::InitSynced(bool dryRun)
 {
 	if (!IsValid()) {
@@ -1821,7 +1955,12 @@ int CSplitLuaHandle::LoadStringData(lua_State* L)
 	const char *str    = luaL_checklstring(L, 1, &len);
 	const char *chunkname = luaL_optstring(L, 2, str);
 
-	if (luaL_loadbuffer(L, str, len, chunkname) != 0) {
+	// only named chunks (i.e. gadget files) are worth caching, not runtime snippets
+	const int error = lua_isstring(L, 2)?
+		LuaBytecodeCache::LoadBuffer(L, str, len, chunkname):
+		luaL_loadbuffer(L, str, len, chunkname);
+
+	if (error != 0) {
 		lua_pushnil(L);
 		lua_insert(L, -2);
 		return 2; // nil, then the error message
@@ -3,7 +3,9 @@
 #ifndef LUA_HANDLE_SYNCED
 #define LUA_HANDLE_SYNCED
 
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include "LuaHandle.h"
 #include "LuaRulesParams.h"
@@ -28,6 +30,7 @@ class CUnsyncedLuaHandle : public CLuaHandle
 
 	public: // all non-eventhandler callins
 		void RecvFromSynced(lua_State* srcState, int args); // not an engine call-in
+		void RecvFromSyncedBatch(); // not an engine call-in
 
 	protected:
 		CUnsyncedLuaHandle(CSplitLuaHandle* base, const std::string& name, int order);
@@ -42,6 +45,9 @@ class CUnsyncedLuaHandle : public CLuaHandle
 
 	protected:
 		CSplitLuaHandle& base;
+
+	private: // call-outs
+		static int NextSyncedMessage(lua_State* L);
 };
 
 
@@ -146,6 +152,7 @@ class CSyncedLuaHandle : public CLuaHandle
 		static int SyncedPairs(lua_State* L);
 
 		static int SendToUnsynced(lua_State* L);
+		static int SendToUnsyncedBatched(lua_State* L);
 
 		static int AddSyncedActionFallback(lua_State* L);
 		static int RemoveSyncedActionFallback(lua_State* L);
@@ -209,6 +216,9 @@ class CSplitLuaHandle
 			return &ulh->base.syncedLuaHandle;
 		}
 
+		// hands the messages queued by SendToUnsyncedBatched to the unsynced state
+		void DeliverBatchedMessages() { unsyncedLuaHandle.RecvFromSyncedBatch(); }
+
 		bool ReloadUnsynced() { return (FreeUnsynced(), LoadUnsynced()); }
 		bool SwapSyncedHandle(lua_State* L, lua_State* L_GC);
 		bool InitUnsynced();
@@ -267,8 +277,50 @@ class CSplitLuaHandle
 		CSyncedLuaHandle syncedLuaHandle;
 		CUnsyncedLuaHandle unsyncedLuaHandle;
 
+	protected:
+		/**
+		 * Synced-to-unsynced messages of nil, boolean, number and string
+		 * arguments, serialized back to back as {numArgs, {type, value}...}
+		 * so queueing one costs no call into the unsynced state. Cleared
+		 * (keeping its capacity) each time the batch is delivered.
+		 */
+		class MessageBatch {
+		public:
+			void Append(lua_State* L, int numArgs);
+			// pushes the arguments of the next message, -1 after the last
+			int Read(lua_State* L);
+
+			void Clear() {
+				data.clear();
+				readPos = 0;
+				numMessages = 0;
+			}
+
+			unsigned int GetNumMessages() const { return numMessages; }
+
+		private:
+			template<typename T> void WriteValue(const T& value) {
+				data.resize(data.size() + sizeof(T));
+				std::memcpy(&data[data.size() - sizeof(T)], &value, sizeof(T));
+			}
+			template<typename T> T ReadValue() {
+				T value;
+				std::memcpy(&value, &data[readPos], sizeof(T));
+				readPos += sizeof(T);
+				return value;
+			}
+
+		private:
+			std::vector<unsigned char> data;
+
+			size_t readPos = 0;
+			unsigned int numMessages = 0;
+		};
+
+		MessageBatch messageBatch;
+
 	public:
-		static void ClearGameParams() { spring::clear_unordered_map(gameParams); }
+		static void ClearGameParams() { gameParams.clear(); LuaRulesParams::ClearSlots(); }
 		static const LuaRulesParams::Params& GetGameParams() { return gameParams; }
 
 	private:
@@ -7,6 +7,7 @@
 #include "LuaUtils.h"
 #include "Map/MetalMap.h"
 #include "Map/ReadMap.h"
+#include "System/Rectangle.h"
 
 /******************************************************************************/
 /******************************************************************************/
@@ -16,15 +17,48 @@ bool LuaMetalMap::PushReadEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetMetalMapSize);
 	REGISTER_LUA_CFUNC(GetMetalAmount);
 	REGISTER_LUA_CFUNC(GetMetalExtraction);
+	REGISTER_LUA_CFUNC(GetMetalAmounts);
+	REGISTER_LUA_CFUNC(GetMetalExtractions);
 	return true;
 }
 
 bool LuaMetalMap::PushCtrlEntries(lua_State* L)
 {
 	REGISTER_LUA_CFUNC(SetMetalAmount);
+	REGISTER_LUA_CFUNC(SetMetalAmounts);
 	return true;
 }
 
+
+// metalmap squares x1 <= x < x2, z1 <= z < z2 of the args at <index>..<index+3>, clamped to the map
+static SRectangle ParseMetalMapRect(lua_State* L, int index)
+{
+	SRectangle rect;
+
+	rect.x1 = Clamp(luaL_checkint(L, index + 0), 0, metalMap.GetSizeX());
+	rect.z1 = Clamp(luaL_checkint(L, index + 1), 0, metalMap.GetSizeZ());
+	rect.x2 = Clamp(luaL_checkint(L, index + 2), rect.x1, metalMap.GetSizeX());
+	rect.z2 = Clamp(luaL_checkint(L, index + 3), rect.z1, metalMap.GetSizeZ());
+
+	return rect;
+}
+
+// pushes an array of f(x, z) over rect, row by row
+template<typename F>
+static int PushMetalMapRect(lua_State* L, const SRectangle& rect, F f)
+{
+	lua_createtable(L, rect.GetArea(), 0);
+
+	for (int z = rect.z1, i = 1; z < rect.z2; z++) {
+		for (int x = rect.x1; x < rect.x2; x++) {
+			lua_pushnumber(L, f(x, z));
+			lua_rawseti(L, -2, i++);
+		}
+	}
+
+	return 1;
+}
+
 int LuaMetalMap::GetMetalMapSize(lua_State* L)
 {
 	lua_pushnumber(L, metalMap.GetSizeX());
@@ -61,6 +95,40 @@ int LuaMetalMap::GetMetalExtraction(lua_State* L)
 }
 
 
+int LuaMetalMap::GetMetalAmounts(lua_State* L)
+{
+	const SRectangle rect = ParseMetalMapRect(L, 1);
+	return (PushMetalMapRect(L, rect, [](int x, int z) { return metalMap.GetMetalAmount(x, z); }));
+}
+
+int LuaMetalMap::SetMetalAmounts(lua_State* L)
+{
+	const SRectangle rect = ParseMetalMapRect(L, 1);
+
+	luaL_checktype(L, 5, LUA_TTABLE);
+
+	// same layout as GetMetalAmounts returns, missing entries are left unchanged
+	for (int z = rect.z1, i = 1; z < rect.z2; z++) {
+		for (int x = rect.x1; x < rect.x2; x++, i++) {
+			lua_rawgeti(L, 5, i);
+
+			if (lua_isnumber(L, -1))
+				metalMap.SetMetalAmount(x, z, lua_tofloat(L, -1));
+
+			lua_pop(L, 1);
+		}
+	}
+
+	return 0;
+}
+
+int LuaMetalMap::GetMetalExtractions(lua_State* L)
+{
+	const SRectangle rect = ParseMetalMapRect(L, 1);
+	return (PushMetalMapRect(L, rect, [](int x, int z) { return metalMap.GetMetalExtraction(x, z); }));
+}
+
+
 
 
 /******************************************************************************/
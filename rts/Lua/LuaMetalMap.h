@@ -15,6 +15,10 @@ class LuaMetalMap {
 		static int GetMetalAmount(lua_State* L);
 		static int SetMetalAmount(lua_State* L);
 		static int GetMetalExtraction(lua_State* L);
+
+		static int GetMetalAmounts(lua_State* L);
+		static int SetMetalAmounts(lua_State* L);
+		static int GetMetalExtractions(lua_State* L);
 };
 
 
@@ -12,6 +12,7 @@
 #include "System/float4.h"
 #include "LuaInclude.h"
 
+#include "LuaBytecodeCache.h"
 #include "LuaConstGame.h"
 #include "LuaConstEngine.h"
 #include "LuaIO.h"
@@ -233,7 +234,7 @@ bool LuaParser::Execute()
 	char errorBuf[4096] = {0};
 	int errorNum = 0;
 
-	if ((errorNum = luaL_loadbuffer(L, code.c_str(), code.size(), codeLabel.c_str())) != 0) {
+	if ((errorNum = LuaBytecodeCache::LoadBuffer(L, code.c_str(), code.size(), codeLabel.c_str())) != 0) {
 		SNPRINTF(errorBuf, sizeof(errorBuf), "[loadbuf] error %d (\"%s\") in %s", errorNum, lua_tostring(L, -1), codeLabel.c_str());
 		LUA_CLOSE(&L);
 
@@ -637,7 +638,7 @@ int LuaParser::Include(lua_State* L)
  		lua_error(L);
 	}
 
-	int error = luaL_loadbuffer(L, code.c_str(), code.size(), filename.c_str());
+	int error = LuaBytecodeCache::LoadBuffer(L, code.c_str(), code.size(), filename.c_str());
 	if (error != 0) {
 		char buf[1024];
 		SNPRINTF(buf, sizeof(buf), "error = %i, %s, %s\n", error, filename.c_str(), lua_tostring(L, -1));
@@ -741,6 +742,16 @@ int LuaParser::DontMessWithMyCase(lua_State* L)
 //  LuaTable
 //
 
+static const std::string& GetLowerKey(const std::string& mixedKey, std::string& lowerKey, bool toLower)
+{
+	// every def tag is looked up this way, skip the copy if nothing would change
+	if (!toLower || std::none_of(mixedKey.begin(), mixedKey.end(), [](char c) { return (c != tolower(c)); }))
+		return mixedKey;
+
+	return (lowerKey = StringToLower(mixedKey));
+}
+
+
 LuaTable::LuaTable()
 : path(""),
   isValid(false),
@@ -857,7 +868,8 @@ LuaTable LuaTable::SubTable(int key) const
 
 LuaTable LuaTable::SubTable(const std::string& mixedKey) const
 {
-	const std::string key = !((parser != nullptr)? parser->lowerCppKeys : true) ? mixedKey : StringToLower(mixedKey);
+	std::string lowerKey;
+	const std::string& key = GetLowerKey(mixedKey, lowerKey, (parser == nullptr) || parser->lowerCppKeys);
 
 	LuaTable subTable;
 	subTable.path = path + "." + key;
@@ -986,7 +998,8 @@ bool LuaTable::PushValue(int key) const
 
 bool LuaTable::PushValue(const std::string& mixedKey) const
 {
-	const std::string key = !(parser ? parser->lowerCppKeys : true) ? mixedKey : StringToLower(mixedKey);
+	std::string lowerKey;
+	const std::string& key = GetLowerKey(mixedKey, lowerKey, (parser == nullptr) || parser->lowerCppKeys);
 
 	if (!PushTable())
 		return false;
@@ -2,6 +2,8 @@
 
 #include "LuaRulesParams.h"
 
+#include <memory>
+
 using namespace LuaRulesParams;
 
 CR_BIND(Param,)
@@ -10,3 +12,133 @@ CR_REG_METADATA(Param, (
 	CR_MEMBER(valueInt),
 	CR_MEMBER(valueString)
 ))
+
+CR_BIND(Params::Entry,)
+CR_REG_METADATA_SUB(Params, Entry, (
+	CR_MEMBER(slot),
+	CR_MEMBER(changeFrame),
+	CR_MEMBER(param)
+))
+
+CR_BIND(Params,)
+CR_REG_METADATA(Params, (
+	CR_MEMBER(entries)
+))
+
+
+static std::vector<std::string> slotNames;
+static spring::unordered_map<std::string, int> slotIndices;
+
+ChangeLog LuaRulesParams::unitChangeLog;
+
+
+int LuaRulesParams::GetSlot(const std::string& name)
+{
+	const auto it = slotIndices.find(name);
+
+	if (it != slotIndices.end())
+		return it->second;
+
+	slotIndices.emplace(name, slotNames.size());
+	slotNames.push_back(name);
+
+	return (slotNames.size() - 1);
+}
+
+int LuaRulesParams::FindSlot(const std::string& name)
+{
+	const auto it = slotIndices.find(name);
+
+	if (it == slotIndices.end())
+		return -1;
+
+	return it->second;
+}
+
+const std::string& LuaRulesParams::GetSlotName(int slot)
+{
+	static const std::string noName;
+
+	if (slot < 0 || slot >= static_cast<int>(slotNames.size()))
+		return noName;
+
+	return slotNames[slot];
+}
+
+void LuaRulesParams::ClearSlots()
+{
+	slotNames.clear();
+	slotIndices.clear();
+
+	unitChangeLog.Clear();
+}
+
+void LuaRulesParams::SerializeSlots(creg::ISerializer* s)
+{
+	std::unique_ptr<creg::IType> namesType = creg::DeduceType<decltype(slotNames)>::Get();
+	namesType->Serialize(s, &slotNames);
+
+	if (s->IsWriting())
+		return;
+
+	slotIndices.clear();
+
+	for (size_t i = 0; i < slotNames.size(); i++) {
+		slotIndices.emplace(slotNames[i], i);
+	}
+}
+
+
+Params::Entry& Params::Get(int slot)
+{
+	for (Entry& e: entries) {
+		if (e.slot == slot)
+			return e;
+	}
+
+	entries.emplace_back();
+	entries.back().slot = slot;
+	return entries.back();
+}
+
+bool Params::Erase(int slot)
+{
+	for (auto it = entries.begin(); it != entries.end(); ++it) {
+		if (it->slot != slot)
+			continue;
+
+		// keep the insertion order, synced Lua sees it through Get*RulesParams
+		entries.erase(it);
+		return true;
+	}
+
+	return false;
+}
+
+
+void ChangeLog::Add(int objectID, Params::Entry* entry, int slot, int frameNum)
+{
+	if (frameNum != lastFrame) {
+		changes.clear();
+		lastFrame = frameNum;
+	}
+
+	if (entry != nullptr) {
+		if (entry->changeFrame == frameNum)
+			return;
+
+		entry->changeFrame = frameNum;
+	}
+
+	changes.emplace_back(objectID, slot);
+}
+
+const std::vector<std::pair<int, int>>& ChangeLog::GetChanges(int frameNum) const
+{
+	static const std::vector<std::pair<int, int>> noChanges;
+
+	if (frameNum != lastFrame)
+		return noChanges;
+
+	return changes;
+}
@@ -4,6 +4,7 @@
 #define LUA_RULESPARAMS_H
 
 #include <string>
+#include <vector>
 
 #include "System/UnorderedMap.hpp"
 #include "System/creg/creg_cond.h"
@@ -35,7 +36,85 @@ namespace LuaRulesParams
 		std::string valueString;
 	};
 
-	typedef spring::unordered_map<std::string, Param> Params;
+
+	/**
+	 * Param names are interned to small integer slots, shared by every game,
+	 * team, unit and feature. New slots are only ever handed out by synced
+	 * code (SetRulesParam, or GetRulesParamSlot from a synced handle), so the
+	 * numbering is identical on all clients and survives save/load.
+	 */
+	int GetSlot(const std::string& name); // registers <name> if unknown
+	int FindSlot(const std::string& name); // -1 if <name> was never registered
+	const std::string& GetSlotName(int slot);
+	void ClearSlots();
+
+	void SerializeSlots(creg::ISerializer* s);
+
+
+	/**
+	 * Per-object params as a flat {slot, param} array in insertion order; a
+	 * lookup is a scan over a handful of integers rather than a string hash,
+	 * and iteration order (visible to synced Lua) does not depend on hashing.
+	 */
+	class Params {
+		CR_DECLARE_STRUCT(Params)
+
+	public:
+		struct Entry {
+			CR_DECLARE_STRUCT(Entry)
+
+			int slot = -1;
+			// frame of the last ChangeLog::Add for this entry, avoids duplicates
+			int changeFrame = -1;
+			Param param;
+		};
+
+	public:
+		const Param* Find(int slot) const {
+			for (const Entry& e: entries) {
+				if (e.slot == slot)
+					return &e.param;
+			}
+
+			return nullptr;
+		}
+		const Param* Find(const std::string& name) const { return (Find(FindSlot(name))); }
+
+		// adds a default param if <slot> is absent
+		Entry& Get(int slot);
+		bool Erase(int slot);
+
+		void clear() { entries.clear(); }
+
+		size_t size() const { return entries.size(); }
+		std::vector<Entry>::const_iterator begin() const { return entries.cbegin(); }
+		std::vector<Entry>::const_iterator end() const { return entries.cend(); }
+
+	private:
+		std::vector<Entry> entries;
+	};
+
+
+	/**
+	 * {objectID, slot} pairs of the params changed (or erased) during the
+	 * current simulation frame, reset lazily on the first change of a frame.
+	 */
+	class ChangeLog {
+	public:
+		void Add(int objectID, Params::Entry* entry, int slot, int frameNum);
+
+		// empty unless it was written during <frameNum>
+		const std::vector<std::pair<int, int>>& GetChanges(int frameNum) const;
+
+		void Clear() { changes.clear(); lastFrame = -1; }
+
+	private:
+		std::vector<std::pair<int, int>> changes;
+
+		int lastFrame = -1;
+	};
+
+	extern ChangeLog unitChangeLog;
 }
 
 #endif // LUA_RULESPARAMS_H
@@ -19,10 +19,13 @@
 #include "System/TypeToStr.h"
 #include "Rendering/Models/ModelsMemStorage.h"
 #include "Rendering/Models/ModelsMemStorageDefs.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "System/Sync/HsiehHash.h"
 
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <initializer_list>
 
 int   intUniformArrayBuf[1024] = {0   };
 float fltUniformArrayBuf[1024] = {0.0f};
@@ -533,6 +536,31 @@ GLint LuaShaders::GetUniformLocation(LuaShaders::Program* p, const char* name)
 	return iter->second.location;
 }
 
+namespace {
+	static unsigned int GetProgramBinaryHash(const std::vector<std::string>& defs, const std::initializer_list<const std::vector<std::string>*>& stageSrcs)
+	{
+		unsigned int hash = 127;
+
+		for (const std::string& def: defs) {
+			hash = HsiehHash(def.data(), def.size(), hash);
+		}
+
+		// stage index separates e.g. a vertex-only from a fragment-only program with the same source
+		unsigned int stage = 0;
+
+		for (const std::vector<std::string>* srcs: stageSrcs) {
+			hash = HsiehHash(&stage, sizeof(stage), hash);
+			stage++;
+
+			for (const std::string& src: *srcs) {
+				hash = HsiehHash(src.data(), src.size(), hash);
+			}
+		}
+
+		return hash;
+	}
+}
+
 int LuaShaders::CreateShader(lua_State* L)
 {
 	const int args = lua_gettop(L);
@@ -576,6 +604,24 @@ int LuaShaders::CreateShader(lua_State* L)
 	if (!graphicSrcEmpty && !computeSrcEmpty)
 		return 0;
 
+	// geometry parameters come from the table instead of the sources, keep such programs out of the cache
+	const bool useBinaryCache = geomSrcs.empty();
+	const unsigned int binaryHash = GetProgramBinaryHash(shdrDefs, {&vertSrcs, &tcsSrcs, &tesSrcs, &geomSrcs, &fragSrcs, &compSrcs});
+
+	CShaderHandler::ProgramBinaryCache& binaryCache = shaderHandler->GetProgramBinaryCache();
+
+	if (useBinaryCache) {
+		const GLuint cachedProg = binaryCache.Load(binaryHash);
+
+		if (cachedProg != 0) {
+			Program p(cachedProg);
+
+			// no compile-log to report
+			CLuaHandle::GetActiveShaders(L).errorLog.clear();
+			return AddLinkedProgram(L, p, GL_TRUE);
+		}
+	}
+
 	bool success;
 	const GLuint vertObj = CompileObject(L, shdrDefs, vertSrcs, GL_VERTEX_SHADER, success);
 
@@ -655,11 +701,25 @@ int LuaShaders::CreateShader(lua_State* L)
 	}
 
 	GLint linkStatus;
-	GLint validStatus;
+
+	if (useBinaryCache)
+		binaryCache.SetRetrievable(prog);
 
 	glLinkProgram(prog);
 	glGetProgramiv(prog, GL_LINK_STATUS, &linkStatus);
 
+	if (useBinaryCache && linkStatus == GL_TRUE)
+		binaryCache.Save(binaryHash, prog);
+
+	return AddLinkedProgram(L, p, linkStatus);
+}
+
+int LuaShaders::AddLinkedProgram(lua_State* L, Program& p, GLint linkStatus)
+{
+	const GLuint prog = p.id;
+
+	GLint validStatus;
+
 	// Parse active uniforms and locations
 	GLint currentProgram = FillActiveUniforms(p);
 
@@ -66,6 +66,8 @@ class LuaShaders {
 		// helper
 		static bool DeleteProgram(Program& p);
 		static GLint GetUniformLocation(Program* p, const char* name);
+		// sets up and validates a linked program, pushes its index (or nothing on failure)
+		static int AddLinkedProgram(lua_State* L, Program& p, GLint linkStatus);
 	private:
 
 		// the call-outs
@@ -44,6 +44,7 @@
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/Wind.h"
 #include "Sim/MoveTypes/AAirMoveType.h"
+#include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/Projectile.h"
@@ -475,6 +476,7 @@ static int SetSolidObjectCollisionVolumeData(lua_State* L, CSolidObject* o)
 	if (o == nullptr)
 		return 0;
 
+	quadField.ObjectsChanged();
 	return LuaUtils::ParseColVolData(L, 2, &o->collisionVolume);
 }
 
@@ -483,6 +485,8 @@ static int SetSolidObjectBlocking(lua_State* L, CSolidObject* o)
 	if (o == nullptr)
 		return 0;
 
+	quadField.ObjectsChanged();
+
 	// update SO-bit of collidable state
 	if (lua_isboolean(L, 3)) {
 		if (lua_toboolean(L, 3)) {
@@ -612,6 +616,8 @@ static int SetSolidObjectPieceCollisionVolumeData(lua_State* L, CSolidObject* ob
 	if (lmp == nullptr)
 		luaL_argerror(L, 2, "invalid piece");
 
+	quadField.ObjectsChanged();
+
 	CollisionVolume* vol = lmp->GetCollisionVolume();
 
 	const float3 scales(luaL_checkfloat(L, 4), luaL_checkfloat(L, 5), luaL_checkfloat(L, 6));
@@ -1016,15 +1022,17 @@ int LuaSyncedCtrl::ShareTeamResource(lua_State* L)
 /******************************************************************************/
 
 void SetRulesParam(lua_State* L, const char* caller, int offset,
-				LuaRulesParams::Params& params)
+				LuaRulesParams::Params& params, LuaRulesParams::ChangeLog* changeLog = nullptr, int objectID = -1)
 {
 	const int index = offset + 1;
 	const int valIndex = offset + 2;
 	const int losIndex = offset + 3; // table
 
 	const std::string& key = luaL_checkstring(L, index);
+	const int slot = LuaRulesParams::GetSlot(key);
 
-	LuaRulesParams::Param& param = params[key];
+	LuaRulesParams::Params::Entry& entry = params.Get(slot);
+	LuaRulesParams::Param& param = entry.param;
 
 	// set the value of the parameter
 	if (lua_israwnumber(L, valIndex)) {
@@ -1033,7 +1041,11 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 	} else if (lua_isstring(L, valIndex)) {
 		param.valueString = lua_tostring(L, valIndex);
 	} else if (lua_isnoneornil(L, valIndex)) {
-		params.erase(key);
+		params.Erase(slot);
+
+		if (changeLog != nullptr)
+			changeLog->Add(objectID, nullptr, slot, gs->frameNum);
+
 		return; //no need to set los if param was erased
 	} else {
 		luaL_error(L, "Incorrect arguments to %s()", caller);
@@ -1067,6 +1079,9 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 	} else {
 		param.los = luaL_optint(L, losIndex, param.los);
 	}
+
+	if (changeLog != nullptr)
+		changeLog->Add(objectID, &entry, slot, gs->frameNum);
 }
 
 
@@ -1095,7 +1110,7 @@ int LuaSyncedCtrl::SetUnitRulesParam(lua_State* L)
 	if (unit == nullptr)
 		return 0;
 
-	SetRulesParam(L, __func__, 1, unit->modParams);
+	SetRulesParam(L, __func__, 1, unit->modParams, &LuaRulesParams::unitChangeLog, unit->id);
 	return 0;
 }
 
@@ -1505,6 +1520,7 @@ int LuaSyncedCtrl::SetUnitResourcing(lua_State* L)
 		luaL_error(L, "Incorrect arguments to SetUnitResourcing");
 	}
 
+	unit->UpdateHasResourcing();
 	return 0;
 }
 
@@ -3819,7 +3835,7 @@ int LuaSyncedCtrl::LevelHeightMap(lua_State* L)
 		}
 	}
 
-	mapDamage->RecalcArea(x1, x2, z1, z2);
+	mapDamage->QueueRecalcArea(x1, x2, z1, z2);
 	return 0;
 }
 
@@ -3841,7 +3857,7 @@ int LuaSyncedCtrl::AdjustHeightMap(lua_State* L)
 		}
 	}
 
-	mapDamage->RecalcArea(x1, x2, z1, z2);
+	mapDamage->QueueRecalcArea(x1, x2, z1, z2);
 	return 0;
 }
 
@@ -3879,7 +3895,7 @@ int LuaSyncedCtrl::RevertHeightMap(lua_State* L)
 		}
 	}
 
-	mapDamage->RecalcArea(x1, x2, z1, z2);
+	mapDamage->QueueRecalcArea(x1, x2, z1, z2);
 	return 0;
 }
 
@@ -4001,7 +4017,7 @@ int LuaSyncedCtrl::SetHeightMapFunc(lua_State* L)
 	}
 
 	if (heightMapx2 > -1) {
-		mapDamage->RecalcArea(heightMapx1, heightMapx2, heightMapz1, heightMapz2);
+		mapDamage->QueueRecalcArea(heightMapx1, heightMapx2, heightMapz1, heightMapz2);
 	}
 
 	lua_pushnumber(L, heightMapAmountChanged);
@@ -4201,6 +4217,7 @@ int LuaSyncedCtrl::SetMapSquareTerrainType(lua_State* L)
 	const int ntt = luaL_checkint(L, 3);
 
 	readMap->GetTypeMapSynced()[tz * mapDims.hmapx + tx] = std::max(0, std::min(ntt, (CMapInfo::NUM_TERRAIN_TYPES - 1)));
+	CMoveMath::UpdateSpeedModMaps({hx, hz, hx + 1, hz + 1});
 	pathManager->TerrainChange(hx, hz,  hx + 1, hz + 1,  TERRAINCHANGE_SQUARE_TYPEMAP_INDEX);
 
 	lua_pushnumber(L, ott);
@@ -4237,8 +4254,10 @@ int LuaSyncedCtrl::SetTerrainTypeData(lua_State* L)
 	// hardness changes do not require repathing
 	if (ttHardnessChanged)
 		mapDamage->TerrainTypeHardnessChanged(tti);
-	if (ttSpeedModChanged)
+	if (ttSpeedModChanged) {
+		CMoveMath::TerrainTypeSpeedModChanged(tti);
 		mapDamage->TerrainTypeSpeedModChanged(tti);
+	}
 
 	lua_pushboolean(L, true);
 	return 1;
@@ -11,6 +11,7 @@
 #include "LuaPathFinder.h"
 #include "LuaRules.h"
 #include "LuaRulesParams.h"
+#include "LuaUnitStateView.h"
 #include "LuaUtils.h"
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "Game/Game.h"
@@ -75,7 +76,10 @@
 #include "System/FileSystem/FileSystem.h"
 #include "System/StringUtil.h"
 
+#include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <limits>
 
 
 using std::min;
@@ -114,6 +118,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(GetGameRulesParam);
 	REGISTER_LUA_CFUNC(GetGameRulesParams);
+	REGISTER_LUA_CFUNC(GetRulesParamSlot);
 
 	REGISTER_LUA_CFUNC(GetMapOptions);
 	REGISTER_LUA_CFUNC(GetModOptions);
@@ -207,6 +212,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitDirection);
 	REGISTER_LUA_CFUNC(GetUnitHeading);
 	REGISTER_LUA_CFUNC(GetUnitVelocity);
+	REGISTER_LUA_CFUNC(GetUnitsData);
 	REGISTER_LUA_CFUNC(GetUnitBuildFacing);
 	REGISTER_LUA_CFUNC(GetUnitIsBuilding);
 	REGISTER_LUA_CFUNC(GetUnitCurrentBuildPower);
@@ -256,6 +262,8 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(GetUnitRulesParam);
 	REGISTER_LUA_CFUNC(GetUnitRulesParams);
+	REGISTER_LUA_CFUNC(GetUnitRulesParamBySlot);
+	REGISTER_LUA_CFUNC(GetUnitRulesParamChanges);
 
 	REGISTER_LUA_CFUNC(GetCEGID);
 
@@ -355,6 +363,9 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	if (!LuaPathFinder::PushEntries(L))
 		return false;
 
+	if (!LuaUnitStateView::PushEntries(L))
+		return false;
+
 	return true;
 }
 
@@ -659,9 +670,9 @@ static int PushRulesParams(lua_State* L, const char* caller,
 {
 	lua_createtable(L, 0, params.size());
 
-	for (auto& it: params) {
-		const std::string& name = it.first;
-		const LuaRulesParams::Param& param = it.second;
+	for (const auto& entry: params) {
+		const std::string& name = LuaRulesParams::GetSlotName(entry.slot);
+		const LuaRulesParams::Param& param = entry.param;
 		if (!(param.los & losStatus))
 			continue;
 
@@ -676,27 +687,42 @@ static int PushRulesParams(lua_State* L, const char* caller,
 }
 
 
+static int PushRulesParam(lua_State* L, const LuaRulesParams::Param& param, const int losStatus)
+{
+	if (!(param.los & losStatus))
+		return 0;
+
+	if (!param.valueString.empty()) {
+		lua_pushsstring(L, param.valueString);
+	} else {
+		lua_pushnumber(L, param.valueInt);
+	}
+
+	return 1;
+}
+
+
 static int GetRulesParam(lua_State* L, const char* caller, int index,
                           const LuaRulesParams::Params& params,
                           const int& losStatus)
 {
-	const std::string& key = luaL_checkstring(L, index);
-	const auto it = params.find(key);
-	if (it == params.end())
+	const LuaRulesParams::Param* param = params.Find(luaL_checkstring(L, index));
+	if (param == nullptr)
 		return 0;
 
-	const LuaRulesParams::Param& param = it->second;
+	return PushRulesParam(L, *param, losStatus);
+}
 
-	if (param.los & losStatus) {
-		if (!param.valueString.empty()) {
-			lua_pushsstring(L, param.valueString);
-		} else {
-			lua_pushnumber(L, param.valueInt);
-		}
-		return 1;
-	}
 
-	return 0;
+static int GetRulesParamBySlot(lua_State* L, int index,
+                          const LuaRulesParams::Params& params,
+                          const int losStatus)
+{
+	const LuaRulesParams::Param* param = params.Find(luaL_checkint(L, index));
+	if (param == nullptr)
+		return 0;
+
+	return PushRulesParam(L, *param, losStatus);
 }
 
 
@@ -832,6 +858,21 @@ int LuaSyncedRead::GetGameRulesParams(lua_State* L)
 }
 
 
+int LuaSyncedRead::GetRulesParamSlot(lua_State* L)
+{
+	const std::string name = luaL_checkstring(L, 1);
+
+	// only synced code may hand out new slots, see LuaRulesParams::GetSlot
+	const int slot = CLuaHandle::GetHandleSynced(L)? LuaRulesParams::GetSlot(name): LuaRulesParams::FindSlot(name);
+
+	if (slot < 0)
+		return 0;
+
+	lua_pushnumber(L, slot);
+	return 1;
+}
+
+
 int LuaSyncedRead::GetGameRulesParam(lua_State* L)
 {
 	// always readable for all
@@ -1317,12 +1358,13 @@ int LuaSyncedRead::GetTeamStatsHistory(lua_State* L)
 
 	std::advance(it, start);
 
-	lua_newtable(L);
+	// size the tables up front, long games can ask for thousands of entries
+	lua_createtable(L, (statCount > 0)? (end - start + 1): 0, 0);
 	if (statCount > 0) {
 		int count = 1;
 		for (int i = start; i <= end; ++i, ++it) {
 			const TeamStatistics& stats = *it;
-			lua_newtable(L); {
+			lua_createtable(L, 0, 21); {
 				if (i+1 == teamStats.size()) {
 					// the `stats.frame` var indicates the frame when a new entry needs to get added,
 					// for the most recent stats entry this lies obviously in the future,
@@ -2042,6 +2084,51 @@ int LuaSyncedRead::GetTeamUnitCount(lua_State* L)
 		}                                                           \
 	}
 
+// Macro Requirements:
+//   L, units (quad candidates), mins, maxs, numResults
+//   the results table on top of the stack
+
+#define LOOP_UNIT_CANDIDATES(ALLEGIANCE_TEST, CUSTOM_TEST) \
+	{                                                           \
+		unsigned int count = 0;                                 \
+                                                                \
+		for (const CUnit* unit: units) {                        \
+			const float3& qp = unit->pos;                       \
+			if (qp.x < mins.x || qp.x > maxs.x) { continue; }   \
+			if (qp.z < mins.z || qp.z > maxs.z) { continue; }   \
+                                                                \
+			ALLEGIANCE_TEST;                                    \
+			CUSTOM_TEST;                                        \
+                                                                \
+			lua_pushnumber(L, unit->id);                        \
+			lua_rawseti(L, -2, ++count);                        \
+		}                                                       \
+                                                                \
+		numResults = count;                                     \
+	}
+
+// pushes the caller's results table at <index> to be refilled in place, or a
+// new one; returns the number of array entries it held before the query
+static unsigned int PushResultsTable(lua_State* L, int index, size_t sizeHint)
+{
+	if (!lua_istable(L, index)) {
+		lua_createtable(L, sizeHint, 0);
+		return 0;
+	}
+
+	lua_pushvalue(L, index);
+	return lua_objlen(L, -1);
+}
+
+// drops the stale entries a reused results table kept past <numResults>
+static void TrimResultsTable(lua_State* L, unsigned int numResults, unsigned int numPrevResults)
+{
+	for (unsigned int i = numResults + 1; i <= numPrevResults; i++) {
+		lua_pushnil(L);
+		lua_rawseti(L, -2, i);
+	}
+}
+
 // Macro Requirements:
 //   unit
 //   readTeam   for MY_UNIT_TEST
@@ -2072,6 +2159,8 @@ int LuaSyncedRead::GetTeamUnitCount(lua_State* L)
 
 int LuaSyncedRead::GetUnitsInRectangle(lua_State* L)
 {
+	constexpr int RESULTS_IDX = 6;
+
 	const float xmin = luaL_checkfloat(L, 1);
 	const float zmin = luaL_checkfloat(L, 2);
 	const float xmax = luaL_checkfloat(L, 3);
@@ -2082,39 +2171,42 @@ int LuaSyncedRead::GetUnitsInRectangle(lua_State* L)
 
 	const int allegiance = LuaUtils::ParseAllegiance(L, __func__, 5);
 
-#define RECTANGLE_TEST ; // no test, GetUnitsExact is sufficient
+#define RECTANGLE_TEST ; // no test, the candidate bounds test is sufficient
 
-	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, mins, maxs);
-	const auto& units = (*qfQuery.units);
+	const auto& units = quadField.GetUnitCandidatesExact(mins, maxs);
+	const unsigned int numPrevResults = PushResultsTable(L, RESULTS_IDX, units.size());
+	unsigned int numResults = 0;
 
 	if (allegiance >= 0) {
 		if (LuaUtils::IsAlliedTeam(L, allegiance)) {
-			LOOP_UNIT_CONTAINER(SIMPLE_TEAM_TEST, RECTANGLE_TEST, true);
+			LOOP_UNIT_CANDIDATES(SIMPLE_TEAM_TEST, RECTANGLE_TEST);
 		} else {
-			LOOP_UNIT_CONTAINER(VISIBLE_TEAM_TEST, RECTANGLE_TEST, true);
+			LOOP_UNIT_CANDIDATES(VISIBLE_TEAM_TEST, RECTANGLE_TEST);
 		}
 	}
 	else if (allegiance == LuaUtils::MyUnits) {
 		const int readTeam = CLuaHandle::GetHandleReadTeam(L);
-		LOOP_UNIT_CONTAINER(MY_UNIT_TEST, RECTANGLE_TEST, true);
+		LOOP_UNIT_CANDIDATES(MY_UNIT_TEST, RECTANGLE_TEST);
 	}
 	else if (allegiance == LuaUtils::AllyUnits) {
-		LOOP_UNIT_CONTAINER(ALLY_UNIT_TEST, RECTANGLE_TEST, true);
+		LOOP_UNIT_CANDIDATES(ALLY_UNIT_TEST, RECTANGLE_TEST);
 	}
 	else if (allegiance == LuaUtils::EnemyUnits) {
-		LOOP_UNIT_CONTAINER(ENEMY_UNIT_TEST, RECTANGLE_TEST, true);
+		LOOP_UNIT_CANDIDATES(ENEMY_UNIT_TEST, RECTANGLE_TEST);
 	}
 	else { // AllUnits
-		LOOP_UNIT_CONTAINER(VISIBLE_TEST, RECTANGLE_TEST, true);
+		LOOP_UNIT_CANDIDATES(VISIBLE_TEST, RECTANGLE_TEST);
 	}
 
+	TrimResultsTable(L, numResults, numPrevResults);
 	return 1;
 }
 
 
 int LuaSyncedRead::GetUnitsInBox(lua_State* L)
 {
+	constexpr int RESULTS_IDX = 8;
+
 	const float xmin = luaL_checkfloat(L, 1);
 	const float ymin = luaL_checkfloat(L, 2);
 	const float zmin = luaL_checkfloat(L, 3);
@@ -2133,37 +2225,40 @@ int LuaSyncedRead::GetUnitsInBox(lua_State* L)
 		continue;                     \
 	}
 
-	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, mins, maxs);
-	const auto& units = (*qfQuery.units);
+	const auto& units = quadField.GetUnitCandidatesExact(mins, maxs);
+	const unsigned int numPrevResults = PushResultsTable(L, RESULTS_IDX, units.size());
+	unsigned int numResults = 0;
 
 	if (allegiance >= 0) {
 		if (LuaUtils::IsAlliedTeam(L, allegiance)) {
-			LOOP_UNIT_CONTAINER(SIMPLE_TEAM_TEST, BOX_TEST, true);
+			LOOP_UNIT_CANDIDATES(SIMPLE_TEAM_TEST, BOX_TEST);
 		} else {
-			LOOP_UNIT_CONTAINER(VISIBLE_TEAM_TEST, BOX_TEST, true);
+			LOOP_UNIT_CANDIDATES(VISIBLE_TEAM_TEST, BOX_TEST);
 		}
 	}
 	else if (allegiance == LuaUtils::MyUnits) {
 		const int readTeam = CLuaHandle::GetHandleReadTeam(L);
-		LOOP_UNIT_CONTAINER(MY_UNIT_TEST, BOX_TEST, true);
+		LOOP_UNIT_CANDIDATES(MY_UNIT_TEST, BOX_TEST);
 	}
 	else if (allegiance == LuaUtils::AllyUnits) {
-		LOOP_UNIT_CONTAINER(ALLY_UNIT_TEST, BOX_TEST, true);
+		LOOP_UNIT_CANDIDATES(ALLY_UNIT_TEST, BOX_TEST);
 	}
 	else if (allegiance == LuaUtils::EnemyUnits) {
-		LOOP_UNIT_CONTAINER(ENEMY_UNIT_TEST, BOX_TEST, true);
+		LOOP_UNIT_CANDIDATES(ENEMY_UNIT_TEST, BOX_TEST);
 	}
 	else { // AllUnits
-		LOOP_UNIT_CONTAINER(VISIBLE_TEST, BOX_TEST, true);
+		LOOP_UNIT_CANDIDATES(VISIBLE_TEST, BOX_TEST);
 	}
 
+	TrimResultsTable(L, numResults, numPrevResults);
 	return 1;
 }
 
 
 int LuaSyncedRead::GetUnitsInCylinder(lua_State* L)
 {
+	constexpr int RESULTS_IDX = 5;
+
 	const float x      = luaL_checkfloat(L, 1);
 	const float z      = luaL_checkfloat(L, 2);
 	const float radius = luaL_checkfloat(L, 3);
@@ -2183,37 +2278,40 @@ int LuaSyncedRead::GetUnitsInCylinder(lua_State* L)
 		continue;                               \
 	}                                           \
 
-	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, mins, maxs);
-	const auto& units = (*qfQuery.units);
+	const auto& units = quadField.GetUnitCandidatesExact(mins, maxs);
+	const unsigned int numPrevResults = PushResultsTable(L, RESULTS_IDX, units.size());
+	unsigned int numResults = 0;
 
 	if (allegiance >= 0) {
 		if (LuaUtils::IsAlliedTeam(L, allegiance)) {
-			LOOP_UNIT_CONTAINER(SIMPLE_TEAM_TEST, CYLINDER_TEST, true);
+			LOOP_UNIT_CANDIDATES(SIMPLE_TEAM_TEST, CYLINDER_TEST);
 		} else {
-			LOOP_UNIT_CONTAINER(VISIBLE_TEAM_TEST, CYLINDER_TEST, true);
+			LOOP_UNIT_CANDIDATES(VISIBLE_TEAM_TEST, CYLINDER_TEST);
 		}
 	}
 	else if (allegiance == LuaUtils::MyUnits) {
 		const int readTeam = CLuaHandle::GetHandleReadTeam(L);
-		LOOP_UNIT_CONTAINER(MY_UNIT_TEST, CYLINDER_TEST, true);
+		LOOP_UNIT_CANDIDATES(MY_UNIT_TEST, CYLINDER_TEST);
 	}
 	else if (allegiance == LuaUtils::AllyUnits) {
-		LOOP_UNIT_CONTAINER(ALLY_UNIT_TEST, CYLINDER_TEST, true);
+		LOOP_UNIT_CANDIDATES(ALLY_UNIT_TEST, CYLINDER_TEST);
 	}
 	else if (allegiance == LuaUtils::EnemyUnits) {
-		LOOP_UNIT_CONTAINER(ENEMY_UNIT_TEST, CYLINDER_TEST, true);
+		LOOP_UNIT_CANDIDATES(ENEMY_UNIT_TEST, CYLINDER_TEST);
 	}
 	else { // AllUnits
-		LOOP_UNIT_CONTAINER(VISIBLE_TEST, CYLINDER_TEST, true);
+		LOOP_UNIT_CANDIDATES(VISIBLE_TEST, CYLINDER_TEST);
 	}
 
+	TrimResultsTable(L, numResults, numPrevResults);
 	return 1;
 }
 
 
 int LuaSyncedRead::GetUnitsInSphere(lua_State* L)
 {
+	constexpr int RESULTS_IDX = 6;
+
 	const float x      = luaL_checkfloat(L, 1);
 	const float y      = luaL_checkfloat(L, 2);
 	const float z      = luaL_checkfloat(L, 3);
@@ -2237,31 +2335,32 @@ int LuaSyncedRead::GetUnitsInSphere(lua_State* L)
 		continue;                                 \
 	}                                           \
 
-	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, mins, maxs);
-	const auto& units = (*qfQuery.units);
+	const auto& units = quadField.GetUnitCandidatesExact(mins, maxs);
+	const unsigned int numPrevResults = PushResultsTable(L, RESULTS_IDX, units.size());
+	unsigned int numResults = 0;
 
 	if (allegiance >= 0) {
 		if (LuaUtils::IsAlliedTeam(L, allegiance)) {
-			LOOP_UNIT_CONTAINER(SIMPLE_TEAM_TEST, SPHERE_TEST, true);
+			LOOP_UNIT_CANDIDATES(SIMPLE_TEAM_TEST, SPHERE_TEST);
 		} else {
-			LOOP_UNIT_CONTAINER(VISIBLE_TEAM_TEST, SPHERE_TEST, true);
+			LOOP_UNIT_CANDIDATES(VISIBLE_TEAM_TEST, SPHERE_TEST);
 		}
 	}
 	else if (allegiance == LuaUtils::MyUnits) {
 		const int readTeam = CLuaHandle::GetHandleReadTeam(L);
-		LOOP_UNIT_CONTAINER(MY_UNIT_TEST, SPHERE_TEST, true);
+		LOOP_UNIT_CANDIDATES(MY_UNIT_TEST, SPHERE_TEST);
 	}
 	else if (allegiance == LuaUtils::AllyUnits) {
-		LOOP_UNIT_CONTAINER(ALLY_UNIT_TEST, SPHERE_TEST, true);
+		LOOP_UNIT_CANDIDATES(ALLY_UNIT_TEST, SPHERE_TEST);
 	}
 	else if (allegiance == LuaUtils::EnemyUnits) {
-		LOOP_UNIT_CONTAINER(ENEMY_UNIT_TEST, SPHERE_TEST, true);
+		LOOP_UNIT_CANDIDATES(ENEMY_UNIT_TEST, SPHERE_TEST);
 	}
 	else { // AllUnits
-		LOOP_UNIT_CONTAINER(VISIBLE_TEST, SPHERE_TEST, true);
+		LOOP_UNIT_CANDIDATES(VISIBLE_TEST, SPHERE_TEST);
 	}
 
+	TrimResultsTable(L, numResults, numPrevResults);
 	return 1;
 }
 
@@ -3045,6 +3144,165 @@ int LuaSyncedRead::GetUnitVelocity(lua_State* L)
 }
 
 
+namespace {
+	// one column of GetUnitsData; <values> receives <stride> numbers per unit,
+	// NaN marks entries the reading handle is not allowed to see (pushed as false)
+	struct UnitsDataField {
+		const char* name;
+		int stride;
+		bool needsLos; // else only the IsUnitVisible test of ParseUnit
+		void (*read)(lua_State* L, const CUnit* unit, float* values);
+	};
+
+	float3 GetUnitsDataErrorVec(lua_State* L, const CUnit* unit) {
+		if (LuaUtils::IsAllyUnit(L, unit))
+			return ZeroVector;
+
+		return (unit->GetLuaErrorVector(CLuaHandle::GetHandleReadAllyTeam(L), CLuaHandle::GetHandleFullRead(L)));
+	}
+
+	void ReadUnitsDataHealth(lua_State* L, const CUnit* unit, float* values) {
+		const UnitDef* ud = unit->unitDef;
+		const bool enemyUnit = LuaUtils::IsEnemyUnit(L, unit);
+
+		if (ud->hideDamage && enemyUnit) {
+			values[0] = std::numeric_limits<float>::quiet_NaN();
+			values[1] = std::numeric_limits<float>::quiet_NaN();
+			values[2] = std::numeric_limits<float>::quiet_NaN();
+		} else {
+			const float scale = (!enemyUnit || (ud->decoyDef == nullptr))? 1.0f: (ud->decoyDef->health / ud->health);
+
+			values[0] = scale * unit->health;
+			values[1] = scale * unit->maxHealth;
+			values[2] = scale * unit->paralyzeDamage;
+		}
+
+		values[3] = unit->captureProgress;
+		values[4] = unit->buildProgress;
+	}
+
+	// same access rules and values as the matching single-unit call
+	const UnitsDataField UNITS_DATA_FIELDS[] = {
+		{"position"   , 3, false, [](lua_State* L, const CUnit* u, float* v) { const float3 p = u->pos    + GetUnitsDataErrorVec(L, u); std::memcpy(v, &p.x, sizeof(float) * 3); }},
+		{"midPosition", 3, false, [](lua_State* L, const CUnit* u, float* v) { const float3 p = u->midPos + GetUnitsDataErrorVec(L, u); std::memcpy(v, &p.x, sizeof(float) * 3); }},
+		{"aimPosition", 3, false, [](lua_State* L, const CUnit* u, float* v) { const float3 p = u->aimPos + GetUnitsDataErrorVec(L, u); std::memcpy(v, &p.x, sizeof(float) * 3); }},
+		{"velocity"   , 4, true , [](lua_State* L, const CUnit* u, float* v) { std::memcpy(v, &u->speed.x, sizeof(float) * 4); }},
+		{"direction"  , 3, true , [](lua_State* L, const CUnit* u, float* v) { std::memcpy(v, &u->frontdir.x, sizeof(float) * 3); }},
+		{"heading"    , 1, true , [](lua_State* L, const CUnit* u, float* v) { v[0] = u->heading; }},
+		{"health"     , 5, true , ReadUnitsDataHealth},
+		{"teamID"     , 1, false, [](lua_State* L, const CUnit* u, float* v) { v[0] = u->team; }},
+	};
+
+	constexpr int UNITS_DATA_MAX_STRIDE = 5;
+}
+
+/*
+ * Bulk variant of GetUnitPosition, GetUnitVelocity, GetUnitHealth, etc.
+ *
+ * Spring.GetUnitsData(unitIDs = {id1, ...}, fields = {"position", ...}[, results])
+ * returns results = {position = {x1, y1, z1, x2, ...}, ...}, one flat column
+ * per field with <stride> entries per unit in unitIDs-order. Entries of dead,
+ * invisible or out-of-LOS units are false. Passing the table returned by an
+ * earlier call refills its columns in place instead of allocating new ones.
+ */
+int LuaSyncedRead::GetUnitsData(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	const int numUnits = lua_objlen(L, 1);
+	const int numFields = lua_objlen(L, 2);
+
+	std::vector<const UnitsDataField*> fields;
+	fields.reserve(numFields);
+
+	for (int i = 1; i <= numFields; i++) {
+		lua_rawgeti(L, 2, i);
+
+		const char* fieldName = luaL_checkstring(L, -1);
+		const auto pred = [&](const UnitsDataField& f) { return (strcmp(f.name, fieldName) == 0); };
+		const auto iter = std::find_if(std::begin(UNITS_DATA_FIELDS), std::end(UNITS_DATA_FIELDS), pred);
+
+		if (iter == std::end(UNITS_DATA_FIELDS))
+			luaL_error(L, "[%s] unknown field \"%s\" (arg #2, entry %d)", __func__, fieldName, i);
+
+		fields.push_back(&*iter);
+		lua_pop(L, 1);
+	}
+
+	// resolve every unit once, the columns only repeat the cheap tests
+	std::vector<const CUnit*> units(numUnits, nullptr);
+	std::vector<uint8_t> unitsInLos(numUnits, 0);
+
+	for (int i = 0; i < numUnits; i++) {
+		lua_rawgeti(L, 1, i + 1);
+
+		if (lua_isnumber(L, -1)) {
+			const CUnit* unit = unitHandler.GetUnit(lua_toint(L, -1));
+
+			if (unit != nullptr && LuaUtils::IsUnitVisible(L, unit)) {
+				units[i] = unit;
+				unitsInLos[i] = LuaUtils::IsUnitInLos(L, unit);
+			}
+		}
+
+		lua_pop(L, 1);
+	}
+
+	if (lua_istable(L, 3)) {
+		lua_pushvalue(L, 3);
+	} else {
+		lua_createtable(L, 0, numFields);
+	}
+
+	const int resultsIdx = lua_gettop(L);
+
+	for (const UnitsDataField* field: fields) {
+		lua_getfield(L, resultsIdx, field->name);
+
+		if (!lua_istable(L, -1)) {
+			lua_pop(L, 1);
+			lua_createtable(L, numUnits * field->stride, 0);
+			lua_pushvalue(L, -1);
+			lua_setfield(L, resultsIdx, field->name);
+		}
+
+		const int numValues = numUnits * field->stride;
+		const int oldNumValues = lua_objlen(L, -1);
+
+		float values[UNITS_DATA_MAX_STRIDE];
+
+		for (int i = 0; i < numUnits; i++) {
+			const CUnit* unit = units[i];
+			const bool readable = (unit != nullptr && (!field->needsLos || unitsInLos[i]));
+
+			if (readable)
+				field->read(L, unit, values);
+
+			for (int j = 0; j < field->stride; j++) {
+				if (readable && !math::isnan(values[j])) {
+					lua_pushnumber(L, values[j]);
+				} else {
+					lua_pushboolean(L, false);
+				}
+
+				lua_rawseti(L, -2, i * field->stride + j + 1);
+			}
+		}
+
+		// shrink reused columns that held more units last time
+		for (int k = oldNumValues; k > numValues; k--) {
+			lua_pushnil(L);
+			lua_rawseti(L, -2, k);
+		}
+
+		lua_pop(L, 1);
+	}
+
+	return 1;
+}
+
+
 int LuaSyncedRead::GetUnitBuildFacing(lua_State* L)
 {
 	const CUnit* unit = ParseInLosUnit(L, __func__, 1);
@@ -4481,6 +4739,49 @@ int LuaSyncedRead::GetUnitRulesParam(lua_State* L)
 }
 
 
+int LuaSyncedRead::GetUnitRulesParamBySlot(lua_State* L)
+{
+	const CUnit* unit = ParseUnit(L, __func__, 1);
+	if (unit == nullptr || game == nullptr)
+		return 0;
+
+	return GetRulesParamBySlot(L, 2, unit->modParams, GetUnitRulesParamLosMask(L, unit));
+}
+
+
+int LuaSyncedRead::GetUnitRulesParamChanges(lua_State* L)
+{
+	const auto& changes = LuaRulesParams::unitChangeLog.GetChanges(gs->frameNum);
+
+	lua_createtable(L, changes.size() * 2, 0);
+
+	int n = 0;
+
+	for (const auto& [unitID, slot]: changes) {
+		const CUnit* unit = unitHandler.GetUnit(unitID);
+
+		if (unit == nullptr)
+			continue;
+
+		const int losMask = GetUnitRulesParamLosMask(L, unit);
+		const LuaRulesParams::Param* param = unit->modParams.Find(slot);
+
+		// an erased param has no los of its own, only report that to allies
+		if (param == nullptr && (losMask & LuaRulesParams::RULESPARAMLOS_ALLIED) == 0)
+			continue;
+		if (param != nullptr && (param->los & losMask) == 0)
+			continue;
+
+		lua_pushnumber(L, unitID);
+		lua_rawseti(L, -2, ++n);
+		lua_pushnumber(L, slot);
+		lua_rawseti(L, -2, ++n);
+	}
+
+	return 1;
+}
+
+
 /******************************************************************************/
 
 int LuaSyncedRead::GetUnitCmdDescs(lua_State* L)
@@ -5545,7 +5846,7 @@ int LuaSyncedRead::IsUnitInLos(lua_State* L)
 		return 1;
 	}
 
-	lua_pushboolean(L, losHandler->InLos(unit, allyTeamID));
+	lua_pushboolean(L, losHandler->IsUnitInLos(unit, allyTeamID));
 	return 1;
 }
 
@@ -5579,7 +5880,7 @@ int LuaSyncedRead::IsUnitInRadar(lua_State* L)
 		return 1;
 	}
 
-	lua_pushboolean(L, losHandler->InRadar(unit, allyTeamID));
+	lua_pushboolean(L, losHandler->IsUnitInRadar(unit, allyTeamID));
 	return 1;
 }
 
@@ -37,6 +37,7 @@ class LuaSyncedRead {
 
 		static int GetGameRulesParam(lua_State* L);
 		static int GetGameRulesParams(lua_State* L);
+		static int GetRulesParamSlot(lua_State* L);
 
 		static int GetTidal(lua_State* L);
 		static int GetWind(lua_State* L);
@@ -123,6 +124,7 @@ class LuaSyncedRead {
 		static int GetUnitDirection(lua_State* L);
 		static int GetUnitHeading(lua_State* L);
 		static int GetUnitVelocity(lua_State* L);
+		static int GetUnitsData(lua_State* L);
 		static int GetUnitBuildFacing(lua_State* L);
 		static int GetUnitIsBuilding(lua_State* L);
 		static int GetUnitCurrentBuildPower(lua_State* L);
@@ -169,6 +171,8 @@ class LuaSyncedRead {
 
 		static int GetUnitRulesParam(lua_State* L);
 		static int GetUnitRulesParams(lua_State* L);
+		static int GetUnitRulesParamBySlot(lua_State* L);
+		static int GetUnitRulesParamChanges(lua_State* L);
 
 		static int GetUnitLosState(lua_State* L);
 		static int GetUnitSeparation(lua_State* L);
@@ -0,0 +1,126 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaTypedArray.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "lib/sol2/sol.hpp"
+
+#include "System/SafeUtil.h"
+#include "LuaUtils.h"
+
+LuaTypedArray::LuaTypedArray(GLenum type_, int count_)
+	: type{ type_ }
+	, typeSizeInBytes{ 0u }
+	, count{ 0u }
+	, data{}
+{
+	if (!IsTypeValid(type))
+		LuaUtils::SolLuaError("[LuaTypedArray::%s] Invalid array type [%u], use one of GL.FLOAT, GL.INT, GL.UNSIGNED_INT or GL.UNSIGNED_BYTE", __func__, type);
+
+	typeSizeInBytes = (type == GL_UNSIGNED_BYTE) ? 1u : 4u;
+
+	Resize(count_);
+}
+
+bool LuaTypedArray::IsTypeValid(GLenum type)
+{
+	switch (type) {
+	case GL_FLOAT:
+	case GL_INT:
+	case GL_UNSIGNED_INT:
+	case GL_UNSIGNED_BYTE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void LuaTypedArray::Resize(int count_)
+{
+	if (count_ < 0 || static_cast<uint64_t>(count_) * typeSizeInBytes > ARRAY_SANE_LIMIT_BYTES)
+		LuaUtils::SolLuaError("[LuaTypedArray::%s] Invalid array size [%d], must be positive and at most %u bytes", __func__, count_, ARRAY_SANE_LIMIT_BYTES);
+
+	count = static_cast<uint32_t>(count_);
+	data.resize(count * typeSizeInBytes, 0);
+}
+
+uint32_t LuaTypedArray::CheckIndex(int idx, const char* func) const
+{
+	if (idx < 1 || static_cast<uint32_t>(idx) > count)
+		LuaUtils::SolLuaError("[LuaTypedArray::%s] Index [%d] is out of the array bounds [1, %u]", func, idx, count);
+
+	return static_cast<uint32_t>(idx - 1);
+}
+
+void LuaTypedArray::SetImpl(uint32_t idx, lua_Number value)
+{
+	switch (type) {
+	case GL_FLOAT:         { *Ptr<float   >(idx) = static_cast<float>(value); } break;
+	case GL_INT:           { *Ptr<int32_t >(idx) = spring::SafeCast<int32_t , lua_Number>(value); } break;
+	case GL_UNSIGNED_INT:  { *Ptr<uint32_t>(idx) = spring::SafeCast<uint32_t, lua_Number>(value); } break;
+	case GL_UNSIGNED_BYTE: { *Ptr<uint8_t >(idx) = spring::SafeCast<uint8_t , lua_Number>(value); } break;
+	default: { assert(false); } break;
+	}
+}
+
+lua_Number LuaTypedArray::Get(int idx) const
+{
+	const uint32_t i = CheckIndex(idx, __func__);
+
+	switch (type) {
+	case GL_FLOAT:         return static_cast<lua_Number>(*Ptr<float   >(i));
+	case GL_INT:           return static_cast<lua_Number>(*Ptr<int32_t >(i));
+	case GL_UNSIGNED_INT:  return static_cast<lua_Number>(*Ptr<uint32_t>(i));
+	case GL_UNSIGNED_BYTE: return static_cast<lua_Number>(*Ptr<uint8_t >(i));
+	default: { assert(false); } break;
+	}
+
+	return 0;
+}
+
+void LuaTypedArray::Set(int idx, sol::variadic_args values)
+{
+	const uint32_t i = CheckIndex(idx, __func__);
+
+	if (i + values.size() > count)
+		LuaUtils::SolLuaError("[LuaTypedArray::%s] Writing %u values at index [%d] exceeds the array size [%u]", __func__, static_cast<uint32_t>(values.size()), idx, count);
+
+	uint32_t j = i;
+
+	for (const auto& value: values) {
+		SetImpl(j++, value.as<lua_Number>());
+	}
+}
+
+void LuaTypedArray::SetValue(int idx, lua_Number value)
+{
+	SetImpl(CheckIndex(idx, __func__), value);
+}
+
+void LuaTypedArray::Fill(lua_Number value, sol::optional<int> firstOpt, sol::optional<int> lastOpt)
+{
+	if (count == 0)
+		return;
+
+	const uint32_t first = CheckIndex(firstOpt.value_or(1), __func__);
+	const uint32_t last = CheckIndex(lastOpt.value_or(count), __func__);
+
+	for (uint32_t i = first; i <= last; ++i) {
+		SetImpl(i, value);
+	}
+}
+
+int LuaTypedArray::FromTable(const sol::stack_table& luaTblData, sol::optional<int> dstIdxOpt)
+{
+	const uint32_t dstIdx = CheckIndex(dstIdxOpt.value_or(1), __func__);
+	const uint32_t numValues = std::min(static_cast<uint32_t>(luaTblData.size()), count - dstIdx);
+
+	constexpr auto defaultValue = static_cast<lua_Number>(0);
+	for (uint32_t k = 0; k < numValues; ++k) {
+		SetImpl(dstIdx + k, luaTblData.raw_get_or<lua_Number>(k + 1, defaultValue));
+	}
+
+	return static_cast<int>(numValues);
+}
@@ -0,0 +1,61 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_TYPED_ARRAY_H
+#define LUA_TYPED_ARRAY_H
+
+#include <cstdint>
+#include <vector>
+
+#include "lib/lua/include/lua.h" //for lua_Number
+#include "lib/sol2/forward.hpp"
+
+#include "Rendering/GL/myGL.h"
+
+/**
+ * Flat native array of one basic GL type that Lua fills in place, so a VBO
+ * upload from it is a plain memcpy (or a per-element cast) instead of a walk
+ * over a Lua table; see LuaVBOImpl::Upload
+ */
+class LuaTypedArray {
+public:
+	LuaTypedArray() = delete;
+	LuaTypedArray(GLenum type, int count);
+	LuaTypedArray(const LuaTypedArray&) = delete;
+	LuaTypedArray(LuaTypedArray&&) = default;
+
+	lua_Number Get(int idx) const;
+	// writes the values to consecutive slots starting at idx
+	void Set(int idx, sol::variadic_args values);
+	void SetValue(int idx, lua_Number value);
+	void Fill(lua_Number value, sol::optional<int> firstOpt, sol::optional<int> lastOpt);
+	// copies a Lua array into the slots starting at dstIdx, returns the number of copied values
+	int FromTable(const sol::stack_table& luaTblData, sol::optional<int> dstIdxOpt);
+
+	void Resize(int count);
+
+	int GetSize() const { return static_cast<int>(count); }
+	GLenum GetType() const { return type; }
+
+	const void* GetData() const { return data.data(); }
+	uint32_t GetTypeSizeInBytes() const { return typeSizeInBytes; }
+public:
+	static bool IsTypeValid(GLenum type);
+private:
+	template<typename T> T* Ptr(uint32_t idx) { return reinterpret_cast<T*>(data.data()) + idx; }
+	template<typename T> const T* Ptr(uint32_t idx) const { return reinterpret_cast<const T*>(data.data()) + idx; }
+
+	uint32_t CheckIndex(int idx, const char* func) const;
+
+	void SetImpl(uint32_t idx, lua_Number value);
+private:
+	GLenum type;
+	uint32_t typeSizeInBytes;
+	uint32_t count;
+
+	// float is the widest type, the default allocator always satisfies its alignment
+	std::vector<uint8_t> data;
+private:
+	static constexpr uint32_t ARRAY_SANE_LIMIT_BYTES = 0x1000000u; //16 MB, as LuaVBOImpl::BUFFER_SANE_LIMIT_BYTES
+};
+
+#endif //LUA_TYPED_ARRAY_H
@@ -29,6 +29,7 @@
 #include "LuaZip.h"
 #include "Game/Camera.h"
 #include "Game/GlobalUnsynced.h"
+#include "Game/UI/GuiHandler.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Units/CommandAI/CommandDescription.h"
@@ -37,8 +38,10 @@
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/VFSModes.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/GlobalConfig.h"
 #include "System/StringUtil.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
 #include "lib/luasocket/src/luasocket.h"
 
 #include <cstdio>
@@ -51,6 +54,12 @@ CONFIG(bool, LuaSocketEnabled)
 ;
 
 
+CONFIG(bool, LuaUIThreadedUpdate)
+	.defaultValue(false)
+	.description("Run the Update call-in of LuaUI on a worker thread while the frame is swapped. Widgets must then not call gl.* functions from Update; Spring.SendCommands is deferred until the worker is done.")
+;
+
+
 CLuaUI* luaUI = nullptr;
 
 
@@ -76,6 +85,7 @@ CLuaUI::CLuaUI()
 	UpdateTeams();
 
 	queuedAction = ACTION_NOVALUE;
+	threadedUpdate = configHandler->GetBool("LuaUIThreadedUpdate");
 
 	haveShockFront = false;
 	shockFrontMinArea  = 0.0f;
@@ -183,9 +193,60 @@ CLuaUI::CLuaUI()
 
 CLuaUI::~CLuaUI()
 {
+	// never leave a worker running on a dead handle
+	if (updateTask != nullptr)
+		updateTask->get();
+
 	luaUI = nullptr;
 }
 
+
+void CLuaUI::Update()
+{
+	if (!threadedUpdate) {
+		CLuaHandle::Update();
+		return;
+	}
+
+	pendingUpdate = true;
+}
+
+void CLuaUI::StartThreadedUpdate()
+{
+	if (!pendingUpdate)
+		return;
+
+	pendingUpdate = false;
+
+	assert(updateTask == nullptr);
+	updateTask = ThreadPool::Enqueue([this]() { CLuaHandle::Update(); });
+}
+
+void CLuaUI::FinishThreadedUpdate()
+{
+	if (updateTask == nullptr)
+		return;
+
+	updateTask->get();
+	updateTask.reset();
+
+	if (deferredCommands.empty())
+		return;
+
+	// execute on a copy, the commands may reload LuaUI
+	std::vector<std::string> cmds = std::move(deferredCommands);
+	deferredCommands.clear();
+
+	configHandler->EnableWriting(globalConfig.luaWritableConfigFile);
+	guihandler->RunCustomCommands(cmds, false);
+	configHandler->EnableWriting(true);
+}
+
+void CLuaUI::DeferCommands(std::vector<std::string>&& cmds)
+{
+	deferredCommands.insert(deferredCommands.end(), std::make_move_iterator(cmds.begin()), std::make_move_iterator(cmds.end()));
+}
+
 void CLuaUI::InitLuaSocket(lua_State* L) {
 	std::string code;
 	std::string filename = "socket.lua";
@@ -3,6 +3,8 @@
 #ifndef LUA_UI_H
 #define LUA_UI_H
 
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -74,6 +76,20 @@ public: // call-ins
 
 	void ShockFront(const float3& pos, float power, float areaOfEffect, const float* distMod = NULL);
 
+	// with LuaUIThreadedUpdate, only marks the call-in as pending for StartThreadedUpdate
+	void Update() override;
+
+public:
+	// run a pending Update on a worker while the main thread swaps buffers, nothing
+	// else touches LuaUI or mutates engine state meanwhile; Finish must follow the swap
+	void StartThreadedUpdate();
+	void FinishThreadedUpdate();
+
+	bool InThreadedUpdate() const { return (updateTask != nullptr); }
+
+	// commands sent by the worker, they are executed by FinishThreadedUpdate
+	void DeferCommands(std::vector<std::string>&& cmds);
+
 protected:
 	CLuaUI();
 	virtual ~CLuaUI();
@@ -93,6 +109,12 @@ protected:
 protected:
 	QueuedAction queuedAction;
 
+	bool threadedUpdate = false;
+	bool pendingUpdate = false;
+
+	std::shared_ptr<std::future<void>> updateTask;
+	std::vector<std::string> deferredCommands;
+
 	bool haveShockFront;
 	float shockFrontMinArea;
 	float shockFrontMinPower;
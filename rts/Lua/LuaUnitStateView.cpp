@@ -0,0 +1,166 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaUnitStateView.h"
+
+#include "LuaInclude.h"
+#include "LuaHandle.h"
+#include "LuaHashString.h"
+#include "LuaUtils.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitHandler.h"
+
+
+namespace {
+	enum {
+		READ_ALLY    = 0, // allied units only
+		READ_VISIBLE = 1, // in LOS or radar
+		READ_TYPED   = 2, // in LOS, or in radar after having been seen
+		READ_INLOS   = 3,
+	};
+
+	struct StateColumn {
+		const char* name;
+		int access;
+
+		// pushes the value of <unit>, or nothing if it is hidden
+		int (*push)(lua_State* L, const CUnit* unit, bool allyUnit);
+	};
+
+	int PushHealthScaled(lua_State* L, const CUnit* unit, bool allyUnit, float value) {
+		const UnitDef* ud = unit->unitDef;
+
+		// as GetUnitHealth
+		if (allyUnit || (!ud->hideDamage && ud->decoyDef == nullptr)) {
+			lua_pushnumber(L, value);
+			return 1;
+		}
+		if (ud->hideDamage)
+			return 0;
+
+		lua_pushnumber(L, value * (ud->decoyDef->health / ud->health));
+		return 1;
+	}
+
+	const StateColumn STATE_COLUMNS[] = {
+		{"posX", READ_INLOS, [](lua_State* L, const CUnit* u, bool a) { lua_pushnumber(L, u->pos.x); return 1; }},
+		{"posY", READ_INLOS, [](lua_State* L, const CUnit* u, bool a) { lua_pushnumber(L, u->pos.y); return 1; }},
+		{"posZ", READ_INLOS, [](lua_State* L, const CUnit* u, bool a) { lua_pushnumber(L, u->pos.z); return 1; }},
+
+		{"health",        READ_INLOS, [](lua_State* L, const CUnit* u, bool a) { return (PushHealthScaled(L, u, a, u->health   )); }},
+		{"maxHealth",     READ_INLOS, [](lua_State* L, const CUnit* u, bool a) { return (PushHealthScaled(L, u, a, u->maxHealth)); }},
+		{"buildProgress", READ_INLOS, [](lua_State* L, const CUnit* u, bool a) { lua_pushnumber(L, u->buildProgress); return 1; }},
+
+		{"teamID",     READ_VISIBLE, [](lua_State* L, const CUnit* u, bool a) { lua_pushnumber(L, u->team); return 1; }},
+		{"allyTeamID", READ_VISIBLE, [](lua_State* L, const CUnit* u, bool a) { lua_pushnumber(L, u->allyteam); return 1; }},
+		{"unitDefID",  READ_TYPED,   [](lua_State* L, const CUnit* u, bool a) { lua_pushnumber(L, (a? u->unitDef: LuaUtils::EffectiveUnitDef(L, u))->id); return 1; }},
+
+		{"fireState", READ_ALLY, [](lua_State* L, const CUnit* u, bool a) { lua_pushnumber(L, u->fireState); return 1; }},
+		{"moveState", READ_ALLY, [](lua_State* L, const CUnit* u, bool a) { lua_pushnumber(L, u->moveState); return 1; }},
+		{"active",    READ_ALLY, [](lua_State* L, const CUnit* u, bool a) { lua_pushboolean(L, u->activated); return 1; }},
+	};
+
+	constexpr char COLUMN_METATABLE_NAME[] = "UnitStateColumn";
+	constexpr char VIEW_REGISTRY_KEY[] = "UnitStateView";
+
+
+	bool CanRead(lua_State* L, const CUnit* unit, int access) {
+		if (access == READ_ALLY)
+			return false;
+
+		const unsigned short losStatus = unit->losStatus[CLuaHandle::GetHandleReadAllyTeam(L)];
+		const unsigned short prevMask = (LOS_PREVLOS | LOS_CONTRADAR);
+
+		switch (access) {
+			case READ_VISIBLE: { return ((losStatus & (LOS_INLOS | LOS_INRADAR)) != 0); } break;
+			case READ_TYPED  : { return ((losStatus & LOS_INLOS) != 0 || (losStatus & prevMask) == prevMask); } break;
+			case READ_INLOS  : { return ((losStatus & LOS_INLOS) != 0); } break;
+			default          : {} break;
+		}
+
+		return false;
+	}
+}
+
+
+bool LuaUnitStateView::PushEntries(lua_State* L)
+{
+	REGISTER_LUA_CFUNC(GetUnitStateView);
+
+	luaL_newmetatable(L, COLUMN_METATABLE_NAME);
+	HSTR_PUSH_CFUNC(L, "__index",    meta_index);
+	HSTR_PUSH_CFUNC(L, "__newindex", meta_newindex);
+	HSTR_PUSH_CFUNC(L, "__len",      meta_len);
+	HSTR_PUSH_STRING(L, "__metatable", "protected metatable");
+	lua_pop(L, 1);
+
+	return true;
+}
+
+
+/******************************************************************************
+ * Spring.GetUnitStateView() returns, once per handle, the table
+ * {version = number, posX = column, ..., unitDefID = column, ...}
+ * where column[unitID] reads a value or gives nil if the unit does not exist
+ * or the value is hidden from the caller
+ */
+int LuaUnitStateView::GetUnitStateView(lua_State* L)
+{
+	lua_getfield(L, LUA_REGISTRYINDEX, VIEW_REGISTRY_KEY);
+
+	if (lua_istable(L, -1))
+		return 1;
+
+	lua_pop(L, 1);
+	lua_createtable(L, 0, 1 + sizeof(STATE_COLUMNS) / sizeof(STATE_COLUMNS[0]));
+
+	HSTR_PUSH_NUMBER(L, "version", VIEW_VERSION);
+
+	for (size_t i = 0; i < sizeof(STATE_COLUMNS) / sizeof(STATE_COLUMNS[0]); i++) {
+		lua_pushstring(L, STATE_COLUMNS[i].name);
+
+		*static_cast<const StateColumn**>(lua_newuserdata(L, sizeof(const StateColumn*))) = &STATE_COLUMNS[i];
+		luaL_getmetatable(L, COLUMN_METATABLE_NAME);
+		lua_setmetatable(L, -2);
+
+		lua_rawset(L, -3);
+	}
+
+	lua_pushvalue(L, -1);
+	lua_setfield(L, LUA_REGISTRYINDEX, VIEW_REGISTRY_KEY);
+	return 1;
+}
+
+
+int LuaUnitStateView::meta_index(lua_State* L)
+{
+	// only column userdata carry this metatable, and it can not be swapped out
+	const StateColumn* column = *static_cast<const StateColumn**>(lua_touserdata(L, 1));
+
+	if (!lua_isnumber(L, 2))
+		return 0;
+
+	const CUnit* unit = unitHandler.GetUnit(lua_toint(L, 2));
+
+	if (unit == nullptr)
+		return 0;
+
+	const bool allyUnit = LuaUtils::IsAllyUnit(L, unit);
+
+	if (!allyUnit && !CanRead(L, unit, column->access))
+		return 0;
+
+	return (column->push(L, unit, allyUnit));
+}
+
+int LuaUnitStateView::meta_newindex(lua_State* L)
+{
+	luaL_error(L, "[%s] unit state views are read-only", __func__);
+	return 0;
+}
+
+int LuaUnitStateView::meta_len(lua_State* L)
+{
+	lua_pushnumber(L, unitHandler.MaxUnits());
+	return 1;
+}
@@ -0,0 +1,31 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_UNIT_STATE_VIEW_H
+#define LUA_UNIT_STATE_VIEW_H
+
+struct lua_State;
+
+/**
+ * Read-only columns of hot per-unit state indexed directly by unitID
+ * (view.health[unitID]), bypassing the argument parsing and error paths of
+ * the Spring.GetUnit* call-outs. An element read is one metamethod call: an
+ * ID-indexed unit lookup, a LOS flag test and the load of the value, with
+ * the values and access rules of the matching call-out.
+ */
+class LuaUnitStateView {
+public:
+	static bool PushEntries(lua_State* L);
+
+	static int GetUnitStateView(lua_State* L);
+
+public:
+	// bumped whenever columns are added or their meaning changes
+	static constexpr int VIEW_VERSION = 1;
+
+private:
+	static int meta_index(lua_State* L);
+	static int meta_newindex(lua_State* L);
+	static int meta_len(lua_State* L);
+};
+
+#endif // LUA_UNIT_STATE_VIEW_H
@@ -10,6 +10,7 @@
 #include "LuaOpenGLUtils.h"
 #include "LuaParser.h"
 #include "LuaTextures.h"
+#include "LuaUI.h"
 #include "LuaUtils.h"
 
 #include "ExternalAI/EngineOutHandler.h"
@@ -75,6 +76,7 @@
 #include "System/Log/ILog.h"
 #include "System/Net/PackPacket.h"
 #include "System/Platform/Misc.h"
+#include "System/Platform/Threading.h"
 #include "System/SafeUtil.h"
 #include "System/UnorderedMap.hpp"
 #include "System/StringUtil.h"
@@ -270,6 +272,9 @@ bool LuaUnsyncedCtrl::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(ClearWatchDogTimer);
 	REGISTER_LUA_CFUNC(GarbageCollectCtrl);
+	REGISTER_LUA_CFUNC(SetAllocProfiling);
+	REGISTER_LUA_CFUNC(BeginAddonProfile);
+	REGISTER_LUA_CFUNC(EndAddonProfile);
 
 	REGISTER_LUA_CFUNC(PreloadUnitDefModel);
 	REGISTER_LUA_CFUNC(PreloadFeatureDefModel);
@@ -2005,6 +2010,12 @@ int LuaUnsyncedCtrl::SendCommands(lua_State* L)
 
 	lua_settop(L, 0); // pop the input arguments
 
+	// actions may touch GL, run them once LuaUI's threaded Update has finished
+	if (luaUI != nullptr && luaUI->InThreadedUpdate() && !Threading::IsMainThread()) {
+		luaUI->DeferCommands(std::move(cmds));
+		return 0;
+	}
+
 	configHandler->EnableWriting(globalConfig.luaWritableConfigFile);
 	guihandler->RunCustomCommands(cmds, false);
 	configHandler->EnableWriting(true);
@@ -3164,6 +3175,56 @@ int LuaUnsyncedCtrl::GarbageCollectCtrl(lua_State* L) {
 	gcCtrl.baseRunTimeMult = std::max(0.0f, luaL_optfloat(L, 7, gcCtrl.baseRunTimeMult));
 	gcCtrl.baseMemLoadMult = std::max(0.0f, luaL_optfloat(L, 8, gcCtrl.baseMemLoadMult));
 
+	gcCtrl.frameBudget = std::max(0.0f, luaL_optfloat(L, 9, gcCtrl.frameBudget));
+
+	return 0;
+}
+
+int LuaUnsyncedCtrl::SetAllocProfiling(lua_State* L) {
+	const luaContextData* ctxData = GetLuaContextData(L);
+	LuaAllocProfiler* allocProfiler = ctxData->allocProfiler;
+
+	if (allocProfiler == nullptr)
+		return 0;
+
+	// hook the handle's main thread, coroutines created after this inherit it
+	lua_State* handleL = ctxData->owner->GetLuaState();
+
+	if (luaL_optboolean(L, 3, false))
+		allocProfiler->Clear();
+
+	if (luaL_checkboolean(L, 1)) {
+		allocProfiler->Enable(handleL, luaL_optint(L, 2, LuaAllocProfiler::DEFAULT_HOOK_PERIOD));
+	} else {
+		allocProfiler->Disable(handleL);
+	}
+
+	return 0;
+}
+
+int LuaUnsyncedCtrl::BeginAddonProfile(lua_State* L) {
+	const luaContextData* ctxData = GetLuaContextData(L);
+	LuaAddonProfiler* addonProfiler = ctxData->addonProfiler;
+
+	if (addonProfiler == nullptr)
+		return 0;
+
+	size_t nameLen = 0;
+	const char* name = luaL_checklstring(L, 1, &nameLen);
+
+	addonProfiler->Begin(ctxData->owner->GetName().c_str(), ctxData->synced, name, nameLen, ctxData->allocState.allocSumBytes.load());
+	return 0;
+}
+
+int LuaUnsyncedCtrl::EndAddonProfile(lua_State* L) {
+	const luaContextData* ctxData = GetLuaContextData(L);
+	LuaAddonProfiler* addonProfiler = ctxData->addonProfiler;
+
+	if (addonProfiler == nullptr)
+		return 0;
+
+	// nothing is returned, synced code may call this too
+	addonProfiler->End(ctxData->allocState.allocSumBytes.load());
 	return 0;
 }
 
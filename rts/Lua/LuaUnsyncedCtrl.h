@@ -173,6 +173,9 @@ class LuaUnsyncedCtrl {
 
 		static int ClearWatchDogTimer(lua_State* L);
 		static int GarbageCollectCtrl(lua_State* L);
+		static int SetAllocProfiling(lua_State* L);
+		static int BeginAddonProfile(lua_State* L);
+		static int EndAddonProfile(lua_State* L);
 
 		static int PreloadUnitDefModel(lua_State* L);
 		static int PreloadFeatureDefModel(lua_State* L);
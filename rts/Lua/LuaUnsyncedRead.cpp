@@ -61,6 +61,7 @@
 #include "Game/UI/Groups/GroupHandler.h"
 #include "Net/Protocol/NetProtocol.h" // NETMSG_*
 #include "System/TimeProfiler.h"
+#include "System/MemoryStats.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Config/ConfigVariable.h"
 #include "System/Input/KeyInput.h"
@@ -99,7 +100,10 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetProfilerRecordNames);
 
 	REGISTER_LUA_CFUNC(GetLuaMemUsage);
+	REGISTER_LUA_CFUNC(GetAllocProfile);
+	REGISTER_LUA_CFUNC(GetAddonProfile);
 	REGISTER_LUA_CFUNC(GetVidMemUsage);
+	REGISTER_LUA_CFUNC(GetMemoryStats);
 
 	REGISTER_LUA_CFUNC(GetDrawFrame);
 	REGISTER_LUA_CFUNC(GetFrameTimeOffset);
@@ -145,6 +149,7 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(GetVisibleUnits);
 	REGISTER_LUA_CFUNC(GetVisibleFeatures);
+	REGISTER_LUA_CFUNC(GetVisibleObjectsStamp);
 	REGISTER_LUA_CFUNC(GetVisibleProjectiles);
 
 	REGISTER_LUA_CFUNC(GetRenderUnits);
@@ -473,6 +478,66 @@ int LuaUnsyncedRead::GetLuaMemUsage(lua_State* L)
 	return 8;
 }
 
+int LuaUnsyncedRead::GetAllocProfile(lua_State* L)
+{
+	const LuaAllocProfiler* allocProfiler = GetLuaContextData(L)->allocProfiler;
+
+	if (allocProfiler == nullptr)
+		return 0;
+
+	const auto& sizeClassCounts = allocProfiler->GetSizeClassCounts();
+	const auto& topSites = allocProfiler->GetTopSites(luaL_optint(L, 1, 32));
+
+	// [i] := number of allocations whose size rounds up to 2^(i-1) bytes
+	lua_createtable(L, sizeClassCounts.size(), 0);
+
+	for (size_t i = 0; i < sizeClassCounts.size(); i++) {
+		lua_pushnumber(L, sizeClassCounts[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	lua_createtable(L, topSites.size(), 0);
+
+	for (size_t i = 0; i < topSites.size(); i++) {
+		lua_createtable(L, 0, 4);
+		HSTR_PUSH_STRING(L, "source", topSites[i]->source);
+		HSTR_PUSH_NUMBER(L, "line", topSites[i]->line);
+		HSTR_PUSH_NUMBER(L, "samples", topSites[i]->numSamples);
+		HSTR_PUSH_NUMBER(L, "kiloBytes", topSites[i]->allocBytes / 1024.0f); // can exceed 1<<24 in bytes
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 2;
+}
+
+int LuaUnsyncedRead::GetAddonProfile(lua_State* L)
+{
+	LuaAddonProfiler* addonProfiler = GetLuaContextData(L)->addonProfiler;
+
+	if (addonProfiler == nullptr)
+		return 0;
+
+	const auto& sortedStats = addonProfiler->GetSortedStats();
+
+	lua_createtable(L, sortedStats.size(), 0);
+
+	for (size_t i = 0; i < sortedStats.size(); i++) {
+		lua_createtable(L, 0, 5);
+		HSTR_PUSH_STRING(L, "name", sortedStats[i]->name);
+		HSTR_PUSH_NUMBER(L, "totalTime", sortedStats[i]->totalTime.toMilliSecsf());
+		HSTR_PUSH_NUMBER(L, "peakTime", sortedStats[i]->peakTime.toMilliSecsf());
+		HSTR_PUSH_NUMBER(L, "calls", sortedStats[i]->numCalls);
+		HSTR_PUSH_NUMBER(L, "kiloBytes", sortedStats[i]->allocBytes / 1024.0f);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	// optionally start a new measuring period
+	if (luaL_optboolean(L, 1, false))
+		addonProfiler->Clear();
+
+	return 1;
+}
+
 int LuaUnsyncedRead::GetVidMemUsage(lua_State* L)
 {
 	int2 vidMemInfo;
@@ -484,6 +549,25 @@ int LuaUnsyncedRead::GetVidMemUsage(lua_State* L)
 	return 2;
 }
 
+int LuaUnsyncedRead::GetMemoryStats(lua_State* L)
+{
+	// refreshed about once per second, see /debuginfo memory
+	const std::vector<CMemoryStats::Entry> entries = memoryStats.GetSnapshot();
+
+	lua_createtable(L, 0, entries.size());
+
+	// (kilo)bytes, can exceed 1<<24 otherwise
+	for (const CMemoryStats::Entry& e: entries) {
+		lua_pushsstring(L, e.first);
+		lua_pushnumber(L, e.second / 1024.0f);
+		lua_rawset(L, -3);
+	}
+
+	lua_pushnumber(L, CMemoryStats::GetResidentBytes() / 1024.0f);
+	lua_pushnumber(L, CMemoryStats::GetPeakResidentBytes() / 1024.0f);
+	return 3;
+}
+
 
 /******************************************************************************/
 
@@ -997,6 +1081,47 @@ int LuaUnsyncedRead::GetVisibleUnits(lua_State* L)
 		testRadius = std::max(testRadius, -testRadius);
 	}
 
+	const auto IsListed = [&](const CUnit* u) {
+		if (u->noDraw)
+			return false;
+
+		if (allyTeamID >= 0 && !(u->losStatus[allyTeamID] & LOS_INLOS))
+			return false;
+
+		if (noIcons && u->GetIsIcon())
+			return false;
+
+		if ((teamID == LuaUtils::AllyUnits)  && (allyTeamID != u->allyteam))
+			return false;
+
+		if ((teamID == LuaUtils::EnemyUnits) && (allyTeamID == u->allyteam))
+			return false;
+
+		//No check for AllUnits, since there's no need.
+		return ((teamID < 0) || (teamID == u->team));
+	};
+
+	unsigned int count = 0;
+
+	// the drawer has already tested every unit against this camera (during
+	// its Update of this frame), filter its results rather than re-culling
+	if (unitDrawer->HasViewCullRadii(camera)) {
+		lua_newtable(L);
+
+		for (const CUnit* u: unitDrawer->GetUnsortedUnits()) {
+			if (u->viewCullRadius > (testRadius + (u->GetDrawRadius() * radiusMult)))
+				continue;
+
+			if (!IsListed(u))
+				continue;
+
+			lua_pushnumber(L, u->id);
+			lua_rawseti(L, -2, ++count);
+		}
+
+		return 1;
+	}
+
 	static CVisUnitQuadDrawer unitQuadIter;
 
 	unitQuadIter.ResetState();
@@ -1007,7 +1132,6 @@ int LuaUnsyncedRead::GetVisibleUnits(lua_State* L)
 	const int tempNum = gs->GetTempNum();
 	lua_createtable(L, unitQuadIter.GetObjectCount(), 0);
 
-	unsigned int count = 0;
 	for (auto visUnitList: unitQuadIter.GetObjectLists()) {
 		for (CUnit* u: *visUnitList) {
 			if (u->tempNum == tempNum)
@@ -1015,26 +1139,9 @@ int LuaUnsyncedRead::GetVisibleUnits(lua_State* L)
 
 			u->tempNum = tempNum;
 
-			if (u->noDraw)
-				continue;
-
-			if (allyTeamID >= 0 && !(u->losStatus[allyTeamID] & LOS_INLOS))
-				continue;
-
-			if (noIcons && u->GetIsIcon())
-				continue;
-
-			if ((teamID == LuaUtils::AllyUnits)  && (allyTeamID != u->allyteam))
+			if (!IsListed(u))
 				continue;
 
-			if ((teamID == LuaUtils::EnemyUnits) && (allyTeamID == u->allyteam))
-				continue;
-
-			if ((teamID >= 0) && (teamID != u->team))
-				continue;
-
-			//No check for AllUnits, since there's no need.
-
 			if (!camera->InView(u->drawMidPos, testRadius + (u->GetDrawRadius() * radiusMult)))
 				continue;
 
@@ -1076,6 +1183,39 @@ int LuaUnsyncedRead::GetVisibleFeatures(lua_State* L)
 		testRadius = std::max(testRadius, -testRadius);
 	}
 
+	const auto IsListed = [&](const CFeature* f) {
+		if (f->noDraw)
+			return false;
+
+		if (noIcons && f->drawFlag == DrawFlags::SO_DRICON_FLAG)
+			return false;
+
+		if (noGeos && f->def->geoThermal)
+			return false;
+
+		return (gu->spectatingFullView || f->IsInLosForAllyTeam(allyTeamID));
+	};
+
+	unsigned int count = 0;
+
+	// see GetVisibleUnits
+	if (featureDrawer->HasViewCullRadii(camera)) {
+		lua_newtable(L);
+
+		for (const CFeature* f: featureDrawer->GetUnsortedFeatures()) {
+			if (f->viewCullRadius > (testRadius + (f->GetDrawRadius() * radiusMult)))
+				continue;
+
+			if (!IsListed(f))
+				continue;
+
+			lua_pushnumber(L, f->id);
+			lua_rawseti(L, -2, ++count);
+		}
+
+		return 1;
+	}
+
 	static CVisFeatureQuadDrawer featureQuadIter;
 
 	featureQuadIter.ResetState();
@@ -1086,7 +1226,6 @@ int LuaUnsyncedRead::GetVisibleFeatures(lua_State* L)
 	const int tempNum = gs->GetTempNum();
 	lua_createtable(L, featureQuadIter.GetObjectCount(), 0);
 
-	unsigned int count = 0;
 	for (auto visFeatureList: featureQuadIter.GetObjectLists()) {
 		for (CFeature* f: *visFeatureList) {
 			if (f->tempNum == tempNum)
@@ -1094,16 +1233,7 @@ int LuaUnsyncedRead::GetVisibleFeatures(lua_State* L)
 
 			f->tempNum = tempNum;
 
-			if (f->noDraw)
-				continue;
-
-			if (noIcons && f->drawFlag == DrawFlags::SO_DRICON_FLAG)
-				continue;
-
-			if (noGeos && f->def->geoThermal)
-				continue;
-
-			if (!gu->spectatingFullView && !f->IsInLosForAllyTeam(allyTeamID))
+			if (!IsListed(f))
 				continue;
 
 			if (!camera->InView(f->drawMidPos, testRadius + (f->GetDrawRadius() * radiusMult)))
@@ -1118,6 +1248,16 @@ int LuaUnsyncedRead::GetVisibleFeatures(lua_State* L)
 	return 1;
 }
 
+
+int LuaUnsyncedRead::GetVisibleObjectsStamp(lua_State* L)
+{
+	// unchanged stamps mean GetVisible{Units,Features} would still return
+	// the same objects for the player camera, barring LOS or team changes
+	lua_pushnumber(L, unitDrawer->GetViewCullStamp());
+	lua_pushnumber(L, featureDrawer->GetViewCullStamp());
+	return 2;
+}
+
 int LuaUnsyncedRead::GetVisibleProjectiles(lua_State* L)
 {
 	int allyTeamID = luaL_optint(L, 1, -1);
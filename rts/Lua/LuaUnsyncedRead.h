@@ -23,7 +23,10 @@ class LuaUnsyncedRead {
 		static int GetProfilerRecordNames(lua_State* L);
 
 		static int GetLuaMemUsage(lua_State* L);
+		static int GetAllocProfile(lua_State* L);
+		static int GetAddonProfile(lua_State* L);
 		static int GetVidMemUsage(lua_State* L);
+		static int GetMemoryStats(lua_State* L);
 
 		static int GetDrawFrame(lua_State* L);
 		static int GetFrameTimeOffset(lua_State* L);
@@ -71,6 +74,7 @@ class LuaUnsyncedRead {
 
 		static int GetVisibleUnits(lua_State* L);
 		static int GetVisibleFeatures(lua_State* L);
+		static int GetVisibleObjectsStamp(lua_State* L);
 		static int GetVisibleProjectiles(lua_State* L);
 
 		static int GetRenderUnits(lua_State* L);
@@ -6,6 +6,7 @@
 #include "lib/sol2/sol.hpp"
 
 #include "Rendering/GL/myGL.h"
+#include "LuaTypedArray.h"
 #include "LuaVBOImpl.h"
 #include "LuaUtils.h"
 
@@ -14,6 +15,7 @@
 bool LuaVBO::PushEntries(lua_State* L)
 {
 	REGISTER_LUA_CFUNC(GetVBO);
+	REGISTER_LUA_CFUNC(GetTypedArray);
 
 	sol::state_view lua(L);
 	auto gl = sol::stack::get<sol::table>(L, -1);
@@ -23,7 +25,10 @@ bool LuaVBO::PushEntries(lua_State* L)
 		"Delete", &LuaVBOImpl::Delete,
 
 		"Define", &LuaVBOImpl::Define,
-		"Upload", &LuaVBOImpl::Upload,
+		"Upload", sol::overload(
+			sol::resolve<size_t(const sol::stack_table&, sol::optional<int>, sol::optional<int>, sol::optional<int>, sol::optional<int>)>(&LuaVBOImpl::Upload),
+			sol::resolve<size_t(const LuaTypedArray&, sol::optional<int>, sol::optional<int>, sol::optional<int>, sol::optional<int>)>(&LuaVBOImpl::Upload)
+		),
 		"Download", &LuaVBOImpl::Download,
 
 		"ModelsVBO", &LuaVBOImpl::ModelsVBO,
@@ -54,9 +59,41 @@ bool LuaVBO::PushEntries(lua_State* L)
 
 	gl.set("VBO", sol::lua_nil); //because :)
 
+	gl.new_usertype<LuaTypedArray>("TypedArray",
+		sol::constructors<LuaTypedArray(GLenum, int)>(),
+		"Get", &LuaTypedArray::Get,
+		"Set", &LuaTypedArray::Set,
+		"Fill", &LuaTypedArray::Fill,
+		"FromTable", &LuaTypedArray::FromTable,
+		"Resize", &LuaTypedArray::Resize,
+
+		"GetSize", &LuaTypedArray::GetSize,
+		"GetType", &LuaTypedArray::GetType,
+
+		// arr[i] and arr[i] = v, only reached for keys that are not methods
+		sol::meta_function::index, &LuaTypedArray::Get,
+		sol::meta_function::new_index, &LuaTypedArray::SetValue,
+		sol::meta_function::length, &LuaTypedArray::GetSize
+	);
+
+	gl.set("TypedArray", sol::lua_nil);
+
 	return true;
 }
 
+int LuaVBO::GetTypedArray(lua_State* L)
+{
+	const unsigned int type = luaL_checkint(L, 1);
+	if (!LuaTypedArray::IsTypeValid(type)) {
+		LOG_L(L_ERROR, "[LuaVBO:%s]: Supplied invalid array type [%u], use one of GL.FLOAT, GL.INT, GL.UNSIGNED_INT or GL.UNSIGNED_BYTE", __func__, type);
+		return 0;
+	}
+
+	return sol::stack::call_lua(L, 1, [](GLenum type, int count) {
+		return std::make_shared<LuaTypedArray>(type, count);
+	});
+}
+
 bool LuaVBO::CheckAndReportSupported(lua_State* L, const unsigned int target) {
 	#define ValStr(arg) { arg, #arg }
 	#define ValStr2(arg1, arg2) { arg1, #arg2 }
@@ -8,6 +8,7 @@ struct lua_State;
 class LuaVBO {
 public:
 	static int GetVBO(lua_State* L);
+	static int GetTypedArray(lua_State* L);
 	static bool PushEntries(lua_State* L);
 private:
 	static bool CheckAndReportSupported(lua_State* L, const unsigned int target);
@@ -3,6 +3,7 @@
 #include <unordered_map>
 #include <algorithm>
 #include <sstream>
+#include <type_traits>
 
 #include "lib/sol2/sol.hpp"
 #include "lib/fmt/format.h"
@@ -13,6 +14,7 @@
 #include "System/SafeUtil.h"
 #include "Rendering/ModelsDataUploader.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/StreamBuffer.h"
 #include "Rendering/GL/VBO.h"
 #include "Sim/Objects/SolidObjectDef.h"
 #include "Sim/Features/Feature.h"
@@ -25,6 +27,7 @@
 #include "Sim/Units/UnitDefHandler.h"
 #include "Game/GlobalUnsynced.h"
 
+#include "LuaTypedArray.h"
 #include "LuaUtils.h"
 
 LuaVBOImpl::LuaVBOImpl(const sol::optional<GLenum> defTargetOpt, const sol::optional<bool> freqUpdatedOpt)
@@ -455,37 +458,45 @@ std::tuple<uint32_t, uint32_t, uint32_t> LuaVBOImpl::GetBufferSize()
 	);
 }
 
-size_t LuaVBOImpl::Upload(const sol::stack_table& luaTblData, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt)
+void LuaVBOImpl::UploadCheckArgs(uint32_t dataSize, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt, const char* func, uint32_t& elemOffset, int& attribIdx, uint32_t& luaStartIndex, uint32_t& luaFinishIndex)
 {
 	if (!vbo) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid VBO. Did you call :Define() or :ShapeFromUnitDefID/ShapeFromFeatureDefID()?", __func__);
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid VBO. Did you call :Define() or :ShapeFromUnitDefID/ShapeFromFeatureDefID()?", func);
 	}
 
-	const uint32_t elemOffset = static_cast<uint32_t>(std::max(elemOffsetOpt.value_or(0), 0));
+	elemOffset = static_cast<uint32_t>(std::max(elemOffsetOpt.value_or(0), 0));
 	if (elemOffset >= elementsCount) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid elemOffset [%u] >= elementsCount [%u]", __func__, elemOffset, elementsCount);
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid elemOffset [%u] >= elementsCount [%u]", func, elemOffset, elementsCount);
 	}
 
-	const int attribIdx = std::max(attribIdxOpt.value_or(-1), -1);
+	attribIdx = std::max(attribIdxOpt.value_or(-1), -1);
 	if (attribIdx != -1 && bufferAttribDefs.find(attribIdx) == bufferAttribDefs.cend()) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] attribIdx is not found in bufferAttribDefs", __func__);
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] attribIdx is not found in bufferAttribDefs", func);
 	}
 
-	const uint32_t luaTblDataSize = luaTblData.size();
-
-	const uint32_t luaStartIndex = static_cast<uint32_t>(std::max(luaStartIndexOpt.value_or(1), 1));
-	if (luaStartIndex > luaTblDataSize) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaStartIndex [%u] exceeds table size [%u]", __func__, luaStartIndex, luaTblDataSize);
+	luaStartIndex = static_cast<uint32_t>(std::max(luaStartIndexOpt.value_or(1), 1));
+	if (luaStartIndex > dataSize) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaStartIndex [%u] exceeds table size [%u]", func, luaStartIndex, dataSize);
 	}
 
-	const uint32_t luaFinishIndex = static_cast<uint32_t>(std::max(luaFinishIndexOpt.value_or(luaTblDataSize), 1));
-	if (luaFinishIndex > luaTblDataSize) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaFinishIndex [%u] exceeds table size [%u]", __func__, luaFinishIndex, luaTblDataSize);
+	luaFinishIndex = static_cast<uint32_t>(std::max(luaFinishIndexOpt.value_or(dataSize), 1));
+	if (luaFinishIndex > dataSize) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaFinishIndex [%u] exceeds table size [%u]", func, luaFinishIndex, dataSize);
 	}
 
 	if (luaStartIndex > luaFinishIndex) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaStartIndex [%u] is greater than luaFinishIndex [%u]", __func__, luaStartIndex, luaFinishIndex);
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaStartIndex [%u] is greater than luaFinishIndex [%u]", func, luaStartIndex, luaFinishIndex);
 	}
+}
+
+size_t LuaVBOImpl::Upload(const sol::stack_table& luaTblData, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt)
+{
+	uint32_t elemOffset;
+	int attribIdx;
+	uint32_t luaStartIndex;
+	uint32_t luaFinishIndex;
+
+	UploadCheckArgs(luaTblData.size(), attribIdxOpt, elemOffsetOpt, luaStartIndexOpt, luaFinishIndexOpt, __func__, elemOffset, attribIdx, luaStartIndex, luaFinishIndex);
 
 	std::vector<lua_Number> dataVec;
 	dataVec.resize(luaFinishIndex - luaStartIndex + 1);
@@ -498,6 +509,37 @@ size_t LuaVBOImpl::Upload(const sol::stack_table& luaTblData, sol::optional<int>
 	return UploadImpl<lua_Number>(dataVec, elemOffset, attribIdx);
 }
 
+size_t LuaVBOImpl::Upload(const LuaTypedArray& typedArray, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt)
+{
+	uint32_t elemOffset;
+	int attribIdx;
+	uint32_t luaStartIndex;
+	uint32_t luaFinishIndex;
+
+	UploadCheckArgs(typedArray.GetSize(), attribIdxOpt, elemOffsetOpt, luaStartIndexOpt, luaFinishIndexOpt, __func__, elemOffset, attribIdx, luaStartIndex, luaFinishIndex);
+
+	// no staging copy, the array is read straight into the CPU-side buffer mirror
+	#define UPLOAD_TYPED(T) { \
+		const T* dataBeg = static_cast<const T*>(typedArray.GetData()); \
+		return UploadImpl<T>(dataBeg + luaStartIndex - 1, dataBeg + luaFinishIndex, elemOffset, attribIdx); \
+	}
+
+	switch (typedArray.GetType()) {
+	case GL_FLOAT:
+		UPLOAD_TYPED(GLfloat);
+	case GL_INT:
+		UPLOAD_TYPED(int32_t);
+	case GL_UNSIGNED_INT:
+		UPLOAD_TYPED(uint32_t);
+	case GL_UNSIGNED_BYTE:
+		UPLOAD_TYPED(uint8_t);
+	}
+
+	#undef UPLOAD_TYPED
+
+	return 0u;
+}
+
 sol::as_table_t<std::vector<lua_Number>> LuaVBOImpl::Download(sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> elemCountOpt, sol::optional<bool> forceGPUReadOpt)
 {
 	std::vector<lua_Number> dataVec;
@@ -814,9 +856,43 @@ size_t LuaVBOImpl::InstanceDataFromImpl(const sol::stack_table& ids, int attrID,
 }
 
 template<typename TIn>
-size_t LuaVBOImpl::UploadImpl(const std::vector<TIn>& dataVec, uint32_t elemOffset, int attribIdx)
+bool LuaVBOImpl::IsUploadMemcpyable(int attribIdx) const
 {
-	if (dataVec.empty())
+	// the write loop below packs attributes back to back, so the output is a
+	// byte-copy of the input whenever every written attribute has type TIn
+	if (attribIdx != -1 && bufferAttribDefsVec.size() != 1)
+		return false;
+
+	for (const auto& va : bufferAttribDefsVec) {
+		switch (va.second.type) {
+		case GL_UNSIGNED_BYTE: {
+			if (!std::is_same_v<TIn, uint8_t>) return false;
+		} break;
+		case GL_INT:
+		case GL_INT_VEC4: {
+			if (!std::is_same_v<TIn, int32_t>) return false;
+		} break;
+		case GL_UNSIGNED_INT:
+		case GL_UNSIGNED_INT_VEC4: {
+			if (!std::is_same_v<TIn, uint32_t>) return false;
+		} break;
+		case GL_FLOAT:
+		case GL_FLOAT_VEC4:
+		case GL_FLOAT_MAT4: {
+			if (!std::is_same_v<TIn, GLfloat>) return false;
+		} break;
+		default:
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<typename TIn>
+size_t LuaVBOImpl::UploadImpl(const TIn* dataBeg, const TIn* dataEnd, uint32_t elemOffset, int attribIdx)
+{
+	if (dataBeg == dataEnd)
 		return 0u;
 
 	const uint32_t bufferOffsetInBytes = elemOffset * elemSizeInBytes;
@@ -825,6 +901,25 @@ size_t LuaVBOImpl::UploadImpl(const std::vector<TIn>& dataVec, uint32_t elemOffs
 	auto buffDataWithOffset = static_cast<uint8_t*>(bufferData) + bufferOffsetInBytes;
 
 	const auto uploadToGPU = [this, buffDataWithOffset, bufferOffsetInBytes, mappedBufferSizeInBytes](int bytesWritten) -> int {
+		// stage through the stream arena and let the GPU do the copy, glBufferSubData
+		// into a buffer that is still in use makes some drivers stall or orphan it
+		auto& streamArena = StreamRingArena::GetInstance();
+
+		if (streamArena.IsAvailable()) {
+			const auto chunk = streamArena.Allocate(bytesWritten, 4, StreamRingArena::SRA_LUAVBO);
+
+			if (chunk.ptr != nullptr) {
+				memcpy(chunk.ptr, buffDataWithOffset, bytesWritten);
+
+				glBindBuffer(GL_COPY_READ_BUFFER, streamArena.GetID());
+				glBindBuffer(GL_COPY_WRITE_BUFFER, vbo->GetId());
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, chunk.byteOffset, bufferOffsetInBytes, bytesWritten);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+				glBindBuffer(GL_COPY_READ_BUFFER, 0);
+				return bytesWritten;
+			}
+		}
+
 		vbo->Bind();
 #if 1
 		vbo->SetBufferSubData(bufferOffsetInBytes, bytesWritten, buffDataWithOffset);
@@ -840,9 +935,21 @@ size_t LuaVBOImpl::UploadImpl(const std::vector<TIn>& dataVec, uint32_t elemOffs
 		return bytesWritten;
 	};
 
+	if (IsUploadMemcpyable<TIn>(attribIdx)) {
+		int bytesWritten = static_cast<int>((dataEnd - dataBeg) * sizeof(TIn));
+
+		if (bytesWritten > mappedBufferSizeInBytes) {
+			LOG_L(L_ERROR, "[LuaVBOImpl::%s] Upload array contains too much data", __func__);
+			bytesWritten = mappedBufferSizeInBytes;
+		}
+
+		memcpy(buffDataWithOffset, dataBeg, bytesWritten);
+		return uploadToGPU(bytesWritten);
+	}
+
 	int bytesWritten = 0;
 
-	for (auto bdvIter = dataVec.cbegin(); bdvIter < dataVec.cend();) {
+	for (auto bdvIter = dataBeg; bdvIter < dataEnd;) {
 		for (const auto& va : bufferAttribDefsVec) {
 			const int   attrID = va.first;
 			const auto& attrDef = va.second;
@@ -859,7 +966,7 @@ size_t LuaVBOImpl::UploadImpl(const std::vector<TIn>& dataVec, uint32_t elemOffs
 			bool copyData = attribIdx == -1 || attribIdx == attrID; // copy data if specific attribIdx is not requested or requested and matches attrID
 
 			#define TRANSFORM_AND_WRITE(T) { \
-				if (!TransformAndWrite<TIn, T>(bytesWritten, buffDataWithOffset, mappedBufferSizeInBytes, basicTypeSize, bdvIter, dataVec.cend(), copyData)) { \
+				if (!TransformAndWrite<TIn, T>(bytesWritten, buffDataWithOffset, mappedBufferSizeInBytes, basicTypeSize, bdvIter, dataEnd, copyData)) { \
 					return uploadToGPU(bytesWritten); \
 				} \
 			}
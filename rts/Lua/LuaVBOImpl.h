@@ -15,6 +15,7 @@
 
 class VBO;
 class LuaVAOImpl;
+class LuaTypedArray;
 
 class LuaVBOImpl {
 public:
@@ -30,6 +31,7 @@ public:
 	std::tuple<uint32_t, uint32_t, uint32_t> GetBufferSize();
 
 	size_t Upload(const sol::stack_table& luaTblData, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt);
+	size_t Upload(const LuaTypedArray& typedArray, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt);
 	sol::as_table_t<std::vector<lua_Number>> Download(sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> elemCountOpt, sol::optional<bool> forceGPUReadOpt);
 
 	size_t ModelsVBO();
@@ -76,8 +78,15 @@ private:
 	template<typename TObj>
 	size_t InstanceDataFromImpl(const sol::stack_table& ids, int attrID, uint8_t defTeamID, const sol::optional<int>& elemOffsetOpt);
 
+	void UploadCheckArgs(uint32_t dataSize, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt, const char* func, uint32_t& elemOffset, int& attribIdx, uint32_t& luaStartIndex, uint32_t& luaFinishIndex);
+
+	template<typename TIn>
+	size_t UploadImpl(const std::vector<TIn>& dataVec, uint32_t elemOffset, int attribIdx) { return UploadImpl<TIn>(dataVec.data(), dataVec.data() + dataVec.size(), elemOffset, attribIdx); }
+	template<typename TIn>
+	size_t UploadImpl(const TIn* dataBeg, const TIn* dataEnd, uint32_t elemOffset, int attribIdx);
+
 	template<typename TIn>
-	size_t UploadImpl(const std::vector<TIn>& dataVec, uint32_t elemOffset, int attribIdx);
+	bool IsUploadMemcpyable(int attribIdx) const;
 
 	template<typename T>
 	static T MaybeFunc(const sol::table& tbl, const std::string& key, T defValue);
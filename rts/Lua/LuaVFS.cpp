@@ -4,6 +4,7 @@
 #include <cmath>
 
 #include "LuaVFS.h"
+#include "LuaBytecodeCache.h"
 #include "LuaInclude.h"
 #include "LuaHandle.h"
 #include "LuaHashString.h"
@@ -157,7 +158,7 @@ int LuaVFS::Include(lua_State* L, bool synced)
  		lua_error(L);
 	}
 
-	if ((luaError = luaL_loadbuffer(L, fileData.c_str(), fileData.size(), fileName.c_str())) != 0) {
+	if ((luaError = LuaBytecodeCache::LoadBuffer(L, fileData.c_str(), fileData.size(), fileName.c_str())) != 0) {
 		char buf[1024];
 		SNPRINTF(buf, sizeof(buf), "[LuaVFS::%s(synced=%d)][loadbuf] file=%s error=%i (%s) cenv=%d", __func__, synced, fileName.c_str(), luaError, lua_tostring(L, -1), hasCustomEnv);
 		lua_pushstring(L, buf);
@@ -8,11 +8,16 @@
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/QuadField.h"
+#include "Sim/Misc/SmoothHeightMesh.h"
+#include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Features/FeatureHandler.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
 
 
 void CBasicMapDamage::Init()
@@ -214,27 +219,84 @@ void CBasicMapDamage::Explosion(const float3& pos, float strength, float radius)
 
 void CBasicMapDamage::RecalcArea(int x1, int x2, int y1, int y2)
 {
-	if (!readMap->GetHeightMapUpdated())
+	recalcRects.emplace_back(x1, y1, x2, y2);
+	RecalcQueuedAreas();
+}
+
+void CBasicMapDamage::QueueRecalcArea(int x1, int x2, int y1, int y2)
+{
+	recalcRects.emplace_back(x1, y1, x2, y2);
+}
+
+void CBasicMapDamage::RecalcQueuedAreas()
+{
+	if (recalcRects.empty())
+		return;
+
+	if (!readMap->GetHeightMapUpdated()) {
+		recalcRects.clear();
 		return;
+	}
 
-	x1 = std::max(x1, 0); x2 = std::clamp(x2, x1, mapDims.mapx);
-	y1 = std::max(y1, 0); y2 = std::clamp(y2, y1, mapDims.mapy);
+	for (SRectangle& r: recalcRects) {
+		r.x1 = std::max(r.x1, 0); r.x2 = std::clamp(r.x2, r.x1, mapDims.mapx);
+		r.z1 = std::max(r.z1, 0); r.z2 = std::clamp(r.z2, r.z1, mapDims.mapy);
+	}
 
 	// do not bother with zero-area updates
-	const SRectangle updRect(x1, y1, x2, y2);
-	if (updRect.GetArea() <= 0)
-		return;
+	recalcRects.erase(std::remove_if(recalcRects.begin(), recalcRects.end(), [](const SRectangle& r) { return (r.GetArea() <= 0); }), recalcRects.end());
+
+	// areas queued during the same frame (explosions expiring together, builders
+	// terraforming neighbouring squares, gadgets deforming in a loop) are merged
+	// so that e.g. an artillery barrage is recalculated once per impact zone
+	// instead of once per shell (only while the merged area does not exceed the sum)
+	for (size_t i = 0; i < recalcRects.size(); i++) {
+		for (size_t j = i + 1; j < recalcRects.size(); ) {
+			const SRectangle& a = recalcRects[i];
+			const SRectangle& b = recalcRects[j];
+			const SRectangle u = {std::min(a.x1, b.x1), std::min(a.z1, b.z1), std::max(a.x2, b.x2), std::max(a.z2, b.z2)};
+
+			if (u.GetArea() > (a.GetArea() + b.GetArea())) {
+				j++;
+				continue;
+			}
 
-	readMap->UpdateHeightMapSynced(updRect);
-	featureHandler.TerrainChanged(x1, y1, x2, y2);
-	{
-		SCOPED_TIMER("Sim::BasicMapDamage::Los");
-		losHandler->UpdateHeightMapSynced(updRect);
+			recalcRects[i] = u;
+			recalcRects[j] = recalcRects.back();
+			recalcRects.pop_back();
+
+			// the grown area may now also cover rectangles skipped before
+			j = i + 1;
+		}
+	}
+
+	// the heightmap stages write into the padded borders of their rectangles
+	// and features share the quadfield query pools, these stay sequential
+	for (const SRectangle& r: recalcRects) {
+		readMap->UpdateHeightMapSynced(r);
+		CMoveMath::UpdateSpeedModMaps(r);
+		featureHandler.TerrainChanged(r.x1, r.z1, r.x2, r.z2);
 	}
+
 	{
-		SCOPED_TIMER("Sim::BasicMapDamage::Path");
-		pathManager->TerrainChange(x1, y1, x2, y2, TERRAINCHANGE_DAMAGE_RECALCULATION);
+		SCOPED_TIMER("Sim::BasicMapDamage::LosPath");
+
+		// LOS, pathing and the smoothed mesh only read the (now final) heightmaps
+		// and keep their own state, so all consumers can process the whole batch
+		// at once
+		for_mt(0, 3, [&](const int jobId) {
+			for (const SRectangle& r: recalcRects) {
+				switch (jobId) {
+					case 0: { losHandler->UpdateHeightMapSynced(r); } break;
+					case 1: { pathManager->TerrainChange(r.x1, r.z1, r.x2, r.z2, TERRAINCHANGE_DAMAGE_RECALCULATION); } break;
+					case 2: { smoothGround.MapChanged(r.x1, r.z1, r.x2, r.z2); } break;
+					default: {} break;
+				}
+			}
+		});
 	}
+
+	recalcRects.clear();
 }
 
 
@@ -277,9 +339,11 @@ void CBasicMapDamage::Update()
 		if (e.ttl != 0)
 			continue;
 
-		RecalcArea(e.x1 - 1, e.x2 + 1, e.y1 - 1, e.y2 + 1);
+		recalcRects.emplace_back(e.x1 - 1, e.y1 - 1, e.x2 + 1, e.y2 + 1);
 	}
 
+	RecalcQueuedAreas();
+
 
 	// pop explosions that are no longer being processed
 	while (explUpdateQueueIdx < explosionUpdateQueue.size()) {
@@ -4,6 +4,7 @@
 #define _BASIC_MAP_DAMAGE_H
 
 #include "MapDamage.h"
+#include "System/Rectangle.h"
 
 #include <vector>
 
@@ -12,6 +13,8 @@ class CBasicMapDamage : public IMapDamage
 public:
 	void Explosion(const float3& pos, float strength, float radius) override;
 	void RecalcArea(int x1, int x2, int y1, int y2) override;
+	void QueueRecalcArea(int x1, int x2, int y1, int y2) override;
+	void RecalcQueuedAreas() override;
 	void TerrainTypeHardnessChanged(int ttIndex) override;
 	void TerrainTypeSpeedModChanged(int ttIndex) override;
 
@@ -60,6 +63,7 @@ private:
 
 	std::vector<float> explosionSquaresPool;
 	std::vector<Explo> explosionUpdateQueue;
+	std::vector<SRectangle> recalcRects;
 
 	static constexpr unsigned int CRATER_TABLE_SIZE = 200;
 	static constexpr unsigned int EXPLOSION_LIFETIME = 10;
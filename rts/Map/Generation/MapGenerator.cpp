@@ -1,35 +1,77 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "MapGenerator.h"
+#include "Game/GameVersion.h"
 #include "Map/SMF/SMFFormat.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GL/myGL.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/Archives/VirtualArchive.h"
 #include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
 #include "System/Exceptions.h"
+#include "System/Log/ILog.h"
 #include "System/StringUtil.h"
 #include "System/FileSystem/VFSHandler.h"
+#include "System/Sync/SHA512.hpp"
+#include "System/Threading/ThreadPool.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <cstring> // strcpy,memset
+#include <fstream>
 #include <sstream>
 
+CONFIG(bool, MapGeneratorCache).defaultValue(true).description("Keep the files of generated maps in the cache directory, so later games with the same generator seed and map options load them instead of generating the map again.");
+
+
+namespace {
+	// bump whenever the generator output changes
+	constexpr uint32_t CACHE_FILE_VERSION = 1;
+
+	// archive file and the extension of its cached copy; the SMF goes last
+	// so a complete .smf implies that the others were written before it
+	constexpr const char* ARCHIVE_FILES[][2] = {
+		{"maps/generated.smt", ".smt"},
+		{"mapinfo.lua"       , ".lua"},
+		{"maps/generated.smf", ".smf"},
+	};
+
+	const std::string& GetCacheDir()
+	{
+		// empty if the cache is disabled or could not be created
+		static const std::string cacheDir = configHandler->GetBool("MapGeneratorCache")?
+			dataDirsAccess.LocateDir(FileSystem::GetCacheDir() + "/mapgen/", FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS):
+			"";
+		return cacheDir;
+	}
+}
+
+
 void CMapGenerator::Generate()
 {
 	// create archive for map
 	CVirtualArchive* archive = virtualArchiveFactory->AddArchive(setup->mapName);
 
-	// create arrays that can be filled by top class
-	const int2 gridSize = GetGridSize();
+	const std::string cacheFileName = GetCacheFileName();
 
-	heightMap.resize((gridSize.x + 1) * (gridSize.y + 1));
-	metalMap.resize((gridSize.x + 1) * (gridSize.y + 1));
+	if (!LoadCached(archive, cacheFileName)) {
+		// create arrays that can be filled by top class
+		const int2 gridSize = GetGridSize();
 
-	// generate map and fill archive files
-	GenerateMap();
-	GenerateSMF(archive->GetFilePtr(archive->AddFile("maps/generated.smf")));
-	GenerateMapInfo(archive->GetFilePtr(archive->AddFile("mapinfo.lua")));
-	GenerateSMT(archive->GetFilePtr(archive->AddFile("maps/generated.smt")));
+		heightMap.resize((gridSize.x + 1) * (gridSize.y + 1));
+		metalMap.resize((gridSize.x + 1) * (gridSize.y + 1));
+
+		// generate map and fill archive files
+		GenerateMap();
+		GenerateSMF(archive->GetFilePtr(archive->AddFile(ARCHIVE_FILES[2][0])));
+		GenerateMapInfo(archive->GetFilePtr(archive->AddFile(ARCHIVE_FILES[1][0])));
+		GenerateSMT(archive->GetFilePtr(archive->AddFile(ARCHIVE_FILES[0][0])));
+		StoreCached(archive, cacheFileName);
+	}
 
 	// add archive to VFS
 	archiveScanner->ScanArchive(setup->mapName + "." + virtualArchiveFactory->GetDefaultExtension());
@@ -38,6 +80,120 @@ void CMapGenerator::Generate()
 	// archive->WriteToFile();
 }
 
+
+std::string CMapGenerator::GetCacheFileName() const
+{
+	if (GetCacheDir().empty())
+		return "";
+
+	// the output also depends on the mapinfo template and the engine build
+	static const std::string buildTag = SpringVersion::GetFull() + " " + std::to_string(CACHE_FILE_VERSION);
+
+	std::string luaTemplate;
+	CFileHandler fh("mapgenerator/mapinfo_template.lua", SPRING_VFS_PWD_ALL);
+
+	if (!fh.FileExists() || !fh.LoadStringData(luaTemplate))
+		return "";
+
+	std::vector<std::pair<std::string, std::string>> mapOpts(setup->GetMapOptionsCont().begin(), setup->GetMapOptionsCont().end());
+	std::sort(mapOpts.begin(), mapOpts.end());
+
+	std::string msg = buildTag + '\0' + setup->mapName + '\0' + std::to_string(setup->mapSeed) + '\0' + luaTemplate + '\0';
+
+	for (const auto& mapOpt: mapOpts) {
+		msg += mapOpt.first + '=' + mapOpt.second + '\0';
+	}
+
+	uint8_t hash[sha512::SHA_LEN];
+	char hex[8 * 2 + 1];
+
+	sha512::calc_digest(reinterpret_cast<const uint8_t*>(msg.data()), msg.size(), hash);
+
+	for (int i = 0; i < 8; i++) {
+		snprintf(&hex[i * 2], 3, "%02x", hash[i]);
+	}
+
+	return (GetCacheDir() + hex);
+}
+
+bool CMapGenerator::LoadCached(CVirtualArchive* archive, const std::string& cacheFileName)
+{
+	if (cacheFileName.empty())
+		return false;
+
+	std::vector<std::uint8_t> buffers[3];
+
+	for (size_t i = 0; i < 3; i++) {
+		std::ifstream file(cacheFileName + ARCHIVE_FILES[i][1], std::ios::in | std::ios::binary | std::ios::ate);
+
+		if (!file.is_open())
+			return false;
+
+		buffers[i].resize(file.tellg());
+		file.seekg(0);
+
+		if (buffers[i].empty() || !file.read(reinterpret_cast<char*>(buffers[i].data()), buffers[i].size()))
+			return false;
+	}
+
+	// sanity-check the SMF, the rest is validated by the map loader
+	SMFHeader smfHeader;
+
+	if (buffers[2].size() < sizeof(smfHeader))
+		return false;
+
+	std::memcpy(&smfHeader, buffers[2].data(), sizeof(smfHeader));
+
+	if (std::strcmp(smfHeader.magic, "spring map file") != 0 || smfHeader.mapx != GetGridSize().x || smfHeader.mapy != GetGridSize().y)
+		return false;
+
+	// same order as Generate
+	for (const size_t i: {2, 1, 0}) {
+		archive->GetFilePtr(archive->AddFile(ARCHIVE_FILES[i][0]))->buffer = std::move(buffers[i]);
+	}
+
+	LOG("[MapGen::%s] loaded \"%s\" from the cache", __func__, setup->mapName.c_str());
+	return true;
+}
+
+void CMapGenerator::StoreCached(CVirtualArchive* archive, const std::string& cacheFileName)
+{
+	if (cacheFileName.empty())
+		return;
+
+	const auto& nameIndex = archive->GetNameIndex();
+
+	for (const auto& archiveFile: ARCHIVE_FILES) {
+		const auto iter = nameIndex.find(archiveFile[0]);
+
+		if (iter == nameIndex.end())
+			return;
+
+		const std::vector<std::uint8_t>& buffer = archive->GetFilePtr(iter->second)->buffer;
+		const std::string fileName = cacheFileName + archiveFile[1];
+		const std::string tmpFileName = fileName + ".tmp";
+
+		{
+			// write to a temporary first, a crash must not leave a truncated file behind
+			std::ofstream file(tmpFileName, std::ios::out | std::ios::binary);
+
+			if (!file.is_open() || !file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size())) {
+				LOG_L(L_WARNING, "[MapGen::%s] could not write \"%s\"", __func__, tmpFileName.c_str());
+				file.close();
+				std::remove(tmpFileName.c_str());
+				return;
+			}
+		}
+
+		std::remove(fileName.c_str());
+
+		if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+			std::remove(tmpFileName.c_str());
+			return;
+		}
+	}
+}
+
 void CMapGenerator::AppendToBuffer(CVirtualFile* file, const void* data, int size)
 {
 	file->buffer.insert(file->buffer.end(), (std::uint8_t*)data, (std::uint8_t*)data + size);
@@ -123,9 +279,11 @@ void CMapGenerator::GenerateSMF(CVirtualFile* fileSMF)
 	const float heightMax = smfHeader.maxHeight;
 	const float heightMul = 65535.0f / (smfHeader.maxHeight - smfHeader.minHeight);
 
-	for (int x = 0; x < heightmapDimensions; x++) {
-		heightmapPtr[x] = int16_t(Clamp(heightMap[x], heightMin, heightMax) - heightMin) * heightMul;
-	}
+	for_mt(0, smfHeader.mapy + 1, [&](const int y) {
+		for (int x = y * (smfHeader.mapx + 1), xe = x + smfHeader.mapx + 1; x < xe; x++) {
+			heightmapPtr[x] = int16_t(Clamp(heightMap[x], heightMin, heightMax) - heightMin) * heightMul;
+		}
+	});
 
 	std::memset(typemapPtr.data(), 0, typemapSize);
 
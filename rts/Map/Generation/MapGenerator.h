@@ -26,6 +26,11 @@ protected:
 	virtual int2 GetGridSize() const { return int2(GetMapSize().x * CSMFReadMap::bigSquareSize, GetMapSize().y * CSMFReadMap::bigSquareSize); }
 
 private:
+	std::string GetCacheFileName() const;
+
+	bool LoadCached(CVirtualArchive* archive, const std::string& cacheFileName);
+	void StoreCached(CVirtualArchive* archive, const std::string& cacheFileName);
+
 	void GenerateSMF(CVirtualFile*);
 	void GenerateMapInfo(CVirtualFile*);
 	void GenerateSMT(CVirtualFile*);
@@ -4,6 +4,7 @@
 
 #include "SimpleMapGenerator.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 
 
 CSimpleMapGenerator::CSimpleMapGenerator(const CGameSetup* setup) : CMapGenerator(setup)
@@ -55,5 +56,11 @@ void CSimpleMapGenerator::GenerateMap()
 	mapDescription = "Simple Random Map";
 
 	std::vector<float>& map = GetHeightMap();
-	std::fill(map.begin(), map.end(), 50.0f);
+
+	const int2 gridSize = GetGridSize();
+
+	for_mt(0, gridSize.y + 1, [&](const int y) {
+		const auto rowBeg = map.begin() + y * (gridSize.x + 1);
+		std::fill(rowBeg, rowBeg + gridSize.x + 1, 50.0f);
+	});
 }
@@ -16,6 +16,14 @@ public:
 
 	virtual void Explosion(const float3& pos, float strength, float radius) = 0;
 	virtual void RecalcArea(int x1, int x2, int y1, int y2) = 0;
+	/**
+	 * Defers the heightmap-dependent updates (normals, slopes, LOS, pathing)
+	 * of a changed area until RecalcQueuedAreas, which merges all areas that
+	 * were queued since the previous call. Use for changes made during a sim
+	 * frame; RecalcArea updates immediately.
+	 */
+	virtual void QueueRecalcArea(int x1, int x2, int y1, int y2) { RecalcArea(x1, x2, y1, y2); }
+	virtual void RecalcQueuedAreas() {}
 	virtual void TerrainTypeHardnessChanged(int ttIndex) {}
 	virtual void TerrainTypeSpeedModChanged(int ttIndex) {}
 
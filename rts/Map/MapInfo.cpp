@@ -435,6 +435,8 @@ void CMapInfo::ReadPFSConstants()
 
 	qtpfsConsts.layersPerUpdate = qtpfsTable.GetInt("layersPerUpdate",  5);
 	qtpfsConsts.maxTeamSearches = qtpfsTable.GetInt("maxTeamSearches", 25);
+	qtpfsConsts.minFieldGroupSize = qtpfsTable.GetInt("minFieldGroupSize", 16);
+	qtpfsConsts.maxLayerUpdateSquares = qtpfsTable.GetInt("maxLayerUpdateSquares", 128 * 128);
 	qtpfsConsts.minNodeSizeX    = qtpfsTable.GetInt("minNodeSizeX",     8);
 	qtpfsConsts.minNodeSizeZ    = qtpfsTable.GetInt("minNodeSizeZ",     8);
 	qtpfsConsts.maxNodeDepth    = qtpfsTable.GetInt("maxNodeDepth",    16);
@@ -213,6 +213,8 @@ public:
 		struct qtpfs_constants_t {
 			unsigned int layersPerUpdate;
 			unsigned int maxTeamSearches;
+			unsigned int minFieldGroupSize;
+			unsigned int maxLayerUpdateSquares;
 			unsigned int minNodeSizeX;
 			unsigned int minNodeSizeZ;
 			unsigned int maxNodeDepth;
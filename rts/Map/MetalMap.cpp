@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "MetalMap.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "System/SpringMath.h"
 #include "System/EventHandler.h"
 
@@ -16,7 +17,12 @@ CR_REG_METADATA(CMetalMap,(
 
 	CR_IGNORED(texturePalette),
 	CR_MEMBER(distributionMap),
-	CR_MEMBER(extractionMap)
+	CR_MEMBER(extractionMap),
+
+	CR_IGNORED(extDirtyRects),
+	CR_IGNORED(extUpdateNum),
+	CR_IGNORED(numExtDirtyRects),
+	CR_IGNORED(extLostUpdateNum)
 ))
 
 
@@ -33,6 +39,10 @@ void CMetalMap::Init(const unsigned char* map, int _sizeX, int _sizeZ, float _me
 	extractionMap.clear();
 	extractionMap.resize(sizeX * sizeZ, 0.0f);
 	distributionMap.clear();
+
+	extUpdateNum += 1;
+	numExtDirtyRects = 0;
+	extLostUpdateNum = extUpdateNum;
 	distributionMap.resize(sizeX * sizeZ, 0);
 
 	if (map != nullptr) {
@@ -103,6 +113,7 @@ float CMetalMap::RequestExtraction(int x, int z, float toDepth)
 
 	extractionMap[(z * sizeX) + x] = toDepth;
 
+	MarkExtractionChanged(x, z);
 	return available;
 }
 
@@ -113,6 +124,8 @@ void CMetalMap::RemoveExtraction(int x, int z, float depth)
 	z = Clamp(z, 0, sizeZ - 1);
 
 	extractionMap[(z * sizeX) + x] -= depth;
+
+	MarkExtractionChanged(x, z);
 }
 
 
@@ -125,6 +138,55 @@ int CMetalMap::GetMetalExtraction(int x, int z) const
 }
 
 
+void CMetalMap::MarkExtractionChanged(int x, int z)
+{
+	if (numExtDirtyRects > 0) {
+		ExtractionDirtyRect& dirtyRect = extDirtyRects[(numExtDirtyRects - 1) % NUM_EXT_DIRTY_RECTS];
+
+		if (dirtyRect.frameNum == gs->frameNum) {
+			dirtyRect.rect.x1 = std::min(dirtyRect.rect.x1, x    );
+			dirtyRect.rect.z1 = std::min(dirtyRect.rect.z1, z    );
+			dirtyRect.rect.x2 = std::max(dirtyRect.rect.x2, x + 1);
+			dirtyRect.rect.z2 = std::max(dirtyRect.rect.z2, z + 1);
+			return;
+		}
+	}
+
+	extUpdateNum += 1;
+
+	ExtractionDirtyRect& dirtyRect = extDirtyRects[(numExtDirtyRects++) % NUM_EXT_DIRTY_RECTS];
+
+	if (numExtDirtyRects > NUM_EXT_DIRTY_RECTS)
+		extLostUpdateNum = dirtyRect.updateNum;
+
+	dirtyRect.rect = {x, z, x + 1, z + 1};
+	dirtyRect.updateNum = extUpdateNum;
+	dirtyRect.frameNum = gs->frameNum;
+}
+
+bool CMetalMap::GetExtractionDirtyRect(unsigned int sinceUpdateNum, SRectangle& rect) const
+{
+	if (sinceUpdateNum < extLostUpdateNum)
+		return false;
+
+	rect = {sizeX, sizeZ, 0, 0};
+
+	for (unsigned int i = 0, n = std::min(numExtDirtyRects, NUM_EXT_DIRTY_RECTS); i < n; i++) {
+		const ExtractionDirtyRect& dirtyRect = extDirtyRects[i];
+
+		if (dirtyRect.updateNum <= sinceUpdateNum)
+			continue;
+
+		rect.x1 = std::min(rect.x1, dirtyRect.rect.x1);
+		rect.z1 = std::min(rect.z1, dirtyRect.rect.z1);
+		rect.x2 = std::max(rect.x2, dirtyRect.rect.x2);
+		rect.z2 = std::max(rect.z2, dirtyRect.rect.z2);
+	}
+
+	return true;
+}
+
+
 #else
 
 
@@ -137,5 +199,8 @@ void CMetalMap::SetMetalAmount(int x, int z, float m) {}
 float CMetalMap::RequestExtraction(int x, int z, float toDepth) { return 0.0f; }
 void CMetalMap::RemoveExtraction(int x, int z, float depth) {}
 int CMetalMap::GetMetalExtraction(int x, int z) const { return 0; }
+
+void CMetalMap::MarkExtractionChanged(int x, int z) {}
+bool CMetalMap::GetExtractionDirtyRect(unsigned int sinceUpdateNum, SRectangle& rect) const { return false; }
 #endif
 
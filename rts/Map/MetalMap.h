@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "System/creg/creg_cond.h"
+#include "System/Rectangle.h"
 #include "Sim/Misc/GlobalConstants.h"
 
 // each metalmap square covers 2x2 normal squares
@@ -49,6 +50,11 @@ public:
 
 	int GetMetalExtraction(int x, int z) const;
 
+	/// incremented by each sim-frame which changes the extraction-map, see GetExtractionDirtyRect
+	unsigned int GetExtractionUpdateNum() const { return extUpdateNum; }
+	/// union of the extraction-map squares (x2 and z2 exclusive) changed after update <sinceUpdateNum>, false if that is no longer known
+	bool GetExtractionDirtyRect(unsigned int sinceUpdateNum, SRectangle& rect) const;
+
 	int GetSizeX() const { return sizeX; }
 	int GetSizeZ() const { return sizeZ; }
 
@@ -57,7 +63,20 @@ public:
 	const         float* GetExtractionMap  () const { return   extractionMap.data(); }
 
 private:
+	void MarkExtractionChanged(int x, int z);
+
+private:
+	static constexpr unsigned int NUM_EXT_DIRTY_RECTS = 16;
+
+	struct ExtractionDirtyRect {
+		SRectangle rect;
+		unsigned int updateNum = 0;
+		int frameNum = -1;
+	};
+
 	std::array<unsigned char, 256 * 3> texturePalette;
+	// all changes made by extractors in the same sim-frame are merged into one rect
+	std::array<ExtractionDirtyRect, NUM_EXT_DIRTY_RECTS> extDirtyRects;
 
 	std::vector<unsigned char> distributionMap;
 	std::vector<        float> extractionMap;
@@ -66,6 +85,12 @@ private:
 
 	int sizeX = 0;
 	int sizeZ = 0;
+
+	// start "lost" s.t. consumers asking since update 0 begin with the full map
+	unsigned int extUpdateNum = 1;
+	unsigned int numExtDirtyRects = 0;
+	// newest update whose changed area is not in extDirtyRects anymore
+	unsigned int extLostUpdateNum = 1;
 };
 
 extern CMetalMap metalMap;
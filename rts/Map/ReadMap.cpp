@@ -16,6 +16,7 @@
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
 #include "System/SpringMath.h"
+#include "System/SpringMem.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/FileSystem/ArchiveScanner.h"
 #include "System/FileSystem/FileHandler.h"
@@ -65,6 +66,10 @@ CR_REG_METADATA(CReadMap, (
 	CR_IGNORED(currHeightBounds),
 	CR_IGNORED(boundingRadius),
 	CR_IGNORED(mapChecksum),
+	CR_IGNORED(hmDirtyRects),
+	CR_IGNORED(hmUpdateNum),
+	CR_IGNORED(numHmDirtyRects),
+	CR_IGNORED(hmLostUpdateNum),
 
 	CR_IGNORED(heightMapSyncedPtr),
 	CR_IGNORED(heightMapUnsyncedPtr),
@@ -311,18 +316,24 @@ void CReadMap::Initialize()
 	}
 
 	originalHeightMap.clear();
+	spring::ReserveHugePages(originalHeightMap, mapDims.mapxp1 * mapDims.mapyp1);
 	originalHeightMap.resize(mapDims.mapxp1 * mapDims.mapyp1);
 	faceNormalsSynced.clear();
+	spring::ReserveHugePages(faceNormalsSynced, mapDims.mapx * mapDims.mapy * 2);
 	faceNormalsSynced.resize(mapDims.mapx * mapDims.mapy * 2);
 	faceNormalsUnsynced.clear();
+	spring::ReserveHugePages(faceNormalsUnsynced, mapDims.mapx * mapDims.mapy * 2);
 	faceNormalsUnsynced.resize(mapDims.mapx * mapDims.mapy * 2);
 	centerNormalsSynced.clear();
+	spring::ReserveHugePages(centerNormalsSynced, mapDims.mapx * mapDims.mapy);
 	centerNormalsSynced.resize(mapDims.mapx * mapDims.mapy);
 	centerNormalsUnsynced.clear();
+	spring::ReserveHugePages(centerNormalsUnsynced, mapDims.mapx * mapDims.mapy);
 	centerNormalsUnsynced.resize(mapDims.mapx * mapDims.mapy);
 	centerNormals2D.clear();
 	centerNormals2D.resize(mapDims.mapx * mapDims.mapy);
 	centerHeightMap.clear();
+	spring::ReserveHugePages(centerHeightMap, mapDims.mapx * mapDims.mapy);
 	centerHeightMap.resize(mapDims.mapx * mapDims.mapy);
 
 	mipPointerHeightMaps.fill(nullptr);
@@ -343,6 +354,7 @@ void CReadMap::Initialize()
 	typeMap.resize(mapDims.hmapx * mapDims.hmapy, 0);
 
 	visVertexNormals.clear();
+	spring::ReserveHugePages(visVertexNormals, mapDims.mapxp1 * mapDims.mapyp1);
 	visVertexNormals.resize(mapDims.mapxp1 * mapDims.mapyp1);
 
 	// note: if USE_UNSYNCED_HEIGHTMAP is false, then
@@ -482,6 +494,21 @@ void CReadMap::UpdateHeightMapSynced(const SRectangle& hgtMapRect, bool initiali
 	UpdateFaceNormals(centerRect, initialize);
 	UpdateSlopemap(centerRect, initialize); // must happen after UpdateFaceNormals()!
 
+	hmUpdateNum += 1;
+
+	if (initialize) {
+		numHmDirtyRects = 0;
+		hmLostUpdateNum = hmUpdateNum;
+	} else {
+		HeightMapDirtyRect& dirtyRect = hmDirtyRects[(numHmDirtyRects++) % NUM_HM_DIRTY_RECTS];
+
+		if (numHmDirtyRects > NUM_HM_DIRTY_RECTS)
+			hmLostUpdateNum = dirtyRect.updateNum;
+
+		dirtyRect.rect = {centerRect.x1, centerRect.z1, centerRect.x2 + 1, centerRect.z2 + 1};
+		dirtyRect.updateNum = hmUpdateNum;
+	}
+
 	#ifdef USE_UNSYNCED_HEIGHTMAP
 	// push the unsynced update; initial one without LOS check
 	if (initialize) {
@@ -512,6 +539,29 @@ void CReadMap::UpdateHeightMapSynced(const SRectangle& hgtMapRect, bool initiali
 }
 
 
+bool CReadMap::GetHeightMapDirtyRect(unsigned int sinceUpdateNum, SRectangle& rect) const
+{
+	if (sinceUpdateNum < hmLostUpdateNum)
+		return false;
+
+	rect = {mapDims.mapx, mapDims.mapy, 0, 0};
+
+	for (unsigned int i = 0, n = std::min(numHmDirtyRects, NUM_HM_DIRTY_RECTS); i < n; i++) {
+		const HeightMapDirtyRect& dirtyRect = hmDirtyRects[i];
+
+		if (dirtyRect.updateNum <= sinceUpdateNum)
+			continue;
+
+		rect.x1 = std::min(rect.x1, dirtyRect.rect.x1);
+		rect.z1 = std::min(rect.z1, dirtyRect.rect.z1);
+		rect.x2 = std::max(rect.x2, dirtyRect.rect.x2);
+		rect.z2 = std::max(rect.z2, dirtyRect.rect.z2);
+	}
+
+	return true;
+}
+
+
 void CReadMap::UpdateHeightBounds(int syncFrame)
 {
 	constexpr int PACING_PERIOD = GAME_SPEED; //tune if needed
@@ -716,25 +766,78 @@ void CReadMap::UpdateHeightBounds()
 	currHeightBounds.y = tempHeightBounds.y;
 }
 
+namespace {
+	using SIMDVfloat = xsimd::simd_type<float>;
+	using SIMDVint = xsimd::simd_type<std::int32_t>;
+
+	static_assert(SIMDVfloat::size == SIMDVint::size, "");
+
+	// lane-wise fastmath::isqrt2_nosse, same operations in the same order
+	inline SIMDVfloat ISqrt(SIMDVfloat x) {
+		const SIMDVfloat xh = SIMDVfloat(0.5f) * x;
+
+		x = xsimd::bitwise_cast<SIMDVfloat>(SIMDVint(0x5f375a86) - (xsimd::bitwise_cast<SIMDVint>(x) >> 1));
+		x = x * (SIMDVfloat(1.5f) - xh * (x * x));
+		x = x * (SIMDVfloat(1.5f) - xh * (x * x));
+		return x;
+	}
+
+	// lane-wise float3::SafeNormalize
+	inline void Normalize(SIMDVfloat& x, SIMDVfloat& y, SIMDVfloat& z) {
+		const SIMDVfloat sql = x * x + y * y + z * z;
+		const SIMDVfloat scl = xsimd::select(sql > SIMDVfloat(float3::nrm_eps()), ISqrt(sql), SIMDVfloat(1.0f));
+
+		x = x * scl;
+		y = y * scl;
+		z = z * scl;
+	}
+
+	// lane-wise float3::SafeNormalize2D, y*y is zero
+	inline void Normalize2D(SIMDVfloat& x, SIMDVfloat& z) {
+		const SIMDVfloat sql = x * x + z * z;
+		const SIMDVfloat scl = xsimd::select(sql > SIMDVfloat(float3::nrm_eps()), ISqrt(sql), SIMDVfloat(1.0f));
+
+		x = x * scl;
+		z = z * scl;
+	}
+}
+
+
+// NOTE:
+//   the SIMD kernels below perform exactly the operations (and in the same
+//   order) as the scalar code they replace, so their results are bitwise
+//   identical on every SSE machine; scaling by 1.0f in the masked lanes of
+//   Normalize is exact as well. No FMA, no reciprocal approximations.
 void CReadMap::UpdateCenterHeightmap(const SRectangle& rect, bool initialize)
 {
 	const float* heightmapSynced = GetCornerHeightMapSynced();
 
-	for (int y = rect.z1; y <= rect.z2; y++) {
-		for (int x = rect.x1; x <= rect.x2; x++) {
-			const int idxTL = (y    ) * mapDims.mapxp1 + x;
-			const int idxTR = (y    ) * mapDims.mapxp1 + x + 1;
-			const int idxBL = (y + 1) * mapDims.mapxp1 + x;
-			const int idxBR = (y + 1) * mapDims.mapxp1 + x + 1;
+	for_mt(rect.z1, rect.z2 + 1, [&](const int y) {
+		const float* rowT = &heightmapSynced[(y    ) * mapDims.mapxp1];
+		const float* rowB = &heightmapSynced[(y + 1) * mapDims.mapxp1];
+
+		float* dst = &centerHeightMap[y * mapDims.mapx];
+
+		int x = rect.x1;
+
+		for (; (x + int(SIMDVfloat::size) - 1) <= rect.x2; x += SIMDVfloat::size) {
+			const SIMDVfloat hTL = xsimd::load_unaligned(rowT + x    );
+			const SIMDVfloat hTR = xsimd::load_unaligned(rowT + x + 1);
+			const SIMDVfloat hBL = xsimd::load_unaligned(rowB + x    );
+			const SIMDVfloat hBR = xsimd::load_unaligned(rowB + x + 1);
 
+			xsimd::store_unaligned(dst + x, (hTL + hTR + hBL + hBR) * SIMDVfloat(0.25f));
+		}
+
+		for (; x <= rect.x2; x++) {
 			const float height =
-				heightmapSynced[idxTL] +
-				heightmapSynced[idxTR] +
-				heightmapSynced[idxBL] +
-				heightmapSynced[idxBR];
-			centerHeightMap[y * mapDims.mapx + x] = height * 0.25f;
+				rowT[x    ] +
+				rowT[x + 1] +
+				rowB[x    ] +
+				rowB[x + 1];
+			dst[x] = height * 0.25f;
 		}
-	}
+	});
 }
 
 
@@ -748,10 +851,11 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 		const int sy = (rect.z1 >> i) & (~1);
 		const int ey = (rect.z2 >> i);
 
-		float* topMipMap = mipPointerHeightMaps[i    ];
-		float* subMipMap = mipPointerHeightMaps[i + 1];
+		const float* topMipMap = mipPointerHeightMaps[i    ];
+		      float* subMipMap = mipPointerHeightMaps[i + 1];
 
-		for (int y = sy; y < ey; y += 2) {
+		// each level only depends on the previous one; within a level rows are independent
+		for_mt(sy, ey, 2, [&](const int y) {
 			for (int x = sx; x < ex; x += 2) {
 				const float height =
 					topMipMap[(x    ) + (y    ) * hmapx] +
@@ -760,7 +864,7 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 					topMipMap[(x + 1) + (y + 1) * hmapx];
 				subMipMap[(x / 2) + (y / 2) * hmapx / 2] = height * 0.25f;
 			}
-		}
+		});
 	}
 }
 
@@ -775,17 +879,48 @@ void CReadMap::UpdateFaceNormals(const SRectangle& rect, bool initialize)
 	const int x2 = std::min(mapDims.mapxm1, rect.x2 + 1);
 
 	for_mt(z1, z2+1, [&](const int y) {
-		float3 fnTL;
-		float3 fnBR;
+		const float* rowT = &heightmapSynced[(y    ) * mapDims.mapxp1];
+		const float* rowB = &heightmapSynced[(y + 1) * mapDims.mapxp1];
+
+		int x = x1;
+
+		// SIMDVfloat::size squares at a time; see the scalar loop for the math
+		for (; (x + int(SIMDVfloat::size) - 1) <= x2; x += SIMDVfloat::size) {
+			const SIMDVfloat hTL = xsimd::load_unaligned(rowT + x    );
+			const SIMDVfloat hTR = xsimd::load_unaligned(rowT + x + 1);
+			const SIMDVfloat hBL = xsimd::load_unaligned(rowB + x    );
+			const SIMDVfloat hBR = xsimd::load_unaligned(rowB + x + 1);
 
-		for (int x = x1; x <= x2; x++) {
-			const int idxTL = (y    ) * mapDims.mapxp1 + x; // TL
-			const int idxBL = (y + 1) * mapDims.mapxp1 + x; // BL
+			SIMDVfloat tlx = -(hTR - hTL), tly = SIMDVfloat(SQUARE_SIZE), tlz = -(hBL - hTL);
+			SIMDVfloat brx =  (hBL - hBR), bry = SIMDVfloat(SQUARE_SIZE), brz =  (hTR - hBR);
 
-			const float& hTL = heightmapSynced[idxTL    ];
-			const float& hTR = heightmapSynced[idxTL + 1];
-			const float& hBL = heightmapSynced[idxBL    ];
-			const float& hBR = heightmapSynced[idxBL + 1];
+			Normalize(tlx, tly, tlz);
+			Normalize(brx, bry, brz);
+
+			SIMDVfloat cnx = tlx + brx, cny = tly + bry, cnz = tlz + brz;
+			SIMDVfloat c2x = cnx,                        c2z = cnz;
+
+			Normalize(cnx, cny, cnz);
+			Normalize2D(c2x, c2z);
+
+			for (int i = 0; i < int(SIMDVfloat::size); i++) {
+				const int idx = y * mapDims.mapx + x + i;
+
+				faceNormalsSynced[idx * 2    ] = {tlx[i], tly[i], tlz[i]};
+				faceNormalsSynced[idx * 2 + 1] = {brx[i], bry[i], brz[i]};
+				centerNormalsSynced[idx] = {cnx[i], cny[i], cnz[i]};
+				centerNormals2D[idx] = {c2x[i], 0.0f, c2z[i]};
+			}
+		}
+
+		for (; x <= x2; x++) {
+			float3 fnTL;
+			float3 fnBR;
+
+			const float& hTL = rowT[x    ];
+			const float& hTR = rowT[x + 1];
+			const float& hBL = rowB[x    ];
+			const float& hBR = rowB[x + 1];
 
 			// normal of top-left triangle (face) in square
 			//
@@ -822,15 +957,17 @@ void CReadMap::UpdateFaceNormals(const SRectangle& rect, bool initialize)
 			// square-normal
 			centerNormalsSynced[y * mapDims.mapx + x] = (fnTL + fnBR).Normalize();
 			centerNormals2D[y * mapDims.mapx + x] = (fnTL + fnBR).Normalize2D();
+		}
 
-			#ifdef USE_UNSYNCED_HEIGHTMAP
-			if (initialize) {
+		#ifdef USE_UNSYNCED_HEIGHTMAP
+		if (initialize) {
+			for (x = x1; x <= x2; x++) {
 				faceNormalsUnsynced[(y * mapDims.mapx + x) * 2    ] = faceNormalsSynced[(y * mapDims.mapx + x) * 2    ];
 				faceNormalsUnsynced[(y * mapDims.mapx + x) * 2 + 1] = faceNormalsSynced[(y * mapDims.mapx + x) * 2 + 1];
 				centerNormalsUnsynced[y * mapDims.mapx + x] = centerNormalsSynced[y * mapDims.mapx + x];
 			}
-			#endif
 		}
+		#endif
 	});
 }
 
@@ -842,7 +979,8 @@ void CReadMap::UpdateSlopemap(const SRectangle& rect, bool initialize)
 	const int sy = std::max(0,                 (rect.z1 / 2) - 1);
 	const int ey = std::min(mapDims.hmapy - 1, (rect.z2 / 2) + 1);
 
-	for (int y = sy; y <= ey; y++) {
+	// eight strided loads per square do not vectorize well, but rows are independent
+	for_mt(sy, ey + 1, [&](const int y) {
 		for (int x = sx; x <= ex; x++) {
 			const int idx0 = (y*2    ) * (mapDims.mapx) + x*2;
 			const int idx1 = (y*2 + 1) * (mapDims.mapx) + x*2;
@@ -873,7 +1011,7 @@ void CReadMap::UpdateSlopemap(const SRectangle& rect, bool initialize)
 
 			slopeMap[y * mapDims.hmapx + x] = 1.0f - slope;
 		}
-	}
+	});
 }
 
 
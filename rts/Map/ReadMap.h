@@ -210,6 +210,11 @@ public:
 	void UpdateHeightBounds();
 
 	bool GetHeightMapUpdated() const { return hmUpdated; }
+
+	/// incremented by every UpdateHeightMapSynced, see GetHeightMapDirtyRect
+	unsigned int GetHeightMapUpdateNum() const { return hmUpdateNum; }
+	/// union of the center-heightmap squares (x2 and z2 exclusive) changed after update <sinceUpdateNum>, false if that is no longer known
+	bool GetHeightMapDirtyRect(unsigned int sinceUpdateNum, SRectangle& rect) const;
 private:
 	void InitHeightBounds();
 	void UpdateHeightBounds(int syncFrame);
@@ -226,6 +231,10 @@ public:
 	/// number of heightmap mipmaps, including full resolution
 	static constexpr int numHeightMipMaps = 7;
 
+	// number of past synced heightmap updates whose changed areas are remembered
+	// for incremental readers (AIs); older ones need a full read
+	static constexpr unsigned int NUM_HM_DIRTY_RECTS = 64;
+
 protected:
 	// these point to the actual heightmap data
 	// which is allocated by subclass instances
@@ -278,6 +287,18 @@ private:
 
 	unsigned int mapChecksum = 0;
 
+	struct HeightMapDirtyRect {
+		SRectangle rect;
+		unsigned int updateNum = 0;
+	};
+
+	std::array<HeightMapDirtyRect, NUM_HM_DIRTY_RECTS> hmDirtyRects;
+
+	unsigned int hmUpdateNum = 0;
+	unsigned int numHmDirtyRects = 0;
+	// newest update whose changed area is not in hmDirtyRects anymore
+	unsigned int hmLostUpdateNum = 0;
+
 	bool processingHeightBounds = false;
 	bool hmUpdated = false;
 
@@ -9,6 +9,7 @@
 #include "Map/SMF/SMFGroundDrawer.h"
 #include "Rendering/GlobalRendering.h"
 #include "System/EventHandler.h"
+#include "System/Threading/ThreadPool.h"
 
 #ifndef glPrimitiveRestartIndex
 #define glPrimitiveRestartIndex glPrimitiveRestartIndexNV
@@ -147,11 +148,31 @@ void CBasicMeshDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect) {
 	const float* heightMap = readMap->GetCornerHeightMapUnsynced();
 	const float3* normalMap = readMap->GetVisVertexNormalsUnsynced();
 
-	// TODO: update asynchronously, clip rect against patch bounds
+	const uint32_t numRectPatchesX = maxPatchX - minPatchX + 1;
+	const uint32_t numRectPatchesY = maxPatchY - minPatchY + 1;
+
+	// TODO: clip rect against patch bounds
+	// buffers are (re)allocated and mapped by this thread, only filling them is spread over the pool
 	for (uint32_t py = minPatchY; py <= maxPatchY; py += 1) {
 		for (uint32_t px = minPatchX; px <= maxPatchX; px += 1) {
 			for (uint32_t n = 0; n < lodLevels; n += 1) {
-				UploadPatchSquareGeometry(n, px, py, heightMap, normalMap);
+				MapPatchSquareGeometry(n, px, py);
+			}
+		}
+	}
+
+	for_mt(0, numRectPatchesX * numRectPatchesY * lodLevels, [&](const int i) {
+		const uint32_t n  = i % lodLevels;
+		const uint32_t px = minPatchX + (i / lodLevels) % numRectPatchesX;
+		const uint32_t py = minPatchY + (i / lodLevels) / numRectPatchesX;
+
+		FillPatchSquareGeometry(n, px, py, heightMap, normalMap);
+	});
+
+	for (uint32_t py = minPatchY; py <= maxPatchY; py += 1) {
+		for (uint32_t px = minPatchX; px <= maxPatchX; px += 1) {
+			for (uint32_t n = 0; n < lodLevels; n += 1) {
+				UnmapPatchSquareGeometry(n, px, py);
 			}
 			// need border data at all MIP's regardless of USE_MIPMAP_BUFFERS
 			for (uint32_t n = 0; n < LOD_LEVELS; n += 1) {
@@ -163,7 +184,7 @@ void CBasicMeshDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect) {
 
 
 
-void CBasicMeshDrawer::UploadPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm) {
+void CBasicMeshDrawer::MapPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py) {
 	MeshPatch& meshPatch = meshPatches[py * numPatchesX + px];
 
 	VBO& squareVertexBuffer = meshPatch.squareVertexBuffers[n];
@@ -176,14 +197,6 @@ void CBasicMeshDrawer::UploadPatchSquareGeometry(uint32_t n, uint32_t px, uint32
 	const uint32_t lodStep  = 1 << n;
 	const uint32_t lodVerts = (PATCH_SIZE / lodStep) + 1;
 
-	const uint32_t bpx = px * PATCH_SIZE;
-	const uint32_t bpy = py * PATCH_SIZE;
-
-	uint32_t vertexIndx = 0;
-	#if (USE_PACKED_BUFFERS == 0)
-	uint32_t normalIndx = 0;
-	#endif
-
 	{
 		#if (USE_MAPPED_BUFFERS == 1)
 		// HACK: the VBO constructor defaults to storage=false
@@ -193,16 +206,47 @@ void CBasicMeshDrawer::UploadPatchSquareGeometry(uint32_t n, uint32_t px, uint32
 		squareVertexBuffer.Bind(GL_ARRAY_BUFFER);
 		squareVertexBuffer.New((lodVerts * lodVerts) * sizeof(float3) * (USE_PACKED_BUFFERS + 1), GL_DYNAMIC_DRAW);
 
-		float3* verts = meshPatch.squareVertexPtrs[n];
-
-		if (verts == nullptr)
-			verts = reinterpret_cast<float3*>(squareVertexBuffer.MapBuffer(BUFFER_MAP_BITS));
+		// persistent mappings keep their pointer, others stay mapped until UnmapPatchSquareGeometry
+		if (meshPatch.squareVertexPtrs[n] == nullptr)
+			meshPatch.squareVertexPtrs[n] = reinterpret_cast<float3*>(squareVertexBuffer.MapBuffer(BUFFER_MAP_BITS));
 
+		assert(meshPatch.squareVertexPtrs[n] != nullptr);
+		squareVertexBuffer.Unbind();
+	}
+	#if (USE_PACKED_BUFFERS == 0)
+	{
 		#if (USE_MAPPED_BUFFERS == 1)
-		meshPatch.squareVertexPtrs[n] = verts;
+		squareNormalBuffer.immutableStorage = true;
 		#endif
 
-		assert(verts != nullptr);
+		squareNormalBuffer.Bind(GL_ARRAY_BUFFER);
+		squareNormalBuffer.New((lodVerts * lodVerts) * sizeof(float3), GL_DYNAMIC_DRAW);
+
+		if (meshPatch.squareNormalPtrs[n] == nullptr)
+			meshPatch.squareNormalPtrs[n] = reinterpret_cast<float3*>(squareNormalBuffer.MapBuffer(BUFFER_MAP_BITS));
+
+		assert(meshPatch.squareNormalPtrs[n] != nullptr);
+		squareNormalBuffer.Unbind();
+	}
+	#endif
+}
+
+void CBasicMeshDrawer::FillPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm) {
+	MeshPatch& meshPatch = meshPatches[py * numPatchesX + px];
+
+	const uint32_t lodStep  = 1 << n;
+	const uint32_t lodVerts = (PATCH_SIZE / lodStep) + 1;
+
+	const uint32_t bpx = px * PATCH_SIZE;
+	const uint32_t bpy = py * PATCH_SIZE;
+
+	uint32_t vertexIndx = 0;
+	#if (USE_PACKED_BUFFERS == 0)
+	uint32_t normalIndx = 0;
+	#endif
+
+	{
+		float3* verts = meshPatch.squareVertexPtrs[n];
 
 		for (uint32_t vy = 0; vy < lodVerts; vy += 1) {
 			for (uint32_t vx = 0; vx < lodVerts; vx += 1) {
@@ -218,32 +262,11 @@ void CBasicMeshDrawer::UploadPatchSquareGeometry(uint32_t n, uint32_t px, uint32
 				#endif
 			}
 		}
-
-		#if (USE_MAPPED_BUFFERS == 0)
-		squareVertexBuffer.UnmapBuffer();
-		#endif
-		squareVertexBuffer.Unbind();
 	}
 	#if (USE_PACKED_BUFFERS == 0)
 	{
-		#if (USE_MAPPED_BUFFERS == 1)
-		squareNormalBuffer.immutableStorage = true;
-		#endif
-
-		squareNormalBuffer.Bind(GL_ARRAY_BUFFER);
-		squareNormalBuffer.New((lodVerts * lodVerts) * sizeof(float3), GL_DYNAMIC_DRAW);
-
 		float3* nrmls = meshPatch.squareNormalPtrs[n];
 
-		if (nrmls == nullptr)
-			nrmls = reinterpret_cast<float3*>(squareNormalBuffer.MapBuffer(BUFFER_MAP_BITS));
-
-		#if (USE_MAPPED_BUFFERS == 1)
-		meshPatch.squareNormalPtrs[n] = nrmls;
-		#endif
-
-		assert(nrmls != nullptr);
-
 		for (uint32_t vy = 0; vy < lodVerts; vy += 1) {
 			for (uint32_t vx = 0; vx < lodVerts; vx += 1) {
 				const uint32_t lvx = vx * lodStep;
@@ -252,15 +275,34 @@ void CBasicMeshDrawer::UploadPatchSquareGeometry(uint32_t n, uint32_t px, uint32
 				nrmls[normalIndx++] = cnm[(bpy + lvy) * mapDims.mapxp1 + (bpx + lvx)];
 			}
 		}
-
-		#if (USE_MAPPED_BUFFERS == 0)
-		squareNormalBuffer.UnmapBuffer();
-		#endif
-		squareNormalBuffer.Unbind();
 	}
 	#endif
 }
 
+void CBasicMeshDrawer::UnmapPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py) {
+	#if (USE_MAPPED_BUFFERS == 0)
+	MeshPatch& meshPatch = meshPatches[py * numPatchesX + px];
+
+	VBO& squareVertexBuffer = meshPatch.squareVertexBuffers[n];
+
+	squareVertexBuffer.Bind(GL_ARRAY_BUFFER);
+	squareVertexBuffer.UnmapBuffer();
+	squareVertexBuffer.Unbind();
+
+	meshPatch.squareVertexPtrs[n] = nullptr;
+
+	#if (USE_PACKED_BUFFERS == 0)
+	VBO& squareNormalBuffer = meshPatch.squareNormalBuffers[n];
+
+	squareNormalBuffer.Bind(GL_ARRAY_BUFFER);
+	squareNormalBuffer.UnmapBuffer();
+	squareNormalBuffer.Unbind();
+
+	meshPatch.squareNormalPtrs[n] = nullptr;
+	#endif
+	#endif
+}
+
 void CBasicMeshDrawer::UploadPatchBorderGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm) {
 	MeshPatch& meshPatch = meshPatches[py * numPatchesX + px];
 
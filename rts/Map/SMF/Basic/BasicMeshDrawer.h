@@ -55,7 +55,9 @@ public:
 	void DrawBorderMesh(const DrawPass::e& drawPass) override;
 
 private:
-	void UploadPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm);
+	void MapPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py);
+	void FillPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm);
+	void UnmapPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py);
 	void UploadPatchBorderGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm);
 	void UploadPatchBorderNormals(VBO& nrmlBuffer, const float3& nrmlVector, uint32_t lodVerts);
 	void UploadPatchIndices(uint32_t n);
@@ -0,0 +1,394 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ClipMapMeshDrawer.h"
+#include "Game/Camera.h"
+#include "Game/CameraHandler.h"
+#include "Map/HeightMapTexture.h"
+#include "Map/ReadMap.h"
+#include "Map/SMF/SMFGroundDrawer.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/Shaders/Shader.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "System/SpringMath.h"
+#include "System/Log/ILog.h"
+
+
+
+typedef CClipMapMeshDrawer::MeshPatch MeshPatch;
+
+class ClipMapPatchVisTestDrawer: public CReadMap::IQuadDrawer {
+public:
+	void ResetState() override {}
+	void ResetState(CCamera* c, MeshPatch* p, uint32_t xsize) {
+		testCamera = c;
+		patchArray = p;
+		numPatches = xsize;
+	}
+
+	void DrawQuad(int px, int py) override {
+		patchArray[py * numPatches + px].visUpdateFrames[testCamera->GetCamType()] = globalRendering->drawFrame;
+	}
+
+private:
+	CCamera* testCamera;
+	MeshPatch* patchArray;
+
+	uint32_t numPatches;
+};
+
+static ClipMapPatchVisTestDrawer patchVisTestDrawer;
+
+
+
+bool CClipMapMeshDrawer::IsSupported()
+{
+	if (!globalRendering->haveGL4 || !GLEW_ARB_compute_shader || !GLEW_ARB_shader_storage_buffer_object)
+		return false;
+
+	return (heightMapTexture != nullptr && heightMapTexture->GetTextureID() != 0);
+}
+
+
+CClipMapMeshDrawer::CClipMapMeshDrawer(CSMFGroundDrawer* gd)
+	: smfGroundDrawer(gd)
+{
+	numPatchesX = mapDims.mapx / PATCH_SIZE;
+	numPatchesY = mapDims.mapy / PATCH_SIZE;
+
+	assert(numPatchesX >= 1);
+	assert(numPatchesY >= 1);
+
+	meshPatches.resize(numPatchesX * numPatchesY);
+	patchInfos.reserve(meshPatches.size() * 4);
+
+	for (uint32_t y = 0; y < numPatchesY; y += 1) {
+		for (uint32_t x = 0; x < numPatchesX; x += 1) {
+			MeshPatch& meshPatch = meshPatches[y * numPatchesX + x];
+
+			meshPatch.visUpdateFrames.fill(0);
+			meshPatch.borderOffsets.fill(0);
+
+			meshPatch.lod = LOD_LEVELS - 1;
+			meshPatch.vertexOffset = 0;
+			meshPatch.borderMask  = 0;
+			meshPatch.borderMask |= ((x ==                 0) << MAP_BORDER_L);
+			meshPatch.borderMask |= ((x == (numPatchesX - 1)) << MAP_BORDER_R);
+			meshPatch.borderMask |= ((y ==                 0) << MAP_BORDER_T);
+			meshPatch.borderMask |= ((y == (numPatchesY - 1)) << MAP_BORDER_B);
+		}
+	}
+
+	if (!CreateShader())
+		return;
+
+	indexBuffer = VBO{GL_ELEMENT_ARRAY_BUFFER, false};
+	vertexBuffer = VBO{GL_ARRAY_BUFFER, false};
+	patchesSSBO = VBO{GL_SHADER_STORAGE_BUFFER, false};
+
+	CreateIndexBuffer();
+}
+
+CClipMapMeshDrawer::~CClipMapMeshDrawer()
+{
+	shaderHandler->ReleaseProgramObjects("[ClipMapMeshDrawer]");
+	buildShader = nullptr;
+}
+
+
+bool CClipMapMeshDrawer::CreateShader()
+{
+	buildShader = shaderHandler->CreateProgramObject("[ClipMapMeshDrawer]", "SMFClipMapCompGL4", false);
+	buildShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/SMFClipMapCompGL4.glsl", "", GL_COMPUTE_SHADER));
+	buildShader->SetFlag("MESH_WORKGROUP_SIZE", MESH_WORKGROUP_SIZE);
+	buildShader->SetFlag("PATCHES_SSBO_BINDING_IDX", PATCHES_SSBO_BINDING_IDX);
+	buildShader->SetFlag("VERTICES_SSBO_BINDING_IDX", VERTICES_SSBO_BINDING_IDX);
+	buildShader->SetFlag("NUM_LOD_LEVELS", LOD_LEVELS);
+	buildShader->SetFlag("PATCH_SIZE", PATCH_SIZE);
+	buildShader->SetFlag("SQUARE_SIZE", SQUARE_SIZE);
+	buildShader->Link();
+	buildShader->Enable();
+	buildShader->SetUniform("heightMapTex", 0);
+	buildShader->SetUniform("borderHeight", std::min(readMap->GetInitMinHeight(), -500.0f));
+	buildShader->Disable();
+	buildShader->Validate();
+
+	if (buildShader->IsValid())
+		return true;
+
+	LOG_L(L_WARNING, "[ClipMapMeshDrawer::%s] mesh compute shader failed to compile", __func__);
+
+	shaderHandler->ReleaseProgramObjects("[ClipMapMeshDrawer]");
+	buildShader = nullptr;
+	return false;
+}
+
+void CClipMapMeshDrawer::CreateIndexBuffer()
+{
+	std::vector<uint16_t> indices;
+
+	// every LOD-level shares one index list, patches only differ by their base vertex
+	for (uint32_t n = 0; n < LOD_LEVELS; n += 1) {
+		const uint32_t lodQuads = (PATCH_SIZE >> n);
+		const uint32_t lodVerts = (PATCH_SIZE >> n) + 1;
+
+		lodSquareRanges[n].x = indices.size();
+
+		// A B
+		// C D
+		for (uint32_t vy = 0; vy < lodQuads; vy += 1) {
+			for (uint32_t vx = 0; vx < lodQuads; vx += 1) {
+				indices.push_back((vy * lodVerts) + (vx     + lodVerts)); // C
+				indices.push_back((vy * lodVerts) + (vx + 1           )); // B
+				indices.push_back((vy * lodVerts) + (vx               )); // A
+
+				indices.push_back((vy * lodVerts) + (vx     + lodVerts)); // C
+				indices.push_back((vy * lodVerts) + (vx + 1 + lodVerts)); // D
+				indices.push_back((vy * lodVerts) + (vx + 1           )); // B
+			}
+		}
+
+		lodSquareRanges[n].y = indices.size() - lodSquareRanges[n].x;
+		lodBorderRanges[n].x = indices.size();
+
+		// one strip between the upper and lower row of a border side
+		for (uint32_t vi = 0; vi < lodVerts; vi += 1) {
+			indices.push_back(vi           );
+			indices.push_back(vi + lodVerts);
+		}
+
+		lodBorderRanges[n].y = indices.size() - lodBorderRanges[n].x;
+	}
+
+	indexBuffer.Bind();
+	indexBuffer.New(indices, GL_STATIC_DRAW);
+	indexBuffer.Unbind();
+}
+
+
+float CClipMapMeshDrawer::GetLODDistance(const float2& pos) const
+{
+	// same as SMFClipMapCompGL4::GetLODDistance
+	return math::sqrt(Square(pos.x - lodCamPos.x) + Square(pos.y - lodCamPos.z) + lodCamHeightSq);
+}
+
+
+void CClipMapMeshDrawer::Update()
+{
+	CCamera* activeCam = CCameraHandler::GetActiveCamera();
+	MeshPatch* meshPatch = &meshPatches[0];
+
+	assert(activeCam->GetCamType() < CCamera::CAMTYPE_VISCUL);
+	patchVisTestDrawer.ResetState(activeCam, meshPatch, numPatchesX);
+
+	activeCam->CalcFrustumLines(readMap->GetCurrMinHeight() - 100.0f, readMap->GetCurrMaxHeight() + 100.0f, SQUARE_SIZE);
+	readMap->GridVisibility(activeCam, &patchVisTestDrawer, 1e9, PATCH_SIZE);
+}
+
+void CClipMapMeshDrawer::UpdateDraw()
+{
+	if (!IsValid())
+		return;
+
+	// all passes share the LOD-levels of the player camera, as ROAM does; this
+	// runs before CCamera::Update but the position is already current
+	const CCamera* playerCam = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
+
+	constexpr float PATCH_WORLD_SIZE = PATCH_SIZE * SQUARE_SIZE;
+	constexpr float PATCH_DIAGONAL = PATCH_WORLD_SIZE * math::SQRT2;
+
+	lodCamPos = playerCam->GetPos();
+	lodCamHeightSq = Square(std::max(lodCamPos.y - readMap->GetCurrMaxHeight(), 0.0f));
+	lodBaseDist = PATCH_DIAGONAL * std::max(MIN_LOD_DIST_SCALE, smfGroundDrawer->GetGroundDetail() / 24.0f);
+
+	uint32_t numVertices = 0;
+	uint32_t maxPatchVerts = 0;
+
+	patchInfos.clear();
+
+	for (uint32_t py = 0; py < numPatchesY; py += 1) {
+		for (uint32_t px = 0; px < numPatchesX; px += 1) {
+			MeshPatch& meshPatch = meshPatches[py * numPatchesX + px];
+
+			const float2 patchMin = {px * PATCH_WORLD_SIZE, py * PATCH_WORLD_SIZE};
+			const float2 patchPos = {
+				Clamp(lodCamPos.x, patchMin.x, patchMin.x + PATCH_WORLD_SIZE),
+				Clamp(lodCamPos.z, patchMin.y, patchMin.y + PATCH_WORLD_SIZE),
+			};
+
+			// the closest point decides, no vertex of the patch is nearer than this
+			const float patchDist = GetLODDistance(patchPos);
+
+			for (meshPatch.lod = 0; meshPatch.lod < (LOD_LEVELS - 1); meshPatch.lod += 1) {
+				if (patchDist < (lodBaseDist * (1 << meshPatch.lod)))
+					break;
+			}
+
+			const uint32_t lodVerts = (PATCH_SIZE >> meshPatch.lod) + 1;
+
+			uint32_t patchVerts = lodVerts * lodVerts;
+
+			for (uint32_t side = MAP_BORDER_L; side <= MAP_BORDER_B; side += 1) {
+				if ((meshPatch.borderMask & (1 << side)) == 0)
+					continue;
+
+				meshPatch.borderOffsets[side] = numVertices + patchVerts;
+				patchVerts += (lodVerts * 2);
+			}
+
+			meshPatch.vertexOffset = numVertices;
+
+			patchInfos.push_back(px * PATCH_SIZE);
+			patchInfos.push_back(py * PATCH_SIZE);
+			patchInfos.push_back(meshPatch.lod | (meshPatch.borderMask << 8));
+			patchInfos.push_back(meshPatch.vertexOffset);
+
+			numVertices += patchVerts;
+			maxPatchVerts = std::max(maxPatchVerts, patchVerts);
+		}
+	}
+
+	// {position, normal} per vertex; grows with some headroom since the total varies with the camera
+	const uint32_t numBytes = numVertices * sizeof(float3) * 2;
+
+	if (numBytes > vertexBuffer.GetSize()) {
+		vertexBuffer.Bind();
+		vertexBuffer.New(numBytes + numBytes / 4, GL_DYNAMIC_COPY);
+		vertexBuffer.Unbind();
+	}
+
+	patchesSSBO.Bind();
+	patchesSSBO.New(patchInfos, GL_STREAM_DRAW);
+	patchesSSBO.Unbind();
+
+	patchesSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, PATCHES_SSBO_BINDING_IDX, 0, patchesSSBO.GetSize());
+	vertexBuffer.BindBufferRange(GL_SHADER_STORAGE_BUFFER, VERTICES_SSBO_BINDING_IDX, 0, vertexBuffer.GetSize());
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, heightMapTexture->GetTextureID());
+
+	buildShader->Enable();
+	buildShader->SetUniform("lodParams", lodCamPos.x, lodCamPos.z, lodCamHeightSq, lodBaseDist);
+
+	glDispatchCompute((maxPatchVerts + MESH_WORKGROUP_SIZE - 1) / MESH_WORKGROUP_SIZE, meshPatches.size(), 1);
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+	buildShader->Disable();
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	vertexBuffer.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, VERTICES_SSBO_BINDING_IDX, 0, vertexBuffer.GetSize());
+	patchesSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, PATCHES_SSBO_BINDING_IDX, 0, patchesSSBO.GetSize());
+
+	lastBuildFrame = globalRendering->drawFrame;
+}
+
+
+void CClipMapMeshDrawer::DrawMesh(const DrawPass::e& drawPass)
+{
+	Update();
+
+	// nothing built yet, e.g. when switched to in the middle of a frame
+	if (lastBuildFrame == -1u)
+		return;
+
+	const CCamera* activeCam = CCameraHandler::GetActiveCamera();
+
+	vertexBuffer.Bind(GL_ARRAY_BUFFER);
+	indexBuffer.Bind(GL_ELEMENT_ARRAY_BUFFER);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(float3) * 2, nullptr);
+	glNormalPointer(GL_FLOAT, sizeof(float3) * 2, reinterpret_cast<const void*>(sizeof(float3)));
+
+	for (uint32_t py = 0; py < numPatchesY; py += 1) {
+		for (uint32_t px = 0; px < numPatchesX; px += 1) {
+			const MeshPatch& meshPatch = meshPatches[py * numPatchesX + px];
+			const int2& indexRange = lodSquareRanges[meshPatch.lod];
+
+			if (meshPatch.visUpdateFrames[activeCam->GetCamType()] < globalRendering->drawFrame)
+				continue;
+
+			if (drawPass != DrawPass::Shadow)
+				smfGroundDrawer->SetupBigSquare(px, py);
+
+			glDrawElementsBaseVertex(GL_TRIANGLES, indexRange.y, GL_UNSIGNED_SHORT, reinterpret_cast<const void*>(indexRange.x * sizeof(uint16_t)), meshPatch.vertexOffset);
+		}
+	}
+
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	indexBuffer.Unbind();
+	vertexBuffer.Unbind();
+}
+
+
+void CClipMapMeshDrawer::DrawBorderMeshPatch(const MeshPatch& meshPatch, const CCamera* activeCam, uint32_t borderSide) const
+{
+	if (meshPatch.visUpdateFrames[activeCam->GetCamType()] < globalRendering->drawFrame)
+		return;
+
+	const int2& indexRange = lodBorderRanges[meshPatch.lod];
+
+	glDrawElementsBaseVertex(GL_TRIANGLE_STRIP, indexRange.y, GL_UNSIGNED_SHORT, reinterpret_cast<const void*>(indexRange.x * sizeof(uint16_t)), meshPatch.borderOffsets[borderSide]);
+}
+
+void CClipMapMeshDrawer::DrawBorderMesh(const DrawPass::e& drawPass)
+{
+	if (lastBuildFrame == -1u)
+		return;
+
+	const CCamera* activeCam = CCameraHandler::GetActiveCamera();
+
+	vertexBuffer.Bind(GL_ARRAY_BUFFER);
+	indexBuffer.Bind(GL_ELEMENT_ARRAY_BUFFER);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(float3) * 2, nullptr);
+	glNormalPointer(GL_FLOAT, sizeof(float3) * 2, reinterpret_cast<const void*>(sizeof(float3)));
+
+	const uint32_t npxm1 = numPatchesX - 1;
+	const uint32_t npym1 = numPatchesY - 1;
+
+	// same strip layout and culling as CBasicMeshDrawer::DrawBorderMesh
+	{
+		glFrontFace(GL_CW);
+
+		for (uint32_t px = 0; px < numPatchesX; px++) {
+			if (drawPass != DrawPass::Shadow)
+				smfGroundDrawer->SetupBigSquare(px, 0);
+
+			DrawBorderMeshPatch(meshPatches[0 * numPatchesX + px], activeCam, MAP_BORDER_T);
+		}
+		for (uint32_t py = 0; py < numPatchesY; py++) {
+			if (drawPass != DrawPass::Shadow)
+				smfGroundDrawer->SetupBigSquare(npxm1, py);
+
+			DrawBorderMeshPatch(meshPatches[py * numPatchesX + npxm1], activeCam, MAP_BORDER_R);
+		}
+	}
+	{
+		glFrontFace(GL_CCW);
+
+		for (uint32_t px = 0; px < numPatchesX; px++) {
+			if (drawPass != DrawPass::Shadow)
+				smfGroundDrawer->SetupBigSquare(px, npym1);
+
+			DrawBorderMeshPatch(meshPatches[npym1 * numPatchesX + px], activeCam, MAP_BORDER_B);
+		}
+		for (uint32_t py = 0; py < numPatchesY; py++) {
+			if (drawPass != DrawPass::Shadow)
+				smfGroundDrawer->SetupBigSquare(0, py);
+
+			DrawBorderMeshPatch(meshPatches[py * numPatchesX + 0], activeCam, MAP_BORDER_L);
+		}
+	}
+
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	indexBuffer.Unbind();
+	vertexBuffer.Unbind();
+}
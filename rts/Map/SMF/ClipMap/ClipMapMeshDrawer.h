@@ -0,0 +1,113 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _CLIPMAP_MESH_DRAWER_H_
+#define _CLIPMAP_MESH_DRAWER_H_
+
+#include <array>
+#include <vector>
+
+#include "Game/Camera.h"
+#include "Map/SMF/IMeshDrawer.h"
+#include "Rendering/GL/VBO.h"
+#include "System/type2.h"
+
+class CSMFGroundDrawer;
+
+namespace Shader {
+	struct IProgramObject;
+}
+
+/**
+ * Map mesh drawer whose geometry is built entirely on the GPU: every patch
+ * picks a LOD-level from its distance to the player camera (rings of
+ * doubling size, like a geometry clipmap) and a compute pass samples the
+ * heightmap texture into one shared vertex buffer. Vertices morph toward the
+ * next coarser grid as they approach a ring boundary, which keeps adjacent
+ * patches crack-free. Heightmap changes only cost the texture sub-update done
+ * by HeightMapTexture, and the vertices stay in gl_Vertex so every ground and
+ * shadow shader (including Lua ones) can draw them unchanged.
+ */
+class CClipMapMeshDrawer : public IMeshDrawer
+{
+public:
+	static constexpr int32_t PATCH_SIZE = 128; // must match SMFReadMap::bigSquareSize
+	static constexpr int32_t LOD_LEVELS =   8; // log2(PATCH_SIZE) + 1; 129x129 to 2x2
+
+	// fraction of a LOD-level's distance at which vertices start and finish morphing; as in SMFClipMapCompGL4
+	static constexpr float MORPH_START = 0.75f;
+	static constexpr float MORPH_END   = 0.95f;
+	// minimum first LOD-distance in patch diagonals; morphing is crack-free only above 2
+	static constexpr float MIN_LOD_DIST_SCALE = 2.5f;
+
+	static constexpr uint32_t MESH_WORKGROUP_SIZE = 64;
+	static constexpr uint32_t PATCHES_SSBO_BINDING_IDX  = 2;
+	static constexpr uint32_t VERTICES_SSBO_BINDING_IDX = 3;
+
+	enum {
+		MAP_BORDER_L = 0,
+		MAP_BORDER_R = 1,
+		MAP_BORDER_T = 2,
+		MAP_BORDER_B = 3,
+	};
+
+	struct MeshPatch {
+		std::array<uint32_t, CCamera::CAMTYPE_VISCUL> visUpdateFrames;
+
+		uint32_t lod;
+		uint32_t borderMask;
+		uint32_t vertexOffset;
+		// vertexOffset of each side's strip, valid for the bits set in borderMask
+		std::array<uint32_t, MAP_BORDER_B + 1> borderOffsets;
+	};
+
+public:
+	static bool IsSupported();
+
+	CClipMapMeshDrawer(CSMFGroundDrawer* gd);
+	~CClipMapMeshDrawer();
+
+	bool IsValid() const { return (buildShader != nullptr); }
+
+	void Update() override;
+	void UpdateDraw() override;
+
+	void DrawMesh(const DrawPass::e& drawPass) override;
+	void DrawBorderMesh(const DrawPass::e& drawPass) override;
+
+private:
+	bool CreateShader();
+	void CreateIndexBuffer();
+
+	float GetLODDistance(const float2& pos) const;
+
+	void DrawBorderMeshPatch(const MeshPatch& meshPatch, const CCamera* activeCam, uint32_t borderSide) const;
+
+private:
+	uint32_t numPatchesX = 0;
+	uint32_t numPatchesY = 0;
+
+	// frame of the last UpdateDraw that built the vertices, -1 := none yet
+	uint32_t lastBuildFrame = -1u;
+
+	float3 lodCamPos;
+	float lodCamHeightSq = 0.0f;
+	float lodBaseDist = 0.0f;
+
+	std::vector<MeshPatch> meshPatches;
+	// GPU copy of the patch LOD-state, see SMFClipMapCompGL4
+	std::vector<uint32_t> patchInfos;
+
+	// {first index, index count} per LOD-level within indexBuffer
+	std::array<int2, LOD_LEVELS> lodSquareRanges;
+	std::array<int2, LOD_LEVELS> lodBorderRanges;
+
+	VBO indexBuffer;
+	VBO vertexBuffer;
+	VBO patchesSSBO;
+
+	Shader::IProgramObject* buildShader = nullptr;
+
+	CSMFGroundDrawer* smfGroundDrawer;
+};
+
+#endif // _CLIPMAP_MESH_DRAWER_H_
@@ -19,6 +19,8 @@ public:
 	virtual ~IMeshDrawer() {}
 
 	virtual void Update() = 0;
+	// once per draw-frame right after CReadMap::UpdateDraw, for work that does not depend on the draw-pass
+	virtual void UpdateDraw() {}
 	virtual void DrawMesh(const DrawPass::e& drawPass) = 0;
 	virtual void DrawBorderMesh(const DrawPass::e& drawPass) = 0;
 };
@@ -16,11 +16,13 @@
 #include "Map/ReadMap.h"
 #include "Map/SMF/SMFGroundDrawer.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/StreamBuffer.h"
 #include "Rendering/GL/VertexArray.h"
 #include "System/Log/ILog.h"
 #include "System/Threading/ThreadPool.h"
 
 #include <climits>
+#include <cstring>
 
 
 TriTreeNode TriTreeNode::dummyNode;
@@ -125,6 +127,7 @@ Patch::~Patch()
 	triList = 0;
 	vertexBuffer = 0;
 	vertexIndexBuffer = 0;
+	vertexIndexBufferSize = 0;
 }
 
 void Patch::Init(CSMFGroundDrawer* _drawer, int patchX, int patchZ)
@@ -205,8 +208,11 @@ void Patch::UpdateHeightMap(const SRectangle& rect)
 	}
 
 	midPos.y = averageHeight/((PATCH_SIZE+1)*(PATCH_SIZE+1));
-	VBOUploadVertices();
+
+	// no GL here, can run on any thread; the VBO is refreshed by the next Upload or Draw
+	vboVerticesUploaded = false;
 	isDirty = true;
+	varianceDirty = true;
 }
 
 
@@ -500,8 +506,8 @@ void Patch::ComputeVariance()
 		RecursComputeVariance(left, rght, apex, hgts, 1, 1);
 	}
 
-	// Clear the dirty flag for this patch
-	isDirty = false;
+	// isDirty is cleared by the mesh drawer once the patch is queued for retessellation
+	varianceDirty = false;
 }
 
 
@@ -571,6 +577,9 @@ void Patch::Draw()
 		} break;
 
 		case VBO: {
+			if (!vboVerticesUploaded)
+				VBOUploadVertices();
+
 			// enable VBOs
 			glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer); // coors
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vertexIndexBuffer); // indices
@@ -703,9 +712,7 @@ void Patch::Upload()
 			if (!vboVerticesUploaded)
 				VBOUploadVertices();
 
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vertexIndexBuffer);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), &indices[0], GL_DYNAMIC_DRAW);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+			VBOUploadIndices();
 		} break;
 
 		default: {
@@ -714,6 +721,40 @@ void Patch::Upload()
 	isChanged = false;
 }
 
+void Patch::VBOUploadIndices()
+{
+	const uint32_t byteSize = indices.size() * sizeof(unsigned);
+
+	auto& streamArena = StreamRingArena::GetInstance();
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vertexIndexBuffer);
+
+	// stage in the persistently mapped arena and copy on the GPU, which neither
+	// reallocates the index buffer nor waits for draws still reading from it
+	if (byteSize > 0 && streamArena.IsAvailable()) {
+		const auto chunk = streamArena.Allocate(byteSize, sizeof(unsigned), StreamRingArena::SRA_ROAMMESH);
+
+		if (chunk.ptr != nullptr) {
+			std::memcpy(chunk.ptr, indices.data(), byteSize);
+
+			// leave some headroom, retessellations mostly add triangles
+			if (byteSize > vertexIndexBufferSize)
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, vertexIndexBufferSize = byteSize + byteSize / 4, nullptr, GL_DYNAMIC_DRAW);
+
+			glBindBuffer(GL_COPY_READ_BUFFER, streamArena.GetID());
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ELEMENT_ARRAY_BUFFER, chunk.byteOffset, 0, byteSize);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+			return;
+		}
+	}
+
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, byteSize, indices.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	vertexIndexBufferSize = byteSize;
+}
+
 void Patch::SetSquareTexture() const
 {
 	smfGroundDrawer->SetupBigSquare(coors.x / PATCH_SIZE, coors.y / PATCH_SIZE);
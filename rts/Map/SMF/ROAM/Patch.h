@@ -115,6 +115,7 @@ public:
 
 	bool IsVisible(const CCamera*) const;
 	char IsDirty() const { return isDirty; }
+	bool IsVarianceDirty() const { return varianceDirty; }
 	int GetTriCount() const { return (indices.size() / 3); }
 
 	void UpdateHeightMap(const SRectangle& rect = SRectangle(0, 0, PATCH_SIZE, PATCH_SIZE));
@@ -145,6 +146,7 @@ public:
 
 protected:
 	void VBOUploadVertices();
+	void VBOUploadIndices();
 
 private:
 	// recursive functions
@@ -182,8 +184,10 @@ private:
 	// pool used during Tessellate; each invoked Split allocates from this
 	CTriNodePool* curTriPool = nullptr;
 	float3 midPos;
-	// does the variance-tree need to be recalculated for this Patch?
+	// did the heightmap change since this Patch was last tessellated?
 	bool isDirty = true;
+	// does the variance-tree need to be recalculated for this Patch?
+	bool varianceDirty = true;
 	bool vboVerticesUploaded = false;
 	// Did the tesselation tree change from what we have stored in the VBO?
 	bool isChanged = false;
@@ -214,6 +218,9 @@ private:
 	GLuint triList = 0;
 	GLuint vertexBuffer = 0;
 	GLuint vertexIndexBuffer = 0;
+
+	// allocated size of vertexIndexBuffer, only grows while streaming
+	uint32_t vertexIndexBufferSize = 0;
 };
 
 #endif
@@ -265,9 +265,13 @@ void CRoamMeshDrawer::Update()
 			// second case, a patch entered visibility:
 			if (isVisibleNow) {
 				numPatchesVisible++;
-				// if it was dirty(had heightmap change) then recompute variances.
+				// if it was dirty(had heightmap change) then recompute variances;
+				// usually already done in parallel by UpdateDraw
 				if (p.IsDirty()) {
-					p.ComputeVariance();
+					if (p.IsVarianceDirty())
+						p.ComputeVariance();
+
+					p.isDirty = false;
 					// here we can do incremental retesselation?
 					patchesToTesselate[i] = true;
 				}
@@ -389,32 +393,25 @@ void CRoamMeshDrawer::Update()
 
 	{
 		//SCOPED_TIMER("ROAM::GenerateIndexArray");
-		//only do for_mt if a full tesselation happened, since only a few patches come into visibility
-		if (forceNextTesselation[shadowPass]) {
-			for_mt(0, numPatches, [&patches, &cam](const int i) {
-				Patch* p = &patches[i];
-				if (!p->IsVisible(cam))
-					return;
-
-				p->GenerateIndices();
-			});
-		} else {
-			for (Patch& p: patches) {
-				if (!p.IsVisible(cam) || !p.isChanged)
-					continue;
+		changedPatches.clear();
 
-				p.GenerateIndices();
-			}
+		for (Patch& p: patches) {
+			if (!p.IsVisible(cam) || !p.isChanged)
+				continue;
+
+			changedPatches.push_back(&p);
 		}
+
+		// patch-local once tessellation is done, even a few patches coming into view are worth spreading out
+		for_mt(0, changedPatches.size(), [&](const int i) {
+			changedPatches[i]->GenerateIndices();
+		});
 	}
 	{
 		//SCOPED_TIMER("ROAM::Upload");
 
-		for (Patch& p: patches) {
-			if (!p.IsVisible(cam) || !p.isChanged)
-				continue;
-
-			p.Upload();
+		for (Patch* p: changedPatches) {
+			p->Upload();
 			actualUploads++;
 		}
 	}
@@ -444,6 +441,29 @@ void CRoamMeshDrawer::Update()
 }
 
 
+void CRoamMeshDrawer::UpdateDraw()
+{
+	//SCOPED_TIMER("ROAM::UpdateDraw");
+	dirtyPatches.clear();
+
+	// heightmap changes were just applied by CReadMap::UpdateDraw; compute the
+	// variance-trees of every patch that changed here in parallel rather than
+	// one by one inside the draw-passes
+	for (auto& patches: patchMeshGrid) {
+		for (Patch& p: patches) {
+			if (!p.IsVarianceDirty())
+				continue;
+
+			dirtyPatches.push_back(&p);
+		}
+	}
+
+	for_mt(0, dirtyPatches.size(), [&](const int i) {
+		dirtyPatches[i]->ComputeVariance();
+	});
+}
+
+
 void CRoamMeshDrawer::DrawMesh(const DrawPass::e& drawPass)
 {
 	// NOTE:
@@ -590,26 +610,34 @@ void CRoamMeshDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect)
 	const int zstart = std::max(          0, (int)math::floor((rect.z1 - BORDER_MARGIN) * INV_PATCH_SIZE));
 	const int zend   = std::min(numPatchesY, (int)math::ceil ((rect.z2 + BORDER_MARGIN) * INV_PATCH_SIZE));
 
+	dirtyPatches.clear();
+
 	// update patches in both tessellations
 	for (unsigned int i = MESH_NORMAL; i <= MESH_SHADOW; i++) {
 		auto& patches = patchMeshGrid[i];
 
 		for (int z = zstart; z < zend; ++z) {
 			for (int x = xstart; x < xend; ++x) {
-				Patch& p = patches[z * numPatchesX + x];
-
-				// clamp the update-rectangle within the patch
-				SRectangle prect(
-					std::max(rect.x1 - BORDER_MARGIN - p.coors.x,          0),
-					std::max(rect.z1 - BORDER_MARGIN - p.coors.y,          0),
-					std::min(rect.x2 + BORDER_MARGIN - p.coors.x, PATCH_SIZE),
-					std::min(rect.z2 + BORDER_MARGIN - p.coors.y, PATCH_SIZE)
-				);
-
-				p.UpdateHeightMap(prect);
+				dirtyPatches.push_back(&patches[z * numPatchesX + x]);
 			}
 		}
 	}
+
+	// UpdateHeightMap only touches patch-local data, vertex uploads are deferred to the draw-thread
+	for_mt(0, dirtyPatches.size(), [&](const int i) {
+		Patch& p = *dirtyPatches[i];
+
+		// clamp the update-rectangle within the patch
+		SRectangle prect(
+			std::max(rect.x1 - BORDER_MARGIN - p.coors.x,          0),
+			std::max(rect.z1 - BORDER_MARGIN - p.coors.y,          0),
+			std::min(rect.x2 + BORDER_MARGIN - p.coors.x, PATCH_SIZE),
+			std::min(rect.z2 + BORDER_MARGIN - p.coors.y, PATCH_SIZE)
+		);
+
+		p.UpdateHeightMap(prect);
+	});
+
 	heightMapChanged = true;
 }
 
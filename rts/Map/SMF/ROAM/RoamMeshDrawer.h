@@ -49,6 +49,7 @@ public:
 	~CRoamMeshDrawer();
 
 	void Update();
+	void UpdateDraw();
 
 	void DrawMesh(const DrawPass::e& drawPass);
 	void DrawBorderMesh(const DrawPass::e& drawPass);
@@ -85,6 +86,10 @@ private:
 	// char instead of bool, accessors to different elements must be thread-safe
 	std::vector<uint8_t> patchVisFlags[MESH_COUNT];
 
+	// scratch lists for the parallel parts of Update and UnsyncedHeightMapUpdate
+	std::vector<Patch*> changedPatches;
+	std::vector<Patch*> dirtyPatches;
+
 	// whether tessellation should be forcibly performed next frame
 	static bool forceNextTesselation[MESH_COUNT];
 
@@ -8,6 +8,7 @@
 #include "Map/MapInfo.h"
 #include "Map/ReadMap.h"
 #include "Map/SMF/Basic/BasicMeshDrawer.h"
+#include "Map/SMF/ClipMap/ClipMapMeshDrawer.h"
 #include "Map/SMF/Legacy/LegacyMeshDrawer.h"
 #include "Map/SMF/ROAM/RoamMeshDrawer.h"
 #include "Rendering/GlobalRendering.h"
@@ -148,6 +149,21 @@ IMeshDrawer* CSMFGroundDrawer::SwitchMeshDrawer(int wantedMode)
 
 	spring::SafeDelete(meshDrawer);
 
+	if (wantedMode == SMF_MESHDRAWER_CLIPMAP) {
+		CClipMapMeshDrawer* clipMapDrawer = CClipMapMeshDrawer::IsSupported()? new CClipMapMeshDrawer(this): nullptr;
+
+		if (clipMapDrawer != nullptr && clipMapDrawer->IsValid()) {
+			LOG("Switching to ClipMap Mesh Rendering");
+			drawerMode = wantedMode;
+			return (meshDrawer = clipMapDrawer);
+		}
+
+		LOG_L(L_WARNING, "[SMFGroundDrawer::%s] ClipMap mesh rendering requires compute shaders, using Basic", __func__);
+		spring::SafeDelete(clipMapDrawer);
+
+		wantedMode = SMF_MESHDRAWER_BASIC;
+	}
+
 	switch ((drawerMode = wantedMode)) {
 		case SMF_MESHDRAWER_LEGACY: {
 			LOG("Switching to Legacy Mesh Rendering");
@@ -515,6 +531,7 @@ void CSMFGroundDrawer::Update()
 	groundTextures->DrawUpdate();
 	// done by DrawMesh; needs to know the actual draw-pass
 	// meshDrawer->Update();
+	meshDrawer->UpdateDraw();
 
 	if (drawDeferred) {
 		drawDeferred &= UpdateGeometryBuffer(false);
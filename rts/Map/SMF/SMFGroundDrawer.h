@@ -14,10 +14,11 @@ class IMeshDrawer;
 struct ISMFRenderState;
 
 enum {
-	SMF_MESHDRAWER_LEGACY = 0,
-	SMF_MESHDRAWER_BASIC  = 1,
-	SMF_MESHDRAWER_ROAM   = 2,
-	SMF_MESHDRAWER_LAST   = 3,
+	SMF_MESHDRAWER_LEGACY  = 0,
+	SMF_MESHDRAWER_BASIC   = 1,
+	SMF_MESHDRAWER_ROAM    = 2,
+	SMF_MESHDRAWER_CLIPMAP = 3,
+	SMF_MESHDRAWER_LAST    = 4,
 };
 
 
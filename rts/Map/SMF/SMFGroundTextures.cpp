@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstdio>
@@ -23,10 +24,12 @@
 #include "Game/LoadScreen.h"
 #include "System/Exceptions.h"
 #include "System/FastMath.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/MappedFile.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Threading/ThreadPool.h" // for_mt
 
@@ -41,12 +44,18 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_SMF_GROUND_TEXTURES)
 #endif
 #define LOG_SECTION_CURRENT LOG_SECTION_SMF_GROUND_TEXTURES
 
+CONFIG(int, SMFTexStreamingBudget).defaultValue(8).minimumValue(0).description("Maximum number of SMF ground texture squares uploaded per frame. Squares gain detail one mip-level per upload, the most blurry and nearest ones first. 0 means unlimited.");
+
 
 
 std::vector<CSMFGroundTextures::GroundSquare> CSMFGroundTextures::squares;
 
 std::vector<int> CSMFGroundTextures::tileMap;
-std::vector<char> CSMFGroundTextures::tiles;
+std::vector<CSMFGroundTextures::TileFile> CSMFGroundTextures::tileFiles;
+std::vector<const std::uint8_t*> CSMFGroundTextures::tiles;
+
+// stands in for tiles the tile-files come up short of
+static const std::uint8_t BLACK_TILE[SMALL_TILE_SIZE] = {0};
 
 std::vector<float> CSMFGroundTextures::heightMaxima;
 std::vector<float> CSMFGroundTextures::heightMinima;
@@ -66,6 +75,8 @@ CSMFGroundTextures::GroundSquare::~GroundSquare()
 
 CSMFGroundTextures::CSMFGroundTextures(CSMFReadMap* rm): smfMap(rm)
 {
+	streamingBudget = configHandler->GetInt("SMFTexStreamingBudget");
+
 	LoadTiles(smfMap->GetMapFile());
 	LoadSquareTextures(3);
 	ConvolveHeightMap(mapDims.mapx, 1);
@@ -97,8 +108,8 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 
 	tileMap.clear();
 	tileMap.resize(smfMap->tileCount);
-	tiles.clear();
-	tiles.resize(tileHeader.numTiles * SMALL_TILE_SIZE);
+	tileFiles.clear();
+	tileFiles.resize(tileHeader.numTileFiles);
 	squares.clear();
 	squares.resize(smfMap->numBigTexX * smfMap->numBigTexY);
 
@@ -113,7 +124,9 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 		}
 	}
 
-	for (int a = 0, curTile = 0; a < tileHeader.numTileFiles; ++a) {
+	for (int a = 0; a < tileHeader.numTileFiles; ++a) {
+		TileFile& tf = tileFiles[a];
+
 		int numSmallTiles = 0;
 		char fileNameBuffer[256] = {0};
 
@@ -121,6 +134,9 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 		ifs->ReadString(&fileNameBuffer[0], sizeof(char) * (sizeof(fileNameBuffer) - 1));
 		swabDWordInPlace(numSmallTiles);
 
+		tf.tileDataOffset = 0;
+		tf.numTiles = std::max(numSmallTiles, 0);
+
 		std::string smtFileName = fileNameBuffer;
 		std::string smtFilePath = (!smtHeaderOverride)?
 			(smfDir + smtFileName):
@@ -138,8 +154,7 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 				__func__, a, smtFilePath.c_str(), numSmallTiles
 			);
 
-			memset(&tiles[curTile * SMALL_TILE_SIZE], 0xaa, numSmallTiles * SMALL_TILE_SIZE);
-			curTile += numSmallTiles;
+			tf.buffer.resize(tf.numTiles * SMALL_TILE_SIZE, 0xaa);
 			continue;
 		}
 
@@ -155,11 +170,32 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 			throw content_error(tmp);
 		}
 
-		for (int b = 0; b < numSmallTiles; ++b) {
-			tileFile.Read(&tiles[(curTile++) * SMALL_TILE_SIZE], SMALL_TILE_SIZE);
+		const int tileDataOffset = tileFile.GetPos();
+		const int tileDataSize = tf.numTiles * SMALL_TILE_SIZE;
+
+		// keep mapped tile-files mapped, only the tiles of squares actually extracted are ever read
+		if ((tf.mapping = tileFile.GetMappedFile()) != nullptr && (tileDataOffset + tileDataSize) <= tileFile.FileSize()) {
+			tf.tileDataOffset = tileDataOffset;
+			continue;
 		}
+
+		tf.mapping.reset();
+
+		if (tileFile.IsBuffered()) {
+			// the file was read into memory as a whole anyway, no need for a second copy
+			tf.buffer = std::move(tileFile.GetBuffer());
+			tf.tileDataOffset = tileDataOffset;
+		} else {
+			tf.buffer.resize(tileDataSize);
+			tileFile.Read(tf.buffer.data(), tileDataSize);
+		}
+
+		// tiles missing from truncated files stay black
+		tf.buffer.resize(std::max(tf.buffer.size(), size_t(tf.tileDataOffset + tileDataSize)), 0);
 	}
 
+	UpdateTilePointers(tileHeader.numTiles);
+
 	ifs->Read(&tileMap[0], smfMap->tileCount * sizeof(int));
 
 	for (int i = 0; i < smfMap->tileCount; i++) {
@@ -179,6 +215,31 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 	}
 }
 
+void CSMFGroundTextures::UpdateTilePointers(int numTiles)
+{
+	tiles.clear();
+	tiles.reserve(numTiles);
+
+	for (const TileFile& tf: tileFiles) {
+		const std::uint8_t* tileData = tf.GetTileData();
+
+		for (int i = 0; i < tf.numTiles; i++) {
+			tiles.push_back(tileData + i * SMALL_TILE_SIZE);
+		}
+	}
+
+	// the header's tile-count is what tileMap indexes into, whatever the tile-files say
+	tiles.resize(std::max(numTiles, 0), BLACK_TILE);
+}
+
+const std::uint8_t* CSMFGroundTextures::TileFile::GetTileData() const
+{
+	if (mapping != nullptr)
+		return (mapping->GetData() + tileDataOffset);
+
+	return (buffer.data() + tileDataOffset);
+}
+
 void CSMFGroundTextures::LoadSquareTextures(const int mipLevel)
 {
 	loadscreen->SetLoadMessage("Loading Square Textures");
@@ -186,9 +247,11 @@ void CSMFGroundTextures::LoadSquareTextures(const int mipLevel)
 	for (int y = 0; y < smfMap->numBigTexY; ++y) {
 		for (int x = 0; x < smfMap->numBigTexX; ++x) {
 			// start at the lowest mip-level
-			LoadSquareTexture(x, y, mipLevel);
+			QueueSquareTexture(x, y, mipLevel);
 		}
 	}
+
+	LoadQueuedSquareTextures(squareRequests.size());
 }
 
 void CSMFGroundTextures::ConvolveHeightMap(const int mapWidth, const int mipLevel)
@@ -281,12 +344,26 @@ bool CSMFGroundTextures::RecompressTilesIfNeeded()
 	rg_etc1::etc1_pack_params pack_params;
 	pack_params.m_quality = rg_etc1::cLowQuality; // must be low, all others take _ages_ to process
 
-	for_mt(0, tiles.size() / 8, [&](const int i) {
-		squish::u8 rgba[64]; // 4x4 pixels * 4 * 1byte channels = 64byte
-		squish::Decompress(rgba, &tiles[i * 8], squish::kDxt1);
-		rg_etc1::pack_etc1_block(&tiles[i * 8], (const unsigned int*)rgba, pack_params);
-	});
+	for (TileFile& tf: tileFiles) {
+		// mappings are read-only, recompress a private copy
+		if (tf.mapping != nullptr) {
+			const std::uint8_t* tileData = tf.GetTileData();
 
+			tf.buffer.assign(tileData, tileData + tf.numTiles * SMALL_TILE_SIZE);
+			tf.mapping.reset();
+			tf.tileDataOffset = 0;
+		}
+
+		std::uint8_t* tileData = tf.buffer.data() + tf.tileDataOffset;
+
+		for_mt(0, (tf.numTiles * SMALL_TILE_SIZE) / 8, [&](const int i) {
+			squish::u8 rgba[64]; // 4x4 pixels * 4 * 1byte channels = 64byte
+			squish::Decompress(rgba, &tileData[i * 8], squish::kDxt1);
+			rg_etc1::pack_etc1_block(&tileData[i * 8], (const unsigned int*)rgba, pack_params);
+		});
+	}
+
+	UpdateTilePointers(tiles.size());
 	return true;
 }
 #endif
@@ -335,7 +412,7 @@ void CSMFGroundTextures::DrawUpdate()
 				if ((square->GetMipLevel() < 3) && ((globalRendering->drawFrame - square->GetDrawFrame()) > 120)) {
 					// `unload` texture (load lowest mip-map) if
 					// the square wasn't visible for 120 vframes
-					LoadSquareTexture(x, y, 3);
+					QueueSquareTexture(x, y, 3);
 				}
 				continue;
 			}
@@ -390,11 +467,26 @@ void CSMFGroundTextures::DrawUpdate()
 			if (stretchFactors[y * smfMap->numBigTexX + x] > 16000 && wantedLevel > 0)
 				wantedLevel--;
 
-			if (square->GetMipLevel() != wantedLevel) {
-				LoadSquareTexture(x, y, wantedLevel);
+			const int currentLevel = square->GetMipLevel();
+
+			if (currentLevel > wantedLevel) {
+				// raise detail one level at a time so every visible square gets its lower mips first
+				QueueSquareTexture(x, y, currentLevel - 1, currentLevel - wantedLevel, dist);
+			} else if (currentLevel < wantedLevel) {
+				QueueSquareTexture(x, y, wantedLevel);
 			}
 		}
 	}
+
+	// most blurry first, then nearest; detail reductions go last
+	std::sort(squareRequests.begin(), squareRequests.end(), [](const SquareRequest& a, const SquareRequest& b) {
+		if (a.priority != b.priority)
+			return (a.priority > b.priority);
+
+		return (a.distance < b.distance);
+	});
+
+	LoadQueuedSquareTextures((streamingBudget > 0)? streamingBudget: squareRequests.size());
 }
 
 
@@ -476,7 +568,7 @@ void CSMFGroundTextures::ExtractSquareTiles(
 			const int tileX = tileOffsetX + x1;
 			const int tileY = tileOffsetY + y1;
 			const int tileIdx = tileMap[tileY * smfMap->tileMapSizeX + tileX];
-			const GLint* tile = (GLint*) &tiles[tileIdx * SMALL_TILE_SIZE + mipOffset];
+			const GLint* tile = (const GLint*) (tiles[tileIdx] + mipOffset);
 
 			const int doff = (x1 * numBlocks) + (y1 * numBlocks * numBlocks) * BLOCK_SIZE;
 
@@ -491,11 +583,61 @@ void CSMFGroundTextures::ExtractSquareTiles(
 	}
 }
 
-void CSMFGroundTextures::LoadSquareTexture(int x, int y, int level)
+void CSMFGroundTextures::QueueSquareTexture(int x, int y, int level, int priority, float distance)
+{
+	squareRequests.push_back({x, y, level, priority, distance});
+}
+
+void CSMFGroundTextures::LoadQueuedSquareTextures(size_t maxCount)
 {
-	constexpr GLenum ttarget = GL_TEXTURE_2D;
 	constexpr GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
 
+	const size_t numRequests = std::min(maxCount, squareRequests.size());
+
+	if (numRequests == 0) {
+		squareRequests.clear();
+		return;
+	}
+
+	squareOffsets.clear();
+	squareOffsets.resize(numRequests + 1, 0);
+
+	for (size_t i = 0; i < numRequests; i++) {
+		const int mipSqSize = smfMap->bigTexSize >> squareRequests[i].mipLevel;
+		squareOffsets[i + 1] = squareOffsets[i] + (mipSqSize * mipSqSize) / 2;
+	}
+
+	pbo.Bind();
+	pbo.New(squareOffsets[numRequests]);
+
+	// all requests share one mapping, the tile gathers are spread over the worker threads
+	char* pboBuf = reinterpret_cast<char*>(pbo.MapBuffer(0, pbo.GetSize(), access | pbo.mapUnsyncedBit));
+
+	if (pboBuf != nullptr) {
+		for_mt(0, numRequests, [&](const int i) {
+			const SquareRequest& req = squareRequests[i];
+			ExtractSquareTiles(req.squareX, req.squareY, req.mipLevel, reinterpret_cast<GLint*>(pboBuf + squareOffsets[i]));
+		});
+	}
+
+	pbo.UnmapBuffer();
+
+	for (size_t i = 0; i < numRequests; i++) {
+		const SquareRequest& req = squareRequests[i];
+		UploadSquareTexture(req.squareX, req.squareY, req.mipLevel, pbo.GetPtr(squareOffsets[i]));
+	}
+
+	pbo.Invalidate();
+	pbo.Unbind();
+
+	// requests over budget are re-evaluated next frame
+	squareRequests.clear();
+}
+
+void CSMFGroundTextures::UploadSquareTexture(int x, int y, int level, const void* data)
+{
+	constexpr GLenum ttarget = GL_TEXTURE_2D;
+
 	const int mipSqSize = smfMap->bigTexSize >> level;
 	const int numSqBytes = (mipSqSize * mipSqSize) / 2;
 
@@ -503,11 +645,6 @@ void CSMFGroundTextures::LoadSquareTexture(int x, int y, int level)
 	square->SetMipLevel(level);
 	assert(!square->HasLuaTexture());
 
-	pbo.Bind();
-	pbo.New(numSqBytes);
-	ExtractSquareTiles(x, y, level, (GLint*) pbo.MapBuffer(0, pbo.GetSize(), access | pbo.mapUnsyncedBit));
-	pbo.UnmapBuffer();
-
 	glDeleteTextures(1, square->GetTextureIDPtr());
 	glGenTextures(1, square->GetTextureIDPtr());
 	glBindTexture(ttarget, square->GetTextureID());
@@ -528,10 +665,7 @@ void CSMFGroundTextures::LoadSquareTexture(int x, int y, int level)
 		glTexParameterf(ttarget, GL_TEXTURE_PRIORITY, 0.5f);
 	}
 
-	glCompressedTexImage2D(ttarget, 0, tileTexFormat, mipSqSize, mipSqSize, 0, numSqBytes, pbo.GetPtr());
-
-	pbo.Invalidate();
-	pbo.Unbind();
+	glCompressedTexImage2D(ttarget, 0, tileTexFormat, mipSqSize, mipSqSize, 0, numSqBytes, data);
 }
 
 void CSMFGroundTextures::BindSquareTexture(int texSquareX, int texSquareY)
@@ -3,11 +3,14 @@
 #ifndef _SMF_GROUND_TEXTURES_H_
 #define _SMF_GROUND_TEXTURES_H_
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "Map/BaseGroundTextures.h"
 #include "Rendering/GL/PBO.h"
 
+class CMappedFile;
 class CSMFMapFile;
 class CSMFReadMap;
 
@@ -23,11 +26,14 @@ public:
 
 protected:
 	void LoadTiles(CSMFMapFile& file);
+	void UpdateTilePointers(int numTiles);
 	void LoadSquareTextures(const int mipLevel);
 	void ConvolveHeightMap(const int mapWidth, const int mipLevel);
 	bool RecompressTilesIfNeeded();
 	void ExtractSquareTiles(const int texSquareX, const int texSquareY, const int mipLevel, GLint* tileBuf) const;
-	void LoadSquareTexture(int x, int y, int level);
+	void QueueSquareTexture(int x, int y, int level, int priority = 0, float distance = 0.0f);
+	void LoadQueuedSquareTextures(size_t maxCount);
+	void UploadSquareTexture(int x, int y, int level, const void* data);
 
 	inline bool TexSquareInView(int, int) const;
 
@@ -61,11 +67,34 @@ private:
 		unsigned int texDrawFrame;
 	};
 
+	struct TileFile {
+		// set for .smt files the VFS could map, their tiles are paged in by the OS when first extracted
+		std::shared_ptr<const CMappedFile> mapping;
+		// otherwise the tiles are owned here (taken over from the file-handler without copying if possible)
+		std::vector<std::uint8_t> buffer;
+
+		const std::uint8_t* GetTileData() const;
+
+		int tileDataOffset;
+		int numTiles;
+	};
+
+	struct SquareRequest {
+		int squareX;
+		int squareY;
+		int mipLevel;
+		// mip-levels of detail still missing; only the most blurry squares are upgraded per frame
+		int priority;
+		float distance;
+	};
+
 	// note: intentionally declared static (see ReadMap)
 	static std::vector<GroundSquare> squares;
 
 	static std::vector<int> tileMap;
-	static std::vector<char> tiles;
+	static std::vector<TileFile> tileFiles;
+	// start of each tile's data in <tileFiles>, SMALL_TILE_SIZE bytes
+	static std::vector<const std::uint8_t*> tiles;
 
 	// FIXME? these are not updated at runtime
 	static std::vector<float> heightMaxima;
@@ -75,6 +104,12 @@ private:
 	// use Pixel Buffer Objects for async. uploading (DMA)
 	PBO pbo;
 
+	std::vector<SquareRequest> squareRequests;
+	std::vector<size_t> squareOffsets;
+
+	// maximum number of squares (re)uploaded per DrawUpdate, 0 := unlimited
+	int streamingBudget = 0;
+
 	unsigned int tileTexFormat = 0;
 	// unsigned int pboUnsyncedBit = 0;
 };
@@ -27,6 +27,18 @@ static bool CheckHeader(const SMFHeader& h)
 
 
 void CSMFMapFile::Open(const std::string& mapFileName)
+{
+	ifs.Open(mapFileName);
+	OpenHeader(mapFileName);
+}
+
+void CSMFMapFile::Open(const std::string& mapFileName, std::vector<std::uint8_t>&& mapFileData)
+{
+	ifs.Open(mapFileName, std::move(mapFileData));
+	OpenHeader(mapFileName);
+}
+
+void CSMFMapFile::OpenHeader(const std::string& mapFileName)
 {
 	char buf[512] = {0};
 	const char* fmts[] = {"[SMFMapFile::%s] could not open \"%s\"", "[SMFMapFile::%s] corrupt header for \"%s\" (v=%d ts=%d tps=%d ss=%d)"};
@@ -35,8 +47,6 @@ void CSMFMapFile::Open(const std::string& mapFileName)
 	memset(&featureHeader, 0, sizeof(featureHeader));
 	memset( featureTypes , 0, sizeof(featureTypes ));
 
-	ifs.Open(mapFileName);
-
 	if (!ifs.FileExists()) {
 		snprintf(buf, sizeof(buf), fmts[0], __func__, mapFileName.c_str());
 		throw content_error(buf);
@@ -20,6 +20,8 @@ public:
 	~CSMFMapFile() { Close(); }
 
 	void Open(const std::string& mapFileName);
+	/// parses an .smf read by the caller, independent of the VFS
+	void Open(const std::string& mapFileName, std::vector<std::uint8_t>&& mapFileData);
 	void Close();
 
 	void ReadMinimap(void* data);
@@ -49,6 +51,8 @@ public:
 	static void ReadMapTileFileHeader(TileFileHeader& head, CFileHandler& file);
 
 private:
+	void OpenHeader(const std::string& mapFileName);
+
 	bool ReadGrassMap(void* data);
 	void ReadMapHeader(SMFHeader& head, CFileHandler& file);
 	void ReadMapFeatureHeader(MapFeatureHeader& head, CFileHandler& file);
@@ -24,6 +24,7 @@
 #include "System/FileSystem/FileHandler.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/SpringMath.h"
+#include "System/SpringMem.h"
 #include "System/SafeUtil.h"
 #include "System/StringHash.h"
 
@@ -45,8 +46,32 @@ std::vector<float> CSMFReadMap::cornerHeightMapUnsynced;
 std::vector<unsigned char> CSMFReadMap::shadingTexBuffer;
 std::vector<unsigned char> CSMFReadMap::waterHeightColors;
 
-static std::vector<float> normalPixels;
-static std::vector<unsigned char> shadingPixels;
+
+
+// the texels are written straight into (orphaned) PBO memory, which lets the
+// driver schedule the transfer instead of copying out of client memory before
+// glTexSubImage2D returns
+template<typename FillFunc>
+static void UploadTextureRect(PBO& pbo, GLuint texID, int x, int y, int xsize, int ysize, GLenum format, GLenum type, size_t numBytes, FillFunc&& fillFunc)
+{
+	pbo.Bind();
+	pbo.New(numBytes);
+
+	void* texels = pbo.MapBuffer(0, pbo.GetSize(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | pbo.mapUnsyncedBit);
+
+	if (texels != nullptr)
+		fillFunc(texels);
+
+	pbo.UnmapBuffer();
+
+	if (texels != nullptr) {
+		glBindTexture(GL_TEXTURE_2D, texID);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, xsize, ysize, format, type, pbo.GetPtr());
+	}
+
+	pbo.Invalidate();
+	pbo.Unbind();
+}
 
 
 
@@ -120,9 +145,11 @@ void CSMFReadMap::LoadHeightMap()
 	const SMFHeader& header = mapFile.GetHeader();
 
 	cornerHeightMapSynced.clear();
+	spring::ReserveHugePages(cornerHeightMapSynced, (mapDims.mapx + 1) * (mapDims.mapy + 1));
 	cornerHeightMapSynced.resize((mapDims.mapx + 1) * (mapDims.mapy + 1)); //mapDims.mapxp1, mapDims.mapyp1 are not available here
 	#ifdef USE_UNSYNCED_HEIGHTMAP
 	cornerHeightMapUnsynced.clear();
+	spring::ReserveHugePages(cornerHeightMapUnsynced, (mapDims.mapx + 1) * (mapDims.mapy + 1));
 	cornerHeightMapUnsynced.resize((mapDims.mapx + 1) * (mapDims.mapy + 1));
 	#endif
 
@@ -614,42 +641,42 @@ void CSMFReadMap::UpdateNormalTexture(const SRectangle& update)
 	const int xsize = (maxx - minx) + 1;
 	const int zsize = (maxz - minz) + 1;
 
-	// Note, it doesn't make sense to use a PBO here.
-	// Cause the upstreamed float32s need to be transformed to float16s, which seems to happen on the CPU!
-
+	// NOTE:
+	//   the float32 -> float16 conversion may still happen on the CPU, but
+	//   it is now up to the driver when, rather than inside glTexSubImage2D
 #if (SSMF_UNCOMPRESSED_NORMALS == 1)
-	normalPixels.clear();
-	normalPixels.resize(xsize * zsize * 4, 0.0f);
+	constexpr GLenum texFormat = GL_RGBA;
+	constexpr size_t numChannels = 4;
 #else
-	normalPixels.clear();
-	normalPixels.resize(xsize * zsize * 2, 0.0f);
+	constexpr GLenum texFormat = GL_LUMINANCE_ALPHA;
+	constexpr size_t numChannels = 2;
 #endif
 
-	for (int z = minz; z <= maxz; z++) {
-		for (int x = minx; x <= maxx; x++) {
-			const float3& vertNormal = vvn[z * mapDims.mapxp1 + x];
-
-		#if (SSMF_UNCOMPRESSED_NORMALS == 1)
-			normalPixels[((z - minz) * xsize + (x - minx)) * 4 + 0] = vertNormal.x;
-			normalPixels[((z - minz) * xsize + (x - minx)) * 4 + 1] = vertNormal.y;
-			normalPixels[((z - minz) * xsize + (x - minx)) * 4 + 2] = vertNormal.z;
-			normalPixels[((z - minz) * xsize + (x - minx)) * 4 + 3] = 1.0f;
-		#else
-			// note: y-coord is regenerated in the shader via "sqrt(1 - x*x - z*z)",
-			//   this gives us 2 solutions but we know that the y-coord always points
-			//   upwards, so we can reconstruct it in the shader.
-			normalPixels[((z - minz) * xsize + (x - minx)) * 2 + 0] = vertNormal.x;
-			normalPixels[((z - minz) * xsize + (x - minx)) * 2 + 1] = vertNormal.z;
-		#endif
+	const auto fillNormalPixels = [&](void* texels) {
+		float* normalPixels = reinterpret_cast<float*>(texels);
+
+		for (int z = minz; z <= maxz; z++) {
+			for (int x = minx; x <= maxx; x++) {
+				const float3& vertNormal = vvn[z * mapDims.mapxp1 + x];
+
+			#if (SSMF_UNCOMPRESSED_NORMALS == 1)
+				normalPixels[((z - minz) * xsize + (x - minx)) * 4 + 0] = vertNormal.x;
+				normalPixels[((z - minz) * xsize + (x - minx)) * 4 + 1] = vertNormal.y;
+				normalPixels[((z - minz) * xsize + (x - minx)) * 4 + 2] = vertNormal.z;
+				normalPixels[((z - minz) * xsize + (x - minx)) * 4 + 3] = 1.0f;
+			#else
+				// note: y-coord is regenerated in the shader via "sqrt(1 - x*x - z*z)",
+				//   this gives us 2 solutions but we know that the y-coord always points
+				//   upwards, so we can reconstruct it in the shader.
+				normalPixels[((z - minz) * xsize + (x - minx)) * 2 + 0] = vertNormal.x;
+				normalPixels[((z - minz) * xsize + (x - minx)) * 2 + 1] = vertNormal.z;
+			#endif
+			}
 		}
-	}
+	};
 
-	glBindTexture(GL_TEXTURE_2D, normalsTex.GetID());
-#if (SSMF_UNCOMPRESSED_NORMALS == 1)
-	glTexSubImage2D(GL_TEXTURE_2D, 0, minx, minz, xsize, zsize, GL_RGBA, GL_FLOAT, &normalPixels[0]);
-#else
-	glTexSubImage2D(GL_TEXTURE_2D, 0, minx, minz, xsize, zsize, GL_LUMINANCE_ALPHA, GL_FLOAT, &normalPixels[0]);
-#endif
+	PBO& pbo = texUpdatePBOs[globalRendering->drawFrame % 3];
+	UploadTextureRect(pbo, normalsTex.GetID(), minx, minz, xsize, zsize, texFormat, GL_FLOAT, xsize * zsize * numChannels * sizeof(float), fillNormalPixels);
 }
 
 
@@ -670,29 +697,31 @@ void CSMFReadMap::UpdateShadingTexture(const SRectangle& update)
 		const int xsize = (x2 - x1) + 1; // +1 cause we iterate:
 		const int ysize = (y2 - y1) + 1; // x1 <= xi <= x2  (not!  x1 <= xi < x2)
 
-		//TODO switch to PBO?
-		shadingPixels.clear();
-		shadingPixels.resize(xsize * ysize * 4, 0.0f);
-
-		for_mt(0, ysize, [&](const int y) {
-			const int idx1 = (y + y1) * mapDims.mapx + x1;
-			const int idx2 = (y + y1) * mapDims.mapx + x2;
-			UpdateShadingTexPart(idx1, idx2, &shadingPixels[y * xsize * 4]);
-		});
-
 		// check if we were in a dynamic sun issued shadingTex update
 		// and our updaterect was already updated (buffered, not send to the GPU yet!)
 		// if so update it in that buffer, too
-		if (shadingTexUpdateProgress > (y1 * mapDims.mapx + x1)) {
-			for (int y = 0; y < ysize; ++y) {
-				const int idx = (y + y1) * mapDims.mapx + x1;
-				memcpy(&shadingTexBuffer[idx * 4] , &shadingPixels[y * xsize * 4], xsize);
-			}
-		}
+		const bool updateTexBuffer = (shadingTexUpdateProgress > (y1 * mapDims.mapx + x1));
+
+		const auto fillShadingPixels = [&](void* texels) {
+			unsigned char* shadingPixels = reinterpret_cast<unsigned char*>(texels);
+
+			for_mt(0, ysize, [&](const int y) {
+				const int idx1 = (y + y1) * mapDims.mapx + x1;
+				const int idx2 = (y + y1) * mapDims.mapx + x2;
+
+				// the mapped PBO is write-only, never read back from it
+				if (updateTexBuffer) {
+					UpdateShadingTexPart(idx1, idx2, &shadingTexBuffer[idx1 * 4]);
+					memcpy(&shadingPixels[y * xsize * 4], &shadingTexBuffer[idx1 * 4], xsize * 4);
+				} else {
+					UpdateShadingTexPart(idx1, idx2, &shadingPixels[y * xsize * 4]);
+				}
+			});
+		};
 
 		// redefine the texture subregion
-		glBindTexture(GL_TEXTURE_2D, shadingTex.GetID());
-		glTexSubImage2D(GL_TEXTURE_2D, 0, x1, y1, xsize, ysize, GL_RGBA, GL_UNSIGNED_BYTE, &shadingPixels[0]);
+		PBO& pbo = texUpdatePBOs[globalRendering->drawFrame % 3];
+		UploadTextureRect(pbo, shadingTex.GetID(), x1, y1, xsize, ysize, GL_RGBA, GL_UNSIGNED_BYTE, xsize * ysize * 4, fillShadingPixels);
 	}
 }
 
@@ -836,8 +865,10 @@ void CSMFReadMap::UpdateShadingTexture()
 		}
 
 		//FIXME use FBO and blend slowly new and old? (this way update rate could reduced even more -> saves CPU time)
-		glBindTexture(GL_TEXTURE_2D, shadingTex.GetID());
-		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, xsize, ysize, GL_RGBA, GL_UNSIGNED_BYTE, &shadingTexBuffer[0]);
+		PBO& pbo = texUpdatePBOs[globalRendering->drawFrame % 3];
+		UploadTextureRect(pbo, shadingTex.GetID(), 0, 0, xsize, ysize, GL_RGBA, GL_UNSIGNED_BYTE, shadingTexBuffer.size(), [&](void* texels) {
+			memcpy(texels, shadingTexBuffer.data(), shadingTexBuffer.size());
+		});
 		return;
 	}
 
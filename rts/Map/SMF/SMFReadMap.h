@@ -7,6 +7,7 @@
 
 #include "SMFMapFile.h"
 #include "Map/ReadMap.h"
+#include "Rendering/GL/PBO.h"
 #include "System/EventClient.h"
 #include "System/type2.h"
 
@@ -202,6 +203,9 @@ private:
 private:
 	CSMFGroundDrawer* groundDrawer = nullptr;
 
+	// staging buffers for normal and shading texture updates (RR policy)
+	PBO texUpdatePBOs[3];
+
 private:
 	MapTexture grassShadingTex;       // specifies grass-blade modulation color (defaults to minimapTex)
 	MapTexture detailTex;             // supplied by the map
@@ -112,6 +112,7 @@ bool SMFRenderStateGLSL::Init(const CSMFGroundDrawer* smfGroundDrawer) {
 	const std::string defs =
 		("#define SMF_TEXSQUARE_SIZE " + FloatToString(                  SMF_TEXSQUARE_SIZE) + "\n") +
 		("#define SMF_INTENSITY_MULT " + FloatToString(CGlobalRendering::SMF_INTENSITY_MULT) + "\n");
+	const std::string fragDefs = defs + (smfGroundDrawer->GetLightHandler()->IsClustered()? GL::LightClusters::GetShaderDefs(): "");
 
 
 	if (useLuaShaders) {
@@ -125,7 +126,7 @@ bool SMFRenderStateGLSL::Init(const CSMFGroundDrawer* smfGroundDrawer) {
 			// load from VFS files
 			glslShaders[n] = shaderHandler->CreateProgramObject("[SMFGroundDrawer::VFS]", names[n], false);
 			glslShaders[n]->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/SMFVertProg.glsl", defs, GL_VERTEX_SHADER));
-			glslShaders[n]->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/SMFFragProg.glsl", defs, GL_FRAGMENT_SHADER));
+			glslShaders[n]->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/SMFFragProg.glsl", fragDefs, GL_FRAGMENT_SHADER));
 		}
 	}
 
@@ -191,6 +192,7 @@ void SMFRenderStateGLSL::Update(
 
 			// both are runtime set in ::Enable, but ATI drivers need values from the beginning
 			glslShaders[n]->SetFlag("HAVE_SHADOWS", false);
+			glslShaders[n]->SetFlag("HAVE_SHADOW_CASCADES", false);
 			glslShaders[n]->SetFlag("HAVE_INFOTEX", false);
 
 			// used to strip down the shader for the deferred pass
@@ -223,6 +225,7 @@ void SMFRenderStateGLSL::Update(
 			glslShaders[n]->SetUniform("splatDetailNormalTex2", 16);
 			glslShaders[n]->SetUniform("splatDetailNormalTex3", 17);
 			glslShaders[n]->SetUniform("splatDetailNormalTex4", 18);
+			glslShaders[n]->SetUniform("shadowCascadeTex",      19);
 
 			glslShaders[n]->SetUniform("mapSizePO2", mapDims.pwr2mapx * SQUARE_SIZE * 1.0f, mapDims.pwr2mapy * SQUARE_SIZE * 1.0f);
 			glslShaders[n]->SetUniform("mapSize",    mapDims.mapx     * SQUARE_SIZE * 1.0f, mapDims.mapy     * SQUARE_SIZE * 1.0f);
@@ -498,6 +501,7 @@ void SMFRenderStateGLSL::Enable(const CSMFGroundDrawer* smfGroundDrawer, const D
 	      GL::LightHandler* mLightHandler = const_cast<GL::LightHandler*>(cLightHandler); // XXX
 
 	glslShaders[GLSL_SHADER_CURRENT]->SetFlag("HAVE_SHADOWS", shadowHandler.ShadowsLoaded());
+	glslShaders[GLSL_SHADER_CURRENT]->SetFlag("HAVE_SHADOW_CASCADES", shadowHandler.ShadowsLoaded() && shadowHandler.GetNumCascades() > CShadowHandler::MIN_SHADOW_CASCADES);
 	glslShaders[GLSL_SHADER_CURRENT]->SetFlag("HAVE_INFOTEX", infoTextureHandler->IsEnabled());
 
 	glslShaders[GLSL_SHADER_CURRENT]->Enable();
@@ -512,8 +516,11 @@ void SMFRenderStateGLSL::Enable(const CSMFGroundDrawer* smfGroundDrawer, const D
 	mLightHandler->Update(glslShaders[GLSL_SHADER_CURRENT]);
 	glMultMatrixf(camera->GetViewMatrix());
 
-	if (shadowHandler.ShadowsLoaded())
+	if (shadowHandler.ShadowsLoaded()) {
+		shadowHandler.SetCascadeUniforms(glslShaders[GLSL_SHADER_CURRENT]);
 		shadowHandler.SetupShadowTexSampler(GL_TEXTURE4);
+		shadowHandler.SetupCascadeTexSampler(GL_TEXTURE19);
+	}
 
 	glActiveTexture(GL_TEXTURE2); glBindTexture(GL_TEXTURE_2D, smfMap->GetDetailTexture());
 	glActiveTexture(GL_TEXTURE5); glBindTexture(GL_TEXTURE_2D, smfMap->GetNormalsTexture());
@@ -544,6 +551,8 @@ void SMFRenderStateGLSL::Disable(const CSMFGroundDrawer*, const DrawPass::e&) {
 	}
 
 	if (shadowHandler.ShadowsLoaded()) {
+		shadowHandler.ResetCascadeTexSampler(GL_TEXTURE19);
+
 		glActiveTexture(GL_TEXTURE4);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
 	}
@@ -6,6 +6,9 @@
 #include "System/Log/ILog.h"
 #include "System/Net/Socket.h"
 
+#include <asio/ip/tcp.hpp>
+#include <asio/local/stream_protocol.hpp>
+
 #include <cstring>
 #include <vector>
 #include <cinttypes>
@@ -79,6 +82,50 @@ enum EVENT
 	/// Player has been defeated (uchar playernumber)
 	PLAYER_DEFEATED = 14,
 
+	/**
+	 * @brief Load of a player's client, sent about once per second
+	 *   (uchar playernumber, float cpuusage, int32 ping, float simframetimemedian,
+	 *   float simframetimep95, float drawframetime, uint16 queuedsimframes)
+	 *
+	 * Times are in milliseconds, the frame times are zero until the client
+	 * reports them.
+	 */
+	PLAYER_STATS = 15,
+
+	/**
+	 * @brief Memory use of the server process, sent about once per second
+	 *   (uint64 residentbytes, uint64 peakresidentbytes, uint64 packetcachebytes,
+	 *   then per subsystem: uint64 bytes, string name, '\0')
+	 *
+	 * The subsystem list is empty for a dedicated server; otherwise it holds
+	 * the estimates of the host's game (see /debuginfo memory), which are
+	 * refreshed about once per second as well.
+	 */
+	SERVER_MEMSTATS = 16,
+
+	/**
+	 * @brief Speed and lag of the game, sent about once per second
+	 *   (int32 framenumber, float userspeed, float internalspeed,
+	 *   float mediancpuusage, int32 medianping, int32 maxping, uchar paused)
+	 *
+	 * Pings are in milliseconds; the medians are zero unless the server uses
+	 * the average speed control (SpeedControl=1).
+	 */
+	SERVER_FRAMESTATS = 17,
+
+	/**
+	 * @brief Players disagree with the sync checksum of a frame
+	 *   (int32 framenumber, uint32 correctchecksum,
+	 *   then per desynced player: uchar playernumber, uint32 checksum)
+	 */
+	SERVER_DESYNC = 18,
+
+	/**
+	 * @brief Telemetry events were dropped because the autohost did not keep
+	 *   up with the stream (uint32 numdroppedevents), only sent over streams
+	 */
+	SERVER_DROPPED = 19,
+
 	/**
 	 * @brief Message sent by lua script
 	 *
@@ -96,10 +143,25 @@ enum EVENT
 };
 }
 
+static void AppendEvent(std::vector<std::uint8_t>& queue, const std::uint8_t* msg, size_t msgSize)
+{
+	const std::uint32_t eventSize = msgSize;
+	const size_t pos = queue.size();
+
+	queue.resize(pos + sizeof(eventSize) + msgSize);
+
+	memcpy(&queue[pos], &eventSize, sizeof(eventSize));
+	memcpy(&queue[pos + sizeof(eventSize)], msg, msgSize);
+}
+
 using namespace asio;
 
+constexpr char AutohostInterface::STREAM_MAGIC[8];
+constexpr std::uint32_t AutohostInterface::STREAM_VERSION;
+
 AutohostInterface::AutohostInterface(const std::string& remoteIP, int remotePort, const std::string& localIP, int localPort)
 		: autohost(netcode::netservice)
+		, stream(netcode::netservice)
 		, initialized(false)
 {
 	std::string errorMsg = AutohostInterface::TryBindSocket(autohost, remoteIP, remotePort, localIP, localPort);
@@ -111,6 +173,56 @@ AutohostInterface::AutohostInterface(const std::string& remoteIP, int remotePort
 	}
 }
 
+AutohostInterface::AutohostInterface(Transport transport, const std::string& remoteAddress, int remotePort, size_t maxQueuedBytes)
+		: autohost(netcode::netservice)
+		, stream(netcode::netservice)
+		, maxQueuedBytes(maxQueuedBytes)
+		, initialized(false)
+{
+	try {
+		switch (transport) {
+			case TRANSPORT_TCP: {
+				asio::error_code err;
+
+				const ip::address remoteAddr = netcode::WrapIP(remoteAddress, &err);
+
+				if (err)
+					throw std::runtime_error("Failed to parse address " + remoteAddress + ": " + err.message());
+
+				stream.connect(ip::tcp::endpoint(remoteAddr, remotePort));
+				// events are batched by Flush already
+				stream.set_option(ip::tcp::no_delay(true));
+			} break;
+			case TRANSPORT_UNIX: {
+			#ifdef ASIO_HAS_LOCAL_SOCKETS
+				stream.connect(local::stream_protocol::endpoint(remoteAddress));
+			#else
+				throw std::runtime_error("UNIX sockets are not supported on this platform");
+			#endif
+			} break;
+		}
+
+		stream.non_blocking(true);
+	} catch (const std::runtime_error& ex) {
+		// also includes asio::system_error, inherits from runtime_error
+		stream.close();
+		LOG_L(L_ERROR, "Failed to connect stream to %s: %s", remoteAddress.c_str(), ex.what());
+		return;
+	}
+
+	sendQueue.reserve(std::min(maxQueuedBytes, size_t(64 * 1024)));
+	sendQueue.insert(sendQueue.end(), STREAM_MAGIC, STREAM_MAGIC + sizeof(STREAM_MAGIC));
+	sendQueue.insert(sendQueue.end(), reinterpret_cast<const std::uint8_t*>(&STREAM_VERSION), reinterpret_cast<const std::uint8_t*>(&STREAM_VERSION) + sizeof(STREAM_VERSION));
+
+	initialized = true;
+}
+
+AutohostInterface::~AutohostInterface()
+{
+	// best effort for SERVER_QUIT, without blocking on an autohost that stopped reading
+	Flush();
+}
+
 std::string AutohostInterface::TryBindSocket(
 			asio::ip::udp::socket& socket,
 			const std::string& remoteIP, int remotePort,
@@ -230,7 +342,7 @@ void AutohostInterface::SendGameOver(uchar playerNum, const std::vector<uchar>&
 
 void AutohostInterface::SendPlayerJoined(uchar playerNum, const std::string& name)
 {
-	if (autohost.is_open()) {
+	if (IsOpen()) {
 		unsigned msgsize = 2 * sizeof(uchar) + name.size();
 		std::vector<std::uint8_t> buffer(msgsize);
 		buffer[0] = PLAYER_JOINED;
@@ -257,7 +369,7 @@ void AutohostInterface::SendPlayerReady(uchar playerNum, uchar readyState)
 
 void AutohostInterface::SendPlayerChat(uchar playerNum, uchar destination, const std::string& chatmsg)
 {
-	if (autohost.is_open()) {
+	if (IsOpen()) {
 		const unsigned msgsize = 3 * sizeof(uchar) + chatmsg.size();
 		std::vector<std::uint8_t> buffer(msgsize);
 		buffer[0] = PLAYER_CHAT;
@@ -276,9 +388,113 @@ void AutohostInterface::SendPlayerDefeated(uchar playerNum)
 	Send(asio::buffer(&msg, 2 * sizeof(uchar)));
 }
 
+void AutohostInterface::SendPlayerStats(uchar playerNum, float cpuUsage, std::int32_t ping, float simFrameTimeMedian, float simFrameTimeP95, float drawFrameTime, std::uint16_t numQueuedSimFrames)
+{
+	if (IsOpen()) {
+		std::vector<std::uint8_t> buffer(2 * sizeof(uchar) + 4 * sizeof(float) + sizeof(ping) + sizeof(numQueuedSimFrames));
+		unsigned int pos = 0;
+
+		buffer[pos++] = PLAYER_STATS;
+		buffer[pos++] = playerNum;
+
+		memcpy(&buffer[pos], &cpuUsage, sizeof(cpuUsage));
+		pos += sizeof(cpuUsage);
+		memcpy(&buffer[pos], &ping, sizeof(ping));
+		pos += sizeof(ping);
+		memcpy(&buffer[pos], &simFrameTimeMedian, sizeof(simFrameTimeMedian));
+		pos += sizeof(simFrameTimeMedian);
+		memcpy(&buffer[pos], &simFrameTimeP95, sizeof(simFrameTimeP95));
+		pos += sizeof(simFrameTimeP95);
+		memcpy(&buffer[pos], &drawFrameTime, sizeof(drawFrameTime));
+		pos += sizeof(drawFrameTime);
+		memcpy(&buffer[pos], &numQueuedSimFrames, sizeof(numQueuedSimFrames));
+
+		Send(asio::buffer(buffer));
+	}
+}
+
+void AutohostInterface::SendMemoryStats(std::uint64_t residentBytes, std::uint64_t peakResidentBytes, std::uint64_t packetCacheBytes, const std::vector< std::pair<std::string, std::uint64_t> >& subsystemBytes)
+{
+	if (IsOpen()) {
+		std::vector<std::uint8_t> buffer(sizeof(uchar) + 3 * sizeof(std::uint64_t));
+		unsigned int pos = 0;
+
+		buffer[pos++] = SERVER_MEMSTATS;
+
+		memcpy(&buffer[pos], &residentBytes, sizeof(residentBytes));
+		pos += sizeof(residentBytes);
+		memcpy(&buffer[pos], &peakResidentBytes, sizeof(peakResidentBytes));
+		pos += sizeof(peakResidentBytes);
+		memcpy(&buffer[pos], &packetCacheBytes, sizeof(packetCacheBytes));
+		pos += sizeof(packetCacheBytes);
+
+		for (const auto& p: subsystemBytes) {
+			buffer.resize(pos + sizeof(p.second) + p.first.size() + 1);
+
+			memcpy(&buffer[pos], &p.second, sizeof(p.second));
+			pos += sizeof(p.second);
+			memcpy(&buffer[pos], p.first.c_str(), p.first.size() + 1);
+			pos += (p.first.size() + 1);
+		}
+
+		Send(asio::buffer(buffer));
+	}
+}
+
+void AutohostInterface::SendFrameStats(std::int32_t frameNum, float userSpeed, float internalSpeed, float medianCpuUsage, std::int32_t medianPing, std::int32_t maxPing, bool paused)
+{
+	if (IsOpen()) {
+		std::vector<std::uint8_t> buffer(2 * sizeof(uchar) + 3 * sizeof(float) + 3 * sizeof(std::int32_t));
+		unsigned int pos = 0;
+
+		buffer[pos++] = SERVER_FRAMESTATS;
+
+		memcpy(&buffer[pos], &frameNum, sizeof(frameNum));
+		pos += sizeof(frameNum);
+		memcpy(&buffer[pos], &userSpeed, sizeof(userSpeed));
+		pos += sizeof(userSpeed);
+		memcpy(&buffer[pos], &internalSpeed, sizeof(internalSpeed));
+		pos += sizeof(internalSpeed);
+		memcpy(&buffer[pos], &medianCpuUsage, sizeof(medianCpuUsage));
+		pos += sizeof(medianCpuUsage);
+		memcpy(&buffer[pos], &medianPing, sizeof(medianPing));
+		pos += sizeof(medianPing);
+		memcpy(&buffer[pos], &maxPing, sizeof(maxPing));
+		pos += sizeof(maxPing);
+
+		buffer[pos++] = paused;
+
+		Send(asio::buffer(buffer));
+	}
+}
+
+void AutohostInterface::SendDesync(std::int32_t frameNum, std::uint32_t correctChecksum, const std::vector< std::pair<uchar, std::uint32_t> >& desyncedPlayers)
+{
+	if (IsOpen()) {
+		std::vector<std::uint8_t> buffer(sizeof(uchar) + sizeof(frameNum) + sizeof(correctChecksum) + desyncedPlayers.size() * (sizeof(uchar) + sizeof(std::uint32_t)));
+		unsigned int pos = 0;
+
+		buffer[pos++] = SERVER_DESYNC;
+
+		memcpy(&buffer[pos], &frameNum, sizeof(frameNum));
+		pos += sizeof(frameNum);
+		memcpy(&buffer[pos], &correctChecksum, sizeof(correctChecksum));
+		pos += sizeof(correctChecksum);
+
+		for (const auto& p: desyncedPlayers) {
+			buffer[pos++] = p.first;
+
+			memcpy(&buffer[pos], &p.second, sizeof(p.second));
+			pos += sizeof(p.second);
+		}
+
+		Send(asio::buffer(buffer));
+	}
+}
+
 void AutohostInterface::Message(const std::string& message)
 {
-	if (autohost.is_open()) {
+	if (IsOpen()) {
 		const unsigned msgsize = sizeof(uchar) + message.size();
 		std::vector<std::uint8_t> buffer(msgsize);
 		buffer[0] = SERVER_MESSAGE;
@@ -290,7 +506,7 @@ void AutohostInterface::Message(const std::string& message)
 
 void AutohostInterface::Warning(const std::string& message)
 {
-	if (autohost.is_open()) {
+	if (IsOpen()) {
 		const unsigned msgsize = sizeof(uchar) + message.size();
 		std::vector<std::uint8_t> buffer(msgsize);
 		buffer[0] = SERVER_WARNING;
@@ -302,7 +518,7 @@ void AutohostInterface::Warning(const std::string& message)
 
 void AutohostInterface::SendLuaMsg(const std::uint8_t* msg, size_t msgSize)
 {
-	if (autohost.is_open()) {
+	if (IsOpen()) {
 		std::vector<std::uint8_t> buffer(msgSize+1);
 		buffer[0] = GAME_LUAMSG;
 		std::copy(msg, msg + msgSize, buffer.begin() + 1);
@@ -313,7 +529,7 @@ void AutohostInterface::SendLuaMsg(const std::uint8_t* msg, size_t msgSize)
 
 void AutohostInterface::Send(const std::uint8_t* msg, size_t msgSize)
 {
-	if (autohost.is_open()) {
+	if (IsOpen()) {
 		std::vector<std::uint8_t> buffer(msgSize);
 		std::copy(msg, msg + msgSize, buffer.begin());
 
@@ -323,6 +539,46 @@ void AutohostInterface::Send(const std::uint8_t* msg, size_t msgSize)
 
 std::string AutohostInterface::GetChatMessage()
 {
+	if (stream.is_open()) {
+		asio::error_code err;
+
+		const size_t numAvailable = stream.available(err);
+
+		if (!err && numAvailable > 0) {
+			const size_t pos = recvBuffer.size();
+
+			recvBuffer.resize(pos + numAvailable);
+			recvBuffer.resize(pos + stream.read_some(asio::buffer(&recvBuffer[pos], numAvailable), err));
+		}
+
+		if (err && err != asio::error::would_block) {
+			std::lock_guard<spring::mutex> lock(sendQueueMutex);
+			CloseStream(err.message().c_str());
+			return "";
+		}
+
+		std::uint32_t msgSize = 0;
+
+		if (recvBuffer.size() < sizeof(msgSize))
+			return "";
+
+		memcpy(&msgSize, recvBuffer.data(), sizeof(msgSize));
+
+		if (msgSize > maxQueuedBytes) {
+			std::lock_guard<spring::mutex> lock(sendQueueMutex);
+			CloseStream("malformed message from autohost");
+			return "";
+		}
+
+		if (recvBuffer.size() < (sizeof(msgSize) + msgSize))
+			return "";
+
+		const std::string msg(recvBuffer.begin() + sizeof(msgSize), recvBuffer.begin() + sizeof(msgSize) + msgSize);
+
+		recvBuffer.erase(recvBuffer.begin(), recvBuffer.begin() + sizeof(msgSize) + msgSize);
+		return msg;
+	}
+
 	if (autohost.is_open()) {
 		size_t bytes_avail = 0;
 
@@ -336,8 +592,87 @@ std::string AutohostInterface::GetChatMessage()
 	return "";
 }
 
+void AutohostInterface::Flush()
+{
+	if (!stream.is_open())
+		return;
+
+	std::lock_guard<spring::mutex> lock(sendQueueMutex);
+
+	if (numDroppedEvents > 0 && sendQueue.size() <= (maxQueuedBytes / 4)) {
+		std::uint8_t msg[sizeof(uchar) + sizeof(numDroppedEvents)] = {SERVER_DROPPED};
+
+		memcpy(&msg[1], &numDroppedEvents, sizeof(numDroppedEvents));
+		AppendEvent(sendQueue, msg, sizeof(msg));
+
+		numDroppedEvents = 0;
+	}
+
+	if (sendQueue.empty())
+		return;
+
+	asio::error_code err;
+
+	const size_t numBytes = stream.write_some(asio::buffer(sendQueue), err);
+
+	if (err && err != asio::error::would_block) {
+		CloseStream(err.message().c_str());
+		return;
+	}
+
+	sendQueue.erase(sendQueue.begin(), sendQueue.begin() + numBytes);
+}
+
+void AutohostInterface::QueueEvent(const std::uint8_t* msg, size_t msgSize)
+{
+	std::lock_guard<spring::mutex> lock(sendQueueMutex);
+
+	if (!stream.is_open())
+		return;
+
+	const size_t queuedBytes = sendQueue.size() + sizeof(std::uint32_t) + msgSize;
+
+	switch (msg[0]) {
+		case PLAYER_STATS:
+		case SERVER_MEMSTATS:
+		case SERVER_FRAMESTATS: {
+			// sent again a second later, leave the rest of the queue to the other events
+			if (queuedBytes > (maxQueuedBytes / 2)) {
+				numDroppedEvents += 1;
+				return;
+			}
+		} break;
+		default: {
+			// dropping these would leave the autohost with a wrong picture of the game
+			if (queuedBytes > maxQueuedBytes) {
+				CloseStream("send queue is full, the autohost stopped reading");
+				return;
+			}
+		} break;
+	}
+
+	AppendEvent(sendQueue, msg, msgSize);
+}
+
+void AutohostInterface::CloseStream(const char* reason)
+{
+	// called with sendQueueMutex held
+	LOG_L(L_ERROR, "Closing the autohost stream: %s", reason);
+
+	asio::error_code err;
+	stream.close(err);
+
+	sendQueue.clear();
+	recvBuffer.clear();
+}
+
 void AutohostInterface::Send(asio::mutable_buffers_1 buffer)
 {
+	if (stream.is_open()) {
+		QueueEvent(reinterpret_cast<const std::uint8_t*>(buffer.data()), buffer.size());
+		return;
+	}
+
 	if (autohost.is_open()) {
 		try {
 			autohost.send(buffer);
@@ -4,18 +4,41 @@
 #define AUTOHOST_INTERFACE_H
 
 #include <string>
+#include <vector>
 #include <cinttypes>
 #include <asio/ip/udp.hpp>
+#include <asio/generic/stream_protocol.hpp>
+
+#include "System/Threading/SpringThreading.h"
 
 /**
  * API for engine <-> autohost (or similar) communication, using UDP over
- * loopback.
+ * loopback or a TCP / UNIX-domain stream.
+ *
+ * Over UDP every event is one datagram, sent at once. Over a stream the
+ * engine first sends STREAM_MAGIC and STREAM_VERSION (uint32), then each event
+ * as uint32 length + the same bytes as its datagram; events are queued and
+ * written in one batch per server update (Flush). The autohost sends its
+ * chat messages and commands framed the same way, as uint32 length + text.
+ *
+ * The stream queue is bounded: past half of it the once-per-second telemetry
+ * (PLAYER_STATS, SERVER_MEMSTATS, SERVER_FRAMESTATS) is dropped and later
+ * reported by a SERVER_DROPPED event, an autohost that stops reading for long
+ * enough to fill it entirely is disconnected.
  */
 class AutohostInterface
 {
 public:
 	typedef unsigned char uchar;
 
+	enum Transport {
+		TRANSPORT_TCP,
+		TRANSPORT_UNIX,
+	};
+
+	static constexpr char STREAM_MAGIC[8] = {'S', 'P', 'R', 'I', 'N', 'G', 'A', 'H'};
+	static constexpr std::uint32_t STREAM_VERSION = 1;
+
 	/**
 	 * @brief Connects to a port on localhost
 	 * @param remoteIP IP of the autohost to connect to
@@ -28,9 +51,17 @@ public:
 	 */
 	AutohostInterface(const std::string& remoteIP, int remotePort,
 			const std::string& localIP = "", int localPort = 0);
-	virtual ~AutohostInterface() {}
+	/**
+	 * @brief Connects a stream to the autohost
+	 * @param remoteAddress IP of the autohost for TCP, socket path for UNIX
+	 * @param remotePort the autohost's port for TCP, ignored for UNIX
+	 * @param maxQueuedBytes bound of the send queue
+	 */
+	AutohostInterface(Transport transport, const std::string& remoteAddress, int remotePort, size_t maxQueuedBytes);
+	virtual ~AutohostInterface();
 
 	bool IsInitialized() const { return initialized; }
+	bool IsStream() const { return stream.is_open(); }
 
 	void SendStart();
 	void SendQuit();
@@ -42,6 +73,10 @@ public:
 	void SendPlayerReady(uchar playerNum, uchar readyState);
 	void SendPlayerChat(uchar playerNum, uchar destination, const std::string& msg);
 	void SendPlayerDefeated(uchar playerNum);
+	void SendPlayerStats(uchar playerNum, float cpuUsage, std::int32_t ping, float simFrameTimeMedian, float simFrameTimeP95, float drawFrameTime, std::uint16_t numQueuedSimFrames);
+	void SendMemoryStats(std::uint64_t residentBytes, std::uint64_t peakResidentBytes, std::uint64_t packetCacheBytes, const std::vector< std::pair<std::string, std::uint64_t> >& subsystemBytes);
+	void SendFrameStats(std::int32_t frameNum, float userSpeed, float internalSpeed, float medianCpuUsage, std::int32_t medianPing, std::int32_t maxPing, bool paused);
+	void SendDesync(std::int32_t frameNum, std::uint32_t correctChecksum, const std::vector< std::pair<uchar, std::uint32_t> >& desyncedPlayers);
 
 	void Message(const std::string& message);
 	void Warning(const std::string& message);
@@ -56,8 +91,15 @@ public:
 	 */
 	std::string GetChatMessage();
 
+	/// writes as much of the stream queue as the socket takes without blocking
+	void Flush();
+
 private:
+	bool IsOpen() const { return (autohost.is_open() || stream.is_open()); }
+
 	void Send(asio::mutable_buffers_1 sendBuffer);
+	void QueueEvent(const std::uint8_t* msg, size_t msgSize);
+	void CloseStream(const char* reason);
 
 	/**
 	 * Tries to bind a socket for communication with a UDP server.
@@ -76,6 +118,17 @@ private:
 			const std::string& localIP = "", int localPort = 0);
 
 	asio::ip::udp::socket autohost;
+	asio::generic::stream_protocol::socket stream;
+
+	std::vector<std::uint8_t> sendQueue;
+	std::vector<std::uint8_t> recvBuffer;
+
+	// events may be sent from outside the server thread (Message)
+	spring::mutex sendQueueMutex;
+
+	size_t maxQueuedBytes = 0;
+	std::uint32_t numDroppedEvents = 0;
+
 	bool initialized;
 };
 
@@ -45,6 +45,18 @@ public:
 
 	PlayerStatistics lastStats;
 
+	/// timings last reported by the client through NETMSG_CLIENT_STATS (milliseconds)
+	struct ClientStats {
+		float simFrameTimeMedian = 0.0f;
+		float simFrameTimeP95 = 0.0f;
+		float prevSimFrameTimeP95 = 0.0f;
+		float drawFrameTime = 0.0f;
+
+		int numQueuedSimFrames = 0;
+	};
+
+	ClientStats clientStats;
+
 	struct ClientLinkData {
 		ClientLinkData(bool connect = true) {
 			if (connect)
@@ -4,6 +4,7 @@
 #include "System/Net/UDPConnection.h"
 
 #include <functional>
+#include <limits>
 
 #if defined DEDICATED || defined DEBUG
 	#include <iostream>
@@ -21,6 +22,7 @@
 #include "Game/Action.h"
 #include "Game/ChatMessage.h"
 #include "Game/CommandMessage.h"
+#include "Game/GameVersion.h"
 #include "Game/GlobalUnsynced.h" // for syncdebug
 #ifndef DEDICATED
 #include "Game/IVideoCapturing.h"
@@ -46,14 +48,17 @@
 #include "System/StringHash.h"
 #include "System/StringUtil.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/MemoryStats.h"
 #include "System/FileSystem/SimpleParser.h"
 #include "System/Net/Connection.h"
 #include "System/Net/LocalConnection.h"
 #include "System/Net/UnpackPacket.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/LoadSave/DemoReader.h"
+#include "System/Sync/SyncTree.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/errorhandler.h"
+#include "System/Platform/Misc.h"
 #include "System/Platform/Threading.h"
 #include "System/Threading/SpringThreading.h"
 
@@ -75,7 +80,10 @@ CONFIG(bool, WhiteListAdditionalPlayers).defaultValue(true);
 CONFIG(bool, ServerRecordDemos).defaultValue(false).dedicatedValue(true);
 CONFIG(bool, ServerLogInfoMessages).defaultValue(false);
 CONFIG(bool, ServerLogDebugMessages).defaultValue(false);
+CONFIG(bool, SyncTreeStateDumps).defaultValue(false).description("On the first sync tree mismatch, have every client write a binary state dump (see DumpStateSnapshot) of the same frame.");
 CONFIG(std::string, AutohostIP).defaultValue("127.0.0.1");
+CONFIG(std::string, AutohostTransport).defaultValue("udp").description("How to talk to the autohost: udp (one datagram per event), tcp (event stream to AutohostIP:AutohostPort) or unix:<socket path> (event stream over a UNIX domain socket).");
+CONFIG(int, AutohostMaxQueuedKB).defaultValue(4096).minimumValue(64).description("Bound of the event queue for stream autohost connections; telemetry is dropped past half of it, and an autohost that lets it fill up is disconnected.");
 
 
 // use the specific section for all LOG*() calls in this source file
@@ -110,6 +118,9 @@ static constexpr unsigned gameProgressFrameInterval = GAME_SPEED * 5;
 
 static constexpr unsigned syncResponseEchoInterval = GAME_SPEED * 2;
 
+/// skip targets at least this far beyond the next keyframe restart demo playback from it
+static constexpr int keyframeReloadFrames = GAME_SPEED * 60 * 10;
+
 
 //FIXME remodularize server commands, so they get registered in word completion etc.
 decltype(CGameServer::commandBlacklist) CGameServer::commandBlacklist{
@@ -170,7 +181,7 @@ void CGameServer::Initialize()
 	if (!myGameSetup->onlyLocal)
 		udpListener.reset(new netcode::UDPListener(myClientSetup->hostPort, myClientSetup->hostIP));
 
-	AddAutohostInterface(StringToLower(configHandler->GetString("AutohostIP")), configHandler->GetInt("AutohostPort"));
+	AddAutohostInterface(StringToLower(configHandler->GetString("AutohostIP")), configHandler->GetInt("AutohostPort"), configHandler->GetString("AutohostTransport"));
 	Message(spring::format(ServerStart, myClientSetup->hostPort), false);
 
 	// start script
@@ -260,6 +271,9 @@ void CGameServer::Initialize()
 	lastNewFrameTick = spring_gettime();
 	lastBandwidthUpdate = spring_gettime();
 
+	if (!myClientSetup->relayHostIP.empty() && demoReader == nullptr && udpListener != nullptr)
+		ConnectRelayHost();
+
 	thread = std::move(spring::thread(std::bind(&CGameServer::UpdateLoop, this)));
 
 	// Something in CGameServer::CGameServer borks the FPU control word
@@ -267,7 +281,7 @@ void CGameServer::Initialize()
 	// Set single precision floating point math.
 	streflop::streflop_init<streflop::Simple>();
 
-	if (!demoReader) {
+	if (!demoReader && !IsRelay()) {
 		GenerateAndSendGameID();
 		rng.Seed(gameID.intArray[0] ^ gameID.intArray[1] ^ gameID.intArray[2] ^ gameID.intArray[3]);
 		Broadcast(CBaseNetProtocol::Get().SendRandSeed(rng()));
@@ -361,8 +375,28 @@ void CGameServer::AddLocalClient(const std::string& myName, const std::string& m
 	localClientNumber = BindConnection(std::shared_ptr<netcode::CConnection>(new netcode::CLocalConnection()), myName, "", myVersion, myPlatform, true);
 }
 
-void CGameServer::AddAutohostInterface(const std::string& autohostIP, const int autohostPort)
+void CGameServer::AddAutohostInterface(const std::string& autohostIP, const int autohostPort, const std::string& transport)
 {
+	const size_t maxQueuedBytes = configHandler->GetInt("AutohostMaxQueuedKB") * size_t(1024);
+
+	if (transport.compare(0, 5, "unix:") == 0) {
+		if (!hostif) {
+			hostif.reset(new AutohostInterface(AutohostInterface::TRANSPORT_UNIX, transport.substr(5), 0, maxQueuedBytes));
+
+			if (hostif->IsInitialized()) {
+				hostif->SendStart();
+				Message(spring::format(ConnectAutohostSocket, transport.c_str() + 5), false);
+			} else {
+				// same as below
+				hostif.reset();
+				Message(spring::format(ConnectAutohostSocketFailed, transport.c_str() + 5), false);
+				quitServer = true;
+			}
+		}
+
+		return;
+	}
+
 	if (autohostPort <= 0)
 		return;
 
@@ -371,13 +405,23 @@ void CGameServer::AddAutohostInterface(const std::string& autohostIP, const int
 		return;
 	}
 
+	const bool useTCP = (transport == "tcp");
+
+	if (!useTCP && transport != "udp")
+		LOG_L(L_WARNING, "Unknown AutohostTransport \"%s\", using udp", transport.c_str());
+
 #ifndef DEDICATED
 	// disallow luasockets access to autohost interface
-	luaSocketRestrictions->addRule(CLuaSocketRestrictions::UDP_CONNECT, autohostIP, autohostPort, false);
+	luaSocketRestrictions->addRule(useTCP? CLuaSocketRestrictions::TCP_CONNECT: CLuaSocketRestrictions::UDP_CONNECT, autohostIP, autohostPort, false);
 #endif
 
 	if (!hostif) {
-		hostif.reset(new AutohostInterface(autohostIP, autohostPort));
+		if (useTCP) {
+			hostif.reset(new AutohostInterface(AutohostInterface::TRANSPORT_TCP, autohostIP, autohostPort, maxQueuedBytes));
+		} else {
+			hostif.reset(new AutohostInterface(autohostIP, autohostPort));
+		}
+
 		if (hostif->IsInitialized()) {
 			hostif->SendStart();
 			Message(spring::format(ConnectAutohost, autohostPort), false);
@@ -430,6 +474,100 @@ void CGameServer::SkipTo(int targetFrameNum)
 	isPaused = wasPaused;
 }
 
+void CGameServer::SkipToKeyframe(int keyframe, int targetFrameNum)
+{
+	const DemoKeyframe& kf = demoReader->GetKeyframes()[keyframe];
+	netcode::RawPacket* buf = nullptr;
+
+	// the local client restored everything simulated up to the keyframe, so neither
+	// frames nor orders before it are sent; players and the start signal are not in
+	// its state however
+	while (demoReader->GetStreamPos() < kf.streamOffset && (buf = demoReader->GetData(std::numeric_limits<float>::max())) != nullptr) {
+		std::shared_ptr<const RawPacket> rpkt(buf);
+
+		if (buf->length <= 0)
+			continue;
+
+		switch (buf->data[0]) {
+			case NETMSG_NEWFRAME:
+			case NETMSG_KEYFRAME: {
+				serverFrameNum++;
+			} break;
+
+			case NETMSG_CREATE_NEWPLAYER: {
+				AddDemoPlayer(rpkt);
+			} break;
+
+			case NETMSG_CCOMMAND: {
+				try {
+					CommandMessage msg(rpkt);
+					const Action& action = msg.GetAction();
+					if (msg.GetPlayerID() == SERVER_PLAYER && action.command == "cheat")
+						InverseOrSetBool(cheating, action.extra);
+				} catch (const netcode::UnpackPacketException& ex) {
+					Message(spring::format("Warning: Discarding invalid command message packet in demo: %s", ex.what()));
+				}
+			} break;
+
+			case NETMSG_STARTPLAYING:
+			case NETMSG_GAMEID:
+			case NETMSG_PLAYERNAME: {
+				Broadcast(rpkt);
+			} break;
+
+			default: {
+			} break;
+		}
+	}
+
+	if (serverFrameNum != kf.frameNum)
+		Message(spring::format("Warning: demo keyframe at frame %d was found at frame %d", kf.frameNum, serverFrameNum));
+
+	// keep the demo from rushing through the time that was read ahead
+	demoReader->ResetTime(modGameTime);
+
+	SkipTo(targetFrameNum);
+}
+
+bool CGameServer::ReloadForSkip(int targetFrameNum) const
+{
+	// the reload happens in the local client; nobody else could follow it
+	if (!HasLocalClient())
+		return false;
+
+	for (const GameParticipant& p: players) {
+		if (p.clientLink != nullptr && !p.isLocal)
+			return false;
+	}
+
+	const int keyframe = demoReader->FindKeyframe(targetFrameNum);
+
+	if (keyframe < 0)
+		return false;
+
+	return ((demoReader->GetKeyframes()[keyframe].frameNum - serverFrameNum) >= keyframeReloadFrames);
+}
+
+bool CGameServer::AddDemoPlayer(std::shared_ptr<const netcode::RawPacket> packet)
+{
+	try {
+		netcode::UnpackPacket pckt(packet, 3);
+		unsigned char spectator, team, playerNum;
+		std::string name;
+		pckt >> playerNum;
+		pckt >> spectator;
+		pckt >> team;
+		pckt >> name;
+		AddAdditionalUser(name, "", true, (bool)spectator, (int)team, playerNum); // even though this is a demo, keep the players vector properly updated
+	} catch (const netcode::UnpackPacketException& ex) {
+		Message(spring::format("Warning: Discarding invalid new player packet in demo: %s", ex.what()));
+		return false;
+	}
+
+	Broadcast(packet);
+	return true;
+}
+
 std::string CGameServer::GetPlayerNames(const std::vector<int>& indices) const
 {
 	std::string playerstring;
@@ -482,21 +620,7 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 			}
 
 			case NETMSG_CREATE_NEWPLAYER: {
-				try {
-					netcode::UnpackPacket pckt(rpkt, 3);
-					unsigned char spectator, team, playerNum;
-					std::string name;
-					pckt >> playerNum;
-					pckt >> spectator;
-					pckt >> team;
-					pckt >> name;
-					AddAdditionalUser(name, "", true, (bool)spectator, (int)team, playerNum); // even though this is a demo, keep the players vector properly updated
-				} catch (const netcode::UnpackPacketException& ex) {
-					Message(spring::format("Warning: Discarding invalid new player packet in demo: %s", ex.what()));
-					continue;
-				}
-
-				Broadcast(rpkt);
+				AddDemoPlayer(rpkt);
 				break;
 			}
 
@@ -541,14 +665,139 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 	return ret;
 }
 
+void CGameServer::ConnectRelayHost()
+{
+	const std::string& hostIP = myClientSetup->relayHostIP;
+	const int hostPort = myClientSetup->relayHostPort;
+
+	relayLink = udpListener->SpawnConnection(hostIP, hostPort);
+	relayLink->Unmute();
+	relayLink->SendData(CBaseNetProtocol::Get().SendAttemptConnect(myClientSetup->myPlayerName, myClientSetup->myPasswd, SpringVersion::GetSync(), Platform::GetPlatformStr(), globalConfig.networkLossFactor));
+	relayLink->Flush(true);
+
+	// clients have to match the upstream server, not whoever connects first
+	refClientVersion = {hostIP, SpringVersion::GetSync()};
+
+	// not until upstream has sent us the game data and our player number
+	udpListener->SetAcceptingConnections(false);
+
+	Message(spring::format("Relaying game hosted at %s:%d as %s", hostIP.c_str(), hostPort, myClientSetup->myPlayerName.c_str()), false);
+}
+
+void CGameServer::ReadRelayData()
+{
+	std::shared_ptr<const RawPacket> packet;
+
+	while ((packet = relayLink->GetData()) != nullptr) {
+		if (packet->length <= 0)
+			continue;
+
+		switch (packet->data[0]) {
+			case NETMSG_GAMEDATA: {
+				relayGameData = packet;
+			} break;
+			case NETMSG_SETPLAYERNUM: {
+				relayPlayerNum = packet->data[1];
+				udpListener->SetAcceptingConnections(relayGameData != nullptr);
+			} break;
+			case NETMSG_PING: {
+				// only ever addressed to us
+			} break;
+
+			case NETMSG_NEWFRAME:
+			case NETMSG_KEYFRAME: {
+				lastNewFrameTick = spring_gettime();
+				serverFrameNum++;
+				gameHasStarted = true;
+
+				BroadcastPacket(packet);
+			} break;
+
+			case NETMSG_QUIT: {
+				Message("Relay host closed the connection", false);
+				BroadcastPacket(packet);
+
+				quitServer = true;
+				return;
+			} break;
+
+			default: {
+				BroadcastPacket(packet);
+			} break;
+		}
+	}
+
+	if (!relayLink->CheckTimeout(0, !gameHasStarted))
+		return;
+
+	Message("Relay host timed out", false);
+	Broadcast(CBaseNetProtocol::Get().SendQuit("Relay host timed out"));
+
+	quitServer = true;
+}
+
+void CGameServer::ProcessRelayViewerPacket(const unsigned playerNum, std::shared_ptr<const netcode::RawPacket> packet)
+{
+	const std::uint8_t* inbuf = packet->data;
+	GameParticipant& p = players[playerNum];
+
+	// all clients act as our upstream spectator; whatever they would have it say
+	// or do is dropped, only what concerns their own connection is handled here
+	switch (inbuf[0]) {
+		case NETMSG_KEYFRAME: {
+			const int frameNum = *(int*) &inbuf[1];
+
+			if (frameNum <= serverFrameNum && frameNum > p.lastFrameResponse)
+				p.lastFrameResponse = frameNum;
+		} break;
+
+		case NETMSG_PING: {
+			// limit to 50 pings per second
+			if (spring_diffmsecs(spring_now(), netPingTimings[playerNum]) >= 20) {
+				p.SendData(CBaseNetProtocol::Get().SendPing(relayPlayerNum, inbuf[2], *(reinterpret_cast<const float*>(&inbuf[3]))));
+				netPingTimings[playerNum] = spring_now();
+			}
+		} break;
+
+		case NETMSG_CPU_USAGE: {
+			p.cpuUsage = *((float*) &inbuf[1]);
+		} break;
+
+		case NETMSG_PLAYERNAME: {
+			p.myState = GameParticipant::INGAME;
+			Message(spring::format(PlayerJoined, p.GetType(), p.name.c_str()), false);
+		} break;
+
+		case NETMSG_QUIT: {
+			Message(spring::format(PlayerLeft, p.GetType(), p.name.c_str(), " normal quit"), false);
+			p.Kill("[GameServer] user exited", true);
+		} break;
+
+		default: {
+		} break;
+	}
+}
+
 void CGameServer::Broadcast(std::shared_ptr<const netcode::RawPacket> packet)
+{
+	// a relay only passes on the upstream stream (see ReadRelayData); its own
+	// bookkeeping would refer to client numbers that stream knows nothing of
+	if (IsRelay() && packet->data[0] != NETMSG_QUIT)
+		return;
+
+	BroadcastPacket(packet);
+}
+
+void CGameServer::BroadcastPacket(std::shared_ptr<const netcode::RawPacket> packet)
 {
 	for (GameParticipant& p: players) {
 		p.SendData(packet);
 	}
 
-	if (canReconnect || allowSpecJoin || !gameHasStarted)
+	if (canReconnect || allowSpecJoin || !gameHasStarted || IsRelay()) {
 		packetCache.push_back(packet);
+		packetCacheBytes += (sizeof(netcode::RawPacket) + packet->length);
+	}
 
 	if (demoRecorder != nullptr)
 		demoRecorder->SaveToDemo(packet->data, packet->length, GetDemoTime());
@@ -730,6 +979,21 @@ void CGameServer::CheckSync()
 				spring::exitCode = spring::EXIT_CODE_DESYNC;
 				#endif
 
+				if (hostif != nullptr) {
+					std::vector< std::pair<unsigned char, std::uint32_t> > desyncedPlayers;
+
+					for (const auto& desyncGroup: desyncGroups) {
+						for (const int playerNum: desyncGroup.second) {
+							desyncedPlayers.emplace_back(playerNum, desyncGroup.first);
+						}
+					}
+					for (const auto& p: desyncSpecs) {
+						desyncedPlayers.emplace_back(p.first, p.second);
+					}
+
+					hostif->SendDesync(outstandingSyncFrame, correctChecksum, desyncedPlayers);
+				}
+
 				// For each group, output a message with list of player names in it.
 				// TODO this should be linked to the resync system so it can roundrobin
 				// the resync checksum request packets to multiple clients in the same group.
@@ -762,6 +1026,7 @@ void CGameServer::CheckSync()
 		++outstandingSyncFrameIt;
 	}
 
+	CheckSyncTree();
 #else
 
 	// Make it clear this build isn't suitable for release.
@@ -773,6 +1038,119 @@ void CGameServer::CheckSync()
 }
 
 
+void CGameServer::CheckSyncTree()
+{
+#ifdef SYNCCHECK
+	constexpr size_t maxReportedDiffs = 8;
+
+	std::map<std::vector<std::uint32_t>, std::vector<int>> hashGroups; // <hashes, [players]>
+	std::vector<unsigned int> diffs;
+
+	for (auto checkIt = syncTreeChecks.begin(); checkIt != syncTreeChecks.end(); ) {
+		const int frameNum = checkIt->first.first;
+		const int node = checkIt->first.second;
+		const SyncTreeCheck& check = checkIt->second;
+
+		const auto hasResponded = [&](int p) { return (check.hashes.find(p) != check.hashes.end() || players[p].clientLink == nullptr); };
+
+		if (serverFrameNum < check.deadline && !std::all_of(check.players.begin(), check.players.end(), hasResponded)) {
+			++checkIt;
+			continue;
+		}
+
+		hashGroups.clear();
+
+		// empty responses come from clients that already replaced the requested hashes
+		for (const auto& p: check.hashes) {
+			if (!p.second.empty())
+				hashGroups[p.second].push_back(p.first);
+		}
+
+		// same baseline as CheckSync: the local client's hashes, else what most players agree on
+		auto refGroupIt = hashGroups.end();
+
+		for (auto groupIt = hashGroups.begin(); groupIt != hashGroups.end(); ++groupIt) {
+			const std::vector<int>& groupPlayers = groupIt->second;
+
+			if (HasLocalClient() && std::find(groupPlayers.begin(), groupPlayers.end(), localClientNumber) != groupPlayers.end()) {
+				refGroupIt = groupIt;
+				break;
+			}
+
+			if (refGroupIt == hashGroups.end() || groupPlayers.size() > refGroupIt->second.size())
+				refGroupIt = groupIt;
+		}
+
+		for (auto groupIt = hashGroups.begin(); groupIt != hashGroups.end(); ++groupIt) {
+			if (groupIt == refGroupIt)
+				continue;
+
+			const std::vector<std::uint32_t>& refHashes = refGroupIt->first;
+			const std::vector<std::uint32_t>& hashes = groupIt->first;
+
+			diffs.clear();
+
+			for (size_t i = 0, n = std::max(refHashes.size(), hashes.size()); i < n; i++) {
+				if (i >= refHashes.size() || i >= hashes.size() || refHashes[i] != hashes[i])
+					diffs.push_back(i);
+			}
+
+			std::string diffNames;
+
+			for (size_t i = 0; i < std::min(diffs.size(), maxReportedDiffs); i++) {
+				diffNames += (i > 0)? ", ": "";
+				diffNames += (node == SYNCTREE_NODE_ROOT)? CSyncTree::GetNodeName(diffs[i]): CSyncTree::GetChildName(node, diffs[i]);
+			}
+
+			if (diffs.size() > maxReportedDiffs)
+				diffNames += spring::format(" and %u more", unsigned(diffs.size() - maxReportedDiffs));
+
+			Message(spring::format(SyncTreeError, GetPlayerNames(groupIt->second).c_str(), frameNum, diffNames.c_str()));
+
+			if (node != SYNCTREE_NODE_ROOT)
+				continue;
+
+			// once per game, since every dump is a full copy of the synced state
+			if (syncTreeDumpFrame < 0 && configHandler->GetBool("SyncTreeStateDumps")) {
+				syncTreeDumpFrame = serverFrameNum + GAME_SPEED;
+
+				for (size_t p = 0; p < players.size(); ++p) {
+					if (players[p].clientLink != nullptr)
+						players[p].SendData(CBaseNetProtocol::Get().SendSyncTree(SERVER_PLAYER, syncTreeDumpFrame, SYNCTREE_NODE_DUMP, {}));
+				}
+
+				Message(spring::format(SyncTreeDumpRequest, syncTreeDumpFrame));
+			}
+
+			// drill down: ask these players and one reference player for the children of each differing node
+			for (const unsigned int diffNode: diffs) {
+				if (!CSyncTree::HasChildren(diffNode))
+					continue;
+
+				SyncTreeCheck& childCheck = syncTreeChecks[std::make_pair(frameNum, int(diffNode))];
+
+				if (childCheck.players.empty())
+					childCheck.deadline = serverFrameNum + SYNCCHECK_TIMEOUT;
+
+				std::vector<int> askPlayers = groupIt->second;
+				askPlayers.push_back(refGroupIt->second.front());
+
+				for (const int p: askPlayers) {
+					if (std::find(childCheck.players.begin(), childCheck.players.end(), p) != childCheck.players.end())
+						continue;
+
+					childCheck.players.push_back(p);
+					players[p].SendData(CBaseNetProtocol::Get().SendSyncTree(SERVER_PLAYER, frameNum, diffNode, {}));
+				}
+			}
+		}
+
+		checkIt = syncTreeChecks.erase(checkIt);
+	}
+#endif
+}
+
+
 float CGameServer::GetDemoTime() const {
 	if (!gameHasStarted) return gameTime;
 	return (startTime + serverFrameNum / float(GAME_SPEED));
@@ -821,15 +1199,16 @@ void CGameServer::Update()
 		}
 	}
 
-	if (!gameHasStarted)
+	if (IsRelay())
+		ReadRelayData();
+	else if (!gameHasStarted)
 		CheckForGameStart();
 	else if (!PreSimFrame() || demoReader != nullptr)
 		CreateNewFrame(true, false);
 
 	if (hostif != nullptr) {
-		const std::string msg = hostif->GetChatMessage();
-
-		if (!msg.empty()) {
+		// a stream can deliver several messages per update, a datagram socket queues them
+		for (std::string msg = hostif->GetChatMessage(); !msg.empty(); msg = hostif->GetChatMessage()) {
 			if (msg.at(0) != '/') { // normal chat message
 				GotChatMessage(ChatMessage(SERVER_PLAYER, ChatMessage::TO_EVERYONE, msg));
 			}
@@ -843,7 +1222,8 @@ void CGameServer::Update()
 	}
 
 	const bool pregameTimeoutReached = (spring_gettime() > (serverStartTime + spring_secs(globalConfig.initialNetworkTimeout)));
-	const bool canCheckForPlayers = (pregameTimeoutReached || gameHasStarted);
+	// a relay keeps running without clients for as long as its upstream does
+	const bool canCheckForPlayers = ((pregameTimeoutReached || gameHasStarted) && !IsRelay());
 
 	if (canCheckForPlayers) {
 		bool hasPlayers = false;
@@ -856,6 +1236,10 @@ void CGameServer::Update()
 		if ((quitServer = (quitServer || !hasPlayers)))
 			Message(NoClientsExit);
 	}
+
+	// one write for everything this update (and the preceding ServerReadNet) produced
+	if (hostif != nullptr)
+		hostif->Flush();
 }
 
 
@@ -864,17 +1248,22 @@ void CGameServer::LagProtection()
 {
 	std::vector<float> cpu;
 	std::vector<int> ping;
+	std::vector<float> maxSpeeds;
 	cpu.reserve(players.size());
 	ping.reserve(players.size());
+	maxSpeeds.reserve(players.size());
 
-	// detect reference cpu usage ( highest )
-	float refCpuUsage = 0.0f;
 	for (GameParticipant& player: players) {
 		if (player.myState == GameParticipant::INGAME) {
+			const GameParticipant::ClientStats& stats = player.clientStats;
+
 			// send info about the players
 			const int curPing = ((serverFrameNum - player.lastFrameResponse) * 1000) / (GAME_SPEED * internalSpeed);
 			Broadcast(CBaseNetProtocol::Get().SendPlayerInfo(player.id, player.cpuUsage, curPing));
 
+			if (hostif != nullptr)
+				hostif->SendPlayerStats(player.id, player.cpuUsage, curPing, stats.simFrameTimeMedian, stats.simFrameTimeP95, stats.drawFrameTime, stats.numQueuedSimFrames);
+
 			const float playerCpuUsage = player.cpuUsage;
 			const float correctedCpu   = Clamp(playerCpuUsage, 0.0f, 1.0f);
 
@@ -882,14 +1271,19 @@ void CGameServer::LagProtection()
 				player.isReconn = false;
 
 			if ((player.isLocal) || (demoReader ? !player.isFromDemo : !player.spectator)) {
-				if (!player.isReconn && correctedCpu > refCpuUsage)
-					refCpuUsage = correctedCpu;
 				cpu.push_back(correctedCpu);
 				ping.push_back(curPing);
+
+				// a reconnecting client is still catching up and must not drag the speed down
+				if (!player.isReconn)
+					maxSpeeds.push_back(PredictMaxSpeed(player, correctedCpu));
 			}
 		}
 	}
 
+	if (hostif != nullptr)
+		hostif->SendMemoryStats(CMemoryStats::GetResidentBytes(), CMemoryStats::GetPeakResidentBytes(), packetCacheBytes, memoryStats.GetSnapshot());
+
 	// calculate median values
 	medianCpu = 0.0f;
 	medianPing = 0;
@@ -904,40 +1298,89 @@ void CGameServer::LagProtection()
 			medianCpu = (medianCpu + cpu[midpos - 1]) / 2.0f;
 			medianPing = (medianPing + ping[midpos - 1]) / 2;
 		}
-		refCpuUsage = medianCpu;
 	}
 
+	if (hostif != nullptr) {
+		const int maxPing = ping.empty()? 0: *std::max_element(ping.begin(), ping.end());
+		hostif->SendFrameStats(serverFrameNum, userSpeedFactor, internalSpeed, medianCpu, medianPing, maxPing, isPaused);
+	}
+
+	if (maxSpeeds.empty() || isPaused)
+		return;
+
 	// adjust game speed
-	if (refCpuUsage > 0.0f && !isPaused) {
-		//userSpeedFactor holds the wanted speed adjusted manually by user ( normally 1)
-		//internalSpeed holds the current speed the sim is running
-		//refCpuUsage holds the highest cpu if curSpeedCtrl == 0 or median if curSpeedCtrl == 1
+	//userSpeedFactor holds the wanted speed adjusted manually by user ( normally 1)
+	//internalSpeed holds the current speed the sim is running
+	//wantedSpeed is what the slowest client can sustain if curSpeedCtrl == 0, or the median one if curSpeedCtrl == 1
+	std::sort(maxSpeeds.begin(), maxSpeeds.end());
+
+	float wantedSpeed = maxSpeeds[0];
 
-		// aim for 60% cpu usage if median is used as reference and 75% cpu usage if max is the reference
-		float wantedCpuUsage = (curSpeedCtrl == 1) ?  0.60f : 0.75f;
+	if (curSpeedCtrl == 1) {
+		const size_t midpos = maxSpeeds.size() / 2;
 
-		//the following line can actually make it go faster than wanted normal speed ( userSpeedFactor )
-		//if the current cpu of the target is smaller than the aimed cpu target but the clamp will cap it
-		// the clamp will throttle it to the wanted one, otherwise it's a simple linear proportion aiming
-		// to keep cpu load constant
-		float newSpeed = internalSpeed / refCpuUsage * wantedCpuUsage;
+		if ((maxSpeeds.size() & 1) != 0) {
+			wantedSpeed = maxSpeeds[midpos];
+		} else {
+			wantedSpeed = (maxSpeeds[midpos] + maxSpeeds[midpos - 1]) * 0.5f;
+		}
+	}
 
-		newSpeed = Clamp(newSpeed, 0.1f, userSpeedFactor);
-		//average to smooth the speed change over time to reduce the impact of cpu spikes in the players
-		newSpeed = (newSpeed + internalSpeed) * 0.5f;
+	wantedSpeed = Clamp(wantedSpeed, 0.1f, userSpeedFactor);
 
 #ifndef DEDICATED
-		// in non-dedicated hosting, we'll add an additional safeguard to make sure the host can keep up with the game's speed
-		// adjust game speed to localclient's (:= host) maximum SimFrame rate
-		const float invSimDrawFract = 1.0f - CGlobalUnsynced::reconnectSimDrawBalance;
-		const float maxSimFrameRate = (1000.0f / gu->avgSimFrameTime) * invSimDrawFract;
+	// in non-dedicated hosting, we'll add an additional safeguard to make sure the host can keep up with the game's speed
+	// adjust game speed to localclient's (:= host) maximum SimFrame rate
+	const float invSimDrawFract = 1.0f - CGlobalUnsynced::reconnectSimDrawBalance;
+	const float maxSimFrameRate = (1000.0f / gu->avgSimFrameTime) * invSimDrawFract;
 
-		newSpeed = Clamp(newSpeed, 0.1f, ((maxSimFrameRate / GAME_SPEED) + internalSpeed) * 0.5f);
+	wantedSpeed = Clamp(wantedSpeed, 0.1f, maxSimFrameRate / GAME_SPEED);
 #endif
 
-		if (newSpeed != internalSpeed)
-			InternalSpeedChange(newSpeed);
+	const float speedDelta = wantedSpeed - internalSpeed;
+
+	// every change is broadcast and re-times all clients, ignore jitter below 2%
+	// (unless that is all that is left on the way back up to the user's speed)
+	if (std::fabs(speedDelta) < (internalSpeed * 0.02f) && wantedSpeed < userSpeedFactor)
+		return;
+
+	// slow down at once since some client is about to fall behind, but speed up in
+	// steps; averaging both ways made one load spike swing the speed back and forth
+	float newSpeed = wantedSpeed;
+
+	if (speedDelta > 0.0f)
+		newSpeed = std::min(wantedSpeed, internalSpeed + std::max(speedDelta * 0.25f, internalSpeed * 0.02f));
+
+	if (newSpeed != internalSpeed)
+		InternalSpeedChange(newSpeed);
+}
+
+float CGameServer::PredictMaxSpeed(const GameParticipant& player, float cpuUsage) const
+{
+	const GameParticipant::ClientStats& stats = player.clientStats;
+
+	// aim for 60% cpu usage if median is used as reference and 75% cpu usage if max is the reference
+	const float wantedCpuUsage = (curSpeedCtrl == 1) ?  0.60f : 0.75f;
+
+	// proportional to the averaged load until the client reports its frame times
+	float maxSpeed = (cpuUsage > 0.0f)? (internalSpeed / cpuUsage * wantedCpuUsage): userSpeedFactor;
+
+	if (stats.simFrameTimeP95 > 0.0f) {
+		// frames get more expensive as a game grows; extrapolate half of the last
+		// rise so the speed drops before the client saturates rather than after
+		const float simFrameTime = stats.simFrameTimeP95 + std::max(0.0f, stats.simFrameTimeP95 - stats.prevSimFrameTimeP95) * 0.5f;
+		// time per second left for simulation after the minimum number of draw frames
+		const float simTimeBudget = std::max(0.0f, 1000.0f - CGlobalUnsynced::minDrawFPS * stats.drawFrameTime) * wantedCpuUsage;
+
+		maxSpeed = simTimeBudget / (simFrameTime * GAME_SPEED);
 	}
+
+	// more than a second of frames queued up means it already fell behind; leave
+	// it enough slack to catch up within about a second
+	if (stats.numQueuedSimFrames > GAME_SPEED)
+		maxSpeed = std::min(maxSpeed, internalSpeed * GAME_SPEED / stats.numQueuedSimFrames);
+
+	return maxSpeed;
 }
 
 
@@ -1016,6 +1459,11 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 	const unsigned a = playerNum;
 	const unsigned msgCode = (unsigned) inbuf[0];
 
+	if (IsRelay()) {
+		ProcessRelayViewerPacket(playerNum, packet);
+		return;
+	}
+
 	switch (msgCode) {
 		case NETMSG_KEYFRAME: {
 			const int frameNum = *(int*) &inbuf[1];
@@ -1073,6 +1521,28 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 			players[a].cpuUsage = *((float*) &inbuf[1]);
 			break;
 
+		case NETMSG_CLIENT_STATS: {
+			try {
+				netcode::UnpackPacket pckt(packet, 1);
+				GameParticipant::ClientStats& stats = players[a].clientStats;
+
+				float simFrameTimeP95 = 0.0f;
+				uint16_t numQueuedSimFrames = 0;
+
+				pckt >> stats.simFrameTimeMedian;
+				pckt >> simFrameTimeP95;
+				pckt >> stats.drawFrameTime;
+				pckt >> numQueuedSimFrames;
+
+				// the first report has nothing to compare against
+				stats.prevSimFrameTimeP95 = (stats.simFrameTimeP95 > 0.0f)? stats.simFrameTimeP95: simFrameTimeP95;
+				stats.simFrameTimeP95 = simFrameTimeP95;
+				stats.numQueuedSimFrames = numQueuedSimFrames;
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Player %s sent invalid ClientStats: %s", players[a].name.c_str(), ex.what()));
+			}
+		} break;
+
 		case NETMSG_QUIT: {
 			Message(spring::format(PlayerLeft, players[a].GetType(), players[a].name.c_str(), " normal quit"));
 			Broadcast(CBaseNetProtocol::Get().SendPlayerLeft(a, 1));
@@ -1199,6 +1669,7 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 			break;
 
 		case NETMSG_SELECT:
+		case NETMSG_SELECT_PACKED:
 			try {
 				netcode::UnpackPacket pckt(packet, 3);
 				unsigned char playerNum;
@@ -1348,6 +1819,50 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 #endif
 		} break;
 
+		case NETMSG_SYNCTREE: {
+#ifdef SYNCCHECK
+			try {
+				netcode::UnpackPacket pckt(packet, 3);
+
+				uint8_t playerNum; pckt >> playerNum;
+				int32_t  frameNum; pckt >> frameNum;
+				uint8_t      node; pckt >> node;
+
+				if (playerNum != a) {
+					Message(spring::format(WrongPlayer, msgCode, a, (unsigned)playerNum));
+					break;
+				}
+
+				std::vector<std::uint32_t> hashes((packet->length - 9) / sizeof(std::uint32_t));
+				pckt >> hashes;
+
+				const auto key = std::make_pair(int(frameNum), int(node));
+				auto checkIt = syncTreeChecks.find(key);
+
+				if (checkIt == syncTreeChecks.end()) {
+					// child hashes are only accepted when requested
+					if (node != SYNCTREE_NODE_ROOT || frameNum > serverFrameNum || (frameNum % CSyncTree::UPDATE_INTERVAL) != 0)
+						break;
+
+					checkIt = syncTreeChecks.emplace(key, SyncTreeCheck()).first;
+					checkIt->second.deadline = serverFrameNum + SYNCCHECK_TIMEOUT;
+
+					for (const GameParticipant& p: players) {
+						if (p.clientLink != nullptr && p.myState == GameParticipant::INGAME)
+							checkIt->second.players.push_back(p.id);
+					}
+				}
+
+				SyncTreeCheck& check = checkIt->second;
+
+				if (std::find(check.players.begin(), check.players.end(), a) != check.players.end())
+					check.hashes[a] = std::move(hashes);
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Player %s sent invalid SyncTree: %s", players[a].name.c_str(), ex.what()));
+			}
+#endif
+		} break;
+
 		case NETMSG_SHARE:
 			if (inbuf[1] != a) {
 				Message(spring::format(WrongPlayer, msgCode, a, (unsigned)inbuf[1]));
@@ -2142,8 +2657,10 @@ void CGameServer::StartGame(bool forced)
 	gameHasStarted = true;
 	startTime = gameTime;
 
-	if (!canReconnect && !allowSpecJoin)
+	if (!canReconnect && !allowSpecJoin) {
 		packetCache.clear(); // free memory
+		packetCacheBytes = 0;
+	}
 
 	if (udpListener && !canReconnect && !allowSpecJoin)
 		udpListener->SetAcceptingConnections(false); // do not accept new connections
@@ -2155,6 +2672,12 @@ void CGameServer::StartGame(bool forced)
 		// the client told us to start a demo
 		// no need to send startPos and startplaying since its in the demo
 		Message(DemoStart);
+
+		if (myClientSetup->demoKeyframe >= 0) {
+			SkipToKeyframe(myClientSetup->demoKeyframe, myClientSetup->demoStartFrame);
+		} else if (myClientSetup->demoStartFrame > 0) {
+			SkipTo(myClientSetup->demoStartFrame);
+		}
 		return;
 	}
 
@@ -2430,7 +2953,15 @@ void CGameServer::PushAction(const Action& action, bool fromAutoHost)
 			// the absolute frame to skip to
 			const int endFrame = skipFrames? amount: (GAME_SPEED * amount);
 
-			SkipTo(endFrame + (serverFrameNum * skipRelative));
+			const int targetFrame = endFrame + (serverFrameNum * skipRelative);
+
+			if (gameHasStarted && ReloadForSkip(targetFrame)) {
+				CommandMessage reloadMsg(spring::format("skip reload %d", targetFrame), SERVER_PLAYER);
+				players[localClientNumber].SendData(std::shared_ptr<const netcode::RawPacket>(reloadMsg.Pack()));
+				return;
+			}
+
+			SkipTo(targetFrame);
 		} break;
 
 		case hashString("cheat"): {
@@ -2536,6 +3067,10 @@ bool CGameServer::HasFinished() const
 
 void CGameServer::CreateNewFrame(bool fromServerThread, bool fixedFrameTime)
 {
+	// frames come from upstream
+	if (IsRelay())
+		return;
+
 	if (demoReader != nullptr) {
 		CheckSync();
 		SendDemoData(-1);
@@ -2687,8 +3222,10 @@ void CGameServer::UpdateLoop()
 			Update();
 		}
 
-		if (hostif != nullptr)
+		if (hostif != nullptr) {
 			hostif->SendQuit();
+			hostif->Flush();
+		}
 
 		Broadcast(CBaseNetProtocol::Get().SendQuit("Server shutdown"));
 
@@ -2866,9 +3403,9 @@ unsigned CGameServer::BindConnection(
 			bool forceNewLink;
 		};
 
-		// find the player in the current list
+		// find the player in the current list; a relay's clients never take a player's place
 		const auto pred = [&clientName](const GameParticipant& gp) { return (clientName == gp.name); };
-		const auto iter = std::find_if(players.begin(), players.end(), pred);
+		const auto iter = IsRelay()? players.end(): std::find_if(players.begin(), players.end(), pred);
 
 		const auto GetConnectionFlags = [&](const GameParticipant& gp) -> ConnectionFlags {
 			if (gp.isFromDemo)
@@ -2916,7 +3453,7 @@ unsigned CGameServer::BindConnection(
 			if (!demoReader && allowSpecJoin)
 				clientName = "~" + clientName;
 
-			if (demoReader || allowSpecJoin)
+			if (demoReader || allowSpecJoin || IsRelay())
 				AddAdditionalUser(clientName, clientPassword);
 			else
 				errMsg = "User name not authorized to connect";
@@ -2959,7 +3496,7 @@ unsigned CGameServer::BindConnection(
 	}
 
 	// inform the player about himself if it's a midgame join
-	if (newPlayer.isMidgameJoin)
+	if (newPlayer.isMidgameJoin && !IsRelay())
 		clientLink->SendData(CBaseNetProtocol::Get().SendCreateNewPlayer(newPlayerNumber, newPlayer.spectator, newPlayer.team, newPlayer.name));
 
 	// there is an open link -> reconnect
@@ -2976,11 +3513,18 @@ unsigned CGameServer::BindConnection(
 	}
 
 	newPlayer.Connected(clientLink, isLocal);
-	newPlayer.SendData(std::shared_ptr<const RawPacket>(myGameData->Pack()));
-	newPlayer.SendData(CBaseNetProtocol::Get().SendSetPlayerNum((unsigned char)newPlayerNumber));
+
+	if (IsRelay()) {
+		// connections are only accepted once both have arrived
+		newPlayer.SendData(relayGameData);
+		newPlayer.SendData(CBaseNetProtocol::Get().SendSetPlayerNum((unsigned char)relayPlayerNum));
+	} else {
+		newPlayer.SendData(std::shared_ptr<const RawPacket>(myGameData->Pack()));
+		newPlayer.SendData(CBaseNetProtocol::Get().SendSetPlayerNum((unsigned char)newPlayerNumber));
+	}
 
 	// after gamedata and playerNum, the player can start loading
-	if (demoReader == nullptr || myGameSetup->demoName.empty()) {
+	if ((demoReader == nullptr || myGameSetup->demoName.empty()) && !IsRelay()) {
 		// player wants to play -> join team
 		if (!newPlayer.spectator) {
 			const unsigned newPlayerTeam = newPlayer.team;
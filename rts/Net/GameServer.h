@@ -31,6 +31,7 @@ namespace netcode
 {
 	class RawPacket;
 	class CConnection;
+	class UDPConnection;
 	class UDPListener;
 }
 class CDemoReader;
@@ -78,7 +79,7 @@ public:
 	static void Reload(const std::shared_ptr<const CGameSetup> newGameSetup);
 
 	void AddLocalClient(const std::string& myName, const std::string& myVersion, const std::string& myPlatform);
-	void AddAutohostInterface(const std::string& autohostIP, const int autohostPort);
+	void AddAutohostInterface(const std::string& autohostIP, const int autohostPort, const std::string& transport);
 
 	void Initialize();
 	/**
@@ -96,6 +97,7 @@ public:
 	bool HasStarted() const { return gameHasStarted; }
 	bool HasGameID() const { return generatedGameID; }
 	bool HasLocalClient() const { return (localClientNumber != -1u); }
+	bool IsRelay() const { return (relayLink != nullptr); }
 	/// Is the server still running?
 	bool HasFinished() const;
 
@@ -117,6 +119,9 @@ public:
 	const std::unique_ptr<CDemoReader>& GetDemoReader() const { return demoReader; }
 	const std::unique_ptr<CDemoRecorder>& GetDemoRecorder() const { return demoRecorder; }
 
+	/// size of the packets kept for reconnecting and late-joining clients, readable from any thread
+	std::uint64_t GetPacketCacheBytes() const { return packetCacheBytes.load(); }
+
 private:
 	/**
 	 * @brief relay chat messages to players / autohost
@@ -161,10 +166,13 @@ private:
 	void Update();
 	void ProcessPacket(const unsigned playerNum, std::shared_ptr<const netcode::RawPacket> packet);
 	void CheckSync();
+	void CheckSyncTree();
 	void HandleConnectionAttempts();
 	void ServerReadNet();
 
 	void LagProtection();
+	/// fastest speed the client of <player> is expected to sustain
+	float PredictMaxSpeed(const GameParticipant& player, float cpuUsage) const;
 
 	/** @brief Generate a unique game identifier and send it to all clients. */
 	void GenerateAndSendGameID();
@@ -173,7 +181,19 @@ private:
 	/// read data from demo and send it to clients
 	bool SendDemoData(int targetFrameNum);
 
+	/**
+	 * @brief relay mode: join the upstream server as a spectator
+	 * Its packet stream (GAMEDATA and SETPLAYERNUM excepted) is then passed
+	 * on to our own clients verbatim and cached for late joiners, while the
+	 * server generates no game traffic of its own. Every client plays the
+	 * role of our upstream spectator.
+	 */
+	void ConnectRelayHost();
+	void ReadRelayData();
+	void ProcessRelayViewerPacket(const unsigned playerNum, std::shared_ptr<const netcode::RawPacket> packet);
+
 	void Broadcast(std::shared_ptr<const netcode::RawPacket> packet);
+	void BroadcastPacket(std::shared_ptr<const netcode::RawPacket> packet);
 
 	/**
 	 * @brief skip frames
@@ -182,6 +202,16 @@ private:
 	 * targetFrame to all clients
 	 */
 	void SkipTo(int targetFrameNum);
+	/**
+	 * @brief skip to a demo keyframe clients have loaded the state of
+	 *
+	 * Fast-reads the demo stream up to where the keyframe was taken, passing
+	 * on only what its state does not contain, then skips until targetFrame
+	 */
+	void SkipToKeyframe(int keyframe, int targetFrameNum);
+	/// @return true iff the demo player reaches targetFrame sooner by restarting from a keyframe
+	bool ReloadForSkip(int targetFrameNum) const;
+	bool AddDemoPlayer(std::shared_ptr<const netcode::RawPacket> packet);
 
 	void Message(const std::string& message, bool broadcast = true, bool internal = false);
 	void PrivateMessage(int playerNum, const std::string& message);
@@ -222,10 +252,24 @@ private:
 	std::pair<std::string, std::string> refClientVersion;
 
 	std::deque< std::shared_ptr<const netcode::RawPacket> > packetCache;
+	std::atomic<std::uint64_t> packetCacheBytes = {0};
 
 	/////////////////// sync stuff ///////////////////
 #ifdef SYNCCHECK
 	std::set<int> outstandingSyncFrames;
+
+	/// hashes of one level of the sync tree (see CSyncTree) at one frame
+	struct SyncTreeCheck {
+		int deadline = 0;                                  ///< serverFrameNum after which missing responses are not waited for
+		std::vector<int> players;                          ///< expected to respond
+		std::map<int, std::vector<std::uint32_t>> hashes;  ///< <playerNum, hashes>
+	};
+
+	/// <{frameNum, node}, check>; node is SYNCTREE_NODE_ROOT for the top level
+	std::map<std::pair<int, int>, SyncTreeCheck> syncTreeChecks;
+
+	/// frame at which the clients were asked for state dumps, -1 if they were not
+	int syncTreeDumpFrame = -1;
 #endif
 
 	/////////////////// game status variables ///////////////////
@@ -285,6 +329,12 @@ private:
 	static std::array<std::string, 25> commandBlacklist;
 
 	std::unique_ptr<netcode::UDPListener> udpListener;
+
+	/// relay mode: the link to the upstream server and the game data it sent us
+	std::shared_ptr<netcode::UDPConnection> relayLink;
+	std::shared_ptr<const netcode::RawPacket> relayGameData;
+
+	int relayPlayerNum = -1;
 	std::unique_ptr<CDemoReader> demoReader;
 	std::unique_ptr<CDemoRecorder> demoRecorder;
 	std::unique_ptr<AutohostInterface> hostif;
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cinttypes>
 
 #include "Game/Game.h"
@@ -36,6 +37,8 @@
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Net/UnpackPacket.h"
 #include "System/Sound/ISound.h"
+#include "System/Sync/DumpState.h"
+#include "System/Sync/SyncTree.h"
 
 CONFIG(bool, LogClientData).defaultValue(false);
 
@@ -43,6 +46,10 @@ CONFIG(bool, LogClientData).defaultValue(false);
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_NET)
 
 static spring::unordered_map<int32_t, uint32_t> localSyncChecksums;
+#ifdef SYNCCHECK
+static CSyncTree localSyncTree;
+static int localStateDumpFrame = -1;
+#endif
 
 
 void CGame::AddTraffic(int playerID, int packetCode, int length)
@@ -80,6 +87,22 @@ void CGame::SendClientProcUsage()
 
 			// take the minimum drawframes into account, too
 			clientNet->Send(CBaseNetProtocol::Get().SendCPUUsage(totalProcUsage));
+
+			// the load above is an average, the server also wants to see the spikes
+			const size_t numSamples = std::min(size_t(numSimFrameTimes), simFrameTimes.size());
+
+			if (numSamples > 0) {
+				decltype(simFrameTimes) samples = simFrameTimes;
+				std::sort(samples.begin(), samples.begin() + numSamples);
+
+				const float medianSimFrameTime = samples[numSamples / 2];
+				const float p95SimFrameTime = samples[(numSamples * 95) / 100];
+				const uint16_t numQueuedFrames = Clamp(lastNumQueuedSimFrames, 0, 0xFFFF);
+
+				clientNet->Send(CBaseNetProtocol::Get().SendClientStats(medianSimFrameTime, p95SimFrameTime, gu->avgDrawFrameTime, numQueuedFrames));
+			}
+
+			numSimFrameTimes = 0;
 		} else {
 			// the CPU-load percentage is undefined prior to SimFrame()
 			clientNet->Send(CBaseNetProtocol::Get().SendCPUUsage(0.0f));
@@ -168,10 +191,21 @@ void CGame::UpdateNumQueuedSimFrames()
 			lastNumQueuedSimFrames = mix(lastNumQueuedSimFrames * 1.0f, numQueuedFrames * 1.0f, 0.1f);
 		}
 
+		// jitter buffer: running dry means frames arrive more unevenly (e.g. bundled
+		// by the server's links, see NetworkBundleLatency) than the buffer absorbs,
+		// so deepen it by a frame at once and let it shrink by one per ~10 seconds
+		if (netBufferUnderrun) {
+			numJitterBufferFrames = std::min(numJitterBufferFrames + 1.0f, GAME_SPEED * 0.5f);
+		} else {
+			numJitterBufferFrames = std::max(numJitterBufferFrames - 0.05f, 0.0f);
+		}
+
+		netBufferUnderrun = false;
+
 		// always stay a bit behind the actual server time
 		// at higher speeds we need to keep more distance!
 		// (because effect of network jitter is amplified)
-		consumeSpeedMult = GAME_SPEED * gs->speedFactor + lastNumQueuedSimFrames - (2 * gs->speedFactor);
+		consumeSpeedMult = GAME_SPEED * gs->speedFactor + lastNumQueuedSimFrames - ((2 + numJitterBufferFrames) * gs->speedFactor);
 	} else {
 		// Modified SPRING95 behaviour
 		// Aim at staying 2 sim frames behind.
@@ -275,8 +309,14 @@ void CGame::ClientReadNet()
 		// get netpacket from the queue
 		std::shared_ptr<const netcode::RawPacket> packet = clientNet->GetData(gs->frameNum);
 
-		if (packet == nullptr)
+		if (packet == nullptr) {
+			// there was time left to simulate a frame the server has not delivered yet
+			netBufferUnderrun |= (gameServer == nullptr && !skipping && !gs->paused && gs->frameNum > 0);
 			break;
+		}
+
+		// messages can change the synced state an asynchronous AI update reads
+		eoh->WaitForAsyncUpdate();
 
 		lastReceivedNetPacketTime = spring_gettime();
 
@@ -574,6 +614,17 @@ void CGame::ClientReadNet()
 				// reset checksum every 4096 frames =~ 2.5 minutes
 				if ((gs->frameNum & 4095) == 0)
 					CSyncChecker::NewFrame();
+
+				// the server compares these; a local one replaying a demo has no one to compare against
+				if (!haveServerDemo && (gs->frameNum % CSyncTree::UPDATE_INTERVAL) == 0) {
+					localSyncTree.Update(gs->frameNum);
+					clientNet->Send(CBaseNetProtocol::Get().SendSyncTree(gu->myPlayerNum, gs->frameNum, SYNCTREE_NODE_ROOT, localSyncTree.GetNodeHashes()));
+				}
+
+				if (gs->frameNum == localStateDumpFrame) {
+					DumpStateSnapshot(gu->myPlayerNum);
+					localStateDumpFrame = -1;
+				}
 #endif
 				AddTraffic(-1, packetCode, dataLength);
 			} break;
@@ -613,6 +664,35 @@ void CGame::ClientReadNet()
 			} break;
 
 
+			case NETMSG_SYNCTREE: {
+#ifdef SYNCCHECK
+				try {
+					netcode::UnpackPacket pckt(packet, 3);
+
+					uint8_t playerNum; pckt >> playerNum;
+					int32_t  frameNum; pckt >> frameNum;
+					uint8_t      node; pckt >> node;
+
+					if (node == SYNCTREE_NODE_DUMP) {
+						// dumped once the frame is simulated, nothing to answer
+						localStateDumpFrame = frameNum;
+						LOG("[Game::%s] server requested a state dump of frame %d", __func__, frameNum);
+					} else {
+						// server requests the child hashes of <node>; answer with none if they were replaced
+						static const std::vector<uint32_t> noHashes;
+
+						const bool haveChildren = (frameNum == localSyncTree.GetFrameNum() && node < SYNCTREE_NUM_NODES);
+						const std::vector<uint32_t>& childHashes = haveChildren? localSyncTree.GetChildHashes(node): noHashes;
+
+						clientNet->Send(CBaseNetProtocol::Get().SendSyncTree(gu->myPlayerNum, frameNum, node, childHashes));
+					}
+				} catch (const netcode::UnpackPacketException& ex) {
+					LOG_L(L_ERROR, "[Game::%s][NETMSG_SYNCTREE] exception \"%s\"", __func__, ex.what());
+				}
+#endif
+				AddTraffic(-1, packetCode, dataLength);
+			} break;
+
 			case NETMSG_COMMAND: {
 				try {
 					netcode::UnpackPacket pckt(packet, 1);
@@ -648,7 +728,8 @@ void CGame::ClientReadNet()
 				}
 			} break;
 
-			case NETMSG_SELECT: {
+			case NETMSG_SELECT:
+			case NETMSG_SELECT_PACKED: {
 				try {
 					netcode::UnpackPacket pckt(packet, 1);
 					std::vector<int32_t> selectedUnitIDs;
@@ -656,29 +737,66 @@ void CGame::ClientReadNet()
 					uint16_t packetSize; pckt >> packetSize;
 					uint8_t playerNum; pckt >> playerNum;
 
-					const uint32_t numUnitIDs = (packetSize - 4) / sizeof(int16_t);
-
 					if (!playerHandler.IsValidPlayer(playerNum))
 						throw netcode::UnpackPacketException("Invalid player number");
 
 					const CPlayer* netPlayer = playerHandler.Player(playerNum);
-					const CUnit* unit = nullptr;
-
-					selectedUnitIDs.reserve(numUnitIDs);
 
-					for (uint32_t a = 0; a < numUnitIDs; ++a) {
-						int16_t unitID; pckt >> unitID;
+					const auto SelectUnit = [&](int unitID) {
+						const CUnit* unit = unitHandler.GetUnit(unitID);
 
 						// unit was destroyed in simulation (without its ID being recycled)
 						// after sending a command but before receiving it back, more likely
 						// to happen in high-latency situations
 						// LOG_L(L_WARNING, "[NETMSG_SELECT] invalid unitID (%i) from player %i", unitID, playerNum);
-						if ((unit = unitHandler.GetUnit(unitID)) == nullptr)
-							continue;
+						if (unit == nullptr)
+							return;
 
 						// if in (full) godMode, this is always true for any player
 						if (netPlayer->CanControlTeam(unit->team))
 							selectedUnitIDs.push_back(unitID);
+					};
+
+					if (packetCode == NETMSG_SELECT) {
+						const uint32_t numUnitIDs = (packetSize - 4) / sizeof(int16_t);
+
+						selectedUnitIDs.reserve(numUnitIDs);
+
+						for (uint32_t a = 0; a < numUnitIDs; ++a) {
+							int16_t unitID; pckt >> unitID;
+							SelectUnit(unitID);
+						}
+					} else {
+						uint8_t encoding; pckt >> encoding;
+
+						switch (encoding) {
+							case SELECT_RANGES: {
+								for (uint32_t a = 0, n = (packetSize - 5) / (sizeof(int16_t) + sizeof(uint16_t)); a < n; ++a) {
+									int16_t firstUnitID; pckt >> firstUnitID;
+									uint16_t numUnitIDs; pckt >> numUnitIDs;
+
+									// GetUnit rejects IDs past the end, no need to walk beyond it
+									for (int unitID = firstUnitID, lastUnitID = std::min(firstUnitID + numUnitIDs, int(unitHandler.MaxUnits())); unitID < lastUnitID; ++unitID) {
+										SelectUnit(unitID);
+									}
+								}
+							} break;
+							case SELECT_BITSET: {
+								int16_t firstUnitID; pckt >> firstUnitID;
+
+								for (uint32_t a = 0, n = packetSize - 7; a < n; ++a) {
+									uint8_t unitBits; pckt >> unitBits;
+
+									for (int b = 0; b < 8; ++b) {
+										if ((unitBits & (1 << b)) != 0)
+											SelectUnit(firstUnitID + a * 8 + b);
+									}
+								}
+							} break;
+							default: {
+								throw netcode::UnpackPacketException("Invalid unit-ID encoding");
+							} break;
+						}
 					}
 
 					selectedUnitsHandler.NetSelect(selectedUnitIDs, playerNum);
@@ -7,6 +7,7 @@
 #include "System/Net/RawPacket.h"
 #include "System/Net/PackPacket.h"
 #include "System/Net/ProtocolDef.h"
+#include <algorithm>
 #include <cinttypes>
 
 using netcode::PackPacket;
@@ -101,11 +102,66 @@ PacketType CBaseNetProtocol::SendSelect(uint8_t playerNum, const std::vector<int
 	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
 	const uint32_t packetSize = headerSize + payloadSize;
 
+	if (!selectedUnitIDs.empty()) {
+		int16_t minUnitID = selectedUnitIDs[0];
+		int16_t maxUnitID = selectedUnitIDs[0];
+
+		uint32_t numRanges = 1;
+
+		for (size_t i = 1, n = selectedUnitIDs.size(); i < n; i++) {
+			minUnitID = std::min(minUnitID, selectedUnitIDs[i]);
+			maxUnitID = std::max(maxUnitID, selectedUnitIDs[i]);
+			numRanges += (selectedUnitIDs[i] != (selectedUnitIDs[i - 1] + 1));
+		}
+
+		const uint32_t packedHeaderSize = headerSize + sizeof(playerNum) + sizeof(uint8_t);
+		const uint32_t rangesSize = packedHeaderSize + numRanges * (sizeof(int16_t) + sizeof(uint16_t));
+		const uint32_t bitsetSize = packedHeaderSize + sizeof(int16_t) + (maxUnitID - minUnitID) / 8 + 1;
+
+		if (rangesSize < std::min(packetSize, bitsetSize))
+			return (SendSelectRanges(playerNum, selectedUnitIDs, rangesSize));
+		if (bitsetSize < packetSize)
+			return (SendSelectBitset(playerNum, selectedUnitIDs, bitsetSize, minUnitID, maxUnitID));
+	}
+
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_SELECT);
 	*packet << static_cast<uint16_t>(packetSize) << playerNum << selectedUnitIDs;
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendSelectRanges(uint8_t playerNum, const std::vector<int16_t>& selectedUnitIDs, uint32_t packetSize)
+{
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_SELECT_PACKED);
+	*packet << static_cast<uint16_t>(packetSize) << playerNum << static_cast<uint8_t>(SELECT_RANGES);
+
+	for (size_t i = 0, n = selectedUnitIDs.size(); i < n; ) {
+		size_t j = i + 1;
+
+		while (j < n && selectedUnitIDs[j] == (selectedUnitIDs[j - 1] + 1)) {
+			j++;
+		}
+
+		*packet << selectedUnitIDs[i] << static_cast<uint16_t>(j - i);
+		i = j;
+	}
+
+	return PacketType(packet);
+}
+
+PacketType CBaseNetProtocol::SendSelectBitset(uint8_t playerNum, const std::vector<int16_t>& selectedUnitIDs, uint32_t packetSize, int16_t minUnitID, int16_t maxUnitID)
+{
+	std::vector<uint8_t> unitBits((maxUnitID - minUnitID) / 8 + 1, 0);
+
+	for (const int16_t unitID: selectedUnitIDs) {
+		unitBits[(unitID - minUnitID) >> 3] |= (1 << ((unitID - minUnitID) & 7));
+	}
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_SELECT_PACKED);
+	*packet << static_cast<uint16_t>(packetSize) << playerNum << static_cast<uint8_t>(SELECT_BITSET);
+	*packet << minUnitID << unitBits;
+	return PacketType(packet);
+}
+
 
 PacketType CBaseNetProtocol::SendPause(uint8_t playerNum, uint8_t bPaused)
 {
@@ -219,6 +275,13 @@ PacketType CBaseNetProtocol::SendCPUUsage(float cpuUsage)
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendClientStats(float simFrameTimeMedian, float simFrameTimeP95, float drawFrameTime, uint16_t numQueuedSimFrames)
+{
+	PackPacket* packet = new PackPacket(sizeof(uint8_t) + 3 * sizeof(float) + sizeof(numQueuedSimFrames), NETMSG_CLIENT_STATS);
+	*packet << simFrameTimeMedian << simFrameTimeP95 << drawFrameTime << numQueuedSimFrames;
+	return PacketType(packet);
+}
+
 PacketType CBaseNetProtocol::SendDirectControl(uint8_t playerNum)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum), NETMSG_DIRECT_CONTROL);
@@ -383,6 +446,18 @@ PacketType CBaseNetProtocol::SendSyncResponse(uint8_t playerNum, int32_t frameNu
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendSyncTree(uint8_t playerNum, int32_t frameNum, uint8_t node, const std::vector<uint32_t>& hashes)
+{
+	const uint32_t packetSize = sizeof(uint8_t) + sizeof(uint16_t) + sizeof(playerNum) + sizeof(frameNum) + sizeof(node) + hashes.size() * sizeof(uint32_t);
+
+	if (packetSize >= (1 << (sizeof(uint16_t) * 8)))
+		throw netcode::PackPacketException("[BaseNetProto::SendSyncTree] maximum packet-size exceeded");
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_SYNCTREE);
+	*packet << static_cast<uint16_t>(packetSize) << playerNum << frameNum << node << hashes;
+	return PacketType(packet);
+}
+
 PacketType CBaseNetProtocol::SendSystemMessage(uint8_t playerNum, std::string message)
 {
 	if (message.size() > 65000) {
@@ -625,6 +700,7 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_PATH_CHECKSUM, 1 + 1 + sizeof(uint32_t));
 	proto->AddType(NETMSG_COMMAND, -2);
 	proto->AddType(NETMSG_SELECT, -2);
+	proto->AddType(NETMSG_SELECT_PACKED, -2);
 	proto->AddType(NETMSG_PAUSE, 3);
 
 	proto->AddType(NETMSG_AICOMMAND, -2);
@@ -635,6 +711,7 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_USER_SPEED, 6);
 	proto->AddType(NETMSG_INTERNAL_SPEED, 5);
 	proto->AddType(NETMSG_CPU_USAGE, 5);
+	proto->AddType(NETMSG_CLIENT_STATS, 1 + 3 * 4 + 2);
 	proto->AddType(NETMSG_DIRECT_CONTROL, 2);
 	proto->AddType(NETMSG_DC_UPDATE, 7);
 	proto->AddType(NETMSG_ATTEMPTCONNECT, -2);
@@ -646,6 +723,7 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_GAMEOVER, -1);
 	proto->AddType(NETMSG_MAPDRAW, -1);
 	proto->AddType(NETMSG_SYNCRESPONSE, 10);
+	proto->AddType(NETMSG_SYNCTREE, -2);
 	proto->AddType(NETMSG_SYSTEMMSG, -2);
 	proto->AddType(NETMSG_STARTPOS, 16);
 	proto->AddType(NETMSG_PLAYERINFO, 10);
@@ -51,6 +51,7 @@ public:
 	PacketType SendRandSeed(uint32_t randSeed);
 	PacketType SendGameID(const uint8_t* buf);
 	PacketType SendPathCheckSum(uint8_t playerNum, uint32_t checksum);
+	/// sends a NETMSG_SELECT_PACKED instead if that is smaller, best when the IDs are sorted
 	PacketType SendSelect(uint8_t playerNum, const std::vector<int16_t>& selectedUnitIDs);
 	PacketType SendPause(uint8_t playerNum, uint8_t bPaused);
 
@@ -61,6 +62,7 @@ public:
 	PacketType SendUserSpeed(uint8_t playerNum, float userSpeed);
 	PacketType SendInternalSpeed(float internalSpeed);
 	PacketType SendCPUUsage(float cpuUsage);
+	PacketType SendClientStats(float simFrameTimeMedian, float simFrameTimeP95, float drawFrameTime, uint16_t numQueuedSimFrames);
 	PacketType SendCustomData(uint8_t playerNum, uint8_t dataType, int32_t dataValue);
 	PacketType SendLuaDrawTime(uint8_t playerNum, int32_t mSec);
 	PacketType SendDirectControl(uint8_t playerNum);
@@ -74,6 +76,7 @@ public:
 	PacketType SendMapDrawLine(uint8_t playerNum, int16_t x1, int16_t z1, int16_t x2, int16_t z2, bool);
 	PacketType SendMapDrawPoint(uint8_t playerNum, int16_t x, int16_t z, const std::string& label, bool);
 	PacketType SendSyncResponse(uint8_t playerNum, int32_t frameNum, uint32_t checksum);
+	PacketType SendSyncTree(uint8_t playerNum, int32_t frameNum, uint8_t node, const std::vector<uint32_t>& hashes);
 	PacketType SendSystemMessage(uint8_t playerNum, std::string message);
 	PacketType SendStartPos(uint8_t playerNum, uint8_t teamNum, uint8_t readyState, float x, float y, float z);
 	PacketType SendPlayerInfo(uint8_t playerNum, float cpuUsage, int32_t ping);
@@ -121,6 +124,9 @@ public:
 private:
 	CBaseNetProtocol();
 
+	PacketType SendSelectRanges(uint8_t playerNum, const std::vector<int16_t>& selectedUnitIDs, uint32_t packetSize);
+	PacketType SendSelectBitset(uint8_t playerNum, const std::vector<int16_t>& selectedUnitIDs, uint32_t packetSize, int16_t minUnitID, int16_t maxUnitID);
+
 };
 
 #endif // _BASE_NET_PROTOCOL_H
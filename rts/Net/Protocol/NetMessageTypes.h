@@ -93,6 +93,15 @@ enum NETMSG {
 
 	NETMSG_PING = 78, // uint8_t playerNum, uint8_t pingTag, float localTime
 
+	NETMSG_SELECT_PACKED    = 79, // uint16_t msgSize, uint8_t playerNum, uint8_t encoding; SELECT_RANGES: N * {int16_t firstUnitID, uint16_t numUnitIDs}
+	                              //                                                         SELECT_BITSET: int16_t firstUnitID, std::vector<uint8_t> unitBits
+
+	NETMSG_CLIENT_STATS     = 80, // float simFrameTimeMedian, simFrameTimeP95, drawFrameTime /*in milliseconds*/; uint16_t numQueuedSimFrames
+
+	NETMSG_SYNCTREE         = 81, // uint16_t msgSize, uint8_t playerNum, int32_t frameNum, uint8_t node; std::vector<uint32_t> hashes
+	                              // client: top-level hashes (node = SYNCTREE_NODE_ROOT) or the child hashes of <node>
+	                              // server: requests the child hashes of <node>, or a state dump at frameNum (node = SYNCTREE_NODE_DUMP); no hashes
+
 	NETMSG_LAST //max types of netmessages, internal only
 };
 
@@ -108,6 +117,12 @@ enum TEAMMSG {
 //TODO: in-game allyteams
 };
 
+/// unit-ID encodings of NETMSG_SELECT_PACKED
+enum SelectEncoding {
+	SELECT_RANGES = 0, // runs of consecutive IDs
+	SELECT_BITSET = 1, // bit (i & 7) of byte (i >> 3) set if firstUnitID + i is selected
+};
+
 /// sub-action-types of NETMSG_MAPDRAW
 enum MapDrawAction {
 	MAPDRAW_POINT,
@@ -15,6 +15,7 @@
 
 #include <functional>
 #include <cassert>
+#include <cstring>
 
 #if defined(_WIN32) && !defined(__MINGW32__)
 #pragma message("Adding library: vfw32.lib")
@@ -89,7 +90,7 @@ CAVIGenerator::CAVIGenerator(const std::string& fileName, int videoSizeX, int vi
 	errorMsg("Ok"),
 	quitAVIgen(false),
 	AVIThread(0),
-	readBuf(nullptr),
+	readbackIndex(0),
 	m_lFrame(0),
 	m_pAVIFile(nullptr),
 	m_pStream(nullptr),
@@ -107,12 +108,24 @@ CAVIGenerator::CAVIGenerator(const std::string& fileName, int videoSizeX, int vi
 	bitmapInfo.biSizeImage = videoSizeX * videoSizeY * 3;
 	bitmapInfo.biCompression = BI_RGB;
 
+	readbackFences.fill(nullptr);
+
 	quitAVIgen = (!initVFW());
 }
 
 
 CAVIGenerator::~CAVIGenerator()
 {
+	// do not drop the last few frames that are still being read back
+	FlushReadbacks();
+
+	for (GLsync& fence: readbackFences) {
+		if (fence != nullptr)
+			glDeleteSync(fence);
+
+		fence = nullptr;
+	}
+
 	if (AVIThread) {
 		{
 			std::lock_guard<spring::mutex> lock(AVIMutex);
@@ -132,7 +145,6 @@ CAVIGenerator::~CAVIGenerator()
 		imageBuffers.pop_front();
 	}
 
-	spring::SafeDelete(readBuf);
 	ReleaseAVICompressionEngine();
 	LOG("Finished writing avi file %s", fileName.c_str());
 
@@ -143,7 +155,6 @@ CAVIGenerator::~CAVIGenerator()
 	assert(m_pStreamCompressed == nullptr);
 	assert(freeImageBuffers.empty());
 	assert(imageBuffers.empty());
-	assert(readBuf == nullptr);
 }
 
 
@@ -328,6 +339,13 @@ bool CAVIGenerator::InitEngine()
 		freeImageBuffers.push_back(new unsigned char[bitmapInfo.biSizeImage]);
 	}
 
+	for (VBO& pbo: readbackPBOs) {
+		pbo = VBO{GL_PIXEL_PACK_BUFFER, false};
+		pbo.Bind();
+		pbo.New(bitmapInfo.biSizeImage, GL_STREAM_READ);
+		pbo.Unbind();
+	}
+
 	HWND mainWindow = FindWindow(nullptr, ("Spring " + SpringVersion::GetFull()).c_str());
 
 	if (globalRendering->fullScreen)
@@ -365,18 +383,40 @@ HRESULT CAVIGenerator::AddFrame(unsigned char* pixelData)
 
 bool CAVIGenerator::readOpenglPixelDataThreaded()
 {
+	VBO& pbo = readbackPBOs[readbackIndex];
+	GLsync& fence = readbackFences[readbackIndex];
+
+	readbackIndex = (readbackIndex + 1) % NUM_READBACK_PBOS;
+
+	// this PBO was filled NUM_READBACK_PBOS frames ago, so the transfer has
+	// almost always finished and mapping it does not stall the pipeline the
+	// way a glReadPixels into client memory does
+	if (fence != nullptr && !QueueReadback(pbo, fence))
+		return false;
+
+	pbo.Bind();
+	glReadPixels(0, 0, bitmapInfo.biWidth, bitmapInfo.biHeight, GL_BGR_EXT, GL_UNSIGNED_BYTE, nullptr);
+	pbo.Unbind();
+
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	return true;
+}
+
+bool CAVIGenerator::QueueReadback(VBO& pbo, GLsync& fence)
+{
+	unsigned char* readBuf = nullptr;
+
+	// blocks only if the GPU is more than NUM_READBACK_PBOS - 1 frames behind
+	glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000 * 1000 * 1000);
+	glDeleteSync(fence);
+	fence = nullptr;
+
 	while (true) {
 		std::unique_lock<spring::mutex> lock(AVIMutex);
 
 		if (quitAVIgen)
 			return false;
 
-		if (readBuf != nullptr) {
-			imageBuffers.push_back(readBuf);
-			readBuf = nullptr;
-			AVICondition.notify_all();
-		}
-
 		if (freeImageBuffers.empty()) {
 			AVICondition.wait(lock);
 		} else {
@@ -386,10 +426,40 @@ bool CAVIGenerator::readOpenglPixelDataThreaded()
 		}
 	}
 
-	glReadPixels(0, 0, bitmapInfo.biWidth, bitmapInfo.biHeight, GL_BGR_EXT, GL_UNSIGNED_BYTE, readBuf);
+	pbo.Bind();
+	const GLubyte* mem = pbo.MapBuffer(GL_READ_ONLY);
+
+	if (mem != nullptr)
+		memcpy(readBuf, mem, bitmapInfo.biSizeImage);
+
+	pbo.UnmapBuffer();
+	pbo.Unbind();
+
+	std::lock_guard<spring::mutex> lock(AVIMutex);
+
+	if (mem != nullptr) {
+		imageBuffers.push_back(readBuf);
+	} else {
+		freeImageBuffers.push_back(readBuf);
+	}
+
+	AVICondition.notify_all();
 	return true;
 }
 
+void CAVIGenerator::FlushReadbacks()
+{
+	for (size_t i = 0; i < NUM_READBACK_PBOS; i++) {
+		VBO& pbo = readbackPBOs[readbackIndex];
+		GLsync& fence = readbackFences[readbackIndex];
+
+		readbackIndex = (readbackIndex + 1) % NUM_READBACK_PBOS;
+
+		if (fence != nullptr && !QueueReadback(pbo, fence))
+			return;
+	}
+}
+
 
 __FORCE_ALIGN_STACK__
 void CAVIGenerator::AVIGeneratorThreadProc()
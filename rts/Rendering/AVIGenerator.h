@@ -5,12 +5,15 @@
 
 #ifdef _WIN32
 
+#include "Rendering/GL/myGL.h"
+#include "Rendering/GL/VBO.h"
 #include "System/Threading/SpringThreading.h"
 #include "System/Misc/NonCopyable.h"
 
 #include <windows.h>
 #include <vfw.h>
 
+#include <array>
 #include <string>
 #include <deque>
 #include <vector>
@@ -31,8 +34,17 @@ public:
 	bool readOpenglPixelDataThreaded();
 
 private:
+	/// frames are read back through a ring of PBO's, each one is mapped
+	/// (and handed to the encoder) NUM_READBACK_PBOS - 1 frames later
+	static constexpr size_t NUM_READBACK_PBOS = 3;
+
 	bool initVFW();
 
+	/// copies a finished readback into a free image buffer and queues it
+	bool QueueReadback(VBO& pbo, GLsync& fence);
+	/// queues all readbacks that are still in flight, oldest first
+	void FlushReadbacks();
+
 	HRESULT InitAVICompressionEngine();
 	/// Adds a frame to the movie.
 	HRESULT AddFrame(unsigned char* pixelData);
@@ -64,8 +76,10 @@ private:
 	std::deque< unsigned char* > freeImageBuffers;
 	std::deque< unsigned char* > imageBuffers;
 
-	unsigned char* readBuf;
+	std::array<VBO, NUM_READBACK_PBOS> readbackPBOs;
+	std::array<GLsync, NUM_READBACK_PBOS> readbackFences;
 
+	size_t readbackIndex;
 
 	/// frame counter
 	long m_lFrame;
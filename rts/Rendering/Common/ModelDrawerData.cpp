@@ -1,3 +1,4 @@
 #include "ModelDrawerData.h"
 
-CONFIG(int, UnitLodDist).defaultValue(1000).headlessValue(0);
\ No newline at end of file
+CONFIG(int, UnitLodDist).defaultValue(1000).headlessValue(0);
+CONFIG(bool, GPUModelCulling).defaultValue(false).headlessValue(false).safemodeValue(false).description("Cull and batch units and features with a compute shader in the GL4 model drawers.");
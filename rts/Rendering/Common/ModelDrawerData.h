@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <array>
 #include <functional>
@@ -21,6 +22,7 @@
 #include "Game/Camera.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/CameraHandler.h"
+#include "Sim/Misc/GlobalSynced.h"
 
 class CModelDrawerDataConcept : public CEventClient {
 public:
@@ -29,6 +31,8 @@ public:
 	{
 		if (modelDrawDist == 0.0f)
 			SetModelDrawDist(static_cast<float>(configHandler->GetInt("UnitLodDist")));
+
+		gpuCulling = configHandler->GetBool("GPUModelCulling");
 	};
 	virtual ~CModelDrawerDataConcept() {
 		eventHandler.RemoveClient(this);
@@ -45,6 +49,9 @@ public:
 public:
 	// lenghts & distances
 	static float inline modelDrawDist    = 0.0f;
+
+	// GL4 drawers cull and batch objects in ModelCullCompGL4, see S3DModelVAO::SubmitCulled
+	static bool inline gpuCulling = false;
 protected:
 	static constexpr int MT_CHUNK_OR_MIN_CHUNK_SIZE_SMMA = -128;
 	static constexpr int MT_CHUNK_OR_MIN_CHUNK_SIZE_UPDT = -256;
@@ -63,6 +70,8 @@ public:
 	virtual void Update() = 0;
 protected:
 	virtual bool IsAlpha(const T* co) const = 0;
+	// objects the GPU culling pass has to leave to the CPU (Lua materials, far-textures, ...)
+	virtual bool IsCPUDrawn(const T* co) const = 0;
 private:
 	void AddObject(const T* co, bool add); //never to be called directly! Use UpdateObject() instead!
 protected:
@@ -73,11 +82,29 @@ protected:
 	virtual void UpdateObjectDrawFlags(CSolidObject* o) const = 0;
 private:
 	void UpdateObjectSMMA(const T* o);
-	void UpdateObjectUniforms(const T* o);
+	void UpdateObjectUniforms(const T* o, bool cpuDrawn);
+	void UpdateCPUDrawnObjects();
 public:
 	const std::vector<T*>& GetUnsortedObjects() const { return unsortedObjects; }
+
+	// true if the objects' viewCullRadius values (set by Update) still hold for <cam>
+	bool HasViewCullRadii(const CCamera* cam) const {
+		return (viewCullStamp != 0 && cam->GetCamType() == CCamera::CAMTYPE_PLAYER && !(cam->GetViewProjectionMatrix() != viewCullMatrix));
+	}
+	// draw-frame of the last Update that (potentially) changed the set of visible objects
+	uint32_t GetViewCullStamp() const { return viewCullStamp; }
 	const ModelRenderContainer<T>& GetModelRenderer(int modelType) const { return modelRenderers[modelType]; }
 
+	// sorted by texture-type, only filled while gpuCulling is enabled
+	const std::vector<T*>& GetCPUDrawnObjects(int modelType) const { return cpuDrawnObjects[modelType]; }
+	// the subset of the above belonging to the bin with texture-type <binKey>
+	std::pair<typename std::vector<T*>::const_iterator, typename std::vector<T*>::const_iterator> GetCPUDrawnObjects(int modelType, int binKey) const {
+		const auto& objs = cpuDrawnObjects[modelType];
+		const auto beg = std::lower_bound(objs.begin(), objs.end(), binKey, [](const T* o, int key) { return (o->model->textureType < key); });
+		const auto end = std::upper_bound(beg, objs.end(), binKey, [](int key, const T* o) { return (key < o->model->textureType); });
+		return {beg, end};
+	}
+
 	const ScopedMatricesMemAlloc& GetObjectMatricesMemAlloc(const T* o) const {
 		const auto it = matricesMemAllocs.find(const_cast<T*>(o));
 		return (it != matricesMemAllocs.end()) ? it->second : ScopedMatricesMemAlloc::Dummy();
@@ -91,7 +118,17 @@ protected:
 	std::vector<T*> unsortedObjects;
 	std::unordered_map<T*, ScopedMatricesMemAlloc> matricesMemAllocs;
 
+	std::array<std::vector<T*>, MODELTYPE_CNT> cpuDrawnObjects;
+	std::vector<uint8_t> cpuDrawnFlags;
+
 	bool& mtModelDrawer;
+private:
+	// state the viewCullRadius values were computed for
+	CMatrix44f viewCullMatrix;
+	float viewCullTimeOffset = 0.0f;
+	int viewCullSimFrame = -1;
+	size_t viewCullNumObjects = 0;
+	uint32_t viewCullStamp = 0;
 };
 
 using CUnitDrawerDataBase = CModelDrawerDataBase<CUnit>;
@@ -176,6 +213,11 @@ inline void CModelDrawerDataBase<T>::UpdateObjectSMMA(const T* o)
 	if (tmNew != tmOld)
 		smma[0] = tmNew;
 
+	// no piece was animated or hidden since the last update, their matrices
+	// are still current; this is the common case for idle and static units
+	if (!o->localModel.SetGetCustomDirty(false))
+		return;
+
 	for (int i = 0; i < o->localModel.pieces.size(); ++i) {
 		const LocalModelPiece& lmp = o->localModel.pieces[i];
 		const bool wasCustomDirty = lmp.SetGetCustomDirty(false);
@@ -193,10 +235,11 @@ inline void CModelDrawerDataBase<T>::UpdateObjectSMMA(const T* o)
 }
 
 template<typename T>
-inline void CModelDrawerDataBase<T>::UpdateObjectUniforms(const T* o)
+inline void CModelDrawerDataBase<T>::UpdateObjectUniforms(const T* o, bool cpuDrawn)
 {
 	auto& uni = modelsUniformsStorage.GetObjUniformsArray(o);
 	uni.drawFlag = o->drawFlag;
+	uni.gpuDrawMask = o->engineDrawMask * (1 - cpuDrawn);
 
 	if (gu->spectatingFullView || o->IsInLosForAllyTeam(gu->myAllyTeam)) {
 		uni.speed = o->speed;
@@ -205,17 +248,53 @@ inline void CModelDrawerDataBase<T>::UpdateObjectUniforms(const T* o)
 	}
 }
 
+template<typename T>
+inline void CModelDrawerDataBase<T>::UpdateCPUDrawnObjects()
+{
+	for (auto& objs : cpuDrawnObjects) {
+		objs.clear();
+	}
+
+	if (!gpuCulling)
+		return;
+
+	for (size_t k = 0; k < unsortedObjects.size(); ++k) {
+		T* o = unsortedObjects[k];
+
+		if (cpuDrawnFlags[k] == 0 || o->model == nullptr)
+			continue;
+
+		cpuDrawnObjects[MDL_TYPE(o)].emplace_back(o);
+	}
+
+	for (auto& objs : cpuDrawnObjects) {
+		std::stable_sort(objs.begin(), objs.end(), [](const T* a, const T* b) { return (a->model->textureType < b->model->textureType); });
+	}
+}
+
 template<typename T>
 inline void CModelDrawerDataBase<T>::UpdateCommon()
 {
-	const auto updateBody = [this](int k) {
+	cpuDrawnFlags.resize(unsortedObjects.size() * gpuCulling);
+
+	// shared with Lua, Spring.GetVisible{Units,Features} filter on these
+	// instead of walking the quadfield and testing the frustum per call
+	const CCamera* playerCam = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
+
+	const auto updateBody = [this, playerCam](int k) {
 		T* o = unsortedObjects[k];
+		o->viewCullRadius = playerCam->GetInViewRadius(o->drawMidPos);
 		UpdateObjectDrawFlags(o);
 
 		if (o->alwaysUpdateMat || (o->drawFlag > DrawFlags::SO_NODRAW_FLAG && o->drawFlag < DrawFlags::SO_FARTEX_FLAG))
 			this->UpdateObjectSMMA(o);
 
-		this->UpdateObjectUniforms(o);
+		const bool cpuDrawn = gpuCulling && IsCPUDrawn(o);
+
+		if (gpuCulling)
+			cpuDrawnFlags[k] = cpuDrawn;
+
+		this->UpdateObjectUniforms(o, cpuDrawn);
 	};
 
 	if (mtModelDrawer) {
@@ -227,4 +306,23 @@ inline void CModelDrawerDataBase<T>::UpdateCommon()
 		for (int k = 0; k < unsortedObjects.size(); ++k)
 			updateBody(k);
 	}
+
+	{
+		// interpolated draw-positions only move if timeOffset or the sim-frame does
+		bool changed = (playerCam->GetViewProjectionMatrix() != viewCullMatrix);
+
+		changed |= (globalRendering->timeOffset != viewCullTimeOffset);
+		changed |= (gs->frameNum != viewCullSimFrame);
+		changed |= (unsortedObjects.size() != viewCullNumObjects);
+
+		if (changed || viewCullStamp == 0) {
+			viewCullMatrix = playerCam->GetViewProjectionMatrix();
+			viewCullTimeOffset = globalRendering->timeOffset;
+			viewCullSimFrame = gs->frameNum;
+			viewCullNumObjects = unsortedObjects.size();
+			viewCullStamp = std::max(globalRendering->drawFrame, 1u);
+		}
+	}
+
+	UpdateCPUDrawnObjects();
 }
\ No newline at end of file
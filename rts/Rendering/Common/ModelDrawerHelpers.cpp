@@ -34,8 +34,10 @@ void CModelDrawerHelper::EnableTexturesCommon()
 	glActiveTexture(GL_TEXTURE1);
 	glEnable(GL_TEXTURE_2D);
 
-	if (shadowHandler.ShadowsLoaded())
+	if (shadowHandler.ShadowsLoaded()) {
 		shadowHandler.SetupShadowTexSampler(GL_TEXTURE2, true);
+		shadowHandler.SetupCascadeTexSampler(GL_TEXTURE5);
+	}
 
 	if (CModelDrawerConcept::UseAdvShading()) {
 		glActiveTexture(GL_TEXTURE3);
@@ -56,8 +58,10 @@ void CModelDrawerHelper::DisableTexturesCommon()
 	glActiveTexture(GL_TEXTURE1);
 	glDisable(GL_TEXTURE_2D);
 
-	if (shadowHandler.ShadowsLoaded())
+	if (shadowHandler.ShadowsLoaded()) {
 		shadowHandler.ResetShadowTexSampler(GL_TEXTURE2, true);
+		shadowHandler.ResetCascadeTexSampler(GL_TEXTURE5);
+	}
 
 	if (CModelDrawerConcept::UseAdvShading()) {
 		glActiveTexture(GL_TEXTURE3);
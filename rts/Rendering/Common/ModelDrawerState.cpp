@@ -375,11 +375,12 @@ CModelDrawerStateGLSL::CModelDrawerStateGLSL()
 	const std::string extraDefs =
 		("#define BASE_DYNAMIC_MODEL_LIGHT " + IntToString(lightHandler->GetBaseLight()) + "\n") +
 		("#define MAX_DYNAMIC_MODEL_LIGHTS " + IntToString(lightHandler->GetMaxLights()) + "\n");
+	const std::string fragDefs = extraDefs + (lightHandler->IsClustered()? GL::LightClusters::GetShaderDefs(): "");
 
 	for (uint32_t n = MODEL_SHADER_NOSHADOW_STANDARD; n <= MODEL_SHADER_SHADOWED_DEFERRED; n++) {
 		modelShaders[n] = sh->CreateProgramObject(PO_CLASS, shaderNames[n], false);
 		modelShaders[n]->AttachShaderObject(sh->CreateShaderObject("GLSL/ModelVertProg.glsl", extraDefs, GL_VERTEX_SHADER));
-		modelShaders[n]->AttachShaderObject(sh->CreateShaderObject("GLSL/ModelFragProg.glsl", extraDefs, GL_FRAGMENT_SHADER));
+		modelShaders[n]->AttachShaderObject(sh->CreateShaderObject("GLSL/ModelFragProg.glsl", fragDefs, GL_FRAGMENT_SHADER));
 
 		modelShaders[n]->SetFlag("USE_SHADOWS", int((n & 1) == 1));
 		modelShaders[n]->SetFlag("DEFERRED_MODE", int(n >= MODEL_SHADER_NOSHADOW_DEFERRED));
@@ -534,6 +535,8 @@ CModelDrawerStateGL4::CModelDrawerStateGL4()
 		modelShaders[n]->SetFlag("GBUFFER_EMITTEX_IDX", GL::GeometryBuffer::ATTACHMENT_EMITTEX);
 		modelShaders[n]->SetFlag("GBUFFER_MISCTEX_IDX", GL::GeometryBuffer::ATTACHMENT_MISCTEX);
 		modelShaders[n]->SetFlag("GBUFFER_ZVALTEX_IDX", GL::GeometryBuffer::ATTACHMENT_ZVALTEX);
+		modelShaders[n]->SetFlag("BINDLESS_MODEL_TEXTURES", int(textureHandlerS3O.UseBindlessTextures()));
+		modelShaders[n]->SetFlag("TEX_HANDLES_SSBO_BINDING_IDX", CS3OTextureHandler::TEX_HANDLES_SSBO_BINDING_IDX);
 
 		modelShaders[n]->Link();
 		modelShaders[n]->Enable();
@@ -595,6 +598,9 @@ void CModelDrawerStateGL4::Enable(bool deferredPass, bool alphaPass) const
 	float gtThreshold = mix(0.5, 0.1, static_cast<float>(alphaPass));
 	modelShader->SetUniform("alphaCtrl", gtThreshold, 1.0f, 0.0f, 0.0f); // test > 0.1 | 0.5
 
+	if (shadowHandler.ShadowsLoaded())
+		shadowHandler.SetCascadeUniforms(modelShader);
+
 	// end of EnableCommon();
 }
 
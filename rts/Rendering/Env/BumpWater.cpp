@@ -36,6 +36,9 @@
 #include "System/SpringFormat.h"
 #include "System/StringUtil.h"
 
+#include <algorithm>
+#include <limits>
+
 using std::string;
 using std::vector;
 using std::min;
@@ -53,6 +56,8 @@ CONFIG(bool, BumpWaterEndlessOcean).defaultValue(true).description("Sets whether
 CONFIG(bool, BumpWaterDynamicWaves).defaultValue(true);
 CONFIG(bool, BumpWaterUseUniforms).defaultValue(false);
 CONFIG(bool, BumpWaterOcclusionQuery).defaultValue(false); //FIXME doesn't work as expected (it's slower than w/o), needs fixing
+CONFIG(bool, BumpWaterAdaptiveReflection).defaultValue(false).description("Render the reflection less often and at a lower resolution whenever the frame-time exceeds BumpWaterTargetFrameTime.");
+CONFIG(float, BumpWaterTargetFrameTime).defaultValue(16.6f).minimumValue(1.0f).description("Frame-time in milliseconds above which BumpWaterAdaptiveReflection starts to reduce the reflection cost.");
 
 
 #define LOG_SECTION_BUMP_WATER "BumpWater"
@@ -162,6 +167,13 @@ CBumpWater::CBumpWater()
 	, normalTexture2(0)
 	, coastTexture(0)
 	, coastUpdateTexture(0)
+	, waterCellsX(0)
+	, waterCellsY(0)
+	, reflAvgFrameTime(0.0f)
+	, reflUpdateInterval(1)
+	, reflSizeShift(0)
+	, reflBudgetFrame(0)
+	, reflUpdateFrame(0)
 	, wasVisibleLastFrame(false)
 {
 	eventHandler.AddClient(this);
@@ -180,6 +192,13 @@ CBumpWater::CBumpWater()
 	               && ((readMap->HasVisibleWater()) || (waterRendering->forceRendering));
 	dynWaves     = (configHandler->GetBool("BumpWaterDynamicWaves")) && (waterRendering->numTiles > 1);
 	useUniforms  = (configHandler->GetBool("BumpWaterUseUniforms"));
+	adaptiveRefl = (configHandler->GetBool("BumpWaterAdaptiveReflection"));
+	reflTargetFrameTime = configHandler->GetFloat("BumpWaterTargetFrameTime");
+
+	waterCellsX = (mapDims.mapx + WATER_CELL_SIZE - 1) / WATER_CELL_SIZE;
+	waterCellsY = (mapDims.mapy + WATER_CELL_SIZE - 1) / WATER_CELL_SIZE;
+	waterCellMinHeights.resize(waterCellsX * waterCellsY, 0.0f);
+	UpdateWaterCells(SRectangle(0, 0, mapDims.mapx, mapDims.mapy));
 
 	// CHECK HARDWARE
 	if (!globalRendering->haveGLSL) {
@@ -373,6 +392,10 @@ CBumpWater::CBumpWater()
 			}
 		}
 
+		// shoreWaves already registered for heightmap updates, needed to keep the water cells current
+		if (reflection > 0 && !shoreWaves)
+			eventHandler.InsertEvent(this, "UnsyncedHeightMapUpdate");
+
 		if (refraction > 0) {
 			refractFBO.Bind();
 			refractFBO.CreateRenderBuffer(GL_DEPTH_ATTACHMENT_EXT, depthRBOFormat, screenTextureX, screenTextureY);
@@ -730,7 +753,7 @@ void CBumpWater::UpdateWater(CGame* game)
 
 	glPushAttrib(GL_FOG_BIT);
 	if (refraction > 1) DrawRefraction(game);
-	if (reflection > 0) DrawReflection(game);
+	if (reflection > 0 && WantReflectionUpdate(CCameraHandler::GetActiveCamera())) DrawReflection(game);
 	if (reflection || refraction) {
 		FBO::Unbind();
 		glViewport(globalRendering->viewPosX, 0, globalRendering->viewSizeX, globalRendering->viewSizeY);
@@ -739,6 +762,152 @@ void CBumpWater::UpdateWater(CGame* game)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+///  REFLECTION BUDGET
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CBumpWater::UpdateWaterCells(const SRectangle& rect)
+{
+	const float* heightMap = readMap->GetCornerHeightMapUnsynced();
+
+	const int cx1 = std::max(rect.x1, 0) / WATER_CELL_SIZE;
+	const int cy1 = std::max(rect.y1, 0) / WATER_CELL_SIZE;
+	const int cx2 = std::min(rect.x2, mapDims.mapx - 1) / WATER_CELL_SIZE;
+	const int cy2 = std::min(rect.y2, mapDims.mapy - 1) / WATER_CELL_SIZE;
+
+	// whole cells are rescanned, which also catches heights that were raised above water
+	for (int cy = cy1; cy <= cy2; cy++) {
+		for (int cx = cx1; cx <= cx2; cx++) {
+			const int x1 = cx * WATER_CELL_SIZE;
+			const int y1 = cy * WATER_CELL_SIZE;
+			const int x2 = std::min(x1 + WATER_CELL_SIZE, mapDims.mapx);
+			const int y2 = std::min(y1 + WATER_CELL_SIZE, mapDims.mapy);
+
+			float minHeight = std::numeric_limits<float>::max();
+
+			for (int y = y1; y <= y2; y++) {
+				const float* row = &heightMap[y * mapDims.mapxp1];
+				minHeight = std::min(minHeight, *std::min_element(row + x1, row + x2 + 1));
+			}
+
+			waterCellMinHeights[cy * waterCellsX + cx] = minHeight;
+		}
+	}
+}
+
+bool CBumpWater::IsWaterInView(const CCamera* cam) const
+{
+	if (waterRendering->forceRendering)
+		return true;
+
+	// waves never rise far above the plane
+	constexpr float waterMinY = -5.0f;
+	constexpr float waterMaxY =  5.0f;
+
+	const float mapSizeX = mapDims.mapx * SQUARE_SIZE;
+	const float mapSizeZ = mapDims.mapy * SQUARE_SIZE;
+
+	if (endlessOcean) {
+		// bounds of the disc drawn by DrawRadialDisc, minus the map itself
+		const float r = 12.25f * std::min(mapSizeX, mapSizeZ) * 0.25f;
+
+		if (cam->InView(float3(-r, waterMinY, -r), float3(0.0f, waterMaxY, mapSizeZ + r)))
+			return true;
+		if (cam->InView(float3(mapSizeX, waterMinY, -r), float3(mapSizeX + r, waterMaxY, mapSizeZ + r)))
+			return true;
+		if (cam->InView(float3(0.0f, waterMinY, -r), float3(mapSizeX, waterMaxY, 0.0f)))
+			return true;
+		if (cam->InView(float3(0.0f, waterMinY, mapSizeZ), float3(mapSizeX, waterMaxY, mapSizeZ + r)))
+			return true;
+	}
+
+	for (int cy = 0; cy < waterCellsY; cy++) {
+		for (int cx = 0; cx < waterCellsX; cx++) {
+			if (waterCellMinHeights[cy * waterCellsX + cx] >= 0.0f)
+				continue;
+
+			const float3 mins = {float(cx * WATER_CELL_SIZE * SQUARE_SIZE), waterMinY, float(cy * WATER_CELL_SIZE * SQUARE_SIZE)};
+			const float3 maxs = {std::min(mins.x + WATER_CELL_SIZE * SQUARE_SIZE, mapSizeX), waterMaxY, std::min(mins.z + WATER_CELL_SIZE * SQUARE_SIZE, mapSizeZ)};
+
+			if (cam->InView(mins, maxs))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+bool CBumpWater::WantReflectionUpdate(const CCamera* cam)
+{
+	// nothing would sample the texture, render it right away once water comes back into view
+	if (!IsWaterInView(cam)) {
+		reflUpdateFrame = 0;
+		return false;
+	}
+
+	if (adaptiveRefl)
+		UpdateReflectionBudget();
+
+	// skipped frames keep showing the previous reflection
+	if (reflUpdateFrame != 0 && (globalRendering->drawFrame - reflUpdateFrame) < static_cast<unsigned int>(reflUpdateInterval))
+		return false;
+
+	reflUpdateFrame = globalRendering->drawFrame;
+	return true;
+}
+
+void CBumpWater::UpdateReflectionBudget()
+{
+	reflAvgFrameTime = mix(reflAvgFrameTime, globalRendering->lastFrameTime, 0.05f);
+
+	if ((globalRendering->drawFrame - reflBudgetFrame) < BUDGET_UPDATE_FRAMES)
+		return;
+
+	reflBudgetFrame = globalRendering->drawFrame;
+
+	// over budget: first refresh less often, then render at a lower resolution
+	if (reflAvgFrameTime > reflTargetFrameTime) {
+		if (reflUpdateInterval < MAX_REFL_UPDATE_INTERVAL) {
+			reflUpdateInterval++;
+		} else if (reflSizeShift < MAX_REFL_SIZE_SHIFT && (reflTexSize >> (reflSizeShift + 1)) >= 32) {
+			ResizeReflection(reflSizeShift + 1);
+		}
+
+		return;
+	}
+
+	// well within budget: undo in reverse order, the margin keeps it from oscillating
+	if (reflAvgFrameTime < reflTargetFrameTime * 0.75f) {
+		if (reflSizeShift > 0) {
+			ResizeReflection(reflSizeShift - 1);
+		} else if (reflUpdateInterval > 1) {
+			reflUpdateInterval--;
+		}
+	}
+}
+
+void CBumpWater::ResizeReflection(int sizeShift)
+{
+	const int texSize = reflTexSize >> (reflSizeShift = sizeShift);
+
+	glBindTexture(GL_TEXTURE_2D, reflectTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texSize, texSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	reflectFBO.Bind();
+	reflectFBO.Detach(GL_DEPTH_ATTACHMENT_EXT);
+	reflectFBO.CreateRenderBuffer(GL_DEPTH_ATTACHMENT_EXT, static_cast<GLuint>(CGlobalRendering::DepthBitsToFormat(depthBits)), texSize, texSize);
+	reflectFBO.AttachTexture(reflectTexture);
+	reflectFBO.CheckStatus("BUMPWATER(reflection)");
+	FBO::Unbind();
+
+	// contents are undefined after the reallocation
+	reflUpdateFrame = 0;
+
+	LOG_L(L_DEBUG, "reflection resized to %dx%d (frame-time %.1fms, target %.1fms)", texSize, texSize, reflAvgFrameTime, reflTargetFrameTime);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 ///  SHOREWAVES/COASTMAP
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -763,6 +932,9 @@ CBumpWater::CoastAtlasRect::CoastAtlasRect(const SRectangle& rect)
 
 void CBumpWater::UnsyncedHeightMapUpdate(const SRectangle& rect)
 {
+	if (reflection > 0)
+		UpdateWaterCells(rect);
+
 	if (!shoreWaves || !readMap->HasVisibleWater())
 		return;
 
@@ -1213,7 +1385,7 @@ void CBumpWater::DrawReflection(CGame* game)
 
 	{
 		curCam->CopyStateReflect(prvCam);
-		curCam->UpdateLoadViewPort(0, 0, reflTexSize, reflTexSize);
+		curCam->UpdateLoadViewPort(0, 0, reflTexSize >> reflSizeShift, reflTexSize >> reflSizeShift);
 
 		DrawReflections(&clipPlaneEqs[0], reflection > 1, true);
 	}
@@ -3,6 +3,8 @@
 #ifndef BUMP_WATER_H
 #define BUMP_WATER_H
 
+#include <vector>
+
 #include "Rendering/GL/FBO.h"
 #include "Rendering/GL/myGL.h"
 #include "IWater.h"
@@ -15,12 +17,14 @@ namespace Shader {
 	struct IProgramObject;
 }
 
+class CCamera;
+
 class CBumpWater : public IWater, public CEventClient
 {
 public:
 	//! CEventClient interface
 	bool WantsEvent(const std::string& eventName) {
-		return shoreWaves && (eventName == "UnsyncedHeightMapUpdate");
+		return (shoreWaves || reflection > 0) && (eventName == "UnsyncedHeightMapUpdate");
 	}
 	bool GetFullRead() const { return true; }
 	int GetReadAllyTeam() const { return AllAccessTeam; }
@@ -70,6 +74,32 @@ private:
 
 	void UnsyncedHeightMapUpdate(const SRectangle& rect);
 
+private:
+	//! reflection pass budgeting
+	void UpdateWaterCells(const SRectangle& rect);
+	void UpdateReflectionBudget();
+	void ResizeReflection(int sizeShift);
+
+	bool IsWaterInView(const CCamera* cam) const;
+	bool WantReflectionUpdate(const CCamera* cam);
+
+	static constexpr int WATER_CELL_SIZE = 64; ///< heightmap squares per side of a waterCellMinHeights cell
+	static constexpr int BUDGET_UPDATE_FRAMES = 30; ///< draw-frames between two budget adjustments
+	static constexpr int MAX_REFL_UPDATE_INTERVAL = 4;
+	static constexpr int MAX_REFL_SIZE_SHIFT = 2;
+
+	std::vector<float> waterCellMinHeights; ///< lowest corner height per cell, cells below 0 contain water
+	int waterCellsX;
+	int waterCellsY;
+
+	bool  adaptiveRefl;        ///< lower reflection rate and size when the frame-time exceeds reflTargetFrameTime
+	float reflTargetFrameTime; ///< milliseconds
+	float reflAvgFrameTime;
+	int   reflUpdateInterval;  ///< draw-frames between two reflection renders
+	int   reflSizeShift;       ///< reflection is rendered at (reflTexSize >> reflSizeShift)
+	unsigned int reflBudgetFrame;
+	unsigned int reflUpdateFrame; ///< 0 := reflection texture is not up to date
+
 private:
 	//! user options
 	char  reflection;   ///< 0:=off, 1:=don't render the terrain, 2:=render everything+terrain
@@ -6,6 +6,7 @@
 #include "Game/GlobalUnsynced.h"
 #include "Lua/LuaParser.h"
 #include "Map/Ground.h"
+#include "Map/HeightMapTexture.h"
 #include "Map/MapInfo.h"
 #include "Map/ReadMap.h"
 #include "Map/SMF/SMFReadMap.h"
@@ -41,10 +42,12 @@
 #include "System/FileSystem/FileSystem.h"
 #include "System/UnorderedMap.hpp"
 
+#include <limits>
 #include <numeric>
 
 
 CONFIG(bool, GroundDecalsParallaxMapping).defaultValue(true);
+CONFIG(int, GroundDecalsBakedTiles).defaultValue(64).minimumValue(0).maximumValue(256).description("Number of ground tiles the GL4 decal drawer can bake explosion scars into. 0 keeps every scar as a live decal.");
 
 
 //#define DEBUG_SAVE_ATLAS
@@ -221,6 +224,12 @@ CDecalsDrawerGL4::CDecalsDrawerGL4()
 	, overlapStage(0)
 	, depthTex(0)
 	, atlasTex(0)
+	, numBakedTilesX(0)
+	, numBakedTilesZ(0)
+	, bakedAlbedoTex(0)
+	, bakedNormalsTex(0)
+	, decalBakeShader(nullptr)
+	, decalBakedShader(nullptr)
 {
 	//if (!GetDrawDecals()) {
 	//	return;
@@ -246,6 +255,8 @@ CDecalsDrawerGL4::CDecalsDrawerGL4()
 	if (!decalShader->IsValid())
 		throw opengl_error(LOG_SECTION_DECALS_GL4 ": cannot compile shader");
 
+	CreateBakedTiles();
+
 	glGenTextures(1, &depthTex);
 	CreateBoundingBoxVBOs();
 	CreateStructureVBOs();
@@ -273,10 +284,14 @@ CDecalsDrawerGL4::~CDecalsDrawerGL4()
 
 	glDeleteTextures(1, &depthTex);
 	glDeleteTextures(1, &atlasTex);
+	glDeleteTextures(1, &bakedAlbedoTex);
+	glDeleteTextures(1, &bakedNormalsTex);
 
 	shaderHandler->ReleaseProgramObjects("[DecalsDrawerGL4]");
 
 	decalShader = nullptr;
+	decalBakeShader = nullptr;
+	decalBakedShader = nullptr;
 	decalDrawer = nullptr;
 }
 
@@ -648,9 +663,14 @@ void CDecalsDrawerGL4::CreateStructureVBOs()
 
 void CDecalsDrawerGL4::ViewResize()
 {
-	decalShader->Enable();
-	decalShader->SetUniform("invScreenSize", 1.f / globalRendering->viewSizeX, 1.f / globalRendering->viewSizeY);
-	decalShader->Disable();
+	for (Shader::IProgramObject* shader: {decalShader, decalBakedShader}) {
+		if (shader == nullptr)
+			continue;
+
+		shader->Enable();
+		shader->SetUniform("invScreenSize", 1.f / globalRendering->viewSizeX, 1.f / globalRendering->viewSizeY);
+		shader->Disable();
+	}
 
 	glBindTexture(GL_TEXTURE_2D, depthTex);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -690,6 +710,9 @@ void CDecalsDrawerGL4::SunChanged()
 		uboGroundLighting.UnmapBuffer();
 	glUniformBlockBinding(decalShader->GetObjID(), uniformBlockIndex, 5);
 	glBindBufferBase(GL_UNIFORM_BUFFER, 5, uboGroundLighting.GetId());
+
+	if (decalBakedShader != nullptr)
+		glUniformBlockBinding(decalBakedShader->GetObjID(), glGetUniformBlockIndex(decalBakedShader->GetObjID(), "SGroundLighting"), 5);
 	uboGroundLighting.Unbind();
 }
 
@@ -723,7 +746,10 @@ void CDecalsDrawerGL4::Draw()
 	if (!GetDrawDecals())
 		return;
 
-	if (!AnyDecalsInView())
+	const bool drawBaked = CollectVisibleBakedTiles();
+	const bool drawLive = AnyDecalsInView();
+
+	if (!drawBaked && !drawLive)
 		return;
 
 	// disable parallax, when we are lagging for a while
@@ -772,17 +798,29 @@ void CDecalsDrawerGL4::Draw()
 	glEnable(GL_ALPHA_TEST);
 	glAlphaFunc(GL_LESS, 1.0f);
 
-	decalShader->SetFlag("HAVE_SHADOWS", shadowHandler.ShadowsLoaded());
-	decalShader->SetFlag("HAVE_INFOTEX", infoTextureHandler->IsEnabled());
-	decalShader->Enable();
-		decalShader->SetUniform3v("camPos", &camera->GetPos()[0]);
-		decalShader->SetUniform3v("camDir", &camera->GetDir()[0]);
+	CMatrix44f vpi = camera->GetViewProjectionMatrixInverse();
+	vpi.Translate(-OnesVector);
+	vpi.Scale(OnesVector * 2.f);
+
+	CMatrix44f sm = shadowHandler.GetShadowMatrix();
+	sm.GetPos() += float3(0.5f, 0.5f, 0.0f);
 
-		CMatrix44f vpi = camera->GetViewProjectionMatrixInverse();
-		vpi.Translate(-OnesVector);
-		vpi.Scale(OnesVector * 2.f);
-		decalShader->SetUniformMatrix4x4("viewProjMatrix", false, camera->GetViewProjectionMatrix().m);
-		decalShader->SetUniformMatrix4x4("viewProjMatrixInv", false, vpi.m);
+	// baked and live decals share the projection and lighting setup
+	const auto EnableShader = [&](Shader::IProgramObject* shader) {
+		shader->SetFlag("HAVE_SHADOWS", shadowHandler.ShadowsLoaded());
+		shader->SetFlag("HAVE_INFOTEX", infoTextureHandler->IsEnabled());
+		shader->Enable();
+		shader->SetUniform3v("camPos", &camera->GetPos()[0]);
+		shader->SetUniform3v("camDir", &camera->GetDir()[0]);
+		shader->SetUniformMatrix4x4("viewProjMatrix", false, camera->GetViewProjectionMatrix().m);
+		shader->SetUniformMatrix4x4("viewProjMatrixInv", false, vpi.m);
+
+		if (!shadowHandler.ShadowsLoaded())
+			return;
+
+		shader->SetUniformMatrix4x4("shadowMatrix", false, sm.m);
+		shader->SetUniform("shadowDensity", sunLighting->groundShadowDensity);
+	};
 
 	const std::array<GLuint,5> textures = {
 		atlasTex,
@@ -793,16 +831,18 @@ void CDecalsDrawerGL4::Draw()
 	};
 	glSpringBindTextures(0, textures.size(), &textures[0]);
 
-	if (shadowHandler.ShadowsLoaded()) {
-		CMatrix44f sm = shadowHandler.GetShadowMatrix();
-		sm.GetPos() += float3(0.5f, 0.5f, 0.0f);
-
-		decalShader->SetUniformMatrix4x4("shadowMatrix", false, sm.m);
-		decalShader->SetUniform("shadowDensity", sunLighting->groundShadowDensity);
+	// Draw; older baked scars first, live decals blend over them
+	if (drawBaked) {
+		EnableShader(decalBakedShader);
+		DrawBakedTiles();
+		decalBakedShader->Disable();
 	}
 
-	// Draw
-	DrawDecals();
+	if (drawLive) {
+		EnableShader(decalShader);
+		DrawDecals();
+		decalShader->Disable();
+	}
 
 	glDisable(GL_DEPTH_CLAMP);
 	glEnable(GL_DEPTH_TEST);
@@ -812,7 +852,6 @@ void CDecalsDrawerGL4::Draw()
 	glDisable(GL_BLEND);
 	glDisable(GL_ALPHA_TEST);
 
-	decalShader->Disable();
 	//if (setTimerQuery) drawTimerQuery.Stop();
 }
 
@@ -872,6 +911,7 @@ void CDecalsDrawerGL4::UpdateDecalsVBO()
 void CDecalsDrawerGL4::Update()
 {
 	SCOPED_TIMER("Update::DecalsDrawerGL4");
+	BakeDirtyTiles();
 	UpdateOverlap();
 	OptimizeGroups();
 	UpdateDecalsVBO();
@@ -1365,6 +1405,313 @@ std::vector<int> CDecalsDrawerGL4::UpdateOverlap_CheckQueries()
 
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void CDecalsDrawerGL4::CreateBakedTiles()
+{
+	GLint maxLayers = 0;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+	const int numLayers = std::min(configHandler->GetInt("GroundDecalsBakedTiles"), maxLayers);
+
+	if (numLayers <= 0)
+		return;
+
+	decalBakeShader = shaderHandler->CreateProgramObject("[DecalsDrawerGL4]", "DecalBakeShader", false);
+	decalBakeShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/DecalsBakeVertGL4.glsl", "", GL_VERTEX_SHADER));
+	decalBakeShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/DecalsBakeFragGL4.glsl", "", GL_FRAGMENT_SHADER));
+	decalBakeShader->SetFlag("SQUARE_SIZE", SQUARE_SIZE);
+	decalBakeShader->Link();
+	decalBakeShader->Enable();
+		decalBakeShader->SetUniform("decalAtlasTex", 0);
+		decalBakeShader->SetUniform("heightMapTex", 1);
+		decalBakeShader->SetUniform("invHeightMapSize", 1.0f / mapDims.mapxp1, 1.0f / mapDims.mapyp1);
+	decalBakeShader->Disable();
+	decalBakeShader->Validate();
+
+	decalBakedShader = shaderHandler->CreateProgramObject("[DecalsDrawerGL4]", "DecalBakedShader", false);
+	decalBakedShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/DecalsVertGL4.glsl", "", GL_VERTEX_SHADER));
+	decalBakedShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/DecalsFragGL4.glsl", "", GL_FRAGMENT_SHADER));
+	decalBakedShader->SetFlag("BAKED_DECALS", true);
+	decalBakedShader->SetFlag("BAKED_TILE_SIZE", BAKED_TILE_SIZE);
+	decalBakedShader->Link();
+	decalBakedShader->Enable();
+		decalBakedShader->SetUniform("invMapSizePO2", 1.0f / (mapDims.pwr2mapx * SQUARE_SIZE), 1.0f / (mapDims.pwr2mapy * SQUARE_SIZE));
+		decalBakedShader->SetUniform("invMapSize",    1.0f / (mapDims.mapx * SQUARE_SIZE),     1.0f / (mapDims.mapy * SQUARE_SIZE));
+		decalBakedShader->SetUniform("bakedAlbedoTex", 5);
+		decalBakedShader->SetUniform("bakedNormalsTex", 6);
+	decalBakedShader->Disable();
+	decalBakedShader->Validate();
+
+	if (!decalBakeShader->IsValid() || !decalBakedShader->IsValid()) {
+		LOG_L(L_WARNING, "[%s] cannot compile decal baking shaders, explosion scars stay live decals", __func__);
+		return;
+	}
+
+	const auto CreateTileArray = [numLayers](GLuint& texID) {
+		glGenTextures(1, &texID);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, texID);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, BAKED_TILE_TEXELS, BAKED_TILE_TEXELS, numLayers);
+	};
+
+	CreateTileArray(bakedAlbedoTex);
+	CreateTileArray(bakedNormalsTex);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	fboBake.Bind();
+	fboBake.AttachTexture(bakedAlbedoTex, GL_TEXTURE_2D_ARRAY, GL_COLOR_ATTACHMENT0, 0, 0);
+	fboBake.AttachTexture(bakedNormalsTex, GL_TEXTURE_2D_ARRAY, GL_COLOR_ATTACHMENT1, 0, 0);
+	const bool fboValid = fboBake.CheckStatus(LOG_SECTION_DECALS_GL4);
+	fboBake.Unbind();
+
+	if (!fboValid)
+		return;
+
+	numBakedTilesX = (mapDims.mapx * SQUARE_SIZE + BAKED_TILE_SIZE - 1) / BAKED_TILE_SIZE;
+	numBakedTilesZ = (mapDims.mapy * SQUARE_SIZE + BAKED_TILE_SIZE - 1) / BAKED_TILE_SIZE;
+
+	bakedTiles.resize(numBakedTilesX * numBakedTilesZ);
+	bakedLayerTiles.resize(numLayers, -1);
+
+	vboBakedTiles.Bind(GL_ARRAY_BUFFER);
+	vboBakedTiles.New(bakedTiles.size() * sizeof(float4), GL_STREAM_DRAW);
+	vboBakedTiles.Unbind();
+}
+
+
+void CDecalsDrawerGL4::BakeDecal(const Decal& d)
+{
+	// corners in world-space, inverse of the decal-space transform in DecalsFragGL4
+	const float c = std::cos(d.rot);
+	const float s = std::sin(d.rot);
+
+	float2 mins = { 1e9f,  1e9f};
+	float2 maxs = {-1e9f, -1e9f};
+
+	for (const float2 corner: {float2(-1.0f, -1.0f), float2(1.0f, -1.0f), float2(-1.0f, 1.0f), float2(1.0f, 1.0f)}) {
+		const float lx = corner.x * d.size.x;
+		const float lz = corner.y * d.size.y;
+		const float2 p = {d.pos.x + c * lx - s * lz, d.pos.z + s * lx + c * lz};
+
+		mins = {std::min(mins.x, p.x), std::min(mins.y, p.y)};
+		maxs = {std::max(maxs.x, p.x), std::max(maxs.y, p.y)};
+	}
+
+	const int x1 = Clamp(int(mins.x) / BAKED_TILE_SIZE, 0, numBakedTilesX - 1);
+	const int z1 = Clamp(int(mins.y) / BAKED_TILE_SIZE, 0, numBakedTilesZ - 1);
+	const int x2 = Clamp(int(maxs.x) / BAKED_TILE_SIZE, 0, numBakedTilesX - 1);
+	const int z2 = Clamp(int(maxs.y) / BAKED_TILE_SIZE, 0, numBakedTilesZ - 1);
+
+	for (int z = z1; z <= z2; ++z) {
+		for (int x = x1; x <= x2; ++x) {
+			const int tileIdx = z * numBakedTilesX + x;
+			SBakedTile& tile = bakedTiles[tileIdx];
+
+			if (tile.layer < 0 && (tile.layer = AllocBakedLayer(tileIdx)) < 0)
+				continue;
+
+			if (tile.pendingDecals.empty())
+				dirtyBakedTiles.push_back(tileIdx);
+
+			tile.pendingDecals.push_back(d);
+		}
+	}
+}
+
+
+int CDecalsDrawerGL4::AllocBakedLayer(int tileIdx)
+{
+	int layer = -1;
+
+	// a free layer, otherwise the one whose tile was drawn longest ago
+	for (int i = 0, lruFrame = std::numeric_limits<int>::max(); i < int(bakedLayerTiles.size()); ++i) {
+		if (bakedLayerTiles[i] < 0) {
+			layer = i;
+			break;
+		}
+
+		const SBakedTile& tile = bakedTiles[bakedLayerTiles[i]];
+
+		// keep tiles whose scars are still queued
+		if (!tile.pendingDecals.empty())
+			continue;
+
+		if (tile.lastUsedFrame < lruFrame) {
+			lruFrame = tile.lastUsedFrame;
+			layer = i;
+		}
+	}
+
+	if (layer < 0)
+		return -1;
+
+	// evicting a tile drops its scars, like FreeDecal does for live ones
+	if (bakedLayerTiles[layer] >= 0)
+		bakedTiles[bakedLayerTiles[layer]].layer = -1;
+
+	bakedLayerTiles[layer] = tileIdx;
+	bakedTiles[tileIdx].clearLayer = true;
+	bakedTiles[tileIdx].lastUsedFrame = globalRendering->drawFrame;
+	return layer;
+}
+
+
+void CDecalsDrawerGL4::BakeDirtyTiles()
+{
+	if (dirtyBakedTiles.empty())
+		return;
+
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+
+	fboBake.Bind();
+	glViewport(0, 0, BAKED_TILE_TEXELS, BAKED_TILE_TEXELS);
+
+	constexpr GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+	glDrawBuffers(2, drawBuffers);
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_ALPHA_TEST);
+
+	// accumulate as DecalsFragGL4 does: rgb := mix(rgb, decal, a) and a := a * (1 - decal.a)
+	glEnable(GL_BLEND);
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, (heightMapTexture != nullptr)? heightMapTexture->GetTextureID(): 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, atlasTex);
+
+	decalBakeShader->Enable();
+	decalBakeShader->SetUniform("heightFade", float(heightMapTexture != nullptr));
+
+	CVertexArray* va = GetVertexArray();
+
+	const int numTiles = std::min(int(dirtyBakedTiles.size()), MAX_BAKED_TILES_PER_UPDATE);
+
+	for (int i = 0; i < numTiles; ++i) {
+		SBakedTile& tile = bakedTiles[dirtyBakedTiles[i]];
+
+		fboBake.AttachTexture(bakedAlbedoTex, GL_TEXTURE_2D_ARRAY, GL_COLOR_ATTACHMENT0, 0, tile.layer);
+		fboBake.AttachTexture(bakedNormalsTex, GL_TEXTURE_2D_ARRAY, GL_COLOR_ATTACHMENT1, 0, tile.layer);
+
+		if (tile.clearLayer) {
+			// no decal yet: full transmittance and an upright normal
+			constexpr float clearAlbedo[] = {0.0f, 0.0f, 0.0f, 1.0f};
+			constexpr float clearNormal[] = {0.5f, 1.0f, 0.5f, 1.0f};
+
+			glClearBufferfv(GL_COLOR, 0, clearAlbedo);
+			glClearBufferfv(GL_COLOR, 1, clearNormal);
+			tile.clearLayer = false;
+		}
+
+		const int tileIdx = dirtyBakedTiles[i];
+		const float2 tileMins = {float((tileIdx % numBakedTilesX) * BAKED_TILE_SIZE), float((tileIdx / numBakedTilesX) * BAKED_TILE_SIZE)};
+
+		decalBakeShader->SetUniform("tileRect", tileMins.x, tileMins.y, 1.0f / BAKED_TILE_SIZE);
+
+		// only the new scars are drawn, on top of what the tile already holds
+		for (const Decal& d: tile.pendingDecals) {
+			const float c = std::cos(d.rot);
+			const float s = std::sin(d.rot);
+
+			decalBakeShader->SetUniform("decalPosAlpha", d.pos.x, d.pos.y, d.pos.z, d.alpha);
+			decalBakeShader->SetUniform("decalRotInvSize", c, s, 1.0f / d.size.x, 1.0f / d.size.y);
+			decalBakeShader->SetUniform4v("texCoords", &d.texOffsets.x);
+			decalBakeShader->SetUniform4v("texNormalsCoords", &d.texNormalOffsets.x);
+
+			va->Initialize();
+			va->AddVertex2dT(-1.0f, -1.0f, 0.0f, 0.0f);
+			va->AddVertex2dT( 1.0f, -1.0f, 1.0f, 0.0f);
+			va->AddVertex2dT(-1.0f,  1.0f, 0.0f, 1.0f);
+			va->AddVertex2dT( 1.0f,  1.0f, 1.0f, 1.0f);
+			va->DrawArray2dT(GL_TRIANGLE_STRIP);
+		}
+
+		tile.pendingDecals.clear();
+	}
+
+	dirtyBakedTiles.erase(dirtyBakedTiles.begin(), dirtyBakedTiles.begin() + numTiles);
+
+	decalBakeShader->Disable();
+	fboBake.Unbind();
+
+	glPopAttrib();
+}
+
+
+bool CDecalsDrawerGL4::CollectVisibleBakedTiles()
+{
+	visibleBakedTiles.clear();
+
+	for (int layer = 0; layer < int(bakedLayerTiles.size()); ++layer) {
+		const int tileIdx = bakedLayerTiles[layer];
+
+		if (tileIdx < 0)
+			continue;
+
+		SBakedTile& tile = bakedTiles[tileIdx];
+
+		// not rasterised yet
+		if (tile.clearLayer)
+			continue;
+
+		const float3 mins = {float((tileIdx % numBakedTilesX) * BAKED_TILE_SIZE), readMap->GetCurrMinHeight(), float((tileIdx / numBakedTilesX) * BAKED_TILE_SIZE)};
+		const float3 maxs = {mins.x + BAKED_TILE_SIZE, readMap->GetCurrMaxHeight(), mins.z + BAKED_TILE_SIZE};
+
+		if (!camera->InView(mins, maxs))
+			continue;
+
+		tile.lastUsedFrame = globalRendering->drawFrame;
+		visibleBakedTiles.emplace_back(mins.x, mins.z, float(layer), 0.0f);
+	}
+
+	return !visibleBakedTiles.empty();
+}
+
+
+void CDecalsDrawerGL4::DrawBakedTiles()
+{
+	decalBakedShader->SetUniform("tileHeights", readMap->GetCurrMinHeight(), readMap->GetCurrMaxHeight());
+
+	glActiveTexture(GL_TEXTURE5);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, bakedAlbedoTex);
+	glActiveTexture(GL_TEXTURE6);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, bakedNormalsTex);
+	glActiveTexture(GL_TEXTURE0);
+
+	vboBakedTiles.Bind(GL_ARRAY_BUFFER);
+	vboBakedTiles.SetBufferSubData(visibleBakedTiles);
+	glVertexAttribPointer(1, 4, GL_FLOAT, false, sizeof(float4), vboBakedTiles.GetPtr());
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(1);
+
+	vboVertices.Bind(GL_ARRAY_BUFFER);
+	vboIndices.Bind(GL_ELEMENT_ARRAY_BUFFER);
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, 0, vboVertices.GetPtr());
+			glDrawElementsInstanced(GL_TRIANGLES, vboIndices.GetSize(), GL_UNSIGNED_BYTE, vboIndices.GetPtr(), visibleBakedTiles.size());
+		glDisableClientState(GL_VERTEX_ARRAY);
+	vboIndices.Unbind();
+	vboVertices.Unbind();
+
+	glDisableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 0);
+
+	glActiveTexture(GL_TEXTURE6);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glActiveTexture(GL_TEXTURE5);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1559,6 +1906,12 @@ void CDecalsDrawerGL4::AddExplosion(float3 pos, float damage, float radius)
 	d.owner = nullptr;
 	d.generation = gs->frameNum;
 
+	// scars never change after creation, no need to keep them live
+	if (!bakedTiles.empty()) {
+		BakeDecal(d);
+		return;
+	}
+
 	NewDecal(d);
 }
 
@@ -126,6 +126,11 @@ public:
 	static constexpr int MAX_OVERLAP = 3;
 	static constexpr int OVERLAP_TEST_TEXTURE_SIZE = 256;
 
+	// explosion scars are baked into a cache of ground tiles instead of taking a decal slot
+	static constexpr int BAKED_TILE_SIZE = 512; // elmos
+	static constexpr int BAKED_TILE_TEXELS = 256;
+	static constexpr int MAX_BAKED_TILES_PER_UPDATE = 4;
+
 	struct Decal {
 	public:
 		Decal()
@@ -228,6 +233,13 @@ private:
 	void DrawDecals();
 	//void DrawTracks();
 
+	void CreateBakedTiles();
+	void BakeDecal(const Decal& d);
+	int AllocBakedLayer(int tileIdx);
+	void BakeDirtyTiles();
+	bool CollectVisibleBakedTiles();
+	void DrawBakedTiles();
+
 private:
 	std::vector<Decal> decals;
 	std::vector<SDecalGroup> groups;
@@ -264,6 +276,30 @@ private:
 	GLuint atlasTex;
 	Shader::IProgramObject* decalShader;
 
+	struct SBakedTile {
+		std::vector<Decal> pendingDecals; ///< rasterised on top of the tile's layer by BakeDirtyTiles
+
+		int layer = -1;
+		int lastUsedFrame = 0;
+		bool clearLayer = false;
+	};
+
+	std::vector<SBakedTile> bakedTiles;
+	std::vector<int> bakedLayerTiles; ///< tile of every cache layer, -1 if free
+	std::vector<int> dirtyBakedTiles;
+	std::vector<float4> visibleBakedTiles; ///< x,z mins and layer per drawn tile
+
+	int numBakedTilesX;
+	int numBakedTilesZ;
+
+	FBO fboBake;
+	VBO vboBakedTiles;
+
+	GLuint bakedAlbedoTex;
+	GLuint bakedNormalsTex;
+	Shader::IProgramObject* decalBakeShader;
+	Shader::IProgramObject* decalBakedShader;
+
 	LegacyTrackHandler trackHandler;
 };
 
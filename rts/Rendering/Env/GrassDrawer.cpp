@@ -1,11 +1,13 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <array>
 #include <cmath>
 
 #include "GrassDrawer.h"
 #include "Game/Camera.h"
 #include "Game/CameraHandler.h"
 #include "Map/Ground.h"
+#include "Map/HeightMapTexture.h"
 #include "Map/MapInfo.h"
 #include "Map/ReadMap.h"
 #include "Rendering/GlobalRendering.h"
@@ -23,6 +25,7 @@
 #include "System/EventHandler.h"
 #include "System/GlobalRNG.h"
 #include "System/SpringMath.h"
+#include "System/float4.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Color.h"
 #include "System/Exceptions.h"
@@ -33,6 +36,7 @@
 #include "System/FileSystem/FileHandler.h"
 
 CONFIG(int, GrassDetail).defaultValue(7).headlessValue(0).minimumValue(0).description("Sets how detailed the engine rendered grass will be on any given map.");
+CONFIG(bool, GPUGrass).defaultValue(false).headlessValue(false).safemodeValue(false).description("Generate, cull and draw grass turfs with a compute shader instead of on the CPU.");
 
 // uses a 'synced' RNG s.t. grass turfs generated from the same
 // seed also share identical sequences, otherwise an unpleasant
@@ -54,6 +58,21 @@ static constexpr int   BMSSQ = SQUARE_SIZE * blockMapSize;
 
 static GrassRNG grng;
 
+// only bound while the turf compute shader runs
+static constexpr int TURFS_WORKGROUP_SIZE = 8;
+static constexpr int GRASS_MAP_SSBO_BINDING_IDX = 2;
+static constexpr int TURFS_SSBO_BINDING_IDX = 3;
+static constexpr int DRAW_CMDS_SSBO_BINDING_IDX = 4;
+// 0 := gl_Vertex, 2 := gl_Normal and 8 := gl_MultiTexCoord0 on some drivers
+static constexpr int TURF_ATTRIB_IDX = 6;
+
+struct SDrawArraysIndirectCommand {
+	uint32_t count;
+	uint32_t instanceCount;
+	uint32_t first;
+	uint32_t baseInstance;
+};
+
 
 
 static float GetGrassBlockCamDist(const int x, const int y, const bool square = false)
@@ -190,6 +209,7 @@ CGrassDrawer::CGrassDrawer()
 	grng.Seed(15);
 
 	const int detail = configHandler->GetInt("GrassDetail");
+	const bool wantGPUGrass = configHandler->GetBool("GPUGrass");
 
 	// load grass density from map
 	{
@@ -246,6 +266,7 @@ CGrassDrawer::CGrassDrawer()
 	grass.resize(blocksX * blocksY);
 	farnearVA.Initialize();
 	grassDL = glGenLists(1);
+	gpuGrass = (wantGPUGrass && InitGPUGrass());
 
 	ChangeDetail(detail);
 	LoadGrassShaders();
@@ -283,6 +304,9 @@ void CGrassDrawer::ChangeDetail(int detail) {
 	CreateGrassDispList(grassDL);
 	CreateFarTex();
 
+	if (gpuGrass)
+		CreateGPUGrassBuffers();
+
 	// reset  all cached blocks
 	for (GrassStruct& pGS: grass) {
 		ResetPos(pGS.posX, pGS.posZ);
@@ -305,15 +329,22 @@ void CGrassDrawer::LoadGrassShaders() {
 	static const std::string shaderNames[GRASS_PROGRAM_LAST] = {
 		"grassNearAdvShader",
 		"grassDistAdvShader",
-		"grassShadGenShader"
+		"grassShadGenShader",
+		"grassNearGPUShader",
+		"grassDistGPUShader"
 	};
 	static const std::string shaderDefines[GRASS_PROGRAM_LAST] = {
 		"#define DISTANCE_NEAR\n",
 		"#define DISTANCE_FAR\n",
-		"#define SHADOW_GEN\n"
+		"#define SHADOW_GEN\n",
+		"#version 430 compatibility\n#define GPU_GRASS\n#define DISTANCE_NEAR\n",
+		"#version 430 compatibility\n#define GPU_GRASS\n#define DISTANCE_FAR\n"
 	};
 
 	for (int i = 0; i < GRASS_PROGRAM_LAST; i++) {
+		if (i >= GRASS_PROGRAM_NEAR_GPU && !gpuGrass)
+			break;
+
 		grassShaders[i] = sh->CreateProgramObject("[GrassDrawer]", shaderNames[i] + "GLSL", false);
 		grassShaders[i]->AttachShaderObject(sh->CreateShaderObject("GLSL/GrassVertProg.glsl", shaderDefines[i], GL_VERTEX_SHADER));
 		grassShaders[i]->AttachShaderObject(sh->CreateShaderObject("GLSL/GrassFragProg.glsl", shaderDefines[i], GL_FRAGMENT_SHADER));
@@ -332,11 +363,22 @@ void CGrassDrawer::LoadGrassShaders() {
 		grassShaders[i]->SetUniform("groundShadowDensity", sunLighting->groundShadowDensity);
 		grassShaders[i]->SetUniformMatrix4x4("shadowMatrix", false, shadowHandler.GetShadowMatrixRaw());
 		grassShaders[i]->SetUniform4v("shadowParams", &shadowHandler.GetShadowParams().x);
+		grassShaders[i]->SetUniform("billboardSize", partTurfSize);
 		grassShaders[i]->Disable();
 		grassShaders[i]->Validate();
 
-		if ((grassOff = !grassShaders[i]->IsValid()))
+		if (grassShaders[i]->IsValid())
+			continue;
+
+		// the CPU path still works without the GPU variants
+		if (i >= GRASS_PROGRAM_NEAR_GPU) {
+			LOG_L(L_WARNING, "[GrassDrawer::%s] GPU grass shaders failed to compile, grass turfs are built on the CPU", __func__);
+			gpuGrass = false;
 			break;
+		}
+
+		grassOff = true;
+		break;
 	}
 
 	#undef sh
@@ -499,6 +541,181 @@ void CGrassDrawer::DrawNearBillboards(const std::vector<InviewNearGrass>& inview
 }
 
 
+bool CGrassDrawer::InitGPUGrass()
+{
+	if (!globalRendering->haveGL4 || !GLEW_ARB_compute_shader || !GLEW_ARB_shader_storage_buffer_object)
+		return false;
+
+	turfsShader = shaderHandler->CreateProgramObject("[GrassDrawer]", "GrassTurfsCompGL4", false);
+	turfsShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/GrassTurfsCompGL4.glsl", "", GL_COMPUTE_SHADER));
+	turfsShader->SetFlag("TURFS_WORKGROUP_SIZE", TURFS_WORKGROUP_SIZE);
+	turfsShader->SetFlag("GRASS_MAP_SSBO_BINDING_IDX", GRASS_MAP_SSBO_BINDING_IDX);
+	turfsShader->SetFlag("TURFS_SSBO_BINDING_IDX", TURFS_SSBO_BINDING_IDX);
+	turfsShader->SetFlag("DRAW_CMDS_SSBO_BINDING_IDX", DRAW_CMDS_SSBO_BINDING_IDX);
+	turfsShader->SetFlag("GRASS_SQUARE_SIZE", GSSSQ);
+	turfsShader->SetFlag("SQUARE_SIZE", SQUARE_SIZE);
+	turfsShader->Link();
+	turfsShader->Enable();
+	turfsShader->SetUniform("heightMapTex", 0);
+	turfsShader->SetUniform("grassMapSize", mapDims.mapx / grassSquareSize, mapDims.mapy / grassSquareSize);
+	turfsShader->SetUniform("turfSize", partTurfSize);
+	turfsShader->Disable();
+	turfsShader->Validate();
+
+	if (!turfsShader->IsValid()) {
+		LOG_L(L_WARNING, "[GrassDrawer::%s] turf compute shader failed to compile, grass turfs are built on the CPU", __func__);
+		return false;
+	}
+
+	// one byte per grass square, packed into uints on the GPU
+	grassMapSSBO = VBO{GL_SHADER_STORAGE_BUFFER, false};
+	grassMapSSBO.Bind();
+	grassMapSSBO.New(((grassMap.size() + 3) / 4) * 4, GL_STATIC_DRAW);
+	grassMapSSBO.SetBufferSubData(0, grassMap.size(), grassMap.data());
+	grassMapSSBO.Unbind();
+
+	const std::array<SDrawArraysIndirectCommand, 2> drawCmds = {};
+
+	drawCmdsVBO = VBO{GL_DRAW_INDIRECT_BUFFER, false};
+	drawCmdsVBO.Bind();
+	drawCmdsVBO.New(sizeof(drawCmds), GL_STREAM_DRAW, drawCmds.data());
+	drawCmdsVBO.Unbind();
+
+	bladeVBO = VBO{GL_ARRAY_BUFFER, false};
+	turfsVBO = VBO{GL_ARRAY_BUFFER, false};
+	return true;
+}
+
+void CGrassDrawer::CreateGPUGrassBuffers()
+{
+	// every square within maxGrassDist of the camera can emit numTurfs meshes or billboards
+	turfWindowSize = 2 * int(std::ceil(maxGrassDist / GSSSQ)) + 2;
+	turfWindowSize = std::min(turfWindowSize, std::max(mapDims.mapx, mapDims.mapy) / grassSquareSize);
+	turfCapacity = Square(turfWindowSize) * numTurfs;
+
+	bladeVBO.Bind();
+	bladeVBO.New(bladeVerts.size() * sizeof(VA_TYPE_TN), GL_STATIC_DRAW, bladeVerts.data());
+	bladeVBO.Unbind();
+
+	turfsVBO.Bind();
+	turfsVBO.New(turfCapacity * 2 * sizeof(float4), GL_DYNAMIC_COPY);
+	turfsVBO.Unbind();
+
+	const auto BindTurfAttrib = [this]() {
+		turfsVBO.Bind();
+		glEnableVertexAttribArray(TURF_ATTRIB_IDX);
+		glVertexAttribDivisor(TURF_ATTRIB_IDX, 1);
+		glVertexAttribPointer(TURF_ATTRIB_IDX, 4, GL_FLOAT, false, sizeof(float4), nullptr);
+	};
+
+	bladeVAO.Bind();
+	bladeVBO.Bind();
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(VA_TYPE_TN), reinterpret_cast<const void*>(offsetof(VA_TYPE_TN, p)));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(VA_TYPE_TN), reinterpret_cast<const void*>(offsetof(VA_TYPE_TN, s)));
+	glNormalPointer(GL_FLOAT, sizeof(VA_TYPE_TN), reinterpret_cast<const void*>(offsetof(VA_TYPE_TN, n)));
+	BindTurfAttrib();
+	bladeVAO.Unbind();
+
+	billboardVAO.Bind();
+	BindTurfAttrib();
+	billboardVAO.Unbind();
+
+	turfsVBO.Unbind();
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableVertexAttribArray(TURF_ATTRIB_IDX);
+	glVertexAttribDivisor(TURF_ATTRIB_IDX, 0);
+
+	updateVisibility = true;
+}
+
+void CGrassDrawer::UpdateGPUGrassMap(const int grassSquareIdx)
+{
+	if (!gpuGrass)
+		return;
+
+	grassMapSSBO.Bind();
+	grassMapSSBO.SetBufferSubData(grassSquareIdx, 1, &grassMap[grassSquareIdx]);
+	grassMapSSBO.Unbind();
+}
+
+void CGrassDrawer::UpdateGPUTurfs()
+{
+	// turfs only depend on the camera, grass- and heightmap; wind is animated per-vertex
+	if (!updateVisibility || heightMapTexture == nullptr)
+		return;
+
+	updateVisibility = false;
+
+	const CCamera* cam = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
+	const float3& camPos = cam->GetPos();
+
+	const int grassMapSizeX = mapDims.mapx / grassSquareSize;
+	const int grassMapSizeZ = mapDims.mapy / grassSquareSize;
+
+	const int x1 = Clamp(int(camPos.x / GSSSQ) - turfWindowSize / 2, 0, grassMapSizeX);
+	const int z1 = Clamp(int(camPos.z / GSSSQ) - turfWindowSize / 2, 0, grassMapSizeZ);
+	const int x2 = std::min(x1 + turfWindowSize, grassMapSizeX);
+	const int z2 = std::min(z1 + turfWindowSize, grassMapSizeZ);
+
+	// the compute pass only fills in instanceCount
+	const std::array<SDrawArraysIndirectCommand, 2> drawCmds = {{
+		{uint32_t(bladeVerts.size()), 0, 0, 0},
+		{4, 0, 0, uint32_t(turfCapacity)},
+	}};
+
+	drawCmdsVBO.Bind(GL_SHADER_STORAGE_BUFFER);
+	drawCmdsVBO.SetBufferSubData(0, sizeof(drawCmds), drawCmds.data());
+	drawCmdsVBO.Unbind();
+
+	if (x2 <= x1 || z2 <= z1)
+		return;
+
+	grassMapSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, GRASS_MAP_SSBO_BINDING_IDX, 0, grassMapSSBO.GetSize());
+	turfsVBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, TURFS_SSBO_BINDING_IDX, 0, turfsVBO.GetSize());
+	drawCmdsVBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_CMDS_SSBO_BINDING_IDX, 0, drawCmdsVBO.GetSize());
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, heightMapTexture->GetTextureID());
+
+	turfsShader->Enable();
+	turfsShader->SetUniform("squareWindow", x1, z1, x2 - x1, z2 - z1);
+	turfsShader->SetUniform("numTurfs", numTurfs);
+	turfsShader->SetUniform("turfCapacity", turfCapacity);
+	turfsShader->SetUniform("cameraPos", camPos.x, camPos.y, camPos.z);
+	turfsShader->SetUniform("grassParams", maxGrassDist, maxDetailedDist, mapInfo->grass.bladeHeight, 0.0f);
+	turfsShader->SetUniformMatrix4x4("cameraViewProj", false, &cam->GetViewProjectionMatrix().m[0]);
+
+	glDispatchCompute((x2 - x1 + TURFS_WORKGROUP_SIZE - 1) / TURFS_WORKGROUP_SIZE, (z2 - z1 + TURFS_WORKGROUP_SIZE - 1) / TURFS_WORKGROUP_SIZE, 1);
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+	turfsShader->Disable();
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	drawCmdsVBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_CMDS_SSBO_BINDING_IDX, 0, drawCmdsVBO.GetSize());
+	turfsVBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, TURFS_SSBO_BINDING_IDX, 0, turfsVBO.GetSize());
+	grassMapSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, GRASS_MAP_SSBO_BINDING_IDX, 0, grassMapSSBO.GetSize());
+}
+
+void CGrassDrawer::DrawGPUTurfs(const bool billboards)
+{
+	const VAO& vao = billboards? billboardVAO: bladeVAO;
+
+	// billboards are spanned from gl_VertexID, not sorted by distance
+	vao.Bind();
+	drawCmdsVBO.Bind(GL_DRAW_INDIRECT_BUFFER);
+	glDrawArraysIndirect(billboards? GL_TRIANGLE_STRIP: GL_TRIANGLES, reinterpret_cast<const void*>(billboards? sizeof(SDrawArraysIndirectCommand): 0));
+	drawCmdsVBO.Unbind();
+	vao.Unbind();
+}
+
+
 void CGrassDrawer::Update()
 {
 	// grass is never drawn in any special (non-opaque) pass
@@ -508,6 +725,13 @@ void CGrassDrawer::Update()
 	updateVisibility |= (oldCamPos != cam->GetPos());
 	updateVisibility |= (oldCamDir != cam->GetDir());
 
+	if (gpuGrass) {
+		// consumed by UpdateGPUTurfs
+		oldCamPos = cam->GetPos();
+		oldCamDir = cam->GetDir();
+		return;
+	}
+
 	if (updateVisibility) {
 		oldCamPos = cam->GetPos();
 		oldCamDir = cam->GetDir();
@@ -554,6 +778,23 @@ void CGrassDrawer::Draw()
 	glPushAttrib(GL_CURRENT_BIT);
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 
+	if (gpuGrass) {
+		UpdateGPUTurfs();
+
+		SetupGlStateNear();
+			DrawGPUTurfs(false);
+		ResetGlStateNear();
+
+		if (!shadowHandler.ShadowsLoaded() || !globalRendering->amdHacks) {
+			SetupGlStateFar();
+				DrawGPUTurfs(true);
+			ResetGlStateFar();
+		}
+
+		glPopAttrib();
+		return;
+	}
+
 	if (!blockDrawer.inviewGrass.empty()) {
 		SetupGlStateNear();
 			DrawNear(blockDrawer.inviewGrass);
@@ -644,7 +885,7 @@ void CGrassDrawer::SetupGlStateNear()
 
 	// bind shader
 	if (globalRendering->haveGLSL) {
-		EnableShader(GRASS_PROGRAM_NEAR);
+		EnableShader(gpuGrass? GRASS_PROGRAM_NEAR_GPU: GRASS_PROGRAM_NEAR);
 
 		if (shadowHandler.ShadowsLoaded())
 			shadowHandler.SetupShadowTexSampler(GL_TEXTURE4);
@@ -755,7 +996,7 @@ void CGrassDrawer::SetupGlStateFar()
 		glPushMatrix();
 		glLoadIdentity();
 
-	EnableShader(GRASS_PROGRAM_DIST);
+	EnableShader(gpuGrass? GRASS_PROGRAM_DIST_GPU: GRASS_PROGRAM_DIST);
 
 	glActiveTextureARB(GL_TEXTURE0_ARB);
 		glBindTexture(GL_TEXTURE_2D, farTex);
@@ -802,6 +1043,15 @@ void CGrassDrawer::CreateGrassDispList(int listNum)
 	va->Initialize();
 	grng.Seed(15);
 
+	// the GPU path draws all blades of a turf in one instanced call, unrolled into triangles
+	std::vector<VA_TYPE_TN> bladeStrip;
+	bladeVerts.clear();
+
+	const auto AddVertex = [&](const float3& pos, float s, float t, const float3& n) {
+		va->AddVertexTN(pos, s, t, n);
+		bladeStrip.push_back({pos, s, t, n});
+	};
+
 	for (int a = 0; a < strawPerTurf; ++a) {
 		// draw a single blade
 		const float lngRnd = grng.NextFloat();
@@ -824,8 +1074,8 @@ void CGrassDrawer::CreateGrassDispList(int listNum)
 		float3 normalBend = -bendVect;
 
 		// start btm
-		va->AddVertexTN(basePos + sideVect - float3(0.0f, 3.0f, 0.0f), xtexCoord              , 0.f, normalBend);
-		va->AddVertexTN(basePos - sideVect - float3(0.0f, 3.0f, 0.0f), xtexCoord + (1.0f / 16), 0.f, normalBend);
+		AddVertex(basePos + sideVect - float3(0.0f, 3.0f, 0.0f), xtexCoord              , 0.f, normalBend);
+		AddVertex(basePos - sideVect - float3(0.0f, 3.0f, 0.0f), xtexCoord + (1.0f / 16), 0.f, normalBend);
 
 		for (float h = 0.0f; h < 1.0f; h += (1.0f / numSections)) {
 			const float ang = maxAng * h;
@@ -834,14 +1084,23 @@ void CGrassDrawer::CreateGrassDispList(int listNum)
 			const float3 edgePosL = edgePos - sideVect * (1.0f - h);
 			const float3 edgePosR = edgePos + sideVect * (1.0f - h);
 
-			va->AddVertexTN(basePos + edgePosR, xtexCoord + (1.0f / 32) * h              , h, (n + sideVect * 0.04f).ANormalize());
-			va->AddVertexTN(basePos + edgePosL, xtexCoord - (1.0f / 32) * h + (1.0f / 16), h, (n - sideVect * 0.04f).ANormalize());
+			AddVertex(basePos + edgePosR, xtexCoord + (1.0f / 32) * h              , h, (n + sideVect * 0.04f).ANormalize());
+			AddVertex(basePos + edgePosL, xtexCoord - (1.0f / 32) * h + (1.0f / 16), h, (n - sideVect * 0.04f).ANormalize());
 		}
 
 		// end top tip (single triangle)
 		const float3 edgePos = (UpVector * std::cos(maxAng) + bendVect * std::sin(maxAng)) * length;
 		const float3 n = (normalBend * std::cos(maxAng) + UpVector * std::sin(maxAng)).ANormalize();
-		va->AddVertexTN(basePos + edgePos, xtexCoord + (1.0f / 32), 1.0f, n);
+		AddVertex(basePos + edgePos, xtexCoord + (1.0f / 32), 1.0f, n);
+
+		// keep the strip winding when unrolling
+		for (size_t i = 2; i < bladeStrip.size(); i++) {
+			bladeVerts.push_back(bladeStrip[i - 2 + (i & 1)]);
+			bladeVerts.push_back(bladeStrip[i - 1 - (i & 1)]);
+			bladeVerts.push_back(bladeStrip[i]);
+		}
+
+		bladeStrip.clear();
 
 		// next blade
 		va->EndStrip();
@@ -1045,6 +1304,7 @@ void CGrassDrawer::AddGrass(const float3& pos, const uint8_t grassValue)
 	assert(z >= 0 && z < (mapDims.mapy / grassSquareSize));
 
 	grassMap[z * mapDims.mapx / grassSquareSize + x] = grassValue;
+	UpdateGPUGrassMap(z * mapDims.mapx / grassSquareSize + x);
 	ResetPos(pos);
 }
 
@@ -1059,6 +1319,7 @@ void CGrassDrawer::RemoveGrass(const float3& pos)
 	assert(z >= 0 && z < (mapDims.mapy / grassSquareSize));
 
 	grassMap[z * mapDims.mapx / grassSquareSize + x] = 0;
+	UpdateGPUGrassMap(z * mapDims.mapx / grassSquareSize + x);
 	ResetPos(pos);
 }
 
@@ -5,6 +5,8 @@
 
 #include <vector>
 
+#include "Rendering/GL/VAO.h"
+#include "Rendering/GL/VBO.h"
 #include "Rendering/GL/VertexArray.h"
 #include "System/float3.h"
 #include "System/EventClient.h"
@@ -70,7 +72,9 @@ public:
 		GRASS_PROGRAM_NEAR        = 0,
 		GRASS_PROGRAM_DIST        = 1,
 		GRASS_PROGRAM_SHADOW_GEN  = 2,
-		GRASS_PROGRAM_LAST        = 3
+		GRASS_PROGRAM_NEAR_GPU    = 3,
+		GRASS_PROGRAM_DIST_GPU    = 4,
+		GRASS_PROGRAM_LAST        = 5
 	};
 
 protected:
@@ -91,6 +95,13 @@ protected:
 
 	void ResetPos(const int grassBlockX, const int grassBlockZ);
 
+	// GPU turf generation, see GrassTurfsCompGL4.glsl
+	bool InitGPUGrass();
+	void CreateGPUGrassBuffers();
+	void UpdateGPUGrassMap(const int grassSquareIdx);
+	void UpdateGPUTurfs();
+	void DrawGPUTurfs(const bool billboards);
+
 protected:
 	friend class CGrassBlockDrawer;
 
@@ -115,11 +126,28 @@ protected:
 	int numTurfs;
 	int strawPerTurf;
 
+	// blade mesh of one turf as GL_TRIANGLES, mirrors grassDL
+	std::vector<VA_TYPE_TN> bladeVerts;
+
+	VAO bladeVAO;
+	VAO billboardVAO;
+	VBO bladeVBO;
+	VBO turfsVBO;
+	VBO grassMapSSBO;
+	VBO drawCmdsVBO;
+
+	Shader::IProgramObject* turfsShader = nullptr;
+
+	// turfs per region of turfsVBO, the near meshes come first
+	int turfCapacity = 0;
+	int turfWindowSize = 0;
+
 	float3 oldCamPos;
 	float3 oldCamDir;
 	int lastVisibilityUpdate;
 
 	bool grassOff;
+	bool gpuGrass = false;
 	bool updateBillboards;
 	bool updateVisibility;
 };
@@ -83,13 +83,17 @@ bool FlyingPiece::Update()
 	pos        = pos0 + (speed * dragFactors.x) + UpVector * (mapInfo->map.gravity * dragFactors.y);
 	drawRadius = pieceRadius + EXPLOSION_SPEED * dragFactors.x + 10.f;
 
-	// check visibility (if all particles are underground -> kill)
-	if ((age % GAME_SPEED) == 0)
+	// check visibility (if all particles are underground -> kill) once per second
+	if ((age % GAME_SPEED) != 0)
 		return true;
 
-	for (auto& cp: splitterParts) {
-		const CMatrix44f& m = GetMatrixOf(cp, dragFactors);
-		const float3 p = m.GetPos();
+	// the rotation in GetMatrixOf is applied in piece space and does not
+	// move the origin, so the full matrix is not needed for the position
+	const float3 gravityOffset = UpVector * (mapInfo->map.gravity * dragFactors.y);
+
+	for (const auto& cp: splitterParts) {
+		const float3 p = bposeMatrix.GetPos() + cp.speed * dragFactors.x + gravityOffset;
+
 		if ((p.y + pieceRadius * 2.f) >= CGround::GetApproximateHeight(p.x, p.z, false)) {
 			return true;
 		}
@@ -6,9 +6,12 @@
 #include "Game/Camera.h"
 #include "Game/GlobalUnsynced.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/ShadowHandler.h"
+#include "Rendering/Env/Particles/GPUParticleSystems.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/GL/VertexArray.h"
 #include "Rendering/Textures/ColorMap.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Projectiles/ExpGenSpawnableMemberInfo.h"
 #include "Sim/Projectiles/ProjectileMemPool.h"
 #include "System/creg/DefTypes.h"
@@ -40,7 +43,9 @@ CR_REG_METADATA(CSimpleParticleSystem,
 		CR_MEMBER(sizeGrowth),
 		CR_MEMBER(sizeMod),
 	CR_MEMBER_ENDFLAG(CM_Config),
-	CR_MEMBER(particles)
+	CR_MEMBER(particles),
+	CR_IGNORED(gpuEmitterIdx),
+	CR_IGNORED(gpuDeathFrame)
 ))
 
 CR_BIND(CSimpleParticleSystem::Particle, )
@@ -78,19 +83,37 @@ CSimpleParticleSystem::CSimpleParticleSystem()
 	, sizeGrowth(0.0f)
 	, sizeMod(0.0f)
 	, numParticles(0)
+	, gpuEmitterIdx(GPUParticleSystems::INVALID_INDEX)
+	, gpuDeathFrame(0)
 {
 	checkCol = false;
 	useAirLos = true;
 }
 
+CSimpleParticleSystem::~CSimpleParticleSystem()
+{
+	particles.clear();
+
+	if (gpuEmitterIdx != GPUParticleSystems::INVALID_INDEX)
+		GPUParticleSystems::GetInstance().DelEmitter(gpuEmitterIdx);
+}
+
 void CSimpleParticleSystem::Draw(CVertexArray* va)
 {
-	va->EnlargeArrays(numParticles * 4, 0, VA_SIZE_TC);
+	if (gpuEmitterIdx != GPUParticleSystems::INVALID_INDEX) {
+		// batched after fxVA by CProjectileDrawer; GPU systems cast no shadows
+		if (!shadowHandler.InShadowPass())
+			GPUParticleSystems::GetInstance().QueueDraw(gpuEmitterIdx);
+
+		return;
+	}
+
+	va->EnlargeArrays(particles.size() * 4, 0, VA_SIZE_TC);
 
 	std::array<float3, 4> bounds;
 
 	if (directional) {
-		for (int i = 0; i < numParticles; i++) {
+		for (size_t i = 0; i < particles.size(); i++) {
 			const Particle* p = &particles[i];
 
 			if (p->life >= 1.0f)
@@ -144,7 +167,7 @@ void CSimpleParticleSystem::Draw(CVertexArray* va)
 	}
 
 	// !directional
-	for (int i = 0; i < numParticles; i++) {
+	for (size_t i = 0; i < particles.size(); i++) {
 		const Particle* p = &particles[i];
 
 		if (p->life >= 1.0f)
@@ -178,6 +201,11 @@ void CSimpleParticleSystem::Draw(CVertexArray* va)
 
 void CSimpleParticleSystem::Update()
 {
+	if (gpuEmitterIdx != GPUParticleSystems::INVALID_INDEX) {
+		deleteMe = (gs->frameNum >= gpuDeathFrame);
+		return;
+	}
+
 	deleteMe = true;
 
 	for (auto& p: particles) {
@@ -228,6 +256,48 @@ void CSimpleParticleSystem::Init(const CUnit* owner, const float3& offset)
 	}
 
 	drawRadius = (particleSpeed + particleSpeedSpread) * (particleLife * particleLifeSpread);
+
+	if (!GPUParticleSystems::GetInstance().IsEnabled())
+		return;
+
+	std::vector<GPUParticleData> gpuParticles(particles.size());
+
+	for (size_t i = 0; i < particles.size(); i++) {
+		const Particle& p = particles[i];
+
+		gpuParticles[i].posDecay = {p.pos, p.decayrate};
+		gpuParticles[i].speedSize = {p.speed, p.size};
+		gpuParticles[i].rotVal = p.rotVal;
+		gpuParticles[i].rotVel = p.rotVel;
+	}
+
+	if (InitGPUParticles(gpuParticles, rotParams.y))
+		particles.clear();
+}
+
+bool CSimpleParticleSystem::InitGPUParticles(std::vector<GPUParticleData>& gpuParticles, float rotAccel)
+{
+	GPUEmitterData emitter;
+
+	if (!GPUParticleSystems::SetEmitterParams(emitter, colorMap, texture))
+		return false;
+
+	emitter.gravityAirdrag = {gravity, airdrag};
+	emitter.growthParams = {sizeMod, sizeGrowth, rotAccel, 0.0f};
+	emitter.directional = directional;
+
+	if ((gpuEmitterIdx = GPUParticleSystems::GetInstance().AddEmitter(emitter, gpuParticles)) == GPUParticleSystems::INVALID_INDEX)
+		return false;
+
+	// the CPU path removes the system on the first update after all particles died
+	int lifeFrames = 0;
+
+	for (const GPUParticleData& p: gpuParticles) {
+		lifeFrames = std::max(lifeFrames, static_cast<int>(std::ceil(1.0f / p.posDecay.w)));
+	}
+
+	gpuDeathFrame = gs->frameNum + lifeFrames + 1;
+	return true;
 }
 
 int CSimpleParticleSystem::GetProjectilesCount() const
@@ -269,6 +339,22 @@ CR_BIND_DERIVED(CSphereParticleSpawner, CSimpleParticleSystem, )
 
 CR_REG_METADATA(CSphereParticleSpawner, )
 
+void CSphereParticleSpawner::Draw(CVertexArray* va)
+{
+	if (gpuEmitterIdx != GPUParticleSystems::INVALID_INDEX)
+		CSimpleParticleSystem::Draw(va);
+}
+
+void CSphereParticleSpawner::Update()
+{
+	if (gpuEmitterIdx != GPUParticleSystems::INVALID_INDEX) {
+		CSimpleParticleSystem::Update();
+		return;
+	}
+
+	deleteMe = true;
+}
+
 void CSphereParticleSpawner::Init(const CUnit* owner, const float3& offset)
 {
 	const float3 up = emitVector;
@@ -285,6 +371,9 @@ void CSphereParticleSpawner::Init(const CUnit* owner, const float3& offset)
 		LOG_L(L_WARNING, "[CSphereParticleSpawner::%s] no texture specified", __FUNCTION__);
 	}
 
+	if (GPUParticleSystems::GetInstance().IsEnabled() && InitGPU(owner, offset, up, right, forward))
+		return;
+
 	for (int i = 0; i < numParticles; i++) {
 		const float az = guRNG.NextFloat() * math::TWOPI;
 		const float ay = (emitRot + emitRotSpread*guRNG.NextFloat()) * math::DEG_TO_RAD;
@@ -313,6 +402,32 @@ void CSphereParticleSpawner::Init(const CUnit* owner, const float3& offset)
 	deleteMe = true;
 }
 
+bool CSphereParticleSpawner::InitGPU(const CUnit* owner, const float3& offset, const float3& up, const float3& right, const float3& forward)
+{
+	// one GPU system instead of numParticles CGenericParticleProjectile's; those do not rotate
+	std::vector<GPUParticleData> gpuParticles(numParticles);
+
+	for (GPUParticleData& p: gpuParticles) {
+		const float az = guRNG.NextFloat() * math::TWOPI;
+		const float ay = (emitRot + emitRotSpread*guRNG.NextFloat()) * math::DEG_TO_RAD;
+
+		const float3 pspeed = ((up * emitMul.y) * std::cos(ay) - ((right * emitMul.x) * std::cos(az) - (forward * emitMul.z) * std::sin(az)) * std::sin(ay)) * (particleSpeed + (guRNG.NextFloat() * particleSpeedSpread));
+
+		p.posDecay = {pos + offset, 1.0f / (particleLife + guRNG.NextFloat() * particleLifeSpread)};
+		p.speedSize = {pspeed, particleSize + guRNG.NextFloat() * particleSizeSpread};
+		p.rotVal = 0.0f;
+		p.rotVel = 0.0f;
+	}
+
+	if (!InitGPUParticles(gpuParticles, 0.0f))
+		return false;
+
+	CProjectile::Init(owner, offset);
+
+	drawRadius = (particleSpeed + particleSpeedSpread) * (particleLife + particleLifeSpread) + particleSize + particleSizeSpread;
+	return true;
+}
+
 bool CSphereParticleSpawner::GetMemberInfo(SExpGenSpawnableMemberInfo& memberInfo)
 {
 	return CSimpleParticleSystem::GetMemberInfo(memberInfo);
@@ -9,6 +9,7 @@
 
 class CUnit;
 class CColorMap;
+struct GPUParticleData;
 
 class CSimpleParticleSystem : public CProjectile
 {
@@ -17,7 +18,7 @@ class CSimpleParticleSystem : public CProjectile
 
 public:
 	CSimpleParticleSystem();
-	virtual ~CSimpleParticleSystem() { particles.clear(); }
+	virtual ~CSimpleParticleSystem();
 
 	void Draw(CVertexArray* va) override;
 	void Update() override;
@@ -68,8 +69,16 @@ protected:
 		float sizeMod;
 	};
 
+protected:
+	// hands the particles to GPUParticleSystems, false if they stay on the CPU
+	bool InitGPUParticles(std::vector<GPUParticleData>& gpuParticles, float rotAccel);
+
 protected:
 	 std::vector<Particle> particles;
+
+	// not saved, a loaded system without CPU particles just expires
+	size_t gpuEmitterIdx;
+	int gpuDeathFrame;
 };
 
 /**
@@ -83,11 +92,14 @@ class CSphereParticleSpawner : public CSimpleParticleSystem
 public:
 	CSphereParticleSpawner() {}
 
-	void Draw(CVertexArray* va) override {}
-	void Update() override {}
+	void Draw(CVertexArray* va) override;
+	void Update() override;
 	void Init(const CUnit* owner, const float3& offset) override;
 
 	static bool GetMemberInfo(SExpGenSpawnableMemberInfo& memberInfo);
+
+private:
+	bool InitGPU(const CUnit* owner, const float3& offset, const float3& up, const float3& right, const float3& forward);
 };
 
 #endif // SIMPLE_PARTICLE_SYSTEM_H
@@ -0,0 +1,269 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "GPUParticleSystems.h"
+
+#include <algorithm>
+#include <type_traits>
+
+#include "Game/Camera.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "Rendering/Shaders/Shader.h"
+#include "Rendering/Textures/ColorMap.h"
+#include "Rendering/Textures/TextureAtlas.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+
+CONFIG(bool, GPUParticleSystems).defaultValue(false).headlessValue(false).safemodeValue(false).description("Animate and draw CEG simple-particle systems and sphere-particle spawners on the GPU.");
+
+
+static void ExtendRange(std::array<size_t, 2>& range, size_t first, size_t count)
+{
+	range[0] = std::min(range[0], first);
+	range[1] = std::max(range[1], first + count);
+}
+
+
+GPUParticleSystems& GPUParticleSystems::GetInstance()
+{
+	static GPUParticleSystems instance;
+	return instance;
+}
+
+bool GPUParticleSystems::IsEnabled()
+{
+	if (state >= 0)
+		return (state > 0);
+
+	state = 0;
+
+	if (!configHandler->GetBool("GPUParticleSystems"))
+		return false;
+	if (!globalRendering->haveGL4)
+		return false;
+
+	if (!InitResources()) {
+		LOG_L(L_WARNING, "[GPUParticleSystems::%s] particle shader failed to compile, particle systems are drawn on the CPU", __func__);
+		return false;
+	}
+
+	state = 1;
+	return true;
+}
+
+bool GPUParticleSystems::InitResources()
+{
+	shader = shaderHandler->CreateProgramObject("[GPUParticleSystems]", "GPUParticles", false);
+	shader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/GPUParticlesVertProg.glsl", "", GL_VERTEX_SHADER));
+	shader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/GPUParticlesFragProg.glsl", "", GL_FRAGMENT_SHADER));
+	shader->SetFlag("EMITTERS_SSBO_BINDING_IDX", EMITTERS_SSBO_BINDING_IDX);
+	shader->SetFlag("MAX_COLORS", GPUEmitterData::MAX_COLORS);
+	shader->Link();
+	shader->Enable();
+	shader->SetUniform("atlasTex", 0);
+	shader->Disable();
+	shader->Validate();
+
+	if (!shader->IsValid())
+		return false;
+
+	particlesVBO = VBO{GL_ARRAY_BUFFER, false};
+	emittersSSBO = VBO{GL_SHADER_STORAGE_BUFFER, false};
+	drawCmdsVBO = VBO{GL_DRAW_INDIRECT_BUFFER, false};
+
+	// reserve some room up front, grown on demand by FlushUploads
+	particlesVBO.Bind();
+	particlesVBO.New(std::max(particles.GetSize(), size_t(1 << 14)) * sizeof(GPUParticleData), GL_STATIC_DRAW);
+	particlesVBO.Unbind();
+
+	emittersSSBO.Bind();
+	emittersSSBO.New(std::max(emitters.GetSize(), size_t(1 << 10)) * sizeof(GPUEmitterData), GL_STATIC_DRAW);
+	emittersSSBO.Unbind();
+
+	vao.Bind();
+	particlesVBO.Bind();
+
+	for (int i = 0; i <= 3; ++i) {
+		glEnableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 1);
+	}
+
+	glVertexAttribPointer (0, 4, GL_FLOAT       , false, sizeof(GPUParticleData), (const void*)offsetof(GPUParticleData, posDecay  ));
+	glVertexAttribPointer (1, 4, GL_FLOAT       , false, sizeof(GPUParticleData), (const void*)offsetof(GPUParticleData, speedSize ));
+	glVertexAttribPointer (2, 2, GL_FLOAT       , false, sizeof(GPUParticleData), (const void*)offsetof(GPUParticleData, rotVal    ));
+	glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT,        sizeof(GPUParticleData), (const void*)offsetof(GPUParticleData, emitterIdx));
+
+	vao.Unbind();
+	particlesVBO.Unbind();
+
+	for (int i = 0; i <= 3; ++i) {
+		glDisableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 0);
+	}
+
+	// systems registered before a reload still need their data on the GPU
+	ExtendRange(dirtyParticles, 0, particles.GetSize());
+	ExtendRange(dirtyEmitters, 0, emitters.GetSize());
+	return true;
+}
+
+void GPUParticleSystems::Kill()
+{
+	// CPU-side copies are kept; live systems release their ranges on destruction
+	if (shader != nullptr)
+		shaderHandler->ReleaseProgramObjects("[GPUParticleSystems]");
+
+	shader = nullptr;
+
+	particlesVBO = VBO{};
+	emittersSSBO = VBO{};
+	drawCmdsVBO = VBO{};
+	vao.Delete();
+
+	queuedEmitters.clear();
+	state = -1;
+}
+
+
+bool GPUParticleSystems::SetEmitterParams(GPUEmitterData& emitter, const CColorMap* colorMap, const AtlasedTexture* texture)
+{
+	const std::vector<SColor>& colors = colorMap->GetColors();
+
+	if (colors.size() > GPUEmitterData::MAX_COLORS)
+		return false;
+
+	if (colors.empty()) {
+		// matches the grey CColorMap::GetColor returns for a dummy map
+		emitter.colors[0] = SColor(128, 128, 128, 255);
+		emitter.colors[1] = SColor(128, 128, 128, 255);
+		emitter.numColors = 2;
+	} else {
+		std::copy(colors.begin(), colors.end(), emitter.colors.begin());
+		emitter.numColors = colors.size();
+	}
+
+	emitter.texCoords = *texture;
+	emitter.createFrame = gs->frameNum;
+	return true;
+}
+
+size_t GPUParticleSystems::AddEmitter(const GPUEmitterData& emitter, std::vector<GPUParticleData>& newParticles)
+{
+	if (newParticles.empty())
+		return INVALID_INDEX;
+
+	const size_t emitterIdx = emitters.Allocate(1);
+	const size_t particlesIdx = particles.Allocate(newParticles.size());
+
+	emitters[emitterIdx] = emitter;
+
+	for (GPUParticleData& p: newParticles) {
+		p.emitterIdx = emitterIdx;
+	}
+
+	std::copy(newParticles.begin(), newParticles.end(), particles.GetData().begin() + particlesIdx);
+
+	if (emitterIdx >= emitterRanges.size())
+		emitterRanges.resize(emitterIdx + 1);
+
+	emitterRanges[emitterIdx] = {static_cast<uint32_t>(particlesIdx), static_cast<uint32_t>(newParticles.size())};
+
+	ExtendRange(dirtyEmitters, emitterIdx, 1);
+	ExtendRange(dirtyParticles, particlesIdx, newParticles.size());
+	return emitterIdx;
+}
+
+void GPUParticleSystems::DelEmitter(size_t emitterIdx)
+{
+	if (emitterIdx >= emitterRanges.size())
+		return;
+
+	const EmitterRange range = emitterRanges[emitterIdx];
+
+	if (range.numParticles == 0)
+		return;
+
+	// freed slots are overwritten before they are drawn again, no need to upload
+	particles.Free(range.particlesIdx, range.numParticles);
+	emitters.Free(emitterIdx, 1);
+
+	emitterRanges[emitterIdx] = {0, 0};
+}
+
+
+void GPUParticleSystems::FlushUploads()
+{
+	const auto UploadRange = [](VBO& vbo, auto& storage, std::array<size_t, 2>& range) {
+		if (range[0] >= range[1])
+			return;
+
+		using T = typename std::remove_reference_t<decltype(storage.GetData())>::value_type;
+
+		const auto& data = storage.GetData();
+
+		vbo.Bind();
+
+		if (data.size() * sizeof(T) > vbo.GetSize()) {
+			// grow geometrically, New discards the old contents
+			vbo.New(data.size() * 2 * sizeof(T), GL_STATIC_DRAW);
+			range = {0, data.size()};
+		}
+
+		range[1] = std::min(range[1], data.size());
+
+		if (range[0] < range[1])
+			vbo.SetBufferSubData(range[0] * sizeof(T), (range[1] - range[0]) * sizeof(T), &data[range[0]]);
+
+		vbo.Unbind();
+
+		range = {~0u, 0};
+	};
+
+	UploadRange(particlesVBO, particles, dirtyParticles);
+	UploadRange(emittersSSBO, emitters, dirtyEmitters);
+}
+
+void GPUParticleSystems::DrawQueued()
+{
+	if (queuedEmitters.empty())
+		return;
+
+	FlushUploads();
+
+	drawCmds.clear();
+	drawCmds.reserve(queuedEmitters.size());
+
+	for (const size_t emitterIdx: queuedEmitters) {
+		const EmitterRange& range = emitterRanges[emitterIdx];
+		drawCmds.push_back({4, range.numParticles, 0, range.particlesIdx});
+	}
+
+	queuedEmitters.clear();
+
+	drawCmdsVBO.Bind();
+
+	if (drawCmds.size() * sizeof(SDrawArraysIndirectCommand) > drawCmdsVBO.GetSize())
+		drawCmdsVBO.New(drawCmds.size() * 2 * sizeof(SDrawArraysIndirectCommand), GL_STREAM_DRAW);
+
+	drawCmdsVBO.SetBufferSubData(drawCmds);
+
+	shader->Enable();
+	shader->SetUniform("gameFrame", gs->frameNum);
+	shader->SetUniform("frameTimeOffset", globalRendering->timeOffset);
+	shader->SetUniform("cameraPos", camera->GetPos().x, camera->GetPos().y, camera->GetPos().z);
+	shader->SetUniform("cameraRight", camera->GetRight().x, camera->GetRight().y, camera->GetRight().z);
+	shader->SetUniform("cameraUp", camera->GetUp().x, camera->GetUp().y, camera->GetUp().z);
+	shader->SetUniform("cameraFwd", camera->GetForward().x, camera->GetForward().y, camera->GetForward().z);
+
+	vao.Bind();
+	emittersSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, EMITTERS_SSBO_BINDING_IDX, 0, emittersSSBO.GetSize());
+
+	glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, nullptr, drawCmds.size(), sizeof(SDrawArraysIndirectCommand));
+
+	emittersSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, EMITTERS_SSBO_BINDING_IDX, 0, emittersSSBO.GetSize());
+	vao.Unbind();
+
+	shader->Disable();
+	drawCmdsVBO.Unbind();
+}
@@ -0,0 +1,127 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef GPU_PARTICLE_SYSTEMS_H
+#define GPU_PARTICLE_SYSTEMS_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Rendering/GL/VAO.h"
+#include "Rendering/GL/VBO.h"
+#include "System/Color.h"
+#include "System/float4.h"
+#include "System/MemPoolTypes.h"
+
+class CColorMap;
+struct AtlasedTexture;
+
+namespace Shader {
+	struct IProgramObject;
+}
+
+/**
+ * Initial state of one particle, uploaded once when its system is created.
+ * Motion under the CSimpleParticleSystem rules (gravity, airdrag, size
+ * and rotation growth) has a closed form, so the vertex shader evaluates
+ * each particle at its age instead of the CPU stepping it every frame.
+ */
+struct GPUParticleData {
+	float4 posDecay;   // xyz := position, w := life decay-rate
+	float4 speedSize;  // xyz := speed, w := size
+	float rotVal;
+	float rotVel;
+	uint32_t emitterIdx;
+	uint32_t unused;
+};
+
+/**
+ * Parameters shared by all particles of one system, std430 layout.
+ */
+struct GPUEmitterData {
+	static constexpr uint32_t MAX_COLORS = 16;
+
+	float4 gravityAirdrag;  // xyz := gravity, w := airdrag
+	float4 growthParams;    // x := sizeMod, y := sizeGrowth, z := rotation acceleration
+	float4 texCoords;       // xstart, ystart, xend, yend
+
+	uint32_t createFrame;
+	uint32_t numColors;
+	uint32_t directional;
+	uint32_t unused;
+
+	std::array<SColor, MAX_COLORS> colors;
+};
+
+static_assert(sizeof(GPUParticleData) == 48, "");
+static_assert(sizeof(GPUEmitterData) == 128, "");
+
+
+/**
+ * Optional GPU backend for the unsynced CEG particle systems. Particle
+ * initial states live in one static instanced buffer (sub-allocated per
+ * system) and are drawn with a single multi-draw-indirect call after the
+ * CPU-built fxVA batch, in the same blend state.
+ */
+class GPUParticleSystems {
+public:
+	static constexpr size_t INVALID_INDEX = StablePosAllocator<GPUEmitterData>::INVALID_INDEX;
+
+	static GPUParticleSystems& GetInstance();
+
+	bool IsEnabled();
+	void Kill();
+
+	// false if the colormap or texture can not be represented on the GPU
+	static bool SetEmitterParams(GPUEmitterData& emitter, const CColorMap* colorMap, const AtlasedTexture* texture);
+
+	// returns INVALID_INDEX if the system has to be simulated on the CPU
+	size_t AddEmitter(const GPUEmitterData& emitter, std::vector<GPUParticleData>& particles);
+	void DelEmitter(size_t emitterIdx);
+
+	void QueueDraw(size_t emitterIdx) { queuedEmitters.push_back(emitterIdx); }
+	bool HaveQueuedDraws() const { return !queuedEmitters.empty(); }
+	void DrawQueued();
+
+private:
+	bool InitResources();
+	void FlushUploads();
+
+private:
+	struct EmitterRange {
+		uint32_t particlesIdx;
+		uint32_t numParticles;
+	};
+
+	struct SDrawArraysIndirectCommand {
+		uint32_t count;
+		uint32_t instanceCount;
+		uint32_t first;
+		uint32_t baseInstance;
+	};
+
+	static constexpr uint32_t EMITTERS_SSBO_BINDING_IDX = 4;
+
+	StablePosAllocator<GPUParticleData> particles;
+	StablePosAllocator<GPUEmitterData> emitters;
+
+	std::vector<EmitterRange> emitterRanges;
+	std::vector<size_t> queuedEmitters;
+	std::vector<SDrawArraysIndirectCommand> drawCmds;
+
+	// element ranges of the CPU copies not yet mirrored on the GPU
+	std::array<size_t, 2> dirtyParticles = {~0u, 0};
+	std::array<size_t, 2> dirtyEmitters = {~0u, 0};
+
+	VAO vao;
+	VBO particlesVBO;
+	VBO emittersSSBO;
+	VBO drawCmdsVBO;
+
+	Shader::IProgramObject* shader = nullptr;
+
+	// -1 := not yet initialized, 0 := unavailable, 1 := enabled
+	int state = -1;
+};
+
+#endif // GPU_PARTICLE_SYSTEMS_H
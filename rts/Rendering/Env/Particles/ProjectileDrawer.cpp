@@ -14,6 +14,7 @@
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Units/UnitDrawer.h"
 #include "Rendering/Env/ISky.h"
+#include "Rendering/Env/Particles/GPUParticleSystems.h"
 #include "Rendering/GL/FBO.h"
 #include "Rendering/GL/VertexArray.h"
 #include "Rendering/Shaders/Shader.h"
@@ -73,6 +74,8 @@ void CProjectileDrawer::Init() {
 
 	textureAtlas = new CTextureAtlas(CTextureAtlas::ATLAS_ALLOC_LEGACY, 0, 0, "ProjectileTextureAtlas", true);
 	groundFXAtlas = new CTextureAtlas(CTextureAtlas::ATLAS_ALLOC_LEGACY, 0, 0, "ProjectileEffectsAtlas", true);
+	textureAtlas->SetCacheLayout(true);
+	groundFXAtlas->SetCacheLayout(true);
 
 	LuaParser resourcesParser("gamedata/resources.lua", SPRING_VFS_MOD_BASE, SPRING_VFS_ZIP);
 	LuaParser mapResParser("gamedata/resources_map.lua", SPRING_VFS_MAP_BASE, SPRING_VFS_ZIP);
@@ -306,6 +309,8 @@ void CProjectileDrawer::Kill() {
 		//spring::SafeDelete(fxShader); crashes spring
 	}
 
+	GPUParticleSystems::GetInstance().Kill();
+
 	if (depthFBO) {
 		if (depthFBO->IsValid()) {
 			depthFBO->Bind();
@@ -759,7 +764,9 @@ void CProjectileDrawer::Draw(bool drawReflection, bool drawRefraction) {
 	glEnable(GL_BLEND);
 	glDisable(GL_FOG);
 
-	if (fxVA->drawIndex() > 0) {
+	GPUParticleSystems& gpuParticleSystems = GPUParticleSystems::GetInstance();
+
+	if (fxVA->drawIndex() > 0 || gpuParticleSystems.HaveQueuedDraws()) {
 		glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 		glEnable(GL_TEXTURE_2D);
 
@@ -790,6 +797,9 @@ void CProjectileDrawer::Draw(bool drawReflection, bool drawRefraction) {
 			fxShader->Disable();
 			glBindTexture(GL_TEXTURE_2D, 0); glActiveTexture(GL_TEXTURE0);
 		}
+
+		// unsorted and unsoftened, drawn on top of the CPU-side particles
+		gpuParticleSystems.DrawQueued();
 	} else {
 		eventHandler.DrawWorldPreParticles();
 	}
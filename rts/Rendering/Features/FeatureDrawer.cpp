@@ -117,6 +117,9 @@ bool CFeatureDrawer::ShouldDrawFeatureShadow(CFeature* f)
 	if (!f->HasDrawFlag(DrawFlags::SO_SHADOW_FLAG))
 		return false;
 
+	if (!shadowHandler.InShadowCascadePass(f->shadowCascadeMask))
+		return false;
+
 	if (LuaObjectDrawer::AddShadowMaterialObject(f, LUAOBJ_FEATURE))
 		return false;
 
@@ -294,27 +297,44 @@ void CFeatureDrawerGL4::DrawObjectsShadow(int modelType) const
 	auto& smv = S3DModelVAO::GetInstance();
 	smv.Bind();
 
-	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
+	// with bindless textures all bins can go into one submission
+	const uint32_t numBins = mdlRenderer.GetNumObjectBins();
+	const bool batchBins = textureHandlerS3O.UseBindlessTextures();
+	const bool culledBins = batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, 0, numBins, S3DModelVAO::CULL_PASS_SHADOW, DrawFlags::SO_SHADOW_FLAG);
+
+	for (uint32_t i = 0; i < numBins; i++) {
 		if (mdlRenderer.GetObjectBin(i).empty())
 			continue;
 
-		const auto* texMat = textureHandlerS3O.GetTexture(mdlRenderer.GetObjectBinKey(i));
-		CModelDrawerHelper::modelDrawerHelpers[modelType]->BindShadowTex(texMat);
+		if (!batchBins)
+			CModelDrawerHelper::modelDrawerHelpers[modelType]->BindShadowTex(textureHandlerS3O.GetTexture(mdlRenderer.GetObjectBinKey(i)));
 
 		const auto& bin = mdlRenderer.GetObjectBin(i);
+		auto objs = std::make_pair(bin.cbegin(), bin.cend());
+
+		if (culledBins || (!batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, i, 1, S3DModelVAO::CULL_PASS_SHADOW, DrawFlags::SO_SHADOW_FLAG)))
+			objs = modelDrawerData->GetCPUDrawnObjects(modelType, mdlRenderer.GetObjectBinKey(i));
+
+		for (auto it = objs.first; it != objs.second; ++it) {
+			auto* o = *it;
 
-		for (auto* o : bin) {
 			if (!ShouldDrawFeatureShadow(o))
 				continue;
 
 			smv.AddToSubmission(o);
 		}
 
+		if (batchBins)
+			continue;
+
 		smv.Submit(GL_TRIANGLES, false);
 
 		CModelDrawerHelper::modelDrawerHelpers[modelType]->UnbindShadowTex();
 	}
 
+	if (batchBins)
+		smv.Submit(GL_TRIANGLES, false);
+
 	smv.Unbind();
 }
 
@@ -332,21 +352,39 @@ void CFeatureDrawerGL4::DrawOpaqueObjects(int modelType, bool drawReflection, bo
 	auto& smv = S3DModelVAO::GetInstance();
 	smv.Bind();
 
-	for (unsigned int i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
+	// with bindless textures all bins can go into one submission
+	const uint32_t numBins = mdlRenderer.GetNumObjectBins();
+	const bool batchBins = textureHandlerS3O.UseBindlessTextures();
+	const bool culledBins = batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, 0, numBins, S3DModelVAO::CULL_PASS_OPAQUE, thisPassMask);
+
+	for (uint32_t i = 0; i < numBins; i++) {
 		if (mdlRenderer.GetObjectBin(i).empty())
 			continue;
 
-		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
+		if (!batchBins)
+			CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
+
+		const auto& bin = mdlRenderer.GetObjectBin(i);
+		auto objs = std::make_pair(bin.cbegin(), bin.cend());
+
+		if (culledBins || (!batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, i, 1, S3DModelVAO::CULL_PASS_OPAQUE, thisPassMask)))
+			objs = modelDrawerData->GetCPUDrawnObjects(modelType, mdlRenderer.GetObjectBinKey(i));
+
+		for (auto it = objs.first; it != objs.second; ++it) {
+			auto* o = *it;
 
-		for (auto* o : mdlRenderer.GetObjectBin(i)) {
 			if (!ShouldDrawOpaqueFeature(o, thisPassMask))
 				continue;
 
 			smv.AddToSubmission(o);
 		}
 
-		smv.Submit(GL_TRIANGLES, false);
+		if (!batchBins)
+			smv.Submit(GL_TRIANGLES, false);
 	}
+
+	if (batchBins)
+		smv.Submit(GL_TRIANGLES, false);
 	smv.Unbind();
 }
 
@@ -364,22 +402,38 @@ void CFeatureDrawerGL4::DrawAlphaObjects(int modelType, bool drawReflection, boo
 
 	modelDrawerState->SetColorMultiplier(IModelDrawerState::alphaValues.x);
 	//main cloaked alpha pass
-	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
+	// with bindless textures all bins can go into one submission
+	const uint32_t numBins = mdlRenderer.GetNumObjectBins();
+	const bool batchBins = textureHandlerS3O.UseBindlessTextures();
+	const bool culledBins = batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, 0, numBins, S3DModelVAO::CULL_PASS_ALPHA, thisPassMask);
+
+	for (uint32_t i = 0; i < numBins; i++) {
 		if (mdlRenderer.GetObjectBin(i).empty())
 			continue;
 
-		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
+		if (!batchBins)
+			CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
 		const auto& bin = mdlRenderer.GetObjectBin(i);
+		auto objs = std::make_pair(bin.cbegin(), bin.cend());
+
+		if (culledBins || (!batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, i, 1, S3DModelVAO::CULL_PASS_ALPHA, thisPassMask)))
+			objs = modelDrawerData->GetCPUDrawnObjects(modelType, mdlRenderer.GetObjectBinKey(i));
+
+		for (auto it = objs.first; it != objs.second; ++it) {
+			auto* o = *it;
 
-		for (auto* o : bin) {
 			if (!ShouldDrawAlphaFeature(o, thisPassMask))
 				continue;
 
 			smv.AddToSubmission(o);
 		}
 
-		smv.Submit(GL_TRIANGLES, false);
+		if (!batchBins)
+			smv.Submit(GL_TRIANGLES, false);
 	}
+
+	if (batchBins)
+		smv.Submit(GL_TRIANGLES, false);
 	smv.Unbind();
 }
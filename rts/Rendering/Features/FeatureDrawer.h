@@ -8,6 +8,7 @@
 #include "Rendering/Models/ModelRenderContainer.h"
 #include "Rendering/Common/ModelDrawer.h"
 #include "Rendering/Features/FeatureDrawerData.h"
+#include "Rendering/Models/3DModelVAO.h"
 
 class CFeature;
 
@@ -32,6 +33,8 @@ public:
 	// modelDrawerData proxies
 	void ConfigNotify(const std::string& key, const std::string& value) { modelDrawerData->ConfigNotify(key, value); }
 	static const std::vector<CFeature*>& GetUnsortedFeatures() { return modelDrawerData->GetUnsortedObjects(); }
+	static bool HasViewCullRadii(const CCamera* cam) { return modelDrawerData->HasViewCullRadii(cam); }
+	static uint32_t GetViewCullStamp() { return modelDrawerData->GetViewCullStamp(); }
 public:
 	virtual void DrawFeatureModel(const CFeature* feature, bool noLuaCall) const = 0;
 protected:
@@ -115,6 +118,8 @@ protected:
 
 	void DrawOpaqueObjects(int modelType, bool drawReflection, bool drawRefraction) const override;
 	void DrawAlphaObjects(int modelType, bool drawReflection, bool drawRefraction) const override;
+private:
+	mutable std::array<S3DModelCullSet, MODELTYPE_CNT> cullSets;
 };
 
 #define featureDrawer (CFeatureDrawer::modelDrawer)
\ No newline at end of file
@@ -5,11 +5,14 @@
 #include "Game/Camera.h"
 #include "Game/CameraHandler.h"
 #include "Game/GlobalUnsynced.h"
+#include "Map/ReadMap.h"
 #include "Sim/Features/Feature.h"
 #include "Sim/Features/FeatureDef.h"
 #include "Rendering/LuaObjectDrawer.h"
+#include "Lua/LuaObjectMaterial.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Common/ModelDrawerHelpers.h"
+#include "Rendering/GL/HiZPyramid.h"
 
 CONFIG(float, FeatureDrawDistance)
 .defaultValue(6000.0f)
@@ -98,19 +101,87 @@ void CFeatureDrawerData::Update()
 			UpdateDrawPos(f);
 	}
 
+	UpdateCullCells();
 	UpdateCommon();
 }
 
+void CFeatureDrawerData::UpdateCullCells()
+{
+	// most features never move, so rather than frustum-testing each of them
+	// for every camera the map is split into coarse cells which are tested
+	// once per camera; only features in cells a camera sees get the exact
+	// per-feature test. Cells are fixed in space and a feature's cell is
+	// derived from its current draw-position, so nothing has to be updated
+	// when features are created, destroyed or moved.
+	cullGridSize = {
+		(mapDims.mapx * SQUARE_SIZE + CULL_CELL_SIZE - 1) / CULL_CELL_SIZE,
+		(mapDims.mapy * SQUARE_SIZE + CULL_CELL_SIZE - 1) / CULL_CELL_SIZE,
+	};
+	cullGridHeights = {readMap->GetCurrMinHeight(), readMap->GetCurrMaxHeight()};
+
+	cullCellBits.clear();
+	cullCellBits.resize(cullGridSize.x * cullGridSize.y, 0);
+
+	for (uint32_t camType = CCamera::CAMTYPE_PLAYER; camType < CCamera::CAMTYPE_ENVMAP; ++camType) {
+		if (camType == CCamera::CAMTYPE_UWREFL && !water->CanDrawReflectionPass())
+			continue;
+
+		if (camType == CCamera::CAMTYPE_SHADOW && ((shadowHandler.shadowGenBits & CShadowHandler::SHADOWGEN_BIT_MODEL) == 0))
+			continue;
+
+		const CCamera* cam = CCameraHandler::GetCamera(camType);
+
+		for (int z = 0; z < cullGridSize.y; z++) {
+			for (int x = 0; x < cullGridSize.x; x++) {
+				const float3 mins = {x * CULL_CELL_SIZE - CULL_CELL_MARGIN, cullGridHeights.x - CULL_CELL_MARGIN, z * CULL_CELL_SIZE - CULL_CELL_MARGIN};
+				const float3 maxs = {(x + 1) * CULL_CELL_SIZE + CULL_CELL_MARGIN, cullGridHeights.y + CULL_CELL_MARGIN, (z + 1) * CULL_CELL_SIZE + CULL_CELL_MARGIN};
+
+				cullCellBits[z * cullGridSize.x + x] |= (cam->InView(mins, maxs) << camType);
+			}
+		}
+	}
+}
+
+int CFeatureDrawerData::GetCullCell(const CFeature* f) const
+{
+	const float3& pos = f->drawMidPos;
+
+	// the cell's box must contain the feature's entire draw-sphere
+	if (f->GetDrawRadius() > CULL_CELL_MARGIN)
+		return -1;
+	if (pos.y < cullGridHeights.x || pos.y > cullGridHeights.y)
+		return -1;
+	if (pos.x < 0.0f || pos.z < 0.0f)
+		return -1;
+
+	const int x = pos.x / CULL_CELL_SIZE;
+	const int z = pos.z / CULL_CELL_SIZE;
+
+	if (x >= cullGridSize.x || z >= cullGridSize.y)
+		return -1;
+
+	return (z * cullGridSize.x + x);
+}
+
 bool CFeatureDrawerData::IsAlpha(const CFeature* co) const
 {
 	return (co->drawAlpha < 1.0f);
 }
 
+bool CFeatureDrawerData::IsCPUDrawn(const CFeature* co) const
+{
+	// far-textures have to be queued, Lua materials are drawn by LuaObjectDrawer
+	return (co->HasDrawFlag(DrawFlags::SO_FARTEX_FLAG) || co->GetLuaMaterialData()->Enabled());
+}
+
 void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 {
 	CFeature* f = static_cast<CFeature*>(o);
 	f->ResetDrawFlag();
 
+	const int cullCell = GetCullCell(f);
+	const uint8_t cullBits = (cullCell >= 0)? cullCellBits[cullCell]: 0xFF;
+
 	for (uint32_t camType = CCamera::CAMTYPE_PLAYER; camType < CCamera::CAMTYPE_ENVMAP; ++camType) {
 		if (camType == CCamera::CAMTYPE_UWREFL && !water->CanDrawReflectionPass())
 			continue;
@@ -129,12 +200,18 @@ void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 		if (!f->IsInLosForAllyTeam(gu->myAllyTeam) && !gu->spectatingFullView)
 			continue;
 
+		if ((cullBits & (1 << camType)) == 0)
+			continue;
+
 		if (!cam->InView(f->drawMidPos, f->GetDrawRadius()))
 			continue;
 
 		switch (camType)
 			{
 			case CCamera::CAMTYPE_PLAYER: {
+				if (GL::HiZPyramid::GetInstance().IsOccluded(cam, f->drawMidPos, f->GetDrawRadius(), GL::HiZPyramid::OBJ_TYPE_FEATURE))
+					continue;
+
 				const float sqrCamDist = (f->drawPos - cam->GetPos()).SqLength();
 				const float farTexDist = Square(f->GetDrawRadius() + CModelDrawerDataConcept::modelDrawDist);
 				if (sqrCamDist >= farTexDist) {
@@ -199,6 +276,7 @@ void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 					continue;
 
 				f->AddDrawFlag(DrawFlags::SO_SHADOW_FLAG);
+				f->shadowCascadeMask = shadowHandler.GetShadowCascadeMask(f->drawMidPos, f->GetDrawRadius());
 			} break;
 
 			default: { assert(false); } break;
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <vector>
+
 #include "System/float3.h"
+#include "System/type2.h"
 #include "Rendering/Common/ModelDrawerData.h"
 
 class CFeature;
@@ -26,10 +29,26 @@ public:
 public:
 	void Update() override;
 	bool IsAlpha(const CFeature* co) const override;
+	bool IsCPUDrawn(const CFeature* co) const override;
 protected:
 	void UpdateObjectDrawFlags(CSolidObject* o) const override;
 private:
 	static void UpdateDrawPos(CFeature* f);
+
+	void UpdateCullCells();
+	int GetCullCell(const CFeature* f) const;
+private:
+	// side-length of a cull-cell in elmos; features whose draw-radius exceeds
+	// the margin or that are outside the map's height-range (e.g. debris) are
+	// not assigned a cell and always get the per-feature frustum test
+	static constexpr int CULL_CELL_SIZE = 1024;
+	static constexpr float CULL_CELL_MARGIN = 256.0f;
+
+	int2 cullGridSize;
+	float2 cullGridHeights;
+
+	// per cell one bit for each camera type whose frustum intersects it
+	std::vector<uint8_t> cullCellBits;
 public:
 	float featureDrawDistance;
 	float featureFadeDistance;
@@ -4,6 +4,7 @@
 #include "FontLogSection.h"
 
 #include <cstring> // for memset, memcpy
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -25,6 +26,7 @@
 #include "System/Log/ILog.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/SafeUtil.h"
 #include "System/StringUtil.h"
 #include "System/TimeProfiler.h"
@@ -85,6 +87,25 @@ struct FontFace {
 	std::shared_ptr<SP_Byte> memory;
 };
 
+// glyphs of one language block, rasterized (possibly on a worker thread)
+// before they are inserted into the atlas on the thread owning the font
+struct CFontTexture::GlyphBlock {
+	struct Bitmap {
+		std::vector<uint8_t> data;
+		int2 size;
+	};
+
+	char32_t start = 0;
+	char32_t end = 0;
+
+	std::vector<GlyphInfo> glyphs;
+	// index into bitmaps per glyph, -1 := glyph has no pixels
+	std::vector<int> glyphBitmaps;
+	std::vector<Bitmap> bitmaps;
+
+	spring::unsynced_set<std::shared_ptr<FontFace>> fallbackFonts;
+};
+
 static spring::unsynced_set<CFontTexture*> allFonts;
 static spring::unsynced_map<std::string, std::weak_ptr<FontFace>> fontFaceCache;
 static spring::unsynced_map<std::string, std::weak_ptr<SP_Byte>> fontMemCache;
@@ -498,6 +519,10 @@ CFontTexture::CFontTexture(const std::string& fontfile, int size, int _outlinesi
 		}
 	}
 
+	// the not-defined glyph, drawn in place of those still being rasterized
+	GetGlyph(0);
+
+	asyncBlockLoads = true;
 	allFonts.insert(this);
 #endif
 }
@@ -507,6 +532,10 @@ CFontTexture::~CFontTexture()
 #ifndef HEADLESS
 	allFonts.erase(this);
 
+	// queued blocks reference this font until a worker has rasterized them
+	while (numQueuedBlocks.load() > 0)
+		spring::this_thread::yield();
+
 	glDeleteTextures(1, (const GLuint*)&texture);
 	glDeleteLists(textureSpaceMatrix, 1);
 
@@ -532,10 +561,21 @@ const GlyphInfo& CFontTexture::GetGlyph(char32_t ch)
 	if (it != glyphs.end())
 		return it->second;
 
+	const auto pit = placeholderGlyphs.find(ch);
+	if (pit != placeholderGlyphs.end())
+		return pit->second;
+
 	// Get block start pos
 	char32_t start, end;
 	start = GetLanguageBlock(ch, end);
 
+	if (QueueBlock(start, end)) {
+		GlyphInfo& glyph = placeholderGlyphs[ch];
+		glyph = glyphs[0];
+		glyph.utf16 = ch;
+		return glyph;
+	}
+
 	// Load an entire block
 	LoadBlock(start, end);
 	return GetGlyph(ch);
@@ -555,6 +595,12 @@ float CFontTexture::GetKerning(const GlyphInfo& lgl, const GlyphInfo& rgl)
 	if (hash < (sizeof(kerningPrecached) / sizeof(kerningPrecached[0])))
 		return kerningPrecached[hash];
 
+	// do not cache the kerning of a placeholder, the real glyph replaces it soon
+	if (!placeholderGlyphs.empty()) {
+		if (placeholderGlyphs.find(lgl.utf16) != placeholderGlyphs.end() || placeholderGlyphs.find(rgl.utf16) != placeholderGlyphs.end())
+			return lgl.advance;
+	}
+
 	const auto it = kerningDynamic.find(hash);
 
 	if (it != kerningDynamic.end())
@@ -577,26 +623,71 @@ void CFontTexture::LoadBlock(char32_t start, char32_t end)
 {
 	std::lock_guard<spring::recursive_mutex> lk(fontCacheMutex);
 
+	GlyphBlock block;
+	block.start = start;
+	block.end = end;
+
+	RasterizeBlock(block);
+	InsertBlock(block);
+}
+
+
+bool CFontTexture::QueueBlock(char32_t start, char32_t end)
+{
+	// ASCII and the not-defined glyph are loaded synchronously by the ctor
+	if (!asyncBlockLoads || !ThreadPool::HasThreads())
+		return false;
+
+	if (!queuedBlocks.insert(start).second)
+		return true;
+
+	numQueuedBlocks.fetch_add(1);
+
+	ThreadPool::Enqueue([this, start, end]() {
+		std::shared_ptr<GlyphBlock> block = std::make_shared<GlyphBlock>();
+		block->start = start;
+		block->end = end;
+
+		RasterizeBlock(*block);
+
+		std::lock_guard<spring::recursive_mutex> lk(fontCacheMutex);
+		rasterizedBlocks.emplace_back(std::move(block));
+		numQueuedBlocks.fetch_sub(1);
+	});
+
+	return true;
+}
+
+
+void CFontTexture::RasterizeBlock(GlyphBlock& block) const
+{
 	// load glyphs from different fonts (using fontconfig)
 	std::shared_ptr<FontFace> f = shFace;
 
 	spring::unsynced_set<std::shared_ptr<FontFace>> alreadyCheckedFonts;
 
 	// generate list of wanted glyphs
-	std::vector<char32_t> map(end - start, 0);
+	std::vector<char32_t> map(block.end - block.start, 0);
 
-	for (char32_t i = start; i < end; ++i)
-		map[i - start] = i;
+	for (char32_t i = block.start; i < block.end; ++i)
+		map[i - block.start] = i;
 
 #ifndef HEADLESS
+	// faces are shared between fonts, FreeType calls are serialized per glyph
+	// so that the render thread never waits long for a worker
 	do {
 		alreadyCheckedFonts.insert(f);
 
 		for (std::size_t idx = 0; idx < map.size(); /*nop*/) {
-			FT_UInt index = FT_Get_Char_Index(*f, map[idx]);
+			FT_UInt index = 0;
+
+			{
+				std::lock_guard<spring::recursive_mutex> lk(fontCacheMutex);
+				index = FT_Get_Char_Index(*f, map[idx]);
+			}
 
 			if (index != 0) {
-				LoadGlyph(f, map[idx], index);
+				RasterizeGlyph(f, map[idx], index, block);
 
 				map[idx] = map.back();
 				map.pop_back();
@@ -605,17 +696,119 @@ void CFontTexture::LoadBlock(char32_t start, char32_t end)
 			}
 		}
 
-		f = GetFontForCharacters(map, *f, fontSize);
-		usedFallbackFonts.insert(f);
+		{
+			std::lock_guard<spring::recursive_mutex> lk(fontCacheMutex);
+			f = GetFontForCharacters(map, *f, fontSize);
+		}
+
+		block.fallbackFonts.insert(f);
 	} while (!map.empty() && f && (alreadyCheckedFonts.find(f) == alreadyCheckedFonts.end()));
 #endif
 
 
 	// load fail glyph for all remaining ones (they will all share the same fail glyph)
+	std::shared_ptr<FontFace> failFace = shFace;
+
 	for (auto c: map) {
-		LoadGlyph(shFace, c, 0);
+		RasterizeGlyph(failFace, c, 0, block);
+	}
+}
+
+
+void CFontTexture::RasterizeGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned index, GlyphBlock& block) const
+{
+#ifndef HEADLESS
+	// check for duplicated glyphs, these share the bitmap
+	const auto pred = [&](const GlyphInfo& g) { return (g.index == index && g.face == f->face); };
+	const auto iter = std::find_if(block.glyphs.begin(), block.glyphs.end(), pred);
+
+	if (iter != block.glyphs.end()) {
+		const int bitmapIdx = block.glyphBitmaps[iter - block.glyphs.begin()];
+
+		block.glyphs.push_back(*iter);
+		block.glyphs.back().utf16 = ch;
+		block.glyphBitmaps.push_back(bitmapIdx);
+		return;
+	}
+
+	block.glyphs.emplace_back();
+	block.glyphBitmaps.push_back(-1);
+
+	GlyphInfo& glyph = block.glyphs.back();
+	glyph.face  = f->face;
+	glyph.index = index;
+	glyph.utf16 = ch;
+
+	std::lock_guard<spring::recursive_mutex> lk(fontCacheMutex);
+
+	// load glyph
+	if (FT_Load_Glyph(*f, index, FT_LOAD_RENDER) != 0)
+		LOG_L(L_ERROR, "Couldn't load glyph %d", ch);
+
+	FT_GlyphSlot slot = f->face->glyph;
+
+	const float xbearing = slot->metrics.horiBearingX * normScale;
+	const float ybearing = slot->metrics.horiBearingY * normScale;
+
+	glyph.size.x = xbearing;
+	glyph.size.y = ybearing - fontDescender;
+	glyph.size.w =  slot->metrics.width * normScale;
+	glyph.size.h = -slot->metrics.height * normScale;
+
+	glyph.advance   = slot->advance.x * normScale;
+	glyph.height    = slot->metrics.height * normScale;
+	glyph.descender = ybearing - glyph.height;
+
+	// workaround bugs in FreeSansBold (in range 0x02B0 - 0x0300)
+	if (glyph.advance == 0 && glyph.size.w > 0)
+		glyph.advance = glyph.size.w;
+
+	const int width  = slot->bitmap.width;
+	const int height = slot->bitmap.rows;
+
+	if (width <= 0 || height <= 0)
+		return;
+
+	if (slot->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY) {
+		LOG_L(L_ERROR, "invalid pixeldata mode");
+		return;
+	}
+
+	if (slot->bitmap.pitch != width) {
+		LOG_L(L_ERROR, "invalid pitch");
+		return;
+	}
+
+	// store glyph bitmap until the block is inserted into the atlas
+	block.glyphBitmaps.back() = block.bitmaps.size();
+	block.bitmaps.emplace_back();
+	block.bitmaps.back().data.assign(slot->bitmap.buffer, slot->bitmap.buffer + width * height);
+	block.bitmaps.back().size = {width, height};
+#endif
+}
+
+
+void CFontTexture::InsertBlock(const GlyphBlock& block)
+{
+	std::lock_guard<spring::recursive_mutex> lk(fontCacheMutex);
+
+	for (const auto& f: block.fallbackFonts) {
+		usedFallbackFonts.insert(f);
 	}
 
+	const int olSize = 2 * outlineSize;
+
+	// bitmap (index) is kept by the allocator until the atlas entries are copied below
+	for (size_t i = 0; i < block.bitmaps.size(); ++i) {
+		const GlyphBlock::Bitmap& bitmap = block.bitmaps[i];
+
+		atlasGlyphs.emplace_back(bitmap.data.data(), bitmap.size.x, bitmap.size.y, 1);
+
+		atlasAlloc.AddEntry(IntToString(i)       , bitmap.size                           , reinterpret_cast<void*>(atlasGlyphs.size() - 1));
+		atlasAlloc.AddEntry(IntToString(i) + "sh", bitmap.size + int2(olSize, olSize)                                                   );
+	}
+
+	std::vector<std::pair<IGlyphRect, IGlyphRect>> bitmapTexCords(block.bitmaps.size());
 
 	// read atlasAlloc glyph data back into atlasUpdate{Shadow}
 	{
@@ -636,7 +829,7 @@ void CFontTexture::LoadBlock(char32_t start, char32_t end)
 		if ((atlasUpdateShadow.xsize != wantedTexWidth) || (atlasUpdateShadow.ysize != wantedTexHeight))
 			atlasUpdateShadow = std::move(atlasUpdateShadow.CanvasResize(wantedTexWidth, wantedTexHeight, false));
 
-		for (char32_t i = start; i < end; ++i) {
+		for (size_t i = 0; i < block.bitmaps.size(); ++i) {
 			const std::string glyphName  = IntToString(i);
 			const std::string glyphName2 = glyphName + "sh";
 
@@ -646,8 +839,8 @@ void CFontTexture::LoadBlock(char32_t start, char32_t end)
 			const auto texpos  = atlasAlloc.GetEntry(glyphName);
 			const auto texpos2 = atlasAlloc.GetEntry(glyphName2);
 
-			glyphs[i].texCord       = IGlyphRect(texpos [0], texpos [1], texpos [2] - texpos [0], texpos [3] - texpos [1]);
-			glyphs[i].shadowTexCord = IGlyphRect(texpos2[0], texpos2[1], texpos2[2] - texpos2[0], texpos2[3] - texpos2[1]);
+			bitmapTexCords[i].first  = IGlyphRect(texpos [0], texpos [1], texpos [2] - texpos [0], texpos [3] - texpos [1]);
+			bitmapTexCords[i].second = IGlyphRect(texpos2[0], texpos2[1], texpos2[2] - texpos2[0], texpos2[3] - texpos2[1]);
 
 			const size_t glyphIdx = reinterpret_cast<size_t>(atlasAlloc.GetEntryData(glyphName));
 
@@ -657,85 +850,57 @@ void CFontTexture::LoadBlock(char32_t start, char32_t end)
 				atlasUpdate.CopySubImage(atlasGlyphs[glyphIdx], texpos.x, texpos.y);
 			if (texpos2[2] != 0)
 				atlasUpdateShadow.CopySubImage(atlasGlyphs[glyphIdx], texpos2.x + outlineSize, texpos2.y + outlineSize);
+
+			atlasDirtyRect.x1 = std::min(atlasDirtyRect.x1, std::min(int(texpos.x), int(texpos2.x)));
+			atlasDirtyRect.y1 = std::min(atlasDirtyRect.y1, std::min(int(texpos.y), int(texpos2.y)));
+			atlasDirtyRect.x2 = std::max(atlasDirtyRect.x2, std::max(int(texpos.z), int(texpos2.z)));
+			atlasDirtyRect.y2 = std::max(atlasDirtyRect.y2, std::max(int(texpos.w), int(texpos2.w)));
 		}
 
 		atlasAlloc.clear();
 		atlasGlyphs.clear();
 	}
 
-	// schedule a texture update
-	++curTextureUpdate;
-}
-
+	for (size_t i = 0; i < block.glyphs.size(); ++i) {
+		const GlyphInfo& blockGlyph = block.glyphs[i];
 
+		// might have been loaded synchronously while a worker rasterized the block
+		if (glyphs.find(blockGlyph.utf16) != glyphs.end())
+			continue;
 
-void CFontTexture::LoadGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned index)
-{
-#ifndef HEADLESS
-	if (glyphs.find(ch) != glyphs.end())
-		return;
+		GlyphInfo& glyph = glyphs[blockGlyph.utf16];
+		glyph = blockGlyph;
 
-	// check for duplicated glyphs
-	const auto pred = [&](const std::pair<char32_t, GlyphInfo>& p) { return (p.second.index == index && p.second.face == f->face); };
-	const auto iter = std::find_if(glyphs.begin(), glyphs.end(), pred);
+		if (block.glyphBitmaps[i] < 0)
+			continue;
 
-	if (iter != glyphs.end()) {
-		auto& glyph = glyphs[ch];
-		glyph = iter->second;
-		glyph.utf16 = ch;
-		return;
+		glyph.texCord       = bitmapTexCords[block.glyphBitmaps[i]].first;
+		glyph.shadowTexCord = bitmapTexCords[block.glyphBitmaps[i]].second;
 	}
 
-	auto& glyph = glyphs[ch];
-	glyph.face  = f->face;
-	glyph.index = index;
-	glyph.utf16 = ch;
-
-	// load glyph
-	if (FT_Load_Glyph(*f, index, FT_LOAD_RENDER) != 0)
-		LOG_L(L_ERROR, "Couldn't load glyph %d", ch);
-
-	FT_GlyphSlot slot = f->face->glyph;
-
-	const float xbearing = slot->metrics.horiBearingX * normScale;
-	const float ybearing = slot->metrics.horiBearingY * normScale;
-
-	glyph.size.x = xbearing;
-	glyph.size.y = ybearing - fontDescender;
-	glyph.size.w =  slot->metrics.width * normScale;
-	glyph.size.h = -slot->metrics.height * normScale;
-
-	glyph.advance   = slot->advance.x * normScale;
-	glyph.height    = slot->metrics.height * normScale;
-	glyph.descender = ybearing - glyph.height;
+	// schedule a texture update
+	++curTextureUpdate;
+}
 
-	// workaround bugs in FreeSansBold (in range 0x02B0 - 0x0300)
-	if (glyph.advance == 0 && glyph.size.w > 0)
-		glyph.advance = glyph.size.w;
 
-	const int width  = slot->bitmap.width;
-	const int height = slot->bitmap.rows;
-	const int olSize = 2 * outlineSize;
+void CFontTexture::InsertRasterizedBlocks()
+{
+	std::lock_guard<spring::recursive_mutex> lk(fontCacheMutex);
 
-	if (width <= 0 || height <= 0)
+	if (rasterizedBlocks.empty())
 		return;
 
-	if (slot->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY) {
-		LOG_L(L_ERROR, "invalid pixeldata mode");
-		return;
-	}
+	for (const std::shared_ptr<GlyphBlock>& block: rasterizedBlocks) {
+		InsertBlock(*block);
 
-	if (slot->bitmap.pitch != width) {
-		LOG_L(L_ERROR, "invalid pitch");
-		return;
-	}
+		for (char32_t c = block->start; c < block->end; ++c) {
+			placeholderGlyphs.erase(c);
+		}
 
-	// store glyph bitmap (index) in allocator until the next LoadBlock call
-	atlasGlyphs.emplace_back(slot->bitmap.buffer, width, height, 1);
+		queuedBlocks.erase(block->start);
+	}
 
-	atlasAlloc.AddEntry(IntToString(ch)       , int2(width         , height         ), reinterpret_cast<void*>(atlasGlyphs.size() - 1));
-	atlasAlloc.AddEntry(IntToString(ch) + "sh", int2(width + olSize, height + olSize)                                                 );
-#endif
+	rasterizedBlocks.clear();
 }
 
 
@@ -762,7 +927,7 @@ void CFontTexture::CreateTexture(const int width, const int height)
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
 	}
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, 1, 1, 0, GL_ALPHA, GL_UNSIGNED_BYTE, nullptr);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, nullptr);
 	glPopAttrib();
 
 	textureSpaceMatrix = glGenLists(1);
@@ -833,28 +998,50 @@ void CFontTexture::UpdateTexture()
 #ifndef HEADLESS
 	std::lock_guard<spring::recursive_mutex> lk(fontCacheMutex);
 
+	InsertRasterizedBlocks();
+
 	if (curTextureUpdate == lastTextureUpdate)
 		return;
 
+	// a resized atlas is uploaded in full, otherwise only the area of the new glyphs
+	const bool resized = (texWidth != wantedTexWidth || texHeight != wantedTexHeight);
+
 	lastTextureUpdate = curTextureUpdate;
 	texWidth  = wantedTexWidth;
 	texHeight = wantedTexHeight;
 
-	// merge shadow and regular atlas bitmaps, dispose shadow
+	SRectangle rect = {0, 0, texWidth, texHeight};
+
+	if (!resized) {
+		rect = atlasDirtyRect;
+		rect.ClampIn({0, 0, texWidth, texHeight});
+	}
+
+	atlasDirtyRect = {std::numeric_limits<int>::max(), std::numeric_limits<int>::max(), 0, 0};
+
+	if (rect.GetWidth() <= 0 || rect.GetHeight() <= 0)
+		return;
+
+	// merge shadow and regular atlas bitmaps, dispose shadow; the shadow only
+	// holds the new glyphs whose outlines are padded by the blur radius, so it
+	// suffices to blur the changed area
 	if (atlasUpdateShadow.xsize == atlasUpdate.xsize && atlasUpdateShadow.ysize == atlasUpdate.ysize) {
-		atlasUpdateShadow.Blur(outlineSize, outlineWeight);
-		assert((atlasUpdate.xsize * atlasUpdate.ysize) % sizeof(int) == 0);
+		CBitmap shadowRect;
+		shadowRect.Alloc(rect.GetWidth(), rect.GetHeight(), 1);
 
-		const int* src = reinterpret_cast<const int*>(atlasUpdateShadow.GetRawMem());
-		      int* dst = reinterpret_cast<      int*>(atlasUpdate.GetRawMem());
+		for (int y = 0; y < rect.GetHeight(); ++y) {
+			memcpy(shadowRect.GetRawMem() + y * rect.GetWidth(), atlasUpdateShadow.GetRawMem() + (rect.y1 + y) * texWidth + rect.x1, rect.GetWidth());
+		}
 
-		const int size = (atlasUpdate.xsize * atlasUpdate.ysize) / sizeof(int);
+		shadowRect.Blur(outlineSize, outlineWeight);
 
-		assert(atlasUpdateShadow.GetMemSize() / sizeof(int) == size);
-		assert(atlasUpdate.GetMemSize() / sizeof(int) == size);
+		const uint8_t* src = shadowRect.GetRawMem();
+		      uint8_t* dst = atlasUpdate.GetRawMem();
 
-		for (int i = 0; i < size; ++i) {
-			dst[i] |= src[i];
+		for (int y = 0; y < rect.GetHeight(); ++y) {
+			for (int x = 0; x < rect.GetWidth(); ++x) {
+				dst[(rect.y1 + y) * texWidth + rect.x1 + x] |= src[y * rect.GetWidth() + x];
+			}
 		}
 
 		atlasUpdateShadow = {};
@@ -862,14 +1049,25 @@ void CFontTexture::UpdateTexture()
 
 
 	glPushAttrib(GL_PIXEL_MODE_BIT | GL_TEXTURE_BIT);
+	glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
 		// update texture atlas
 		glBindTexture(GL_TEXTURE_2D, texture);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, texWidth, texHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, atlasUpdate.GetRawMem());
+
+		if (resized) {
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, texWidth, texHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, atlasUpdate.GetRawMem());
+		} else {
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, texWidth);
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, rect.x1);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, rect.y1);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x1, rect.y1, rect.GetWidth(), rect.GetHeight(), GL_ALPHA, GL_UNSIGNED_BYTE, atlasUpdate.GetRawMem());
+		}
 
 		// update texture space dlist (this affects already compiled dlists too!)
 		glNewList(textureSpaceMatrix, GL_COMPILE);
 		glScalef(1.0f / texWidth, 1.0f / texHeight, 1.0f);
 		glEndList();
+	glPopClientAttrib();
 	glPopAttrib();
 #endif
-}
\ No newline at end of file
+}
@@ -3,12 +3,16 @@
 #ifndef _CFONTTEXTURE_H
 #define _CFONTTEXTURE_H
 
-#include <string>
+#include <atomic>
+#include <limits>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "Rendering/Textures/Bitmap.h"
 #include "Rendering/Textures/IAtlasAllocator.h"
 #include "Rendering/Textures/RowAtlasAlloc.h"
+#include "System/Rectangle.h"
 #include "System/UnorderedMap.hpp"
 #include "System/UnorderedSet.hpp"
 
@@ -78,6 +82,8 @@ struct GlyphInfo {
 This class just store glyphs and load new glyphs if requred
 It works with image and don't care about rendering these glyphs
 It works only and only with UTF32 chars
+Blocks beyond those loaded by the ctor are rasterized on a worker thread,
+the not-defined glyph stands in for their glyphs until the next UpdateTexture
 **/
 class CFontTexture
 {
@@ -109,13 +115,27 @@ protected:
 private:
 	void CreateTexture(const int width, const int height);
 
+	struct GlyphBlock;
+
 	// Load all chars in block's range
 	void LoadBlock(char32_t start, char32_t end);
-	void LoadGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned index);
+	// hand the block to a worker thread, false if it has to be loaded synchronously
+	bool QueueBlock(char32_t start, char32_t end);
+
+	// thread-safe, only reads members that are constant after the ctor
+	void RasterizeBlock(GlyphBlock& block) const;
+	void RasterizeGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned index, GlyphBlock& block) const;
+
+	void InsertBlock(const GlyphBlock& block);
+	void InsertRasterizedBlocks();
 
 protected:
 	float GetKerning(const GlyphInfo& lgl, const GlyphInfo& rgl);
 
+	// changes whenever glyphs are added or replace a placeholder, anything
+	// derived from glyph metrics has to be recomputed when it does
+	int GetGlyphsVersion() const { return curTextureUpdate; }
+
 protected:
 	float kerningPrecached[128 * 128]; // contains ASCII kerning
 
@@ -148,12 +168,26 @@ private:
 	spring::unsynced_map<char32_t, GlyphInfo> glyphs; // UTF16 -> GlyphInfo
 	spring::unsynced_map<uint32_t, float> kerningDynamic; // contains unicode kerning
 
+	// glyphs of queued blocks, copies of the not-defined glyph
+	spring::unsynced_map<char32_t, GlyphInfo> placeholderGlyphs;
+	// start of every block handed to a worker and not yet inserted
+	spring::unsynced_set<char32_t> queuedBlocks;
+	// blocks finished by workers, guarded by fontCacheMutex
+	std::vector<std::shared_ptr<GlyphBlock>> rasterizedBlocks;
+
+	std::atomic<int> numQueuedBlocks = {0};
+
+	bool asyncBlockLoads = false;
+
 	std::vector<CBitmap> atlasGlyphs;
 
 	CRowAtlasAlloc atlasAlloc;
 
 	CBitmap atlasUpdate;
 	CBitmap atlasUpdateShadow;
+
+	// atlas area changed since the last UpdateTexture; x1 >= x2 := none
+	SRectangle atlasDirtyRect = {std::numeric_limits<int>::max(), std::numeric_limits<int>::max(), 0, 0};
 };
 
 #endif // CFONTTEXTURE_H
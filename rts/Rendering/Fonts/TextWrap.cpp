@@ -560,13 +560,46 @@ void CTextWrap::RemergeColorCodes(std::list<word>* words, std::list<colorcode>&
 
 int CTextWrap::WrapInPlace(std::u8string& text, float _fontSize, float maxWidth, float maxHeight)
 {
-	// TODO make an option to insert '-' for word wrappings (and perhaps try to syllabificate)
-
 	if (_fontSize <= 0.0f)
 		_fontSize = GetSize();
 
 	maxWidth = std::max(maxWidth, 10.0f); //otherwise endless loop with OOM might happen
 
+	// the wrap depends on glyph widths, placeholders among them are replaced later
+	if (GetGlyphsVersion() != wrapsGlyphsVersion) {
+		wrappedTexts.clear();
+		wrapsGlyphsVersion = GetGlyphsVersion();
+	}
+
+	// UI elements rewrap the same text every frame
+	const auto iter = wrappedTexts.find(text);
+
+	if (iter != wrappedTexts.end()) {
+		const WrappedText& wt = iter->second;
+
+		if (wt.fontSize == _fontSize && wt.maxWidth == maxWidth && wt.maxHeight == maxHeight) {
+			text.assign(wt.text);
+			return wt.numLines;
+		}
+	}
+
+	if (wrappedTexts.size() >= MAX_CACHED_WRAPS)
+		wrappedTexts.clear();
+
+	WrappedText& wt = wrappedTexts[text];
+
+	wt.fontSize = _fontSize;
+	wt.maxWidth = maxWidth;
+	wt.maxHeight = maxHeight;
+	wt.numLines = WrapInPlace_(text, _fontSize, maxWidth, maxHeight);
+	wt.text = text;
+	return wt.numLines;
+}
+
+int CTextWrap::WrapInPlace_(std::u8string& text, float _fontSize, float maxWidth, float maxHeight)
+{
+	// TODO make an option to insert '-' for word wrappings (and perhaps try to syllabificate)
+
 	const float maxWidthf  = maxWidth / _fontSize;
 	const float maxHeightf = maxHeight / _fontSize;
 
@@ -9,6 +9,7 @@
 #include "CFontTexture.h"
 #include "ustring.h"
 #include "System/Color.h"
+#include "System/UnorderedMap.hpp"
 
 
 class CTextWrap : public CFontTexture
@@ -79,7 +80,25 @@ private:
 	void WrapTextConsole(std::list<word>& words, float maxWidth, float maxHeight);
 
 	int WrapInPlace(std::u8string& text, float fontSize,  float maxWidth, float maxHeight = MAX_HEIGHT_DEFAULT);
+	int WrapInPlace_(std::u8string& text, float fontSize,  float maxWidth, float maxHeight);
 	std::u8string Wrap(const std::u8string& text, float fontSize, float maxWidth, float maxHeight = MAX_HEIGHT_DEFAULT);
+
+private:
+	struct WrappedText {
+		float fontSize;
+		float maxWidth;
+		float maxHeight;
+
+		int numLines;
+		std::string text;
+	};
+
+	static constexpr size_t MAX_CACHED_WRAPS = 256;
+
+	//! keyed by the unwrapped text, only the last wrap parameters are kept
+	spring::unsynced_map<std::string, WrappedText> wrappedTexts;
+
+	int wrapsGlyphsVersion = -1;
 };
 
 // wrappers
@@ -615,7 +615,34 @@ void CglFont::End()
 /*******************************************************************************/
 /*******************************************************************************/
 
-void CglFont::RenderString(float x, float y, const float& scaleX, const float& scaleY, const std::string& str)
+const CglFont::TextLayout& CglFont::GetTextLayout(const std::string& str, int decoration)
+{
+	// layouts built before new glyphs arrived can contain their placeholders
+	if (GetGlyphsVersion() != layoutsGlyphsVersion) {
+		for (auto& layouts: textLayouts) {
+			layouts.clear();
+		}
+
+		layoutsGlyphsVersion = GetGlyphsVersion();
+	}
+
+	auto& layouts = textLayouts[decoration];
+	const auto iter = layouts.find(str);
+
+	if (iter != layouts.end())
+		return iter->second;
+
+	// strings that change every frame (timers, counters) would grow it forever
+	if (layouts.size() >= MAX_CACHED_LAYOUTS)
+		layouts.clear();
+
+	TextLayout& layout = layouts[str];
+	BuildTextLayout(layout, str, decoration);
+	return layout;
+}
+
+
+void CglFont::BuildTextLayout(TextLayout& layout, const std::string& str, int decoration)
 {
 	/**
 	 * NOTE:
@@ -631,11 +658,22 @@ void CglFont::RenderString(float x, float y, const float& scaleX, const float& s
 
 	const std::u8string& ustr = toustring(str);
 
-	const float startx = x;
-	const float lineHeight_ = scaleY * GetLineHeight();
-	const size_t length = str.length();
+	// outlines grow the glyph, shadows also shift it to the lower right
+	const float decorSize = (decoration != TEXT_DECORATION_NONE) * GetOutlineWidth() / float(fontSize);
+	const float decorShiftX = (decoration == TEXT_DECORATION_SHADOW) *  0.1f;
+	const float decorShiftY = (decoration == TEXT_DECORATION_SHADOW) * -0.1f;
+
+	// a reset is the only way for the color to become negative
+	float4 resetColor = {-1.0f, -1.0f, -1.0f, -1.0f};
+
+	layout.quads.reserve(str.length() * 4);
+	layout.decorQuads.reserve((decoration != TEXT_DECORATION_NONE) * str.length() * 4);
+
+	layout.width = GetTextWidth_(ustr);
+	layout.height = GetTextHeight_(ustr, &layout.descender);
 
-	va.EnlargeArrays(length * 4, 0, VA_SIZE_2DT);
+	float x = 0.0f;
+	float y = 0.0f;
 
 	int i = 0;
 	int skippedLines = 0;
@@ -648,33 +686,28 @@ void CglFont::RenderString(float x, float y, const float& scaleX, const float& s
 	char32_t cc = 0;
 	char32_t pc = 0;
 
-	float4 newColor = textColor;
+	float4 newColor = resetColor;
 
 	do {
 		// check for end-of-string
-		if (SkipColorCodesAndNewLines(ustr, &i, &newColor, &colorChanged, &skippedLines, &baseTextColor))
+		if (SkipColorCodesAndNewLines(ustr, &i, &newColor, &colorChanged, &skippedLines, &resetColor))
 			return;
 
 		cc = utf8::GetNextChar(str, i);
 
-		if (colorChanged) {
-			if (autoOutlineColor) {
-				SetColors(&newColor, nullptr);
-			} else {
-				SetTextColor(&newColor);
-			}
-		}
+		if (colorChanged)
+			layout.colorChanges.push_back({uint32_t(layout.quads.size() / 4), newColor.x < 0.0f, newColor});
 
 
 		const GlyphInfo* cg = &GetGlyph(cc);
 		const GlyphInfo* pg = nullptr;
 
 		if (skippedLines > 0) {
-			x  = startx;
-			y -= (skippedLines * lineHeight_);
+			x  = 0.0f;
+			y -= (skippedLines * GetLineHeight());
 		} else if (pc != 0) {
 			pg = &GetGlyph(pc);
-			x += (scaleX * GetKerning(*pg, *cg));
+			x += GetKerning(*pg, *cg);
 		}
 
 		pg = cg;
@@ -682,171 +715,64 @@ void CglFont::RenderString(float x, float y, const float& scaleX, const float& s
 
 
 		const auto&  tc = pg->texCord;
-		const float dx0 = (scaleX * pg->size.x0()) + x, dy0 = (scaleY * pg->size.y0()) + y;
-		const float dx1 = (scaleX * pg->size.x1()) + x, dy1 = (scaleY * pg->size.y1()) + y;
+		const float dx0 = pg->size.x0() + x, dy0 = pg->size.y0() + y;
+		const float dx1 = pg->size.x1() + x, dy1 = pg->size.y1() + y;
+
+		if (decoration != TEXT_DECORATION_NONE) {
+			const auto& stc = pg->shadowTexCord;
+			const float sx0 = dx0 + decorShiftX - decorSize, sy0 = dy0 + decorShiftY + decorSize;
+			const float sx1 = dx1 + decorShiftX + decorSize, sy1 = dy1 + decorShiftY - decorSize;
+
+			layout.decorQuads.push_back({sx0, sy1, stc.x0(), stc.y1()});
+			layout.decorQuads.push_back({sx0, sy0, stc.x0(), stc.y0()});
+			layout.decorQuads.push_back({sx1, sy0, stc.x1(), stc.y0()});
+			layout.decorQuads.push_back({sx1, sy1, stc.x1(), stc.y1()});
+		}
 
-		va.AddVertexQ2dT(dx0, dy1, tc.x0(), tc.y1());
-		va.AddVertexQ2dT(dx0, dy0, tc.x0(), tc.y0());
-		va.AddVertexQ2dT(dx1, dy0, tc.x1(), tc.y0());
-		va.AddVertexQ2dT(dx1, dy1, tc.x1(), tc.y1());
+		layout.quads.push_back({dx0, dy1, tc.x0(), tc.y1()});
+		layout.quads.push_back({dx0, dy0, tc.x0(), tc.y0()});
+		layout.quads.push_back({dx1, dy0, tc.x1(), tc.y0()});
+		layout.quads.push_back({dx1, dy1, tc.x1(), tc.y1()});
 	} while (true);
 }
 
 
-void CglFont::RenderStringShadow(float x, float y, const float& scaleX, const float& scaleY, const std::string& str)
+void CglFont::RenderTextLayout(const TextLayout& layout, float x, float y, float scaleX, float scaleY)
 {
-	#if 0
-	RenderString(x, y, scaleX, scaleY, str);
-	return;
-	#endif
+	const size_t numQuads = layout.quads.size() / 4;
 
-	const std::u8string& ustr = toustring(str);
+	va.EnlargeArrays(layout.quads.size(), 0, VA_SIZE_2DT);
+	va2.EnlargeArrays(layout.decorQuads.size(), 0, VA_SIZE_2DT);
 
-	const float startx = x;
-	const float shiftX = scaleX * 0.1;
-	const float shiftY = scaleY * 0.1;
-	const float ssX = (scaleX / fontSize) * GetOutlineWidth();
-	const float ssY = (scaleY / fontSize) * GetOutlineWidth();
-	const float lineHeight_ = scaleY * GetLineHeight();
-	const size_t length = str.length();
+	auto colorChange = layout.colorChanges.cbegin();
 
-	va.EnlargeArrays(length * 4, 0, VA_SIZE_2DT);
-	va2.EnlargeArrays(length * 4, 0, VA_SIZE_2DT);
+	for (size_t n = 0; n < numQuads; n++) {
+		if (colorChange != layout.colorChanges.cend() && colorChange->quadIndex == n) {
+			// colorcodes only replace rgb, the alpha is that of the glPrint call
+			float4 newColor = baseTextColor;
 
-	int i = 0;
-	int skippedLines = 0;
-	bool colorChanged = false;
-
-	char32_t cc = 0;
-	char32_t pc = 0;
+			if (!colorChange->reset)
+				newColor = float4(colorChange->color, baseTextColor.w);
 
-	float4 newColor = textColor;
-
-	do {
-		// check for end-of-string
-		if (SkipColorCodesAndNewLines(ustr, &i, &newColor, &colorChanged, &skippedLines, &baseTextColor))
-			return;
-
-		cc = utf8::GetNextChar(str, i);
-
-		if (colorChanged) {
 			if (autoOutlineColor) {
 				SetColors(&newColor, nullptr);
 			} else {
 				SetTextColor(&newColor);
 			}
-		}
-
 
-		const GlyphInfo* cg = &GetGlyph(cc);
-		const GlyphInfo* pg = nullptr;
-
-		if (skippedLines > 0) {
-			x  = startx;
-			y -= (skippedLines * lineHeight_);
-		} else if (pc != 0) {
-			pg = &GetGlyph(pc);
-			x += (scaleX * GetKerning(*pg, *cg));
+			++colorChange;
 		}
 
-		pg = cg;
-		pc = cc;
-
-
-		const auto&  tc = pg->texCord;
-		const auto& stc = pg->shadowTexCord;
-		const float dx0 = (scaleX * pg->size.x0()) + x, dy0 = (scaleY * pg->size.y0()) + y;
-		const float dx1 = (scaleX * pg->size.x1()) + x, dy1 = (scaleY * pg->size.y1()) + y;
-
-		// draw shadow
-		va2.AddVertexQ2dT(dx0 + shiftX - ssX, dy1 - shiftY - ssY, stc.x0(), stc.y1());
-		va2.AddVertexQ2dT(dx0 + shiftX - ssX, dy0 - shiftY + ssY, stc.x0(), stc.y0());
-		va2.AddVertexQ2dT(dx1 + shiftX + ssX, dy0 - shiftY + ssY, stc.x1(), stc.y0());
-		va2.AddVertexQ2dT(dx1 + shiftX + ssX, dy1 - shiftY - ssY, stc.x1(), stc.y1());
-
-		// draw the actual character
-		va.AddVertexQ2dT(dx0, dy1, tc.x0(), tc.y1());
-		va.AddVertexQ2dT(dx0, dy0, tc.x0(), tc.y0());
-		va.AddVertexQ2dT(dx1, dy0, tc.x1(), tc.y0());
-		va.AddVertexQ2dT(dx1, dy1, tc.x1(), tc.y1());
-	} while (true);
-}
-
-void CglFont::RenderStringOutlined(float x, float y, const float& scaleX, const float& scaleY, const std::string& str)
-{
-	#if 0
-	RenderString(x, y, scaleX, scaleY, str);
-	return;
-	#endif
-
-	const std::u8string& ustr = toustring(str);
-
-	const float startx = x;
-	const float shiftX = (scaleX / fontSize) * GetOutlineWidth();
-	const float shiftY = (scaleY / fontSize) * GetOutlineWidth();
-	const float lineHeight_ = scaleY * GetLineHeight();
-	const size_t length = str.length();
-
-	va.EnlargeArrays(length * 4, 0, VA_SIZE_2DT);
-	va2.EnlargeArrays(length * 4, 0, VA_SIZE_2DT);
-
-	int i = 0;
-	int skippedLines = 0;
-	bool colorChanged = false;
-
-	char32_t cc = 0;
-	char32_t pc = 0;
-
-	float4 newColor = textColor;
-
-	do {
-		// check for end-of-string
-		if (SkipColorCodesAndNewLines(ustr, &i, &newColor, &colorChanged, &skippedLines, &baseTextColor))
-			return;
-
-		cc = utf8::GetNextChar(str, i);
-
-		if (colorChanged) {
-			if (autoOutlineColor) {
-				SetColors(&newColor, nullptr);
-			} else {
-				SetTextColor(&newColor);
-			}
+		for (size_t k = n * 4; k < (n * 4 + 4) && !layout.decorQuads.empty(); k++) {
+			const VA_TYPE_2dT& v = layout.decorQuads[k];
+			va2.AddVertexQ2dT(x + scaleX * v.x, y + scaleY * v.y, v.s, v.t);
 		}
 
-
-		const GlyphInfo* cg = &GetGlyph(cc);
-		const GlyphInfo* pg = nullptr;
-
-		if (skippedLines > 0) {
-			x  = startx;
-			y -= (skippedLines * lineHeight_);
-		} else if (pc != 0) {
-			pg = &GetGlyph(pc);
-			x += (scaleX * GetKerning(*pg, *cg));
+		for (size_t k = n * 4; k < (n * 4 + 4); k++) {
+			const VA_TYPE_2dT& v = layout.quads[k];
+			va.AddVertexQ2dT(x + scaleX * v.x, y + scaleY * v.y, v.s, v.t);
 		}
-
-		pg = cg;
-		pc = cc;
-
-
-		const auto&  tc = pg->texCord;
-		const auto& stc = pg->shadowTexCord;
-		const float dx0 = (scaleX * pg->size.x0()) + x, dy0 = (scaleY * pg->size.y0()) + y;
-		const float dx1 = (scaleX * pg->size.x1()) + x, dy1 = (scaleY * pg->size.y1()) + y;
-
-		// draw outline
-		va2.AddVertexQ2dT(dx0 - shiftX, dy1 - shiftY, stc.x0(), stc.y1());
-		va2.AddVertexQ2dT(dx0 - shiftX, dy0 + shiftY, stc.x0(), stc.y0());
-		va2.AddVertexQ2dT(dx1 + shiftX, dy0 + shiftY, stc.x1(), stc.y0());
-		va2.AddVertexQ2dT(dx1 + shiftX, dy1 - shiftY, stc.x1(), stc.y1());
-
-		// draw the actual character
-		va.AddVertexQ2dT(dx0, dy1, tc.x0(), tc.y1());
-		va.AddVertexQ2dT(dx0, dy0, tc.x0(), tc.y0());
-		va.AddVertexQ2dT(dx1, dy0, tc.x1(), tc.y0());
-		va.AddVertexQ2dT(dx1, dy1, tc.x1(), tc.y1());
-	} while (true);
+	}
 }
 
 
@@ -866,6 +792,19 @@ void CglFont::glWorldPrint(const float3& p, const float size, const std::string&
 
 void CglFont::glPrint(float x, float y, float s, const int options, const std::string& text)
 {
+	if (threadSafety)
+		vaMutex.lock();
+
+	int decoration = TEXT_DECORATION_NONE;
+
+	if (options & FONT_OUTLINE) {
+		decoration = TEXT_DECORATION_OUTLINE;
+	} else if (options & FONT_SHADOW) {
+		decoration = TEXT_DECORATION_SHADOW;
+	}
+
+	const TextLayout& layout = GetTextLayout(text, decoration);
+
 	// s := scale or absolute size?
 	if (options & FONT_SCALE) {
 		s *= fontSize;
@@ -881,9 +820,9 @@ void CglFont::glPrint(float x, float y, float s, const int options, const std::s
 
 	// horizontal alignment (FONT_LEFT is default)
 	if (options & FONT_CENTER) {
-		x -= sizeX * 0.5f * GetTextWidth(text);
+		x -= sizeX * 0.5f * layout.width;
 	} else if (options & FONT_RIGHT) {
-		x -= sizeX * GetTextWidth(text);
+		x -= sizeX * layout.width;
 	}
 
 
@@ -894,18 +833,15 @@ void CglFont::glPrint(float x, float y, float s, const int options, const std::s
 	} else if (options & FONT_DESCENDER) {
 		y -= sizeY * GetDescender();
 	} else if (options & FONT_VCENTER) {
-		float textDescender;
-		y -= sizeY * 0.5f * GetTextHeight(text,&textDescender);
-		y -= sizeY * 0.5f * textDescender;
+		y -= sizeY * 0.5f * layout.height;
+		y -= sizeY * 0.5f * layout.descender;
 	} else if (options & FONT_TOP) {
-		y -= sizeY * GetTextHeight(text);
+		y -= sizeY * layout.height;
 	} else if (options & FONT_ASCENDER) {
 		y -= sizeY * GetDescender();
 		y -= sizeY;
 	} else if (options & FONT_BOTTOM) {
-		float textDescender;
-		GetTextHeight(text,&textDescender);
-		y -= sizeY * textDescender;
+		y -= sizeY * layout.descender;
 	}
 
 	if (options & FONT_NEAREST) {
@@ -924,14 +860,7 @@ void CglFont::glPrint(float x, float y, float s, const int options, const std::s
 	}
 
 
-	// select correct decoration RenderString function
-	if (options & FONT_OUTLINE) {
-		RenderStringOutlined(x, y, sizeX, sizeY, text);
-	} else if (options & FONT_SHADOW) {
-		RenderStringShadow(x, y, sizeX, sizeY, text);
-	} else {
-		RenderString(x, y, sizeX, sizeY, text);
-	}
+	RenderTextLayout(layout, x, y, sizeX, sizeY);
 
 
 	// immediate mode?
@@ -941,6 +870,9 @@ void CglFont::glPrint(float x, float y, float s, const int options, const std::s
 
 	// reset text & outline colors (if changed via in text colorcodes)
 	SetColors(&baseTextColor,&baseOutlineColor);
+
+	if (threadSafety)
+		vaMutex.unlock();
 }
 
 void CglFont::glPrintTable(float x, float y, float s, const int options, const std::string& text)
@@ -3,14 +3,17 @@
 #ifndef _GLFONT_H
 #define _GLFONT_H
 
+#include <array>
 #include <string>
 #include <deque>
+#include <vector>
 
 #include "TextWrap.h"
 #include "ustring.h"
 
 #include "Rendering/GL/VertexArray.h"
 #include "System/float4.h"
+#include "System/UnorderedMap.hpp"
 #include "System/Threading/SpringThreading.h"
 
 #undef GetCharWidth // winapi.h
@@ -86,11 +89,41 @@ public:
 	static const char8_t ColorResetIndicator = 0x08; //! =: '\\b'
 	static bool threadSafety;
 private:
+	enum {
+		TEXT_DECORATION_NONE    = 0,
+		TEXT_DECORATION_SHADOW  = 1,
+		TEXT_DECORATION_OUTLINE = 2,
+		TEXT_DECORATION_COUNT   = 3,
+	};
+
+	/**
+	 * Glyph quads of a string laid out at unit scale around the origin. Every
+	 * vertex is linear in the print position and size, so one layout serves
+	 * all glPrint calls of the same string and decoration.
+	 */
+	struct TextLayout {
+		struct ColorChange {
+			uint32_t quadIndex; //! first glyph drawn in this color
+			bool reset; //! ColorResetIndicator, otherwise color.xyz is the colorcode
+			float4 color;
+		};
+
+		std::vector<VA_TYPE_2dT> quads; //! 4 vertices per glyph
+		std::vector<VA_TYPE_2dT> decorQuads; //! shadow or outline of each glyph, if any
+		std::vector<ColorChange> colorChanges;
+
+		float width = 0.0f;
+		float height = 0.0f;
+		float descender = 0.0f;
+	};
+
+	static constexpr size_t MAX_CACHED_LAYOUTS = 1024;
+
 	static const float4* ChooseOutlineColor(const float4& textColor);
 
-	void RenderString(float x, float y, const float& scaleX, const float& scaleY, const std::string& str);
-	void RenderStringShadow(float x, float y, const float& scaleX, const float& scaleY, const std::string& str);
-	void RenderStringOutlined(float x, float y, const float& scaleX, const float& scaleY, const std::string& str);
+	const TextLayout& GetTextLayout(const std::string& str, int decoration);
+	void BuildTextLayout(TextLayout& layout, const std::string& str, int decoration);
+	void RenderTextLayout(const TextLayout& layout, float x, float y, float scaleX, float scaleY);
 
 private:
 	float GetTextWidth_(const std::u8string& text);
@@ -113,6 +146,11 @@ private:
 
 	spring::recursive_mutex vaMutex;
 
+	//! keyed by string, guarded by vaMutex
+	std::array<spring::unsynced_map<std::string, TextLayout>, TEXT_DECORATION_COUNT> textLayouts;
+
+	int layoutsGlyphsVersion = -1;
+
 	bool inBeginEnd;
 	bool autoOutlineColor; //! auto select outline color for in-text-colorcodes
 	bool setColor; //! used for backward compability (so you can call glPrint (w/o BeginEnd and no shadow/outline!) and set the color yourself via glColor)
@@ -0,0 +1,126 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "GPUTimerQueries.h"
+#include "System/Misc/SpringTime.h"
+
+namespace GL {
+	bool GPUTimerQueries::Init()
+	{
+		if (state >= 0)
+			return (state == 1);
+
+		if ((state = GLEW_ARB_timer_query) == 0)
+			return false;
+
+		for (FrameQueries& frame: frames) {
+			glGenQueries(frame.queries.size(), frame.queries.data());
+			frame.numScopes = 0;
+		}
+
+		return true;
+	}
+
+	void GPUTimerQueries::Kill()
+	{
+		if (state == 1) {
+			for (FrameQueries& frame: frames) {
+				glDeleteQueries(frame.queries.size(), frame.queries.data());
+				frame.numScopes = 0;
+			}
+		}
+
+		state = -1;
+		recording = false;
+	}
+
+
+	void GPUTimerQueries::Update()
+	{
+		recording = false;
+
+		if (!profiler.IsEnabled() && !profiler.IsTracing())
+			return;
+		if (!Init())
+			return;
+
+		curFrameIdx = (curFrameIdx + 1) % NUM_FRAMES;
+
+		ReadBack(curFrameIdx);
+
+		FrameQueries& frame = frames[curFrameIdx];
+
+		GLint64 gpuTime = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+
+		frame.numScopes = 0;
+		frame.clockOffset = spring_now().toNanoSecsi() - gpuTime;
+
+		recording = true;
+	}
+
+	void GPUTimerQueries::ReadBack(uint32_t frameIdx)
+	{
+		FrameQueries& frame = frames[frameIdx];
+
+		if (frame.numScopes == 0)
+			return;
+
+		// never block; a frame that is somehow still in flight is dropped
+		for (uint32_t i = 0; i < frame.numScopes; i++) {
+			GLint available = 0;
+			glGetQueryObjectiv(frame.queries[i * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+			if (!available) {
+				frame.numScopes = 0;
+				return;
+			}
+		}
+
+		const bool tracing = profiler.IsTracing();
+
+		for (uint32_t i = 0; i < frame.numScopes; i++) {
+			GLuint64 t0 = 0;
+			GLuint64 t1 = 0;
+
+			glGetQueryObjectui64v(frame.queries[i * 2 + 0], GL_QUERY_RESULT, &t0);
+			glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &t1);
+
+			const spring_time startTime = spring_time::fromNanoSecs(int64_t(t0) + frame.clockOffset);
+			const spring_time deltaTime = spring_time::fromNanoSecs(int64_t(t1 - t0));
+
+			profiler.AddTime(frame.nameHashes[i], startTime, deltaTime);
+
+			if (tracing)
+				profiler.AddGPUTraceEvent(frame.nameHashes[i], startTime, startTime + deltaTime);
+		}
+
+		frame.numScopes = 0;
+	}
+
+
+	int GPUTimerQueries::BeginScope(unsigned nameHash)
+	{
+		if (!recording)
+			return -1;
+
+		FrameQueries& frame = frames[curFrameIdx];
+
+		if (frame.numScopes >= MAX_SCOPES)
+			return -1;
+
+		const uint32_t scopeIdx = frame.numScopes++;
+
+		frame.nameHashes[scopeIdx] = nameHash;
+		glQueryCounter(frame.queries[scopeIdx * 2 + 0], GL_TIMESTAMP);
+
+		return scopeIdx;
+	}
+
+	void GPUTimerQueries::EndScope(int scopeIdx)
+	{
+		if (scopeIdx < 0 || !recording)
+			return;
+
+		glQueryCounter(frames[curFrameIdx].queries[scopeIdx * 2 + 1], GL_TIMESTAMP);
+	}
+}
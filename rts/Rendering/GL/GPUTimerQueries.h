@@ -0,0 +1,80 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _GL_GPUTIMERQUERIES_H
+#define _GL_GPUTIMERQUERIES_H
+
+#include <array>
+#include <cstdint>
+
+#include "myGL.h"
+#include "System/TimeProfiler.h"
+
+// GPU counterpart of SCOPED_TIMER, shows up in the profiler as "GPU::<name>"
+// NB: names are assumed to be compile-time literals
+#define SCOPED_GPU_TIMER(name)  static TimerNameRegistrar __gtnr("GPU::" name); GL::ScopedGPUTimer __scopedGPUTimer(hashString("GPU::" name));
+
+namespace GL {
+	/**
+	 * GL_TIMESTAMP queries around render passes. Each draw-frame records into
+	 * its own set of queries, which is read back NUM_FRAMES draw-frames later
+	 * when the results are long available, so nothing ever waits on the GPU.
+	 * Durations are fed to the profiler (and its trace recorder) like those
+	 * of the CPU timers; only active while either of them is.
+	 */
+	struct GPUTimerQueries {
+	public:
+		static constexpr uint32_t MAX_SCOPES = 64; // per draw-frame, excess scopes are not timed
+		static constexpr uint32_t NUM_FRAMES = 3;
+
+	public:
+		static GPUTimerQueries& GetInstance() {
+			static GPUTimerQueries instance;
+			return instance;
+		}
+
+		void Kill();
+
+		// reads back the oldest recorded frame and starts a new one; once per draw-frame
+		void Update();
+
+		// returns the scope's slot, -1 if not recording
+		int BeginScope(unsigned nameHash);
+		void EndScope(int scopeIdx);
+
+	private:
+		bool Init();
+		void ReadBack(uint32_t frameIdx);
+
+	private:
+		struct FrameQueries {
+			std::array<GLuint, MAX_SCOPES * 2> queries = {};
+			std::array<unsigned, MAX_SCOPES> nameHashes = {};
+
+			uint32_t numScopes = 0;
+
+			// CPU minus GPU clock (ns) when the frame started, maps GPU timestamps for tracing
+			int64_t clockOffset = 0;
+		};
+
+		std::array<FrameQueries, NUM_FRAMES> frames;
+
+		uint32_t curFrameIdx = 0;
+
+		// -1 := not yet tried, 0 := unsupported, 1 := queries created
+		int state = -1;
+
+		bool recording = false;
+	};
+
+
+	class ScopedGPUTimer {
+	public:
+		ScopedGPUTimer(unsigned nameHash): scopeIdx(GPUTimerQueries::GetInstance().BeginScope(nameHash)) {}
+		~ScopedGPUTimer() { GPUTimerQueries::GetInstance().EndScope(scopeIdx); }
+
+	private:
+		const int scopeIdx;
+	};
+}
+
+#endif // _GL_GPUTIMERQUERIES_H
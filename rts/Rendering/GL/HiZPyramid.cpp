@@ -0,0 +1,396 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "HiZPyramid.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "GeometryBuffer.h"
+#include "VertexArray.h"
+#include "Game/Camera.h"
+#include "Map/BaseGroundDrawer.h"
+#include "Map/ReadMap.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "Rendering/Shaders/Shader.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+#include "System/SpringMath.h"
+
+CONFIG(bool, HiZOcclusionCulling).defaultValue(false).headlessValue(false).safemodeValue(false).description("Skip drawing units and features hidden behind the terrain, tested against a depth pyramid of a previous frame.");
+
+
+bool GL::HiZPyramid::IsEnabled()
+{
+	if (state >= 0)
+		return (state > 0);
+
+	state = 0;
+
+	if (!configHandler->GetBool("HiZOcclusionCulling"))
+		return false;
+	// the depth copy can not read from a multisampled framebuffer
+	if (!globalRendering->haveGL4 || globalRendering->msaaLevel > 0)
+		return false;
+
+	if (!InitResources()) {
+		LOG_L(L_WARNING, "[HiZPyramid::%s] depth reduction shader failed to compile, occlusion culling is disabled", __func__);
+		return false;
+	}
+
+	state = 1;
+	return true;
+}
+
+bool GL::HiZPyramid::InitResources()
+{
+	shader = shaderHandler->CreateProgramObject("[HiZPyramid]", "HiZReduce", false);
+	shader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/HiZReduceVertProg.glsl", "", GL_VERTEX_SHADER));
+	shader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/HiZReduceFragProg.glsl", "", GL_FRAGMENT_SHADER));
+	shader->Link();
+	shader->Enable();
+	shader->SetUniform("srcTex", 0);
+	shader->Disable();
+	shader->Validate();
+
+	if (!shader->IsValid())
+		return false;
+
+	fbo.Init(false);
+	readbackPBO = VBO{GL_PIXEL_PACK_BUFFER, false};
+	return true;
+}
+
+void GL::HiZPyramid::Kill()
+{
+	if (shader != nullptr)
+		shaderHandler->ReleaseProgramObjects("[HiZPyramid]");
+
+	if (readbackFence != nullptr)
+		glDeleteSync(readbackFence);
+
+	glDeleteTextures(1, &depthTex);
+	glDeleteTextures(1, &pyramidTex);
+
+	shader = nullptr;
+	readbackFence = nullptr;
+	depthTex = 0;
+	pyramidTex = 0;
+
+	fbo.Kill();
+	readbackPBO = VBO{};
+
+	gpuLevelSizes.clear();
+	cpuLevels.clear();
+
+	usable = false;
+	state = -1;
+}
+
+
+void GL::HiZPyramid::CreateTextures(const int2 size)
+{
+	glDeleteTextures(1, &depthTex);
+	glDeleteTextures(1, &pyramidTex);
+
+	gpuLevelSizes.clear();
+	gpuLevelSizes.push_back(size);
+
+	// every level halves (rounding up) until it is narrow enough to be read back
+	while (gpuLevelSizes.back().x > READBACK_MAX_WIDTH) {
+		const int2 prev = gpuLevelSizes.back();
+		gpuLevelSizes.push_back({(prev.x + 1) >> 1, (prev.y + 1) >> 1});
+	}
+
+	// at least one reduction, the depth texture itself can not be attached as color
+	if (gpuLevelSizes.size() == 1)
+		gpuLevelSizes.push_back({(size.x + 1) >> 1, (size.y + 1) >> 1});
+
+	const int numMips = gpuLevelSizes.size() - 1;
+
+	glGenTextures(1, &depthTex);
+	glBindTexture(GL_TEXTURE_2D, depthTex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, CGlobalRendering::DepthBitsToFormat(globalRendering->supportDepthBufferBitDepth), size.x, size.y, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+
+	// mip i holds pyramid level i + 1
+	glGenTextures(1, &pyramidTex);
+	glBindTexture(GL_TEXTURE_2D, pyramidTex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexStorage2D(GL_TEXTURE_2D, numMips, GL_R32F, gpuLevelSizes[1].x, gpuLevelSizes[1].y);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	cpuBaseLevel = numMips;
+
+	readbackPBO.Bind();
+	readbackPBO.New(gpuLevelSizes.back().x * gpuLevelSizes.back().y * sizeof(float), GL_STREAM_READ);
+	readbackPBO.Unbind();
+}
+
+void GL::HiZPyramid::Capture(const CCamera* cam)
+{
+	if (!IsEnabled())
+		return;
+
+	// previous readback still in flight
+	if (readbackFence != nullptr)
+		return;
+	if (cam->GetCamType() != CCamera::CAMTYPE_PLAYER)
+		return;
+
+	const int2 size = {globalRendering->viewSizeX, globalRendering->viewSizeY};
+
+	if (gpuLevelSizes.empty() || gpuLevelSizes[0] != size)
+		CreateTextures(size);
+
+	// the deferred ground pass already keeps a (terrain-only) depth texture
+	GLuint srcTex = depthTex;
+
+	const CBaseGroundDrawer* gd = readMap->GetGroundDrawer();
+	const GeometryBuffer* gb = gd->GetGeometryBuffer();
+
+	if (gd->DrawDeferred() && gb != nullptr && gb->Valid() && gb->GetTextureTarget() == GL_TEXTURE_2D && gb->GetCurrSize() == size) {
+		srcTex = gb->GetBufferTexture(GeometryBuffer::ATTACHMENT_ZVALTEX);
+	} else {
+		glBindTexture(GL_TEXTURE_2D, depthTex);
+		glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, globalRendering->viewPosX, globalRendering->viewPosY, size.x, size.y);
+	}
+
+	glPushAttrib(GL_ENABLE_BIT | GL_VIEWPORT_BIT | GL_DEPTH_BUFFER_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+	glDisable(GL_ALPHA_TEST);
+	glDisable(GL_CULL_FACE);
+	glDepthMask(GL_FALSE);
+
+	fbo.Bind();
+	shader->Enable();
+
+	CVertexArray* va = GetVertexArray();
+
+	for (size_t level = 1; level < gpuLevelSizes.size(); ++level) {
+		const int2 srcSize = gpuLevelSizes[level - 1];
+		const int2 dstSize = gpuLevelSizes[level    ];
+
+		fbo.AttachTexture(pyramidTex, GL_TEXTURE_2D, GL_COLOR_ATTACHMENT0, level - 1);
+
+		if (level == 1) {
+			glBindTexture(GL_TEXTURE_2D, srcTex);
+		} else {
+			// restrict sampling to the source mip, the destination one is attached
+			glBindTexture(GL_TEXTURE_2D, pyramidTex);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 2);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 2);
+		}
+
+		shader->SetUniform("srcSize", srcSize.x, srcSize.y);
+		glViewport(0, 0, dstSize.x, dstSize.y);
+
+		va->Initialize();
+		va->AddVertex2dT(0.0f, 0.0f, 0.0f, 0.0f);
+		va->AddVertex2dT(1.0f, 0.0f, 1.0f, 0.0f);
+		va->AddVertex2dT(0.0f, 1.0f, 0.0f, 1.0f);
+		va->AddVertex2dT(1.0f, 1.0f, 1.0f, 1.0f);
+		va->DrawArray2dT(GL_TRIANGLE_STRIP);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, pyramidTex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, gpuLevelSizes.size() - 2);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	shader->Disable();
+
+	// the coarsest GPU level is still attached
+	readbackPBO.Bind();
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glReadPixels(0, 0, gpuLevelSizes.back().x, gpuLevelSizes.back().y, GL_RED, GL_FLOAT, nullptr);
+	readbackPBO.Unbind();
+
+	readbackFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	fbo.Unbind();
+	glPopAttrib();
+
+	pendingViewProj = cam->GetViewProjectionMatrix();
+	pendingCamPos = cam->GetPos();
+	pendingViewSize = size;
+	pendingFrame = globalRendering->drawFrame;
+}
+
+void GL::HiZPyramid::Fetch()
+{
+	for (int i = 0; i < OBJ_TYPE_CNT; i++) {
+		lastNumTested[i] = numTested[i].exchange(0, std::memory_order_relaxed);
+		lastNumOccluded[i] = numOccluded[i].exchange(0, std::memory_order_relaxed);
+	}
+
+	if (!IsEnabled())
+		return;
+
+	// e.g. while the world is not being drawn
+	usable &= ((globalRendering->drawFrame - captureFrame) <= MAX_PYRAMID_AGE);
+
+	if (readbackFence == nullptr)
+		return;
+
+	const GLenum waitRet = glClientWaitSync(readbackFence, 0, 0);
+
+	if (waitRet != GL_ALREADY_SIGNALED && waitRet != GL_CONDITION_SATISFIED)
+		return;
+
+	glDeleteSync(readbackFence);
+	readbackFence = nullptr;
+
+	// a resize since the capture reallocated the buffer
+	if (pendingViewSize != gpuLevelSizes[0])
+		return;
+
+	const int2 readbackSize = gpuLevelSizes.back();
+
+	cpuLevels.resize(1);
+	cpuLevels[0].size = readbackSize;
+	cpuLevels[0].depths.resize(readbackSize.x * readbackSize.y);
+
+	readbackPBO.Bind();
+	const GLubyte* mem = readbackPBO.MapBuffer(GL_READ_ONLY);
+
+	if (mem != nullptr)
+		std::memcpy(cpuLevels[0].depths.data(), mem, cpuLevels[0].depths.size() * sizeof(float));
+
+	readbackPBO.UnmapBuffer();
+	readbackPBO.Unbind();
+
+	if ((usable = (mem != nullptr))) {
+		BuildCPULevels();
+
+		viewProj = pendingViewProj;
+		camPos = pendingCamPos;
+		viewSize = pendingViewSize;
+		captureFrame = pendingFrame;
+	}
+}
+
+
+void GL::HiZPyramid::BuildCPULevels()
+{
+	while (cpuLevels.back().size.x > 1 || cpuLevels.back().size.y > 1) {
+		const Level& src = cpuLevels.back();
+		Level dst;
+
+		dst.size = {(src.size.x + 1) >> 1, (src.size.y + 1) >> 1};
+		dst.depths.resize(dst.size.x * dst.size.y);
+
+		for (int y = 0; y < dst.size.y; y++) {
+			for (int x = 0; x < dst.size.x; x++) {
+				const int sx0 = x * 2, sx1 = std::min(sx0 + 1, src.size.x - 1);
+				const int sy0 = y * 2, sy1 = std::min(sy0 + 1, src.size.y - 1);
+
+				dst.depths[y * dst.size.x + x] = std::max(
+					std::max(src.depths[sy0 * src.size.x + sx0], src.depths[sy0 * src.size.x + sx1]),
+					std::max(src.depths[sy1 * src.size.x + sx0], src.depths[sy1 * src.size.x + sx1])
+				);
+			}
+		}
+
+		cpuLevels.push_back(std::move(dst));
+	}
+}
+
+float GL::HiZPyramid::GetMaxDepth(int level, int x0, int y0, int x1, int y1) const
+{
+	const Level& lvl = cpuLevels[level];
+
+	x0 = std::min(x0, lvl.size.x - 1); x1 = std::min(x1, lvl.size.x - 1);
+	y0 = std::min(y0, lvl.size.y - 1); y1 = std::min(y1, lvl.size.y - 1);
+
+	float maxDepth = 0.0f;
+
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			maxDepth = std::max(maxDepth, lvl.depths[y * lvl.size.x + x]);
+		}
+	}
+
+	return maxDepth;
+}
+
+bool GL::HiZPyramid::IsOccluded(const CCamera* cam, const float3& pos, float radius, ObjectTypes objType) const
+{
+	if (!usable)
+		return false;
+
+	numTested[objType].fetch_add(1, std::memory_order_relaxed);
+
+	// the pyramid was seen from <camPos>; growing the bounds by the distance travelled
+	// since keeps objects revealed by parallax from popping in a frame late
+	const float testRadius = radius + cam->GetPos().distance(camPos);
+
+	if (pos.SqDistance(camPos) <= Square(testRadius + cam->GetNearPlaneDist()))
+		return false;
+
+	float2 uvMins = { 1e9f,  1e9f};
+	float2 uvMaxs = {-1e9f, -1e9f};
+	float minDepth = 1.0f;
+
+	for (int i = 0; i < 8; i++) {
+		const float3 corner = pos + float3((i & 1)? testRadius: -testRadius, (i & 2)? testRadius: -testRadius, (i & 4)? testRadius: -testRadius);
+		const float4 clipPos = viewProj * float4(corner.x, corner.y, corner.z, 1.0f);
+
+		if (clipPos.w <= 0.0f)
+			return false;
+
+		const float3 ndcPos = float3(clipPos.x, clipPos.y, clipPos.z) / clipPos.w;
+		const float depth = globalRendering->supportClipSpaceControl? ndcPos.z: (ndcPos.z * 0.5f + 0.5f);
+
+		uvMins = {std::min(uvMins.x, ndcPos.x * 0.5f + 0.5f), std::min(uvMins.y, ndcPos.y * 0.5f + 0.5f)};
+		uvMaxs = {std::max(uvMaxs.x, ndcPos.x * 0.5f + 0.5f), std::max(uvMaxs.y, ndcPos.y * 0.5f + 0.5f)};
+		minDepth = std::min(minDepth, depth);
+	}
+
+	// nothing is known about what was outside the captured view
+	if (uvMins.x < 0.0f || uvMins.y < 0.0f || uvMaxs.x > 1.0f || uvMaxs.y > 1.0f)
+		return false;
+
+	const int px0 = int(uvMins.x * viewSize.x), px1 = std::min(int(uvMaxs.x * viewSize.x), viewSize.x - 1);
+	const int py0 = int(uvMins.y * viewSize.y), py1 = std::min(int(uvMaxs.y * viewSize.y), viewSize.y - 1);
+
+	// coarsest level at which the rect still touches at most 2x2 texels
+	int level = 0;
+
+	while ((level + 1) < int(cpuLevels.size())) {
+		const int shift = cpuBaseLevel + level;
+
+		if (((px1 >> shift) - (px0 >> shift)) <= 1 && ((py1 >> shift) - (py0 >> shift)) <= 1)
+			break;
+
+		level += 1;
+	}
+
+	const int shift = cpuBaseLevel + level;
+
+	if (minDepth <= GetMaxDepth(level, px0 >> shift, py0 >> shift, px1 >> shift, py1 >> shift))
+		return false;
+
+	numOccluded[objType].fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+
+void GL::HiZPyramid::PrintDebugInfo() const
+{
+	LOG("[HiZPyramid] occlusion culling %s", (state > 0)? (usable? "active": "waiting for a depth readback"): "disabled (see HiZOcclusionCulling)");
+
+	if (state <= 0)
+		return;
+
+	LOG("\tpyramid: %dx%d, %u levels read back, captured %u draw-frames ago", viewSize.x, viewSize.y, unsigned(cpuLevels.size()), globalRendering->drawFrame - captureFrame);
+	LOG("\tunits   : %u of %u tested occluded", lastNumOccluded[OBJ_TYPE_UNIT], lastNumTested[OBJ_TYPE_UNIT]);
+	LOG("\tfeatures: %u of %u tested occluded", lastNumOccluded[OBJ_TYPE_FEATURE], lastNumTested[OBJ_TYPE_FEATURE]);
+}
@@ -0,0 +1,121 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _GL_HIZPYRAMID_H
+#define _GL_HIZPYRAMID_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "FBO.h"
+#include "VBO.h"
+#include "myGL.h"
+#include "System/Matrix44f.h"
+#include "System/float3.h"
+#include "System/type2.h"
+
+class CCamera;
+
+namespace Shader {
+	struct IProgramObject;
+}
+
+namespace GL {
+	/**
+	 * Hierarchical-Z occlusion test for the unit and feature drawers. Right
+	 * after the ground pass the depth buffer is reduced on the GPU into a
+	 * max-depth mip chain, whose coarsest levels are read back without
+	 * stalling; the drawer data then tests object bounds against the most
+	 * recent completed pyramid (one or two frames old) while computing the
+	 * player camera draw-flags. Only the ground contributes occluders, so a
+	 * moving model can never hide another one.
+	 */
+	struct HiZPyramid {
+	public:
+		enum ObjectTypes {
+			OBJ_TYPE_UNIT    = 0,
+			OBJ_TYPE_FEATURE = 1,
+			OBJ_TYPE_CNT     = 2,
+		};
+
+		// GPU levels are reduced until the level width fits, the coarser ones are built on the CPU
+		static constexpr int READBACK_MAX_WIDTH = 256;
+		// a pyramid this many draw-frames old is not trusted anymore
+		static constexpr uint32_t MAX_PYRAMID_AGE = 8;
+
+	public:
+		static HiZPyramid& GetInstance() {
+			static HiZPyramid instance;
+			return instance;
+		}
+
+		bool IsEnabled();
+		// true if IsOccluded can cull this frame
+		bool IsUsable() const { return usable; }
+
+		void Kill();
+
+		// maps the last completed readback; once per draw-frame before the drawer data is updated
+		void Fetch();
+		// reduces the current depth buffer; must be called right after the ground pass
+		void Capture(const CCamera* cam);
+
+		// thread-safe, conservatively false whenever the pyramid can not decide
+		bool IsOccluded(const CCamera* cam, const float3& pos, float radius, ObjectTypes objType) const;
+
+		void PrintDebugInfo() const;
+
+	private:
+		bool InitResources();
+		void CreateTextures(const int2 size);
+		void BuildCPULevels();
+
+		float GetMaxDepth(int level, int x0, int y0, int x1, int y1) const;
+
+	private:
+		struct Level {
+			std::vector<float> depths;
+			int2 size;
+		};
+
+		// -1 := not yet tried, 0 := disabled or unsupported, 1 := enabled
+		int state = -1;
+
+		Shader::IProgramObject* shader = nullptr;
+
+		FBO fbo{true};
+		VBO readbackPBO;
+
+		GLuint depthTex = 0;
+		GLuint pyramidTex = 0;
+		GLsync readbackFence = nullptr;
+
+		// {screen, GPU mip sizes...}
+		std::vector<int2> gpuLevelSizes;
+		// [0] is the read-back GPU level, pixel footprint of level i is 1 << (cpuBaseLevel + i)
+		std::vector<Level> cpuLevels;
+
+		int cpuBaseLevel = 0;
+
+		// state of the capture in flight and of the one being tested against
+		CMatrix44f pendingViewProj;
+		CMatrix44f viewProj;
+		float3 pendingCamPos;
+		float3 camPos;
+		int2 pendingViewSize;
+		int2 viewSize;
+		uint32_t pendingFrame = 0;
+		uint32_t captureFrame = 0;
+
+		bool usable = false;
+
+		mutable std::array<std::atomic<uint32_t>, OBJ_TYPE_CNT> numTested = {};
+		mutable std::array<std::atomic<uint32_t>, OBJ_TYPE_CNT> numOccluded = {};
+
+		std::array<uint32_t, OBJ_TYPE_CNT> lastNumTested = {};
+		std::array<uint32_t, OBJ_TYPE_CNT> lastNumOccluded = {};
+	};
+}
+
+#endif // _GL_HIZPYRAMID_H
@@ -0,0 +1,217 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LightClusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "myGL.h"
+#include "StreamBuffer.h"
+#include "Game/Camera.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/Shaders/Shader.h"
+#include "System/StringUtil.h"
+
+
+bool GL::LightClusters::IsSupported()
+{
+	return (globalRendering->haveGL4 && GLEW_ARB_shader_storage_buffer_object);
+}
+
+std::string GL::LightClusters::GetShaderDefs()
+{
+	return
+		"#version 430 compatibility\n"
+		"#define CLUSTERED_DYNAMIC_LIGHTS\n" +
+		("#define CLUSTER_TILES_X " + IntToString(NUM_TILES_X) + "u\n") +
+		("#define CLUSTER_TILES_Y " + IntToString(NUM_TILES_Y) + "u\n") +
+		("#define CLUSTER_SLICES " + IntToString(NUM_SLICES) + "u\n") +
+		("#define CLUSTER_LIGHTS_SSBO_BINDING_IDX " + IntToString(LIGHTS_SSBO_BINDING_IDX) + "\n") +
+		("#define CLUSTER_RANGES_SSBO_BINDING_IDX " + IntToString(RANGES_SSBO_BINDING_IDX) + "\n") +
+		("#define CLUSTER_INDICES_SSBO_BINDING_IDX " + IntToString(INDICES_SSBO_BINDING_IDX) + "\n");
+}
+
+void GL::LightClusters::Kill()
+{
+	for (VBO& ssbo: ssbos) {
+		ssbo.Release();
+	}
+
+	Clear();
+
+	lastDrawFrame = -1u;
+	lastCamType = -1u;
+}
+
+
+bool GL::LightClusters::NeedsUpdate(const CCamera* cam) const
+{
+	return (lastDrawFrame != globalRendering->drawFrame || lastCamType != cam->GetCamType());
+}
+
+void GL::LightClusters::Update(const CCamera* cam)
+{
+	lastDrawFrame = globalRendering->drawFrame;
+	lastCamType = cam->GetCamType();
+
+	AssignLights(cam);
+	Upload();
+}
+
+
+void GL::LightClusters::AssignLights(const CCamera* cam)
+{
+	const CMatrix44f& viewMat = cam->GetViewMatrix();
+
+	const float nearDist = std::max(cam->GetNearPlaneDist(), 1.0f);
+	const float farDist = std::max(cam->GetFarPlaneDist(), nearDist * 2.0f);
+	const float sliceScale = NUM_SLICES / std::log(farDist / nearDist);
+
+	const float tanHalfFovY = cam->GetTanHalfFov();
+	const float tanHalfFovX = tanHalfFovY * cam->GetAspectRatio();
+
+	// ortho projections only get depth-binned
+	const bool perspective = (cam->GetProjType() == CCamera::PROJTYPE_PERSP);
+
+	GLint vp[4];
+	glGetIntegerv(GL_VIEWPORT, vp);
+
+	viewport = {float(vp[0]), float(vp[1]), 1.0f / std::max(vp[2], 1), 1.0f / std::max(vp[3], 1)};
+	viewDepthRow = {viewMat.m[2], viewMat.m[6], viewMat.m[10], viewMat.m[14]};
+	depthParams[0] = nearDist;
+	depthParams[1] = sliceScale;
+
+	const auto SliceOf = [&](float depth) {
+		return std::clamp(int(std::log(std::max(depth, nearDist) / nearDist) * sliceScale), 0, int(NUM_SLICES) - 1);
+	};
+	const auto SliceStart = [&](int slice) {
+		return (nearDist * std::pow(farDist / nearDist, slice / float(NUM_SLICES)));
+	};
+	// conservative NDC range of [minCoor, maxCoor] over view depths [minDepth, maxDepth]
+	const auto TileRange = [&](float minCoor, float maxCoor, float minDepth, float maxDepth, float tanHalfFov, uint32_t numTiles) {
+		const float minNDC = minCoor / (tanHalfFov * ((minCoor < 0.0f)? minDepth: maxDepth));
+		const float maxNDC = maxCoor / (tanHalfFov * ((maxCoor > 0.0f)? minDepth: maxDepth));
+
+		const int minTile = int(std::floor((minNDC * 0.5f + 0.5f) * numTiles));
+		const int maxTile = int(std::floor((maxNDC * 0.5f + 0.5f) * numTiles));
+
+		return std::array<int, 2>{std::max(minTile, 0), std::min(maxTile, int(numTiles) - 1)};
+	};
+
+	// higher-priority lights claim the cluster slots first
+	order.resize(lights.size());
+	counts.assign(NUM_CLUSTERS, 0);
+	pairs.clear();
+	viewPositions.resize(lights.size());
+
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+		viewPositions[i] = lights[i].posRadius;
+	}
+
+	viewMat.Mul(viewPositions.data(), viewPositions.data(), viewPositions.size());
+
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return (priorities[a] > priorities[b]); });
+
+	for (const uint32_t lightIdx: order) {
+		const float3& viewPos = viewPositions[lightIdx];
+
+		const float radius = lights[lightIdx].posRadius.w;
+		const float depth = -viewPos.z;
+
+		if ((depth + radius) < nearDist || (depth - radius) > farDist)
+			continue;
+
+		const int minSlice = SliceOf(depth - radius);
+		const int maxSlice = SliceOf(depth + radius);
+
+		for (int slice = minSlice; slice <= maxSlice; slice++) {
+			const float minDepth = std::max(depth - radius, SliceStart(slice    ));
+			const float maxDepth = std::min(depth + radius, SliceStart(slice + 1));
+
+			std::array<int, 2> xTiles = {0, int(NUM_TILES_X) - 1};
+			std::array<int, 2> yTiles = {0, int(NUM_TILES_Y) - 1};
+
+			if (perspective) {
+				xTiles = TileRange(viewPos.x - radius, viewPos.x + radius, minDepth, maxDepth, tanHalfFovX, NUM_TILES_X);
+				yTiles = TileRange(viewPos.y - radius, viewPos.y + radius, minDepth, maxDepth, tanHalfFovY, NUM_TILES_Y);
+			}
+
+			for (int y = yTiles[0]; y <= yTiles[1]; y++) {
+				for (int x = xTiles[0]; x <= xTiles[1]; x++) {
+					const uint32_t clusterIdx = (slice * NUM_TILES_Y + y) * NUM_TILES_X + x;
+
+					if (counts[clusterIdx] >= MAX_CLUSTER_LIGHTS)
+						continue;
+
+					counts[clusterIdx] += 1;
+					pairs.push_back({clusterIdx, lightIdx});
+				}
+			}
+		}
+	}
+
+	// counting-sort the (cluster, light) pairs into one compact index list
+	ranges.resize(NUM_CLUSTERS * 2);
+	indices.resize(std::max(pairs.size(), size_t(1)));
+
+	for (uint32_t clusterIdx = 0, offset = 0; clusterIdx < NUM_CLUSTERS; clusterIdx++) {
+		ranges[clusterIdx * 2 + 0] = offset;
+		ranges[clusterIdx * 2 + 1] = 0;
+		offset += counts[clusterIdx];
+	}
+
+	for (const auto& pair: pairs) {
+		uint32_t* range = &ranges[pair[0] * 2];
+		indices[range[0] + range[1]++] = pair[1];
+	}
+}
+
+void GL::LightClusters::Upload()
+{
+	// keep every binding non-empty
+	if (lights.empty())
+		lights.emplace_back();
+
+	const std::array<const void*, 3> datas = {lights.data(), ranges.data(), indices.data()};
+	const std::array<uint32_t, 3> sizes = {
+		uint32_t(lights.size() * sizeof(ClusterLight)),
+		uint32_t(ranges.size() * sizeof(uint32_t)),
+		uint32_t(indices.size() * sizeof(uint32_t)),
+	};
+
+	auto& streamArena = StreamRingArena::GetInstance();
+
+	for (size_t i = 0; i < ssbos.size(); i++) {
+		if (streamArena.IsAvailable()) {
+			const auto chunk = streamArena.Allocate(sizes[i], VBO::GetOffsetAlignment(GL_SHADER_STORAGE_BUFFER), StreamRingArena::SRA_LIGHTCLUSTERS);
+
+			if (chunk.ptr != nullptr) {
+				std::memcpy(chunk.ptr, datas[i], sizes[i]);
+				ssboRanges[i] = {streamArena.GetID(), chunk.byteOffset, sizes[i]};
+				continue;
+			}
+		}
+
+		// orphaned on every upload
+		ssbos[i].Bind(GL_SHADER_STORAGE_BUFFER);
+		ssbos[i].New(sizes[i], GL_STREAM_DRAW, datas[i]);
+		ssbos[i].Unbind();
+
+		ssboRanges[i] = {ssbos[i].GetIdRaw(), 0, sizes[i]};
+	}
+}
+
+void GL::LightClusters::Bind(Shader::IProgramObject* shader) const
+{
+	constexpr std::array<uint32_t, 3> bindingIndices = {LIGHTS_SSBO_BINDING_IDX, RANGES_SSBO_BINDING_IDX, INDICES_SSBO_BINDING_IDX};
+
+	for (size_t i = 0; i < ssboRanges.size(); i++) {
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, bindingIndices[i], ssboRanges[i][0], ssboRanges[i][1], ssboRanges[i][2]);
+	}
+
+	shader->SetUniform4v("clusterViewport", &viewport.x);
+	shader->SetUniform4v("clusterViewDepth", &viewDepthRow.x);
+	shader->SetUniform("clusterDepthParams", depthParams[0], depthParams[1]);
+}
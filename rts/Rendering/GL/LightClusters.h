@@ -0,0 +1,97 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _GL_LIGHTCLUSTERS_H
+#define _GL_LIGHTCLUSTERS_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "VBO.h"
+#include "System/float4.h"
+
+class CCamera;
+
+namespace Shader {
+	struct IProgramObject;
+}
+
+namespace GL {
+	/**
+	 * Clustered (froxel) light assignment for LightHandler. The view
+	 * frustum is split into NUM_TILES_X * NUM_TILES_Y screen tiles and
+	 * NUM_SLICES exponentially spaced depth slices; every cluster stores
+	 * the indices of at most MAX_CLUSTER_LIGHTS lights whose bounding
+	 * sphere overlaps it, so the per-fragment cost stays bounded however
+	 * many lights the scene contains. Lights, cluster ranges and index
+	 * lists are read by the shaders from three SSBOs.
+	 */
+	struct LightClusters {
+	public:
+		static constexpr uint32_t NUM_TILES_X = 16;
+		static constexpr uint32_t NUM_TILES_Y = 9;
+		static constexpr uint32_t NUM_SLICES = 24;
+		static constexpr uint32_t NUM_CLUSTERS = NUM_TILES_X * NUM_TILES_Y * NUM_SLICES;
+		static constexpr uint32_t MAX_CLUSTER_LIGHTS = 32;
+
+		static constexpr uint32_t LIGHTS_SSBO_BINDING_IDX = 5;
+		static constexpr uint32_t RANGES_SSBO_BINDING_IDX = 6;
+		static constexpr uint32_t INDICES_SSBO_BINDING_IDX = 7;
+
+		// std430 layout, positions and directions are in world-space
+		struct ClusterLight {
+			float4 posRadius;
+			float4 ambientColor;
+			float4 diffuseColor;
+			float4 specularColor;
+			float4 spotDirCosCutoff;
+		};
+
+	public:
+		static bool IsSupported();
+		// prepended to the fragment shaders sampling the clusters
+		static std::string GetShaderDefs();
+
+		void Kill();
+
+		// lights are only collected and assigned again once per frame and camera
+		bool NeedsUpdate(const CCamera* cam) const;
+		void Clear() { lights.clear(); priorities.clear(); }
+		void AddLight(const ClusterLight& light, uint32_t priority) {
+			lights.push_back(light);
+			priorities.push_back(priority);
+		}
+
+		void Update(const CCamera* cam);
+		void Bind(Shader::IProgramObject* shader) const;
+
+	private:
+		void AssignLights(const CCamera* cam);
+		void Upload();
+
+	private:
+		std::vector<ClusterLight> lights;
+		std::vector<uint32_t> priorities;
+
+		std::vector<uint32_t> ranges; // {offset, count} per cluster
+		std::vector<uint32_t> indices;
+		std::vector<uint32_t> order;
+		std::vector<uint32_t> counts;
+		std::vector<float3> viewPositions; // per light
+		std::vector<std::array<uint32_t, 2>> pairs; // {cluster, light}
+
+		// fallback storage if the stream arena is unavailable
+		std::array<VBO, 3> ssbos;
+		std::array<std::array<uint32_t, 3>, 3> ssboRanges = {}; // {buffer, offset, size}
+
+		float4 viewport;
+		float4 viewDepthRow;
+		float depthParams[2] = {1.0f, 1.0f};
+
+		uint32_t lastDrawFrame = -1u;
+		uint32_t lastCamType = -1u;
+	};
+}
+
+#endif // _GL_LIGHTCLUSTERS_H
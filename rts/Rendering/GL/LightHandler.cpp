@@ -2,16 +2,91 @@
 
 #include "myGL.h"
 #include "LightHandler.h"
+#include "Game/Camera.h"
 #include "Game/GlobalUnsynced.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Projectiles/Projectile.h"
+#include "System/SpringMath.h"
+#include "System/Config/ConfigHandler.h"
+
+CONFIG(int, ClusteredDynamicLights)
+	.defaultValue(0)
+	.minimumValue(0)
+	.maximumValue(4096)
+	.description("Number of dynamic map and model lights (each) assigned to screen-space clusters instead of the fixed OpenGL light slots, 0 to disable. Requires GL4 and GLSL shaders.");
 
 //automatically initialized to zeros
 static constexpr float4 ZeroVector4;
 
+// advances <light> to the current frame, false if it died
+static bool UpdateLightState(GL::Light& light, float4& lightPos, float4& lightDir) {
+	if (light.GetAbsoluteTime() != gs->frameNum) {
+		light.SetRelativeTime(light.GetRelativeTime() + 1);
+		light.SetAbsoluteTime(gs->frameNum);
+		light.DecayColors();
+		light.ClampColors();
+	}
+
+	lightPos = light.GetPosition();
+	lightDir = light.GetDirection(); // w=0, make sure to pick mat::oper*(float4)
+
+	if (light.GetTrackObject() != nullptr) {
+		switch (light.GetTrackType()) {
+			case GL::Light::TRACK_TYPE_UNIT: {
+				const CSolidObject* so = static_cast<const CSolidObject*>(light.GetTrackObject());
+
+				if (light.LocalSpace()) {
+					lightPos = so->GetObjectSpaceDrawPos(lightPos);
+					lightDir = so->GetObjectSpaceVec(lightDir);
+				} else {
+					lightPos = so->drawPos;
+					lightDir = so->frontdir;
+				}
+			} break;
+			case GL::Light::TRACK_TYPE_PROJ: {
+				const CProjectile* po = static_cast<const CProjectile*>(light.GetTrackObject());
+
+				if (light.LocalSpace()) {
+					const CMatrix44f m = po->GetTransformMatrix(false);
+
+					lightPos = m * lightPos;
+					lightDir = m * lightDir;
+				} else {
+					lightPos = po->drawPos;
+					lightDir = po->dir;
+				}
+			} break;
+			default: {} break;
+		}
+	}
+
+	if (light.GetRelativeTime() > light.GetTTL()) {
+		// mark light as dead
+		light.SetTTL(0);
+		return false;
+	}
+
+	return true;
+}
+
+
 void GL::LightHandler::Init(unsigned int cfgBaseLight, unsigned int cfgMaxLights) {
+	const unsigned int cfgClusteredLights = configHandler->GetInt("ClusteredDynamicLights");
+
+	if (cfgClusteredLights > 0 && GL::LightClusters::IsSupported()) {
+		// no FFP slots are used, shaders read the lights from the clusters
+		baseLight = cfgBaseLight;
+		maxLights = 0;
+		clustered = true;
+
+		lights.resize(cfgClusteredLights);
+		return;
+	}
+
+	clustered = false;
+
 	glGetIntegerv(GL_MAX_LIGHTS, reinterpret_cast<int*>(&maxLights));
 
 	baseLight = cfgBaseLight;
@@ -109,6 +184,11 @@ void GL::LightHandler::Update(Shader::IProgramObject* shader) {
 	if (numLights == 0)
 		return;
 
+	if (clustered && !clusters.NeedsUpdate(camera)) {
+		clusters.Bind(shader);
+		return;
+	}
+
 	// float3 sumWeight;
 	float3 maxWeight = OnesVector * 0.01f;
 
@@ -120,6 +200,11 @@ void GL::LightHandler::Update(Shader::IProgramObject* shader) {
 		maxWeight = float3::max(maxWeight, light.GetIntensityWeight());
 	}
 
+	if (clustered) {
+		UpdateClusters(shader, maxWeight);
+		return;
+	}
+
 	for (GL::Light& light: lights) {
 		const unsigned int lightID = light.GetID();
 
@@ -133,12 +218,11 @@ void GL::LightHandler::Update(Shader::IProgramObject* shader) {
 			continue;
 		}
 
-		if (light.GetAbsoluteTime() != gs->frameNum) {
-			light.SetRelativeTime(light.GetRelativeTime() + 1);
-			light.SetAbsoluteTime(gs->frameNum);
-			light.DecayColors();
-			light.ClampColors();
-		}
+		float4 lightPos;
+		float4 lightDir;
+
+		if (!UpdateLightState(light, lightPos, lightDir))
+			continue;
 
 		// rescale by max (not sum!), otherwise 1) the intensity would
 		// change if any light is added or removed when all have equal
@@ -149,45 +233,6 @@ void GL::LightHandler::Update(Shader::IProgramObject* shader) {
 		const float4 weightedDiffuseCol  = light.GetDiffuseColor()  * weight.y;
 		const float4 weightedSpecularCol = light.GetSpecularColor() * weight.z;
 
-		float4 lightPos = light.GetPosition();
-		float4 lightDir = light.GetDirection(); // w=0, make sure to pick mat::oper*(float4)
-
-		if (light.GetTrackObject() != nullptr) {
-			switch (light.GetTrackType()) {
-				case GL::Light::TRACK_TYPE_UNIT: {
-					const CSolidObject* so = static_cast<const CSolidObject*>(light.GetTrackObject());
-
-					if (light.LocalSpace()) {
-						lightPos = so->GetObjectSpaceDrawPos(lightPos);
-						lightDir = so->GetObjectSpaceVec(lightDir);
-					} else {
-						lightPos = so->drawPos;
-						lightDir = so->frontdir;
-					}
-				} break;
-				case GL::Light::TRACK_TYPE_PROJ: {
-					const CProjectile* po = static_cast<const CProjectile*>(light.GetTrackObject());
-
-					if (light.LocalSpace()) {
-						const CMatrix44f m = po->GetTransformMatrix(false);
-
-						lightPos = m * lightPos;
-						lightDir = m * lightDir;
-					} else {
-						lightPos = po->drawPos;
-						lightDir = po->dir;
-					}
-				} break;
-				default: {} break;
-			}
-		}
-
-		if (light.GetRelativeTime() > light.GetTTL()) {
-			// mark light as dead
-			light.SetTTL(0);
-			continue;
-		}
-
 		// communicate properties via the FFP to save uniforms
 		// note: we want MV to be identity here
 		glEnable(lightID);
@@ -219,3 +264,37 @@ void GL::LightHandler::Update(Shader::IProgramObject* shader) {
 	}
 }
 
+
+void GL::LightHandler::UpdateClusters(Shader::IProgramObject* shader, const float3& maxWeight) {
+	clusters.Clear();
+
+	for (GL::Light& light: lights) {
+		if (light.GetTTL() == 0)
+			continue;
+
+		float4 lightPos;
+		float4 lightDir;
+
+		if (!UpdateLightState(light, lightPos, lightDir))
+			continue;
+
+		// lights outside LOS contribute nothing, no need to assign them
+		if (!gu->spectatingFullView && !light.IgnoreLOS() && !losHandler->InLos(lightPos, gu->myAllyTeam))
+			continue;
+
+		const float3 weight = light.GetIntensityWeight() / maxWeight;
+		const float spotCosCutoff = (light.GetFOV() >= 180.0f)? -1.0f: math::cos(light.GetFOV() * math::DEG_TO_RAD);
+
+		GL::LightClusters::ClusterLight clusterLight;
+		clusterLight.posRadius = {lightPos.x, lightPos.y, lightPos.z, light.GetRadius()};
+		clusterLight.ambientColor = light.GetAmbientColor() * weight.x;
+		clusterLight.diffuseColor = light.GetDiffuseColor() * weight.y;
+		clusterLight.specularColor = light.GetSpecularColor() * weight.z;
+		clusterLight.spotDirCosCutoff = {lightDir.x, lightDir.y, lightDir.z, spotCosCutoff};
+
+		clusters.AddLight(clusterLight, light.GetPriority());
+	}
+
+	clusters.Update(camera);
+	clusters.Bind(shader);
+}
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "Light.h"
+#include "LightClusters.h"
 
 namespace Shader {
 	struct IProgramObject;
@@ -14,11 +15,11 @@ namespace Shader {
 namespace GL {
 	struct LightHandler {
 	public:
-		LightHandler(): baseLight(0), maxLights(0), numLights(0), lightHandle(0) {}
+		LightHandler(): baseLight(0), maxLights(0), numLights(0), lightHandle(0), clustered(false) {}
 		~LightHandler() { Kill(); }
 
 		void Init(unsigned int, unsigned int);
-		void Kill() { lights.clear(); }
+		void Kill() { lights.clear(); clusters.Kill(); }
 		void Update(Shader::IProgramObject*);
 
 		unsigned int AddLight(const GL::Light&);
@@ -29,13 +30,23 @@ namespace GL {
 		unsigned int GetBaseLight() const { return baseLight; }
 		unsigned int GetMaxLights() const { return maxLights; }
 
+		// if true, lights are assigned to LightClusters instead of the FFP slots
+		bool IsClustered() const { return clustered; }
+
+	private:
+		void UpdateClusters(Shader::IProgramObject*, const float3& maxWeight);
+
 	private:
 		std::vector<GL::Light> lights;
 
+		GL::LightClusters clusters;
+
 		unsigned int baseLight;
 		unsigned int maxLights;
 		unsigned int numLights;
 		unsigned int lightHandle;
+
+		bool clustered;
 	};
 }
 
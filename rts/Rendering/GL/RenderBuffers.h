@@ -485,6 +485,8 @@ public:
 	static Shader::IProgramObject& GetShader() { return shader.GetShader(); }
 private:
 	void CondInit();
+	void InitBuffers();
+	void InitFallback();
 	void InitVAO() const;
 private:
 	size_t vertCount0;
@@ -511,7 +513,7 @@ private:
 	inline static RenderBufferShader<T> shader;
 
 	static constexpr const char* vboTypeName = spring::TypeToCStr<VertType>();
-	static constexpr IStreamBufferConcept::Types bufferTypeDefault = IStreamBufferConcept::Types::SB_BUFFERSUBDATA;
+	static constexpr IStreamBufferConcept::Types bufferTypeDefault = IStreamBufferConcept::Types::SB_RINGARENA;
 };
 
 
@@ -532,10 +534,22 @@ inline void TypedRenderBuffer<T>::UploadVBO()
 		vertCount0 = verts.capacity();
 	}
 
+	// arena chunks only hold what was mapped last, resend everything not drawn yet
+	if (vbo->GetBufferImplementation() == IStreamBufferConcept::Types::SB_RINGARENA) {
+		vboUploadIndex = vboStartIndex;
+		elemsCount = (verts.size() - vboUploadIndex);
+	}
+
 	//update on the GPU
 	const VertType* clientPtr = verts.data();
 	VertType* mappedPtr = vbo->Map(clientPtr, vboUploadIndex, elemsCount);
 
+	if (mappedPtr == nullptr) {
+		InitFallback();
+		UploadVBO();
+		return;
+	}
+
 	if (!vbo->HasClientPtr())
 		memcpy(mappedPtr, clientPtr + vboUploadIndex, elemsCount * sizeof(VertType));
 
@@ -558,10 +572,23 @@ inline void TypedRenderBuffer<T>::UploadEBO()
 		elemCount0 = indcs.capacity();
 	}
 
+	if (ebo->GetBufferImplementation() == IStreamBufferConcept::Types::SB_RINGARENA) {
+		eboUploadIndex = eboStartIndex;
+		elemsCount = (indcs.size() - eboUploadIndex);
+	}
+
 	//update on the GPU
 	const IndcType* clientPtr = indcs.data();
 	IndcType* mappedPtr = ebo->Map(clientPtr, eboUploadIndex, elemsCount);
 
+	if (mappedPtr == nullptr) {
+		// the vertices went into the arena too, they have to follow
+		InitFallback();
+		UploadVBO();
+		UploadEBO();
+		return;
+	}
+
 	if (!ebo->HasClientPtr())
 		memcpy(mappedPtr, clientPtr + eboUploadIndex, elemsCount * sizeof(IndcType));
 
@@ -582,7 +609,7 @@ inline void TypedRenderBuffer<T>::DrawArrays(uint32_t mode, bool rewind)
 
 	assert(vao.GetIdRaw() > 0);
 	vao.Bind();
-	glDrawArrays(mode, vbo->BufferElemOffset() + vboStartIndex, vertsCount);
+	glDrawArrays(mode, vbo->BufferElemIndex(vboStartIndex), vertsCount);
 	vao.Unbind();
 
 	if (rewind)
@@ -605,7 +632,9 @@ inline void TypedRenderBuffer<T>::DrawElements(uint32_t mode, bool rewind)
 	#define BUFFER_OFFSET(T, n) (reinterpret_cast<void*>(sizeof(T) * (n)))
 	assert(vao.GetIdRaw() > 0);
 	vao.Bind();
-	glDrawElements(mode, indcsCount, GL_UNSIGNED_INT, BUFFER_OFFSET(uint32_t, ebo->BufferElemOffset() + eboStartIndex));
+	// indices are relative to verts[0], which need not sit at the start of the buffer
+	const GLint baseVertex = static_cast<GLint>(vbo->BufferElemIndex(vboStartIndex)) - static_cast<GLint>(vboStartIndex);
+	glDrawElementsBaseVertex(mode, indcsCount, GL_UNSIGNED_INT, BUFFER_OFFSET(uint32_t, ebo->BufferElemIndex(eboStartIndex)), baseVertex);
 	vao.Unbind();
 	#undef BUFFER_OFFSET
 
@@ -624,13 +653,36 @@ inline void TypedRenderBuffer<T>::CondInit()
 	if (vao.GetIdRaw() > 0)
 		return;
 
+	InitBuffers();
+	InitVAO();
+}
+
+template<typename T>
+inline void TypedRenderBuffer<T>::InitBuffers()
+{
 	if (vertCount0 > 0)
 		vbo = IStreamBuffer<VertType>::CreateInstance(GL_ARRAY_BUFFER        , vertCount0, std::string(vboTypeName), bufferType);
 
 	if (elemCount0 > 0)
 		ebo = IStreamBuffer<IndcType>::CreateInstance(GL_ELEMENT_ARRAY_BUFFER, elemCount0, std::string(vboTypeName), bufferType);
+}
 
+template<typename T>
+inline void TypedRenderBuffer<T>::InitFallback()
+{
+	LOG_L(L_WARNING, "[TypedRenderBuffer<%s>::%s] Stream arena ran out of space, switching to per-buffer uploads", vboTypeName, __func__);
+
+	bufferType = IStreamBufferConcept::Types::SB_BUFFERSUBDATA;
+
+	vbo = nullptr;
+	ebo = nullptr;
+
+	InitBuffers();
 	InitVAO();
+
+	// nothing undrawn is in the new buffers yet
+	vboUploadIndex = vboStartIndex;
+	eboUploadIndex = eboStartIndex;
 }
 
 template<typename T>
@@ -2,11 +2,16 @@
 
 #include "VBO.h"
 
+#include <algorithm>
+
 #include "System/ContainerUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GlobalRenderingInfo.h"
 
+CONFIG(int, StreamRingArenaSize).defaultValue(16).minimumValue(0).maximumValue(256).description("Size in MB of each of the three segments of the persistently mapped buffer that per-frame vertex and uniform uploads are streamed through. 0 disables it in favor of the per-buffer upload paths.");
+
 
 //////////////////////////////////////////////////////////////////////
 
@@ -17,6 +22,8 @@
 // glClientWaitSync() right before you write into the buffer.
 void IStreamBufferConcept::PutBufferLocks()
 {
+	StreamRingArena::GetInstance().EndFrame();
+
 	if (lockList.empty())
 		return;
 
@@ -106,6 +113,11 @@ uint32_t IStreamBufferConcept::GetAlignedByteSize(uint32_t byteSizeRaw)
 	return VBO::GetAlignedSize(target, byteSizeRaw);
 }
 
+uint32_t IStreamBufferConcept::GetOffsetAlignment() const
+{
+	return std::max(VBO::GetOffsetAlignment(target), size_t(1));
+}
+
 void IStreamBufferConcept::Bind(uint32_t bindTarget) const
 {
 	glBindBuffer(bindTarget > 0 ? bindTarget : target, id);
@@ -118,10 +130,181 @@ void  IStreamBufferConcept::Unbind(uint32_t bindTarget) const
 
 void IStreamBufferConcept::BindBufferRange(GLuint index, uint32_t bindTarget) const
 {
-	glBindBufferRange(bindTarget > 0 ? bindTarget : this->target, index, id, allocIdx * this->byteSize, this->byteSize);
+	// nothing to bind before the first upload into an arena chunk
+	if (GetBindByteSize() == 0)
+		return;
+
+	glBindBufferRange(bindTarget > 0 ? bindTarget : this->target, index, id, GetBindByteOffset(), GetBindByteSize());
 }
 
 void IStreamBufferConcept::UnbindBufferRange(GLuint index, uint32_t bindTarget) const
 {
-	glBindBufferRange(bindTarget > 0 ? bindTarget : this->target, index, 0u, allocIdx * this->byteSize, this->byteSize);
+	if (GetBindByteSize() == 0)
+		return;
+
+	glBindBufferRange(bindTarget > 0 ? bindTarget : this->target, index, 0u, GetBindByteOffset(), GetBindByteSize());
+}
+
+
+//////////////////////////////////////////////////////////////////////
+
+bool StreamRingArena::Init()
+{
+	initTried = true;
+
+	if (!globalRendering->supportPersistentMapping || !GLEW_ARB_sync)
+		return false;
+
+	if ((segmentSize = configHandler->GetInt("StreamRingArenaSize") * 1024 * 1024) == 0)
+		return false;
+
+	constexpr uint32_t storageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	// any target works, use one nobody keeps bound
+	glGenBuffers(1, &id);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, NUM_SEGMENTS * segmentSize, nullptr, storageFlags);
+	ptrBase = reinterpret_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, NUM_SEGMENTS * segmentSize, storageFlags));
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (ptrBase == nullptr) {
+		LOG_L(L_ERROR, "[StreamRingArena::%s] persistent mapping of %u bytes failed, falling back to per-buffer uploads", __func__, NUM_SEGMENTS * segmentSize);
+		glDeleteBuffers(1, &id);
+		id = 0;
+		return false;
+	}
+
+	LOG("[StreamRingArena::%s] streaming through %u segments of %u bytes", __func__, NUM_SEGMENTS, segmentSize);
+
+	fences = {};
+	writeFrames = {};
+	curSegment = 0;
+	curSegmentHead = 0;
+	return true;
+}
+
+void StreamRingArena::Kill()
+{
+	if (id == 0)
+		return;
+
+	for (uint32_t i = 0; i < NUM_SEGMENTS; i++) {
+		if (glIsSync(fences[i]))
+			glDeleteSync(fences[i]);
+	}
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+	glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glDeleteBuffers(1, &id);
+
+	id = 0;
+	ptrBase = nullptr;
+	fences = {};
+	// allow a new context to recreate it
+	initTried = false;
+}
+
+void StreamRingArena::WaitSegment(uint32_t segmentIdx)
+{
+	GLsync& syncObj = fences[segmentIdx];
+
+	if (!glIsSync(syncObj))
+		return;
+
+	uint32_t waitSpins = 0;
+	while (true) {
+		const GLenum waitReturn = glClientWaitSync(syncObj, GL_SYNC_FLUSH_COMMANDS_BIT, 1);
+		if (waitReturn == GL_ALREADY_SIGNALED || waitReturn == GL_CONDITION_SATISFIED)
+			break;
+
+		waitSpins++;
+	}
+	glDeleteSync(syncObj);
+	syncObj = {};
+
+	curFrameStats.numFenceWaits += (waitSpins > 0);
+	curFrameStats.numWaitSpins += waitSpins;
+}
+
+StreamRingArena::Allocation StreamRingArena::Allocate(uint32_t byteSize, uint32_t byteAlign, Producers producer)
+{
+	const auto AlignedOffset = [byteAlign](uint32_t offset) { return ((offset + byteAlign - 1) / byteAlign) * byteAlign; };
+
+	Allocation alloc;
+
+	if (!IsAvailable() || byteSize == 0 || byteSize > segmentSize) {
+		curFrameStats.numFailed[producer] += 1;
+		return alloc;
+	}
+
+	uint32_t byteOffset = AlignedOffset(curSegment * segmentSize + curSegmentHead);
+
+	if (byteOffset + byteSize > (curSegment + 1) * segmentSize) {
+		const uint32_t nextSegment = (curSegment + 1) % NUM_SEGMENTS;
+
+		// the GPU may still read whatever was written into it this frame
+		if (writeFrames[nextSegment] == frameNum) {
+			curFrameStats.numFailed[producer] += 1;
+			return alloc;
+		}
+
+		WaitSegment(nextSegment);
+
+		curSegment = nextSegment;
+		curSegmentHead = 0;
+		curFrameStats.numSegmentSwaps += 1;
+
+		if ((byteOffset = AlignedOffset(curSegment * segmentSize)) + byteSize > (curSegment + 1) * segmentSize) {
+			curFrameStats.numFailed[producer] += 1;
+			return alloc;
+		}
+	}
+
+	curSegmentHead = (byteOffset + byteSize) - curSegment * segmentSize;
+	writeFrames[curSegment] = frameNum;
+
+	curFrameStats.numUploads[producer] += 1;
+	curFrameStats.numBytes[producer] += byteSize;
+
+	alloc.ptr = ptrBase + byteOffset;
+	alloc.byteOffset = byteOffset;
+	alloc.byteSize = byteSize;
+	return alloc;
+}
+
+void StreamRingArena::EndFrame()
+{
+	if (id == 0)
+		return;
+
+	for (uint32_t i = 0; i < NUM_SEGMENTS; i++) {
+		if (writeFrames[i] != frameNum)
+			continue;
+
+		if (glIsSync(fences[i]))
+			glDeleteSync(fences[i]);
+
+		fences[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	lastFrameStats = curFrameStats;
+	curFrameStats = {};
+	frameNum += 1;
+}
+
+void StreamRingArena::LogLastFrameStats() const
+{
+	static constexpr const char* producerNames[SRA_PRODUCER_CNT] = {"VertexArray", "RenderBuffers", "LuaVBO", "ModelsData", "LightClusters", "ROAMMesh"};
+
+	if (id == 0) {
+		LOG("[StreamRingArena] not in use, per-frame uploads go through the per-buffer paths");
+		return;
+	}
+
+	LOG("[StreamRingArena] last frame: %u segment swaps, %u fence waits (%u spins), segment size %u bytes", lastFrameStats.numSegmentSwaps, lastFrameStats.numFenceWaits, lastFrameStats.numWaitSpins, segmentSize);
+
+	for (uint32_t i = 0; i < SRA_PRODUCER_CNT; i++) {
+		LOG("\t%-14s uploads=%u bytes=%u failed=%u", producerNames[i], lastFrameStats.numUploads[i], static_cast<uint32_t>(lastFrameStats.numBytes[i]), lastFrameStats.numFailed[i]);
+	}
 }
\ No newline at end of file
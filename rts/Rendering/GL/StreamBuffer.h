@@ -6,8 +6,10 @@
 // https://github.com/dolphin-emu/dolphin/blob/master/Source/Core/VideoBackends/OGL/OGLStreamBuffer.h
 // https://github.com/dolphin-emu/dolphin/blob/master/Source/Core/VideoBackends/OGL/OGLStreamBuffer.cpp
 
+#include <array>
 #include <cstdint>
 #include <memory>
+#include <numeric>
 #include <vector>
 #include <string>
 #include <string_view>
@@ -28,7 +30,8 @@ public:
 		SB_MAPANDSYNC    = 3,
 		SB_PERSISTENTMAP = 4,
 		SB_PINNEDMEMAMD  = 5,
-		SB_AUTODETECT    = 6,
+		SB_RINGARENA     = 6,
+		SB_AUTODETECT    = 7,
 	};
 
 	static void PutBufferLocks();
@@ -37,6 +40,7 @@ public:
 	virtual ~IStreamBufferConcept() {}
 
 	uint32_t GetAlignedByteSize(uint32_t byteSizeRaw);
+	uint32_t GetOffsetAlignment() const;
 
 	void Bind(uint32_t bindTarget = 0) const;
 	void Unbind(uint32_t bindTarget = 0) const;
@@ -50,6 +54,9 @@ public:
 
 	virtual IStreamBufferConcept::Types GetBufferImplementation() const = 0;
 protected:
+	virtual uint32_t GetBindByteOffset() const { return allocIdx * byteSize; }
+	virtual uint32_t GetBindByteSize() const { return byteSize; }
+
 	void CreateBuffer(uint32_t byteBufferSize, uint32_t newUsage);
 	void CreateBufferStorage(uint32_t byteBufferSize, uint32_t flags);
 	void DeleteBuffer();
@@ -70,10 +77,88 @@ protected:
 	static constexpr uint32_t DEFAULT_NUM_BUFFERS = 3;
 };
 
+// Single persistently mapped, coherent buffer that all per-frame streaming
+// producers suballocate from. It is split into NUM_SEGMENTS segments which
+// are filled in ring order; a segment is fenced at the end of every frame it
+// was written in and only reused once that fence has signaled, so uploads
+// never make the driver orphan or synchronize a buffer behind our back.
+class StreamRingArena {
+public:
+	enum Producers : uint8_t {
+		SRA_VERTEXARRAY   = 0,
+		SRA_RENDERBUFFERS = 1,
+		SRA_LUAVBO        = 2,
+		SRA_MODELSDATA    = 3,
+		SRA_LIGHTCLUSTERS = 4,
+		SRA_ROAMMESH      = 5,
+		SRA_PRODUCER_CNT  = 6,
+	};
+
+	struct Allocation {
+		uint8_t* ptr = nullptr;
+		uint32_t byteOffset = 0;
+		uint32_t byteSize = 0;
+	};
+
+	struct FrameStats {
+		std::array<uint32_t, SRA_PRODUCER_CNT> numUploads = {};
+		std::array<uint64_t, SRA_PRODUCER_CNT> numBytes = {};
+		std::array<uint32_t, SRA_PRODUCER_CNT> numFailed = {};
+
+		uint32_t numSegmentSwaps = 0;
+		uint32_t numFenceWaits = 0;
+		uint32_t numWaitSpins = 0;
+	};
+
+	static StreamRingArena& GetInstance() {
+		static StreamRingArena instance;
+		return instance;
+	}
+
+	// false if the GL implementation can not persistently map buffers or the arena is disabled
+	bool IsAvailable() { return (id != 0 || (!initTried && Init())); }
+	void Kill();
+
+	// returns an empty Allocation if <byteSize> does not fit in a segment or every segment was written this frame
+	Allocation Allocate(uint32_t byteSize, uint32_t byteAlign, Producers producer);
+
+	// placed after the frame's last draw, from IStreamBufferConcept::PutBufferLocks
+	void EndFrame();
+
+	uint32_t GetID() const { return id; }
+	uint32_t GetSegmentSize() const { return segmentSize; }
+
+	const FrameStats& GetLastFrameStats() const { return lastFrameStats; }
+	void LogLastFrameStats() const;
+private:
+	bool Init();
+	void WaitSegment(uint32_t segmentIdx);
+private:
+	uint32_t id = 0;
+	uint32_t segmentSize = 0;
+
+	// writeFrames[i] == frameNum means segment i was written during the current frame
+	uint32_t frameNum = 1;
+	uint32_t curSegment = 0;
+	uint32_t curSegmentHead = 0;
+
+	bool initTried = false;
+
+	uint8_t* ptrBase = nullptr;
+
+	static constexpr uint32_t NUM_SEGMENTS = 3;
+
+	std::array<GLsync, NUM_SEGMENTS> fences = {};
+	std::array<uint32_t, NUM_SEGMENTS> writeFrames = {};
+
+	FrameStats curFrameStats;
+	FrameStats lastFrameStats;
+};
+
 template<typename T>
 class IStreamBuffer : public IStreamBufferConcept {
 public:
-	static std::unique_ptr<IStreamBuffer<T>> CreateInstance(uint32_t target, uint32_t numElems, const std::string& name = "", Types type = SB_AUTODETECT, bool resizeAble = false, bool coherent = false, uint32_t numBuffers = DEFAULT_NUM_BUFFERS);
+	static std::unique_ptr<IStreamBuffer<T>> CreateInstance(uint32_t target, uint32_t numElems, const std::string& name = "", Types type = SB_AUTODETECT, bool resizeAble = false, bool coherent = false, uint32_t numBuffers = DEFAULT_NUM_BUFFERS, StreamRingArena::Producers producer = StreamRingArena::SRA_RENDERBUFFERS);
 public:
 	IStreamBuffer(uint32_t target_, uint32_t numElems, const std::string& name_, const std::string_view& bufferTypeName_)
 		: IStreamBufferConcept(target_, numElems, name_, bufferTypeName_)
@@ -97,6 +182,8 @@ public:
 
 	virtual bool HasClientPtr() const { return false; };
 	virtual uint32_t BufferElemOffset() const { return 0; };
+	// position in the GL buffer of the element last uploaded at index <elemIdx>
+	virtual uint32_t BufferElemIndex(uint32_t elemIdx) const { return BufferElemOffset() + elemIdx; };
 
 	virtual void Init() = 0;
 	virtual void Kill(bool deleteBuffer) = 0;
@@ -540,10 +627,72 @@ private:
 	static constexpr uint32_t ALIGN_PINNED_MEMORY_SIZE = 4096;
 };
 
+template<typename T>
+class RingArenaImpl : public IStreamBuffer<T> {
+public:
+	RingArenaImpl(GLenum target, uint32_t numElems, const std::string& name_, StreamRingArena::Producers producer_)
+		: IStreamBuffer<T>(target, numElems, name_, spring::TypeToCStr<decltype(*this)>())
+		, producer{ producer_ }
+		, byteAlign{ 0 }
+	{
+		Init();
+	}
+	~RingArenaImpl() override {
+		Kill(true);
+	}
+
+	void Init() override {
+		this->byteSize = this->GetAlignedByteSize(this->numElements * sizeof(T));
+		// shared by every instance, owned by the arena
+		this->id = StreamRingArena::GetInstance().GetID();
+
+		// chunk offsets must be addressable in whole elements and bindable as ranges
+		byteAlign = std::lcm(static_cast<uint32_t>(sizeof(T)), this->GetOffsetAlignment());
+	}
+
+	void Kill(bool deleteBuffer) override {
+		// never delete the arena's buffer
+		this->id = 0;
+		chunk = {};
+	}
+	IStreamBufferConcept::Types GetBufferImplementation() const override { return IStreamBufferConcept::Types::SB_RINGARENA; }
+
+	bool IsValid() const override {
+		return (this->id != 0);
+	}
+
+	// every Map() gets a fresh chunk of the arena, nullptr if it ran out of space for this frame
+	T* Map(const T* clientPtr, uint32_t elemOffset, uint32_t elemCount) override {
+		IStreamBuffer<T>::Map(clientPtr, elemOffset, elemCount);
+
+		chunk = StreamRingArena::GetInstance().Allocate(this->mapElemCount * sizeof(T), byteAlign, producer);
+		return reinterpret_cast<T*>(chunk.ptr);
+	}
+
+	void Unmap() override {} // coherent mapping, nothing to flush
+
+	uint32_t BufferElemOffset() const override {
+		return chunk.byteOffset / sizeof(T);
+	}
+	uint32_t BufferElemIndex(uint32_t elemIdx) const override {
+		// only elements of the last Map() are available
+		assert(elemIdx >= this->mapElemOffet);
+		return BufferElemOffset() + (elemIdx - this->mapElemOffet);
+	}
+protected:
+	uint32_t GetBindByteOffset() const override { return chunk.byteOffset; }
+	uint32_t GetBindByteSize() const override { return chunk.byteSize; }
+private:
+	StreamRingArena::Producers producer;
+	StreamRingArena::Allocation chunk;
+
+	uint32_t byteAlign;
+};
+
 //////////////////////////////////////////////////////////////////////
 
 template<typename T>
-inline std::unique_ptr<IStreamBuffer<T>> IStreamBuffer<T>::CreateInstance(uint32_t target, uint32_t numElems, const std::string& name, Types type, bool resizeAble, bool coherent, uint32_t numBuffers)
+inline std::unique_ptr<IStreamBuffer<T>> IStreamBuffer<T>::CreateInstance(uint32_t target, uint32_t numElems, const std::string& name, Types type, bool resizeAble, bool coherent, uint32_t numBuffers, StreamRingArena::Producers producer)
 {
 	IStreamBufferConcept::reportType = (type == SB_AUTODETECT);
 
@@ -560,6 +709,12 @@ inline std::unique_ptr<IStreamBuffer<T>> IStreamBuffer<T>::CreateInstance(uint32
 		return std::make_unique<PersistentMapImpl<T>>(target, numElems, numBuffers, name, coherent);
 	case SB_PINNEDMEMAMD:
 		return std::make_unique<PinnedMemoryAMDImpl<T>>(target, numElems, numBuffers, name);
+	case SB_RINGARENA: {
+		if (StreamRingArena::GetInstance().IsAvailable())
+			return std::make_unique<RingArenaImpl<T>>(target, numElems, name, producer);
+
+		return CreateInstance(target, numElems, name, SB_BUFFERSUBDATA, resizeAble, coherent, numBuffers);
+	} break;
 	default: {} break;
 	}
 
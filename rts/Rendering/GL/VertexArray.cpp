@@ -3,6 +3,7 @@
 #include <cstring>
 
 #include "VertexArray.h"
+#include "StreamBuffer.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -198,15 +199,50 @@ void CVertexArray::DrawArraysCallback(const GLenum mode, const unsigned int stri
 //
 //////////////////////////////////////////////////////////////////////
 
+const float* CVertexArray::MapDrawArray()
+{
+	auto& streamArena = StreamRingArena::GetInstance();
+
+	// keep drawing from client memory if there is no arena (or no room left in it)
+	if (!streamArena.IsAvailable())
+		return drawArray;
+
+	const uint32_t byteSize = drawIndex() * sizeof(float);
+	const auto chunk = streamArena.Allocate(byteSize, sizeof(float) * 4, StreamRingArena::SRA_VERTEXARRAY);
+
+	if (chunk.ptr == nullptr)
+		return drawArray;
+
+	memcpy(chunk.ptr, drawArray, byteSize);
+
+	// the gl*Pointer calls capture the binding, so it can be reset right after the draw
+	glBindBuffer(GL_ARRAY_BUFFER, streamArena.GetID());
+	arenaBound = true;
+
+	return reinterpret_cast<const float*>(static_cast<uintptr_t>(chunk.byteOffset));
+}
+
+void CVertexArray::UnmapDrawArray()
+{
+	if (!arenaBound)
+		return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	arenaBound = false;
+}
+
+
 void CVertexArray::DrawArray0(const int drawType, unsigned int stride)
 {
 	if (drawIndex() == 0)
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
+	glVertexPointer(3, GL_FLOAT, stride, vaPtr);
 	DrawArrays(drawType, stride);
+	UnmapDrawArray();
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
@@ -216,9 +252,11 @@ void CVertexArray::DrawArray2d0(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
+	glVertexPointer(2, GL_FLOAT, stride, vaPtr);
 	DrawArrays(drawType, stride);
+	UnmapDrawArray();
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
@@ -228,11 +266,13 @@ void CVertexArray::DrawArrayN(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glNormalPointer(GL_FLOAT, stride, drawArray + 3);
+	glVertexPointer(3, GL_FLOAT, stride, vaPtr);
+	glNormalPointer(GL_FLOAT, stride, vaPtr + 3);
 	DrawArrays(drawType, stride);
+	UnmapDrawArray();
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_NORMAL_ARRAY);
 }
@@ -244,11 +284,13 @@ void CVertexArray::DrawArrayC(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glColorPointer(4, GL_UNSIGNED_BYTE, stride, drawArray + 3);
+	glVertexPointer(3, GL_FLOAT, stride, vaPtr);
+	glColorPointer(4, GL_UNSIGNED_BYTE, stride, vaPtr + 3);
 	DrawArrays(drawType, stride);
+	UnmapDrawArray();
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
 }
@@ -260,11 +302,13 @@ void CVertexArray::DrawArrayT(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 3);
+	glVertexPointer(3, GL_FLOAT, stride, vaPtr);
+	glTexCoordPointer(2, GL_FLOAT, stride, vaPtr + 3);
 	DrawArrays(drawType, stride);
+	UnmapDrawArray();
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
@@ -276,11 +320,13 @@ void CVertexArray::DrawArray2dT(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 2);
+	glVertexPointer(2, GL_FLOAT, stride, vaPtr);
+	glTexCoordPointer(2, GL_FLOAT, stride, vaPtr + 2);
 	DrawArrays(drawType, stride);
+	UnmapDrawArray();
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
@@ -292,13 +338,15 @@ void CVertexArray::DrawArray2dTC(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 2);
-	glColorPointer(4, GL_UNSIGNED_BYTE, stride, drawArray + 4);
+	glVertexPointer(2, GL_FLOAT, stride, vaPtr);
+	glTexCoordPointer(2, GL_FLOAT, stride, vaPtr + 2);
+	glColorPointer(4, GL_UNSIGNED_BYTE, stride, vaPtr + 4);
 	DrawArrays(drawType, stride);
+	UnmapDrawArray();
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
@@ -311,11 +359,13 @@ void CVertexArray::DrawArray2dT(const int drawType, StripCallback callback, void
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 2);
+	glVertexPointer(2, GL_FLOAT, stride, vaPtr);
+	glTexCoordPointer(2, GL_FLOAT, stride, vaPtr + 2);
 	DrawArraysCallback(drawType, stride, callback, data);
+	UnmapDrawArray();
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
@@ -327,14 +377,16 @@ void CVertexArray::DrawArrayTN(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 3);
-	glNormalPointer(GL_FLOAT, stride, drawArray + 5);
+	glVertexPointer(3, GL_FLOAT, stride, vaPtr);
+	glTexCoordPointer(2, GL_FLOAT, stride, vaPtr + 3);
+	glNormalPointer(GL_FLOAT, stride, vaPtr + 5);
 	DrawArrays(drawType, stride);
+	UnmapDrawArray();
 
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -347,6 +399,7 @@ void CVertexArray::DrawArrayTNT(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 
 	#define SET_ENABLE_ACTIVE_TEX(texUnit)            \
 		glClientActiveTexture(texUnit);               \
@@ -358,15 +411,16 @@ void CVertexArray::DrawArrayTNT(const int drawType, unsigned int stride)
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE0); glTexCoordPointer(2, GL_FLOAT, stride, drawArray +  3);
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE1); glTexCoordPointer(2, GL_FLOAT, stride, drawArray +  3); // FIXME? (format-specific)
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE5); glTexCoordPointer(3, GL_FLOAT, stride, drawArray +  8);
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE6); glTexCoordPointer(3, GL_FLOAT, stride, drawArray + 11);
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE0); glTexCoordPointer(2, GL_FLOAT, stride, vaPtr +  3);
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE1); glTexCoordPointer(2, GL_FLOAT, stride, vaPtr +  3); // FIXME? (format-specific)
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE5); glTexCoordPointer(3, GL_FLOAT, stride, vaPtr +  8);
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE6); glTexCoordPointer(3, GL_FLOAT, stride, vaPtr + 11);
 
-	glVertexPointer(3, GL_FLOAT, stride, drawArray + 0);
-	glNormalPointer(GL_FLOAT, stride, drawArray + 5);
+	glVertexPointer(3, GL_FLOAT, stride, vaPtr + 0);
+	glNormalPointer(GL_FLOAT, stride, vaPtr + 5);
 
 	DrawArrays(drawType, stride);
+	UnmapDrawArray();
 
 	SET_DISABLE_ACTIVE_TEX(GL_TEXTURE6);
 	SET_DISABLE_ACTIVE_TEX(GL_TEXTURE5);
@@ -387,13 +441,15 @@ void CVertexArray::DrawArrayTC(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+	const float* vaPtr = MapDrawArray();
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 3);
-	glColorPointer(4, GL_UNSIGNED_BYTE, stride, drawArray + 5);
+	glVertexPointer(3, GL_FLOAT, stride, vaPtr);
+	glTexCoordPointer(2, GL_FLOAT, stride, vaPtr + 3);
+	glColorPointer(4, GL_UNSIGNED_BYTE, stride, vaPtr + 5);
 	DrawArrays(drawType, stride);
+	UnmapDrawArray();
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
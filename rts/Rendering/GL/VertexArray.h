@@ -111,6 +111,10 @@ protected:
 	void EnlargeDrawArray();
 	void CheckEndStrip();
 
+	// copies drawArray into the stream arena, returns the base for the gl*Pointer calls
+	const float* MapDrawArray();
+	void UnmapDrawArray();
+
 protected:
 	float* drawArray;
 	float* drawArrayPos;
@@ -121,6 +125,8 @@ protected:
 	unsigned int* stripArraySize;
 
 	unsigned int maxVertices;
+
+	bool arenaBound = false;
 };
 
 #endif /* VERTEXARRAY_H */
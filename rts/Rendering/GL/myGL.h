@@ -140,10 +140,10 @@ struct SDrawElementsIndirectCommand {
 
 struct SInstanceData {
 	SInstanceData() = default;
-	SInstanceData(uint32_t matOffset_, uint8_t teamIndex, uint8_t drawFlags, uint32_t uniOffset_)
+	SInstanceData(uint32_t matOffset_, uint8_t teamIndex, uint8_t drawFlags, uint32_t uniOffset_, uint16_t texType = 0)
 		: matOffset{ matOffset_ }			 // updated during the following draw frames
 		, uniOffset{ uniOffset_ }			 // updated during the following draw frames
-		, info{ teamIndex, drawFlags, 0, 0 } // not updated during the following draw frames
+		, info{ teamIndex, drawFlags, uint8_t(texType & 0xFF), uint8_t(texType >> 8) } // not updated during the following draw frames
 		, aux1 { 0u }
 	{}
 
@@ -338,6 +338,7 @@ CGlobalRendering::~CGlobalRendering()
 void CGlobalRendering::PreKill()
 {
 	UniformConstants::GetInstance().Kill(); //unsafe to kill in ~CGlobalRendering()
+	StreamRingArena::GetInstance().Kill();
 }
 
 
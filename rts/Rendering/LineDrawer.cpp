@@ -4,6 +4,7 @@
 
 #include "LineDrawer.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "Rendering/GlobalRendering.h"
@@ -21,9 +22,12 @@ CLineDrawer::CLineDrawer()
 	, lastPos(ZeroVector)
 	, lastColor(NULL)
 	, stippleTimer(0.0f)
+	, curBatch(nullptr)
 {
-	lines.reserve(32);
-	stippled.reserve(32);
+	lines[0].type = GL_LINE_STRIP;
+	lines[1].type = GL_LINES;
+	stippled[0].type = GL_LINE_STRIP;
+	stippled[1].type = GL_LINES;
 }
 
 
@@ -51,9 +55,19 @@ void CLineDrawer::SetupLineStipple()
 
 void CLineDrawer::DrawAll()
 {
-	if (lines.empty() && stippled.empty())
+	const auto isEmpty = [](const LineBatch& b) { return b.firsts.empty(); };
+	const auto drawBatch = [](const LineBatch& b) {
+		if (b.firsts.empty())
+			return;
+
+		glColorPointer(4, GL_FLOAT, 0, b.colors.data());
+		glVertexPointer(3, GL_FLOAT, 0, b.verts.data());
+		glMultiDrawArrays(b.type, b.firsts.data(), b.counts.data(), b.firsts.size());
+	};
+
+	if (std::all_of(lines.begin(), lines.end(), isEmpty) && std::all_of(stippled.begin(), stippled.end(), isEmpty))
 		return;
-	
+
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
 
@@ -62,24 +76,14 @@ void CLineDrawer::DrawAll()
 	glDisable(GL_DEPTH_TEST);
 	glDisable(GL_LINE_STIPPLE);
 
-	for (int i = 0; i<lines.size(); ++i) {
-		int size = lines[i].colors.size();
-		if(size > 0) {
-			glColorPointer(4, GL_FLOAT, 0, &lines[i].colors[0]);
-			glVertexPointer(3, GL_FLOAT, 0, &lines[i].verts[0]);
-			glDrawArrays(lines[i].type, 0, size/4);
-		}
+	for (const LineBatch& b: lines) {
+		drawBatch(b);
 	}
 
-	if (!stippled.empty()) {
+	if (!std::all_of(stippled.begin(), stippled.end(), isEmpty)) {
 		glEnable(GL_LINE_STIPPLE);
-		for (int i = 0; i<stippled.size(); ++i) {
-			int size = stippled[i].colors.size();
-			if(size > 0) {
-				glColorPointer(4, GL_FLOAT, 0, &stippled[i].colors[0]);
-				glVertexPointer(3, GL_FLOAT, 0, &stippled[i].verts[0]);
-				glDrawArrays(stippled[i].type, 0, size/4);
-			}
+		for (const LineBatch& b: stippled) {
+			drawBatch(b);
 		}
 		glDisable(GL_LINE_STIPPLE);
 	}
@@ -88,6 +92,12 @@ void CLineDrawer::DrawAll()
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glPopAttrib();
 
-	lines.clear();
-	stippled.clear();
+	for (LineBatch& b: lines) {
+		b.Clear();
+	}
+	for (LineBatch& b: stippled) {
+		b.Clear();
+	}
+
+	curBatch = nullptr;
 }
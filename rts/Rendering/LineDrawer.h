@@ -5,6 +5,7 @@
 
 #include <vector>
 #include <array>
+#include <cassert>
 
 #include "Game/UI/CursorIcons.h"
 #include "Rendering/GL/myGL.h"
@@ -45,15 +46,45 @@ class CLineDrawer {
 		
 		float stippleTimer;
 
-		// queue all lines and draw them in one go later
-		struct LinePair {
+		// queue all lines and draw them in one go later; paths of the
+		// same type share one flat array and are submitted together by
+		// a single glMultiDrawArrays call, the arrays keep their memory
+		// between frames
+		struct LineBatch {
+			void AddVertex(const float3& pos, const float* color) {
+				verts.push_back(pos.x);
+				verts.push_back(pos.y);
+				verts.push_back(pos.z);
+				colors.push_back(color[0]);
+				colors.push_back(color[1]);
+				colors.push_back(color[2]);
+				colors.push_back(color[3]);
+				counts.back() += 1;
+			}
+			void AddVertex(const float3& pos, const float* color, float alpha) {
+				const float c[4] = {color[0], color[1], color[2], alpha};
+				AddVertex(pos, c);
+			}
+
+			void Clear() {
+				verts.clear();
+				colors.clear();
+				firsts.clear();
+				counts.clear();
+			}
+
 			GLenum type;
 			std::vector<GLfloat> verts;
 			std::vector<GLfloat> colors;
+			std::vector<GLint> firsts;
+			std::vector<GLsizei> counts;
 		};
 
-		std::vector<LinePair> lines;
-		std::vector<LinePair> stippled;
+		// [0] := strips (no color restarts), [1] := segments
+		std::array<LineBatch, 2> lines;
+		std::array<LineBatch, 2> stippled;
+
+		LineBatch* curBatch;
 };
 
 
@@ -90,28 +121,15 @@ inline void CLineDrawer::Break(const float3& endPos, const float* color)
 
 inline void CLineDrawer::Restart()
 {
-	LinePair *ptr;
-	if (lineStipple) {
-		stippled.push_back(LinePair());
-		ptr = &stippled.back();
-	} else {
-		lines.push_back(LinePair());
-		ptr = &lines.back();
-	}
-	LinePair& p = *ptr;
-
-	if (!useColorRestarts)	 {
-		p.type = GL_LINE_STRIP;
-		p.colors.push_back(lastColor[0]);
-		p.colors.push_back(lastColor[1]);
-		p.colors.push_back(lastColor[2]);
-		p.colors.push_back(lastColor[3]);
-		p.verts.push_back(lastPos[0]);
-		p.verts.push_back(lastPos[1]);
-		p.verts.push_back(lastPos[2]);
-	} else {
-		p.type = GL_LINES;
-	}
+	LineBatch& b = lineStipple? stippled[useColorRestarts]: lines[useColorRestarts];
+
+	b.firsts.push_back(b.verts.size() / 3);
+	b.counts.push_back(0);
+
+	if (!useColorRestarts)
+		b.AddVertex(lastPos, lastColor);
+
+	curBatch = &b;
 }
 
 
@@ -140,45 +158,19 @@ inline void CLineDrawer::StartPath(const float3& pos, const float* color)
 
 inline void CLineDrawer::DrawLine(const float3& endPos, const float* color)
 {
-	LinePair *ptr;
-	if (lineStipple) {
-		ptr = &stippled.back();
-	} else {
-		ptr = &lines.back();
-	}
-	LinePair& p = *ptr;
+	assert(curBatch != nullptr);
+	LineBatch& b = *curBatch;
 
 	if (!useColorRestarts) {
-		p.colors.push_back(color[0]);
-		p.colors.push_back(color[1]);
-		p.colors.push_back(color[2]);
-		p.colors.push_back(color[3]);
-		p.verts.push_back(endPos.x);
-		p.verts.push_back(endPos.y);
-		p.verts.push_back(endPos.z);
+		b.AddVertex(endPos, color);
 	} else {
 		if (useRestartColor) {
-			p.colors.push_back(restartColor[0]);
-			p.colors.push_back(restartColor[1]);
-			p.colors.push_back(restartColor[2]);
-			p.colors.push_back(restartColor[3]);
+			b.AddVertex(lastPos, restartColor);
 		} else {
-			p.colors.push_back(color[0]);
-			p.colors.push_back(color[1]);
-			p.colors.push_back(color[2]);
-			p.colors.push_back(color[3] * restartAlpha);
+			b.AddVertex(lastPos, color, color[3] * restartAlpha);
 		}
-		p.verts.push_back(lastPos.x);
-		p.verts.push_back(lastPos.y);
-		p.verts.push_back(lastPos.z);
-
-		p.colors.push_back(color[0]);
-		p.colors.push_back(color[1]);
-		p.colors.push_back(color[2]);
-		p.colors.push_back(color[3]);
-		p.verts.push_back(endPos.x);
-		p.verts.push_back(endPos.y);
-		p.verts.push_back(endPos.z);
+
+		b.AddVertex(endPos, color);
 	}
 
 	lastPos = endPos;
@@ -137,33 +137,68 @@ void CLosTexture::Update()
 
 		glBindTexture(GL_TEXTURE_2D, texture);
 		glGenerateMipmap(GL_TEXTURE_2D);
+
+		// global LOS overwrote everything, rebuild in full once it ends
+		lastAllyTeam = -1;
 		return;
 	}
 
+	// only re-upload the squares changed since the last update
+	SRectangle rect;
+
+	if (gu->myAllyTeam != lastAllyTeam || !losHandler->los.losMaps[gu->myAllyTeam].GetDirtyRect(lastUpdateNum, rect))
+		rect = {0, 0, texSize.x, texSize.y};
+
+	lastUpdateNum = losHandler->los.updateNum;
+	lastAllyTeam = gu->myAllyTeam;
+
+	if (rect.GetWidth() <= 0 || rect.GetHeight() <= 0)
+		return;
+
+	UpdateGPU(rect);
+}
+
+
+void CLosTexture::UpdateGPU(SRectangle rect)
+{
+	// keep rows 4-byte aligned for the default unpack alignment
+	rect.x1 &= ~1;
+	rect.x2 = std::min(texSize.x, (rect.x2 + 1) & ~1);
+
+	const int rectSizeX = rect.GetWidth();
+	const int rectSizeY = rect.GetHeight();
+
 	infoTexPBO.Bind();
 	auto infoTexMem = reinterpret_cast<unsigned char*>(infoTexPBO.MapBuffer());
 	const unsigned short* myLos = &losHandler->los.losMaps[gu->myAllyTeam].front();
-	memcpy(infoTexMem, myLos, texSize.x * texSize.y * texChannels * sizeof(short));
+	for (int y = rect.y1; y < rect.y2; ++y) {
+		memcpy(infoTexMem + (y - rect.y1) * rectSizeX * sizeof(short), &myLos[y * texSize.x + rect.x1], rectSizeX * sizeof(short));
+	}
 	infoTexPBO.UnmapBuffer();
 
 	//Trick: Upload the ushort as 2 ubytes, and then check both for `!=0` in the shader.
 	// Faster than doing it on the CPU! And uploading it as shorts would be slow, cause the GPU
 	// has no native support for them and so the transformation would happen on the CPU, too.
 	glBindTexture(GL_TEXTURE_2D, uploadTex);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x1, rect.y1, rectSizeX, rectSizeY, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
 	infoTexPBO.Invalidate();
 	infoTexPBO.Unbind();
 
-	// do post-processing on the gpu (los-checking & scaling)
+	// do post-processing on the gpu (los-checking & scaling), restricted to the uploaded area
+	const float x1 = rect.x1 * 2.0f / texSize.x - 1.0f;
+	const float y1 = rect.y1 * 2.0f / texSize.y - 1.0f;
+	const float x2 = rect.x2 * 2.0f / texSize.x - 1.0f;
+	const float y2 = rect.y2 * 2.0f / texSize.y - 1.0f;
+
 	fbo.Bind();
 	glViewport(0,0, texSize.x, texSize.y);
 	shader->Enable();
 	glDisable(GL_BLEND);
 	glBegin(GL_QUADS);
-		glVertex2f(-1.f, -1.f);
-		glVertex2f(-1.f, +1.f);
-		glVertex2f(+1.f, +1.f);
-		glVertex2f(+1.f, -1.f);
+		glVertex2f(x1, y1);
+		glVertex2f(x1, y2);
+		glVertex2f(x2, y2);
+		glVertex2f(x2, y1);
 	glEnd();
 	shader->Disable();
 	glViewport(globalRendering->viewPosX,0,globalRendering->viewSizeX,globalRendering->viewSizeY);
@@ -5,6 +5,7 @@
 
 #include "PboInfoTexture.h"
 #include "Rendering/GL/FBO.h"
+#include "System/Rectangle.h"
 
 
 namespace Shader {
@@ -24,10 +25,16 @@ public:
 
 private:
 	void UpdateCPU();
+	void UpdateGPU(SRectangle rect);
 
 private:
 	FBO fbo;
 	GLuint uploadTex;
+
+	// state of the last GPU update, see CLosMap::GetDirtyRect
+	unsigned int lastUpdateNum = 0;
+	int lastAllyTeam = -1;
+
 	Shader::IProgramObject* shader;
 };
 
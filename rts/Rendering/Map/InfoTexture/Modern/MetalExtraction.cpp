@@ -51,11 +51,12 @@ CMetalExtractionTexture::CMetalExtractionTexture()
 	)";
 
 	const std::string fragmentCode = R"(
-		uniform sampler2D tex0;
+		uniform sampler2D texExtraction;
+		uniform sampler2D texLoS;
 		varying vec2 texCoord;
 
 		void main() {
-			gl_FragColor = texture2D(tex0, texCoord) * 800.0;
+			gl_FragColor = texture2D(texExtraction, texCoord) * texture2D(texLoS, texCoord) * 800.0;
 		}
 	)";
 
@@ -68,7 +69,8 @@ CMetalExtractionTexture::CMetalExtractionTexture()
 		LOG_L(L_ERROR, fmt, shader->GetName().c_str(), shader->GetLog().c_str());
 	} else {
 		shader->Enable();
-		shader->SetUniform("tex0", 0);
+		shader->SetUniform("texExtraction", 0);
+		shader->SetUniform("texLoS",        1);
 		shader->Disable();
 		shader->Validate();
 		if (!shader->IsValid()) {
@@ -77,12 +79,28 @@ CMetalExtractionTexture::CMetalExtractionTexture()
 		}
 	}
 
+	if (fbo.IsValid() && shader->IsValid()) {
+		glGenTextures(1, &uploadTex);
+		glBindTexture(GL_TEXTURE_2D, uploadTex);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glSpringTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, texSize.x, texSize.y);
+	}
+
 	if (!fbo.IsValid() || !shader->IsValid()) {
 		throw opengl_error("");
 	}
 }
 
 
+CMetalExtractionTexture::~CMetalExtractionTexture()
+{
+	glDeleteTextures(1, &uploadTex);
+}
+
+
 bool CMetalExtractionTexture::IsUpdateNeeded()
 {
 	// update only once per second
@@ -93,33 +111,103 @@ bool CMetalExtractionTexture::IsUpdateNeeded()
 void CMetalExtractionTexture::Update()
 {
 	// los-checking is done in FBO: when FBO isn't working don't expose hidden data!
-	if (!fbo.IsValid() || !shader->IsValid())
+	if (!fbo.IsValid() || !shader->IsValid() || uploadTex == 0)
 		return;
 
-	CInfoTexture* infoTex = infoTextureHandler->GetInfoTexture("los");
-
 	assert(metalMap.GetSizeX() == texSize.x && metalMap.GetSizeZ() == texSize.y);
 
-	// upload raw data to gpu
-	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RED, GL_FLOAT, metalMap.GetExtractionMap());
+	// only re-upload and re-mask the squares whose extraction or LOS changed
+	// since the last update; switching ally-team or global LOS touches all
+	SRectangle rect = {0, 0, texSize.x, texSize.y};
+	SRectangle extractionRect;
+	SRectangle losRect;
+
+	const bool globalLos = losHandler->GetGlobalLOS(gu->myAllyTeam);
+
+	if (gu->myAllyTeam != lastAllyTeam || globalLos != lastGlobalLos)
+		numFullUpdates = 2;
+
+	const bool incremental = (numFullUpdates == 0)
+		&& metalMap.GetExtractionDirtyRect(lastExtractionUpdateNum, extractionRect)
+		&& losHandler->los.losMaps[gu->myAllyTeam].GetDirtyRect(lastLosUpdateNums[0], losRect);
+
+	if (incremental) {
+		const int2 losSize = losHandler->los.size;
+
+		// padded by a square since the los texture is sampled with linear filtering
+		if (losRect.x1 < losRect.x2 && losRect.y1 < losRect.y2 && !globalLos) {
+			losRect.x1 = (losRect.x1 * texSize.x) / losSize.x - 1;
+			losRect.y1 = (losRect.y1 * texSize.y) / losSize.y - 1;
+			losRect.x2 = (losRect.x2 * texSize.x + losSize.x - 1) / losSize.x + 1;
+			losRect.y2 = (losRect.y2 * texSize.y + losSize.y - 1) / losSize.y + 1;
+		} else {
+			losRect = {texSize.x, texSize.y, 0, 0};
+		}
+
+		// extraction squares are also sampled linearly
+		if (extractionRect.x1 < extractionRect.x2 && extractionRect.z1 < extractionRect.z2) {
+			extractionRect.x1 -= 1;
+			extractionRect.z1 -= 1;
+			extractionRect.x2 += 1;
+			extractionRect.z2 += 1;
+		}
+
+		rect.x1 = std::max(0, std::min(extractionRect.x1, losRect.x1));
+		rect.y1 = std::max(0, std::min(extractionRect.y1, losRect.y1));
+		rect.x2 = std::min(texSize.x, std::max(extractionRect.x2, losRect.x2));
+		rect.y2 = std::min(texSize.y, std::max(extractionRect.y2, losRect.y2));
+	}
+
+	lastExtractionUpdateNum = metalMap.GetExtractionUpdateNum();
+	lastLosUpdateNums[0] = lastLosUpdateNums[1];
+	lastLosUpdateNums[1] = losHandler->los.updateNum;
+	lastAllyTeam = gu->myAllyTeam;
+	lastGlobalLos = globalLos;
+	numFullUpdates -= (numFullUpdates > 0);
+
+	if (rect.GetWidth() <= 0 || rect.GetHeight() <= 0)
+		return;
+
+	UpdateGPU(rect);
+}
+
+
+void CMetalExtractionTexture::UpdateGPU(const SRectangle& rect)
+{
+	// upload raw data to gpu; rows of floats need no realignment
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, texSize.x);
+	glBindTexture(GL_TEXTURE_2D, uploadTex);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x1, rect.y1, rect.GetWidth(), rect.GetHeight(), GL_RED, GL_FLOAT, metalMap.GetExtractionMap() + rect.y1 * texSize.x + rect.x1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+	// do post-processing on the gpu (los-checking & scaling), restricted to the uploaded area
+	const float x1 = rect.x1 * 2.0f / texSize.x - 1.0f;
+	const float y1 = rect.y1 * 2.0f / texSize.y - 1.0f;
+	const float x2 = rect.x2 * 2.0f / texSize.x - 1.0f;
+	const float y2 = rect.y2 * 2.0f / texSize.y - 1.0f;
 
-	// do post-processing on the gpu (los-checking & scaling)
 	fbo.Bind();
-	shader->Enable();
 	glViewport(0,0, texSize.x, texSize.y);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_ZERO, GL_SRC_COLOR);
-	glBindTexture(GL_TEXTURE_2D, infoTex->GetTexture());
+	shader->Enable();
+	glDisable(GL_BLEND);
+	glActiveTexture(GL_TEXTURE1);
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, infoTextureHandler->GetInfoTexture("los")->GetTexture());
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, uploadTex);
 	glBegin(GL_QUADS);
-		glVertex2f(-1.f, -1.f);
-		glVertex2f(-1.f, +1.f);
-		glVertex2f(+1.f, +1.f);
-		glVertex2f(+1.f, -1.f);
+		glVertex2f(x1, y1);
+		glVertex2f(x1, y2);
+		glVertex2f(x2, y2);
+		glVertex2f(x2, y1);
 	glEnd();
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	//glDisable(GL_BLEND);
-	glViewport(globalRendering->viewPosX,0,globalRendering->viewSizeX,globalRendering->viewSizeY);
 	shader->Disable();
+	glViewport(globalRendering->viewPosX,0,globalRendering->viewSizeX,globalRendering->viewSizeY);
 	FBO::Unbind();
+
+	// cleanup, the full-map pass used to leave blending enabled
+	glEnable(GL_BLEND);
+	glActiveTexture(GL_TEXTURE1);
+	glDisable(GL_TEXTURE_2D);
+	glActiveTexture(GL_TEXTURE0);
 }
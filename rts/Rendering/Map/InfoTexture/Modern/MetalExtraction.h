@@ -5,6 +5,7 @@
 
 #include "PboInfoTexture.h"
 #include "Rendering/GL/FBO.h"
+#include "System/Rectangle.h"
 
 
 namespace Shader {
@@ -16,14 +17,30 @@ class CMetalExtractionTexture : public CPboInfoTexture
 {
 public:
 	CMetalExtractionTexture();
+	~CMetalExtractionTexture();
 
 public:
 	void Update() override;
 	bool IsUpdateNeeded() override;
 
+private:
+	void UpdateGPU(const SRectangle& rect);
+
 private:
 	int updateN;
 	FBO fbo;
+	// raw extraction-map, LOS-masked into texture by the FBO pass
+	GLuint uploadTex = 0;
+
+	// state of the last update, see CMetalMap::GetExtractionDirtyRect and CLosMap::GetDirtyRect
+	unsigned int lastExtractionUpdateNum = 0;
+	// the los info-texture might only be updated after this one, so its
+	// changes are applied twice: {two updates ago, last update}
+	unsigned int lastLosUpdateNums[2] = {0, 0};
+	// for the same reason, an ally-team or global LOS switch is rebuilt twice
+	int numFullUpdates = 2;
+	int lastAllyTeam = -1;
+	bool lastGlobalLos = false;
 	Shader::IProgramObject* shader;
 };
 
@@ -171,19 +171,79 @@ void CRadarTexture::Update()
 
 		glBindTexture(GL_TEXTURE_2D, texture);
 		glGenerateMipmap(GL_TEXTURE_2D);
+
+		// global LOS overwrote everything, rebuild in full once it ends
+		lastAllyTeam = -1;
 		return;
 	}
 
 	const int jammerAllyTeam = modInfo.separateJammers ? gu->myAllyTeam : 0;
 
+	// only re-upload the squares changed since the last update; the jammer
+	// channel is masked by LOS, so its changes (at LOS resolution) count too
+	SRectangle rect = {0, 0, texSize.x, texSize.y};
+	SRectangle radarRect;
+	SRectangle jammerRect;
+	SRectangle losRect;
+
+	const bool incremental = (gu->myAllyTeam == lastAllyTeam)
+		&& losHandler->radar.losMaps[gu->myAllyTeam].GetDirtyRect(lastRadarUpdateNum, radarRect)
+		&& losHandler->jammer.losMaps[jammerAllyTeam].GetDirtyRect(lastJammerUpdateNum, jammerRect)
+		&& losHandler->los.losMaps[gu->myAllyTeam].GetDirtyRect(lastLosUpdateNums[0], losRect);
+
+	if (incremental) {
+		const int2 losSize = losHandler->los.size;
+
+		// padded by a square since the los texture is sampled with linear filtering
+		if (losRect.x1 < losRect.x2 && losRect.y1 < losRect.y2) {
+			losRect.x1 = (losRect.x1 * texSize.x) / losSize.x - 1;
+			losRect.y1 = (losRect.y1 * texSize.y) / losSize.y - 1;
+			losRect.x2 = (losRect.x2 * texSize.x + losSize.x - 1) / losSize.x + 1;
+			losRect.y2 = (losRect.y2 * texSize.y + losSize.y - 1) / losSize.y + 1;
+		} else {
+			losRect = {texSize.x, texSize.y, 0, 0};
+		}
+
+		rect.x1 = std::max(0, std::min(radarRect.x1, std::min(jammerRect.x1, losRect.x1)));
+		rect.y1 = std::max(0, std::min(radarRect.y1, std::min(jammerRect.y1, losRect.y1)));
+		rect.x2 = std::min(texSize.x, std::max(radarRect.x2, std::max(jammerRect.x2, losRect.x2)));
+		rect.y2 = std::min(texSize.y, std::max(radarRect.y2, std::max(jammerRect.y2, losRect.y2)));
+	}
+
+	lastRadarUpdateNum = losHandler->radar.updateNum;
+	lastJammerUpdateNum = losHandler->jammer.updateNum;
+	lastLosUpdateNums[0] = lastLosUpdateNums[1];
+	lastLosUpdateNums[1] = losHandler->los.updateNum;
+	lastAllyTeam = gu->myAllyTeam;
+
+	if (rect.GetWidth() <= 0 || rect.GetHeight() <= 0)
+		return;
+
+	UpdateGPU(rect);
+}
+
+
+void CRadarTexture::UpdateGPU(SRectangle rect)
+{
+	// keep rows 4-byte aligned for the default unpack alignment
+	rect.x1 &= ~1;
+	rect.x2 = std::min(texSize.x, (rect.x2 + 1) & ~1);
+
+	const int rectSizeX = rect.GetWidth();
+	const int rectSizeY = rect.GetHeight();
+
+	const int jammerAllyTeam = modInfo.separateJammers ? gu->myAllyTeam : 0;
+
 	infoTexPBO.Bind();
-	const size_t arraySize = texSize.x * texSize.y * sizeof(unsigned short);
+	const size_t rowSize = rectSizeX * sizeof(unsigned short);
+	const size_t arraySize = rowSize * rectSizeY;
 	auto infoTexMem = reinterpret_cast<unsigned char*>(infoTexPBO.MapBuffer());
 	const unsigned short* myRadar  = &losHandler->radar.losMaps[gu->myAllyTeam].front();
 	const unsigned short* myJammer = &losHandler->jammer.losMaps[jammerAllyTeam].front();
-	memcpy(infoTexMem,  myRadar, arraySize);
-	infoTexMem += arraySize;
-	memcpy(infoTexMem, myJammer, arraySize);
+	for (int y = rect.y1; y < rect.y2; ++y) {
+		memcpy(infoTexMem + (y - rect.y1) * rowSize,             &myRadar[y * texSize.x + rect.x1], rowSize);
+		memcpy(infoTexMem + (y - rect.y1) * rowSize + arraySize, &myJammer[y * texSize.x + rect.x1], rowSize);
+	}
 	infoTexPBO.UnmapBuffer();
 
 	//Trick: Upload the ushort as 2 ubytes, and then check both for `!=0` in the shader.
@@ -192,14 +252,19 @@ void CRadarTexture::Update()
 	glActiveTexture(GL_TEXTURE1);
 	glEnable(GL_TEXTURE_2D);
 	glBindTexture(GL_TEXTURE_2D, uploadTexRadar);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x1, rect.y1, rectSizeX, rectSizeY, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, uploadTexJammer);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr(arraySize));
+	glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x1, rect.y1, rectSizeX, rectSizeY, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr(arraySize));
 	infoTexPBO.Invalidate();
 	infoTexPBO.Unbind();
 
-	// do post-processing on the gpu (los-checking & scaling)
+	// do post-processing on the gpu (los-checking & scaling), restricted to the uploaded area
+	const float x1 = rect.x1 * 2.0f / texSize.x - 1.0f;
+	const float y1 = rect.y1 * 2.0f / texSize.y - 1.0f;
+	const float x2 = rect.x2 * 2.0f / texSize.x - 1.0f;
+	const float y2 = rect.y2 * 2.0f / texSize.y - 1.0f;
+
 	fbo.Bind();
 	glViewport(0,0, texSize.x, texSize.y);
 	shader->Enable();
@@ -208,10 +273,10 @@ void CRadarTexture::Update()
 	glEnable(GL_TEXTURE_2D);
 	glBindTexture(GL_TEXTURE_2D, infoTextureHandler->GetInfoTexture("los")->GetTexture());
 	glBegin(GL_QUADS);
-		glVertex2f(-1.f, -1.f);
-		glVertex2f(-1.f, +1.f);
-		glVertex2f(+1.f, +1.f);
-		glVertex2f(+1.f, -1.f);
+		glVertex2f(x1, y1);
+		glVertex2f(x1, y2);
+		glVertex2f(x2, y2);
+		glVertex2f(x2, y1);
 	glEnd();
 	shader->Disable();
 	glViewport(globalRendering->viewPosX,0,globalRendering->viewSizeX,globalRendering->viewSizeY);
@@ -6,6 +6,7 @@
 
 #include "PboInfoTexture.h"
 #include "Rendering/GL/FBO.h"
+#include "System/Rectangle.h"
 
 
 namespace Shader {
@@ -25,11 +26,20 @@ public:
 
 private:
 	void UpdateCPU();
+	void UpdateGPU(SRectangle rect);
 
 private:
 	FBO fbo;
 	GLuint uploadTexRadar;
 	GLuint uploadTexJammer;
+
+	// state of the last GPU update, see CLosMap::GetDirtyRect
+	unsigned int lastRadarUpdateNum = 0;
+	unsigned int lastJammerUpdateNum = 0;
+	// the los info-texture might only be updated after this one, so its
+	// changes are applied twice: {two updates ago, last update}
+	unsigned int lastLosUpdateNums[2] = {0, 0};
+	int lastAllyTeam = -1;
 	Shader::IProgramObject* shader;
 };
 
@@ -8,6 +8,11 @@
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "System/Exceptions.h"
 #include "System/SafeUtil.h"
+#include "System/StringUtil.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Sync/HsiehHash.h"
 #include "lib/meshoptimizer/src/meshoptimizer.h"
 
 #include "System/Log/ILog.h"
@@ -15,6 +20,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <fstream>
 
 CR_BIND(LocalModelPiece, (nullptr))
 CR_REG_METADATA(LocalModelPiece, (
@@ -34,18 +40,41 @@ CR_REG_METADATA(LocalModelPiece, (
 	CR_IGNORED(original),
 
 	CR_IGNORED(dirty),
+	CR_IGNORED(customDirty),
+	CR_IGNORED(localModel),
 	CR_IGNORED(modelSpaceMat),
 	CR_IGNORED(pieceSpaceMat),
 
 	CR_IGNORED(lodDispLists) //FIXME GL idx!
 ))
 
+// bump whenever the LOD-file format or the simplification parameters change
+static constexpr uint32_t LOD_FILE_VERSION = 1;
+static constexpr char LOD_FILE_MAGIC[8] = {'S', 'P', 'R', 'M', 'D', 'L', 'O', 'D'};
+
+// {fraction of the LOD0 indices, relative deformation} targeted by each coarser level
+static constexpr std::array<float2, NUM_MODEL_LODS - 1> LOD_SIMPLIFY_TARGETS = {{{0.5f, 0.01f}, {0.2f, 0.04f}}};
+// pieces with fewer indices are kept as-is at every level
+static constexpr uint32_t LOD_MIN_INDEX_COUNT = 3 * 64;
+// a model keeps a level only if it has less than this fraction of the previous one's indices
+static constexpr float LOD_MAX_INDEX_RATIO = 0.8f;
+
+struct LODFileHeader {
+	char magic[sizeof(LOD_FILE_MAGIC)];
+
+	uint32_t version;
+	uint32_t geometryHash;
+	uint32_t numPieces;
+	uint32_t numLODs;
+};
+
 CR_BIND(LocalModel, )
 CR_REG_METADATA(LocalModel, (
 	CR_MEMBER(pieces),
 
 	CR_IGNORED(boundingVolume),
-	CR_IGNORED(luaMaterialData)
+	CR_IGNORED(luaMaterialData),
+	CR_IGNORED(customDirty)
 ))
 
 
@@ -307,6 +336,31 @@ void S3DModelPiece::MeshOptimize()
 	}
 }
 
+void S3DModelPiece::GenerateLODIndices()
+{
+	for (uint32_t lod = 1; lod < NUM_MODEL_LODS; lod++) {
+		std::vector<uint32_t>& lodIndcs = lodIndices[lod - 1];
+
+		// every level is simplified from the full mesh, which keeps the errors from accumulating
+		if (indices.size() < LOD_MIN_INDEX_COUNT) {
+			lodIndcs = indices;
+			continue;
+		}
+
+		const float2& target = LOD_SIMPLIFY_TARGETS[lod - 1];
+		const size_t targetCount = (static_cast<size_t>(indices.size() * target.x) / 3) * 3;
+
+		lodIndcs.resize(indices.size());
+		lodIndcs.resize(meshopt_simplify(lodIndcs.data(), indices.data(), indices.size(), &vertices[0].pos.x, vertices.size(), sizeof(SVertexData), targetCount, target.y));
+
+		// seams or a mesh made of disjoint parts can make the simplifier give up entirely
+		if (lodIndcs.empty())
+			lodIndcs = GetLODIndicesVec(lod - 1);
+
+		meshopt_optimizeVertexCache(lodIndcs.data(), lodIndcs.data(), lodIndcs.size(), vertices.size());
+	}
+}
+
 void S3DModelPiece::BindVertexAttribVBOs() const
 {
 	assert(model);
@@ -384,6 +438,7 @@ void LocalModel::SetModel(const S3DModel* model, bool initialize)
 
 			pieces[n].original = omp;
 			pieces[n].dispListID = omp->GetDisplayListID();
+			pieces[n].localModel = this;
 		}
 
 		pieces[0].UpdateChildMatricesRec(true);
@@ -398,6 +453,10 @@ void LocalModel::SetModel(const S3DModel* model, bool initialize)
 
 	CreateLocalModelPieces(model->GetRootPiece());
 
+	for (LocalModelPiece& lmp: pieces) {
+		lmp.localModel = this;
+	}
+
 	// must recursively update matrices here too: for features
 	// LocalModel::Update is never called, but they might have
 	// baked piece rotations (in the case of .dae)
@@ -585,6 +644,141 @@ void S3DModel::UploadToVBO(const std::vector<SVertexData>& vertices, const std::
 
 }
 
+void S3DModel::GenerateLODs()
+{
+	numLODs = 1;
+
+	if (type != MODELTYPE_S3O && type != MODELTYPE_ASS)
+		return;
+
+	uint32_t geometryHash = LOD_FILE_VERSION;
+
+	for (const S3DModelPiece* piece: pieceObjects) {
+		const auto& verts = piece->GetVerticesVec();
+		const auto& indcs = piece->GetIndicesVec();
+
+		const uint32_t counts[2] = {static_cast<uint32_t>(verts.size()), static_cast<uint32_t>(indcs.size())};
+
+		geometryHash = HsiehHash(counts, sizeof(counts), geometryHash);
+		geometryHash = HsiehHash(verts.data(), verts.size() * sizeof(SVertexData), geometryHash);
+		geometryHash = HsiehHash(indcs.data(), indcs.size() * sizeof(uint32_t), geometryHash);
+	}
+
+	geometryHash = HsiehHash(LOD_SIMPLIFY_TARGETS.data(), sizeof(LOD_SIMPLIFY_TARGETS), geometryHash);
+
+	const std::string cacheDir = FileSystem::GetCacheDir() + "/models/";
+	const std::string fileName = cacheDir + IntToString(geometryHash, "%08x") + ".lod";
+
+	const auto ReadLODs = [&]() {
+		std::ifstream file(dataDirsAccess.LocateFile(fileName), std::ios::in | std::ios::binary);
+
+		if (!file.is_open())
+			return false;
+
+		LODFileHeader header;
+
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+
+		if (std::memcmp(header.magic, LOD_FILE_MAGIC, sizeof(LOD_FILE_MAGIC)) != 0)
+			return false;
+		if (header.version != LOD_FILE_VERSION || header.geometryHash != geometryHash || header.numPieces != pieceObjects.size())
+			return false;
+		if (header.numLODs == 0 || header.numLODs > NUM_MODEL_LODS)
+			return false;
+
+		std::vector<uint32_t> lodIndcs;
+
+		for (S3DModelPiece* piece: pieceObjects) {
+			const uint32_t numVerts = piece->GetVerticesVec().size();
+			const uint32_t numIndcs = piece->GetIndicesVec().size();
+
+			for (uint32_t lod = 1; lod < header.numLODs; lod++) {
+				uint32_t numLODIndcs = 0;
+
+				if (!file.read(reinterpret_cast<char*>(&numLODIndcs), sizeof(numLODIndcs)))
+					return false;
+				if (numLODIndcs > numIndcs || (numLODIndcs % 3) != 0)
+					return false;
+
+				lodIndcs.resize(numLODIndcs);
+
+				if (!file.read(reinterpret_cast<char*>(lodIndcs.data()), numLODIndcs * sizeof(uint32_t)))
+					return false;
+				if (std::find_if(lodIndcs.begin(), lodIndcs.end(), [&](uint32_t indx) { return (indx >= numVerts); }) != lodIndcs.end())
+					return false;
+
+				piece->SetLODIndices(lod, std::move(lodIndcs));
+			}
+		}
+
+		numLODs = header.numLODs;
+		return true;
+	};
+
+	const auto WriteLODs = [&]() {
+		if (!FileSystem::CreateDirectory(cacheDir))
+			return false;
+
+		std::ofstream file(dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE), std::ios::out | std::ios::binary);
+
+		if (!file.is_open())
+			return false;
+
+		LODFileHeader header;
+
+		std::memcpy(header.magic, LOD_FILE_MAGIC, sizeof(LOD_FILE_MAGIC));
+
+		header.version = LOD_FILE_VERSION;
+		header.geometryHash = geometryHash;
+		header.numPieces = pieceObjects.size();
+		header.numLODs = numLODs;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (const S3DModelPiece* piece: pieceObjects) {
+			for (uint32_t lod = 1; lod < numLODs; lod++) {
+				const auto& lodIndcs = piece->GetLODIndicesVec(lod);
+				const uint32_t numLODIndcs = lodIndcs.size();
+
+				file.write(reinterpret_cast<const char*>(&numLODIndcs), sizeof(numLODIndcs));
+				file.write(reinterpret_cast<const char*>(lodIndcs.data()), numLODIndcs * sizeof(uint32_t));
+			}
+		}
+
+		return file.good();
+	};
+
+	if (ReadLODs())
+		return;
+
+	std::array<size_t, NUM_MODEL_LODS> lodIndxSums = {};
+
+	for (S3DModelPiece* piece: pieceObjects) {
+		if (!piece->HasGeometryData())
+			continue;
+
+		piece->GenerateLODIndices();
+
+		for (uint32_t lod = 0; lod < NUM_MODEL_LODS; lod++) {
+			lodIndxSums[lod] += piece->GetLODIndicesVec(lod).size();
+		}
+	}
+
+	// a level that barely removes anything is not worth a draw-command of its own
+	while (numLODs < NUM_MODEL_LODS && lodIndxSums[numLODs] < lodIndxSums[numLODs - 1] * LOD_MAX_INDEX_RATIO)
+		numLODs++;
+
+	for (S3DModelPiece* piece: pieceObjects) {
+		for (uint32_t lod = numLODs; lod < NUM_MODEL_LODS; lod++) {
+			piece->SetLODIndices(lod, {});
+		}
+	}
+
+	if (!WriteLODs())
+		LOG_L(L_WARNING, "[S3DModel::%s] could not write LOD-cache file \"%s\" for model \"%s\"", __func__, fileName.c_str(), name.c_str());
+}
+
 /** ****************************************************************************************************
  * LocalModelPiece
  */
@@ -628,6 +822,9 @@ void LocalModelPiece::SetDirty() {
 
 bool LocalModelPiece::SetGetCustomDirty(bool cd) const
 {
+	if (cd && localModel != nullptr)
+		localModel->SetGetCustomDirty(true);
+
 	std::swap(cd, customDirty);
 	return cd;
 }
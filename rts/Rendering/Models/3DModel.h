@@ -21,6 +21,7 @@ constexpr int MAX_MODEL_OBJECTS = 2560;
 constexpr int AVG_MODEL_PIECES = 16; // as it used to be
 constexpr int NUM_MODEL_TEXTURES = 2;
 constexpr int NUM_MODEL_UVCHANNS = 2;
+constexpr int NUM_MODEL_LODS = 3; // including the full-detail one
 
 static constexpr float3 DEF_MIN_SIZE( 10000.0f,  10000.0f,  10000.0f);
 static constexpr float3 DEF_MAX_SIZE(-10000.0f, -10000.0f, -10000.0f);
@@ -111,6 +112,9 @@ struct S3DModelPiece {
 		for (S3DModelPiecePart& p : shatterParts) {
 			p.renderData.clear();
 		}
+		for (auto& lodIndcs : lodIndices) {
+			lodIndcs.clear();
+		}
 
 		parent = nullptr;
 		colvol = {};
@@ -144,6 +148,8 @@ struct S3DModelPiece {
 	void UploadToVBO();
 
 	void MeshOptimize();
+	// simplifies <indices> into those of every coarser LOD-level, <vertices> are shared
+	void GenerateLODIndices();
 
 	void BindVertexAttribVBOs() const;
 	void UnbindVertexAttribVBOs() const;
@@ -213,6 +219,22 @@ public:
 
 	const std::vector<SVertexData>& GetVerticesVec() const { return vertices; };
 	const std::vector<uint32_t>& GetIndicesVec() const { return indices; };
+	const std::vector<uint32_t>& GetLODIndicesVec(uint32_t lod) const { return ((lod == 0)? indices: lodIndices[lod - 1]); }
+
+	// CPU-side geometry, excluding the piece itself
+	size_t GetMemFootPrint() const {
+		size_t memFootPrint = vertices.capacity() * sizeof(SVertexData);
+
+		memFootPrint += ((indices.capacity() + indicesVBO.capacity()) * sizeof(uint32_t));
+
+		for (const auto& lodIndcs: lodIndices) {
+			memFootPrint += (lodIndcs.capacity() * sizeof(uint32_t));
+		}
+
+		return memFootPrint;
+	}
+
+	void SetLODIndices(uint32_t lod, std::vector<uint32_t>&& lodIndcs) { assert(lod > 0 && lod < NUM_MODEL_LODS); lodIndices[lod - 1] = std::move(lodIndcs); }
 private:
 	void CreateShatterPiecesVariation(const int num);
 
@@ -244,6 +266,9 @@ protected:
 	std::vector<uint32_t> indices;
 	std::vector<uint32_t> indicesVBO; //used only to upload to VBO with shifted indices
 
+	// LOD-levels 1 to NUM_MODEL_LODS - 1, index into <vertices> like <indices>
+	std::array<std::vector<uint32_t>, NUM_MODEL_LODS - 1> lodIndices;
+
 	VBO vboShatterIndices;
 
 	S3DModel* model;
@@ -270,6 +295,10 @@ struct S3DModel
 		, indxStart(0u)
 		, indxCount(0u)
 
+		, numLODs(1u)
+		, lodIndxStarts{}
+		, lodIndxCounts{}
+
 		, curVertStartIndx(0u)
 		, curIndxStartIndx(0u)
 
@@ -313,6 +342,10 @@ struct S3DModel
 		indxStart = m.indxStart;
 		indxCount = m.indxCount;
 
+		numLODs = m.numLODs;
+		lodIndxStarts = m.lodIndxStarts;
+		lodIndxCounts = m.lodIndxCounts;
+
 		curVertStartIndx = m.curVertStartIndx;
 		curIndxStartIndx = m.curIndxStartIndx;
 
@@ -339,6 +372,9 @@ struct S3DModel
 
 	void CreateVBOs();
 
+	// fills the coarser LOD-levels of every piece, from the cache-dir if possible; thread-safe
+	void GenerateLODs();
+
 	void BindVertexAttribs() const;
 	void UnbindVertexAttribs() const;
 
@@ -419,6 +455,11 @@ public:
 	uint32_t indxStart; //global VBO offset, size data
 	uint32_t indxCount;
 
+	// [0] equals {indxStart, indxCount}, levels >= numLODs are not valid
+	uint32_t numLODs;
+	std::array<uint32_t, NUM_MODEL_LODS> lodIndxStarts;
+	std::array<uint32_t, NUM_MODEL_LODS> lodIndxCounts;
+
 	uint32_t curVertStartIndx;
 	uint32_t curIndxStartIndx;
 
@@ -441,6 +482,7 @@ private:
  * Instance of S3DModel. Container for the geometric properties & piece visibility status of the agent's instance of a 3d model.
  */
 
+struct LocalModel;
 struct LocalModelPiece
 {
 	CR_DECLARE_STRUCT(LocalModelPiece)
@@ -538,6 +580,8 @@ public:
 
 	const S3DModelPiece* original;
 	LocalModelPiece* parent;
+	// owner of this piece, set by LocalModel::SetModel
+	LocalModel* localModel = nullptr;
 
 	std::vector<LocalModelPiece*> children;
 	std::vector<unsigned int> lodDispLists;
@@ -585,6 +629,10 @@ struct LocalModel
 
 	void SetModel(const S3DModel* model, bool initialize = true);
 	void SetLODCount(unsigned int lodCount);
+
+	// true if any piece became custom-dirty (see LocalModelPiece::SetGetCustomDirty)
+	// since the last reset; lets drawers skip the pieces of models nothing animated
+	bool SetGetCustomDirty(bool cd) const { std::swap(cd, customDirty); return cd; }
 	void UpdateBoundingVolume();
 
 	void GetBoundingBoxVerts(std::vector<float3>& verts) const {
@@ -626,6 +674,8 @@ private:
 
 	// custom Lua-set material this model should be rendered with
 	LuaObjectMaterialData luaMaterialData;
+
+	mutable bool customDirty = true;
 };
 
 #endif /* _3DMODEL_H */
@@ -3,17 +3,61 @@
 #include "3DModelVAO.h"
 
 #include <algorithm>
+#include <array>
 #include <iterator>
+#include <unordered_map>
+#include <utility>
 
+#include "Game/Camera.h"
+#include "Game/CameraHandler.h"
+#include "Rendering/GlobalRendering.h"
 #include "Rendering/Models/3DModel.h"
 #include "Rendering/Models/IModelParser.h"
 #include "Rendering/Models/ModelPreloader.h"
+#include "Rendering/Models/ModelRenderContainer.h"
 #include "Rendering/ModelsDataUploader.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "Rendering/Shaders/Shader.h"
+#include "Rendering/Textures/S3OTextureHandler.h"
+#include "System/Log/ILog.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
 #include "Sim/Features/Feature.h"
 
 
+// projected radius in pixels below which LOD-level i + 1 is drawn; also used by ModelCullCompGL4
+static constexpr std::array<float, NUM_MODEL_LODS - 1> LOD_PIXEL_RADII = {48.0f, 16.0f};
+static_assert(LOD_PIXEL_RADII.size() == 2, "must match lodPixelRadii in ModelCullCompGL4.glsl");
+
+
+// pixel radius of a unit-sized object at unit distance from the player camera
+static float GetLODPixelScale()
+{
+	const CCamera* cam = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
+	return (globalRendering->viewSizeY * 0.5f / cam->GetTanHalfFov());
+}
+
+template<typename TObj>
+static uint32_t GetObjectLOD(const TObj* obj)
+{
+	const S3DModel* model = obj->model;
+
+	if (model->numLODs <= 1)
+		return 0;
+
+	// every pass refers to the player camera, drawing shadows and reflections at the on-screen detail
+	const CCamera* cam = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
+	const float pxRadius = obj->GetDrawRadius() * GetLODPixelScale() / std::max(cam->GetPos().distance(obj->drawMidPos), 1.0f);
+
+	uint32_t lod = 0;
+
+	while (lod < (model->numLODs - 1) && pxRadius < LOD_PIXEL_RADII[lod])
+		lod++;
+
+	return lod;
+}
+
+
 void S3DModelVAO::EnableAttribs(bool inst) const
 {
 	if (!inst) {
@@ -51,9 +95,11 @@ void S3DModelVAO::DisableAttribs() const
 S3DModelVAO::S3DModelVAO()
 	: batchedBaseInstance{ 0u }
 	, immediateBaseInstance{ 0u }
+	, culledBaseInstance{ 0u }
 {
 	std::vector<SVertexData> vertData; vertData.reserve(2 << 21);
 	std::vector<uint32_t   > indxData; indxData.reserve(2 << 22);
+	std::vector<uint32_t   > pieceVertOffsets;
 
 	//populate content of the common buffers
 	{
@@ -63,6 +109,8 @@ S3DModelVAO::S3DModelVAO()
 			//models should know their index offset
 			model.indxStart = std::distance(indxData.cbegin(), indxData.cend());
 
+			pieceVertOffsets.clear();
+
 			for (auto modelPiece : model.pieceObjects) { //vec of pointers
 				if (!modelPiece->HasGeometryData())
 					continue;
@@ -71,6 +119,7 @@ S3DModelVAO::S3DModelVAO()
 				const auto& modelPieceIndcs = modelPiece->GetIndicesVec();
 
 				const uint32_t indexOffsetVertNum = vertData.size();
+				pieceVertOffsets.push_back(indexOffsetVertNum);
 
 				vertData.insert(vertData.end(), modelPieceVerts.begin(), modelPieceVerts.end()); //append
 				indxData.insert(indxData.end(), modelPieceIndcs.begin(), modelPieceIndcs.end()); //append
@@ -89,6 +138,28 @@ S3DModelVAO::S3DModelVAO()
 
 			//models should know their index count
 			model.indxCount = indxData.size() - model.indxStart;
+
+			model.lodIndxStarts[0] = model.indxStart;
+			model.lodIndxCounts[0] = model.indxCount;
+
+			// coarser levels follow LOD0 and reuse its vertices; piece ranges only exist for LOD0
+			for (uint32_t lod = 1; lod < model.numLODs; lod++) {
+				model.lodIndxStarts[lod] = indxData.size();
+
+				for (size_t i = 0, j = 0; i < model.pieceObjects.size(); i++) {
+					const auto modelPiece = model.pieceObjects[i];
+
+					if (!modelPiece->HasGeometryData())
+						continue;
+
+					const auto& modelPieceIndcs = modelPiece->GetLODIndicesVec(lod);
+					const uint32_t indexOffsetVertNum = pieceVertOffsets[j++];
+
+					std::transform(modelPieceIndcs.begin(), modelPieceIndcs.end(), std::back_inserter(indxData), [indexOffsetVertNum](uint32_t indx) { return (indx + indexOffsetVertNum); });
+				}
+
+				model.lodIndxCounts[lod] = indxData.size() - model.lodIndxStarts[lod];
+			}
 		}
 	}
 
@@ -132,6 +203,15 @@ S3DModelVAO::S3DModelVAO()
 	}
 }
 
+S3DModelVAO::~S3DModelVAO()
+{
+	if (cullShader == nullptr)
+		return;
+
+	shaderHandler->ReleaseProgramObjects("[S3DModelVAO]");
+	cullShader = nullptr;
+}
+
 void S3DModelVAO::Init()
 {
 	Kill();
@@ -147,17 +227,23 @@ void S3DModelVAO::Bind() const
 {
 	assert(vao.GetIdRaw() > 0);
 	vao.Bind();
+
+	if (textureHandlerS3O.UseBindlessTextures())
+		textureHandlerS3O.BindTextureHandles();
 }
 
 void S3DModelVAO::Unbind() const
 {
 	assert(vao.GetIdRaw() > 0);
 	vao.Unbind();
+
+	if (textureHandlerS3O.UseBindlessTextures())
+		textureHandlerS3O.UnbindTextureHandles();
 }
 
 
 template<typename TObj>
-bool S3DModelVAO::AddToSubmissionImpl(const TObj* obj, uint32_t indexStart, uint32_t indexCount, uint8_t teamID, uint8_t drawFlags)
+bool S3DModelVAO::AddToSubmissionImpl(const TObj* obj, uint32_t indexStart, uint32_t indexCount, uint16_t texType, uint8_t teamID, uint8_t drawFlags)
 {
 	const auto matIndex = matrixUploader.GetElemOffset(obj);
 	if (matIndex == MatricesMemStorage::INVALID_INDEX)
@@ -166,7 +252,7 @@ bool S3DModelVAO::AddToSubmissionImpl(const TObj* obj, uint32_t indexStart, uint
 	const auto uniIndex = modelsUniformsStorage.GetObjOffset(obj); //doesn't need to exist for defs amd model. Don't check for validity
 
 	auto& modelInstanceData = modelDataToInstance[SIndexAndCount{ indexStart, indexCount }];
-	modelInstanceData.emplace_back(SInstanceData(matIndex, teamID, drawFlags, uniIndex));
+	modelInstanceData.emplace_back(SInstanceData(matIndex, teamID, drawFlags, uniIndex, texType));
 	return true;
 }
 
@@ -174,7 +260,7 @@ bool S3DModelVAO::AddToSubmission(const S3DModel* model, uint8_t teamID, uint8_t
 {
 	assert(model);
 
-	return AddToSubmissionImpl(model, model->indxStart, model->indxCount, teamID, drawFlags);
+	return AddToSubmissionImpl(model, model->indxStart, model->indxCount, model->textureType, teamID, drawFlags);
 }
 
 bool S3DModelVAO::AddToSubmission(const CUnit* unit)
@@ -184,7 +270,9 @@ bool S3DModelVAO::AddToSubmission(const CUnit* unit)
 	const S3DModel* model = unit->model;
 	assert(model);
 
-	return AddToSubmissionImpl(unit, model->indxStart, model->indxCount, unit->team, unit->drawFlag);
+	const uint32_t lod = GetObjectLOD(unit);
+
+	return AddToSubmissionImpl(unit, model->lodIndxStarts[lod], model->lodIndxCounts[lod], model->textureType, unit->team, unit->drawFlag);
 }
 
 bool S3DModelVAO::AddToSubmission(const CFeature* feature)
@@ -194,7 +282,9 @@ bool S3DModelVAO::AddToSubmission(const CFeature* feature)
 	const S3DModel* model = feature->model;
 	assert(model);
 
-	return AddToSubmissionImpl(feature, model->indxStart, model->indxCount, feature->team, feature->drawFlag);
+	const uint32_t lod = GetObjectLOD(feature);
+
+	return AddToSubmissionImpl(feature, model->lodIndxStarts[lod], model->lodIndxCounts[lod], model->textureType, feature->team, feature->drawFlag);
 }
 
 bool S3DModelVAO::AddToSubmission(const UnitDef* unitDef, uint8_t teamID)
@@ -204,7 +294,7 @@ bool S3DModelVAO::AddToSubmission(const UnitDef* unitDef, uint8_t teamID)
 	const S3DModel* model = unitDef->model;
 	assert(model);
 
-	return AddToSubmissionImpl(unitDef, model->indxStart, model->indxCount, teamID, 0);
+	return AddToSubmissionImpl(unitDef, model->indxStart, model->indxCount, model->textureType, teamID, 0);
 }
 
 
@@ -256,7 +346,7 @@ void S3DModelVAO::Submit(GLenum mode, bool bindUnbind)
 }
 
 template<typename TObj>
-bool S3DModelVAO::SubmitImmediatelyImpl(const TObj* obj, uint32_t indexStart, uint32_t indexCount, uint8_t teamID, uint8_t drawFlags, GLenum mode, bool bindUnbind)
+bool S3DModelVAO::SubmitImmediatelyImpl(const TObj* obj, uint32_t indexStart, uint32_t indexCount, uint16_t texType, uint8_t teamID, uint8_t drawFlags, GLenum mode, bool bindUnbind)
 {
 	std::size_t matIndex = matrixUploader.GetElemOffset(obj);
 	if (matIndex == MatricesMemStorage::INVALID_INDEX)
@@ -264,7 +354,7 @@ bool S3DModelVAO::SubmitImmediatelyImpl(const TObj* obj, uint32_t indexStart, ui
 
 	const auto uniIndex = modelsUniformsStorage.GetObjOffset(obj); //doesn't need to exist for defs. Don't check for validity
 
-	SInstanceData instanceData(static_cast<uint32_t>(matIndex), teamID, drawFlags, uniIndex);
+	SInstanceData instanceData(static_cast<uint32_t>(matIndex), teamID, drawFlags, uniIndex, texType);
 	const uint32_t immediateBaseInstanceAbs = INSTANCE_BUFFER_NUM_BATCHED + immediateBaseInstance;
 	SDrawElementsIndirectCommand scmd{
 		indexCount,
@@ -294,7 +384,7 @@ bool S3DModelVAO::SubmitImmediatelyImpl(const TObj* obj, uint32_t indexStart, ui
 bool S3DModelVAO::SubmitImmediately(const S3DModel* model, uint8_t teamID, uint8_t drawFlags, GLenum mode, bool bindUnbind)
 {
 	assert(model);
-	return SubmitImmediatelyImpl(model, model->indxStart, model->indxCount, teamID, drawFlags, mode, bindUnbind);
+	return SubmitImmediatelyImpl(model, model->indxStart, model->indxCount, model->textureType, teamID, drawFlags, mode, bindUnbind);
 }
 
 bool S3DModelVAO::SubmitImmediately(const CUnit* unit, const GLenum mode, bool bindUnbind)
@@ -304,7 +394,7 @@ bool S3DModelVAO::SubmitImmediately(const CUnit* unit, const GLenum mode, bool b
 	const S3DModel* model = unit->model;
 	assert(model);
 
-	return SubmitImmediatelyImpl(unit, model->indxStart, model->indxCount, unit->team, unit->drawFlag, mode, bindUnbind);
+	return SubmitImmediatelyImpl(unit, model->indxStart, model->indxCount, model->textureType, unit->team, unit->drawFlag, mode, bindUnbind);
 }
 
 bool S3DModelVAO::SubmitImmediately(const CFeature* feature, GLenum mode, bool bindUnbind)
@@ -314,7 +404,7 @@ bool S3DModelVAO::SubmitImmediately(const CFeature* feature, GLenum mode, bool b
 	const S3DModel* model = feature->model;
 	assert(model);
 
-	return SubmitImmediatelyImpl(feature, model->indxStart, model->indxCount, feature->team, feature->drawFlag, mode, bindUnbind);
+	return SubmitImmediatelyImpl(feature, model->indxStart, model->indxCount, model->textureType, feature->team, feature->drawFlag, mode, bindUnbind);
 }
 
 bool S3DModelVAO::SubmitImmediately(const UnitDef* unitDef, int teamID, GLenum mode, bool bindUnbind)
@@ -324,5 +414,229 @@ bool S3DModelVAO::SubmitImmediately(const UnitDef* unitDef, int teamID, GLenum m
 	const S3DModel* model = unitDef->model;
 	assert(model);
 
-	return SubmitImmediatelyImpl(unitDef, model->indxStart, model->indxCount, teamID, 0, mode, bindUnbind);
-}
\ No newline at end of file
+	return SubmitImmediatelyImpl(unitDef, model->indxStart, model->indxCount, model->textureType, teamID, 0, mode, bindUnbind);
+}
+
+bool S3DModelVAO::InitCullShader()
+{
+	if (cullShaderState >= 0)
+		return (cullShaderState > 0);
+
+	cullShaderState = 0;
+
+	if (!globalRendering->haveGL4 || !GLEW_ARB_compute_shader)
+		return false;
+
+	cullShader = shaderHandler->CreateProgramObject("[S3DModelVAO]", "ModelCullCompGL4", false);
+	cullShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/ModelCullCompGL4.glsl", "", GL_COMPUTE_SHADER));
+	cullShader->SetFlag("CULL_WORKGROUP_SIZE", CULL_WORKGROUP_SIZE);
+	cullShader->SetFlag("CULL_OBJS_SSBO_BINDING_IDX", CULL_OBJS_SSBO_BINDING_IDX);
+	cullShader->SetFlag("INSTANCES_SSBO_BINDING_IDX", INSTANCES_SSBO_BINDING_IDX);
+	cullShader->SetFlag("DRAW_CMDS_SSBO_BINDING_IDX", DRAW_CMDS_SSBO_BINDING_IDX);
+	cullShader->Link();
+	cullShader->Validate();
+
+	if (!cullShader->IsValid()) {
+		LOG_L(L_WARNING, "[S3DModelVAO::%s] culling shader failed to compile, GPU model culling is disabled", __func__);
+		return false;
+	}
+
+	cullShaderState = 1;
+	return true;
+}
+
+template<typename TObj>
+void S3DModelVAO::UpdateCullSet(S3DModelCullSet& cullSet, const ModelRenderContainer<TObj, ModelRenderContainerSelector<TObj>>& mdlRenderer) const
+{
+	cullSet.cullObjs.clear();
+	cullSet.drawCmds.clear();
+	cullSet.cullBins.clear();
+
+	// model-id to this bin's first draw-command index, one command follows per LOD-level
+	static std::unordered_map<int, uint32_t> binModelCmds;
+
+	uint32_t instsOffset = 0;
+
+	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
+		S3DModelCullSet::CullBin cullBin;
+		cullBin.objsOffset = cullSet.cullObjs.size();
+		cullBin.cmdsOffset = cullSet.drawCmds.size();
+		cullBin.instsOffset = instsOffset;
+
+		binModelCmds.clear();
+
+		for (const TObj* o : mdlRenderer.GetObjectBin(i)) {
+			const S3DModel* model = o->model;
+
+			const auto matIndex = matrixUploader.GetElemOffset(o);
+			if (matIndex == MatricesMemStorage::INVALID_INDEX)
+				continue;
+
+			const auto uniIndex = modelsUniformsStorage.GetObjOffset(o);
+			const auto cmdIter = binModelCmds.try_emplace(model->id, cullSet.drawCmds.size()).first;
+
+			if (cmdIter->second == cullSet.drawCmds.size()) {
+				for (uint32_t lod = 0; lod < model->numLODs; lod++) {
+					cullSet.drawCmds.emplace_back(model->lodIndxCounts[lod], 0u, model->lodIndxStarts[lod], 0u, 0u);
+				}
+			}
+
+			// instanceCount is the bin's capacity for this model until the offsets are known
+			for (uint32_t lod = 0; lod < model->numLODs; lod++) {
+				cullSet.drawCmds[cmdIter->second + lod].instanceCount++;
+			}
+
+			S3DModelCullSet::CullObject cullObj;
+			cullObj.instData = SInstanceData(static_cast<uint32_t>(matIndex), o->team, o->drawFlag, uniIndex, model->textureType);
+			cullObj.instData.aux1 = cmdIter->second | ((model->numLODs - 1) << 30);
+			cullObj.midPosRadius = float4{ o->localModel.GetRelMidPos(), o->GetDrawRadius() };
+
+			cullSet.cullObjs.emplace_back(cullObj);
+		}
+
+		uint32_t binBaseInstance = 0;
+
+		for (size_t j = cullBin.cmdsOffset; j < cullSet.drawCmds.size(); j++) {
+			auto& drawCmd = cullSet.drawCmds[j];
+
+			drawCmd.baseInstance = binBaseInstance;
+			binBaseInstance += std::exchange(drawCmd.instanceCount, 0u);
+		}
+
+		cullBin.objsCount = cullSet.cullObjs.size() - cullBin.objsOffset;
+		cullBin.cmdsCount = cullSet.drawCmds.size() - cullBin.cmdsOffset;
+		cullBin.instsCount = binBaseInstance;
+		cullSet.cullBins.emplace_back(cullBin);
+
+		instsOffset += binBaseInstance;
+	}
+
+	if (cullSet.cullObjsSSBO.GetIdRaw() == 0) {
+		cullSet.cullObjsSSBO = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+		cullSet.drawCmdsSSBO = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+	}
+
+	// never shrink, avoids reallocations while the unit count oscillates
+	{
+		const size_t cullObjsSize = std::max(cullSet.cullObjs.size(), size_t(1)) * sizeof(S3DModelCullSet::CullObject);
+		cullSet.cullObjsSSBO.Bind();
+		if (cullSet.cullObjsSSBO.GetSize() < cullObjsSize)
+			cullSet.cullObjsSSBO.New(cullObjsSize * 2, GL_DYNAMIC_DRAW);
+		if (!cullSet.cullObjs.empty())
+			cullSet.cullObjsSSBO.SetBufferSubData(cullSet.cullObjs);
+		cullSet.cullObjsSSBO.Unbind();
+	}
+	{
+		const size_t drawCmdsSize = std::max(cullSet.drawCmds.size(), size_t(1)) * sizeof(SDrawElementsIndirectCommand);
+		cullSet.drawCmdsSSBO.Bind(GL_SHADER_STORAGE_BUFFER);
+		if (cullSet.drawCmdsSSBO.GetSize() < drawCmdsSize)
+			cullSet.drawCmdsSSBO.New(drawCmdsSize * 2, GL_DYNAMIC_DRAW);
+		cullSet.drawCmdsSSBO.Unbind();
+	}
+
+	cullSet.version = mdlRenderer.GetVersion();
+}
+
+template<typename TObj>
+bool S3DModelVAO::SubmitCulled(
+	S3DModelCullSet& cullSet,
+	const ModelRenderContainer<TObj, ModelRenderContainerSelector<TObj>>& mdlRenderer,
+	uint32_t binIdx,
+	uint32_t numBins,
+	CullPassType passType,
+	uint8_t passMask,
+	GLenum mode
+) {
+	if (!InitCullShader())
+		return false;
+
+	if (cullSet.version != mdlRenderer.GetVersion())
+		UpdateCullSet(cullSet, mdlRenderer);
+
+	if (numBins == 0)
+		return true;
+
+	assert(binIdx + numBins <= cullSet.cullBins.size());
+
+	// bins are laid out back to back, so a range of them is culled like one bin
+	const auto& firstBin = cullSet.cullBins[binIdx];
+	const auto& lastBin = cullSet.cullBins[binIdx + numBins - 1];
+
+	const S3DModelCullSet::CullBin cullBin = {
+		firstBin.objsOffset,
+		lastBin.objsOffset + lastBin.objsCount - firstBin.objsOffset,
+		firstBin.cmdsOffset,
+		lastBin.cmdsOffset + lastBin.cmdsCount - firstBin.cmdsOffset,
+		firstBin.instsOffset,
+		lastBin.instsOffset + lastBin.instsCount - firstBin.instsOffset,
+	};
+
+	if (cullBin.instsCount > INSTANCE_BUFFER_NUM_CULLED)
+		return false;
+
+	if (cullBin.cmdsCount == 0)
+		return true;
+
+	// cycle through the culled region so consecutive passes do not overwrite instances still in flight
+	if (culledBaseInstance + cullBin.instsCount > INSTANCE_BUFFER_NUM_CULLED)
+		culledBaseInstance = 0;
+
+	const uint32_t culledBaseInstanceAbs = INSTANCE_BUFFER_NUM_BATCHED + INSTANCE_BUFFER_NUM_IMMEDIATE + culledBaseInstance;
+	culledBaseInstance += cullBin.instsCount;
+
+	static std::vector<SDrawElementsIndirectCommand> binDrawCmds;
+	binDrawCmds.clear();
+	binDrawCmds.insert(binDrawCmds.end(), cullSet.drawCmds.begin() + cullBin.cmdsOffset, cullSet.drawCmds.begin() + cullBin.cmdsOffset + cullBin.cmdsCount);
+
+	// baseInstance is relative to each bin, whose instances start at (instsOffset - cullBin.instsOffset)
+	for (uint32_t i = binIdx; i < binIdx + numBins; i++) {
+		const auto& bin = cullSet.cullBins[i];
+
+		for (uint32_t j = bin.cmdsOffset; j < bin.cmdsOffset + bin.cmdsCount; j++) {
+			binDrawCmds[j - cullBin.cmdsOffset].baseInstance += (culledBaseInstanceAbs + bin.instsOffset - cullBin.instsOffset);
+		}
+	}
+
+	cullSet.drawCmdsSSBO.Bind(GL_SHADER_STORAGE_BUFFER);
+	cullSet.drawCmdsSSBO.SetBufferSubData(binDrawCmds, cullBin.cmdsOffset);
+	cullSet.drawCmdsSSBO.Unbind();
+
+	// the model shader is active, restore it once culling is done
+	GLint prevProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &prevProgram);
+
+	cullSet.cullObjsSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, CULL_OBJS_SSBO_BINDING_IDX, 0, cullSet.cullObjsSSBO.GetSize());
+	instVBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES_SSBO_BINDING_IDX, 0, instVBO.GetSize());
+	cullSet.drawCmdsSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_CMDS_SSBO_BINDING_IDX, 0, cullSet.drawCmdsSSBO.GetSize());
+
+	cullShader->Enable();
+	cullShader->SetUniform("objsOffset", static_cast<int>(cullBin.objsOffset));
+	cullShader->SetUniform("objsCount", static_cast<int>(cullBin.objsCount));
+	cullShader->SetUniform("passType", static_cast<int>(passType));
+	cullShader->SetUniform("passMask", static_cast<int>(passMask));
+	{
+		const float3& camPos = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER)->GetPos();
+
+		cullShader->SetUniform("lodParams", camPos.x, camPos.y, camPos.z, GetLODPixelScale());
+		cullShader->SetUniform("lodPixelRadii", LOD_PIXEL_RADII[0], LOD_PIXEL_RADII[1]);
+	}
+
+	glDispatchCompute((cullBin.objsCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+	cullShader->Disable();
+	glUseProgram(prevProgram);
+
+	cullSet.drawCmdsSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_CMDS_SSBO_BINDING_IDX, 0, cullSet.drawCmdsSSBO.GetSize());
+	instVBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES_SSBO_BINDING_IDX, 0, instVBO.GetSize());
+	cullSet.cullObjsSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, CULL_OBJS_SSBO_BINDING_IDX, 0, cullSet.cullObjsSSBO.GetSize());
+
+	cullSet.drawCmdsSSBO.Bind(GL_DRAW_INDIRECT_BUFFER);
+	glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, reinterpret_cast<const void*>(cullBin.cmdsOffset * sizeof(SDrawElementsIndirectCommand)), cullBin.cmdsCount, sizeof(SDrawElementsIndirectCommand));
+	cullSet.drawCmdsSSBO.Unbind();
+
+	return true;
+}
+
+template bool S3DModelVAO::SubmitCulled<CUnit>(S3DModelCullSet&, const ModelRenderContainer<CUnit, ModelRenderContainerSelector<CUnit>>&, uint32_t, uint32_t, CullPassType, uint8_t, GLenum);
+template bool S3DModelVAO::SubmitCulled<CFeature>(S3DModelCullSet&, const ModelRenderContainer<CFeature, ModelRenderContainerSelector<CFeature>>&, uint32_t, uint32_t, CullPassType, uint8_t, GLenum);
\ No newline at end of file
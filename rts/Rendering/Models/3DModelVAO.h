@@ -2,10 +2,12 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/VBO.h"
 #include "Rendering/GL/VAO.h"
+#include "System/float4.h"
 
 struct S3DModel;
 struct S3DModelPiece;
@@ -17,6 +19,10 @@ struct UnitDef;
 
 struct SDrawElementsIndirectCommand;
 
+template<typename TObject, typename TObjectSelector> class ModelRenderContainer;
+template<typename TObject> class ModelRenderContainerSelector;
+namespace Shader { struct IProgramObject; }
+
 struct SIndexAndCount {
 	SIndexAndCount() = default;
 	SIndexAndCount(uint32_t index_, uint32_t count_)
@@ -31,6 +37,38 @@ struct SIndexAndCount {
 	uint32_t count;
 };
 
+/**
+ * GPU-side mirror of one ModelRenderContainer, consumed by S3DModelVAO::SubmitCulled.
+ * Only rebuilt when the container's membership changes, so per frame the CPU work is
+ * proportional to the number of bins and models rather than the number of objects.
+ */
+struct S3DModelCullSet {
+	struct CullObject {
+		SInstanceData instData; // aux1 holds the index of the object's first draw-command | (number of model LODs - 1) << 30
+		float4 midPosRadius;    // model-space mid-position, draw-radius
+	};
+	struct CullBin {
+		uint32_t objsOffset;
+		uint32_t objsCount;
+		uint32_t cmdsOffset;
+		uint32_t cmdsCount;
+		// every LOD-level of a model reserves room for all of its objects
+		uint32_t instsOffset;
+		uint32_t instsCount;
+	};
+
+	std::vector<CullObject> cullObjs;
+	std::vector<SDrawElementsIndirectCommand> drawCmds; // instanceCount = 0, baseInstance relative to the bin
+	std::vector<CullBin> cullBins;
+
+	VBO cullObjsSSBO;
+	VBO drawCmdsSSBO;
+
+	uint32_t version = -1u;
+};
+
+static_assert(sizeof(S3DModelCullSet::CullObject) == 32, "must match CullObject in ModelCullCompGL4.glsl");
+
 // singleton
 class S3DModelVAO {
 public:
@@ -41,9 +79,17 @@ public:
 public:
 	static constexpr size_t INSTANCE_BUFFER_NUM_BATCHED = 2 << 15;
 	static constexpr size_t INSTANCE_BUFFER_NUM_IMMEDIATE = 2 << 10;
-	static constexpr size_t INSTANCE_BUFFER_NUM_ELEMS = INSTANCE_BUFFER_NUM_BATCHED + INSTANCE_BUFFER_NUM_IMMEDIATE;
+	static constexpr size_t INSTANCE_BUFFER_NUM_CULLED = 2 << 16;
+	static constexpr size_t INSTANCE_BUFFER_NUM_ELEMS = INSTANCE_BUFFER_NUM_BATCHED + INSTANCE_BUFFER_NUM_IMMEDIATE + INSTANCE_BUFFER_NUM_CULLED;
+
+	enum CullPassType {
+		CULL_PASS_OPAQUE = 0,
+		CULL_PASS_ALPHA  = 1,
+		CULL_PASS_SHADOW = 2,
+	};
 public:
 	S3DModelVAO();
+	~S3DModelVAO();
 
 	void Bind() const;
 	void Unbind() const;
@@ -61,16 +107,37 @@ public:
 	bool SubmitImmediately(const CFeature* feature, GLenum mode = GL_TRIANGLES, bool bindUnbind = false);
 	bool SubmitImmediately(const UnitDef* unitDef, int teamID, GLenum mode = GL_TRIANGLES, bool bindUnbind = false);
 
+	/**
+	 * Culls the objects of bins [binIdx, binIdx + numBins) of <mdlRenderer> against <passMask> and the pass
+	 * camera in a compute shader, then draws the survivors with a single glMultiDrawElementsIndirect. The VAO
+	 * must be bound; more than one bin can only be drawn at once with bindless model textures.
+	 * Objects flagged as CPU-drawn (ModelUniformData::gpuDrawMask == 0) are skipped and left to the caller.
+	 * Returns false if GPU culling is unavailable, in which case the caller has to draw the bins itself.
+	 */
+	template<typename TObj>
+	bool SubmitCulled(
+		S3DModelCullSet& cullSet,
+		const ModelRenderContainer<TObj, ModelRenderContainerSelector<TObj>>& mdlRenderer,
+		uint32_t binIdx,
+		uint32_t numBins,
+		CullPassType passType,
+		uint8_t passMask,
+		GLenum mode = GL_TRIANGLES
+	);
+
 	const VBO* GetVertVBO() const { return &vertVBO; }
 	      VBO* GetVertVBO()       { return &vertVBO; }
 	const VBO* GetIndxVBO() const { return &indxVBO; }
 	      VBO* GetIndxVBO()       { return &indxVBO; }
+
+	size_t GetBuffersSize() const { return (vertVBO.GetSize() + indxVBO.GetSize() + instVBO.GetSize()); }
 private:
 	template<typename TObj>
 	bool SubmitImmediatelyImpl(
 		const TObj* obj,
 		uint32_t indexStart,
 		uint32_t indexCount,
+		uint16_t texType,
 		uint8_t teamID,
 		uint8_t drawFlags,
 		GLenum mode = GL_TRIANGLES,
@@ -81,16 +148,32 @@ private:
 		const TObj* obj,
 		uint32_t indexStart,
 		uint32_t indexCount,
+		uint16_t texType,
 		uint8_t teamID,
 		uint8_t drawFlags
 	);
 	void EnableAttribs(bool inst) const;
 	void DisableAttribs() const;
+
+	template<typename TObj>
+	void UpdateCullSet(S3DModelCullSet& cullSet, const ModelRenderContainer<TObj, ModelRenderContainerSelector<TObj>>& mdlRenderer) const;
+
+	bool InitCullShader();
 private:
 	inline static S3DModelVAO* instance = nullptr;
+
+	static constexpr uint32_t CULL_OBJS_SSBO_BINDING_IDX = 2;
+	static constexpr uint32_t INSTANCES_SSBO_BINDING_IDX = 3;
+	static constexpr uint32_t DRAW_CMDS_SSBO_BINDING_IDX = 4;
+	static constexpr uint32_t CULL_WORKGROUP_SIZE = 64;
 private:
 	uint32_t batchedBaseInstance;
 	uint32_t immediateBaseInstance; //note relative index
+	uint32_t culledBaseInstance; //note relative index
+
+	// -1 := not yet tried, 0 := unsupported or failed to compile
+	int cullShaderState = -1;
+	Shader::IProgramObject* cullShader = nullptr;
 
 	VBO vertVBO;
 	VBO indxVBO;
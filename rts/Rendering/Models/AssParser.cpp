@@ -13,8 +13,11 @@
 #include "System/Log/ILog.h"
 #include "System/Exceptions.h"
 #include "System/ScopedFPUSettings.h"
+#include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/Sync/HsiehHash.h"
 
 #include "lib/assimp/include/assimp/config.h"
 #include "lib/assimp/include/assimp/defs.h"
@@ -24,6 +27,8 @@
 #include "lib/assimp/include/assimp/Importer.hpp"
 #include "lib/assimp/include/assimp/DefaultLogger.hpp"
 
+#include <cstring>
+#include <fstream>
 #include <regex>
 
 
@@ -54,6 +59,21 @@ static constexpr unsigned int ASS_LOGGING_OPTIONS =
 	Assimp::Logger::Err |
 	Assimp::Logger::Warn;
 
+// the parsed pieces of a model are kept in the cache-dir, keyed by the hash
+// of its file and metafile, so only the first load has to go through Assimp
+// bump the version whenever what Load makes of a given file changes
+static constexpr uint32_t ASS_CACHE_VERSION = 1;
+static constexpr char ASS_CACHE_MAGIC[8] = {'S', 'P', 'R', 'M', 'D', 'A', 'S', 'S'};
+
+struct AssCacheHeader {
+	char magic[sizeof(ASS_CACHE_MAGIC)];
+
+	uint32_t version;
+	uint32_t cacheHash;
+	uint32_t dataHash;
+	uint32_t dataSize;
+};
+
 
 
 static inline float3 aiVectorToFloat3(const aiVector3D v)
@@ -182,13 +202,6 @@ S3DModel CAssParser::Load(const std::string& modelFilePath)
 		LOG_SL(LOG_SECTION_MODEL, L_INFO, "No valid model metadata in '%s' or no meta-file", metaFileName.c_str());
 
 
-	Assimp::Importer importer;
-
-	// speed-up processing by skipping things we don't need
-	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, ASS_IMPORTER_OPTIONS);
-	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT,   maxVertices);
-	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, maxIndices / 3);
-
 	if (!file.IsBuffered()) {
 		fileBuf.resize(file.FileSize(), 0);
 		file.Read(fileBuf.data(), fileBuf.size());
@@ -196,6 +209,32 @@ S3DModel CAssParser::Load(const std::string& modelFilePath)
 		fileBuf = std::move(file.GetBuffer());
 	}
 
+	S3DModel model;
+	model.name = modelFilePath;
+	model.type = MODELTYPE_ASS;
+
+	std::vector<std::string> materialTextures;
+
+	const uint32_t cacheHash = GetCacheHash(fileBuf, metaFileName);
+	const std::string cacheFileName = GetCacheFileName(modelFilePath, cacheHash);
+
+	if (ReadCachedModel(&model, materialTextures, cacheFileName, cacheHash)) {
+		LOG_SL(LOG_SECTION_MODEL, L_INFO, "Loaded model %s from cache", modelFilePath.c_str());
+
+		FindTextures(&model, materialTextures, modelTable, modelPath, modelName);
+		textureHandlerS3O.PreloadTexture(&model, modelTable.GetBool("fliptextures", true), modelTable.GetBool("invertteamcolor", true));
+		CalculateModelProperties(&model, modelTable);
+		return model;
+	}
+
+
+	Assimp::Importer importer;
+
+	// speed-up processing by skipping things we don't need
+	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, ASS_IMPORTER_OPTIONS);
+	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT,   maxVertices);
+	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, maxIndices / 3);
+
 	if (modelTable.GetBool("nodenamesfromids", false)) {
 		assert(FileSystem::GetExtension(modelFilePath) == "dae");
 		PreProcessFileBuffer(fileBuf);
@@ -225,12 +264,9 @@ S3DModel CAssParser::Load(const std::string& modelFilePath)
 	ModelPieceMap pieceMap;
 	ParentNameMap parentMap;
 
-	S3DModel model;
-	model.name = modelFilePath;
-	model.type = MODELTYPE_ASS;
-
 	// Load textures
-	FindTextures(&model, scene, modelTable, modelPath, modelName);
+	GetMaterialTextures(scene, materialTextures);
+	FindTextures(&model, materialTextures, modelTable, modelPath, modelName);
 	LOG_SL(LOG_SECTION_MODEL, L_INFO, "Loading textures. Tex1: '%s' Tex2: '%s'", model.texs[0].c_str(), model.texs[1].c_str());
 
 	textureHandlerS3O.PreloadTexture(&model, modelTable.GetBool("fliptextures", true), modelTable.GetBool("invertteamcolor", true));
@@ -251,10 +287,239 @@ S3DModel CAssParser::Load(const std::string& modelFilePath)
 	LOG_SL(LOG_SECTION_MODEL, L_DEBUG, "model->mins: (%f,%f,%f)", model.mins[0], model.mins[1], model.mins[2]);
 	LOG_SL(LOG_SECTION_MODEL, L_DEBUG, "model->maxs: (%f,%f,%f)", model.maxs[0], model.maxs[1], model.maxs[2]);
 	LOG_SL(LOG_SECTION_MODEL, L_INFO, "Model %s Imported.", model.name.c_str());
+
+	WriteCachedModel(&model, materialTextures, cacheFileName, cacheHash);
 	return model;
 }
 
 
+uint32_t CAssParser::GetCacheHash(const std::vector<unsigned char>& fileBuf, const std::string& metaFileName) const
+{
+	const uint32_t params[] = {ASS_CACHE_VERSION, ASS_POSTPROCESS_OPTIONS, ASS_IMPORTER_OPTIONS, maxVertices, maxIndices, sizeof(SVertexData)};
+
+	std::string metaFileBuf;
+	CFileHandler metaFile(metaFileName, SPRING_VFS_ZIP);
+
+	// the metafile's tables are applied while parsing, e.g. piece offsets
+	if (metaFile.FileExists())
+		metaFile.LoadStringData(metaFileBuf);
+
+	uint32_t hash = HsiehHash(params, sizeof(params), 0);
+
+	hash = HsiehHash(fileBuf.data(), fileBuf.size(), hash);
+	hash = HsiehHash(metaFileBuf.data(), metaFileBuf.size(), hash);
+	return hash;
+}
+
+std::string CAssParser::GetCacheFileName(const std::string& modelFilePath, uint32_t cacheHash)
+{
+	// the basename keeps a hash collision from swapping two models
+	return (FileSystem::GetCacheDir() + "/models/" + FileSystem::GetBasename(modelFilePath) + IntToString(cacheHash, "-%08x") + ".amc");
+}
+
+bool CAssParser::ReadCachedModel(S3DModel* model, std::vector<std::string>& materialTextures, const std::string& cacheFileName, uint32_t cacheHash)
+{
+	std::ifstream file(dataDirsAccess.LocateFile(cacheFileName), std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	AssCacheHeader header;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+
+	if (std::memcmp(header.magic, ASS_CACHE_MAGIC, sizeof(ASS_CACHE_MAGIC)) != 0)
+		return false;
+	if (header.version != ASS_CACHE_VERSION || header.cacheHash != cacheHash)
+		return false;
+
+	std::vector<char> data(header.dataSize);
+
+	// an interrupted or concurrent write leaves a file that fails this check
+	if (!file.read(data.data(), data.size()))
+		return false;
+	if (HsiehHash(data.data(), data.size(), 0) != header.dataHash)
+		return false;
+
+	size_t pos = 0;
+
+	const auto Read = [&](void* dst, size_t size) {
+		if ((pos + size) > data.size())
+			return false;
+
+		std::memcpy(dst, data.data() + pos, size);
+		pos += size;
+		return true;
+	};
+	const auto ReadString = [&](std::string& str) {
+		uint32_t len = 0;
+
+		if (!Read(&len, sizeof(len)) || (pos + len) > data.size())
+			return false;
+
+		str.assign(data.data() + pos, len);
+		pos += len;
+		return true;
+	};
+
+	uint32_t numTextures = 0;
+	uint32_t numPieces = 0;
+
+	if (!Read(&numTextures, sizeof(numTextures)))
+		return false;
+
+	materialTextures.resize(numTextures);
+
+	for (std::string& texName: materialTextures) {
+		if (!ReadString(texName))
+			return false;
+	}
+
+	if (!Read(&numPieces, sizeof(numPieces)) || numPieces == 0)
+		return false;
+
+	std::vector<SAssPiece*> pieces;
+	pieces.reserve(numPieces);
+
+	for (uint32_t i = 0; i < numPieces; i++) {
+		SAssPiece* piece = AllocPiece();
+
+		int32_t parentIndex = -1;
+		uint32_t numVertices = 0;
+		uint32_t numIndices = 0;
+
+		CMatrix44f bakedMatrix;
+
+		pieces.push_back(piece);
+
+		bool valid = true;
+
+		valid = valid && ReadString(piece->name);
+		valid = valid && Read(&parentIndex, sizeof(parentIndex));
+		valid = valid && Read(&piece->offset, sizeof(piece->offset));
+		valid = valid && Read(&piece->scales, sizeof(piece->scales));
+		valid = valid && Read(&bakedMatrix.m[0], sizeof(bakedMatrix.m));
+		valid = valid && Read(&piece->mins, sizeof(piece->mins));
+		valid = valid && Read(&piece->maxs, sizeof(piece->maxs));
+		valid = valid && Read(&piece->numTexCoorChannels, sizeof(piece->numTexCoorChannels));
+		valid = valid && Read(&numVertices, sizeof(numVertices));
+		valid = valid && (numVertices <= ((data.size() - pos) / sizeof(SVertexData)));
+
+		if (valid) {
+			piece->vertices.resize(numVertices);
+			valid = Read(piece->vertices.data(), numVertices * sizeof(SVertexData));
+		}
+
+		valid = valid && Read(&numIndices, sizeof(numIndices));
+		valid = valid && (numIndices <= ((data.size() - pos) / sizeof(uint32_t)));
+
+		if (valid) {
+			piece->indices.resize(numIndices);
+			valid = Read(piece->indices.data(), numIndices * sizeof(uint32_t));
+		}
+
+		// pieces are stored depth-first, so parents always come first
+		valid = valid && ((i == 0) == (parentIndex == -1)) && (parentIndex < int32_t(i));
+		valid = valid && std::none_of(piece->indices.begin(), piece->indices.end(), [&](uint32_t idx) { return (idx >= numVertices); });
+
+		if (!valid) {
+			// the pool slots are not reused, but this needs a damaged cache
+			for (SAssPiece* p: pieces) {
+				p->Clear();
+			}
+
+			model->pieceObjects.clear();
+			materialTextures.clear();
+			return false;
+		}
+
+		piece->SetBakedMatrix(bakedMatrix);
+		piece->SetParentModel(model);
+
+		if (i == 0) {
+			model->AddPiece(piece);
+			continue;
+		}
+
+		piece->parent = pieces[parentIndex];
+		piece->parent->children.push_back(piece);
+	}
+
+	model->numPieces = numPieces;
+	model->FlattenPieceTree(model->GetRootPiece());
+	return true;
+}
+
+void CAssParser::WriteCachedModel(const S3DModel* model, const std::vector<std::string>& materialTextures, const std::string& cacheFileName, uint32_t cacheHash)
+{
+	std::vector<char> data;
+
+	const auto Write = [&](const void* src, size_t size) {
+		data.insert(data.end(), reinterpret_cast<const char*>(src), reinterpret_cast<const char*>(src) + size);
+	};
+	const auto WriteString = [&](const std::string& str) {
+		const uint32_t len = str.size();
+
+		Write(&len, sizeof(len));
+		Write(str.data(), len);
+	};
+
+	const uint32_t numTextures = materialTextures.size();
+	const uint32_t numPieces = model->pieceObjects.size();
+
+	Write(&numTextures, sizeof(numTextures));
+
+	for (const std::string& texName: materialTextures) {
+		WriteString(texName);
+	}
+
+	Write(&numPieces, sizeof(numPieces));
+
+	for (const S3DModelPiece* p: model->pieceObjects) {
+		const SAssPiece* piece = static_cast<const SAssPiece*>(p);
+		const auto parentIter = std::find(model->pieceObjects.begin(), model->pieceObjects.end(), piece->parent);
+
+		const int32_t parentIndex = (piece->parent != nullptr)? (parentIter - model->pieceObjects.begin()): -1;
+		const uint32_t numVertices = piece->vertices.size();
+		const uint32_t numIndices = piece->indices.size();
+
+		WriteString(piece->name);
+		Write(&parentIndex, sizeof(parentIndex));
+		Write(&piece->offset, sizeof(piece->offset));
+		Write(&piece->scales, sizeof(piece->scales));
+		Write(&piece->bakedMatrix.m[0], sizeof(piece->bakedMatrix.m));
+		Write(&piece->mins, sizeof(piece->mins));
+		Write(&piece->maxs, sizeof(piece->maxs));
+		Write(&piece->numTexCoorChannels, sizeof(piece->numTexCoorChannels));
+		Write(&numVertices, sizeof(numVertices));
+		Write(piece->vertices.data(), numVertices * sizeof(SVertexData));
+		Write(&numIndices, sizeof(numIndices));
+		Write(piece->indices.data(), numIndices * sizeof(uint32_t));
+	}
+
+	AssCacheHeader header;
+
+	std::memcpy(header.magic, ASS_CACHE_MAGIC, sizeof(ASS_CACHE_MAGIC));
+
+	header.version = ASS_CACHE_VERSION;
+	header.cacheHash = cacheHash;
+	header.dataHash = HsiehHash(data.data(), data.size(), 0);
+	header.dataSize = data.size();
+
+	if (!FileSystem::CreateDirectory(FileSystem::GetDirectory(cacheFileName)))
+		return;
+
+	std::ofstream file(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE), std::ios::out | std::ios::binary);
+
+	if (!file.is_open())
+		return;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(data.data(), data.size());
+}
+
+
 void CAssParser::PreProcessFileBuffer(std::vector<unsigned char>& fileBuffer)
 {
 	// the Collada specification requires node uid's to be unique
@@ -777,9 +1042,37 @@ static std::string FindTextureByRegex(const std::string& regex_path, const std::
 }
 
 
+void CAssParser::GetMaterialTextures(const aiScene* scene, std::vector<std::string>& materialTextures)
+{
+	if (scene->mNumMaterials == 0)
+		return;
+
+	constexpr unsigned int texTypes[] = {
+		aiTextureType_SPECULAR,
+		aiTextureType_UNKNOWN,
+		aiTextureType_DIFFUSE,
+		/*
+		// TODO: support these too (we need to allow constructing tex1 & tex2 from several sources)
+		aiTextureType_EMISSIVE,
+		aiTextureType_HEIGHT,
+		aiTextureType_NORMALS,
+		aiTextureType_SHININESS,
+		aiTextureType_OPACITY,
+		*/
+	};
+	for (unsigned int texType: texTypes) {
+		aiString textureFile;
+		if (scene->mMaterials[0]->Get(AI_MATKEY_TEXTURE(texType, 0), textureFile) != aiReturn_SUCCESS)
+			continue;
+
+		assert(textureFile.length > 0);
+		materialTextures.emplace_back(textureFile.data);
+	}
+}
+
 void CAssParser::FindTextures(
 	S3DModel* model,
-	const aiScene* scene,
+	const std::vector<std::string>& materialTextures,
 	const LuaTable& modelTable,
 	const std::string& modelPath,
 	const std::string& modelName
@@ -794,29 +1087,9 @@ void CAssParser::FindTextures(
 	if (model->texs[0].empty()) model->texs[0] = FindTextureByRegex(modelPath, "diffuse");
 	if (model->texs[1].empty()) model->texs[1] = FindTextureByRegex(modelPath, "glow"); // lowest-priority name
 
-	// 2. gather model-defined textures of first material (medium priority)
-	if (scene->mNumMaterials > 0) {
-		constexpr unsigned int texTypes[] = {
-			aiTextureType_SPECULAR,
-			aiTextureType_UNKNOWN,
-			aiTextureType_DIFFUSE,
-			/*
-			// TODO: support these too (we need to allow constructing tex1 & tex2 from several sources)
-			aiTextureType_EMISSIVE,
-			aiTextureType_HEIGHT,
-			aiTextureType_NORMALS,
-			aiTextureType_SHININESS,
-			aiTextureType_OPACITY,
-			*/
-		};
-		for (unsigned int texType: texTypes) {
-			aiString textureFile;
-			if (scene->mMaterials[0]->Get(AI_MATKEY_TEXTURE(texType, 0), textureFile) != aiReturn_SUCCESS)
-				continue;
-
-			assert(textureFile.length > 0);
-			model->texs[0] = FindTexture(textureFile.data, modelPath, model->texs[0]);
-		}
+	// 2. use the model-defined textures of the first material (medium priority)
+	for (const std::string& textureFile: materialTextures) {
+		model->texs[0] = FindTexture(textureFile, modelPath, model->texs[0]);
 	}
 
 	// 3. try to load from metafile (highest priority)
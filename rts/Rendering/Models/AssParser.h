@@ -108,11 +108,18 @@ private:
 	static void CalculateModelProperties(S3DModel* model, const LuaTable& pieceTable);
 	static void FindTextures(
 		S3DModel* model,
-		const aiScene* scene,
+		const std::vector<std::string>& materialTextures,
 		const LuaTable& pieceTable,
 		const std::string& modelPath,
 		const std::string& modelName
 	);
+	static void GetMaterialTextures(const aiScene* scene, std::vector<std::string>& materialTextures);
+
+	uint32_t GetCacheHash(const std::vector<unsigned char>& fileBuf, const std::string& metaFileName) const;
+	static std::string GetCacheFileName(const std::string& modelFilePath, uint32_t cacheHash);
+
+	bool ReadCachedModel(S3DModel* model, std::vector<std::string>& materialTextures, const std::string& cacheFileName, uint32_t cacheHash);
+	static void WriteCachedModel(const S3DModel* model, const std::vector<std::string>& materialTextures, const std::string& cacheFileName, uint32_t cacheHash);
 
 private:
 	unsigned int maxIndices = 0;
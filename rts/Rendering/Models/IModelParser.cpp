@@ -4,10 +4,12 @@
 #include "3DOParser.h"
 #include "S3OParser.h"
 #include "AssParser.h"
+#include "3DModelVAO.h"
 #include "Game/GlobalUnsynced.h"
 #include "Rendering/Textures/S3OTextureHandler.h"
 #include "Net/Protocol/NetProtocol.h" // NETLOG
 #include "Sim/Misc/CollisionVolume.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
@@ -19,6 +21,8 @@
 #include "lib/assimp/include/assimp/Importer.hpp"
 
 
+CONFIG(bool, ModelLODs).defaultValue(true).description("Generate simplified LOD-meshes for S3O and Assimp models and draw them for models that are small on screen.");
+
 CModelLoader modelLoader;
 
 static C3DOParser g3DOParser;
@@ -127,6 +131,9 @@ void CModelLoader::Init()
 	RegisterModelFormats(formats);
 	InitParsers();
 
+	// read once, preload threads must not touch the config
+	generateLODs = configHandler->GetBool("ModelLODs");
+
 	models.clear();
 	models.resize(MAX_MODEL_OBJECTS);
 
@@ -246,6 +253,33 @@ void CModelLoader::LogErrors()
 	errors.clear();
 }
 
+std::uint64_t CModelLoader::GetMemFootPrint()
+{
+	// preload threads may be adding models
+	std::lock_guard<spring::mutex> lock(mutex);
+
+	std::uint64_t memFootPrint = models.capacity() * sizeof(S3DModel);
+
+	for (unsigned int i = 0; i < numModels; i++) {
+		for (const S3DModelPiece* p: models[i].pieceObjects) {
+			memFootPrint += (sizeof(S3DModelPiece) + p->GetMemFootPrint());
+		}
+	}
+
+	memFootPrint += (matricesMemStorage.GetSize() * sizeof(CMatrix44f));
+	return memFootPrint;
+}
+
+std::uint64_t CModelLoader::GetGPUMemFootPrint() const
+{
+	std::uint64_t memFootPrint = 0;
+
+	if (S3DModelVAO::IsValid())
+		memFootPrint += S3DModelVAO::GetInstance().GetBuffersSize();
+
+	return memFootPrint;
+}
+
 
 S3DModel* CModelLoader::LoadModel(std::string name, bool preload)
 {
@@ -309,6 +343,9 @@ S3DModel* CModelLoader::CreateModel(
 
 		model.SetPieceMatrices();
 
+		if (generateLODs)
+			model.GenerateLODs();
+
 		if (!preload)
 			CreateLists(&model);
 	}
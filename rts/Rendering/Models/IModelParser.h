@@ -36,6 +36,11 @@ public:
 
 	const std::vector<S3DModel>& GetModelsVec() const { return models; }
 	      std::vector<S3DModel>& GetModelsVec()       { return models; }
+
+	// bytes held by the loaded models' pieces and transform matrices (CPU)
+	// and by their vertex, index and instance buffers (GPU)
+	std::uint64_t GetMemFootPrint();
+	std::uint64_t GetGPUMemFootPrint() const;
 public:
 	typedef spring::unordered_map<std::string, unsigned int> ModelMap; // "armflash.3do" --> id
 	typedef spring::unordered_map<std::string, unsigned int> FormatMap; // "3do" --> MODELTYPE_3DO
@@ -66,6 +71,8 @@ private:
 
 	// all unique models loaded so far
 	unsigned int numModels = 0;
+
+	bool generateLODs = false;
 };
 
 extern CModelLoader modelLoader;
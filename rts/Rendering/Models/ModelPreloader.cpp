@@ -1,9 +1,50 @@
 #include "ModelPreloader.h"
+#include "IModelParser.h"
 
 #include "Sim/Units/UnitDefHandler.h"
 #include "Sim/Features/FeatureDefHandler.h"
 #include "Sim/Weapons/WeaponDefHandler.h"
+#include "System/StringUtil.h"
 #include "System/Misc/UnfreezeSpring.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+void ModelPreloader::ParseModels()
+{
+	std::vector<std::string> modelNames;
+
+	for (const auto& def : unitDefHandler->GetUnitDefsVec()) {
+		modelNames.push_back(def.modelName);
+	}
+	for (const auto& def : featureDefHandler->GetFeatureDefsVec()) {
+		modelNames.push_back(def.modelName);
+	}
+	for (const auto& def : weaponDefHandler->GetWeaponDefsVec()) {
+		modelNames.push_back(def.visuals.modelName);
+	}
+
+	for (std::string& name : modelNames) {
+		StringToLowerInPlace(name);
+	}
+
+	std::sort(modelNames.begin(), modelNames.end());
+	modelNames.erase(std::unique(modelNames.begin(), modelNames.end()), modelNames.end());
+	modelNames.erase(std::remove(modelNames.begin(), modelNames.end(), ""), modelNames.end());
+
+	// a few models per thread at a time, so the watchdog can be kept quiet in between
+	const int batchSize = std::max(ThreadPool::GetNumThreads(), 1) * 2;
+
+	for (int i = 0, n = modelNames.size(); i < n; i += batchSize) {
+		for_mt(i, std::min(i + batchSize, n), [&](const int j) {
+			modelLoader.LoadModel(modelNames[j], true);
+		});
+
+		spring::UnfreezeSpring(WDT_LOAD, 1);
+	}
+}
 
 void ModelPreloader::LoadUnitDefs()
 {
@@ -7,6 +7,10 @@
 class ModelPreloader {
 public:
 	static void Load() {
+		// parsing needs no GL, so it can run on all threads; without GL4 the
+		// models are then only given their buffers when first drawn
+		ParseModels();
+
 		if (!globalRendering->haveGL4 || !enabled)
 			return;
 
@@ -28,6 +32,7 @@ public:
 private:
 	static constexpr bool enabled = true;
 private:
+	static void ParseModels();
 	static void LoadUnitDefs();
 	static void LoadFeatureDefs();
 	static void LoadWeaponDefs();
@@ -27,6 +27,9 @@ private:
 	size_t numObjs = 0;
 	size_t numBins = 0;
 
+	// bumped on every membership change, lets GPU-side mirrors detect staleness
+	uint32_t version = 0;
+
 	const TObjectSelector objectSelector;
 private:
 	int CalcObjectBinIdx(const TObject* o) const { return objectSelector(o); }
@@ -58,6 +61,7 @@ public:
 
 		numObjs = 0;
 		numBins = 0;
+		version++;
 	}
 
 	void AddObject(const TObject* o) {
@@ -78,7 +82,10 @@ public:
 
 		// numBins += (ki == ke);
 		// cast since updating an object's draw-position requires mutability
-		numObjs += spring::VectorInsertUnique(bin, const_cast<TObject*>(o));
+		const bool inserted = spring::VectorInsertUnique(bin, const_cast<TObject*>(o));
+
+		numObjs += inserted;
+		version += inserted;
 	}
 
 	void DelObject(const TObject* o) {
@@ -96,8 +103,11 @@ public:
 		// and alpha containers (since it does not know the
 		// cloaked state) which also means the tex-type key
 		// might not exist here
-		numObjs -= spring::VectorErase(bin, const_cast<TObject*>(o));
+		const bool erased = spring::VectorErase(bin, const_cast<TObject*>(o));
+
+		numObjs -= erased;
 		numBins -= (bin.empty());
+		version += erased;
 
 		if (!bin.empty())
 			return;
@@ -111,6 +121,7 @@ public:
 	unsigned int GetNumObjects() const { return numObjs; }
 	unsigned int GetNumObjectBins() const { return numBins; }
 	unsigned int GetObjectBinKey(unsigned int idx) const { return keys[idx]; }
+	uint32_t GetVersion() const { return version; }
 
 	const ObjectBin& GetObjectBin(unsigned int idx) const { return bins[idx]; }
 };
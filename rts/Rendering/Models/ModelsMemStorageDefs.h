@@ -13,7 +13,7 @@ struct alignas(4) ModelUniformData {
 		uint32_t composite;
 		struct {
 			uint8_t drawFlag;
-			uint8_t unused1;
+			uint8_t gpuDrawMask; // engineDrawMask as seen by ModelCullCompGL4, 0 when drawn by the CPU path
 			uint16_t id;
 		};
 	};
@@ -51,7 +51,7 @@ void TypedStorageBufferUploader<T, Derived>::InitImpl(uint32_t bindingIdx_, uint
 
 	assert(bindingIdx < -1u);
 
-	ssbo = IStreamBuffer<T>::CreateInstance(GL_SHADER_STORAGE_BUFFER, elemCount0, std::string(className), static_cast<IStreamBufferConcept::Types>(type), true, coherent, numBuffers);
+	ssbo = IStreamBuffer<T>::CreateInstance(GL_SHADER_STORAGE_BUFFER, elemCount0, std::string(className), static_cast<IStreamBufferConcept::Types>(type), true, coherent, numBuffers, StreamRingArena::SRA_MODELSDATA);
 	ssbo->BindBufferRange(bindingIdx);
 }
 
@@ -287,7 +287,8 @@ void ModelsUniformsUploader::InitDerived()
 	if (!Supported())
 		return;
 
-	InitImpl(MATUNI_SSBO_BINDING_IDX, ELEM_COUNT0, ELEM_COUNTI, IStreamBufferConcept::Types::SB_BUFFERSUBDATA, true, 3);
+	// rewritten completely each frame, so it can be streamed through the shared arena
+	InitImpl(MATUNI_SSBO_BINDING_IDX, ELEM_COUNT0, ELEM_COUNTI, IStreamBufferConcept::Types::SB_RINGARENA, true, 3);
 }
 
 void ModelsUniformsUploader::KillDerived()
@@ -319,6 +320,13 @@ void ModelsUniformsUploader::UpdateDerived()
 	const ModelUniformData* clientPtr = modelsUniformsStorage.GetData().data();
 	ModelUniformData* mappedPtr = ssbo->Map(clientPtr, 0, storageElemCount);
 
+	if (mappedPtr == nullptr) {
+		LOG_L(L_WARNING, "[%s::%s] Stream arena ran out of space, falling back to SB_BUFFERSUBDATA", className, __func__);
+		KillImpl();
+		InitImpl(MATUNI_SSBO_BINDING_IDX, std::max(elemCount, AlignUp(storageElemCount, elemCountIncr)), ELEM_COUNTI, IStreamBufferConcept::Types::SB_BUFFERSUBDATA, true, 3);
+		mappedPtr = ssbo->Map(clientPtr, 0, storageElemCount);
+	}
+
 	if (!ssbo->HasClientPtr())
 		memcpy(mappedPtr, clientPtr, storageElemCount * sizeof(ModelUniformData));
 
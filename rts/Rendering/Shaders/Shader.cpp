@@ -507,6 +507,23 @@ namespace Shader {
 		curSrcHash = 0;
 	}
 
+	unsigned int GLSLProgramObject::GetBinaryHash() const {
+		// stage types and attribute bindings are baked into the binary, but not part of curSrcHash
+		unsigned int hash = curSrcHash;
+
+		for (const IShaderObject* so: shaderObjs) {
+			const unsigned int type = so->GetType();
+			hash = HsiehHash(&type, sizeof(type), hash);
+		}
+
+		// combined order-independently, attribLocations is unordered
+		for (const auto& [name, index] : attribLocations) {
+			hash ^= HsiehHash(&index, sizeof(index), HsiehHash(name.data(), name.size(), 127));
+		}
+
+		return hash;
+	}
+
 	void GLSLProgramObject::Reload(bool reloadFromDisk, bool validate) {
 		const unsigned int oldProgID = objID;
 		const unsigned int oldSrcHash = curSrcHash;
@@ -556,7 +573,15 @@ namespace Shader {
 			}
 		}
 
-		// recompile if not found in cache (id 0)
+		CShaderHandler::ProgramBinaryCache& binaryCache = shaderHandler->GetProgramBinaryCache();
+
+		const unsigned int binaryHash = GetBinaryHash();
+
+		// try a binary linked by a previous run
+		if (objID == 0)
+			objID = binaryCache.Load(binaryHash);
+
+		// recompile if not found in either cache (id 0)
 		if (objID == 0) {
 			objID = glCreateProgram();
 
@@ -581,6 +606,7 @@ namespace Shader {
 				glBindAttribLocation(objID, index, name.c_str());
 			}
 
+			binaryCache.SetRetrievable(objID);
 			glLinkProgram(objID);
 
 			valid = glslIsValid(objID);
@@ -588,6 +614,8 @@ namespace Shader {
 
 			if (!IsValid()) {
 				LOG_L(L_WARNING, "[GLSL-PO::%s] program-object name: %s, link-log:\n%s\n", __FUNCTION__, name.c_str(), log.c_str());
+			} else {
+				binaryCache.Save(binaryHash, objID);
 			}
 
 			#ifdef _DEBUG
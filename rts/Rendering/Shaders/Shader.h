@@ -383,6 +383,9 @@ namespace Shader {
 		void SetUniformMatrix4fv(int idx, bool transp, const float* v) override;
 
 	private:
+		// key of the program in CShaderHandler::ProgramBinaryCache
+		unsigned int GetBinaryHash() const;
+
 		int GetUniformType(const int idx) override;
 		int GetUniformLoc(const char* name) override;
 
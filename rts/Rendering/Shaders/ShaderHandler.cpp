@@ -5,10 +5,36 @@
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/GlobalRenderingInfo.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
+#include "System/Sync/HsiehHash.h"
 
 #include <cassert>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+CONFIG(bool, UseShaderBinaryCache).defaultValue(true).description("If linked GLSL programs should be stored in the cache-dir and reused by later runs, skipping most shader compiles at load time.");
+
+
+// bump whenever the layout changes
+static constexpr uint32_t BINARY_CACHE_VERSION = 1;
+static constexpr char BINARY_CACHE_MAGIC[8] = {'S', 'P', 'R', 'G', 'L', 'B', 'I', 'N'};
+
+struct ProgramBinaryHeader {
+	char magic[sizeof(BINARY_CACHE_MAGIC)];
+
+	uint32_t version;
+	uint32_t driverHash;
+	uint32_t srcHash;
+	uint32_t binaryFormat;
+	uint32_t binarySize;
+};
 
 
 // not extern'ed, so static
@@ -175,3 +201,133 @@ Shader::IShaderObject* CShaderHandler::CreateShaderObject(const std::string& soN
 
 	return so;
 }
+
+
+
+static std::string GetProgramBinaryCacheDir() { return (FileSystem::GetCacheDir() + "/shaders/"); }
+
+std::string CShaderHandler::ProgramBinaryCache::GetFileName(unsigned int hash) const {
+	return (GetProgramBinaryCacheDir() + IntToString(hash, "%08x") + ".bin");
+}
+
+bool CShaderHandler::ProgramBinaryCache::IsEnabled() {
+	if (state >= 0)
+		return (state == 1);
+
+	state = 0;
+
+	if (!configHandler->GetBool("UseShaderBinaryCache"))
+		return false;
+	if (!GLEW_ARB_get_program_binary)
+		return false;
+
+	GLint numFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+
+	// some drivers expose the extension without supporting any format
+	if (numFormats <= 0)
+		return false;
+
+	if (!FileSystem::CreateDirectory(GetProgramBinaryCacheDir()))
+		return false;
+
+	// binaries are only portable between identical driver builds
+	const char* driverStrs[] = {globalRenderingInfo.glVendor, globalRenderingInfo.glRenderer, globalRenderingInfo.glVersion};
+
+	for (const char* str: driverStrs) {
+		if (str != nullptr)
+			driverHash = HsiehHash(str, strlen(str), driverHash);
+	}
+
+	state = 1;
+	return true;
+}
+
+void CShaderHandler::ProgramBinaryCache::SetRetrievable(GLuint progID) {
+	if (!IsEnabled())
+		return;
+
+	glProgramParameteri(progID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+GLuint CShaderHandler::ProgramBinaryCache::Load(unsigned int hash) {
+	if (!IsEnabled())
+		return 0;
+
+	std::ifstream file(dataDirsAccess.LocateFile(GetFileName(hash)), std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+		return 0;
+
+	ProgramBinaryHeader header;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return 0;
+
+	if (std::memcmp(header.magic, BINARY_CACHE_MAGIC, sizeof(BINARY_CACHE_MAGIC)) != 0)
+		return 0;
+	if (header.version != BINARY_CACHE_VERSION || header.driverHash != driverHash || header.srcHash != hash)
+		return 0;
+
+	std::vector<uint8_t> binary(header.binarySize);
+
+	if (binary.empty() || !file.read(reinterpret_cast<char*>(binary.data()), binary.size()))
+		return 0;
+
+	const GLuint progID = glCreateProgram();
+
+	// keeps the binary retrievable should the program's state ever be re-saved
+	glProgramParameteri(progID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glProgramBinary(progID, header.binaryFormat, binary.data(), binary.size());
+
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(progID, GL_LINK_STATUS, &linkStatus);
+
+	// drivers may reject binaries at any time (e.g. after an update); caller recompiles and overwrites
+	if (linkStatus != GL_TRUE) {
+		glDeleteProgram(progID);
+		return 0;
+	}
+
+	return progID;
+}
+
+bool CShaderHandler::ProgramBinaryCache::Save(unsigned int hash, GLuint progID) {
+	if (!IsEnabled())
+		return false;
+
+	GLint binarySize = 0;
+	glGetProgramiv(progID, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+
+	if (binarySize <= 0)
+		return false;
+
+	std::vector<uint8_t> binary(binarySize);
+
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(progID, binarySize, &binarySize, &binaryFormat, binary.data());
+
+	if (binarySize <= 0)
+		return false;
+
+	ProgramBinaryHeader header;
+
+	std::memcpy(header.magic, BINARY_CACHE_MAGIC, sizeof(BINARY_CACHE_MAGIC));
+
+	header.version = BINARY_CACHE_VERSION;
+	header.driverHash = driverHash;
+	header.srcHash = hash;
+	header.binaryFormat = binaryFormat;
+	header.binarySize = binarySize;
+
+	std::ofstream file(dataDirsAccess.LocateFile(GetFileName(hash), FileQueryFlags::WRITE), std::ios::out | std::ios::binary);
+
+	if (!file.is_open()) {
+		LOG_L(L_WARNING, "[SH::PBC::%s] could not write program binary %08x", __func__, hash);
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(binary.data()), binarySize);
+	return file.good();
+}
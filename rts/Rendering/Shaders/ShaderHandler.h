@@ -72,14 +72,46 @@ public:
 		spring::unsynced_map<size_t, GLuint> cache;
 	};
 
+	/**
+	 * On-disk store of linked program binaries (ARB_get_program_binary) in
+	 * the cache-dir, keyed by a hash of the sources and definitions; files
+	 * are only accepted by the driver (vendor, renderer, version) that wrote
+	 * them. Saves the compile and link on every start after the first one.
+	 */
+	struct ProgramBinaryCache {
+	public:
+		bool IsEnabled();
+
+		// hint for glGetProgramBinary, must be set before linking a program that will be saved
+		void SetRetrievable(GLuint progID);
+
+		// returns a new linked program, or 0 if there is no (usable) binary for hash
+		GLuint Load(unsigned int hash);
+		// progID must be linked successfully
+		bool Save(unsigned int hash, GLuint progID);
+
+	private:
+		std::string GetFileName(unsigned int hash) const;
+
+	private:
+		// -1 := not yet checked, 0 := disabled or unsupported, 1 := enabled
+		int state = -1;
+
+		unsigned int driverHash = 0;
+	};
+
 	const ShaderCache& GetShaderCache() const { return shaderCache; }
 	      ShaderCache& GetShaderCache()       { return shaderCache; }
 
+	ProgramBinaryCache& GetProgramBinaryCache() { return programBinaryCache; }
+
 private:
 	// all created programs, by name
 	ProgramTable programObjects;
 	// all (re)loaded program ID's, by hash
 	ShaderCache shaderCache;
+	// linked programs from previous runs, by hash
+	ProgramBinaryCache programBinaryCache;
 };
 
 #define shaderHandler (CShaderHandler::GetInstance(1))
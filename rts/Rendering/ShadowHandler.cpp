@@ -10,6 +10,7 @@
 #include "Map/MapInfo.h"
 #include "Map/ReadMap.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/UniformConstants.h"
 #include "Rendering/Features/FeatureDrawer.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/Units/UnitDrawer.h"
@@ -19,6 +20,7 @@
 #include "Rendering/GL/myGL.h"
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
+#include "Rendering/Textures/S3OTextureHandler.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/Matrix44f.h"
@@ -32,6 +34,7 @@
 CONFIG(int, Shadows).defaultValue(2).headlessValue(-1).minimumValue(-1).safemodeValue(-1).description("Sets whether shadows are rendered.\n-1:=forceoff, 0:=off, 1:=full, 2:=fast (skip terrain)"); //FIXME document bitmask
 CONFIG(int, ShadowMapSize).defaultValue(CShadowHandler::DEF_SHADOWMAP_SIZE).minimumValue(32).description("Sets the resolution of shadows. Higher numbers increase quality at the cost of performance.");
 CONFIG(int, ShadowProjectionMode).defaultValue(CShadowHandler::SHADOWPROMODE_CAM_CENTER);
+CONFIG(int, ShadowCascades).defaultValue(CShadowHandler::MIN_SHADOW_CASCADES).minimumValue(CShadowHandler::MIN_SHADOW_CASCADES).maximumValue(CShadowHandler::MAX_SHADOW_CASCADES).description("Number of shadow-map cascades. 1 renders a single shadow-map, higher values add tighter cascades near the camera for sharper close-up shadows.");
 
 CShadowHandler shadowHandler;
 
@@ -67,12 +70,15 @@ void CShadowHandler::Init()
 	// shadowProMode = configHandler->GetInt("ShadowProjectionMode");
 	shadowProMode = SHADOWPROMODE_CAM_CENTER;
 	shadowGenBits = SHADOWGEN_BIT_NONE;
+	numCascades = configHandler->GetInt("ShadowCascades");
+	curCascade = 0;
 
 	shadowsLoaded = false;
 	inShadowPass = false;
 
 	shadowTexture = 0;
 	dummyColorTexture = 0;
+	cascadeTexture = 0;
 
 	if (!tmpFirstInit && !shadowsSupported)
 		return;
@@ -133,6 +139,15 @@ void CShadowHandler::Init()
 		return;
 	}
 
+	if (numCascades > MIN_SHADOW_CASCADES && !InitCascadeTarget()) {
+		LOG_L(L_WARNING, "[%s] failed to initialize %u-layer cascade texture, falling back to a single shadow-map", __func__, numCascades - 1);
+
+		cascadeFBO.Kill();
+		glDeleteTextures(1, &cascadeTexture); cascadeTexture = 0;
+
+		numCascades = MIN_SHADOW_CASCADES;
+	}
+
 	LoadProjectionMatrix(CCameraHandler::GetCamera(CCamera::CAMTYPE_SHADOW));
 	LoadShadowGenShaders();
 }
@@ -152,6 +167,7 @@ void CShadowHandler::Update()
 
 	SetShadowMapSizeFactors();
 	SetShadowMatrix(playCam, shadCam);
+	SetCascadeMatrices(playCam);
 	SetShadowCamera(shadCam);
 }
 
@@ -162,10 +178,18 @@ void CShadowHandler::FreeTextures() {
 		shadowMapFBO.Unbind();
 	}
 
+	if (cascadeFBO.IsValid()) {
+		cascadeFBO.Bind();
+		cascadeFBO.DetachAll();
+		cascadeFBO.Unbind();
+	}
+
 	shadowMapFBO.Kill();
+	cascadeFBO.Kill();
 
 	glDeleteTextures(1, &shadowTexture    ); shadowTexture     = 0;
 	glDeleteTextures(1, &dummyColorTexture); dummyColorTexture = 0;
+	glDeleteTextures(1, &cascadeTexture   ); cascadeTexture    = 0;
 }
 
 
@@ -261,6 +285,8 @@ void CShadowHandler::LoadShadowGenShaders()
 
 			po->AttachShaderObject(sh->CreateShaderObject("GLSL/ShadowGenVertProgGL4.glsl", shadowGenProgDefines[SHADOWGEN_PROGRAM_MODEL_GL4] + extraDefs, GL_VERTEX_SHADER));
 			po->AttachShaderObject(sh->CreateShaderObject("GLSL/ShadowGenFragProgGL4.glsl", shadowGenProgDefines[SHADOWGEN_PROGRAM_MODEL_GL4] + extraDefs, GL_FRAGMENT_SHADER));
+			po->SetFlag("BINDLESS_MODEL_TEXTURES", int(textureHandlerS3O.UseBindlessTextures()));
+			po->SetFlag("TEX_HANDLES_SSBO_BINDING_IDX", CS3OTextureHandler::TEX_HANDLES_SSBO_BINDING_IDX);
 			po->Link();
 			po->Enable();
 			po->SetUniform("cameraMode", 1);
@@ -347,6 +373,47 @@ bool CShadowHandler::InitDepthTarget()
 }
 
 
+bool CShadowHandler::InitCascadeTarget()
+{
+	// consumers sample the cascades through sampler2DArrayShadow
+	if (!globalRendering->haveGLSL || !GLEW_EXT_texture_array)
+		return false;
+
+	cascadeFBO.Init(false);
+
+	if (!cascadeFBO.IsValid()) {
+		LOG_L(L_ERROR, "[%s] framebuffer not valid", __func__);
+		return false;
+	}
+
+	const GLint depthFormat = static_cast<GLint>(CGlobalRendering::DepthBitsToFormat(globalRendering->supportDepthBufferBitDepth));
+	constexpr float one[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+
+	glGenTextures(1, &cascadeTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, cascadeTexture);
+	glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, one);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// never read raw, so the compare-mode can stay enabled permanently
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_R_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, depthFormat, shadowMapSize, shadowMapSize, numCascades - 1, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	cascadeFBO.Bind();
+	cascadeFBO.AttachTexture(cascadeTexture, GL_TEXTURE_2D_ARRAY, GL_DEPTH_ATTACHMENT_EXT, 0, 0);
+
+	glDrawBuffer(GL_NONE);
+
+	const bool status = cascadeFBO.CheckStatus("SHADOW-CASCADES");
+
+	cascadeFBO.Unbind();
+	return status;
+}
+
+
 bool CShadowHandler::WorkaroundUnsupportedFboRenderTargets()
 {
 	bool status = false;
@@ -450,6 +517,35 @@ void CShadowHandler::DrawShadowPasses()
 	inShadowPass = false;
 }
 
+void CShadowHandler::DrawCascadePasses()
+{
+	if (numCascades <= MIN_SHADOW_CASCADES)
+		return;
+
+	CCamera* shadowCam = CCameraHandler::GetCamera(CCamera::CAMTYPE_SHADOW);
+	UniformConstants& uniformConstants = UniformConstants::GetInstance();
+
+	cascadeFBO.Bind();
+
+	// every cascade sees the full set of passes; models only submit the
+	// objects whose (multi-threaded) cascade-mask test passed, the GPU
+	// culling path re-tests against the cascade matrices in the UBO
+	for (curCascade = MIN_SHADOW_CASCADES; curCascade < numCascades; curCascade++) {
+		cascadeFBO.AttachTexture(cascadeTexture, GL_TEXTURE_2D_ARRAY, GL_DEPTH_ATTACHMENT_EXT, 0, curCascade - 1);
+		glClear(GL_DEPTH_BUFFER_BIT);
+
+		SetShadowCamera(shadowCam, curCascade);
+		uniformConstants.SetShadowMatrices(cascades[curCascade].viewMatrix[SHADOWMAT_TYPE_DRAWING], projMatrix[SHADOWMAT_TYPE_DRAWING]);
+
+		DrawShadowPasses();
+	}
+
+	curCascade = 0;
+
+	uniformConstants.ResetShadowMatrices();
+	SetShadowCamera(shadowCam);
+}
+
 void CShadowHandler::SetShadowMapSizeFactors()
 {
 	#if (SHADOWMATRIX_NONLINEAR == 1)
@@ -498,9 +594,29 @@ static CMatrix44f ComposeScaleMatrix(const float4 scales)
 	return (CMatrix44f(FwdVector * 0.5f, RgtVector / scales.x, UpVector / scales.y, FwdVector / scales.w));
 }
 
+static void ComposeViewMatrices(CMatrix44f* viewMats, const CMatrix44f& lightMatrix, const CMatrix44f& scaleMatrix, const float3& projPos)
+{
+	// see SetShadowMatrix for the rationale behind both forms
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_CULLING].LoadIdentity();
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_CULLING].SetX(lightMatrix.GetX());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_CULLING].SetY(lightMatrix.GetY());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_CULLING].SetZ(lightMatrix.GetZ());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_CULLING].SetPos(projPos);
+
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].LoadIdentity();
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].SetX(lightMatrix.GetX());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].SetY(lightMatrix.GetY());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].SetZ(lightMatrix.GetZ());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].Scale(float3(scaleMatrix[0], scaleMatrix[5], scaleMatrix[10])); // extract (X.x, Y.y, Z.z)
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].Transpose();
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].SetPos(viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING] * -projPos);
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].SetPos(viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].GetPos() + scaleMatrix.GetPos()); // add z-bias
+}
+
 void CShadowHandler::SetShadowMatrix(CCamera* playerCam, CCamera* shadowCam)
 {
-	const CMatrix44f lightMatrix = ComposeLightMatrix(sky->GetLight());
+	lightMatrix = ComposeLightMatrix(sky->GetLight());
+
 	const CMatrix44f scaleMatrix = ComposeScaleMatrix(shadowProjScales = GetShadowProjectionScales(playerCam, lightMatrix));
 
 	#if 0
@@ -530,24 +646,12 @@ void CShadowHandler::SetShadowMatrix(CCamera* playerCam, CCamera* shadowCam)
 	//   we can omit inverting X (does not impact VC) or disable PD face-culling
 	//   or just let objects end up behind znear since InView only tests against
 	//   zfar
-	viewMatrix[SHADOWMAT_TYPE_CULLING].LoadIdentity();
-	viewMatrix[SHADOWMAT_TYPE_CULLING].SetX(lightMatrix.GetX());
-	viewMatrix[SHADOWMAT_TYPE_CULLING].SetY(lightMatrix.GetY());
-	viewMatrix[SHADOWMAT_TYPE_CULLING].SetZ(lightMatrix.GetZ());
-	viewMatrix[SHADOWMAT_TYPE_CULLING].SetPos(projMidPos[2]);
+	//
+	// the drawing form is what shaders need, projection into SM-space is done by
+	// shadow2DProj() (ShadowGenVertProg is a special case, it does not use uniforms)
+	ComposeViewMatrices(&viewMatrix[0], lightMatrix, scaleMatrix, projMidPos[2]);
 	#endif
 
-	// shaders need this form, projection into SM-space is done by shadow2DProj()
-	// note: ShadowGenVertProg is a special case because it does not use uniforms
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].LoadIdentity();
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].SetX(lightMatrix.GetX());
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].SetY(lightMatrix.GetY());
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].SetZ(lightMatrix.GetZ());
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].Scale(float3(scaleMatrix[0], scaleMatrix[5], scaleMatrix[10])); // extract (X.x, Y.y, Z.z)
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].Transpose();
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].SetPos(viewMatrix[SHADOWMAT_TYPE_DRAWING] * -projMidPos[2]);
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].SetPos(viewMatrix[SHADOWMAT_TYPE_DRAWING].GetPos() + scaleMatrix.GetPos()); // add z-bias
-
 
 	#if 0
 	// holds true in the non-KISS case, but needs an epsilon-tolerance equality test
@@ -555,15 +659,75 @@ void CShadowHandler::SetShadowMatrix(CCamera* playerCam, CCamera* shadowCam)
 	#endif
 }
 
-void CShadowHandler::SetShadowCamera(CCamera* shadowCam)
+void CShadowHandler::SetCascadeMatrices(const CCamera* playerCam)
 {
+	if (numCascades <= MIN_SHADOW_CASCADES)
+		return;
+
+	// blend between logarithmic and uniform split distances ("practical" scheme)
+	constexpr float splitLambda = 0.75f;
+	// diameters are rounded up to this to keep texel sizes stable while zooming
+	constexpr float diameterStep = 64.0f;
+
+	const float nearDist = std::max(playerCam->GetNearPlaneDist(), 1.0f);
+	const float farDist = std::max(std::min(playerCam->GetFarPlaneDist(), shadowProjScales.x), nearDist + 1.0f);
+
+	const float tanHalfFovY = playerCam->GetTanHalfFov();
+	const float tanHalfFovX = tanHalfFovY * playerCam->GetAspectRatio();
+	const float sqTanHalfDiag = tanHalfFovX * tanHalfFovX + tanHalfFovY * tanHalfFovY;
+
+	const float3& lightX = lightMatrix.GetX();
+	const float3& lightY = lightMatrix.GetY();
+	const float3& lightZ = lightMatrix.GetZ();
+
+	for (unsigned int i = MIN_SHADOW_CASCADES; i < numCascades; i++) {
+		ShadowCascade& sc = cascades[i];
+
+		const float splitFrac = i / static_cast<float>(numCascades);
+		const float splitDist = mix(nearDist + (farDist - nearDist) * splitFrac, nearDist * std::pow(farDist / nearDist, splitFrac), splitLambda);
+
+		// smallest sphere on the view-axis enclosing the [nearDist, splitDist] slice of the
+		// frustum, its size does not depend on the camera orientation so rotating does not
+		// make the cascade shimmer
+		const float sphereDist = std::min(splitDist, 0.5f * (splitDist + nearDist) * (1.0f + sqTanHalfDiag));
+		const float farRadius = math::sqrt(Square(splitDist - sphereDist) + Square(splitDist) * sqTanHalfDiag);
+		const float nearRadius = math::sqrt(Square(sphereDist - nearDist) + Square(nearDist) * sqTanHalfDiag);
+
+		sc.diameter = std::ceil(2.0f * std::max(farRadius, nearRadius) / diameterStep) * diameterStep;
+		sc.center = playerCam->GetPos() + playerCam->GetDir() * sphereDist;
+
+		{
+			// snap the center to whole texels in light-space so translating does not shimmer
+			const float texelSize = sc.diameter / shadowMapSize;
+			const float cx = std::floor(sc.center.dot(lightX) / texelSize) * texelSize;
+			const float cy = std::floor(sc.center.dot(lightY) / texelSize) * texelSize;
+
+			sc.center = lightX * cx + lightY * cy + lightZ * sc.center.dot(lightZ);
+		}
+
+		// depth range is kept identical to cascade 0 so the same biases apply
+		ComposeViewMatrices(&sc.viewMatrix[0], lightMatrix, ComposeScaleMatrix({sc.diameter, sc.diameter, shadowProjScales.z, shadowProjScales.w}), sc.center);
+	}
+}
+
+void CShadowHandler::SetShadowCamera(CCamera* shadowCam, unsigned int cascadeIdx)
+{
+	const CMatrix44f* viewMats = &viewMatrix[0];
+	float4 projScales = shadowProjScales;
+
+	if (cascadeIdx != 0) {
+		viewMats = &cascades[cascadeIdx].viewMatrix[0];
+		projScales.x = cascades[cascadeIdx].diameter;
+		projScales.y = cascades[cascadeIdx].diameter;
+	}
+
 	// first set matrices needed by shaders (including ShadowGenVertProg)
 	shadowCam->SetProjMatrix(projMatrix[SHADOWMAT_TYPE_DRAWING]);
-	shadowCam->SetViewMatrix(viewMatrix[SHADOWMAT_TYPE_DRAWING]);
+	shadowCam->SetViewMatrix(viewMats[SHADOWMAT_TYPE_DRAWING]);
 
-	shadowCam->SetAspectRatio(shadowProjScales.x / shadowProjScales.y);
+	shadowCam->SetAspectRatio(projScales.x / projScales.y);
 	// convert xy-diameter to radius
-	shadowCam->SetFrustumScales(shadowProjScales * float4(0.5f, 0.5f, 1.0f, 1.0f));
+	shadowCam->SetFrustumScales(projScales * float4(0.5f, 0.5f, 1.0f, 1.0f));
 	shadowCam->UpdateFrustum();
 	shadowCam->UpdateLoadViewPort(0, 0, shadowMapSize, shadowMapSize);
 	// load matrices into gl_{ModelView,Projection}Matrix
@@ -572,10 +736,36 @@ void CShadowHandler::SetShadowCamera(CCamera* shadowCam)
 	// next set matrices needed for SP visibility culling (these
 	// are *NEVER* loaded into gl_{ModelView,Projection}Matrix!)
 	shadowCam->SetProjMatrix(projMatrix[SHADOWMAT_TYPE_CULLING]);
-	shadowCam->SetViewMatrix(viewMatrix[SHADOWMAT_TYPE_CULLING]);
+	shadowCam->SetViewMatrix(viewMats[SHADOWMAT_TYPE_CULLING]);
 	shadowCam->UpdateFrustum();
 }
 
+uint8_t CShadowHandler::GetShadowCascadeMask(const float3& pos, float radius) const
+{
+	// masks are computed by the drawer-data updates which run before Update()
+	// moves the cascades for this frame, pad their extents to cover the lag
+	constexpr float cascadePadding = 1.1f;
+
+	uint8_t cascadeMask = 0;
+
+	for (unsigned int i = MIN_SHADOW_CASCADES; i < numCascades; i++) {
+		const ShadowCascade& sc = cascades[i];
+
+		const float3 relPos = pos - sc.center;
+		const float maxDist = sc.diameter * 0.5f * cascadePadding + radius;
+
+		// orthographic projection, only the light-space XY extent matters
+		if (std::fabs(relPos.dot(lightMatrix.GetX())) > maxDist)
+			continue;
+		if (std::fabs(relPos.dot(lightMatrix.GetY())) > maxDist)
+			continue;
+
+		cascadeMask |= (1 << i);
+	}
+
+	return cascadeMask;
+}
+
 
 void CShadowHandler::SetupShadowTexSampler(unsigned int texUnit, bool enable) const
 {
@@ -615,6 +805,39 @@ void CShadowHandler::ResetShadowTexSamplerRaw() const
 	glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_TEXTURE_MODE, GL_LUMINANCE);
 }
 
+void CShadowHandler::SetupCascadeTexSampler(unsigned int texUnit) const
+{
+	if (numCascades <= MIN_SHADOW_CASCADES)
+		return;
+
+	glActiveTexture(texUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, cascadeTexture);
+}
+
+void CShadowHandler::ResetCascadeTexSampler(unsigned int texUnit) const
+{
+	if (numCascades <= MIN_SHADOW_CASCADES)
+		return;
+
+	glActiveTexture(texUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void CShadowHandler::SetCascadeUniforms(Shader::IProgramObject* po) const
+{
+	static constexpr const char* cascadeMatNames[MAX_SHADOW_CASCADES - 1] = {
+		"shadowCascadeMats[0]",
+		"shadowCascadeMats[1]",
+		"shadowCascadeMats[2]",
+	};
+
+	po->SetUniform("numShadowCascades", static_cast<int>(numCascades));
+
+	for (unsigned int i = MIN_SHADOW_CASCADES; i < numCascades; i++) {
+		po->SetUniformMatrix4x4(cascadeMatNames[i - 1], false, &cascades[i].viewMatrix[SHADOWMAT_TYPE_DRAWING].m[0]);
+	}
+}
+
 
 void CShadowHandler::CreateShadows()
 {
@@ -663,8 +886,10 @@ void CShadowHandler::CreateShadows()
 		}
 	}
 
-	if ((sky->GetLight())->GetLightIntensity() > 0.0f)
+	if ((sky->GetLight())->GetLightIntensity() > 0.0f) {
 		DrawShadowPasses();
+		DrawCascadePasses();
+	}
 
 
 	CCameraHandler::SetActiveCamera(prvCam->GetCamType());
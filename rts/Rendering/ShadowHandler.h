@@ -4,6 +4,7 @@
 #define SHADOW_HANDLER_H
 
 #include <array>
+#include <cstdint>
 
 #include "Rendering/GL/FBO.h"
 #include "System/float4.h"
@@ -17,7 +18,7 @@ class CCamera;
 class CShadowHandler
 {
 public:
-	CShadowHandler(): shadowMapFBO(true) {}
+	CShadowHandler(): shadowMapFBO(true), cascadeFBO(true) {}
 
 	void Init();
 	void Kill();
@@ -48,6 +49,11 @@ public:
 		MAX_SHADOWMAP_SIZE = 16384,
 	};
 
+	enum ShadowCascadeCounts {
+		MIN_SHADOW_CASCADES = 1,
+		MAX_SHADOW_CASCADES = 4,
+	};
+
 	enum ShadowGenProgram {
 		SHADOWGEN_PROGRAM_MODEL      = 0,
 		SHADOWGEN_PROGRAM_MODEL_GL4  = 1,
@@ -80,6 +86,23 @@ public:
 	unsigned int GetShadowTextureID() const { return shadowTexture; }
 	unsigned int GetColorTextureID() const { return dummyColorTexture; }
 
+	// cascade 0 is the regular shadow-map covering the whole shadow-frustum,
+	// cascades 1..N-1 are nested (tightest first) slices of the player view
+	// that live in the layers of a separate depth texture-array
+	unsigned int GetNumCascades() const { return numCascades; }
+	unsigned int GetCurrentCascade() const { return curCascade; }
+	unsigned int GetCascadeTextureID() const { return cascadeTexture; }
+
+	const CMatrix44f& GetCascadeViewMatrix(unsigned int idx) const { return cascades[idx].viewMatrix[SHADOWMAT_TYPE_DRAWING]; }
+
+	// bit N is set if the sphere can cast shadows into cascade N (N >= 1)
+	uint8_t GetShadowCascadeMask(const float3& pos, float radius) const;
+	bool InShadowCascadePass(uint8_t cascadeMask) const { return (curCascade == 0 || (cascadeMask & (1 << curCascade)) != 0); }
+
+	void SetupCascadeTexSampler(unsigned int texUnit) const;
+	void ResetCascadeTexSampler(unsigned int texUnit) const;
+	void SetCascadeUniforms(Shader::IProgramObject* po) const;
+
 	static bool ShadowsInitialized() { return firstInit; }
 	static bool ShadowsSupported() { return shadowsSupported; }
 
@@ -89,15 +112,18 @@ private:
 	void FreeTextures();
 
 	bool InitDepthTarget();
+	bool InitCascadeTarget();
 	bool WorkaroundUnsupportedFboRenderTargets();
 
 	void DrawShadowPasses();
+	void DrawCascadePasses();
 	void LoadProjectionMatrix(const CCamera* shadowCam);
 	void LoadShadowGenShaders();
 
 	void SetShadowMapSizeFactors();
 	void SetShadowMatrix(CCamera* playerCam, CCamera* shadowCam);
-	void SetShadowCamera(CCamera* shadowCam);
+	void SetCascadeMatrices(const CCamera* playerCam);
+	void SetShadowCamera(CCamera* shadowCam, unsigned int cascadeIdx = 0);
 
 	float4 GetShadowProjectionScales(CCamera*, const CMatrix44f&);
 	float3 CalcShadowProjectionPos(CCamera*, float3*);
@@ -112,8 +138,20 @@ public:
 	int shadowProMode;
 
 private:
+	struct ShadowCascade {
+		float3 center;
+		float diameter = 0.0f;
+
+		// same forms as CShadowHandler::viewMatrix
+		CMatrix44f viewMatrix[2];
+	};
+
 	unsigned int shadowTexture;
 	unsigned int dummyColorTexture;
+	unsigned int cascadeTexture = 0;
+
+	unsigned int numCascades = MIN_SHADOW_CASCADES;
+	unsigned int curCascade = 0;
 
 	bool shadowsLoaded = false;
 	bool inShadowPass = false;
@@ -137,8 +175,13 @@ private:
 	// culling and drawing versions of both matrices
 	CMatrix44f projMatrix[2];
 	CMatrix44f viewMatrix[2];
+	CMatrix44f lightMatrix;
+
+	// [0] is unused, cascade 0 is defined by the matrices above
+	std::array<ShadowCascade, MAX_SHADOW_CASCADES> cascades;
 
 	FBO shadowMapFBO;
+	FBO cascadeFBO;
 };
 
 extern CShadowHandler shadowHandler;
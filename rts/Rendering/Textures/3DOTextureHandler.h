@@ -3,6 +3,7 @@
 #ifndef _3DO_TEXTURE_HANDLER_H
 #define _3DO_TEXTURE_HANDLER_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -28,6 +29,8 @@ public:
 	unsigned int GetAtlasTex2ID() const { return atlas3do2; }
 	unsigned int GetAtlasTexSizeX() const { return bigTexX; }
 	unsigned int GetAtlasTexSizeY() const { return bigTexY; }
+	// both atlases are RGBA8 without mipmaps
+	std::uint64_t GetGPUMemFootPrint() const { return (std::uint64_t(bigTexX) * bigTexY * 4 * ((atlas3do1 != 0) + (atlas3do2 != 0))); }
 
 	const spring::unordered_map<std::string, UnitTexture>& GetAtlasTextures() const { return textures; }
 
@@ -46,6 +46,8 @@ public:
 	}
 	void Load(const float* data, size_t size);
 
+	const std::vector<SColor>& GetColors() const { return map; }
+
 private:
 	void LoadMap(const unsigned char* buf, int num);
 
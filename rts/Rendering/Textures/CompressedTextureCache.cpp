@@ -0,0 +1,249 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "CompressedTextureCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#if defined(USE_LIBSQUISH) && !defined(HEADLESS)
+	#include "lib/squish/squish.h"
+#endif
+
+#include "Bitmap.h"
+#include "Game/GameVersion.h"
+#include "Rendering/GL/myGL.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/ILog.h"
+#include "System/Sync/SHA512.hpp"
+#include "System/Threading/ThreadPool.h"
+
+CONFIG(bool, CompressedTextureCache).defaultValue(false).description("Transcode model textures to DXT1/DXT5 in the background and load the cached compressed versions in later runs. Saves VRAM and load time at some loss of texture quality.");
+
+
+#if defined(USE_LIBSQUISH) && !defined(HEADLESS)
+namespace {
+	// bump whenever the transcoder output changes
+	constexpr uint32_t CACHE_FILE_VERSION = 1;
+
+	struct TranscodeJob {
+		std::vector<uint8_t> pixels;
+		std::string fileName;
+
+		int xsize;
+		int ysize;
+	};
+
+
+	const std::string& GetCacheDir()
+	{
+		// empty if the cache is disabled or could not be created
+		static const std::string cacheDir = configHandler->GetBool("CompressedTextureCache")?
+			dataDirsAccess.LocateDir(FileSystem::GetCacheDir() + "/textures/", FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS):
+			"";
+		return cacheDir;
+	}
+
+
+	// 2x2 box filter; odd edges repeat their last row or column
+	void DownsampleRGBA(const std::vector<uint8_t>& src, int srcX, int srcY, std::vector<uint8_t>& dst, int dstX, int dstY)
+	{
+		dst.resize(dstX * dstY * 4);
+
+		for (int y = 0; y < dstY; y++) {
+			const int y0 = std::min(y * 2 + 0, srcY - 1);
+			const int y1 = std::min(y * 2 + 1, srcY - 1);
+
+			for (int x = 0; x < dstX; x++) {
+				const int x0 = std::min(x * 2 + 0, srcX - 1);
+				const int x1 = std::min(x * 2 + 1, srcX - 1);
+
+				for (int c = 0; c < 4; c++) {
+					const int sum =
+						src[(y0 * srcX + x0) * 4 + c] + src[(y0 * srcX + x1) * 4 + c] +
+						src[(y1 * srcX + x0) * 4 + c] + src[(y1 * srcX + x1) * 4 + c];
+
+					dst[(y * dstX + x) * 4 + c] = (sum + 2) / 4;
+				}
+			}
+		}
+	}
+
+	void Transcode(const TranscodeJob& job)
+	{
+		const auto hasAlpha = [&]() {
+			for (size_t i = 3, n = job.pixels.size(); i < n; i += 4) {
+				if (job.pixels[i] != 0xFF)
+					return true;
+			}
+
+			return false;
+		};
+
+		// range-fit is an order of magnitude faster than the default cluster-fit;
+		// these jobs share the pool with the simulation's parallel loops
+		const int flags = (hasAlpha()? squish::kDxt5: squish::kDxt1) | squish::kColourRangeFit;
+
+		std::vector<uint8_t> levelPixels[2];
+		std::vector<uint8_t> blocks;
+
+		// nv_dds halves each dimension down to 1, and so do we
+		int numLevels = 1;
+
+		for (int x = job.xsize, y = job.ysize; x > 1 || y > 1; ) {
+			x = std::max(x >> 1, 1);
+			y = std::max(y >> 1, 1);
+			numLevels += 1;
+		}
+
+		nv_dds::DDS_HEADER ddsh;
+		std::memset(&ddsh, 0, sizeof(ddsh));
+
+		ddsh.dwSize = sizeof(ddsh);
+		ddsh.dwFlags = nv_dds::DDSF_CAPS | nv_dds::DDSF_WIDTH | nv_dds::DDSF_HEIGHT | nv_dds::DDSF_PIXELFORMAT | nv_dds::DDSF_LINEARSIZE | nv_dds::DDSF_MIPMAPCOUNT;
+		ddsh.dwWidth = job.xsize;
+		ddsh.dwHeight = job.ysize;
+		ddsh.dwPitchOrLinearSize = squish::GetStorageRequirements(job.xsize, job.ysize, flags);
+		ddsh.dwMipMapCount = numLevels;
+		ddsh.ddspf.dwSize = sizeof(ddsh.ddspf);
+		ddsh.ddspf.dwFlags = nv_dds::DDSF_FOURCC;
+		ddsh.ddspf.dwFourCC = (flags & squish::kDxt5)? nv_dds::FOURCC_DXT5: nv_dds::FOURCC_DXT1;
+		ddsh.dwCaps1 = nv_dds::DDSF_TEXTURE | ((numLevels > 1)? (nv_dds::DDSF_COMPLEX | nv_dds::DDSF_MIPMAP): 0);
+
+		// write to a temporary first, a crash must not leave a truncated file behind
+		const std::string tmpFileName = job.fileName + ".tmp";
+
+		{
+			std::ofstream file(tmpFileName, std::ios::out | std::ios::binary);
+
+			if (!file.is_open())
+				return;
+
+			file.write("DDS ", 4);
+			file.write(reinterpret_cast<const char*>(&ddsh), sizeof(ddsh));
+
+			const std::vector<uint8_t>* srcPixels = &job.pixels;
+
+			for (int level = 0, x = job.xsize, y = job.ysize; level < numLevels; level++) {
+				blocks.resize(squish::GetStorageRequirements(x, y, flags));
+				squish::CompressImage(srcPixels->data(), x, y, blocks.data(), flags);
+				file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size());
+
+				if ((level + 1) == numLevels)
+					break;
+
+				const int nextX = std::max(x >> 1, 1);
+				const int nextY = std::max(y >> 1, 1);
+
+				DownsampleRGBA(*srcPixels, x, y, levelPixels[level & 1], nextX, nextY);
+
+				srcPixels = &levelPixels[level & 1];
+				x = nextX;
+				y = nextY;
+			}
+
+			if (!file.good()) {
+				LOG_L(L_WARNING, "[CompressedTextureCache::%s] could not write \"%s\"", __func__, tmpFileName.c_str());
+				file.close();
+				std::remove(tmpFileName.c_str());
+				return;
+			}
+		}
+
+		// another job (a texture shared by several models) may have won the race
+		if (std::rename(tmpFileName.c_str(), job.fileName.c_str()) != 0)
+			std::remove(tmpFileName.c_str());
+	}
+}
+
+
+bool CompressedTextureCache::IsEnabled() { return (!GetCacheDir().empty()); }
+
+std::string CompressedTextureCache::GetCacheFileName(const std::string& texName, uint32_t loadFlags)
+{
+	if (!IsEnabled())
+		return "";
+
+	CFileHandler file(texName);
+
+	if (!file.FileExists())
+		return "";
+
+	// the transcoder output also depends on the engine build, e.g. a squish update
+	static const std::string buildTag = SpringVersion::GetFull() + " " + std::to_string(CACHE_FILE_VERSION);
+
+	std::vector<uint8_t> msg(buildTag.begin(), buildTag.end());
+
+	msg.push_back(0);
+	msg.insert(msg.end(), reinterpret_cast<const uint8_t*>(&loadFlags), reinterpret_cast<const uint8_t*>(&loadFlags) + sizeof(loadFlags));
+	msg.resize(msg.size() + file.FileSize());
+
+	if (file.Read(msg.data() + msg.size() - file.FileSize(), file.FileSize()) != file.FileSize())
+		return "";
+
+	uint8_t hash[sha512::SHA_LEN];
+	char hex[8 * 2 + 1];
+
+	sha512::calc_digest(msg.data(), msg.size(), hash);
+
+	for (int i = 0; i < 8; i++) {
+		snprintf(&hex[i * 2], 3, "%02x", hash[i]);
+	}
+
+	return (GetCacheDir() + hex + ".dds");
+}
+
+
+bool CompressedTextureCache::Load(CBitmap& bitmap, const std::string& cacheFileName)
+{
+	if (cacheFileName.empty() || !FileSystem::FileExists(cacheFileName))
+		return false;
+
+	// written unflipped, the rows are in the same order as those of the source bitmap
+	if (!bitmap.ddsimage.load(cacheFileName, false) || bitmap.ddsimage.get_type() != nv_dds::TextureFlat) {
+		bitmap.ddsimage.clear();
+		return false;
+	}
+
+	bitmap.compressed = true;
+	bitmap.textype = GL_TEXTURE_2D;
+	bitmap.xsize = bitmap.ddsimage.get_width();
+	bitmap.ysize = bitmap.ddsimage.get_height();
+	bitmap.channels = bitmap.ddsimage.get_components();
+	return true;
+}
+
+void CompressedTextureCache::Store(const CBitmap& bitmap, const std::string& cacheFileName)
+{
+	if (cacheFileName.empty() || bitmap.compressed)
+		return;
+	if (bitmap.channels != 4 || bitmap.dataType != GL_UNSIGNED_BYTE)
+		return;
+	if (std::max(bitmap.xsize, bitmap.ysize) < MIN_CACHED_TEXTURE_SIZE)
+		return;
+
+	TranscodeJob job;
+
+	job.pixels.assign(bitmap.GetRawMem(), bitmap.GetRawMem() + bitmap.GetMemSize());
+	job.fileName = cacheFileName;
+	job.xsize = bitmap.xsize;
+	job.ysize = bitmap.ysize;
+
+	ThreadPool::Enqueue([](const TranscodeJob& job) { Transcode(job); }, std::move(job));
+}
+
+#else
+
+bool CompressedTextureCache::IsEnabled() { return false; }
+std::string CompressedTextureCache::GetCacheFileName(const std::string& texName, uint32_t loadFlags) { return ""; }
+
+bool CompressedTextureCache::Load(CBitmap& bitmap, const std::string& cacheFileName) { return false; }
+void CompressedTextureCache::Store(const CBitmap& bitmap, const std::string& cacheFileName) {}
+
+#endif
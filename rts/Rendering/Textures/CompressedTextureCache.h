@@ -0,0 +1,36 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COMPRESSED_TEXTURE_CACHE_H
+#define COMPRESSED_TEXTURE_CACHE_H
+
+#include <cstdint>
+#include <string>
+
+class CBitmap;
+
+/**
+ * Keeps DXT1/DXT5 compressed (and mipmapped) versions of decoded textures as
+ * DDS files in the cache directory, keyed by the hash of the source file and
+ * the transformations applied to it after loading. The first run uploads the
+ * texture uncompressed as before and transcodes a copy on a worker thread;
+ * later runs load the DDS instead of decoding the source, which skips the
+ * decode and mipmap generation and cuts upload size and VRAM use by 4-8x.
+ */
+class CompressedTextureCache {
+public:
+	static bool IsEnabled();
+
+	/// cache file of texName (as found on the VFS), empty if there is none or the cache is disabled
+	static std::string GetCacheFileName(const std::string& texName, uint32_t loadFlags);
+
+	/// replaces the contents of bitmap by the cached DDS, false on a miss
+	static bool Load(CBitmap& bitmap, const std::string& cacheFileName);
+	/// transcodes a copy of the (RGBA8) bitmap in the background and writes it to cacheFileName
+	static void Store(const CBitmap& bitmap, const std::string& cacheFileName);
+
+private:
+	// smaller textures gain (almost) nothing, the file lookup costs more
+	static constexpr int MIN_CACHED_TEXTURE_SIZE = 64;
+};
+
+#endif // COMPRESSED_TEXTURE_CACHE_H
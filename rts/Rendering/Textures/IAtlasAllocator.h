@@ -57,6 +57,17 @@ public:
 		return uv;
 	}
 
+	// visits every entry as (name, size, absolute texCoords)
+	template<typename F> void ForEachEntry(F&& func) const {
+		for (const auto& [name, entry]: entries) {
+			func(name, entry.size, entry.texCoords);
+		}
+	}
+
+	// used to restore a cached layout instead of calling Allocate
+	void SetEntryCoords(const std::string& name, const float4& texCoords) { entries[name].texCoords = texCoords; }
+	void SetAtlasSize(const int2 size) { atlasSize = size; }
+
 	bool contains(const std::string& name) const
 	{
 		return (entries.find(name) != entries.end());
@@ -6,10 +6,14 @@
 
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/SimpleParser.h"
+#include "Rendering/GlobalRendering.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Units/UnitDrawer.h"
 #include "Rendering/Models/3DModel.h"
 #include "Rendering/Textures/Bitmap.h"
+#include "Rendering/Textures/CompressedTextureCache.h"
+#include "Rendering/Textures/3DOTextureHandler.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/StringUtil.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
@@ -29,6 +33,8 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_TEXTURE)
 
 #define TEX_MAT_UID(pTxID, sTxID) ((std::uint64_t(pTxID) << 32u) | sTxID)
 
+CONFIG(bool, BindlessModelTextures).defaultValue(false).safemodeValue(false).description("Use ARB_bindless_texture handles for model textures in the GL4 drawers, so the models of all texture-types are drawn in one batch.");
+
 
 // The S3O texture handler uses two textures.
 // The first contains diffuse color (RGB) and teamcolor (A)
@@ -42,15 +48,28 @@ CS3OTextureHandler textureHandlerS3O;
 
 void CS3OTextureHandler::Init()
 {
+	bindless = configHandler->GetBool("BindlessModelTextures") && globalRendering->haveGL4 && GLEW_ARB_bindless_texture;
+
 	textures.reserve(128);
 
-	// dummies
+	// dummies; 3DO models use texture-type 0, their atlas takes its handles
 	textures.emplace_back();
 	textures.emplace_back();
+
+	if (!bindless)
+		return;
+
+	for (S3OTexMat& texture: textures) {
+		texture.tex1Handle = MakeTextureHandleResident(textureHandler3DO.GetAtlasTex1ID());
+		texture.tex2Handle = MakeTextureHandleResident(textureHandler3DO.GetAtlasTex2ID());
+	}
+
+	texHandlesSSBO = VBO{GL_SHADER_STORAGE_BUFFER, false};
 }
 
 void CS3OTextureHandler::Kill()
 {
+	// deleting a texture also releases its handles
 	for (S3OTexMat& texture: textures) {
 		glDeleteTextures(1, &(texture.tex1));
 		glDeleteTextures(1, &(texture.tex2));
@@ -60,10 +79,45 @@ void CS3OTextureHandler::Kill()
 	textureCache.clear();
 	textureTable.clear();
 	bitmapCache.clear();
+
+	texHandlesSSBO = VBO{};
+	numUploadedHandles = 0;
+}
+
+std::uint64_t CS3OTextureHandler::GetMemFootPrint()
+{
+	std::uint64_t memFootPrint = 0;
+
+	cacheMutex.lock();
+	for (const auto& [texName, bitmap]: bitmapCache) {
+		memFootPrint += bitmap.GetMemSize();
+	}
+	cacheMutex.unlock();
+
+	return memFootPrint;
+}
+
+std::uint64_t CS3OTextureHandler::GetGPUMemFootPrint()
+{
+	std::uint64_t memFootPrint = 0;
+
+	cacheMutex.lock();
+	for (const auto& [texName, texData]: textureCache) {
+		if (texData.texID == 0)
+			continue;
+
+		// a full mipmap chain adds a third
+		memFootPrint += ((std::uint64_t(texData.xsize) * texData.ysize * 4 * 4) / 3);
+	}
+	cacheMutex.unlock();
+
+	return memFootPrint;
 }
 
 void CS3OTextureHandler::Reload()
 {
+	bool replacedTextures = false;
+
 	cacheMutex.lock(); //needed?
 	for (auto& [texName, texData] : textureCache) {
 		if (texData.texID == 0)
@@ -79,8 +133,40 @@ void CS3OTextureHandler::Reload()
 			if (texData.invertAxis)
 				bitmap.ReverseYAxis();
 
-			uint32_t newTexId = bitmap.CreateTexture(0.0f, 0.0f, true, texData.texID);
-			assert(newTexId == texData.texID);
+			if (texData.texHandle == 0) {
+				uint32_t newTexId = bitmap.CreateTexture(0.0f, 0.0f, true, texData.texID);
+				assert(newTexId == texData.texID);
+				continue;
+			}
+
+			// textures become immutable once they have a handle, replace them
+			const uint32_t oldTexID = texData.texID;
+
+			texData.texID = bitmap.CreateTexture(0.0f, 0.0f, true);
+			texData.texHandle = MakeTextureHandleResident(texData.texID);
+
+			for (S3OTexMat& texMat: textures) {
+				if (texMat.tex1 == oldTexID) {
+					texMat.tex1 = texData.texID;
+					texMat.tex1Handle = texData.texHandle;
+				}
+				if (texMat.tex2 == oldTexID) {
+					texMat.tex2 = texData.texID;
+					texMat.tex2Handle = texData.texHandle;
+				}
+			}
+
+			glDeleteTextures(1, &oldTexID);
+			replacedTextures = true;
+		}
+	}
+
+	if (replacedTextures) {
+		numUploadedHandles = 0;
+		textureTable.clear();
+
+		for (size_t i = 2; i < textures.size(); i++) {
+			textureTable[TEX_MAT_UID(textures[i].tex1, textures[i].tex2)] = textures[i].num;
 		}
 	}
 	cacheMutex.unlock();
@@ -149,18 +235,29 @@ unsigned int CS3OTextureHandler::LoadAndCacheTexture(
 
 		bitmap = &(iter->second);
 
-		if (!bitmap->Load(textureName) && !bitmap->Load("unittextures/" + textureName)) {
-			if (texNum == 0)
-				LOG_L(L_WARNING, "[%s] could not load primary texture \"%s\" from model \"%s\"", __func__, textureName.c_str(), model->name.c_str());
+		// the cached version already has both inversions applied
+		std::string cacheFileName = CompressedTextureCache::GetCacheFileName(textureName, invertAxis | (invertAlpha << 1));
 
-			// file not found (or headless build), set a single pixel so model is visible
-			bitmap->AllocDummy(SColor(255 * (texNum == 0), 0, 0, 255 * (1 - invertAlpha)));
-		}
+		if (cacheFileName.empty())
+			cacheFileName = CompressedTextureCache::GetCacheFileName("unittextures/" + textureName, invertAxis | (invertAlpha << 1));
+
+		if (!CompressedTextureCache::Load(*bitmap, cacheFileName)) {
+			if (!bitmap->Load(textureName) && !bitmap->Load("unittextures/" + textureName)) {
+				if (texNum == 0)
+					LOG_L(L_WARNING, "[%s] could not load primary texture \"%s\" from model \"%s\"", __func__, textureName.c_str(), model->name.c_str());
 
-		if (invertAxis)
-			bitmap->ReverseYAxis();
-		if (invertAlpha)
-			bitmap->InvertAlpha();
+				// file not found (or headless build), set a single pixel so model is visible
+				bitmap->AllocDummy(SColor(255 * (texNum == 0), 0, 0, 255 * (1 - invertAlpha)));
+				cacheFileName.clear();
+			}
+
+			if (invertAxis)
+				bitmap->ReverseYAxis();
+			if (invertAlpha)
+				bitmap->InvertAlpha();
+
+			CompressedTextureCache::Store(*bitmap, cacheFileName);
+		}
 	}
 
 	const unsigned int texID = preloadCall ? 0 : bitmap->CreateMipMapTexture();
@@ -168,6 +265,7 @@ unsigned int CS3OTextureHandler::LoadAndCacheTexture(
 	if (textureIt != textureCache.end()) {
 		assert(!preloadCall);
 		textureIt->second.texID = texID;
+		textureIt->second.texHandle = bindless? MakeTextureHandleResident(texID): 0;
 	}
 	else {
 		//save main params from the preloadCall pass, such that data is stored correctly for Reload()
@@ -177,7 +275,8 @@ unsigned int CS3OTextureHandler::LoadAndCacheTexture(
 			static_cast<uint32_t>(bitmap->xsize),
 			static_cast<uint32_t>(bitmap->ysize),
 			invertAxis,
-			invertAlpha
+			invertAlpha,
+			0
 		};
 	}
 
@@ -206,9 +305,59 @@ unsigned int CS3OTextureHandler::InsertTextureMat(const S3DModel* model)
 	texMat.tex1SizeY = tex1.ysize;
 	texMat.tex2SizeX = tex2.xsize;
 	texMat.tex2SizeY = tex2.ysize;
+	texMat.tex1Handle = tex1.texHandle;
+	texMat.tex2Handle = tex2.texHandle;
 
 	textureTable[TEX_MAT_UID(texMat.tex1, texMat.tex2)] = texMat.num;
 
 	return texMat.num;
 }
 
+
+std::uint64_t CS3OTextureHandler::MakeTextureHandleResident(unsigned int texID) const
+{
+	if (texID == 0)
+		return 0;
+
+	// the same texture always yields the same handle, which may only be made resident once
+	const std::uint64_t texHandle = glGetTextureHandleARB(texID);
+
+	if (!glIsTextureHandleResidentARB(texHandle))
+		glMakeTextureHandleResidentARB(texHandle);
+
+	return texHandle;
+}
+
+void CS3OTextureHandler::BindTextureHandles()
+{
+	assert(bindless);
+
+	if (numUploadedHandles != textures.size()) {
+		std::vector<std::uint64_t> texHandles;
+		texHandles.reserve(textures.size() * 2);
+
+		for (const S3OTexMat& texMat: textures) {
+			texHandles.push_back(texMat.tex1Handle);
+			texHandles.push_back(texMat.tex2Handle);
+		}
+
+		texHandlesSSBO.Bind();
+
+		if (texHandles.size() * sizeof(std::uint64_t) > texHandlesSSBO.GetSize())
+			texHandlesSSBO.New(texHandles.size() * 2 * sizeof(std::uint64_t), GL_STATIC_DRAW);
+
+		texHandlesSSBO.SetBufferSubData(texHandles);
+		texHandlesSSBO.Unbind();
+
+		numUploadedHandles = textures.size();
+	}
+
+	texHandlesSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, TEX_HANDLES_SSBO_BINDING_IDX, 0, texHandlesSSBO.GetSize());
+}
+
+void CS3OTextureHandler::UnbindTextureHandles() const
+{
+	assert(bindless);
+	texHandlesSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, TEX_HANDLES_SSBO_BINDING_IDX, 0, texHandlesSSBO.GetSize());
+}
+
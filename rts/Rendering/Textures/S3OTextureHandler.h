@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "Bitmap.h"
+#include "Rendering/GL/VBO.h"
 #include "System/Threading/SpringThreading.h"
 #include "System/UnorderedMap.hpp"
 
@@ -27,6 +28,10 @@ public:
 
 		unsigned int tex2SizeX;
 		unsigned int tex2SizeY;
+
+		// resident ARB_bindless_texture handles, 0 unless UseBindlessTextures()
+		std::uint64_t tex1Handle;
+		std::uint64_t tex2Handle;
 	};
 
 	struct CachedS3OTex {
@@ -35,8 +40,13 @@ public:
 		unsigned int ysize;
 		bool invertAxis;
 		bool invertAlpha;
+
+		std::uint64_t texHandle;
 	};
 
+	// matches the binding in the GL4 model and shadow shaders
+	static constexpr unsigned int TEX_HANDLES_SSBO_BINDING_IDX = 8;
+
 	void Init();
 	void Kill();
 	void Reload();
@@ -44,6 +54,22 @@ public:
 	void LoadTexture(S3DModel* model);
 	void PreloadTexture(S3DModel* model, bool invertAxis = false, bool invertAlpha = false);
 
+	/**
+	 * With bindless textures the GL4 model shaders fetch the tex1/tex2 handles
+	 * of each instance's texture-type from an SSBO, so all bins of a model-type
+	 * can be drawn without rebinding textures in between.
+	 */
+	bool UseBindlessTextures() const { return bindless; }
+
+	// uploads handles of newly created texture-types, needs UseBindlessTextures()
+	void BindTextureHandles();
+	void UnbindTextureHandles() const;
+
+	// preloaded bitmaps not yet turned into textures
+	std::uint64_t GetMemFootPrint();
+	// uploaded textures, assuming RGBA8 plus mipmaps (compressed ones are overestimated)
+	std::uint64_t GetGPUMemFootPrint();
+
 public:
 	const S3OTexMat* GetTexture(unsigned int num) {
 		if (num < textures.size())
@@ -62,6 +88,8 @@ private:
 	);
 	unsigned int InsertTextureMat(const S3DModel* model);
 
+	std::uint64_t MakeTextureHandleResident(unsigned int texID) const;
+
 private:
 	typedef spring::unsynced_map<std::string, CachedS3OTex> TextureCache;
 	typedef spring::unsynced_map<std::string, CBitmap> BitmapCache;
@@ -74,6 +102,12 @@ private:
 	spring::mutex cacheMutex;
 
 	std::vector<S3OTexMat> textures;
+
+	VBO texHandlesSSBO;
+	// number of texture-types mirrored in texHandlesSSBO
+	size_t numUploadedHandles = 0;
+
+	bool bindless = false;
 };
 
 extern CS3OTextureHandler textureHandlerS3O;
@@ -10,16 +10,38 @@
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/PBO.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
 #include "System/Exceptions.h"
 #include "System/SafeUtil.h"
+#include "System/Sync/HsiehHash.h"
+#include "System/Threading/ThreadPool.h" // for_mt
 
+#include <algorithm>
 #include <cstring>
+#include <fstream>
 
 CONFIG(int, MaxTextureAtlasSizeX).defaultValue(2048).minimumValue(512).maximumValue(32768);
 CONFIG(int, MaxTextureAtlasSizeY).defaultValue(2048).minimumValue(512).maximumValue(32768);
 
+// bump whenever the layout-file format or an allocator's packing changes
+static constexpr uint32_t LAYOUT_FILE_VERSION = 1;
+static constexpr char LAYOUT_FILE_MAGIC[8] = {'S', 'P', 'R', 'A', 'T', 'L', 'A', 'S'};
+
+struct LayoutFileHeader {
+	char magic[sizeof(LAYOUT_FILE_MAGIC)];
+
+	uint32_t version;
+	uint32_t layoutHash;
+	uint32_t numEntries;
+	int32_t atlasSizeX;
+	int32_t atlasSizeY;
+	int32_t maxMipMaps;
+};
+
 CR_BIND(AtlasedTexture, )
 CR_REG_METADATA(AtlasedTexture, (CR_MEMBER(x), CR_MEMBER(y), CR_MEMBER(z), CR_MEMBER(w)))
 
@@ -128,7 +150,19 @@ bool CTextureAtlas::Finalize()
 	if (initialized && !reloadable)
 		return true;
 
-	const bool success = atlasAllocator->Allocate() && (initialized = CreateTexture());
+	const uint32_t layoutHash = cacheLayout? GetLayoutHash(): 0;
+
+	int maxMipMaps = 0;
+	bool allocated = (cacheLayout && LoadLayout(layoutHash, maxMipMaps));
+
+	if (!allocated && (allocated = atlasAllocator->Allocate())) {
+		maxMipMaps = atlasAllocator->GetMaxMipMaps();
+
+		if (cacheLayout)
+			SaveLayout(layoutHash, maxMipMaps);
+	}
+
+	const bool success = allocated && (initialized = CreateTexture(maxMipMaps));
 
 	if (!reloadable) {
 		memTextures.clear();
@@ -138,15 +172,137 @@ bool CTextureAtlas::Finalize()
 	return success;
 }
 
+
+static std::vector< std::pair<std::string, int2> > GetSortedEntries(const IAtlasAllocator* atlasAllocator)
+{
+	std::vector< std::pair<std::string, int2> > sortedEntries;
+
+	atlasAllocator->ForEachEntry([&](const std::string& name, const int2 size, const float4&) {
+		sortedEntries.emplace_back(name, size);
+	});
+
+	// entries are unordered, the file stores them by name
+	std::sort(sortedEntries.begin(), sortedEntries.end(), [](const auto& a, const auto& b) { return (a.first < b.first); });
+	return sortedEntries;
+}
+
+uint32_t CTextureAtlas::GetLayoutHash() const
+{
+	const int2 maxSize = atlasAllocator->GetMaxSize();
+	const uint32_t npot = globalRendering->supportNonPowerOfTwoTex;
+
+	uint32_t hash = LAYOUT_FILE_VERSION;
+
+	hash = HsiehHash(&allocType, sizeof(allocType), hash);
+	hash = HsiehHash(&maxSize, sizeof(maxSize), hash);
+	hash = HsiehHash(&npot, sizeof(npot), hash);
+
+	for (const auto& [name, size]: GetSortedEntries(atlasAllocator)) {
+		hash = HsiehHash(name.data(), name.size(), hash);
+		hash = HsiehHash(&size, sizeof(size), hash);
+	}
+
+	return hash;
+}
+
+std::string CTextureAtlas::GetLayoutFileName(uint32_t layoutHash) const
+{
+	return (FileSystem::GetCacheDir() + "/atlases/" + name + "-" + IntToString(layoutHash, "%08x") + ".bin");
+}
+
+bool CTextureAtlas::LoadLayout(uint32_t layoutHash, int& maxMipMaps)
+{
+	std::ifstream file(dataDirsAccess.LocateFile(GetLayoutFileName(layoutHash)), std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	const auto& sortedEntries = GetSortedEntries(atlasAllocator);
+
+	LayoutFileHeader header;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+
+	if (std::memcmp(header.magic, LAYOUT_FILE_MAGIC, sizeof(LAYOUT_FILE_MAGIC)) != 0)
+		return false;
+	if (header.version != LAYOUT_FILE_VERSION || header.layoutHash != layoutHash || header.numEntries != sortedEntries.size())
+		return false;
+
+	const int2 maxSize = atlasAllocator->GetMaxSize();
+
+	if (header.atlasSizeX <= 0 || header.atlasSizeX > maxSize.x || header.atlasSizeY <= 0 || header.atlasSizeY > maxSize.y)
+		return false;
+
+	std::vector<float4> texCoords(sortedEntries.size());
+
+	if (!file.read(reinterpret_cast<char*>(texCoords.data()), texCoords.size() * sizeof(float4)))
+		return false;
+
+	// reject anything that does not fit the entry exactly, a fresh allocation is cheap
+	for (size_t i = 0; i < sortedEntries.size(); i++) {
+		const int2 size = sortedEntries[i].second;
+		const float4& tc = texCoords[i];
+
+		if (tc.x1 < 0.0f || tc.y1 < 0.0f || tc.x2 >= header.atlasSizeX || tc.y2 >= header.atlasSizeY)
+			return false;
+		if (int(tc.x2 - tc.x1) + 1 != size.x || int(tc.y2 - tc.y1) + 1 != size.y)
+			return false;
+	}
+
+	for (size_t i = 0; i < sortedEntries.size(); i++) {
+		atlasAllocator->SetEntryCoords(sortedEntries[i].first, texCoords[i]);
+	}
+
+	atlasAllocator->SetAtlasSize({header.atlasSizeX, header.atlasSizeY});
+
+	maxMipMaps = header.maxMipMaps;
+	return true;
+}
+
+bool CTextureAtlas::SaveLayout(uint32_t layoutHash, int maxMipMaps) const
+{
+	if (!FileSystem::CreateDirectory(FileSystem::GetCacheDir() + "/atlases/"))
+		return false;
+
+	std::ofstream file(dataDirsAccess.LocateFile(GetLayoutFileName(layoutHash), FileQueryFlags::WRITE), std::ios::out | std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	std::vector<float4> texCoords;
+	texCoords.reserve(memTextures.size());
+
+	for (const auto& [name, size]: GetSortedEntries(atlasAllocator)) {
+		texCoords.push_back(atlasAllocator->GetEntry(name));
+	}
+
+	const int2 atlasSize = atlasAllocator->GetAtlasSize();
+
+	LayoutFileHeader header;
+
+	std::memcpy(header.magic, LAYOUT_FILE_MAGIC, sizeof(LAYOUT_FILE_MAGIC));
+
+	header.version = LAYOUT_FILE_VERSION;
+	header.layoutHash = layoutHash;
+	header.numEntries = texCoords.size();
+	header.atlasSizeX = atlasSize.x;
+	header.atlasSizeY = atlasSize.y;
+	header.maxMipMaps = maxMipMaps;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(texCoords.data()), texCoords.size() * sizeof(float4));
+	return file.good();
+}
+
 const uint32_t CTextureAtlas::GetTexTarget() const
 {
 	return GL_TEXTURE_2D; // just constant for now
 }
 
-bool CTextureAtlas::CreateTexture()
+bool CTextureAtlas::CreateTexture(int maxMipMaps)
 {
 	const int2 atlasSize = atlasAllocator->GetAtlasSize();
-	const int maxMipMaps = atlasAllocator->GetMaxMipMaps();
 
 	// ATI drivers like to *crash* in glTexImage if x=0 or y=0
 	if (atlasSize.x <= 0 || atlasSize.y <= 0) {
@@ -164,18 +320,29 @@ bool CTextureAtlas::CreateTexture()
 		// make spacing between textures black transparent to avoid ugly lines with linear filtering
 		std::memset(data, 0, atlasSize.x * atlasSize.y * 4);
 
-		for (const MemTex& memTex: memTextures) {
+		std::vector<int2> texPositions(memTextures.size());
+
+		for (size_t i = 0; i < memTextures.size(); ++i) {
+			const MemTex& memTex = memTextures[i];
+
 			const float4 texCoords = atlasAllocator->GetTexCoords(memTex.names[0]);
 			const float4 absCoords = atlasAllocator->GetEntry(memTex.names[0]);
 
-			const int xpos = absCoords.x;
-			const int ypos = absCoords.y;
+			texPositions[i] = {int(absCoords.x), int(absCoords.y)};
 
 			AtlasedTexture tex(texCoords);
 
 			for (const auto& name: memTex.names) {
 				textures[name] = std::move(tex); //make sure textures[name] gets only its guts replaced, so all pointers remain valid
 			}
+		}
+
+		// entries never overlap, so each can be copied into the mapped buffer independently
+		for_mt(0, memTextures.size(), [&](const int i) {
+			const MemTex& memTex = memTextures[i];
+
+			const int xpos = texPositions[i].x;
+			const int ypos = texPositions[i].y;
 
 			for (int y = 0; y < memTex.ysize; ++y) {
 				int* dst = ((int*)           data  ) + xpos + (ypos + y) * atlasSize.x;
@@ -183,7 +350,7 @@ bool CTextureAtlas::CreateTexture()
 
 				memcpy(dst, src, memTex.xsize * 4);
 			}
-		}
+		});
 
 		if (debug) {
 			CBitmap tex(data, atlasSize.x, atlasSize.y);
@@ -64,6 +64,7 @@ public:
 			atlasTexID = ta.atlasTexID;
 			initialized = ta.initialized;
 			freeTexture = ta.freeTexture;
+			cacheLayout = ta.cacheLayout;
 
 			allocType = ta.allocType;
 			atlasSizeX = ta.atlasSizeX;
@@ -134,6 +135,7 @@ public:
 
 	void BindTexture();
 	void SetFreeTexture(bool b) { freeTexture = b; }
+	void SetCacheLayout(bool b) { cacheLayout = b; }
 	void SetName(const std::string& s) { name = s; }
 
 	static void SetDebug(bool b) { debug = b; }
@@ -146,7 +148,14 @@ protected:
 			default: return 32;
 		}
 	}
-	bool CreateTexture();
+	bool CreateTexture(int maxMipMaps);
+
+	// packed layouts are stored in the cache-dir by a hash of the allocator settings and entries
+	uint32_t GetLayoutHash() const;
+	std::string GetLayoutFileName(uint32_t layoutHash) const;
+
+	bool LoadLayout(uint32_t layoutHash, int& maxMipMaps);
+	bool SaveLayout(uint32_t layoutHash, int maxMipMaps) const;
 
 protected:
 	uint32_t allocType;
@@ -196,6 +205,7 @@ protected:
 
 	bool initialized = false;
 	bool freeTexture = true; // free texture on atlas destruction?
+	bool cacheLayout = false; // reuse the packed layout of a previous run?
 
 	// set to true to write finalized texture atlas to disk
 	static inline bool debug = false;
@@ -43,6 +43,8 @@ void UniformConstants::Init()
 
 	umbSBT = IStreamBuffer<UniformMatricesBuffer>::CreateInstance(GL_UNIFORM_BUFFER, 1, "UniformMatricesBuffer");
 	upbSBT = IStreamBuffer<UniformParamsBuffer  >::CreateInstance(GL_UNIFORM_BUFFER, 1, "UniformParamsBuffer"  , IStreamBufferConcept::Types::SB_BUFFERSUBDATA);
+	// rewritten several times per frame, let the driver handle the renaming
+	umbShadowSBT = IStreamBuffer<UniformMatricesBuffer>::CreateInstance(GL_UNIFORM_BUFFER, 1, "UniformShadowMatricesBuffer", IStreamBufferConcept::Types::SB_BUFFERSUBDATA);
 
 	initialized = true;
 }
@@ -57,6 +59,7 @@ void UniformConstants::Kill()
 
 	umbSBT = nullptr;
 	upbSBT = nullptr;
+	umbShadowSBT = nullptr;
 
 	initialized = false;
 }
@@ -208,8 +211,10 @@ void UniformConstants::UpdateMatrices()
 	if (!Supported())
 		return;
 
+	UniformConstants::UpdateMatricesImpl(&umbCache);
+
 	auto umbMap = umbSBT->Map();
-	UniformConstants::UpdateMatricesImpl(umbMap);
+	*umbMap = umbCache;
 	umbSBT->Unmap();
 }
 
@@ -232,4 +237,27 @@ void UniformConstants::Bind()
 
 	umbSBT->BindBufferRange(UBO_MATRIX_IDX);
 	upbSBT->BindBufferRange(UBO_PARAMS_IDX);
+}
+
+void UniformConstants::SetShadowMatrices(const CMatrix44f& shadowView, const CMatrix44f& shadowProj)
+{
+	if (!Supported())
+		return;
+
+	auto umbMap = umbShadowSBT->Map();
+	*umbMap = umbCache;
+	umbMap->shadowView = shadowView;
+	umbMap->shadowProj = shadowProj;
+	umbMap->shadowViewProj = shadowProj * shadowView;
+	umbShadowSBT->Unmap();
+
+	umbShadowSBT->BindBufferRange(UBO_MATRIX_IDX);
+}
+
+void UniformConstants::ResetShadowMatrices()
+{
+	if (!Supported())
+		return;
+
+	umbSBT->BindBufferRange(UBO_MATRIX_IDX);
 }
\ No newline at end of file
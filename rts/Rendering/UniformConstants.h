@@ -99,6 +99,11 @@ public:
 		UpdateParams();
 	}
 	void Bind();
+
+	// temporarily rebinds the matrices with the shadow ones replaced, e.g.
+	// for the shadow-cascade passes; Reset restores the per-frame buffer
+	void SetShadowMatrices(const CMatrix44f& shadowView, const CMatrix44f& shadowProj);
+	void ResetShadowMatrices();
 private:
 	static void UpdateMatricesImpl(UniformMatricesBuffer* updateBuffer);
 	static void UpdateParamsImpl(UniformParamsBuffer* updateBuffer);
@@ -110,6 +115,10 @@ private:
 
 	std::unique_ptr<IStreamBuffer<UniformMatricesBuffer>> umbSBT;
 	std::unique_ptr<IStreamBuffer<UniformParamsBuffer  >> upbSBT;
+	std::unique_ptr<IStreamBuffer<UniformMatricesBuffer>> umbShadowSBT;
+
+	// CPU-side copy of this frame's matrices, the base for SetShadowMatrices
+	UniformMatricesBuffer umbCache;
 
 	bool initialized = false;
 };
@@ -30,6 +30,7 @@
 #include "Rendering/Common/ModelDrawerHelpers.h"
 #include "Rendering/Models/3DModelVAO.h"
 #include "Rendering/Models/ModelsMemStorage.h"
+#include "Rendering/Units/UnitIconBatches.h"
 
 #include "Sim/Features/Feature.h"
 #include "Sim/Misc/LosHandler.h"
@@ -211,6 +212,9 @@ bool CUnitDrawer::ShouldDrawUnitShadow(CUnit* u)
 	if (!u->HasDrawFlag(DrawFlags::SO_SHADOW_FLAG))
 		return false;
 
+	if (!shadowHandler.InShadowCascadePass(u->shadowCascadeMask))
+		return false;
+
 	if (LuaObjectDrawer::AddShadowMaterialObject(u, LUAOBJ_UNIT))
 		return false;
 
@@ -285,6 +289,82 @@ void CUnitDrawerLegacy::DrawUnitTrans(const CUnit* unit, uint32_t preList, uint3
 
 void CUnitDrawerLegacy::DrawUnitMiniMapIcons() const
 {
+	static constexpr uint8_t defaultColor[4] = { 255, 255, 255, 255 };
+
+	const auto GetIconInstance = [](const CUnit* unit) {
+		CUnitIconBatches::IconInstance inst = {{}, {}, SColor{}};
+
+		if (unit->noMinimap)
+			return inst;
+		if (unit->myIcon == nullptr)
+			return inst;
+		if (!unit->drawIcon)
+			return inst;
+		if (unit->IsInVoid())
+			return inst;
+
+		const uint8_t* color = &defaultColor[0];
+
+		if (!unit->isSelected) {
+			if (minimap->UseSimpleColors()) {
+				if (unit->team == gu->myTeam) {
+					color = minimap->GetMyTeamIconColor();
+				}
+				else if (teamHandler.Ally(gu->myAllyTeam, unit->allyteam)) {
+					color = minimap->GetAllyTeamIconColor();
+				}
+				else {
+					color = minimap->GetEnemyTeamIconColor();
+				}
+			}
+			else {
+				color = teamHandler.Team(unit->team)->color;
+			}
+		}
+
+		const float iconScale = CUnitDrawerHelper::GetUnitIconScale(unit);
+		const float3& iconPos = (!gu->spectatingFullView) ?
+			unit->GetObjDrawErrorPos(gu->myAllyTeam) :
+			unit->GetObjDrawMidPos();
+
+		inst.pos = {iconPos.x, iconPos.z};
+		inst.halfSize = {iconScale * minimap->GetUnitSizeX(), iconScale * minimap->GetUnitSizeY()};
+		inst.color = SColor{color};
+		return inst;
+	};
+
+	CUnitIconBatches& iconBatches = CUnitIconBatches::GetInstance();
+
+	if (iconBatches.IsSupported()) {
+		iconBatches.Enable();
+
+		if (!minimap->UseUnitIcons())
+			icon::iconHandler.GetDefaultIconData()->BindTexture();
+
+		for (const auto& [icon, units] : modelDrawerData->GetUnitsByIcon()) {
+			if (icon == nullptr)
+				continue;
+			if (units.empty())
+				continue;
+
+			if (minimap->UseUnitIcons())
+				icon->BindTexture();
+
+			CUnitIconBatches::IconBatch& batch = iconBatches.GetBatch(icon);
+
+			for (size_t i = 0; i < units.size(); i++) {
+				assert(units[i]->myIcon == icon);
+				batch.SetInstance(i, GetIconInstance(units[i]));
+			}
+
+			iconBatches.Draw(batch, units.size());
+		}
+
+		iconBatches.Disable();
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return;
+	}
+
 	static auto& rb = RenderBuffer::GetTypedRenderBuffer<VA_TYPE_2dTC>();
 	assert(rb.AssertSubmission());
 
@@ -293,8 +373,6 @@ void CUnitDrawerLegacy::DrawUnitMiniMapIcons() const
 	sh.Enable();
 	sh.SetUniform("alphaCtrl", 0.0f, 1.0f, 0.0f, 0.0f); // GL_GREATER > 0.0
 
-	static constexpr uint8_t defaultColor[4] = { 255, 255, 255, 255 };
-
 	if (!minimap->UseUnitIcons())
 		icon::iconHandler.GetDefaultIconData()->BindTexture();
 
@@ -310,52 +388,22 @@ void CUnitDrawerLegacy::DrawUnitMiniMapIcons() const
 
 		for (const CUnit* unit : units) {
 			assert(unit->myIcon == icon);
-			if (unit->noMinimap)
-				continue;
-			if (unit->myIcon == nullptr)
-				continue;
-			if (!unit->drawIcon)
-				continue;
-			if (unit->IsInVoid())
-				continue;
 
-			const uint8_t* color = &defaultColor[0];
-
-			if (!unit->isSelected) {
-				if (minimap->UseSimpleColors()) {
-					if (unit->team == gu->myTeam) {
-						color = minimap->GetMyTeamIconColor();
-					}
-					else if (teamHandler.Ally(gu->myAllyTeam, unit->allyteam)) {
-						color = minimap->GetAllyTeamIconColor();
-					}
-					else {
-						color = minimap->GetEnemyTeamIconColor();
-					}
-				}
-				else {
-					color = teamHandler.Team(unit->team)->color;
-				}
-			}
+			const CUnitIconBatches::IconInstance inst = GetIconInstance(unit);
 
-			const float iconScale = CUnitDrawerHelper::GetUnitIconScale(unit);
-			const float3& iconPos = (!gu->spectatingFullView) ?
-				unit->GetObjDrawErrorPos(gu->myAllyTeam) :
-				unit->GetObjDrawMidPos();
-
-			const float iconSizeX = (iconScale * minimap->GetUnitSizeX());
-			const float iconSizeY = (iconScale * minimap->GetUnitSizeY());
+			if (inst.halfSize.x <= 0.0f)
+				continue;
 
-			const float x0 = iconPos.x - iconSizeX;
-			const float x1 = iconPos.x + iconSizeX;
-			const float y0 = iconPos.z - iconSizeY;
-			const float y1 = iconPos.z + iconSizeY;
+			const float x0 = inst.pos.x - inst.halfSize.x;
+			const float x1 = inst.pos.x + inst.halfSize.x;
+			const float y0 = inst.pos.y - inst.halfSize.y;
+			const float y1 = inst.pos.y + inst.halfSize.y;
 
 			rb.AddQuadTriangles(
-				{ x0, y0, 0.0f, 0.0f, color },
-				{ x1, y0, 1.0f, 0.0f, color },
-				{ x1, y1, 1.0f, 1.0f, color },
-				{ x0, y1, 0.0f, 1.0f, color }
+				{ x0, y0, 0.0f, 0.0f, inst.color },
+				{ x1, y0, 1.0f, 0.0f, inst.color },
+				{ x1, y1, 1.0f, 1.0f, inst.color },
+				{ x0, y1, 0.0f, 1.0f, inst.color }
 			);
 		}
 
@@ -1324,19 +1372,40 @@ void CUnitDrawerGL4::DrawObjectsShadow(int modelType) const
 	auto& smv = S3DModelVAO::GetInstance();
 	smv.Bind();
 
-	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
+	static vector<const ObjType*> beingBuilt;
+	beingBuilt.clear();
+
+	const auto SubmitObjects = [&]() {
+		smv.Submit(GL_TRIANGLES, false);
+
+		for (auto* o : beingBuilt) {
+			DrawUnitModelBeingBuiltShadow(o, false);
+		}
+
+		beingBuilt.clear();
+	};
+
+	// with bindless textures all bins can go into one submission
+	const uint32_t numBins = mdlRenderer.GetNumObjectBins();
+	const bool batchBins = textureHandlerS3O.UseBindlessTextures();
+	const bool culledBins = batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, 0, numBins, S3DModelVAO::CULL_PASS_SHADOW, DrawFlags::SO_SHADOW_FLAG);
+
+	for (uint32_t i = 0; i < numBins; i++) {
 		if (mdlRenderer.GetObjectBin(i).empty())
 			continue;
 
-		const auto* texMat = textureHandlerS3O.GetTexture(mdlRenderer.GetObjectBinKey(i));
-		CModelDrawerHelper::modelDrawerHelpers[modelType]->BindShadowTex(texMat);
+		if (!batchBins)
+			CModelDrawerHelper::modelDrawerHelpers[modelType]->BindShadowTex(textureHandlerS3O.GetTexture(mdlRenderer.GetObjectBinKey(i)));
 
 		const auto& bin = mdlRenderer.GetObjectBin(i);
+		auto objs = std::make_pair(bin.cbegin(), bin.cend());
 
-		static vector<const ObjType*> beingBuilt;
-		beingBuilt.clear();
+		if (culledBins || (!batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, i, 1, S3DModelVAO::CULL_PASS_SHADOW, DrawFlags::SO_SHADOW_FLAG)))
+			objs = modelDrawerData->GetCPUDrawnObjects(modelType, mdlRenderer.GetObjectBinKey(i));
+
+		for (auto it = objs.first; it != objs.second; ++it) {
+			auto* o = *it;
 
-		for (auto* o : bin) {
 			if (!ShouldDrawUnitShadow(o))
 				continue;
 
@@ -1348,15 +1417,17 @@ void CUnitDrawerGL4::DrawObjectsShadow(int modelType) const
 			smv.AddToSubmission(o);
 		}
 
-		smv.Submit(GL_TRIANGLES, false);
+		if (batchBins)
+			continue;
 
-		for (auto* o : beingBuilt) {
-			DrawUnitModelBeingBuiltShadow(o, false);
-		}
+		SubmitObjects();
 
 		CModelDrawerHelper::modelDrawerHelpers[modelType]->UnbindShadowTex();
 	}
 
+	if (batchBins)
+		SubmitObjects();
+
 	smv.Unbind();
 }
 
@@ -1375,16 +1446,40 @@ void CUnitDrawerGL4::DrawOpaqueObjects(int modelType, bool drawReflection, bool
 	auto& smv = S3DModelVAO::GetInstance();
 	smv.Bind();
 
-	for (unsigned int i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
+	static vector<const ObjType*> beingBuilt;
+	beingBuilt.clear();
+
+	const auto SubmitObjects = [&]() {
+		smv.Submit(GL_TRIANGLES, false);
+
+		for (auto* o : beingBuilt) {
+			DrawUnitModelBeingBuiltOpaque(o, false);
+		}
+
+		beingBuilt.clear();
+	};
+
+	// with bindless textures all bins can go into one submission
+	const uint32_t numBins = mdlRenderer.GetNumObjectBins();
+	const bool batchBins = textureHandlerS3O.UseBindlessTextures();
+	const bool culledBins = batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, 0, numBins, S3DModelVAO::CULL_PASS_OPAQUE, thisPassMask);
+
+	for (uint32_t i = 0; i < numBins; i++) {
 		if (mdlRenderer.GetObjectBin(i).empty())
 			continue;
 
-		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
+		if (!batchBins)
+			CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
-		static vector<const ObjType*> beingBuilt;
-		beingBuilt.clear();
+		const auto& bin = mdlRenderer.GetObjectBin(i);
+		auto objs = std::make_pair(bin.cbegin(), bin.cend());
+
+		if (culledBins || (!batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, i, 1, S3DModelVAO::CULL_PASS_OPAQUE, thisPassMask)))
+			objs = modelDrawerData->GetCPUDrawnObjects(modelType, mdlRenderer.GetObjectBinKey(i));
+
+		for (auto it = objs.first; it != objs.second; ++it) {
+			auto* o = *it;
 
-		for (auto* o : mdlRenderer.GetObjectBin(i)) {
 			if (!ShouldDrawOpaqueUnit(o, thisPassMask))
 				continue;
 
@@ -1396,13 +1491,13 @@ void CUnitDrawerGL4::DrawOpaqueObjects(int modelType, bool drawReflection, bool
 			smv.AddToSubmission(o);
 		}
 
-		smv.Submit(GL_TRIANGLES, false);
-
-		for (auto* o : beingBuilt) {
-			DrawUnitModelBeingBuiltOpaque(o, false);
-		}
+		if (!batchBins)
+			SubmitObjects();
 	}
 
+	if (batchBins)
+		SubmitObjects();
+
 	smv.Unbind();
 }
 
@@ -1421,25 +1516,41 @@ void CUnitDrawerGL4::DrawAlphaObjects(int modelType, bool drawReflection, bool d
 	//some magical constant that equalizes alpha with GLSL drawer, the origin of this difference is unknown
 	modelDrawerState->SetColorMultiplier(0.6f);
 	modelDrawerState->SetTeamColor(0, IModelDrawerState::alphaValues.x); //teamID doesn't matter here
+	// with bindless textures all bins can go into one submission
+	const uint32_t numBins = mdlRenderer.GetNumObjectBins();
+	const bool batchBins = textureHandlerS3O.UseBindlessTextures();
+	const bool culledBins = batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, 0, numBins, S3DModelVAO::CULL_PASS_ALPHA, thisPassMask);
+
 	//main cloaked alpha pass
-	for (uint32_t i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
+	for (uint32_t i = 0; i < numBins; i++) {
 		if (mdlRenderer.GetObjectBin(i).empty())
 			continue;
 
-		CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
+		if (!batchBins)
+			CModelDrawerHelper::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
 		const auto& bin = mdlRenderer.GetObjectBin(i);
+		auto objs = std::make_pair(bin.cbegin(), bin.cend());
+
+		if (culledBins || (!batchBins && modelDrawerData->gpuCulling && smv.SubmitCulled(cullSets[modelType], mdlRenderer, i, 1, S3DModelVAO::CULL_PASS_ALPHA, thisPassMask)))
+			objs = modelDrawerData->GetCPUDrawnObjects(modelType, mdlRenderer.GetObjectBinKey(i));
+
+		for (auto it = objs.first; it != objs.second; ++it) {
+			auto* o = *it;
 
-		for (auto* o : bin) {
 			if (!ShouldDrawAlphaUnit(o, thisPassMask))
 				continue;
 
 			smv.AddToSubmission(o);
 		}
 
-		smv.Submit(GL_TRIANGLES, false);
+		if (!batchBins)
+			smv.Submit(GL_TRIANGLES, false);
 	}
 
+	if (batchBins)
+		smv.Submit(GL_TRIANGLES, false);
+
 	// void CGLUnitDrawer::DrawGhostedBuildings(int modelType)
 	if (gu->spectatingFullView)
 		return;
@@ -9,6 +9,7 @@
 #include "Rendering/Common/ModelDrawerState.hpp"
 #include "Rendering/Units/UnitDrawerData.h"
 #include "Rendering/GL/LightHandler.h"
+#include "Rendering/Models/3DModelVAO.h"
 #include "Game/UI/CursorIcons.h"
 #include "System/type2.h"
 #include "Sim/Units/CommandAI/Command.h"
@@ -56,6 +57,8 @@ public:
 	static void AddTempDrawUnit(const CUnitDrawerData::TempDrawUnit& tempDrawUnit) { modelDrawerData->AddTempDrawUnit(tempDrawUnit); }
 
 	static const std::vector<CUnit*>& GetUnsortedUnits() { return modelDrawerData->GetUnsortedObjects(); }
+	static bool HasViewCullRadii(const CCamera* cam) { return modelDrawerData->HasViewCullRadii(cam); }
+	static uint32_t GetViewCullStamp() { return modelDrawerData->GetViewCullStamp(); }
 public:
 	// DrawUnit*
 	virtual void DrawUnitNoTrans(const CUnit* unit, uint32_t preList, uint32_t postList, bool lodCall, bool noLuaCall) const = 0;
@@ -238,6 +241,8 @@ protected:
 
 	void DrawUnitModelBeingBuiltShadow(const CUnit* unit, bool noLuaCall) const;
 	void DrawUnitModelBeingBuiltOpaque(const CUnit* unit, bool noLuaCall) const;
+private:
+	mutable std::array<S3DModelCullSet, MODELTYPE_CNT> cullSets;
 };
 
 #define unitDrawer (CUnitDrawer::modelDrawer)
\ No newline at end of file
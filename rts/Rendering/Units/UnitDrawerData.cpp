@@ -8,12 +8,15 @@
 #include "Game/Game.h"
 #include "Game/GameSetup.h"
 #include "Game/GlobalUnsynced.h"
+#include "Game/Players/Player.h"
 #include "Game/Camera.h"
 #include "Game/CameraHandler.h"
 #include "Game/UI/MiniMap.h"
 #include "Rendering/Common/ModelDrawerHelpers.h"
+#include "Rendering/GL/HiZPyramid.h"
 #include "Rendering/Units/UnitDrawer.h"
 #include "Rendering/LuaObjectDrawer.h"
+#include "Lua/LuaObjectMaterial.h"
 #include "Rendering/IconHandler.h"
 #include "Rendering/Textures/Bitmap.h"
 #include "Rendering/Env/IGroundDecalDrawer.h"
@@ -138,6 +141,21 @@ void CUnitDrawerData::Update()
 	UpdateCommon();
 }
 
+bool CUnitDrawerData::IsCPUDrawn(const CUnit* co) const
+{
+	if (co->HasDrawFlag(DrawFlags::SO_FARTEX_FLAG))
+		return true;
+
+	if (co->beingBuilt && co->unitDef->showNanoFrame)
+		return true;
+
+	if (co->GetLuaMaterialData()->Enabled())
+		return true;
+
+	// skipped by ShouldDrawOpaqueUnit outside of reflection passes
+	return (co == (gu->GetMyPlayer())->fpsController.GetControllee());
+}
+
 void CUnitDrawerData::UpdateGhostedBuildings()
 {
 	for (int allyTeam = 0; allyTeam < deadGhostBuildings.size(); ++allyTeam) {
@@ -338,6 +356,9 @@ void CUnitDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 		switch (camType)
 		{
 			case CCamera::CAMTYPE_PLAYER: {
+				if (GL::HiZPyramid::GetInstance().IsOccluded(cam, u->drawMidPos, u->GetDrawRadius(), GL::HiZPyramid::OBJ_TYPE_UNIT))
+					continue;
+
 				const float sqrCamDist = (u->drawPos - cam->GetPos()).SqLength();
 				const float farTexDist = Square(u->GetDrawRadius() + CModelDrawerDataConcept::modelDrawDist);
 				if (sqrCamDist >= farTexDist) {
@@ -372,6 +393,7 @@ void CUnitDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 					continue;
 
 				u->AddDrawFlag(DrawFlags::SO_SHADOW_FLAG);
+				u->shadowCascadeMask = shadowHandler.GetShadowCascadeMask(u->drawMidPos, u->GetDrawRadius());
 			} break;
 
 			default: { assert(false); } break;
@@ -96,6 +96,7 @@ public:
 public:
 	void Update() override;
 	bool IsAlpha(const CUnit* co) const override { return co->IsCloaked(); }
+	bool IsCPUDrawn(const CUnit* co) const override;
 public:
 	void AddTempDrawUnit(const TempDrawUnit& tempDrawUnit);
 
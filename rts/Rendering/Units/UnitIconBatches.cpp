@@ -0,0 +1,123 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "UnitIconBatches.h"
+
+#include <cstddef>
+
+#include "Rendering/GL/myGL.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "Rendering/Shaders/Shader.h"
+#include "System/Log/ILog.h"
+
+
+bool CUnitIconBatches::IsSupported()
+{
+	if (state >= 0)
+		return (state > 0);
+
+	state = 0;
+
+	if (!VAO::IsSupported() || !GLEW_ARB_instanced_arrays || !GLEW_ARB_draw_instanced || !GLEW_ARB_explicit_attrib_location)
+		return false;
+
+	if (!InitShader()) {
+		LOG_L(L_WARNING, "[UnitIconBatches::%s] icon shader failed to compile, minimap icons are drawn without instancing", __func__);
+		return false;
+	}
+
+	state = 1;
+	return true;
+}
+
+bool CUnitIconBatches::InitShader()
+{
+	shader = shaderHandler->CreateProgramObject("[UnitIconBatches]", "MiniMapIcons", false);
+	shader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/MiniMapIconsVertProg.glsl", "", GL_VERTEX_SHADER));
+	shader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/MiniMapIconsFragProg.glsl", "", GL_FRAGMENT_SHADER));
+	shader->Link();
+	shader->Enable();
+	shader->SetUniform("iconTex", 0);
+	shader->Disable();
+	shader->Validate();
+
+	return (shader->IsValid());
+}
+
+void CUnitIconBatches::Kill()
+{
+	batches.clear();
+
+	if (shader != nullptr)
+		shaderHandler->ReleaseProgramObjects("[UnitIconBatches]");
+
+	shader = nullptr;
+	state = -1;
+}
+
+void CUnitIconBatches::Enable() const
+{
+	assert(shader != nullptr);
+	shader->Enable();
+}
+
+void CUnitIconBatches::Disable() const
+{
+	shader->Disable();
+}
+
+void CUnitIconBatches::Draw(IconBatch& batch, size_t numInstances)
+{
+	numInstances = std::min(numInstances, batch.instances.size());
+
+	if (numInstances == 0)
+		return;
+
+	if (batch.vao.GetIdRaw() == 0) {
+		batch.instVBO = VBO{GL_ARRAY_BUFFER, false};
+
+		batch.vao.Bind();
+		batch.instVBO.Bind();
+
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glVertexAttribDivisor(0, 1);
+		glVertexAttribDivisor(1, 1);
+		glVertexAttribPointer(0, 4, GL_FLOAT        , false, sizeof(IconInstance), (const void*)offsetof(IconInstance, pos  ));
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, true , sizeof(IconInstance), (const void*)offsetof(IconInstance, color));
+
+		batch.vao.Unbind();
+		batch.instVBO.Unbind();
+
+		glDisableVertexAttribArray(0);
+		glDisableVertexAttribArray(1);
+		glVertexAttribDivisor(0, 0);
+		glVertexAttribDivisor(1, 0);
+
+		// force a full upload into the new buffer
+		batch.dirtyBeg = 0;
+		batch.dirtyEnd = batch.instances.size();
+	}
+
+	if (batch.dirtyBeg < batch.dirtyEnd) {
+		batch.instVBO.Bind();
+
+		// grow along with the vector, the VAO keeps pointing at the same buffer object
+		if (batch.instVBO.GetSize() < batch.instances.size() * sizeof(IconInstance)) {
+			batch.instVBO.New(batch.instances.capacity() * sizeof(IconInstance), GL_DYNAMIC_DRAW);
+
+			batch.dirtyBeg = 0;
+			batch.dirtyEnd = batch.instances.size();
+		}
+
+		batch.instVBO.SetBufferSubData(batch.dirtyBeg * sizeof(IconInstance), (batch.dirtyEnd - batch.dirtyBeg) * sizeof(IconInstance), &batch.instances[batch.dirtyBeg]);
+
+		batch.instVBO.Unbind();
+
+		batch.dirtyBeg = batch.instances.size();
+		batch.dirtyEnd = 0;
+	}
+
+	batch.vao.Bind();
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, numInstances);
+	batch.vao.Unbind();
+}
@@ -0,0 +1,96 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _UNIT_ICON_BATCHES_H_
+#define _UNIT_ICON_BATCHES_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Rendering/GL/VAO.h"
+#include "Rendering/GL/VBO.h"
+#include "System/Color.h"
+#include "System/type2.h"
+#include "System/UnorderedMap.hpp"
+
+namespace icon {
+	class CIconData;
+}
+namespace Shader {
+	struct IProgramObject;
+}
+
+/**
+ * Persistent per-icon instance buffers for the minimap unit icons. Every icon
+ * keeps the instances of its units from the previous frame, so only the slots
+ * of units that moved or changed color, size or visibility are re-uploaded and
+ * each icon costs a single instanced draw instead of a rebuilt set of quads.
+ */
+class CUnitIconBatches {
+public:
+	struct IconInstance {
+		float2 pos;      // top-down world-space {x, z}
+		float2 halfSize; // zero for units that are not drawn this frame
+		SColor color;
+	};
+
+	struct IconBatch {
+	public:
+		// slots are the indices of the units in their icon's unit list
+		void SetInstance(size_t slot, const IconInstance& inst) {
+			if (slot >= instances.size())
+				instances.resize(slot + 1, IconInstance{{}, {}, SColor{}});
+
+			if (std::memcmp(&instances[slot], &inst, sizeof(IconInstance)) == 0)
+				return;
+
+			instances[slot] = inst;
+
+			dirtyBeg = std::min(dirtyBeg, slot);
+			dirtyEnd = std::max(dirtyEnd, slot + 1);
+		}
+
+	private:
+		friend class CUnitIconBatches;
+
+		std::vector<IconInstance> instances;
+
+		size_t dirtyBeg = 0;
+		size_t dirtyEnd = 0;
+
+		VBO instVBO;
+		VAO vao;
+	};
+
+public:
+	static CUnitIconBatches& GetInstance() {
+		static CUnitIconBatches instance;
+		return instance;
+	}
+
+	bool IsSupported();
+
+	void Kill();
+
+	IconBatch& GetBatch(const icon::CIconData* icon) { return batches[icon]; }
+
+	// uploads the dirty slots and draws the first <numInstances>; icon texture and matrices must be set up
+	void Draw(IconBatch& batch, size_t numInstances);
+
+	void Enable() const;
+	void Disable() const;
+
+private:
+	bool InitShader();
+
+private:
+	// -1 := not yet tried, 0 := unsupported or failed to compile, 1 := ok
+	int state = -1;
+
+	Shader::IProgramObject* shader = nullptr;
+
+	spring::unordered_map<const icon::CIconData*, IconBatch> batches;
+};
+
+#endif // _UNIT_ICON_BATCHES_H_
@@ -13,11 +13,14 @@
 #include "Rendering/CommandDrawer.h"
 #include "Rendering/DebugColVolDrawer.h"
 #include "Rendering/FarTextureHandler.h"
+#include "Rendering/GL/GPUTimerQueries.h"
+#include "Rendering/GL/HiZPyramid.h"
 #include "Rendering/LineDrawer.h"
 #include "Rendering/LuaObjectDrawer.h"
 #include "Rendering/Features/FeatureDrawer.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/Units/UnitDrawer.h"
+#include "Rendering/Units/UnitIconBatches.h"
 #include "Rendering/IPathDrawer.h"
 #include "Rendering/SmoothHeightMeshDrawer.h"
 #include "Rendering/InMapDrawView.h"
@@ -152,6 +155,10 @@ void CWorldDrawer::Kill()
 	spring::SafeDelete(farTextureHandler);
 	spring::SafeDelete(heightMapTexture);
 
+	GL::HiZPyramid::GetInstance().Kill();
+	GL::GPUTimerQueries::GetInstance().Kill();
+	CUnitIconBatches::GetInstance().Kill();
+
 	textureHandler3DO.Kill();
 	textureHandlerS3O.Kill();
 
@@ -179,6 +186,7 @@ void CWorldDrawer::Update(bool newSimFrame)
 	// (it updates unitdrawpos which is used for maximized minimap too)
 	// unitDrawer->Update();
 	// lineDrawer.UpdateLineStipple();
+	GL::HiZPyramid::GetInstance().Fetch();
 	CUnitDrawer::UpdateStatic();
 	CFeatureDrawer::UpdateStatic();
 	IWater::ApplyPushedChanges(game);
@@ -208,6 +216,7 @@ void CWorldDrawer::GenerateIBLTextures() const
 
 	if (shadowHandler.ShadowsLoaded()) {
 		SCOPED_TIMER("Draw::World::CreateShadows");
+		SCOPED_GPU_TIMER("Draw::World::CreateShadows");
 
 		game->SetDrawMode(CGame::gameShadowDraw);
 		shadowHandler.CreateShadows();
@@ -259,6 +268,7 @@ void CWorldDrawer::ResetMVPMatrices() const
 void CWorldDrawer::Draw() const
 {
 	SCOPED_TIMER("Draw::World");
+	SCOPED_GPU_TIMER("Draw::World");
 
 	glClearColor(sky->fogColor[0], sky->fogColor[1], sky->fogColor[2], 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
@@ -270,13 +280,17 @@ void CWorldDrawer::Draw() const
 
 	camera->Update();
 
-	sky->Draw();
+	{
+		SCOPED_GPU_TIMER("Draw::World::Sky");
+		sky->Draw();
+	}
 
 	DrawOpaqueObjects();
 	DrawAlphaObjects();
 
 	{
 		SCOPED_TIMER("Draw::World::Projectiles");
+		SCOPED_GPU_TIMER("Draw::World::Projectiles");
 		projectileDrawer->Draw(false);
 	}
 
@@ -284,6 +298,7 @@ void CWorldDrawer::Draw() const
 
 	{
 		SCOPED_TIMER("Draw::World::DrawWorld");
+		SCOPED_GPU_TIMER("Draw::World::DrawWorld");
 		eventHandler.DrawWorld();
 	}
 
@@ -301,15 +316,23 @@ void CWorldDrawer::DrawOpaqueObjects() const
 	if (globalRendering->drawGround) {
 		{
 			SCOPED_TIMER("Draw::World::Terrain");
+			SCOPED_GPU_TIMER("Draw::World::Terrain");
 			gd->Draw(DrawPass::Normal);
 		}
+		{
+			// terrain-only depth, tested against by the next frames' drawer data updates
+			SCOPED_TIMER("Draw::World::HiZPyramid");
+			GL::HiZPyramid::GetInstance().Capture(camera);
+		}
 		{
 			SCOPED_TIMER("Draw::World::Decals");
+			SCOPED_GPU_TIMER("Draw::World::Decals");
 			groundDecals->Draw();
 			projectileDrawer->DrawGroundFlashes();
 		}
 		{
 			SCOPED_TIMER("Draw::World::Foliage");
+			SCOPED_GPU_TIMER("Draw::World::Foliage");
 			grassDrawer->Draw();
 		}
 		smoothHeightMeshDrawer->Draw(1.0f);
@@ -321,12 +344,22 @@ void CWorldDrawer::DrawOpaqueObjects() const
 	}
 
 	selectedUnitsHandler.Draw();
-	eventHandler.DrawWorldPreUnit();
+
+	{
+		SCOPED_GPU_TIMER("Draw::World::DrawWorldPreUnit");
+		eventHandler.DrawWorldPreUnit();
+	}
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Opaque");
-		unitDrawer->Draw(false);
-		featureDrawer->Draw(false);
+		{
+			SCOPED_GPU_TIMER("Draw::World::Models::Opaque::Units");
+			unitDrawer->Draw(false);
+		}
+		{
+			SCOPED_GPU_TIMER("Draw::World::Models::Opaque::Features");
+			featureDrawer->Draw(false);
+		}
 
 		DebugColVolDrawer::Draw();
 		pathDrawer->DrawAll();
@@ -344,6 +377,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Alpha");
+		SCOPED_GPU_TIMER("Draw::World::Models::Alpha");
 		// clip in model-space
 		glPushMatrix();
 		glLoadIdentity();
@@ -361,6 +395,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 	// draw water (in-between)
 	if (globalRendering->drawWater && !mapRendering->voidWater) {
 		SCOPED_TIMER("Draw::World::Water");
+		SCOPED_GPU_TIMER("Draw::World::Water");
 
 		water->UpdateWater(game);
 		water->Draw();
@@ -368,6 +403,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Alpha");
+		SCOPED_GPU_TIMER("Draw::World::Models::Alpha");
 		glPushMatrix();
 		glLoadIdentity();
 		glClipPlane(GL_CLIP_PLANE3, abovePlaneEq);
@@ -34,6 +34,7 @@ CR_BIND_DERIVED_POOL(CFeature, CSolidObject, , featureMemPool.allocMem, featureM
 CR_REG_METADATA(CFeature, (
 	CR_MEMBER(isRepairingBeforeResurrect),
 	CR_MEMBER(inUpdateQue),
+	CR_MEMBER(atRest),
 	CR_MEMBER(deleteMe),
 	CR_MEMBER(alphaFade),
 
@@ -468,6 +469,9 @@ void CFeature::ForcedMove(const float3& newPos)
 	Move(newPos - pos, true);
 	Block();
 
+	// let physics run again if still in the update-queue
+	atRest = false;
+
 	// ForcedMove calls might cause the pstate to go stale
 	// (features are only Update()'d when in the FH queue)
 	UpdateTransformAndPhysState();
@@ -597,7 +601,11 @@ bool CFeature::UpdatePosition()
 
 bool CFeature::Update()
 {
-	bool continueUpdating = UpdatePosition();
+	bool continueUpdating = false;
+
+	// a settled feature only moves again after being woken
+	if (!atRest)
+		atRest = !(continueUpdating = UpdatePosition());
 
 	continueUpdating |= (smokeTime != 0);
 	continueUpdating |= (fireTime != 0);
@@ -115,6 +115,8 @@ public:
 	 */
 	bool isRepairingBeforeResurrect = false;
 	bool inUpdateQue = false;
+	/// physics settled, Update only runs the smoke/fire/geo timers until woken
+	bool atRest = false;
 	bool deleteMe = false;
 	bool alphaFade = true; // unsynced
 
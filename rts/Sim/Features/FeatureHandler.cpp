@@ -242,6 +242,8 @@ bool CFeatureHandler::UpdateFeature(CFeature* feature)
 
 void CFeatureHandler::SetFeatureUpdateable(CFeature* feature)
 {
+	feature->atRest = false;
+
 	if (feature->inUpdateQue) {
 		assert(std::find(updateFeatures.begin(), updateFeatures.end(), feature) != updateFeatures.end());
 		return;
@@ -262,6 +264,12 @@ void CFeatureHandler::TerrainChanged(int x1, int y1, int x2, int y2)
 
 	for (const int qi: *qfQuery.quads) {
 		for (CFeature* f: quadField.GetQuad(qi).features) {
+			// quads are much larger than most changed areas, skip features not touching it
+			if ((f->pos.x + f->radius) < mins.x || (f->pos.x - f->radius) > maxs.x)
+				continue;
+			if ((f->pos.z + f->radius) < mins.z || (f->pos.z - f->radius) > maxs.z)
+				continue;
+
 			// put this feature back in the update-queue
 			SetFeatureUpdateable(f);
 		}
@@ -52,6 +52,7 @@ public:
 	CFeature* LoadFeature(const FeatureLoadParams& params);
 	CFeature* CreateWreckage(const FeatureLoadParams& params);
 	CFeature* GetFeature(unsigned int id) { return ((id < features.size())? features[id]: nullptr); }
+	unsigned int GetMaxFeatures() const { return features.size(); }
 
 	void Update();
 
@@ -67,6 +68,10 @@ public:
 
 	const spring::unordered_set<int>& GetActiveFeatureIDs() const { return activeFeatureIDs; }
 
+	/// features in the update-queue (moving, burning, smoking, ...), the rest cost nothing per frame
+	unsigned int GetNumUpdatingFeatures() const { return updateFeatures.size(); }
+	unsigned int GetNumStaticFeatures() const { return (activeFeatureIDs.size() - updateFeatures.size()); }
+
 private:
 	bool CanAddFeature(int id) const {
 		// do we want to be assigned a random ID and are any left in pool?
@@ -9,14 +9,121 @@
 #include "Sim/Objects/SolidObject.h"
 #include "System/Matrix44f.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 
-unsigned int CCollisionHandler::numDiscTests = 0;
-unsigned int CCollisionHandler::numContTests = 0;
+#include <array>
+#include <xmmintrin.h>
+
+// per-thread, projectile hit-tests are detected on workers (see CProjectileHandler)
+struct alignas(64) HitTestCounters {
+	unsigned int numDiscTests = 0; // number of discrete hit-tests executed
+	unsigned int numContTests = 0; // number of continuous hit-tests executed (inc. unsynced)
+};
+
+static std::array<HitTestCounters, ThreadPool::MAX_THREADS> hitTestCounters;
+
+
+// std::min and std::max semantics (incl. NaN operands), unlike _mm_{min,max}_ps
+static inline __m128 SelectMin(__m128 a, __m128 b) { const __m128 m = _mm_cmplt_ps(b, a); return (_mm_or_ps(_mm_and_ps(m, b), _mm_andnot_ps(m, a))); }
+static inline __m128 SelectMax(__m128 a, __m128 b) { const __m128 m = _mm_cmplt_ps(a, b); return (_mm_or_ps(_mm_and_ps(m, b), _mm_andnot_ps(m, a))); }
+
+// a += (x*b + y*c + z*d) with the scalar evaluation order of CMatrix44f::Translate
+static inline __m128 MulAdd3(__m128 x, __m128 b, __m128 y, __m128 c, __m128 z, __m128 d) {
+	return (_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, b), _mm_mul_ps(y, c)), _mm_mul_ps(z, d)));
+}
+
+/*
+ * Performs the bounding-box rejection test at the top of Intersect(v, m, p0, p1, q)
+ * for four volumes at once, lane i corresponding to matrix mats[i] (which is the
+ * caller's object-transform, *not* yet translated by <offs0> and <offs1> here) and
+ * half-scales hs[i]. Every operation mirrors the scalar Translate, InvertAffine and
+ * Mul(float3) sequence so each lane yields bit-identical intermediates; returns the
+ * lane-mask of volumes that the segment certainly misses.
+ */
+__FORCE_ALIGN_STACK__
+static int RejectSegmentBoxes4(
+	const CMatrix44f* mats,
+	const float3* offs0,
+	const float3* offs1,
+	const float3* hs,
+	const float3 p0,
+	const float3 p1
+) {
+	#define LANES(expr) _mm_setr_ps(mats[0].expr, mats[1].expr, mats[2].expr, mats[3].expr)
+	const __m128 m0 = LANES(m[0]), m1 = LANES(m[1]), m2  = LANES(m[ 2]);
+	const __m128 m4 = LANES(m[4]), m5 = LANES(m[5]), m6  = LANES(m[ 6]);
+	const __m128 m8 = LANES(m[8]), m9 = LANES(m[9]), m10 = LANES(m[10]);
+	#undef LANES
+
+	__m128 m12 = _mm_setr_ps(mats[0].m[12], mats[1].m[12], mats[2].m[12], mats[3].m[12]);
+	__m128 m13 = _mm_setr_ps(mats[0].m[13], mats[1].m[13], mats[2].m[13], mats[3].m[13]);
+	__m128 m14 = _mm_setr_ps(mats[0].m[14], mats[1].m[14], mats[2].m[14], mats[3].m[14]);
+
+	// mr.Translate(o->relMidPos * s); mr.Translate(v->GetOffsets());
+	for (const float3* offs: {offs0, offs1}) {
+		const __m128 x = _mm_setr_ps(offs[0].x, offs[1].x, offs[2].x, offs[3].x);
+		const __m128 y = _mm_setr_ps(offs[0].y, offs[1].y, offs[2].y, offs[3].y);
+		const __m128 z = _mm_setr_ps(offs[0].z, offs[1].z, offs[2].z, offs[3].z);
+
+		m12 = _mm_add_ps(m12, MulAdd3(x, m0, y, m4, z, m8));
+		m13 = _mm_add_ps(m13, MulAdd3(x, m1, y, m5, z, m9));
+		m14 = _mm_add_ps(m14, MulAdd3(x, m2, y, m6, z, m10));
+	}
+
+	// InvertAffine; rotation is transposed, translation becomes R^T * -t
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 tx = _mm_sub_ps(zero, m12);
+	const __m128 ty = _mm_sub_ps(zero, m13);
+	const __m128 tz = _mm_sub_ps(zero, m14);
+
+	const __m128 i12 = MulAdd3(tx, m0, ty, m1, tz, m2);
+	const __m128 i13 = MulAdd3(tx, m4, ty, m5, tz, m6);
+	const __m128 i14 = MulAdd3(tx, m8, ty, m9, tz, m10);
+
+	// mInv.Mul(p); the w=1 column is added last, multiplied by one
+	const __m128 one = _mm_set1_ps(1.0f);
+	const auto TransformPoint = [&](const float3 p, __m128& px, __m128& py, __m128& pz) {
+		const __m128 x = _mm_set1_ps(p.x);
+		const __m128 y = _mm_set1_ps(p.y);
+		const __m128 z = _mm_set1_ps(p.z);
+
+		px = _mm_add_ps(MulAdd3(m0, x, m1, y, m2 , z), _mm_mul_ps(i12, one));
+		py = _mm_add_ps(MulAdd3(m4, x, m5, y, m6 , z), _mm_mul_ps(i13, one));
+		pz = _mm_add_ps(MulAdd3(m8, x, m9, y, m10, z), _mm_mul_ps(i14, one));
+	};
+
+	__m128 pi0x, pi0y, pi0z;
+	__m128 pi1x, pi1y, pi1z;
+
+	TransformPoint(p0, pi0x, pi0y, pi0z);
+	TransformPoint(p1, pi1x, pi1y, pi1z);
+
+	const __m128 vmaxx = _mm_setr_ps(hs[0].x, hs[1].x, hs[2].x, hs[3].x);
+	const __m128 vmaxy = _mm_setr_ps(hs[0].y, hs[1].y, hs[2].y, hs[3].y);
+	const __m128 vmaxz = _mm_setr_ps(hs[0].z, hs[1].z, hs[2].z, hs[3].z);
+	const __m128 vminx = _mm_sub_ps(zero, vmaxx);
+	const __m128 vminy = _mm_sub_ps(zero, vmaxy);
+	const __m128 vminz = _mm_sub_ps(zero, vmaxz);
+
+	__m128 miss = _mm_or_ps(_mm_cmplt_ps(SelectMax(pi0x, pi1x), vminx), _mm_cmpgt_ps(SelectMin(pi0x, pi1x), vmaxx));
+	miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmplt_ps(SelectMax(pi0y, pi1y), vminy), _mm_cmpgt_ps(SelectMin(pi0y, pi1y), vmaxy)));
+	miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmplt_ps(SelectMax(pi0z, pi1z), vminz), _mm_cmpgt_ps(SelectMin(pi0z, pi1z), vmaxz)));
+
+	return (_mm_movemask_ps(miss));
+}
 
 
 
 void CCollisionHandler::PrintStats()
 {
+	unsigned int numDiscTests = 0;
+	unsigned int numContTests = 0;
+
+	for (const HitTestCounters& counters: hitTestCounters) {
+		numDiscTests += counters.numDiscTests;
+		numContTests += counters.numContTests;
+	}
+
 	LOG("[CCollisionHandler] dis-/continuous tests: %i/%i", numDiscTests, numContTests);
 }
 
@@ -72,6 +179,87 @@ bool CCollisionHandler::DetectHit(
 
 
 
+size_t CCollisionHandler::DetectHits(
+	const CSolidObject* const* objs,
+	const size_t numObjs,
+	const float3 p0,
+	const float3 p1,
+	CollisionQuery* cq,
+	bool forceTrace
+) {
+	constexpr size_t NUM_LANES = 4;
+
+	CMatrix44f mats[NUM_LANES];
+	float3 offs0[NUM_LANES];
+	float3 offs1[NUM_LANES];
+	float3 hs[NUM_LANES];
+
+	for (size_t i = 0; i < numObjs; i += NUM_LANES) {
+		const size_t numLanes = std::min(numObjs - i, NUM_LANES);
+
+		// lanes whose DetectHit would start with Intersect(v, m, p0, p1, q);
+		// everything else (discrete tests, void objects, ...) always falls
+		// through to the scalar path, as do unused lanes
+		int testMask = 0;
+
+		for (size_t j = 0; j < NUM_LANES; j++) {
+			mats[j] = CMatrix44f();
+			offs0[j] = ZeroVector;
+			offs1[j] = ZeroVector;
+			hs[j] = ZeroVector;
+
+			if (j >= numLanes)
+				continue;
+
+			const CSolidObject* o = objs[i + j];
+			const CollisionVolume* v = &o->collisionVolume;
+
+			mats[j] = o->GetTransformMatrix(true);
+
+			if (o->IsInVoid())
+				continue;
+
+			if (v->DefaultToPieceTree()) {
+				// IntersectPieceTree's early-out test, relMidPos scaled by 0
+				v = o->localModel.GetBoundingVolume();
+				offs0[j] = o->relMidPos * 0.0f;
+			} else {
+				if (v->IgnoreHits())
+					continue;
+				if (!forceTrace && !v->UseContHitTest())
+					continue;
+
+				offs0[j] = o->relMidPos * 1.0f;
+			}
+
+			offs1[j] = v->GetOffsets();
+			hs[j] = v->GetHScales();
+
+			testMask |= (1 << j);
+		}
+
+		const int missMask = (testMask != 0)? (RejectSegmentBoxes4(mats, offs0, offs1, hs, p0, p1) & testMask): 0;
+
+		for (size_t j = 0; j < numLanes; j++) {
+			if ((missMask & (1 << j)) != 0) {
+				// keep the stats equal to the scalar path
+				hitTestCounters[ThreadPool::GetThreadNum()].numContTests += 1;
+				continue;
+			}
+
+			if (DetectHit(objs[i + j], mats[j], p0, p1, cq, forceTrace))
+				return (i + j);
+		}
+	}
+
+	if (cq != nullptr)
+		cq->Reset();
+
+	return numObjs;
+}
+
+
+
 bool CCollisionHandler::Collision(
 	const CSolidObject* o,
 	const CollisionVolume* v,
@@ -136,7 +324,7 @@ bool CCollisionHandler::CollisionFootPrint(const CSolidObject* o, const float3&
 
 bool CCollisionHandler::Collision(const CollisionVolume* v, const CMatrix44f& m, const float3& p)
 {
-	numDiscTests += 1;
+	hitTestCounters[ThreadPool::GetThreadNum()].numDiscTests += 1;
 
 	// get the inverse volume transformation matrix and
 	// apply it to the projectile's position, then test
@@ -345,7 +533,7 @@ inline bool CCollisionHandler::Intersect(
 
 bool CCollisionHandler::Intersect(const CollisionVolume* v, const CMatrix44f& m, const float3& p0, const float3& p1, CollisionQuery* q)
 {
-	numContTests += 1;
+	hitTestCounters[ThreadPool::GetThreadNum()].numContTests += 1;
 
 	const CMatrix44f mInv = m.InvertAffine();
 	const float3 pi0 = mInv.Mul(p0);
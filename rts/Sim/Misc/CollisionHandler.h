@@ -112,6 +112,20 @@ class CCollisionHandler {
 			CollisionQuery* cq = nullptr,
 			bool forceTrace = false
 		);
+		/**
+		 * Batched DetectHit for one ray-segment and many objects, each tested
+		 * against its own volume and synced transform in order; returns the
+		 * index of the first object hit (or numObjs if none) with <cq> set
+		 * exactly as the equivalent DetectHit loop would have left it
+		 */
+		static size_t DetectHits(
+			const CSolidObject* const* objs,
+			size_t numObjs,
+			const float3 p0,
+			const float3 p1,
+			CollisionQuery* cq = nullptr,
+			bool forceTrace = false
+		);
 		static bool MouseHit(
 			const CSolidObject* o,
 			const CMatrix44f& m,
@@ -166,10 +180,6 @@ class CCollisionHandler {
 		static bool IntersectEllipsoid(const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* cq);
 		static bool IntersectCylinder(const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* cq);
 		static bool IntersectBox(const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* cq);
-
-	private:
-		static unsigned int numDiscTests; // number of discrete hit-tests executed
-		static unsigned int numContTests; // number of continuous hit-tests executed (inc. unsynced)
 };
 
 #endif // COLLISION_HANDLER_H
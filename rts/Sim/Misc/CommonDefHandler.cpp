@@ -48,28 +48,53 @@ size_t CommonDefHandler::SoundSetDataCount()
 }
 
 
-int CommonDefHandler::LoadSoundFile(const std::string& fileName)
+std::string CommonDefHandler::FindSoundName(const std::string& fileName)
 {
-	if (!fileName.empty()) {
-		const std::string soundExt = std::move(FileSystem::GetExtension(fileName));
+	if (fileName.empty())
+		return "";
+
+	const std::string soundExt = std::move(FileSystem::GetExtension(fileName));
+
+	// unlike constructing a CFileHandler this does not read the data
+	// into memory; faster for large files and many small individually
+	// compressed sounds (e.g. in pool archives)
+	const bool foundExt = (std::find(soundExts.cbegin(), soundExts.cend(), soundExt) != soundExts.cend());
+	const bool haveFile = (foundExt && CFileHandler::FileExists(fileName, SPRING_VFS_RAW_FIRST));
+	const bool haveItem = (haveFile || sound->HasSoundItem(fileName));
+
+	if (haveItem)
+		return fileName;
 
-		// unlike constructing a CFileHandler this does not read the data
-		// into memory; faster for large files and many small individually
-		// compressed sounds (e.g. in pool archives)
-		const bool foundExt = (std::find(soundExts.cbegin(), soundExts.cend(), soundExt) != soundExts.cend());
-		const bool haveFile = (foundExt && CFileHandler::FileExists(fileName, SPRING_VFS_RAW_FIRST));
-		const bool haveItem = (haveFile || sound->HasSoundItem(fileName));
+	const std::string soundFile = "sounds/" + fileName + ((soundExt.empty())? ".wav": "");
 
-		if (haveItem)
-			return (sound->GetSoundId(fileName));
+	if (CFileHandler::FileExists(soundFile, SPRING_VFS_RAW_FIRST))
+		return soundFile;
 
-		const std::string soundFile = "sounds/" + fileName + ((soundExt.empty())? ".wav": "");
+	return "";
+}
+
+int CommonDefHandler::LoadSoundFile(const std::string& fileName)
+{
+	const std::string soundName = FindSoundName(fileName);
 
-		if (CFileHandler::FileExists(soundFile, SPRING_VFS_RAW_FIRST))
-			return (sound->GetSoundId(soundFile));
+	if (!soundName.empty())
+		return (sound->GetSoundId(soundName));
 
+	if (!fileName.empty())
 		LOG_L(L_WARNING, "[%s] could not load sound \"%s\" from {Unit,Weapon}Def", __func__, fileName.c_str());
-	}
 
 	return 0;
 }
+
+void CommonDefHandler::PreloadSoundFiles()
+{
+	// [0] is the dummy; missing sounds are reported by LoadSoundFile when first played
+	for (size_t i = 1; i < soundSetData.size(); i++) {
+		const std::string soundName = FindSoundName(soundSetData[i].name);
+
+		if (soundName.empty())
+			continue;
+
+		sound->PreloadSoundItem(soundName);
+	}
+}
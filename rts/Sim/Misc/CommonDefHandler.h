@@ -21,6 +21,11 @@ public:
 
 	// loads a soundfile, adds "sounds/" prefix and ".wav" extension if necessary
 	static int LoadSoundFile(const std::string& fileName);
+	// lets the sound system decode the files of all sound-sets in the background
+	static void PreloadSoundFiles();
+
+private:
+	static std::string FindSoundName(const std::string& fileName);
 };
 
 #endif
@@ -29,14 +29,11 @@ DefType::DefType(const char* n): name(n) {
 void DefType::AddTagMetaData(const DefTagMetaData* data)
 {
 	const auto key = data->GetInternalName();
+	const auto iter = internalKeyMap.find(key);
 
-	const auto tend = tagMetaData.begin() + tagMetaDataCnt;
-	const auto pred = [&](const DefTagMetaData* md) { return (key == md->GetInternalName()); };
-	const auto iter = std::find_if(tagMetaData.begin(), tend, pred);
-
-	if (iter != tend) {
+	if (iter != internalKeyMap.end()) {
 		LOG_VAR(data, "Duplicate config variable declaration \"%s\"", key.c_str());
-		LOG_VAR(*iter, "  Previously declared here");
+		LOG_VAR(iter->second, "  Previously declared here");
 		assert(false);
 		return;
 	}
@@ -46,39 +43,48 @@ void DefType::AddTagMetaData(const DefTagMetaData* data)
 	}
 
 	tagMetaData[tagMetaDataCnt++] = data;
+	internalKeyMap.emplace(key, data);
 }
 
 
-const DefTagMetaData* DefType::GetMetaDataByInternalKey(const string& key)
-{
-	const auto tend = tagMetaData.begin() + tagMetaDataCnt;
-	const auto pred = [&](const DefTagMetaData* md) { return (key == md->GetInternalName()); };
-	const auto iter = std::find_if(tagMetaData.begin(), tend, pred);
-
-	return ((iter == tend)? nullptr: *iter);
-}
-
-
-const DefTagMetaData* DefType::GetMetaDataByExternalKey(const string& key)
+void DefType::BuildExternalKeyMap()
 {
-	const std::string lkey = StringToLower(key);
+	// names are only known once all tags are declared (they are set through
+	// the DefTagBuilder after AddTagMetaData), so this runs on the first query;
+	// emplace keeps the first tag per name like a scan in declaration order
+	externalKeyMap.reserve(tagMetaDataCnt * 2);
 
 	for (unsigned int i = 0; i < tagMetaDataCnt; i++) {
 		const DefTagMetaData* md = tagMetaData[i];
 
 		if (md->GetExternalName().IsSet()) {
-			if (lkey == StringToLower(md->GetExternalName().Get()))
-				return md;
+			externalKeyMap.emplace(StringToLower(md->GetExternalName().Get()), md);
 		} else {
-			if (lkey == StringToLower(md->GetInternalName()))
-				return md;
+			externalKeyMap.emplace(StringToLower(md->GetInternalName()), md);
 		}
 
-		if (lkey == StringToLower(md->GetFallbackName().Get()))
-			return md;
+		if (md->GetFallbackName().IsSet())
+			externalKeyMap.emplace(StringToLower(md->GetFallbackName().Get()), md);
 	}
+}
+
+
+const DefTagMetaData* DefType::GetMetaDataByInternalKey(const string& key)
+{
+	const auto iter = internalKeyMap.find(key);
+
+	return ((iter == internalKeyMap.end())? nullptr: iter->second);
+}
+
+
+const DefTagMetaData* DefType::GetMetaDataByExternalKey(const string& key)
+{
+	if (externalKeyMap.empty())
+		BuildExternalKeyMap();
+
+	const auto iter = externalKeyMap.find(StringToLower(key));
 
-	return nullptr;
+	return ((iter == externalKeyMap.end())? nullptr: iter->second);
 }
 
 
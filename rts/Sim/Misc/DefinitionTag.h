@@ -17,6 +17,7 @@
 #include "Lua/LuaParser.h"
 #include "System/float3.h"
 #include "System/SpringMath.h"
+#include "System/UnorderedMap.hpp"
 
 // table placeholder (used for LuaTables)
 // example usage: DUMMYTAG(Defs, DefClass, table, customParams)
@@ -269,6 +270,11 @@ private:
 	const char* name = nullptr;
 	const LuaTable* luaTable = nullptr;
 
+	// every tag is looked up once per def (and every key of a def table
+	// is checked for being a tag), so avoid scanning all of tagMetaData
+	spring::unordered_map<std::string, const DefTagMetaData*> internalKeyMap;
+	spring::unordered_map<std::string, const DefTagMetaData*> externalKeyMap;
+
 private:
 	static std::vector<const DefType*>& GetTypes() {
 		static std::vector<const DefType*> tagtypes;
@@ -288,6 +294,7 @@ private:
 		return tmd;
 	}
 	void AddTagMetaData(const DefTagMetaData* data);
+	void BuildExternalKeyMap();
 
 	const DefTagMetaData* GetMetaDataByInternalKey(const std::string& key);
 	const DefTagMetaData* GetMetaDataByExternalKey(const std::string& key);
@@ -128,5 +128,26 @@ public:
 extern CGlobalSynced* gs;
 extern CGlobalSyncedRNG gsRNG;
 
+
+/// subsystems drawing from CSyncedRNGStream's, each gets its own streams per object
+enum SyncedRNGStreamSubsystem {
+	RNG_STREAM_MOVETYPE   = 0,
+	RNG_STREAM_WEAPON     = 1,
+	RNG_STREAM_PROJECTILE = 2,
+	RNG_STREAM_PATHING    = 3,
+	RNG_STREAM_LUA        = 4,
+};
+
+/**
+ * Returns the stream for (current frame, subsystem, objectID). Unlike gsRNG
+ * this may be used from parallel synced code, as long as every object (ID)
+ * draws only from its own stream; a stream should be created once per frame
+ * and object, since another one for the same triple repeats its values.
+ * Keyed on the initial game seed, so Lua's SetSeed does not affect streams.
+ */
+inline CSyncedRNGStream GetSyncedRNGStream(SyncedRNGStreamSubsystem subsystem, unsigned int objectID) {
+	return {gsRNG.GetInitSeed(), static_cast<uint32_t>(gs->frameNum), static_cast<uint32_t>(subsystem), objectID};
+}
+
 #endif // _GLOBAL_SYNCED_H
 
@@ -21,6 +21,7 @@ CR_REG_METADATA_TEMPLATE(CGroundBlockingObjectMap::ArrCell, (
 CR_BIND(CGroundBlockingObjectMap, )
 CR_REG_METADATA(CGroundBlockingObjectMap, (
 	CR_MEMBER(arrCells),
+	CR_MEMBER(cellMasks),
 	CR_MEMBER(vecCells),
 	CR_MEMBER(vecIndcs)
 ))
@@ -225,12 +226,27 @@ unsigned int CGroundBlockingObjectMap::CalcChecksum() const
 
 
 
+void CGroundBlockingObjectMap::UpdateCellMask(unsigned int sqr) {
+	const BlockingMapCell& cell = GetCellUnsafeConst(sqr);
+
+	uint8_t mask = CELL_MASK_NONE;
+
+	for (size_t i = 0, n = cell.size(); i < n; i++) {
+		mask |= ((cell[i]->immobile)? CELL_MASK_IMMOBILE: CELL_MASK_MOBILE);
+	}
+
+	cellMasks[sqr] = mask;
+}
+
 bool CGroundBlockingObjectMap::CellInsertUnique(unsigned int sqr, CSolidObject* o) {
 	ArrCell& ac = GetArrCell(sqr);
 	VecCell* vc = nullptr;
 
 	if (ac.Contains(o))
 		return false;
+
+	cellMasks[sqr] |= ((o->immobile)? CELL_MASK_IMMOBILE: CELL_MASK_MOBILE);
+
 	if (ac.Insert(o))
 		return true;
 
@@ -254,8 +270,10 @@ bool CGroundBlockingObjectMap::CellErase(unsigned int sqr, CSolidObject* o) {
 	VecCell* vc = nullptr;
 
 	if (ac.Erase(o)) {
-		if (ac.GetVecIndx() == 0)
+		if (ac.GetVecIndx() == 0) {
+			UpdateCellMask(sqr);
 			return true;
+		}
 
 		// never allow a hole between array and vector parts
 		assert(!vecCells[ac.GetVecIndx()].empty());
@@ -284,6 +302,7 @@ CommonExit:
 		ac.SetVecIndx(0);
 	}
 
+	UpdateCellMask(sqr);
 	return true;
 }
 
@@ -3,19 +3,21 @@
 #ifndef GROUNDBLOCKINGOBJECTMAP_H
 #define GROUNDBLOCKINGOBJECTMAP_H
 
+#include <algorithm>
 #include <array>
 #include <vector>
 
 #include "Sim/Objects/SolidObject.h"
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
+#include "System/SpringMem.h"
 
 class CGroundBlockingObjectMap
 {
 	CR_DECLARE_STRUCT(CGroundBlockingObjectMap)
 
 private:
-	template<typename T, uint32_t S = 8> struct ArrayCell {
+	template<typename T, uint32_t S = 2> struct ArrayCell {
 	public:
 		CR_DECLARE_STRUCT(ArrayCell)
 
@@ -69,10 +71,20 @@ private:
 		std::array<T*, S> arr;
 	};
 
+	// most occupied squares hold a single object or two overlapping ones, any
+	// further objects spill over into a (pooled) vector-cell
 	typedef ArrayCell<CSolidObject> ArrCell;
 	typedef std::vector<CSolidObject*> VecCell;
 
 public:
+	// kinds of objects present in a cell, kept alongside the cells so that
+	// queries for empty or structure-free squares need not touch them
+	enum CellMaskBits {
+		CELL_MASK_NONE     = 0,
+		CELL_MASK_MOBILE   = 1,
+		CELL_MASK_IMMOBILE = 2,
+	};
+
 	struct BlockingMapCell {
 	public:
 		BlockingMapCell() = delete;
@@ -98,7 +110,9 @@ public:
 
 
 	void Init(unsigned int numSquares) {
+		spring::ReserveHugePages(arrCells, numSquares);
 		arrCells.resize(numSquares);
+		cellMasks.resize(numSquares, CELL_MASK_NONE);
 		vecCells.reserve(32);
 		vecIndcs.reserve(32);
 
@@ -116,6 +130,7 @@ public:
 			v.clear();
 		}
 
+		std::fill(cellMasks.begin(), cellMasks.end(), CELL_MASK_NONE);
 		vecIndcs.clear();
 	}
 
@@ -138,14 +153,15 @@ public:
 
 	// same as GroundBlocked(), but does not bounds-check mapSquare
 	CSolidObject* GroundBlockedUnsafe(unsigned int mapSquare) const {
-		const BlockingMapCell& cell = GetCellUnsafeConst(mapSquare);
-
-		if (cell.empty())
+		if (cellMasks[mapSquare] == CELL_MASK_NONE)
 			return nullptr;
 
-		return cell[0];
+		return GetArrCell(mapSquare)[0];
 	}
 
+	// CellMaskBits of the objects in a cell, does not bounds-check mapSquare
+	uint8_t GetCellMaskUnsafe(unsigned int mapSquare) const { return cellMasks[mapSquare]; }
+
 
 	bool GroundBlocked(int x, int z, const CSolidObject* ignoreObj) const;
 	bool GroundBlocked(const float3& pos, const CSolidObject* ignoreObj) const;
@@ -182,8 +198,11 @@ private:
 	bool CellInsertUnique(unsigned int sqr, CSolidObject* o);
 	bool CellErase(unsigned int sqr, CSolidObject* o);
 
+	void UpdateCellMask(unsigned int sqr);
+
 private:
 	std::vector<ArrCell> arrCells;
+	std::vector<uint8_t> cellMasks;
 	std::vector<VecCell> vecCells;
 	std::vector<uint32_t> vecIndcs;
 };
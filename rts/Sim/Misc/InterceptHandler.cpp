@@ -33,85 +33,115 @@ void CInterceptHandler::Update(bool forced) {
 		return;
 
 	for (CWeapon* w: interceptors) {
-		const WeaponDef* wDef = w->weaponDef;
-		const CUnit* wOwner = w->owner;
+		for (CWeaponProjectile* p: interceptables) {
+			TestInterceptTarget(w, p);
+		}
+	}
+}
 
-		assert(wDef->interceptor || wDef->isShield);
 
-		for (CWeaponProjectile* p: interceptables) {
-			if (!p->CanBeInterceptedBy(wDef))
-				continue;
-			if (w->HasIncomingProjectile(p->id))
-				continue;
-
-			const int pAllyTeam = p->GetAllyteamID();
-
-			if (teamHandler.IsValidAllyTeam(pAllyTeam) && teamHandler.Ally(wOwner->allyteam, pAllyTeam))
-				continue;
-
-			// note: will be called every Update so long as gadget does not return true
-			if (!eventHandler.AllowWeaponInterceptTarget(wOwner, w, p))
-				continue;
-
-			// there are four cases when an interceptor <w> should fire at a projectile <p>:
-			//     1. p's target position inside w's interception circle (w's owner can move!)
-			//     2. p's current position inside w's interception circle
-			//     3. p's projected impact position inside w's interception circle
-			//     4. p's trajectory intersects w's interception circle
-			//
-			// these checks all need to be evaluated periodically, not just
-			// when a projectile is created and handed to AddInterceptTarget
-			const float weaponDist = w->aimFromPos.distance(p->pos);
-			const float impactDist = CGround::LineGroundCol(p->pos, p->pos + p->dir * weaponDist);
-
-			const float3& pImpactPos = p->pos + p->dir * impactDist;
-			const float3& pTargetPos = p->GetTargetPos();
-			const float3  pWeaponVec = p->pos - w->aimFromPos;
-
-			if (w->aimFromPos.SqDistance2D(pTargetPos) < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 1
-			}
-
-			if (false /*wDef->noFlyThroughIntercept*/) {
-				// <w> is just a static interceptor and fires only at projectiles
-				// TARGETED within its current interception area; any projectiles
-				// CROSSING its interception area aren't targeted
-				//XXX implement in lua?
-				continue;
-			}
-
-			if (pWeaponVec.SqLength2D() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 2
-			}
-
-			if (w->aimFromPos.SqDistance2D(pImpactPos) < Square(wDef->coverageRange)) {
-				const float3 pTargetDir = (pTargetPos - p->pos).SafeNormalize();
-				const float3 pImpactDir = (pImpactPos - p->pos).SafeNormalize();
-
-				// the projected impact position can briefly shift into the covered
-				// area during transition from vertical to horizontal flight, so we
-				// perform an extra test (NOTE: assumes non-parabolic trajectory)
-				if (pTargetDir.dot(pImpactDir) >= 0.999f) {
-					w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-					w->AddIncomingProjectile(p->id);
-					continue; // 3
-				}
-			}
-
-			const float3 pMinSepPos = p->pos + p->dir * Clamp(-(pWeaponVec.dot(p->dir)), 0.0f, impactDist);
-			const float3 pMinSepVec = w->aimFromPos - pMinSepPos;
-
-			if (pMinSepVec.SqLength() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 4
-			}
+// conservative 2D test whether the ray from <p> (backed up by one step, see below)
+// can pass within <range> of <w>; rejects most pairs before the exact test needs
+// a Lua callin and a ground raycast
+static bool InterceptRayInRange(const CWeapon* w, const CWeaponProjectile* p, float range)
+{
+	// points considered by the exact test lie on p->pos + p->dir * t with t >= -1
+	// (LineGroundCol returns -1 on a miss), and are compared in 2D or in 3D where
+	// the latter is never closer
+	const float3 rayPos = p->pos - p->dir;
+	const float3 rayDir = p->dir * XZVector;
+	const float3 posVec = (w->aimFromPos - rayPos) * XZVector;
+
+	const float dirSqLen = rayDir.SqLength();
+	const float rayDist = (dirSqLen > 0.0f)? std::max(0.0f, posVec.dot(rayDir) / dirSqLen): 0.0f;
+
+	// margin covers the rounding differences with the exact test
+	return ((posVec - rayDir * rayDist).SqLength() < Square(range * 1.01f + 1.0f));
+}
+
+void CInterceptHandler::TestInterceptTarget(CWeapon* w, CWeaponProjectile* p)
+{
+	const WeaponDef* wDef = w->weaponDef;
+	const CUnit* wOwner = w->owner;
+
+	assert(wDef->interceptor || wDef->isShield);
+
+	if (!p->CanBeInterceptedBy(wDef))
+		return;
+	if (w->HasIncomingProjectile(p->id))
+		return;
+
+	const int pAllyTeam = p->GetAllyteamID();
+
+	if (teamHandler.IsValidAllyTeam(pAllyTeam) && teamHandler.Ally(wOwner->allyteam, pAllyTeam))
+		return;
+
+	const float3& pTargetPos = p->GetTargetPos();
+
+	// cases 2 to 4 below can only apply if the trajectory passes nearby
+	if (w->aimFromPos.SqDistance2D(pTargetPos) >= Square(wDef->coverageRange) && !InterceptRayInRange(w, p, wDef->coverageRange))
+		return;
+
+	// note: will be called every Update so long as gadget does not return true
+	if (!eventHandler.AllowWeaponInterceptTarget(wOwner, w, p))
+		return;
+
+	// there are four cases when an interceptor <w> should fire at a projectile <p>:
+	//     1. p's target position inside w's interception circle (w's owner can move!)
+	//     2. p's current position inside w's interception circle
+	//     3. p's projected impact position inside w's interception circle
+	//     4. p's trajectory intersects w's interception circle
+	//
+	// these checks all need to be evaluated periodically, not just
+	// when a projectile is created and handed to AddInterceptTarget
+	const float weaponDist = w->aimFromPos.distance(p->pos);
+	const float impactDist = CGround::LineGroundCol(p->pos, p->pos + p->dir * weaponDist);
+
+	const float3& pImpactPos = p->pos + p->dir * impactDist;
+	const float3  pWeaponVec = p->pos - w->aimFromPos;
+
+	if (w->aimFromPos.SqDistance2D(pTargetPos) < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 1
+	}
+
+	if (false /*wDef->noFlyThroughIntercept*/) {
+		// <w> is just a static interceptor and fires only at projectiles
+		// TARGETED within its current interception area; any projectiles
+		// CROSSING its interception area aren't targeted
+		//XXX implement in lua?
+		return;
+	}
+
+	if (pWeaponVec.SqLength2D() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 2
+	}
+
+	if (w->aimFromPos.SqDistance2D(pImpactPos) < Square(wDef->coverageRange)) {
+		const float3 pTargetDir = (pTargetPos - p->pos).SafeNormalize();
+		const float3 pImpactDir = (pImpactPos - p->pos).SafeNormalize();
+
+		// the projected impact position can briefly shift into the covered
+		// area during transition from vertical to horizontal flight, so we
+		// perform an extra test (NOTE: assumes non-parabolic trajectory)
+		if (pTargetDir.dot(pImpactDir) >= 0.999f) {
+			w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+			w->AddIncomingProjectile(p->id);
+			return; // 3
 		}
 	}
+
+	const float3 pMinSepPos = p->pos + p->dir * Clamp(-(pWeaponVec.dot(p->dir)), 0.0f, impactDist);
+	const float3 pMinSepVec = w->aimFromPos - pMinSepPos;
+
+	if (pMinSepVec.SqLength() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 4
+	}
 }
 
 
@@ -141,7 +171,10 @@ void CInterceptHandler::AddInterceptTarget(CWeaponProjectile* target, const floa
 	// die before the interceptable itself does)
 	AddDeathDependence(target, DEPENDENCE_INTERCEPTABLE);
 
-	Update(true);
+	// pairs of older targets are retested by the periodic Update
+	for (CWeapon* w: interceptors) {
+		TestInterceptTarget(w, target);
+	}
 }
 
 
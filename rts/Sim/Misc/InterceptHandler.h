@@ -26,6 +26,9 @@ public:
 
 	void DependentDied(CObject* o);
 
+private:
+	void TestInterceptTarget(CWeapon* w, CWeaponProjectile* p);
+
 private:
 	std::deque<CWeapon*> interceptors;
 	std::deque<CWeaponProjectile*> interceptables;
@@ -10,6 +10,7 @@
 #include "Map/ReadMap.h"
 #include "System/Log/ILog.h"
 #include "System/Sync/HsiehHash.h"
+#include "System/bitops.h"
 #include "System/creg/STL_Deque.h"
 #include "System/EventHandler.h"
 #include "System/SafeUtil.h"
@@ -41,7 +42,14 @@ CR_REG_METADATA(CLosHandler,(
 	CR_MEMBER(baseRadarErrorSize),
 	CR_MEMBER(baseRadarErrorMult),
 	CR_MEMBER(radarErrorSizes),
-	CR_IGNORED(losTypes)
+	CR_IGNORED(losTypes),
+	CR_IGNORED(updatedTypes),
+	CR_IGNORED(applyJobs),
+	CR_IGNORED(recalcJobs),
+
+	CR_IGNORED(unitVisStates),
+	CR_IGNORED(unitLosBits),
+	CR_IGNORED(unitRadarBits)
 ))
 
 
@@ -58,6 +66,8 @@ inline void SLosInstance::Init(int radius, int allyteam, int2 basePos, float bas
 	this->baseHeight = baseHeight;
 	this->refCount = 0;
 	this->hashNum = hashNum;
+	this->sectorOcclusion.clear();
+	this->dirtySectors = 0;
 	this->status = NONE;
 	this->isCached = false;
 	this->isQueuedForUpdate = false;
@@ -72,6 +82,8 @@ inline void SLosInstance::Init(int radius, int allyteam, int2 basePos, float bas
 size_t ILosType::cacheFails = 1;
 size_t ILosType::cacheHits  = 1;
 size_t ILosType::cacheRefs  = 1;
+size_t ILosType::sectorReuses  = 0;
+size_t ILosType::sectorRecasts = 0;
 
 constexpr float CLosHandler::defBaseRadarErrorSize;
 constexpr float CLosHandler::defBaseRadarErrorMult;
@@ -90,12 +102,17 @@ void ILosType::Init(const int mipLevel_, LosType type_)
 
 	freeIDs.reserve(4096);
 	losMaps.resize(teamHandler.ActiveAllyTeams());
+	losBatches.resize(teamHandler.ActiveAllyTeams());
 
 	const float* ctrHeightMap = readMap->GetCenterHeightMapSynced();
 	const float* mipHeightMap = readMap->GetMIPHeightMapSynced(mipLevel_);
 
+	// not reset, readers of the dirty-rect history have to notice a reinitialization
+	updateNum += 1;
+
 	for (CLosMap& losMap: losMaps) {
 		losMap.Init(size, int2(mapDims.mapx, mapDims.mapy), ctrHeightMap, mipHeightMap, type == LOS_TYPE_LOS);
+		losMap.ResetDirtyRects(updateNum);
 	}
 }
 
@@ -122,11 +139,31 @@ void ILosType::Kill()
 	losAdd.clear();
 	losDeleted.clear();
 	losRecalc.clear();
+	losBatches.clear();
 
 	// mark as invalid
 	size = {0, 0};
 }
 
+size_t ILosType::GetMemFootPrint() const
+{
+	size_t memFootPrint = instances.size() * sizeof(SLosInstance);
+
+	for (const SLosInstance& li: instances) {
+		memFootPrint += (li.squares.capacity() * sizeof(SLosInstance::RLE));
+		memFootPrint += (li.sectorOcclusion.capacity() * sizeof(li.sectorOcclusion[0]));
+
+		for (const auto& sector: li.sectorOcclusion) {
+			memFootPrint += (sector.capacity() * sizeof(SLosInstance::RLE));
+		}
+	}
+	for (const CLosMap& lm: losMaps) {
+		memFootPrint += lm.GetMemFootPrint();
+	}
+
+	return memFootPrint;
+}
+
 
 float ILosType::GetRadius(const CUnit* unit) const
 {
@@ -269,25 +306,76 @@ inline void ILosType::RemoveUnit(CUnit* unit, bool delayed)
 }
 
 
-inline void ILosType::LosAdd(SLosInstance* li)
+void ILosType::AddApplyJobs(int amount, std::vector<ApplyJob>& jobs)
 {
-	assert(li);
-	assert(teamHandler.IsValidAllyTeam(li->allyteam));
+	const std::vector<SLosInstance*>& instances = (amount < 0)? losRemove: losAdd;
 
-	if (algoType == LOS_ALGO_RAYCAST) {
-		losMaps[li->allyteam].AddRaycast(li, 1);
-	} else {
-		losMaps[li->allyteam].AddCircle(li, 1);
+	if (instances.empty())
+		return;
+
+	for (auto& batch: losBatches) {
+		batch.clear();
 	}
-}
 
+	for (SLosInstance* li: instances) {
+		assert(li);
+		assert(teamHandler.IsValidAllyTeam(li->allyteam));
+		assert(amount < 0 || li->refCount > 0);
+		losBatches[li->allyteam].push_back(li);
+	}
+
+	const int maxStripes = std::max(1, std::min(ThreadPool::GetNumThreads(), size.y / MIN_STRIPE_ROWS));
+
+	for (size_t a = 0; a < losBatches.size(); ++a) {
+		CLosMap& losMap = losMaps[a];
+
+		if (losBatches[a].empty())
+			continue;
+
+		// telling which squares enter LOS needs the per-square counts while
+		// the batch is added, so add it serially; the ReadMap events this
+		// queues are handed over by CLosHandler::FlushReadmapEvents
+		if (losMap.SendsReadmapEvents(a, amount)) {
+			for (SLosInstance* li: losBatches[a]) {
+				losMap.AddRaycast(li, amount);
+			}
+
+			continue;
+		}
+
+		// the jobs skip this, they would all write to the same rectangle
+		for (const SLosInstance* li: losBatches[a]) {
+			if (algoType == LOS_ALGO_RAYCAST && (li->squares.empty() || li->squares[0].length == SLosInstance::EMPTY_RLE.length))
+				continue;
+
+			losMap.MarkDirty(li);
+		}
+
+		// every square belongs to one stripe and hence job, and sums up the same
+		// amounts in the same (batch) order as if the batch was added in one go;
+		// the stripe count only affects how the work is split, not the result
+		const int numStripes = Clamp(int(losBatches[a].size()) / STRIPE_INSTANCES, 1, maxStripes);
+
+		for (int s = 0; s < numStripes; s++) {
+			jobs.push_back({this, int(a), amount, (size.y * s) / numStripes, (size.y * (s + 1)) / numStripes});
+		}
+	}
+}
 
-inline void ILosType::LosRemove(SLosInstance* li)
+void ILosType::Apply(const ApplyJob& job)
 {
-	if (algoType == LOS_ALGO_RAYCAST) {
-		losMaps[li->allyteam].AddRaycast(li, -1);
-	} else {
-		losMaps[li->allyteam].AddCircle(li, -1);
+	CLosMap& losMap = losMaps[job.allyTeam];
+
+	for (const SLosInstance* li: losBatches[job.allyTeam]) {
+		// rows [y - r, y + r] of the instance's box
+		if ((li->basePos.y + li->radius) < job.minRow || (li->basePos.y - li->radius) >= job.maxRow)
+			continue;
+
+		if (algoType == LOS_ALGO_RAYCAST) {
+			losMap.AddRaycastRows(li, job.amount, job.minRow, job.maxRow);
+		} else {
+			losMap.AddCircleRows(li, job.amount, job.minRow, job.maxRow);
+		}
 	}
 }
 
@@ -337,6 +425,10 @@ inline void ILosType::AddInstanceToCache(SLosInstance* li)
 		return;
 	}
 
+	// an instance that becomes used again is recast in full on its next terrain change
+	li->sectorOcclusion.clear();
+	li->dirtySectors = 0;
+
 	li->isCached = true;
 	losCache.push_back(li);
 }
@@ -384,6 +476,8 @@ inline void ILosType::DeleteInstance(SLosInstance* li)
 	}
 
 	li->squares.clear();
+	li->sectorOcclusion.clear();
+	li->dirtySectors = 0;
 	freeIDs.push_back(li->id);
 }
 
@@ -475,7 +569,7 @@ inline int ILosType::GetHashNum(const int allyteam, const int2 baseLos, const fl
 }
 
 
-void ILosType::Update()
+bool ILosType::BeginUpdate()
 {
 	// delayed delete
 	while (!delayedDeleteQue.empty() && delayedDeleteQue.front().timeoutTime < gs->frameNum) {
@@ -495,7 +589,7 @@ void ILosType::Update()
 
 	// no updates? -> early exit
 	if (losUpdate.empty())
-		return;
+		return false;
 
 
 	losRemove.clear();
@@ -546,26 +640,29 @@ void ILosType::Update()
 		}
 	}
 
-	// remove sight
-	//FIXME multithread?
-	for (SLosInstance* li: losRemove) {
-		LosRemove(li);
-	}
+	if (algoType != LOS_ALGO_RAYCAST)
+		return true;
 
-	// raycast terrain
-	if (algoType == LOS_ALGO_RAYCAST)  {
-		for_mt(0, losRecalc.size(), [&](const int idx) {
-			auto li = losRecalc[idx];
-			assert(li->refCount > 0);
-			li->squares.clear();
-			losMaps[li->allyteam].PrepareRaycast(li);
-		});
+	for (const SLosInstance* li: losRecalc) {
+		if (li->dirtySectors == 0)
+			continue;
+
+		const bool haveSectors = (li->sectorOcclusion.size() == CLosMap::NUM_RAYCAST_SECTORS);
+		const unsigned numRecasts = haveSectors? count_bits_set(li->dirtySectors): CLosMap::NUM_RAYCAST_SECTORS;
+
+		sectorRecasts += numRecasts;
+		sectorReuses += (CLosMap::NUM_RAYCAST_SECTORS - numRecasts);
 	}
 
-	// add sight
-	for (SLosInstance* li: losAdd) {
-		assert(li->refCount > 0);
-		LosAdd(li);
+	return true;
+}
+
+void ILosType::FinishUpdate()
+{
+	updateNum += 1;
+
+	for (CLosMap& losMap: losMaps) {
+		losMap.PublishDirtyRect(updateNum);
 	}
 
 	// delete / move to cache unused instances
@@ -629,14 +726,31 @@ void ILosType::UpdateHeightMapSynced(SRectangle rect)
 		DeleteInstance(li);
 	}
 
-	// relos used instances
+	// changed area in LOS-map squares, padded since MIP-heightmap squares
+	// are not aligned with the heightmap rectangle
+	const SRectangle losRect = {
+		(rect.x1 * SQUARE_SIZE) / mipDiv - 1,
+		(rect.y1 * SQUARE_SIZE) / mipDiv - 1,
+		(rect.x2 * SQUARE_SIZE) / mipDiv + 1,
+		(rect.y2 * SQUARE_SIZE) / mipDiv + 1,
+	};
+
+	// relos used instances, only the sectors whose rays cross the change
 	for (auto& p: instanceHashes) {
 		for (SLosInstance* li: p.second) {
-			if (li->status & SLosInstance::TLosStatus::RECALC)
-				continue;
 			if (!CheckOverlap(li, rect))
 				continue;
 
+			const unsigned int sectors = losMaps[li->allyteam].GetRaycastSectors(li, losRect);
+
+			if (sectors == 0)
+				continue;
+
+			li->dirtySectors |= sectors;
+
+			if (li->status & SLosInstance::TLosStatus::RECALC)
+				continue;
+
 			UpdateInstanceStatus(li, SLosInstance::TLosStatus::RECALC);
 		}
 	}
@@ -661,6 +775,8 @@ void CLosHandler::InitStatic()
 	ILosType::cacheFails = 1;
 	ILosType::cacheHits  = 1;
 	ILosType::cacheRefs  = 1;
+	ILosType::sectorReuses  = 0;
+	ILosType::sectorRecasts = 0;
 
 	if (losHandler == nullptr)
 		losHandler = new (losHandlerMem) CLosHandler();
@@ -711,6 +827,10 @@ void CLosHandler::Init()
 
 void CLosHandler::Kill()
 {
+	unitVisStates.clear();
+	unitLosBits.clear();
+	unitRadarBits.clear();
+
 	los.Kill();
 	airLos.Kill();
 	radar.Kill();
@@ -719,39 +839,49 @@ void CLosHandler::Kill()
 	jammer.Kill();
 	sonarJammer.Kill();
 
-	/*size_t memUsage = 0;
-	for (ILosType* lt: losTypes) {
-		memUsage += lt->instances.size() * sizeof(SLosInstance);
-		for (SLosInstance& li: lt->instances) {
-			memUsage += li.squares.capacity() * sizeof(SLosInstance::RLE);
-		}
-		memUsage += lt->losMaps.size() * sizeof(CLosMap);
-		for (CLosMap& lm: lt->losMaps) {
-			memUsage += lm.losmap.capacity() * sizeof(unsigned short);
-		}
-	}
-	LOG_L(L_WARNING, "LosHandler MemUsage: ~%.1fMB", memUsage / (1024.f * 1024.f));*/
-
 	LOG("[LosHandler::%s] raycast instance cache-{hits,misses}={%u,%u}; shared=%.0f%%; cached=%.0f%%",
 		__func__, unsigned(ILosType::cacheHits), unsigned(ILosType::cacheFails),
 		100.0f * float(ILosType::cacheHits - ILosType::cacheRefs) / (ILosType::cacheHits + ILosType::cacheFails),
 		100.0f * float(ILosType::cacheRefs) / (ILosType::cacheHits + ILosType::cacheFails)
 	);
+	LOG("[LosHandler::%s] raycast terrain-recalc sector-{reuses,recasts}={%u,%u}; reused=%.0f%%",
+		__func__, unsigned(ILosType::sectorReuses), unsigned(ILosType::sectorRecasts),
+		100.0f * float(ILosType::sectorReuses) / std::max(size_t(1), ILosType::sectorReuses + ILosType::sectorRecasts)
+	);
 
 	losTypes.fill(nullptr);
 }
 
+size_t CLosHandler::GetMemFootPrint() const
+{
+	size_t memFootPrint = 0;
+
+	for (const ILosType* lt: losTypes) {
+		if (lt == nullptr)
+			continue;
+
+		memFootPrint += lt->GetMemFootPrint();
+	}
+
+	return memFootPrint;
+}
+
 
 void CLosHandler::SetGlobalLOS(const int allyTeamId, const bool newState)
 {
 	globalLOS[allyTeamId] = newState;
 
+	// overrides the visibility of (almost) every unit
+	std::fill(unitVisStates.begin(), unitVisStates.end(), UnitVisState());
+
 	if (globalLOS[allyTeamId])
 		readMap->BecomeSpectator(); //update unsynced heightmap
 }
 
 void CLosHandler::UnitDestroyed(const CUnit* unit, const CUnit* attacker)
 {
+	ForgetUnitVisibility(unit);
+
 	for (ILosType* lt: losTypes) {
 		lt->RemoveUnit(const_cast<CUnit*>(unit), true);
 	}
@@ -760,6 +890,9 @@ void CLosHandler::UnitDestroyed(const CUnit* unit, const CUnit* attacker)
 
 void CLosHandler::UnitTaken(const CUnit* unit, int oldTeam, int newTeam)
 {
+	// cloaked units are visible to their own allyteam
+	ForgetUnitVisibility(unit);
+
 	for (ILosType* lt: losTypes) {
 		lt->RemoveUnit(const_cast<CUnit*>(unit));
 	}
@@ -785,9 +918,42 @@ void CLosHandler::UnitLoaded(const CUnit* unit, const CUnit* transport)
 }
 
 
+void CLosHandler::UpdateUnitVisibility(const std::vector<CUnit*>& units)
+{
+	const size_t numWords = (unitHandler.MaxUnits() + 63) / 64;
+	const int numAllyTeams = teamHandler.ActiveAllyTeams();
+
+	unitVisStates.assign(unitHandler.MaxUnits(), UnitVisState());
+	unitLosBits.resize(numAllyTeams);
+	unitRadarBits.resize(numAllyTeams);
+
+	for (const CUnit* u: units) {
+		unitVisStates[u->id] = UnitVisState(u);
+	}
+
+	// each allyteam only writes its own bitsets
+	for_mt(0, numAllyTeams, [&](const int allyTeam) {
+		std::vector<uint64_t>& losBits = unitLosBits[allyTeam];
+		std::vector<uint64_t>& radarBits = unitRadarBits[allyTeam];
+
+		losBits.assign(numWords, 0);
+		radarBits.assign(numWords, 0);
+
+		for (const CUnit* u: units) {
+			if (InLos(u, allyTeam))
+				SetUnitBit(losBits, u->id);
+			if (InRadar(u, allyTeam))
+				SetUnitBit(radarBits, u->id);
+		}
+	});
+}
+
+
 void CLosHandler::Update()
 {
-	SCOPED_TIMER("Sim::Los");
+	// can run on a ThreadPool worker, see CGame::AddSimFrameStages
+	static TimerNameRegistrar timerName("Sim::Los");
+	SCOPED_MT_TIMER("Sim::Los");
 
 	const std::vector<CUnit*>& activeUnits = unitHandler.GetActiveUnits();
 
@@ -799,6 +965,10 @@ void CLosHandler::Update()
 	const size_t maxUnitIndex = minUnitIndex + losBatchSize + (activeUnits.size() % losBatchRate) * (losBatchMult == (losBatchRate - 1));
 	#endif
 
+	// reset per frame, written by index from the tasks below
+	updatedTypes.assign(losTypes.size(), nullptr);
+
+	// unit updates and the queues touch the instance caches, one task per type
 	for_mt(0, losTypes.size(), [&](const int idx) {
 		ILosType* lt = losTypes[idx];
 
@@ -814,8 +984,63 @@ void CLosHandler::Update()
 		}
 		#endif
 
-		lt->Update();
+		if (lt->BeginUpdate())
+			updatedTypes[idx] = lt;
+	});
+
+	// the remaining phases cost the most for radar and jammer types late in
+	// the game (and for the ally-teams with the most units), so each is run
+	// for all types at once, split into per ally-team map stripes, instead of
+	// letting the heaviest type make the others' threads wait for it
+	const auto ApplyAll = [&](int amount) {
+		applyJobs.clear();
+
+		for (ILosType* lt: updatedTypes) {
+			if (lt != nullptr)
+				lt->AddApplyJobs(amount, applyJobs);
+		}
+
+		for_mt(0, applyJobs.size(), [&](const int idx) {
+			applyJobs[idx].losType->Apply(applyJobs[idx]);
+		});
+	};
+
+	// remove sight
+	ApplyAll(-1);
+
+	// raycast terrain
+	recalcJobs.clear();
+
+	for (ILosType* lt: updatedTypes) {
+		if (lt == nullptr)
+			continue;
+
+		for (SLosInstance* li: lt->GetRecalcInstances()) {
+			recalcJobs.emplace_back(lt, li);
+		}
+	}
+
+	for_mt(0, recalcJobs.size(), [&](const int idx) {
+		assert(recalcJobs[idx].second->refCount > 0);
+		recalcJobs[idx].first->PrepareRaycast(recalcJobs[idx].second);
 	});
+
+	// add sight
+	ApplyAll(1);
+
+	for (ILosType* lt: updatedTypes) {
+		if (lt != nullptr)
+			lt->FinishUpdate();
+	}
+
+	UpdateUnitVisibility(activeUnits);
+}
+
+void CLosHandler::FlushReadmapEvents()
+{
+	for (ILosType* lt: losTypes) {
+		lt->FlushReadmapEvents();
+	}
 }
 
 
@@ -43,6 +43,7 @@ struct SLosInstance
 		, basePos()
 		, baseHeight(-1)
 		, refCount(0)
+		, dirtySectors(0)
 		, hashNum(-1)
 		, status(NONE)
 		, isCached(false)
@@ -65,6 +66,13 @@ public:
 	static constexpr RLE EMPTY_RLE = RLE{0,0};
 	std::vector<RLE> squares;
 
+	// squares occluded by the rays of each raycast sector (indices are local to the
+	// instance's (2r+1)^2 box), only kept after the first terrain-triggered recalc
+	// and dropped again when the instance goes into the cache
+	std::vector< std::vector<RLE> > sectorOcclusion;
+	// sectors whose rays touch terrain changed since the last recalc
+	unsigned int dirtySectors;
+
 	// helpers
 	int hashNum;
 	enum TLosStatus {
@@ -124,21 +132,52 @@ public:
 		LOS_TYPE_COUNT
 	};
 
+	// adds <amount> sight of one ally-team's batch within rows [minRow, maxRow) of its map
+	struct ApplyJob {
+		ILosType* losType;
+
+		int allyTeam;
+		int amount;
+		int minRow;
+		int maxRow;
+	};
+
 	void Init(const int mipLevel, LosType type);
 	void Kill();
 
+	size_t GetMemFootPrint() const;
+
 public:
-	void Update();
+	// an update runs in phases, which CLosHandler::Update interleaves over all
+	// types: BeginUpdate, the ApplyJobs of AddApplyJobs(-1), PrepareRaycast of
+	// every GetRecalcInstances entry, the ApplyJobs of AddApplyJobs(1), FinishUpdate
+
+	/// applies the delayed queues and sorts the queued instances by what to do with them, false if none
+	bool BeginUpdate();
+	void FinishUpdate();
+
+	/// batches the sight to remove (amount < 0) or add per ally-team and appends a job per map stripe
+	void AddApplyJobs(int amount, std::vector<ApplyJob>& jobs);
+	void Apply(const ApplyJob& job);
+
+	const std::vector<SLosInstance*>& GetRecalcInstances() const { return losRecalc; }
+	void PrepareRaycast(SLosInstance* instance) {
+		instance->squares.clear();
+		losMaps[instance->allyteam].PrepareRaycast(instance);
+	}
+
 	void UpdateHeightMapSynced(SRectangle rect);
+	void FlushReadmapEvents() {
+		for (CLosMap& losMap: losMaps) {
+			losMap.FlushReadmapEvents();
+		}
+	}
 	void RemoveUnit(CUnit* unit, bool delayed = false);
 	void UpdateUnit(CUnit* unit, bool ignore = false);
 
 private:
 	//void PostLoad();
 
-	void LosAdd(SLosInstance* instance);
-	void LosRemove(SLosInstance* instance);
-
 	void RefInstance(SLosInstance* instance);
 	void UnrefInstance(SLosInstance* instance);
 	void DelayedUnrefInstance(SLosInstance* instance);
@@ -166,9 +205,14 @@ public:
 	LosType type = LOS_TYPE_LOS;
 	LosAlgoType algoType = LOS_ALGO_RAYCAST;
 
+	// incremented by every Update that changed losMaps, see CLosMap::GetDirtyRect
+	unsigned int updateNum = 0;
+
 	static size_t cacheFails;
 	static size_t cacheHits;
 	static size_t cacheRefs;
+	static size_t sectorReuses;
+	static size_t sectorRecasts;
 
 	spring::unordered_map<int, std::vector<SLosInstance*> > instanceHashes;
 
@@ -191,8 +235,12 @@ private:
 	std::vector<SLosInstance*> losAdd;
 	std::vector<SLosInstance*> losDeleted;
 	std::vector<SLosInstance*> losRecalc;
+	std::vector< std::vector<SLosInstance*> > losBatches;
 
 	static constexpr int CACHE_SIZE = 4096;
+	// a batch gets one stripe per this many instances, each at least MIN_STRIPE_ROWS high
+	static constexpr int STRIPE_INSTANCES = 16;
+	static constexpr int MIN_STRIPE_ROWS = 16;
 };
 
 
@@ -215,6 +263,9 @@ public:
 	void Init();
 	void Kill();
 
+	// bytes held by the maps and (cached) instances of all LOS types
+	size_t GetMemFootPrint() const;
+
 	// the Interface
 	bool InLos(const CUnit* unit, int allyTeam) const;
 	bool InLos(const CWorldObject* obj, int allyTeam) const {
@@ -263,6 +314,82 @@ public:
 		return seismic.InSight(unit->pos, allyTeam);
 	}
 
+public:
+	/**
+	 * Evaluates InLos and InRadar of all <units> for every allyteam at once (in
+	 * parallel over the allyteams) into per-allyteam bitsets over unit IDs; Update
+	 * calls this each frame right after updating the LOS maps.
+	 * IsUnitInLos and IsUnitInRadar then are bit tests for as long as everything
+	 * InLos and InRadar look at stays the same. A unit that moved, (de)cloaked or
+	 * otherwise changed since, was created or taken after it, and all units after
+	 * a global LOS change, fall back to InLos and InRadar until the next update.
+	 */
+	void UpdateUnitVisibility(const std::vector<CUnit*>& units);
+
+	bool HasUnitVisibility(const CUnit* unit, int allyTeam) const {
+		if (size_t(allyTeam) >= unitLosBits.size())
+			return false;
+		if (size_t(unit->id) >= unitVisStates.size())
+			return false;
+
+		return (unitVisStates[unit->id] == UnitVisState(unit));
+	}
+	bool IsUnitInLos(const CUnit* unit, int allyTeam) const {
+		if (!HasUnitVisibility(unit, allyTeam))
+			return InLos(unit, allyTeam);
+
+		return GetUnitBit(unitLosBits[allyTeam], unit->id);
+	}
+	bool IsUnitInRadar(const CUnit* unit, int allyTeam) const {
+		if (!HasUnitVisibility(unit, allyTeam))
+			return InRadar(unit, allyTeam);
+
+		return GetUnitBit(unitRadarBits[allyTeam], unit->id);
+	}
+
+private:
+	static bool GetUnitBit(const std::vector<uint64_t>& bits, int unitID) { return ((bits[unitID >> 6] >> (unitID & 63)) & 1); }
+	static void SetUnitBit(std::vector<uint64_t>& bits, int unitID) { bits[unitID >> 6] |= (uint64_t(1) << (unitID & 63)); }
+
+	void ForgetUnitVisibility(const CUnit* unit) {
+		if (size_t(unit->id) < unitVisStates.size())
+			unitVisStates[unit->id] = {};
+	}
+
+	// the unit state InLos and InRadar depend on, beyond the maps and allyteam
+	struct UnitVisState {
+		UnitVisState() = default;
+		UnitVisState(const CUnit* unit)
+			: pos(unit->pos)
+			, speed(unit->speed)
+			, physicalState(unit->physicalState)
+			, flags(
+				(1 << 0) |
+				(unit->isCloaked     << 1) |
+				(unit->alwaysVisible << 2) |
+				(unit->useAirLos     << 3) |
+				(unit->stealth       << 4) |
+				(unit->sonarStealth  << 5) |
+				(unit->beingBuilt    << 6)
+			)
+		{}
+
+		// exact per-component comparison; float3::operator== has a relative
+		// epsilon that lets a unit far from the origin move without being seen
+		static bool Equals(const float3& a, const float3& b) { return (a.x == b.x && a.y == b.y && a.z == b.z); }
+
+		bool operator == (const UnitVisState& s) const {
+			return (Equals(pos, s.pos) && Equals(speed, s.speed) && physicalState == s.physicalState && flags == s.flags);
+		}
+
+		float3 pos;
+		float3 speed;
+
+		unsigned int physicalState = 0;
+		// bit 0 := evaluated, never set for a default-constructed (forgotten) state
+		unsigned int flags = 0;
+	};
+
 public:
 	// default operations for targeting-facilities
 	void IncreaseAllyTeamRadarErrorSize(int allyTeam) { radarErrorSizes[allyTeam] *= baseRadarErrorMult; }
@@ -297,6 +424,9 @@ public:
 public:
 	void Update() override;
 	void UpdateHeightMapSynced(SRectangle rect);
+	/// hands the ReadMap the squares that entered LOS during Update (which can
+	/// run on a ThreadPool worker), main thread only
+	void FlushReadmapEvents();
 
 public:
 	ILosType los;
@@ -324,6 +454,17 @@ private:
 
 	std::vector<float> radarErrorSizes;
 	std::array<ILosType*, 7> losTypes;
+
+	// work of all types' updates in the current frame, see Update
+	std::vector<ILosType*> updatedTypes;
+	std::vector<ILosType::ApplyJob> applyJobs;
+	std::vector< std::pair<ILosType*, SLosInstance*> > recalcJobs;
+
+	// see UpdateUnitVisibility; [unitID] := state of the unit when it was evaluated
+	std::vector<UnitVisState> unitVisStates;
+	// [allyTeam][unitID]
+	std::vector< std::vector<uint64_t> > unitLosBits;
+	std::vector< std::vector<uint64_t> > unitRadarBits;
 };
 
 
@@ -2,6 +2,9 @@
 
 #include <algorithm>
 #include <array>
+#include <limits>
+
+#include <emmintrin.h>
 
 #include "LosMap.h"
 #include "LosHandler.h"
@@ -10,6 +13,7 @@
 #include "System/float3.h"
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
+#include "System/UnorderedMap.hpp"
 #include "System/Threading/ThreadPool.h"
 #ifdef USE_UNSYNCED_HEIGHTMAP
 	#include "Game/GlobalUnsynced.h" // for myAllyTeam
@@ -23,6 +27,7 @@ static std::array<std::vector<float>, ThreadPool::MAX_THREADS> RADIUS_ISQRT_TABL
 
 static std::array<std::vector<float>, ThreadPool::MAX_THREADS> RAYCAST_ANGLE_TABLES;
 static std::array<std::vector< char>, ThreadPool::MAX_THREADS> LOSRAY_SQUARE_TABLES; // visible squares per instance
+static std::array<std::vector<  int>, ThreadPool::MAX_THREADS> SECTOR_OCCLUSION_TABLES; // occluded squares per sector
 
 
 static float isqrtTableLookup(unsigned r, int threadNum)
@@ -118,8 +123,19 @@ public:
 	typedef std::vector<int2> LosLine;
 	typedef std::vector<LosLine> LosTable;
 
+	struct LosSector {
+		std::vector<unsigned int> rays;
+
+		// bounds of all squares touched by the sector's rays (upper right quadrant)
+		int2 mins = {std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+		int2 maxs = {std::numeric_limits<int>::min(), std::numeric_limits<int>::min()};
+	};
+	typedef std::array<LosSector, CLosMap::NUM_RAYCAST_QUADRANT_SECTORS> LosSectors;
+
 	// only generates table if not in cache
 	void GenerateForLosSize(size_t losSize);
+	// only generates sectors if not in cache, requires the table
+	const LosSectors& GetLosTableSectors(size_t losSize);
 
 	const int2 GetLosTableRaySquare(size_t losSize, size_t rayIndex, size_t squareIdx) {
 		return losTables[losSize][rayIndex][squareIdx];
@@ -140,8 +156,12 @@ private:
 	//   why not precalculate only the largest and subsample?
 	std::array<LosTable, MAX_UNIT_SENSOR_RADIUS + 1> losTables;
 
+	// sparse, only radii that ever had a terrain-triggered recalc
+	spring::unordered_map<size_t, LosSectors> losSectors;
+
 private:
 	static LosLine GetRay(int x, int y);
+	static LosSectors GetLosSectors(const LosTable& losRays);
 	static LosTable GetLosRays(int radius);
 	static std::vector<int2> GetCircleSurface(const int radius);
 	static void AddMissing(LosTable& losRays, const std::vector<int2>& circlePoints, const int radius);
@@ -168,6 +188,16 @@ void CLosTableHelper::GenerateForLosSize(size_t losSize)
 	table = std::move(GetLosRays(losSize));
 }
 
+const CLosTableHelper::LosSectors& CLosTableHelper::GetLosTableSectors(size_t losSize)
+{
+	const auto it = losSectors.find(losSize);
+
+	if (it != losSectors.end())
+		return it->second;
+
+	return (losSectors[losSize] = std::move(GetLosSectors(losTables[losSize])));
+}
+
 
 
 /**
@@ -201,6 +231,33 @@ CLosTableHelper::LosTable CLosTableHelper::GetLosRays(const int radius)
 }
 
 
+/**
+ * @brief Buckets the rays of the upper right quadrant by the angle of their end point.
+ * The sector boundaries are at ~22.5, 45 and ~67.5 degrees.
+ */
+CLosTableHelper::LosSectors CLosTableHelper::GetLosSectors(const LosTable& losRays)
+{
+	static_assert(CLosMap::NUM_RAYCAST_QUADRANT_SECTORS == 4, "");
+
+	LosSectors sectors;
+
+	for (size_t i = 0; i < losRays.size(); ++i) {
+		const int2 p = losRays[i].back();
+		const size_t s = (p.y <= p.x)? ((p.y * 12 < p.x * 5)? 0: 1): ((p.x * 12 < p.y * 5)? 3: 2);
+
+		LosSector& sector = sectors[s];
+		sector.rays.push_back(i);
+
+		for (const int2 q: losRays[i]) {
+			sector.mins = {std::min(sector.mins.x, q.x), std::min(sector.mins.y, q.y)};
+			sector.maxs = {std::max(sector.maxs.x, q.x), std::max(sector.maxs.y, q.y)};
+		}
+	}
+
+	return sectors;
+}
+
+
 /**
  * @brief returns the surface coords of a 2d circle.
  * Note, we only return the upper right part, the other 3 are generated via mirroring.
@@ -404,8 +461,87 @@ void CLosTableHelper::Debug(const LosTable& losRays, const std::vector<int2>& po
 //////////////////////////////////////////////////////////////////////
 /// CLosMap implementation
 
+// adds <amount> to <len> consecutive counters, eight at a time
+// (the 16-bit lanes wrap exactly like the scalar unsigned short)
+static inline void AddToSpan(unsigned short* dst, unsigned int len, int amount)
+{
+	const __m128i inc = _mm_set1_epi16(short(amount));
+
+	unsigned int i = 0;
+
+	for (; (i + 8) <= len; i += 8) {
+		__m128i* ptr = reinterpret_cast<__m128i*>(dst + i);
+		_mm_storeu_si128(ptr, _mm_add_epi16(_mm_loadu_si128(ptr), inc));
+	}
+
+	for (; i < len; ++i) {
+		dst[i] += amount;
+	}
+}
+
+
+void CLosMap::MarkDirty(const SLosInstance* li)
+{
+	pendingDirtyRect.x1 = std::min(pendingDirtyRect.x1, std::max(li->basePos.x - li->radius, 0));
+	pendingDirtyRect.y1 = std::min(pendingDirtyRect.y1, std::max(li->basePos.y - li->radius, 0));
+	pendingDirtyRect.x2 = std::max(pendingDirtyRect.x2, std::min(li->basePos.x + li->radius + 1, size.x));
+	pendingDirtyRect.y2 = std::max(pendingDirtyRect.y2, std::min(li->basePos.y + li->radius + 1, size.y));
+}
+
+
+void CLosMap::ResetDirtyRects(unsigned int updateNum)
+{
+	pendingDirtyRect = {size.x, size.y, 0, 0};
+
+	numDirtyRects = 0;
+	lostUpdateNum = updateNum;
+}
+
+
+void CLosMap::PublishDirtyRect(unsigned int updateNum)
+{
+	if (pendingDirtyRect.x1 >= pendingDirtyRect.x2 || pendingDirtyRect.y1 >= pendingDirtyRect.y2)
+		return;
+
+	DirtyRect& dirtyRect = dirtyRects[(numDirtyRects++) % NUM_DIRTY_RECTS];
+
+	if (numDirtyRects > NUM_DIRTY_RECTS)
+		lostUpdateNum = dirtyRect.updateNum;
+
+	dirtyRect.rect = pendingDirtyRect;
+	dirtyRect.updateNum = updateNum;
+
+	pendingDirtyRect = {size.x, size.y, 0, 0};
+}
+
+
+bool CLosMap::GetDirtyRect(unsigned int sinceUpdateNum, SRectangle& rect) const
+{
+	if (sinceUpdateNum < lostUpdateNum)
+		return false;
+
+	rect = {size.x, size.y, 0, 0};
+
+	for (unsigned int i = 0, n = std::min(numDirtyRects, NUM_DIRTY_RECTS); i < n; i++) {
+		const DirtyRect& dirtyRect = dirtyRects[i];
+
+		if (dirtyRect.updateNum <= sinceUpdateNum)
+			continue;
+
+		rect.x1 = std::min(rect.x1, dirtyRect.rect.x1);
+		rect.y1 = std::min(rect.y1, dirtyRect.rect.y1);
+		rect.x2 = std::max(rect.x2, dirtyRect.rect.x2);
+		rect.y2 = std::max(rect.y2, dirtyRect.rect.y2);
+	}
+
+	return true;
+}
+
+
 void CLosMap::AddCircle(SLosInstance* instance, int amount)
 {
+	MarkDirty(instance);
+
 #ifdef USE_UNSYNCED_HEIGHTMAP
 	//only AddRaycast supports UnsyncedHeightMap updates
 #endif
@@ -417,9 +553,8 @@ void CLosMap::AddCircle(SLosInstance* instance, int amount)
 			const unsigned sx = Clamp(instance->basePos.x - width,     0, size.x);
 			const unsigned ex = Clamp(instance->basePos.x + width + 1, 0, size.x);
 
-			for (unsigned x_ = sx; x_ < ex; ++x_) {
-				losmap[(y_ * size.x) + x_] += amount;
-			}
+			if (sx < ex)
+				AddToSpan(&losmap[(y_ * size.x) + sx], ex - sx, amount);
 		}
 	});
 }
@@ -432,12 +567,11 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 	if (losSquares.empty() || losSquares[0].length == SLosInstance::EMPTY_RLE.length)
 		return;
 
+	MarkDirty(instance);
+
 #ifdef USE_UNSYNCED_HEIGHTMAP
 	// inform ReadMap when squares enter LoS
-	const bool visibleInstanceSquares = (instance->allyteam >= 0 && (instance->allyteam == gu->myAllyTeam || gu->spectatingFullView));
-	const bool updateUnsyncedHeightMap = sendReadmapEvents && visibleInstanceSquares;
-
-	if ((amount > 0) && updateUnsyncedHeightMap) {
+	if (SendsReadmapEvents(instance->allyteam, amount)) {
 		for (const SLosInstance::RLE rle: losSquares) {
 			for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
 				losmap[idx] += amount;
@@ -451,7 +585,7 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 				const int2 p2 = (lm + int2(1, 1)) * LOS2HEIGHT;
 				const int2 p3 = {std::min(p2.x, mapDims.mapxm1), std::min(p2.y, mapDims.mapym1)};
 
-				readMap->UpdateLOS(SRectangle(p1.x, p1.y,  p3.x, p3.y));
+				readmapEvents.emplace_back(p1.x, p1.y,  p3.x, p3.y);
 			}
 		}
 
@@ -460,10 +594,64 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 #endif
 
 	for (const SLosInstance::RLE rle: losSquares) {
-		for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
-			losmap[idx] += amount;
-		}
+		AddToSpan(&losmap[rle.start], rle.length, amount);
+	}
+}
+
+
+void CLosMap::AddCircleRows(const SLosInstance* instance, int amount, int minRow, int maxRow)
+{
+	MidpointCircleAlgoPerLine(instance->radius, [&](int width, int y) {
+		const int y_ = instance->basePos.y + y;
+
+		if (y_ < minRow || y_ >= maxRow)
+			return;
+
+		const unsigned sx = Clamp(instance->basePos.x - width,     0, size.x);
+		const unsigned ex = Clamp(instance->basePos.x + width + 1, 0, size.x);
+
+		if (sx < ex)
+			AddToSpan(&losmap[(y_ * size.x) + sx], ex - sx, amount);
+	});
+}
+
+void CLosMap::AddRaycastRows(const SLosInstance* instance, int amount, int minRow, int maxRow)
+{
+	const auto& losSquares = instance->squares;
+
+	if (losSquares.empty() || losSquares[0].length == SLosInstance::EMPTY_RLE.length)
+		return;
+
+	// spans index the map linearly, clip them to the squares of the rows
+	const int minIdx = minRow * size.x;
+	const int maxIdx = maxRow * size.x;
+
+	for (const SLosInstance::RLE rle: losSquares) {
+		const int sIdx = std::max(int(rle.start), minIdx);
+		const int eIdx = std::min(int(rle.start + rle.length), maxIdx);
+
+		if (sIdx < eIdx)
+			AddToSpan(&losmap[sIdx], eIdx - sIdx, amount);
+	}
+}
+
+
+void CLosMap::FlushReadmapEvents()
+{
+	for (const SRectangle& rect: readmapEvents) {
+		readMap->UpdateLOS(rect);
 	}
+
+	readmapEvents.clear();
+}
+
+bool CLosMap::SendsReadmapEvents(int allyTeam, int amount) const
+{
+#ifdef USE_UNSYNCED_HEIGHTMAP
+	return (amount > 0 && sendReadmapEvents && allyTeam >= 0 && (allyTeam == gu->myAllyTeam || gu->spectatingFullView));
+#else
+	return false;
+#endif
 }
 
 
@@ -498,8 +686,12 @@ void CLosMap::LosAdd(SLosInstance* li) const
 	const SRectangle fullRect(0, 0, size.x, size.y);
 	const SRectangle safeRect(li->radius, li->radius, size.x - li->radius, size.y - li->radius);
 
-	if (fullRect.Inside(li->basePos) && li->baseHeight <= ctrHeightMap[MAP_SQUARE_FULLRES(li->basePos)])
+	if (fullRect.Inside(li->basePos) && li->baseHeight <= ctrHeightMap[MAP_SQUARE_FULLRES(li->basePos)]) {
+		// no rays are cast, nothing to reuse on the next recalc either
+		li->sectorOcclusion.clear();
+		li->dirtySectors = 0;
 		return;
+	}
 
 	// add all squares within the instance's sight radius
 	if (safeRect.Inside(li->basePos)) {
@@ -526,13 +718,18 @@ inline void CastLos(
 	std::vector<char>& losRaySquares,
 	std::vector<float>& raycastAngles,
 	int losRadius,
-	int threadNum
+	int threadNum,
+	std::vector<int>* occludedSquares = nullptr
 ) {
 	const size_t oidx = ToAngleMapIdx(off, losRadius);
 
 	// angle to square is smaller than current max-angle, so not visible
 	if (raycastAngles[oidx] < *maxAngle) {
 		losRaySquares[oidx] = false;
+
+		if (occludedSquares != nullptr)
+			occludedSquares->push_back(oidx);
+
 		return;
 	}
 
@@ -542,6 +739,10 @@ inline void CastLos(
 
 		if (raycastAngles[oidx] < (*maxAngle = angle)) {
 			losRaySquares[oidx] = false;
+
+			if (occludedSquares != nullptr)
+				occludedSquares->push_back(oidx);
+
 			return;
 		}
 	}
@@ -550,6 +751,148 @@ inline void CastLos(
 }
 
 
+inline static int2 ToQuadrantSquare(const int2 square, const unsigned int quadrant)
+{
+	// same mirroring order as the ray loops in {Uns,S}afeLosAdd
+	switch (quadrant) {
+		case 0: return ( square                   );
+		case 1: return (-square                   );
+		case 2: return (int2( square.y, -square.x));
+		case 3: return (int2(-square.y,  square.x));
+	}
+
+	return square;
+}
+
+
+unsigned int CLosMap::GetRaycastSectors(const SLosInstance* li, const SRectangle& losRect) const
+{
+	CLosTableHelper& helper = losTableHelpers[ThreadPool::GetThreadNum()];
+
+	// rectangle relative to the instance
+	const int2 rmins = int2(losRect.x1, losRect.y1) - li->basePos;
+	const int2 rmaxs = int2(losRect.x2, losRect.y2) - li->basePos;
+
+	// the base square is not on any ray, but its height decides whether the instance sees anything
+	if (li->radius <= 0 || (rmins.x <= 0 && rmins.y <= 0 && rmaxs.x >= 0 && rmaxs.y >= 0))
+		return ALL_RAYCAST_SECTORS;
+
+	helper.GenerateForLosSize(li->radius);
+
+	const CLosTableHelper::LosSectors& sectors = helper.GetLosTableSectors(li->radius);
+
+	unsigned int mask = 0;
+
+	for (unsigned int q = 0; q < 4; ++q) {
+		for (unsigned int s = 0; s < NUM_RAYCAST_QUADRANT_SECTORS; ++s) {
+			const CLosTableHelper::LosSector& sector = sectors[s];
+
+			if (sector.rays.empty())
+				continue;
+
+			const int2 c0 = ToQuadrantSquare(sector.mins, q);
+			const int2 c1 = ToQuadrantSquare(sector.maxs, q);
+			const int2 smins = {std::min(c0.x, c1.x), std::min(c0.y, c1.y)};
+			const int2 smaxs = {std::max(c0.x, c1.x), std::max(c0.y, c1.y)};
+
+			if (smaxs.x < rmins.x || smins.x > rmaxs.x)
+				continue;
+			if (smaxs.y < rmins.y || smins.y > rmaxs.y)
+				continue;
+
+			mask |= (1u << (q * NUM_RAYCAST_QUADRANT_SECTORS + s));
+		}
+	}
+
+	return mask;
+}
+
+
+/**
+ * @brief Casts the rays of every dirty sector and re-applies the stored occlusion of the others.
+ * A square is visible iff none of the rays passing it is blocked before reaching it, so the
+ * visible set is the precalculated circle minus the union of the per-sector occluded sets.
+ * Sectors whose rays do not touch the changed terrain have the same occluded set as before.
+ *
+ * castMode: 0 = unsafe, 1 = safe with base inside the map, 2 = safe with base outside the map
+ */
+void CLosMap::CastSectorRays(SLosInstance* li, CLosTableHelper& helper, std::vector<char>& losRaySquares, std::vector<float>& raycastAngles, int castMode) const
+{
+	const int threadNum = ThreadPool::GetThreadNum();
+
+	const int2 pos   = li->basePos;
+	const int radius = li->radius;
+
+	const SRectangle mapRect(0, 0, size.x, size.y);
+	const CLosTableHelper::LosSectors& sectors = helper.GetLosTableSectors(radius);
+
+	std::vector<int>& occludedSquares = SECTOR_OCCLUSION_TABLES[threadNum];
+
+	// first terrain-triggered recalc of this instance, have to cast (and remember) everything
+	if (li->sectorOcclusion.size() != NUM_RAYCAST_SECTORS) {
+		li->sectorOcclusion.clear();
+		li->sectorOcclusion.resize(NUM_RAYCAST_SECTORS);
+		li->dirtySectors = ALL_RAYCAST_SECTORS;
+	}
+
+	if (castMode != 2)
+		losRaySquares[ToAngleMapIdx(int2(0, 0), radius)] = true;
+
+	for (unsigned int q = 0; q < 4; ++q) {
+		for (unsigned int s = 0; s < NUM_RAYCAST_QUADRANT_SECTORS; ++s) {
+			const unsigned int sectorIdx = q * NUM_RAYCAST_QUADRANT_SECTORS + s;
+
+			std::vector<SLosInstance::RLE>& sectorOcclusion = li->sectorOcclusion[sectorIdx];
+
+			if ((li->dirtySectors & (1u << sectorIdx)) == 0) {
+				for (const SLosInstance::RLE rle: sectorOcclusion) {
+					std::fill(losRaySquares.begin() + rle.start, losRaySquares.begin() + rle.start + rle.length, false);
+				}
+
+				continue;
+			}
+
+			occludedSquares.clear();
+
+			for (const unsigned int i: sectors[s].rays) {
+				float maxAngle = -1e7;
+				float prvAngle = -1e7;
+
+				const size_t numSquares = helper.GetLosTableRaySize(radius, i);
+
+				for (size_t n = 0; n < numSquares; n++) {
+					const int2 square = ToQuadrantSquare(helper.GetLosTableRaySquare(radius, i, n), q);
+
+					if (castMode != 0 && !mapRect.Inside(pos + square)) {
+						if (castMode == 1)
+							break;
+
+						continue;
+					}
+
+					CastLos(&prvAngle, &maxAngle, square, losRaySquares, raycastAngles, radius, threadNum, &occludedSquares);
+				}
+			}
+
+			std::sort(occludedSquares.begin(), occludedSquares.end());
+
+			sectorOcclusion.clear();
+
+			for (auto it = occludedSquares.begin(); it != occludedSquares.end(); ++it) {
+				if (!sectorOcclusion.empty() && int(sectorOcclusion.back().start + sectorOcclusion.back().length) >= *it) {
+					sectorOcclusion.back().length = std::max(sectorOcclusion.back().length, unsigned(*it - sectorOcclusion.back().start + 1));
+					continue;
+				}
+
+				sectorOcclusion.push_back({*it, 1});
+			}
+		}
+	}
+
+	li->dirtySectors = 0;
+}
+
+
 void CLosMap::AddSquaresToInstance(SLosInstance* li, const std::vector<char>& losRaySquares) const
 {
 	const int2 pos   = li->basePos;
@@ -650,6 +993,13 @@ void CLosMap::UnsafeLosAdd(SLosInstance* li) const
 		}
 	});
 
+	// recast only the sectors touched by a terrain change
+	if (li->dirtySectors != 0) {
+		CastSectorRays(li, helper, losRaySquares, raycastAngles, 0);
+		AddSquaresToInstance(li, losRaySquares);
+		return;
+	}
+
 	// cast the rays
 	losRaySquares[ToAngleMapIdx(int2(0, 0), radius)] = true;
 
@@ -738,6 +1088,12 @@ void CLosMap::SafeLosAdd(SLosInstance* li) const
 	});
 
 
+	if (li->dirtySectors != 0) {
+		CastSectorRays(li, helper, losRaySquares, raycastAngles, 2 - safeRect.Inside(pos));
+		AddSquaresToInstance(li, losRaySquares);
+		return;
+	}
+
 	// Cast the Rays
 	const size_t numRays = helper.GetLosTableSize(radius);
 
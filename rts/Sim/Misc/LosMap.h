@@ -5,17 +5,33 @@
 #ifndef LOS_MAP_H
 #define LOS_MAP_H
 
+#include <array>
 #include <vector>
 #include "System/type2.h"
+#include "System/Rectangle.h"
 #include "System/SpringMath.h"
+#include "System/SpringMem.h"
 
 
 struct SLosInstance;
+class CLosTableHelper;
 
 
 /// map containing counts of how many units have Line Of Sight (LOS) to each square
 class CLosMap
 {
+public:
+	// raycast instances are split into angular sectors (four per quadrant, the
+	// quadrants being the mirrored copies of the ray table) so that a terrain
+	// change only needs to recast the rays of the sectors it intersects
+	static constexpr unsigned int NUM_RAYCAST_QUADRANT_SECTORS = 4;
+	static constexpr unsigned int NUM_RAYCAST_SECTORS = NUM_RAYCAST_QUADRANT_SECTORS * 4;
+	static constexpr unsigned int ALL_RAYCAST_SECTORS = (1u << NUM_RAYCAST_SECTORS) - 1;
+
+	// number of past ILosType updates whose changed areas are remembered for
+	// incremental readers (the LOS info-textures); older ones need a full read
+	static constexpr unsigned int NUM_DIRTY_RECTS = 32;
+
 public:
 	void Init(const int2 size_, const int2 mapDims, const float* ctrHeightMap_, const float* mipHeightMap_, bool sendReadmapEvents_)
 	{
@@ -23,15 +39,18 @@ public:
 		LOS2HEIGHT = mapDims / size;
 
 		losmap.clear();
+		spring::ReserveHugePages(losmap, size.x * size.y);
 		losmap.resize(size.x * size.y, 0);
 
 		ctrHeightMap = ctrHeightMap_;
 		mipHeightMap = mipHeightMap_;
 
 		sendReadmapEvents = sendReadmapEvents_;
+
+		pendingDirtyRect = {size.x, size.y, 0, 0};
 	}
 
-	void Kill() {}
+	void Kill() { readmapEvents.clear(); }
 
 public:
 	/// circular area, for airLosMap, circular radar maps, jammer maps, ...
@@ -40,9 +59,32 @@ public:
 	/// arbitrary area, for losMap, non-circular radar maps, ...
 	void AddRaycast(SLosInstance* instance, int amount);
 
+	/// AddCircle and AddRaycast restricted to the rows [minRow, maxRow); unlike those they
+	/// do not MarkDirty, so disjoint row ranges of one map can be added to concurrently
+	void AddCircleRows(const SLosInstance* instance, int amount, int minRow, int maxRow);
+	void AddRaycastRows(const SLosInstance* instance, int amount, int minRow, int maxRow);
+
+	/// includes the squares of <instance> in the changed area of the next PublishDirtyRect
+	void MarkDirty(const SLosInstance* instance);
+
+	/// true if AddRaycast(..., amount) queues ReadMap events for the squares entering LOS
+	bool SendsReadmapEvents(int allyTeam, int amount) const;
+	/// passes the events queued by AddRaycast on to the (unsynced) ReadMap, main thread only
+	void FlushReadmapEvents();
+
 	/// arbitrary area, for losMap, non-circular radar maps, ...
 	void PrepareRaycast(SLosInstance* instance) const;
 
+	/// bitmask of the raycast sectors of <instance> whose rays touch <losRect> (LOS-map squares, inclusive)
+	unsigned int GetRaycastSectors(const SLosInstance* instance, const SRectangle& losRect) const;
+
+	/// forgets all changed areas, readers asking about updates before <updateNum> must read everything
+	void ResetDirtyRects(unsigned int updateNum);
+	/// records the squares changed since the previous call as the changed area of update <updateNum>
+	void PublishDirtyRect(unsigned int updateNum);
+	/// union of the squares changed after update <sinceUpdateNum> (empty if none), false if that is no longer known
+	bool GetDirtyRect(unsigned int sinceUpdateNum, SRectangle& rect) const;
+
 public:
 	int At(int2 p) const {
 		p.x = Clamp(p.x, 0, size.x - 1);
@@ -53,11 +95,14 @@ public:
 	// FIXME temp fix for CBaseGroundDrawer and AI interface, which need raw data
 	const unsigned short& front() const { return (losmap.front()); }
 
+	size_t GetMemFootPrint() const { return (sizeof(*this) + losmap.capacity() * sizeof(unsigned short)); }
+
 private:
 	void LosAdd(SLosInstance* instance) const;
 	void UnsafeLosAdd(SLosInstance* instance) const;
 	void SafeLosAdd(SLosInstance* instance) const;
 
+	void CastSectorRays(SLosInstance* li, CLosTableHelper& helper, std::vector<char>& losRaySquares, std::vector<float>& raycastAngles, int castMode) const;
 	void AddSquaresToInstance(SLosInstance* li, const std::vector<char>& losRaySquares) const;
 
 protected:
@@ -70,6 +115,24 @@ protected:
 	const float* mipHeightMap = nullptr;
 
 	bool sendReadmapEvents = false;
+
+	// heightmap rectangles of the squares that entered LOS since the last flush
+	std::vector<SRectangle> readmapEvents;
+
+private:
+	struct DirtyRect {
+		SRectangle rect;
+		unsigned int updateNum = 0;
+	};
+
+	std::array<DirtyRect, NUM_DIRTY_RECTS> dirtyRects;
+
+	// squares changed by Add* since the last PublishDirtyRect; x1 >= x2 := none
+	SRectangle pendingDirtyRect;
+
+	unsigned int numDirtyRects = 0;
+	// newest update whose changed area is not in dirtyRects anymore
+	unsigned int lostUpdateNum = 0;
 };
 
 #endif // LOS_MAP_H
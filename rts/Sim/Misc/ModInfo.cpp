@@ -33,6 +33,7 @@ void CModInfo::ResetState()
 		allowSepAxisCollisionTest  = false;
 		allowGroundUnitGravity     = true;
 		allowHoverUnitStrafing     = true;
+		deferUnitCollisionResponse = false;
 	}
 	{
 		constructionDecay      = true;
@@ -95,6 +96,10 @@ void CModInfo::ResetState()
 		pathFinderSystem = NOPFS_TYPE;
 		pfRawDistMult    = 1.25f;
 		pfUpdateRate     = 0.007f;
+		pfSearchMode     = 0;
+
+		pfCoalesceRequests  = true;
+		pfRequestNodeBudget = 0;
 
 		allowTake = true;
 	}
@@ -134,6 +139,9 @@ void CModInfo::Init(const std::string& modFileName)
 		pathFinderSystem = Clamp(system.GetInt("pathFinderSystem", HAPFS_TYPE), int(NOPFS_TYPE), int(PFS_TYPE_MAX));
 		pfRawDistMult = system.GetFloat("pathFinderRawDistMult", pfRawDistMult);
 		pfUpdateRate = system.GetFloat("pathFinderUpdateRate", pfUpdateRate);
+		pfSearchMode = Clamp(system.GetInt("pathFinderSearchMode", pfSearchMode), 0, 2);
+		pfCoalesceRequests = system.GetBool("pathFinderCoalesceRequests", pfCoalesceRequests);
+		pfRequestNodeBudget = std::max(0, system.GetInt("pathFinderRequestNodeBudget", pfRequestNodeBudget));
 
 		allowTake = system.GetBool("allowTake", allowTake);
 	}
@@ -152,6 +160,7 @@ void CModInfo::Init(const std::string& modFileName)
 		allowSepAxisCollisionTest = movementTbl.GetBool("allowSepAxisCollisionTest", allowSepAxisCollisionTest);
 		allowGroundUnitGravity = movementTbl.GetBool("allowGroundUnitGravity", allowGroundUnitGravity);
 		allowHoverUnitStrafing = movementTbl.GetBool("allowHoverUnitStrafing", (pathFinderSystem == QTPFS_TYPE));
+		deferUnitCollisionResponse = movementTbl.GetBool("deferUnitCollisionResponse", deferUnitCollisionResponse);
 	}
 
 	{
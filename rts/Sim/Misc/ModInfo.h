@@ -51,6 +51,7 @@ public:
 	bool allowSepAxisCollisionTest;  //< determines if (ground-)units perform collision-testing via the SAT
 	bool allowGroundUnitGravity;     //< determines if (ground-)units experience gravity during regular movement
 	bool allowHoverUnitStrafing;     //< determines if (hover-)units carry their momentum sideways when turning
+	bool deferUnitCollisionResponse; //< determines if (ground-)unit collision pushes are summed and applied in unit-ID order after all units moved
 
 	// Build behaviour
 	/// Should constructions without builders decay?
@@ -159,6 +160,14 @@ public:
 	/// which pathfinder system (NOP, DEFAULT/legacy, or QT) the mod will use
 	int pathFinderSystem;
 
+	/// default MoveDef::pathSearchMode (0 = A*, 1 = jump-point search, 2 = bidirectional A*)
+	int pfSearchMode;
+
+	/// whether similar path requests made on the same frame are coalesced, see CPathRequestBroker
+	bool pfCoalesceRequests;
+	/// nodes the path requests of one frame may expand before the rest are deferred (0 = unlimited)
+	int pfRequestNodeBudget;
+
 	float pfRawDistMult;
 	float pfUpdateRate;
 
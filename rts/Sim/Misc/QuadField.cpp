@@ -9,6 +9,11 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "System/ContainerUtil.h"
+#include "System/SpringMem.h"
+
+#ifndef UNIT_TEST
+	#include "System/TimeProfiler.h"
+#endif
 
 #ifndef UNIT_TEST
 	#include "Sim/Features/Feature.h"
@@ -30,13 +35,22 @@ CR_REG_METADATA(CQuadField, (
 	CR_IGNORED(tempFeatures),
 	CR_IGNORED(tempProjectiles),
 	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(tempQuads),
+
+	CR_IGNORED(unitQueryCache),
+	CR_IGNORED(unitQueryCacheIdx),
+	CR_IGNORED(unitQuadsEpoch),
+	CR_IGNORED(numObjectChanges),
+	CR_IGNORED(unitQueryCacheFrame),
+	CR_IGNORED(unitQueryCacheHits),
+	CR_IGNORED(unitQueryCacheMisses)
 ))
 
 CR_BIND(CQuadField::Quad, )
 CR_REG_METADATA_SUB(CQuadField, Quad, (
 	CR_MEMBER(units),
 	CR_IGNORED(teamUnits),
+	CR_IGNORED(teamUnitsMask),
 	CR_MEMBER(features),
 	CR_MEMBER(projectiles),
 	CR_MEMBER(repulsers),
@@ -102,10 +116,29 @@ void CQuadField::Quad::PostLoad()
 
 	for (CUnit* unit: units) {
 		spring::VectorInsertUnique(teamUnits[unit->allyteam], unit, false);
+		teamUnitsMask.set(unit->allyteam);
 	}
 #endif
 }
 
+#ifndef UNIT_TEST
+void CQuadField::Quad::InsertUnit(CUnit* unit)
+{
+	spring::VectorInsertUnique(units, unit, false);
+	spring::VectorInsertUnique(teamUnits[unit->allyteam], unit, false);
+
+	teamUnitsMask.set(unit->allyteam);
+}
+
+void CQuadField::Quad::EraseUnit(CUnit* unit)
+{
+	spring::VectorErase(units, unit);
+	spring::VectorErase(teamUnits[unit->allyteam], unit);
+
+	teamUnitsMask.set(unit->allyteam, !teamUnits[unit->allyteam].empty());
+}
+#endif
+
 void CQuadField::Init(int2 mapDims, int quadSize)
 {
 	quadSizeX = quadSize;
@@ -120,10 +153,13 @@ void CQuadField::Init(int2 mapDims, int quadSize)
 
 	invQuadSize = {1.0f / quadSizeX, 1.0f / quadSizeZ};
 
+	spring::ReserveHugePages(baseQuads, numQuadsX * numQuadsZ);
 	baseQuads.resize(numQuadsX * numQuadsZ);
 	tempQuads.ReserveAll(numQuadsX * numQuadsZ);
 	tempQuads.ReleaseAll();
 
+	ClearUnitQueryCache();
+
 #ifndef UNIT_TEST
 	for (Quad& quad: baseQuads) {
 		quad.Resize(teamHandler.ActiveAllyTeams());
@@ -144,6 +180,49 @@ void CQuadField::Kill()
 	tempProjectiles.ReleaseAll();
 	tempSolids.ReleaseAll();
 	tempQuads.ReleaseAll();
+
+	ClearUnitQueryCache();
+}
+
+size_t CQuadField::GetMemFootPrint() const
+{
+	size_t memFootPrint = baseQuads.capacity() * sizeof(Quad);
+
+	for (const Quad& quad: baseQuads) {
+		memFootPrint += quad.GetMemFootPrint();
+	}
+
+	return memFootPrint;
+}
+
+size_t CQuadField::Quad::GetMemFootPrint() const
+{
+	size_t memFootPrint = 0;
+
+	memFootPrint += (units.capacity() * sizeof(CUnit*));
+	memFootPrint += (teamUnits.capacity() * sizeof(std::vector<CUnit*>));
+	memFootPrint += (features.capacity() * sizeof(CFeature*));
+	memFootPrint += (projectiles.capacity() * sizeof(CProjectile*));
+	memFootPrint += (repulsers.capacity() * sizeof(CPlasmaRepulser*));
+
+	for (const auto& v: teamUnits) {
+		memFootPrint += (v.capacity() * sizeof(CUnit*));
+	}
+
+	return memFootPrint;
+}
+
+void CQuadField::ClearUnitQueryCache()
+{
+	for (UnitQueryCacheEntry& entry: unitQueryCache) {
+		entry.valid = false;
+		entry.units.clear();
+	}
+
+	unitQueryCacheIdx = 0;
+	unitQueryCacheFrame = -1;
+	unitQueryCacheHits = 0;
+	unitQueryCacheMisses = 0;
 }
 
 
@@ -164,10 +243,15 @@ int CQuadField::WorldPosToQuadFieldIdx(const float3 p) const
 
 #ifndef UNIT_TEST
 void CQuadField::GetQuads(QuadFieldQuery& qfq, float3 pos, float radius)
+{
+	qfq.quads = tempQuads.ReserveVector();
+	GetQuads(*qfq.quads, pos, radius);
+}
+
+void CQuadField::GetQuads(std::vector<int>& quads, float3 pos, float radius) const
 {
 	pos.AssertNaNs();
 	pos.ClampInBounds();
-	qfq.quads = tempQuads.ReserveVector();
 
 	const int2 min = WorldPosToQuadField(pos - radius);
 	const int2 max = WorldPosToQuadField(pos + radius);
@@ -184,12 +268,10 @@ void CQuadField::GetQuads(QuadFieldQuery& qfq, float3 pos, float radius)
 			assert(z < numQuadsZ);
 			const float3 quadPos = float3(x * quadSizeX + quadSizeX * 0.5f, 0, z * quadSizeZ + quadSizeZ * 0.5f);
 			if (pos.SqDistance2D(quadPos) < maxSqLength) {
-				qfq.quads->push_back(z * numQuadsX + x);
+				quads.push_back(z * numQuadsX + x);
 			}
 		}
 	}
-
-	return;
 }
 
 
@@ -322,8 +404,8 @@ bool CQuadField::InsertUnitIf(CUnit* unit, const float3& wpos)
 	if (!spring::VectorInsertUnique(unit->quads, wposQuadIdx, true))
 		return false;
 
-	spring::VectorInsertUnique(baseQuads[wposQuadIdx].units, unit, false);
-	spring::VectorInsertUnique(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit, false);
+	baseQuads[wposQuadIdx].InsertUnit(unit);
+	UnitQuadsChanged();
 	return true;
 }
 
@@ -352,8 +434,8 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 	if (!spring::VectorErase(unit->quads, wposQuadIdx))
 		return false;
 
-	spring::VectorErase(baseQuads[wposQuadIdx].units, unit);
-	spring::VectorErase(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit);
+	baseQuads[wposQuadIdx].EraseUnit(unit);
+	UnitQuadsChanged();
 	return true;
 }
 #endif
@@ -363,6 +445,8 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 #ifndef UNIT_TEST
 void CQuadField::MovedUnit(CUnit* unit)
 {
+	ObjectsChanged();
+
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, unit->pos, unit->radius);
 
@@ -373,26 +457,27 @@ void CQuadField::MovedUnit(CUnit* unit)
 	}
 
 	for (const int qi: unit->quads) {
-		spring::VectorErase(baseQuads[qi].units, unit);
-		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		baseQuads[qi].EraseUnit(unit);
 	}
 
 	for (const int qi: *qfQuery.quads) {
-		spring::VectorInsertUnique(baseQuads[qi].units, unit, false);
-		spring::VectorInsertUnique(baseQuads[qi].teamUnits[unit->allyteam], unit, false);
+		baseQuads[qi].InsertUnit(unit);
 	}
 
 	unit->quads = std::move(*qfQuery.quads);
+	UnitQuadsChanged();
 }
 
 void CQuadField::RemoveUnit(CUnit* unit)
 {
+	ObjectsChanged();
+
 	for (const int qi: unit->quads) {
-		spring::VectorErase(baseQuads[qi].units, unit);
-		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		baseQuads[qi].EraseUnit(unit);
 	}
 
 	unit->quads.clear();
+	UnitQuadsChanged();
 
 	#ifdef DEBUG_QUADFIELD
 	for (const Quad& q: baseQuads) {
@@ -450,6 +535,8 @@ void CQuadField::RemoveRepulser(CPlasmaRepulser* repulser)
 
 void CQuadField::AddFeature(CFeature* feature)
 {
+	ObjectsChanged();
+
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, feature->pos, feature->radius);
 
@@ -460,6 +547,8 @@ void CQuadField::AddFeature(CFeature* feature)
 
 void CQuadField::RemoveFeature(CFeature* feature)
 {
+	ObjectsChanged();
+
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, feature->pos, feature->radius);
 
@@ -529,12 +618,55 @@ void CQuadField::RemoveProjectile(CProjectile* p)
 
 
 
-void CQuadField::GetUnits(QuadFieldQuery& qfq, const float3& pos, float radius)
+const std::vector<CUnit*>& CQuadField::GetCachedUnitCandidates(const float3& a, const float3& b, bool rectangle)
 {
+	if (unitQueryCacheFrame != gs->frameNum) {
+		if (unitQueryCacheHits != 0 || unitQueryCacheMisses != 0) {
+			profiler.AddCounter("Sim::QuadField::UnitQueryCache::Hits", unitQueryCacheHits);
+			profiler.AddCounter("Sim::QuadField::UnitQueryCache::Misses", unitQueryCacheMisses);
+		}
+
+		for (UnitQueryCacheEntry& entry: unitQueryCache) {
+			entry.valid = false;
+		}
+
+		unitQueryCacheFrame = gs->frameNum;
+		unitQueryCacheHits = 0;
+		unitQueryCacheMisses = 0;
+	}
+
+	for (const UnitQueryCacheEntry& entry: unitQueryCache) {
+		if (!entry.valid || entry.epoch != unitQuadsEpoch)
+			continue;
+		if (entry.rectangle != rectangle || entry.a != a || entry.b != b)
+			continue;
+
+		unitQueryCacheHits += 1;
+		return entry.units;
+	}
+
+	UnitQueryCacheEntry& entry = unitQueryCache[unitQueryCacheIdx];
+
+	unitQueryCacheIdx += 1;
+	unitQueryCacheIdx %= unitQueryCache.size();
+	unitQueryCacheMisses += 1;
+
+	entry.a = a;
+	entry.b = b;
+	entry.epoch = unitQuadsEpoch;
+	entry.rectangle = rectangle;
+	entry.valid = true;
+	entry.units.clear();
+
 	QuadFieldQuery qfQuery;
-	GetQuads(qfQuery, pos, radius);
+
+	if (rectangle) {
+		GetQuadsRectangle(qfQuery, a, b);
+	} else {
+		GetQuads(qfQuery, a, b.x);
+	}
+
 	const int tempNum = gs->GetTempNum();
-	qfq.units = tempUnits.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
@@ -542,69 +674,57 @@ void CQuadField::GetUnits(QuadFieldQuery& qfq, const float3& pos, float radius)
 				continue;
 
 			u->tempNum = tempNum;
-			qfq.units->push_back(u);
+			entry.units.push_back(u);
 		}
 	}
 
-	return;
+	return entry.units;
 }
 
-void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float radius, bool spherical)
+
+void CQuadField::GetUnits(QuadFieldQuery& qfq, const float3& pos, float radius)
 {
-	QuadFieldQuery qfQuery;
-	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.units = tempUnits.ReserveVector();
+	const std::vector<CUnit*>& candidates = GetCachedUnitCandidates(pos, {radius, 0.0f, 0.0f}, false);
 
-	for (const int qi: *qfQuery.quads) {
-		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
-				continue;
+	qfq.units = tempUnits.ReserveVector(0, candidates.size());
+	qfq.units->assign(candidates.begin(), candidates.end());
+}
 
-			u->tempNum = tempNum;
+void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float radius, bool spherical)
+{
+	const std::vector<CUnit*>& candidates = GetCachedUnitCandidates(pos, {radius, 0.0f, 0.0f}, false);
 
-			const float totRad       = radius + u->radius;
-			const float totRadSq     = totRad * totRad;
-			const float posUnitDstSq = spherical?
-				pos.SqDistance(u->pos):
-				pos.SqDistance2D(u->pos);
+	qfq.units = tempUnits.ReserveVector();
 
-			if (posUnitDstSq >= totRadSq)
-				continue;
+	for (CUnit* u: candidates) {
+		const float totRad       = radius + u->radius;
+		const float totRadSq     = totRad * totRad;
+		const float posUnitDstSq = spherical?
+			pos.SqDistance(u->pos):
+			pos.SqDistance2D(u->pos);
 
-			qfq.units->push_back(u);
-		}
-	}
+		if (posUnitDstSq >= totRadSq)
+			continue;
 
-	return;
+		qfq.units->push_back(u);
+	}
 }
 
 void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const float3& maxs)
 {
-	QuadFieldQuery qfQuery;
-	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
-	qfq.units = tempUnits.ReserveVector();
-
-	for (const int qi: *qfQuery.quads) {
-		for (CUnit* unit: baseQuads[qi].units) {
-
-			if (unit->tempNum == tempNum)
-				continue;
+	const std::vector<CUnit*>& candidates = GetCachedUnitCandidates(mins, maxs, true);
 
-			unit->tempNum = tempNum;
+	qfq.units = tempUnits.ReserveVector();
 
-			const float3& pos = unit->pos;
-			if (pos.x < mins.x || pos.x > maxs.x)
-				continue;
-			if (pos.z < mins.z || pos.z > maxs.z)
-				continue;
+	for (CUnit* unit: candidates) {
+		const float3& pos = unit->pos;
+		if (pos.x < mins.x || pos.x > maxs.x)
+			continue;
+		if (pos.z < mins.z || pos.z > maxs.z)
+			continue;
 
-			qfq.units->push_back(unit);
-		}
+		qfq.units->push_back(unit);
 	}
-
-	return;
 }
 
 
@@ -885,4 +1005,47 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 		}
 	}
 }
+
+void CQuadField::GetUnitsAndFeaturesColVolMT(
+	const float3& pos,
+	const float radius,
+	std::vector<int>& quads,
+	std::vector<CUnit*>& units,
+	std::vector<CFeature*>& features,
+	std::vector<CPlasmaRepulser*>* repulsers
+) const {
+	// same results (and order) as GetUnitsAndFeaturesColVol, but objects spanning
+	// several quads are deduplicated against the outputs instead of via tempNum
+	const auto AddObject = [&](auto* o, auto& objects, const float3& objPos) {
+		const float totRad = radius + o->collisionVolume.GetBoundingRadius();
+
+		if (pos.SqDistance(objPos) >= (totRad * totRad))
+			return;
+		if (std::find(objects.begin(), objects.end(), o) != objects.end())
+			return;
+
+		objects.push_back(o);
+	};
+
+	quads.clear();
+	GetQuads(quads, pos, radius);
+
+	for (const int qi: quads) {
+		const Quad& quad = baseQuads[qi];
+
+		for (CUnit* u: quad.units) {
+			AddObject(u, units, u->collisionVolume.GetWorldSpacePos(u));
+		}
+		for (CFeature* f: quad.features) {
+			AddObject(f, features, f->collisionVolume.GetWorldSpacePos(f));
+		}
+
+		if (repulsers == nullptr)
+			continue;
+
+		for (CPlasmaRepulser* r: quad.repulsers) {
+			AddObject(r, *repulsers, r->weaponMuzzlePos);
+		}
+	}
+}
 #endif // UNIT_TEST
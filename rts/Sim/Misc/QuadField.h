@@ -5,8 +5,11 @@
 
 #include <algorithm>
 #include <array>
+#include <bitset>
+#include <cstdint>
 #include <vector>
 
+#include "Sim/Misc/GlobalConstants.h"
 #include "System/Misc/NonCopyable.h"
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
@@ -93,6 +96,7 @@ public:
 	void Kill();
 
 	void GetQuads(QuadFieldQuery& qfq, float3 pos, float radius);
+	void GetQuads(std::vector<int>& quads, float3 pos, float radius) const;
 	void GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, const float3& maxs);
 	void GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const float3& dir, float length);
 
@@ -103,6 +107,18 @@ public:
 		std::vector<CFeature*>& features,
 		std::vector<CPlasmaRepulser*>* repulsers = nullptr
 	);
+	/**
+	 * Thread-safe variant of GetUnitsAndFeaturesColVol, for read-only passes
+	 * run on workers; does not use tempNum or the query vector caches
+	 */
+	void GetUnitsAndFeaturesColVolMT(
+		const float3& pos,
+		const float radius,
+		std::vector<int>& quads,
+		std::vector<CUnit*>& units,
+		std::vector<CFeature*>& features,
+		std::vector<CPlasmaRepulser*>* repulsers = nullptr
+	) const;
 
 	/**
 	 * Returns all units within @c radius of @c pos,
@@ -120,6 +136,13 @@ public:
 	 * mins and maxs, which extends infinitely along the y-axis
 	 */
 	void GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const float3& maxs);
+	/**
+	 * Returns a superset of the units GetUnitsExact(qfq, mins, maxs) would, all
+	 * (deduplicated) units in the quads touched by the rectangle, for callers
+	 * that apply the bounds test in their own filtering pass; the reference is
+	 * only valid until the next unit query
+	 */
+	const std::vector<CUnit*>& GetUnitCandidatesExact(const float3& mins, const float3& maxs) { return (GetCachedUnitCandidates(mins, maxs, true)); }
 	/**
 	 * Returns all features within @c radius of @c pos,
 	 * takes the 3D model radius of each feature into account,
@@ -167,6 +190,12 @@ public:
 	void MovedRepulser(CPlasmaRepulser* repulser);
 	void RemoveRepulser(CPlasmaRepulser* repulser);
 
+	// bumped whenever a unit or feature is moved, added or removed (or has
+	// its collision-relevant state changed by Lua); lets callers tell if a
+	// query result gathered earlier in the frame could have gone stale
+	void ObjectsChanged() { numObjectChanges += 1; }
+	unsigned int GetNumObjectChanges() const { return numObjectChanges; }
+
 	void ReleaseVector(std::vector<CUnit*>* v       ) { tempUnits.ReleaseVector(v); }
 	void ReleaseVector(std::vector<CFeature*>* v    ) { tempFeatures.ReleaseVector(v); }
 	void ReleaseVector(std::vector<CProjectile*>* v ) { tempProjectiles.ReleaseVector(v); }
@@ -185,6 +214,7 @@ public:
 		Quad& operator = (Quad&& q) {
 			units = std::move(q.units);
 			teamUnits = std::move(q.teamUnits);
+			teamUnitsMask = q.teamUnitsMask;
 			features = std::move(q.features);
 			projectiles = std::move(q.projectiles);
 			repulsers = std::move(q.repulsers);
@@ -200,14 +230,24 @@ public:
 			for (auto& v: teamUnits) {
 				v.clear();
 			}
+			teamUnitsMask.reset();
 			features.clear();
 			projectiles.clear();
 			repulsers.clear();
 		}
 
+		void InsertUnit(CUnit* unit);
+		void EraseUnit(CUnit* unit);
+
+		// lets allyteam-filtered queries skip quads without touching teamUnits
+		bool HasAllyTeamUnits(int allyTeam) const { return teamUnitsMask[allyTeam]; }
+
+		size_t GetMemFootPrint() const;
+
 	public:
 		std::vector<CUnit*> units;
 		std::vector< std::vector<CUnit*> > teamUnits;
+		std::bitset<MAX_TEAMS> teamUnitsMask; // bit i is set iff teamUnits[i] is non-empty
 		std::vector<CFeature*> features;
 		std::vector<CProjectile*> projectiles;
 		std::vector<CPlasmaRepulser*> repulsers;
@@ -229,12 +269,33 @@ public:
 	int GetQuadSizeX() const { return quadSizeX; }
 	int GetQuadSizeZ() const { return quadSizeZ; }
 
+	// bytes held by the per-quad object lists
+	size_t GetMemFootPrint() const;
+
 	constexpr static unsigned int BASE_QUAD_SIZE = 128;
 
 private:
 	int2 WorldPosToQuadField(const float3 p) const;
 	int WorldPosToQuadFieldIdx(const float3 p) const;
 
+	// returns the deduplicated units in all quads touched by a circular
+	// (<a> = pos, <b> = {radius, 0, 0}) or rectangular (<a> = mins, <b> =
+	// maxs) query area, without any exact distance or bounds filtering
+	const std::vector<CUnit*>& GetCachedUnitCandidates(const float3& a, const float3& b, bool rectangle);
+	void ClearUnitQueryCache();
+	void UnitQuadsChanged() { unitQuadsEpoch += 1; }
+
+	struct UnitQueryCacheEntry {
+		float3 a;
+		float3 b;
+
+		unsigned int epoch = 0;
+		bool rectangle = false;
+		bool valid = false;
+
+		std::vector<CUnit*> units;
+	};
+
 private:
 	std::vector<Quad> baseQuads;
 
@@ -245,6 +306,20 @@ private:
 	QueryVectorCache<CSolidObject*> tempSolids;
 	QueryVectorCache<int> tempQuads;
 
+	// candidate sets of recent Get{Units,UnitsExact} queries; an entry is valid
+	// until any unit enters or leaves a quad, and the cache is flushed (and its
+	// hit-rate reported to the profiler) once per frame
+	std::array<UnitQueryCacheEntry, 16> unitQueryCache;
+
+	unsigned int unitQueryCacheIdx = 0;
+	unsigned int unitQuadsEpoch = 0;
+	unsigned int numObjectChanges = 0;
+
+	int unitQueryCacheFrame = -1;
+
+	uint64_t unitQueryCacheHits = 0;
+	uint64_t unitQueryCacheMisses = 0;
+
 	float2 invQuadSize;
 
 	int numQuadsX;
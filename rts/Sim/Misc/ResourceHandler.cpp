@@ -124,9 +124,19 @@ const CResourceMapAnalyzer* CResourceHandler::GetResourceMapAnalyzer(int resourc
 
 	CResourceMapAnalyzer* rma = &resourceMapAnalyzers[resourceId];
 
-	if (rma->GetNumSpots() < 0)
-		rma->Init();
+	// finishes a background analysis if one was started
+	rma->Init();
 
 	return rma;
 }
 
+void CResourceHandler::InitResourceMapAnalyzers()
+{
+	for (size_t resourceId = 0; resourceId < resourceMapAnalyzers.size(); resourceId++) {
+		if (GetResourceMap(resourceId) == nullptr)
+			continue;
+
+		resourceMapAnalyzers[resourceId].Init(true);
+	}
+}
+
@@ -103,6 +103,13 @@ public:
 	 * Returns the resource map analyzer by index.
 	 */
 	const CResourceMapAnalyzer* GetResourceMapAnalyzer(int resourceId);
+	/**
+	 * @brief	start analyzing all resource maps in the background
+	 *
+	 * Called while loading when there are local Skirmish AIs, s.t. the
+	 * analysis is usually done before GetResourceMapAnalyzer is called.
+	 */
+	void InitResourceMapAnalyzers();
 
 	size_t GetNumResources() const { return resourceDescriptions.size(); }
 
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <string>
 #include <cstdio>
 
@@ -18,22 +19,32 @@ using std::fclose;
 #include "Game/GameSetup.h"
 #include "Map/MapInfo.h"
 #include "Map/MetalMap.h"
+#include "Map/ReadMap.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
+#include "System/StringUtil.h"
+#include "System/Sync/HsiehHash.h"
+#include "System/Threading/ThreadPool.h"
 
 #include <stdexcept>
 
 static constexpr float3 ERRORVECTOR(-1, 0, 0);
 static std::string CACHE_BASE("");
 
+// bump whenever the analysis or the cache layout changes
+static constexpr std::uint32_t CACHE_VERSION = 2;
+
 CResourceMapAnalyzer::CResourceMapAnalyzer(int resourceId)
 	: resourceId(resourceId)
 	, numSpotsFound(-1)
 
 	, extractorRadius(-1.0f)
 	, averageIncome(0.0f)
+	, maxWorth(0.0f)
+
+	, cacheKey(0)
 
 	, stopMe(false)
 
@@ -110,14 +121,29 @@ float3 CResourceMapAnalyzer::GetNearestSpot(float3 fromPos, int team, const Unit
 }
 
 
-void CResourceMapAnalyzer::Init() {
+void CResourceMapAnalyzer::Init(bool async) {
+	if (initTask != nullptr) {
+		FinishInit();
+
+		if (cacheKey == GetCacheKey())
+			return;
+
+		LOG_L(L_WARNING, "[RMA::%s] resource-map %d changed during analysis, redoing it", __func__, resourceId);
+		numSpotsFound = -1;
+	}
+
+	if (numSpotsFound >= 0)
+		return;
+
 	const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
+	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
 
 	mapWidth = resourceHandler->GetResourceMapWidth(resourceId);
 	mapHeight = resourceHandler->GetResourceMapHeight(resourceId);
 
 	totalCells = mapHeight * mapWidth;
 	extractorRadius = resource->extractorRadius;
+	maxWorth = resource->maxWorth;
 	xtractorRadius = static_cast<int>(extractorRadius / (SQUARE_SIZE * 2));
 	doubleRadius = xtractorRadius * 2;
 	squareRadius = xtractorRadius * xtractorRadius;
@@ -130,11 +156,44 @@ void CResourceMapAnalyzer::Init() {
 
 	tempAverage.resize(totalCells);
 
+	vectoredSpots.clear();
+	maxResource = 0;
+	stopMe = false;
+
+	// resources without a map (eg. energy) have no spots
+	if (resourceMapArray == nullptr || totalCells == 0) {
+		numSpotsFound = 0;
+		return;
+	}
+
+	// everything the analysis reads from the engine is copied here, so it can run on any thread
+	std::copy(resourceMapArray, resourceMapArray + totalCells, rexArrayA.begin());
+
+	cacheKey = GetCacheKey();
+	cacheFileName = GetCacheFileName();
+
 	// if there's no available load file, create one and save it
-	if (!LoadResourceMap()) {
+	if (LoadResourceMap())
+		return;
+
+	if (!async) {
 		GetResourcePoints();
 		SaveResourceMap();
+		return;
 	}
+
+	initTask = ThreadPool::Enqueue([this]() {
+		GetResourcePoints();
+		SaveResourceMap();
+	});
+}
+
+void CResourceMapAnalyzer::FinishInit() {
+	if (initTask == nullptr)
+		return;
+
+	initTask->get();
+	initTask.reset();
 }
 
 float CResourceMapAnalyzer::GetAverageIncome() const {
@@ -151,14 +210,13 @@ void CResourceMapAnalyzer::GetResourcePoints() {
 		xend[a] = int(math::sqrt(floatsqrradius - z * z));
 	}
 
-	// load up the resource values in each pixel
-	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
+	// the resource values in each pixel were loaded up by Init
 	double totalResourcesDouble  = 0;
 
 	for (int i = 0; i < totalCells; i++) {
 		// count the total resources so you can work out
 		// an average of the whole map
-		totalResourcesDouble +=  rexArrayA[i] = resourceMapArray[i];
+		totalResourcesDouble += rexArrayA[i];
 	}
 
 	// do the average
@@ -170,80 +228,46 @@ void CResourceMapAnalyzer::GetResourcePoints() {
 		return;
 
 	// Now work out how much resources each spot can make
-	// by adding up the resources from nearby spots
-	for (int y = 0; y < mapHeight; y++) {
-		for (int x = 0; x < mapWidth; x++) {
-			totalResources = 0;
-
-			// first spot needs full calculation
-			if (x == 0 && y == 0)
-				for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-					if (sy >= 0 && sy < mapHeight){
-						for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
-							if (sx >= 0 && sx < mapWidth) {
-								// get the resources from all pixels around the extractor radius
-								totalResources += rexArrayA[sy * mapWidth + sx];
-							}
-						}
-					}
-				}
-
-			// quick calc test
-			if (x > 0) {
-				totalResources = tempAverage[y * mapWidth + x - 1];
-				for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-					if (sy >= 0 && sy < mapHeight) {
-						const int addX = x + xend[a];
-						const int remX = x - xend[a] - 1;
-
-						if (addX < mapWidth) {
-							totalResources += rexArrayA[sy * mapWidth + addX];
-						}
-						if (remX >= 0) {
-							totalResources -= rexArrayA[sy * mapWidth + remX];
-						}
-					}
-				}
-			} else if (y > 0) {
-				// x == 0 here
-				totalResources = tempAverage[(y - 1) * mapWidth];
-				// remove the top half
-				int a = xtractorRadius;
-
-				for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-					if (sx < mapWidth) {
-						const int remY = y - xend[a] - 1;
-
-						if (remY >= 0) {
-							totalResources -= rexArrayA[remY * mapWidth + sx];
-						}
-					}
+	// by adding up the resources from nearby spots; rows
+	// do not depend on each other, only on rexArrayA
+	for_mt(0, mapHeight, [&](const int y) {
+		int rowResources = 0;
+
+		// first spot of each row needs full calculation
+		for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+			if (sy >= 0 && sy < mapHeight) {
+				for (int sx = 0; sx <= xend[a] && sx < mapWidth; sx++) {
+					// get the resources from all pixels around the extractor radius
+					rowResources += rexArrayA[sy * mapWidth + sx];
 				}
+			}
+		}
 
-				// add the bottom half
-				a = xtractorRadius;
+		tempAverage[y * mapWidth] = rowResources;
 
-				for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-					if (sx < mapWidth) {
-						const int addY = y + xend[a];
+		// quick calc for the others
+		for (int x = 1; x < mapWidth; x++) {
+			for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+				if (sy >= 0 && sy < mapHeight) {
+					const int addX = x + xend[a];
+					const int remX = x - xend[a] - 1;
 
-						if (addY < mapHeight) {
-							totalResources += rexArrayA[addY * mapWidth + sx];
-						}
+					if (addX < mapWidth) {
+						rowResources += rexArrayA[sy * mapWidth + addX];
+					}
+					if (remX >= 0) {
+						rowResources -= rexArrayA[sy * mapWidth + remX];
 					}
 				}
 			}
 
 			// set that spot's resource making ability
-			// (divide by cells to values are small)
-			tempAverage[y * mapWidth + x] = totalResources;
-
-			if (maxResource < totalResources) {
-				// find the spot with the highest resource value to set as the map's max
-				maxResource = totalResources;
-			}
+			tempAverage[y * mapWidth + x] = rowResources;
 		}
-	}
+	});
+
+	// find the spot with the highest resource value to set as the map's max
+	maxResource = *std::max_element(tempAverage.begin(), tempAverage.end());
 
 	// make a list for the distribution of values
 	std::vector<int> valueDist(256, 0);
@@ -388,8 +412,7 @@ void CResourceMapAnalyzer::GetResourcePoints() {
 			bufferSpot.x = coordX * (SQUARE_SIZE * 2) + SQUARE_SIZE;
 			bufferSpot.z = coordZ * (SQUARE_SIZE * 2) + SQUARE_SIZE;
 			// gets the actual amount of resource an extractor can make
-			const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
-			bufferSpot.y = tempResources * (resource->maxWorth) * maxResource / 255;
+			bufferSpot.y = tempResources * maxWorth * maxResource / 255;
 			vectoredSpots.push_back(bufferSpot);
 
 			// plot TGA array (not necessary) for debug
@@ -508,7 +531,6 @@ static inline void writeToFile(const T& value, FILE* file) {
 
 void CResourceMapAnalyzer::SaveResourceMap() {
 
-	const std::string cacheFileName = GetCacheFileName();
 	FILE* saveFile = fopen(cacheFileName.c_str(), "wb");
 
 	try {
@@ -516,6 +538,8 @@ void CResourceMapAnalyzer::SaveResourceMap() {
 			throw std::runtime_error("failed to open file for writing");
 
 		assert(numSpotsFound != -1);
+		writeToFile(CACHE_VERSION, saveFile);
+		writeToFile(cacheKey, saveFile);
 		writeToFile(numSpotsFound, saveFile);
 		writeToFile(averageIncome, saveFile);
 		for (int i = 0; i < numSpotsFound; i++) {
@@ -525,7 +549,8 @@ void CResourceMapAnalyzer::SaveResourceMap() {
 		LOG_L(L_WARNING, "Failed to save the analyzed resource-map to file %s, reason: %s", cacheFileName.c_str(), err.what());
 	}
 
-	fclose(saveFile);
+	if (saveFile != nullptr)
+		fclose(saveFile);
 }
 
 static void fileReadChecked(void* buf, size_t size, size_t count, FILE* fstream) {
@@ -539,13 +564,24 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 
 	bool loaded = false;
 
-	const std::string cacheFileName = GetCacheFileName();
-
 	FILE* cacheFile = fopen(cacheFileName.c_str(), "rb");
 
 	if (cacheFile != nullptr) {
 		try {
+			std::uint32_t fileVersion = 0;
+			std::uint32_t fileKey = 0;
+
+			fileReadChecked(&fileVersion, sizeof(fileVersion), 1, cacheFile);
+			fileReadChecked(&fileKey, sizeof(fileKey), 1, cacheFile);
+
+			if (fileVersion != CACHE_VERSION || fileKey != cacheKey)
+				throw std::runtime_error("stale cache");
+
 			fileReadChecked(&numSpotsFound, sizeof(int), 1, cacheFile);
+
+			if (numSpotsFound < 0 || numSpotsFound > maxSpots)
+				throw std::runtime_error("invalid number of spots");
+
 			vectoredSpots.resize(numSpotsFound);
 			fileReadChecked(&averageIncome, sizeof(float), 1, cacheFile);
 			for (int i = 0; i < numSpotsFound; i++) {
@@ -554,6 +590,9 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 			loaded = true;
 		} catch (const std::runtime_error& err) {
 			LOG_L(L_WARNING, "Failed to load the resource map cache from file %s: %s", cacheFileName.c_str(), err.what());
+
+			numSpotsFound = -1;
+			vectoredSpots.clear();
 		}
 		fclose(cacheFile);
 	}
@@ -562,10 +601,23 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 }
 
 
+std::uint32_t CResourceMapAnalyzer::GetCacheKey() const {
+
+	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
+
+	std::uint32_t key = readMap->GetMapChecksum();
+
+	key = HsiehHash(resourceMapArray, totalCells, key);
+	key = HsiehHash(&extractorRadius, sizeof(extractorRadius), key);
+	key = HsiehHash(&maxWorth, sizeof(maxWorth), key);
+
+	return key;
+}
+
 std::string CResourceMapAnalyzer::GetCacheFileName() const {
 
 	const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
-	std::string absFile = CACHE_BASE + gameSetup->mapName + resource->name;
+	std::string absFile = CACHE_BASE + gameSetup->mapName + resource->name + IntToString(cacheKey, "-%08x");
 
 	return absFile;
 }
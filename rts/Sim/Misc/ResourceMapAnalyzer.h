@@ -4,6 +4,11 @@
 #define _RESOURCE_MAP_ANALYZER_H
 
 #include "System/float3.h"
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
 #include <vector>
 
 class CResource;
@@ -12,9 +17,15 @@ struct UnitDef;
 class CResourceMapAnalyzer {
 public:
 	CResourceMapAnalyzer(int resourceId);
+	~CResourceMapAnalyzer() { FinishInit(); }
 
-	// deferred to ResourceHandler
-	void Init();
+	/**
+	 * Deferred to ResourceHandler. If async is true and there is no cached
+	 * analysis for the map, the spots are searched for by a worker thread;
+	 * a later synchronous Init waits for it and redoes the analysis if the
+	 * resource map was changed in the meantime (eg. by Lua).
+	 */
+	void Init(bool async = false);
 
 	/**
 	 * Returns positions indicating where to place resource extractors on the map.
@@ -33,10 +44,12 @@ public:
 	int GetNumSpots() const { return numSpotsFound; }
 
 private:
+	void FinishInit();
 	void GetResourcePoints();
 	void SaveResourceMap();
 	bool LoadResourceMap();
 
+	std::uint32_t GetCacheKey() const;
 	std::string GetCacheFileName() const;
 
 	int resourceId;
@@ -44,6 +57,13 @@ private:
 
 	float extractorRadius;
 	float averageIncome;
+	float maxWorth;
+
+	// hash over the resource map and everything else the analysis depends on
+	std::uint32_t cacheKey;
+	std::string cacheFileName;
+
+	std::shared_ptr<std::future<void>> initTask;
 
 	bool stopMe;
 
@@ -15,6 +15,9 @@
 
 SmoothHeightMesh smoothGround;
 
+static constexpr int BLUR_PASSES_COUNT = 2;
+static constexpr float GAUSSIAN_SIGMA = 5.0f;
+
 
 static float Interpolate(float x, float y, const int maxx, const int maxy, const float res, const float* heightmap)
 {
@@ -54,6 +57,11 @@ void SmoothHeightMesh::Kill() {
 
 	mesh.clear();
 	origMesh.clear();
+
+	winHeights.clear();
+	winMaxima.clear();
+	winMesh[0].clear();
+	winMesh[1].clear();
 }
 
 
@@ -371,30 +379,8 @@ void SmoothHeightMesh::MakeSmoothMesh()
 	// use sliding window of maximums to reduce computational complexity
 	const int winSize = smoothRadius / resolution;
 	const int blurSize = std::max(1, winSize / 2);
-	constexpr int blurPassesCount = 2;
-
-	const auto fillGaussianKernelFunc = [blurSize](std::vector<float>& gaussianKernel, const float sigma) {
-		gaussianKernel.resize(blurSize + 1);
-
-		const auto gaussianG = [](const int x, const float sigma) -> float {
-			// 0.3989422804f = 1/sqrt(2*pi)
-			return 0.3989422804f * math::expf(-0.5f * x * x / (sigma * sigma)) / sigma;
-		};
-
-		float sum = (gaussianKernel[0] = gaussianG(0, sigma));
-
-		for (int i = 1; i < blurSize + 1; ++i) {
-			sum += 2.0f * (gaussianKernel[i] = gaussianG(i, sigma));
-		}
-
-		for (auto& gk : gaussianKernel) {
-			gk /= sum;
-		}
-	};
 
-	constexpr float gSigma = 5.0f;
-	std::vector<float> gaussianKernel;
-	fillGaussianKernelFunc(gaussianKernel, gSigma);
+	MakeGaussianKernel();
 
 	assert(mesh.empty());
 	mesh.resize((maxx + 1) * (maxy + 1), 0.0f);
@@ -418,7 +404,7 @@ void SmoothHeightMesh::MakeSmoothMesh()
 	}
 
 	// actually smooth with approximate Gaussian blur passes
-	for (int numBlurs = blurPassesCount; numBlurs > 0; --numBlurs) {
+	for (int numBlurs = BLUR_PASSES_COUNT; numBlurs > 0; --numBlurs) {
 		BlurHorizontal(maxx, maxy, blurSize, resolution, gaussianKernel, mesh, origMesh); mesh.swap(origMesh);
 		BlurVertical(maxx, maxy, blurSize, resolution, gaussianKernel, mesh, origMesh); mesh.swap(origMesh);
 	}
@@ -426,3 +412,179 @@ void SmoothHeightMesh::MakeSmoothMesh()
 	// <mesh> now contains the final smoothed heightmap, save it in origMesh
 	std::copy(mesh.begin(), mesh.end(), origMesh.begin());
 }
+
+void SmoothHeightMesh::MakeGaussianKernel()
+{
+	const int winSize = smoothRadius / resolution;
+	const int blurSize = std::max(1, winSize / 2);
+
+	const auto gaussianG = [](const int x, const float sigma) -> float {
+		// 0.3989422804f = 1/sqrt(2*pi)
+		return 0.3989422804f * math::expf(-0.5f * x * x / (sigma * sigma)) / sigma;
+	};
+
+	gaussianKernel.resize(blurSize + 1);
+
+	float sum = (gaussianKernel[0] = gaussianG(0, GAUSSIAN_SIGMA));
+
+	for (int i = 1; i < blurSize + 1; ++i) {
+		sum += 2.0f * (gaussianKernel[i] = gaussianG(i, GAUSSIAN_SIGMA));
+	}
+
+	for (auto& gk : gaussianKernel) {
+		gk /= sum;
+	}
+}
+
+
+
+// dst[k * dstStep] = max(src[i * srcStep]) for i in [first + k - winSize, first + k + winSize] (clamped to
+// [0, srcCount - 1]); monotonic queue of candidate indices, so amortized O(1) per element independent of winSize
+static void SlidingMaxima(
+	const float* src,
+	const int srcStep,
+	const int srcCount,
+	float* dst,
+	const int dstStep,
+	const int dstFirst,
+	const int dstCount,
+	const int winSize,
+	std::vector<int>& queue
+) {
+	queue.clear();
+
+	size_t head = 0;
+	int next = std::max(0, dstFirst - winSize);
+
+	for (int k = 0; k < dstCount; ++k) {
+		const int center = dstFirst + k;
+		const int last = std::min(srcCount - 1, center + winSize);
+
+		for (; next <= last; ++next) {
+			while (queue.size() > head && src[queue.back() * srcStep] <= src[next * srcStep])
+				queue.pop_back();
+
+			queue.push_back(next);
+		}
+
+		while (queue[head] < (center - winSize))
+			head++;
+
+		dst[k * dstStep] = src[queue[head] * srcStep];
+	}
+}
+
+void SmoothHeightMesh::MapChanged(int x1, int z1, int x2, int z2)
+{
+	if (mesh.empty())
+		return;
+
+	const int winSize = smoothRadius / resolution;
+	const int blurSize = std::max(1, winSize / 2);
+	const int blurRange = BLUR_PASSES_COUNT * blurSize;
+
+	// the blur passes (and the final mesh) cover <maxx> cols by <maxy> rows, the
+	// column maxima also include row <maxy> like FindMaximumColumnHeights does
+	const auto ClampRect = [&](SRectangle r, int maxCol, int maxRow) {
+		r.x1 = std::clamp(r.x1, 0, maxCol); r.x2 = std::clamp(r.x2, 0, maxCol);
+		r.z1 = std::clamp(r.z1, 0, maxRow); r.z2 = std::clamp(r.z2, 0, maxRow);
+		return r;
+	};
+
+	// mesh points whose interpolated ground height changed, inclusive (padded by one against truncation)
+	const SRectangle chgRect = {
+		int(((x1 - 1) * SQUARE_SIZE) / resolution) - 1,
+		int(((z1 - 1) * SQUARE_SIZE) / resolution) - 1,
+		int(((x2 + 1) * SQUARE_SIZE) / resolution) + 1,
+		int(((z2 + 1) * SQUARE_SIZE) / resolution) + 1,
+	};
+	// final mesh points that see the change through the maximum-filter and the blurs
+	const SRectangle outRect = ClampRect({chgRect.x1 - winSize - blurRange, chgRect.z1 - winSize - blurRange, chgRect.x2 + winSize + blurRange, chgRect.z2 + winSize + blurRange}, maxx - 1, maxy - 1);
+	// maximum-filtered points the blurs of outRect read
+	const SRectangle winRect = ClampRect({outRect.x1 - blurRange, outRect.z1 - blurRange, outRect.x2 + blurRange, outRect.z2 + blurRange}, maxx - 1, maxy - 1);
+	// ground heights the maximum-filter of winRect reads
+	const SRectangle hgtRect = ClampRect({winRect.x1 - winSize, winRect.z1 - winSize, winRect.x2 + winSize, winRect.z2 + winSize}, maxx - 1, maxy);
+
+	const int winCols = winRect.x2 - winRect.x1 + 1;
+	const int winRows = winRect.z2 - winRect.z1 + 1;
+	const int hgtCols = hgtRect.x2 - hgtRect.x1 + 1;
+	const int hgtRows = hgtRect.z2 - hgtRect.z1 + 1;
+
+	winHeights.resize(hgtCols * hgtRows);
+	winMaxima.resize(hgtCols * winRows);
+	winMesh[0].resize(winCols * winRows);
+	winMesh[1].resize(winCols * winRows);
+
+	for (int y = hgtRect.z1; y <= hgtRect.z2; ++y) {
+		for (int x = hgtRect.x1; x <= hgtRect.x2; ++x) {
+			winHeights[(x - hgtRect.x1) + (y - hgtRect.z1) * hgtCols] = CGround::GetHeightReal(x * resolution, y * resolution);
+		}
+	}
+
+	// separable maximum-filter, equivalent to the sliding window of MakeSmoothMesh; first per column over rows...
+	for (int x = 0; x < hgtCols; ++x) {
+		SlidingMaxima(&winHeights[x], hgtCols, hgtRows, &winMaxima[x], hgtCols, winRect.z1 - hgtRect.z1, winRows, winSize, winQueue);
+	}
+	// ...then per row over the column maxima
+	for (int y = 0; y < winRows; ++y) {
+		SlidingMaxima(&winMaxima[y * hgtCols], 1, hgtCols, &winMesh[0][y * winCols], 1, winRect.x1 - hgtRect.x1, winCols, winSize, winQueue);
+	}
+
+	// blur passes, in MakeSmoothMesh's order and with its exact arithmetic; every pass
+	// leaves a smaller valid area since its inputs have to lie inside the window (or
+	// be clamped to the map edges)
+	SRectangle valRect = winRect;
+
+	const auto BlurPass = [&](const std::vector<float>& src, std::vector<float>& dst, bool horizontal) {
+		SRectangle r = valRect;
+
+		if (horizontal) {
+			r.x1 += (blurSize * (r.x1 > 0));
+			r.x2 -= (blurSize * (r.x2 < (maxx - 1)));
+		} else {
+			r.z1 += (blurSize * (r.z1 > 0));
+			r.z2 -= (blurSize * (r.z2 < (maxy - 1)));
+		}
+
+		for (int y = r.z1; y <= r.z2; ++y) {
+			for (int x = r.x1; x <= r.x2; ++x) {
+				float avg = 0.0f;
+
+				if (horizontal) {
+					for (int x1 = x - blurSize; x1 <= x + blurSize; ++x1)
+						avg += gaussianKernel[abs(x1 - x)] * src[(std::max(0, std::min(maxx - 1, x1)) - winRect.x1) + (y - winRect.z1) * winCols];
+				} else {
+					for (int y1 = y - blurSize; y1 <= y + blurSize; ++y1)
+						avg += gaussianKernel[abs(y1 - y)] * src[(x - winRect.x1) + (std::max(0, std::min(maxy - 1, y1)) - winRect.z1) * winCols];
+				}
+
+				const float ghaw = winHeights[(x - hgtRect.x1) + (y - hgtRect.z1) * hgtCols];
+
+				dst[(x - winRect.x1) + (y - winRect.z1) * winCols] = std::clamp(std::max(ghaw, avg), readMap->GetCurrMinHeight(), readMap->GetCurrMaxHeight());
+			}
+		}
+
+		valRect = r;
+	};
+
+	for (int numBlurs = BLUR_PASSES_COUNT; numBlurs > 0; --numBlurs) {
+		BlurPass(winMesh[0], winMesh[1], true);
+		BlurPass(winMesh[1], winMesh[0], false);
+	}
+
+	assert(valRect.x1 <= outRect.x1 && valRect.x2 >= outRect.x2);
+	assert(valRect.z1 <= outRect.z1 && valRect.z2 >= outRect.z2);
+
+	for (int y = outRect.z1; y <= outRect.z2; ++y) {
+		for (int x = outRect.x1; x <= outRect.x2; ++x) {
+			const int idx = x + y * maxx;
+			const float h = winMesh[0][(x - winRect.x1) + (y - winRect.z1) * winCols];
+
+			// points set through Spring.{Set,Add}SmoothMesh* are left alone
+			if (mesh[idx] == origMesh[idx])
+				mesh[idx] = h;
+
+			origMesh[idx] = h;
+		}
+	}
+}
@@ -5,6 +5,8 @@
 
 #include <vector>
 
+#include "System/Rectangle.h"
+
 class CGround;
 
 /**
@@ -22,6 +24,13 @@ public:
 	float AddHeight(int index, float h);
 	float SetMaxHeight(int index, float h);
 
+	/**
+	 * Recomputes the part of the mesh that depends on the (inclusive)
+	 * heightmap-square rectangle [x1,x2]x[z1,z2]. Mesh points that Lua
+	 * changed keep their value, only their original height is updated.
+	 */
+	void MapChanged(int x1, int z1, int x2, int z2);
+
 	int GetMaxX() const { return maxx; }
 	int GetMaxY() const { return maxy; }
 	float GetFMaxX() const { return fmaxx; }
@@ -33,6 +42,7 @@ public:
 
 private:
 	void MakeSmoothMesh();
+	void MakeGaussianKernel();
 
 	int maxx = 0;
 	int maxy = 0;
@@ -46,6 +56,14 @@ private:
 
 	std::vector<float> colsMaxima;
 	std::vector<int> maximaRows;
+
+	std::vector<float> gaussianKernel;
+
+	// scratch-space for MapChanged
+	std::vector<float> winHeights;
+	std::vector<float> winMaxima;
+	std::vector<float> winMesh[2];
+	std::vector<int> winQueue;
 };
 
 extern SmoothHeightMesh smoothGround;
@@ -4,6 +4,8 @@
 
 #include "System/Platform/byteorder.h"
 
+#include <ostream>
+
 
 CR_BIND(TeamStatistics, )
 CR_REG_METADATA(TeamStatistics, (
@@ -81,3 +83,22 @@ void TeamStatistics::swab()
 	swabDWordInPlace(unitsKilled);
 }
 
+
+void TeamStatistics::OutputJSON(std::ostream& out) const
+{
+	out << "{\"frame\": " << frame;
+	out << ", \"metalUsed\": " << metalUsed << ", \"energyUsed\": " << energyUsed;
+	out << ", \"metalProduced\": " << metalProduced << ", \"energyProduced\": " << energyProduced;
+	out << ", \"metalExcess\": " << metalExcess << ", \"energyExcess\": " << energyExcess;
+	out << ", \"metalReceived\": " << metalReceived << ", \"energyReceived\": " << energyReceived;
+	out << ", \"metalSent\": " << metalSent << ", \"energySent\": " << energySent;
+	out << ", \"damageDealt\": " << damageDealt << ", \"damageReceived\": " << damageReceived;
+	out << ", \"unitsProduced\": " << unitsProduced;
+	out << ", \"unitsDied\": " << unitsDied;
+	out << ", \"unitsReceived\": " << unitsReceived;
+	out << ", \"unitsSent\": " << unitsSent;
+	out << ", \"unitsCaptured\": " << unitsCaptured;
+	out << ", \"unitsOutCaptured\": " << unitsOutCaptured;
+	out << ", \"unitsKilled\": " << unitsKilled;
+	out << "}";
+}
@@ -7,6 +7,7 @@
 #include "System/Platform/byteorder.h"
 
 #include <cstring>
+#include <iosfwd>
 
 #pragma pack(push, 1)
 
@@ -40,6 +41,9 @@ struct TeamStatistics
 	/// Change structure from host endian to little endian or vice versa.
 	void swab();
 
+	/// Write all fields as one JSON object, keyed by their member names.
+	void OutputJSON(std::ostream& out) const;
+
 	/// In intervalls of this many seconds, statistics are updated
 	static const int statsPeriod = 15;
 };
@@ -5,6 +5,7 @@
 #include "Game/GlobalUnsynced.h"
 #include "Map/Ground.h"
 #include "Map/MapInfo.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Rendering/Env/Particles/Classes/SmokeProjectile.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/SmoothHeightMesh.h"
@@ -41,7 +42,11 @@ CR_REG_METADATA(AAirMoveType, (
 
 	CR_MEMBER(lastCollidee),
 
-	CR_MEMBER(crashExpGenID)
+	CR_MEMBER(crashExpGenID),
+
+	CR_IGNORED(groundSampleHeights),
+	CR_IGNORED(groundSamplePos),
+	CR_IGNORED(groundSampleFrame)
 ))
 
 
@@ -108,6 +113,36 @@ AAirMoveType::AAirMoveType(CUnit* unit): AMoveType(unit)
 }
 
 
+void AAirMoveType::SampleGroundHeights()
+{
+	const float3& pos = owner->pos;
+
+	// three lookups cover all functions, the results are the same bit for bit
+	const float groundHeight = CGround::GetHeightReal(pos.x, pos.z);
+	const float approxHeight = CGround::GetApproximateHeight(pos.x, pos.z);
+	const float smoothHeight = smoothGround.GetHeight(pos.x, pos.z);
+
+	groundSampleHeights[0] = std::max(0.0f, groundHeight);
+	groundSampleHeights[1] = groundHeight;
+	groundSampleHeights[2] = std::max(0.0f, smoothHeight);
+	groundSampleHeights[3] = std::max(0.0f, smoothHeight);
+	groundSampleHeights[4] = std::max(smoothHeight, approxHeight);
+	groundSampleHeights[5] = std::max(smoothHeight, groundSampleHeights[0]);
+
+	groundSamplePos = pos;
+	groundSampleFrame = gs->frameNum;
+}
+
+float AAirMoveType::GetGroundHeight(unsigned int funcIdx, float x, float z) const
+{
+	// the owner usually has not moved yet when its altitude is checked
+	if (groundSampleFrame == gs->frameNum && x == groundSamplePos.x && z == groundSamplePos.z)
+		return groundSampleHeights[funcIdx];
+
+	return (amtGetGroundHeightFuncs[funcIdx](x, z));
+}
+
+
 bool AAirMoveType::UseSmoothMesh() const {
 	if (!useSmoothMesh)
 		return false;
@@ -155,7 +190,7 @@ void AAirMoveType::UpdateLanded()
 	// lowered) later and we do not want to end up hovering
 	// in mid-air or sink below it
 	// let gravity do the job instead of teleporting
-	const float minHeight = amtGetGroundHeightFuncs[owner->unitDef->canSubmerge](owner->pos.x, owner->pos.z);
+	const float minHeight = GetGroundHeight(owner->unitDef->canSubmerge, owner->pos.x, owner->pos.z);
 	const float curHeight = owner->pos.y;
 
 	if (curHeight > minHeight) {
@@ -191,14 +226,14 @@ void AAirMoveType::LandAt(float3 pos, float distanceSq)
 	owner->Block();
 	owner->Move(originalPos, false);
 
-	wantedHeight = reservedLandingPos.y - amtGetGroundHeightFuncs[owner->unitDef->canSubmerge](reservedLandingPos.x, reservedLandingPos.z);
+	wantedHeight = reservedLandingPos.y - GetGroundHeight(owner->unitDef->canSubmerge, reservedLandingPos.x, reservedLandingPos.z);
 }
 
 
 void AAirMoveType::UpdateLandingHeight(float newWantedHeight)
 {
 	wantedHeight = newWantedHeight;
-	reservedLandingPos.y = wantedHeight + amtGetGroundHeightFuncs[owner->unitDef->canSubmerge](reservedLandingPos.x, reservedLandingPos.z);
+	reservedLandingPos.y = wantedHeight + GetGroundHeight(owner->unitDef->canSubmerge, reservedLandingPos.x, reservedLandingPos.z);
 }
 
 
@@ -211,7 +246,7 @@ void AAirMoveType::UpdateLanding()
 	const float distSq = reservedLandingPos.SqDistance(pos);
 
 
-	const float localAltitude = pos.y - amtGetGroundHeightFuncs[owner->unitDef->canSubmerge](owner->pos.x, owner->pos.z);
+	const float localAltitude = pos.y - GetGroundHeight(owner->unitDef->canSubmerge, owner->pos.x, owner->pos.z);
 
 	if (distSq <= radiusSq || (distSq < landRadiusSq && localAltitude < wantedHeight + radius)) {
 		SetState(AIRCRAFT_LANDED);
@@ -3,6 +3,8 @@
 #ifndef A_AIR_MOVE_TYPE_H_
 #define A_AIR_MOVE_TYPE_H_
 
+#include <array>
+
 #include "MoveType.h"
 
 /**
@@ -60,9 +62,16 @@ public:
 
 	void DependentDied(CObject* o);
 
+	/// evaluates all amtGetGroundHeightFuncs at the owner's position for this
+	/// frame; only reads map data and writes the cache, so may run in parallel
+	void SampleGroundHeights();
+
 protected:
 	void CheckForCollision();
 
+	/// amtGetGroundHeightFuncs[funcIdx](x, z), from the cache if sampled there
+	float GetGroundHeight(unsigned int funcIdx, float x, float z) const;
+
 public:
 	AircraftState aircraftState = AIRCRAFT_LANDED;
 	CollisionState collisionState = COLLISION_NOUNIT;
@@ -94,6 +103,12 @@ protected:
 	CUnit* lastCollidee = nullptr;
 
 	unsigned int crashExpGenID = -1u;
+
+	/// not saved, only valid during the frame they were sampled in
+	std::array<float, 6> groundSampleHeights;
+	float3 groundSamplePos;
+
+	int groundSampleFrame = -1;
 };
 
 #endif // A_AIR_MOVE_TYPE_H_
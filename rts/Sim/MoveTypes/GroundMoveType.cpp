@@ -2352,6 +2352,7 @@ void CGroundMoveType::HandleUnitCollisions(
 	const bool allowPEU = modInfo.allowPushingEnemyUnits;
 	const bool allowSAT = modInfo.allowSepAxisCollisionTest;
 	const bool forceSAT = (colliderParams.z > 0.1f);
+	const bool deferUCR = modInfo.deferUnitCollisionResponse;
 
 	// copy on purpose, since the below can call Lua
 	QuadFieldQuery qfQuery;
@@ -2520,6 +2521,18 @@ void CGroundMoveType::HandleUnitCollisions(
 		const bool moveCollider = ((pushCollider || !pushCollidee) && colliderMobile);
 		const bool moveCollidee = ((pushCollidee || !pushCollider) && collideeMobile);
 
+		if (deferUCR) {
+			// responses are tested and applied by CUnitHandler once all
+			// move-types have updated, so neither party sees the other's
+			// push (or the pushes of earlier colliders) until next frame
+			if (moveCollider)
+				unitHandler.AddDeferredPush(collider, colliderMoveVec);
+			if (moveCollidee)
+				unitHandler.AddDeferredPush(collidee, collideeMoveVec);
+
+			continue;
+		}
+
 		if (moveCollider && colliderMD->TestMoveSquare(collider, collider->pos + colliderMoveVec, colliderMoveVec))
 			collider->Move(colliderMoveVec, true);
 
@@ -97,7 +97,6 @@ static bool UnitIsBusy(const CUnit* u) { return (UnitIsBusy(u->commandAI)); }
 static bool UnitHasLoadCmd(const CUnit* u) { return (UnitHasLoadCmd(u->commandAI)); }
 
 
-extern AAirMoveType::GetGroundHeightFunc amtGetGroundHeightFuncs[6];
 extern AAirMoveType::EmitCrashTrailFunc amtEmitCrashTrailFuncs[2];
 
 
@@ -389,7 +388,7 @@ void CHoverAirMoveType::UpdateTakeoff()
 
 	UpdateAirPhysics();
 
-	const float curAltitude = pos.y - amtGetGroundHeightFuncs[canSubmerge](pos.x, pos.z);
+	const float curAltitude = pos.y - GetGroundHeight(canSubmerge, pos.x, pos.z);
 	const float minAltitude = orgWantedHeight * 0.8f;
 
 	if (curAltitude <= minAltitude)
@@ -439,7 +438,7 @@ void CHoverAirMoveType::UpdateFlying()
 	}
 
 	const float goalDistSq2D = goalVec.SqLength2D();
-	const float groundHeight = amtGetGroundHeightFuncs[4 * UseSmoothMesh()](pos.x, pos.z);
+	const float groundHeight = GetGroundHeight(4 * UseSmoothMesh(), pos.x, pos.z);
 
 	const bool closeToGoal = (flyState == FLY_ATTACKING)?
 		(goalDistSq2D < (             400.0f)):
@@ -789,8 +788,8 @@ void CHoverAirMoveType::UpdateAirPhysics()
 	// if this aircraft uses the smoothmesh, these values are
 	// calculated with respect to that when changing vertical
 	// speed (but not for ground collision)
-	float cpGroundHeight = amtGetGroundHeightFuncs[canSubmerge](     pos.x,      pos.z);
-	float bpGroundHeight = amtGetGroundHeightFuncs[canSubmerge](brakePos.x, brakePos.z);
+	float cpGroundHeight = GetGroundHeight(canSubmerge,      pos.x,      pos.z);
+	float bpGroundHeight = GetGroundHeight(canSubmerge, brakePos.x, brakePos.z);
 
 	if (((gs->frameNum + owner->id) & 3) == 0)
 		CheckForCollision();
@@ -833,8 +832,8 @@ void CHoverAirMoveType::UpdateAirPhysics()
 	}
 
 
-	cpGroundHeight = amtGetGroundHeightFuncs[UseSmoothMesh() * 2 + canSubmerge](     pos.x,      pos.z);
-	bpGroundHeight = amtGetGroundHeightFuncs[UseSmoothMesh() * 2 + canSubmerge](brakePos.x, brakePos.z);
+	cpGroundHeight = GetGroundHeight(UseSmoothMesh() * 2 + canSubmerge,      pos.x,      pos.z);
+	bpGroundHeight = GetGroundHeight(UseSmoothMesh() * 2 + canSubmerge, brakePos.x, brakePos.z);
 
 	// compute new vertical speed
 	// NOTE:
@@ -935,7 +934,7 @@ bool CHoverAirMoveType::Update()
 		case AIRCRAFT_CRASHING: {
 			UpdateAirPhysics();
 
-			if ((CGround::GetHeightAboveWater(owner->pos.x, owner->pos.z) + 5.0f + owner->radius) > owner->pos.y) {
+			if ((GetGroundHeight(0, owner->pos.x, owner->pos.z) + 5.0f + owner->radius) > owner->pos.y) {
 				owner->ForcedKillUnit(nullptr, true, false);
 			} else {
 				#define SPIN_DIR(o) ((o->id & 1) * 2 - 1)
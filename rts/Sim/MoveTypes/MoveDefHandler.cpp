@@ -5,6 +5,7 @@
 #include "Map/MapInfo.h"
 #include "MoveMath/MoveMath.h"
 #include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/ModInfo.h"
 #include "System/creg/STL_Map.h"
 #include "System/Exceptions.h"
 #include "System/CRC.h"
@@ -47,7 +48,9 @@ CR_REG_METADATA(MoveDef, (
 	CR_MEMBER(allowRawMovement),
 
 	CR_MEMBER(heatMapping),
-	CR_MEMBER(flowMapping)
+	CR_MEMBER(flowMapping),
+
+	CR_MEMBER(pathSearchMode)
 ))
 
 CR_REG_METADATA(MoveDefHandler, (
@@ -138,6 +141,18 @@ void MoveDefHandler::Init(LuaParser* defsParser)
 	crc << CMoveMath::noHoverWaterMove;
 
 	mdChecksum = crc.GetDigest();
+
+	CMoveMath::InitSpeedModMaps();
+}
+
+void MoveDefHandler::Kill()
+{
+	CMoveMath::KillSpeedModMaps();
+
+	nameMap.clear(); // never iterated
+
+	mdCounter = 0;
+	mdChecksum = 0;
 }
 
 
@@ -219,6 +234,8 @@ MoveDef::MoveDef(const LuaTable& moveDefTable): MoveDef() {
 	heatMapping = moveDefTable.GetBool("heatMapping", false);
 	flowMapping = moveDefTable.GetBool("flowMapping", true);
 
+	pathSearchMode = static_cast<PathSearchMode>(Clamp(moveDefTable.GetInt("pathSearchMode", modInfo.pfSearchMode), int(PATH_SEARCH_ASTAR), int(PATH_SEARCH_MODES - 1)));
+
 	heatMod = moveDefTable.GetFloat("heatMod", (1.0f / (GAME_SPEED * 2)) * 0.25f);
 	flowMod = moveDefTable.GetFloat("flowMod", 1.0f);
 
@@ -334,6 +351,25 @@ bool MoveDef::TestMoveSquareRange(
 	return retTestMove;
 }
 
+bool MoveDef::TestMoveSquareTerrain(const float3 testMovePos, const float3 testMoveDir, bool centerOnly) const
+{
+	const int xmin = int(testMovePos.x / SQUARE_SIZE) - xsizeh * (1 - centerOnly);
+	const int zmin = int(testMovePos.z / SQUARE_SIZE) - zsizeh * (1 - centerOnly);
+	const int xmax = int(testMovePos.x / SQUARE_SIZE) + xsizeh * (1 - centerOnly);
+	const int zmax = int(testMovePos.z / SQUARE_SIZE) + zsizeh * (1 - centerOnly);
+
+	const float3 testMoveDir2D = (testMoveDir * XZVector).SafeNormalize2D();
+
+	for (int z = zmin; z <= zmax; z += 1) {
+		for (int x = xmin; x <= xmax; x += 1) {
+			if (CMoveMath::GetPosSpeedMod(*this, x, z, testMoveDir2D) <= 0.0f)
+				return false;
+		}
+	}
+
+	return true;
+}
+
 
 
 float MoveDef::CalcFootPrintMinExteriorRadius(float scale) const { return ((math::sqrt((xsize * xsize + zsize * zsize)) * 0.5f * SQUARE_SIZE) * scale); }
@@ -50,6 +50,9 @@ struct MoveDef {
 	) const {
 		return (TestMoveSquareRange(collider, testMovePos, testMovePos, testMoveDir, testTerrain, testObjects, centerOnly, minSpeedModPtr, maxBlockBitPtr));
 	}
+	/// terrain part of TestMoveSquare(..., true, false); never touches the blocking-map
+	/// (RangeIsBlocked and its shared dedup-counter), so it is safe to call from any thread
+	bool TestMoveSquareTerrain(const float3 testMovePos, const float3 testMoveDir, bool centerOnly = false) const;
 
 	// aircraft and buildings defer to UnitDef::floatOnWater
 	bool FloatOnWater() const { return (speedModClass == MoveDef::Hover || speedModClass == MoveDef::Ship); }
@@ -95,6 +98,13 @@ struct MoveDef {
 		SPEEDMOD_MOBILE_MOVE_MULT = 2,
 		SPEEDMOD_MOBILE_NUM_MULTS = 3,
 	};
+	/// search variant used by the max-res (PF) layer of the default pathfinders
+	enum PathSearchMode {
+		PATH_SEARCH_ASTAR = 0,
+		PATH_SEARCH_JPS   = 1, /// jump-point search over uniform-cost regions
+		PATH_SEARCH_BIDIR = 2, /// bidirectional A*
+		PATH_SEARCH_MODES = 3,
+	};
 
 	std::string name;
 
@@ -149,6 +159,9 @@ struct MoveDef {
 	bool heatMapping = true;
 	bool flowMapping = true;
 #pragma pack(pop)
+
+	/// not part of the checksum; PE vertex costs are always computed by plain A*
+	PathSearchMode pathSearchMode = PATH_SEARCH_ASTAR;
 };
 
 
@@ -159,12 +172,7 @@ class MoveDefHandler
 	CR_DECLARE_STRUCT(MoveDefHandler)
 public:
 	void Init(LuaParser* defsParser);
-	void Kill() {
-		nameMap.clear(); // never iterated
-
-		mdCounter = 0;
-		mdChecksum = 0;
-	}
+	void Kill();
 
 	MoveDef* GetMoveDefByPathType(unsigned int pathType) { return &moveDefs[pathType]; }
 	MoveDef* GetMoveDefByName(const std::string& name);
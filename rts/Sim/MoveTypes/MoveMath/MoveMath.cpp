@@ -6,15 +6,21 @@
 #include "Map/MapInfo.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/MoveTypes/MoveType.h"
 #include "Sim/Objects/SolidObject.h"
 #include "Sim/Units/Unit.h"
 #include "System/Platform/Threading.h"
+#include "System/Threading/ThreadPool.h"
 
 bool CMoveMath::noHoverWaterMove = false;
 float CMoveMath::waterDamageCost = 0.0f;
 
+// non-directional speed-modifiers of every half-resolution square, one map per MoveDef
+// (indexed by pathType); these only change along with the heightmap or the terrain-types
+static std::vector<float> speedModMaps;
+
 static constexpr int FOOTPRINT_XSTEP = 2;
 static constexpr int FOOTPRINT_ZSTEP = 2;
 
@@ -45,13 +51,68 @@ float CMoveMath::yLevel(const MoveDef& moveDef, const float3& pos)
 
 
 
-/* calculate the local speed-modifier for this MoveDef */
-float CMoveMath::GetPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsigned zSquare)
+void CMoveMath::InitSpeedModMaps()
 {
-	if (xSquare >= mapDims.mapx || zSquare >= mapDims.mapy)
-		return 0.0f;
+	speedModMaps.clear();
+	speedModMaps.resize(moveDefHandler.GetNumMoveDefs() * mapDims.hmapx * mapDims.hmapy, 0.0f);
 
-	const int square = (xSquare >> 1) + ((zSquare >> 1) * mapDims.hmapx);
+	UpdateSpeedModMaps({0, 0, mapDims.mapx, mapDims.mapy});
+}
+
+void CMoveMath::KillSpeedModMaps()
+{
+	speedModMaps.clear();
+	speedModMaps.shrink_to_fit();
+}
+
+void CMoveMath::UpdateSpeedModMaps(const SRectangle& hgtMapRect)
+{
+	// same range as CReadMap::UpdateSlopemap, which extends the rectangle the heightmap was
+	// updated for by one square and the resulting half-resolution one by another
+	const int sx = std::max(0,                  ((hgtMapRect.x1 - 1) / 2) - 1);
+	const int ex = std::min(mapDims.hmapx - 1, ((hgtMapRect.x2 + 1) / 2) + 1);
+	const int sz = std::max(0,                  ((hgtMapRect.z1 - 1) / 2) - 1);
+	const int ez = std::min(mapDims.hmapy - 1, ((hgtMapRect.z2 + 1) / 2) + 1);
+
+	const int numSquares = mapDims.hmapx * mapDims.hmapy;
+
+	for_mt(sz, ez + 1, [&](const int z) {
+		for (unsigned int i = 0, n = moveDefHandler.GetNumMoveDefs(); i < n; i++) {
+			const MoveDef* md = moveDefHandler.GetMoveDefByPathType(i);
+
+			float* speedModMap = &speedModMaps[i * numSquares];
+
+			for (int x = sx; x <= ex; x++) {
+				speedModMap[z * mapDims.hmapx + x] = CalcPosSpeedMod(*md, z * mapDims.hmapx + x);
+			}
+		}
+	});
+}
+
+void CMoveMath::TerrainTypeSpeedModChanged(int ttIndex)
+{
+	const unsigned char* typeMap = readMap->GetTypeMapSynced();
+
+	const int numSquares = mapDims.hmapx * mapDims.hmapy;
+
+	for_mt(0, mapDims.hmapy, [&](const int z) {
+		for (int x = 0; x < mapDims.hmapx; x++) {
+			const int square = z * mapDims.hmapx + x;
+
+			if (typeMap[square] != ttIndex)
+				continue;
+
+			for (unsigned int i = 0, n = moveDefHandler.GetNumMoveDefs(); i < n; i++) {
+				speedModMaps[i * numSquares + square] = CalcPosSpeedMod(*moveDefHandler.GetMoveDefByPathType(i), square);
+			}
+		}
+	});
+}
+
+
+/* calculate the local speed-modifier for this MoveDef */
+float CMoveMath::CalcPosSpeedMod(const MoveDef& moveDef, int square)
+{
 	const int squareTerrType = readMap->GetTypeMapSynced()[square];
 
 	const float height  = readMap->GetMIPHeightMapSynced(1)[square];
@@ -70,11 +131,26 @@ float CMoveMath::GetPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsign
 	return 0.0f;
 }
 
+float CMoveMath::GetPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsigned zSquare)
+{
+	if (xSquare >= mapDims.mapx || zSquare >= mapDims.mapy)
+		return 0.0f;
+
+	const int square = (xSquare >> 1) + ((zSquare >> 1) * mapDims.hmapx);
+
+	assert(moveDef.pathType < moveDefHandler.GetNumMoveDefs());
+	return speedModMaps[moveDef.pathType * (mapDims.hmapx * mapDims.hmapy) + square];
+}
+
 float CMoveMath::GetPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsigned zSquare, float3 moveDir)
 {
 	if (xSquare >= mapDims.mapx || zSquare >= mapDims.mapy)
 		return 0.0f;
 
+	// the directional ground and hover modifiers equal the cached ones unless enabled
+	if (!modInfo.allowDirectionalPathing && moveDef.speedModClass != MoveDef::Ship)
+		return (GetPosSpeedMod(moveDef, xSquare, zSquare));
+
 	const int square = (xSquare >> 1) + ((zSquare >> 1) * mapDims.hmapx);
 	const int squareTerrType = readMap->GetTypeMapSynced()[square];
 
@@ -121,6 +197,9 @@ CMoveMath::BlockType CMoveMath::IsBlockedNoSpeedModCheck(const MoveDef& moveDef,
 		const int zOffset = z * mapDims.mapx;
 
 		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
+			if (groundBlockingObjectMap.GetCellMaskUnsafe(zOffset + x) == CGroundBlockingObjectMap::CELL_MASK_NONE)
+				continue;
+
 			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
 
 			for (size_t i = 0, n = cell.size(); i < n; i++) {
@@ -164,6 +243,9 @@ CMoveMath::BlockType CMoveMath::IsBlockedNoSpeedModCheckDiff(const MoveDef& move
 			 		&& 	x <= prev_xmax && x >= prev_xmin)
 				continue;
 
+			if (groundBlockingObjectMap.GetCellMaskUnsafe(zOffset + x) == CGroundBlockingObjectMap::CELL_MASK_NONE)
+				continue;
+
 			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
 
 			for (size_t i = 0, n = cell.size(); i < n; i++) {
@@ -324,6 +406,9 @@ CMoveMath::BlockType CMoveMath::RangeIsBlocked(const MoveDef& moveDef, int xmin,
 		const int zOffset = z * mapDims.mapx;
 
 		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
+			if (groundBlockingObjectMap.GetCellMaskUnsafe(zOffset + x) == CGroundBlockingObjectMap::CELL_MASK_NONE)
+				continue;
+
 			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
 
 			for (size_t i = 0, n = cell.size(); i < n; i++) {
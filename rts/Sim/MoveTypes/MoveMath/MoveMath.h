@@ -20,6 +20,16 @@ protected:
 	static float ShipSpeedMod(const MoveDef& moveDef, float height, float slope);
 	static float ShipSpeedMod(const MoveDef& moveDef, float height, float slope, float dirSlopeMod);
 
+	static float CalcPosSpeedMod(const MoveDef& moveDef, int square);
+
+public:
+	// (re)computes the cached per-MoveDef speed-modifiers of every half-resolution square
+	static void InitSpeedModMaps();
+	static void KillSpeedModMaps();
+	// recomputes the squares whose height, slope or terrain-type may have changed with <hgtMapRect>
+	static void UpdateSpeedModMaps(const SRectangle& hgtMapRect);
+	static void TerrainTypeSpeedModChanged(int ttIndex);
+
 public:
 	// gives the y-coordinate the unit will "stand on"
 	static float yLevel(const MoveDef& moveDef, const float3& pos);
@@ -88,7 +88,6 @@ static const unsigned int FLOAT_MEMBER_HASHES[] = {
 #undef MEMBER_CHARPTR_HASH
 #undef MEMBER_LITERAL_HASH
 
-extern AAirMoveType::GetGroundHeightFunc amtGetGroundHeightFuncs[6];
 extern AAirMoveType::EmitCrashTrailFunc amtEmitCrashTrailFuncs[2];
 
 
@@ -489,7 +488,7 @@ bool CStrafeAirMoveType::Update()
 							const SyncedFloat3& rightdir = owner->rightdir;
 							const SyncedFloat3& frontdir = owner->frontdir;
 
-							const float altitude = CGround::GetHeightAboveWater(owner->pos.x, owner->pos.z) - lastPos.y;
+							const float altitude = GetGroundHeight(0, owner->pos.x, owner->pos.z) - lastPos.y;
 
 							if ((maneuverState = SelectLoopBackManeuver(frontdir, rightdir, lastSpd, turnRadius, altitude)) == MANEUVER_IMMELMAN_INV)
 								maneuverSubState = 0;
@@ -510,7 +509,7 @@ bool CStrafeAirMoveType::Update()
 			// NOTE: the crashing-state can only be set (and unset) by scripts
 			UpdateAirPhysics({crashRudder, crashElevator, crashAileron, 0.0f}, owner->frontdir);
 
-			if ((CGround::GetHeightAboveWater(owner->pos.x, owner->pos.z) + 5.0f + owner->radius) > owner->pos.y)
+			if ((GetGroundHeight(0, owner->pos.x, owner->pos.z) + 5.0f + owner->radius) > owner->pos.y)
 				owner->ForcedKillUnit(nullptr, true, false);
 
 			amtEmitCrashTrailFuncs[crashExpGenID != -1u](owner, crashExpGenID);
@@ -749,7 +748,7 @@ void CStrafeAirMoveType::UpdateAttack()
 	oldGoalPos = goalPos;
 	goalPos += difGoalPos;
 
-	const float gHeightAW = CGround::GetHeightAboveWater(pos.x, pos.z);
+	const float gHeightAW = GetGroundHeight(0, pos.x, pos.z);
 	const float goalDist = pos.distance(goalPos);
 	const float3 goalDir = (goalDist > 0.0f)?
 		(goalPos - pos) / goalDist:
@@ -826,7 +825,7 @@ bool CStrafeAirMoveType::UpdateFlying(float wantedHeight, float wantedThrottle)
 
 	// do not check if the plane can be submerged here,
 	// since it'll cause ground collisions later on (?)
-	const float groundHeight = amtGetGroundHeightFuncs[5 * UseSmoothMesh()](pos.x, pos.z);
+	const float groundHeight = GetGroundHeight(5 * UseSmoothMesh(), pos.x, pos.z);
 
 	// If goal-distance is half turn radius then turn if
 	// goal-position is not in front within a ~45 degree
@@ -897,7 +896,7 @@ void CStrafeAirMoveType::UpdateTakeOff()
 	const float dirWeight = Clamp(goalDir.dot(rightdir), -1.0f, 1.0f);
 	// this tends to alternate between -1 and +1 when goalDir and rightdir are ~orthogonal
 	// const float yawSign = Sign(goalDir.dot(rightdir));
-	const float currentHeight = pos.y - amtGetGroundHeightFuncs[canSubmerge](pos.x, pos.z);
+	const float currentHeight = pos.y - GetGroundHeight(canSubmerge, pos.x, pos.z);
 	const float minAccHeight = wantedHeight * 0.4f;
 
 	frontdir += (rightdir * dirWeight * yawWeight);
@@ -1004,7 +1003,7 @@ void CStrafeAirMoveType::UpdateLanding()
 		if (landPosDistXZ > curSpeedXZ && curSpeedXZ > 0.1f) {
 			owner->SetVelocity(spd + UpVector * std::max(-altitudeRate, landPosDistY * curSpeedXZ / landPosDistXZ));
 		} else {
-			const float localAltitude = pos.y - amtGetGroundHeightFuncs[canSubmerge](pos.x, pos.z);
+			const float localAltitude = pos.y - GetGroundHeight(canSubmerge, pos.x, pos.z);
 			const float deltaAltitude = wantedHeight - localAltitude;
 
 			if (deltaAltitude < 0.0f)
@@ -1032,7 +1031,7 @@ void CStrafeAirMoveType::UpdateAirPhysics(const float4& controlInputs, const flo
 	SyncedFloat3& frontdir = owner->frontdir;
 	SyncedFloat3& updir    = owner->updir;
 
-	const float groundHeight = CGround::GetHeightAboveWater(pos.x, pos.z);
+	const float groundHeight = GetGroundHeight(0, pos.x, pos.z);
 	const float linearSpeed = spd.w;
 
 	const float   rudder = controlInputs.x;
@@ -12,6 +12,7 @@
 #include "System/SpringMath.h"
 
 int CSolidObject::deletingRefID = -1;
+unsigned int CSolidObject::numTransformChanges = 0;
 
 
 CR_BIND_DERIVED_INTERFACE(CSolidObject, CWorldObject)
@@ -75,6 +76,8 @@ CR_REG_METADATA(CSolidObject,
 	CR_MEMBER(drawMidPos),
 
 	CR_MEMBER(drawFlag),
+	CR_IGNORED(shadowCascadeMask),
+	CR_IGNORED(viewCullRadius),
 
 	CR_MEMBER(buildFacing),
 	CR_MEMBER(modParams),
@@ -412,6 +415,8 @@ void CSolidObject::SetFacingFromHeading() { buildFacing = GetFacingFromHeading(h
 
 void CSolidObject::UpdateDirVectors(bool useGroundNormal, bool useObjectNormal)
 {
+	numTransformChanges += 1;
+
 	updir    = GetWantedUpDir(useGroundNormal, useObjectNormal);
 	frontdir = GetVectorFromHeading(heading);
 	rightdir = (frontdir.cross(updir)).Normalize();
@@ -432,6 +437,8 @@ void CSolidObject::ForcedSpin(const float3& newDir)
 	const float3 xdir = (zdir.cross(udir)).Normalize();
 	const float3 ydir = (xdir.cross(zdir)).Normalize();
 
+	numTransformChanges += 1;
+
 	frontdir = zdir;
 	rightdir = xdir;
 	   updir = ydir;
@@ -131,6 +131,8 @@ public:
 	void Move(const float3& v, bool relative) {
 		const float3& dv = relative? v: (v - pos);
 
+		numTransformChanges += 1;
+
 		pos += dv;
 		midPos += dv;
 		aimPos += dv;
@@ -140,10 +142,14 @@ public:
 	// vectors are changed (ie. after a rotation) in
 	// eg. movetype code
 	void UpdateMidAndAimPos() {
+		numTransformChanges += 1;
+
 		midPos = GetMidPos();
 		aimPos = GetAimPos();
 	}
 	void SetMidAndAimPos(const float3& mp, const float3& ap, bool relative) {
+		numTransformChanges += 1;
+
 		SetMidPos(mp, relative);
 		SetAimPos(ap, relative);
 	}
@@ -151,6 +157,8 @@ public:
 
 	void SetDirVectorsEuler(const float3 angles);
 	void SetDirVectors(const CMatrix44f& matrix) {
+		numTransformChanges += 1;
+
 		rightdir.x = -matrix[0]; updir.x = matrix[4]; frontdir.x = matrix[ 8];
 		rightdir.y = -matrix[1]; updir.y = matrix[5]; frontdir.y = matrix[ 9];
 		rightdir.z = -matrix[2]; updir.z = matrix[6]; frontdir.z = matrix[10];
@@ -301,7 +309,7 @@ public:
 
 	virtual void SetMass(float newMass);
 
-	void ResetDrawFlag() { drawFlag = DrawFlags::SO_NODRAW_FLAG; }
+	void ResetDrawFlag() { drawFlag = DrawFlags::SO_NODRAW_FLAG; shadowCascadeMask = 0; }
 	void SetDrawFlag(DrawFlags f) { drawFlag  =  f; }
 	void AddDrawFlag(DrawFlags f) { drawFlag |=  f; }
 	void DelDrawFlag(DrawFlags f) { drawFlag &= ~f; }
@@ -425,6 +433,10 @@ public:
 	float3 drawMidPos;
 
 	uint8_t drawFlag = DrawFlags::SO_NODRAW_FLAG;
+	///< shadow cascades (bit N for cascade N >= 1) this object casts into (unsynced)
+	uint8_t shadowCascadeMask = 0;
+	///< smallest radius around drawMidPos the player camera sees, see CCamera::GetInViewRadius (unsynced)
+	float viewCullRadius = 1e9f;
 
 	/**
 	 * @brief mod controlled parameters
@@ -442,11 +454,16 @@ public:
 	static constexpr float MAXIMUM_MASS = 1e6f;
 
 	static int deletingRefID;
+	// bumped by every position or direction setter above (sim-thread only)
+	static unsigned int numTransformChanges;
 
 	static void SetDeletingRefID(int id) { deletingRefID = id; }
 	// returns the object (command reference) id of the object currently being deleted,
 	// for units this equals unit->id, and for features feature->id + unitHandler.MaxUnits()
 	static int GetDeletingRefID() { return deletingRefID; }
+	// lets callers tell whether any object was moved or rotated since they
+	// last looked, e.g. to invalidate collision tests done ahead of time
+	static unsigned int GetNumTransformChanges() { return numTransformChanges; }
 };
 
 #endif // SOLID_OBJECT_H
@@ -4,15 +4,46 @@
 #include "PathFinderDef.h"
 #include "PathLog.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
+#include "Sim/Path/PathRequestBroker.h"
 #include "System/Log/ILog.h"
 
+#include <atomic>
+
 
 static std::vector<PathNodeStateBuffer> nodeStateBuffers;
 static std::vector<IPathFinder*> pathFinderInstances;
 
+// PF searches can run on worker threads (TKPFS)
+static std::atomic<std::uint64_t> numSearchesPerMode[MoveDef::PATH_SEARCH_MODES];
+static std::atomic<std::uint64_t> numExpansionsPerMode[MoveDef::PATH_SEARCH_MODES];
+
+
+void PathLog::AddSearchStats(unsigned int searchMode, unsigned int numExpandedNodes)
+{
+	assert(searchMode < MoveDef::PATH_SEARCH_MODES);
+
+	numSearchesPerMode[searchMode].fetch_add(1, std::memory_order_relaxed);
+	numExpansionsPerMode[searchMode].fetch_add(numExpandedNodes, std::memory_order_relaxed);
+}
+
+void PathLog::LogSearchStats()
+{
+	constexpr const char* searchModeNames[MoveDef::PATH_SEARCH_MODES] = {"A*", "JPS", "bidirectional A*"};
+
+	for (unsigned int searchMode = 0; searchMode < MoveDef::PATH_SEARCH_MODES; searchMode++) {
+		const std::uint64_t numSearches = numSearchesPerMode[searchMode].exchange(0);
+		const std::uint64_t numExpansions = numExpansionsPerMode[searchMode].exchange(0);
+
+		if (numSearches == 0)
+			continue;
+
+		LOG("[PathLog::%s] %s: %lu searches, %lu nodes expanded (%.1f per search)", __func__, searchModeNames[searchMode], (unsigned long) numSearches, (unsigned long) numExpansions, numExpansions * 1.0 / numSearches);
+	}
+}
+
 
 void IPathFinder::InitStatic() { pathFinderInstances.reserve(8); }
-void IPathFinder::KillStatic() { pathFinderInstances.clear  ( ); }
+void IPathFinder::KillStatic() { pathFinderInstances.clear  ( ); PathLog::LogSearchStats(); }
 
 
 void IPathFinder::Init(unsigned int _BLOCK_SIZE)
@@ -82,6 +113,7 @@ void IPathFinder::ResetSearch()
 	openBlocks.Clear();
 
 	testedBlocks = 0;
+	expandedBlocks = 0;
 }
 
 
@@ -127,6 +159,9 @@ IPath::SearchResult IPathFinder::GetPath(
 	// start up a new search
 	const IPath::SearchResult result = InitSearch(moveDef, pfDef, owner);
 
+	// lets the request broker enforce its per-frame node budget
+	CPathRequestBroker::AddSearchedNodes(testedBlocks);
+
 	// if search was successful, generate new path and cache it
 	if (result == IPath::Ok || result == IPath::GoalOutOfRange) {
 		FinishSearch(moveDef, pfDef, path);
@@ -135,6 +170,7 @@ IPath::SearchResult IPathFinder::GetPath(
 		if (LOG_IS_ENABLED(L_DEBUG)) {
 			LOG_L(L_DEBUG, "==== %s: Search completed ====", (BLOCK_SIZE != 1) ? "PE" : "PF");
 			LOG_L(L_DEBUG, "Tested blocks: %u", testedBlocks);
+			LOG_L(L_DEBUG, "Expanded blocks: %u", expandedBlocks);
 			LOG_L(L_DEBUG, "Open blocks: %u", openBlockBuffer.GetSize());
 			LOG_L(L_DEBUG, "Path length: " _STPF_, path.path.size());
 			LOG_L(L_DEBUG, "Path cost: %f", path.pathCost);
@@ -144,6 +180,7 @@ IPath::SearchResult IPathFinder::GetPath(
 		if (LOG_IS_ENABLED(L_DEBUG)) {
 			LOG_L(L_DEBUG, "==== %s: Search failed! ====", (BLOCK_SIZE != 1) ? "PE" : "PF");
 			LOG_L(L_DEBUG, "Tested blocks: %u", testedBlocks);
+			LOG_L(L_DEBUG, "Expanded blocks: %u", expandedBlocks);
 			LOG_L(L_DEBUG, "Open blocks: %u", openBlockBuffer.GetSize());
 			LOG_L(L_DEBUG, "============================");
 		}
@@ -0,0 +1,207 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PathCostsFile.h"
+#include "PathConstants.h"
+
+#include "System/FileSystem/MappedFile.h"
+#include "System/Log/ILog.h"
+#include "System/Sync/HsiehHash.h"
+#include "System/Threading/ThreadPool.h" // for_mt
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace PathCostsFile {
+
+// bump whenever the layout changes
+static constexpr std::uint32_t FORMAT_VERSION = 1;
+static constexpr char FORMAT_MAGIC[8] = {'S', 'P', 'R', 'P', 'A', 'T', 'H', 'C'};
+
+// files with more broken blocks than this are recomputed from scratch
+static constexpr unsigned int MAX_INVALID_BLOCKS_FRACTION = 8;
+
+struct FileHeader {
+	char magic[sizeof(FORMAT_MAGIC)];
+
+	std::uint32_t version;
+	std::uint32_t hashCode;
+	std::uint32_t blockSize;
+	std::uint32_t numBlocks;
+	std::uint32_t numPathTypes;
+	std::uint32_t numVertices;
+};
+
+static_assert((sizeof(FileHeader) % sizeof(float)) == 0, "");
+
+
+static FileHeader MakeHeader(std::uint32_t hashCode, unsigned int blockSize, unsigned int numBlocks, unsigned int numPathTypes)
+{
+	FileHeader header;
+
+	std::memcpy(header.magic, FORMAT_MAGIC, sizeof(FORMAT_MAGIC));
+
+	header.version = FORMAT_VERSION;
+	header.hashCode = hashCode;
+	header.blockSize = blockSize;
+	header.numBlocks = numBlocks;
+	header.numPathTypes = numPathTypes;
+	header.numVertices = PATH_DIRECTION_VERTICES;
+	return header;
+}
+
+static size_t CalcFileSize(const FileHeader& header)
+{
+	const size_t numBlocks = header.numBlocks;
+	const size_t numPathTypes = header.numPathTypes;
+
+	return (sizeof(FileHeader) + numBlocks * sizeof(std::uint32_t) + numBlocks * numPathTypes * (sizeof(short2) + PATH_DIRECTION_VERTICES * sizeof(float)));
+}
+
+// covers one block's data for every path-type (strided in memory)
+static std::uint32_t CalcBlockChecksum(const short2* nodeOffsets, const float* vertexCosts, unsigned int blockIdx, unsigned int numBlocks, unsigned int numPathTypes)
+{
+	std::uint32_t checksum = blockIdx;
+
+	for (unsigned int pathType = 0; pathType < numPathTypes; pathType++) {
+		checksum = HsiehHash(&nodeOffsets[pathType * numBlocks + blockIdx], sizeof(short2), checksum);
+		checksum = HsiehHash(&vertexCosts[(pathType * numBlocks + blockIdx) * PATH_DIRECTION_VERTICES], PATH_DIRECTION_VERTICES * sizeof(float), checksum);
+	}
+
+	return checksum;
+}
+
+
+bool Read(
+	const std::string& filePath,
+	std::uint32_t hashCode,
+	unsigned int blockSize,
+	std::vector< std::vector<short2> >& nodeOffsets,
+	std::vector<float>& vertexCosts,
+	std::vector<unsigned int>& invalidBlocks
+) {
+	invalidBlocks.clear();
+
+	if (nodeOffsets.empty())
+		return false;
+
+	CMappedFile file(filePath);
+
+	if (!file.IsOpen())
+		return false;
+
+	const unsigned int numPathTypes = nodeOffsets.size();
+	const unsigned int numBlocks = nodeOffsets[0].size();
+
+	const FileHeader expHeader = MakeHeader(hashCode, blockSize, numBlocks, numPathTypes);
+	const size_t expFileSize = CalcFileSize(expHeader);
+
+	assert(vertexCosts.size() == (numPathTypes * numBlocks * PATH_DIRECTION_VERTICES));
+
+	if (file.GetSize() != expFileSize) {
+		LOG_L(L_WARNING, "[PathCostsFile::%s] \"%s\" has size %u (expected %u)", __func__, filePath.c_str(), unsigned(file.GetSize()), unsigned(expFileSize));
+		return false;
+	}
+
+	if (std::memcmp(file.GetData(), &expHeader, sizeof(FileHeader)) != 0) {
+		LOG_L(L_WARNING, "[PathCostsFile::%s] \"%s\" has a mismatching header", __func__, filePath.c_str());
+		return false;
+	}
+
+	const std::uint8_t* fileBlockChecksums = file.GetData() + sizeof(FileHeader);
+	const std::uint8_t* fileNodeOffsets = fileBlockChecksums + numBlocks * sizeof(std::uint32_t);
+	const std::uint8_t* fileVertexCosts = fileNodeOffsets + numBlocks * numPathTypes * sizeof(short2);
+
+	// straight copies, the mapping is only paged in as these run
+	for (unsigned int pathType = 0; pathType < numPathTypes; pathType++) {
+		std::memcpy(nodeOffsets[pathType].data(), fileNodeOffsets + pathType * numBlocks * sizeof(short2), numBlocks * sizeof(short2));
+	}
+
+	std::memcpy(vertexCosts.data(), fileVertexCosts, vertexCosts.size() * sizeof(float));
+
+	// validate each block against its stored checksum
+	std::vector<std::uint8_t> validBlocks(numBlocks, 0);
+
+	for_mt_chunk(0, numBlocks, [&](const int blockIdx) {
+		std::uint32_t expChecksum;
+		std::memcpy(&expChecksum, fileBlockChecksums + blockIdx * sizeof(std::uint32_t), sizeof(std::uint32_t));
+
+		const short2* offsets = reinterpret_cast<const short2*>(fileNodeOffsets);
+		const float* costs = reinterpret_cast<const float*>(fileVertexCosts);
+
+		validBlocks[blockIdx] = (CalcBlockChecksum(offsets, costs, blockIdx, numBlocks, numPathTypes) == expChecksum);
+	});
+
+	for (unsigned int blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+		if (validBlocks[blockIdx] == 0)
+			invalidBlocks.push_back(blockIdx);
+	}
+
+	if (invalidBlocks.size() > (numBlocks / MAX_INVALID_BLOCKS_FRACTION)) {
+		LOG_L(L_WARNING, "[PathCostsFile::%s] \"%s\" has %u of %u invalid blocks", __func__, filePath.c_str(), unsigned(invalidBlocks.size()), numBlocks);
+		invalidBlocks.clear();
+		return false;
+	}
+
+	return true;
+}
+
+
+bool Write(
+	const std::string& filePath,
+	std::uint32_t hashCode,
+	unsigned int blockSize,
+	const std::vector< std::vector<short2> >& nodeOffsets,
+	const std::vector<float>& vertexCosts
+) {
+	if (nodeOffsets.empty())
+		return false;
+
+	const unsigned int numPathTypes = nodeOffsets.size();
+	const unsigned int numBlocks = nodeOffsets[0].size();
+
+	const FileHeader header = MakeHeader(hashCode, blockSize, numBlocks, numPathTypes);
+
+	// the checksums want the offsets in file (contiguous) order
+	std::vector<short2> allNodeOffsets;
+	std::vector<std::uint32_t> blockChecksums(numBlocks);
+
+	allNodeOffsets.reserve(numBlocks * numPathTypes);
+
+	for (const auto& pathTypeOffsets: nodeOffsets) {
+		allNodeOffsets.insert(allNodeOffsets.end(), pathTypeOffsets.begin(), pathTypeOffsets.end());
+	}
+
+	for_mt_chunk(0, numBlocks, [&](const int blockIdx) {
+		blockChecksums[blockIdx] = CalcBlockChecksum(allNodeOffsets.data(), vertexCosts.data(), blockIdx, numBlocks, numPathTypes);
+	});
+
+	const std::string tempFilePath = filePath + ".tmp";
+
+	{
+		std::ofstream file(tempFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(blockChecksums.data()), blockChecksums.size() * sizeof(std::uint32_t));
+		file.write(reinterpret_cast<const char*>(allNodeOffsets.data()), allNodeOffsets.size() * sizeof(short2));
+		file.write(reinterpret_cast<const char*>(vertexCosts.data()), vertexCosts.size() * sizeof(float));
+
+		if (!file.good()) {
+			file.close();
+			std::remove(tempFilePath.c_str());
+			return false;
+		}
+	}
+
+	// rename does not replace existing files on all platforms
+	std::remove(filePath.c_str());
+
+	if (std::rename(tempFilePath.c_str(), filePath.c_str()) != 0) {
+		std::remove(tempFilePath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,49 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PATH_COSTS_FILE_H
+#define PATH_COSTS_FILE_H
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "System/type2.h"
+
+/**
+ * On-disk cache of a path estimator's block offsets and vertex costs,
+ * shared by the Default CPathEstimator and TKPFS::PathingState.
+ *
+ * The file is stored uncompressed so it can be memory-mapped and copied
+ * into place without any parsing: a header identifying the estimator
+ * (format version, estimator hash, block size and counts), one checksum
+ * per block, then the offsets and vertex costs in their in-memory order.
+ * Per-block checksums let a damaged file be salvaged by recomputing only
+ * the blocks that fail validation.
+ */
+namespace PathCostsFile {
+	/**
+	 * Returns false if the file is missing, belongs to another estimator
+	 * or is damaged beyond repair. On success the indices of all blocks
+	 * whose data did not validate are returned in invalidBlocks; callers
+	 * must recompute those before using the costs.
+	 */
+	bool Read(
+		const std::string& filePath,
+		std::uint32_t hashCode,
+		unsigned int blockSize,
+		std::vector< std::vector<short2> >& nodeOffsets,
+		std::vector<float>& vertexCosts,
+		std::vector<unsigned int>& invalidBlocks
+	);
+
+	// written to a temporary file first, so readers never see a partial one
+	bool Write(
+		const std::string& filePath,
+		std::uint32_t hashCode,
+		unsigned int blockSize,
+		const std::vector< std::vector<short2> >& nodeOffsets,
+		const std::vector<float>& vertexCosts
+	);
+}
+
+#endif
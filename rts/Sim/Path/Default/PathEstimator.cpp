@@ -2,10 +2,10 @@
 
 #include "System/Platform/Win/win32.h"
 
-#include "zlib.h"
-#include "minizip/zip.h"
+#include <algorithm>
 
 #include "PathEstimator.h"
+#include "PathCostsFile.h"
 #include "PathFinder.h"
 #include "PathFinderDef.h"
 // #include "PathFlowMap.hpp"
@@ -21,13 +21,12 @@
 #include "System/Threading/ThreadPool.h" // for_mt
 #include "System/TimeProfiler.h"
 #include "System/Config/ConfigHandler.h"
-#include "System/FileSystem/Archives/IArchive.h"
-#include "System/FileSystem/ArchiveLoader.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/Platform/Threading.h"
 #include "System/SafeUtil.h"
+#include "System/SpringMem.h"
 #include "System/StringUtil.h"
 #include "System/Sync/SHA512.hpp"
 
@@ -45,7 +44,7 @@ static const std::string GetPathCacheDir() {
 }
 
 static const std::string GetCacheFileName(const std::string& fileHashCode, const std::string& peFileName, const std::string& mapFileName) {
-	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + ".zip");
+	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + ".bin");
 }
 
 
@@ -79,6 +78,7 @@ void CPathEstimator::Init(IPathFinder* pf, unsigned int BLOCK_SIZE, const std::s
 	}
 	{
 		vertexCosts.clear();
+		spring::ReserveHugePages(vertexCosts, moveDefHandler.GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES);
 		vertexCosts.resize(moveDefHandler.GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES, PATHCOST_INFINITY);
 		maxSpeedMods.clear();
 		maxSpeedMods.resize(moveDefHandler.GetNumMoveDefs(), 0.001f);
@@ -964,57 +964,24 @@ bool CPathEstimator::ReadFile(const std::string& peFileName, const std::string&
 	if (!FileSystem::FileExists(cacheFileName))
 		return false;
 
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
-
-	if (upfile == nullptr || !upfile->IsOpen()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
-
 	char calcMsg[512];
 	sprintf(calcMsg, "Reading Estimate PathCosts [%d]", BLOCK_SIZE);
 	loadscreen->SetLoadMessage(calcMsg);
 
-	const unsigned fid = upfile->FindFile("pathinfo");
-	if (fid >= upfile->NumFiles()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+	std::vector<unsigned int> invalidBlocks;
 
-	std::vector<std::uint8_t> buffer;
-
-	if (!upfile->GetFile(fid, buffer) || buffer.size() < 4) {
+	if (!PathCostsFile::Read(dataDirsAccess.LocateFile(cacheFileName), fileHashCode, BLOCK_SIZE, blockStates.peNodeOffsets, vertexCosts, invalidBlocks)) {
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
-	const unsigned int filehash = *(reinterpret_cast<unsigned int*>(&buffer[0]));
-	const unsigned int blockSize = blockStates.GetSize() * sizeof(short2);
-	unsigned int pos = sizeof(unsigned);
-
-	if (filehash != fileHashCode) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
-
-	if (buffer.size() < (pos + blockSize * moveDefHandler.GetNumMoveDefs())) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
-
-	// read center-offset data
-	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		std::memcpy(&blockStates.peNodeOffsets[pathType][0], &buffer[pos], blockSize);
-		pos += blockSize;
-	}
+	if (!invalidBlocks.empty()) {
+		LOG_L(L_WARNING, "[PathEstimator::%s] recalculating %u damaged blocks", __func__, unsigned(invalidBlocks.size()));
 
-	// read vertex-cost data
-	if (buffer.size() < (pos + vertexCosts.size() * sizeof(float))) {
-		FileSystem::Remove(cacheFileName);
-		return false;
+		RecalcBlocks(invalidBlocks);
+		WriteFile(peFileName, mapFileName);
 	}
 
-	std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
 	return true;
 }
 
@@ -1033,39 +1000,43 @@ bool CPathEstimator::WriteFile(const std::string& peFileName, const std::string&
 
 	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
-	// open file for writing in a suitable location
-	zipFile file = zipOpen(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE).c_str(), APPEND_STATUS_CREATE);
-
-	if (file == nullptr)
-		return false;
+	return (PathCostsFile::Write(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE), fileHashCode, BLOCK_SIZE, blockStates.peNodeOffsets, vertexCosts));
+}
 
-	zipOpenNewFileInZip(file, "pathinfo", nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_BEST_COMPRESSION);
 
-	// write hash-code (NOTE: this also affects the CRC!)
-	zipWriteInFileInZip(file, (const void*) &fileHashCode, 4);
+/**
+ * Recalculate offsets and vertex costs of blocks that failed to load
+ */
+void CPathEstimator::RecalcBlocks(const std::vector<unsigned int>& blockIndices)
+{
+	// vertex costs depend on the offsets of both blocks they connect, so
+	// first redo all offsets and then the costs of each block's neighbours
+	std::vector<unsigned int> costBlockIndices;
 
-	// write center-offsets
-	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		zipWriteInFileInZip(file, (const void*) &blockStates.peNodeOffsets[pathType][0], blockStates.peNodeOffsets[pathType].size() * sizeof(short2));
-	}
+	for (const unsigned int blockIdx: blockIndices) {
+		const int2 blockPos = BlockIdxToPos(blockIdx);
 
-	// write vertex-costs
-	zipWriteInFileInZip(file, vertexCosts.data(), vertexCosts.size() * sizeof(float));
+		for (unsigned int i = 0; i < moveDefHandler.GetNumMoveDefs(); i++) {
+			const MoveDef* md = moveDefHandler.GetMoveDefByPathType(i);
 
-	zipCloseFileInZip(file);
-	zipClose(file, nullptr);
+			blockStates.peNodeOffsets[md->pathType][blockIdx] = FindBlockPosOffset(*md, blockPos.x, blockPos.y);
+		}
 
+		for (int z = std::max(blockPos.y - 1, 0); z <= std::min(blockPos.y + 1, int(nbrOfBlocks.y) - 1); z++) {
+			for (int x = std::max(blockPos.x - 1, 0); x <= std::min(blockPos.x + 1, int(nbrOfBlocks.x) - 1); x++) {
+				costBlockIndices.push_back(BlockPosToIdx(int2(x, z)));
+			}
+		}
+	}
 
-	// get the CRC over the written path data
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
+	std::sort(costBlockIndices.begin(), costBlockIndices.end());
+	costBlockIndices.erase(std::unique(costBlockIndices.begin(), costBlockIndices.end()), costBlockIndices.end());
 
-	if (upfile == nullptr || !upfile->IsOpen()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
+	for (const unsigned int blockIdx: costBlockIndices) {
+		for (unsigned int i = 0; i < moveDefHandler.GetNumMoveDefs(); i++) {
+			CalcVertexPathCosts(*moveDefHandler.GetMoveDefByPathType(i), BlockIdxToPos(blockIdx));
+		}
 	}
-
-	assert(upfile->FindFile("pathinfo") < upfile->NumFiles());
-  return true;
 }
 
 
@@ -70,6 +70,7 @@ public:
 
 
 	const std::vector<float>& GetVertexCosts() const { return vertexCosts; }
+	size_t GetVertexCostsMemFootPrint() const { return ((vertexCosts.size() + maxSpeedMods.size()) * sizeof(float)); }
 	const std::deque<int2>& GetUpdatedBlocks() const { return updatedBlocks; }
 
 
@@ -121,6 +122,7 @@ private:
 
 	bool ReadFile(const std::string& peFileName, const std::string& mapFileName);
 	bool WriteFile(const std::string& peFileName, const std::string& mapFileName);
+	void RecalcBlocks(const std::vector<unsigned int>& blockIndices);
 
 	std::uint32_t CalcChecksum() const;
 	std::uint32_t CalcHash(const char* caller) const;
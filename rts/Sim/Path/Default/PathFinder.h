@@ -3,6 +3,7 @@
 #ifndef PATH_FINDER_H
 #define PATH_FINDER_H
 
+#include <memory>
 #include <vector>
 
 #include "IPath.h"
@@ -23,7 +24,7 @@ public:
 	CPathFinder(bool threadSafe) { Init(threadSafe); }
 
 	void Init(bool threadSafe);
-	void Kill() { IPathFinder::Kill(); }
+	void Kill();
 
 	typedef CMoveMath::BlockType (*BlockCheckFunc)(const MoveDef&, int, int, const CSolidObject*);
 
@@ -75,6 +76,9 @@ protected:
 	) override { }
 
 private:
+	IPath::SearchResult DoUnidirSearch(const MoveDef& moveDef, const CPathFinderDef& pfDef, const CSolidObject* owner, bool jumpSearch);
+	IPath::SearchResult DoBidirSearch(const MoveDef& moveDef, const CPathFinderDef& pfDef, const CSolidObject* owner);
+
 	void TestNeighborSquares(
 		const MoveDef& moveDef,
 		const CPathFinderDef& pfDef,
@@ -82,6 +86,58 @@ private:
 		const CSolidObject* owner
 	);
 
+	/**
+	 * Jump-point variant of TestNeighborSquares. Squares of equal cost
+	 * are scanned in straight lines from the parent and only the ones
+	 * where a path could turn (jump-points) are queued; the scanned-over
+	 * squares just get their backtracking state. Squares whose cost is
+	 * not uniform (mobile units, heat, extra costs, directional slopes)
+	 * end each scan and get a regular expansion.
+	 */
+	void TestJumpSquares(
+		const MoveDef& moveDef,
+		const CPathFinderDef& pfDef,
+		const PathNode* parentSquare,
+		const CSolidObject* owner
+	);
+	/// returns the number of steps to the first jump-point along pathOptDir, or 0 if there is none
+	unsigned int JumpSquares(
+		const MoveDef& moveDef,
+		const CPathFinderDef& pfDef,
+		const CSolidObject* owner,
+		int2 square,
+		const unsigned int pathOptDir,
+		const float refSpeedMod
+	);
+	void AddJumpSquares(
+		const MoveDef& moveDef,
+		const CPathFinderDef& pfDef,
+		const PathNode* parentSquare,
+		const CSolidObject* owner,
+		const unsigned int pathOptDir,
+		const unsigned int numSteps,
+		const float refSpeedMod
+	);
+	void LabelJumpSquare(const CPathFinderDef& pfDef, const PathNode& jumpSquare, const unsigned int pathOptDir);
+
+	/**
+	 * Returns 0 for impassable squares, -1 for passable squares whose
+	 * cost of entry depends on more than their (positional) speedmod,
+	 * and the speedmod otherwise. Cached for the duration of a search.
+	 */
+	float GetUniformSpeedMod(const MoveDef& moveDef, const CPathFinderDef& pfDef, const CSolidObject* owner, const int2 square);
+
+	bool InitReverseSearch(const MoveDef& moveDef, const CPathFinderDef& pfDef, const CSolidObject* owner);
+	/// expands a square of the reverse (goal to start) half of a bidirectional search
+	void TestReverseSquares(
+		const MoveDef& moveDef,
+		const CPathFinderDef& pfDef,
+		const PathNode* square,
+		const CSolidObject* owner
+	);
+	/// joins the reverse path from <meetSquareIdx> to the goal onto the forward one
+	void FinishBidirSearch(const CPathFinderDef& pfDef, unsigned int meetSquareIdx);
+
 	/**
 	 * Adjusts the found path to cut corners where possible.
 	 */
@@ -102,6 +158,22 @@ private:
 
 	BlockCheckFunc blockCheckFunc;
 	CPathCache::CacheItem dummyCacheItem;
+
+	// state of the goal-side search, allocated by the first bidirectional search
+	struct ReverseSearchState {
+		PathNodeBuffer openBlockBuffer;
+		PathNodeStateBuffer blockStates;
+		PathPriorityQueue openBlocks;
+
+		std::vector<unsigned int> dirtyBlocks;
+		std::vector<unsigned int> pathSquares;
+	};
+
+	std::unique_ptr<ReverseSearchState> reverseSearch;
+
+	// see GetUniformSpeedMod, allocated by the first jump-point search
+	std::vector<float> uniformSpeedMods;
+	std::vector<unsigned int> dirtyUniformSpeedMods;
 };
 
 #endif // PATH_FINDER_H
@@ -3,6 +3,7 @@
 #ifndef PATH_HEATMAP_HDR
 #define PATH_HEATMAP_HDR
 
+#include <cinttypes>
 #include <vector>
 #include "System/type2.h"
 
@@ -13,6 +14,12 @@ struct MoveDef;
 /**
  * Heat mapping makes the pathfinder favor unused paths more. 
  * Less path overlap should make units behave more intelligently.
+ *
+ * Cells are grouped into 8x8 tiles stored back to back (Morton order
+ * within a tile) so the neighbours an A* expansion looks at share cache
+ * lines. Heat decays by one per frame; instead of touching every cell,
+ * each tile remembers the frame its values are relative to and is only
+ * rebased when written to.
  */
 class PathHeatMap {
 public:
@@ -22,6 +29,7 @@ public:
 	void Init(unsigned int sizex, unsigned int sizez);
 	void Kill() {
 		heatMap.clear();
+		tileStamps.clear();
 		pathSquares.clear();
 	}
 
@@ -34,27 +42,42 @@ public:
 	void UpdateHeatValue(unsigned int x, unsigned int y, unsigned int value, unsigned int ownerID);
 
 	const int GetHeatValue(unsigned int x, unsigned int y) const {
-		const unsigned int idx = GetHeatMapIndex(x, y);
-		const unsigned int val = heatMap[idx].value;
-
-		return ((val - heatMapOffset) * (heatMapOffset < val));
+		return (GetCellHeat(GetHeatMapIndex(x, y)));
 	}
 
 	float GetHeatCost(unsigned int x, unsigned int z, const MoveDef&, unsigned int ownerID) const;
 
 private:
+	static constexpr unsigned int TILE_SIZE_BITS = 3;
+	static constexpr unsigned int TILE_SIZE = 1 << TILE_SIZE_BITS;
+	static constexpr unsigned int TILE_CELLS_BITS = TILE_SIZE_BITS * 2;
+	static constexpr unsigned int TILE_CELLS = 1 << TILE_CELLS_BITS;
+
+	// 16 bits suffice for both; unit ID's are below MAX_UNITS
 	struct HeatCell {
-		unsigned int value = 0;
-		unsigned int ownerID = 0;
+		std::uint16_t value = 0;
+		std::uint16_t ownerID = 0;
 	};
 
+	// remaining heat of the cell at heatMapIndex as of the current frame
+	unsigned int GetCellHeat(unsigned int idx) const {
+		const unsigned int val = heatMap[idx].value;
+		const unsigned int age = heatMapOffset - tileStamps[idx >> TILE_CELLS_BITS];
+
+		return ((val - age) * (age < val));
+	}
+
+	void RebaseTile(unsigned int tileIdx);
 
-	// resolution is hmapx*hmapy
+	// resolution is hmapx*hmapy, padded to whole tiles
 	std::vector<HeatCell> heatMap;
+	// value of heatMapOffset each tile's cell values are relative to
+	std::vector<unsigned int> tileStamps;
 	std::vector<int2> pathSquares;
 
 	unsigned int xscale = 0, xsize = 0;
 	unsigned int zscale = 0, zsize = 0;
+	unsigned int xtiles = 0;
 
 	// heatmap values are relative to this
 	unsigned int heatMapOffset = 0;
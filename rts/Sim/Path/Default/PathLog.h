@@ -15,4 +15,11 @@
 
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_PATH)
 
+namespace PathLog {
+	// per-MoveDef::PathSearchMode totals of PF searches and the nodes they expanded
+	void AddSearchStats(unsigned int searchMode, unsigned int numExpandedNodes);
+	// logs (and resets) the totals; called when a pathing system shuts down
+	void LogSearchStats();
+}
+
 #endif // PATH_LOG_H
@@ -34,6 +34,7 @@ CPathManager::CPathManager()
 
 	pathFlowMap = PathFlowMap::GetInstance();
 	pathHeatMap = PathHeatMap::GetInstance();
+	pathHeatMap->Init(PATH_HEATMAP_XSCALE, PATH_HEATMAP_ZSCALE);
 
 	pathMap.reserve(1024);
 
@@ -73,6 +74,17 @@ std::uint32_t CPathManager::GetPathCheckSum() const {
 	return (medResPE->GetPathChecksum() + lowResPE->GetPathChecksum());
 }
 
+std::uint64_t CPathManager::GetMemFootPrint() const {
+	if (!IsFinalized())
+		return 0;
+
+	std::uint64_t memFootPrint = maxResPF->GetMemFootPrint();
+
+	memFootPrint += (medResPE->GetMemFootPrint() + medResPE->GetVertexCostsMemFootPrint());
+	memFootPrint += (lowResPE->GetMemFootPrint() + lowResPE->GetVertexCostsMemFootPrint());
+	return memFootPrint;
+}
+
 std::int64_t CPathManager::Finalize() {
 	const spring_time t0 = spring_gettime();
 
@@ -377,6 +389,8 @@ unsigned int CPathManager::RequestPath(
 	if (!IsFinalized())
 		return 0;
 
+	TraceRequest(caller, moveDef, startPos, goalPos, goalRadius);
+
 	// in misc since it is called from many points
 	//SCOPED_TIMER("Misc::Path::RequestPath");
 	startPos.ClampInBounds();
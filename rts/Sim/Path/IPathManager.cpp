@@ -1,10 +1,12 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "IPathManager.h"
+#include "PathRequestTracer.h"
 #include "Default/PathManager.h"
 #include "QTPFS/PathManager.hpp"
 #include "TKPFS/PathManager.h"
 #include "System/Log/ILog.h"
+#include "System/TimeProfiler.h"
 
 IPathManager nullPathManager;
 IPathManager* pathManager = &nullPathManager;
@@ -30,9 +32,21 @@ IPathManager* IPathManager::GetInstance(int type) {
 void IPathManager::FreeInstance(IPathManager* pm) {
 	assert(pm == pathManager);
 
+	pm->GetRequestBroker().Kill();
+
 	if (pm != &nullPathManager)
 		delete pm;
 
 	pathManager = &nullPathManager;
 }
 
+void IPathManager::TraceRequest(const CSolidObject* caller, const MoveDef* moveDef, const float3& startPos, const float3& goalPos, float goalRadius) const {
+	// counted for --frame-stats, whose games have the profiler enabled
+	if (profiler.IsEnabled())
+		profiler.AddCounter("Sim::Path::Requests", 1);
+
+	if (!pathRequestTracer.IsCapturing())
+		return;
+
+	pathRequestTracer.AddRequest(caller, moveDef, startPos, goalPos, goalRadius);
+}
@@ -7,6 +7,7 @@
 #include <cinttypes>
 
 #include "PFSTypes.h"
+#include "PathRequestBroker.h"
 #include "System/type2.h"
 #include "System/float3.h"
 
@@ -22,6 +23,8 @@ public:
 
 	virtual std::int32_t GetPathFinderType() const { return NOPFS_TYPE; }
 	virtual std::uint32_t GetPathCheckSum() const { return 0; }
+	/// bytes held by the node-state buffers and precomputed costs, see MemoryStats
+	virtual std::uint64_t GetMemFootPrint() const { return 0; }
 
 	virtual std::int64_t Finalize() { return 0; }
 	virtual std::int64_t PostFinalizeRefresh() { return 0; }
@@ -174,6 +177,15 @@ public:
 
 	virtual bool SupportsMultiThreadedRequests() const { return false; }
 	virtual void SavePathCacheForPathId(int pathIdToSave) {};
+
+	CPathRequestBroker& GetRequestBroker() { return requestBroker; }
+
+protected:
+	// called by RequestPath implementations; records the call while /PathTrace captures
+	void TraceRequest(const CSolidObject* caller, const MoveDef* moveDef, const float3& startPos, const float3& goalPos, float goalRadius) const;
+
+protected:
+	CPathRequestBroker requestBroker;
 };
 
 extern IPathManager* pathManager;
@@ -0,0 +1,209 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+
+#include "PathRequestBroker.h"
+#include "Default/PathConstants.h"
+#include "Default/PathLog.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/ModInfo.h"
+#include "Sim/MoveTypes/MoveDefHandler.h"
+#include "System/UnorderedMap.hpp"
+#include "System/Threading/ThreadPool.h" // for_mt
+
+// nodes expanded by the request currently being searched on this thread
+static thread_local unsigned int numRequestNodes = 0;
+
+void CPathRequestBroker::AddSearchedNodes(unsigned int numNodes)
+{
+	numRequestNodes += numNodes;
+}
+
+void CPathRequestBroker::ResetSearchedNodes()
+{
+	numRequestNodes = 0;
+}
+
+unsigned int CPathRequestBroker::GetSearchedNodes()
+{
+	return numRequestNodes;
+}
+
+
+void CPathRequestBroker::Kill()
+{
+	LogStats();
+
+	requests.clear();
+	scheduled.clear();
+	leaders.clear();
+	followers.clear();
+	executed.clear();
+	searchedNodes.clear();
+	deferredOwnerIDs.clear();
+
+	numRequests = 0;
+	numMergedRequests = 0;
+	numDeferredRequests = 0;
+	numSearchedNodes = 0;
+}
+
+void CPathRequestBroker::LogStats() const
+{
+	if (numRequests == 0)
+		return;
+
+	LOG("[PathRequestBroker::%s] requests=%lu merged=%lu (%.1f%%) deferred=%lu searchedNodes=%lu", __func__,
+		(unsigned long) numRequests,
+		(unsigned long) numMergedRequests,
+		(numMergedRequests * 100.0f) / numRequests,
+		(unsigned long) numDeferredRequests,
+		(unsigned long) numSearchedNodes
+	);
+}
+
+
+void CPathRequestBroker::Schedule()
+{
+	scheduled.clear();
+	scheduled.reserve(requests.size());
+
+	for (unsigned int i = 0, n = requests.size(); i < n; i++) {
+		const Request& r = requests[i];
+
+		scheduled.push_back({0, r.startPos.SqDistance2D(r.goalPos), i, i});
+	}
+
+	// urgent requests first, then the cheapest (closest to their goal); ties keep arrival order
+	std::stable_sort(scheduled.begin(), scheduled.end(), [&](const ScheduledRequest& a, const ScheduledRequest& b) {
+		const bool au = requests[a.requestIdx].urgent;
+		const bool bu = requests[b.requestIdx].urgent;
+
+		if (au != bu)
+			return au;
+
+		return (a.sqGoalDist < b.sqGoalDist);
+	});
+
+	leaders.clear();
+	followers.clear();
+
+	if (!modInfo.pfCoalesceRequests) {
+		leaders.swap(scheduled);
+		return;
+	}
+
+	// same as the estimator cache-key resolution, so followers hit the leader's entry
+	constexpr float BLOCK_PIXEL_SIZE = MEDRES_PE_BLOCKSIZE * SQUARE_SIZE;
+
+	spring::unordered_map<std::uint64_t, unsigned int> groupLeaders;
+	groupLeaders.reserve(scheduled.size());
+
+	for (ScheduledRequest& sr: scheduled) {
+		const Request& r = requests[sr.requestIdx];
+
+		if (r.moveDef == nullptr) {
+			leaders.push_back(sr);
+			continue;
+		}
+
+		const std::uint64_t sbx = std::uint64_t(std::max(0.0f, r.startPos.x / BLOCK_PIXEL_SIZE)) & 0x7FF;
+		const std::uint64_t sbz = std::uint64_t(std::max(0.0f, r.startPos.z / BLOCK_PIXEL_SIZE)) & 0x7FF;
+		const std::uint64_t gbx = std::uint64_t(std::max(0.0f, r.goalPos.x / BLOCK_PIXEL_SIZE)) & 0x7FF;
+		const std::uint64_t gbz = std::uint64_t(std::max(0.0f, r.goalPos.z / BLOCK_PIXEL_SIZE)) & 0x7FF;
+		const std::uint64_t rad = std::min(std::uint64_t(std::max(0.0f, r.goalRadius)), std::uint64_t(0x3FF));
+		const std::uint64_t ptp = std::uint64_t(r.moveDef->pathType) & 0x3FF;
+
+		sr.groupKey = (sbx << 53) | (sbz << 42) | (gbx << 31) | (gbz << 20) | (rad << 10) | ptp;
+
+		const auto iter = groupLeaders.find(sr.groupKey);
+
+		if (iter == groupLeaders.end()) {
+			groupLeaders.emplace(sr.groupKey, sr.requestIdx);
+			leaders.push_back(sr);
+			continue;
+		}
+
+		sr.leaderIdx = iter->second;
+		followers.push_back(sr);
+	}
+
+	numMergedRequests += followers.size();
+}
+
+void CPathRequestBroker::ExecutePass(
+	const std::vector<ScheduledRequest>& pass,
+	bool multiThreaded,
+	const std::function<void(unsigned int)>& searchFunc,
+	const std::function<void(unsigned int)>& publishFunc
+) {
+	const std::uint64_t nodeBudget = modInfo.pfRequestNodeBudget;
+
+	// member so the batch buffer is not reallocated for every pass of every frame
+	batch.reserve(REQUEST_BATCH_SIZE);
+
+	for (size_t i = 0, n = pass.size(); i < n; ) {
+		const bool overBudget = (nodeBudget > 0 && frameSearchedNodes >= nodeBudget);
+
+		batch.clear();
+
+		for (; i < n && batch.size() < REQUEST_BATCH_SIZE; i++) {
+			const Request& r = requests[pass[i].requestIdx];
+
+			if (overBudget && !r.urgent) {
+				deferredOwnerIDs.push_back(r.ownerID);
+				numDeferredRequests++;
+				continue;
+			}
+
+			batch.push_back(pass[i].requestIdx);
+		}
+
+		const auto searchRequest = [&](const int j) {
+			ResetSearchedNodes();
+			searchFunc(batch[j]);
+			searchedNodes[batch[j]] = GetSearchedNodes();
+		};
+
+		if (multiThreaded) {
+			for_mt(0, batch.size(), searchRequest);
+		} else {
+			for (size_t j = 0; j < batch.size(); j++) {
+				searchRequest(j);
+			}
+		}
+
+		for (const unsigned int requestIdx: batch) {
+			publishFunc(requestIdx);
+			executed.push_back(requestIdx);
+
+			frameSearchedNodes += searchedNodes[requestIdx];
+		}
+	}
+}
+
+const std::vector<unsigned int>& CPathRequestBroker::Execute(
+	bool multiThreaded,
+	const std::function<void(unsigned int)>& searchFunc,
+	const std::function<void(unsigned int)>& publishFunc
+) {
+	executed.clear();
+	deferredOwnerIDs.clear();
+
+	searchedNodes.clear();
+	searchedNodes.resize(requests.size(), 0);
+
+	frameSearchedNodes = 0;
+	numRequests += requests.size();
+
+	Schedule();
+
+	// followers only run after every leader has published its paths
+	ExecutePass(leaders, multiThreaded, searchFunc, publishFunc);
+	ExecutePass(followers, multiThreaded, searchFunc, publishFunc);
+
+	numSearchedNodes += frameSearchedNodes;
+	requests.clear();
+
+	return executed;
+}
@@ -0,0 +1,109 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PATH_REQUEST_BROKER_H
+#define PATH_REQUEST_BROKER_H
+
+#include <cinttypes>
+#include <functional>
+#include <vector>
+
+#include "System/float3.h"
+
+struct MoveDef;
+
+/**
+ * Orders the (re-)path requests collected by CUnitHandler each frame.
+ *
+ * Requests with the same MoveDef, goal radius and start and goal in the
+ * same medium-resolution estimator blocks are coalesced: the first one of
+ * such a group (its leader) is searched in an earlier pass than the rest,
+ * whose estimator searches are then served from the leader's cached path.
+ * Within a pass urgent requests come first, then those closest to their
+ * goal. Once the nodes expanded in a frame exceed the modrule budget, the
+ * remaining non-urgent requests are deferred to the next frame.
+ *
+ * Passes run in batches of a fixed size so the budget is checked at the
+ * same points on every client regardless of thread count.
+ */
+class CPathRequestBroker {
+public:
+	struct Request {
+		const MoveDef* moveDef;
+
+		float3 startPos;
+		float3 goalPos;
+		float goalRadius;
+
+		int ownerID;
+		bool urgent;
+	};
+
+	// requests of the first pass are searched in groups of this size
+	static constexpr unsigned int REQUEST_BATCH_SIZE = 64;
+
+	void Kill();
+	void LogStats() const;
+
+	void AddRequest(const Request& r) { requests.push_back(r); }
+
+	/**
+	 * Runs every queued request. searchFunc(i) performs the search for
+	 * request i and is invoked concurrently if multiThreaded is set,
+	 * publishFunc(i) is then called serially (in scheduling order) once
+	 * each batch has finished. Returns the executed request indices in
+	 * that same order and clears the queue.
+	 */
+	const std::vector<unsigned int>& Execute(
+		bool multiThreaded,
+		const std::function<void(unsigned int)>& searchFunc,
+		const std::function<void(unsigned int)>& publishFunc
+	);
+
+	// owners whose requests were pushed back by the budget on the last Execute
+	const std::vector<int>& GetDeferredOwners() const { return deferredOwnerIDs; }
+
+	// called by the path-finders; the tally is per thread and per request
+	static void AddSearchedNodes(unsigned int numNodes);
+	static void ResetSearchedNodes();
+	static unsigned int GetSearchedNodes();
+
+private:
+	struct ScheduledRequest {
+		std::uint64_t groupKey;
+
+		float sqGoalDist;
+
+		unsigned int requestIdx;
+		unsigned int leaderIdx;
+	};
+
+	void Schedule();
+	void ExecutePass(
+		const std::vector<ScheduledRequest>& pass,
+		bool multiThreaded,
+		const std::function<void(unsigned int)>& searchFunc,
+		const std::function<void(unsigned int)>& publishFunc
+	);
+
+private:
+	std::vector<Request> requests;
+
+	std::vector<ScheduledRequest> scheduled;
+	std::vector<ScheduledRequest> leaders;
+	std::vector<ScheduledRequest> followers;
+
+	std::vector<unsigned int> executed;
+	std::vector<unsigned int> batch;
+	std::vector<unsigned int> searchedNodes;
+
+	std::vector<int> deferredOwnerIDs;
+
+	std::uint64_t frameSearchedNodes = 0;
+
+	std::uint64_t numRequests = 0;
+	std::uint64_t numMergedRequests = 0;
+	std::uint64_t numDeferredRequests = 0;
+	std::uint64_t numSearchedNodes = 0;
+};
+
+#endif
@@ -0,0 +1,208 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PathRequestTrace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace PathRequestTrace {
+
+// bump whenever a line layout changes
+static constexpr int FORMAT_VERSION = 1;
+
+static constexpr const char* REQUESTS_MAGIC = "springPathRequests";
+static constexpr const char* RESULTS_MAGIC = "springPathResults";
+
+
+static bool ReadHeader(std::ifstream& file, const char* magic, std::string& name)
+{
+	std::string line;
+	std::string fileMagic;
+	int fileVersion = 0;
+
+	if (!std::getline(file, line))
+		return false;
+
+	std::istringstream header(line);
+
+	if (!(header >> fileMagic >> fileVersion) || fileMagic != magic || fileVersion != FORMAT_VERSION)
+		return false;
+
+	// name is the remainder of the line (maps may have spaces in theirs)
+	std::getline(header >> std::ws, name);
+	return true;
+}
+
+
+bool WriteRequests(const std::string& filePath, const std::string& mapName, const std::vector<Request>& requests)
+{
+	std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+
+	if (!file.is_open())
+		return false;
+
+	file << REQUESTS_MAGIC << ' ' << FORMAT_VERSION << ' ' << mapName << '\n';
+	file << "# frame ownerID moveDef startX startY startZ goalX goalY goalZ goalRadius\n";
+
+	char buf[512];
+
+	for (const Request& r: requests) {
+		snprintf(buf, sizeof(buf), "%d %d %s %.9g %.9g %.9g %.9g %.9g %.9g %.9g\n",
+			r.frame, r.ownerID, r.moveDefName.c_str(),
+			r.startPos[0], r.startPos[1], r.startPos[2],
+			r.goalPos[0], r.goalPos[1], r.goalPos[2],
+			r.goalRadius
+		);
+		file << buf;
+	}
+
+	return file.good();
+}
+
+bool ReadRequests(const std::string& filePath, std::string& mapName, std::vector<Request>& requests)
+{
+	std::ifstream file(filePath);
+
+	requests.clear();
+
+	if (!file.is_open())
+		return false;
+	if (!ReadHeader(file, REQUESTS_MAGIC, mapName))
+		return false;
+
+	std::string line;
+
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream fields(line);
+		Request r;
+
+		fields >> r.frame >> r.ownerID >> r.moveDefName;
+		fields >> r.startPos[0] >> r.startPos[1] >> r.startPos[2];
+		fields >> r.goalPos[0] >> r.goalPos[1] >> r.goalPos[2];
+		fields >> r.goalRadius;
+
+		if (fields.fail())
+			return false;
+
+		requests.push_back(r);
+	}
+
+	return true;
+}
+
+
+bool WriteResults(const std::string& filePath, const Results& results)
+{
+	std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+
+	if (!file.is_open())
+		return false;
+
+	file << RESULTS_MAGIC << ' ' << FORMAT_VERSION << ' ' << results.pfsName << '\n';
+	file << "memUsage " << results.memUsage << '\n';
+	file << "# found numWaypoints numNodes pathLength searchTime(us)\n";
+
+	char buf[256];
+
+	for (const Result& r: results.results) {
+		snprintf(buf, sizeof(buf), "%d %u %u %.9g %.9g\n", r.found, r.numWaypoints, r.numNodes, r.pathLength, r.searchTime);
+		file << buf;
+	}
+
+	return file.good();
+}
+
+bool ReadResults(const std::string& filePath, Results& results)
+{
+	std::ifstream file(filePath);
+
+	results.results.clear();
+
+	if (!file.is_open())
+		return false;
+	if (!ReadHeader(file, RESULTS_MAGIC, results.pfsName))
+		return false;
+
+	std::string line;
+	std::string tag;
+
+	if (!std::getline(file, line))
+		return false;
+
+	std::istringstream memLine(line);
+
+	if (!(memLine >> tag >> results.memUsage) || tag != "memUsage")
+		return false;
+
+	while (std::getline(file, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream fields(line);
+		Result r;
+		int found = 0;
+
+		fields >> found >> r.numWaypoints >> r.numNodes >> r.pathLength >> r.searchTime;
+
+		if (fields.fail())
+			return false;
+
+		r.found = (found != 0);
+		results.results.push_back(r);
+	}
+
+	return true;
+}
+
+
+Summary Summarize(const Results& results, const Results* reference)
+{
+	Summary s;
+
+	double searchTime = 0.0;
+	double sumLengthDelta = 0.0;
+
+	for (size_t i = 0; i < results.results.size(); i++) {
+		const Result& r = results.results[i];
+
+		s.numRequests += 1;
+		s.numFound += r.found;
+		s.numNodes += r.numNodes;
+
+		searchTime += r.searchTime;
+
+		if (reference == nullptr || i >= reference->results.size())
+			continue;
+
+		const Result& rr = reference->results[i];
+
+		if (!r.found || !rr.found || rr.pathLength <= 0.0f)
+			continue;
+
+		const float lengthDelta = (r.pathLength - rr.pathLength) / rr.pathLength;
+
+		s.numCompared += 1;
+		s.maxLengthDelta = std::max(s.maxLengthDelta, std::fabs(lengthDelta));
+
+		sumLengthDelta += lengthDelta;
+	}
+
+	s.searchTime = searchTime * 1e-6;
+
+	if (s.searchTime > 0.0f)
+		s.searchesPerSec = s.numRequests / s.searchTime;
+	if (s.numRequests > 0)
+		s.nodesPerSearch = s.numNodes / float(s.numRequests);
+	if (s.numCompared > 0)
+		s.meanLengthDelta = sumLengthDelta / s.numCompared;
+
+	return s;
+}
+
+}
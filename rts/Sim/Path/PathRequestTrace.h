@@ -0,0 +1,76 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PATH_REQUEST_TRACE_H
+#define PATH_REQUEST_TRACE_H
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+/**
+ * Plain-text files of recorded RequestPath calls and of their replayed
+ * outcomes, see CPathRequestTracer and the /PathTrace command. Replaying
+ * one request trace under each pathfinder system (and comparing against
+ * a reference results file) makes them measurable side by side.
+ *
+ * Kept free of engine dependencies so results can be summarized outside
+ * of a running game as well.
+ */
+namespace PathRequestTrace {
+	struct Request {
+		std::int32_t frame = 0;
+		std::int32_t ownerID = -1;
+
+		std::string moveDefName;
+
+		float startPos[3] = {0.0f, 0.0f, 0.0f};
+		float goalPos[3] = {0.0f, 0.0f, 0.0f};
+		float goalRadius = 0.0f;
+	};
+
+	struct Result {
+		bool found = false;
+
+		std::uint32_t numWaypoints = 0;
+		std::uint32_t numNodes = 0;
+
+		float pathLength = 0.0f;
+		float searchTime = 0.0f; // microseconds
+	};
+
+	struct Results {
+		std::string pfsName;
+		// resident memory grown during the replay, in KB
+		std::uint64_t memUsage = 0;
+
+		std::vector<Result> results;
+	};
+
+	struct Summary {
+		std::uint32_t numRequests = 0;
+		std::uint32_t numFound = 0;
+
+		std::uint64_t numNodes = 0;
+
+		float searchTime = 0.0f; // seconds
+		float searchesPerSec = 0.0f;
+		float nodesPerSearch = 0.0f;
+
+		// against a reference, over the requests both found a path for
+		std::uint32_t numCompared = 0;
+
+		float meanLengthDelta = 0.0f; // relative: (len - refLen) / refLen
+		float maxLengthDelta = 0.0f;
+	};
+
+	bool WriteRequests(const std::string& filePath, const std::string& mapName, const std::vector<Request>& requests);
+	bool ReadRequests(const std::string& filePath, std::string& mapName, std::vector<Request>& requests);
+
+	bool WriteResults(const std::string& filePath, const Results& results);
+	bool ReadResults(const std::string& filePath, Results& results);
+
+	// reference may be null; entries are matched by index
+	Summary Summarize(const Results& results, const Results* reference);
+}
+
+#endif
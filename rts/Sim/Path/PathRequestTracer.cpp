@@ -0,0 +1,223 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+
+#include "PathRequestTracer.h"
+#include "IPathManager.h"
+#include "Game/GameSetup.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/MoveTypes/MoveDefHandler.h"
+#include "Sim/Objects/SolidObject.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+
+#ifndef _WIN32
+	#include <sys/resource.h>
+#else
+	#define PSAPI_VERSION 2 // K32 entry points, no psapi.lib needed
+	#include <windows.h>
+	#include <psapi.h>
+#endif
+
+CPathRequestTracer pathRequestTracer;
+
+
+// peak resident set size of the process in KB
+static std::uint64_t GetPeakResidentMemory()
+{
+	#ifndef _WIN32
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	#ifdef __APPLE__
+	return (usage.ru_maxrss / 1024);
+	#else
+	return usage.ru_maxrss;
+	#endif
+	#else
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+
+	return (counters.PeakWorkingSetSize / 1024);
+	#endif
+}
+
+static const char* GetPathFinderTypeName(int type)
+{
+	switch (type) {
+		case HAPFS_TYPE: return "HAPFS";
+		case QTPFS_TYPE: return "QTPFS";
+		case TKPFS_TYPE: return "TKPFS";
+		default: break;
+	}
+
+	return "NOPFS";
+}
+
+static float GetPathLength(const std::vector<float3>& points)
+{
+	float pathLength = 0.0f;
+
+	for (size_t i = 1; i < points.size(); i++) {
+		pathLength += points[i].distance2D(points[i - 1]);
+	}
+
+	return pathLength;
+}
+
+
+void CPathRequestTracer::StartCapture()
+{
+	const std::lock_guard<std::mutex> lock(requestsMutex);
+
+	requests.clear();
+	capturing.store(true);
+}
+
+bool CPathRequestTracer::StopCapture(const std::string& filePath, unsigned int& numRequests)
+{
+	const std::lock_guard<std::mutex> lock(requestsMutex);
+
+	capturing.store(false);
+
+	// MT requests arrive in any order; each owner's stay on one thread
+	std::stable_sort(requests.begin(), requests.end(), [](const PathRequestTrace::Request& a, const PathRequestTrace::Request& b) {
+		if (a.frame != b.frame)
+			return (a.frame < b.frame);
+
+		return (a.ownerID < b.ownerID);
+	});
+
+	numRequests = requests.size();
+
+	if (requests.empty())
+		return false;
+
+	const bool ret = PathRequestTrace::WriteRequests(filePath, gameSetup->mapName, requests);
+
+	requests.clear();
+	return ret;
+}
+
+void CPathRequestTracer::AddRequest(
+	const CSolidObject* caller,
+	const MoveDef* moveDef,
+	const float3& startPos,
+	const float3& goalPos,
+	float goalRadius
+) {
+	if (moveDef == nullptr)
+		return;
+
+	PathRequestTrace::Request r;
+
+	r.frame = gs->frameNum;
+	r.ownerID = (caller != nullptr)? caller->id: -1;
+	r.moveDefName = moveDef->name;
+	r.goalRadius = goalRadius;
+
+	std::copy(&startPos.x, &startPos.x + 3, r.startPos);
+	std::copy(&goalPos.x, &goalPos.x + 3, r.goalPos);
+
+	const std::lock_guard<std::mutex> lock(requestsMutex);
+	requests.push_back(std::move(r));
+}
+
+
+bool CPathRequestTracer::Replay(const std::string& tracePath, const std::string& resultsPath, const std::string& referencePath) const
+{
+	std::string mapName;
+	std::vector<PathRequestTrace::Request> traceRequests;
+
+	if (!PathRequestTrace::ReadRequests(tracePath, mapName, traceRequests)) {
+		LOG_L(L_WARNING, "[PathRequestTracer::%s] could not read trace \"%s\"", __func__, tracePath.c_str());
+		return false;
+	}
+
+	if (mapName != gameSetup->mapName)
+		LOG_L(L_WARNING, "[PathRequestTracer::%s] trace was recorded on \"%s\", not the current map", __func__, mapName.c_str());
+
+	PathRequestTrace::Results results;
+	PathRequestTrace::Results reference;
+
+	const bool haveReference = !referencePath.empty() && PathRequestTrace::ReadResults(referencePath, reference);
+
+	if (!referencePath.empty() && !haveReference)
+		LOG_L(L_WARNING, "[PathRequestTracer::%s] could not read reference results \"%s\"", __func__, referencePath.c_str());
+
+	results.pfsName = GetPathFinderTypeName(pathManager->GetPathFinderType());
+	results.results.reserve(traceRequests.size());
+
+	// QTPFS only queues requests, searches happen in its Update
+	const bool deferredSearches = (pathManager->GetPathFinderType() == QTPFS_TYPE);
+	const std::uint64_t initMemUsage = GetPeakResidentMemory();
+
+	std::vector<float3> points;
+	std::vector<int> starts;
+
+	for (const PathRequestTrace::Request& r: traceRequests) {
+		PathRequestTrace::Result result;
+
+		const MoveDef* moveDef = moveDefHandler.GetMoveDefByName(r.moveDefName);
+
+		if (moveDef == nullptr) {
+			results.results.push_back(result);
+			continue;
+		}
+
+		const float3 startPos = {r.startPos[0], r.startPos[1], r.startPos[2]};
+		const float3 goalPos = {r.goalPos[0], r.goalPos[1], r.goalPos[2]};
+
+		CPathRequestBroker::ResetSearchedNodes();
+
+		const spring_time t0 = spring_gettime();
+		const unsigned int pathID = pathManager->RequestPath(nullptr, moveDef, startPos, goalPos, r.goalRadius, false);
+
+		if (deferredSearches && pathID != 0)
+			pathManager->Update();
+
+		const spring_time t1 = spring_gettime();
+
+		result.numNodes = CPathRequestBroker::GetSearchedNodes();
+		result.searchTime = (t1 - t0).toMicroSecsf();
+
+		if (pathID != 0) {
+			pathManager->GetPathWayPoints(pathID, points, starts);
+			pathManager->DeletePath(pathID);
+
+			result.found = !points.empty();
+			result.numWaypoints = points.size();
+			result.pathLength = GetPathLength(points);
+		}
+
+		results.results.push_back(result);
+	}
+
+	results.memUsage = GetPeakResidentMemory() - initMemUsage;
+
+	if (!resultsPath.empty() && !PathRequestTrace::WriteResults(resultsPath, results))
+		LOG_L(L_WARNING, "[PathRequestTracer::%s] could not write results \"%s\"", __func__, resultsPath.c_str());
+
+	const PathRequestTrace::Summary s = PathRequestTrace::Summarize(results, haveReference? &reference: nullptr);
+
+	LOG("[PathRequestTracer::%s][%s] requests=%u found=%u time=%.3fs searches/sec=%.1f nodes=%lu (%.1f per search) peakMemGrowth=%luKB",
+		__func__, results.pfsName.c_str(),
+		s.numRequests, s.numFound,
+		s.searchTime, s.searchesPerSec,
+		(unsigned long) s.numNodes, s.nodesPerSearch,
+		(unsigned long) results.memUsage
+	);
+
+	if (haveReference) {
+		LOG("[PathRequestTracer::%s][%s vs %s] compared=%u meanLengthDelta=%+.2f%% maxLengthDelta=%.2f%%",
+			__func__, results.pfsName.c_str(), reference.pfsName.c_str(),
+			s.numCompared, s.meanLengthDelta * 100.0f, s.maxLengthDelta * 100.0f
+		);
+	}
+
+	return true;
+}
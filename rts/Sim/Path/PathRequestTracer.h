@@ -0,0 +1,56 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PATH_REQUEST_TRACER_H
+#define PATH_REQUEST_TRACER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "PathRequestTrace.h"
+#include "System/float3.h"
+
+struct MoveDef;
+class CSolidObject;
+
+/**
+ * Records the RequestPath calls reaching the active path manager and
+ * replays recorded traces against it (driven by the /PathTrace command).
+ *
+ * A replay issues every request unsynced and in recorded order, timing
+ * each and counting the nodes the pathfinders report to the request
+ * broker. Running the same trace under each pathfinderSystem and passing
+ * one run's results as reference to the others gives searches/sec,
+ * nodes expanded, memory use and path-length deltas between them.
+ */
+class CPathRequestTracer {
+public:
+	bool IsCapturing() const { return capturing.load(std::memory_order_relaxed); }
+
+	void StartCapture();
+	// returns false if nothing was captured or the file could not be written
+	bool StopCapture(const std::string& filePath, unsigned int& numRequests);
+
+	// thread-safe, TKPFS requests arrive from the MT request phase
+	void AddRequest(
+		const CSolidObject* caller,
+		const MoveDef* moveDef,
+		const float3& startPos,
+		const float3& goalPos,
+		float goalRadius
+	);
+
+	// referencePath may be empty; the summary is logged
+	bool Replay(const std::string& tracePath, const std::string& resultsPath, const std::string& referencePath) const;
+
+private:
+	std::atomic<bool> capturing = {false};
+
+	std::mutex requestsMutex;
+	std::vector<PathRequestTrace::Request> requests;
+};
+
+extern CPathRequestTracer pathRequestTracer;
+
+#endif
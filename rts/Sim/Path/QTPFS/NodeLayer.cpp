@@ -69,6 +69,7 @@ void QTPFS::NodeLayer::Clear() {
 
 	#ifdef QTPFS_STAGGERED_LAYER_UPDATES
 	layerUpdates.clear();
+	numMergedUpdates = 0;
 	#endif
 }
 
@@ -76,9 +77,33 @@ void QTPFS::NodeLayer::Clear() {
 
 #ifdef QTPFS_STAGGERED_LAYER_UPDATES
 void QTPFS::NodeLayer::QueueUpdate(const SRectangle& r, const MoveDef* md) {
+	// fold <r> into the most recent queued update it overlaps, as long
+	// as no later queued update touches <r> (those would then replay an
+	// older snapshot over it) and the union does not grow far beyond the
+	// two originals; repeated craters in one spot thus cost one update
+	for (size_t n = layerUpdates.size(), i = n; i > 0 && (n - i) < MAX_MERGED_UPDATE_LOOKBACK; i--) {
+		LayerUpdate& layerUpdate = layerUpdates[i - 1];
+		SRectangle& lr = layerUpdate.rectangle;
+
+		if (!lr.CheckOverlap(r))
+			continue;
+
+		const SRectangle ur = {std::min(lr.x1, r.x1), std::min(lr.z1, r.z1), std::max(lr.x2, r.x2), std::max(lr.z2, r.z2)};
+
+		if (ur.GetArea() > ((lr.GetArea() + r.GetArea()) * 2))
+			break;
+
+		// re-snapshot the whole union, current terrain supersedes both
+		SnapshotUpdate(layerUpdate, ur, md);
+		numMergedUpdates += 1;
+		return;
+	}
+
 	layerUpdates.emplace_back();
-	LayerUpdate& layerUpdate = layerUpdates.back();
+	SnapshotUpdate(layerUpdates.back(), r, md);
+}
 
+void QTPFS::NodeLayer::SnapshotUpdate(LayerUpdate& layerUpdate, const SRectangle& r, const MoveDef* md) {
 	// the first update MUST have a non-zero counter
 	// since all nodes are at 0 after initialization
 	layerUpdate.rectangle = r;
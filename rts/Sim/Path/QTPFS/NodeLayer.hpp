@@ -53,6 +53,7 @@ namespace QTPFS {
 		bool HaveQueuedUpdate() const { return (!layerUpdates.empty()); }
 		const LayerUpdate& GetQueuedUpdate() const { return (layerUpdates.front()); }
 		unsigned int NumQueuedUpdates() const { return (layerUpdates.size()); }
+		unsigned int NumMergedUpdates() const { return numMergedUpdates; }
 		#endif
 
 		bool Update(
@@ -141,7 +142,14 @@ namespace QTPFS {
 		std::vector<SpeedBinType> oldSpeedBins;
 
 		#ifdef QTPFS_STAGGERED_LAYER_UPDATES
+		void SnapshotUpdate(LayerUpdate& layerUpdate, const SRectangle& r, const MoveDef* md);
+
 		std::deque<LayerUpdate> layerUpdates;
+
+		// how far back QueueUpdate looks for an update to merge with
+		static constexpr size_t MAX_MERGED_UPDATE_LOOKBACK = 16;
+
+		unsigned int numMergedUpdates = 0;
 		#endif
 
 		// root lives outside pool s.t. all four children of a given node are always in one chunk
@@ -107,6 +107,8 @@ namespace QTPFS {
 
 	unsigned int PathManager::LAYERS_PER_UPDATE;
 	unsigned int PathManager::MAX_TEAM_SEARCHES;
+	unsigned int PathManager::MIN_FIELD_GROUP_SIZE;
+	unsigned int PathManager::MAX_LAYER_UPDATE_SQUARES;
 
 	std::vector<NodeLayer> PathManager::nodeLayers;
 	std::vector<QTNode*> PathManager::nodeTrees;
@@ -123,6 +125,35 @@ QTPFS::PathManager::PathManager() {
 }
 
 QTPFS::PathManager::~PathManager() {
+	// workers might still be touching the layers, let them finish first
+	for (SearchBatch& batch: searchBatches) {
+		WaitForSearchBatch(batch);
+
+		for (SearchJob& job: batch.jobs) {
+			delete job.search;
+		}
+		for (FieldJob& field: batch.fields) {
+			delete field.search;
+		}
+	}
+
+	if (numSearchBatches > 0)
+		LOG("[QTPFS::%s] %u off-frame search-batches, %u missed their delivery frame", __func__, numSearchBatches, numMissedDeliveries);
+	if (numFieldSearches > 0)
+		LOG("[QTPFS::%s] %u field-searches served %u requests", __func__, numFieldSearches, numFieldSamples);
+
+	#ifdef QTPFS_STAGGERED_LAYER_UPDATES
+	if (numLayerUpdates > 0) {
+		unsigned int numMergedUpdates = 0;
+
+		for (const NodeLayer& nodeLayer: nodeLayers) {
+			numMergedUpdates += nodeLayer.NumMergedUpdates();
+		}
+
+		LOG("[QTPFS::%s] %u layer-updates executed, %u more merged into them", __func__, numLayerUpdates, numMergedUpdates);
+	}
+	#endif
+
 	for (unsigned int layerNum = 0; layerNum < nodeLayers.size(); layerNum++) {
 		nodeTrees[layerNum]->Merge(nodeLayers[layerNum]);
 		nodeLayers[layerNum].Clear();
@@ -144,6 +175,7 @@ QTPFS::PathManager::~PathManager() {
 	pathSearches.clear();
 	pathTypes.clear();
 	pathTraces.clear();
+	searchBatches.clear();
 
 	numCurrExecutedSearches.clear();
 	numPrevExecutedSearches.clear();
@@ -182,6 +214,12 @@ std::int64_t QTPFS::PathManager::Finalize() {
 void QTPFS::PathManager::InitStatic() {
 	LAYERS_PER_UPDATE = std::max(1u, mapInfo->pfs.qtpfs_constants.layersPerUpdate);
 	MAX_TEAM_SEARCHES = std::max(1u, mapInfo->pfs.qtpfs_constants.maxTeamSearches);
+	// zero disables field searches; a group of one is never worth it
+	MIN_FIELD_GROUP_SIZE = mapInfo->pfs.qtpfs_constants.minFieldGroupSize;
+	MIN_FIELD_GROUP_SIZE = (MIN_FIELD_GROUP_SIZE == 0)? -1u: std::max(2u, MIN_FIELD_GROUP_SIZE);
+	// zero means no quota, i.e. drain each layer's update queue in one go
+	MAX_LAYER_UPDATE_SQUARES = mapInfo->pfs.qtpfs_constants.maxLayerUpdateSquares;
+	MAX_LAYER_UPDATE_SQUARES = (MAX_LAYER_UPDATE_SQUARES == 0)? -1u: MAX_LAYER_UPDATE_SQUARES;
 }
 
 void QTPFS::PathManager::Load() {
@@ -191,10 +229,18 @@ void QTPFS::PathManager::Load() {
 	numPathRequests   = 0;
 	maxNumLeafNodes   = 0;
 
+	numSearchBatches    = 0;
+	numMissedDeliveries = 0;
+	numFieldSearches    = 0;
+	numFieldSamples     = 0;
+	numLayerUpdates     = 0;
+
 	nodeTrees.resize(moveDefHandler.GetNumMoveDefs(), nullptr);
 	nodeLayers.resize(moveDefHandler.GetNumMoveDefs());
 	pathCaches.resize(moveDefHandler.GetNumMoveDefs());
 	pathSearches.resize(moveDefHandler.GetNumMoveDefs());
+	// batches are not movable, construct in place
+	searchBatches = std::vector<SearchBatch>(moveDefHandler.GetNumMoveDefs());
 
 	// add one extra element for object-less requests
 	numCurrExecutedSearches.resize(teamHandler.ActiveTeams() + 1, 0);
@@ -252,7 +298,7 @@ void QTPFS::PathManager::Load() {
 
 	{
 		const std::string sumStr = "pfs-checksum: " + IntToString(pfsCheckSum, "%08x") + ", ";
-		const std::string memStr = "mem-footprint: " + IntToString(GetMemFootPrint()) + "MB";
+		const std::string memStr = "mem-footprint: " + IntToString(GetMemFootPrint() / (1024 * 1024)) + "MB";
 
 		pmLoadScreen.AddMessage("[" + std::string(__func__) + "] " + sumStr + memStr);
 		pmLoadScreen.Kill();
@@ -267,8 +313,7 @@ std::uint64_t QTPFS::PathManager::GetMemFootPrint() const {
 		memFootPrint += nodeTrees[i]->GetMemFootPrint(nodeLayers[i]);
 	}
 
-	// convert to megabytes
-	return (memFootPrint / (1024 * 1024));
+	return memFootPrint;
 }
 
 
@@ -434,7 +479,7 @@ void QTPFS::PathManager::UpdateNodeLayer(unsigned int layerNum, const SRectangle
 
 	// NOTE:
 	//     this is needed for IsBlocked* --> SquareIsBlocked --> IsNonBlocking
-	//     but no point doing it in ExecuteSearch because the IsBlocked* calls
+	//     but no point doing it in LaunchSearch because the IsBlocked* calls
 	//     are only made from NodeLayer::Update and also no point doing it here
 	//     since we are independent of a specific path --> requires redesign
 	//
@@ -486,21 +531,30 @@ void QTPFS::PathManager::QueueNodeLayerUpdates(const SRectangle& r) {
 	}
 }
 
-void QTPFS::PathManager::ExecQueuedNodeLayerUpdates(unsigned int layerNum, bool flushQueue) {
-	// flush this layer's entire update-queue if necessary
-	// (otherwise eat through 5 percent of it s.t. updates
-	// do not pile up faster than we consume them)
+void QTPFS::PathManager::ExecQueuedNodeLayerUpdates(unsigned int layerNum) {
+	// eat through at most MAX_LAYER_UPDATE_SQUARES worth of this layer's
+	// queue (but always at least one update s.t. it keeps draining); the
+	// quota depends only on the queue contents, never on timing
+	//
+	// searches do not wait for the rest, they run on the stale part of
+	// the tree and MarkDeadPaths re-requests any path crossing an update
+	// once it is executed
 	//
 	// called at run-time only, not load-time so we always
 	// *want* (as opposed to need) a tesselation pass here
 	//
-	unsigned int maxExecutedUpdates = nodeLayers[layerNum].NumQueuedUpdates() * 0.05f;
-	unsigned int numExecutedUpdates = 0;
+	unsigned int numExecutedSquares = 0;
 
 	while (nodeLayers[layerNum].HaveQueuedUpdate()) {
 		const LayerUpdate& lu = nodeLayers[layerNum].GetQueuedUpdate();
 		const SRectangle& mr = lu.rectangle;
 
+		if (numExecutedSquares > 0 && (numExecutedSquares + mr.GetArea()) > MAX_LAYER_UPDATE_SQUARES)
+			break;
+
+		numExecutedSquares += mr.GetArea();
+		numLayerUpdates += 1;
+
 		SRectangle ur = mr;
 
 		if (nodeLayers[layerNum].ExecQueuedUpdate()) {
@@ -521,11 +575,6 @@ void QTPFS::PathManager::ExecQueuedNodeLayerUpdates(unsigned int layerNum, bool
 		}
 
 		nodeLayers[layerNum].PopQueuedUpdate();
-
-		if ((!flushQueue) && ((numExecutedUpdates += 1) >= maxExecutedUpdates)) {
-			// no pending searches this frame, stop flushing
-			break;
-		}
 	}
 }
 #endif
@@ -653,7 +702,9 @@ void QTPFS::PathManager::TerrainChange(unsigned int x1, unsigned int z1,  unsign
 	// layers right away, depends on many factors
 	QueueNodeLayerUpdates(SRectangle(x1, z1,  x2, z2));
 	#else
-	// update all layers right now for this change-event
+	// update all layers right now for this change-event; any
+	// in-flight searches have to be delivered before that
+	DeliverSearchBatches(true);
 	UpdateNodeLayersThreaded(SRectangle(x1, z1,  x2, z2));
 	#endif
 }
@@ -710,16 +761,21 @@ void QTPFS::PathManager::ThreadUpdate() {
 		static unsigned int minPathTypeUpdate = 0;
 		static unsigned int maxPathTypeUpdate = numPathTypeUpdates;
 
-		sharedPaths.clear();
+		// results of batches launched SEARCH_DELIVERY_FRAMES ago
+		DeliverSearchBatches(false);
 
 		for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
 			#ifndef QTPFS_IGNORE_DEAD_PATHS
 			QueueDeadPathSearches(pathTypeUpdate);
 			#endif
 
+			// layer still belongs to a worker, queued searches and updates wait
+			if (searchBatches[pathTypeUpdate].InFlight())
+				continue;
+
 			#ifdef QTPFS_STAGGERED_LAYER_UPDATES
 			// NOTE: *must* be called between QueueDeadPathSearches and ExecuteQueuedSearches
-			ExecQueuedNodeLayerUpdates(pathTypeUpdate, !pathSearches[pathTypeUpdate].empty());
+			ExecQueuedNodeLayerUpdates(pathTypeUpdate);
 			#endif
 
 			ExecuteQueuedSearches(pathTypeUpdate);
@@ -750,22 +806,40 @@ void QTPFS::PathManager::ThreadUpdate() {
 void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int pathType) {
 	NodeLayer& nodeLayer = nodeLayers[pathType];
 	PathCache& pathCache = pathCaches[pathType];
+	SearchBatch& batch = searchBatches[pathType];
 
 	std::vector<IPathSearch*>& searches = pathSearches[pathType];
 	std::vector<IPathSearch*>::iterator searchesIt = searches.begin();
 
-	if (!searches.empty()) {
-		// execute pending searches collected via
-		// RequestPath and QueueDeadPathSearches
-		while (searchesIt != searches.end()) {
-			if (ExecuteSearch(searches, searchesIt, nodeLayer, pathCache, pathType)) {
-				searchStateOffset += NODE_STATE_OFFSET;
-			}
-		}
+	if (searches.empty())
+		return;
+
+	assert(!batch.InFlight());
+	assert(batch.jobs.empty());
+	assert(batch.fields.empty());
+
+	// large groups heading to the same goal share one field-search
+	LaunchFieldSearches(pathType);
+
+	// move remaining searches collected via RequestPath
+	// and QueueDeadPathSearches into this layer's batch
+	for (searchesIt = searches.begin(); searchesIt != searches.end(); ) {
+		LaunchSearch(searches, searchesIt, nodeLayer, pathCache, pathType);
 	}
+
+	if (batch.jobs.empty())
+		return;
+
+	batch.deliveryFrame = gs->frameNum + SEARCH_DELIVERY_FRAMES;
+	batch.finished.store(false, std::memory_order_release);
+
+	numSearchBatches += 1;
+
+	// runs inline if the pool has no workers
+	ThreadPool::Enqueue(&PathManager::ExecuteSearchBatch, &batch);
 }
 
-bool QTPFS::PathManager::ExecuteSearch(
+bool QTPFS::PathManager::LaunchSearch(
 	PathSearchVect& searches,
 	PathSearchVectIt& searchesIt,
 	NodeLayer& nodeLayer,
@@ -778,17 +852,13 @@ bool QTPFS::PathManager::ExecuteSearch(
 	assert(search != nullptr);
 	assert(path != nullptr);
 
-	const auto DeleteSearch = [](IPathSearch* s, PathSearchVect& v, PathSearchVectIt& it) {
-		// ordering of still-queued searches is not relevant
-		*it = v.back();
-		v.pop_back();
-		delete s;
-	};
-
 	// temp-path might have been removed already via
 	// DeletePath before we got a chance to process it
 	if (path->GetID() == 0) {
-		DeleteSearch(search, searches, searchesIt);
+		// ordering of still-queued searches is not relevant
+		*searchesIt = searches.back();
+		searches.pop_back();
+		delete search;
 		return false;
 	}
 
@@ -796,21 +866,9 @@ bool QTPFS::PathManager::ExecuteSearch(
 	assert(path->GetID() == search->GetID());
 
 	search->Initialize(&nodeLayer, &pathCache, path->GetSourcePoint(), path->GetTargetPoint(), MAP_RECTANGLE);
-	path->SetHash(search->GetHash(mapDims.mapx * mapDims.mapy, pathType));
 
+	#ifdef QTPFS_LIMIT_TEAM_SEARCHES
 	{
-		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		SharedPathMap::const_iterator sharedPathsIt = sharedPaths.find(path->GetHash());
-
-		if (sharedPathsIt != sharedPaths.end()) {
-			if (search->SharedFinalize(sharedPathsIt->second, path)) {
-				DeleteSearch(search, searches, searchesIt);
-				return false;
-			}
-		}
-		#endif
-
-		#ifdef QTPFS_LIMIT_TEAM_SEARCHES
 		const unsigned int numCurrSearches = numCurrExecutedSearches[search->GetTeam()];
 		const unsigned int numPrevSearches = numPrevExecutedSearches[search->GetTeam()];
 
@@ -819,26 +877,263 @@ bool QTPFS::PathManager::ExecuteSearch(
 		}
 
 		numCurrExecutedSearches[search->GetTeam()] += 1;
+	}
+	#endif
+
+	PushSearchJob(searchBatches[pathType], search, path, pathType);
+
+	*searchesIt = searches.back();
+	searches.pop_back();
+	return true;
+}
+
+void QTPFS::PathManager::LaunchFieldSearches(unsigned int pathType) {
+	NodeLayer& nodeLayer = nodeLayers[pathType];
+	PathCache& pathCache = pathCaches[pathType];
+	SearchBatch& batch = searchBatches[pathType];
+
+	std::vector<IPathSearch*>& searches = pathSearches[pathType];
+
+	if (searches.size() < MIN_FIELD_GROUP_SIZE)
+		return;
+
+	fieldGroupKeys.clear();
+	fieldGroupKeys.reserve(searches.size());
+
+	for (unsigned int i = 0; i < searches.size(); i++) {
+		IPathSearch* search = searches[i];
+		IPath* path = pathCache.GetTempPath(search->GetID());
+
+		// deleted, left for LaunchSearch to clean up
+		if (path->GetID() == 0)
+			continue;
+
+		search->Initialize(&nodeLayer, &pathCache, path->GetSourcePoint(), path->GetTargetPoint(), MAP_RECTANGLE);
+		fieldGroupKeys.emplace_back(search->GetTeam(), search->GetTargetNodeNumber(), i);
+	}
+
+	// node-numbers rather than pointers keep the grouping order synced
+	std::sort(fieldGroupKeys.begin(), fieldGroupKeys.end());
+
+	for (size_t a = 0, b = 0; a < fieldGroupKeys.size(); a = b) {
+		const unsigned int team = std::get<0>(fieldGroupKeys[a]);
+		const unsigned int node = std::get<1>(fieldGroupKeys[a]);
+
+		for (b = a + 1; b < fieldGroupKeys.size(); b++) {
+			if (std::get<0>(fieldGroupKeys[b]) != team || std::get<1>(fieldGroupKeys[b]) != node)
+				break;
+		}
+
+		if ((b - a) < MIN_FIELD_GROUP_SIZE)
+			continue;
+
+		#ifdef QTPFS_LIMIT_TEAM_SEARCHES
+		// the whole group counts as a single search
+		if ((numCurrExecutedSearches[team] - numPrevExecutedSearches[team]) >= MAX_TEAM_SEARCHES)
+			continue;
+
+		numCurrExecutedSearches[team] += 1;
 		#endif
+
+		// all members share a goal-node, the first one's target seeds the field
+		const IPath* goalPath = pathCache.GetTempPath(searches[std::get<2>(fieldGroupKeys[a])]->GetID());
+		const float3& goalPos = goalPath->GetTargetPoint();
+
+		// bound the integration to the group's extent plus some room for detours
+		SRectangle fieldRect(goalPos.x / SQUARE_SIZE, goalPos.z / SQUARE_SIZE, goalPos.x / SQUARE_SIZE, goalPos.z / SQUARE_SIZE);
+
+		for (size_t k = a; k < b; k++) {
+			const float3& pos = pathCache.GetTempPath(searches[std::get<2>(fieldGroupKeys[k])]->GetID())->GetSourcePoint();
+
+			fieldRect.x1 = std::min(fieldRect.x1, int(pos.x / SQUARE_SIZE));
+			fieldRect.z1 = std::min(fieldRect.z1, int(pos.z / SQUARE_SIZE));
+			fieldRect.x2 = std::max(fieldRect.x2, int(pos.x / SQUARE_SIZE));
+			fieldRect.z2 = std::max(fieldRect.z2, int(pos.z / SQUARE_SIZE));
+		}
+
+		const int fieldPad = std::max(std::max(fieldRect.GetWidth(), fieldRect.GetHeight()) / 2, 32);
+
+		fieldRect.x1 = std::max(fieldRect.x1 - fieldPad,            0);
+		fieldRect.z1 = std::max(fieldRect.z1 - fieldPad,            0);
+		fieldRect.x2 = std::min(fieldRect.x2 + fieldPad, mapDims.mapx);
+		fieldRect.z2 = std::min(fieldRect.z2 + fieldPad, mapDims.mapy);
+
+		FieldJob field;
+
+		field.search = new PathSearch(PATH_SEARCH_DIJKSTRA);
+		field.search->Initialize(&nodeLayer, &pathCache, goalPos, goalPos, fieldRect);
+		field.stateOffset = searchStateOffset;
+		field.magicNumber = numTerrainChanges;
+		field.firstJob = batch.jobs.size();
+		field.numJobs = b - a;
+
+		searchStateOffset += NODE_STATE_OFFSET;
+
+		// members keep their own search as a fallback for unreached nodes
+		for (size_t k = a; k < b; k++) {
+			IPathSearch*& search = searches[std::get<2>(fieldGroupKeys[k])];
+
+			PushSearchJob(batch, search, pathCache.GetTempPath(search->GetID()), pathType);
+			search = nullptr;
+		}
+
+		batch.fields.push_back(field);
+		numFieldSearches += 1;
 	}
 
-	// removes path from temp-paths, adds it to live-paths
-	if (search->Execute(searchStateOffset, numTerrainChanges)) {
-		search->Finalize(path);
+	searches.erase(std::remove(searches.begin(), searches.end(), nullptr), searches.end());
+}
+
+void QTPFS::PathManager::PushSearchJob(SearchBatch& batch, IPathSearch* search, IPath* path, unsigned int pathType) {
+	SearchJob job;
+
+	path->SetHash(search->GetHash(mapDims.mapx * mapDims.mapy, pathType));
+
+	// the worker only sees its own copy of the path
+	job.search = search;
+	job.result.AllocPoints(2);
+	job.result.SetSourcePoint(path->GetSourcePoint());
+	job.result.SetTargetPoint(path->GetTargetPoint());
+	job.stateOffset = searchStateOffset;
+	job.magicNumber = numTerrainChanges;
+	job.success = false;
+	job.sampled = false;
+
+	batch.jobs.push_back(std::move(job));
+
+	searchStateOffset += NODE_STATE_OFFSET;
+}
+
+__FORCE_ALIGN_STACK__
+void QTPFS::PathManager::ExecuteSearchBatch(SearchBatch* batch) {
+	// reset FPU state for synced computations
+	streflop::streflop_init<streflop::Simple>();
+
+	{
+		SCOPED_MT_TIMER("Sim::Path::AsyncSearch");
+
+		std::vector<float3> samplePoints;
+
+		// fields first, each must be fully sampled before the next
+		// search on this layer overwrites the node back-pointers
+		for (FieldJob& field: batch->fields) {
+			samplePoints.clear();
+
+			for (size_t i = field.firstJob; i < (field.firstJob + field.numJobs); i++) {
+				samplePoints.push_back(batch->jobs[i].result.GetSourcePoint());
+			}
+
+			field.search->ExecuteField(field.stateOffset, field.magicNumber, samplePoints);
+
+			for (size_t i = field.firstJob; i < (field.firstJob + field.numJobs); i++) {
+				SearchJob& job = batch->jobs[i];
+				IPath& path = job.result;
+
+				job.success = (job.sampled = field.search->SampleField(&path, path.GetSourcePoint(), path.GetTargetPoint()));
+			}
+		}
+
+		// in launch-order, node-states depend on it
+		for (SearchJob& job: batch->jobs) {
+			if (job.sampled)
+				continue;
+
+			if ((job.success = job.search->Execute(job.stateOffset, job.magicNumber)))
+				job.search->TraceResult(&job.result);
+		}
+	}
+
+	batch->finished.store(true, std::memory_order_release);
+}
+
+void QTPFS::PathManager::WaitForSearchBatch(SearchBatch& batch) {
+	if (batch.finished.load(std::memory_order_acquire))
+		return;
+
+	SCOPED_TIMER("Sim::Path::AsyncSearch::Wait");
+
+	while (!batch.finished.load(std::memory_order_acquire)) {
+		spring::this_thread::yield();
+	}
+}
+
+void QTPFS::PathManager::DeliverSearchBatches(bool force) {
+	for (unsigned int pathType = 0; pathType < searchBatches.size(); pathType++) {
+		const SearchBatch& batch = searchBatches[pathType];
+
+		if (!batch.InFlight())
+			continue;
+		if (!force && batch.deliveryFrame > gs->frameNum)
+			continue;
+
+		DeliverSearchBatch(pathType);
+	}
+}
+
+void QTPFS::PathManager::DeliverSearchBatch(unsigned int pathType) {
+	PathCache& pathCache = pathCaches[pathType];
+	SearchBatch& batch = searchBatches[pathType];
+
+	// a late worker stalls the sim rather than delaying its
+	// results, otherwise delivery would depend on wall-time
+	if (!batch.finished.load(std::memory_order_acquire)) {
+		numMissedDeliveries += 1;
+		WaitForSearchBatch(batch);
+	}
+
+	sharedPaths.clear();
+
+	// removes paths from temp-paths, adds them to live-paths; each
+	// client does this in launch-order on the same frame
+	for (SearchJob& job: batch.jobs) {
+		IPathSearch* search = job.search;
+		IPath* path = pathCache.GetTempPath(search->GetID());
+
+		// deleted while the search was in flight
+		if (path->GetID() == 0) {
+			delete search;
+			continue;
+		}
 
 		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		sharedPaths[path->GetHash()] = path;
-		#endif
+		SharedPathMap::const_iterator sharedPathsIt = sharedPaths.find(path->GetHash());
 
-		#ifdef QTPFS_TRACE_PATH_SEARCHES
-		pathTraces[path->GetID()] = search->GetExecutionTrace();
+		if (sharedPathsIt != sharedPaths.end()) {
+			if (search->SharedFinalize(sharedPathsIt->second, path)) {
+				delete search;
+				continue;
+			}
+		}
 		#endif
-	} else {
-		DeletePath(path->GetID());
+
+		numFieldSamples += job.sampled;
+
+		if (job.success) {
+			path->CopyPoints(job.result);
+			path->SetBoundingBox();
+			pathCache.AddLivePath(path);
+
+			#ifdef QTPFS_SEARCH_SHARED_PATHS
+			sharedPaths[path->GetHash()] = path;
+			#endif
+
+			#ifdef QTPFS_TRACE_PATH_SEARCHES
+			pathTraces[path->GetID()] = search->GetExecutionTrace();
+			#endif
+		} else {
+			DeletePath(path->GetID());
+		}
+
+		delete search;
 	}
 
-	DeleteSearch(search, searches, searchesIt);
-	return true;
+	for (FieldJob& field: batch.fields) {
+		delete field.search;
+	}
+
+	batch.jobs.clear();
+	batch.fields.clear();
+	batch.deliveryFrame = -1;
 }
 
 void QTPFS::PathManager::QueueDeadPathSearches(unsigned int pathType) {
@@ -881,7 +1176,7 @@ unsigned int QTPFS::PathManager::QueueSearch(
 	//     the path-owner object handed to us can never become
 	//     dangling (even with delayed execution) because ~GMT
 	//     calls DeletePath, which ensures any path is removed
-	//     from its cache before we get to ExecuteSearch
+	//     from its cache before we get to DeliverSearchBatch
 	IPath* newPath = new IPath();
 	IPathSearch* newSearch = new PathSearch(PATH_SEARCH_ASTAR);
 
@@ -985,6 +1280,8 @@ unsigned int QTPFS::PathManager::RequestPath(
 	if (!IsFinalized())
 		return 0;
 
+	TraceRequest(object, moveDef, sourcePoint, targetPoint, radius);
+
 	return (QueueSearch(nullptr, object, moveDef, sourcePoint, targetPoint, radius, synced));
 }
 
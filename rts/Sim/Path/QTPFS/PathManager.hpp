@@ -3,6 +3,8 @@
 #ifndef QTPFS_PATHMANAGER_HDR
 #define QTPFS_PATHMANAGER_HDR
 
+#include <atomic>
+#include <tuple>
 #include <vector>
 
 #include "Sim/Path/IPathManager.h"
@@ -34,6 +36,7 @@ namespace QTPFS {
 
 		std::int32_t GetPathFinderType() const override { return QTPFS_TYPE; }
 		std::uint32_t GetPathCheckSum() const override { return pfsCheckSum; }
+		std::uint64_t GetMemFootPrint() const override;
 
 		std::int64_t Finalize() override;
 
@@ -82,8 +85,6 @@ namespace QTPFS {
 		void ThreadUpdate();
 		void Load();
 
-		std::uint64_t GetMemFootPrint() const;
-
 		typedef void (PathManager::*MemberFunc)(
 			unsigned int threadNum,
 			unsigned int numThreads,
@@ -99,6 +100,48 @@ namespace QTPFS {
 		typedef std::vector<IPathSearch*> PathSearchVect;
 		typedef std::vector<IPathSearch*>::iterator PathSearchVectIt;
 
+		struct SearchJob {
+			IPathSearch* search;
+
+			// waypoints traced by the worker, copied into the temp-path on delivery
+			IPath result;
+
+			unsigned int stateOffset;
+			unsigned int magicNumber;
+
+			bool success;
+			// true if <result> was sampled from a group's field, <search> is then skipped
+			bool sampled;
+		};
+
+		// one integration-field search shared by a group of requests that
+		// have the same goal-node and team, see LaunchFieldSearches
+		struct FieldJob {
+			PathSearch* search;
+
+			unsigned int stateOffset;
+			unsigned int magicNumber;
+
+			// group members are jobs [firstJob, firstJob + numJobs)
+			size_t firstJob;
+			size_t numJobs;
+		};
+
+		// searches launched on one layer in the same frame; executed off-frame
+		// by an async worker and delivered SEARCH_DELIVERY_FRAMES later so all
+		// clients see the results on the same frame regardless of worker speed
+		// the layer is not updated and no new batch is launched on it until the
+		// current one has been delivered, workers are the sole users of its nodes
+		struct SearchBatch {
+			bool InFlight() const { return (deliveryFrame >= 0); }
+
+			std::vector<SearchJob> jobs;
+			std::vector<FieldJob> fields;
+			std::atomic<bool> finished = {true};
+
+			int deliveryFrame = -1;
+		};
+
 		void SpawnSpringThreads(MemberFunc f, const SRectangle& r);
 
 		void InitNodeLayersThreaded(const SRectangle& rect);
@@ -118,12 +161,21 @@ namespace QTPFS {
 
 		#ifdef QTPFS_STAGGERED_LAYER_UPDATES
 		void QueueNodeLayerUpdates(const SRectangle& r);
-		void ExecQueuedNodeLayerUpdates(unsigned int layerNum, bool flushQueue);
+		void ExecQueuedNodeLayerUpdates(unsigned int layerNum);
 		#endif
 
 		void ExecuteQueuedSearches(unsigned int pathType);
 		void QueueDeadPathSearches(unsigned int pathType);
 
+		void LaunchFieldSearches(unsigned int pathType);
+		void PushSearchJob(SearchBatch& batch, IPathSearch* search, IPath* path, unsigned int pathType);
+
+		void DeliverSearchBatches(bool force);
+		void DeliverSearchBatch(unsigned int pathType);
+		void WaitForSearchBatch(SearchBatch& batch);
+
+		static void ExecuteSearchBatch(SearchBatch* batch);
+
 		unsigned int QueueSearch(
 			const IPath* oldPath,
 			const CSolidObject* object,
@@ -134,7 +186,7 @@ namespace QTPFS {
 			const bool synced
 		);
 
-		bool ExecuteSearch(
+		bool LaunchSearch(
 			PathSearchVect& searches,
 			PathSearchVectIt& searchesIt,
 			NodeLayer& nodeLayer,
@@ -159,17 +211,34 @@ namespace QTPFS {
 		// maps "hashes" of executed searches to the found paths
 		spring::unordered_map<std::uint64_t, IPath*> sharedPaths;
 
+		// at most one in-flight batch per layer
+		std::vector<SearchBatch> searchBatches;
+
+		// {team, goal-node number, index into pathSearches[pathType]}
+		std::vector< std::tuple<unsigned int, unsigned int, unsigned int> > fieldGroupKeys;
+
 		std::vector<unsigned int> numCurrExecutedSearches;
 		std::vector<unsigned int> numPrevExecutedSearches;
 
 		static unsigned int LAYERS_PER_UPDATE;
 		static unsigned int MAX_TEAM_SEARCHES;
 
+		static unsigned int MIN_FIELD_GROUP_SIZE;
+		static unsigned int MAX_LAYER_UPDATE_SQUARES;
+
+		static constexpr int SEARCH_DELIVERY_FRAMES = 2;
+
 		unsigned int searchStateOffset;
 		unsigned int numTerrainChanges;
 		unsigned int numPathRequests;
 		unsigned int maxNumLeafNodes;
 
+		unsigned int numSearchBatches = 0;
+		unsigned int numMissedDeliveries = 0;
+		unsigned int numFieldSearches = 0;
+		unsigned int numFieldSamples = 0;
+		unsigned int numLayerUpdates = 0;
+
 		std::uint32_t pfsCheckSum;
 
 		bool layersInited;
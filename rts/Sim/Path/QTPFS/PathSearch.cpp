@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 #include <limits>
 
@@ -15,7 +16,7 @@
 
 #include "System/float3.h"
 
-QTPFS::binary_heap<QTPFS::INode*> QTPFS::PathSearch::openNodes;
+thread_local QTPFS::binary_heap<QTPFS::INode*> QTPFS::PathSearch::openNodes;
 
 
 
@@ -51,6 +52,7 @@ bool QTPFS::PathSearch::Execute(
 
 	haveFullPath = (srcNode == tgtNode);
 	havePartPath = false;
+	haveFieldPath = false;
 
 	// early-out
 	if (haveFullPath)
@@ -116,6 +118,98 @@ bool QTPFS::PathSearch::Execute(
 	return (haveFullPath || havePartPath);
 }
 
+void QTPFS::PathSearch::ExecuteField(
+	unsigned int searchStateOffset,
+	unsigned int searchMagicNumber,
+	const std::vector<float3>& samplePoints
+) {
+	searchState = searchStateOffset;
+	searchMagic = searchMagicNumber;
+
+	haveFullPath = false;
+	havePartPath = false;
+	haveFieldPath = true;
+
+	// there is no single target, every node is expanded until all
+	// sample-nodes are closed (or the search-area is exhausted)
+	tgtNode = nullptr;
+	tgtPoint = srcPoint;
+	hCostMult = 0.0f;
+
+	std::vector<const INode*> sampleNodes;
+	sampleNodes.reserve(samplePoints.size());
+
+	for (float3 p: samplePoints) {
+		p.ClampInBounds();
+		sampleNodes.push_back(nodeLayer->GetNode(p.x / SQUARE_SIZE, p.z / SQUARE_SIZE));
+	}
+
+	// only used for membership tests, pointer-order is fine here
+	std::sort(sampleNodes.begin(), sampleNodes.end());
+	sampleNodes.erase(std::unique(sampleNodes.begin(), sampleNodes.end()), sampleNodes.end());
+
+	std::vector<bool> closedNodes(sampleNodes.size(), false);
+	size_t numOpenNodes = sampleNodes.size();
+
+	if (srcNode->GetMoveCost() == QTPFS_POSITIVE_INFINITY)
+		srcNode->SetMoveCost(0.0f);
+
+	ResetState(srcNode);
+	UpdateNode(srcNode, nullptr, 0);
+
+	while (!openNodes.empty() && numOpenNodes > 0) {
+		IterateNodes(nodeLayer->GetNodes());
+
+		const auto it = std::lower_bound(sampleNodes.begin(), sampleNodes.end(), curNode);
+
+		if (it == sampleNodes.end() || *it != curNode)
+			continue;
+
+		const size_t idx = it - sampleNodes.begin();
+
+		numOpenNodes -= (!closedNodes[idx]);
+		closedNodes[idx] = true;
+	}
+
+	openNodes.reset();
+
+	if (srcNode->GetMoveCost() == 0.0f)
+		srcNode->SetMoveCost(QTPFS_POSITIVE_INFINITY);
+}
+
+bool QTPFS::PathSearch::SampleField(IPath* path, float3 sourcePoint, float3 targetPoint) {
+	assert(haveFieldPath);
+
+	sourcePoint.ClampInBounds();
+	targetPoint.ClampInBounds();
+
+	INode* node = nodeLayer->GetNode(sourcePoint.x / SQUARE_SIZE, sourcePoint.z / SQUARE_SIZE);
+
+	// reached and closed by this field's integration pass?
+	if (node->GetSearchState() != (searchState | NODE_STATE_CLOSED))
+		return false;
+
+	// the field was integrated from the goal outward, so trace
+	// from <node> back to it and flip the waypoints afterwards
+	tgtNode = node;
+	tgtPoint = sourcePoint;
+
+	path->AllocPoints(2);
+	TraceResult(path);
+
+	for (unsigned int i = 0, j = path->NumPoints() - 1; i < j; i++, j--) {
+		const float3 p = path->GetPoint(i);
+
+		path->SetPoint(i, path->GetPoint(j));
+		path->SetPoint(j, p);
+	}
+
+	// any point in the (rectangular) goal-node is reachable from its edges
+	path->SetTargetPoint(targetPoint);
+	path->SetBoundingBox();
+	return true;
+}
+
 
 
 void QTPFS::PathSearch::ResetState(INode* node) {
@@ -293,6 +387,13 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 }
 
 void QTPFS::PathSearch::Finalize(IPath* path) {
+	TraceResult(path);
+
+	// path remains in live-cache until DeletePath is called
+	pathCache->AddLivePath(path);
+}
+
+void QTPFS::PathSearch::TraceResult(IPath* path) {
 	TracePath(path);
 
 	#ifdef QTPFS_SMOOTH_PATHS
@@ -300,9 +401,6 @@ void QTPFS::PathSearch::Finalize(IPath* path) {
 	#endif
 
 	path->SetBoundingBox();
-
-	// path remains in live-cache until DeletePath is called
-	pathCache->AddLivePath(path);
 }
 
 void QTPFS::PathSearch::TracePath(IPath* path) {
@@ -335,7 +433,8 @@ void QTPFS::PathSearch::TracePath(IPath* path) {
 			// make sure the back-pointers can never become dangling
 			// (if smoothing IS enabled, we delay this until we reach
 			// SmoothPath() because we still need them there)
-			tmpNode->SetPrevNode(nullptr);
+			if (!haveFieldPath)
+				tmpNode->SetPrevNode(nullptr);
 			#endif
 
 			prvPoint = tmpPoint;
@@ -375,6 +474,9 @@ void QTPFS::PathSearch::SmoothPath(IPath* path) const {
 		}
 	}
 
+	if (haveFieldPath)
+		return;
+
 	INode* n0 = tgtNode;
 	INode* n1 = tgtNode;
 
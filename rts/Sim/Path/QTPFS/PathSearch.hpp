@@ -96,10 +96,12 @@ namespace QTPFS {
 			unsigned int searchMagicNumber = 0
 		) = 0;
 		virtual void Finalize(IPath* path) = 0;
+		virtual void TraceResult(IPath* path) = 0;
 		virtual bool SharedFinalize(const IPath* srcPath, IPath* dstPath) { return false; }
 		virtual PathSearchTrace::Execution* GetExecutionTrace() { return NULL; }
 
 		virtual const std::uint64_t GetHash(std::uint64_t N, std::uint32_t k) const = 0;
+		virtual unsigned int GetTargetNodeNumber() const = 0;
 
 		void SetID(unsigned int n) { searchID = n; }
 		void SetTeam(unsigned int n) { searchTeam = n; }
@@ -131,6 +133,7 @@ namespace QTPFS {
 			, hCostMult(0.0f)
 			, haveFullPath(false)
 			, havePartPath(false)
+			, haveFieldPath(false)
 			{}
 		~PathSearch() { openNodes.reset(); }
 
@@ -146,10 +149,29 @@ namespace QTPFS {
 			unsigned int searchMagicNumber = 0
 		);
 		void Finalize(IPath* path);
+		// writes the waypoints found by Execute into <path> without touching
+		// the cache; relies on node back-pointers, so must run before another
+		// search executes on the same layer
+		void TraceResult(IPath* path);
 		bool SharedFinalize(const IPath* srcPath, IPath* dstPath);
 		PathSearchTrace::Execution* GetExecutionTrace() { return searchExec; }
 
+		// integration-field mode: expands outward from the source point (a
+		// group's goal) until the nodes containing all <samplePoints> are
+		// closed, afterwards the back-pointer of every closed node leads to
+		// the goal and SampleField can be called once per group member
+		void ExecuteField(
+			unsigned int searchStateOffset,
+			unsigned int searchMagicNumber,
+			const std::vector<float3>& samplePoints
+		);
+		// writes the path from <sourcePoint> through the field to <targetPoint>
+		// (which must lie in the field's goal-node) into <path>; false if the
+		// node containing <sourcePoint> was not reached by ExecuteField
+		bool SampleField(IPath* path, float3 sourcePoint, float3 targetPoint);
+
 		const std::uint64_t GetHash(std::uint64_t N, std::uint32_t k) const;
+		unsigned int GetTargetNodeNumber() const { return (tgtNode->GetNodeNumber()); }
 
 		static void InitGlobalQueue(unsigned int n) { openNodes.reserve(n); }
 		static void FreeGlobalQueue() { openNodes.clear(); }
@@ -167,7 +189,8 @@ namespace QTPFS {
 
 		// global queue: allocated once, re-used by all searches without clear()'s
 		// this relies on INode::operator< to sort the INode*'s by increasing f-cost
-		static binary_heap<INode*> openNodes;
+		// (one per thread since searches on different layers run concurrently)
+		static thread_local binary_heap<INode*> openNodes;
 
 		NodeLayer* nodeLayer;
 		PathCache* pathCache;
@@ -196,6 +219,8 @@ namespace QTPFS {
 
 		bool haveFullPath;
 		bool havePartPath;
+		// back-pointers are shared by all samples of a field, do not reset them
+		bool haveFieldPath;
 	};
 }
 
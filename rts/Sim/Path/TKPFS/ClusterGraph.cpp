@@ -0,0 +1,295 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ClusterGraph.h"
+#include "PathConstants.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <utility>
+
+namespace TKPFS {
+
+// start and goal clusters closer than this are searched without a corridor
+static constexpr int MIN_CORRIDOR_DISTANCE = 2;
+// how many clusters the corridor extends beyond the cluster route
+static constexpr int CORRIDOR_MARGIN = 1;
+
+
+void ClusterGraph::Init(int2 _numBlocks, unsigned int _clusterSize, unsigned int _numPathTypes)
+{
+	assert(_clusterSize != 0);
+
+	numBlocks = _numBlocks;
+	numClusters = {int((numBlocks.x + _clusterSize - 1) / _clusterSize), int((numBlocks.y + _clusterSize - 1) / _clusterSize)};
+
+	clusterSize = _clusterSize;
+	numPathTypes = _numPathTypes;
+
+	edgeCosts.clear();
+	edgeCosts.resize(numPathTypes * GetNumClusters() * PATH_DIRECTION_VERTICES, PATHCOST_INFINITY);
+	minEdgeCosts.clear();
+	minEdgeCosts.resize(numPathTypes, 0.0f);
+
+	dirtyMask.clear();
+	dirtyMask.resize(GetNumClusters(), 0);
+	dirtyClusters.clear();
+}
+
+void ClusterGraph::Kill()
+{
+	clusterSize = 0;
+	numPathTypes = 0;
+
+	edgeCosts.clear();
+	minEdgeCosts.clear();
+	dirtyMask.clear();
+	dirtyClusters.clear();
+}
+
+
+void ClusterGraph::Rebuild(const std::vector<float>& vertexCosts)
+{
+	assert(vertexCosts.size() == (numPathTypes * numBlocks.x * numBlocks.y * PATH_DIRECTION_VERTICES));
+
+	// the other four directions are covered by the neighbouring clusters
+	for (unsigned int idx = 0, n = GetNumClusters(); idx < n; idx++) {
+		CalcClusterEdges(vertexCosts, idx, PATH_DIRECTION_VERTICES);
+	}
+
+	std::fill(dirtyMask.begin(), dirtyMask.end(), 0);
+	dirtyClusters.clear();
+
+	CalcMinEdgeCosts();
+}
+
+void ClusterGraph::MarkDirtyBlock(int2 blockPos)
+{
+	if (static_cast<unsigned int>(blockPos.x) >= numBlocks.x || static_cast<unsigned int>(blockPos.y) >= numBlocks.y)
+		return;
+
+	// a block's vertices only lead into the eight surrounding blocks, so
+	// every edge they contribute to has an endpoint in the block's cluster
+	const unsigned int idx = ClusterPosToIdx(BlockToClusterPos(blockPos));
+
+	if (dirtyMask[idx] != 0)
+		return;
+
+	dirtyMask[idx] = 1;
+	dirtyClusters.push_back(idx);
+}
+
+void ClusterGraph::Repair(const std::vector<float>& vertexCosts)
+{
+	if (dirtyClusters.empty())
+		return;
+
+	for (const unsigned int idx: dirtyClusters) {
+		CalcClusterEdges(vertexCosts, idx, PATH_DIRECTIONS);
+		dirtyMask[idx] = 0;
+	}
+
+	dirtyClusters.clear();
+
+	CalcMinEdgeCosts();
+}
+
+
+float ClusterGraph::GetEdgeCost(unsigned int pathType, int2 clusterPos, unsigned int dir) const
+{
+	const unsigned int edgeIdx =
+		pathType * GetNumClusters() * PATH_DIRECTION_VERTICES +
+		ClusterPosToIdx(clusterPos) * PATH_DIRECTION_VERTICES +
+		GetBlockVertexOffset(dir, numClusters.x);
+
+	return edgeCosts[edgeIdx];
+}
+
+void ClusterGraph::CalcClusterEdges(const std::vector<float>& vertexCosts, unsigned int clusterIdx, unsigned int numDirs)
+{
+	const int2 clusterPos = ClusterIdxToPos(clusterIdx);
+
+	for (unsigned int pathType = 0; pathType < numPathTypes; pathType++) {
+		const unsigned int edgeBaseIdx = pathType * GetNumClusters() * PATH_DIRECTION_VERTICES + clusterIdx * PATH_DIRECTION_VERTICES;
+
+		for (unsigned int dir = 0; dir < numDirs; dir++) {
+			const int2 nbrPos = clusterPos + PE_DIRECTION_VECTORS[dir];
+			const bool inside = (static_cast<unsigned int>(nbrPos.x) < numClusters.x && static_cast<unsigned int>(nbrPos.y) < numClusters.y);
+
+			// edges in the upper four directions are stored at the neighbour
+			if (!inside && dir >= PATH_DIRECTION_VERTICES)
+				continue;
+
+			edgeCosts[edgeBaseIdx + GetBlockVertexOffset(dir, numClusters.x)] = inside? CalcEdgeCost(vertexCosts, pathType, clusterPos, dir): PATHCOST_INFINITY;
+		}
+	}
+}
+
+float ClusterGraph::CalcEdgeCost(const std::vector<float>& vertexCosts, unsigned int pathType, int2 clusterPos, unsigned int dir) const
+{
+	const int2 nbrPos = clusterPos + PE_DIRECTION_VECTORS[dir];
+
+	const int2 minBlockPos = clusterPos * clusterSize;
+	const int2 maxBlockPos = {std::min(minBlockPos.x + int(clusterSize), numBlocks.x), std::min(minBlockPos.y + int(clusterSize), numBlocks.y)};
+
+	const unsigned int vertexBaseIdx = pathType * numBlocks.x * numBlocks.y * PATH_DIRECTION_VERTICES;
+
+	float minCost = PATHCOST_INFINITY;
+
+	// cheapest vertex between any block of this cluster and any block of
+	// the neighbour; only the blocks along the shared border can qualify
+	for (int z = minBlockPos.y; z < maxBlockPos.y; z++) {
+		for (int x = minBlockPos.x; x < maxBlockPos.x; x++) {
+			const int2 blockPos = {x, z};
+			const unsigned int blockIdx = z * numBlocks.x + x;
+
+			for (unsigned int blockDir = 0; blockDir < PATH_DIRECTIONS; blockDir++) {
+				const int2 nbrBlockPos = blockPos + PE_DIRECTION_VECTORS[blockDir];
+
+				if (static_cast<unsigned int>(nbrBlockPos.x) >= numBlocks.x || static_cast<unsigned int>(nbrBlockPos.y) >= numBlocks.y)
+					continue;
+				if (BlockToClusterPos(nbrBlockPos) != nbrPos)
+					continue;
+
+				minCost = std::min(minCost, vertexCosts[vertexBaseIdx + blockIdx * PATH_DIRECTION_VERTICES + GetBlockVertexOffset(blockDir, numBlocks.x)]);
+			}
+		}
+	}
+
+	// crossing a cluster takes clusterSize block steps; assume all of
+	// them are as cheap as the best entrance (keeps the search greedy)
+	return (minCost * clusterSize);
+}
+
+void ClusterGraph::CalcMinEdgeCosts()
+{
+	for (unsigned int pathType = 0; pathType < numPathTypes; pathType++) {
+		const unsigned int edgeBaseIdx = pathType * GetNumClusters() * PATH_DIRECTION_VERTICES;
+
+		float minCost = PATHCOST_INFINITY;
+
+		for (unsigned int idx = 0, n = GetNumClusters(); idx < n; idx++) {
+			minCost = std::min(minCost, edgeCosts[edgeBaseIdx + idx * PATH_DIRECTION_VERTICES + PATHDIR_LEFT]);
+			minCost = std::min(minCost, edgeCosts[edgeBaseIdx + idx * PATH_DIRECTION_VERTICES + PATHDIR_UP  ]);
+		}
+
+		minEdgeCosts[pathType] = (minCost < PATHCOST_INFINITY)? minCost: 0.0f;
+	}
+}
+
+
+bool ClusterGraph::FindCorridor(
+	unsigned int pathType,
+	int2 srcBlockPos,
+	int2 tgtBlockPos,
+	std::vector<std::uint8_t>& corridor,
+	unsigned int* numExpandedClusters
+) const {
+	constexpr float DIAG_STEP_COST = 1.4142135f;
+
+	// per-thread since PE searches run concurrently
+	static thread_local std::vector<float> gCosts;
+	static thread_local std::vector<unsigned int> parents;
+	static thread_local std::vector<std::uint8_t> closed;
+	static thread_local std::vector< std::pair<float, unsigned int> > openQueue;
+
+	if (numExpandedClusters != nullptr)
+		*numExpandedClusters = 0;
+
+	if (!IsInitialized())
+		return false;
+
+	srcBlockPos = {std::clamp(srcBlockPos.x, 0, numBlocks.x - 1), std::clamp(srcBlockPos.y, 0, numBlocks.y - 1)};
+	tgtBlockPos = {std::clamp(tgtBlockPos.x, 0, numBlocks.x - 1), std::clamp(tgtBlockPos.y, 0, numBlocks.y - 1)};
+
+	const int2 srcPos = BlockToClusterPos(srcBlockPos);
+	const int2 tgtPos = BlockToClusterPos(tgtBlockPos);
+
+	if (std::max(std::abs(tgtPos.x - srcPos.x), std::abs(tgtPos.y - srcPos.y)) < MIN_CORRIDOR_DISTANCE)
+		return false;
+
+	const float hCostMult = minEdgeCosts[pathType];
+	const auto Heuristic = [&](int2 pos) {
+		const int dx = std::abs(tgtPos.x - pos.x);
+		const int dz = std::abs(tgtPos.y - pos.y);
+		return (hCostMult * (std::max(dx, dz) + (DIAG_STEP_COST - 1.0f) * std::min(dx, dz)));
+	};
+
+	const unsigned int srcIdx = ClusterPosToIdx(srcPos);
+	const unsigned int tgtIdx = ClusterPosToIdx(tgtPos);
+
+	gCosts.assign(GetNumClusters(), PATHCOST_INFINITY);
+	parents.assign(GetNumClusters(), -1u);
+	closed.assign(GetNumClusters(), 0);
+	openQueue.clear();
+
+	gCosts[srcIdx] = 0.0f;
+	openQueue.emplace_back(Heuristic(srcPos), srcIdx);
+
+	// ties are broken by index, keeps the corridor independent of timing
+	constexpr std::greater< std::pair<float, unsigned int> > cmp;
+
+	while (!openQueue.empty()) {
+		std::pop_heap(openQueue.begin(), openQueue.end(), cmp);
+
+		const unsigned int curIdx = openQueue.back().second;
+		openQueue.pop_back();
+
+		if (closed[curIdx] != 0)
+			continue;
+
+		closed[curIdx] = 1;
+
+		if (numExpandedClusters != nullptr)
+			*numExpandedClusters += 1;
+
+		if (curIdx == tgtIdx)
+			break;
+
+		const int2 curPos = ClusterIdxToPos(curIdx);
+
+		for (unsigned int dir = 0; dir < PATH_DIRECTIONS; dir++) {
+			const int2 nbrPos = curPos + PE_DIRECTION_VECTORS[dir];
+
+			if (static_cast<unsigned int>(nbrPos.x) >= numClusters.x || static_cast<unsigned int>(nbrPos.y) >= numClusters.y)
+				continue;
+
+			const unsigned int nbrIdx = ClusterPosToIdx(nbrPos);
+			const float edgeCost = GetEdgeCost(pathType, curPos, dir);
+
+			if (edgeCost >= PATHCOST_INFINITY || closed[nbrIdx] != 0)
+				continue;
+
+			const float gCost = gCosts[curIdx] + edgeCost;
+
+			if (gCost >= gCosts[nbrIdx])
+				continue;
+
+			gCosts[nbrIdx] = gCost;
+			parents[nbrIdx] = curIdx;
+
+			openQueue.emplace_back(gCost + Heuristic(nbrPos), nbrIdx);
+			std::push_heap(openQueue.begin(), openQueue.end(), cmp);
+		}
+	}
+
+	if (closed[tgtIdx] == 0)
+		return false;
+
+	corridor.assign(GetNumClusters(), 0);
+
+	for (unsigned int idx = tgtIdx; idx != -1u; idx = parents[idx]) {
+		const int2 pos = ClusterIdxToPos(idx);
+
+		for (int z = std::max(pos.y - CORRIDOR_MARGIN, 0); z <= std::min(pos.y + CORRIDOR_MARGIN, numClusters.y - 1); z++) {
+			for (int x = std::max(pos.x - CORRIDOR_MARGIN, 0); x <= std::min(pos.x + CORRIDOR_MARGIN, numClusters.x - 1); x++) {
+				corridor[ClusterPosToIdx({x, z})] = 1;
+			}
+		}
+	}
+
+	return true;
+}
+
+}
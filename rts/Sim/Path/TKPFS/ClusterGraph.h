@@ -0,0 +1,95 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef TKPFS_CLUSTERGRAPH_H
+#define TKPFS_CLUSTERGRAPH_H
+
+#include <cinttypes>
+#include <vector>
+
+#include "System/type2.h"
+
+namespace TKPFS {
+
+/**
+ * Coarse (HPA*-style) abstraction on top of the low-res PathingState.
+ * Every clusterSize x clusterSize blocks form a cluster; the entrance
+ * graph links each cluster to its eight neighbours with the cheapest
+ * block vertex crossing their shared border. It carries no data of its
+ * own, everything is derived from the vertex costs of the underlying
+ * level and repaired per cluster whenever those change.
+ *
+ * A search over the (small) cluster graph yields a corridor of clusters
+ * which the block-level search is then confined to; the corridor is a
+ * hint only, callers must fall back to an unrestricted search if the
+ * block-level search fails inside it.
+ */
+class ClusterGraph {
+public:
+	void Init(int2 numBlocks, unsigned int clusterSize, unsigned int numPathTypes);
+	void Kill();
+
+	// vertexCosts uses the PathingState layout, i.e. PATH_DIRECTION_VERTICES
+	// costs per block, blocks of each path-type stored consecutively
+	void Rebuild(const std::vector<float>& vertexCosts);
+
+	// call after the vertex costs of a block (for any path-type) changed
+	void MarkDirtyBlock(int2 blockPos);
+	// recalculates the edges of all clusters marked dirty since last time
+	void Repair(const std::vector<float>& vertexCosts);
+
+	/**
+	 * Searches the cluster graph and marks the clusters on the resulting
+	 * route, plus a one-cluster margin around it, in corridor (which is
+	 * resized to GetNumClusters()). Returns false if no corridor exists
+	 * or if the blocks are too close together for one to be worthwhile.
+	 */
+	bool FindCorridor(
+		unsigned int pathType,
+		int2 srcBlockPos,
+		int2 tgtBlockPos,
+		std::vector<std::uint8_t>& corridor,
+		unsigned int* numExpandedClusters = nullptr
+	) const;
+
+	bool InCorridor(const std::vector<std::uint8_t>& corridor, int2 blockPos) const {
+		return (corridor[ClusterPosToIdx(BlockToClusterPos(blockPos))] != 0);
+	}
+
+	bool IsInitialized() const { return (clusterSize != 0); }
+
+	int2 BlockToClusterPos(int2 blockPos) const { return {int(blockPos.x / clusterSize), int(blockPos.y / clusterSize)}; }
+	int2 ClusterIdxToPos(unsigned int idx) const { return {int(idx % numClusters.x), int(idx / numClusters.x)}; }
+	unsigned int ClusterPosToIdx(int2 pos) const { return (pos.y * numClusters.x + pos.x); }
+
+	unsigned int GetNumClusters() const { return (numClusters.x * numClusters.y); }
+	unsigned int GetNumDirtyClusters() const { return dirtyClusters.size(); }
+	unsigned int GetClusterSize() const { return clusterSize; }
+
+	// cost of moving from cluster to its neighbour in PE direction dir
+	float GetEdgeCost(unsigned int pathType, int2 clusterPos, unsigned int dir) const;
+
+private:
+	void CalcClusterEdges(const std::vector<float>& vertexCosts, unsigned int clusterIdx, unsigned int numDirs);
+	float CalcEdgeCost(const std::vector<float>& vertexCosts, unsigned int pathType, int2 clusterPos, unsigned int dir) const;
+	void CalcMinEdgeCosts();
+
+private:
+	int2 numBlocks;
+	int2 numClusters;
+
+	unsigned int clusterSize = 0;
+	unsigned int numPathTypes = 0;
+
+	// PATH_DIRECTION_VERTICES edges per cluster per path-type, using the
+	// same bi-directional layout as PathingState::vertexCosts
+	std::vector<float> edgeCosts;
+	// cheapest cardinal edge per path-type, scales the search heuristic
+	std::vector<float> minEdgeCosts;
+
+	std::vector<std::uint8_t> dirtyMask;
+	std::vector<unsigned int> dirtyClusters;
+};
+
+}
+
+#endif
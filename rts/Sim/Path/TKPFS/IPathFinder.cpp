@@ -5,6 +5,7 @@
 #include "Sim/Path/Default/PathLog.h"
 #include "Sim/Path/TKPFS/PathGlobal.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
+#include "Sim/Path/PathRequestBroker.h"
 #include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
 
@@ -20,7 +21,7 @@ static std::vector<IPathFinder*> pathFinderInstances;
 
 
 void IPathFinder::InitStatic() { pathFinderInstances.reserve(8); }
-void IPathFinder::KillStatic() { pathFinderInstances.clear  ( ); }
+void IPathFinder::KillStatic() { pathFinderInstances.clear  ( ); PathLog::LogSearchStats(); }
 
 
 void IPathFinder::Init(unsigned int _BLOCK_SIZE)
@@ -90,6 +91,7 @@ void IPathFinder::ResetSearch()
 	openBlocks.Clear();
 
 	testedBlocks = 0;
+	expandedBlocks = 0;
 }
 
 //std::mutex cacheAccessLock;
@@ -152,6 +154,9 @@ IPath::SearchResult IPathFinder::GetPath(
 	// start up a new search
 	const IPath::SearchResult result = InitSearch(moveDef, pfDef, owner);
 
+	// lets the request broker enforce its per-frame node budget
+	CPathRequestBroker::AddSearchedNodes(testedBlocks);
+
 	// if search was successful, generate new path and cache it
 	if (result == IPath::Ok || result == IPath::GoalOutOfRange) {
 		FinishSearch(moveDef, pfDef, path);
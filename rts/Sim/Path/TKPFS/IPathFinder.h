@@ -139,6 +139,7 @@ public:
 
 	unsigned int maxBlocksToBeSearched = 0;
 	unsigned int testedBlocks = 0;
+	unsigned int expandedBlocks = 0;
 
 	unsigned int instanceIndex = 0;
 
@@ -7,7 +7,6 @@
 #include "Sim/Misc/GlobalSynced.h"
 #include "System/Log/ILog.h"
 
-#define MAX_CACHE_QUEUE_SIZE   200
 #define MAX_PATH_LIFETIME_SECS   6
 #define USE_NONCOLLIDABLE_HASH   1
 
@@ -27,7 +26,13 @@ CPathCache::CPathCache(int blocksX, int blocksZ)
 	// {result, path, strtBlock, goalBlock, goalRadius, pathType}
 	dummyCacheItem = {IPath::Error, {}, {-1, -1}, {-1, -1}, -1.0f, -1};
 
-	cachedPaths.reserve(4096);
+	cacheTable.fill({0, -1});
+	freeItems.reserve(MAX_CACHE_ITEMS);
+
+	// hand out low indices first
+	for (int i = MAX_CACHE_ITEMS - 1; i >= 0; i--) {
+		freeItems.push_back(i);
+	}
 }
 
 CPathCache::~CPathCache()
@@ -39,7 +44,7 @@ CPathCache::~CPathCache()
 		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%lu";
 #endif
 
-	LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, GetCacheHitPercentage(), numHashCollisions, maxCacheSize);
+	LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, numCacheHits.load(), GetCacheHitPercentage(), numHashCollisions, maxCacheSize);
 }
 
 bool CPathCache::AddPath(
@@ -55,23 +60,33 @@ bool CPathCache::AddPath(
 
 	const std::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
 	const std::uint32_t cols = numHashCollisions;
-	const auto iter = cachedPaths.find(hash);
-
-	// LOG("%llu Cache L1 added entry (%d): (%d, %d) -> (%d, %d) ~ %f for [%d] (%llu) : %llu (available? %d)"
-	// 		, numBlocks
-	// 		, result
-	// 		, strtBlock.x, strtBlock.y
-	// 		, goalBlock.x, goalBlock.y
-	// 		, goalRadius, pathType
-	// 		, currentFrameCachedPaths.size()
-	// 		, hash
-	// 		, (iter == currentFrameCachedPaths.end()));
+	const int slotIdx = FindSlot(hash);
 
 	// register any hash collisions
-	if (iter != cachedPaths.end())
-		return ((numHashCollisions += HashCollision(iter->second, strtBlock, goalBlock, goalRadius, pathType)) != cols);
+	if (slotIdx >= 0)
+		return ((numHashCollisions += HashCollision(cacheItems[cacheTable[slotIdx].itemIdx], strtBlock, goalBlock, goalRadius, pathType)) != cols);
+
+	assert(!freeItems.empty());
 
-	cachedPaths[hash] = CacheItem{result, *path, strtBlock, goalBlock, goalRadius, pathType};
+	const std::int32_t itemIdx = freeItems.back();
+	CacheItem& item = cacheItems[itemIdx];
+
+	freeItems.pop_back();
+
+	item.result = result;
+	item.path = *path;
+	item.strtBlock = strtBlock;
+	item.goalBlock = goalBlock;
+	item.goalRadius = goalRadius;
+	item.pathType = pathType;
+
+	unsigned int freeSlotIdx = GetSlotIndex(hash);
+
+	while (cacheTable[freeSlotIdx].itemIdx >= 0) {
+		freeSlotIdx = (freeSlotIdx + 1) & (CACHE_TABLE_SIZE - 1);
+	}
+
+	cacheTable[freeSlotIdx] = {hash, itemIdx};
 
 	const int lifeTime = (result == IPath::Ok) ? GAME_SPEED * MAX_PATH_LIFETIME_SECS : GAME_SPEED * (MAX_PATH_LIFETIME_SECS / 2);
 
@@ -86,7 +101,7 @@ const CPathCache::CacheItem& CPathCache::GetCachedPath(
 	const int2 goalBlock,
 	float goalRadius,
 	int pathType
-) {
+) const {
 	const std::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
 
 	// LOG("%llu Cache lookup: (%d, %d) -> (%d, %d) ~ %f for [%d] (%llu) : %llu"
@@ -98,20 +113,19 @@ const CPathCache::CacheItem& CPathCache::GetCachedPath(
 	// 		, hash
 	// 		);
 
-	{
-		auto iter = cachedPaths.find(hash);
-		if (iter != cachedPaths.end()
-				&& (iter->second).strtBlock == strtBlock
-				&& (iter->second).goalBlock == goalBlock
-				&& (iter->second).pathType == pathType
-			) {
-			// LOG("Cache Hit %d", iter->second.path.path.size());
-			++numCacheHits;
-			return (iter->second);
+	const int slotIdx = FindSlot(hash);
+
+	if (slotIdx >= 0) {
+		const CacheItem& item = cacheItems[cacheTable[slotIdx].itemIdx];
+
+		if (item.strtBlock == strtBlock && item.goalBlock == goalBlock && item.pathType == pathType) {
+			// LOG("Cache Hit %d", item.path.path.size());
+			numCacheHits.fetch_add(1, std::memory_order_relaxed);
+			return item;
 		}
 	}
 
-	++numCacheMisses;
+	numCacheMisses.fetch_add(1, std::memory_order_relaxed);
 	return dummyCacheItem;
 }
 
@@ -123,13 +137,60 @@ void CPathCache::Update()
 
 void CPathCache::RemoveFrontQueItem()
 {
-	const auto it = cachedPaths.find((cacheQue.front()).hash);
+	const int slotIdx = FindSlot((cacheQue.front()).hash);
 
-	assert(it != cachedPaths.end());
-	cachedPaths.erase(it);
+	assert(slotIdx >= 0);
+	EraseSlot(slotIdx);
 	cacheQue.pop_front();
 }
 
+
+unsigned int CPathCache::GetSlotIndex(std::uint64_t hash) const
+{
+	// keys are dense linear indices, spread them over the table first
+	return ((hash * 0x9E3779B97F4A7C15ull) >> (64 - CACHE_TABLE_BITS));
+}
+
+int CPathCache::FindSlot(std::uint64_t hash) const
+{
+	for (unsigned int slotIdx = GetSlotIndex(hash); ; slotIdx = (slotIdx + 1) & (CACHE_TABLE_SIZE - 1)) {
+		const CacheSlot& slot = cacheTable[slotIdx];
+
+		// the table is never full, every probe sequence ends in an empty slot
+		if (slot.itemIdx < 0)
+			return -1;
+		if (slot.hash == hash)
+			return slotIdx;
+	}
+
+	return -1;
+}
+
+void CPathCache::EraseSlot(unsigned int slotIdx)
+{
+	freeItems.push_back(cacheTable[slotIdx].itemIdx);
+
+	// pull later members of the probe sequence back into the hole so
+	// FindSlot never has to skip over tombstones
+	for (unsigned int nextIdx = slotIdx; ; ) {
+		nextIdx = (nextIdx + 1) & (CACHE_TABLE_SIZE - 1);
+
+		if (cacheTable[nextIdx].itemIdx < 0)
+			break;
+
+		const unsigned int homeIdx = GetSlotIndex(cacheTable[nextIdx].hash);
+
+		// entry can stay if its home lies cyclically within (slotIdx, nextIdx]
+		if ((slotIdx <= nextIdx)? ((slotIdx < homeIdx) && (homeIdx <= nextIdx)): ((slotIdx < homeIdx) || (homeIdx <= nextIdx)))
+			continue;
+
+		cacheTable[slotIdx] = cacheTable[nextIdx];
+		slotIdx = nextIdx;
+	}
+
+	cacheTable[slotIdx].itemIdx = -1;
+}
+
 std::uint64_t CPathCache::GetHash(
 	const int2 strtBlk,
 	const int2 goalBlk,
@@ -3,15 +3,26 @@
 #ifndef TKPFS_PATHCACHE_H
 #define TKPFS_PATHCACHE_H
 
+#include <array>
+#include <atomic>
 #include <deque>
-#include <unordered_map>
+#include <vector>
 
 #include "Sim/Path/Default/IPath.h"
 #include "System/type2.h"
-#include "System/UnorderedMap.hpp"
 
 namespace TKPFS {
 
+/**
+ * Cache of recent block-level paths, shared by every unit of a path-type.
+ *
+ * Entries live in a fixed pool and are found through an open-addressing
+ * table (linear probing, backward-shift deletion), so neither lookups nor
+ * evictions allocate. The table is only modified from the serial parts of
+ * a frame (the end-of-frame merge in pathId order, Update, single-threaded
+ * requests); the MT request phase just reads it, which is why lookups need
+ * no lock and the returned references stay valid until the next merge.
+ */
 class CPathCache
 {
 public:
@@ -42,11 +53,15 @@ public:
 		const int2 goalBlock,
 		float goalRadius,
 		int pathType
-	);
+	) const;
 
 private:
 	void RemoveFrontQueItem();
 
+	unsigned int GetSlotIndex(std::uint64_t hash) const;
+	int FindSlot(std::uint64_t hash) const;
+	void EraseSlot(unsigned int slotIdx);
+
 	std::uint64_t GetHash(
 		const int2 strtBlk,
 		const int2 goalBlk,
@@ -69,25 +84,46 @@ private:
 		return ((numCacheHits / float(numCacheHits + numCacheMisses)) * 100.0f);
 	}
 
+public:
+	// AddPath evicts once the queue grows past this, so at most one more is live
+	static constexpr unsigned int MAX_CACHE_QUEUE_SIZE = 200;
+	static constexpr unsigned int MAX_CACHE_ITEMS = MAX_CACHE_QUEUE_SIZE + 1;
+
+	// kept under half full so probe sequences stay short
+	static constexpr unsigned int CACHE_TABLE_BITS = 9;
+	static constexpr unsigned int CACHE_TABLE_SIZE = 1 << CACHE_TABLE_BITS;
+
+	static_assert(CACHE_TABLE_SIZE >= (MAX_CACHE_ITEMS * 2), "");
+
 private:
 	struct CacheQueItem {
 		std::int32_t timeout;
 		std::uint64_t hash;
 	};
 
+	struct CacheSlot {
+		std::uint64_t hash;
+		std::int32_t itemIdx; // -1 if empty
+	};
+
 	// returned on any cache-miss
 	CacheItem dummyCacheItem;
 
 	std::deque<CacheQueItem> cacheQue;
-	spring::unordered_map<std::uint64_t, CacheItem> cachedPaths; // ints are sync-safe keys
+
+	std::array<CacheSlot, CACHE_TABLE_SIZE> cacheTable;
+	std::array<CacheItem, MAX_CACHE_ITEMS> cacheItems;
+	// indices of unused cacheItems; reused items keep their path capacity
+	std::vector<std::int32_t> freeItems;
 
 	std::uint32_t numBlocksX;
 	std::uint32_t numBlocksZ;
 	std::uint64_t numBlocks;
 
 	std::uint64_t maxCacheSize;
-	std::uint32_t numCacheHits;
-	std::uint32_t numCacheMisses;
+	// bumped concurrently by the MT request phase
+	mutable std::atomic<std::uint32_t> numCacheHits;
+	mutable std::atomic<std::uint32_t> numCacheMisses;
 	std::uint32_t numHashCollisions;
 };
 
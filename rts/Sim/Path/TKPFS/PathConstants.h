@@ -30,6 +30,8 @@ static constexpr unsigned int PATHESTIMATOR_VERSION = 106;
 
 static constexpr unsigned int MEDRES_PE_BLOCKSIZE = 16;
 static constexpr unsigned int LOWRES_PE_BLOCKSIZE = 32;
+// cluster level (see ClusterGraph), in low-res blocks
+static constexpr unsigned int CLUSTER_PE_BLOCKSIZE = 4;
 
 static constexpr unsigned int SQUARES_TO_UPDATE = 8000;
 static constexpr unsigned int MAX_SEARCHED_NODES_ON_REFINE = 2000;
@@ -57,6 +57,21 @@ void CPathEstimator::Init(IPathFinder* pf, unsigned int BLOCK_SIZE, PathingState
 
 void CPathEstimator::Kill()
 {
+	clusterCorridor.clear();
+	useClusterCorridor = false;
+}
+
+
+bool CPathEstimator::ArrangeClusterCorridor(const MoveDef& moveDef, int2 srcBlockPos, int2 tgtBlockPos)
+{
+	const ClusterGraph& clusterGraph = pathingState->GetClusterGraph();
+
+	useClusterCorridor = false;
+
+	if (!clusterGraph.IsInitialized())
+		return false;
+
+	return (useClusterCorridor = clusterGraph.FindCorridor(moveDef.pathType, srcBlockPos, tgtBlockPos, clusterCorridor));
 }
 
 
@@ -67,13 +82,16 @@ void CPathEstimator::InitEstimator()
 
 const CPathCache::CacheItem& CPathEstimator::GetCache(const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced) const
 {
-	tempCacheItem = pathingState->GetCache(strtBlock, goalBlock, goalRadius, pathType, synced);
-	return tempCacheItem;
+	return (pathingState->GetCache(strtBlock, goalBlock, goalRadius, pathType, synced));
 }
 
 
 void CPathEstimator::AddCache(const IPath::Path* path, const IPath::SearchResult result, const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced)
 {
+	// partial results from within a cluster corridor get retried without it
+	if (useClusterCorridor && result != IPath::Ok)
+		return;
+
 	pathingState->AddCache(path, result, strtBlock, goalBlock, goalRadius, pathType, synced);
 }
 
@@ -266,6 +284,11 @@ bool CPathEstimator::TestBlock(
 	if (static_cast<unsigned int>(testBlockPos.y) >= nbrOfBlocks.y)
 		return false;
 
+	// outside the cluster corridor? (not PATHOPT_BLOCKED, the corridor
+	// differs per search)
+	if (useClusterCorridor && !pathingState->GetClusterGraph().InCorridor(clusterCorridor, testBlockPos))
+		return false;
+
 	// read precached vertex costs
 	const unsigned int openBlockIdx = BlockPosToIdx(openBlockPos);
 	const unsigned int testBlockIdx = BlockPosToIdx(testBlockPos);
@@ -57,6 +57,14 @@ public:
 
 	IPathFinder* GetParent() override { return parentPathFinder; }
 
+	/**
+	 * Confines subsequent searches to the cluster corridor between the
+	 * given blocks, if the PathingState has a cluster level and finds one.
+	 * Returns whether a corridor is active; ClearClusterCorridor lifts it.
+	 */
+	bool ArrangeClusterCorridor(const MoveDef& moveDef, int2 srcBlockPos, int2 tgtBlockPos);
+	void ClearClusterCorridor() { useClusterCorridor = false; }
+
 	//const std::vector<float>& GetVertexCosts() const { return vertexCosts; }
 	//const std::deque<int2>& GetUpdatedBlocks() const { return updatedBlocks; }
 
@@ -119,9 +127,11 @@ private:
 	IPathFinder* parentPathFinder; // parent (PF if BLOCK_SIZE is 16, PE[16] if 32)
 	//CPathEstimator* nextPathEstimator; // next lower-resolution estimator
 
-	mutable CPathCache::CacheItem tempCacheItem;
-
 	PathingState* pathingState;
+
+	// clusters the current search may enter (indexed as in ClusterGraph)
+	std::vector<std::uint8_t> clusterCorridor;
+	bool useClusterCorridor = false;
 };
 
 }
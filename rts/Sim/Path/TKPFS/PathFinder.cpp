@@ -35,6 +35,10 @@ static constexpr uint32_t squareMobileBlockBits =
 	uint32_t(MMBT::BLOCK_MOBILE     ) |
 	uint32_t(MMBT::BLOCK_MOVING     );
 
+// GetUniformSpeedMod sentinels
+static constexpr float UNKNOWN_SPEED_MOD = -2.0f;
+static constexpr float NON_UNIFORM_SPEED_MOD = -1.0f;
+
 static constexpr CPathFinder::BlockCheckFunc blockCheckFuncs[2] = {
 	CMoveMath::IsBlockedNoSpeedModCheckThreadUnsafe, // alias for RangeIsBlocked
 	CMoveMath::IsBlockedNoSpeedModCheck // same as RangeIsBlocked without tempNum test
@@ -81,6 +85,33 @@ static constexpr float3 PF_DIRECTION_VECTORS_3D[] = {
 };
 
 
+static float GetMobileSpeedModMult(const MoveDef& moveDef, const unsigned int blockStatus)
+{
+	switch (blockStatus & squareMobileBlockBits) {
+		case (uint32_t(MMBT::BLOCK_MOBILE_BUSY) | uint32_t(MMBT::BLOCK_MOBILE) | uint32_t(MMBT::BLOCK_MOVING)):   // 111
+		case (uint32_t(MMBT::BLOCK_MOBILE_BUSY) | uint32_t(MMBT::BLOCK_MOBILE) | uint32_t(MMBT::BLOCK_NONE  )):   // 110
+		case (uint32_t(MMBT::BLOCK_MOBILE_BUSY) | uint32_t(MMBT::BLOCK_NONE  ) | uint32_t(MMBT::BLOCK_MOVING)):   // 101
+		case (uint32_t(MMBT::BLOCK_MOBILE_BUSY) | uint32_t(MMBT::BLOCK_NONE  ) | uint32_t(MMBT::BLOCK_NONE  )): { // 100
+			return moveDef.speedModMults[MoveDef::SPEEDMOD_MOBILE_BUSY_MULT];
+		} break;
+
+		case (uint32_t(MMBT::BLOCK_NONE       ) | uint32_t(MMBT::BLOCK_MOBILE) | uint32_t(MMBT::BLOCK_MOVING)):   // 011
+		case (uint32_t(MMBT::BLOCK_NONE       ) | uint32_t(MMBT::BLOCK_MOBILE) | uint32_t(MMBT::BLOCK_NONE  )): { // 010
+			return moveDef.speedModMults[MoveDef::SPEEDMOD_MOBILE_IDLE_MULT];
+		} break;
+
+		case (uint32_t(MMBT::BLOCK_NONE       ) | uint32_t(MMBT::BLOCK_NONE  ) | uint32_t(MMBT::BLOCK_MOVING)): { // 001
+			return moveDef.speedModMults[MoveDef::SPEEDMOD_MOBILE_MOVE_MULT];
+		} break;
+
+		default: {
+		} break;
+	}
+
+	return 1.0f;
+}
+
+
 void CPathFinder::InitStatic() {
 	static_assert(PF_DIRECTION_COSTS[PATHOPT_LEFT                ] ==        1.0f, "");
 	static_assert(PF_DIRECTION_COSTS[PATHOPT_RIGHT               ] ==        1.0f, "");
@@ -129,6 +160,18 @@ void CPathFinder::Init(bool threadSafe)
 	dummyCacheItem = CPathCache::CacheItem{IPath::Error, {}, {-1, -1}, {-1, -1}, -1.0f, -1};
 }
 
+void CPathFinder::Kill()
+{
+	reverseSearch.reset();
+
+	uniformSpeedMods.clear();
+	uniformSpeedMods.shrink_to_fit();
+	dirtyUniformSpeedMods.clear();
+	dirtyUniformSpeedMods.shrink_to_fit();
+
+	IPathFinder::Kill();
+}
+
 
 IPath::SearchResult CPathFinder::DoRawSearch(
 	const MoveDef& moveDef,
@@ -214,9 +257,47 @@ IPath::SearchResult CPathFinder::DoSearch(
 	const MoveDef& moveDef,
 	const CPathFinderDef& pfDef,
 	const CSolidObject* owner
+) {
+	// PE vertex-cost searches (the only direction-independent ones) always
+	// use plain A*, their results are cached and must not depend on modes
+	const unsigned int searchMode = pfDef.dirIndependent? MoveDef::PATH_SEARCH_ASTAR: moveDef.pathSearchMode;
+
+	IPath::SearchResult result = IPath::Error;
+
+	switch (searchMode) {
+		case MoveDef::PATH_SEARCH_ASTAR: { result = DoUnidirSearch(moveDef, pfDef, owner, false); } break;
+		case MoveDef::PATH_SEARCH_JPS  : { result = DoUnidirSearch(moveDef, pfDef, owner,  true); } break;
+		case MoveDef::PATH_SEARCH_BIDIR: { result = DoBidirSearch (moveDef, pfDef, owner       ); } break;
+		default: {
+			assert(false);
+		} break;
+	}
+
+	if (!pfDef.dirIndependent)
+		PathLog::AddSearchStats(searchMode, expandedBlocks);
+
+	return result;
+}
+
+IPath::SearchResult CPathFinder::DoUnidirSearch(
+	const MoveDef& moveDef,
+	const CPathFinderDef& pfDef,
+	const CSolidObject* owner,
+	bool jumpSearch
 ) {
 	bool foundGoal = false;
 
+	if (jumpSearch) {
+		if (uniformSpeedMods.size() != (nbrOfBlocks.x * nbrOfBlocks.y))
+			uniformSpeedMods.assign(nbrOfBlocks.x * nbrOfBlocks.y, UNKNOWN_SPEED_MOD);
+
+		for (const unsigned int squareIdx: dirtyUniformSpeedMods) {
+			uniformSpeedMods[squareIdx] = UNKNOWN_SPEED_MOD;
+		}
+
+		dirtyUniformSpeedMods.clear();
+	}
+
 	while (!openBlocks.empty() && (openBlockBuffer.GetSize() < maxBlocksToBeSearched)) {
 
 		// get the open square with lowest expected path-cost
@@ -246,7 +327,13 @@ IPath::SearchResult CPathFinder::DoSearch(
 			continue;
 		}
 
-		TestNeighborSquares(moveDef, pfDef, openSquare, owner);
+		expandedBlocks++;
+
+		if (jumpSearch) {
+			TestJumpSquares(moveDef, pfDef, openSquare, owner);
+		} else {
+			TestNeighborSquares(moveDef, pfDef, openSquare, owner);
+		}
 	}
 
 	if (foundGoal)
@@ -264,6 +351,104 @@ IPath::SearchResult CPathFinder::DoSearch(
 	return IPath::Error;
 }
 
+IPath::SearchResult CPathFinder::DoBidirSearch(
+	const MoveDef& moveDef,
+	const CPathFinderDef& pfDef,
+	const CSolidObject* owner
+) {
+	// the reverse half starts from the goal-square itself, if
+	// that can not be entered there is nothing to search from
+	if (!InitReverseSearch(moveDef, pfDef, owner))
+		return DoUnidirSearch(moveDef, pfDef, owner, false);
+
+	ReverseSearchState& rs = *reverseSearch;
+
+	// cost of the cheapest path found so far through a square labelled by both halves
+	float meetCost = PATHCOST_INFINITY;
+	unsigned int meetSquareIdx = -1u;
+
+	bool foundGoal = false;
+
+	while (!openBlocks.empty() && ((openBlockBuffer.GetSize() + rs.openBlockBuffer.GetSize()) < maxBlocksToBeSearched)) {
+		// stop once either frontier can no longer improve on the meeting path
+		if (openBlocks.top()->fCost >= meetCost)
+			break;
+		if (!rs.openBlocks.empty() && rs.openBlocks.top()->fCost >= meetCost)
+			break;
+
+		// expand the smaller frontier; the reverse one runs dry when the
+		// goal-square is enclosed but other squares within the goal-radius
+		// might still be reachable, so the forward half continues on alone
+		if (rs.openBlocks.empty() || openBlocks.size() <= rs.openBlocks.size()) {
+			const PathNode* openSquare = openBlocks.top();
+			openBlocks.pop();
+
+			if (blockStates.fCost[openSquare->nodeNum] != openSquare->fCost)
+				continue;
+
+			if (pfDef.IsGoal(openSquare->nodePos.x, openSquare->nodePos.y)) {
+				mGoalBlockIdx = openSquare->nodeNum;
+				mGoalHeuristic = 0.0f;
+				foundGoal = true;
+				break;
+			}
+
+			if (!pfDef.WithinConstraints(openSquare->nodePos.x, openSquare->nodePos.y)) {
+				blockStates.nodeMask[openSquare->nodeNum] |= PATHOPT_CLOSED;
+				dirtyBlocks.push_back(openSquare->nodeNum);
+				continue;
+			}
+
+			if ((blockStates.gCost[openSquare->nodeNum] + rs.blockStates.gCost[openSquare->nodeNum]) < meetCost) {
+				meetCost = blockStates.gCost[openSquare->nodeNum] + rs.blockStates.gCost[openSquare->nodeNum];
+				meetSquareIdx = openSquare->nodeNum;
+			}
+
+			expandedBlocks++;
+
+			TestNeighborSquares(moveDef, pfDef, openSquare, owner);
+		} else {
+			const PathNode* openSquare = rs.openBlocks.top();
+			rs.openBlocks.pop();
+
+			if (rs.blockStates.fCost[openSquare->nodeNum] != openSquare->fCost)
+				continue;
+
+			if (!pfDef.WithinConstraints(openSquare->nodePos.x, openSquare->nodePos.y)) {
+				rs.blockStates.nodeMask[openSquare->nodeNum] |= PATHOPT_CLOSED;
+				rs.dirtyBlocks.push_back(openSquare->nodeNum);
+				continue;
+			}
+
+			if ((blockStates.gCost[openSquare->nodeNum] + rs.blockStates.gCost[openSquare->nodeNum]) < meetCost) {
+				meetCost = blockStates.gCost[openSquare->nodeNum] + rs.blockStates.gCost[openSquare->nodeNum];
+				meetSquareIdx = openSquare->nodeNum;
+			}
+
+			expandedBlocks++;
+
+			TestReverseSquares(moveDef, pfDef, openSquare, owner);
+		}
+	}
+
+	if (foundGoal)
+		return IPath::Ok;
+
+	if (meetSquareIdx != -1u) {
+		FinishBidirSearch(pfDef, meetSquareIdx);
+		return IPath::Ok;
+	}
+
+	if ((openBlockBuffer.GetSize() + rs.openBlockBuffer.GetSize()) >= maxBlocksToBeSearched)
+		return IPath::GoalOutOfRange;
+
+	if (openBlocks.empty())
+		return IPath::GoalOutOfRange;
+
+	// should be unreachable
+	return IPath::Error;
+}
+
 void CPathFinder::TestNeighborSquares(
 	const MoveDef& moveDef,
 	const CPathFinderDef& pfDef,
@@ -420,28 +605,8 @@ bool CPathFinder::TestBlock(
 	assert((blockStatus & MMBT::BLOCK_STRUCTURE) == 0);
 	assert(speedMod != 0.0f);
 
-	if (pfDef.testMobile && moveDef.avoidMobilesOnPath) {
-		switch (blockStatus & squareMobileBlockBits) {
-			case (uint32_t(MMBT::BLOCK_MOBILE_BUSY) | uint32_t(MMBT::BLOCK_MOBILE) | uint32_t(MMBT::BLOCK_MOVING)):   // 111
-			case (uint32_t(MMBT::BLOCK_MOBILE_BUSY) | uint32_t(MMBT::BLOCK_MOBILE) | uint32_t(MMBT::BLOCK_NONE  )):   // 110
-			case (uint32_t(MMBT::BLOCK_MOBILE_BUSY) | uint32_t(MMBT::BLOCK_NONE  ) | uint32_t(MMBT::BLOCK_MOVING)):   // 101
-			case (uint32_t(MMBT::BLOCK_MOBILE_BUSY) | uint32_t(MMBT::BLOCK_NONE  ) | uint32_t(MMBT::BLOCK_NONE  )): { // 100
-				speedMod *= moveDef.speedModMults[MoveDef::SPEEDMOD_MOBILE_BUSY_MULT];
-			} break;
-
-			case (uint32_t(MMBT::BLOCK_NONE       ) | uint32_t(MMBT::BLOCK_MOBILE) | uint32_t(MMBT::BLOCK_MOVING)):   // 011
-			case (uint32_t(MMBT::BLOCK_NONE       ) | uint32_t(MMBT::BLOCK_MOBILE) | uint32_t(MMBT::BLOCK_NONE  )): { // 010
-				speedMod *= moveDef.speedModMults[MoveDef::SPEEDMOD_MOBILE_IDLE_MULT];
-			} break;
-
-			case (uint32_t(MMBT::BLOCK_NONE       ) | uint32_t(MMBT::BLOCK_NONE  ) | uint32_t(MMBT::BLOCK_MOVING)): { // 001
-				speedMod *= moveDef.speedModMults[MoveDef::SPEEDMOD_MOBILE_MOVE_MULT];
-			} break;
-
-			default: {
-			} break;
-		}
-	}
+	if (pfDef.testMobile && moveDef.avoidMobilesOnPath)
+		speedMod *= GetMobileSpeedModMult(moveDef, blockStatus);
 
 	const float heatCost  = (pfDef.testMobile) ? gPathHeatMap.GetHeatCost(square.x, square.y, moveDef, ((owner != nullptr)? owner->id: -1U)) : 0.0f;
 	//const float flowCost  = (pfDef.testMobile) ? (PathFlowMap::GetInstance())->GetFlowCost(square.x, square.y, moveDef, pathOptDir) : 0.0f;
@@ -454,13 +619,12 @@ bool CPathFinder::TestBlock(
 	const float hCost = pfDef.Heuristic(square.x, square.y, BLOCK_SIZE); // h
 	const float fCost = gCost + hCost;                                   // f
 
-	if (blockStates.nodeMask[sqrIdx] & PATHOPT_OPEN) {
-		// already in the open set, look for a cost-improvement
-		if (blockStates.fCost[sqrIdx] <= fCost)
-			return true;
+	// already in the open set (or passed over by a jump-point scan), look
+	// for a cost-improvement; unlabelled squares have infinite cost here
+	if (blockStates.fCost[sqrIdx] <= fCost)
+		return true;
 
-		blockStates.nodeMask[sqrIdx] &= ~PATHOPT_CARDINALS;
-	}
+	blockStates.nodeMask[sqrIdx] &= ~PATHOPT_CARDINALS;
 
 	// if heuristic says this node is closer to goal than previous h-estimate, keep it
 	if (!pfDef.exactPath && hCost < mGoalHeuristic) {
@@ -491,6 +655,475 @@ bool CPathFinder::TestBlock(
 }
 
 
+
+float CPathFinder::GetUniformSpeedMod(
+	const MoveDef& moveDef,
+	const CPathFinderDef& pfDef,
+	const CSolidObject* owner,
+	const int2 square
+) {
+	if (static_cast<unsigned int>(square.x) >= nbrOfBlocks.x || static_cast<unsigned int>(square.y) >= nbrOfBlocks.y)
+		return 0.0f;
+
+	const unsigned int sqrIdx = BlockPosToIdx(square);
+
+	if (uniformSpeedMods[sqrIdx] != UNKNOWN_SPEED_MOD)
+		return uniformSpeedMods[sqrIdx];
+
+	const CMoveMath::BlockType blockMask = blockCheckFunc(moveDef, square.x, square.y, owner);
+	const float speedMod = CMoveMath::GetPosSpeedMod(moveDef, square.x, square.y);
+	const float slope = readMap->GetSlopeMapSynced()[(square.x >> 1) + (square.y >> 1) * mapDims.hmapx];
+
+	float& uniformSpeedMod = uniformSpeedMods[sqrIdx];
+
+	dirtyUniformSpeedMods.push_back(sqrIdx);
+
+	if ((blockMask & MMBT::BLOCK_STRUCTURE) != 0 || speedMod == 0.0f)
+		return (uniformSpeedMod = 0.0f);
+
+	// anything that makes the cost of entering this square depend on more
+	// than its speedmod, goal-squares (so scans stop there) and squares an
+	// expansion would not be allowed from
+	uniformSpeedMod = NON_UNIFORM_SPEED_MOD;
+
+	if (pfDef.testMobile && moveDef.avoidMobilesOnPath && (blockMask & squareMobileBlockBits) != 0)
+		return uniformSpeedMod;
+	if (pfDef.testMobile && gPathHeatMap.GetHeatCost(square.x, square.y, moveDef, ((owner != nullptr)? owner->id: -1U)) != 0.0f)
+		return uniformSpeedMod;
+	if (blockStates.GetNodeExtraCost(square.x, square.y, pfDef.synced) != 0.0f)
+		return uniformSpeedMod;
+	// directional speedmods only equal the positional one on flat ground
+	if (modInfo.allowDirectionalPathing && slope != 0.0f)
+		return uniformSpeedMod;
+	if (pfDef.IsGoal(square.x, square.y) || !pfDef.WithinConstraints(square.x, square.y))
+		return uniformSpeedMod;
+
+	return (uniformSpeedMod = speedMod);
+}
+
+void CPathFinder::TestJumpSquares(
+	const MoveDef& moveDef,
+	const CPathFinderDef& pfDef,
+	const PathNode* square,
+	const CSolidObject* owner
+) {
+	const int2 squarePos = square->nodePos;
+
+	const unsigned int parentDir = blockStates.nodeMask[square->nodeNum] & PATHOPT_CARDINALS;
+	const float refSpeedMod = GetUniformSpeedMod(moveDef, pfDef, owner, squarePos);
+
+	// the start-square (which has no parent direction to prune by) and
+	// squares of non-uniform cost get a regular 8-neighbour expansion
+	if (parentDir == 0 || refSpeedMod <= 0.0f) {
+		TestNeighborSquares(moveDef, pfDef, square, owner);
+		return;
+	}
+
+	const auto IsPassable = [&](unsigned int optDir) {
+		return (GetUniformSpeedMod(moveDef, pfDef, owner, squarePos + PF_DIRECTION_VECTORS_2D[optDir]) != 0.0f);
+	};
+
+	const unsigned int optX = parentDir & (PATHOPT_LEFT | PATHOPT_RIGHT);
+	const unsigned int optZ = parentDir & (PATHOPT_UP | PATHOPT_DOWN);
+
+	unsigned int jumpDirs[5];
+	unsigned int numJumpDirs = 0;
+
+	if (optX != 0 && optZ != 0) {
+		// reached diagonally; natural successors only, corners are never cut
+		const bool passableX = IsPassable(optX);
+		const bool passableZ = IsPassable(optZ);
+
+		if (passableX)
+			jumpDirs[numJumpDirs++] = optX;
+		if (passableZ)
+			jumpDirs[numJumpDirs++] = optZ;
+		if (passableX && passableZ)
+			jumpDirs[numJumpDirs++] = parentDir;
+	} else {
+		// reached along a cardinal; a jump-point here exists because one of its
+		// sides became reachable, so (as in JumpSquares) take all passable ones
+		const unsigned int optSides[2] = {
+			(optX != 0)? PATHOPT_UP  : PATHOPT_LEFT,
+			(optX != 0)? PATHOPT_DOWN: PATHOPT_RIGHT,
+		};
+
+		const bool passableNext = IsPassable(parentDir);
+
+		if (passableNext)
+			jumpDirs[numJumpDirs++] = parentDir;
+
+		for (const unsigned int optSide: optSides) {
+			if (!IsPassable(optSide))
+				continue;
+
+			jumpDirs[numJumpDirs++] = optSide;
+
+			if (passableNext)
+				jumpDirs[numJumpDirs++] = parentDir | optSide;
+		}
+	}
+
+	for (unsigned int i = 0; i < numJumpDirs; i++) {
+		const unsigned int numSteps = JumpSquares(moveDef, pfDef, owner, squarePos, jumpDirs[i], refSpeedMod);
+
+		if (numSteps == 0)
+			continue;
+
+		AddJumpSquares(moveDef, pfDef, square, owner, jumpDirs[i], numSteps, refSpeedMod);
+	}
+
+	blockStates.nodeMask[square->nodeNum] |= PATHOPT_CLOSED;
+	dirtyBlocks.push_back(square->nodeNum);
+}
+
+unsigned int CPathFinder::JumpSquares(
+	const MoveDef& moveDef,
+	const CPathFinderDef& pfDef,
+	const CSolidObject* owner,
+	int2 square,
+	const unsigned int pathOptDir,
+	const float refSpeedMod
+) {
+	const int2 stepVec = PF_DIRECTION_VECTORS_2D[pathOptDir];
+
+	const unsigned int optX = pathOptDir & (PATHOPT_LEFT | PATHOPT_RIGHT);
+	const unsigned int optZ = pathOptDir & (PATHOPT_UP | PATHOPT_DOWN);
+
+	const auto GetSpeedMod = [&](const int2 sqr) { return (GetUniformSpeedMod(moveDef, pfDef, owner, sqr)); };
+
+	for (unsigned int numSteps = 1; true; numSteps++) {
+		square += stepVec;
+
+		const float speedMod = GetSpeedMod(square);
+
+		// impassable; nothing to turn towards along this line
+		if (speedMod == 0.0f)
+			return 0;
+		// cost changes (or goal, or leaving the constrained area); expand regularly
+		if (speedMod != refSpeedMod)
+			return numSteps;
+
+		if (optX != 0 && optZ != 0) {
+			// diagonal scans turn wherever one of their cardinal sub-scans does
+			if (JumpSquares(moveDef, pfDef, owner, square, optX, refSpeedMod) != 0)
+				return numSteps;
+			if (JumpSquares(moveDef, pfDef, owner, square, optZ, refSpeedMod) != 0)
+				return numSteps;
+
+			// both sides must be passable for the next diagonal step
+			if (GetSpeedMod(square + PF_DIRECTION_VECTORS_2D[optX]) != refSpeedMod)
+				return 0;
+			if (GetSpeedMod(square + PF_DIRECTION_VECTORS_2D[optZ]) != refSpeedMod)
+				return 0;
+		} else {
+			const unsigned int optSides[2] = {
+				(optX != 0)? PATHOPT_UP  : PATHOPT_LEFT,
+				(optX != 0)? PATHOPT_DOWN: PATHOPT_RIGHT,
+			};
+
+			// forced neighbours; a side-square which could not be reached
+			// from the previous square's side (as that is blocked or of a
+			// different cost) makes this square a jump-point
+			for (const unsigned int optSide: optSides) {
+				const int2 sideSquare = square + PF_DIRECTION_VECTORS_2D[optSide];
+
+				if (GetSpeedMod(sideSquare) != 0.0f && GetSpeedMod(sideSquare - stepVec) != refSpeedMod)
+					return numSteps;
+			}
+		}
+	}
+
+	return 0;
+}
+
+void CPathFinder::AddJumpSquares(
+	const MoveDef& moveDef,
+	const CPathFinderDef& pfDef,
+	const PathNode* parentSquare,
+	const CSolidObject* owner,
+	const unsigned int pathOptDir,
+	const unsigned int numSteps,
+	const float refSpeedMod
+) {
+	const int2 stepVec = PF_DIRECTION_VECTORS_2D[pathOptDir];
+	const float stepCost = PF_DIRECTION_COSTS[pathOptDir] / refSpeedMod;
+
+	// all squares before the jump-point are of uniform cost (refSpeedMod)
+	PathNode jumpSquare = *parentSquare;
+	int2 jumpSquarePos = parentSquare->nodePos;
+
+	for (unsigned int n = 1; n < numSteps; n++) {
+		jumpSquarePos += stepVec;
+
+		jumpSquare.gCost  += stepCost;
+		jumpSquare.nodePos = jumpSquarePos;
+		jumpSquare.nodeNum = BlockPosToIdx(jumpSquarePos);
+
+		LabelJumpSquare(pfDef, jumpSquare, pathOptDir);
+	}
+
+	// the jump-point itself is queued like any regular successor
+	const int2 tgtSquarePos = jumpSquarePos + stepVec;
+	const unsigned int tgtSquareIdx = BlockPosToIdx(tgtSquarePos);
+
+	if (blockStates.nodeMask[tgtSquareIdx] & (PATHOPT_CLOSED | PATHOPT_BLOCKED))
+		return;
+
+	const CMoveMath::BlockType blockMask = blockCheckFunc(moveDef, tgtSquarePos.x, tgtSquarePos.y, owner);
+	const float speedMod = CMoveMath::GetPosSpeedMod(moveDef, tgtSquarePos.x, tgtSquarePos.y, PF_DIRECTION_VECTORS_3D[pathOptDir]);
+
+	if (speedMod == 0.0f)
+		return;
+
+	TestBlock(moveDef, pfDef, &jumpSquare, owner, pathOptDir, blockMask, speedMod);
+}
+
+void CPathFinder::LabelJumpSquare(const CPathFinderDef& pfDef, const PathNode& jumpSquare, const unsigned int pathOptDir)
+{
+	const unsigned int sqrIdx = jumpSquare.nodeNum;
+
+	if ((blockStates.nodeMask[sqrIdx] & PATHOPT_BLOCKED) != 0)
+		return;
+
+	const float hCost = pfDef.Heuristic(jumpSquare.nodePos.x, jumpSquare.nodePos.y, BLOCK_SIZE);
+	const float fCost = jumpSquare.gCost + hCost;
+
+	// only ever lowering a square's cost keeps each one more expensive
+	// than its parent, so backtracking in FinishSearch can not loop
+	if (blockStates.fCost[sqrIdx] <= fCost)
+		return;
+
+	if (!pfDef.exactPath && hCost < mGoalHeuristic) {
+		mGoalBlockIdx = sqrIdx;
+		mGoalHeuristic = hCost;
+	}
+
+	// a queued square would become obsolete by the cost change, so requeue it
+	if ((blockStates.nodeMask[sqrIdx] & PATHOPT_OPEN) != 0) {
+		openBlockBuffer.SetSize(openBlockBuffer.GetSize() + 1);
+		assert(openBlockBuffer.GetSize() < MAX_SEARCHED_NODES_PF);
+
+		PathNode* os = openBlockBuffer.GetNode(openBlockBuffer.GetSize());
+			os->fCost   = fCost;
+			os->gCost   = jumpSquare.gCost;
+			os->nodePos = jumpSquare.nodePos;
+			os->nodeNum = sqrIdx;
+		openBlocks.push(os);
+	}
+
+	blockStates.fCost[sqrIdx] = fCost;
+	blockStates.gCost[sqrIdx] = jumpSquare.gCost;
+	blockStates.nodeMask[sqrIdx] &= ~PATHOPT_CARDINALS;
+	blockStates.nodeMask[sqrIdx] |= pathOptDir;
+
+	dirtyBlocks.push_back(sqrIdx);
+}
+
+
+bool CPathFinder::InitReverseSearch(
+	const MoveDef& moveDef,
+	const CPathFinderDef& pfDef,
+	const CSolidObject* owner
+) {
+	if (reverseSearch == nullptr)
+		reverseSearch = std::make_unique<ReverseSearchState>();
+
+	ReverseSearchState& rs = *reverseSearch;
+
+	if (rs.blockStates.GetSize() != (nbrOfBlocks.x * nbrOfBlocks.y)) {
+		rs.blockStates.Clear();
+		rs.blockStates.Resize(nbrOfBlocks, int2(mapDims.mapx, mapDims.mapy));
+		rs.dirtyBlocks.clear();
+	}
+
+	// cleanup after the last search
+	for (const unsigned int sqrIdx: rs.dirtyBlocks) {
+		rs.blockStates.ClearSquare(sqrIdx);
+	}
+
+	rs.dirtyBlocks.clear();
+	rs.openBlocks.Clear();
+	rs.openBlockBuffer.SetSize(0);
+
+	const int2 goalSquare = {int(pfDef.goalSquareX), int(pfDef.goalSquareZ)};
+
+	if (static_cast<unsigned int>(goalSquare.x) >= nbrOfBlocks.x || static_cast<unsigned int>(goalSquare.y) >= nbrOfBlocks.y)
+		return false;
+
+	const unsigned int goalSquareIdx = BlockPosToIdx(goalSquare);
+
+	if (goalSquareIdx == mStartBlockIdx)
+		return false;
+	if ((blockCheckFunc(moveDef, goalSquare.x, goalSquare.y, owner) & MMBT::BLOCK_STRUCTURE) != 0)
+		return false;
+	if (CMoveMath::GetPosSpeedMod(moveDef, goalSquare.x, goalSquare.y) == 0.0f)
+		return false;
+	if (!pfDef.WithinConstraints(goalSquare.x, goalSquare.y))
+		return false;
+
+	rs.blockStates.nodeMask[goalSquareIdx] |= PATHOPT_OPEN;
+	rs.blockStates.fCost[goalSquareIdx] = 0.0f;
+	rs.blockStates.gCost[goalSquareIdx] = 0.0f;
+	rs.dirtyBlocks.push_back(goalSquareIdx);
+
+	PathNode* ob = rs.openBlockBuffer.GetNode(rs.openBlockBuffer.GetSize());
+		ob->fCost   = 0.0f;
+		ob->gCost   = 0.0f;
+		ob->nodePos = goalSquare;
+		ob->nodeNum = goalSquareIdx;
+	rs.openBlocks.push(ob);
+	return true;
+}
+
+void CPathFinder::TestReverseSquares(
+	const MoveDef& moveDef,
+	const CPathFinderDef& pfDef,
+	const PathNode* square,
+	const CSolidObject* owner
+) {
+	ReverseSearchState& rs = *reverseSearch;
+
+	// <square> is the destination of every edge relaxed here, so its
+	// state (and the direction of each edge) determines their costs
+	const int2 squarePos = square->nodePos;
+	const CMoveMath::BlockType blockMask = blockCheckFunc(moveDef, squarePos.x, squarePos.y, owner);
+
+	const float heatCost  = (pfDef.testMobile) ? gPathHeatMap.GetHeatCost(squarePos.x, squarePos.y, moveDef, ((owner != nullptr)? owner->id: -1U)) : 0.0f;
+	const float extraCost = blockStates.GetNodeExtraCost(squarePos.x, squarePos.y, pfDef.synced);
+	const float mobileMult = (pfDef.testMobile && moveDef.avoidMobilesOnPath)? GetMobileSpeedModMult(moveDef, blockMask): 1.0f;
+
+	// passability of the predecessors along each cardinal, needed for the
+	// diagonal side-square tests (which mirror those of TestNeighborSquares)
+	bool passableCardinals[PATH_DIRECTIONS] = {false};
+
+	for (unsigned int dir: PATHDIR_CARDINALS) {
+		const int2 prdSquarePos = squarePos - PF_DIRECTION_VECTORS_2D[PathDir2PathOpt(dir)];
+
+		if (static_cast<unsigned int>(prdSquarePos.x) >= nbrOfBlocks.x || static_cast<unsigned int>(prdSquarePos.y) >= nbrOfBlocks.y)
+			continue;
+		if ((blockCheckFunc(moveDef, prdSquarePos.x, prdSquarePos.y, owner) & MMBT::BLOCK_STRUCTURE) != 0)
+			continue;
+
+		passableCardinals[dir] = (CMoveMath::GetPosSpeedMod(moveDef, prdSquarePos.x, prdSquarePos.y) != 0.0f);
+	}
+
+	for (unsigned int dir = 0; dir < PATH_DIRECTIONS; dir++) {
+		// forward direction of the edge from the predecessor to <square>
+		const unsigned int optDir = PathDir2PathOpt(dir);
+		const unsigned int optX = optDir & (PATHOPT_LEFT | PATHOPT_RIGHT);
+		const unsigned int optZ = optDir & (PATHOPT_UP | PATHOPT_DOWN);
+
+		const int2 prdSquarePos = squarePos - PF_DIRECTION_VECTORS_2D[optDir];
+
+		if (static_cast<unsigned int>(prdSquarePos.x) >= nbrOfBlocks.x || static_cast<unsigned int>(prdSquarePos.y) >= nbrOfBlocks.y)
+			continue;
+
+		const unsigned int prdSquareIdx = BlockPosToIdx(prdSquarePos);
+
+		if ((rs.blockStates.nodeMask[prdSquareIdx] & PATHOPT_CLOSED) != 0)
+			continue;
+
+		if (optX != 0 && optZ != 0) {
+			// side-squares of a diagonal edge are the cardinal predecessors
+			if (!passableCardinals[PathOpt2PathDir(optX)] || !passableCardinals[PathOpt2PathDir(optZ)])
+				continue;
+		}
+
+		// the start-square is allowed to be blocked, as in the forward search
+		if (prdSquareIdx != mStartBlockIdx) {
+			if ((blockCheckFunc(moveDef, prdSquarePos.x, prdSquarePos.y, owner) & MMBT::BLOCK_STRUCTURE) != 0 || CMoveMath::GetPosSpeedMod(moveDef, prdSquarePos.x, prdSquarePos.y) == 0.0f) {
+				rs.blockStates.nodeMask[prdSquareIdx] |= PATHOPT_CLOSED;
+				rs.dirtyBlocks.push_back(prdSquareIdx);
+				continue;
+			}
+		}
+
+		const float speedMod = CMoveMath::GetPosSpeedMod(moveDef, squarePos.x, squarePos.y, PF_DIRECTION_VECTORS_3D[optDir]) * mobileMult;
+
+		if (speedMod == 0.0f)
+			continue;
+
+		const float dirMoveCost = (1.0f + heatCost) * PF_DIRECTION_COSTS[optDir];
+		const float nodeCost = (dirMoveCost / speedMod) + extraCost;
+
+		const float gCost = square->gCost + nodeCost;
+		const float hCost = pfDef.Heuristic(prdSquarePos.x, prdSquarePos.y, mStartBlock.x, mStartBlock.y, BLOCK_SIZE);
+		const float fCost = gCost + hCost;
+
+		if (rs.blockStates.fCost[prdSquareIdx] <= fCost)
+			continue;
+
+		rs.openBlockBuffer.SetSize(rs.openBlockBuffer.GetSize() + 1);
+		assert(rs.openBlockBuffer.GetSize() < MAX_SEARCHED_NODES_PF);
+
+		PathNode* os = rs.openBlockBuffer.GetNode(rs.openBlockBuffer.GetSize());
+			os->fCost   = fCost;
+			os->gCost   = gCost;
+			os->nodePos = prdSquarePos;
+			os->nodeNum = prdSquareIdx;
+		rs.openBlocks.push(os);
+
+		// the stored direction leads from the predecessor towards the goal
+		rs.blockStates.fCost[prdSquareIdx] = fCost;
+		rs.blockStates.gCost[prdSquareIdx] = gCost;
+		rs.blockStates.nodeMask[prdSquareIdx] &= ~PATHOPT_CARDINALS;
+		rs.blockStates.nodeMask[prdSquareIdx] |= (PATHOPT_OPEN | optDir);
+		rs.dirtyBlocks.push_back(prdSquareIdx);
+	}
+
+	rs.blockStates.nodeMask[square->nodeNum] |= PATHOPT_CLOSED;
+	rs.dirtyBlocks.push_back(square->nodeNum);
+}
+
+void CPathFinder::FinishBidirSearch(const CPathFinderDef& pfDef, unsigned int meetSquareIdx)
+{
+	ReverseSearchState& rs = *reverseSearch;
+
+	// collect the reverse path from the meeting square to the goal-square,
+	// which is the only one without a direction (it started the search)
+	rs.pathSquares.clear();
+
+	for (unsigned int sqrIdx = meetSquareIdx; true; ) {
+		const unsigned int pathOptDir = rs.blockStates.nodeMask[sqrIdx] & PATHOPT_CARDINALS;
+
+		rs.pathSquares.push_back(sqrIdx);
+
+		if (pathOptDir == 0)
+			break;
+
+		sqrIdx = BlockPosToIdx(BlockIdxToPos(sqrIdx) + PF_DIRECTION_VECTORS_2D[pathOptDir]);
+	}
+
+	// graft onto the last square of that path the forward search has labelled,
+	// the forward path to it can then not contain any of the following ones
+	unsigned int graftIdx = 0;
+
+	for (unsigned int i = 1; i < rs.pathSquares.size(); i++) {
+		if (blockStates.gCost[rs.pathSquares[i]] != PATHCOST_INFINITY)
+			graftIdx = i;
+	}
+
+	const float pathCost = blockStates.gCost[rs.pathSquares[graftIdx]] + rs.blockStates.gCost[rs.pathSquares[graftIdx]];
+
+	for (unsigned int i = graftIdx + 1; i < rs.pathSquares.size(); i++) {
+		const unsigned int sqrIdx = rs.pathSquares[i];
+		const int2 sqrPos = BlockIdxToPos(sqrIdx);
+
+		// reverse direction out of the previous square is the forward one into this
+		blockStates.gCost[sqrIdx] = pathCost - rs.blockStates.gCost[sqrIdx];
+		blockStates.fCost[sqrIdx] = blockStates.gCost[sqrIdx] + pfDef.Heuristic(sqrPos.x, sqrPos.y, BLOCK_SIZE);
+		blockStates.nodeMask[sqrIdx] &= ~PATHOPT_CARDINALS;
+		blockStates.nodeMask[sqrIdx] |= (rs.blockStates.nodeMask[rs.pathSquares[i - 1]] & PATHOPT_CARDINALS);
+
+		dirtyBlocks.push_back(sqrIdx);
+	}
+
+	mGoalBlockIdx = rs.pathSquares.back();
+	mGoalHeuristic = 0.0f;
+}
+
+
 void CPathFinder::FinishSearch(const MoveDef& moveDef, const CPathFinderDef& pfDef, IPath::Path& foundPath) const
 {
 	if (pfDef.needPath) {
@@ -22,9 +22,16 @@ void PathHeatMap::Init(unsigned int scalex, unsigned int scalez) {
 	xsize  = mapDims.hmapx / xscale;
 	zsize  = mapDims.hmapy / zscale;
 
+	xtiles = (xsize + TILE_SIZE - 1) >> TILE_SIZE_BITS;
+
+	const unsigned int ztiles = (zsize + TILE_SIZE - 1) >> TILE_SIZE_BITS;
+
 	heatMapOffset = 0;
 
-	heatMap.resize(xsize * zsize);
+	heatMap.clear();
+	heatMap.resize(xtiles * ztiles * TILE_CELLS);
+	tileStamps.clear();
+	tileStamps.resize(xtiles * ztiles, 0);
 }
 
 unsigned int PathHeatMap::GetHeatMapIndex(unsigned int hmx, unsigned int hmz) const {
@@ -34,7 +41,13 @@ unsigned int PathHeatMap::GetHeatMapIndex(unsigned int hmx, unsigned int hmz) co
 	hmx >>= xscale;
 	hmz >>= zscale;
 
-	return (hmz * xsize + hmx);
+	const unsigned int tileIdx = (hmz >> TILE_SIZE_BITS) * xtiles + (hmx >> TILE_SIZE_BITS);
+
+	// interleave the three low bits of each coordinate
+	const auto spread = [](unsigned int v) { return ((v & 1) | ((v & 2) << 1) | ((v & 4) << 2)); };
+	const unsigned int cellIdx = spread(hmx & (TILE_SIZE - 1)) | (spread(hmz & (TILE_SIZE - 1)) << 1);
+
+	return ((tileIdx << TILE_CELLS_BITS) | cellIdx);
 }
 
 void PathHeatMap::AddHeat(const CSolidObject* owner, const CPathManager* pm, unsigned int pathID) {
@@ -79,11 +92,29 @@ void PathHeatMap::AddHeat(const CSolidObject* owner, const CPathManager* pm, uns
 	}
 }
 
+void PathHeatMap::RebaseTile(unsigned int tileIdx) {
+	const unsigned int age = heatMapOffset - tileStamps[tileIdx];
+
+	if (age == 0)
+		return;
+
+	tileStamps[tileIdx] = heatMapOffset;
+
+	for (unsigned int i = tileIdx << TILE_CELLS_BITS, n = i + TILE_CELLS; i < n; i++) {
+		const unsigned int val = heatMap[i].value;
+		heatMap[i].value = (val - age) * (age < val);
+	}
+}
+
 void PathHeatMap::UpdateHeatValue(unsigned int x, unsigned int y, unsigned int value, unsigned int ownerID) {
 	const unsigned int idx = GetHeatMapIndex(x, y);
 
-	if (heatMap[idx].value < (value + heatMapOffset)) {
-		heatMap[idx].value = value + heatMapOffset;
+	value = std::min(value, 0xFFFFu);
+
+	if (GetCellHeat(idx) < value) {
+		RebaseTile(idx >> TILE_CELLS_BITS);
+
+		heatMap[idx].value = value;
 		heatMap[idx].ownerID = ownerID;
 	}
 }
@@ -95,7 +126,7 @@ float PathHeatMap::GetHeatCost(unsigned int x, unsigned int z, const MoveDef& md
 		return c;
 
 	const unsigned int idx = GetHeatMapIndex(x, z);
-	const unsigned int val = (heatMapOffset >= heatMap[idx].value)? 0: (heatMap[idx].value - heatMapOffset);
+	const unsigned int val = GetCellHeat(idx);
 
 	if (heatMap[idx].ownerID != ownerID)
 		c = (md.heatMod * val);
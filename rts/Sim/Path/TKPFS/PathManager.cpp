@@ -174,6 +174,21 @@ std::uint32_t CPathManager::GetPathCheckSum() const {
 	//return (medResPE->GetPathChecksum() + lowResPE->GetPathChecksum());
 }
 
+std::uint64_t CPathManager::GetMemFootPrint() const {
+	if (!IsFinalized())
+		return 0;
+
+	std::uint64_t memFootPrint = pathingStates[PATH_MED_RES].GetMemFootPrint() + pathingStates[PATH_LOW_RES].GetMemFootPrint();
+
+	for (int i = 0; i < pathFinderGroups; ++i) {
+		memFootPrint += maxResPFs[i].GetMemFootPrint();
+		memFootPrint += medResPEs[i].GetMemFootPrint();
+		memFootPrint += lowResPEs[i].GetMemFootPrint();
+	}
+
+	return memFootPrint;
+}
+
 std::int64_t CPathManager::Finalize()
 {
 	const spring_time t0 = spring_gettime();
@@ -323,7 +338,25 @@ IPath::SearchResult CPathManager::ArrangePath(
 				pfDef->DisableConstraint(!useConstraints[n]);
 				pfDef->AllowRawPathSearch(allowRawSearch[n]);
 
-				const IPath::SearchResult currResult = ownPathFinders[n]->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[n], nodeLimits[n]);
+				IPath::SearchResult currResult = IPath::Error;
+
+				if (n == PATH_LOW_RES) {
+					// long paths are refined from the cluster level first,
+					// the low-res search only expands blocks in its corridor
+					CPathEstimator* lowResPE = static_cast<CPathEstimator*>(ownPathFinders[PATH_LOW_RES]);
+
+					const int2 srcBlockPos = {int(startPos.x / (SQUARE_SIZE * LOWRES_PE_BLOCKSIZE)), int(startPos.z / (SQUARE_SIZE * LOWRES_PE_BLOCKSIZE))};
+					const int2 tgtBlockPos = {int(pfDef->goalSquareX / LOWRES_PE_BLOCKSIZE), int(pfDef->goalSquareZ / LOWRES_PE_BLOCKSIZE)};
+
+					if (lowResPE->ArrangeClusterCorridor(*moveDef, srcBlockPos, tgtBlockPos)) {
+						currResult = lowResPE->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[n], nodeLimits[n]);
+						lowResPE->ClearClusterCorridor();
+					}
+				}
+
+				// corridor is only a hint, anything short of Ok is retried without
+				if (currResult != IPath::Ok)
+					currResult = ownPathFinders[n]->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[n], nodeLimits[n]);
 
 				// if (debugLoggingActive == currentThread){
 				// 	LOG("PATH level %d Search Result is: %d",  n, currResult);
@@ -397,6 +430,8 @@ unsigned int CPathManager::RequestPath(
 	if (!IsFinalized())
 		return 0;
 
+	TraceRequest(caller, moveDef, startPos, goalPos, goalRadius);
+
 	// in misc since it is called from many points
 	//SCOPED_TIMER("Misc::Path::RequestPath");
 	//SCOPED_MT_TIMER("Misc::Path::RequestPath");
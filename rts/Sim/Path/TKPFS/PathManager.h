@@ -105,6 +105,7 @@ public:
 
 	std::int32_t GetPathFinderType() const override { return HAPFS_TYPE; }
 	std::uint32_t GetPathCheckSum() const override;
+	std::uint64_t GetMemFootPrint() const override;
 
 	std::int64_t Finalize() override;
 	std::int64_t PostFinalizeRefresh() override;
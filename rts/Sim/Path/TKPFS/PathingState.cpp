@@ -2,8 +2,7 @@
 
 #include "PathingState.h"
 
-#include "zlib.h"
-#include "minizip/zip.h"
+#include <algorithm>
 
 #include "Game/GlobalUnsynced.h"
 #include "Game/LoadScreen.h"
@@ -14,6 +13,7 @@
 #include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "PathFinder.h"
 #include "Sim/Path/Default/IPath.h"
+#include "Sim/Path/Default/PathCostsFile.h"
 #include "PathConstants.h"
 #include "Sim/Path/Default/PathFinderDef.h"
 #include "Sim/Path/Default/PathLog.h"
@@ -21,13 +21,12 @@
 #include "PathMemPool.h"
 
 #include "System/Config/ConfigHandler.h"
-#include "System/FileSystem/Archives/IArchive.h"
-#include "System/FileSystem/ArchiveLoader.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/Platform/Threading.h"
 #include "System/StringUtil.h"
+#include "System/Sync/SHA512.hpp"
 #include "System/Threading/ThreadPool.h" // for_mt
 
 #define ENABLE_NETLOG_CHECKSUM 1
@@ -49,7 +48,7 @@ static const std::string GetPathCacheDir() {
 }
 
 static const std::string GetCacheFileName(const std::string& fileHashCode, const std::string& peFileName, const std::string& mapFileName) {
-	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + ".zip");
+	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + ".bin");
 }
 
 void PathingState::KillStatic() { pathingStates = 0; }
@@ -161,6 +160,12 @@ void PathingState::Init(std::vector<IPathFinder*> pathFinderlist, PathingState*
 
 	// load precalculated data if it exists
 	InitEstimator(peFileName, mapFileName);
+
+	// coarsest level gets the cluster graph on top, derived from its costs
+	if (BLOCK_SIZE == LOWRES_PE_BLOCKSIZE) {
+		clusterGraph.Init(nbrOfBlocks, CLUSTER_PE_BLOCKSIZE, moveDefHandler.GetNumMoveDefs());
+		clusterGraph.Rebuild(vertexCosts);
+	}
 }
 
 void PathingState::Terminate()
@@ -171,6 +176,8 @@ void PathingState::Terminate()
 	if (pathCache[1] != nullptr)
 		pcMemPool.free(pathCache[1]);
 
+	clusterGraph.Kill();
+
 	//LOG("Pathing unporcessed updatedBlocks is %llu", updatedBlocks.size());
 
 	// Clear out lingering unprocessed map changes
@@ -513,57 +520,24 @@ bool PathingState::ReadFile(const std::string& peFileName, const std::string& ma
 	if (!FileSystem::FileExists(cacheFileName))
 		return false;
 
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
-
-	if (upfile == nullptr || !upfile->IsOpen()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
-
 	char calcMsg[512];
 	sprintf(calcMsg, "Reading Estimate PathCosts [%d]", BLOCK_SIZE);
 	loadscreen->SetLoadMessage(calcMsg);
 
-	const unsigned fid = upfile->FindFile("pathinfo");
-	if (fid >= upfile->NumFiles()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
-
-	std::vector<std::uint8_t> buffer;
+	std::vector<unsigned int> invalidBlocks;
 
-	if (!upfile->GetFile(fid, buffer) || buffer.size() < 4) {
+	if (!PathCostsFile::Read(dataDirsAccess.LocateFile(cacheFileName), fileHashCode, BLOCK_SIZE, blockStates.peNodeOffsets, vertexCosts, invalidBlocks)) {
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
-	const unsigned int filehash = *(reinterpret_cast<unsigned int*>(&buffer[0]));
-	const unsigned int blockSize = blockStates.GetSize() * sizeof(short2);
-	unsigned int pos = sizeof(unsigned);
+	if (!invalidBlocks.empty()) {
+		LOG_L(L_WARNING, "[PathEstimator::%s] recalculating %u damaged blocks", __func__, unsigned(invalidBlocks.size()));
 
-	if (filehash != fileHashCode) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
-
-	if (buffer.size() < (pos + blockSize * moveDefHandler.GetNumMoveDefs())) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
-
-	// read center-offset data
-	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		std::memcpy(&blockStates.peNodeOffsets[pathType][0], &buffer[pos], blockSize);
-		pos += blockSize;
-	}
-
-	// read vertex-cost data
-	if (buffer.size() < (pos + vertexCosts.size() * sizeof(float))) {
-		FileSystem::Remove(cacheFileName);
-		return false;
+		RecalcBlocks(invalidBlocks);
+		WriteFile(peFileName, mapFileName);
 	}
 
-	std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
 	return true;
 }
 
@@ -582,39 +556,45 @@ bool PathingState::WriteFile(const std::string& peFileName, const std::string& m
 
 	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
-	// open file for writing in a suitable location
-	zipFile file = zipOpen(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE).c_str(), APPEND_STATUS_CREATE);
-
-	if (file == nullptr)
-		return false;
+	return (PathCostsFile::Write(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE), fileHashCode, BLOCK_SIZE, blockStates.peNodeOffsets, vertexCosts));
+}
 
-	zipOpenNewFileInZip(file, "pathinfo", nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_BEST_COMPRESSION);
 
-	// write hash-code (NOTE: this also affects the CRC!)
-	zipWriteInFileInZip(file, (const void*) &fileHashCode, 4);
+/**
+ * Recalculate offsets and vertex costs of blocks that failed to load
+ */
+void PathingState::RecalcBlocks(const std::vector<unsigned int>& blockIndices)
+{
+	// vertex costs depend on the offsets of both blocks they connect, so
+	// first redo all offsets and then the costs of each block's neighbours
+	std::vector<unsigned int> costBlockIndices;
 
-	// write center-offsets
-	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		zipWriteInFileInZip(file, (const void*) &blockStates.peNodeOffsets[pathType][0], blockStates.peNodeOffsets[pathType].size() * sizeof(short2));
-	}
+	for (const unsigned int blockIdx: blockIndices) {
+		const int2 blockPos = BlockIdxToPos(blockIdx);
 
-	// write vertex-costs
-	zipWriteInFileInZip(file, vertexCosts.data(), vertexCosts.size() * sizeof(float));
+		for (unsigned int i = 0; i < moveDefHandler.GetNumMoveDefs(); i++) {
+			const MoveDef* md = moveDefHandler.GetMoveDefByPathType(i);
 
-	zipCloseFileInZip(file);
-	zipClose(file, nullptr);
+			blockStates.peNodeOffsets[md->pathType][blockIdx] = FindBlockPosOffset(*md, blockPos.x, blockPos.y);
+		}
 
+		for (int z = std::max(blockPos.y - 1, 0); z <= std::min(blockPos.y + 1, int(mapDimensionsInBlocks.y) - 1); z++) {
+			for (int x = std::max(blockPos.x - 1, 0); x <= std::min(blockPos.x + 1, int(mapDimensionsInBlocks.x) - 1); x++) {
+				costBlockIndices.push_back(BlockPosToIdx(int2(x, z)));
+			}
+		}
+	}
 
-	// get the CRC over the written path data
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
+	std::sort(costBlockIndices.begin(), costBlockIndices.end());
+	costBlockIndices.erase(std::unique(costBlockIndices.begin(), costBlockIndices.end()), costBlockIndices.end());
 
-	if (upfile == nullptr || !upfile->IsOpen()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
+	TKPFS::PathingSystemActive = true;
+	for (const unsigned int blockIdx: costBlockIndices) {
+		for (unsigned int i = 0; i < moveDefHandler.GetNumMoveDefs(); i++) {
+			CalcVertexPathCosts(*moveDefHandler.GetMoveDefByPathType(i), BlockIdxToPos(blockIdx));
+		}
 	}
-
-	assert(upfile->FindFile("pathinfo") < upfile->NumFiles());
-	return true;
+	TKPFS::PathingSystemActive = false;
 }
 
 
@@ -755,6 +735,16 @@ void PathingState::UpdateVertexPathCosts(int blocksToUpdate)
 		});
 		TKPFS::PathingSystemActive = false;
 	}
+
+	if (clusterGraph.IsInitialized()) {
+		SCOPED_TIMER("Sim::Path::Estimator::RepairClusters");
+
+		for (const SingleBlock& sb: consumedBlocks) {
+			clusterGraph.MarkDirtyBlock(sb.blockPos);
+		}
+
+		clusterGraph.Repair(vertexCosts);
+	}
 }
 
 
@@ -861,21 +851,13 @@ std::uint32_t PathingState::CalcChecksum() const
 	return chksum;
 }
 
-// CPathCache::CacheItem PathingState::GetCache(const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced) const
-// {
-// 	const std::lock_guard<std::mutex> lock(cacheAccessLock);
-// 	return pathCache[synced]->GetCachedPath(strtBlock, goalBlock, goalRadius, pathType);
-// }
-
 void PathingState::AddCache(const IPath::Path* path, const IPath::SearchResult result, const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced)
 {
-	const std::lock_guard<std::mutex> lock(cacheAccessLock);
 	pathCache[synced]->AddPath(path, result, strtBlock, goalBlock, goalRadius, pathType);
 }
 
 void PathingState::AddPathForCurrentFrame(const IPath::Path* path, const IPath::SearchResult result, const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced)
 {
-	const std::lock_guard<std::mutex> lock(cacheAccessLock);
 	//pathCache[synced]->AddPathForCurrentFrame(path, result, strtBlock, goalBlock, goalRadius, pathType);
 }
 
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+#include "ClusterGraph.h"
 #include "IPathFinder.h"
 #include "Sim/Path/Default/PathDataTypes.h"
 #include "System/Threading/SpringThreading.h"
@@ -41,6 +42,7 @@ public:
     float GetVertexCost(size_t index) const { return vertexCosts[index]; };
 
 	const std::vector<float>& GetVertexCosts() const { return vertexCosts; }
+	size_t GetMemFootPrint() const { return (blockStates.GetMemFootPrint() + (vertexCosts.size() + maxSpeedMods.size()) * sizeof(float)); }
 	const std::deque<int2>& GetUpdatedBlocks() const { return updatedBlocks; }
 
 	struct SOffsetBlock {
@@ -77,20 +79,18 @@ public:
 	 */
 	std::uint32_t GetPathChecksum() const { return pathChecksum; }
 
-    // Re-entrant - return value cannot be a ref to avoid race conditions
-	//const
-	CPathCache::CacheItem GetCache(
+	// Re-entrant; the cache is read-only while MT requests run, see CPathCache
+	const CPathCache::CacheItem& GetCache(
 		const int2 strtBlock,
 		const int2 goalBlock,
 		float goalRadius,
 		int pathType,
 		const bool synced
 	) const {
-		const std::lock_guard<std::mutex> lock(cacheAccessLock);
 		return pathCache[synced]->GetCachedPath(strtBlock, goalBlock, goalRadius, pathType);
 	}
 
-    // Re-entrant, but not MT sync-safe
+	// main thread only, never called during the MT request phase
 	void AddCache(
 		const IPath::Path* path,
 		const IPath::SearchResult result,
@@ -123,6 +123,9 @@ public:
 
 	PathNodeStateBuffer& GetNodeStateBuffer() { return blockStates; }
 
+	// only initialized for the low-res level
+	const ClusterGraph& GetClusterGraph() const { return clusterGraph; }
+
 private:
 	friend class TKPFS::CPathManager;
 	friend struct ::TKPFSPathDrawer;
@@ -140,6 +143,7 @@ private:
 
 	bool ReadFile(const std::string& peFileName, const std::string& mapFileName);
 	bool WriteFile(const std::string& peFileName, const std::string& mapFileName);
+	void RecalcBlocks(const std::vector<unsigned int>& blockIndices);
 
 private:
 	friend class TKPFS::CPathEstimator;
@@ -151,8 +155,6 @@ private:
     std::uint32_t pathChecksum = 0;
     std::uint32_t fileHashCode = 0;
 
-    mutable std::mutex cacheAccessLock;
-
     int blockUpdatePenalty = 0;
 	unsigned int instanceIndex = 0;
 
@@ -180,6 +182,7 @@ private:
     std::deque<int2> updatedBlocks;
 
     PathNodeStateBuffer blockStates;
+    ClusterGraph clusterGraph;
 
 	struct SingleBlock {
 		int2 blockPos;
@@ -4,6 +4,7 @@
 #include <stdexcept>
 #include <cassert>
 #include <cinttypes>
+#include <cstring>
 
 #include "ExplosionGenerator.h"
 #include "ExpGenSpawner.h" //!!
@@ -358,6 +359,11 @@ bool CExplosionGeneratorHandler::GenExplosion(
 	if (expGen == nullptr)
 		return false;
 
+	// every spawnable is unsynced and only drawn, so there is nothing to do
+	// when they would not be; callers still see a successful explosion
+	if (!projectileHandler.SpawnVisualParticles())
+		return true;
+
 	return (expGen->Explosion(pos, dir, damage, radius, gfxMod, owner, hit, withMutex));
 }
 
@@ -849,6 +855,124 @@ void CCustomExplosionGenerator::ParseExplosionCode(
 
 
 
+void CCustomExplosionGenerator::HoistConstantMembers(
+	CCustomExplosionGenerator::ProjectileSpawnInfo* psi,
+	std::string& code
+) {
+	// the code is a sequence of segments that each end in a store,
+	// starting with val=0 and only sharing the OP_YANK buffer; those
+	// made of OP_ADD's alone (or a OP_LOADP) always store the same value
+	struct CodeSegment {
+		size_t beg;
+		size_t end;
+
+		ConstantMemberInfo member;
+
+		bool constant;
+	};
+
+	std::vector<CodeSegment> segments;
+	CodeSegment segment = {0, 0, {}, true};
+
+	float val = 0.0f;
+	void* ptr = nullptr;
+
+	for (size_t i = 0; i < code.size() && code[i] != OP_END; ) {
+		switch (code[i++]) {
+			case OP_STOREI:
+			case OP_STOREF: {
+				const bool isFloat = (code[i - 1] == OP_STOREF);
+
+				segment.member.size = code[i];
+				std::memcpy(&segment.member.offset, &code[i + 1], sizeof(std::uint16_t));
+				i += 3;
+
+				// same conversions as ExecuteExplosionCode
+				std::uint8_t* data = &segment.member.data[0];
+
+				switch (segment.member.size | (isFloat << 4)) {
+					case 1: { const std::int8_t  v = (int) val; std::memcpy(data, &v, sizeof(v)); } break;
+					case 2: { const std::int16_t v = (int) val; std::memcpy(data, &v, sizeof(v)); } break;
+					case 4: { const std::int32_t v = (int) val; std::memcpy(data, &v, sizeof(v)); } break;
+					case 8: { const std::int64_t v = (int) val; std::memcpy(data, &v, sizeof(v)); } break;
+					case (4 | (1 << 4)): { const float  v = val; std::memcpy(data, &v, sizeof(v)); } break;
+					case (8 | (1 << 4)): { const double v = val; std::memcpy(data, &v, sizeof(v)); } break;
+					default: { segment.constant = false; } break;
+				}
+			} break;
+			case OP_STOREP: {
+				segment.member.size = sizeof(void*);
+				std::memcpy(&segment.member.offset, &code[i], sizeof(std::uint16_t));
+				std::memcpy(&segment.member.data[0], &ptr, sizeof(void*));
+				i += 2;
+			} break;
+			case OP_DIR: {
+				segment.member.size = sizeof(float3);
+				segment.constant = false;
+				std::memcpy(&segment.member.offset, &code[i], sizeof(std::uint16_t));
+				i += 2;
+			} break;
+
+			case OP_ADD: {
+				float v = 0.0f;
+				std::memcpy(&v, &code[i], sizeof(v));
+				val += v;
+				i += 4;
+			} continue;
+			case OP_LOADP: {
+				std::memcpy(&ptr, &code[i], sizeof(void*));
+				i += sizeof(void*);
+			} continue;
+
+			default: {
+				// all other operators take a 4-byte operand
+				segment.constant = false;
+				i += 4;
+			} continue;
+		}
+
+		segment.end = i;
+		segments.push_back(segment);
+
+		segment = {i, i, {}, true};
+		val = 0.0f;
+		ptr = nullptr;
+	}
+
+	// trailing operators without a store, keep them as they are
+	if (segment.beg < code.size() && code[segment.beg] != OP_END) {
+		segment.end = code.size() - 1;
+		segment.constant = false;
+		segments.push_back(segment);
+	}
+
+	// stores to the same member must keep their order, so only hoist unique ones
+	const auto overlaps = [](const ConstantMemberInfo& a, const ConstantMemberInfo& b) {
+		return (a.offset < (b.offset + b.size) && b.offset < (a.offset + a.size));
+	};
+
+	std::string varCode;
+
+	for (size_t n = 0; n < segments.size(); n++) {
+		CodeSegment& s = segments[n];
+
+		for (size_t m = 0; m < segments.size() && s.constant; m++) {
+			s.constant &= (m == n || !overlaps(s.member, segments[m].member));
+		}
+
+		if (s.constant) {
+			psi->constMembers.push_back(s.member);
+		} else {
+			varCode.append(code, s.beg, s.end - s.beg);
+		}
+	}
+
+	code = std::move(varCode);
+	code += (char)OP_END;
+}
+
+
+
 bool CCustomExplosionGenerator::Load(CExplosionGeneratorHandler* handler, const char* tag)
 {
 	const LuaTable* root = handler->GetExplosionTableRoot();
@@ -906,6 +1030,7 @@ bool CCustomExplosionGenerator::Load(CExplosionGeneratorHandler* handler, const
 		}
 
 		code += (char)OP_END;
+		HoistConstantMembers(&psi, code);
 		psi.code.resize(code.size());
 		copy(code.begin(), code.end(), psi.code.begin());
 
@@ -981,9 +1106,19 @@ bool CCustomExplosionGenerator::Explosion(
 		if (projectileHandler.GetParticleSaturation() > 1.0f)
 			break;
 
+		const bool hasVarCode = (psi.code[0] != OP_END);
+
 		for (unsigned int c = 0; c < psi.count; c++) {
 			CExpGenSpawnable* projectile = CExpGenSpawnable::CreateSpawnable(psi.spawnableID);
-			ExecuteExplosionCode(&psi.code[0], damage, (char*) projectile, c, dir);
+			char* instance = (char*) projectile;
+
+			for (const ConstantMemberInfo& cmi: psi.constMembers) {
+				std::memcpy(instance + cmi.offset, &cmi.data[0], cmi.size);
+			}
+
+			if (hasVarCode)
+				ExecuteExplosionCode(&psi.code[0], damage, instance, c, dir);
+
 			projectile->Init(owner, pos);
 		}
 	}
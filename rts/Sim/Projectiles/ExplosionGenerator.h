@@ -3,6 +3,7 @@
 #ifndef EXPLOSION_GENERATOR_H
 #define EXPLOSION_GENERATOR_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -143,6 +144,13 @@ public:
 class CCustomExplosionGenerator: public IExplosionGenerator
 {
 protected:
+	/// member whose value does not depend on the explosion, stored as-is
+	struct ConstantMemberInfo {
+		std::uint16_t offset = 0;
+		std::uint8_t size = 0;
+		std::uint8_t data[8] = {0};
+	};
+
 	struct ProjectileSpawnInfo {
 		unsigned int spawnableID = 0;
 
@@ -150,7 +158,9 @@ protected:
 		unsigned int count = 0;
 		unsigned int flags = 0;
 
-		/// parsed explosion script code
+		/// members evaluated at load-time, copied into every projectile
+		std::vector<ConstantMemberInfo> constMembers;
+		/// parsed explosion script code (minus the constant members)
 		std::vector<char> code;
 	};
 
@@ -218,6 +228,7 @@ public:
 
 private:
 	void ParseExplosionCode(ProjectileSpawnInfo* psi, const std::string& script, SExpGenSpawnableMemberInfo& memberInfo, std::string& code);
+	void HoistConstantMembers(ProjectileSpawnInfo* psi, std::string& code);
 	void ExecuteExplosionCode(const char* code, float damage, char* instance, int spawnIndex, const float3& dir);
 
 protected:
@@ -1,6 +1,8 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <algorithm>
+#include <array>
+#include <typeinfo>
 
 #include "Projectile.h"
 #include "ProjectileHandler.h"
@@ -162,6 +164,25 @@ void CProjectileHandler::Kill()
 	CCollisionHandler::PrintStats();
 }
 
+size_t CProjectileHandler::GetMemFootPrint() const
+{
+	// pool pages that were ever handed out, freed ones are kept for reuse
+	size_t memFootPrint = projMemPool.alloc_size();
+
+	for (bool synced: {false, true}) {
+		memFootPrint += (projectileContainers[synced].capacity() * sizeof(CProjectile*));
+		memFootPrint += (projectileMaps[synced].capacity() * sizeof(CProjectile*));
+		memFootPrint += (freeProjectileIDs[synced].capacity() * sizeof(int));
+	}
+
+	for (const FlyingPieceContainer& fpc: flyingPieces) {
+		memFootPrint += (fpc.capacity() * sizeof(FlyingPiece));
+	}
+
+	memFootPrint += (groundFlashes.capacity() * sizeof(CGroundFlash*));
+	return memFootPrint;
+}
+
 
 void CProjectileHandler::ConfigNotify(const std::string& key, const std::string& value)
 {
@@ -182,6 +203,37 @@ static void MAPPOS_SANITY_CHECK(const float3 v)
 }
 
 
+// frames between regrouping the containers by projectile type
+static constexpr int PROJECTILE_SORT_RATE = 16;
+
+static void SortProjectiles(ProjectileContainer& pc, std::true_type)
+{
+	// the Update order of synced projectiles is synced, so only sort by
+	// synced keys; weapon projectiles are the only costly synced ones and
+	// their type maps to their class (IDs are unique among synced ones)
+	std::sort(pc.begin(), pc.end(), [](const CProjectile* a, const CProjectile* b) {
+		if (a->GetProjectileType() != b->GetProjectileType())
+			return (a->GetProjectileType() < b->GetProjectileType());
+
+		return (a->id < b->id);
+	});
+}
+
+static void SortProjectiles(ProjectileContainer& pc, std::false_type)
+{
+	// unsynced ones are updated in parallel and in no particular order, so
+	// group them by class and within that by (pool) address
+	std::sort(pc.begin(), pc.end(), [](const CProjectile* a, const CProjectile* b) {
+		const std::type_info* ta = &typeid(*a);
+		const std::type_info* tb = &typeid(*b);
+
+		if (ta != tb)
+			return (ta < tb);
+
+		return (a < b);
+	});
+}
+
 template<bool synced>
 void CProjectileHandler::UpdateProjectilesImpl()
 {
@@ -217,6 +269,14 @@ void CProjectileHandler::UpdateProjectilesImpl()
 		++i;
 	}
 
+	// deletions swap from the back and new projectiles are appended, so
+	// regroup every now and then to keep consecutive Update calls on the
+	// same code and on neighbouring memory
+	if ((gs->frameNum % PROJECTILE_SORT_RATE) == 0) {
+		SCOPED_TIMER("Sim::Projectiles::Sort");
+		SortProjectiles(pc, std::integral_constant<bool, synced>());
+	}
+
 	SCOPED_TIMER("Sim::Projectiles::Update");
 
 	// WARNING: same as above but for p->Update()
@@ -441,6 +501,34 @@ void CProjectileHandler::AddProjectile(CProjectile* p)
 
 
 
+// below this many projectiles per container hit detection stays serial
+static constexpr size_t MIN_PARALLEL_HIT_TESTS = 128;
+
+// per-projectile result of the parallel detection pass in CheckUnitFeatureCollisions
+struct ProjectileHitTest {
+	CollisionQuery unitQuery;
+	CollisionQuery featureQuery;
+
+	CUnit* unit = nullptr;
+	CFeature* feature = nullptr;
+
+	// set if the projectile has to go through the serial path
+	bool deferred = false;
+};
+
+// per-thread scratch space for hit detection
+struct HitTestBuffers {
+	std::vector<int> quads;
+	std::vector<CUnit*> units;
+	std::vector<CFeature*> features;
+	std::vector<CPlasmaRepulser*> repulsers;
+	std::vector<const CSolidObject*> objects;
+};
+
+static std::vector<ProjectileHitTest> hitTests;
+static std::array<HitTestBuffers, ThreadPool::MAX_THREADS> hitTestBuffers;
+
+
 static bool CheckProjectileCollisionFlags(const CProjectile* p, const CUnit* u)
 {
 	const unsigned int collFlags = p->GetCollisionFlags() * p->weapon;
@@ -483,16 +571,11 @@ static bool CheckProjectileCollisionFlags(const CProjectile* p, const CUnit* u)
 }
 
 
-void CProjectileHandler::CheckUnitCollisions(
-	CProjectile* p,
-	std::vector<CUnit*>& tempUnits,
-	const float3 ppos0,
-	const float3 ppos1
-) {
-	if (!p->checkCol)
-		return;
-
-	CollisionQuery cq;
+static void FilterUnitCandidates(const CProjectile* p, std::vector<CUnit*>& tempUnits)
+{
+	// filter first so the remaining candidates can be hit-tested as a batch;
+	// tempUnits is compacted in place such that its indices match the batch
+	size_t numUnits = 0;
 
 	for (CUnit* unit: tempUnits) {
 		assert(unit != nullptr);
@@ -506,59 +589,114 @@ void CProjectileHandler::CheckUnitCollisions(
 		if (!CheckProjectileCollisionFlags(p, unit))
 			continue;
 
-		if (CCollisionHandler::DetectHit(unit, unit->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
-			if (cq.GetHitPiece() != nullptr)
-				unit->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+		tempUnits[numUnits++] = unit;
+	}
 
-			if (!cq.InsideHit()) {
-				p->SetPosition(cq.GetHitPos());
-				p->Collision(unit);
-				p->SetPosition(ppos0);
-			} else {
-				p->Collision(unit);
-			}
+	tempUnits.resize(numUnits);
+}
 
-			break;
-		}
+static void FilterFeatureCandidates(const CProjectile* p, std::vector<CFeature*>& tempFeatures)
+{
+	if ((p->GetCollisionFlags() & Collision::NOFEATURES) != 0) {
+		tempFeatures.clear();
+		return;
+	}
+
+	// see FilterUnitCandidates
+	size_t numFeatures = 0;
+
+	for (CFeature* feature: tempFeatures) {
+		assert(feature != nullptr);
+
+		if (!feature->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES))
+			continue;
+
+		tempFeatures[numFeatures++] = feature;
 	}
+
+	tempFeatures.resize(numFeatures);
 }
 
-void CProjectileHandler::CheckFeatureCollisions(
+template<typename T>
+static T* DetectFirstHit(
+	const std::vector<T*>& candidates,
+	std::vector<const CSolidObject*>& hitTestObjects,
+	const float3 ppos0,
+	const float3 ppos1,
+	CollisionQuery* cq
+) {
+	hitTestObjects.assign(candidates.begin(), candidates.end());
+
+	const size_t hitIndex = CCollisionHandler::DetectHits(hitTestObjects.data(), hitTestObjects.size(), ppos0, ppos1, cq);
+
+	if (hitIndex == candidates.size())
+		return nullptr;
+
+	return candidates[hitIndex];
+}
+
+template<typename T>
+static void ApplyHit(CProjectile* p, T* object, const CollisionQuery& cq, const float3 ppos0)
+{
+	if (cq.GetHitPiece() != nullptr)
+		object->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+
+	if (!cq.InsideHit()) {
+		p->SetPosition(cq.GetHitPos());
+		p->Collision(object);
+		p->SetPosition(ppos0);
+	} else {
+		p->Collision(object);
+	}
+}
+
+template<typename T>
+static bool AnyPieceTreeVolume(const std::vector<T*>& objects)
+{
+	const auto pred = [](const T* o) { return (o->collisionVolume.DefaultToPieceTree()); };
+	return (std::find_if(objects.begin(), objects.end(), pred) != objects.end());
+}
+
+
+void CProjectileHandler::CheckUnitCollisions(
 	CProjectile* p,
-	std::vector<CFeature*>& tempFeatures,
+	std::vector<CUnit*>& tempUnits,
 	const float3 ppos0,
 	const float3 ppos1
 ) {
-	// already collided with unit?
 	if (!p->checkCol)
 		return;
 
-	if ((p->GetCollisionFlags() & Collision::NOFEATURES) != 0)
+	CollisionQuery cq;
+	FilterUnitCandidates(p, tempUnits);
+
+	CUnit* unit = DetectFirstHit(tempUnits, hitTestBuffers[ThreadPool::GetThreadNum()].objects, ppos0, ppos1, &cq);
+
+	if (unit == nullptr)
 		return;
 
-	CollisionQuery cq;
+	ApplyHit(p, unit, cq, ppos0);
+}
 
-	for (CFeature* feature: tempFeatures) {
-		assert(feature != nullptr);
+void CProjectileHandler::CheckFeatureCollisions(
+	CProjectile* p,
+	std::vector<CFeature*>& tempFeatures,
+	const float3 ppos0,
+	const float3 ppos1
+) {
+	// already collided with unit?
+	if (!p->checkCol)
+		return;
 
-		if (!feature->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES))
-			continue;
+	CollisionQuery cq;
+	FilterFeatureCandidates(p, tempFeatures);
 
-		if (CCollisionHandler::DetectHit(feature, feature->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
-			if (cq.GetHitPiece() != nullptr)
-				feature->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+	CFeature* feature = DetectFirstHit(tempFeatures, hitTestBuffers[ThreadPool::GetThreadNum()].objects, ppos0, ppos1, &cq);
 
-			if (!cq.InsideHit()) {
-				p->SetPosition(cq.GetHitPos());
-				p->Collision(feature);
-				p->SetPosition(ppos0);
-			} else {
-				p->Collision(feature);
-			}
+	if (feature == nullptr)
+		return;
 
-			break;
-		}
-	}
+	ApplyHit(p, feature, cq, ppos0);
 }
 
 
@@ -615,12 +753,65 @@ void CProjectileHandler::CheckShieldCollisions(
 	}
 }
 
+void CProjectileHandler::DetectUnitFeatureHits(const ProjectileContainer& pc)
+{
+	hitTests.clear();
+	hitTests.resize(pc.size());
+
+	for_mt_chunk(0, pc.size(), [&pc](int i) {
+		const CProjectile* p = pc[i];
+
+		if (!p->checkCol) return;
+		if ( p->deleteMe) return;
+
+		ProjectileHitTest& ht = hitTests[i];
+		HitTestBuffers& buffers = hitTestBuffers[ThreadPool::GetThreadNum()];
+
+		const float3 ppos0 = p->pos;
+		const float3 ppos1 = p->pos + p->speed;
+
+		buffers.units.clear();
+		buffers.features.clear();
+		buffers.repulsers.clear();
+
+		quadField.GetUnitsAndFeaturesColVolMT(p->pos, p->speed.w + p->radius, buffers.quads, buffers.units, buffers.features, &buffers.repulsers);
+
+		// shield interception changes shield state, so has to stay in order
+		if ((ht.deferred = !buffers.repulsers.empty()))
+			return;
+
+		FilterUnitCandidates(p, buffers.units);
+		FilterFeatureCandidates(p, buffers.features);
+
+		// piece matrices are updated lazily on access, not safe to race on
+		if ((ht.deferred = (AnyPieceTreeVolume(buffers.units) || AnyPieceTreeVolume(buffers.features))))
+			return;
+
+		ht.unit    = DetectFirstHit(buffers.units   , buffers.objects, ppos0, ppos1, &ht.unitQuery   );
+		ht.feature = DetectFirstHit(buffers.features, buffers.objects, ppos0, ppos1, &ht.featureQuery);
+	});
+}
+
 void CProjectileHandler::CheckUnitFeatureCollisions(ProjectileContainer& pc)
 {
 	static std::vector<CUnit*> tempUnits;
 	static std::vector<CFeature*> tempFeatures;
 	static std::vector<CPlasmaRepulser*> tempRepulsers;
 
+	// for large containers hits are detected on workers against the state at the
+	// start of this pass, then responded to here in container order; once any
+	// unit or feature has been moved, rotated, spawned or removed (e.g. by an
+	// explosion or a Lua call-in run from an earlier response) the detected
+	// results can be stale and every remaining projectile goes through the
+	// serial path
+	const bool detectedHits = (pc.size() >= MIN_PARALLEL_HIT_TESTS);
+
+	if (detectedHits)
+		DetectUnitFeatureHits(pc);
+
+	const unsigned int numObjectChanges = quadField.GetNumObjectChanges();
+	const unsigned int numTransformChanges = CSolidObject::GetNumTransformChanges();
+
 	for (size_t i = 0; i < pc.size(); ++i) {
 		CProjectile* p = pc[i];
 
@@ -631,6 +822,27 @@ void CProjectileHandler::CheckUnitFeatureCollisions(ProjectileContainer& pc)
 		const float3 ppos1 = p->pos + p->speed;
 		// const float3 ppos1 = p->pos + p->dir * (p->speed.w + p->radius);
 
+		const bool worldChanged =
+			(quadField.GetNumObjectChanges() != numObjectChanges) ||
+			(CSolidObject::GetNumTransformChanges() != numTransformChanges);
+
+		if (detectedHits && !hitTests[i].deferred && !worldChanged) {
+			const ProjectileHitTest& ht = hitTests[i];
+
+			const bool validUnitHit = (ht.unit == nullptr || (ht.unit->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES) && CheckProjectileCollisionFlags(p, ht.unit)));
+			const bool validFeatureHit = (ht.feature == nullptr || ht.feature->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES));
+
+			if (validUnitHit && validFeatureHit) {
+				if (ht.unit != nullptr)
+					ApplyHit(p, ht.unit, ht.unitQuery, ppos0);
+				// already collided with unit?
+				if (ht.feature != nullptr && p->checkCol)
+					ApplyHit(p, ht.feature, ht.featureQuery, ppos0);
+
+				continue;
+			}
+		}
+
 		quadField.GetUnitsAndFeaturesColVol(p->pos, p->speed.w + p->radius, tempUnits, tempFeatures, &tempRepulsers);
 
 		CheckShieldCollisions(p, tempRepulsers, ppos0, ppos1); tempRepulsers.clear();
@@ -702,6 +914,9 @@ void CProjectileHandler::AddFlyingPiece(
 	const float2 pieceParams,
 	const int2 renderParams
 ) {
+	if (!SpawnVisualParticles())
+		return;
+
 	flyingPieces[modelType].emplace_back(piece, m, pos, speed, pieceParams, renderParams);
 	resortFlyingPieces[modelType] = true;
 }
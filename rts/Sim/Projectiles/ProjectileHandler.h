@@ -47,6 +47,7 @@ public:
 	void CheckUnitCollisions(CProjectile*, std::vector<CUnit*>&, const float3, const float3);
 	void CheckFeatureCollisions(CProjectile*, std::vector<CFeature*>&, const float3, const float3);
 	void CheckShieldCollisions(CProjectile*, std::vector<CPlasmaRepulser*>&, const float3, const float3);
+	void DetectUnitFeatureHits(const ProjectileContainer&);
 	void CheckUnitFeatureCollisions(ProjectileContainer&);
 	void CheckGroundCollisions(ProjectileContainer&);
 	void CheckCollisions();
@@ -57,6 +58,9 @@ public:
 	void Update();
 
 	float GetParticleSaturation(bool randomized = true) const;
+
+	// bytes held by the projectile memory pool and containers, including flying pieces
+	size_t GetMemFootPrint() const;
 	float GetNanoParticleSaturation(float priority) const {
 		const float total = std::max(1.0f, maxNanoParticles * priority);
 		const float fract = std::max(int(currentNanoParticles >= maxNanoParticles), currentNanoParticles) / total;
@@ -66,6 +70,16 @@ public:
 
 	int GetCurrentParticles() const;
 
+	// false if nothing would ever draw purely visual (CEG, shatter) particles:
+	// always in headless builds, otherwise when MaxParticles is zero
+	bool SpawnVisualParticles() const {
+	#ifdef HEADLESS
+		return false;
+	#else
+		return (maxParticles > 0);
+	#endif
+	}
+
 	void AddProjectile(CProjectile* p);
 	void AddGroundFlash(CGroundFlash* flash) { groundFlashes.push_back(flash); }
 	void AddFlyingPiece(
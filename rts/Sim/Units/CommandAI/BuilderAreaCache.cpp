@@ -0,0 +1,119 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstring>
+
+#include "BuilderAreaCache.h"
+#include "Sim/Features/Feature.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/QuadField.h"
+#include "System/EventHandler.h"
+#include "System/SafeUtil.h"
+
+// CBuilderAreaCache is an EventClient, can not construct in global scope
+static uint8_t builderAreaCacheMem[sizeof(CBuilderAreaCache)];
+
+CBuilderAreaCache* builderAreaCache = nullptr;
+
+
+void CBuilderAreaCache::InitStatic()
+{
+	if (builderAreaCache == nullptr)
+		builderAreaCache = new (builderAreaCacheMem) CBuilderAreaCache();
+
+	builderAreaCache->areas.clear();
+
+	eventHandler.AddClient(builderAreaCache);
+}
+
+void CBuilderAreaCache::KillStatic(bool reload)
+{
+	builderAreaCache->areas.clear();
+
+	if (reload)
+		return;
+
+	spring::SafeDestruct(builderAreaCache);
+	memset(builderAreaCacheMem, 0, sizeof(builderAreaCacheMem));
+}
+
+
+const std::vector<CFeature*>& CBuilderAreaCache::GetFeatures(const float3& pos, float radius)
+{
+	const auto isIdle = [&](const Area& a) { return ((gs->frameNum - a.lastQueryFrame) > MAX_IDLE_FRAMES); };
+	const auto isSame = [&](const Area& a) { return (a.pos == pos && a.radius == radius); };
+
+	areas.erase(std::remove_if(areas.begin(), areas.end(), isIdle), areas.end());
+
+	auto iter = std::find_if(areas.begin(), areas.end(), isSame);
+
+	if (iter == areas.end()) {
+		QuadFieldQuery qfQuery;
+		quadField.GetFeaturesExact(qfQuery, pos, radius, false);
+
+		areas.emplace_back();
+		iter = areas.end() - 1;
+
+		iter->pos = pos;
+		iter->radius = radius;
+		iter->features.assign(qfQuery.features->begin(), qfQuery.features->end());
+	}
+
+	iter->lastQueryFrame = gs->frameNum;
+	return iter->features;
+}
+
+
+void CBuilderAreaCache::Area::AddFeature(CFeature* feature)
+{
+	if (std::find(features.begin(), features.end(), feature) != features.end())
+		return;
+
+	features.push_back(feature);
+}
+
+void CBuilderAreaCache::Area::RemoveFeature(CFeature* feature)
+{
+	const auto iter = std::find(features.begin(), features.end(), feature);
+
+	if (iter == features.end())
+		return;
+
+	// keep the order, it decides ties between equally distant targets
+	features.erase(iter);
+}
+
+
+void CBuilderAreaCache::FeatureCreated(const CFeature* feature)
+{
+	for (Area& a: areas) {
+		if (!a.Contains(feature->pos, feature->radius))
+			continue;
+
+		a.AddFeature(const_cast<CFeature*>(feature));
+	}
+}
+
+void CBuilderAreaCache::FeatureDestroyed(const CFeature* feature)
+{
+	for (Area& a: areas) {
+		a.RemoveFeature(const_cast<CFeature*>(feature));
+	}
+}
+
+void CBuilderAreaCache::FeatureMoved(const CFeature* feature, const float3& oldPos)
+{
+	for (Area& a: areas) {
+		const bool wasInside = a.Contains(oldPos, feature->radius);
+		const bool isInside = a.Contains(feature->pos, feature->radius);
+
+		if (wasInside == isInside)
+			continue;
+
+		if (isInside) {
+			a.AddFeature(const_cast<CFeature*>(feature));
+		} else {
+			a.RemoveFeature(const_cast<CFeature*>(feature));
+		}
+	}
+}
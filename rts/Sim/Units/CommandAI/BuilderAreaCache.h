@@ -0,0 +1,75 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _BUILDER_AREA_CACHE_H_
+#define _BUILDER_AREA_CACHE_H_
+
+#include <vector>
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/EventClient.h"
+#include "System/SpringMath.h"
+#include "System/float3.h"
+
+class CFeature;
+
+/**
+ * Features inside the circles of area reclaim and resurrect commands.
+ *
+ * Such a command is usually given to many builders at once, which then
+ * all search the same circle every SlowUpdate. Rather than querying the
+ * QuadField each time, the features of a circle are collected once and
+ * kept up to date through the Feature{Created,Destroyed,Moved} events;
+ * circles that no builder asked for in a while are dropped.
+ *
+ * Holds no state that is not derived from the features, so nothing is
+ * saved and the circles are simply rebuilt after loading.
+ */
+class CBuilderAreaCache : public CEventClient
+{
+public:
+	CBuilderAreaCache(): CEventClient("[CBuilderAreaCache]", 271994, true) {}
+
+	static void InitStatic();
+	static void KillStatic(bool reload);
+
+	/// same features as CQuadField::GetFeaturesExact(pos, radius, false), not in the same order
+	const std::vector<CFeature*>& GetFeatures(const float3& pos, float radius);
+
+public:
+	// CEventClient interface
+	bool WantsEvent(const std::string& eventName) override {
+		return (eventName == "FeatureCreated") || (eventName == "FeatureDestroyed") || (eventName == "FeatureMoved");
+	}
+	bool GetFullRead() const override { return true; }
+	int  GetReadAllyTeam() const override { return AllAccessTeam; }
+
+	void FeatureCreated(const CFeature* feature) override;
+	void FeatureDestroyed(const CFeature* feature) override;
+	void FeatureMoved(const CFeature* feature, const float3& oldPos) override;
+
+private:
+	struct Area {
+		bool Contains(const float3& objPos, float objRadius) const {
+			return (pos.SqDistance2D(objPos) < Square(radius + objRadius));
+		}
+
+		void AddFeature(CFeature* feature);
+		void RemoveFeature(CFeature* feature);
+
+		float3 pos;
+		float radius;
+
+		int lastQueryFrame;
+
+		std::vector<CFeature*> features;
+	};
+
+	// areas not queried for this many frames are dropped
+	static constexpr int MAX_IDLE_FRAMES = UNIT_SLOWUPDATE_RATE * 4;
+
+	std::vector<Area> areas;
+};
+
+extern CBuilderAreaCache* builderAreaCache;
+
+#endif // _BUILDER_AREA_CACHE_H_
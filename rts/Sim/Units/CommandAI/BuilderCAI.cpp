@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "BuilderCAI.h"
+#include "BuilderAreaCache.h"
 #include "ExternalAI/EngineOutHandler.h"
 #include "Game/GameHelper.h"
 #include "Game/SelectedUnitsHandler.h"
@@ -58,6 +59,7 @@ spring::unordered_set<int> CBuilderCAI::featureReclaimers;
 spring::unordered_set<int> CBuilderCAI::resurrecters;
 
 std::vector<int> CBuilderCAI::removees;
+std::vector<int> CBuilderCAI::claimedFeatureIDs;
 
 
 static std::string GetUnitDefBuildOptionToolTip(const UnitDef* ud, bool disabled) {
@@ -1000,6 +1002,7 @@ void CBuilderCAI::ExecuteReclaim(Command& c)
 				const bool recSpecial = !!(c.GetOpts() & CONTROL_KEY);
 
 				ReclaimOption recopt = REC_NORESCHECK;
+				recopt |= REC_AREACMD;
 				if (recUnits)     recopt |= REC_UNITS;
 				if (recEnemyOnly) recopt |= REC_ENEMYONLY;
 				if (recSpecial)   recopt |= REC_SPECIAL;
@@ -1082,6 +1085,7 @@ void CBuilderCAI::ExecuteReclaim(Command& c)
 		ownerBuilder->StopBuild();
 
 		ReclaimOption recopt = REC_NORESCHECK;
+		recopt |= REC_AREACMD;
 		if (recUnits)     recopt |= REC_UNITS;
 		if (recEnemyOnly) recopt |= REC_ENEMYONLY;
 		if (recSpecial)   recopt |= REC_SPECIAL;
@@ -1159,7 +1163,7 @@ void CBuilderCAI::ExecuteResurrect(Command& c)
 		const float3 pos = c.GetPos(0);
 		const float radius = c.GetParam(3);
 
-		if (FindResurrectableFeatureAndResurrect(pos, radius, c.GetOpts(), (c.GetOpts() & META_KEY))) {
+		if (FindResurrectableFeatureAndResurrect(pos, radius, c.GetOpts(), (c.GetOpts() & META_KEY), true)) {
 			inCommand = false;
 			SlowUpdate();
 			return;
@@ -1488,6 +1492,68 @@ bool CBuilderCAI::IsFeatureBeingResurrected(int featureId, const CUnit* friendUn
 }
 
 
+void CBuilderCAI::GetFeaturesBeingReclaimed(const CUnit* friendUnit)
+{
+	claimedFeatureIDs.clear();
+
+	removees.clear();
+	removees.reserve(featureReclaimers.size());
+
+	for (const int reclaimerID: featureReclaimers) {
+		const CUnit* u = unitHandler.GetUnit(reclaimerID);
+		const CCommandQueue& cq = u->commandAI->commandQue;
+
+		if (cq.empty()) {
+			removees.push_back(u->id);
+			continue;
+		}
+		const Command& c = cq.front();
+		if (c.GetID() != CMD_RECLAIM || (c.GetNumParams() != 1 && c.GetNumParams() != 5)) {
+			removees.push_back(u->id);
+			continue;
+		}
+		if (friendUnit == nullptr || teamHandler.Ally(friendUnit->allyteam, u->allyteam))
+			claimedFeatureIDs.push_back((int)c.GetParam(0) - unitHandler.MaxUnits());
+	}
+
+	for (const int removeeID: removees)
+		RemoveUnitFromFeatureReclaimers(unitHandler.GetUnit(removeeID));
+
+	std::sort(claimedFeatureIDs.begin(), claimedFeatureIDs.end());
+}
+
+
+void CBuilderCAI::GetFeaturesBeingResurrected(const CUnit* friendUnit)
+{
+	claimedFeatureIDs.clear();
+
+	removees.clear();
+	removees.reserve(resurrecters.size());
+
+	for (const int resurrecterID: resurrecters) {
+		const CUnit* u = unitHandler.GetUnit(resurrecterID);
+		const CCommandQueue& cq = u->commandAI->commandQue;
+
+		if (cq.empty()) {
+			removees.push_back(u->id);
+			continue;
+		}
+		const Command& c = cq.front();
+		if (c.GetID() != CMD_RESURRECT || c.GetNumParams() != 1) {
+			removees.push_back(u->id);
+			continue;
+		}
+		if (friendUnit == nullptr || teamHandler.Ally(friendUnit->allyteam, u->allyteam))
+			claimedFeatureIDs.push_back((int)c.GetParam(0) - unitHandler.MaxUnits());
+	}
+
+	for (const int removeeID: removees)
+		RemoveUnitFromResurrecters(unitHandler.GetUnit(removeeID));
+
+	std::sort(claimedFeatureIDs.begin(), claimedFeatureIDs.end());
+}
+
+
 bool CBuilderCAI::ReclaimObject(CSolidObject* object) {
 	if (MoveInBuildRange(object)) {
 		ownerBuilder->SetReclaimTarget(object);
@@ -1506,6 +1572,7 @@ int CBuilderCAI::FindReclaimTarget(const float3& pos, float radius, unsigned cha
 	const bool recEnemy     = recoptions & REC_ENEMY;
 	const bool recEnemyOnly = recoptions & REC_ENEMYONLY;
 	const bool recSpecial   = recoptions & REC_SPECIAL;
+	const bool recAreaCmd   = recoptions & REC_AREACMD;
 
 	const CSolidObject* best = nullptr;
 	float bestDist = bestStartDist;
@@ -1554,10 +1621,13 @@ int CBuilderCAI::FindReclaimTarget(const float3& pos, float radius, unsigned cha
 		best = nullptr;
 		const CTeam* team = teamHandler.Team(owner->team);
 		QuadFieldQuery qfQuery;
-		quadField.GetFeaturesExact(qfQuery, pos, radius, false);
 		bool metal = false;
+		bool haveClaims = false;
+
+		if (!recAreaCmd)
+			quadField.GetFeaturesExact(qfQuery, pos, radius, false);
 
-		for (const CFeature* f: *qfQuery.features) {
+		for (const CFeature* f: (recAreaCmd? builderAreaCache->GetFeatures(pos, radius): *qfQuery.features)) {
 			if (!f->def->reclaimable)
 				continue;
 			if (!recSpecial && !f->def->autoreclaim)
@@ -1582,7 +1652,12 @@ int CBuilderCAI::FindReclaimTarget(const float3& pos, float radius, unsigned cha
 				if (!owner->unitDef->canmove && !IsInBuildRange(f))
 					continue;
 
-				if (IsFeatureBeingResurrected(f->id, owner))
+				if (!haveClaims) {
+					GetFeaturesBeingResurrected(owner);
+					haveClaims = true;
+				}
+
+				if (IsClaimedFeature(f->id))
 					continue;
 
 				metal |= (recSpecial && !metal && f->defResources.metal > 0.0f);
@@ -1627,15 +1702,19 @@ bool CBuilderCAI::FindResurrectableFeatureAndResurrect(
 	const float3& pos,
 	float radius,
 	unsigned char options,
-	bool freshOnly
+	bool freshOnly,
+	bool areaCmd
 ) {
 	QuadFieldQuery qfQuery;
-	quadField.GetFeaturesExact(qfQuery, pos, radius, false);
+
+	if (!areaCmd)
+		quadField.GetFeaturesExact(qfQuery, pos, radius, false);
 
 	const CFeature* best = nullptr;
 	float bestDist = 1.0e30f;
+	bool haveClaims = false;
 
-	for (const CFeature* f: *qfQuery.features) {
+	for (const CFeature* f: (areaCmd? builderAreaCache->GetFeatures(pos, radius): *qfQuery.features)) {
 		if (f->udef == nullptr)
 			continue;
 
@@ -1651,8 +1730,15 @@ bool CBuilderCAI::FindResurrectableFeatureAndResurrect(
 			if (owner->immobile && !IsInBuildRange(f))
 				continue;
 
-			if (!(options & CONTROL_KEY) && IsFeatureBeingReclaimed(f->id, owner))
-				continue;
+			if (!(options & CONTROL_KEY)) {
+				if (!haveClaims) {
+					GetFeaturesBeingReclaimed(owner);
+					haveClaims = true;
+				}
+
+				if (IsClaimedFeature(f->id))
+					continue;
+			}
 
 			bestDist = dist;
 			best = f;
@@ -8,6 +8,7 @@
 #include "System/Misc/BitwiseEnum.h"
 #include "System/UnorderedSet.hpp"
 
+#include <algorithm>
 #include <vector>
 
 class CUnit;
@@ -59,6 +60,16 @@ public:
 	static bool IsFeatureBeingReclaimed(int featureId, const CUnit* friendUnit = nullptr);
 	static bool IsFeatureBeingResurrected(int featureId, const CUnit* friendUnit = nullptr);
 
+	/**
+	 * Same as calling IsFeatureBeing{Reclaimed,Resurrected} for every feature,
+	 * fills claimedFeatureIDs (sorted) for area searches over many features.
+	 */
+	static void GetFeaturesBeingReclaimed(const CUnit* friendUnit);
+	static void GetFeaturesBeingResurrected(const CUnit* friendUnit);
+	static bool IsClaimedFeature(int featureId) {
+		return (std::binary_search(claimedFeatureIDs.begin(), claimedFeatureIDs.end(), featureId));
+	}
+
 	bool IsInBuildRange(const CWorldObject* obj) const;
 	bool IsInBuildRange(const float3& pos, const float radius) const;
 
@@ -70,6 +81,7 @@ public:
 	static spring::unordered_set<int> resurrecters;
 
 	static std::vector<int> removees;
+	static std::vector<int> claimedFeatureIDs;
 
 private:
 	enum ReclaimOptions {
@@ -78,7 +90,8 @@ private:
 		REC_NONREZ     = 1<<2,
 		REC_ENEMY      = 1<<3,
 		REC_ENEMYONLY  = 1<<4,
-		REC_SPECIAL    = 1<<5
+		REC_SPECIAL    = 1<<5,
+		REC_AREACMD    = 1<<6  ///< pos and radius are those of an area command, see CBuilderAreaCache
 	};
 	typedef Bitwise::BitwiseEnum<ReclaimOptions> ReclaimOption;
 
@@ -92,8 +105,9 @@ private:
 	bool FindReclaimTargetAndReclaim(const float3& pos, float radius, unsigned char cmdopt, ReclaimOption recoptions);
 	/**
 	 * @param freshOnly reclaims only corpses that have rez progress or all the metal left
+	 * @param areaCmd pos and radius are those of an area command, see CBuilderAreaCache
 	 */
-	bool FindResurrectableFeatureAndResurrect(const float3& pos, float radius, unsigned char options, bool freshOnly);
+	bool FindResurrectableFeatureAndResurrect(const float3& pos, float radius, unsigned char options, bool freshOnly, bool areaCmd = false);
 
 	/**
 	 * @param builtOnly skips units that are under construction
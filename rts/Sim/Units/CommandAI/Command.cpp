@@ -50,12 +50,17 @@ float Command::GetParam(unsigned int idx) const {
 
 
 bool Command::SetParam(unsigned int idx, float param) {
-	float* ptr = const_cast<float*>(GetParams(idx));
+	if (idx >= numParams)
+		return false;
 
-	if (ptr != nullptr)
-		return (*ptr = param, true);
+	if (IsPooledCommand()) {
+		pageIndex = cmdParamsPool.ClonePage(pageIndex);
+		cmdParamsPool.Set(pageIndex, idx, param);
+		return true;
+	}
 
-	return false;
+	params[idx] = param;
+	return true;
 }
 
 bool Command::PushParam(float param) {
@@ -75,6 +80,8 @@ bool Command::PushParam(float param) {
 
 		memset(&params[0], 0, sizeof(params));
 		assert(IsPooledCommand());
+	} else {
+		pageIndex = cmdParamsPool.ClonePage(pageIndex);
 	}
 
 	// add new parameter
@@ -83,18 +90,49 @@ bool Command::PushParam(float param) {
 }
 
 void Command::CopyParams(const Command& c) {
-	// clear existing params
+	if (c.IsPooledCommand()) {
+		// share the page, reference it first in case c is this command
+		const unsigned int cmdPageIndex = c.pageIndex;
+		const unsigned int cmdNumParams = c.numParams;
+
+		cmdParamsPool.AddRef(cmdPageIndex);
+		ClearParams();
+
+		pageIndex = cmdPageIndex;
+		numParams = cmdNumParams;
+		return;
+	}
+
+	if (this == &c)
+		return;
+
+	ClearParams();
+
+	numParams = c.numParams;
+
+	memcpy(&params[0], &c.params[0], sizeof(params));
+}
+
+void Command::MoveParams(Command& c) {
+	ClearParams();
+
+	pageIndex = c.pageIndex;
+	numParams = c.numParams;
+
+	memcpy(&params[0], &c.params[0], sizeof(params));
+
+	c.pageIndex = -1u;
+	c.numParams = 0;
+}
+
+void Command::ClearParams() {
 	if (IsPooledCommand())
 		cmdParamsPool.ReleasePage(pageIndex);
 
 	pageIndex = -1u;
 	numParams = 0;
 
-	assert(IsEmptyCommand());
-
-	for (unsigned int i = 0; i < c.numParams; i++) {
-		PushParam(c.GetParam(i));
-	}
+	memset(&params[0], 0, sizeof(params));
 }
 
 void Command::Serialize(creg::ISerializer* s) {
@@ -6,6 +6,7 @@
 #include <string>
 #include <climits> // INT_MAX
 #include <cstring> // memset
+#include <utility> // std::move
 
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
@@ -164,6 +165,9 @@ public:
 	Command(const Command& c) {
 		*this = c;
 	}
+	Command(Command&& c) {
+		*this = std::move(c);
+	}
 
 	Command& operator = (const Command& c) {
 		memcpy(&id[0], &c.id[0], sizeof(id));
@@ -172,6 +176,16 @@ public:
 		CopyParams(c);
 		return *this;
 	}
+	Command& operator = (Command&& c) {
+		if (this == &c)
+			return *this;
+
+		memcpy(&id[0], &c.id[0], sizeof(id));
+
+		SetFlags(c.timeOut, c.tag, c.options);
+		MoveParams(c);
+		return *this;
+	}
 
 	Command(const float3& pos) {
 		memset(&params[0], 0, sizeof(params));
@@ -246,22 +260,16 @@ public:
 	}
 
 	void FromRawCommand(const RawCommand& rc) {
-		pageIndex = rc.pageIndex;
-		numParams = rc.numParams;
-
 		memcpy(&id[0], &rc.id[0], sizeof(id));
-		memset(&params[0], 0, sizeof(params));
-
 		SetFlags(rc.timeOut, rc.tag, rc.options);
 
-		if (IsPooledCommand()) {
-			// actual params should still be in pool, original command exists on AI side
-			assert(numParams > MAX_COMMAND_PARAMS);
-			return;
-		}
+		// copy rather than alias the pool page, the original command exists on
+		// the AI side and releases it; rc.params points into the page if pooled
+		ClearParams();
 
-		assert(numParams <= MAX_COMMAND_PARAMS);
-		memcpy(&params[0], &rc.params[0], rc.numParams);
+		for (unsigned int i = 0; i < rc.numParams; i++) {
+			PushParam(rc.params[i]);
+		}
 	}
 
 
@@ -423,6 +431,8 @@ public:
 	}
 
 	void CopyParams(const Command& c);
+	void MoveParams(Command& c);
+	void ClearParams();
 
 	void Serialize(creg::ISerializer* s);
 
@@ -443,6 +453,7 @@ private:
 	int timeOut = INT_MAX;
 
 	/// page-index for cmdParamsPool, valid iff numParams > MAX_COMMAND_PARAMS
+	/// pages are shared between copies and cloned by SetParam and PushParam
 	unsigned int pageIndex = -1u;
 	unsigned int numParams = 0;
 
@@ -45,6 +45,8 @@
 // unreasonable
 static const int TARGET_LOST_TIMER = 4;
 static const float COMMAND_CANCEL_DIST = 17.0f;
+// upper bound on the non-build descriptions added by the CAI ctors
+static const size_t MAX_DEFAULT_CMD_DESCS = 32;
 
 void CCommandAI::InitCommandDescriptionCache() { commandDescriptionCache.Init(); }
 void CCommandAI::KillCommandDescriptionCache() { commandDescriptionCache.Kill(); }
@@ -105,6 +107,10 @@ CCommandAI::CCommandAI(CUnit* owner):
 	lastSelectedCommandPage(0),
 	targetLostTimer(TARGET_LOST_TIMER)
 {
+	// enough for the descriptions added by this and any derived CAI ctor,
+	// so building the list does not reallocate for every new unit
+	possibleCommands.reserve(MAX_DEFAULT_CMD_DESCS + owner->unitDef->buildOptions.size());
+
 	{
 		SCommandDescription c;
 
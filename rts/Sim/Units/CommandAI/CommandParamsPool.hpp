@@ -9,36 +9,53 @@
 
 #include "System/creg/creg_cond.h"
 
+// pages are reference-counted so copies of a command with many params
+// (e.g. the same order given to a large selection) can share one page,
+// commands clone their page before modifying a shared one
 template<typename T, size_t N, size_t S> struct TCommandParamsPool {
 public:
 	const T* GetPtr(unsigned int i, unsigned int j     ) const { assert(i < pages.size()); return (pages[i].data( ) + j); }
 	//    T* GetPtr(unsigned int i, unsigned int j     )       { assert(i < pages.size()); return (pages[i].data( ) + j); }
 	      T  Get   (unsigned int i, unsigned int j     ) const { assert(i < pages.size()); return (pages[i].at  (j)    ); }
-	      T  Set   (unsigned int i, unsigned int j, T v)       { assert(i < pages.size()); return (pages[i].at  (j) = v); }
+	      T  Set   (unsigned int i, unsigned int j, T v)       { assert(!IsShared(i)); return (pages[i].at  (j) = v); }
 
 	size_t Push(unsigned int i, T v) {
-		assert(i < pages.size());
+		assert(!IsShared(i));
 		pages[i].push_back(v);
 		return (pages[i].size());
 	}
 
+	bool IsShared(unsigned int i) const {
+		assert(i < pages.size());
+		return (refCounts[i] > 1);
+	}
+
+	void AddRef(unsigned int i) {
+		assert(i < pages.size());
+		assert(refCounts[i] > 0);
+		refCounts[i] += 1;
+	}
+
 	void ReleasePage(unsigned int i) {
 		assert(i < pages.size());
-		indcs.push_back(i);
+		assert(refCounts[i] > 0);
+
+		if ((refCounts[i] -= 1) == 0)
+			indcs.push_back(i);
 	}
 
 	unsigned int AcquirePage() {
 		if (indcs.empty()) {
-			const size_t numIndices = indcs.size();
-
-			pages.resize(std::max(N, pages.size() << 1));
-			indcs.resize(std::max(N, indcs.size() << 1));
+			const size_t numPages = pages.size();
 
-			const auto beg = indcs.begin() + numIndices;
-			const auto end = indcs.end();
+			pages.resize(std::max(N, numPages << 1));
+			refCounts.resize(pages.size(), 0);
+			indcs.resize(pages.size() - numPages);
 
-			// generate new indices
-			std::for_each(beg, end, [&](const unsigned int& i) { indcs[&i - &indcs[0]] = &i - &indcs[0]; });
+			// generate new indices, in reverse so pages are handed out in order
+			for (size_t k = 0, n = indcs.size(); k < n; k++) {
+				indcs[k] = pages.size() - 1 - k;
+			}
 		}
 
 		const unsigned int pageIndex = indcs.back();
@@ -46,12 +63,27 @@ public:
 		pages[pageIndex].clear();
 		pages[pageIndex].reserve(S);
 
+		refCounts[pageIndex] = 1;
+
 		indcs.pop_back();
 		return pageIndex;
 	}
 
+	// returns an unshared copy of page i, releasing the caller's reference to i
+	unsigned int ClonePage(unsigned int i) {
+		if (!IsShared(i))
+			return i;
+
+		const unsigned int j = AcquirePage();
+
+		pages[j] = pages[i];
+		ReleasePage(i);
+		return j;
+	}
+
 private:
 	std::vector< std::vector<T> > pages;
+	std::vector<unsigned int> refCounts;
 	std::vector<unsigned int> indcs;
 };
 
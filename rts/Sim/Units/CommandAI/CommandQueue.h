@@ -132,7 +132,7 @@ inline CCommandQueue::iterator CCommandQueue::insert(iterator pos, const Command
 {
 	Command tmpCmd = cmd;
 	tmpCmd.SetTag(GetNextTag());
-	return queue.insert(pos, tmpCmd);
+	return queue.insert(pos, std::move(tmpCmd));
 }
 
 
@@ -4,6 +4,12 @@
 #include "CobEngine.h"
 #include "CobThread.h"
 #include "CobFile.h"
+#include "UnitScriptEngine.h"
+#include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
+#include <functional>
 
 
 CR_BIND(CCobEngine, )
@@ -17,10 +23,16 @@ CR_REG_METADATA(CCobEngine, (
 	// always null/empty when saving
 	CR_IGNORED(waitingThreadIDs),
 
-	CR_IGNORED(curThread),
+	CR_IGNORED(wokenThreadIDs),
+	CR_IGNORED(localThreads),
+	CR_IGNORED(localThreadGroups),
+	CR_IGNORED(deferredCalls),
 
 	CR_MEMBER(currentTime),
-	CR_MEMBER(threadCounter)
+	CR_MEMBER(threadCounter),
+
+	CR_IGNORED(opcodeCounts),
+	CR_IGNORED(profileOpcodes)
 ))
 
 CR_BIND(CCobEngine::SleepingThread, )
@@ -30,6 +42,12 @@ CR_REG_METADATA(CCobEngine::SleepingThread, (
 ))
 
 
+// thread being ticked by the calling (worker) thread, for error messages originating in CUnitScript
+static thread_local CCobThread* curThread = nullptr;
+// where calls are deferred to while the calling worker ticks threads in parallel, if anywhere
+static thread_local std::vector<CCobEngine::DeferredCall>* curDeferredCalls = nullptr;
+
+
 int CCobEngine::AddThread(CCobThread&& thread)
 {
 	if (thread.GetID() == -1)
@@ -49,17 +67,24 @@ int CCobEngine::AddThread(CCobThread&& thread)
 // a thread wants to continue running at a later time, and adds itself to the scheduler
 void CCobEngine::ScheduleThread(const CCobThread* thread)
 {
+	DeferredCall call = {DeferredCall::CallScheduleRunning, thread->GetID(), thread->GetWakeTime(), nullptr};
+
 	switch (thread->GetState()) {
 		case CCobThread::Run: {
-			waitingThreadIDs.push_back(thread->GetID());
 		} break;
 		case CCobThread::Sleep: {
-			sleepingThreadIDs.push(SleepingThread{thread->GetID(), thread->GetWakeTime()});
+			call.type = DeferredCall::CallScheduleSleeping;
 		} break;
 		default: {
 			LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, thread->GetState(), thread->GetID());
+			return;
 		} break;
 	}
+
+	if (DeferCall(call))
+		return;
+
+	RunCall(call);
 }
 
 void CCobEngine::SanityCheckThreads(const CCobInstance* owner)
@@ -76,23 +101,180 @@ void CCobEngine::SanityCheckThreads(const CCobInstance* owner)
 }
 
 
-void CCobEngine::TickThread(CCobThread* thread)
+bool CCobEngine::DeferCall(const DeferredCall& call)
+{
+	if (curDeferredCalls == nullptr)
+		return false;
+
+	curDeferredCalls->push_back(call);
+	return true;
+}
+
+void CCobEngine::RunCall(const DeferredCall& call)
+{
+	switch (call.type) {
+		case DeferredCall::CallScheduleRunning: {
+			waitingThreadIDs.push_back(call.threadID);
+		} break;
+		case DeferredCall::CallScheduleSleeping: {
+			sleepingThreadIDs.push(SleepingThread{call.threadID, call.wakeTime});
+		} break;
+		case DeferredCall::CallRemoveThread: {
+			RemoveThread(call.threadID);
+		} break;
+		case DeferredCall::CallAddAnimating: {
+			unitScriptEngine->AddInstance(call.script);
+		} break;
+		case DeferredCall::CallRemoveAnimating: {
+			unitScriptEngine->RemoveInstance(call.script);
+		} break;
+	}
+}
+
+void CCobEngine::RemoveTickedThread(int threadID)
+{
+	// removal runs the thread's callback, which is not local
+	const DeferredCall call = {DeferredCall::CallRemoveThread, threadID, 0, nullptr};
+
+	if (DeferCall(call))
+		return;
+
+	RunCall(call);
+}
+
+
+bool CCobEngine::IsLocalThread(int threadID, bool woken)
 {
+	const CCobThread* thread = GetThread(threadID);
+
+	if (thread == nullptr)
+		return true;
+
+	switch (thread->GetState()) {
+		case CCobThread::Dead : return true;
+		case CCobThread::Sleep: return (woken && thread->IsLocal());
+		default               : break;
+	}
+
+	return (!woken && thread->IsLocal());
+}
+
+void CCobEngine::TickThread(int threadID, bool woken)
+{
+	CCobThread* thread = GetThread(threadID);
+
+	if (thread == nullptr)
+		return;
+
+	// wake up the thread and tick it (if not dead)
+	// this can quite possibly re-add the thread to <sleepingThreadIDs>
+	// again, but any thread is guaranteed to sleep for at least 1 tick
+	if (woken) {
+		switch (thread->GetState()) {
+			case CCobThread::Sleep: {
+				thread->SetState(CCobThread::Run);
+			} break;
+			case CCobThread::Dead: {
+				RemoveTickedThread(threadID);
+			} return;
+			default: {
+				LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, thread->GetState(), threadID);
+			} return;
+		}
+	}
+
 	// for error messages originating in CUnitScript
 	curThread = thread;
 
 	// NB: threadID is still in <runningThreadIDs> here, TickRunningThreads clears it
-	if (thread != nullptr && !thread->Tick())
-		RemoveThread(thread->GetID());
+	if (!thread->Tick())
+		RemoveTickedThread(threadID);
 
 	curThread = nullptr;
 }
 
+void CCobEngine::TickLocalThreads(const int* threadIDs, size_t numThreads, bool woken)
+{
+	localThreads.clear();
+	localThreadGroups.clear();
+
+	// threads of the same instance can interact, each instance's are ticked in order by one task
+	for (size_t i = 0; i < numThreads; i++) {
+		const CCobThread* thread = GetThread(threadIDs[i]);
+		localThreads.emplace_back((thread != nullptr)? thread->cobInst: nullptr, i);
+	}
+
+	// grouping order does not matter, the tasks are independent
+	std::stable_sort(localThreads.begin(), localThreads.end(), [](const auto& a, const auto& b) { return (std::less<const CCobInstance*>()(a.first, b.first)); });
+
+	for (size_t i = 0; i < numThreads; i++) {
+		if (i == 0 || localThreads[i].first != localThreads[i - 1].first)
+			localThreadGroups.push_back(i);
+	}
+
+	localThreadGroups.push_back(numThreads);
+
+	if (deferredCalls.size() < numThreads)
+		deferredCalls.resize(numThreads);
+
+	for_mt(0, localThreadGroups.size() - 1, [&](const int group) {
+		for (size_t i = localThreadGroups[group]; i < localThreadGroups[group + 1]; i++) {
+			const size_t slot = localThreads[i].second;
+
+			curDeferredCalls = &deferredCalls[slot];
+			TickThread(threadIDs[slot], woken);
+		}
+
+		curDeferredCalls = nullptr;
+	});
+
+	// apply the shared-state changes in the order a serial tick would have made them
+	for (size_t i = 0; i < numThreads; i++) {
+		for (const DeferredCall& call: deferredCalls[i]) {
+			RunCall(call);
+		}
+
+		deferredCalls[i].clear();
+	}
+}
+
+void CCobEngine::TickThreads(const std::vector<int>& threadIDs, bool woken)
+{
+	// the opcode counts are not safe to update in parallel
+	const bool tickParallel = !profileOpcodes;
+
+	for (size_t i = 0, n = threadIDs.size(); i < n; ) {
+		size_t j = i;
+
+		// find the run of threads (from i on) that only touch their own instance; those
+		// can neither affect nor observe threads of other instances ticked before them
+		while (tickParallel && j < n && IsLocalThread(threadIDs[j], woken)) {
+			j++;
+		}
+
+		if ((j - i) >= MIN_PARALLEL_THREADS) {
+			TickLocalThreads(&threadIDs[i], j - i, woken);
+			i = j;
+			continue;
+		}
+
+		// not worth it, or thread <i> is not local
+		for (j = std::max(j, i + 1); i < j; i++) {
+			TickThread(threadIDs[i], woken);
+		}
+	}
+}
+
 void CCobEngine::WakeSleepingThreads()
 {
-	// check on the sleeping threads, remove any whose owner died
+	wokenThreadIDs.clear();
+
+	// check on the sleeping threads, remove any whose owner died; every
+	// thread sleeps for at least one tick so none of those rescheduled by
+	// ticking the woken ones can be due yet, and since the queue's order
+	// is total they can be collected up-front without changing it
 	while (!sleepingThreadIDs.empty()) {
-		CCobThread* zzzThread = GetThread((sleepingThreadIDs.top()).id);
+		const CCobThread* zzzThread = GetThread((sleepingThreadIDs.top()).id);
 
 		if (zzzThread == nullptr) {
 			sleepingThreadIDs.pop();
@@ -104,24 +286,11 @@ void CCobEngine::WakeSleepingThreads()
 			break;
 
 		// remove executing thread from the queue
+		wokenThreadIDs.push_back(zzzThread->GetID());
 		sleepingThreadIDs.pop();
-
-		// wake up the thread and tick it (if not dead)
-		// this can quite possibly re-add the thread to <sleepingThreadIDs>
-		// again, but any thread is guaranteed to sleep for at least 1 tick
-		switch (zzzThread->GetState()) {
-			case CCobThread::Sleep: {
-				zzzThread->SetState(CCobThread::Run);
-				TickThread(zzzThread);
-			} break;
-			case CCobThread::Dead: {
-				RemoveThread(zzzThread->GetID());
-			} break;
-			default: {
-				LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, zzzThread->GetState(), zzzThread->GetID());
-			} break;
-		}
 	}
+
+	TickThreads(wokenThreadIDs, true);
 }
 
 void CCobEngine::Tick(int deltaTime)
@@ -146,3 +315,37 @@ void CCobEngine::ShowScriptError(const std::string& msg)
 	LOG_L(L_ERROR, "[COBEngine::%s] \"%s\" outside script execution", __func__, msg.c_str());
 }
 
+
+
+void CCobEngine::SetOpcodeProfiling(bool enable)
+{
+	if (enable) {
+		opcodeCounts.fill(0);
+		profileOpcodes = true;
+		return;
+	}
+
+	if (!profileOpcodes)
+		return;
+
+	profileOpcodes = false;
+
+	std::array<int, COB_OP_COUNT> ops;
+	std::uint64_t total = 0;
+
+	for (int op = 0; op < COB_OP_COUNT; op++) {
+		ops[op] = op;
+		total += opcodeCounts[op];
+	}
+
+	std::sort(ops.begin(), ops.end(), [&](int a, int b) { return (opcodeCounts[a] > opcodeCounts[b]); });
+
+	LOG("[COBEngine::%s] %llu instructions executed", __func__, (unsigned long long) total);
+
+	for (const int op: ops) {
+		if (opcodeCounts[op] == 0)
+			break;
+
+		LOG("\t%-16s %12llu (%5.2f%%)", CCobFile::GetInsnName(op), (unsigned long long) opcodeCounts[op], (opcodeCounts[op] * 100.0) / total);
+	}
+}
@@ -8,8 +8,11 @@
  * It also manages reading and caching of the actual .cob files.
  */
 
+#include <array>
+#include <cstdint>
 #include <vector>
 
+#include "CobFile.h"
 #include "CobThread.h"
 #include "System/creg/creg_cond.h"
 #include "System/creg/STL_Queue.h"
@@ -19,6 +22,7 @@
 
 class CCobThread;
 class CCobInstance;
+class CUnitScript;
 class CCobFile;
 class CCobFileHandler;
 
@@ -37,10 +41,36 @@ private:
 	struct CCobThreadComp: public spring::binary_function<const SleepingThread&, const SleepingThread&, bool> {
 	public:
 		bool operator() (const SleepingThread& a, const SleepingThread& b) const {
-			return (a.wt > b.wt);
+			// ties are broken by ID so that the order in which threads wake up does not
+			// depend on the heap layout, i.e. on when other threads were (re)scheduled
+			return ((a.wt > b.wt) || (a.wt == b.wt && a.id > b.id));
 		}
 	};
 
+public:
+	/**
+	 * A change to state shared between script instances (the scheduler,
+	 * the thread registry, the unit script engine's list of animating
+	 * instances) requested by a thread
+	 */
+	struct DeferredCall {
+		enum {
+			CallScheduleRunning,
+			CallScheduleSleeping,
+			CallRemoveThread,
+			CallAddAnimating,
+			CallRemoveAnimating,
+		} type;
+
+		int threadID;
+		int wakeTime;
+
+		CUnitScript* script;
+	};
+
+	// minimum number of consecutive local threads that are worth ticking in parallel
+	static constexpr size_t MIN_PARALLEL_THREADS = 32;
+
 public:
 	void Init() {
 		threadInstances.reserve(2048);
@@ -69,6 +99,23 @@ public:
 	void Tick(int deltaTime);
 	void ShowScriptError(const std::string& msg);
 
+	/**
+	 * Records <call> if it is made by a thread that is being ticked in
+	 * parallel with others, and returns false (the caller should execute
+	 * it immediately) otherwise. Recorded calls are executed afterwards
+	 * in the order the threads making them would have been ticked in.
+	 */
+	bool DeferCall(const DeferredCall& call);
+
+	/**
+	 * Counts executed instructions per CobInsnOp while enabled; disabling
+	 * logs the counts collected since profiling was enabled (/DebugCOB).
+	 */
+	void SetOpcodeProfiling(bool enable);
+	bool GetOpcodeProfiling() const { return profileOpcodes; }
+
+	std::uint64_t* GetOpcodeCounts() { return (profileOpcodes? opcodeCounts.data(): nullptr); }
+
 
 	CCobThread* GetThread(int threadID) {
 		const auto it = threadInstances.find(threadID);
@@ -110,14 +157,19 @@ public:
 	void SanityCheckThreads(const CCobInstance* owner);
 
 private:
-	void TickThread(CCobThread* thread);
+	void RunCall(const DeferredCall& call);
+	void RemoveTickedThread(int threadID);
+
+	bool IsLocalThread(int threadID, bool woken);
+
+	void TickThread(int threadID, bool woken);
+	void TickLocalThreads(const int* threadIDs, size_t numThreads, bool woken);
+	void TickThreads(const std::vector<int>& threadIDs, bool woken);
 
 	void WakeSleepingThreads();
 	void TickRunningThreads() {
 		// advance all currently running threads
-		for (const int threadID: runningThreadIDs) {
-			TickThread(GetThread(threadID));
-		}
+		TickThreads(runningThreadIDs, false);
 
 		// a thread can never go from running->running, so clear the list
 		// note: if preemption was to be added, this would no longer hold
@@ -142,10 +194,18 @@ private:
 	// for validity; thread owner might get removed while a thread is sleeping
 	std::priority_queue<SleepingThread, std::vector<SleepingThread>, CCobThreadComp> sleepingThreadIDs;
 
-	CCobThread* curThread = nullptr;
+	// scratch buffers for WakeSleepingThreads and TickLocalThreads
+	std::vector<int> wokenThreadIDs;
+	std::vector<std::pair<const CCobInstance*, size_t>> localThreads;
+	std::vector<size_t> localThreadGroups;
+	std::vector<std::vector<DeferredCall>> deferredCalls;
 
 	int currentTime = 0;
 	int threadCounter = 0;
+
+	std::array<std::uint64_t, COB_OP_COUNT> opcodeCounts;
+
+	bool profileOpcodes = false;
 };
 
 
@@ -3,6 +3,7 @@
 
 #include "Sim/Misc/GlobalConstants.h"
 #include "CobFile.h"
+#include "UnitScript.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Sound/ISound.h"
@@ -85,6 +86,87 @@ do {									\
 static std::vector<uint8_t> cobFileData;
 
 
+// Command documentation from http://visualta.tauniverse.com/Downloads/cob-commands.txt
+// And some information from basm0.8 source (basm ops.txt)
+
+// Model interaction
+constexpr int MOVE       = 0x10001000;
+constexpr int TURN       = 0x10002000;
+constexpr int SPIN       = 0x10003000;
+constexpr int STOP_SPIN  = 0x10004000;
+constexpr int SHOW       = 0x10005000;
+constexpr int HIDE       = 0x10006000;
+constexpr int CACHE      = 0x10007000;
+constexpr int DONT_CACHE = 0x10008000;
+constexpr int MOVE_NOW   = 0x1000B000;
+constexpr int TURN_NOW   = 0x1000C000;
+constexpr int SHADE      = 0x1000D000;
+constexpr int DONT_SHADE = 0x1000E000;
+constexpr int EMIT_SFX   = 0x1000F000;
+
+// Blocking operations
+constexpr int WAIT_TURN  = 0x10011000;
+constexpr int WAIT_MOVE  = 0x10012000;
+constexpr int SLEEP      = 0x10013000;
+
+// Stack manipulation
+constexpr int PUSH_CONSTANT    = 0x10021001;
+constexpr int PUSH_LOCAL_VAR   = 0x10021002;
+constexpr int PUSH_STATIC      = 0x10021004;
+constexpr int CREATE_LOCAL_VAR = 0x10022000;
+constexpr int POP_LOCAL_VAR    = 0x10023002;
+constexpr int POP_STATIC       = 0x10023004;
+constexpr int POP_STACK        = 0x10024000; ///< Not sure what this is supposed to do
+
+// Arithmetic operations
+constexpr int ADD         = 0x10031000;
+constexpr int SUB         = 0x10032000;
+constexpr int MUL         = 0x10033000;
+constexpr int DIV         = 0x10034000;
+constexpr int MOD		  = 0x10034001; ///< spring specific
+constexpr int BITWISE_AND = 0x10035000;
+constexpr int BITWISE_OR  = 0x10036000;
+constexpr int BITWISE_XOR = 0x10037000;
+constexpr int BITWISE_NOT = 0x10038000;
+
+// Native function calls
+constexpr int RAND           = 0x10041000;
+constexpr int GET_UNIT_VALUE = 0x10042000;
+constexpr int GET            = 0x10043000;
+
+// Comparison
+constexpr int SET_LESS             = 0x10051000;
+constexpr int SET_LESS_OR_EQUAL    = 0x10052000;
+constexpr int SET_GREATER          = 0x10053000;
+constexpr int SET_GREATER_OR_EQUAL = 0x10054000;
+constexpr int SET_EQUAL            = 0x10055000;
+constexpr int SET_NOT_EQUAL        = 0x10056000;
+constexpr int LOGICAL_AND          = 0x10057000;
+constexpr int LOGICAL_OR           = 0x10058000;
+constexpr int LOGICAL_XOR          = 0x10059000;
+constexpr int LOGICAL_NOT          = 0x1005A000;
+
+// Flow control
+constexpr int START           = 0x10061000;
+constexpr int CALL            = 0x10062000; ///< converted when executed
+constexpr int REAL_CALL       = 0x10062001; ///< spring custom
+constexpr int LUA_CALL        = 0x10062002; ///< spring custom
+constexpr int JUMP            = 0x10064000;
+constexpr int RETURN          = 0x10065000;
+constexpr int JUMP_NOT_EQUAL  = 0x10066000;
+constexpr int SIGNAL          = 0x10067000;
+constexpr int SET_SIGNAL_MASK = 0x10068000;
+
+// Piece destruction
+constexpr int EXPLODE    = 0x10071000;
+constexpr int PLAY_SOUND = 0x10072000;
+
+// Special functions
+constexpr int SET    = 0x10082000;
+constexpr int ATTACH = 0x10083000;
+constexpr int DROP   = 0x10084000;
+
+
 CCobFile::CCobFile(CFileHandler& in, const std::string& scriptName)
 {
 	name.assign(scriptName);
@@ -196,6 +278,317 @@ CCobFile::CCobFile(CFileHandler& in, const std::string& scriptName)
 
 		scriptIndex[pair.second] = fn;
 	}
+
+	DecodeCode();
+}
+
+
+void CCobFile::DecodeCode()
+{
+	fireScripts.clear();
+	fireScripts.resize(scriptNames.size(), false);
+
+	for (int i = 0; i < MAX_WEAPONS_PER_UNIT; ++i) {
+		const int fn = scriptIndex[COBFN_FirePrimary + COBFN_Weapon_Funcs * i];
+
+		if (fn >= 0)
+			fireScripts[fn] = true;
+	}
+
+	const int numWords = code.size();
+	const int numFuncs = scriptNames.size();
+
+	// jumps out of the code land on the sentinel, like running off its end does
+	const auto CodeOffset = [&](int ofs) { return ((ofs >= 0 && ofs < numWords)? ofs: numWords); };
+
+	insns.clear();
+	insns.resize(numWords + 1);
+
+	// decode at every word rather than only along the instruction stream, so that
+	// arbitrary (e.g. misaligned) jump targets behave exactly as they did in the
+	// raw interpreter
+	for (int i = 0; i < numWords; ++i) {
+		SCobInstruction& insn = insns[i];
+
+		int numArgs = 0;
+
+		switch (code[i]) {
+			case MOVE                : { insn.op = COB_OP_MOVE                ; numArgs = 2; } break;
+			case TURN                : { insn.op = COB_OP_TURN                ; numArgs = 2; } break;
+			case SPIN                : { insn.op = COB_OP_SPIN                ; numArgs = 2; } break;
+			case STOP_SPIN           : { insn.op = COB_OP_STOP_SPIN           ; numArgs = 2; } break;
+			case SHOW                : { insn.op = COB_OP_SHOW                ; numArgs = 1; } break;
+			case HIDE                : { insn.op = COB_OP_HIDE                ; numArgs = 1; } break;
+			case CACHE               : { insn.op = COB_OP_NOP                 ; numArgs = 1; } break;
+			case DONT_CACHE          : { insn.op = COB_OP_NOP                 ; numArgs = 1; } break;
+			case MOVE_NOW            : { insn.op = COB_OP_MOVE_NOW            ; numArgs = 2; } break;
+			case TURN_NOW            : { insn.op = COB_OP_TURN_NOW            ; numArgs = 2; } break;
+			case SHADE               : { insn.op = COB_OP_NOP                 ; numArgs = 1; } break;
+			case DONT_SHADE          : { insn.op = COB_OP_NOP                 ; numArgs = 1; } break;
+			case EMIT_SFX            : { insn.op = COB_OP_EMIT_SFX            ; numArgs = 1; } break;
+
+			case WAIT_TURN           : { insn.op = COB_OP_WAIT_TURN           ; numArgs = 2; } break;
+			case WAIT_MOVE           : { insn.op = COB_OP_WAIT_MOVE           ; numArgs = 2; } break;
+			case SLEEP               : { insn.op = COB_OP_SLEEP               ; numArgs = 0; } break;
+
+			case PUSH_CONSTANT       : { insn.op = COB_OP_PUSH_CONSTANT       ; numArgs = 1; } break;
+			case PUSH_LOCAL_VAR      : { insn.op = COB_OP_PUSH_LOCAL_VAR      ; numArgs = 1; } break;
+			case PUSH_STATIC         : { insn.op = COB_OP_PUSH_STATIC         ; numArgs = 1; } break;
+			case CREATE_LOCAL_VAR    : { insn.op = COB_OP_CREATE_LOCAL_VAR    ; numArgs = 0; } break;
+			case POP_LOCAL_VAR       : { insn.op = COB_OP_POP_LOCAL_VAR       ; numArgs = 1; } break;
+			case POP_STATIC          : { insn.op = COB_OP_POP_STATIC          ; numArgs = 1; } break;
+			case POP_STACK           : { insn.op = COB_OP_POP_STACK           ; numArgs = 0; } break;
+
+			case ADD                 : { insn.op = COB_OP_ADD                 ; numArgs = 0; } break;
+			case SUB                 : { insn.op = COB_OP_SUB                 ; numArgs = 0; } break;
+			case MUL                 : { insn.op = COB_OP_MUL                 ; numArgs = 0; } break;
+			case DIV                 : { insn.op = COB_OP_DIV                 ; numArgs = 0; } break;
+			case MOD                 : { insn.op = COB_OP_MOD                 ; numArgs = 0; } break;
+			case BITWISE_AND         : { insn.op = COB_OP_BITWISE_AND         ; numArgs = 0; } break;
+			case BITWISE_OR          : { insn.op = COB_OP_BITWISE_OR          ; numArgs = 0; } break;
+			case BITWISE_XOR         : { insn.op = COB_OP_BITWISE_XOR         ; numArgs = 0; } break;
+			case BITWISE_NOT         : { insn.op = COB_OP_BITWISE_NOT         ; numArgs = 0; } break;
+
+			case RAND                : { insn.op = COB_OP_RAND                ; numArgs = 0; } break;
+			case GET_UNIT_VALUE      : { insn.op = COB_OP_GET_UNIT_VALUE      ; numArgs = 0; } break;
+			case GET                 : { insn.op = COB_OP_GET                 ; numArgs = 0; } break;
+
+			case SET_LESS            : { insn.op = COB_OP_SET_LESS            ; numArgs = 0; } break;
+			case SET_LESS_OR_EQUAL   : { insn.op = COB_OP_SET_LESS_OR_EQUAL   ; numArgs = 0; } break;
+			case SET_GREATER         : { insn.op = COB_OP_SET_GREATER         ; numArgs = 0; } break;
+			case SET_GREATER_OR_EQUAL: { insn.op = COB_OP_SET_GREATER_OR_EQUAL; numArgs = 0; } break;
+			case SET_EQUAL           : { insn.op = COB_OP_SET_EQUAL           ; numArgs = 0; } break;
+			case SET_NOT_EQUAL       : { insn.op = COB_OP_SET_NOT_EQUAL       ; numArgs = 0; } break;
+			case LOGICAL_AND         : { insn.op = COB_OP_LOGICAL_AND         ; numArgs = 0; } break;
+			case LOGICAL_OR          : { insn.op = COB_OP_LOGICAL_OR          ; numArgs = 0; } break;
+			case LOGICAL_XOR         : { insn.op = COB_OP_LOGICAL_XOR         ; numArgs = 0; } break;
+			case LOGICAL_NOT         : { insn.op = COB_OP_LOGICAL_NOT         ; numArgs = 0; } break;
+
+			case START               : { insn.op = COB_OP_START               ; numArgs = 2; } break;
+			case CALL                : { insn.op = COB_OP_CALL                ; numArgs = 2; } break;
+			case REAL_CALL           : { insn.op = COB_OP_CALL                ; numArgs = 2; } break;
+			case LUA_CALL            : { insn.op = COB_OP_LUA_CALL            ; numArgs = 2; } break;
+			case JUMP                : { insn.op = COB_OP_JUMP                ; numArgs = 1; } break;
+			case RETURN              : { insn.op = COB_OP_RETURN              ; numArgs = 0; } break;
+			case JUMP_NOT_EQUAL      : { insn.op = COB_OP_JUMP_NOT_EQUAL      ; numArgs = 1; } break;
+			case SIGNAL              : { insn.op = COB_OP_SIGNAL              ; numArgs = 0; } break;
+			case SET_SIGNAL_MASK     : { insn.op = COB_OP_SET_SIGNAL_MASK     ; numArgs = 0; } break;
+
+			case EXPLODE             : { insn.op = COB_OP_EXPLODE             ; numArgs = 1; } break;
+			case PLAY_SOUND          : { insn.op = COB_OP_PLAY_SOUND          ; numArgs = 1; } break;
+
+			case SET                 : { insn.op = COB_OP_SET                 ; numArgs = 0; } break;
+			case ATTACH              : { insn.op = COB_OP_ATTACH              ; numArgs = 0; } break;
+			case DROP                : { insn.op = COB_OP_DROP                ; numArgs = 0; } break;
+
+			default                  : { insn.op = COB_OP_UNKNOWN             ; numArgs = 0; } break;
+		}
+
+		insn.len = 1 + numArgs;
+
+		if ((i + insn.len) > numWords) {
+			insn.op = COB_OP_OUT_OF_CODE;
+			continue;
+		}
+
+		for (int j = 0; j < numArgs; ++j) {
+			insn.arg[j] = code[i + 1 + j];
+		}
+
+		switch (insn.op) {
+			case COB_OP_CALL: {
+				const int fn = insn.arg[0];
+
+				if (fn < 0 || fn >= numFuncs) {
+					insn.op = COB_OP_UNKNOWN;
+					break;
+				}
+
+				// calls to lua_* functions go to LuaRules
+				if (scriptNames[fn].find("lua_") == 0) {
+					insn.op = COB_OP_LUA_CALL;
+					break;
+				}
+
+				// do not call zero-length functions
+				if (scriptLengths[fn] == 0) {
+					insn.op = COB_OP_NOP;
+					break;
+				}
+
+				insn.arg[2] = CodeOffset(scriptOffsets[fn]);
+			} break;
+			case COB_OP_START: {
+				const int fn = insn.arg[0];
+
+				if (fn < 0 || fn >= numFuncs) {
+					insn.op = COB_OP_UNKNOWN;
+					break;
+				}
+
+				if (scriptLengths[fn] == 0)
+					insn.op = COB_OP_NOP;
+			} break;
+			case COB_OP_JUMP:
+			case COB_OP_JUMP_NOT_EQUAL: {
+				insn.arg[0] = CodeOffset(insn.arg[0]);
+			} break;
+			default: {
+			} break;
+		}
+	}
+
+	insns[numWords].op = COB_OP_OUT_OF_CODE;
+	insns[numWords].len = 0;
+
+	FindLocalScripts();
+}
+
+
+void CCobFile::FindLocalScripts()
+{
+	const int numWords = code.size();
+	const int numFuncs = scriptNames.size();
+
+	std::vector<int> callees;
+	std::vector<int> calleeOffsets(numFuncs + 1, 0);
+	std::vector<bool> boundaries;
+
+	localScripts.clear();
+	localScripts.resize(numFuncs, false);
+
+	for (int fn = 0; fn < numFuncs; ++fn) {
+		const int beg = scriptOffsets[fn];
+		const int end = beg + scriptLengths[fn];
+
+		calleeOffsets[fn] = callees.size();
+
+		if (scriptLengths[fn] <= 0 || beg < 0 || end > numWords)
+			continue;
+
+		boundaries.clear();
+		boundaries.resize(end - beg, false);
+
+		bool local = true;
+		int last = COB_OP_UNKNOWN;
+
+		// walk the function linearly; anything that could make the thread leave
+		// it (other than a CALL to a local function) makes it non-local
+		for (int i = beg, prev = -1; i < end && local; prev = i, i += insns[i].len) {
+			const SCobInstruction& insn = insns[i];
+
+			boundaries[i - beg] = true;
+			last = insn.op;
+
+			switch (insn.op) {
+				case COB_OP_MOVE: case COB_OP_TURN: case COB_OP_SPIN: case COB_OP_STOP_SPIN:
+				case COB_OP_HIDE: case COB_OP_MOVE_NOW: case COB_OP_TURN_NOW:
+				case COB_OP_WAIT_TURN: case COB_OP_WAIT_MOVE: case COB_OP_SLEEP:
+				case COB_OP_PUSH_CONSTANT: case COB_OP_PUSH_LOCAL_VAR: case COB_OP_PUSH_STATIC:
+				case COB_OP_CREATE_LOCAL_VAR: case COB_OP_POP_LOCAL_VAR: case COB_OP_POP_STATIC: case COB_OP_POP_STACK:
+				case COB_OP_ADD: case COB_OP_SUB: case COB_OP_MUL: case COB_OP_DIV: case COB_OP_MOD:
+				case COB_OP_BITWISE_AND: case COB_OP_BITWISE_OR: case COB_OP_BITWISE_XOR: case COB_OP_BITWISE_NOT:
+				case COB_OP_SET_LESS: case COB_OP_SET_LESS_OR_EQUAL: case COB_OP_SET_GREATER: case COB_OP_SET_GREATER_OR_EQUAL:
+				case COB_OP_SET_EQUAL: case COB_OP_SET_NOT_EQUAL:
+				case COB_OP_LOGICAL_AND: case COB_OP_LOGICAL_OR: case COB_OP_LOGICAL_XOR: case COB_OP_LOGICAL_NOT:
+				case COB_OP_RETURN: case COB_OP_SIGNAL: case COB_OP_SET_SIGNAL_MASK: case COB_OP_NOP: {
+				} break;
+
+				// fire-scripts show flares, which spawn projectiles
+				case COB_OP_SHOW: {
+					local = !fireScripts[fn];
+				} break;
+
+				case COB_OP_GET_UNIT_VALUE: {
+					// the value has to be a constant pushed right before, that no jump can bypass
+					local = (prev >= 0 && insns[prev].op == COB_OP_PUSH_CONSTANT && CUnitScript::IsLocalUnitVal(insns[prev].arg[0]));
+				} break;
+
+				case COB_OP_JUMP:
+				case COB_OP_JUMP_NOT_EQUAL: {
+					local = (insn.arg[0] >= beg && insn.arg[0] < end);
+				} break;
+
+				case COB_OP_CALL: {
+					callees.push_back(insn.arg[0]);
+				} break;
+
+				default: {
+					local = false;
+				} break;
+			}
+
+			// instruction extends past the end of the function
+			local &= ((i + insn.len) <= end);
+		}
+
+		// threads must not be able to run off the end into the next function
+		local &= (last == COB_OP_RETURN || last == COB_OP_JUMP);
+
+		for (int i = beg; i < end && local; i += insns[i].len) {
+			const SCobInstruction& insn = insns[i];
+
+			switch (insn.op) {
+				case COB_OP_JUMP:
+				case COB_OP_JUMP_NOT_EQUAL: {
+					local = boundaries[insn.arg[0] - beg];
+				} break;
+				case COB_OP_GET_UNIT_VALUE: {
+					// the pushed constant is only known when entering from the instruction before
+					for (int j = beg; j < end && local; j += insns[j].len) {
+						const int op = insns[j].op;
+
+						if (op == COB_OP_JUMP || op == COB_OP_JUMP_NOT_EQUAL)
+							local = (insns[j].arg[0] != i);
+					}
+				} break;
+				default: {
+				} break;
+			}
+		}
+
+		localScripts[fn] = local;
+	}
+
+	calleeOffsets[numFuncs] = callees.size();
+
+	// a function is only local if everything it calls is, iterate until stable
+	for (bool changed = true; changed; ) {
+		changed = false;
+
+		for (int fn = 0; fn < numFuncs; ++fn) {
+			if (!localScripts[fn])
+				continue;
+
+			for (int i = calleeOffsets[fn]; i < calleeOffsets[fn + 1]; ++i) {
+				if (localScripts[callees[i]])
+					continue;
+
+				localScripts[fn] = false;
+				changed = true;
+				break;
+			}
+		}
+	}
+}
+
+
+const char* CCobFile::GetInsnName(int op)
+{
+	constexpr const char* names[COB_OP_COUNT] = {
+		"move", "turn", "spin", "stop-spin", "show", "hide", "move-now", "turn-now", "sfx",
+		"wait-for-turn", "wait-for-move", "sleep",
+		"pushc", "pushl", "pushs", "clv", "popl", "pops", "pop-stack",
+		"add", "sub", "mul", "div", "mod", "and", "or", "xor", "not",
+		"rand", "getuv", "get",
+		"setl", "setle", "setg", "setge", "sete", "setne", "land", "lor", "lxor", "neg",
+		"start", "call", "lua_call", "jmp", "return", "jne", "signal", "mask",
+		"explode", "play-sound",
+		"set", "attach", "drop",
+		"nop", "out-of-code", "unknown",
+	};
+
+	return ((op >= 0 && op < COB_OP_COUNT)? names[op]: "invalid");
 }
 
 
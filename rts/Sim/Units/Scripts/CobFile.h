@@ -13,6 +13,83 @@
 
 class CFileHandler;
 
+/// dense opcodes of pre-decoded instructions, dispatched on by CCobThread::Tick
+enum CobInsnOp {
+	COB_OP_MOVE,
+	COB_OP_TURN,
+	COB_OP_SPIN,
+	COB_OP_STOP_SPIN,
+	COB_OP_SHOW,
+	COB_OP_HIDE,
+	COB_OP_MOVE_NOW,
+	COB_OP_TURN_NOW,
+	COB_OP_EMIT_SFX,
+
+	COB_OP_WAIT_TURN,
+	COB_OP_WAIT_MOVE,
+	COB_OP_SLEEP,
+
+	COB_OP_PUSH_CONSTANT,
+	COB_OP_PUSH_LOCAL_VAR,
+	COB_OP_PUSH_STATIC,
+	COB_OP_CREATE_LOCAL_VAR,
+	COB_OP_POP_LOCAL_VAR,
+	COB_OP_POP_STATIC,
+	COB_OP_POP_STACK,
+
+	COB_OP_ADD,
+	COB_OP_SUB,
+	COB_OP_MUL,
+	COB_OP_DIV,
+	COB_OP_MOD,
+	COB_OP_BITWISE_AND,
+	COB_OP_BITWISE_OR,
+	COB_OP_BITWISE_XOR,
+	COB_OP_BITWISE_NOT,
+
+	COB_OP_RAND,
+	COB_OP_GET_UNIT_VALUE,
+	COB_OP_GET,
+
+	COB_OP_SET_LESS,
+	COB_OP_SET_LESS_OR_EQUAL,
+	COB_OP_SET_GREATER,
+	COB_OP_SET_GREATER_OR_EQUAL,
+	COB_OP_SET_EQUAL,
+	COB_OP_SET_NOT_EQUAL,
+	COB_OP_LOGICAL_AND,
+	COB_OP_LOGICAL_OR,
+	COB_OP_LOGICAL_XOR,
+	COB_OP_LOGICAL_NOT,
+
+	COB_OP_START,
+	COB_OP_CALL,
+	COB_OP_LUA_CALL,
+	COB_OP_JUMP,
+	COB_OP_RETURN,
+	COB_OP_JUMP_NOT_EQUAL,
+	COB_OP_SIGNAL,
+	COB_OP_SET_SIGNAL_MASK,
+
+	COB_OP_EXPLODE,
+	COB_OP_PLAY_SOUND,
+
+	COB_OP_SET,
+	COB_OP_ATTACH,
+	COB_OP_DROP,
+
+	COB_OP_NOP,         ///< (dont-)cache, (dont-)shade, calls and starts of zero-length functions
+	COB_OP_OUT_OF_CODE, ///< instruction (or its operands) extends past the end of the code
+	COB_OP_UNKNOWN,     ///< unknown opcode or invalid function index
+	COB_OP_COUNT
+};
+
+struct SCobInstruction {
+	int op;  ///< CobInsnOp
+	int len; ///< number of code words, used to advance the program counter
+	int arg[3];
+};
+
 class CCobFile
 {
 public:
@@ -29,6 +106,9 @@ public:
 		scriptLengths = std::move(f.scriptLengths);
 		pieceNames = std::move(f.pieceNames);
 		scriptIndex = std::move(f.scriptIndex);
+		fireScripts = std::move(f.fireScripts);
+		insns = std::move(f.insns);
+		localScripts = std::move(f.localScripts);
 		sounds = std::move(f.sounds);
 		luaScripts = std::move(f.luaScripts);
 		scriptMap = std::move(f.scriptMap);
@@ -39,6 +119,12 @@ public:
 
 	int GetFunctionId(const std::string& name);
 
+	static const char* GetInsnName(int op);
+
+private:
+	void DecodeCode();
+	void FindLocalScripts();
+
 public:
 	int numStaticVars = 0;
 
@@ -49,6 +135,20 @@ public:
 	std::vector<int> scriptLengths;
 	std::vector<std::string> pieceNames;
 	std::array<int, COBFN_NumUnitFuncs> scriptIndex;
+	/// per function: true if it is one of the Fire<Weapon> scripts
+	std::vector<bool> fireScripts;
+	/**
+	 * <code> decoded once at load; insns[i] is the instruction starting at
+	 * word i (jump targets and program counters stay code offsets), plus a
+	 * COB_OP_OUT_OF_CODE sentinel at insns[code.size()]
+	 */
+	std::vector<SCobInstruction> insns;
+	/**
+	 * per function: true if it (and everything it calls) only touches its
+	 * own instance's pieces, animations, static vars and threads, which is
+	 * what CCobEngine needs to tick threads of different units in parallel
+	 */
+	std::vector<bool> localScripts;
 	std::vector<int> sounds;
 	std::vector<LuaHashString> luaScripts;
 	spring::unordered_map<std::string, int> scriptMap;
@@ -89,6 +89,12 @@ public:
 		return ((state == WaitMove && type == CCobInstance::AMove) || (state == WaitTurn && type == CCobInstance::ATurn));
 	}
 
+	/**
+	 * True if every function on the call stack only touches this thread's
+	 * own instance (see CCobFile::localScripts) until the thread has to
+	 * wait or dies, i.e. it can be ticked alongside any other instance's.
+	 */
+	bool IsLocal() const;
 	bool IsDead() const { return (state == Dead); }
 	bool IsGarbage() const { return (cobInst == nullptr); }
 	bool IsWaiting() const { return (waitAxis != -1); }
@@ -105,7 +111,7 @@ protected:
 		int stackTop = -1;
 	};
 
-	void LuaCall();
+	void LuaCall(int scriptID, int argCount);
 
 	bool PushCallStack(CallInfo v) { return (callStackSize < callStack.size() && PushCallStackRaw(v)); }
 	bool PushDataStack(     int v) { return (dataStackSize < dataStack.size() && PushDataStackRaw(v)); }
@@ -58,6 +58,7 @@ void CLuaUnitScriptNames::InitScriptNames()
 	scriptNames[LUAFN_Shot]          = "Shot";
 	scriptNames[LUAFN_BlockShot]     = "BlockShot";
 	scriptNames[LUAFN_TargetWeight]  = "TargetWeight";
+	scriptNames[LUAFN_QueryWeapons]  = "QueryWeapons";
 
 
 	scriptMap.reserve(scriptNames.size());
@@ -54,6 +54,7 @@ enum {
 	LUAFN_Shot,          // ( ) -> nil
 	LUAFN_BlockShot,     // ( targetUnitID, haveUserTarget ) -> boolean
 	LUAFN_TargetWeight,  // ( targetUnitID ) -> number targetWeight
+	LUAFN_QueryWeapons,  // ( ) -> table muzzlePieces, table aimFromPieces | nil
 
 	LUAFN_Last,
 };
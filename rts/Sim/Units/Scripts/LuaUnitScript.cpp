@@ -130,12 +130,21 @@ callIn notes:
 - AimWeapon for a shield (plasma repulser) takes no arguments instead of 0,0
 - Shot takes no arguments instead of 0
 - new callins MoveFinished and TurnFinished, see below
+- new callin QueryWeapons, see below
 
 
 docs for callins defined in this file:
 
   TODO: document other callins properly
 
+QueryWeapons() -> table muzzlePieces, table aimFromPieces | nil
+	Optional, called once per unit before its weapons are slow-updated.
+	Both tables map weapon numbers to pieces; the pieces found in them
+	replace the QueryWeapon and AimFromWeapon calls those slow-updates
+	would make, weapons missing from a table still get QueryWeapon or
+	AimFromWeapon called. Outside the slow-updates (e.g. after a Shot)
+	QueryWeapon and AimFromWeapon are called as before.
+
 TurnFinished(number piece, number axis)
 	Called after a turn finished for this unit/piece/axis (not a turn-now!)
 	Should resume coroutine of the particular thread which called the Lua
@@ -434,6 +443,40 @@ inline bool CLuaUnitScript::PopBoolean(int fn, bool def)
 }
 
 
+bool CLuaUnitScript::PopPieceTable(int fn, std::vector<int>& pieces)
+{
+	pieces.clear();
+	pieces.resize(unit->weapons.size(), NO_QUERIED_PIECE);
+
+	if (lua_isnoneornil(L, -1)) {
+		lua_pop(L, 1);
+		return true;
+	}
+
+	if (!lua_istable(L, -1)) {
+		const std::string& fname = CLuaUnitScriptNames::GetScriptName(fn);
+
+		LOG_L(L_ERROR, "%s: bad return value, expected table or nil", fname.c_str());
+		RemoveCallIn(fname);
+
+		lua_pop(L, 1);
+		return false;
+	}
+
+	for (size_t weaponNum = 0; weaponNum < pieces.size(); weaponNum++) {
+		lua_rawgeti(L, -1, weaponNum + LUA_WEAPON_BASE_INDEX);
+
+		if (lua_israwnumber(L, -1))
+			pieces[weaponNum] = lua_toint(L, -1) - 1;
+
+		lua_pop(L, 1);
+	}
+
+	lua_pop(L, 1);
+	return true;
+}
+
+
 inline void CLuaUnitScript::RawPushFunction(int functionId)
 {
 	// Push Lua function on the stack
@@ -788,8 +831,42 @@ int CLuaUnitScript::QueryBuildInfo()
 }
 
 
+void CLuaUnitScript::BeginWeaponSlowUpdates()
+{
+	const int fn = LUAFN_QueryWeapons;
+
+	if (!HasFunction(fn))
+		return;
+
+	LUA_CALL_IN_CHECK(L);
+	lua_checkstack(L, 3);
+
+	PushFunction(fn);
+
+	if (!RunCallIn(fn, 0, 2))
+		return;
+
+	// aimFrom table is on top
+	if (!PopPieceTable(fn, queriedAimFromPieces)) {
+		lua_pop(L, 1);
+		return;
+	}
+
+	haveQueriedPieces = PopPieceTable(fn, queriedMuzzlePieces);
+}
+
+
+void CLuaUnitScript::EndWeaponSlowUpdates()
+{
+	haveQueriedPieces = false;
+}
+
+
 int CLuaUnitScript::QueryWeapon(int weaponNum)
 {
+	if (haveQueriedPieces && queriedMuzzlePieces[weaponNum] != NO_QUERIED_PIECE)
+		return queriedMuzzlePieces[weaponNum];
+
 	return RunQueryCallIn(LUAFN_QueryWeapon, weaponNum + LUA_WEAPON_BASE_INDEX);
 }
 
@@ -808,6 +885,9 @@ void  CLuaUnitScript::AimShieldWeapon(CPlasmaRepulser* weapon)
 
 int CLuaUnitScript::AimFromWeapon(int weaponNum)
 {
+	if (haveQueriedPieces && queriedAimFromPieces[weaponNum] != NO_QUERIED_PIECE)
+		return queriedAimFromPieces[weaponNum];
+
 	return RunQueryCallIn(LUAFN_AimFromWeapon, weaponNum + LUA_WEAPON_BASE_INDEX);
 }
 
@@ -36,6 +36,15 @@ private:
 	// used to enforce SetDeathScriptFinished can only be used inside Killed
 	bool inKilled = false;
 
+	// per weapon, pieces returned by QueryWeapons for the current weapon
+	// slow-updates or NO_QUERIED_PIECE if QueryWeapon should be called
+	std::vector<int> queriedMuzzlePieces;
+	std::vector<int> queriedAimFromPieces;
+
+	bool haveQueriedPieces = false;
+
+	static constexpr int NO_QUERIED_PIECE = -2;
+
 public:
 	// for creg use only
 	CLuaUnitScript() : CUnitScript(nullptr) {}
@@ -57,6 +66,7 @@ protected:
 
 	float PopNumber(int fn, float def);
 	bool PopBoolean(int fn, bool def);
+	bool PopPieceTable(int fn, std::vector<int>& pieces);
 
 	int  RunQueryCallIn(int fn);
 	int  RunQueryCallIn(int fn, float arg1);
@@ -82,6 +92,9 @@ public:
 	bool HasBlockShot(int weaponNum) const override;
 	bool HasTargetWeight(int weaponNum) const override;
 
+	void BeginWeaponSlowUpdates() override;
+	void EndWeaponSlowUpdates() override;
+
 	// callins, called throughout sim
 	void RawCall(int functionId) override;
 	void Create() override;
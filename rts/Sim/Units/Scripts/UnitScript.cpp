@@ -53,6 +53,8 @@ CR_REG_METADATA(CUnitScript, (
 	CR_MEMBER(unit),
 	CR_MEMBER(busy),
 	CR_MEMBER(anims),
+	// always empty between frames
+	CR_IGNORED(doneAnims),
 
 	//Populated by children
 	CR_IGNORED(pieces),
@@ -86,7 +88,7 @@ CUnitScript::CUnitScript(CUnit* unit)
 CUnitScript::~CUnitScript()
 {
 	// Remove us from possible animation ticking
-	if (!HaveAnimations())
+	if (!HaveAnimations() && !HaveFinishedAnimations())
 		return;
 
 	unitScriptEngine->RemoveInstance(this);
@@ -193,23 +195,28 @@ void CUnitScript::TickAnims(int tickRate, const TickAnimFunc& tickAnimFunc, Anim
 
 /**
  * @brief Called by the engine when we are registered as animating.
-          If we return false there are no active animations left.
+          Finished animations are only collected here, TickAnimFinished
+          notifies their listeners afterwards.
  * @param deltaTime int delta time to update
- * @return true if there are still active animations
  */
-bool CUnitScript::Tick(int deltaTime)
+void CUnitScript::TickAnimations(int deltaTime)
 {
-	// vector of indexes of finished animations,
-	// so we can get rid of them in constant time
-	static AnimContainerType doneAnims[AMove + 1];
 	// tick-functions; these never change address
 	static constexpr TickAnimFunc tickAnimFuncs[AMove + 1] = {&CUnitScript::TickTurnAnim, &CUnitScript::TickSpinAnim, &CUnitScript::TickMoveAnim};
 
 	for (int animType = ATurn; animType <= AMove; animType++) {
 		TickAnims(1000 / deltaTime, tickAnimFuncs[animType], anims[animType], doneAnims[animType]);
 	}
+}
 
-	// Tell listeners to unblock, and remove finished animations from the unit/script.
+/**
+ * @brief Called by the engine after TickAnimations.
+          If we return false there are no active animations left.
+ * @return true if there are still active animations
+ */
+bool CUnitScript::TickAnimFinished()
+{
+	// Tell listeners to unblock; the finished animations were already removed
 	for (int animType = ATurn; animType <= AMove; animType++) {
 		for (AnimInfo& ai: doneAnims[animType]) {
 			AnimFinished((AnimType) animType, ai.piece, ai.axis);
@@ -246,8 +253,9 @@ void CUnitScript::RemoveAnim(AnimType type, const AnimContainerTypeIt& animInfoI
 	anims[type].pop_back();
 
 	// If this was the last animation, remove from currently animating list
+	// (unless TickAnimFinished still has to notify listeners of finished ones)
 	// FIXME: this could be done in a cleaner way
-	if (HaveAnimations())
+	if (HaveAnimations() || HaveFinishedAnimations())
 		return;
 
 	unitScriptEngine->RemoveInstance(this);
@@ -779,6 +787,27 @@ void CUnitScript::ShowFlare(int piece)
 
 
 /******************************************************************************/
+bool CUnitScript::IsLocalUnitVal(int val)
+{
+	switch (val) {
+		case ACTIVATION        : return true;
+		case STANDINGMOVEORDERS: return true;
+		case STANDINGFIREORDERS: return true;
+		case HEALTH            : return true;
+		case INBUILDSTANCE     : return true;
+		case BUSY              : return true;
+		case BUILD_PERCENT_LEFT: return true;
+		case YARD_OPEN         : return true;
+		case ARMORED           : return true;
+		case IN_WATER          : return true;
+		case CURRENT_SPEED     : return true;
+		case MY_ID             : return true;
+		default                : break;
+	}
+
+	return false;
+}
+
 int CUnitScript::GetUnitVal(int val, int p1, int p2, int p3, int p4)
 {
 	// may happen in case one uses Spring.GetUnitCOBValue (Lua) on a unit with CNullUnitScript
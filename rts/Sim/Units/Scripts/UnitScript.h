@@ -43,6 +43,8 @@ protected:
 	typedef bool(CUnitScript::*TickAnimFunc)(int, LocalModelPiece&, AnimInfo&);
 
 	AnimContainerType anims[AMove + 1];
+	// finished animations with waiting listeners, between TickAnimations and TickAnimFinished
+	AnimContainerType doneAnims[AMove + 1];
 
 
 	bool hasSetSFXOccupy;
@@ -106,7 +108,10 @@ public:
 	      CUnit* GetUnit()       { return unit; }
 	const CUnit* GetUnit() const { return unit; }
 
-	bool Tick(int tickRate);
+	// advances all animations; only touches this script's own pieces
+	void TickAnimations(int deltaTime);
+	// notifies listeners of animations finished by TickAnimations
+	bool TickAnimFinished();
 	// note: must copy-and-set here (LMP dirty flag, etc)
 	bool TickMoveAnim(int tickRate, LocalModelPiece& lmp, AnimInfo& ai) { float3 pos = lmp.GetPosition(); const bool ret = MoveToward(pos[ai.axis], ai.dest, ai.speed / tickRate); lmp.SetPosition(pos); return ret; }
 	bool TickTurnAnim(int tickRate, LocalModelPiece& lmp, AnimInfo& ai) { float3 rot = lmp.GetRotation(); const bool ret = TurnToward(rot[ai.axis], ai.dest, ai.speed / tickRate); lmp.SetRotation(rot); return ret; }
@@ -136,6 +141,9 @@ public:
 	void Shatter(int piece, const float3& pos, const float3& speed);
 	void ShowFlare(int piece);
 	int GetUnitVal(int val, int p1, int p2, int p3, int p4);
+	// true if GetUnitVal(val, 0, 0, 0, 0) has no side-effects and only reads state
+	// of the unit itself that local script code (CCobFile::localScripts) can not change
+	static bool IsLocalUnitVal(int val);
 	void SetUnitVal(int val, int param);
 
 	bool IsInAnimation(AnimType type, int piece, int axis) {
@@ -144,6 +152,9 @@ public:
 	bool HaveAnimations() const {
 		return (!anims[ATurn].empty() || !anims[ASpin].empty() || !anims[AMove].empty());
 	}
+	bool HaveFinishedAnimations() const {
+		return (!doneAnims[ATurn].empty() || !doneAnims[ASpin].empty() || !doneAnims[AMove].empty());
+	}
 
 	// checks for callin existence
 	bool HasSetSFXOccupy () const { return hasSetSFXOccupy; }
@@ -203,6 +214,11 @@ public:
 	virtual void  Shot(int weaponNum) = 0;
 	virtual bool  BlockShot(int weaponNum, const CUnit* targetUnit, bool userTarget) = 0; // returns whether shot should be blocked
 	virtual float TargetWeight(int weaponNum, const CUnit* targetUnit) = 0; // returns target weight
+
+	// bracket CUnit::SlowUpdateWeapons, scripts may answer QueryWeapon and
+	// AimFromWeapon for all weapons at once in between
+	virtual void BeginWeaponSlowUpdates() {}
+	virtual void EndWeaponSlowUpdates() {}
 	virtual void AnimFinished(AnimType type, int piece, int axis) = 0;
 };
 
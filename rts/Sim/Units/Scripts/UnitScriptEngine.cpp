@@ -13,6 +13,7 @@
 #include "Sim/Units/UnitHandler.h"
 #include "System/ContainerUtil.h"
 #include "System/SafeUtil.h"
+#include "System/Threading/ThreadPool.h"
 
 static CCobEngine gCobEngine;
 static CCobFileHandler gCobFileHandler;
@@ -101,6 +102,8 @@ void CUnitScriptEngine::AddInstance(CUnitScript* instance)
 {
 	if (instance == currentScript)
 		return;
+	if (cobEngine->DeferCall({CCobEngine::DeferredCall::CallAddAnimating, -1, 0, instance}))
+		return;
 
 	spring::VectorInsertUnique(animating, instance/*, true*/);
 }
@@ -109,6 +112,8 @@ void CUnitScriptEngine::RemoveInstance(CUnitScript* instance)
 {
 	if (instance == currentScript)
 		return;
+	if (cobEngine->DeferCall({CCobEngine::DeferredCall::CallRemoveAnimating, -1, 0, instance}))
+		return;
 
 	spring::VectorErase(animating, instance);
 }
@@ -118,11 +123,18 @@ void CUnitScriptEngine::Tick(int deltaTime)
 {
 	cobEngine->Tick(deltaTime);
 
-	// tick all (COB or LUS) script instances that have registered themselves as animating
+	// tick all (COB or LUS) script instances that have registered themselves as animating;
+	// each only updates its own pieces here so they can be processed in parallel
+	for_mt_chunk(0, animating.size(), [&](const int i) {
+		animating[i]->TickAnimations(deltaTime);
+	});
+
+	// AnimFinished runs script code (and reschedules COB threads), notify serially in
+	// the order of <animating> so every client delivers the callins in the same order
 	for (size_t i = 0; i < animating.size(); ) {
 		currentScript = animating[i];
 
-		if (!currentScript->Tick(deltaTime)) {
+		if (!currentScript->TickAnimFinished()) {
 			animating[i] = animating.back();
 			animating.pop_back();
 			continue;
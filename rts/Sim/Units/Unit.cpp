@@ -299,6 +299,8 @@ void CUnit::PreInit(const UnitLoadParams& params)
 	harvestStorage.metal  = unitDef->harvestMetalStorage;
 	harvestStorage.energy = unitDef->harvestEnergyStorage;
 
+	UpdateHasResourcing();
+
 	moveType = MoveTypeFactory::GetMoveType(this, unitDef);
 	script = CUnitScriptFactory::CreateScript(this, unitDef);
 
@@ -860,17 +862,25 @@ void CUnit::SetLosStatus(int at, unsigned short newStatus)
 
 
 unsigned short CUnit::CalcLosStatus(int at)
+{
+	const bool inLos = losHandler->InLos(this, at);
+	const bool inRadar = !inLos && losHandler->InRadar(this, at);
+
+	return (CalcLosStatus(at, inLos, inRadar));
+}
+
+unsigned short CUnit::CalcLosStatus(int at, bool inLos, bool inRadar)
 {
 	const unsigned short currStatus = losStatus[at];
 
 	unsigned short newStatus = currStatus;
 	unsigned short mask = ~(currStatus >> LOS_MASK_SHIFT);
 
-	if (losHandler->InLos(this, at)) {
+	if (inLos) {
 		newStatus |= (mask & (LOS_INLOS   | LOS_INRADAR |
 		                      LOS_PREVLOS | LOS_CONTRADAR));
 	}
-	else if (losHandler->InRadar(this, at)) {
+	else if (inRadar) {
 		newStatus |=  (mask & LOS_INRADAR);
 		newStatus &= ~(mask & LOS_INLOS);
 	}
@@ -891,6 +901,15 @@ void CUnit::UpdateLosStatus(int at)
 	SetLosStatus(at, CalcLosStatus(at));
 }
 
+void CUnit::UpdateLosStatus(int at, bool inLos, bool inRadar)
+{
+	const unsigned short currStatus = losStatus[at];
+	if ((currStatus & LOS_ALL_MASK_BITS) == LOS_ALL_MASK_BITS) {
+		return; // no need to update, all changes are masked
+	}
+	SetLosStatus(at, CalcLosStatus(at, inLos, inRadar));
+}
+
 
 void CUnit::SetStunned(bool stun) {
 	stunned = stun;
@@ -984,6 +1003,40 @@ void CUnit::SlowUpdate()
 	moveType->SlowUpdate();
 
 
+	if (hasResourcing)
+		SlowUpdateResources();
+
+
+	if (health < maxHealth) {
+		health += (unitDef->idleAutoHeal * (restTime > unitDef->idleTime));
+		health += unitDef->autoHeal;
+		health = std::min(health, maxHealth);
+	}
+
+	SlowUpdateCloak(false);
+	SlowUpdateKamikaze(fireState >= FIRESTATE_FIREATWILL);
+
+	if (moveType->progressState == AMoveType::Active)
+		DoSeismicPing(seismicSignature);
+
+	CalculateTerrainType();
+	UpdateTerrainType();
+}
+
+
+void CUnit::UpdateHasResourcing()
+{
+	// every amount SlowUpdateResources passes on depends on at least one of these
+	hasResourcing = false;
+	hasResourcing |= (!resourcesCondUse.empty() || !resourcesCondMake.empty());
+	hasResourcing |= (!resourcesUncondUse.empty() || !resourcesUncondMake.empty());
+	hasResourcing |= (unitDef->metalMake != 0.0f || unitDef->makesMetal != 0.0f || unitDef->extractsMetal > 0.0f);
+	hasResourcing |= (unitDef->metalUpkeep != 0.0f || unitDef->energyUpkeep != 0.0f || unitDef->energyMake != 0.0f);
+	hasResourcing |= (unitDef->windGenerator > 0.0f || unitDef->tidalGenerator != 0.0f);
+}
+
+void CUnit::SlowUpdateResources()
+{
 	// FIXME: scriptMakeMetal ...?
 	AddMetal(resourcesUncondMake.metal);
 	AddEnergy(resourcesUncondMake.energy);
@@ -1022,22 +1075,6 @@ void CUnit::SlowUpdate()
 
 	// FIXME: tidal part should be under "if (activated)"?
 	AddEnergy((unitDef->energyMake + unitDef->tidalGenerator * envResHandler.GetCurrentTidalStrength()) * 0.5f);
-
-
-	if (health < maxHealth) {
-		health += (unitDef->idleAutoHeal * (restTime > unitDef->idleTime));
-		health += unitDef->autoHeal;
-		health = std::min(health, maxHealth);
-	}
-
-	SlowUpdateCloak(false);
-	SlowUpdateKamikaze(fireState >= FIRESTATE_FIREATWILL);
-
-	if (moveType->progressState == AMoveType::Active)
-		DoSeismicPing(seismicSignature);
-
-	CalculateTerrainType();
-	UpdateTerrainType();
 }
 
 
@@ -1046,9 +1083,13 @@ void CUnit::SlowUpdateWeapons()
 	if (!CanUpdateWeapons())
 		return;
 
+	script->BeginWeaponSlowUpdates();
+
 	for (CWeapon* w: weapons) {
 		w->SlowUpdate();
 	}
+
+	script->EndWeaponSlowUpdates();
 }
 
 void CUnit::SlowUpdateKamikaze(bool scanForTargets)
@@ -2869,6 +2910,7 @@ CR_REG_METADATA(CUnit, (
 	CR_MEMBER(resourcesCondMake),
 	CR_MEMBER(resourcesUncondUse),
 	CR_MEMBER(resourcesUncondMake),
+	CR_MEMBER(hasResourcing),
 
 	CR_MEMBER(resourcesUse),
 	CR_MEMBER(resourcesMake),
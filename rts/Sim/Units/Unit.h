@@ -192,13 +192,20 @@ public:
 
 	void SetLosStatus(int allyTeam, unsigned short newStatus);
 	unsigned short CalcLosStatus(int allyTeam);
+	unsigned short CalcLosStatus(int allyTeam, bool inLos, bool inRadar);
 	void UpdateLosStatus(int allyTeam);
+	// with the visibility already evaluated by CLosHandler::UpdateUnitVisibility
+	void UpdateLosStatus(int allyTeam, bool inLos, bool inRadar);
 
 	void UpdateWeapons();
 
 	void SlowUpdateWeapons();
 	void SlowUpdateKamikaze(bool scanForTargets);
 	void SlowUpdateCloak(bool stunCheck);
+	void SlowUpdateResources();
+
+	/// must be called after changing the resources{Cond,Uncond}{Use,Make} packs
+	void UpdateHasResourcing();
 
 	bool ScriptCloak();
 	bool ScriptDecloak(const CSolidObject* object, const CWeapon* weapon);
@@ -444,6 +451,10 @@ public:
 	SResourcePack resourcesUncondUse;
 	SResourcePack resourcesUncondMake;
 
+	// false if neither the above nor the UnitDef make or use any resources,
+	// SlowUpdate then skips the (all zero) team resource transactions
+	bool hasResourcing = false;
+
 	// costs per UNIT_SLOWUPDATE_RATE frames
 	SResourcePack resourcesUse;
 
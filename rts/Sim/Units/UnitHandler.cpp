@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 
 #include "UnitHandler.h"
@@ -11,8 +12,13 @@
 #include "UnitTypes/Factory.h"
 
 #include "CommandAI/BuilderCAI.h"
+#include "Game/GameHelper.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
+#include "Sim/MoveTypes/AAirMoveType.h"
+#include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/MoveTypes/MoveType.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Weapons/Weapon.h"
@@ -34,10 +40,18 @@ CR_REG_METADATA(CUnitHandler, (
 	CR_MEMBER(unitsByDefs),
 	CR_MEMBER(activeUnits),
 	CR_MEMBER(unitsToBeRemoved),
+	CR_IGNORED(deferredPushVecs),
+	CR_IGNORED(deferredPushIDs),
+	CR_IGNORED(deferredPushTests),
+	CR_IGNORED(autoTargetWeapons),
+	CR_IGNORED(pathRequestUnits),
+	CR_IGNORED(deferredPathIDs),
 
 	CR_MEMBER(builderCAIs),
 
 	CR_MEMBER(activeSlowUpdateUnit),
+	CR_MEMBER(slowUpdateCycleCost),
+	CR_MEMBER(slowUpdateDoneCost),
 	CR_MEMBER(activeUpdateUnit),
 
 	CR_MEMBER(maxUnits),
@@ -100,11 +114,19 @@ void CUnitHandler::Init() {
 	{
 		activeSlowUpdateUnit = 0;
 		activeUpdateUnit = 0;
+
+		slowUpdateCycleCost = 0;
+		slowUpdateDoneCost = 0;
 	}
 	{
 		units.resize(maxUnits, nullptr);
 		activeUnits.reserve(maxUnits);
 
+		deferredPushVecs.clear();
+		deferredPushVecs.resize(maxUnits, ZeroVector);
+		deferredPushIDs.clear();
+		deferredPushIDs.reserve(maxUnits);
+
 		unitMemPool.reserve(128);
 
 		// id's are used as indices, so they must lie in [0, units.size() - 1]
@@ -144,6 +166,13 @@ void CUnitHandler::Kill()
 		activeUnits.clear();
 		unitsToBeRemoved.clear();
 
+		deferredPushVecs.clear();
+		deferredPushIDs.clear();
+		deferredPushTests.clear();
+
+		pathRequestUnits.clear();
+		deferredPathIDs.clear();
+
 		// only iterated by unsynced code, GetBuilderCAIs has no synced callers
 		builderCAIs.clear();
 	}
@@ -304,6 +333,8 @@ void CUnitHandler::UpdateUnitMoveTypes()
 {
 	SCOPED_TIMER("Sim::Unit::MoveType");
 
+	SampleAircraftGroundHeights();
+
 	for (activeUpdateUnit = 0; activeUpdateUnit < activeUnits.size(); ++activeUpdateUnit) {
 		CUnit* unit = activeUnits[activeUpdateUnit];
 		AMoveType* moveType = unit->moveType;
@@ -322,35 +353,182 @@ void CUnitHandler::UpdateUnitMoveTypes()
 		unit->SanityCheck();
 		assert(activeUnits[activeUpdateUnit] == unit);
 	}
+
+	ResolveDeferredPushes();
+}
+
+void CUnitHandler::SampleAircraftGroundHeights()
+{
+	SCOPED_TIMER("Sim::Unit::MoveType::AirGroundHeights");
+
+	// aircraft check their altitude against several height and smooth-mesh
+	// lookups per update; take the samples at all their positions at once
+	// since the map does not change during the move-type sweep (a sample is
+	// ignored if its unit moved in the meantime)
+	for_mt(0, activeUnits.size(), [&](const int i) {
+		CUnit* unit = activeUnits[i];
+
+		if (!unit->unitDef->IsAirUnit() || unit->UsingScriptMoveType())
+			return;
+
+		static_cast<AAirMoveType*>(unit->moveType)->SampleGroundHeights();
+	});
+}
+
+void CUnitHandler::AddDeferredPush(const CUnit* unit, const float3& pushVec)
+{
+	assert(modInfo.deferUnitCollisionResponse);
+
+	// not saved either, the buffers are always empty between frames
+	if (deferredPushVecs.size() != units.size())
+		deferredPushVecs.resize(units.size(), ZeroVector);
+
+	float3& vec = deferredPushVecs[unit->id];
+
+	if (vec == ZeroVector)
+		deferredPushIDs.push_back(unit->id);
+
+	vec += pushVec;
+}
+
+void CUnitHandler::ResolveDeferredPushes()
+{
+	if (deferredPushIDs.empty())
+		return;
+
+	SCOPED_TIMER("Sim::Unit::MoveType::DeferredPushes");
+
+	// apply in ID order so the result does not depend on activeUnits order
+	// (equal across clients anyway) or on which party handled the collision
+	// (pushes can cancel out and re-add an ID, hence the unique)
+	std::sort(deferredPushIDs.begin(), deferredPushIDs.end());
+	deferredPushIDs.erase(std::unique(deferredPushIDs.begin(), deferredPushIDs.end()), deferredPushIDs.end());
+	deferredPushTests.clear();
+	deferredPushTests.resize(deferredPushIDs.size(), 0);
+
+	// the terrain part of the test only reads synced map data and each unit's
+	// own (pre-push) position, so it can run in parallel; the blocking-map part
+	// (RangeIsBlocked) uses a shared dedup-counter and stays on this thread
+	for_mt(0, deferredPushIDs.size(), [&](const int i) {
+		const CUnit* unit = units[deferredPushIDs[i]];
+		const float3& vec = deferredPushVecs[unit->id];
+
+		deferredPushTests[i] = unit->moveDef->TestMoveSquareTerrain(unit->pos + vec, vec);
+	});
+
+	for (size_t i = 0, n = deferredPushIDs.size(); i < n; i++) {
+		CUnit* unit = units[deferredPushIDs[i]];
+		float3& vec = deferredPushVecs[unit->id];
+
+		// ignore pushes on units that died or got picked up during the sweep
+		const bool canMove = (deferredPushTests[i] != 0 && !unit->isDead && unit->GetTransporter() == nullptr);
+
+		if (canMove && unit->moveDef->TestMoveSquare(unit, unit->pos + vec, vec, false, true))
+			unit->Move(vec, true);
+
+		vec = ZeroVector;
+	}
+
+	deferredPushIDs.clear();
 }
 
 void CUnitHandler::UpdateUnitLosStates()
 {
+	// bit tests against the visibility evaluated by the last LOS update, for
+	// the units that did not move or otherwise change since (see LosHandler)
 	for (CUnit* unit: activeUnits) {
 		for (int at = 0; at < teamHandler.ActiveAllyTeams(); ++at) {
-			unit->UpdateLosStatus(at);
+			unit->UpdateLosStatus(at, losHandler->IsUnitInLos(unit, at), losHandler->IsUnitInRadar(unit, at));
 		}
 	}
 }
 
 
+unsigned int CUnitHandler::GetSlowUpdateCost(const CUnit* unit)
+{
+	// static estimate, measured times would differ between clients and the
+	// batches decide when units act; weapons (targeting) and builders (area
+	// and guard searches) dominate the SlowUpdate of a unit
+	unsigned int cost = 1;
+
+	cost += (unit->weapons.size() * 2);
+	cost += (unit->unitDef->IsBuilderUnit()? 2: 0);
+
+	return cost;
+}
+
 void CUnitHandler::SlowUpdateUnits()
 {
 	SCOPED_TIMER("Sim::Unit::SlowUpdate");
 	assert(activeSlowUpdateUnit >= 0);
 
+	const int slot = gs->frameNum % UNIT_SLOWUPDATE_RATE;
+
 	// reset the iterator every <UNIT_SLOWUPDATE_RATE> frames
-	if ((gs->frameNum % UNIT_SLOWUPDATE_RATE) == 0)
+	if (slot == 0) {
 		activeSlowUpdateUnit = 0;
+		slowUpdateCycleCost = 0;
+		slowUpdateDoneCost = 0;
+
+		for (const CUnit* unit: activeUnits) {
+			slowUpdateCycleCost += GetSlowUpdateCost(unit);
+		}
+	}
+
+	// split the cycle into batches of (about) equal estimated cost rather
+	// than equal unit count, so clumps of expensive units do not all land
+	// in the same frame; the last batch takes whatever is left, including
+	// units created during the cycle
+	const uint64_t slotCost = slowUpdateDoneCost;
+	const uint64_t maxCost = (slowUpdateCycleCost * (slot + 1)) / UNIT_SLOWUPDATE_RATE;
 
 	const size_t idxBeg = activeSlowUpdateUnit;
-	const size_t maximumCnt = activeUnits.size() - idxBeg;
-	const size_t logicalCnt = (activeUnits.size() / UNIT_SLOWUPDATE_RATE) + 1;
-	const size_t indCnt = logicalCnt > maximumCnt ? maximumCnt : logicalCnt;
-	const size_t idxEnd = idxBeg + indCnt;
+	      size_t idxEnd = idxBeg;
+
+	for (const size_t n = activeUnits.size(); idxEnd < n; ++idxEnd) {
+		if (slot != (UNIT_SLOWUPDATE_RATE - 1) && slowUpdateDoneCost >= maxCost)
+			break;
+
+		slowUpdateDoneCost += GetSlowUpdateCost(activeUnits[idxEnd]);
+	}
 
 	activeSlowUpdateUnit = idxEnd;
 
+	{
+		static constexpr const char* slotCostNames[] = {
+			"Sim::Unit::SlowUpdate::SlotCost::00", "Sim::Unit::SlowUpdate::SlotCost::01", "Sim::Unit::SlowUpdate::SlotCost::02",
+			"Sim::Unit::SlowUpdate::SlotCost::03", "Sim::Unit::SlowUpdate::SlotCost::04", "Sim::Unit::SlowUpdate::SlotCost::05",
+			"Sim::Unit::SlowUpdate::SlotCost::06", "Sim::Unit::SlowUpdate::SlotCost::07", "Sim::Unit::SlowUpdate::SlotCost::08",
+			"Sim::Unit::SlowUpdate::SlotCost::09", "Sim::Unit::SlowUpdate::SlotCost::10", "Sim::Unit::SlowUpdate::SlotCost::11",
+			"Sim::Unit::SlowUpdate::SlotCost::12", "Sim::Unit::SlowUpdate::SlotCost::13", "Sim::Unit::SlowUpdate::SlotCost::14",
+		};
+		static_assert((sizeof(slotCostNames) / sizeof(slotCostNames[0])) == UNIT_SLOWUPDATE_RATE, "");
+
+		// per-slot totals form a histogram of the estimated batch costs
+		if (profiler.IsEnabled())
+			profiler.AddCounter(slotCostNames[slot], slowUpdateDoneCost - slotCost);
+	}
+
+	// score the auto-target candidates of the batch in parallel up front,
+	// AutoTarget only applies the script and Lua modifiers to them
+	autoTargetWeapons.clear();
+
+	for (size_t i = idxBeg; i < idxEnd; ++i) {
+		const CUnit* unit = activeUnits[i];
+
+		if (!unit->CanUpdateWeapons())
+			continue;
+
+		for (CWeapon* w: unit->weapons) {
+			if (!w->MayAutoTarget())
+				continue;
+
+			autoTargetWeapons.push_back(w);
+		}
+	}
+
+	helper->GenerateWeaponTargetCandidates(autoTargetWeapons);
+
 	// stagger the SlowUpdate's
 	for (size_t i = idxBeg; i<idxEnd; ++i) {
 		CUnit* unit = activeUnits[i];
@@ -362,6 +540,11 @@ void CUnitHandler::SlowUpdateUnits()
 		unit->SanityCheck();
 	}
 
+	// candidates hold raw pointers, dead units may be deleted before the next batch
+	for (CWeapon* w: autoTargetWeapons) {
+		w->haveAutoTargetCandidates = false;
+	}
+
 	// some paths are requested at slow rate
 	UpdateUnitPathing(idxBeg, idxEnd);
 }
@@ -371,7 +554,9 @@ void CUnitHandler::UpdateUnitPathing(const size_t idxBeg, const size_t idxEnd)
 	SCOPED_TIMER("Sim::Unit::RequestPath");
 	TKPFS::PathingSystemActive = true;
 
-	std::vector<CUnit*> unitsToMove;
+	// reused between frames, only grows with the number of active units
+	std::vector<CUnit*>& unitsToMove = pathRequestUnits;
+	unitsToMove.clear();
 	unitsToMove.reserve(activeUnits.size());
 
 	GetUnitsWithPathRequests(unitsToMove, idxBeg, idxEnd);
@@ -386,53 +571,75 @@ void CUnitHandler::UpdateUnitPathing(const size_t idxBeg, const size_t idxEnd)
 
 void CUnitHandler::GetUnitsWithPathRequests(std::vector<CUnit*>& unitsToMove, const size_t idxBeg, const size_t idxEnd)
 {
+	// requests the broker pushed back last frame are retried first, whichever slice they are in
+	std::vector<int>& deferredIDs = deferredPathIDs;
+	const std::vector<int>& deferredOwners = pathManager->GetRequestBroker().GetDeferredOwners();
+
+	deferredIDs.assign(deferredOwners.begin(), deferredOwners.end());
+	std::sort(deferredIDs.begin(), deferredIDs.end());
+
+	for (const int unitID: deferredIDs) {
+		CUnit* unit = GetUnit(unitID);
+		if (unit != nullptr && unit->moveType->WantsReRequestPath() != PATH_REQUEST_NONE)
+			unitsToMove.push_back(unit);
+	}
+
+	const auto isDeferred = [&](const CUnit* unit) { return std::binary_search(deferredIDs.begin(), deferredIDs.end(), unit->id); };
+
 	for (size_t i = 0; i<idxBeg; ++i)
 	{
 		CUnit* unit = activeUnits[i];
-		if (unit->moveType->WantsReRequestPath() & (PATH_REQUEST_TIMING_IMMEDIATE))
+		if ((unit->moveType->WantsReRequestPath() & (PATH_REQUEST_TIMING_IMMEDIATE)) && !isDeferred(unit))
 			unitsToMove.push_back(unit);
 	}
 	for (size_t i = idxBeg; i<idxEnd; ++i)
 	{
 		CUnit* unit = activeUnits[i];
-		if (unit->moveType->WantsReRequestPath() & (PATH_REQUEST_TIMING_DELAYED|PATH_REQUEST_TIMING_IMMEDIATE))
+		if ((unit->moveType->WantsReRequestPath() & (PATH_REQUEST_TIMING_DELAYED|PATH_REQUEST_TIMING_IMMEDIATE)) && !isDeferred(unit))
 			unitsToMove.push_back(unit);
 	}
 	for (size_t i = idxEnd; i<activeUnits.size(); ++i)
 	{
 		CUnit* unit = activeUnits[i];
-		if (unit->moveType->WantsReRequestPath() & (PATH_REQUEST_TIMING_IMMEDIATE))
+		if ((unit->moveType->WantsReRequestPath() & (PATH_REQUEST_TIMING_IMMEDIATE)) && !isDeferred(unit))
 			unitsToMove.push_back(unit);
 	}
-}
 
-void CUnitHandler::MultiThreadPathRequests(std::vector<CUnit*>& unitsToMove)
-{
-	size_t unitsToMoveCount = unitsToMove.size();
+	CPathRequestBroker& requestBroker = pathManager->GetRequestBroker();
 
-	// Carry out the pathing requests without heatmap updates.
-	for_mt(0, unitsToMoveCount, [&unitsToMove](const int i){
-		CUnit* unit = unitsToMove[i];
-		unit->moveType->DelayedReRequestPath();
-	});
+	for (const CUnit* unit: unitsToMove) {
+		const AMoveType* moveType = unit->moveType;
+		const bool urgent = (moveType->WantsReRequestPath() & PATH_REQUEST_TIMING_IMMEDIATE) != 0;
 
-	// update cache
-	for (size_t i = 0; i<unitsToMoveCount; ++i){
-		CUnit* unit = unitsToMove[i];
-		auto pathId = unit->moveType->GetPathId();
-		if (pathId > 0)
-			pathManager->SavePathCacheForPathId(pathId);
+		requestBroker.AddRequest({unit->moveDef, unit->pos, moveType->goalPos, moveType->GetGoalRadius(), unit->id, urgent});
 	}
+}
+
+void CUnitHandler::MultiThreadPathRequests(std::vector<CUnit*>& unitsToMove)
+{
+	// Carry out the pathing requests without heatmap updates. New paths are
+	// published to the shared caches serially and in scheduling order so every
+	// client ends up with the same entries (first path for a key wins).
+	const std::vector<unsigned int>& executed = pathManager->GetRequestBroker().Execute(true,
+		[&unitsToMove](unsigned int i) {
+			unitsToMove[i]->moveType->DelayedReRequestPath();
+		},
+		[&unitsToMove](unsigned int i) {
+			auto pathId = unitsToMove[i]->moveType->GetPathId();
+			if (pathId > 0)
+				pathManager->SavePathCacheForPathId(pathId);
+		}
+	);
 
 	// Update Heatmaps for moved units.
-	for (size_t i = 0; i<unitsToMoveCount; ++i){
+	for (const unsigned int i: executed){
 		CUnit* unit = unitsToMove[i];
 		auto pathId = unit->moveType->GetPathId();
 		if (pathId > 0)
 			pathManager->UpdatePath(unit, pathId);
 	}
 
-	for (size_t i = 0; i<unitsToMoveCount; ++i){
+	for (const unsigned int i: executed){
 		CUnit* unit = unitsToMove[i];
 		unit->moveType->SyncWaypoints();
 	}
@@ -440,22 +647,23 @@ void CUnitHandler::MultiThreadPathRequests(std::vector<CUnit*>& unitsToMove)
 
 void CUnitHandler::SingleThreadPathRequests(std::vector<CUnit*>& unitsToMove)
 {
-	size_t unitsToMoveCount = unitsToMove.size();
-
-	for (size_t i = 0; i<unitsToMoveCount; ++i){
-		CUnit* unit = unitsToMove[i];
-		unit->moveType->DelayedReRequestPath();
-
-		// Update heatmap inline with request to keep as close as possible to the original
-		// behaviour.
-		auto pathId = unit->moveType->GetPathId();
-		if (pathId > 0)
-			pathManager->UpdatePath(unit, pathId);
-
-		unit->moveType->SyncWaypoints();
-
-		// update cache is still done inside the ST pathing
-	}
+	pathManager->GetRequestBroker().Execute(false,
+		[&unitsToMove](unsigned int i) {
+			CUnit* unit = unitsToMove[i];
+			unit->moveType->DelayedReRequestPath();
+
+			// Update heatmap inline with request to keep as close as possible to the original
+			// behaviour.
+			auto pathId = unit->moveType->GetPathId();
+			if (pathId > 0)
+				pathManager->UpdatePath(unit, pathId);
+
+			unit->moveType->SyncWaypoints();
+
+			// update cache is still done inside the ST pathing
+		},
+		[](unsigned int) {}
+	);
 }
 
 void CUnitHandler::UpdateUnits()
@@ -4,15 +4,18 @@
 #define UNITHANDLER_H
 
 #include <array>
+#include <cstdint>
 #include <vector>
 
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/SimObjectIDPool.h"
+#include "System/float3.h"
 #include "System/creg/STL_Map.h"
 
 struct UnitDef;
 class CUnit;
 class CBuilderCAI;
+class CWeapon;
 
 class CUnitHandler
 {
@@ -73,6 +76,9 @@ public:
 
 	const spring::unordered_map<unsigned int, CBuilderCAI*>& GetBuilderCAIs() const { return builderCAIs; }
 
+	// used by CGroundMoveType if modInfo.deferUnitCollisionResponse is set
+	void AddDeferredPush(const CUnit* unit, const float3& pushVec);
+
 private:
 	void InsertActiveUnit(CUnit* unit);
 	bool QueueDeleteUnit(CUnit* unit);
@@ -80,8 +86,11 @@ private:
 	void DeleteUnit(CUnit* unit);
 	void DeleteUnits();
 	void SlowUpdateUnits();
+	static unsigned int GetSlowUpdateCost(const CUnit* unit);
 	void UpdateUnitPathing(const size_t idxBeg, const size_t idxEnd);
 	void UpdateUnitMoveTypes();
+	void SampleAircraftGroundHeights();
+	void ResolveDeferredPushes();
 	void UpdateUnitLosStates();
 	void UpdateUnits();
 	void UpdateUnitWeapons();
@@ -99,10 +108,19 @@ private:
 	std::vector<CUnit*> activeUnits;                                     ///< used to get all active units
 	std::vector<CUnit*> unitsToBeRemoved;                                ///< units that will be removed at start of next update
 
+	std::vector<float3> deferredPushVecs;                                ///< indexed by unit ID, summed collision push-responses
+	std::vector<int> deferredPushIDs;                                    ///< units with a non-empty entry in deferredPushVecs
+	std::vector<uint8_t> deferredPushTests;                              ///< per deferredPushIDs entry, terrain-test result
+	std::vector<CWeapon*> autoTargetWeapons;                             ///< weapons of the SlowUpdate batch with pre-scored targets
+	std::vector<CUnit*> pathRequestUnits;                                ///< UpdateUnitPathing scratch, units issuing path requests
+	std::vector<int> deferredPathIDs;                                    ///< UpdateUnitPathing scratch, sorted IDs of deferred owners
+
 	spring::unordered_map<unsigned int, CBuilderCAI*> builderCAIs;
 
 
 	size_t activeSlowUpdateUnit = 0;  ///< first unit of batch that will be SlowUpdate'd this frame
+	uint64_t slowUpdateCycleCost = 0; ///< estimated SlowUpdate cost of all active units at the start of the cycle
+	uint64_t slowUpdateDoneCost = 0;  ///< estimated SlowUpdate cost of the batches run so far this cycle
 	size_t activeUpdateUnit = 0;      ///< first unit of batch that will be SlowUpdate'd this frame
 
 
@@ -367,7 +367,7 @@ void CUnitLoader::FlattenGround(const CUnit* unit)
 		}
 	}
 
-	mapDamage->RecalcArea(tx1, tx2, tz1, tz2);
+	mapDamage->QueueRecalcArea(tx1, tx2, tz1, tz2);
 }
 
 void CUnitLoader::RestoreGround(const CUnit* unit)
@@ -422,6 +422,6 @@ void CUnitLoader::RestoreGround(const CUnit* unit)
 		}
 	}
 
-	mapDamage->RecalcArea(tx1, tx2, tz1, tz2);
+	mapDamage->QueueRecalcArea(tx1, tx2, tz1, tz2);
 }
 
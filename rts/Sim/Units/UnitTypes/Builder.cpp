@@ -221,7 +221,7 @@ bool CBuilder::UpdateTerraform(const Command&)
 				}
 			}
 			SmoothBorders();
-			mapDamage->RecalcArea(tx1 - b, tx2 + b, tz1 - b, tz2 + b);
+			mapDamage->QueueRecalcArea(tx1 - b, tx2 + b, tz1 - b, tz2 + b);
 
 			if (curBuildee->terraformLeft <= 0.0f) {
 				terraforming = false;
@@ -255,7 +255,7 @@ bool CBuilder::UpdateTerraform(const Command&)
 			}
 		}
 		SmoothBorders();
-		mapDamage->RecalcArea(tx1 - b, tx2 + b, tz1 - b, tz2 + b);
+		mapDamage->QueueRecalcArea(tx1 - b, tx2 + b, tz1 - b, tz2 + b);
 
 		if (myTerraformLeft <= 0.0f) {
 			terraforming = false;
@@ -556,7 +556,7 @@ void CBuilder::Update()
 void CBuilder::SlowUpdate()
 {
 	if (terraforming)
-		mapDamage->RecalcArea(tx1, tx2, tz1, tz2);
+		mapDamage->QueueRecalcArea(tx1, tx2, tz1, tz2);
 
 	CUnit::SlowUpdate();
 }
@@ -20,6 +20,7 @@ private:
 	bool TestRange(const float3 pos, const SWeaponTarget& trg) const override final;
 	// TODO: requires sampling parabola from aimFromPos down to dropPos
 	bool HaveFreeLineOfFire(const float3 srcPos, const float3 tgtPos, const SWeaponTarget& trg) const override final { return true; }
+	void HaveFreeLinesOfFire(const float3 srcPos, const float3* tgtPositions, const SWeaponTarget* targets, size_t count, bool* results) const override final { TestLinesOfFire(srcPos, tgtPositions, targets, count, results); }
 	void FireImpl(const bool scriptCall) override final;
 
 private:
@@ -56,6 +56,16 @@ void CMissileLauncher::FireImpl(const bool scriptCall)
 	WeaponProjectileFactory::LoadProjectile(params);
 }
 
+void CMissileLauncher::HaveFreeLinesOfFire(const float3 srcPos, const float3* tgtPositions, const SWeaponTarget* targets, size_t count, bool* results) const
+{
+	if (weaponDef->trajectoryHeight <= 0.0f) {
+		CWeapon::HaveFreeLinesOfFire(srcPos, tgtPositions, targets, count, results);
+		return;
+	}
+
+	TestLinesOfFire(srcPos, tgtPositions, targets, count, results);
+}
+
 bool CMissileLauncher::HaveFreeLineOfFire(const float3 srcPos, const float3 tgtPos, const SWeaponTarget& trg) const
 {
 	// high-trajectory missiles use parabolic rather than linear ground intersection
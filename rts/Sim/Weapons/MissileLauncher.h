@@ -17,6 +17,7 @@ private:
 	const float3& GetAimFromPos(bool useMuzzle = false) const override { return weaponMuzzlePos; }
 
 	bool HaveFreeLineOfFire(const float3 srcPos, const float3 tgtPos, const SWeaponTarget& trg) const override final;
+	void HaveFreeLinesOfFire(const float3 srcPos, const float3* tgtPositions, const SWeaponTarget* targets, size_t count, bool* results) const override final;
 	void FireImpl(const bool scriptCall) override final;
 };
 
@@ -19,6 +19,7 @@ public:
 	void Init() override final;
 	void DependentDied(CObject* o) override final;
 	bool HaveFreeLineOfFire(const float3 srcPos, const float3 tgtPos, const SWeaponTarget& trg) const override final { return true; }
+	void HaveFreeLinesOfFire(const float3 srcPos, const float3* tgtPositions, const SWeaponTarget* targets, size_t count, bool* results) const override final { TestLinesOfFire(srcPos, tgtPositions, targets, count, results); }
 
 	void Update() override final;
 	void SlowUpdate() override final;
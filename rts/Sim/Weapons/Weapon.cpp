@@ -1,5 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <array>
+
 #include "Weapon.h"
 #include "WeaponDefHandler.h"
 #include "WeaponMemPool.h"
@@ -102,7 +104,10 @@ CR_REG_METADATA(CWeapon, (
 	CR_MEMBER(currentTarget),
 	CR_MEMBER(currentTargetPos),
 
-	CR_MEMBER(incomingProjectileIDs)
+	CR_MEMBER(incomingProjectileIDs),
+
+	CR_IGNORED(autoTargetCandidates),
+	CR_IGNORED(haveAutoTargetCandidates)
 ))
 
 
@@ -177,7 +182,9 @@ CWeapon::CWeapon(CUnit* owner, const WeaponDef* def):
 	errorVector(ZeroVector),
 	errorVectorAdd(ZeroVector),
 
-	muzzleFlareSize(1)
+	muzzleFlareSize(1),
+
+	haveAutoTargetCandidates(false)
 {
 	assert(weaponMemPool.alloced(this));
 }
@@ -612,6 +619,29 @@ bool CWeapon::AllowWeaponAutoTarget() const
 	return (gs->frameNum > (lastTargetRetry + 65));
 }
 
+// the script- and Lua-free part of AllowWeaponAutoTarget, for weapons whose
+// target candidates are worth scoring before the SlowUpdate pass
+bool CWeapon::MayAutoTarget() const
+{
+	if (weaponDef->noAutoTarget || noAutoTarget)
+		return false;
+	if (owner->fireState < FIRESTATE_FIREATWILL)
+		return false;
+	if (slavedTo != nullptr)
+		return false;
+	if (weaponDef->interceptor)
+		return false;
+
+	if (!HaveTarget())
+		return true;
+	if (avoidTarget)
+		return true;
+	if (currentTarget.isUserTarget)
+		return false;
+
+	return (gs->frameNum > (lastTargetRetry + 65));
+}
+
 bool CWeapon::AutoTarget()
 {
 	if (!AllowWeaponAutoTarget())
@@ -627,35 +657,63 @@ bool CWeapon::AutoTarget()
 
 	auto& targetPairs = helper->targetPairs;
 
+	std::array<SWeaponTarget, LOF_BATCH_SIZE> lofTargets;
+	std::array<float3, LOF_BATCH_SIZE> lofTargetPositions;
+	std::array<bool, LOF_BATCH_SIZE> lofResults;
+
 	// NOTE:
 	//   GenerateWeaponTargets sorts by INCREASING order of priority, so lower equals better
 	//   <targetPairs> is normally sorted such that all bad TargetCategory units live at the
 	//   end, but Lua can mess with the ordering arbitrarily
-	for (size_t i = 0, n = CGameHelper::GenerateWeaponTargets(this, avoidUnit, targetPairs); i < n; i++, assert(n == targetPairs.size())) {
-		CUnit* unit = targetPairs[i].second;
+	//
+	//   the line-of-fire tests are the expensive part of TryTarget, so they are done for up
+	//   to LOF_BATCH_SIZE candidates passing every other test at once; candidates are still
+	//   picked in the same order as by testing them one at a time
+	for (size_t i = 0, n = CGameHelper::GenerateWeaponTargets(this, avoidUnit, targetPairs); i < n && goodTargetUnit == nullptr; assert(n == targetPairs.size())) {
+		size_t numBatched = 0;
+
+		for (; i < n && numBatched < LOF_BATCH_SIZE; i++) {
+			CUnit* unit = targetPairs[i].second;
+
+			// save the "best" bad target in case we have no other
+			// good targets (of higher priority) left in <targets>
+			if ((unit->category & badTargetCategory) != 0 && (badTargetUnit != nullptr))
+				continue;
+
+			if (unit->IsNeutral() && (owner->fireState < FIRESTATE_FIREATNEUTRAL))
+				continue;
+
+			// set isAutoTarget s.t. TestRange result is ignored
+			// (which enables pre-aiming at targets out of range)
+			const SWeaponTarget trg(unit, false, autoTargetRangeBoost > 0.0f);
+			const float3 tgtPos = GetLeadTargetPos(trg);
+
+			if (!TestTarget(tgtPos, trg))
+				continue;
+			if (!trg.isAutoTarget && !TestRange(tgtPos, trg))
+				continue;
+
+			lofTargets[numBatched] = trg;
+			lofTargetPositions[numBatched] = tgtPos;
+			numBatched++;
+		}
 
-		// save the "best" bad target in case we have no other
-		// good targets (of higher priority) left in <targets>
-		const bool isBadTarget = (unit->category & badTargetCategory);
+		HaveFreeLinesOfFire(GetAimFromPos(false), lofTargetPositions.data(), lofTargets.data(), numBatched, lofResults.data());
 
-		if (isBadTarget && (badTargetUnit != nullptr))
-			continue;
+		for (size_t j = 0; j < numBatched; j++) {
+			if (!lofResults[j])
+				continue;
 
-		// set isAutoTarget s.t. TestRange result is ignored
-		// (which enables pre-aiming at targets out of range)
-		if (!TryTarget(SWeaponTarget(unit, false, autoTargetRangeBoost > 0.0f)))
-			continue;
+			CUnit* unit = lofTargets[j].unit;
 
-		if (unit->IsNeutral() && (owner->fireState < FIRESTATE_FIREATNEUTRAL))
-			continue;
+			if ((unit->category & badTargetCategory) != 0) {
+				badTargetUnit = (badTargetUnit != nullptr)? badTargetUnit: unit;
+				continue;
+			}
 
-		if (isBadTarget) {
-			badTargetUnit = unit;
-			continue;
+			goodTargetUnit = unit;
+			break;
 		}
-
-		goodTargetUnit = unit;
-		break;
 	}
 
 	if (goodTargetUnit == nullptr)
@@ -948,36 +1006,96 @@ bool CWeapon::HaveFreeLineOfFire(const float3 srcPos, const float3 tgtPos, const
 	if (length == 0.0f)
 		return true;
 
-	CUnit* unit = nullptr;
-	CFeature* feature = nullptr;
-
-	// ground check
-	// NOTE:
-	//   ballistic weapons (Cannon / Missile icw. trajectoryHeight) override this part,
-	//   they rely on TrajectoryGroundCol with an external check for the NOGROUND flag
-	if ((avoidFlags & Collision::NOGROUND) == 0) {
-		const float gndDst = TraceRay::TraceRay(srcPos, tgtDir, length, ~Collision::NOGROUND, owner, unit, feature);
-		const float tgtDst = tgtPos.SqDistance(srcPos + tgtDir * gndDst);
-
-		// true iff ground does not block the ray of length <length> from <srcPos> along <tgtDir>
-		if ((gndDst > 0.0f) && (tgtDst > Square(damages->damageAreaOfEffect)))
-			return false;
-
-		unit = nullptr;
-		feature = nullptr;
-	}
+	if (GroundBlocksLineOfFire(srcPos, tgtPos, tgtDir, length))
+		return false;
 
 	// friendly, neutral & feature check
 	// for projectiles that do not or barely spread out with distance
 	// this reduces to a ray intersection, which is also more accurate
 	// must nerf TraceRay since it scans for enemies and ground if the
 	// flags are omitted, unlike TestCone which is restricted to A/N/F
-	if (spread < 0.001f)
+	if (spread < 0.001f) {
+		CUnit* unit = nullptr;
+		CFeature* feature = nullptr;
+
 		return (TraceRay::TraceRay(srcPos, tgtDir, length, avoidFlags | Collision::NOENEMIES | Collision::NOGROUND, owner, unit, feature) >= length);
+	}
 
 	return (!TraceRay::TestCone(srcPos, tgtDir, length, spread, owner->allyteam, avoidFlags, owner));
 }
 
+void CWeapon::HaveFreeLinesOfFire(const float3 srcPos, const float3* tgtPositions, const SWeaponTarget* targets, size_t count, bool* results) const
+{
+	assert(count <= LOF_BATCH_SIZE);
+
+	const float spread = AccuracyExperience() + SprayAngleExperience();
+
+	if (spread < 0.001f) {
+		// no cones to batch, see HaveFreeLineOfFire
+		TestLinesOfFire(srcPos, tgtPositions, targets, count, results);
+		return;
+	}
+
+	std::array<float3, LOF_BATCH_SIZE> coneDirs;
+	std::array<float, LOF_BATCH_SIZE> coneLengths;
+	std::array<size_t, LOF_BATCH_SIZE> coneIndices;
+	std::array<bool, LOF_BATCH_SIZE> coneBlocked;
+
+	size_t numCones = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		float3 tgtDir = tgtPositions[i] - srcPos;
+
+		const float length = tgtDir.LengthNormalize();
+
+		results[i] = true;
+
+		if (length == 0.0f)
+			continue;
+
+		if (GroundBlocksLineOfFire(srcPos, tgtPositions[i], tgtDir, length)) {
+			results[i] = false;
+			continue;
+		}
+
+		coneDirs[numCones] = tgtDir;
+		coneLengths[numCones] = length;
+		coneIndices[numCones] = i;
+		numCones++;
+	}
+
+	TraceRay::TestCones(srcPos, coneDirs.data(), coneLengths.data(), numCones, spread, owner->allyteam, avoidFlags, owner, coneBlocked.data());
+
+	for (size_t j = 0; j < numCones; j++) {
+		results[coneIndices[j]] = !coneBlocked[j];
+	}
+}
+
+void CWeapon::TestLinesOfFire(const float3 srcPos, const float3* tgtPositions, const SWeaponTarget* targets, size_t count, bool* results) const
+{
+	for (size_t i = 0; i < count; i++) {
+		results[i] = HaveFreeLineOfFire(srcPos, tgtPositions[i], targets[i]);
+	}
+}
+
+bool CWeapon::GroundBlocksLineOfFire(const float3 srcPos, const float3 tgtPos, const float3 tgtDir, float length) const
+{
+	// NOTE:
+	//   ballistic weapons (Cannon / Missile icw. trajectoryHeight) override this part,
+	//   they rely on TrajectoryGroundCol with an external check for the NOGROUND flag
+	if ((avoidFlags & Collision::NOGROUND) != 0)
+		return false;
+
+	CUnit* unit = nullptr;
+	CFeature* feature = nullptr;
+
+	const float gndDst = TraceRay::TraceRay(srcPos, tgtDir, length, ~Collision::NOGROUND, owner, unit, feature);
+	const float tgtDst = tgtPos.SqDistance(srcPos + tgtDir * gndDst);
+
+	// true iff ground blocks the ray of length <length> from <srcPos> along <tgtDir>
+	return ((gndDst > 0.0f) && (tgtDst > Square(damages->damageAreaOfEffect)));
+}
+
 
 bool CWeapon::TryTarget(const SWeaponTarget& trg) const {
 	return TryTarget(GetLeadTargetPos(trg), trg);
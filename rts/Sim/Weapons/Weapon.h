@@ -22,6 +22,9 @@ class CWeapon : public CObject
 	CR_DECLARE_DERIVED(CWeapon)
 
 public:
+	// number of auto-target candidates whose line-of-fire is tested at once
+	static constexpr size_t LOF_BATCH_SIZE = 4;
+
 	CWeapon(CUnit* owner = nullptr, const WeaponDef* def = nullptr);
 	virtual ~CWeapon();
 	virtual void Init();
@@ -56,6 +59,9 @@ public:
 	virtual bool TestRange(const float3 tgtPos, const SWeaponTarget& trg) const;
 	/// test if something is blocking our LineOfFire
 	virtual bool HaveFreeLineOfFire(const float3 srcPos, const float3 tgtPos, const SWeaponTarget& trg) const;
+	// HaveFreeLineOfFire for up to LOF_BATCH_SIZE targets seen from <srcPos>, batching the cone
+	// tests; weapons overriding the single-target version must override this (TestLinesOfFire)
+	virtual void HaveFreeLinesOfFire(const float3 srcPos, const float3* tgtPositions, const SWeaponTarget* targets, size_t count, bool* results) const;
 
 	virtual bool CanFire(bool ignoreAngleGood, bool ignoreTargetType, bool ignoreRequestedDir) const;
 
@@ -83,6 +89,7 @@ public:
 	virtual void UpdateRange(const float val) { range = val; }
 
 	bool AutoTarget();
+	bool MayAutoTarget() const;
 	void AimReady(const int value);
 	void Fire(const bool scriptCall);
 
@@ -104,6 +111,9 @@ protected:
 	static bool TargetUnderWater(const float3 tgtPos, const SWeaponTarget&);
 	static bool TargetInWater(const float3 tgtPos, const SWeaponTarget&);
 
+	void TestLinesOfFire(const float3 srcPos, const float3* tgtPositions, const SWeaponTarget* targets, size_t count, bool* results) const;
+	bool GroundBlocksLineOfFire(const float3 srcPos, const float3 tgtPos, const float3 tgtDir, float length) const;
+
 	void UpdateWeaponPieces(const bool updateAimFrom = true);
 	void UpdateWeaponVectors();
 	float3 GetLeadVec(const CUnit* unit) const;
@@ -197,6 +207,10 @@ public:
 
 	float muzzleFlareSize;                  // size of muzzle flare if drawn
 
+	// scored up front by CGameHelper::GenerateWeaponTargetCandidates, valid only during the SlowUpdate pass
+	std::vector<SWeaponTargetCandidate> autoTargetCandidates;
+	bool haveAutoTargetCandidates;
+
 protected:
 	SWeaponTarget currentTarget;
 	float3 currentTargetPos;
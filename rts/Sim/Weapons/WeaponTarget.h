@@ -48,4 +48,13 @@ public:
 	float3 groundPos;             // if targettype=ground: the ground position
 };
 
+
+// scored by CGameHelper for CWeapon::AutoTarget, lower priority is better
+struct SWeaponTargetCandidate {
+	CUnit* unit;
+
+	float priority;               // excluding the avoidee, TargetWeight and AllowWeaponTarget modifiers
+	bool inLos;
+};
+
 #endif // WEAPONTARGET_H
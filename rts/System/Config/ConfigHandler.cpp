@@ -10,6 +10,8 @@
 #include "System/UnorderedMap.hpp"
 #include "System/Threading/SpringThreading.h"
 
+#include <atomic>
+#include <cassert>
 #include <cstdio>
 #include <cstring>
 
@@ -224,6 +226,8 @@ StringMap ConfigHandlerImpl::GetDataWithoutDefaults() const
 
 void ConfigHandlerImpl::Delete(const std::string& key)
 {
+	InvalidateCachedValues();
+
 	for (ReadOnlyConfigSource* s: sources) {
 		// The alternative to the dynamic cast is to merge ReadWriteConfigSource
 		// with ReadOnlyConfigSource, but then DefaultConfigSource would have to
@@ -301,6 +305,8 @@ void ConfigHandlerImpl::SetString(const std::string& key, const std::string& val
 	if (IsSet(key) && GetString(key) == value)
 		return;
 
+	InvalidateCachedValues();
+
 	if (useOverlay) {
 		overlay->SetString(key, value);
 	} else if (writingEnabled) {
@@ -398,6 +404,7 @@ void ConfigHandlerImpl::RemoveObserver(void* observer) {
 void ConfigHandler::Instantiate(const std::string configSource, const bool safemode)
 {
 	Deallocate();
+	InvalidateCachedValues();
 
 	std::vector<std::string> locations;
 	if (!configSource.empty()) {
@@ -423,9 +430,66 @@ void ConfigHandler::Deallocate()
 	spring::SafeDelete(configHandler);
 }
 
-bool ConfigHandler::Get(const std::string& key) const
+// bumped by every change, a thread's cache is only valid for the generation it was filled in
+static std::atomic<unsigned int> cachedValuesGeneration = {0};
+
+static thread_local spring::unordered_map<std::string, ConfigHandler::CachedValue>* threadCachedValues = nullptr;
+static thread_local unsigned int threadCachedValuesGeneration = 0;
+
+void ConfigHandler::InvalidateCachedValues()
+{
+	cachedValuesGeneration.fetch_add(1, std::memory_order_release);
+}
+
+const ConfigHandler::CachedValue* ConfigHandler::FindCachedValue(const std::string& key) const
+{
+	// never freed, lives as long as the thread does
+	if (threadCachedValues == nullptr)
+		threadCachedValues = new spring::unordered_map<std::string, CachedValue>();
+
+	const unsigned int generation = cachedValuesGeneration.load(std::memory_order_acquire);
+
+	if (generation != threadCachedValuesGeneration) {
+		threadCachedValues->clear();
+		threadCachedValuesGeneration = generation;
+	}
+
+	auto iter = threadCachedValues->find(key);
+
+	if (iter == threadCachedValues->end()) {
+		CachedValue cv;
+
+		// operator>> for numbers, StringToBool for bools
+		const auto parse = [&](auto& value) {
+			std::istringstream buf(cv.s);
+			buf >> value;
+		};
+
+		if ((cv.isSet = IsSet(key))) {
+			cv.s = GetString(key);
+			cv.b = StringToBool(cv.s);
+
+			parse(cv.i);
+			parse(cv.u);
+			parse(cv.f);
+		}
+
+		iter = threadCachedValues->emplace(key, std::move(cv)).first;
+	}
+
+	return ((iter->second.isSet)? &iter->second: nullptr);
+}
+
+const ConfigHandler::CachedValue& ConfigHandler::GetCachedValue(const std::string& key) const
 {
-	return StringToBool(GetString(key));
+	const CachedValue* cv = FindCachedValue(key);
+
+	// throws the usual key-does-not-exist error
+	if (cv == nullptr)
+		GetString(key);
+
+	assert(cv != nullptr);
+	return *cv;
 }
 
 
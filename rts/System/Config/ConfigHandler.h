@@ -69,19 +69,24 @@ public:
 		SetString(key, buffer.str(), useOverlay, notify);
 	}
 
+	// the typed getters below are served from a per-thread cache of parsed
+	// values, so reading a key every frame costs a hash lookup rather than
+	// a walk over all sources plus a parse; any SetString or Delete drops
+	// the caches of all threads
+
 	/// @brief Get bool, throw if key not present
-	bool GetBool(const std::string& key) const { return (Get<bool>(key)); }
+	bool GetBool(const std::string& key) const { return (GetCachedValue(key).b); }
 	/// @brief Get int, throw if key not present
-	int GetInt(const std::string& key) const { return (Get<int>(key)); }
+	int GetInt(const std::string& key) const { return (GetCachedValue(key).i); }
 	/// @brief Get int, throw if key not present
-	int GetUnsigned(const std::string& key) const { return (Get<unsigned>(key)); }
+	int GetUnsigned(const std::string& key) const { return (GetCachedValue(key).u); }
 	/// @brief Get float, throw if key not present
-	float GetFloat(const std::string& key) const { return (Get<float>(key)); }
+	float GetFloat(const std::string& key) const { return (GetCachedValue(key).f); }
 
-	bool GetBoolSafe(const std::string& key, bool def) const { return (IsSet(key)? GetBool(key): def); }
-	int GetIntSafe(const std::string& key, int def) const { return (IsSet(key)? GetInt(key): def); }
-	float GetFloatSafe(const std::string& key, float def) const { return (IsSet(key)? GetFloat(key): def); }
-	std::string GetStringSafe(const std::string& key, const std::string& def) const { return (IsSet(key)? GetString(key): def); }
+	bool GetBoolSafe(const std::string& key, bool def) const { const CachedValue* v = FindCachedValue(key); return ((v != nullptr)? v->b: def); }
+	int GetIntSafe(const std::string& key, int def) const { const CachedValue* v = FindCachedValue(key); return ((v != nullptr)? v->i: def); }
+	float GetFloatSafe(const std::string& key, float def) const { const CachedValue* v = FindCachedValue(key); return ((v != nullptr)? v->f: def); }
+	std::string GetStringSafe(const std::string& key, const std::string& def) const { const CachedValue* v = FindCachedValue(key); return ((v != nullptr)? v->s: def); }
 
 public:
 	virtual ~ConfigHandler() {}
@@ -157,20 +162,26 @@ protected:
 	virtual void AddObserver(ConfigNotifyCallback callback, void* observer, const std::vector<std::string>& configs) = 0;
 	virtual void RemoveObserver(void* observer) = 0;
 
-private:
-	/// @see GetString
-	template<typename T>
-	T Get(const std::string& key) const
-	{
-		std::istringstream buf(GetString(key));
-		T temp;
-		buf >> temp;
-		return temp;
-	}
+	/// @brief Invalidates the typed-value caches of all threads
+	static void InvalidateCachedValues();
 
-	/// @see Get
-	/// @brief <bool> specialization of Get<> (we cannot use template spezialization here, so just overload it)
-	bool Get(const std::string& key) const;
+public:
+	/// GetString(key) and its parses as each of the typed getters sees it
+	struct CachedValue {
+		std::string s;
+
+		int i = 0;
+		unsigned u = 0;
+		float f = 0.0f;
+		bool b = false;
+		bool isSet = false;
+	};
+
+private:
+	/// @return nullptr if the key is not set
+	const CachedValue* FindCachedValue(const std::string& key) const;
+	/// throws if the key is not set, like GetString
+	const CachedValue& GetCachedValue(const std::string& key) const;
 };
 
 extern ConfigHandler* configHandler;
@@ -4,6 +4,7 @@
 #define EVENT_CLIENT_H
 
 #include <algorithm>
+#include <array>
 #include <typeinfo>
 #include <string>
 #include <vector>
@@ -74,6 +75,32 @@ class CEventClient
 		inline bool CanReadAllyTeam(int allyTeam) {
 			return (GetFullRead() || (GetReadAllyTeam() == allyTeam));
 		}
+		// false if the above never change during the client's lifetime, which
+		// lets the eventHandler cache them when the client registers
+		virtual bool HasDynamicReadAccess() const { return false; }
+
+		// per-def subscriptions of some high-frequency unit call-ins, tested
+		// by the eventHandler before calling in; an empty mask passes all defs
+		enum DefFilterEvent {
+			DEF_FILTER_UNIT_CREATED   = 0,
+			DEF_FILTER_UNIT_FINISHED  = 1,
+			DEF_FILTER_UNIT_DESTROYED = 2,
+			DEF_FILTER_UNIT_DAMAGED   = 3,
+			DEF_FILTER_EVENT_COUNT    = 4,
+		};
+
+		// UnitDamaged passes the CSolidObject::DAMAGE_* sources as negative
+		// weaponDefID's, these map to the first entries of the weapon mask
+		static constexpr int DAMAGE_WEAPON_FILTER_OFFSET = 8;
+
+		inline bool WantsUnitDef(int event, int unitDefID) const {
+			const std::vector<bool>& mask = unitDefFilters[event];
+			return (mask.empty() || mask[unitDefID]);
+		}
+		inline bool WantsDamageWeaponDef(int weaponDefID) const {
+			const size_t maskIdx = weaponDefID + DAMAGE_WEAPON_FILTER_OFFSET;
+			return (damageWeaponDefFilter.empty() || (maskIdx < damageWeaponDefFilter.size() && damageWeaponDefFilter[maskIdx]));
+		}
 
 	protected:
 		CEventClient(const std::string& name, int order, bool synced);
@@ -85,6 +112,9 @@ class CEventClient
 		const bool        synced_;
 		      bool        autoLinkEvents;
 
+		std::array<std::vector<bool>, DEF_FILTER_EVENT_COUNT> unitDefFilters;
+		std::vector<bool> damageWeaponDefFilter;
+
 	protected:
 		friend class CEventHandler;
 		typedef std::pair<std::string, bool> LinkPair;
@@ -59,7 +59,7 @@ void CEventHandler::SetupEvents()
 
 void CEventHandler::AddClient(CEventClient* ec)
 {
-	ListInsert(handles, ec);
+	handles.Insert(ec);
 
 	for (const auto& element: eventMap) {
 		const EventInfo& ei = element.second;
@@ -79,7 +79,7 @@ void CEventHandler::RemoveClient(CEventClient* ec)
 	if (mouseOwner == ec)
 		mouseOwner = nullptr;
 
-	ListRemove(handles, ec);
+	handles.Remove(ec);
 
 	for (const auto& element: eventMap) {
 		const EventInfo& ei = element.second;
@@ -151,7 +151,7 @@ bool CEventHandler::InsertEvent(CEventClient* ec, const std::string& ciName)
 	if (ec->GetSynced() && iter->second.HasPropBit(UNSYNCED_BIT))
 		return false;
 
-	ListInsert(*iter->second.GetList(), ec);
+	iter->second.GetList()->Insert(ec);
 	return true;
 }
 
@@ -164,44 +164,51 @@ bool CEventHandler::RemoveEvent(CEventClient* ec, const std::string& ciName)
 	if ((iter == eventMap.end()) || (iter->second.GetList() == nullptr) || (iter->first != ciName))
 		return false;
 
-	ListRemove(*(iter->second.GetList()), ec);
+	iter->second.GetList()->Remove(ec);
 	return true;
 }
 
 
 /******************************************************************************/
 
-void CEventHandler::ListInsert(EventClientList& ecList, CEventClient* ec)
+bool CEventHandler::EventClientList::Contains(const CEventClient* ec) const
 {
-	for (auto it = ecList.begin(); it != ecList.end(); ++it) {
-		const CEventClient* ecIt = *it;
+	return (std::find_if(entries.begin(), entries.end(), [&](const Entry& e) { return (e.client == ec); }) != entries.end());
+}
+
+void CEventHandler::EventClientList::Insert(CEventClient* ec)
+{
+	const Entry entry = {ec, ec->HasDynamicReadAccess()? DynamicAccessTeam: (ec->GetFullRead()? int(CEventClient::AllAccessTeam): ec->GetReadAllyTeam())};
+
+	for (auto it = entries.begin(); it != entries.end(); ++it) {
+		const CEventClient* ecIt = it->client;
 
 		if (ec == ecIt)
 			return; // already in the list
 
 		if (ec->GetOrder() < ecIt->GetOrder()) {
-			ecList.insert(it, ec);
+			entries.insert(it, entry);
 			return;
 		}
 		// should not happen
 		if ((ec->GetOrder() == ecIt->GetOrder()) && (ec->GetName() < ecIt->GetName())) {
-			ecList.insert(it, ec);
+			entries.insert(it, entry);
 			return;
 		}
 	}
 
-	ecList.push_back(ec);
+	entries.push_back(entry);
 }
 
-void CEventHandler::ListRemove(EventClientList& ecList, CEventClient* ec)
+void CEventHandler::EventClientList::Remove(CEventClient* ec)
 {
-	const auto ecIt = std::find(ecList.begin(), ecList.end(), ec);
+	const auto it = std::find_if(entries.begin(), entries.end(), [&](const Entry& e) { return (e.client == ec); });
 
 	// erase does not accept end()
-	if (ecIt == ecList.end())
+	if (it == entries.end())
 		return;
 
-	ecList.erase(ecIt);
+	entries.erase(it);
 }
 
 
@@ -551,7 +558,7 @@ void CEventHandler::UnitHarvestStorageFull(const CUnit* unit)
 	const int count = listUnitHarvestStorageFull.size();
 	for (int i = 0; i < count; i++) {
 		CEventClient* ec = listUnitHarvestStorageFull[i];
-		if (ec->CanReadAllyTeam(unitAllyTeam)) {
+		if (listUnitHarvestStorageFull.CanReadAllyTeam(i, unitAllyTeam)) {
 			ec->UnitHarvestStorageFull(unit);
 		}
 	}
@@ -8,6 +8,7 @@
 
 #include "System/EventClient.h"
 #include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitDef.h"
 #include "Sim/Features/Feature.h"
 #include "Sim/Projectiles/Projectile.h"
 
@@ -26,9 +27,7 @@ class CEventHandler
 
 		void AddClient(CEventClient* ec);
 		void RemoveClient(CEventClient* ec);
-		bool HasClient(CEventClient* ec) const {
-			return (std::find(handles.begin(), handles.end(), ec) != handles.end());
-		}
+		bool HasClient(CEventClient* ec) const { return (handles.Contains(ec)); }
 
 		bool InsertEvent(CEventClient* ec, const std::string& ciName);
 		bool RemoveEvent(CEventClient* ec, const std::string& ciName);
@@ -302,7 +301,46 @@ class CEventHandler
 		/// @}
 
 	private:
-		typedef std::vector<CEventClient*> EventClientList;
+		/**
+		 * Per-event clients in one contiguous array, sorted by order and only
+		 * modified on (un)registration. Each entry also caches the read access
+		 * of its client unless that can change at runtime, so the call-in loops
+		 * do not need two virtual calls per client (CanReadAllyTeam) to filter
+		 * engine-side listeners; only the call-in itself is dispatched.
+		 */
+		class EventClientList {
+			public:
+				size_t size() const { return entries.size(); }
+				bool empty() const { return entries.empty(); }
+				void clear() { entries.clear(); }
+				void reserve(size_t n) { entries.reserve(n); }
+
+				CEventClient* operator [] (size_t i) const { return entries[i].client; }
+
+				bool CanReadAllyTeam(size_t i, int allyTeam) const {
+					const Entry& e = entries[i];
+
+					if (e.readAllyTeam == DynamicAccessTeam)
+						return (e.client->CanReadAllyTeam(allyTeam));
+
+					return (e.readAllyTeam == CEventClient::AllAccessTeam || e.readAllyTeam == allyTeam);
+				}
+
+				bool Contains(const CEventClient* ec) const;
+
+				void Insert(CEventClient* ec);
+				void Remove(CEventClient* ec);
+
+			private:
+				static constexpr int DynamicAccessTeam = CEventClient::MinSpecialTeam - 1;
+
+				struct Entry {
+					CEventClient* client;
+					int readAllyTeam;
+				};
+
+				std::vector<Entry> entries;
+		};
 
 		enum EventPropertyBits {
 			MANAGED_BIT  = (1 << 0), // managed by eventHandler
@@ -334,8 +372,6 @@ class CEventHandler
 	private:
 		void SetupEvent(const std::string& ciName,
 		                EventClientList* list, int props);
-		void ListInsert(EventClientList& ciList, CEventClient* ec);
-		void ListRemove(EventClientList& ciList, CEventClient* ec);
 
 	private:
 		CEventClient* mouseOwner;
@@ -375,7 +411,7 @@ extern CEventHandler eventHandler;
 	for (size_t i = 0; i < list##name.size(); ) {                  \
 		CEventClient* ec = list##name[i];                          \
                                                                    \
-		if (ec->CanReadAllyTeam(allyTeam))                         \
+		if (list##name.CanReadAllyTeam(i, allyTeam))               \
 			ec->name(__VA_ARGS__);                                 \
                                                                    \
 		/* the call-in may remove itself from the list */          \
@@ -387,22 +423,51 @@ extern CEventHandler eventHandler;
 	for (size_t i = 0; i < list##name.size(); ) {                  \
 		CEventClient* ec = list##name[i];                          \
                                                                    \
-		if (ec->CanReadAllyTeam(unitAllyTeam))                     \
+		if (list##name.CanReadAllyTeam(i, unitAllyTeam))           \
 			ec->name(unit, __VA_ARGS__);                           \
                                                                    \
 		/* the call-in may remove itself from the list */          \
 		i += (i < list##name.size() && ec == list##name[i]);       \
 	}
 
+// as above, but also skips clients that did not subscribe to the unit's def
+#define ITERATE_UNIT_DEF_EVENTCLIENTLIST(name, filter, unit, ...)               \
+	const auto unitAllyTeam = unit->allyteam;                                   \
+	const auto unitDefID = unit->unitDef->id;                                   \
+	for (size_t i = 0; i < list##name.size(); ) {                               \
+		CEventClient* ec = list##name[i];                                       \
+                                                                                \
+		if (list##name.CanReadAllyTeam(i, unitAllyTeam) && ec->WantsUnitDef(filter, unitDefID)) \
+			ec->name(unit, __VA_ARGS__);                                        \
+                                                                                \
+		/* the call-in may remove itself from the list */                       \
+		i += (i < list##name.size() && ec == list##name[i]);                    \
+	}
+
 inline void CEventHandler::UnitCreated(const CUnit* unit, const CUnit* builder)
 {
-	ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(UnitCreated, unit, builder)
+	ITERATE_UNIT_DEF_EVENTCLIENTLIST(UnitCreated, CEventClient::DEF_FILTER_UNIT_CREATED, unit, builder)
 }
 
 
 inline void CEventHandler::UnitDestroyed(const CUnit* unit, const CUnit* attacker)
 {
-	ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(UnitDestroyed, unit, attacker)
+	ITERATE_UNIT_DEF_EVENTCLIENTLIST(UnitDestroyed, CEventClient::DEF_FILTER_UNIT_DESTROYED, unit, attacker)
+}
+
+inline void CEventHandler::UnitFinished(const CUnit* unit)
+{
+	const auto unitAllyTeam = unit->allyteam;
+	const auto unitDefID = unit->unitDef->id;
+
+	for (size_t i = 0; i < listUnitFinished.size(); ) {
+		CEventClient* ec = listUnitFinished[i];
+
+		if (listUnitFinished.CanReadAllyTeam(i, unitAllyTeam) && ec->WantsUnitDef(CEventClient::DEF_FILTER_UNIT_FINISHED, unitDefID))
+			ec->UnitFinished(unit);
+
+		i += (i < listUnitFinished.size() && ec == listUnitFinished[i]);
+	}
 }
 
 #define UNIT_CALLIN_NO_PARAM(name)                                 \
@@ -412,7 +477,7 @@ inline void CEventHandler::UnitDestroyed(const CUnit* unit, const CUnit* attacke
 		for (size_t i = 0; i < list##name.size(); ) {              \
 			CEventClient* ec = list##name[i];                      \
                                                                    \
-			if (ec->CanReadAllyTeam(unitAllyTeam))                 \
+			if (list##name.CanReadAllyTeam(i, unitAllyTeam))       \
 				ec->name(unit);                                    \
                                                                    \
 			i += (i < list##name.size() && ec == list##name[i]);   \
@@ -420,7 +485,6 @@ inline void CEventHandler::UnitDestroyed(const CUnit* unit, const CUnit* attacke
 	}
 
 UNIT_CALLIN_NO_PARAM(UnitReverseBuilt);
-UNIT_CALLIN_NO_PARAM(UnitFinished)
 UNIT_CALLIN_NO_PARAM(UnitIdle)
 UNIT_CALLIN_NO_PARAM(UnitMoveFailed)
 UNIT_CALLIN_NO_PARAM(UnitEnteredWater)
@@ -527,7 +591,18 @@ inline void CEventHandler::UnitDamaged(
 	int projectileID,
 	bool paralyzer)
 {
-	ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(UnitDamaged, unit, attacker, damage, weaponDefID, projectileID, paralyzer)
+	const auto unitAllyTeam = unit->allyteam;
+	const auto unitDefID = unit->unitDef->id;
+
+	for (size_t i = 0; i < listUnitDamaged.size(); ) {
+		CEventClient* ec = listUnitDamaged[i];
+
+		// the def-filters keep unsubscribed handles from entering Lua for every hit
+		if (listUnitDamaged.CanReadAllyTeam(i, unitAllyTeam) && ec->WantsUnitDef(CEventClient::DEF_FILTER_UNIT_DAMAGED, unitDefID) && ec->WantsDamageWeaponDef(weaponDefID))
+			ec->UnitDamaged(unit, attacker, damage, weaponDefID, projectileID, paralyzer);
+
+		i += (i < listUnitDamaged.size() && ec == listUnitDamaged[i]);
+	}
 }
 
 inline void CEventHandler::UnitStunned(
@@ -561,12 +636,9 @@ inline void CEventHandler::UnitLoaded(const CUnit* unit,
 
 	for (size_t i = 0; i < count; i++) {
 		CEventClient* ec = listUnitLoaded[i];
-		const int ecAllyTeam = ec->GetReadAllyTeam();
-		if (ec->GetFullRead() ||
-		    (ecAllyTeam == unit->allyteam) ||
-		    (ecAllyTeam == transport->allyteam)) {
+
+		if (listUnitLoaded.CanReadAllyTeam(i, unit->allyteam) || listUnitLoaded.CanReadAllyTeam(i, transport->allyteam))
 			ec->UnitLoaded(unit, transport);
-		}
 	}
 }
 
@@ -578,12 +650,9 @@ inline void CEventHandler::UnitUnloaded(const CUnit* unit,
 
 	for (size_t i = 0; i < count; i++) {
 		CEventClient* ec = listUnitUnloaded[i];
-		const int ecAllyTeam = ec->GetReadAllyTeam();
-		if (ec->GetFullRead() ||
-		    (ecAllyTeam == unit->allyteam) ||
-		    (ecAllyTeam == transport->allyteam)) {
+
+		if (listUnitUnloaded.CanReadAllyTeam(i, unit->allyteam) || listUnitUnloaded.CanReadAllyTeam(i, transport->allyteam))
 			ec->UnitUnloaded(unit, transport);
-		}
 	}
 }
 
@@ -595,7 +664,7 @@ inline void CEventHandler::FeatureCreated(const CFeature* feature)
 	for (size_t i = 0; i < count; i++) {
 		CEventClient* ec = listFeatureCreated[i];
 
-		if ((featureAllyTeam < 0) || ec->CanReadAllyTeam(featureAllyTeam))
+		if ((featureAllyTeam < 0) || listFeatureCreated.CanReadAllyTeam(i, featureAllyTeam))
 			ec->FeatureCreated(feature);
 	}
 }
@@ -608,7 +677,7 @@ inline void CEventHandler::FeatureDestroyed(const CFeature* feature)
 	for (size_t i = 0; i < count; i++) {
 		CEventClient* ec = listFeatureDestroyed[i];
 
-		if ((featureAllyTeam < 0) || ec->CanReadAllyTeam(featureAllyTeam))
+		if ((featureAllyTeam < 0) || listFeatureDestroyed.CanReadAllyTeam(i, featureAllyTeam))
 			ec->FeatureDestroyed(feature);
 	}
 }
@@ -626,7 +695,7 @@ inline void CEventHandler::FeatureDamaged(
 	for (size_t i = 0; i < count; i++) {
 		CEventClient* ec = listFeatureDamaged[i];
 
-		if (featureAllyTeam < 0 || ec->CanReadAllyTeam(featureAllyTeam))
+		if (featureAllyTeam < 0 || listFeatureDamaged.CanReadAllyTeam(i, featureAllyTeam))
 			ec->FeatureDamaged(feature, attacker, damage, weaponDefID, projectileID);
 	}
 }
@@ -638,7 +707,7 @@ inline void CEventHandler::FeatureMoved(const CFeature* feature, const float3& o
 	for (size_t i = 0; i < count; i++) {
 		CEventClient* ec = listFeatureMoved[i];
 
-		if ((featureAllyTeam < 0) || ec->CanReadAllyTeam(featureAllyTeam))
+		if ((featureAllyTeam < 0) || listFeatureMoved.CanReadAllyTeam(i, featureAllyTeam))
 			ec->FeatureMoved(feature, oldpos);
 	}
 }
@@ -650,7 +719,7 @@ inline void CEventHandler::ProjectileCreated(const CProjectile* proj, int allyTe
 	for (size_t i = 0; i < count; i++) {
 		CEventClient* ec = listProjectileCreated[i];
 		if ((allyTeam < 0) || // projectile had no owner at creation
-		    ec->CanReadAllyTeam(allyTeam)) {
+		    listProjectileCreated.CanReadAllyTeam(i, allyTeam)) {
 			ec->ProjectileCreated(proj);
 		}
 	}
@@ -664,7 +733,7 @@ inline void CEventHandler::ProjectileDestroyed(const CProjectile* proj, int ally
 	for (size_t i = 0; i < count; i++) {
 		CEventClient* ec = listProjectileDestroyed[i];
 		if ((allyTeam < 0) || // projectile had no owner at creation
-		    ec->CanReadAllyTeam(allyTeam)) {
+		    listProjectileDestroyed.CanReadAllyTeam(i, allyTeam)) {
 			ec->ProjectileDestroyed(proj);
 		}
 	}
@@ -758,6 +827,7 @@ inline void CEventHandler::RenderProjectileDestroyed(const CProjectile* proj)
 
 
 #undef ITERATE_EVENTCLIENTLIST
+#undef ITERATE_UNIT_DEF_EVENTCLIENTLIST
 #undef ITERATE_ALLYTEAM_EVENTCLIENTLIST
 #undef ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST
 #undef UNIT_CALLIN_NO_PARAM
@@ -11,6 +11,9 @@
 #include "Archives/ZipArchive.h"
 #include "Archives/SevenZipArchive.h"
 #include "Archives/VirtualArchive.h"
+#ifdef USE_ZSTD
+#include "Archives/ZstdArchive.h"
+#endif
 
 #include "FileSystem.h"
 #include "DataDirsAccess.h"
@@ -21,6 +24,9 @@ static CDirArchiveFactory sddArchiveFactory;
 static CZipArchiveFactory sdzArchiveFactory;
 static CSevenZipArchiveFactory sd7ArchiveFactory;
 static CVirtualArchiveFactory sdvArchiveFactory;
+#ifdef USE_ZSTD
+static CZstdArchiveFactory sdsArchiveFactory;
+#endif
 
 CArchiveLoader::CArchiveLoader()
 {
@@ -32,6 +38,9 @@ CArchiveLoader::CArchiveLoader()
 	AddFactory(ARCHIVE_TYPE_SDZ, sdzArchiveFactory);
 	AddFactory(ARCHIVE_TYPE_SD7, sd7ArchiveFactory);
 	AddFactory(ARCHIVE_TYPE_SDV, sdvArchiveFactory);
+	#ifdef USE_ZSTD
+	AddFactory(ARCHIVE_TYPE_SDS, sdsArchiveFactory);
+	#endif
 
 	using P = decltype(archiveFactories)::value_type;
 	std::sort(archiveFactories.begin(), archiveFactories.end(), [](const P& a, const P& b) { return (a.first < b.first); });
@@ -54,7 +63,8 @@ bool CArchiveLoader::IsArchiveFile(const std::string& fileName) const
 	const auto pred = [](const P& a, const P& b) { return (a.first < b.first); };
 	const auto iter = std::lower_bound(archiveFactories.begin(), archiveFactories.end(), P{fileExt, nullptr}, pred);
 
-	return (iter != archiveFactories.end() && iter->first == fileExt);
+	// unused slots (types not compiled in) have no factory and an empty extension
+	return (iter != archiveFactories.end() && iter->first == fileExt && iter->second != nullptr);
 }
 
 
@@ -70,7 +80,7 @@ IArchive* CArchiveLoader::OpenArchive(const std::string& fileName, const std::st
 	const auto pred = [](const P& a, const P& b) { return (a.first < b.first); };
 	const auto iter = std::lower_bound(archiveFactories.begin(), archiveFactories.end(), P{fileExt, nullptr}, pred);
 
-	if (iter != archiveFactories.end() && iter->first == fileExt)
+	if (iter != archiveFactories.end() && iter->first == fileExt && iter->second != nullptr)
 		ret = iter->second->CreateArchive(filePath);
 
 	if (ret != nullptr && ret->IsOpen())
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <array>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 
 #include <sys/types.h>
@@ -18,6 +19,7 @@
 #include "DataDirsAccess.h"
 #include "FileSystem.h"
 #include "FileQueryFlags.h"
+#include "MappedFile.h"
 #include "Lua/LuaParser.h"
 #include "System/ContainerUtil.h"
 #include "System/StringUtil.h"
@@ -30,6 +32,7 @@
 
 #if !defined(DEDICATED) && !defined(UNITSYNC)
 	#include "System/TimeProfiler.h"
+	#include "System/Platform/Threading.h"
 	#include "System/Platform/Watchdog.h"
 #endif
 
@@ -52,6 +55,8 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_ARCHIVESCANNER)
  */
 
 constexpr static int INTERNAL_VER = 16;
+// files up to this size are read and hashed sha512::NUM_LANES at a time
+constexpr static int MAX_BATCHED_HASH_FILE_SIZE = 16 * 1024 * 1024;
 
 
 /*
@@ -379,6 +384,13 @@ bool CArchiveScanner::ArchiveData::GetInfoValueBool(const std::string& key) cons
 static spring::recursive_mutex scannerMutex;
 static std::atomic<uint32_t> numScannedArchives{0};
 
+struct ScanScope {
+	 ScanScope(bool* b) { p = b; *p =  true; }
+	~ScanScope(       ) {        *p = false; }
+
+	bool* p = nullptr;
+};
+
 
 /*
  * CArchiveScanner
@@ -390,11 +402,14 @@ CArchiveScanner::CArchiveScanner()
 	// the "cache" dir is created in DataDirLocater
 	ReadCacheData(cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.lua"));
 	ScanAllDirs();
+	StartHashThread();
 }
 
 
 CArchiveScanner::~CArchiveScanner()
 {
+	StopHashThread();
+
 	if (!isDirty)
 		return;
 
@@ -423,6 +438,9 @@ void CArchiveScanner::Clear()
 
 void CArchiveScanner::Reload()
 {
+	// must happen before locking, the thread grabs scannerMutex to commit results
+	StopHashThread();
+
 	// {Read,Write,Scan}* all grab this too but we need the entire reloading-sequence to appear atomic
 	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
 
@@ -434,6 +452,28 @@ void CArchiveScanner::Reload()
 	Clear();
 	ReadCacheData(cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.lua"));
 	ScanAllDirs();
+	StartHashThread();
+}
+
+void CArchiveScanner::Rescan()
+{
+	StopHashThread();
+
+	{
+		std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
+		// whatever is not found again is removed by WriteCacheData
+		for (ArchiveInfo& ai: archiveInfos) {
+			ai.updated = false;
+		}
+		for (BrokenArchive& ba: brokenArchives) {
+			ba.updated = false;
+		}
+
+		ScanAllDirs();
+	}
+
+	StartHashThread();
 }
 
 void CArchiveScanner::ScanAllDirs()
@@ -498,12 +538,39 @@ void CArchiveScanner::ScanDirs(const std::vector<std::string>& scanDirs)
 		}
 	}*/
 
-	// Create archiveInfos etc. if not in cache already
+	// Create archiveInfos etc. if not in cache already; the cache lookups
+	// are cheap but have to run in order, opening and parsing the archives
+	// that missed is independent per archive and done in parallel
+	std::vector<std::pair<std::string, unsigned>> newArchives;
+	std::vector<ArchiveScanResult> scanResults;
+
 	for (const std::string& archive: foundArchives) {
-		ScanArchive(archive, false);
-	#if !defined(DEDICATED) && !defined(UNITSYNC)
-		Watchdog::ClearTimer(WDT_MAIN);
-	#endif
+		unsigned modifiedTime = 0;
+
+		if (CheckCachedData(archive, modifiedTime, false))
+			continue;
+
+		newArchives.emplace_back(archive, modifiedTime);
+	}
+
+	scanResults.resize(newArchives.size());
+
+	{
+		assert(!isInScan);
+		const ScanScope scanScope(&isInScan);
+
+		for_mt(0, newArchives.size(), [&](const int i) {
+			ScanArchiveData(newArchives[i].first, newArchives[i].second, false, scanResults[i]);
+
+			#if !defined(DEDICATED) && !defined(UNITSYNC)
+			Watchdog::ClearTimer(WDT_MAIN);
+			#endif
+		});
+	}
+
+	// merge in found order, duplicates resolve the same as when scanning serially
+	for (size_t i = 0; i < newArchives.size(); i++) {
+		AddScanResult(newArchives[i].first, std::move(scanResults[i]));
 	}
 
 	// Now we'll have to parse the replaces-stuff found in the mods
@@ -640,6 +707,8 @@ CArchiveScanner::BrokenArchive& CArchiveScanner::GetAddBrokenArchive(const std::
 
 void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 {
+	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
 	unsigned modifiedTime = 0;
 
 	assert(!isInScan);
@@ -648,20 +717,22 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		return;
 
 	isDirty = true;
-	isInScan = true;
 
-	struct ScanScope {
-		 ScanScope(bool* b) { p = b; *p =  true; }
-		~ScanScope(       ) {        *p = false; }
+	const ScanScope scanScope(&isInScan);
 
-		bool* p = nullptr;
-	};
+	ArchiveScanResult result;
+	ScanArchiveData(fullName, modifiedTime, doChecksum, result);
+	AddScanResult(fullName, std::move(result));
+}
 
-	const ScanScope scanScope(&isInScan);
+void CArchiveScanner::ScanArchiveData(const std::string& fullName, unsigned modifiedTime, bool doChecksum, ArchiveScanResult& result)
+{
+	ArchiveInfo& ai = result.archiveInfo;
+	ArchiveData& ad = ai.archiveData;
 
-	const std::string& fname = FileSystem::GetFilename(fullName);
-	const std::string& fpath = FileSystem::GetDirectory(fullName);
-	const std::string& lcfn  = StringToLower(fname);
+	ai.path = FileSystem::GetDirectory(fullName);
+	ai.origName = FileSystem::GetFilename(fullName);
+	ai.modified = modifiedTime;
 
 	std::unique_ptr<IArchive> ar(archiveLoader.OpenArchive(fullName));
 
@@ -669,12 +740,7 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		LOG_L(L_WARNING, "[AS::%s] unable to open archive \"%s\"", __func__, fullName.c_str());
 
 		// record it as broken, so we don't need to look inside everytime
-		BrokenArchive& ba = GetAddBrokenArchive(lcfn);
-		ba.name = lcfn;
-		ba.path = fpath;
-		ba.modified = modifiedTime;
-		ba.updated = true;
-		ba.problem = "Unable to open archive";
+		result.problem = "Unable to open archive";
 
 		// does not count as a scan
 		// numScannedArchives += 1;
@@ -690,9 +756,6 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 	const bool hasMapInfo = ar->FileExists("mapinfo.lua");
 
 
-	ArchiveInfo ai;
-	ArchiveData& ad = ai.archiveData;
-
 	// execute the respective .lua, otherwise assume this archive is a map
 	if (hasMapInfo) {
 		ScanArchiveLua(ar.get(), luaInfoFile = "mapinfo.lua", ai, error);
@@ -713,12 +776,7 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		LOG_L(L_WARNING, "[AS::%s] failed to scan \"%s\" (%s)", __func__, fullName.c_str(), error.c_str());
 
 		// mark archive as broken, so we don't need to look inside everytime
-		BrokenArchive& ba = GetAddBrokenArchive(lcfn);
-		ba.name = lcfn;
-		ba.path = fpath;
-		ba.modified = modifiedTime;
-		ba.updated = true;
-		ba.problem = error;
+		result.problem = error;
 
 		// does count as a scan
 		numScannedArchives += 1;
@@ -752,23 +810,55 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		LOG_S(LOG_SECTION_ARCHIVESCANNER, "missing modinfo.lua/mapinfo.lua");
 	}
 
-	ai.path = fpath;
-	ai.modified = modifiedTime;
-
 	// Store modinfo.lua/mapinfo.lua modified timestamp for directory archives, as only they can change.
 	if (ar->GetType() == ARCHIVE_TYPE_SDD && !luaInfoFile.empty()) {
 		ai.archiveDataPath = ar->GetArchiveFile() + "/" + static_cast<const CDirArchive*>(ar.get())->GetOrigFileName(ar->FindFile(luaInfoFile));
 		ai.modifiedArchiveData = FileSystemAbstraction::GetFileModificationTime(ai.archiveDataPath);
 	}
 
-	ai.origName = fname;
 	ai.updated = true;
 	ai.hashed = doChecksum && GetArchiveChecksum(fullName, ai);
 
+	numScannedArchives += 1;
+}
+
+void CArchiveScanner::AddScanResult(const std::string& fullName, ArchiveScanResult&& result)
+{
+	const std::string& lcfn = StringToLower(FileSystem::GetFilename(fullName));
+	const auto aiIter = archiveInfosIndex.find(lcfn);
+
+	// an earlier copy of this archive was found in the same scan
+	if (aiIter != archiveInfosIndex.end() && archiveInfos[aiIter->second].updated) {
+		IgnoreDuplicateArchive(fullName, archiveInfos[aiIter->second]);
+		return;
+	}
+
+	if (!result.problem.empty()) {
+		BrokenArchive& ba = GetAddBrokenArchive(lcfn);
+		ba.name = lcfn;
+		ba.path = std::move(result.archiveInfo.path);
+		ba.modified = result.archiveInfo.modified;
+		ba.updated = true;
+		ba.problem = std::move(result.problem);
+		return;
+	}
+
 	archiveInfosIndex.insert(lcfn, archiveInfos.size());
-	archiveInfos.emplace_back(std::move(ai));
+	archiveInfos.emplace_back(std::move(result.archiveInfo));
+}
 
-	numScannedArchives += 1;
+void CArchiveScanner::IgnoreDuplicateArchive(const std::string& fullName, const ArchiveInfo& ai) const
+{
+	LOG_L(L_ERROR, "[AS::%s] found a \"%s\" already in \"%s\", ignoring.", __func__, fullName.c_str(), (ai.path + ai.origName).c_str());
+
+	if (baseContentArchives.find(StringToLower(ai.origName)) == baseContentArchives.end())
+		return;
+
+	throw user_error(
+		std::string("duplicate base content detected:\n\t") + ai.path +
+		std::string("\n\t") + FileSystem::GetDirectory(fullName) +
+		std::string("\nPlease fix your configuration/installation as this can cause desyncs!")
+	);
 }
 
 
@@ -833,16 +923,8 @@ bool CArchiveScanner::CheckCachedData(const std::string& fullName, unsigned& mod
 	}
 
 	if (ai.updated) {
-		LOG_L(L_ERROR, "[AS::%s] found a \"%s\" already in \"%s\", ignoring.", __func__, fullName.c_str(), (ai.path + ai.origName).c_str());
-
-		if (baseContentArchives.find(aiIter->first) == baseContentArchives.end())
-			return true; // ignore
-
-		throw user_error(
-			std::string("duplicate base content detected:\n\t") + ai.path +
-			std::string("\n\t") + filePath +
-			std::string("\nPlease fix your configuration/installation as this can cause desyncs!")
-		);
+		IgnoreDuplicateArchive(fullName, ai);
+		return true;
 	}
 
 	// if we are here, we could have invalid info in the cache
@@ -917,6 +999,11 @@ IFileFilter* CArchiveScanner::CreateIgnoreFilter(IArchive* ar)
  * Returns 0 if file could not be opened.
  */
 bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, ArchiveInfo& archiveInfo)
+{
+	return (CalcArchiveChecksum(archiveName, archiveInfo.checksum, nullptr));
+}
+
+bool CArchiveScanner::CalcArchiveChecksum(const std::string& archiveName, uint8_t* checksum, const std::atomic<bool>* stopFlag)
 {
 	// try to open an archive
 	std::unique_ptr<IArchive> ar(archiveLoader.OpenArchive(archiveName));
@@ -928,7 +1015,10 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 	std::unique_ptr<IFileFilter> ignore(CreateIgnoreFilter(ar.get()));
 	std::vector<std::string> fileNames;
 	std::vector<sha512::raw_digest> fileHashes;
-	std::array<std::vector<std::uint8_t>, ThreadPool::MAX_THREADS> fileBuffers;
+	std::vector<uint8_t*> fileHashPtrs;
+	std::vector<uint32_t> fileIDs;
+	std::vector<size_t> fileBatches;
+	std::array<std::array<std::vector<std::uint8_t>, sha512::NUM_LANES>, ThreadPool::MAX_THREADS> fileBuffers;
 
 	fileNames.reserve(ar->NumFiles());
 	fileHashes.reserve(ar->NumFiles());
@@ -947,25 +1037,64 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 	// sort by filename
 	std::stable_sort(fileNames.begin(), fileNames.end());
 
+	fileHashPtrs.reserve(fileNames.size());
+	fileIDs.reserve(fileNames.size());
+
+	// split into batches of up to NUM_LANES files hashed together; large files go alone so
+	// that no thread holds several of them in memory at once (start indices, plus the end)
+	bool prevLargeFile = false;
+
+	for (size_t i = 0; i < fileNames.size(); i++) {
+		fileHashPtrs.push_back(fileHashes[i].data());
+		fileIDs.push_back(ar->FindFile(fileNames[i]));
+
+		const bool largeFile = (ar->FileInfo(fileIDs.back()).second > MAX_BATCHED_HASH_FILE_SIZE);
+
+		if (fileBatches.empty() || largeFile || prevLargeFile || (i - fileBatches.back()) == sha512::NUM_LANES)
+			fileBatches.push_back(i);
+
+		prevLargeFile = largeFile;
+	}
+
+	fileBatches.push_back(fileNames.size());
+
+	const auto calcBatchHashes = [&](size_t b, std::vector<std::uint8_t>* buffers) {
+		const size_t i = fileBatches[b];
+		const size_t n = fileBatches[b + 1] - i;
+
+		ar->CalcHashes(&fileIDs[i], n, &fileHashPtrs[i], buffers);
+	};
+
 	// compute hashes of the files
-	for_mt(0, fileNames.size(), [&](const int i) {
-		ar->CalcHash(ar->FindFile(fileNames[i]), fileHashes[i].data(), fileBuffers[ ThreadPool::GetThreadNum() ]);
+	if (stopFlag == nullptr) {
+		for_mt(0, fileBatches.size() - 1, [&](const int b) {
+			calcBatchHashes(b, fileBuffers[ ThreadPool::GetThreadNum() ].data());
 
-		#if !defined(DEDICATED) && !defined(UNITSYNC)
-		Watchdog::ClearTimer(WDT_MAIN);
-		#endif
-	});
+			#if !defined(DEDICATED) && !defined(UNITSYNC)
+			Watchdog::ClearTimer(WDT_MAIN);
+			#endif
+		});
+	} else {
+		// background thread, must not compete with the pool
+		for (size_t b = 0; b < (fileBatches.size() - 1); b++) {
+			if (stopFlag->load())
+				return false;
+
+			calcBatchHashes(b, fileBuffers[0].data());
+		}
+	}
 
 	// combine individual hashes, initialize to hash(name)
 	for (size_t i = 0; i < fileNames.size(); i++) {
-		sha512::calc_digest(reinterpret_cast<const uint8_t*>(fileNames[i].c_str()), fileNames[i].size(), archiveInfo.checksum);
+		sha512::calc_digest(reinterpret_cast<const uint8_t*>(fileNames[i].c_str()), fileNames[i].size(), checksum);
 
 		for (uint8_t j = 0; j < sha512::SHA_LEN; j++) {
-			archiveInfo.checksum[j] ^= fileHashes[i][j];
+			checksum[j] ^= fileHashes[i][j];
 		}
 
 		#if !defined(DEDICATED) && !defined(UNITSYNC)
-		Watchdog::ClearTimer();
+		if (stopFlag == nullptr)
+			Watchdog::ClearTimer();
 		#endif
 	}
 
@@ -973,9 +1102,87 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 }
 
 
+void CArchiveScanner::StartHashThread()
+{
+#if !defined(DEDICATED) && !defined(UNITSYNC)
+	assert(!hashThread.joinable());
+
+	stopHashing = false;
+	hashThread = spring::thread(&CArchiveScanner::HashArchivesThread, this);
+#endif
+}
+
+void CArchiveScanner::StopHashThread()
+{
+	stopHashing = true;
+
+	if (!hashThread.joinable())
+		return;
+
+	hashThread.join();
+}
+
+void CArchiveScanner::HashArchivesThread()
+{
+#if !defined(DEDICATED) && !defined(UNITSYNC)
+	Threading::SetThreadName("archive-hash");
+#endif
+
+	struct PendingArchive {
+		std::string lcName;
+		std::string fullName;
+		uint32_t modified;
+	};
+
+	std::vector<PendingArchive> pendingArchives;
+	sha512::raw_digest checksum;
+
+	{
+		std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
+		for (const ArchiveInfo& ai: archiveInfos) {
+			if (ai.hashed || !ai.replaced.empty() || ai.path.empty())
+				continue;
+
+			pendingArchives.push_back({StringToLower(ai.origName), ai.path + ai.origName, ai.modified});
+		}
+	}
+
+	for (const PendingArchive& pa: pendingArchives) {
+		// hash outside the lock, checksum requests from the main thread should not wait on us
+		if (!CalcArchiveChecksum(pa.fullName, checksum.data(), &stopHashing))
+			continue;
+
+		std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
+		const auto aiIter = archiveInfosIndex.find(pa.lcName);
+
+		if (aiIter == archiveInfosIndex.end())
+			continue;
+
+		ArchiveInfo& ai = archiveInfos[aiIter->second];
+
+		// hashed by a foreground request meanwhile, or rescanned (e.g. via ScanArchive)
+		if (ai.hashed || ai.modified != pa.modified || (ai.path + ai.origName) != pa.fullName)
+			continue;
+
+		std::memcpy(ai.checksum, checksum.data(), sizeof(ai.checksum));
+
+		ai.hashed = true;
+		isDirty = true;
+	}
+}
+
+
 void CArchiveScanner::ReadCacheData(const std::string& filename)
 {
 	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
+	if (ReadBinaryCacheData(GetBinaryCacheFile(filename))) {
+		isDirty = false;
+		return;
+	}
+
 	if (!FileSystem::FileExists(filename)) {
 		LOG_L(L_INFO, "[AS::%s] ArchiveCache %s doesn't exist", __func__, filename.c_str());
 		return;
@@ -1107,6 +1314,8 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 	}
 
 
+	WriteBinaryCacheData(GetBinaryCacheFile(filename));
+
 	fprintf(out, "local archiveCache = {\n\n");
 	fprintf(out, "\tinternalver = %i,\n\n", INTERNAL_VER);
 	fprintf(out, "\tarchives = {  -- count = %u\n", unsigned(archiveInfos.size()));
@@ -1186,6 +1395,331 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 }
 
 
+
+/*
+ * Binary ArchiveCache layout, host byte-order and 4-byte aligned so it
+ * can be used in place from a memory mapping:
+ *   BinaryCacheHeader
+ *   BinaryCacheArchive[numArchives]
+ *   BinaryCacheInfoItem[numInfoItems]  (archives refer to a contiguous range)
+ *   uint32_t[numDependencies]          (string offsets, likewise)
+ *   BinaryCacheBrokenArchive[numBrokenArchives]
+ *   char[stringTableSize]              (NUL-terminated, pooled; offset 0 is "")
+ * All strings are stored as offsets into the string table.
+ */
+namespace {
+	constexpr uint32_t BINARY_CACHE_MAGIC = 0x43415053; // "SPAC"
+	constexpr uint32_t BINARY_CACHE_VERSION = 1;
+
+	struct BinaryCacheHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t internalVersion; // INTERNAL_VER, as for the Lua cache
+
+		uint32_t numArchives;
+		uint32_t numInfoItems;
+		uint32_t numDependencies;
+		uint32_t numBrokenArchives;
+		uint32_t stringTableSize;
+	};
+	struct BinaryCacheArchive {
+		uint32_t origName;
+		uint32_t path;
+		uint32_t archiveDataPath;
+
+		uint32_t modified;
+		uint32_t modifiedArchiveData;
+
+		uint32_t firstInfoItem;
+		uint32_t numInfoItems;
+		uint32_t firstDependency;
+		uint32_t numDependencies;
+
+		uint8_t checksum[sha512::SHA_LEN];
+	};
+	struct BinaryCacheInfoItem {
+		uint32_t key;
+		uint32_t valueType; // InfoValueType
+		uint32_t value;     // string offset, or the bits of the int/float/bool
+	};
+	struct BinaryCacheBrokenArchive {
+		uint32_t name;
+		uint32_t path;
+		uint32_t problem;
+		uint32_t modified;
+	};
+
+	class BinaryCacheStrings {
+	public:
+		BinaryCacheStrings() { table.push_back(0); }
+
+		uint32_t Add(const std::string& str) {
+			if (str.empty())
+				return 0;
+
+			const auto iter = offsets.find(str);
+
+			if (iter != offsets.end())
+				return iter->second;
+
+			const uint32_t offset = table.size();
+
+			table.insert(table.end(), str.begin(), str.end());
+			table.push_back(0);
+
+			offsets.emplace(str, offset);
+			return offset;
+		}
+
+		const std::vector<char>& GetTable() const { return table; }
+
+	private:
+		spring::unordered_map<std::string, uint32_t> offsets;
+		std::vector<char> table;
+	};
+}
+
+bool CArchiveScanner::ReadBinaryCacheData(const std::string& filename)
+{
+	if (!FileSystem::FileExists(filename))
+		return false;
+
+	CMappedFile mapping;
+
+	if (!mapping.Open(filename) || mapping.GetSize() < sizeof(BinaryCacheHeader))
+		return false;
+
+	const uint8_t* data = mapping.GetData();
+
+	BinaryCacheHeader header;
+	std::memcpy(&header, data, sizeof(header));
+
+	if (header.magic != BINARY_CACHE_MAGIC || header.version != BINARY_CACHE_VERSION || header.internalVersion != INTERNAL_VER)
+		return false;
+
+	const size_t archivesOffset = sizeof(BinaryCacheHeader);
+	const size_t infoItemsOffset = archivesOffset + size_t(header.numArchives) * sizeof(BinaryCacheArchive);
+	const size_t dependenciesOffset = infoItemsOffset + size_t(header.numInfoItems) * sizeof(BinaryCacheInfoItem);
+	const size_t brokenArchivesOffset = dependenciesOffset + size_t(header.numDependencies) * sizeof(uint32_t);
+	const size_t stringTableOffset = brokenArchivesOffset + size_t(header.numBrokenArchives) * sizeof(BinaryCacheBrokenArchive);
+
+	if ((stringTableOffset + header.stringTableSize) != mapping.GetSize() || header.stringTableSize == 0) {
+		LOG_L(L_WARNING, "[AS::%s] \"%s\" is truncated or corrupt, using the Lua cache", __func__, filename.c_str());
+		return false;
+	}
+
+	const auto binArchives = reinterpret_cast<const BinaryCacheArchive*>(data + archivesOffset);
+	const auto binInfoItems = reinterpret_cast<const BinaryCacheInfoItem*>(data + infoItemsOffset);
+	const auto binDependencies = reinterpret_cast<const uint32_t*>(data + dependenciesOffset);
+	const auto binBrokenArchives = reinterpret_cast<const BinaryCacheBrokenArchive*>(data + brokenArchivesOffset);
+	const auto stringTable = reinterpret_cast<const char*>(data + stringTableOffset);
+
+	if (stringTable[header.stringTableSize - 1] != 0)
+		return false;
+
+	bool valid = true;
+
+	const auto GetString = [&](uint32_t offset) -> std::string {
+		if (offset >= header.stringTableSize)
+			return (valid = false, "");
+
+		return (stringTable + offset);
+	};
+
+	// validate ranges up front, GetAddArchiveInfo would leave partial entries
+	for (uint32_t i = 0; i < header.numArchives; i++) {
+		const BinaryCacheArchive& ba = binArchives[i];
+
+		valid &= (ba.firstInfoItem <= header.numInfoItems && ba.numInfoItems <= (header.numInfoItems - ba.firstInfoItem));
+		valid &= (ba.firstDependency <= header.numDependencies && ba.numDependencies <= (header.numDependencies - ba.firstDependency));
+	}
+
+	if (!valid)
+		return false;
+
+	for (uint32_t i = 0; i < header.numArchives && valid; i++) {
+		const BinaryCacheArchive& ba = binArchives[i];
+		const std::string& origName = GetString(ba.origName);
+
+		ArchiveInfo& ai = GetAddArchiveInfo(StringToLower(origName));
+		ArchiveInfo tmp; // used to compare against all-zero hash
+
+		ai.origName = origName;
+		ai.path = GetString(ba.path);
+		ai.archiveDataPath = GetString(ba.archiveDataPath);
+		ai.modified = ba.modified;
+		ai.modifiedArchiveData = ba.modifiedArchiveData;
+
+		std::memcpy(ai.checksum, ba.checksum, sha512::SHA_LEN);
+
+		ai.updated = false;
+		ai.hashed = (memcmp(ai.checksum, tmp.checksum, sha512::SHA_LEN) != 0);
+
+		ArchiveData& ad = ai.archiveData;
+
+		// items were written in (sorted) order, no need to re-sort here
+		for (uint32_t j = ba.firstInfoItem; j < (ba.firstInfoItem + ba.numInfoItems); j++) {
+			const BinaryCacheInfoItem& bii = binInfoItems[j];
+			const std::string& key = GetString(bii.key);
+
+			if (key.empty() || ArchiveData::IsReservedKey(StringToLower(key))) {
+				valid = false;
+				break;
+			}
+
+			switch (bii.valueType) {
+				case INFO_VALUE_TYPE_STRING : { ad.SetInfoItemValueString(key, GetString(bii.value)); } break;
+				case INFO_VALUE_TYPE_INTEGER: { ad.SetInfoItemValueInteger(key, int(bii.value)); } break;
+				case INFO_VALUE_TYPE_FLOAT  : { float f; std::memcpy(&f, &bii.value, sizeof(f)); ad.SetInfoItemValueFloat(key, f); } break;
+				case INFO_VALUE_TYPE_BOOL   : { ad.SetInfoItemValueBool(key, bii.value != 0); } break;
+				default                     : { valid = false; } break;
+			}
+		}
+
+		for (uint32_t j = ba.firstDependency; j < (ba.firstDependency + ba.numDependencies); j++) {
+			ad.GetDependencies().push_back(GetString(binDependencies[j]));
+		}
+
+		if (ad.IsMap()) {
+			AddDependency(ad.GetDependencies(), GetMapHelperContentName());
+		} else if (ad.IsGame()) {
+			AddDependency(ad.GetDependencies(), GetSpringBaseContentName());
+		}
+	}
+
+	for (uint32_t i = 0; i < header.numBrokenArchives && valid; i++) {
+		const BinaryCacheBrokenArchive& bba = binBrokenArchives[i];
+		const std::string& name = GetString(bba.name);
+
+		BrokenArchive& ba = GetAddBrokenArchive(name);
+		ba.name = name;
+		ba.path = GetString(bba.path);
+		ba.problem = GetString(bba.problem);
+		ba.modified = bba.modified;
+		ba.updated = false;
+	}
+
+	if (!valid) {
+		LOG_L(L_WARNING, "[AS::%s] \"%s\" is corrupt, using the Lua cache", __func__, filename.c_str());
+		// drop whatever was read so far, the Lua cache is parsed from scratch
+		archiveInfos.clear();
+		archiveInfosIndex.clear();
+		brokenArchives.clear();
+		brokenArchivesIndex.clear();
+		return false;
+	}
+
+	return true;
+}
+
+void CArchiveScanner::WriteBinaryCacheData(const std::string& filename) const
+{
+	BinaryCacheHeader header;
+	BinaryCacheStrings strings;
+
+	std::vector<BinaryCacheArchive> binArchives;
+	std::vector<BinaryCacheInfoItem> binInfoItems;
+	std::vector<uint32_t> binDependencies;
+	std::vector<BinaryCacheBrokenArchive> binBrokenArchives;
+
+	binArchives.reserve(archiveInfos.size());
+	binBrokenArchives.reserve(brokenArchives.size());
+
+	for (const ArchiveInfo& ai: archiveInfos) {
+		BinaryCacheArchive ba;
+
+		ba.origName = strings.Add(ai.origName);
+		ba.path = strings.Add(ai.path);
+		ba.archiveDataPath = strings.Add(ai.archiveDataPath);
+		ba.modified = ai.modified;
+		ba.modifiedArchiveData = ai.modifiedArchiveData;
+		ba.firstInfoItem = binInfoItems.size();
+		ba.firstDependency = binDependencies.size();
+
+		std::memcpy(ba.checksum, ai.checksum, sha512::SHA_LEN);
+
+		// same as the Lua cache, which omits archivedata for nameless archives
+		const ArchiveData& ad = ai.archiveData;
+
+		if (!ad.GetName().empty()) {
+			for (const auto& ii: ad.GetInfo()) {
+				BinaryCacheInfoItem bii = {strings.Add(ii.second.key), uint32_t(ii.second.valueType), 0};
+
+				switch (ii.second.valueType) {
+					case INFO_VALUE_TYPE_STRING : { bii.value = strings.Add(ii.second.valueTypeString); } break;
+					case INFO_VALUE_TYPE_INTEGER: { bii.value = uint32_t(ii.second.value.typeInteger); } break;
+					case INFO_VALUE_TYPE_FLOAT  : { std::memcpy(&bii.value, &ii.second.value.typeFloat, sizeof(bii.value)); } break;
+					case INFO_VALUE_TYPE_BOOL   : { bii.value = ii.second.value.typeBool; } break;
+					default                     : { continue; } break;
+				}
+
+				binInfoItems.push_back(bii);
+			}
+
+			std::vector<std::string> deps = ad.GetDependencies();
+
+			if (ad.IsMap()) {
+				FilterDep(deps, GetMapHelperContentName());
+			} else if (ad.IsGame()) {
+				FilterDep(deps, GetSpringBaseContentName());
+			}
+
+			for (const std::string& dep: deps) {
+				binDependencies.push_back(strings.Add(dep));
+			}
+		}
+
+		ba.numInfoItems = binInfoItems.size() - ba.firstInfoItem;
+		ba.numDependencies = binDependencies.size() - ba.firstDependency;
+
+		binArchives.push_back(ba);
+	}
+
+	for (const BrokenArchive& ba: brokenArchives) {
+		binBrokenArchives.push_back({strings.Add(ba.name), strings.Add(ba.path), strings.Add(ba.problem), ba.modified});
+	}
+
+	const std::vector<char>& stringTable = strings.GetTable();
+
+	header.magic = BINARY_CACHE_MAGIC;
+	header.version = BINARY_CACHE_VERSION;
+	header.internalVersion = INTERNAL_VER;
+	header.numArchives = binArchives.size();
+	header.numInfoItems = binInfoItems.size();
+	header.numDependencies = binDependencies.size();
+	header.numBrokenArchives = binBrokenArchives.size();
+	header.stringTableSize = stringTable.size();
+
+	// write a temporary and move it in place, other instances might read concurrently
+	const std::string tempname = filename + ".tmp";
+
+	FILE* out = fopen(tempname.c_str(), "wb");
+
+	if (out == nullptr) {
+		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, tempname.c_str());
+		return;
+	}
+
+	bool written = (fwrite(&header, sizeof(header), 1, out) == 1);
+
+	written &= (binArchives.empty() || fwrite(binArchives.data(), sizeof(BinaryCacheArchive), binArchives.size(), out) == binArchives.size());
+	written &= (binInfoItems.empty() || fwrite(binInfoItems.data(), sizeof(BinaryCacheInfoItem), binInfoItems.size(), out) == binInfoItems.size());
+	written &= (binDependencies.empty() || fwrite(binDependencies.data(), sizeof(uint32_t), binDependencies.size(), out) == binDependencies.size());
+	written &= (binBrokenArchives.empty() || fwrite(binBrokenArchives.data(), sizeof(BinaryCacheBrokenArchive), binBrokenArchives.size(), out) == binBrokenArchives.size());
+	written &= (fwrite(stringTable.data(), 1, stringTable.size(), out) == stringTable.size());
+	written &= (fclose(out) != EOF);
+
+	if (!written) {
+		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, tempname.c_str());
+		std::remove(tempname.c_str());
+		return;
+	}
+
+	std::remove(filename.c_str());
+	std::rename(tempname.c_str(), filename.c_str());
+}
+
+
 static void sortByName(std::vector<CArchiveScanner::ArchiveData>& data)
 {
 	std::stable_sort(data.begin(), data.end(), [](const CArchiveScanner::ArchiveData& a, const CArchiveScanner::ArchiveData& b) {
@@ -3,6 +3,7 @@
 #ifndef _ARCHIVE_SCANNER_H
 #define _ARCHIVE_SCANNER_H
 
+#include <atomic>
 #include <cstring> // memset
 #include <string>
 #include <deque>
@@ -11,6 +12,7 @@
 #include "System/Info.h"
 #include "System/Sync/SHA512.hpp"
 #include "System/UnorderedMap.hpp"
+#include "System/Threading/SpringThreading.h"
 
 class IArchive;
 class IFileFilter;
@@ -145,6 +147,12 @@ public:
 	void ScanAllDirs();
 	void Clear();
 	void Reload();
+	/**
+	 * Like Reload, but keeps the in-memory state instead of re-reading
+	 * the cache file; only archives that are new or have changed since
+	 * the last scan are opened, vanished ones are dropped.
+	 */
+	void Rescan();
 
 	std::string ArchiveFromName(const std::string& versionedName) const;
 	std::string NameFromArchive(const std::string& archiveName) const;
@@ -184,6 +192,10 @@ private:
 		uint32_t modified = 0;
 		bool updated = false;
 	};
+	struct ArchiveScanResult {
+		ArchiveInfo archiveInfo;
+		std::string problem;      // non-empty if the archive is broken
+	};
 
 private:
 	ArchiveInfo& GetAddArchiveInfo(const std::string& lcfn);
@@ -192,6 +204,15 @@ private:
 	void ScanDirs(const std::vector<std::string>& dirs);
 	void ScanDir(const std::string& curPath, std::deque<std::string>& foundArchives);
 
+	/**
+	 * open an archive and parse its info without touching the scanner state,
+	 * so archives can be scanned in parallel; the result is merged (in order)
+	 * by AddScanResult
+	 */
+	void ScanArchiveData(const std::string& fullName, unsigned modified, bool doChecksum, ArchiveScanResult& result);
+	void AddScanResult(const std::string& fullName, ArchiveScanResult&& result);
+	void IgnoreDuplicateArchive(const std::string& fullName, const ArchiveInfo& ai) const;
+
 	/// scan mapinfo / modinfo lua files
 	bool ScanArchiveLua(IArchive* ar, const std::string& fileName, ArchiveInfo& ai, std::string& err);
 
@@ -205,6 +226,15 @@ private:
 	void ReadCacheData(const std::string& filename);
 	void WriteCacheData(const std::string& filename);
 
+	/**
+	 * Versioned binary copy of the (Lua) ArchiveCache next to it, read
+	 * in its place when valid since parsing Lua is slow for thousands of
+	 * archives; see ArchiveScanner.cpp for the layout.
+	 */
+	bool ReadBinaryCacheData(const std::string& filename);
+	void WriteBinaryCacheData(const std::string& filename) const;
+	static std::string GetBinaryCacheFile(const std::string& filename) { return (filename.substr(0, filename.rfind('.')) + ".bin"); }
+
 	IFileFilter* CreateIgnoreFilter(IArchive* ar);
 
 	/**
@@ -212,6 +242,19 @@ private:
 	 * Returns false if file could not be opened.
 	 */
 	bool GetArchiveChecksum(const std::string& filename, ArchiveInfo& archiveInfo);
+	/**
+	 * Hashes on the thread pool, or serially (aborting once *stopFlag
+	 * is set) if stopFlag is given.
+	 */
+	bool CalcArchiveChecksum(const std::string& filename, uint8_t* checksum, const std::atomic<bool>* stopFlag);
+
+	/**
+	 * Hashes all archives without a cached checksum on a background thread
+	 * after listing, so they are ready when a game is joined or hosted.
+	 */
+	void StartHashThread();
+	void StopHashThread();
+	void HashArchivesThread();
 
 	bool CheckCachedData(const std::string& fullName, unsigned& modified, bool doChecksum);
 
@@ -245,6 +288,9 @@ private:
 
 	std::string cachefile;
 
+	spring::thread hashThread;
+	std::atomic<bool> stopHashing = {false};
+
 	bool isDirty = false;
 	bool isInScan = false;
 };
@@ -27,6 +27,12 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buff
 	int ret = 0;
 
 	if (noCache) {
+		if (fid < fileCache.size() && fileCache[fid].populated) {
+			buffer = std::move(fileCache[fid].data);
+			fileCache[fid] = {};
+			return true;
+		}
+
 		if ((ret = GetFileImpl(fid, buffer)) != 1)
 			LOG_L(L_WARNING, "[BufferedArchive::%s(fid=%u)][noCache] name=%s ret=%d size=" _STPF_, __func__, fid, archiveFile.c_str(), ret, buffer.size());
 
@@ -67,3 +73,24 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buff
 	std::copy(fb.data.begin(), fb.data.end(), buffer.begin());
 	return true;
 }
+
+void CBufferedArchive::AddPrefetchedFile(unsigned int fid, std::vector<std::uint8_t>&& data)
+{
+	std::lock_guard<spring::mutex> lck(archiveLock);
+	assert(IsFileId(fid));
+
+	if (fileCache.empty())
+		fileCache.resize(NumFiles());
+
+	FileBuffer& fb = fileCache[fid];
+
+	if (fb.populated)
+		return;
+
+	fb.data = std::move(data);
+	fb.populated = true;
+	fb.exists = true;
+
+	cacheSize += fb.data.size();
+	fileCount += 1;
+}
@@ -26,6 +26,12 @@ public:
 protected:
 	virtual int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) = 0;
 
+	/**
+	 * Stores a file decoded ahead of time; archives created without
+	 * caching hand it out once from GetFile and then drop it again.
+	 */
+	void AddPrefetchedFile(unsigned int fid, std::vector<std::uint8_t>&& data);
+
 	struct FileBuffer {
 		FileBuffer() = default;
 		FileBuffer(const FileBuffer& fb) = delete;
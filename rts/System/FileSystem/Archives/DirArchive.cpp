@@ -4,11 +4,13 @@
 #include "DirArchive.h"
 
 #include <assert.h>
+#include <climits>
 #include <fstream>
 
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/MappedFile.h"
 #include "System/StringUtil.h"
 
 
@@ -63,6 +65,25 @@ bool CDirArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer)
 	return true;
 }
 
+std::shared_ptr<const CMappedFile> CDirArchive::GetMappedFile(unsigned int fid)
+{
+	assert(IsFileId(fid));
+
+	const std::string rawpath = dataDirsAccess.LocateFile(dirName + searchFiles[fid]);
+	const size_t fileSize = FileSystem::GetFileSize(rawpath);
+
+	// the upper bound also catches size_t(-1) for a missing file, CFileHandler positions are ints
+	if (fileSize < MIN_MAPPED_FILE_SIZE || fileSize > INT_MAX)
+		return nullptr;
+
+	std::shared_ptr<CMappedFile> mappedFile = std::make_shared<CMappedFile>(rawpath);
+
+	if (!mappedFile->IsOpen())
+		return nullptr;
+
+	return mappedFile;
+}
+
 void CDirArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 {
 	assert(IsFileId(fid));
@@ -2,6 +2,8 @@
 
 #include "IArchive.h"
 
+#include <cassert>
+
 #include "System/StringUtil.h"
 
 unsigned int IArchive::FindFile(const std::string& filePath) const
@@ -28,6 +30,29 @@ bool IArchive::CalcHash(uint32_t fid, uint8_t hash[sha512::SHA_LEN], std::vector
 	return true;
 }
 
+void IArchive::CalcHashes(const uint32_t fids[], size_t count, uint8_t* const hashes[], std::vector<std::uint8_t> fbs[])
+{
+	assert(count <= sha512::NUM_LANES);
+
+	const uint8_t* msgs[sha512::NUM_LANES];
+	size_t lens[sha512::NUM_LANES];
+	uint8_t* shas[sha512::NUM_LANES];
+
+	size_t numMsgs = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		if (!GetFile(fids[i], fbs[i]) || fbs[i].empty())
+			continue;
+
+		msgs[numMsgs] = fbs[i].data();
+		lens[numMsgs] = fbs[i].size();
+		shas[numMsgs] = hashes[i];
+		numMsgs++;
+	}
+
+	sha512::calc_digests(msgs, lens, shas, numMsgs);
+}
+
 bool IArchive::GetFile(const std::string& name, std::vector<std::uint8_t>& buffer)
 {
 	const unsigned int fid = FindFile(name);
@@ -3,6 +3,7 @@
 #ifndef _ARCHIVE_BASE_H
 #define _ARCHIVE_BASE_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <cinttypes>
@@ -11,6 +12,8 @@
 #include "System/Sync/SHA512.hpp"
 #include "System/UnorderedMap.hpp"
 
+class CMappedFile;
+
 /**
  * @brief Abstraction of different archive types
  *
@@ -81,6 +84,14 @@ public:
 	 * @see GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer)
 	 */
 	bool GetFile(const std::string& name, std::vector<std::uint8_t>& buffer);
+	/**
+	 * Maps the content of a file read-only, so it can be accessed without
+	 * copying. Only archive types that keep (or can cache) the file
+	 * uncompressed on disk support this, and only for larger files.
+	 * The mapping remains valid after this archive is closed.
+	 * @return the mapping, or nullptr in which case GetFile should be used
+	 */
+	virtual std::shared_ptr<const CMappedFile> GetMappedFile(unsigned int fid) { return nullptr; }
 
 	std::pair<std::string, int> FileInfo(unsigned int fid) const {
 		std::pair<std::string, int> info;
@@ -125,9 +136,19 @@ public:
 	 * Fetches the (SHA512) hash of a file by its ID.
 	 */
 	virtual bool CalcHash(uint32_t fid, uint8_t hash[sha512::SHA_LEN], std::vector<std::uint8_t>& fb);
+	/**
+	 * Fetches the hashes of up to sha512::NUM_LANES files at once, fbs must
+	 * hold as many buffers. Multiple files are hashed side by side (see
+	 * sha512::calc_digests); like CalcHash, this leaves the hashes of empty
+	 * and unreadable files untouched.
+	 */
+	virtual void CalcHashes(const uint32_t fids[], size_t count, uint8_t* const hashes[], std::vector<std::uint8_t> fbs[]);
 
 
 protected:
+	// below this size reading a file is cheaper than mapping it
+	static constexpr unsigned int MIN_MAPPED_FILE_SIZE = 64 * 1024;
+
 	// Spring expects the contents of archives to be case-independent
 	// this map (which must be populated by subclass archives) is kept
 	// to allow converting back from lowercase to original case
@@ -8,11 +8,16 @@
 #include <sstream>
 #include <string>
 #include <cassert>
+#include <climits>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 
 #include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/MappedFile.h"
 #include "System/Exceptions.h"
 #include "System/StringUtil.h"
 #include "System/Log/ILog.h"
@@ -44,6 +49,20 @@ static bool gz_really_read(gzFile file, voidp buf, unsigned int len)
 	return (gzread(file, reinterpret_cast<char*>(buf), len) == len);
 }
 
+// "<first 2 hex chars>/<last 30 hex chars>" of an entry's md5sum
+static std::string GetPoolFileName(const std::array<uint8_t, 16>& md5sum)
+{
+	constexpr const char table[] = "0123456789abcdef";
+	char c_hex[32];
+
+	for (int i = 0; i < 16; ++i) {
+		c_hex[2 * i    ] = table[(md5sum[i] >> 4) & 0xf];
+		c_hex[2 * i + 1] = table[ md5sum[i]       & 0xf];
+	}
+
+	return (std::string(c_hex, 2) + "/" + std::string(c_hex + 2, 30));
+}
+
 
 
 CPoolArchive::CPoolArchive(const std::string& name): CBufferedArchive(name)
@@ -123,6 +142,27 @@ CPoolArchive::~CPoolArchive()
 	}
 }
 
+std::string CPoolArchive::GetPoolFilePath(const FileData& f) const
+{
+	const std::string poolFileName = "pool/" + GetPoolFileName(f.md5sum) + ".gz";
+	      std::string poolFilePath = poolRootDir + "/" + poolFileName;
+
+	FileSystem::FixSlashes(poolFilePath);
+
+	if (FileSystem::FileExists(poolFilePath))
+		return poolFilePath;
+
+	// entries are addressed by content, so the pool of any other data dir can
+	// provide them; several data dirs can share one pool (or hardlink from it)
+	// and need only their own packages/*.sdp that way
+	const std::string sharedFilePath = dataDirsAccess.LocateFile(poolFileName);
+
+	if (!sharedFilePath.empty() && FileSystem::IsAbsolutePath(sharedFilePath))
+		return sharedFilePath;
+
+	return poolFilePath;
+}
+
 int CPoolArchive::GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer)
 {
 	assert(IsFileId(fid));
@@ -130,19 +170,7 @@ int CPoolArchive::GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffe
 	FileData* f = &files[fid];
 	FileStat* s = &stats[fid];
 
-	constexpr const char table[] = "0123456789abcdef";
-	char c_hex[32];
-
-	for (int i = 0; i < 16; ++i) {
-		c_hex[2 * i    ] = table[(f->md5sum[i] >> 4) & 0xf];
-		c_hex[2 * i + 1] = table[ f->md5sum[i]       & 0xf];
-	}
-
-	const std::string prefix(c_hex,      2);
-	const std::string pstfix(c_hex + 2, 30);
-
-	      std::string rpath = poolRootDir + "/pool/" + prefix + "/" + pstfix + ".gz";
-	const std::string  path = FileSystem::FixSlashes(rpath);
+	const std::string path = GetPoolFilePath(*f);
 
 	const spring_time startTime = spring_now();
 
@@ -200,3 +228,63 @@ int CPoolArchive::GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffe
 	sha512::calc_digest(buffer.data(), buffer.size(), f->shasum.data());
 	return 1;
 }
+
+
+std::shared_ptr<const CMappedFile> CPoolArchive::GetMappedFile(unsigned int fid)
+{
+	assert(IsFileId(fid));
+
+	const FileData& f = files[fid];
+
+	if (f.size < MIN_MAPPED_FILE_SIZE || f.size > INT_MAX)
+		return nullptr;
+
+	const std::string blobName = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheBaseDir()) + "pool/" + GetPoolFileName(f.md5sum);
+	const std::shared_ptr<CMappedFile> mappedFile = std::make_shared<CMappedFile>();
+
+	// a size mismatch means the blob was cut short (e.g. disk full), rewrite it
+	if (mappedFile->Open(dataDirsAccess.LocateFile(blobName)) && mappedFile->GetSize() == f.size)
+		return mappedFile;
+
+	mappedFile->Close();
+
+	std::string blobPath;
+
+	{
+		// GetFileImpl is normally guarded by this too, and it keeps blob writes serialized
+		std::lock_guard<spring::mutex> lck(archiveLock);
+		std::vector<std::uint8_t> buffer;
+
+		if (GetFileImpl(fid, buffer) != 1)
+			return nullptr;
+
+		blobPath = dataDirsAccess.LocateFile(blobName, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+
+		if (blobPath.empty())
+			return nullptr;
+
+		// write under a temporary name and move it in place, mappings of an
+		// older blob (also from other processes) keep their own copy that way
+		const std::string tempPath = blobPath + ".tmp";
+
+		{
+			std::ofstream ofs(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+			if (!ofs.write(reinterpret_cast<const char*>(buffer.data()), buffer.size()))
+				LOG_L(L_WARNING, "[PoolArchive::%s] could not write blob \"%s\"", __func__, tempPath.c_str());
+		}
+
+		// can fail on Windows while the old blob is mapped elsewhere; still try to use that one
+		if (std::rename(tempPath.c_str(), blobPath.c_str()) != 0) {
+			std::remove(blobPath.c_str());
+
+			if (std::rename(tempPath.c_str(), blobPath.c_str()) != 0)
+				std::remove(tempPath.c_str());
+		}
+	}
+
+	if (!mappedFile->Open(blobPath) || mappedFile->GetSize() != f.size)
+		return nullptr;
+
+	return mappedFile;
+}
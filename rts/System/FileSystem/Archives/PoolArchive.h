@@ -68,7 +68,8 @@ private:
  * repeated until EOF and formatted as follows:
  *   \<1 byte real file name length\>\<real file name\>\<16 byte MD5 digest\>\<4 byte CRC32\>\<4 byte file size\>
  * The 16-byte MD5 digest is the reference to the 32 hex-char filename
- * under pool/ which contains the content.
+ * under pool/ which contains the content. Entries missing from the pool next
+ * to the .sdp are looked up in the pools of the other data directories.
  *
  * @author Chris Clearwater (det) <chris@detrino.org>
  */
@@ -100,6 +101,19 @@ public:
 		memcpy(hash, fd.shasum.data(), sha512::SHA_LEN);
 		return (memcmp(fd.shasum.data(), dummyFileHash.data(), sizeof(fd.shasum)) != 0);
 	}
+	void CalcHashes(const uint32_t fids[], size_t count, uint8_t* const hashes[], std::vector<std::uint8_t> fbs[]) override {
+		// pool files carry their hashes, nothing to batch
+		for (size_t i = 0; i < count; i++) {
+			CalcHash(fids[i], hashes[i], fbs[i]);
+		}
+	}
+
+	/**
+	 * Pool entries are gzipped, so larger ones are decompressed once into
+	 * a blob cache (under the cache dir, shared by all pool archives since
+	 * entries are addressed by content) and mapped from there.
+	 */
+	std::shared_ptr<const CMappedFile> GetMappedFile(unsigned int fid) override;
 
 protected:
 	int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
@@ -131,6 +145,9 @@ protected:
 		uint64_t readTime;
 	};
 
+private:
+	std::string GetPoolFilePath(const FileData& f) const;
+
 private:
 	bool isOpen = false;
 
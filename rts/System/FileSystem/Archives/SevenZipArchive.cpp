@@ -3,6 +3,7 @@
 #include "SevenZipArchive.h"
 
 #include <algorithm>
+#include <memory>
 #include <stdexcept>
 #include <string.h> //memcpy
 
@@ -260,6 +261,97 @@ void CSevenZipArchive::FileInfo(unsigned int fid, std::string& name, int& size)
 }
 
 
+std::vector<std::vector<unsigned int>> CSevenZipArchive::GetSolidBlocks(size_t maxBytes) const
+{
+	std::vector<std::vector<unsigned int>> blocks(db.db.NumFolders);
+	std::vector<std::vector<unsigned int>> selected;
+
+	for (unsigned int fid = 0; fid < fileEntries.size(); fid++) {
+		const UInt32 folderIndex = db.FileIndexToFolderIndexMap[fileEntries[fid].fp];
+
+		// empty files are not in any block
+		if (folderIndex == ((UInt32)-1))
+			continue;
+
+		blocks[folderIndex].push_back(fid);
+	}
+
+	size_t numBytes = 0;
+
+	for (std::vector<unsigned int>& fids: blocks) {
+		if (fids.empty())
+			continue;
+
+		if ((numBytes + fileEntries[fids[0]].unpackedSize) > maxBytes)
+			continue;
+
+		numBytes += fileEntries[fids[0]].unpackedSize;
+		selected.emplace_back(std::move(fids));
+	}
+
+	// start with the big blocks so the workers finish at about the same time
+	std::sort(selected.begin(), selected.end(), [&](const std::vector<unsigned int>& a, const std::vector<unsigned int>& b) {
+		return (fileEntries[a[0]].unpackedSize > fileEntries[b[0]].unpackedSize);
+	});
+
+	return selected;
+}
+
+size_t CSevenZipArchive::ExtractBlock(const std::vector<unsigned int>& fids)
+{
+	// CLookToRead embeds its read buffer, keep it off the worker's stack
+	struct BlockStream {
+		CFileInStream archiveStream;
+		CLookToRead lookStream;
+	};
+
+	std::unique_ptr<BlockStream> bs(new BlockStream());
+	std::vector<std::vector<std::uint8_t>> buffers(fids.size());
+
+	if (InFile_Open(&bs->archiveStream.file, archiveFile.c_str()) != 0)
+		return 0;
+
+	FileInStream_CreateVTable(&bs->archiveStream);
+	LookToRead_CreateVTable(&bs->lookStream, False);
+
+	bs->lookStream.realStream = &bs->archiveStream.s;
+	LookToRead_Init(&bs->lookStream);
+
+	UInt32 blockIdx = 0xFFFFFFFF;
+	size_t blockBufferSize = 0;
+	size_t numExtracted = 0;
+
+	Byte* blockBuffer = nullptr;
+
+	// the block is decoded on the first call, later ones only copy out of it
+	for (numExtracted = 0; numExtracted < fids.size(); numExtracted++) {
+		assert(IsFileId(fids[numExtracted]));
+
+		size_t offset = 0;
+		size_t outSizeProcessed = 0;
+
+		if (SzArEx_Extract(&db, &bs->lookStream.s, fileEntries[fids[numExtracted]].fp, &blockIdx, &blockBuffer, &blockBufferSize, &offset, &outSizeProcessed, &allocImp, &allocTempImp) != SZ_OK)
+			break;
+
+		buffers[numExtracted].assign(blockBuffer + offset, blockBuffer + offset + outSizeProcessed);
+	}
+
+	if (blockBuffer != nullptr)
+		IAlloc_Free(&allocImp, blockBuffer);
+
+	File_Close(&bs->archiveStream.file);
+
+	size_t numBytes = 0;
+
+	for (size_t i = 0; i < numExtracted; i++) {
+		numBytes += buffers[i].size();
+		AddPrefetchedFile(fids[i], std::move(buffers[i]));
+	}
+
+	return numBytes;
+}
+
+
 bool CSevenZipArchive::HasLowReadingCost(unsigned int fid) const
 {
 	assert(IsFileId(fid));
@@ -45,6 +45,19 @@ public:
 	int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
 	void FileInfo(unsigned int fid, std::string& name, int& size) const override;
 
+	/**
+	 * Groups files by solid block; decoding each block once puts all of
+	 * its files into the cache (see ExtractBlock). Returns the blocks that
+	 * fit into maxBytes of unpacked data, largest first.
+	 */
+	std::vector<std::vector<unsigned int>> GetSolidBlocks(size_t maxBytes) const;
+	/**
+	 * Decodes the files of one block through a private stream, so distinct
+	 * blocks can be extracted from different threads at the same time.
+	 * @return number of bytes extracted
+	 */
+	size_t ExtractBlock(const std::vector<unsigned int>& fids);
+
 	#if 0
 	unsigned GetCrc32(unsigned int fid) {
 		assert(IsFileId(fid));
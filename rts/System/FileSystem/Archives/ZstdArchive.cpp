@@ -0,0 +1,174 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+
+#include "ZstdArchive.h"
+
+#include <cassert>
+#include <cstring>
+
+#include <zstd.h>
+
+#include "System/FileSystem/MappedFile.h"
+#include "System/StringUtil.h"
+#include "System/Log/ILog.h"
+
+
+static std::uint32_t ReadUInt16(const std::uint8_t* p) { return (p[0] | (p[1] << 8)); }
+static std::uint32_t ReadUInt32(const std::uint8_t* p) { return (ReadUInt16(p) | (ReadUInt16(p + 2) << 16)); }
+static std::uint64_t ReadUInt64(const std::uint8_t* p) { return (ReadUInt32(p) | (std::uint64_t(ReadUInt32(p + 4)) << 32)); }
+
+
+static ZSTD_DCtx* GetThreadContext()
+{
+	struct ContextDeleter { void operator () (ZSTD_DCtx* c) const { ZSTD_freeDCtx(c); } };
+
+	// frames of different archives can be decoded on the same thread in turn
+	static thread_local std::unique_ptr<ZSTD_DCtx, ContextDeleter> context(ZSTD_createDCtx());
+	return context.get();
+}
+
+
+IArchive* CZstdArchiveFactory::DoCreateArchive(const std::string& filePath) const
+{
+	return new CZstdArchive(filePath);
+}
+
+
+CZstdArchive::CZstdArchive(const std::string& archiveName)
+	: IArchive(archiveName)
+	, archiveMapping(new CMappedFile())
+{
+	if (!archiveMapping->Open(archiveName)) {
+		LOG_L(L_ERROR, "[%s] error opening \"%s\"", __func__, archiveName.c_str());
+		return;
+	}
+
+	if (!ReadIndex()) {
+		LOG_L(L_ERROR, "[%s] \"%s\" is not a valid .sds archive", __func__, archiveName.c_str());
+		fileEntries.clear();
+		lcNameIndex.clear();
+		return;
+	}
+
+	isOpen = true;
+}
+
+CZstdArchive::~CZstdArchive()
+{
+	ZSTD_freeDDict(dictionary);
+}
+
+
+bool CZstdArchive::ReadIndex()
+{
+	const std::uint8_t* data = archiveMapping->GetData();
+	const std::uint64_t size = archiveMapping->GetSize();
+
+	if (size < HEADER_SIZE || memcmp(data, "SDSA", 4) != 0)
+		return false;
+
+	if (ReadUInt32(data + 4) != VERSION)
+		return false;
+
+	const std::uint32_t numFiles = ReadUInt32(data + 8);
+	const std::uint32_t dictSize = ReadUInt32(data + 12);
+	const std::uint64_t dictOffset = ReadUInt64(data + 16);
+	const std::uint64_t indexOffset = ReadUInt64(data + 24);
+
+	if (dictOffset > size || dictSize > (size - dictOffset) || indexOffset > size)
+		return false;
+
+	if (dictSize > 0 && (dictionary = ZSTD_createDDict_byReference(data + dictOffset, dictSize)) == nullptr)
+		return false;
+
+	// every record takes at least RECORD_SIZE bytes, reject bogus counts before reserving
+	if (numFiles > ((size - indexOffset) / RECORD_SIZE))
+		return false;
+
+	fileEntries.reserve(numFiles);
+
+	for (std::uint64_t pos = indexOffset; fileEntries.size() < numFiles; ) {
+		if ((size - pos) < RECORD_SIZE)
+			return false;
+
+		const std::uint8_t* record = data + pos;
+		const std::uint32_t nameLength = ReadUInt16(record + 18);
+
+		if ((size - pos - RECORD_SIZE) < nameLength)
+			return false;
+
+		FileEntry fe;
+		fe.offset = ReadUInt64(record);
+		fe.packedSize = ReadUInt32(record + 8);
+		fe.size = ReadUInt32(record + 12);
+		fe.method = record[16];
+		fe.origName.assign(reinterpret_cast<const char*>(record + RECORD_SIZE), nameLength);
+
+		pos += (RECORD_SIZE + nameLength);
+
+		if (fe.offset > size || fe.packedSize > (size - fe.offset))
+			return false;
+		if (fe.method > METHOD_ZSTD_DICT || (fe.method == METHOD_ZSTD_DICT && dictionary == nullptr))
+			return false;
+		if (fe.method == METHOD_STORED && fe.packedSize != fe.size)
+			return false;
+		// sizes are passed around as int
+		if (fe.size > 0x7FFFFFFF)
+			return false;
+
+		// exclude directory names
+		if (fe.origName.empty() || fe.origName.back() == '/')
+			continue;
+
+		lcNameIndex.emplace(StringToLower(fe.origName), fileEntries.size());
+		fileEntries.emplace_back(std::move(fe));
+	}
+
+	return true;
+}
+
+
+void CZstdArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
+{
+	assert(IsFileId(fid));
+
+	name = fileEntries[fid].origName;
+	size = fileEntries[fid].size;
+}
+
+bool CZstdArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer)
+{
+	assert(IsFileId(fid));
+
+	// all state touched here is read-only after construction
+	const FileEntry& fe = fileEntries[fid];
+	const std::uint8_t* payload = archiveMapping->GetData() + fe.offset;
+
+	buffer.resize(fe.size);
+
+	if (fe.method == METHOD_STORED) {
+		std::copy(payload, payload + fe.size, buffer.begin());
+		return true;
+	}
+
+	ZSTD_DCtx* context = GetThreadContext();
+
+	if (context == nullptr)
+		return false;
+
+	size_t result = 0;
+
+	if (fe.method == METHOD_ZSTD_DICT) {
+		result = ZSTD_decompress_usingDDict(context, buffer.data(), buffer.size(), payload, fe.packedSize, dictionary);
+	} else {
+		result = ZSTD_decompressDCtx(context, buffer.data(), buffer.size(), payload, fe.packedSize);
+	}
+
+	if (ZSTD_isError(result) || result != fe.size) {
+		LOG_L(L_ERROR, "[%s] could not decompress \"%s\" from \"%s\": %s", __func__, fe.origName.c_str(), archiveFile.c_str(), ZSTD_isError(result)? ZSTD_getErrorName(result): "size mismatch");
+		buffer.clear();
+		return false;
+	}
+
+	return true;
+}
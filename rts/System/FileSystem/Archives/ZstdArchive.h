@@ -0,0 +1,109 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _ZSTD_ARCHIVE_H
+#define _ZSTD_ARCHIVE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "IArchiveFactory.h"
+#include "IArchive.h"
+
+class CMappedFile;
+struct ZSTD_DDict_s;
+
+/**
+ * Creates zstd compressed, random-access archives.
+ * @see CZstdArchive
+ */
+class CZstdArchiveFactory : public IArchiveFactory {
+public:
+	CZstdArchiveFactory(): IArchiveFactory("sds") {}
+
+private:
+	IArchive* DoCreateArchive(const std::string& filePath) const;
+};
+
+
+/**
+ * A single-file archive (.sds) in which every file is its own zstd frame,
+ * so any file can be decompressed without touching the others and several
+ * files in parallel. Small files of the same kind (Lua sources, FBI/TDF
+ * definitions) can share a dictionary, which recovers most of the ratio a
+ * solid archive gets from compressing them together.
+ *
+ * The archive is memory-mapped whole; frames are decoded straight from the
+ * mapping and nothing but the index is read when the archive is opened.
+ * tools/scripts/make_sds.py creates these archives from a directory.
+ *
+ * Layout, all integers little-endian:
+ *   header (32 bytes)
+ *     char[4]  magic "SDSA"
+ *     uint32   version (1)
+ *     uint32   number of files
+ *     uint32   dictionary size, 0 if there is none
+ *     uint64   dictionary offset
+ *     uint64   index offset
+ *   file data
+ *     one payload per file; stored payloads start at a 4KB boundary and
+ *     frames at a 16 byte boundary
+ *   dictionary
+ *   index, one record per file
+ *     uint64   payload offset
+ *     uint32   payload size
+ *     uint32   file size
+ *     uint8    method (0 stored, 1 zstd, 2 zstd with the dictionary)
+ *     uint8    reserved (0)
+ *     uint16   name length
+ *     char[]   name relative to the archive root, using forward slashes
+ */
+class CZstdArchive : public IArchive
+{
+public:
+	CZstdArchive(const std::string& archiveName);
+	~CZstdArchive();
+
+	int GetType() const override { return ARCHIVE_TYPE_SDS; }
+
+	bool IsOpen() override { return isOpen; }
+
+	unsigned int NumFiles() const override { return (fileEntries.size()); }
+	bool GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
+	void FileInfo(unsigned int fid, std::string& name, int& size) const override;
+
+public:
+	enum {
+		METHOD_STORED    = 0,
+		METHOD_ZSTD      = 1,
+		METHOD_ZSTD_DICT = 2,
+	};
+
+	static constexpr unsigned int HEADER_SIZE = 32;
+	static constexpr unsigned int RECORD_SIZE = 20; // without the name
+	static constexpr unsigned int VERSION = 1;
+
+private:
+	bool ReadIndex();
+
+private:
+	struct FileEntry {
+		std::string origName;
+
+		std::uint64_t offset;
+		std::uint32_t packedSize;
+		std::uint32_t size;
+		std::uint8_t method;
+	};
+
+	std::vector<FileEntry> fileEntries;
+
+	std::unique_ptr<CMappedFile> archiveMapping;
+
+	// shared by all threads, decompression contexts are per-thread
+	ZSTD_DDict_s* dictionary = nullptr;
+
+	bool isOpen = false;
+};
+
+#endif // _ZSTD_ARCHIVE_H
@@ -16,6 +16,7 @@
 
 #include "FileQueryFlags.h"
 #include "FileSystem.h"
+#include "MappedFile.h"
 
 #ifndef TOOLS
 	#include "VFSHandler.h"
@@ -92,7 +93,17 @@ bool CFileHandler::TryReadFromVFS(const string& fileName, int section)
 	if (vfsHandler == nullptr)
 		return (loadCode = -2, false);
 
-	if ((loadCode = vfsHandler->LoadFile(StringToLower(fileName), fileBuffer, (CVFSHandler::Section) section)) == 1) {
+	const std::string& lcFileName = StringToLower(fileName);
+
+	// larger files in dir- and pool-archives are mapped rather than copied
+	if ((fileMapping = vfsHandler->MapFile(lcFileName, (CVFSHandler::Section) section)) != nullptr) {
+		fileBuffer.clear();
+		fileSize = fileMapping->GetSize();
+		loadCode = 1;
+		return true;
+	}
+
+	if ((loadCode = vfsHandler->LoadFile(lcFileName, fileBuffer, (CVFSHandler::Section) section)) == 1) {
 		// capacity can exceed size if FH was used to open more than one file
 		// assert(fileBuffer.size() == fileBuffer.capacity());
 
@@ -122,6 +133,18 @@ void CFileHandler::Open(const string& fileName, const string& modes)
 	}
 }
 
+void CFileHandler::Open(const string& fileName, std::vector<std::uint8_t>&& fileData)
+{
+	Close();
+
+	this->fileName = fileName;
+
+	fileBuffer = std::move(fileData);
+	fileSize = fileBuffer.size();
+	loadCode = 1;
+}
+
+
 void CFileHandler::Close()
 {
 	filePos = 0;
@@ -130,6 +153,7 @@ void CFileHandler::Close()
 
 	ifs.close();
 	fileBuffer.clear();
+	fileMapping.reset();
 }
 
 
@@ -173,15 +197,16 @@ int CFileHandler::Read(void* buf, int length)
 		return ifs.gcount();
 	}
 
-	if (fileBuffer.empty())
+	const std::uint8_t* fileData = GetBufferData();
+
+	if (fileData == nullptr)
 		return 0;
 
 	if ((length + filePos) > fileSize)
 		length = fileSize - filePos;
 
 	if (length > 0) {
-		assert(fileBuffer.size() >= (filePos + length));
-		memcpy(buf, &fileBuffer[filePos], length);
+		memcpy(buf, fileData + filePos, length);
 		filePos += length;
 	}
 
@@ -218,7 +243,7 @@ void CFileHandler::Seek(int length, std::ios_base::seekdir where)
 		ifs.seekg(length, where);
 		return;
 	}
-	if (fileBuffer.empty())
+	if (!IsBuffered())
 		return;
 
 	switch (where) {
@@ -234,7 +259,7 @@ bool CFileHandler::Eof() const
 	if (ifs.is_open())
 		return ifs.eof();
 
-	if (!fileBuffer.empty())
+	if (IsBuffered())
 		return (filePos >= fileSize);
 
 	return true;
@@ -250,6 +275,28 @@ int CFileHandler::GetPos()
 }
 
 
+std::vector<std::uint8_t>& CFileHandler::GetBuffer()
+{
+	if (fileMapping != nullptr) {
+		fileBuffer.assign(fileMapping->GetData(), fileMapping->GetData() + fileMapping->GetSize());
+		fileMapping.reset();
+	}
+
+	return fileBuffer;
+}
+
+const std::uint8_t* CFileHandler::GetBufferData() const
+{
+	if (fileMapping != nullptr)
+		return (fileMapping->GetData());
+
+	if (fileBuffer.empty())
+		return nullptr;
+
+	return (fileBuffer.data());
+}
+
+
 bool CFileHandler::LoadStringData(string& data)
 {
 	if (!FileExists())
@@ -4,12 +4,15 @@
 #define _FILE_HANDLER_H
 
 #include <vector>
+#include <memory>
 #include <string>
 #include <fstream>
 #include <cinttypes>
 
 #include "VFSModes.h"
 
+class CMappedFile;
+
 /**
  * This is for direct VFS file content access.
  * If you need data-dir related file and dir handling methods,
@@ -27,6 +30,8 @@ public:
 	virtual ~CFileHandler() { Close(); }
 
 	void Open(const std::string& fileName, const std::string& modes = SPRING_VFS_RAW_FIRST);
+	// takes over content read by other means, e.g. from an archive opened outside the VFS
+	void Open(const std::string& fileName, std::vector<std::uint8_t>&& fileData);
 	void Close();
 
 	int Read(void* buf, int length);
@@ -37,7 +42,7 @@ public:
 	// true if any of TryReadFrom{RawFS,PWD,VFS} succeed
 	bool FileExists() const { return (fileSize >= 0); }
 	// true if (and only if) TryReadFromVFS succeeds
-	bool IsBuffered() const { return (!fileBuffer.empty()); }
+	bool IsBuffered() const { return (!fileBuffer.empty() || fileMapping != nullptr); }
 
 	bool Eof() const;
 	int GetPos();
@@ -49,7 +54,12 @@ public:
 	static std::string GetFileAbsolutePath(const std::string& filePath, const std::string& modes);
 	static std::string GetArchiveContainingFile(const std::string& filePath, const std::string& modes);
 
-	std::vector<std::uint8_t>& GetBuffer() { return fileBuffer; }
+	// copies the file out if it was mapped, callers may take ownership
+	std::vector<std::uint8_t>& GetBuffer();
+	// read-only view of a buffered file without copying, nullptr if not buffered
+	const std::uint8_t* GetBufferData() const;
+	// shared with the caller so the view can outlive this handler, nullptr if not mapped
+	std::shared_ptr<const CMappedFile> GetMappedFile() const { return fileMapping; }
 
 	static bool InReadDir(const std::string& path);
 	static bool InWriteDir(const std::string& path);
@@ -78,6 +88,8 @@ protected:
 	std::string fileName;
 	std::ifstream ifs;
 	std::vector<std::uint8_t> fileBuffer;
+	// set instead of fileBuffer for files the VFS can map
+	std::shared_ptr<const CMappedFile> fileMapping;
 
 	int filePos = 0;
 	int fileSize = -1;
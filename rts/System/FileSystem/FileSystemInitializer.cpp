@@ -3,6 +3,7 @@
 #include "FileSystemInitializer.h"
 #include "DataDirLocater.h"
 #include "ArchiveScanner.h"
+#include "VFSAsyncLoader.h"
 #include "VFSHandler.h"
 #include "System/LogOutput.h"
 #include "System/SafeUtil.h"
@@ -96,6 +97,9 @@ bool FileSystemInitializer::Initialize()
 void FileSystemInitializer::Cleanup(bool deallocConfigHandler)
 {
 	if (initSuccess) {
+		// in-flight loads still read from the archives
+		CVFSAsyncLoader::GetInstance().Kill();
+
 		spring::SafeDelete(archiveScanner);
 		CVFSHandler::FreeGlobalInstance();
 
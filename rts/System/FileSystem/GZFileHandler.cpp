@@ -47,6 +47,13 @@ bool CGZFileHandler::ReadToBuffer(const std::string& path)
 	while (true) {
 		int unzippedBytes = gzread(file, unzipBuffer, BUFFER_SIZE);
 		if (unzippedBytes < 0) {
+			int errNum = Z_OK;
+			gzerror(file, &errNum);
+
+			// file was cut short (e.g. a demo of a crashed game), keep what could be read
+			if (errNum == Z_BUF_ERROR && !fileBuffer.empty())
+				break;
+
 			fileBuffer.clear();
 			fileSize = -1;
 			gzclose(file);
@@ -65,7 +72,8 @@ bool CGZFileHandler::ReadToBuffer(const std::string& path)
 bool CGZFileHandler::UncompressBuffer()
 {
 	std::vector<std::uint8_t> compressed;
-	std::swap(compressed, fileBuffer);
+	// GetBuffer copies mapped files out
+	std::swap(compressed, GetBuffer());
 
 
 	z_stream zstream;
@@ -86,7 +94,8 @@ bool CGZFileHandler::UncompressBuffer()
 		zstream.avail_out = BUFFER_SIZE;
 		zstream.next_out = unzipBuffer;
 		const int ret = inflate(&zstream, Z_NO_FLUSH);
-		if (ret != Z_OK) {
+		if (ret != Z_OK && ret != Z_STREAM_END && (ret != Z_BUF_ERROR || fileBuffer.empty())) {
+			inflateEnd(&zstream);
 			fileBuffer.clear();
 			fileSize = -1;
 			return false;
@@ -95,8 +104,17 @@ bool CGZFileHandler::UncompressBuffer()
 		const size_t unzippedBytes = BUFFER_SIZE - zstream.avail_out;
 		fileBuffer.insert(fileBuffer.end(), unzipBuffer, unzipBuffer + unzippedBytes);
 
-		if (ret == Z_STREAM_END)
+		// input ran out mid-member, keep what could be read as ReadToBuffer does
+		if (ret == Z_BUF_ERROR)
 			break;
+
+		if (ret == Z_STREAM_END) {
+			// gzip files can consist of several concatenated members
+			if (zstream.avail_in == 0)
+				break;
+
+			inflateReset(&zstream);
+		}
 	}
 
 	inflateEnd(&zstream);
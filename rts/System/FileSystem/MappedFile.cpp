@@ -0,0 +1,100 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "MappedFile.h"
+
+#include "System/Log/ILog.h"
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#else
+	#include <windows.h>
+#endif
+
+
+bool CMappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+	#ifndef _WIN32
+	if ((fileDesc = open(filePath.c_str(), O_RDONLY)) < 0)
+		return false;
+
+	struct stat info;
+
+	if (fstat(fileDesc, &info) != 0 || info.st_size <= 0) {
+		Close();
+		return false;
+	}
+
+	void* ptr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fileDesc, 0);
+
+	if (ptr == MAP_FAILED) {
+		LOG_L(L_WARNING, "[MappedFile::%s] mmap failed for \"%s\"", __func__, filePath.c_str());
+		Close();
+		return false;
+	}
+
+	data = reinterpret_cast<const std::uint8_t*>(ptr);
+	size = info.st_size;
+	#else
+	fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		fileHandle = nullptr;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0) {
+		Close();
+		return false;
+	}
+
+	if ((mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr)) == nullptr) {
+		Close();
+		return false;
+	}
+
+	void* ptr = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+	if (ptr == nullptr) {
+		LOG_L(L_WARNING, "[MappedFile::%s] MapViewOfFile failed for \"%s\"", __func__, filePath.c_str());
+		Close();
+		return false;
+	}
+
+	data = reinterpret_cast<const std::uint8_t*>(ptr);
+	size = fileSize.QuadPart;
+	#endif
+
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	#ifndef _WIN32
+	if (data != nullptr)
+		munmap(const_cast<std::uint8_t*>(data), size);
+	if (fileDesc >= 0)
+		close(fileDesc);
+
+	fileDesc = -1;
+	#else
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mappingHandle != nullptr)
+		CloseHandle(mappingHandle);
+	if (fileHandle != nullptr)
+		CloseHandle(fileHandle);
+
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+	#endif
+
+	data = nullptr;
+	size = 0;
+}
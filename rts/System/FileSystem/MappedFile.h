@@ -0,0 +1,45 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _MAPPED_FILE_H
+#define _MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Read-only memory mapping of a raw (non-VFS) file. Pages are faulted
+ * in by the OS on first access, so opening even a huge file costs next
+ * to nothing until its contents are actually read.
+ */
+class CMappedFile
+{
+public:
+	CMappedFile() = default;
+	CMappedFile(const std::string& filePath) { Open(filePath); }
+	CMappedFile(const CMappedFile&) = delete;
+	~CMappedFile() { Close(); }
+
+	CMappedFile& operator = (const CMappedFile&) = delete;
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	bool IsOpen() const { return (data != nullptr); }
+
+	const std::uint8_t* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+private:
+	const std::uint8_t* data = nullptr;
+	size_t size = 0;
+
+	#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+	#else
+	int fileDesc = -1;
+	#endif
+};
+
+#endif // _MAPPED_FILE_H
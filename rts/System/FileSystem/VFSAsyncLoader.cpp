@@ -0,0 +1,190 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "VFSAsyncLoader.h"
+
+#include <algorithm>
+
+#include "FileHandler.h"
+#include "System/Log/ILog.h"
+#include "System/Platform/Threading.h"
+
+
+CVFSAsyncLoader& CVFSAsyncLoader::GetInstance()
+{
+	static CVFSAsyncLoader loader;
+	return loader;
+}
+
+
+void CVFSAsyncLoader::Kill()
+{
+	std::vector<Request> cancelled;
+
+	{
+		std::lock_guard<decltype(requestMutex)> lck(requestMutex);
+
+		stopThreads = true;
+		cancelled.swap(requests);
+	}
+
+	requestCond.notify_all();
+
+	for (spring::thread& t: threads) {
+		t.join();
+	}
+
+	threads.clear();
+
+	for (Request& r: cancelled) {
+		Complete(r, {r.filePath, {}, false});
+	}
+
+	std::lock_guard<decltype(requestMutex)> lck(requestMutex);
+	stopThreads = false;
+}
+
+
+std::future<CVFSAsyncLoader::LoadResult> CVFSAsyncLoader::Load(const std::string& filePath, const std::string& modes, Priority priority)
+{
+	Request request;
+	request.filePath = filePath;
+	request.modes = modes;
+	request.priority = priority;
+
+	std::future<LoadResult> result = request.promise.get_future();
+
+	Submit(std::move(request));
+	return result;
+}
+
+std::vector<std::future<CVFSAsyncLoader::LoadResult>> CVFSAsyncLoader::Load(const std::vector<std::string>& filePaths, const std::string& modes, Priority priority)
+{
+	std::vector<std::future<LoadResult>> results;
+	results.reserve(filePaths.size());
+
+	for (const std::string& filePath: filePaths) {
+		results.emplace_back(Load(filePath, modes, priority));
+	}
+
+	return results;
+}
+
+void CVFSAsyncLoader::Load(const std::vector<std::string>& filePaths, const LoadCallback& callback, const std::string& modes, Priority priority)
+{
+	for (const std::string& filePath: filePaths) {
+		Request request;
+		request.filePath = filePath;
+		request.modes = modes;
+		request.priority = priority;
+		request.callback = callback;
+
+		Submit(std::move(request));
+	}
+}
+
+
+size_t CVFSAsyncLoader::GetNumPendingRequests() const
+{
+	std::lock_guard<decltype(requestMutex)> lck(requestMutex);
+	return requests.size();
+}
+
+
+void CVFSAsyncLoader::Submit(Request&& request)
+{
+	{
+		std::lock_guard<decltype(requestMutex)> lck(requestMutex);
+
+		request.sequence = numRequests++;
+
+		requests.emplace_back(std::move(request));
+		std::push_heap(requests.begin(), requests.end());
+
+		StartThreads();
+	}
+
+	requestCond.notify_one();
+}
+
+void CVFSAsyncLoader::StartThreads()
+{
+	// requestMutex is held
+	if (!threads.empty())
+		return;
+
+	threads.reserve(NUM_THREADS);
+
+	for (int i = 0; i < NUM_THREADS; i++) {
+		threads.emplace_back(&CVFSAsyncLoader::LoaderThreadFunc, this);
+	}
+}
+
+void CVFSAsyncLoader::LoaderThreadFunc()
+{
+#if !defined(DEDICATED) && !defined(UNITSYNC)
+	Threading::SetThreadName("vfs-loader");
+#endif
+
+	while (true) {
+		Request request;
+
+		{
+			std::unique_lock<decltype(requestMutex)> lck(requestMutex);
+			requestCond.wait(lck, [&]() { return (stopThreads || !requests.empty()); });
+
+			if (stopThreads)
+				return;
+
+			std::pop_heap(requests.begin(), requests.end());
+			request = std::move(requests.back());
+			requests.pop_back();
+		}
+
+		LoadResult result;
+
+		try {
+			result = LoadFile(request);
+		} catch (const std::exception& e) {
+			LOG_L(L_WARNING, "[VFSAsyncLoader::%s] could not load \"%s\": %s", __func__, request.filePath.c_str(), e.what());
+			result = {request.filePath, {}, false};
+		}
+
+		Complete(request, std::move(result));
+	}
+}
+
+
+void CVFSAsyncLoader::Complete(Request& request, LoadResult&& result)
+{
+	if (request.callback) {
+		try {
+			request.callback(std::move(result));
+		} catch (const std::exception& e) {
+			LOG_L(L_ERROR, "[VFSAsyncLoader::%s] callback for \"%s\" threw: %s", __func__, request.filePath.c_str(), e.what());
+		}
+		return;
+	}
+
+	request.promise.set_value(std::move(result));
+}
+
+CVFSAsyncLoader::LoadResult CVFSAsyncLoader::LoadFile(const Request& request)
+{
+	// CFileHandler reaches the VFS through vfsHandler, which pins the
+	// archive a file is read from until the read is done
+	CFileHandler fh(request.filePath, request.modes);
+	LoadResult result = {request.filePath, {}, false};
+
+	if (!fh.FileExists())
+		return result;
+
+	if (fh.IsBuffered()) {
+		result.data = std::move(fh.GetBuffer());
+		result.exists = true;
+		return result;
+	}
+
+	result.data.resize(fh.FileSize());
+	result.exists = (fh.Read(result.data.data(), result.data.size()) == fh.FileSize());
+	return result;
+}
@@ -0,0 +1,104 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _VFS_ASYNC_LOADER_H
+#define _VFS_ASYNC_LOADER_H
+
+#include <cinttypes>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "VFSModes.h"
+#include "System/Threading/SpringThreading.h"
+
+/**
+ * Loads files through CFileHandler on a small, fixed set of I/O threads so
+ * callers can overlap reading and decompressing (7z, zip, sdp pool) archive
+ * members with other work instead of blocking on each file in turn.
+ *
+ * Requests are served by priority, in submission order within a priority.
+ * Results are either handed out through futures or passed to a callback,
+ * which runs on a loader thread and must not touch non-thread-safe state.
+ */
+class CVFSAsyncLoader
+{
+public:
+	enum Priority: int {
+		PRIORITY_HIGH   = 0, // something is about to wait on the result
+		PRIORITY_NORMAL = 1, // textures, models, sounds
+		PRIORITY_LOW    = 2, // speculative prefetching
+	};
+
+	struct LoadResult {
+		std::string filePath;
+		std::vector<std::uint8_t> data;
+
+		// false if the file was not found or the loader was stopped first
+		bool exists = false;
+	};
+
+	typedef std::function<void(LoadResult&&)> LoadCallback;
+
+public:
+	~CVFSAsyncLoader() { Kill(); }
+
+	static CVFSAsyncLoader& GetInstance();
+
+	// I/O-bound, more threads would only contend for the archive locks
+	static constexpr int NUM_THREADS = 2;
+
+	/**
+	 * Joins the loader threads; requests that did not start yet complete
+	 * with exists=false. Must be called before the VFS is torn down, the
+	 * threads are restarted by the next Load.
+	 */
+	void Kill();
+
+	std::future<LoadResult> Load(const std::string& filePath, const std::string& modes = SPRING_VFS_RAW_FIRST, Priority priority = PRIORITY_NORMAL);
+	std::vector<std::future<LoadResult>> Load(const std::vector<std::string>& filePaths, const std::string& modes = SPRING_VFS_RAW_FIRST, Priority priority = PRIORITY_NORMAL);
+
+	/// @param callback invoked once per path, on a loader thread
+	void Load(const std::vector<std::string>& filePaths, const LoadCallback& callback, const std::string& modes = SPRING_VFS_RAW_FIRST, Priority priority = PRIORITY_NORMAL);
+
+	size_t GetNumPendingRequests() const;
+
+private:
+	struct Request {
+		std::string filePath;
+		std::string modes;
+
+		Priority priority;
+		std::uint64_t sequence;
+
+		std::promise<LoadResult> promise;
+		LoadCallback callback;
+
+		// max-heap: the highest priority and oldest request comes out first
+		bool operator < (const Request& r) const {
+			if (priority != r.priority)
+				return (priority > r.priority);
+			return (sequence > r.sequence);
+		}
+	};
+
+	void Submit(Request&& request);
+	void StartThreads();
+	void LoaderThreadFunc();
+
+	static void Complete(Request& request, LoadResult&& result);
+	static LoadResult LoadFile(const Request& request);
+
+private:
+	mutable spring::mutex requestMutex;
+	spring::condition_variable requestCond;
+
+	std::vector<Request> requests;
+	std::vector<spring::thread> threads;
+
+	std::uint64_t numRequests = 0;
+
+	bool stopThreads = false;
+};
+
+#endif // _VFS_ASYNC_LOADER_H
@@ -4,11 +4,16 @@
 #include "VFSHandler.h"
 
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <deque>
+#include <fstream>
+#include <shared_mutex>
 
 #include "ArchiveLoader.h"
 #include "ArchiveScanner.h"
 #include "FileSystem.h"
+#include "FileSystemAbstraction.h"
 #include "System/FileSystem/Archives/IArchive.h"
 #include "System/FileSystem/Archives/DirArchive.h"
 #include "System/Threading/SpringThreading.h"
@@ -17,6 +22,14 @@
 #include "System/SafeUtil.h"
 #include "System/StringUtil.h"
 
+#if !defined(UNITSYNC) && !defined(DEDICATED)
+	#include <atomic>
+	#include "System/GlobalConfig.h"
+	#include "System/Misc/SpringTime.h"
+	#include "System/FileSystem/Archives/SevenZipArchive.h"
+	#include "System/Threading/ThreadPool.h"
+#endif
+
 
 #define LOG_SECTION_VFS "VFS"
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_VFS)
@@ -33,6 +46,11 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_VFS)
 // places including LuaVFS
 static spring::recursive_mutex vfsMutex;
 
+// held shared while an archive is read outside of vfsMutex by {Load,Map}File
+// so that concurrent (e.g. VFSAsyncLoader) reads do not serialize on it, and
+// exclusively (always after vfsMutex) around deleting archives
+static std::shared_mutex archiveUseMutex;
+
 
 static CVFSHandler* vfs = nullptr;
 
@@ -129,6 +147,212 @@ bool CVFSHandler::HasArchive(const std::string& archiveName, Section archiveSect
 
 
 
+/*
+ * Persistent index of archive listings (lower-cased names and sizes sorted
+ * by name) under the cache dir, keyed by archive path and validated by its
+ * modification time; AddArchive takes the listing of an unchanged archive
+ * from here instead of enumerating and sorting its files again. Directory
+ * archives are not indexed, their modification time does not follow their
+ * contents. Guarded by vfsMutex like the rest of the VFS state.
+ */
+namespace VFSIndex {
+	typedef std::vector<std::pair<std::string, int>> FileList;
+
+	struct Entry {
+		std::string archivePath;
+		uint32_t modified;
+		FileList fileList;
+	};
+
+	static constexpr uint32_t INDEX_MAGIC = 0x49534656; // "VFSI"
+	static constexpr uint32_t INDEX_VERSION = 1;
+	// oldest (least recently rebuilt) entries are dropped beyond this
+	static constexpr size_t MAX_ENTRIES = 256;
+	// sanity limit for corrupted files
+	static constexpr uint32_t MAX_ARCHIVE_FILES = 1 << 20;
+
+	static std::deque<Entry> entries;
+
+	static bool loaded = false;
+
+	static std::string GetFilePath() { return (FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + "VFSIndex.bin"); }
+
+	template<typename T> static bool ReadValue(std::ifstream& ifs, T& value) { return (!!ifs.read(reinterpret_cast<char*>(&value), sizeof(value))); }
+	template<typename T> static void WriteValue(std::ofstream& ofs, const T& value) { ofs.write(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+	static bool ReadString(std::ifstream& ifs, std::string& str) {
+		uint16_t len = 0;
+
+		if (!ReadValue(ifs, len))
+			return false;
+
+		str.resize(len);
+		return (!!ifs.read(&str[0], len));
+	}
+	static void WriteString(std::ofstream& ofs, const std::string& str) {
+		WriteValue(ofs, uint16_t(str.size()));
+		ofs.write(str.data(), str.size());
+	}
+
+	static void Read() {
+		std::ifstream ifs(GetFilePath().c_str(), std::ios::in | std::ios::binary);
+
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t numEntries = 0;
+
+		loaded = true;
+
+		if (!ReadValue(ifs, magic) || !ReadValue(ifs, version) || !ReadValue(ifs, numEntries))
+			return;
+		if (magic != INDEX_MAGIC || version != INDEX_VERSION || numEntries > MAX_ENTRIES)
+			return;
+
+		for (uint32_t i = 0; i < numEntries; i++) {
+			Entry e;
+			uint32_t numFiles = 0;
+
+			if (!ReadString(ifs, e.archivePath) || !ReadValue(ifs, e.modified) || !ReadValue(ifs, numFiles))
+				break;
+			if (numFiles > MAX_ARCHIVE_FILES)
+				break;
+
+			e.fileList.resize(numFiles);
+
+			for (auto& fi: e.fileList) {
+				if (!ReadString(ifs, fi.first) || !ReadValue(ifs, fi.second)) {
+					// truncated, keep what was complete
+					LOG_L(L_WARNING, "[VFSIndex::%s] \"%s\" is truncated", __func__, GetFilePath().c_str());
+					return;
+				}
+			}
+
+			entries.emplace_back(std::move(e));
+		}
+	}
+
+	static void Write() {
+		// write a temporary and move it in place, other instances might read concurrently
+		const std::string filePath = GetFilePath();
+		const std::string tempPath = filePath + ".tmp";
+
+		{
+			std::ofstream ofs(tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+			if (!ofs.is_open()) {
+				LOG_L(L_WARNING, "[VFSIndex::%s] could not write \"%s\"", __func__, tempPath.c_str());
+				return;
+			}
+
+			WriteValue(ofs, INDEX_MAGIC);
+			WriteValue(ofs, INDEX_VERSION);
+			WriteValue(ofs, uint32_t(entries.size()));
+
+			for (const Entry& e: entries) {
+				WriteString(ofs, e.archivePath);
+				WriteValue(ofs, e.modified);
+				WriteValue(ofs, uint32_t(e.fileList.size()));
+
+				for (const auto& fi: e.fileList) {
+					WriteString(ofs, fi.first);
+					WriteValue(ofs, fi.second);
+				}
+			}
+		}
+
+		std::remove(filePath.c_str());
+		std::rename(tempPath.c_str(), filePath.c_str());
+	}
+
+	static const FileList* Find(const std::string& archivePath, uint32_t modified) {
+		if (!loaded)
+			Read();
+
+		const auto pred = [&](const Entry& e) { return (e.archivePath == archivePath); };
+		const auto iter = std::find_if(entries.begin(), entries.end(), pred);
+
+		if (iter == entries.end() || iter->modified != modified)
+			return nullptr;
+
+		return &iter->fileList;
+	}
+
+	static const FileList* Insert(const std::string& archivePath, uint32_t modified, FileList&& fileList) {
+		const auto pred = [&](const Entry& e) { return (e.archivePath == archivePath); };
+		const auto iter = std::find_if(entries.begin(), entries.end(), pred);
+
+		if (iter != entries.end())
+			entries.erase(iter);
+		if (entries.size() >= MAX_ENTRIES)
+			entries.pop_front();
+
+		entries.push_back({archivePath, modified, std::move(fileList)});
+		Write();
+
+		return &entries.back().fileList;
+	}
+}
+
+
+static const VFSIndex::FileList* GetArchiveFileList(IArchive* ar, const std::string& archivePath, VFSIndex::FileList& fileList)
+{
+	// directory archives are not indexed, virtual ones have no modification time (0)
+	const bool indexed = (dynamic_cast<CDirArchive*>(ar) == nullptr);
+	const uint32_t modified = indexed? FileSystemAbstraction::GetFileModificationTime(archivePath): 0;
+
+	const VFSIndex::FileList* indexedList = (modified != 0)? VFSIndex::Find(archivePath, modified): nullptr;
+
+	if (indexedList != nullptr)
+		return indexedList;
+
+	fileList.clear();
+	fileList.reserve(ar->NumFiles());
+
+	for (unsigned fid = 0; fid != ar->NumFiles(); ++fid) {
+		std::pair<std::string, int> fi = ar->FileInfo(fid);
+
+		fileList.emplace_back(StringToLower(fi.first), fi.second);
+	}
+
+	// stable, an archive can *internally* contain duplicates
+	std::stable_sort(fileList.begin(), fileList.end(), [](const std::pair<std::string, int>& a, const std::pair<std::string, int>& b) { return (a.first < b.first); });
+
+	if (modified == 0)
+		return &fileList;
+
+	return (VFSIndex::Insert(archivePath, modified, std::move(fileList)));
+}
+
+
+#if !defined(UNITSYNC) && !defined(DEDICATED)
+// decodes the solid blocks of a game archive ahead of time, in parallel;
+// reading them file by file would decode each block serially, and often
+// more than once when the reads jump between blocks
+static void PrefetchSolidArchive(CSevenZipArchive* ar)
+{
+	const size_t maxBytes = size_t(globalConfig.vfsPrefetchSolidArchiveSize) * 1024 * 1024;
+	const std::vector<std::vector<unsigned int>>& blocks = ar->GetSolidBlocks(maxBytes);
+
+	if (blocks.empty())
+		return;
+
+	const spring_time startTime = spring_now();
+
+	std::atomic<size_t> numBytes = {0};
+	std::atomic<size_t> numFiles = {0};
+
+	for_mt(0, blocks.size(), [&](const int i) {
+		numBytes += ar->ExtractBlock(blocks[i]);
+		numFiles += blocks[i].size();
+	});
+
+	const float decodeTime = std::max((spring_now() - startTime).toMilliSecsf(), 1.0f);
+	const float decodeSize = numBytes.load() / (1024.0f * 1024.0f);
+
+	LOG("[VFSHandler::%s] archive=\"%s\" blocks=%u files=%u size=%.1fMB time=%.0fms (%.1fMB/s)", __func__, ar->GetArchiveFile().c_str(), unsigned(blocks.size()), unsigned(numFiles.load()), decodeSize, decodeTime, decodeSize * 1000.0f / decodeTime);
+}
+#endif
+
 bool CVFSHandler::AddArchive(const std::string& archiveName, bool overwrite)
 {
 	std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
@@ -152,8 +376,10 @@ bool CVFSHandler::AddArchive(const std::string& archiveName, bool overwrite)
 
 	LOG_L(L_INFO, "[%s::%s<this=%p>(arName=\"%s\", overwrite=%s)] section=%d cached=%d", vfsName, __func__, this, archiveName.c_str(), overwrite ? "true" : "false", rawSection, ar != nullptr);
 
-	if (dynamic_cast<CDirArchive*>(ar) != nullptr)
+	if (dynamic_cast<CDirArchive*>(ar) != nullptr) {
+		std::unique_lock<std::shared_mutex> arUseLock(archiveUseMutex);
 		spring::SafeDelete(ar);
+	}
 
 	if (ar == nullptr) {
 		archives[tmpSection].erase(archivePath);
@@ -168,22 +394,35 @@ bool CVFSHandler::AddArchive(const std::string& archiveName, bool overwrite)
 			}
 
 			archives[rawSection].emplace(archivePath, ar);
+
+			#if !defined(UNITSYNC) && !defined(DEDICATED)
+			CSevenZipArchive* sd7Archive = dynamic_cast<CSevenZipArchive*>(ar);
+
+			if (rawSection == Section::Mod && sd7Archive != nullptr && globalConfig.vfsPrefetchSolidArchiveSize > 0)
+				PrefetchSolidArchive(sd7Archive);
+			#endif
 		}
 	}
 
 
+	VFSIndex::FileList fileList;
+
+	const VFSIndex::FileList* archiveFiles = GetArchiveFileList(ar, archivePath, fileList);
+	const auto pred = [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); };
+
+	// the listing is sorted, so lookups in the section only have to move forward
+	auto sectionIter = files[rawSection].begin();
+
 	files[Section::Temp].clear();
-	files[Section::Temp].reserve(ar->NumFiles());
+	files[Section::Temp].reserve(archiveFiles->size());
 
-	for (unsigned fid = 0; fid != ar->NumFiles(); ++fid) {
-		std::pair<std::string, int> fi = ar->FileInfo(fid);
-		std::string name = std::move(StringToLower(fi.first));
+	for (const auto& fi: *archiveFiles) {
+		const std::string& name = fi.first;
 
 		if (!overwrite) {
-			const auto pred = [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); };
-			const auto iter = std::lower_bound(files[rawSection].begin(), files[rawSection].end(), FileEntry{name, FileData{}}, pred);
+			sectionIter = std::lower_bound(sectionIter, files[rawSection].end(), FileEntry{name, FileData{}}, pred);
 
-			if (iter != files[rawSection].end() && iter->first == name) {
+			if (sectionIter != files[rawSection].end() && sectionIter->first == name) {
 				LOG_L(L_DEBUG, "[%s::%s<this=%p>] skipping \"%s\", exists", vfsName, __func__, this, name.c_str());
 				continue;
 			}
@@ -198,11 +437,14 @@ bool CVFSHandler::AddArchive(const std::string& archiveName, bool overwrite)
 		files[Section::Temp].emplace_back(name, FileData{ar, fi.second});
 	}
 
+	const size_t numSectionFiles = files[rawSection].size();
+
 	for (FileEntry& fileEntry: files[Section::Temp]) {
 		files[rawSection].emplace_back(std::move(fileEntry));
 	}
 
-	std::stable_sort(files[rawSection].begin(), files[rawSection].end(), [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); });
+	// both ranges are sorted; same order as a stable_sort of the whole section
+	std::inplace_merge(files[rawSection].begin(), files[rawSection].begin() + numSectionFiles, files[rawSection].end(), pred);
 	return true;
 }
 
@@ -273,8 +515,11 @@ bool CVFSHandler::RemoveArchive(const std::string& archiveName)
 		files[section].erase(pos, end);
 	}
 
+	{
+		std::unique_lock<std::shared_mutex> arUseLock(archiveUseMutex);
+		delete ar;
+	}
 
-	delete ar;
 	archives[section].erase(archivePath);
 	return true;
 }
@@ -301,6 +546,7 @@ void CVFSHandler::DeleteArchives(Section section)
 	LOG_L(L_INFO, "[%s::%s<this=%p>(section=%d)] #archives[section]=" _STPF_ " #files[section]=" _STPF_ "", vfsName, __func__, this, section, archives[section].size(), files[section].size());
 
 	std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
+	std::unique_lock<std::shared_mutex> arUseLock(archiveUseMutex);
 
 	for (const auto& p: archives[section]) {
 		LOG_L(L_INFO, "\tarchive=%s (%p)", (p.first).c_str(), p.second);
@@ -449,7 +695,16 @@ int CVFSHandler::LoadFile(const std::string& filePath, std::vector<std::uint8_t>
 	LOG_L(L_DEBUG, "[%s::%s<this=%p>(filePath=\"%s\", section=%d)]", vfsName, __func__, this, filePath.c_str(), section);
 
 	const std::string& normalizedPath = GetNormalizedPath(filePath);
-	const FileData& fileData = GetFileData(normalizedPath, section);
+
+	std::shared_lock<std::shared_mutex> arUseLock(archiveUseMutex, std::defer_lock);
+	FileData fileData;
+
+	{
+		// pin the archive before vfsMutex is released, extraction runs without it
+		std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
+		fileData = GetFileData(normalizedPath, section);
+		arUseLock.lock();
+	}
 
 	if (fileData.ar == nullptr)
 		return -1;
@@ -458,6 +713,32 @@ int CVFSHandler::LoadFile(const std::string& filePath, std::vector<std::uint8_t>
 	return (fileData.ar->GetFile(normalizedPath, buffer));
 }
 
+std::shared_ptr<const CMappedFile> CVFSHandler::MapFile(const std::string& filePath, Section section)
+{
+	LOG_L(L_DEBUG, "[%s::%s<this=%p>(filePath=\"%s\", section=%d)]", vfsName, __func__, this, filePath.c_str(), section);
+
+	const std::string& normalizedPath = GetNormalizedPath(filePath);
+
+	std::shared_lock<std::shared_mutex> arUseLock(archiveUseMutex, std::defer_lock);
+	FileData fileData;
+
+	{
+		std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
+		fileData = GetFileData(normalizedPath, section);
+		arUseLock.lock();
+	}
+
+	if (fileData.ar == nullptr)
+		return nullptr;
+
+	const unsigned int fid = fileData.ar->FindFile(normalizedPath);
+
+	if (!fileData.ar->IsFileId(fid))
+		return nullptr;
+
+	return (fileData.ar->GetMappedFile(fid));
+}
+
 int CVFSHandler::FileExists(const std::string& filePath, Section section)
 {
 	LOG_L(L_DEBUG, "[%s::%s<this=%p>(filePath=\"%s\", section=%d)]", vfsName, __func__, this, filePath.c_str(), section);
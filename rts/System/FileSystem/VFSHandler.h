@@ -4,6 +4,7 @@
 #define _VFS_HANDLER_H
 
 #include <array>
+#include <memory>
 #include <string>
 #include <vector>
 #include <cinttypes>
@@ -11,6 +12,7 @@
 #include "System/UnorderedMap.hpp"
 
 class IArchive;
+class CMappedFile;
 
 /**
  * Main API for accessing the Virtual File System (VFS).
@@ -103,6 +105,12 @@ public:
 	 * @return 1 if the file exists in the VFS and was successfully read
 	 */
 	int LoadFile(const std::string& filePath, std::vector<std::uint8_t>& buffer, Section section);
+	/**
+	 * Maps a file read-only instead of reading it, if its archive supports
+	 * that (see IArchive::GetMappedFile).
+	 * @return nullptr if the file can not be mapped or does not exist
+	 */
+	std::shared_ptr<const CMappedFile> MapFile(const std::string& filePath, Section section);
 
 
 	/**
@@ -50,6 +50,26 @@ CONFIG(int, LinkIncomingMaxWaitingPackets)
 	.defaultValue(512)
 	.minimumValue(0);
 
+CONFIG(int, NetworkUpdateThreads)
+	.defaultValue(0)
+	.minimumValue(0)
+	.maximumValue(16)
+	.description("Number of extra threads a game server flushes its client connections on; worth raising for hosts with many players and spectators.");
+
+CONFIG(bool, NetworkCongestionControl)
+	.defaultValue(false)
+	.description("Pace UDP connections by a loss-driven congestion window and an RTT-derived resend timeout instead of only the fixed LinkOutgoingBandwidth cap; each end applies it to the data it sends.");
+
+CONFIG(int, NetworkBundleLatency)
+	.defaultValue(-1)
+	.minimumValue(-1)
+	.maximumValue(1000)
+	.description("Milliseconds UDP connections may hold small outgoing messages, e.g. the per-frame ones of a server, to bundle them with the following ones into one packet; -1 derives it from NetworkLossFactor (200ms halved per factor step). Lower values cut latency, higher ones the packet rate.");
+
+CONFIG(bool, NetworkCompression)
+	.defaultValue(false)
+	.description("Compress the data this end sends over UDP connections. The receiving end always understands compressed streams, so this can be enabled on either side; helps players on slow links when large orders are given.");
+
 CONFIG(int, TeamHighlight)
 	.defaultValue(CTeamHighlight::HIGHLIGHT_PLAYERS)
 	.minimumValue(CTeamHighlight::HIGHLIGHT_FIRST)
@@ -59,6 +79,10 @@ CONFIG(bool, UseNetMessageSmoothingBuffer).defaultValue(true);
 
 CONFIG(bool, LuaWritableConfigFile).defaultValue(true);
 CONFIG(bool, VFSCacheArchiveFiles).defaultValue(true);
+CONFIG(int, VFSPrefetchSolidArchiveSize)
+	.defaultValue(256)
+	.minimumValue(0)
+	.description("Megabytes of solid .sd7 game archive contents to decompress in parallel, one solid block per thread, when the game is loaded. Speeds up loading such games a lot; 0 disables this.");
 
 
 void GlobalConfig::Init()
@@ -76,6 +100,10 @@ void GlobalConfig::Init()
 	linkIncomingPeakBandwidth = configHandler->GetInt("LinkIncomingPeakBandwidth");
 	linkIncomingMaxPacketRate = configHandler->GetInt("LinkIncomingMaxPacketRate");
 	linkIncomingMaxWaitingPackets = configHandler->GetInt("LinkIncomingMaxWaitingPackets");
+	networkUpdateThreads = configHandler->GetInt("NetworkUpdateThreads");
+	networkCompression = configHandler->GetBool("NetworkCompression");
+	networkCongestionControl = configHandler->GetBool("NetworkCongestionControl");
+	networkBundleLatency = configHandler->GetInt("NetworkBundleLatency");
 
 	if (linkIncomingSustainedBandwidth > 0 && linkIncomingPeakBandwidth < linkIncomingSustainedBandwidth)
 		linkIncomingPeakBandwidth = linkIncomingSustainedBandwidth;
@@ -87,6 +115,7 @@ void GlobalConfig::Init()
 	useNetMessageSmoothingBuffer = configHandler->GetBool("UseNetMessageSmoothingBuffer");
 	luaWritableConfigFile = configHandler->GetBool("LuaWritableConfigFile");
 	vfsCacheArchiveFiles = configHandler->GetBool("VFSCacheArchiveFiles");
+	vfsPrefetchSolidArchiveSize = configHandler->GetInt("VFSPrefetchSolidArchiveSize");
 
 	teamHighlight = configHandler->GetInt("TeamHighlight");
 }
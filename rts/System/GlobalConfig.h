@@ -82,6 +82,37 @@ public:
 	 */
 	int linkIncomingMaxWaitingPackets = 512;
 
+	/**
+	 * @brief networkUpdateThreads
+	 *
+	 * Number of extra threads the server flushes its client connections on,
+	 * 0 to flush all of them serially on the server thread
+	 */
+	int networkUpdateThreads = 0;
+
+	/**
+	 * @brief networkCompression
+	 *
+	 * Whether outgoing UDP connection streams are deflate-compressed
+	 */
+	bool networkCompression = false;
+
+	/**
+	 * @brief networkCongestionControl
+	 *
+	 * Whether UDP connections limit their unacked chunks by a congestion
+	 * window and pace their sends by its estimated rate
+	 */
+	bool networkCongestionControl = false;
+	/**
+	 * @brief networkBundleLatency
+	 *
+	 * Milliseconds a UDP connection may hold small outgoing messages to send
+	 * them together with the following ones, -1 to derive it from the loss
+	 * factor (200ms >> factor)
+	 */
+	int networkBundleLatency = -1;
+
 
 	/**
 	 * @brief useNetMessageSmoothingBuffer
@@ -106,6 +137,14 @@ public:
 	 */
 	bool vfsCacheArchiveFiles = true;
 
+	/**
+	 * @brief vfsPrefetchSolidArchiveSize
+	 *
+	 * Megabytes of solid game archive (.sd7) contents to decompress in
+	 * parallel when the game is loaded, 0 disables this
+	 */
+	int vfsPrefetchSolidArchiveSize = 256;
+
 
 	/**
 	 * @brief teamHighlight
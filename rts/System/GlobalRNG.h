@@ -94,27 +94,97 @@ private:
 };
 
 
-
-template<typename RNG, bool synced> class CGlobalRNG {
+/**
+ * Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+ * Counter-based: each block of four outputs is a keyed bijection of a 128-bit
+ * counter, so a stream is fully described by (key, counter) and any number of
+ * them can be created and drawn from in any order, on any thread. The upper 96
+ * counter bits select the stream, the lowest 32 count its blocks.
+ */
+struct Philox4x32 {
 public:
-	typedef typename RNG::val_type rng_val_type;
-	typedef typename RNG::res_type rng_res_type;
+	typedef uint32_t res_type;
+	typedef uint64_t val_type;
 
-	static_assert(std::numeric_limits<float>::digits == 24, "sign plus mantissa bits should be 24");
+	Philox4x32(const val_type _key = 0, const uint32_t s0 = 0, const uint32_t s1 = 0, const uint32_t s2 = 0) { seed(_key, s0, s1, s2); }
 
-	void Seed(rng_val_type seed) { SetSeed(seed); }
-	void SetSeed(rng_val_type seed, bool init = false) {
-		// use address of this object as sequence-id for unsynced RNG, modern systems have ASLR
-		if (init) {
-			gen.seed(initSeed = seed, static_cast<rng_val_type>(size_t(this)) * (1 - synced) + RNG::def_seq * synced);
-		} else {
-			gen.seed(lastSeed = seed, static_cast<rng_val_type>(size_t(this)) * (1 - synced) + RNG::def_seq * synced);
+	void seed(const val_type initkey, const uint32_t s0, const uint32_t s1, const uint32_t s2) {
+		key[0] = static_cast<uint32_t>(initkey);
+		key[1] = static_cast<uint32_t>(initkey >> 32u);
+
+		ctr[0] = 0;
+		ctr[1] = s0;
+		ctr[2] = s1;
+		ctr[3] = s2;
+
+		idx = 4;
+	}
+
+	res_type next() {
+		if (idx == 4) {
+			Block(ctr, key, out);
+			ctr[0] += 1;
+			idx = 0;
 		}
+
+		return out[idx++];
 	}
 
-	rng_val_type GetInitSeed() const { return initSeed; }
-	rng_val_type GetLastSeed() const { return lastSeed; }
-	rng_val_type GetGenState() const { return (gen.state()); }
+	res_type bnext(const res_type bound) {
+		const res_type threshold = -bound % bound;
+		res_type r = 0;
+
+		for (r = next(); r < threshold; r = next());
+
+		return (r % bound);
+	}
+
+	// number of values drawn so far
+	val_type state() const { return ((static_cast<val_type>(ctr[0]) * 4u) - (4u - idx)); }
+
+	static void Block(const uint32_t c[4], const uint32_t k[2], uint32_t r[4]) {
+		uint32_t c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3];
+		uint32_t k0 = k[0], k1 = k[1];
+
+		for (unsigned int n = 0; n < 10; n++) {
+			const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+			const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+
+			c0 = static_cast<uint32_t>(p1 >> 32u) ^ c1 ^ k0;
+			c1 = static_cast<uint32_t>(p1);
+			c2 = static_cast<uint32_t>(p0 >> 32u) ^ c3 ^ k1;
+			c3 = static_cast<uint32_t>(p0);
+
+			k0 += 0x9E3779B9u;
+			k1 += 0xBB67AE85u;
+		}
+
+		r[0] = c0;
+		r[1] = c1;
+		r[2] = c2;
+		r[3] = c3;
+	}
+
+public:
+	static constexpr res_type min_res = std::numeric_limits<res_type>::min();
+	static constexpr res_type max_res = std::numeric_limits<res_type>::max();
+
+private:
+	uint32_t key[2];
+	uint32_t ctr[4];
+	uint32_t out[4];
+	uint32_t idx;
+};
+
+
+
+// distributions on top of a generator, shared by the global RNG's and the synced streams
+template<typename RNG> class CRandomGen {
+public:
+	typedef typename RNG::val_type rng_val_type;
+	typedef typename RNG::res_type rng_res_type;
+
+	static_assert(std::numeric_limits<float>::digits == 24, "sign plus mantissa bits should be 24");
 
 	// needed for std::{random_}shuffle
 	rng_res_type operator()(              ) { return (gen. next( )); }
@@ -144,15 +214,53 @@ public:
 		return ret;
 	}
 
-private:
+protected:
 	RNG gen;
+};
 
+
+template<typename RNG, bool synced> class CGlobalRNG: public CRandomGen<RNG> {
+public:
+	typedef typename CRandomGen<RNG>::rng_val_type rng_val_type;
+	typedef typename CRandomGen<RNG>::rng_res_type rng_res_type;
+
+	void Seed(rng_val_type seed) { SetSeed(seed); }
+	void SetSeed(rng_val_type seed, bool init = false) {
+		// use address of this object as sequence-id for unsynced RNG, modern systems have ASLR
+		if (init) {
+			this->gen.seed(initSeed = seed, static_cast<rng_val_type>(size_t(this)) * (1 - synced) + RNG::def_seq * synced);
+		} else {
+			this->gen.seed(lastSeed = seed, static_cast<rng_val_type>(size_t(this)) * (1 - synced) + RNG::def_seq * synced);
+		}
+	}
+
+	rng_val_type GetInitSeed() const { return initSeed; }
+	rng_val_type GetLastSeed() const { return lastSeed; }
+	rng_val_type GetGenState() const { return (this->gen.state()); }
+
+private:
 	// initial and last-set seed
 	rng_val_type initSeed = 0;
 	rng_val_type lastSeed = 0;
 };
 
 
+/**
+ * Random numbers for one (frame, subsystem, object) triple. Streams share
+ * nothing, so synced code running in parallel can draw from one stream per
+ * object and stay deterministic regardless of thread order; the same triple
+ * (and key) always yields the same sequence. See GetSyncedRNGStream.
+ */
+class CSyncedRNGStream: public CRandomGen<Philox4x32> {
+public:
+	CSyncedRNGStream(uint64_t key, uint32_t frameNum, uint32_t subsystem, uint32_t objectID) {
+		gen.seed(key, objectID, frameNum, subsystem);
+	}
+
+	rng_val_type GetGenState() const { return (gen.state()); }
+};
+
+
 // synced and unsynced RNG's no longer need to be different types
 typedef CGlobalRNG<PCG32, true> CGlobalSyncedRNG;
 typedef CGlobalRNG<PCG32, false> CGlobalUnsyncedRNG;
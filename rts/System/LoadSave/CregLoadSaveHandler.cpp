@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <future>
 #include <sstream>
 #include <zlib.h>
 
@@ -102,6 +103,7 @@ void CGameStateCollector::Serialize(creg::ISerializer* s)
 	s->SerializeObjectInstance(eoh, eoh->GetClass());
 	std::unique_ptr<creg::IType> mapType = creg::DeduceType<decltype(CSplitLuaHandle::gameParams)>::Get();
 	mapType->Serialize(s, &CSplitLuaHandle::gameParams);
+	LuaRulesParams::SerializeSlots(s);
 }
 
 
@@ -122,6 +124,8 @@ public:
 	std::vector<bool> watchProjectileDefs;  // callin masks for Projectile*
 	std::vector<bool> watchExplosionDefs;   // callin masks for Explosion
 	std::vector<bool> watchAllowTargetDefs; // callin masks for AllowWeapon*Target*
+	std::array<std::vector<bool>, CEventClient::DEF_FILTER_EVENT_COUNT> unitDefFilters;
+	std::vector<bool> damageWeaponDefFilter;
 	void Serialize(creg::ISerializer* s);
 };
 
@@ -135,6 +139,8 @@ CR_REG_METADATA(CLuaStateCollector, (
 	CR_MEMBER(watchProjectileDefs),
 	CR_MEMBER(watchExplosionDefs),
 	CR_MEMBER(watchAllowTargetDefs),
+	CR_MEMBER(unitDefFilters),
+	CR_MEMBER(damageWeaponDefFilter),
 	CR_SERIALIZER(Serialize)
 ))
 
@@ -150,6 +156,8 @@ void CLuaStateCollector::Read(const CSplitLuaHandle* handle) {
 	watchProjectileDefs = handle->syncedLuaHandle.watchProjectileDefs;
 	watchExplosionDefs = handle->syncedLuaHandle.watchExplosionDefs;
 	watchAllowTargetDefs = handle->syncedLuaHandle.watchAllowTargetDefs;
+	unitDefFilters = handle->syncedLuaHandle.unitDefFilters;
+	damageWeaponDefFilter = handle->syncedLuaHandle.damageWeaponDefFilter;
 
 	lua_gc(L_GC, LUA_GCCOLLECT, 0);
 }
@@ -164,6 +172,8 @@ void CLuaStateCollector::Write(CSplitLuaHandle* handle) {
 	handle->syncedLuaHandle.watchProjectileDefs = watchProjectileDefs;
 	handle->syncedLuaHandle.watchExplosionDefs = watchExplosionDefs;
 	handle->syncedLuaHandle.watchAllowTargetDefs = watchAllowTargetDefs;
+	handle->syncedLuaHandle.unitDefFilters = unitDefFilters;
+	handle->syncedLuaHandle.damageWeaponDefFilter = damageWeaponDefFilter;
 }
 
 void CLuaStateCollector::Serialize(creg::ISerializer* s) {
@@ -236,9 +246,64 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 #ifdef USING_CREG
 	LOG("[LSH::%s] saving game to \"%s\"", __func__, path.c_str());
 
-	try {
-		std::stringstream oss;
+	// completion of the last write, so consecutive saves to the same file never overlap
+	static std::shared_future<void> lastWrite;
+
+	std::stringstream oss;
+
+	// the object graph has to be walked while the simulation is halted, everything
+	// after that (copying the stream, compressing, file I/O) runs on a worker thread
+	if (!SaveGameState(oss))
+		return;
+
+	std::promise<void> writeDone;
+	std::shared_future<void> prevWrite = lastWrite;
+
+	lastWrite = writeDone.get_future().share();
+
+	const std::string filePath = dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE);
+	auto func = [filePath, prevWrite, writeDone = std::move(writeDone), oss = std::move(oss)]() mutable {
+		if (prevWrite.valid())
+			prevWrite.wait();
+
+		gzFile file = gzopen(filePath.c_str(), "wb5");
+
+		if (file == nullptr) {
+			LOG_L(L_ERROR, "[LSH::SaveGame] could not open save-file \"%s\"", filePath.c_str());
+		} else {
+			const std::string& data = oss.str();
+
+			gzwrite(file, data.c_str(), data.size());
+			gzflush(file, Z_FINISH);
+			gzclose(file);
+		}
+
+		writeDone.set_value();
+	};
+
+	// need to keep a reference to the future around or its destructor will block
+	ThreadPool::AddExtJob(std::async(std::launch::async, std::move(func)));
+#else //USING_CREG
+	LOG_L(L_ERROR, "[LSH::%s] creg is disabled", __func__);
+#endif //USING_CREG
+}
+
+/// serializes the game state into <data> (the uncompressed contents of a save-file)
+bool CCregLoadSaveHandler::SaveGameState(std::string& data)
+{
+	std::stringstream oss;
+
+	if (!SaveGameState(oss))
+		return false;
+
+	data = oss.str();
+	return true;
+}
 
+bool CCregLoadSaveHandler::SaveGameState(std::stringstream& oss)
+{
+#ifdef USING_CREG
+	try {
 		// write our own header. SavePackage() will add its own
 		WriteString(oss, SpringVersion::GetSync());
 		WriteString(oss, gameSetup->setupText);
@@ -277,25 +342,7 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 			PrintSize("AIs", ((int)oss.tellp()) - aiStart);
 		}
 
-		{
-			gzFile file = gzopen(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE).c_str(), "wb5");
-
-			if (file == nullptr) {
-				LOG_L(L_ERROR, "[LSH::%s] could not open save-file", __func__);
-				return;
-			}
-
-			std::string data = std::move(oss.str());
-			std::function<void(gzFile, std::string&&)> func = [](gzFile file, std::string&& data) {
-				gzwrite(file, data.c_str(), data.size());
-				gzflush(file, Z_FINISH);
-				gzclose(file);
-			};
-
-			// gzFile is just a plain typedef (struct gzFile_s {}* gzFile), can be copied
-			// need to keep a reference to the future around or its destructor will block
-			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::move(data))));
-		}
+		return true;
 
 		//FIXME add lua state
 	} catch (const content_error& ex) {
@@ -312,6 +359,8 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 #else //USING_CREG
 	LOG_L(L_ERROR, "[LSH::%s] creg is disabled", __func__);
 #endif //USING_CREG
+
+	return false;
 }
 
 /// loads the data (map&mod-name,setup-script) needed by PreGame
@@ -345,6 +394,22 @@ bool CCregLoadSaveHandler::LoadGameStartInfo(const std::string& path)
 	return (saveVersion == syncVersion);
 }
 
+/// prepares LoadGame to restore a state produced by SaveGameState (e.g. a demo keyframe)
+bool CCregLoadSaveHandler::LoadGameState(const std::string& data)
+{
+	std::string saveVersion;
+
+	iss.str(data);
+	ReadString(iss, saveVersion);
+
+	// the game runs from the demo's own script, the saved one is skipped
+	ReadString(iss, scriptText);
+	ReadString(iss, modName);
+	ReadString(iss, mapName);
+
+	return (saveVersion == SpringVersion::GetSync());
+}
+
 /// this should be called on frame 0 when the game has started
 void CCregLoadSaveHandler::LoadGame()
 {
@@ -18,6 +18,10 @@ public:
 	void LoadAIData() override;
 	void SaveGame(const std::string& path) override;
 
+	bool SaveGameState(std::string& data);
+	bool SaveGameState(std::stringstream& oss);
+	bool LoadGameState(const std::string& data);
+
 protected:
 	std::stringstream iss;
 };
@@ -15,6 +15,7 @@ CONFIG(bool, DisableDemoVersionCheck).defaultValue(false).description("Allow to
 #include "System/Log/ILog.h"
 #include "System/Net/RawPacket.h"
 
+#include <algorithm>
 #include <array>
 #include <climits>
 #include <stdexcept>
@@ -100,6 +101,11 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 		bytesRemaining = playbackDemoSize - curPos;
 	}
 	playbackDemo->Seek(curPos);
+
+	streamPos = 0;
+	keyframesPos = 0;
+
+	LoadKeyframes();
 }
 
 
@@ -125,6 +131,7 @@ netcode::RawPacket* CDemoReader::GetData(const float readTime)
 			return nullptr;
 		}
 		bytesRemaining -= chunkHeader.length;
+		streamPos += (sizeof(chunkHeader) + chunkHeader.length);
 
 		if (!ReachedEnd()) {
 			// read next chunk header
@@ -200,3 +207,81 @@ void CDemoReader::LoadStats()
 
 	playbackDemo->Seek(curPos);
 }
+
+
+void CDemoReader::LoadKeyframes()
+{
+	// a demo of a crashed game ends mid-stream
+	if (fileHeader.demoStreamSize == 0)
+		return;
+
+	DemoKeyframeTrailer trailer;
+
+	if (playbackDemoSize < int(sizeof(trailer)))
+		return;
+
+	const int curPos = playbackDemo->GetPos();
+	playbackDemo->Seek(playbackDemoSize - sizeof(trailer));
+	playbackDemo->Read(reinterpret_cast<char*>(&trailer), sizeof(trailer));
+	trailer.swab();
+
+	const int indexSize = trailer.numKeyframes * sizeof(DemoKeyframe);
+	const int indexPos = playbackDemoSize - int(sizeof(trailer)) - indexSize;
+	const int statsEnd = fileHeader.headerSize + fileHeader.scriptSize + fileHeader.demoStreamSize;
+
+	// older demos end with their stats
+	if (memcmp(trailer.magic, DEMOFILE_KEYFRAME_MAGIC, sizeof(trailer.magic)) != 0 || trailer.numKeyframes <= 0) {
+		playbackDemo->Seek(curPos);
+		return;
+	}
+
+	if ((keyframesPos = playbackDemoSize - trailer.keyframesSize) < statsEnd || indexPos < keyframesPos) {
+		LOG_L(L_WARNING, "[DemoReader::%s] ignoring corrupt keyframe index", __func__);
+		playbackDemo->Seek(curPos);
+		return;
+	}
+
+	keyframes.resize(trailer.numKeyframes);
+	playbackDemo->Seek(indexPos);
+	playbackDemo->Read(reinterpret_cast<char*>(keyframes.data()), indexSize);
+	playbackDemo->Seek(curPos);
+
+	for (DemoKeyframe& keyframe: keyframes) {
+		keyframe.swab();
+
+		if (keyframe.stateOffset >= 0 && keyframe.stateSize >= 0 && (keyframesPos + keyframe.stateOffset + keyframe.stateSize) <= indexPos)
+			continue;
+
+		LOG_L(L_WARNING, "[DemoReader::%s] ignoring corrupt keyframe index", __func__);
+		keyframes.clear();
+		return;
+	}
+}
+
+int CDemoReader::FindKeyframe(int frameNum) const
+{
+	const auto pred = [](int frameNum, const DemoKeyframe& keyframe) { return (frameNum < keyframe.frameNum); };
+	const auto iter = std::upper_bound(keyframes.begin(), keyframes.end(), frameNum, pred);
+
+	return (int(iter - keyframes.begin()) - 1);
+}
+
+bool CDemoReader::ReadKeyframeState(int index, std::string& state)
+{
+	if (index < 0 || index >= int(keyframes.size()))
+		return false;
+
+	const int curPos = playbackDemo->GetPos();
+
+	state.resize(keyframes[index].stateSize);
+	playbackDemo->Seek(keyframesPos + keyframes[index].stateOffset);
+	playbackDemo->Read(&state[0], state.size());
+	playbackDemo->Seek(curPos);
+	return true;
+}
+
+void CDemoReader::ResetTime(float curTime)
+{
+	demoTimeOffset = curTime - chunkHeader.modGameTime - 0.1f;
+	nextDemoReadTime = curTime - 0.01f;
+}
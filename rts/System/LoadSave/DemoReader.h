@@ -55,6 +55,20 @@ public:
 	/// Not needed for normal demo watching
 	void LoadStats();
 
+	const std::vector<DemoKeyframe>& GetKeyframes() const { return keyframes; }
+
+	/// @return index of the last keyframe at or before frameNum, or -1 if there is none
+	int FindKeyframe(int frameNum) const;
+	bool ReadKeyframeState(int index, std::string& state);
+
+	/// offset into the demo stream of the chunk GetData returns next
+	int GetStreamPos() const { return streamPos; }
+	/// makes the next chunk due at curTime, after reading ahead without waiting
+	void ResetTime(float curTime);
+
+private:
+	void LoadKeyframes();
+
 private:
 	CFileHandler* playbackDemo;
 
@@ -62,6 +76,7 @@ private:
 	float nextDemoReadTime;
 	int bytesRemaining;
 	int playbackDemoSize;
+	int streamPos;
 
 	DemoStreamChunkHeader chunkHeader;
 
@@ -70,6 +85,9 @@ private:
 	std::vector<PlayerStatistics> playerStats; // one stat per player
 	std::vector< std::vector<TeamStatistics> > teamStats; // many stats per team
 	std::vector<unsigned char> winningAllyTeams;
+
+	std::vector<DemoKeyframe> keyframes;
+	int keyframesPos;
 };
 
 #endif
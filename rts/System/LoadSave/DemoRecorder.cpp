@@ -3,11 +3,14 @@
 #include <cassert>
 #include <cerrno>
 #include <cstring>
+#include <map>
 #include <memory>
+#include <zlib.h>
 
 #include "DemoRecorder.h"
 #include "Game/GameVersion.h"
 #include "Sim/Misc/TeamStatistics.h"
+#include "System/ConcurrentQueue.h"
 #include "System/TimeUtil.h"
 #include "System/StringUtil.h"
 #include "System/FileSystem/DataDirsAccess.h"
@@ -15,6 +18,7 @@
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
 #include "System/Threading/ThreadPool.h"
 
 #ifdef CreateDirectory
@@ -26,42 +30,323 @@
 #endif
 
 
-// server and client memory-streams
-static std::string demoStreams[2];
-static spring::mutex demoMutex;
+/**
+ * Owns the demo file and streams recorded data into it from a thread of its
+ * own. The header is kept in a separate stored (uncompressed) gzip member so
+ * its size never changes and it can be rewritten in place, everything after
+ * it goes into deflated members finished every few seconds. gzread decodes
+ * concatenated members as one stream, and a file cut short by a crash still
+ * reads back up to its last finished member.
+ */
+class CDemoFileWriter {
+public:
+	enum {
+		WRITE_HEADER    = 0,
+		WRITE_DATA      = 1,
+		WRITE_KEYFRAME  = 2,
+		WRITE_KEYFRAMES = 3,
+		WRITE_FINISH    = 4,
+	};
 
+	struct Job {
+		int type;
+		unsigned int seqNum;
+		std::string data;
+	};
 
-CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo): isServerDemo(serverDemo)
+	// maximum amount of recorded data held back before it is handed over
+	static constexpr size_t MAX_BLOCK_SIZE = 16 * 1024;
+	static constexpr int MAX_BLOCK_MSECS = 1000;
+	// maximum time a member stays open (and unreadable after a crash)
+	static constexpr int MAX_MEMBER_MSECS = 5000;
+
+public:
+	CDemoFileWriter(FILE* f): file(f) { memset(&stream, 0, sizeof(stream)); }
+	~CDemoFileWriter() {
+		if (inMember)
+			deflateEnd(&stream);
+		if (file != nullptr)
+			fclose(file);
+		if (keyframeFile != nullptr)
+			fclose(keyframeFile);
+	}
+
+	// producer side; the recorder is only ever used by one thread at a time
+	void Push(int type, std::string&& data) { jobs.enqueue({type, numPushedJobs++, std::move(data)}); }
+	void Append(const void* data, size_t size) {
+		block.append(reinterpret_cast<const char*>(data), size);
+		numAppendedBytes += size;
+
+		if (block.size() < MAX_BLOCK_SIZE && (spring_gettime() - lastBlockTime) < spring_msecs(MAX_BLOCK_MSECS))
+			return;
+
+		PushBlock();
+	}
+	void PushBlock() {
+		lastBlockTime = spring_gettime();
+
+		if (block.empty())
+			return;
+
+		Push(WRITE_DATA, std::move(block));
+		block.clear();
+		block.reserve(MAX_BLOCK_SIZE * 2);
+	}
+
+	size_t GetNumAppendedBytes() const { return numAppendedBytes; }
+
+	std::vector<DemoKeyframe>& GetKeyframes() { return keyframes; }
+
+	// consumer side
+	void Run();
+
+private:
+	void WriteHeader(const std::string& data);
+	void WriteData(const std::string& data);
+	void WriteKeyframe(const std::string& data);
+	void WriteKeyframes(const std::string& data);
+	void FinishMember();
+	void Deflate(int flush);
+	void CheckError();
+
+private:
+	FILE* file = nullptr;
+	// savestates are parked here until the demo stream is complete
+	FILE* keyframeFile = nullptr;
+
+	moodycamel::ConcurrentQueue<Job> jobs;
+
+	// pushed from different threads, jobs can be dequeued out of order
+	std::map<unsigned int, Job> pendingJobs;
+
+	std::string block;
+	std::vector<DemoKeyframe> keyframes;
+	std::vector<uint8_t> outBuffer;
+
+	z_stream stream;
+
+	spring_time lastBlockTime;
+	spring_time memberStartTime;
+
+	size_t numAppendedBytes = 0;
+	long headerMemberSize = -1;
+
+	unsigned int numPushedJobs = 0;
+	unsigned int numWrittenJobs = 0;
+
+	bool inMember = false;
+	bool writeError = false;
+};
+
+
+void CDemoFileWriter::Run()
+{
+	Job job;
+
+	while (true) {
+		if (!jobs.try_dequeue(job)) {
+			// a quiet game still gets its data finished and on disk
+			if (inMember && (spring_gettime() - memberStartTime) >= spring_msecs(MAX_MEMBER_MSECS))
+				FinishMember();
+
+			spring::this_thread::sleep_for(std::chrono::milliseconds(50));
+			continue;
+		}
+
+		pendingJobs.emplace(job.seqNum, std::move(job));
+
+		for (auto it = pendingJobs.begin(); it != pendingJobs.end() && it->first == numWrittenJobs; it = pendingJobs.erase(it), numWrittenJobs++) {
+			switch (it->second.type) {
+				case WRITE_HEADER   : {    WriteHeader(it->second.data); } break;
+				case WRITE_DATA     : {      WriteData(it->second.data); } break;
+				case WRITE_KEYFRAME : {  WriteKeyframe(it->second.data); } break;
+				case WRITE_KEYFRAMES: { WriteKeyframes(it->second.data); } break;
+				case WRITE_FINISH   : {
+					WriteData(it->second.data);
+					FinishMember();
+
+					fclose(file);
+					file = nullptr;
+					return;
+				} break;
+				default: {
+					assert(false);
+				} break;
+			}
+		}
+	}
+}
+
+void CDemoFileWriter::WriteHeader(const std::string& data)
+{
+	z_stream hs;
+	memset(&hs, 0, sizeof(hs));
+
+	// +16 makes it a gzip member; stored blocks keep its size independent of the contents
+	deflateInit2(&hs, Z_NO_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+	outBuffer.resize(deflateBound(&hs, data.size()));
+
+	hs.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+	hs.avail_in  = data.size();
+	hs.next_out  = outBuffer.data();
+	hs.avail_out = outBuffer.size();
+
+	deflate(&hs, Z_FINISH);
+	deflateEnd(&hs);
+
+	const long memberSize = hs.total_out;
+
+	if (headerMemberSize < 0) {
+		// the first job, nothing precedes it in the file
+		fwrite(outBuffer.data(), 1, memberSize, file);
+		headerMemberSize = memberSize;
+	} else {
+		assert(memberSize == headerMemberSize);
+
+		fseek(file, 0, SEEK_SET);
+		fwrite(outBuffer.data(), 1, memberSize, file);
+		fseek(file, 0, SEEK_END);
+	}
+
+	fflush(file);
+	CheckError();
+}
+
+void CDemoFileWriter::WriteData(const std::string& data)
+{
+	if (data.empty())
+		return;
+
+	if (!inMember) {
+		deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+		memberStartTime = spring_gettime();
+		inMember = true;
+	}
+
+	stream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+	stream.avail_in = data.size();
+
+	Deflate(Z_NO_FLUSH);
+
+	if ((spring_gettime() - memberStartTime) < spring_msecs(MAX_MEMBER_MSECS))
+		return;
+
+	FinishMember();
+}
+
+void CDemoFileWriter::WriteKeyframe(const std::string& data)
+{
+	if (keyframeFile == nullptr && (keyframeFile = tmpfile()) == nullptr) {
+		LOG_L(L_ERROR, "[DemoFileWriter::%s] error creating keyframe file (%s)", __func__, strerror(errno));
+		return;
+	}
+
+	fwrite(data.data(), 1, data.size(), keyframeFile);
+}
+
+void CDemoFileWriter::WriteKeyframes(const std::string& data)
 {
-	std::lock_guard<spring::mutex> lock(demoMutex);
+	if (keyframeFile == nullptr)
+		return;
+
+	std::string buffer(MAX_BLOCK_SIZE * 4, 0);
+
+	rewind(keyframeFile);
+
+	for (size_t n = 0; (n = fread(&buffer[0], 1, MAX_BLOCK_SIZE * 4, keyframeFile)) > 0; ) {
+		buffer.resize(n);
+		WriteData(buffer);
+		buffer.resize(MAX_BLOCK_SIZE * 4);
+	}
+
+	// an incomplete copy would make the index point at the wrong data
+	if (ferror(keyframeFile) != 0) {
+		LOG_L(L_ERROR, "[DemoFileWriter::%s] error reading keyframe file, keyframes are not saved", __func__);
+		return;
+	}
 
-	SetStream();
+	WriteData(data);
+}
+
+void CDemoFileWriter::FinishMember()
+{
+	if (!inMember)
+		return;
+
+	stream.next_in  = nullptr;
+	stream.avail_in = 0;
+
+	Deflate(Z_FINISH);
+	deflateEnd(&stream);
+
+	inMember = false;
+
+	fflush(file);
+	CheckError();
+}
+
+void CDemoFileWriter::Deflate(int flush)
+{
+	outBuffer.resize(64 * 1024);
+
+	do {
+		stream.next_out  = outBuffer.data();
+		stream.avail_out = outBuffer.size();
+
+		const int ret = deflate(&stream, flush);
+
+		fwrite(outBuffer.data(), 1, outBuffer.size() - stream.avail_out, file);
+
+		if (ret == Z_STREAM_END)
+			break;
+	} while (stream.avail_out == 0 || stream.avail_in > 0);
+}
+
+void CDemoFileWriter::CheckError()
+{
+	if (writeError || ferror(file) == 0)
+		return;
+
+	// keep recording, the data might be written again once space is freed up
+	LOG_L(L_ERROR, "[DemoFileWriter::%s] error writing demo file (%s)", __func__, strerror(errno));
+	clearerr(file);
+
+	writeError = true;
+}
+
+
+
+CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo): isServerDemo(serverDemo)
+{
 	SetName(mapName, modName);
 	SetFileHeader();
-	WriteFileHeader(false);
 
-	file = gzopen(demoName.c_str(), "wb9");
+	FILE* file = fopen(demoName.c_str(), "wb");
+
+	if (file == nullptr)
+		return;
+
+	writer = std::make_shared<CDemoFileWriter>(file);
+	// the writer stays alive until its thread has drained the queue
+	writerJob = std::async(std::launch::async, [w = writer]() { w->Run(); });
+
+	WriteFileHeader(false);
 }
 
 CDemoRecorder::~CDemoRecorder()
 {
-	if (file == nullptr)
+	if (writer == nullptr)
 		return;
 
 	WriteWinnerList();
 	WritePlayerStats();
 	WriteTeamStats();
+	WriteKeyframes();
 	WriteFileHeader(true);
 	WriteDemoFile();
 }
 
 
-void CDemoRecorder::SetStream()
-{
-	demoStreams[isServerDemo].clear();
-	demoStreams[isServerDemo].reserve(8 * 1024 * 1024);
-}
-
 void CDemoRecorder::SetFileHeader()
 {
 	memset(&fileHeader, 0, sizeof(DemoFileHeader));
@@ -78,51 +363,46 @@ void CDemoRecorder::SetFileHeader()
 
 void CDemoRecorder::WriteDemoFile()
 {
-	// zlib FAQ claims the lib is thread-safe, "however any library routines that zlib uses and
-	// any application-provided memory allocation routines must also be thread-safe. zlib's gz*
-	// functions use stdio library routines, and most of zlib's functions use the library memory
-	// allocation routines by default" (so code below should be OK)
-	// gz* should usually be finished before ctor runs again when reloading, but take no chances
-	std::string& data = demoStreams[isServerDemo];
-	std::function<void(gzFile, std::string&)> func = [](gzFile file, std::string& data) {
-		std::lock_guard<spring::mutex> lock(demoMutex);
-
-		gzwrite(file, data.c_str(), data.size());
-		gzflush(file, Z_FINISH);
-		gzclose(file);
-	};
+	LOG("[DemoRecorder::%s] writing %s-demo \"%s\" (" _STPF_ " bytes)", __func__, (isServerDemo? "server": "client"), demoName.c_str(), writer->GetNumAppendedBytes());
 
-	LOG("[DemoRecorder::%s] writing %s-demo \"%s\" (" _STPF_ " bytes)", __func__, (isServerDemo? "server": "client"), demoName.c_str(), data.size());
+	// the header was pushed after the stats, it lands in the file before FINISH closes it
+	std::string data;
+	writer->PushBlock();
+	writer->Push(CDemoFileWriter::WRITE_FINISH, std::move(data));
 
-	#ifndef _WIN32
 	// NOTE: can not use ThreadPool for this directly here, workers are already gone
-	// FIXME: does not currently (august 2017) compile on Windows mingw buildbots
-	ThreadPool::AddExtJob(spring::thread(std::move(func), file, std::ref(data)));
-	#else
-	ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::ref(data))));
-	#endif
+	ThreadPool::AddExtJob(std::move(writerJob));
+	writer.reset();
 }
 
 void CDemoRecorder::WriteSetupText(const std::string& text)
 {
+	if (writer == nullptr)
+		return;
+
 	int length = text.length();
 	while (text[length - 1] == '\0') {
 		--length;
 	}
 
 	fileHeader.scriptSize = length;
-	demoStreams[isServerDemo].append(text.c_str(), length);
+	writer->Append(text.c_str(), length);
+
+	WriteFileHeader(false);
 }
 
 void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime)
 {
+	if (writer == nullptr)
+		return;
+
 	DemoStreamChunkHeader chunkHeader;
 
 	chunkHeader.modGameTime = modGameTime;
 	chunkHeader.length = length;
 	chunkHeader.swab();
-	demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&chunkHeader), sizeof(chunkHeader));
-	demoStreams[isServerDemo].append(reinterpret_cast<const char*>(buf), length);
+	writer->Append(&chunkHeader, sizeof(chunkHeader));
+	writer->Append(buf, length);
 	fileHeader.demoStreamSize += (length + sizeof(chunkHeader));
 }
 
@@ -199,12 +479,7 @@ void CDemoRecorder::SetTeamStats(int teamNum, const std::vector<TeamStatistics>&
 {
 	assert((unsigned)teamNum < teamStats.size()); //FIXME
 
-	teamStats[teamNum].clear();
-	teamStats[teamNum].reserve(stats.size());
-
-	for (const auto& stat: stats) {
-		teamStats[teamNum].push_back(stat);
-	}
+	teamStats[teamNum].assign(stats.begin(), stats.end());
 }
 
 
@@ -216,10 +491,13 @@ void CDemoRecorder::SetWinningAllyTeams(const std::vector<unsigned char>& winnin
 }
 
 /** @brief Write DemoFileHeader
-Write the DemoFileHeader at the start of the file and restores the original
-position in the file afterwards. */
-unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
+Hands the DemoFileHeader to the writer, which overwrites the one at the start
+of the file. */
+void CDemoRecorder::WriteFileHeader(bool updateStreamLength)
 {
+	if (writer == nullptr)
+		return;
+
 	DemoFileHeader tmpHeader;
 	memcpy(&tmpHeader, &fileHeader, sizeof(fileHeader));
 
@@ -229,28 +507,21 @@ unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
 	// to little endian
 	tmpHeader.swab();
 
-	if (demoStreams[isServerDemo].empty()) {
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&tmpHeader), sizeof(tmpHeader));
-	} else {
-		assert(demoStreams[isServerDemo].size() >= sizeof(tmpHeader));
-		memcpy(&demoStreams[isServerDemo][0], reinterpret_cast<const char*>(&tmpHeader), sizeof(tmpHeader)); // no non-const .data() until C++17
-	}
-
-	return (demoStreams[isServerDemo].size());
+	writer->Push(CDemoFileWriter::WRITE_HEADER, std::string(reinterpret_cast<const char*>(&tmpHeader), sizeof(tmpHeader)));
 }
 
 /** @brief Write the CPlayer::Statistics at the current position in the file. */
 void CDemoRecorder::WritePlayerStats()
 {
-	const size_t pos = demoStreams[isServerDemo].size();
+	const size_t pos = writer->GetNumAppendedBytes();
 
 	for (PlayerStatistics& stats: playerStats) {
 		stats.swab();
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&stats), sizeof(PlayerStatistics));
+		writer->Append(&stats, sizeof(PlayerStatistics));
 	}
 
 	fileHeader.numPlayers = playerStats.size();
-	fileHeader.playerStatSize = int(demoStreams[isServerDemo].size() - pos);
+	fileHeader.playerStatSize = int(writer->GetNumAppendedBytes() - pos);
 
 	playerStats.clear();
 }
@@ -263,38 +534,89 @@ void CDemoRecorder::WriteWinnerList()
 	if (fileHeader.numTeams == 0)
 		return;
 
-	const size_t pos = demoStreams[isServerDemo].size();
+	const size_t pos = writer->GetNumAppendedBytes();
 
 	// Write the array of winningAllyTeams.
 	for (size_t i = 0; i < winningAllyTeams.size(); i++) { // NOLINT{modernize-loop-convert}
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&winningAllyTeams[i]), sizeof(unsigned char));
+		writer->Append(&winningAllyTeams[i], sizeof(unsigned char));
 	}
 
 	winningAllyTeams.clear();
 
-	fileHeader.winningAllyTeamsSize = int(demoStreams[isServerDemo].size() - pos);
+	fileHeader.winningAllyTeamsSize = int(writer->GetNumAppendedBytes() - pos);
 }
 
 /** @brief Write the TeamStatistics at the current position in the file. */
 void CDemoRecorder::WriteTeamStats()
 {
-	const size_t pos = demoStreams[isServerDemo].size();
+	const size_t pos = writer->GetNumAppendedBytes();
 
 	// Write array of dwords indicating number of TeamStatistics per team.
 	for (std::vector<TeamStatistics>& history: teamStats) {
 		unsigned int c = swabDWord(history.size());
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&c), sizeof(unsigned int));
+		writer->Append(&c, sizeof(unsigned int));
 	}
 
-	// Write big array of TeamStatistics.
+	// Write big array of TeamStatistics, one append per team (the struct is packed).
 	for (std::vector<TeamStatistics>& history: teamStats) {
 		for (TeamStatistics& stats: history) {
 			stats.swab();
-			demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&stats), sizeof(TeamStatistics));
 		}
+
+		if (!history.empty())
+			writer->Append(history.data(), history.size() * sizeof(TeamStatistics));
 	}
 
-	fileHeader.teamStatSize = int(demoStreams[isServerDemo].size() - pos);
+	fileHeader.teamStatSize = int(writer->GetNumAppendedBytes() - pos);
 
 	teamStats.clear();
 }
+
+/** @brief Hand a savestate of the game at frameNum to the writer
+It is stored after the stats, along with the current position in the stream. */
+void CDemoRecorder::AddKeyframe(int frameNum, std::string&& state)
+{
+	if (writer == nullptr)
+		return;
+
+	std::vector<DemoKeyframe>& keyframes = writer->GetKeyframes();
+	DemoKeyframe keyframe;
+
+	keyframe.frameNum = frameNum;
+	keyframe.streamOffset = fileHeader.demoStreamSize;
+	keyframe.stateOffset = keyframes.empty()? 0: (keyframes.back().stateOffset + keyframes.back().stateSize);
+	keyframe.stateSize = state.size();
+
+	keyframes.push_back(keyframe);
+	writer->Push(CDemoFileWriter::WRITE_KEYFRAME, std::move(state));
+}
+
+/** @brief Write the keyframe index and trailer after the savestates. */
+void CDemoRecorder::WriteKeyframes()
+{
+	std::vector<DemoKeyframe>& keyframes = writer->GetKeyframes();
+
+	if (keyframes.empty())
+		return;
+
+	std::string index;
+	DemoKeyframeTrailer trailer;
+
+	trailer.numKeyframes = keyframes.size();
+	trailer.keyframesSize = keyframes.back().stateOffset + keyframes.back().stateSize;
+	trailer.keyframesSize += (keyframes.size() * sizeof(DemoKeyframe) + sizeof(DemoKeyframeTrailer));
+	strcpy(trailer.magic, DEMOFILE_KEYFRAME_MAGIC);
+	trailer.swab();
+
+	for (DemoKeyframe& keyframe: keyframes) {
+		keyframe.swab();
+		index.append(reinterpret_cast<const char*>(&keyframe), sizeof(DemoKeyframe));
+	}
+
+	index.append(reinterpret_cast<const char*>(&trailer), sizeof(DemoKeyframeTrailer));
+	keyframes.clear();
+
+	// savestates go in front of it, everything recorded so far must precede both
+	writer->PushBlock();
+	writer->Push(CDemoFileWriter::WRITE_KEYFRAMES, std::move(index));
+}
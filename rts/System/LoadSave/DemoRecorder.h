@@ -3,17 +3,24 @@
 #ifndef DEMO_RECORDER
 #define DEMO_RECORDER
 
+#include <future>
+#include <memory>
 #include <vector>
 #include <sstream>
-#include <zlib.h>
 
 #include "Demo.h"
 #include "Game/Players/PlayerStatistics.h"
 #include "Sim/Misc/TeamStatistics.h"
 
+class CDemoFileWriter;
+
 
 /**
  * @brief Used to record demos
+ *
+ * Recorded data is handed to a background thread that compresses it and
+ * streams it to disk while the game runs, so the recording thread never waits
+ * on file I/O and a crash loses at most the last few seconds of the demo.
  */
 class CDemoRecorder : public CDemo
 {
@@ -32,7 +39,8 @@ public:
 		memcpy(&fileHeader, &r.fileHeader, sizeof(fileHeader));
 		memset(&r.fileHeader, 0, sizeof(fileHeader));
 
-		std::swap(file, r.file);
+		std::swap(writer, r.writer);
+		std::swap(writerJob, r.writerJob);
 
 		std::swap(demoName, r.demoName);
 		std::swap(playerStats, r.playerStats);
@@ -44,12 +52,11 @@ public:
 	}
 
 
-	bool IsValid() const { return (file != nullptr); }
+	bool IsValid() const { return (writer != nullptr); }
 
 	void WriteSetupText(const std::string& text);
 	void SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime);
 
-	void SetStream();
 	void SetName(const std::string& mapName, const std::string& modName);
 	const std::string& GetName() const { return demoName; }
 
@@ -62,16 +69,20 @@ public:
 	void SetTeamStats(int teamNum, const std::vector<TeamStatistics>& stats);
 	void SetWinningAllyTeams(const std::vector<unsigned char>& winningAllyTeams);
 
+	void AddKeyframe(int frameNum, std::string&& state);
+
 private:
-	unsigned int WriteFileHeader(bool updateStreamLength);
+	void WriteFileHeader(bool updateStreamLength);
 	void SetFileHeader();
 	void WritePlayerStats();
 	void WriteTeamStats();
 	void WriteWinnerList();
+	void WriteKeyframes();
 	void WriteDemoFile();
 
 private:
-	gzFile file = nullptr;
+	std::shared_ptr<CDemoFileWriter> writer;
+	std::future<void> writerJob;
 
 	std::vector<PlayerStatistics> playerStats;
 	std::vector< std::vector<TeamStatistics> > teamStats;
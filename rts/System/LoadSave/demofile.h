@@ -40,6 +40,10 @@
  *         CTeam::Statistics for each team.
  *       - Array of all CTeam::Statistics (total number of items is the
  *         sum of the elements in the array of dwords).
+ *     - Keyframes (optional), consisting of:
+ *       - Savestates in the format of creg save-files, without compression.
+ *       - Array of DemoKeyframe entries, ordered by frame.
+ *       - DemoKeyframeTrailer, ending the file.
  *
  * The header is designed to be extensible: it contains a version field and a
  * headerSize field to support this. The version field is a major version number
@@ -49,6 +53,9 @@
  *
  * If Spring did not cleanup properly (crashed), the demoStreamSize is 0 and it
  * can be assumed the demo stream continues until the end of the file.
+ *
+ * Keyframes are not part of the header so older readers simply ignore them;
+ * a demo has them iff it ends with a DemoKeyframeTrailer.
  */
 struct DemoFileHeader
 {
@@ -115,6 +122,46 @@ struct DemoStreamChunkHeader
 	}
 };
 
+
+/** The last 16 bytes of each demofile that contains keyframes. */
+#define DEMOFILE_KEYFRAME_MAGIC "spring keyframe"
+
+/**
+ * @brief Spring demo keyframe index entry
+ *
+ * Loading the savestate and then playing the demo stream from streamOffset
+ * continues the game exactly as playing the stream from its start would.
+ */
+struct DemoKeyframe
+{
+	int frameNum;           ///< Frame the savestate was taken after.
+	int streamOffset;       ///< Offset into the demo stream of the first chunk to play after loading it.
+	int stateOffset;        ///< Offset of the savestate from the start of the keyframes chunk.
+	int stateSize;          ///< Size of the savestate.
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(frameNum);
+		swabDWordInPlace(streamOffset);
+		swabDWordInPlace(stateOffset);
+		swabDWordInPlace(stateSize);
+	}
+};
+
+/** @brief Spring demo keyframes chunk trailer */
+struct DemoKeyframeTrailer
+{
+	int numKeyframes;       ///< Number of DemoKeyframe entries preceding the trailer.
+	int keyframesSize;      ///< Size of the entire keyframes chunk, including this trailer.
+	char magic[16];         ///< DEMOFILE_KEYFRAME_MAGIC
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(numKeyframes);
+		swabDWordInPlace(keyframesSize);
+	}
+};
+
 #pragma pack(pop)
 
 #endif // DEMO_FILE_H
@@ -7,21 +7,41 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "Backend.h"
 #include "DefaultFilter.h"
+#include "FramePrefixer.h"
 #include "LogUtil.h"
 #include "System/MainDefines.h"
 
+#ifdef   likely
+#undef   likely
+#undef unlikely
+#endif
+
+#include "System/ConcurrentQueue.h"
+
 #define MAX_LOG_SINKS 8
 
 namespace log_formatter {
 	static std::array<log_sink_ptr, MAX_LOG_SINKS> sinks = {{nullptr}};
+	static std::array<log_sink_ptr, MAX_LOG_SINKS> bufferedSinks = {{nullptr}};
 	static std::array<log_cleanup_ptr, MAX_LOG_SINKS> cleanupFuncs = {{nullptr}};
 
 	static size_t numSinks = 0;
+	static size_t numBufferedSinks = 0;
 	static size_t numFuncs = 0;
 
+	// serializes calls to the buffered sinks, which may come from the logging
+	// thread and from whoever flushes the queue (e.g. the crash handler)
+	static std::recursive_mutex bufferedSinksMutex;
+
 	template<typename T, size_t S> bool array_insert(std::array<T, S>& array, T value, size_t& count) {
 		const auto iter = std::find(array.begin(), array.end(), nullptr);
 
@@ -53,8 +73,23 @@ namespace log_formatter {
 	bool insert_sink(log_sink_ptr sink) {
 		return (array_insert(sinks, sink, numSinks));
 	}
+	bool insert_buffered_sink(log_sink_ptr sink) {
+		std::lock_guard<std::recursive_mutex> lock(bufferedSinksMutex);
+		return (array_insert(bufferedSinks, sink, numBufferedSinks));
+	}
 	bool remove_sink(log_sink_ptr sink) {
-		return (array_remove(sinks, sink, numSinks));
+		if (array_remove(sinks, sink, numSinks))
+			return true;
+
+		std::lock_guard<std::recursive_mutex> lock(bufferedSinksMutex);
+		return (array_remove(bufferedSinks, sink, numBufferedSinks));
+	}
+
+	static void sink_buffered(int level, const char* section, const char* record) {
+		for (size_t i = 0; i < numBufferedSinks; i++) {
+			assert(bufferedSinks[i] != nullptr);
+			bufferedSinks[i](level, section, record);
+		}
 	}
 
 	bool insert_func(log_cleanup_ptr func) {
@@ -66,6 +101,104 @@ namespace log_formatter {
 }
 
 
+namespace log_async {
+	struct Record {
+		int level;
+		std::string section;
+		std::string prefix;
+		std::string msg;
+	};
+
+	// past this many queued records, the threads that log sink them themselves
+	static constexpr size_t MAX_QUEUED_RECORDS = 16384;
+	static constexpr size_t MAX_BATCH_SIZE = 256;
+
+	static std::atomic<bool> enabled = {false};
+
+	class Logger {
+	public:
+		~Logger() { Stop(); }
+
+		void Start() {
+			if (running.exchange(true))
+				return;
+
+			thread = std::thread(&Logger::Run, this);
+		}
+
+		void Stop() {
+			if (!running.exchange(false))
+				return;
+
+			thread.join();
+			Flush();
+		}
+
+		void Enqueue(int level, const char* section, const char* msg) {
+			char prefix[128] = {'\0'};
+			log_framePrefixer_createPrefix(prefix, sizeof(prefix));
+
+			// the moodycamel queue keeps a sub-queue per producing thread, so
+			// this does not contend with other loggers or the logging thread
+			records.enqueue({level, (section != nullptr)? section: "", prefix, msg});
+
+			if (records.size_approx() < MAX_QUEUED_RECORDS)
+				return;
+
+			// the logging thread can not keep up, slow down the producers
+			Flush();
+		}
+
+		/// sinks all queued records in batches, returns how many there were
+		size_t Flush() {
+			std::lock_guard<std::recursive_mutex> lock(log_formatter::bufferedSinksMutex);
+			std::vector<Record> batch(MAX_BATCH_SIZE);
+
+			size_t numRecords = 0;
+			size_t batchSize = 0;
+
+			while ((batchSize = records.try_dequeue_bulk(batch.begin(), batch.size())) > 0) {
+				for (size_t i = 0; i < batchSize; i++) {
+					const Record& r = batch[i];
+
+					// sinks prepend the prefix of when the record was logged, not now
+					log_framePrefixer_pinPrefix(r.prefix.c_str());
+					log_formatter::sink_buffered(r.level, r.section.c_str(), r.msg.c_str());
+				}
+
+				log_framePrefixer_pinPrefix(nullptr);
+				numRecords += batchSize;
+			}
+
+			return numRecords;
+		}
+
+	private:
+		void Run() {
+			while (running.load()) {
+				if (Flush() > 0)
+					continue;
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+		}
+
+	private:
+		moodycamel::ConcurrentQueue<Record> records;
+
+		std::thread thread;
+		std::atomic<bool> running = {false};
+	};
+
+	// constructed on first use, after the sinks have been registered, such that
+	// the queue is drained at exit before their static state is torn down
+	static Logger& GetLogger() {
+		static Logger logger;
+		return logger;
+	}
+}
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -79,8 +212,23 @@ static _threadlocal log_record_t prv_record = {{0}, "", "",  0, 0};
 extern void log_formatter_format(log_record_t* log, va_list arguments);
 
 void log_backend_registerSink(log_sink_ptr sink) { log_formatter::insert_sink(sink); }
+void log_backend_registerBufferedSink(log_sink_ptr sink) { log_formatter::insert_buffered_sink(sink); }
 void log_backend_unregisterSink(log_sink_ptr sink) { log_formatter::remove_sink(sink); }
 
+void log_backend_setAsync(bool enable)
+{
+	if (enable) {
+		log_async::GetLogger().Start();
+		log_async::enabled = true;
+		return;
+	}
+
+	if (!log_async::enabled.exchange(false))
+		return;
+
+	log_async::GetLogger().Stop();
+}
+
 void log_backend_registerCleanup(log_cleanup_ptr cleanupFunc) { log_formatter::insert_func(cleanupFunc); }
 void log_backend_unregisterCleanup(log_cleanup_ptr cleanupFunc) { log_formatter::remove_func(cleanupFunc); }
 
@@ -96,7 +244,7 @@ void log_backend_record(int level, const char* section, const char* fmt, va_list
 {
 	const auto& sinks = log_formatter::sinks;
 
-	if (log_formatter::numSinks == 0)
+	if ((log_formatter::numSinks + log_formatter::numBufferedSinks) == 0)
 		return;
 
 	cur_record.sec = section;
@@ -122,16 +270,26 @@ void log_backend_record(int level, const char* section, const char* fmt, va_list
 		sinks[i](level, section, cur_record.msg);
 	}
 
+	if (log_async::enabled.load()) {
+		log_async::GetLogger().Enqueue(level, section, cur_record.msg);
+	} else {
+		std::lock_guard<std::recursive_mutex> lock(log_formatter::bufferedSinksMutex);
+		log_formatter::sink_buffered(level, section, cur_record.msg);
+	}
+
 	if (cur_record.cnt > 0)
 		return;
 
 	memcpy(prv_record.msg, cur_record.msg, sizeof(cur_record.msg));
 }
 
-/// Passes on a cleanup request to all sinks
+/// Passes on a cleanup request to all sinks, after sinking what is queued
 void log_backend_cleanup() {
 	const auto& funcs = log_formatter::cleanupFuncs;
 
+	if (log_async::enabled.load())
+		log_async::GetLogger().Flush();
+
 	for (size_t i = 0; i < log_formatter::numFuncs; i++) {
 		assert(funcs[i] != nullptr);
 		funcs[i]();
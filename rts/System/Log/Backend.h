@@ -23,9 +23,24 @@ typedef void (*log_sink_ptr)(int level, const char* section, const char* record)
 /// Start routing log records to the supplied sink
 void log_backend_registerSink(log_sink_ptr sink);
 
-/// Stop routing log records to the supplied sink
+/**
+ * Start routing log records to the supplied sink, which may be called from
+ * the logging thread rather than the one that logged the record if
+ * asynchronous logging is enabled. Calls to it are serialized.
+ * @see log_backend_setAsync
+ */
+void log_backend_registerBufferedSink(log_sink_ptr sink);
+
+/// Stop routing log records to the supplied (regular or buffered) sink
 void log_backend_unregisterSink(log_sink_ptr sink);
 
+/**
+ * Enables or disables handing records for the buffered sinks to a logging
+ * thread. Records are formatted and timestamped where they are logged and
+ * queued without locking; disabling (or a cleanup) sinks all queued ones.
+ */
+void log_backend_setAsync(bool enable);
+
 
 typedef void (*log_cleanup_ptr)();
 
@@ -66,7 +66,7 @@ namespace {
 	/// Auto-registers the sink defined in this file before main() is called
 	struct ConsoleSinkRegistrator {
 		ConsoleSinkRegistrator() {
-			log_backend_registerSink(&log_sink_record_console);
+			log_backend_registerBufferedSink(&log_sink_record_console);
 		}
 		~ConsoleSinkRegistrator() {
 			log_backend_unregisterSink(&log_sink_record_console);
@@ -13,6 +13,7 @@
 #include <string>
 
 #include <algorithm>
+#include <mutex>
 #include <vector>
 
 
@@ -54,6 +55,12 @@ namespace log_file {
 	 */
 	bool validTracker = true;
 
+	/**
+	 * Records can be sunk by the logging thread while log files are added or
+	 * removed. Never held while logging, the backend may sink synchronously.
+	 */
+	std::mutex logFilesMutex;
+
 
 	/**
 	 * This class allows us to stop logging cleanly, when the application exits,
@@ -199,6 +206,8 @@ void log_file_addLogFile(
 ) {
 	assert(filePath != nullptr);
 
+	std::unique_lock<std::mutex> lock(log_file::logFilesMutex);
+
 	auto& logFiles = log_file::getLogFiles();
 
 	const std::string sectionsStr = (sections == nullptr) ? "" : sections;
@@ -214,6 +223,8 @@ void log_file_addLogFile(
 	FILE* tmpStream = fopen(filePath, "w");
 
 	if (tmpStream == nullptr) {
+		// logging sinks into the files (via the backend) as well
+		lock.unlock();
 		LOG_L(L_ERROR, "[%s] failed to open log file \"%s\" for writing", __func__, filePath);
 		return;
 	}
@@ -234,6 +245,8 @@ void log_file_addLogFile(
 void log_file_removeLogFile(const char* filePath) {
 	assert(filePath != nullptr);
 
+	std::lock_guard<std::mutex> lock(log_file::logFilesMutex);
+
 	auto& logFiles = log_file::getLogFiles();
 
 	const auto pred = [](const log_file::LogFilePair& a, const log_file::LogFilePair& b) { return (a.first < b.first); };
@@ -256,6 +269,8 @@ void log_file_removeLogFile(const char* filePath) {
 }
 
 void log_file_removeAllLogFiles() {
+	std::lock_guard<std::mutex> lock(log_file::logFilesMutex);
+
 	auto& logFiles = log_file::getLogFiles();
 
 	for (auto& logFilePair: logFiles) {
@@ -267,6 +282,8 @@ void log_file_removeAllLogFiles() {
 
 
 FILE* log_file_getLogFileStream(const char* filePath) {
+	std::lock_guard<std::mutex> lock(log_file::logFilesMutex);
+
 	const auto& logFiles = log_file::getLogFiles();
 
 	for (const auto& p: logFiles) {
@@ -290,6 +307,8 @@ FILE* log_file_getLogFileStream(const char* filePath) {
 /// Records a log entry
 static void log_sink_record_file(int level, const char* section, const char* record)
 {
+	std::lock_guard<std::mutex> lock(log_file::logFilesMutex);
+
 	if (log_file::validTracker && log_file::isActivelyLogging()) {
 		// write buffer to log file
 		log_file::writeBufferToFiles();
@@ -304,6 +323,8 @@ static void log_sink_record_file(int level, const char* section, const char* rec
 
 /// Cleans up all log streams, by flushing them.
 static void log_sink_cleanup_file() {
+	std::lock_guard<std::mutex> lock(log_file::logFilesMutex);
+
 	if (!log_file::isActivelyLogging())
 		return;
 
@@ -318,7 +339,7 @@ namespace {
 	/// Auto-registers the sink defined in this file before main() is called
 	struct FileSinkRegistrator {
 		FileSinkRegistrator() {
-			log_backend_registerSink(&log_sink_record_file);
+			log_backend_registerBufferedSink(&log_sink_record_file);
 			log_backend_registerCleanup(&log_sink_cleanup_file);
 		}
 		~FileSinkRegistrator() {
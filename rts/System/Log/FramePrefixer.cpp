@@ -23,13 +23,23 @@ extern "C" {
 // GlobalSynced makes sure this can not be dangling
 static int* frameNumRef = nullptr;
 
+static _threadlocal const char* pinnedPrefix = nullptr;
+
 void log_framePrefixer_setFrameNumReference(int* frameNumReference)
 {
 	frameNumRef = frameNumReference;
 }
 
+void log_framePrefixer_pinPrefix(const char* prefix)
+{
+	pinnedPrefix = prefix;
+}
+
 size_t log_framePrefixer_createPrefix(char* result, size_t resultSize)
 {
+	if (pinnedPrefix != nullptr)
+		return (SNPRINTF(result, resultSize, "%s", pinnedPrefix));
+
 	const static auto refTime = std::chrono::high_resolution_clock::now();
 	const        auto curTime = std::chrono::high_resolution_clock::now();
 
@@ -22,6 +22,13 @@ void log_framePrefixer_setFrameNumReference(int* frameNumReference);
  */
 size_t log_framePrefixer_createPrefix(char* result, size_t resultSize);
 
+/**
+ * Makes log_framePrefixer_createPrefix return the given prefix on the
+ * calling thread, until called with NULL. Used to sink records with the
+ * prefix they got when they were logged.
+ */
+void log_framePrefixer_pinPrefix(const char* prefix);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -6,6 +6,7 @@
 #include "Game/GameVersion.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/Log/Backend.h"
 #include "System/Log/DefaultFilter.h"
 #include "System/Log/FileSink.h"
 #include "System/Log/ILog.h"
@@ -43,6 +44,10 @@ CONFIG(int, LogRepeatLimit)
 	.defaultValue(10)
 	.description("Allow at most this many consecutive identical messages to be logged.");
 
+CONFIG(bool, LogAsync)
+	.defaultValue(false)
+	.description("Write the logfile and console output from a background thread. Messages keep the time they were logged at, and are written out before a crash report.");
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -184,6 +189,7 @@ void CLogOutput::Initialize()
 
 	log_filter_setRepeatLimit(configHandler->GetInt("LogRepeatLimit")); // all sinks
 	log_file_addLogFile(filePath.c_str(), nullptr, LOG_LEVEL_ALL, configHandler->GetInt("LogFlushLevel"));
+	log_backend_setAsync(configHandler->GetBool("LogAsync"));
 
 	LOG("LogOutput initialized. Logging to %s", filePath.c_str());
 }
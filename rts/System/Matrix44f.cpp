@@ -13,6 +13,14 @@
 #include <xmmintrin.h>
 #include <emmintrin.h>
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#define MATRIX_BATCH_AVX
+	#include <immintrin.h>
+
+	// no "fma" on purpose, fused multiply-adds would round differently than the SSE path
+	#define MATRIX_AVX __attribute__((target("avx")))
+#endif
+
 CR_BIND(CMatrix44f, )
 
 CR_REG_METADATA(CMatrix44f, CR_MEMBER(m))
@@ -459,6 +467,96 @@ float4 CMatrix44f::operator* (const float4 v) const
 }
 
 
+#ifdef MATRIX_BATCH_AVX
+// two vectors per iteration, one in each 128-bit lane; the per-lane
+// arithmetic is exactly that of operator*(float4)
+MATRIX_AVX static void MatrixVectorsMultiplyAVX(const CMatrix44f& m, const float4* vin, float4* vout, size_t count)
+{
+	const __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m.md[0][0]));
+	const __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m.md[1][0]));
+	const __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m.md[2][0]));
+	const __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m.md[3][0]));
+
+	for (size_t i = 0; i < count; i += 2) {
+		const __m256 v = _mm256_loadu_ps(&vin[i].x);
+
+		__m256 out;
+		out =                    _mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00)) ;
+		out = _mm256_add_ps(out, _mm256_mul_ps(c1, _mm256_permute_ps(v, 0x55)));
+		out = _mm256_add_ps(out, _mm256_mul_ps(c2, _mm256_permute_ps(v, 0xAA)));
+		out = _mm256_add_ps(out, _mm256_mul_ps(c3, _mm256_permute_ps(v, 0xFF)));
+
+		_mm256_storeu_ps(&vout[i].x, out);
+	}
+}
+
+MATRIX_AVX static void MatrixPointsMultiplyAVX(const CMatrix44f& m, const float3* vin, float3* vout, size_t count)
+{
+	const __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m.md[0][0]));
+	const __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m.md[1][0]));
+	const __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m.md[2][0]));
+	const __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m.md[3][0]));
+	// operator*(float3) multiplies the last column by w=1, which is exact
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	for (size_t i = 0; i < count; i += 2) {
+		const float3& p0 = vin[i    ];
+		const float3& p1 = vin[i + 1];
+
+		__m256 out;
+		out =                    _mm256_mul_ps(c0, _mm256_setr_ps(p0.x, p0.x, p0.x, p0.x, p1.x, p1.x, p1.x, p1.x)) ;
+		out = _mm256_add_ps(out, _mm256_mul_ps(c1, _mm256_setr_ps(p0.y, p0.y, p0.y, p0.y, p1.y, p1.y, p1.y, p1.y)));
+		out = _mm256_add_ps(out, _mm256_mul_ps(c2, _mm256_setr_ps(p0.z, p0.z, p0.z, p0.z, p1.z, p1.z, p1.z, p1.z)));
+		out = _mm256_add_ps(out, _mm256_mul_ps(c3, one));
+
+		float fout[8];
+		_mm256_storeu_ps(fout, out);
+
+		vout[i    ] = {fout[0], fout[1], fout[2]};
+		vout[i + 1] = {fout[4], fout[5], fout[6]};
+	}
+}
+
+static bool HaveAVX()
+{
+	static const bool haveAVX = __builtin_cpu_supports("avx");
+	return haveAVX;
+}
+#endif
+
+void CMatrix44f::Mul(const float3* vin, float3* vout, size_t count) const
+{
+	size_t i = 0;
+
+	#ifdef MATRIX_BATCH_AVX
+	if (HaveAVX()) {
+		MatrixPointsMultiplyAVX(*this, vin, vout, i = (count & ~size_t(1)));
+	}
+	#endif
+
+	for (; i < count; i++) {
+		vout[i] = (*this) * vin[i];
+	}
+}
+
+void CMatrix44f::Mul(const float4* vin, float4* vout, size_t count) const
+{
+	static_assert(sizeof(float4) == (sizeof(float) * 4), "");
+
+	size_t i = 0;
+
+	#ifdef MATRIX_BATCH_AVX
+	if (HaveAVX()) {
+		MatrixVectorsMultiplyAVX(*this, vin, vout, i = (count & ~size_t(1)));
+	}
+	#endif
+
+	for (; i < count; i++) {
+		vout[i] = (*this) * vin[i];
+	}
+}
+
+
 void CMatrix44f::SetUpVector(const float3 up)
 {
 	float3 zdir(m[8], m[9], m[10]);
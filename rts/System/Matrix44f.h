@@ -4,6 +4,7 @@
 #define MATRIX44F_H
 
 #include <cmath>
+#include <cstddef>
 
 #include "System/float3.h"
 #include "System/float4.h"
@@ -85,6 +86,12 @@ public:
 	float3 Mul(const float3 v) const { return ((*this) * v); }
 	float4 Mul(const float4 v) const { return ((*this) * v); }
 
+	/// batch versions of the above, vin may equal vout; bit-identical to
+	/// calling Mul per vector (AVX halves the loop count where available
+	/// but does the same IEEE operations in the same order, without FMA)
+	void Mul(const float3* vin, float3* vout, size_t count) const;
+	void Mul(const float4* vin, float4* vout, size_t count) const;
+
 	bool operator == (const CMatrix44f& rhs) const { return !(*this == rhs); }
 	bool operator != (const CMatrix44f& rhs) const;
 	/// matrix multiply
@@ -0,0 +1,146 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+
+#include "System/MemoryStats.h"
+#include "System/Log/ILog.h"
+
+#if defined(_WIN32)
+	#define PSAPI_VERSION 2 // K32 entry points, no psapi.lib needed
+	#include <windows.h>
+	#include <psapi.h>
+#elif defined(__APPLE__)
+	#include <mach/mach.h>
+	#include <sys/resource.h>
+#else
+	#include <sys/resource.h>
+	#include <unistd.h>
+#endif
+
+CMemoryStats memoryStats;
+
+
+void CMemoryStats::AddReporter(const std::string& name, Reporter&& reporter)
+{
+	const auto pred = [&](const std::pair<std::string, Reporter>& p) { return (p.first == name); };
+	const auto iter = std::find_if(reporters.begin(), reporters.end(), pred);
+
+	if (iter != reporters.end()) {
+		iter->second = std::move(reporter);
+		return;
+	}
+
+	reporters.emplace_back(name, std::move(reporter));
+}
+
+void CMemoryStats::ClearReporters()
+{
+	reporters.clear();
+
+	std::lock_guard<spring::mutex> lock(snapshotMutex);
+	snapshot.clear();
+}
+
+
+void CMemoryStats::Update()
+{
+	std::vector<Entry> entries;
+	entries.reserve(reporters.size());
+
+	for (const auto& p: reporters) {
+		entries.emplace_back(p.first, p.second());
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return (a.first < b.first); });
+
+	std::lock_guard<spring::mutex> lock(snapshotMutex);
+	snapshot = std::move(entries);
+}
+
+void CMemoryStats::PrintStats() const
+{
+	const std::vector<Entry> entries = GetSnapshot();
+
+	std::uint64_t sumBytes = 0;
+
+	LOG("%25s|%12s", "Subsystem", "Size");
+
+	for (const Entry& e: entries) {
+		LOG("%25s %10.2fMB", e.first.c_str(), e.second / (1024.0f * 1024.0f));
+		sumBytes += e.second;
+	}
+
+	LOG("%25s %10.2fMB", "(accounted)", sumBytes / (1024.0f * 1024.0f));
+	LOG("%25s %10.2fMB", "(resident)", GetResidentBytes() / (1024.0f * 1024.0f));
+	LOG("%25s %10.2fMB", "(peak resident)", GetPeakResidentBytes() / (1024.0f * 1024.0f));
+}
+
+
+std::vector<CMemoryStats::Entry> CMemoryStats::GetSnapshot() const
+{
+	std::lock_guard<spring::mutex> lock(snapshotMutex);
+	return snapshot;
+}
+
+
+std::uint64_t CMemoryStats::GetResidentBytes()
+{
+	#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+
+	return counters.WorkingSetSize;
+
+	#elif defined(__APPLE__)
+	mach_task_basic_info_data_t info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+		return 0;
+
+	return info.resident_size;
+
+	#else
+	// second field is the number of resident pages
+	FILE* file = fopen("/proc/self/statm", "r");
+
+	if (file == nullptr)
+		return 0;
+
+	unsigned long numPages[2] = {0, 0};
+
+	if (fscanf(file, "%lu %lu", &numPages[0], &numPages[1]) != 2)
+		numPages[1] = 0;
+
+	fclose(file);
+	return (std::uint64_t(numPages[1]) * sysconf(_SC_PAGESIZE));
+	#endif
+}
+
+std::uint64_t CMemoryStats::GetPeakResidentBytes()
+{
+	#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+
+	return counters.PeakWorkingSetSize;
+
+	#else
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	// bytes on OSX, KB elsewhere
+	#ifdef __APPLE__
+	return usage.ru_maxrss;
+	#else
+	return (std::uint64_t(usage.ru_maxrss) * 1024);
+	#endif
+	#endif
+}
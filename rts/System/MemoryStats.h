@@ -0,0 +1,50 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "System/Threading/SpringThreading.h"
+
+/**
+ * Per-subsystem memory accounting. Each subsystem (pathing, LOS, models, ...)
+ * gets a named reporter returning the bytes it currently holds; the figures
+ * are estimates from container sizes, memory pools, and GPU buffer/texture
+ * dimensions, allocator overhead and driver-side copies are not included.
+ *
+ * Reporters are only called from the main thread (by Update, about once per
+ * second); other threads, e.g. the server which forwards the figures to the
+ * autohost, read the snapshot taken by the last Update.
+ */
+class CMemoryStats {
+public:
+	typedef std::function<std::uint64_t()> Reporter;
+	typedef std::pair<std::string, std::uint64_t> Entry;
+
+	void AddReporter(const std::string& name, Reporter&& reporter);
+	void ClearReporters();
+
+	void Update();
+	void PrintStats() const;
+
+	// sorted by name
+	std::vector<Entry> GetSnapshot() const;
+
+	// resident set size of the process, current and peak
+	static std::uint64_t GetResidentBytes();
+	static std::uint64_t GetPeakResidentBytes();
+
+private:
+	std::vector< std::pair<std::string, Reporter> > reporters;
+	std::vector<Entry> snapshot;
+
+	mutable spring::mutex snapshotMutex;
+};
+
+extern CMemoryStats memoryStats;
+
+#endif // MEMORY_STATS_H
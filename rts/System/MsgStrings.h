@@ -11,6 +11,8 @@ const std::string ServerStart = "Server started on port %d";
 const std::string PlayingDemo = "Opening demofile %s";
 const std::string ConnectAutohost = "Connecting to autohost on port %d";
 const std::string ConnectAutohostFailed = "Failed connecting to autohost on IP %s, port %d";
+const std::string ConnectAutohostSocket = "Connecting to autohost on socket %s";
+const std::string ConnectAutohostSocketFailed = "Failed connecting to autohost on socket %s";
 const std::string DemoStart = "Beginning demo playback";
 const std::string DemoEnd = "End of demo reached";
 const std::string GameEnd = "Game has ended";
@@ -18,6 +20,8 @@ const std::string NoClientsExit = "No clients connected, shutting down server";
 
 const std::string NoSyncResponse = "Error: Player %s did not send sync checksum for frame %d";
 const std::string SyncError = "Sync error for %s in frame %d (got %x, correct is %x)";
+const std::string SyncTreeError = "Sync tree of %s differs in frame %d: %s";
+const std::string SyncTreeDumpRequest = "Requested state dumps of frame %d from all clients";
 const std::string NoSyncCheck = "Warning: Sync checking disabled!";
 
 const std::string ConnectionReject = "Connection attempt rejected from %s: %s";
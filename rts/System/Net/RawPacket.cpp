@@ -1,19 +1,106 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <string.h>
+#include <array>
+#include <mutex>
 #include <stdexcept>
 
 #include "RawPacket.h"
 
 #include "System/Log/ILog.h"
+#include "System/Threading/SpringThreading.h"
 
 namespace netcode
 {
 
+namespace {
+	// size-classes of 16, 32, ..., 4096 bytes; each block is preceded by a header
+	// holding its class so a buffer can be freed without knowing its size (which
+	// also keeps payloads 8-byte aligned)
+	class PacketBufferPool {
+	public:
+		static constexpr size_t NUM_CLASSES = 9;
+		static constexpr size_t MIN_BLOCK_SIZE = 16;
+		static constexpr size_t HEADER_SIZE = 8;
+		static constexpr size_t SLAB_SIZE = 64 * 1024;
+
+		uint8_t* Alloc(size_t size) {
+			size_t sizeClass = 0;
+
+			while (sizeClass < NUM_CLASSES && (MIN_BLOCK_SIZE << sizeClass) < size) {
+				sizeClass++;
+			}
+
+			uint8_t* block = nullptr;
+
+			if (sizeClass == NUM_CLASSES) {
+				block = new uint8_t[HEADER_SIZE + size];
+			} else {
+				std::lock_guard<spring::spinlock> lock(mutex);
+
+				if (freeBlocks[sizeClass] == nullptr)
+					AddSlab(sizeClass);
+
+				block = freeBlocks[sizeClass];
+				freeBlocks[sizeClass] = *reinterpret_cast<uint8_t**>(block);
+			}
+
+			block[0] = sizeClass;
+			return (block + HEADER_SIZE);
+		}
+
+		void Free(uint8_t* buffer) {
+			uint8_t* block = buffer - HEADER_SIZE;
+			const size_t sizeClass = block[0];
+
+			if (sizeClass == NUM_CLASSES) {
+				delete[] block;
+				return;
+			}
+
+			std::lock_guard<spring::spinlock> lock(mutex);
+
+			*reinterpret_cast<uint8_t**>(block) = freeBlocks[sizeClass];
+			freeBlocks[sizeClass] = block;
+		}
+
+	private:
+		void AddSlab(size_t sizeClass) {
+			const size_t blockSize = HEADER_SIZE + (MIN_BLOCK_SIZE << sizeClass);
+
+			// never released, so the pool settles at the peak number of packets in flight
+			uint8_t* slab = new uint8_t[SLAB_SIZE];
+
+			for (size_t offset = 0; (offset + blockSize) <= SLAB_SIZE; offset += blockSize) {
+				*reinterpret_cast<uint8_t**>(slab + offset) = freeBlocks[sizeClass];
+				freeBlocks[sizeClass] = slab + offset;
+			}
+		}
+
+	private:
+		// packets are made and dropped by the sim, net and server threads alike
+		spring::spinlock mutex;
+
+		std::array<uint8_t*, NUM_CLASSES> freeBlocks = {};
+	};
+
+	PacketBufferPool* GetBufferPool() {
+		// leaked deliberately, packets may be made during static initialization
+		// and still be released during static destruction
+		static PacketBufferPool* pool = new PacketBufferPool();
+		return pool;
+	}
+}
+
+
+uint8_t* RawPacket::AllocBuffer(size_t size) { return (GetBufferPool()->Alloc(size)); }
+void RawPacket::FreeBuffer(uint8_t* buffer) { GetBufferPool()->Free(buffer); }
+
+
 RawPacket::RawPacket(const uint8_t* const tdata, const uint32_t newLength): length(newLength)
 {
 	if (length > 0) {
-		data = new uint8_t[length];
+		data = AllocBuffer(length);
 		memcpy(data, tdata, length);
 	} else {
 		LOG_L(L_ERROR, "[%s] tried to pack a zero-length packet", __func__);
@@ -19,6 +19,9 @@ namespace netcode
 
 /**
  * @brief simple structure to hold some data
+ *
+ * Packets and payloads of up to 4KB are carved from pooled slabs; thousands
+ * are created and dropped per second on a busy server.
  */
 class RawPacket
 {
@@ -40,7 +43,7 @@ public:
 		if (length == 0)
 			return;
 
-		data = new uint8_t[length];
+		data = AllocBuffer(length);
 	}
 
 	RawPacket(const uint32_t length, uint8_t msgID): RawPacket(length) {
@@ -53,9 +56,14 @@ public:
 	~RawPacket() { Delete(); }
 
 
+	static void* operator new(size_t size) { return (AllocBuffer(size)); }
+	static void operator delete(void* p) { FreeBuffer(static_cast<uint8_t*>(p)); }
+
 	RawPacket& operator = (const RawPacket&  p) = delete;
 	RawPacket& operator = (      RawPacket&& p) {
 		// assume no self-assignment
+		Delete();
+
 		data = p.data;
 		p.data = nullptr;
 
@@ -117,12 +125,16 @@ public:
 		if (length == 0)
 			return;
 
-		delete[] data;
+		FreeBuffer(data);
 		data = nullptr;
 
 		length = 0;
 	}
 
+private:
+	static uint8_t* AllocBuffer(size_t size);
+	static void FreeBuffer(uint8_t* buffer);
+
 public:
 	uint8_t id = 0;
 	uint8_t* data = nullptr;
@@ -3,7 +3,10 @@
 #include "UDPConnection.h"
 
 #include <cinttypes>
+#include <cmath>
+#include <mutex>
 
+#include <zlib.h>
 
 #include "Socket.h"
 #include "ProtocolDef.h"
@@ -28,6 +31,32 @@ static constexpr unsigned udpMaxPacketSize = 4096;
 static constexpr int maxChunkSize = 254;
 static constexpr int chunksPerSec = 30;
 
+// see SendPacket
+static std::mutex sharedSocketMutex;
+
+// A compressing end sends this as the only byte of its first chunk (it is not
+// a valid message id); the data of every later chunk is a sequence of stream
+// segments with a one-byte header 0xxxxxxx for x+1 raw bytes or a two-byte
+// header 1xxxxxxx xxxxxxxx for x+1 bytes of a single deflate stream running
+// over the lifetime of the connection, flushed after each segment.
+static constexpr std::uint8_t compressedStreamMarker = 0xFF;
+static constexpr unsigned maxRawSegmentSize = 0x80;
+static constexpr unsigned maxDeflateSegmentSize = 0x8000;
+// less queued data than this goes out raw, the flush overhead would eat the gain
+static constexpr unsigned minDeflateInputSize = 48;
+// bounds how much queued data is compressed before bandwidth is checked again
+static constexpr unsigned maxDeflateInputSize = 0x4000;
+// small window, memory use is paid per connection on a server
+static constexpr int deflateWindowBits = 12;
+static constexpr int deflateMemLevel = 5;
+
+// congestion window bounds in chunks, and the lower resend timeout bound in
+// milliseconds (the upper is the fixed timeout used without congestion control)
+static constexpr float minCongestionWindow = 4.0f;
+static constexpr float maxCongestionWindow = 1024.0f;
+static constexpr float initCongestionWindow = 16.0f;
+static constexpr int minResendTimeout = 60;
+
 
 
 #if NETWORK_TEST
@@ -97,7 +126,7 @@ public:
 	}
 
 	void Unpack(std::vector<std::uint8_t>& t, unsigned unpackLength) {
-		std::copy(data + pos, data + pos + unpackLength, std::back_inserter(t));
+		t.insert(t.end(), data + pos, data + pos + unpackLength);
 		pos += unpackLength;
 	}
 
@@ -171,7 +200,7 @@ Packet::Packet(const unsigned char* data, unsigned length)
 	chunks.reserve(buf.Remaining() / Chunk::headerSize);
 
 	while (buf.Remaining() > Chunk::headerSize) {
-		ChunkPtr temp(new Chunk);
+		ChunkPtr temp = std::make_shared<Chunk>();
 		buf.Unpack(temp->chunkNumber);
 		buf.Unpack(temp->chunkSize);
 
@@ -260,6 +289,19 @@ UDPConnection::UDPConnection(CConnection& conn)
 	Init();
 }
 
+void UDPConnection::DeflateDeleter::operator () (z_stream_s* s) const
+{
+	deflateEnd(s);
+	delete s;
+}
+
+void UDPConnection::InflateDeleter::operator () (z_stream_s* s) const
+{
+	inflateEnd(s);
+	delete s;
+}
+
+
 void UDPConnection::Init()
 {
 	// make sure protocoldef is initialized
@@ -302,6 +344,8 @@ void UDPConnection::Init()
 	lastNak = -1;
 	sentOverhead = 0;
 	recvOverhead = 0;
+	sentPlain = 0;
+	sentCompressed = 0;
 
 	resentChunks = 0;
 	sentPackets = 0;
@@ -320,6 +364,31 @@ void UDPConnection::Init()
 
 	netLossFactor = globalConfig.networkLossFactor;
 	lastMidChunk = -1;
+
+	congestionControl = globalConfig.networkCongestionControl;
+	smoothedRTT = 0.0f;
+	varianceRTT = 0.0f;
+	congestionWindow = initCongestionWindow;
+	slowStartThreshold = maxCongestionWindow;
+	pacingBudget = mtu;
+	lastPacingTime = spring_gettime();
+	lastWindowShrinkTime = spring_gettime();
+	lostChunks = 0;
+
+	segmentOutBuffer.clear();
+	segmentInBuffer.clear();
+	inflateStream.reset();
+	deflateStream.reset();
+
+	if (globalConfig.networkCompression) {
+		// raw deflate, chunks are checksummed already
+		deflateStream.reset(new z_stream_s());
+
+		if (deflateInit2(deflateStream.get(), Z_DEFAULT_COMPRESSION, Z_DEFLATED, -deflateWindowBits, deflateMemLevel, Z_DEFAULT_STRATEGY) != Z_OK) {
+			LOG_L(L_ERROR, "[UDPConnection::%s] failed to initialize stream compression", __func__);
+			deflateStream.reset();
+		}
+	}
 #if	NETWORK_TEST
 	lossCounter = 0;
 #endif
@@ -589,6 +658,9 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 				}
 			}
 
+			if (incoming.nakType != 0)
+				ShrinkCongestionWindow();
+
 			UpdateResendRequests();
 		}
 	}
@@ -624,7 +696,17 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 			fragmentBuffer.Delete();
 		}
 
-		std::copy(wpi->second.data, wpi->second.data + wpi->second.length, std::back_inserter(waitBuffer));
+		if (inflateStream != nullptr) {
+			ReadSegments(wpi->second.data, wpi->second.length);
+		} else if (lastInOrder == -1 && wpi->second.length == 1 && wpi->second.data[0] == compressedStreamMarker) {
+			// the other end compresses; accept any window size
+			inflateStream.reset(new z_stream_s());
+
+			if (inflateInit2(inflateStream.get(), -MAX_WBITS) != Z_OK)
+				throw network_error("[UDPConnection] failed to initialize stream decompression");
+		} else {
+			std::copy(wpi->second.data, wpi->second.data + wpi->second.length, std::back_inserter(waitBuffer));
+		}
 
 		incomingChunkNums.erase(wpi->first);
 		// waitingPackets.erase(wpi);
@@ -702,8 +784,10 @@ void UDPConnection::Flush(const bool forced)
 
 	// do not create chunks more than chunksPerSec times per second
 	const bool waitMore = (lastChunkCreatedTime >= (curTime - spring_msecs(1000 / chunksPerSec)));
-	// if the packet is tiny, reduce the send frequency further
-	const int requiredLength = ((200 >> netLossFactor) - spring_tomsecs(curTime - lastChunkCreatedTime)) / 10;
+	// if the packet is tiny, reduce the send frequency further; the bytes required
+	// for a chunk go down to zero over the bundle latency since the last one
+	const int bundleLatency = (globalConfig.networkBundleLatency >= 0)? globalConfig.networkBundleLatency: (200 >> netLossFactor);
+	const int requiredLength = (bundleLatency - spring_tomsecs(curTime - lastChunkCreatedTime)) / 10;
 
 	int outgoingLength = 0;
 
@@ -713,7 +797,11 @@ void UDPConnection::Flush(const bool forced)
 		}
 	}
 
-	if (forced || (!waitMore && outgoingLength > requiredLength)) {
+	const bool createChunks = (forced || (!waitMore && outgoingLength > requiredLength));
+
+	if (createChunks && deflateStream != nullptr) {
+		FlushCompressed(forced);
+	} else if (createChunks) {
 		std::uint8_t buffer[udpMaxPacketSize];
 		unsigned pos = 0;
 
@@ -737,22 +825,23 @@ void UDPConnection::Flush(const bool forced)
 					);
 					outgoingData.pop_front();
 				} else {
-					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length);
+					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length - outgoingDataPos);
 
 					assert(packet->length > 0);
-					memcpy(buffer + pos, packet->data, numBytes);
+					memcpy(buffer + pos, packet->data + outgoingDataPos, numBytes);
 
 					pos += numBytes;
 					sentOverhead += Packet::headerSize;
 
 					outgoing.DataSent(numBytes, true);
 
-					if ((partialPacket = (numBytes != packet->length))) {
-						// partially transfered
-						packet.reset(new RawPacket(packet->data + numBytes, packet->length - numBytes));
+					if ((partialPacket = ((outgoingDataPos += numBytes) != packet->length))) {
+						// partially transfered, the next chunk continues at the offset
+						// (the packet may be shared by every connection of a broadcast)
 					} else {
 						// full packet copied
 						outgoingData.pop_front();
+						outgoingDataPos = 0;
 					}
 				}
 			}
@@ -766,6 +855,159 @@ void UDPConnection::Flush(const bool forced)
 	SendIfNecessary(forced);
 }
 
+void UDPConnection::FlushCompressed(bool forced)
+{
+	if (currentPacketChunkNum == 0)
+		CreateChunk(&compressedStreamMarker, 1, currentPacketChunkNum++);
+
+	bool sendMore = true;
+
+	do {
+		plainBuffer.clear();
+
+		// whole packets only, the other end reassembles them across segments and chunks anyway
+		while (!outgoingData.empty() && plainBuffer.size() < maxDeflateInputSize) {
+			sendMore  = (outgoing.GetAverage(true) <= globalConfig.linkOutgoingBandwidth);
+			sendMore |= ((globalConfig.linkOutgoingBandwidth <= 0) || forced);
+
+			if (!sendMore)
+				break;
+
+			const std::shared_ptr<const RawPacket>& packet = *(outgoingData.begin());
+
+			if (!ProtocolDef::GetInstance()->IsValidPacket(packet->data, packet->length)) {
+				LOG_L(L_ERROR,
+					"[UDPConnection::%s] discarding outgoing invalid packet: ID %d, LEN %d",
+					__func__, ((packet->length > 0) ? (int)packet->data[0] : -1), packet->length
+				);
+			} else {
+				plainBuffer.insert(plainBuffer.end(), packet->data, packet->data + packet->length);
+			}
+
+			outgoingData.pop_front();
+		}
+
+		if (plainBuffer.empty())
+			break;
+
+		segmentOutBuffer.clear();
+
+		if (plainBuffer.size() < minDeflateInputSize) {
+			for (unsigned pos = 0; pos < plainBuffer.size(); pos += maxRawSegmentSize) {
+				const unsigned numBytes = std::min(unsigned(plainBuffer.size()) - pos, maxRawSegmentSize);
+
+				segmentOutBuffer.push_back(numBytes - 1);
+				segmentOutBuffer.insert(segmentOutBuffer.end(), &plainBuffer[pos], &plainBuffer[pos] + numBytes);
+			}
+		} else {
+			z_stream_s* zs = deflateStream.get();
+
+			unsigned numOut = 0;
+
+			deflateBuffer.resize(deflateBound(zs, plainBuffer.size()) + 16);
+
+			zs->next_in = &plainBuffer[0];
+			zs->avail_in = plainBuffer.size();
+
+			// sync-flush, the other end has to be able to decode everything sent so far
+			while (true) {
+				zs->next_out = &deflateBuffer[numOut];
+				zs->avail_out = deflateBuffer.size() - numOut;
+
+				deflate(zs, Z_SYNC_FLUSH);
+
+				numOut = deflateBuffer.size() - zs->avail_out;
+
+				if (zs->avail_out != 0)
+					break;
+
+				deflateBuffer.resize(deflateBuffer.size() * 2);
+			}
+
+			for (unsigned pos = 0; pos < numOut; pos += maxDeflateSegmentSize) {
+				const unsigned numBytes = std::min(numOut - pos, maxDeflateSegmentSize);
+
+				segmentOutBuffer.push_back(0x80 | ((numBytes - 1) >> 8));
+				segmentOutBuffer.push_back((numBytes - 1) & 0xFF);
+				segmentOutBuffer.insert(segmentOutBuffer.end(), &deflateBuffer[pos], &deflateBuffer[pos] + numBytes);
+			}
+		}
+
+		for (unsigned pos = 0; pos < segmentOutBuffer.size(); pos += maxChunkSize) {
+			const unsigned numBytes = std::min(unsigned(segmentOutBuffer.size()) - pos, unsigned(maxChunkSize));
+
+			CreateChunk(&segmentOutBuffer[pos], numBytes, currentPacketChunkNum++);
+
+			sentOverhead += Packet::headerSize;
+			outgoing.DataSent(numBytes, true);
+		}
+
+		sentPlain += plainBuffer.size();
+		sentCompressed += segmentOutBuffer.size();
+	} while (!outgoingData.empty() && sendMore);
+}
+
+void UDPConnection::ReadSegments(const std::uint8_t* data, unsigned length)
+{
+	segmentInBuffer.insert(segmentInBuffer.end(), data, data + length);
+
+	unsigned pos = 0;
+
+	while (pos < segmentInBuffer.size()) {
+		const std::uint8_t header = segmentInBuffer[pos];
+		const bool deflated = ((header & 0x80) != 0);
+
+		const unsigned headerSize = 1 + deflated;
+
+		if ((pos + headerSize) > segmentInBuffer.size())
+			break;
+
+		const unsigned segmentSize = (deflated? (((header & 0x7F) << 8) | segmentInBuffer[pos + 1]): header) + 1;
+
+		// partial segment, wait for the next chunk
+		if ((pos + headerSize + segmentSize) > segmentInBuffer.size())
+			break;
+
+		std::uint8_t* segment = &segmentInBuffer[pos + headerSize];
+
+		pos += (headerSize + segmentSize);
+
+		if (!deflated) {
+			waitBuffer.insert(waitBuffer.end(), segment, segment + segmentSize);
+			continue;
+		}
+
+		z_stream_s* zs = inflateStream.get();
+
+		zs->next_in = segment;
+		zs->avail_in = segmentSize;
+
+		do {
+			const size_t numOut = waitBuffer.size();
+
+			waitBuffer.resize(numOut + segmentSize * 4);
+
+			zs->next_out = &waitBuffer[numOut];
+			zs->avail_out = waitBuffer.size() - numOut;
+
+			const int ret = inflate(zs, Z_SYNC_FLUSH);
+
+			waitBuffer.resize(waitBuffer.size() - zs->avail_out);
+
+			// Z_BUF_ERROR only means there was nothing left to decode
+			if (ret == Z_BUF_ERROR)
+				break;
+
+			if (ret != Z_OK) {
+				LOG_L(L_ERROR, "\t[%s] discarding undecodable stream segment: LEN %u (%s)", __func__, segmentSize, (zs->msg != nullptr)? zs->msg: "?");
+				break;
+			}
+		} while (zs->avail_in > 0 || zs->avail_out == 0);
+	}
+
+	segmentInBuffer.erase(segmentInBuffer.begin(), segmentInBuffer.begin() + pos);
+}
+
 bool UDPConnection::CheckTimeout(int seconds, bool initial) const {
 
 	int timeout;
@@ -809,6 +1051,9 @@ std::string UDPConnection::Statistics() const
 		"\t{%.3fx, %.3fx} relative protocol overhead {up, down}\n",
 		"\t%u incoming chunks dropped, %u outgoing chunks resent\n",
 		"\t%u incoming chunks processed\n",
+		"\t%u bytes compressed to %u (%.3fx)\n",
+		"\t%.3f%% outgoing chunks lost, %.1fms RTT (%.1fms deviation)\n",
+		"\t%.1f chunks congestion window (%.1f slow-start threshold)\n",
 	};
 
 	std::string msg = "[UDPConnection::Statistics]\n";
@@ -817,6 +1062,15 @@ std::string UDPConnection::Statistics() const
 	msg += spring::format(fmts[2], spring::SafeDivide(sentOverhead * 1.0f, dataSent * 1.0f), spring::SafeDivide(recvOverhead * 1.0f, dataRecv * 1.0f));
 	msg += spring::format(fmts[3], droppedChunks, resentChunks);
 	msg += spring::format(fmts[4], lastInOrder + 1);
+
+	if (deflateStream != nullptr)
+		msg += spring::format(fmts[5], sentPlain, sentCompressed, spring::SafeDivide(sentCompressed * 1.0f, sentPlain * 1.0f));
+
+	msg += spring::format(fmts[6], spring::SafeDivide(lostChunks * 100.0f, currentPacketChunkNum * 1.0f), smoothedRTT, varianceRTT);
+
+	if (congestionControl)
+		msg += spring::format(fmts[7], congestionWindow, slowStartThreshold);
+
 	return msg;
 }
 
@@ -835,10 +1089,10 @@ void UDPConnection::SetMTU(unsigned mtu2)
 void UDPConnection::CreateChunk(const unsigned char* data, const unsigned length, const int packetNum)
 {
 	assert((length > 0) && (length < 255));
-	ChunkPtr buf(new Chunk);
+	ChunkPtr buf = std::make_shared<Chunk>();
 	buf->chunkNumber = packetNum;
 	buf->chunkSize = length;
-	std::copy(data, data + length, std::back_inserter(buf->data));
+	buf->data.assign(data, data + length);
 	newChunks.push_back(buf);
 	lastChunkCreatedTime = spring_gettime();
 }
@@ -848,6 +1102,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 	const spring_time curTime = spring_gettime();
 	const spring_time difTime = curTime - lastPacketSendTime;
 	const spring_time unackTime = spring_msecs(400 >> netLossFactor);
+	const spring_time resendTime = GetResendTimeout();
 
 	int nak = 0;
 	int rev = 0;
@@ -891,20 +1146,36 @@ void UDPConnection::SendIfNecessary(bool flushed)
 	}
 
 	if (!unackedChunks.empty() &&
-		(curTime - lastChunkCreatedTime) > unackTime &&
-		(curTime - lastUnackResentTime) > unackTime) {
+		(curTime - lastChunkCreatedTime) > resendTime &&
+		(curTime - lastUnackResentTime) > resendTime) {
 
 		// resend last packet if we didn't get an ack within reasonable time
 		// and don't plan sending out a new chunk either
-		if (newChunks.empty())
+		if (newChunks.empty()) {
 			RequestResend(*unackedChunks.rbegin(), false);
+			ShrinkCongestionWindow();
+		}
 
 		lastUnackResentTime = curTime;
 	}
 
+	if (congestionControl) {
+		// refill at the rate the window allows per round-trip, probing faster during slow-start
+		const float rttEstimate = (smoothedRTT > 0.0f)? smoothedRTT: unackTime.toMilliSecsf();
+		const float pacingGain = (congestionWindow < slowStartThreshold)? 2.0f: 1.25f;
+		const float pacingRate = congestionWindow * (Chunk::maxSize + Chunk::headerSize) * pacingGain / rttEstimate;
+
+		pacingBudget += ((curTime - lastPacingTime).toMilliSecsf() * pacingRate);
+		pacingBudget = std::min(pacingBudget, std::max(mtu * 1.0f, pacingRate * (1000.0f / chunksPerSec)));
+		lastPacingTime = curTime;
+	}
 
-	const bool flushSend = (flushed || !newChunks.empty());
-	const bool otherSend = (UseMinLossFactor() && !resendRequested.empty());
+	// forced flushes (connecting, closing) are never held back
+	const auto CanPace = [&](unsigned size) { return (!congestionControl || flushed || pacingBudget >= size); };
+	const auto CanSendNew = [&]() { return (!newChunks.empty() && (flushed || CongestionWindowOpen()) && CanPace(newChunks[0]->GetSize())); };
+
+	const bool flushSend = (flushed || CanSendNew());
+	const bool otherSend = (UseMinLossFactor() && !resendRequested.empty() && CanPace(resendRequested.begin()->second->GetSize()));
 	const bool unackSend = (nak > 0) || (difTime > (unackTime * 0.5f));
 
 	if (!flushSend && !otherSend && !unackSend)
@@ -924,6 +1195,10 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		return ((UseMinLossFactor() || (rev == 0)) ? resFwdIter->second->GetSize() : ((rev == 1) ? resRevIter->second->GetSize() : resMidIter->second->GetSize()));
 	};
 
+	// no more resends per call than chunks allowed in flight
+	if (congestionControl)
+		maxResend = std::min(maxResend, int(congestionWindow));
+
 	if (!UseMinLossFactor()) {
 		// keep resend reasonable, or it could cause a tremendous flood of packets
 		maxResend = std::min(maxResend, 20 * netLossFactor);
@@ -970,9 +1245,11 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		bool sent = false;
 
 		while (true) {
+			const unsigned bufSize = buf.GetSize();
+
 			// NB: if maxResend equals 0, then resendRequested is empty and iterators will be invalid
-			const bool canResend = (maxResend > 0) && ((buf.GetSize() + CalcResendSize()) <= mtu);
-			const bool canSendNew = !newChunks.empty() && ((buf.GetSize() + newChunks[0]->GetSize()) <= mtu);
+			const bool canResend = (maxResend > 0) && ((bufSize + CalcResendSize()) <= mtu) && CanPace(CalcResendSize());
+			const bool canSendNew = CanSendNew() && ((bufSize + newChunks[0]->GetSize()) <= mtu);
 
 			if (!canResend && !canSendNew)
 				break;
@@ -1016,11 +1293,15 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 				sent = true;
 			} else if (!resend && canSendNew) {
+				newChunks[0]->sendTime = curTime;
+
 				buf.chunks.push_back(newChunks[0]);
 				unackedChunks.push_back(newChunks[0]);
 				newChunks.pop_front();
 				sent = true;
 			}
+
+			pacingBudget -= (buf.GetSize() - bufSize);
 		}
 
 		buf.checksum = buf.GetChecksum();
@@ -1056,8 +1337,16 @@ void UDPConnection::SendPacket(Packet& pkt)
 	ip::udp::socket::message_flags flags = 0;
 	asio::error_code err;
 
-	EMULATE_LATENCY( !EMULATE_PACKET_LOSS( LOSS_COUNTER ) ) {
-		mySocket->send_to(buffer(sendBuffer), addr, flags, err);
+	{
+		// connections sharing a UDPListener's socket may be flushed from several threads
+		std::unique_lock<std::mutex> lock(sharedSocketMutex, std::defer_lock);
+
+		if (sharedSocket)
+			lock.lock();
+
+		EMULATE_LATENCY( !EMULATE_PACKET_LOSS( LOSS_COUNTER ) ) {
+			mySocket->send_to(buffer(sendBuffer), addr, flags, err);
+		}
 	}
 
 	if (CheckErrorCode(err))
@@ -1069,7 +1358,13 @@ void UDPConnection::SendPacket(Packet& pkt)
 
 void UDPConnection::AckChunks(int lastAck)
 {
+	const spring_time curTime = spring_gettime();
+
 	while (!unackedChunks.empty() && (lastAck >= (*unackedChunks.begin())->chunkNumber)) {
+		if (!unackedChunks[0]->resent)
+			UpdateRoundTripTime(curTime - unackedChunks[0]->sendTime);
+
+		GrowCongestionWindow();
 		unackedChunks.pop_front();
 	}
 
@@ -1084,6 +1379,9 @@ void UDPConnection::AckChunks(int lastAck)
 
 void UDPConnection::RequestResend(ChunkPtr ptr, bool noSort)
 {
+	lostChunks += (!ptr->resent);
+	ptr->resent = true;
+
 	resendRequested.emplace_back(ptr->chunkNumber, ptr);
 
 	if (noSort)
@@ -1100,6 +1398,62 @@ void UDPConnection::RequestResend(ChunkPtr ptr, bool noSort)
 
 
 
+
+spring_time UDPConnection::GetResendTimeout() const
+{
+	const spring_time maxTimeout = spring_msecs(400 >> netLossFactor);
+
+	if (!congestionControl || smoothedRTT == 0.0f)
+		return maxTimeout;
+
+	return (std::min(maxTimeout, spring_msecs(std::max(minResendTimeout, int(smoothedRTT + 4.0f * varianceRTT)))));
+}
+
+void UDPConnection::UpdateRoundTripTime(spring_time sample)
+{
+	// includes the time the other end holds its ack back, which the timeout has to cover too
+	const float rtt = std::max(sample.toMilliSecsf(), 1.0f);
+
+	if (smoothedRTT == 0.0f) {
+		smoothedRTT = rtt;
+		varianceRTT = rtt * 0.5f;
+		return;
+	}
+
+	varianceRTT = varianceRTT * 0.75f + std::fabs(smoothedRTT - rtt) * 0.25f;
+	smoothedRTT = smoothedRTT * 0.875f + rtt * 0.125f;
+}
+
+void UDPConnection::GrowCongestionWindow()
+{
+	if (congestionWindow < slowStartThreshold) {
+		congestionWindow += 1.0f;
+	} else {
+		congestionWindow += (1.0f / congestionWindow);
+	}
+
+	congestionWindow = std::min(congestionWindow, maxCongestionWindow);
+}
+
+void UDPConnection::ShrinkCongestionWindow()
+{
+	// connections set up for lossy links back off less per loss
+	constexpr float backoffFactors[] = {0.5f, 0.7f, 0.85f};
+
+	const spring_time curTime = spring_gettime();
+
+	if (!congestionControl)
+		return;
+	// the other end repeats its naks until a gap is filled, react once per round-trip
+	if ((curTime - lastWindowShrinkTime) < GetResendTimeout())
+		return;
+
+	slowStartThreshold = std::max(congestionWindow * backoffFactors[std::min(netLossFactor, int(MAX_LOSS_FACTOR))], minCongestionWindow);
+	congestionWindow = slowStartThreshold;
+	lastWindowShrinkTime = curTime;
+}
+
+
 void UDPConnection::BandwidthUsage::UpdateTime(unsigned newTime)
 {
 	if (newTime > (lastTime + 100)) {
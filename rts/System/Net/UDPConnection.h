@@ -12,6 +12,7 @@
 #include "System/UnorderedSet.hpp"
 
 class CRC;
+struct z_stream_s;
 
 
 namespace netcode {
@@ -36,6 +37,10 @@ public:
 	std::int32_t chunkNumber;
 	std::uint8_t chunkSize;
 	std::vector<std::uint8_t> data;
+
+	/// local only, for RTT sampling; chunks that were ever resent give ambiguous samples
+	spring_time sendTime;
+	bool resent = false;
 };
 typedef std::shared_ptr<Chunk> ChunkPtr;
 
@@ -152,9 +157,21 @@ private:
 	void RequestResend(ChunkPtr ptr, bool noSort);
 	void SendPacket(Packet& pkt);
 
+	/// the retransmission timeout, derived from the RTT estimate if congestion control is on
+	spring_time GetResendTimeout() const;
+	void UpdateRoundTripTime(spring_time sample);
+	void GrowCongestionWindow();
+	void ShrinkCongestionWindow();
+	bool CongestionWindowOpen() const { return (!congestionControl || unackedChunks.size() < congestionWindow); }
+
 	void UpdateWaitingPackets();
 	void UpdateResendRequests();
 
+	/// chunk our queued outgoing data as compressed stream segments
+	void FlushCompressed(bool forced);
+	/// append the plain data of the segments completed by <data> to waitBuffer
+	void ReadSegments(const std::uint8_t* data, unsigned length);
+
 private:
 	spring_time lastChunkCreatedTime;
 	spring_time lastPacketSendTime;
@@ -179,12 +196,15 @@ private:
 	bool resend;
 	bool sharedSocket;
 	bool logMessages;
+	bool congestionControl;
 
 	int netLossFactor;
 	int reconnectTime;
 
 	/// outgoing stuff (pure data without header) waiting to be sent
 	std::deque< std::shared_ptr<const RawPacket> > outgoingData;
+	/// bytes of the front of outgoingData already put into chunks
+	unsigned int outgoingDataPos = 0;
 	/// packets we have received but not yet read
 	std::vector< std::pair<int, RawPacket> > waitingPackets;
 	spring::unordered_set<int> incomingChunkNums;
@@ -224,6 +244,20 @@ private:
 
 	RawPacket fragmentBuffer;
 
+	struct DeflateDeleter { void operator () (z_stream_s* s) const; };
+	struct InflateDeleter { void operator () (z_stream_s* s) const; };
+
+	/// set if NetworkCompression is on; every chunk after the first is part of the compressed stream
+	std::unique_ptr<z_stream_s, DeflateDeleter> deflateStream;
+	/// set once the other end announced a compressed stream in its first chunk
+	std::unique_ptr<z_stream_s, InflateDeleter> inflateStream;
+
+	/// outgoing stream segments not yet cut into chunks, incoming ones not yet complete
+	std::vector<std::uint8_t> segmentOutBuffer;
+	std::vector<std::uint8_t> segmentInBuffer;
+	std::vector<std::uint8_t> plainBuffer;
+	std::vector<std::uint8_t> deflateBuffer;
+
 	// Traffic statistics and stuff
 	#ifdef ENABLE_DEBUG_STATS
 	float sumDeltaFramePacketRecvTime;
@@ -242,6 +276,8 @@ private:
 	unsigned int droppedChunks;
 
 	unsigned int sentOverhead, recvOverhead;
+	/// stream bytes before and after compression
+	unsigned int sentPlain, sentCompressed;
 	unsigned int sentPackets, recvPackets;
 
 	class BandwidthUsage {
@@ -261,6 +297,21 @@ private:
 	};
 
 	BandwidthUsage outgoing;
+
+	/// smoothed round-trip time and its mean deviation in milliseconds, 0 until the first sample
+	float smoothedRTT;
+	float varianceRTT;
+
+	/// maximum number of unacked chunks in flight, and the slow-start threshold
+	float congestionWindow;
+	float slowStartThreshold;
+	/// bytes we may still send now, refilled at the estimated window rate
+	float pacingBudget;
+
+	spring_time lastPacingTime;
+	spring_time lastWindowShrinkTime;
+
+	unsigned int lostChunks;
 };
 
 } // namespace netcode
@@ -16,6 +16,7 @@
 #include "ProtocolDef.h"
 #include "UDPConnection.h"
 #include "Socket.h"
+#include "System/GlobalConfig.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/errorhandler.h"
 #include "System/StringUtil.h" // for IntToString (header only)
@@ -36,10 +37,16 @@ UDPListener::UDPListener(int port, const std::string& ip): acceptNewConnections(
 	socket->non_blocking(true);
 	SetAcceptingConnections(true);
 
-	LOG("[%s] successfully bound socket on port %i", __func__, socket->local_endpoint().port());
+	if ((numUpdateThreads = globalConfig.networkUpdateThreads) > 0)
+		updatePool.reset(new asio::thread_pool(numUpdateThreads));
+
+	LOG("[%s] successfully bound socket on port %i (%d update-threads)", __func__, socket->local_endpoint().port(), numUpdateThreads);
 }
 
 UDPListener::~UDPListener() {
+	// joins the threads; no flush can be in progress
+	updatePool.reset();
+
 	for (const auto& p: dropMap) {
 		LOG("[%s] dropped %lu packets from unknown IP %s", __func__, (unsigned long) p.second, (p.first).c_str());
 	}
@@ -180,9 +187,54 @@ void UDPListener::Update() {
 			i = connMap.erase(i);
 			continue;
 		}
-		i->second.lock()->Update();
+		updateConns.push_back(i->second.lock());
 		++i;
 	}
+
+	// a handful of connections is not worth the hand-off
+	if (updatePool != nullptr && updateConns.size() > 4) {
+		UpdateConnectionsParallel();
+	} else {
+		for (const auto& conn: updateConns) {
+			conn->Update();
+		}
+	}
+
+	updateConns.clear();
+}
+
+void UDPListener::UpdateConnectionsParallel()
+{
+	nextUpdateConn.store(0);
+
+	{
+		std::lock_guard<std::mutex> lock(updateMutex);
+		numPendingUpdates = numUpdateThreads;
+	}
+
+	for (int i = 0; i < numUpdateThreads; i++) {
+		asio::post(*updatePool, [this]() {
+			UpdateConnectionRange();
+
+			std::lock_guard<std::mutex> lock(updateMutex);
+
+			if ((numPendingUpdates -= 1) == 0)
+				updateCond.notify_one();
+		});
+	}
+
+	UpdateConnectionRange();
+
+	std::unique_lock<std::mutex> lock(updateMutex);
+	updateCond.wait(lock, [this]() { return (numPendingUpdates == 0); });
+}
+
+void UDPListener::UpdateConnectionRange()
+{
+	// connections are pulled one at a time so a slow one only holds up its own thread
+	for (size_t i = nextUpdateConn.fetch_add(1); i < updateConns.size(); i = nextUpdateConn.fetch_add(1)) {
+		updateConns[i]->Update();
+	}
 }
 
 
@@ -4,11 +4,20 @@
 #define _UDP_LISTENER_H
 
 #include "System/Misc/NonCopyable.h"
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <asio/ip/udp.hpp>
 #include <map>
 #include <queue>
 #include <string>
+#include <vector>
+
+namespace asio
+{
+class thread_pool;
+}
 
 namespace netcode
 {
@@ -75,6 +84,10 @@ public:
 	void RejectConnection() { waiting.pop(); }
 	void UpdateConnections(); // Updates connections when the endpoint has been reconnected
 
+private:
+	void UpdateConnectionsParallel();
+	void UpdateConnectionRange();
+
 private:
 	/**
 	 * @brief Do we accept packets from unknown sources?
@@ -92,6 +105,22 @@ private:
 	std::map< std::string, size_t> dropMap;
 
 	std::queue< std::shared_ptr<UDPConnection> > waiting;
+
+	/**
+	 * Per-Update snapshot of the live connections, flushed in parallel by
+	 * updatePool (if NetworkUpdateThreads > 0) and the calling thread. Each
+	 * connection owns its outgoing queue and is only touched by one thread
+	 * at a time; nothing else accesses them until the flush has finished.
+	 */
+	std::vector< std::shared_ptr<UDPConnection> > updateConns;
+	std::unique_ptr<asio::thread_pool> updatePool;
+
+	std::atomic<size_t> nextUpdateConn = {0};
+
+	std::mutex updateMutex;
+	std::condition_variable updateCond;
+	int numPendingUpdates = 0;
+	int numUpdateThreads = 0;
 };
 
 }
@@ -9,9 +9,12 @@
 	#include "System/Sync/FPUCheck.h"
 #endif
 
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <vector>
 #include <cinttypes>
+#include <cstdio>
 #if defined(__APPLE__) || defined(__FreeBSD__)
 #elif defined(_WIN32)
 	#include <windows.h>
@@ -20,6 +23,9 @@
 		#include <sys/prctl.h>
 	#endif
 	#include <sched.h>
+	#include <sys/resource.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
 #endif
 
 #ifndef _WIN32
@@ -206,6 +212,76 @@ namespace Threading {
 
 	bool HasHyperThreading() { return (GetLogicalCpuCores() > GetPhysicalCpuCores()); }
 
+	std::uint32_t GetCoreSiblingsMask(std::uint32_t coreMask)
+	{
+	#if defined(__APPLE__) || defined(__FreeBSD__)
+		// no-op
+		return coreMask;
+
+	#elif defined(_WIN32)
+		std::uint32_t siblingsMask = coreMask;
+
+		DWORD bufferSize = 0;
+		GetLogicalProcessorInformation(nullptr, &bufferSize);
+
+		std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infos(bufferSize / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+
+		if (infos.empty() || !GetLogicalProcessorInformation(infos.data(), &bufferSize))
+			return siblingsMask;
+
+		for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& info: infos) {
+			if (info.Relationship != RelationProcessorCore)
+				continue;
+			if ((static_cast<std::uint32_t>(info.ProcessorMask) & coreMask) == 0)
+				continue;
+
+			siblingsMask |= static_cast<std::uint32_t>(info.ProcessorMask);
+		}
+
+		return siblingsMask;
+	#else
+		std::uint32_t siblingsMask = coreMask;
+
+		for (int n = 0; n < 32; n++) {
+			if ((coreMask & (1u << n)) == 0)
+				continue;
+
+			char path[128];
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", n);
+
+			FILE* f = fopen(path, "r");
+
+			if (f == nullptr)
+				continue;
+
+			// comma-separated list of cores or core ranges, e.g. "0,8" or "0-1"
+			for (int first = 0, last = 0; fscanf(f, "%d", &first) == 1; ) {
+				int sep = fgetc(f);
+
+				last = first;
+
+				if (sep == '-') {
+					if (fscanf(f, "%d", &last) != 1)
+						break;
+
+					sep = fgetc(f);
+				}
+
+				for (int k = std::max(first, 0); k <= std::min(last, 31); k++) {
+					siblingsMask |= (1u << k);
+				}
+
+				if (sep != ',')
+					break;
+			}
+
+			fclose(f);
+		}
+
+		return siblingsMask;
+	#endif
+	}
+
 
 	void SetThreadScheduler()
 	{
@@ -233,6 +309,21 @@ namespace Threading {
 	#endif
 	}
 
+	void SetThreadBackgroundPriority()
+	{
+	#if defined(__APPLE__) || defined(__FreeBSD__)
+		// no-op
+
+	#elif defined(_WIN32)
+		::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+
+	#else
+		// Linux applies nice-values per thread (the POSIX process-wide
+		// semantics are not implemented), so this only affects the caller
+		setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+	#endif
+	}
+
 
 	NativeThreadHandle GetCurrentThread()
 	{
@@ -123,11 +123,21 @@ namespace Threading {
 	int GetPhysicalCpuCores(); /// physical cores only (excluding hyperthreading)
 	int GetLogicalCpuCores();  /// physical + hyperthreading
 	bool HasHyperThreading();
+	/**
+	 * returns the mask of all logical cores that share a physical core
+	 * with any of those in <coreMask> (including the cores themselves)
+	 */
+	std::uint32_t GetCoreSiblingsMask(std::uint32_t coreMask);
 
 	/**
 	 * Inform the OS kernel that we are a cpu-intensive task
 	 */
 	void SetThreadScheduler();
+	/**
+	 * Lowers the OS priority of the calling thread, for background work
+	 * that should not compete with the main- and sim-critical threads
+	 */
+	void SetThreadBackgroundPriority();
 
 	/**
 	 * Used to detect the main-thread which runs SDL, GL, Input, Sim, ...
@@ -5,6 +5,7 @@
 
 #include "System/float3.h"
 
+#include <atomic>
 #include <string>
 
 struct GuiSoundSet;
@@ -68,8 +69,15 @@ public:
 
 protected:
 	virtual void FindSourceAndPlay(size_t id, const float3& p, const float3& velocity, float volume, bool relative) = 0;
+	/// second half of FindSourceAndPlay, run by the sound thread for each queued request
+	virtual void PlayQueuedSample(size_t id, const float3& p, const float3& velocity, float volume, bool relative) {}
 	virtual void SoundSourceFinished(CSoundSource* sndSource) = 0;
 
+	/// whether one of our virtual voices may start on sndSource, which stops what it plays
+	virtual bool CanPlayVirtualVoice(const CSoundSource* sndSource) const { return false; }
+	virtual void SoundSourceStarted(CSoundSource* sndSource) {}
+
+	friend class CSound;
 	friend class CSoundSource;
 
 public:
@@ -78,7 +86,7 @@ public:
 
 protected:
 	unsigned emitsPerFrame;
-	unsigned emitsThisFrame;
+	std::atomic<unsigned> emitsThisFrame;
 	unsigned maxConcurrentSources;
 };
 
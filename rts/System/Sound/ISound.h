@@ -8,6 +8,7 @@
 class float3;
 class LuaParser;
 class CSoundSource;
+class IAudioChannel;
 class SoundItem;
 
 
@@ -41,6 +42,17 @@ public:
 	 * the one with the lowest priority otherwise.
 	 */
 	virtual CSoundSource* GetNextBestSource(bool lock = true) = 0;
+	/**
+	 * Keeps a play request for which no source was free, it gets one
+	 * later if it is still running and among the most audible sounds.
+	 */
+	virtual void AddVirtualVoice(IAudioChannel* channel, size_t id, const float3& pos, const float3& velocity, float volume, bool relative) {}
+	/**
+	 * Hands a play request to the sound thread without taking the sound
+	 * lock, it is passed to IAudioChannel::PlayQueuedSample on its next
+	 * Update. Safe to call from any thread.
+	 */
+	virtual void QueuePlayRequest(IAudioChannel* channel, size_t id, const float3& pos, const float3& velocity, float volume, bool relative) {}
 
 
 	virtual void UpdateListener(const float3& camPos, const float3& camDir, const float3& camUp) = 0;
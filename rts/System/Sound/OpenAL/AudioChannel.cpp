@@ -60,14 +60,31 @@ void AudioChannel::SoundSourceFinished(CSoundSource* sndSource)
 	curSources.erase(sndSource);
 }
 
+bool AudioChannel::CanPlayVirtualVoice(const CSoundSource* sndSource) const
+{
+	if (!enabled)
+		return false;
+
+	// a source of ours that is taken over does not count against the limit
+	const size_t numSources = curSources.size() - curSources.count(const_cast<CSoundSource*>(sndSource));
+
+	return (numSources < maxConcurrentSources);
+}
+
 
 void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3& velocity, float volume, bool relative)
 {
-	if (id == 0 || volume <= 0.0f)
+	if (id == 0 || volume <= 0.0f || !enabled)
 		return;
 
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	// called from the sim and Lua for every shot and explosion; everything
+	// past here needs the sound lock, so leave it to the sound thread
+	sound->QueuePlayRequest(this, id, pos, velocity, volume, relative);
+}
 
+void AudioChannel::PlayQueuedSample(size_t id, const float3& pos, const float3& velocity, float volume, bool relative)
+{
+	// sound thread, soundMutex is held by CSound::Update
 	if (!enabled)
 		return;
 
@@ -117,12 +134,12 @@ void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3&
 	// find a sound source to play the item in
 	CSoundSource* sndSource = sound->GetNextBestSource();
 
-	if (sndSource == nullptr || (sndSource->GetCurrentPriority() >= sndItem->GetPriority())) {
-		LOG_L(L_DEBUG, "[AudioChannel::%s] no source found for sound-item %s", __func__, (sndItem->Name()).c_str());
+	if (sndSource == nullptr || sndSource->IsPlaying()) {
+		// all busy; rather than cutting off whichever has the lowest priority, let
+		// the sound thread decide which of the running sounds are most audible
+		sound->AddVirtualVoice(this, id, pos, velocity, volume, relative);
 		return;
 	}
-	if (sndSource->IsPlaying())
-		sound->numAbortedPlays++;
 
 	// play the sound item
 	sndSource->PlayAsync(this, id, pos, velocity, volume, sndItem->GetPriority(), relative);
@@ -51,8 +51,12 @@ public:
 
 protected:
 	void FindSourceAndPlay(size_t id, const float3& pos, const float3& velocity, float volume, bool relative) override;
+	void PlayQueuedSample(size_t id, const float3& pos, const float3& velocity, float volume, bool relative) override;
 	void SoundSourceFinished(CSoundSource* sndSource) override;
 
+	bool CanPlayVirtualVoice(const CSoundSource* sndSource) const override;
+	void SoundSourceStarted(CSoundSource* sndSource) override { curSources.insert(sndSource); }
+
 private:
 	spring::unsynced_set<CSoundSource*> curSources;
 	std::deque<StreamQueueItem> streamQueue;
@@ -16,6 +16,7 @@
 // #include <alext.h>
 #endif
 
+#include <algorithm>
 #include <climits>
 #include <cinttypes>
 #include <functional>
@@ -41,12 +42,76 @@
 #include "System/Platform/Threading.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
 
 #include "System/float3.h"
 
 
 spring::recursive_mutex soundMutex;
 
+// bounds on the play requests kept without a source, and on how many of
+// them can get one per Update; together they bound the cost of an Update
+static constexpr size_t MAX_VIRTUAL_VOICES = 512;
+static constexpr size_t MAX_VIRTUAL_VOICE_BINDS = 8;
+
+// a sound is only cut off for one of equal priority that is this much
+// more audible, so two similar sounds do not keep replacing each other
+static constexpr float VIRTUAL_VOICE_STEAL_FACTOR = 2.0f;
+
+// bound on the play requests waiting for the sound thread, a stalled
+// Update (e.g. while loading) must not let them pile up without limit
+static constexpr size_t MAX_QUEUED_PLAY_REQUESTS = 4096;
+
+// set on listenerMiddleIdx when it holds a snapshot not yet read
+static constexpr int LISTENER_STATE_DIRTY = 4;
+
+
+static bool DecodeSoundFile(const std::string& path, std::vector<std::uint8_t>& fileBuffer, SoundBuffer::DecodedData& data)
+{
+	CFileHandler file("", "");
+
+	fileBuffer.clear();
+	fileBuffer.reserve(1024 * 1024);
+
+	file.GetBuffer() = std::move(fileBuffer);
+	file.Open(path, SPRING_VFS_RAW_FIRST);
+
+	// steal back
+	fileBuffer = std::move(file.GetBuffer());
+
+	if (!file.FileExists()) {
+		LOG_L(L_ERROR, "[%s] unable to open audio file \"%s\"", __func__, path.c_str());
+		return false;
+	}
+
+	if (fileBuffer.empty()) {
+		// copy file into buffer manually if not in VFS
+		fileBuffer.resize(file.FileSize());
+		file.Read(fileBuffer.data(), fileBuffer.size());
+	}
+
+	const std::string& soundExt = file.GetFileExt();
+
+	switch (soundExt[0]) {
+		case 'w': { return (SoundBuffer::DecodeWAV   (path, fileBuffer, data)); } break; // wav
+		case 'o': { return (SoundBuffer::DecodeVorbis(path, fileBuffer, data)); } break; // ogg
+		default : {
+			LOG_L(L_WARNING, "[%s] unknown audio format \"%s\"", __func__, soundExt.c_str());
+		} break;
+	}
+
+	return false;
+}
+
+
+static bool IsLessAudible(const CSoundSource::VirtualVoice& a, const CSoundSource::VirtualVoice& b)
+{
+	if (a.priority != b.priority)
+		return (a.priority < b.priority);
+
+	return (a.audibility < b.audibility);
+}
+
 
 CSound::CSound()
 {
@@ -76,7 +141,11 @@ void CSound::Init()
 		mute = false;
 		appIsIconified = false;
 
-		updateListener = false;
+		listenerBackIdx = 0;
+		listenerFrontIdx = 1;
+		listenerMiddleIdx = 2;
+		listenerStates.fill({ZeroVector, FwdVector, UpVector});
+
 		soundThreadQuit = false;
 		canLoadDefs = false;
 	}
@@ -165,12 +234,14 @@ bool CSound::HasSoundItem(const std::string& name) const
 
 bool CSound::PreloadSoundItem(const std::string& name)
 {
-	#if 0
-	ThreadPool::Enqueue([name]() { sound->GetSoundId(name); });
-	#else
 	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
-	return ((preloadSet.insert(name)).second);
-	#endif
+
+	if (!(preloadSet.insert(name)).second)
+		return false;
+
+	// decode the file in the background, the sound thread then only has to upload it
+	PreloadSoundFile(GetSoundFileName(name));
+	return true;
 }
 
 
@@ -259,6 +330,127 @@ CSoundSource* CSound::GetNextBestSource(bool lock)
 	return bestSrc;
 }
 
+void CSound::AddVirtualVoice(IAudioChannel* channel, size_t id, const float3& pos, const float3& velocity, float volume, bool relative)
+{
+	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+
+	const SoundItem* item = GetSoundItem(id);
+
+	if (item == nullptr)
+		return;
+
+	const CSoundSource::VirtualVoice voice = CSoundSource::MakeVirtualVoice(channel, item, pos, velocity, volume, relative);
+
+	if (virtualVoices.size() < MAX_VIRTUAL_VOICES) {
+		virtualVoices.push_back(voice);
+		return;
+	}
+
+	// full, the least audible request is dropped
+	const auto iter = std::min_element(virtualVoices.begin(), virtualVoices.end(), IsLessAudible);
+
+	if (IsLessAudible(*iter, voice))
+		*iter = voice;
+
+	numAbortedPlays++;
+}
+
+void CSound::QueuePlayRequest(IAudioChannel* channel, size_t id, const float3& pos, const float3& velocity, float volume, bool relative)
+{
+	if (playRequests.size_approx() >= MAX_QUEUED_PLAY_REQUESTS)
+		return;
+
+	playRequests.enqueue({channel, id, pos, velocity, volume, relative});
+}
+
+void CSound::UpdatePlayRequests()
+{
+	PlayRequest req;
+
+	while (playRequests.try_dequeue(req)) {
+		req.channel->PlayQueuedSample(req.id, req.position, req.velocity, req.volume, req.relative);
+	}
+}
+
+void CSound::UpdateVirtualVoices()
+{
+	if (virtualVoices.empty())
+		return;
+
+	const spring_time curTime = spring_gettime();
+
+	// drop requests that would have ended by now or got a source
+	const auto isDone = [&](const CSoundSource::VirtualVoice& v) { return (v.endTime <= curTime || !v.channel->IsEnabled()); };
+	const auto isMoreAudible = [](const CSoundSource::VirtualVoice& a, const CSoundSource::VirtualVoice& b) { return (IsLessAudible(b, a)); };
+
+	virtualVoices.erase(std::remove_if(virtualVoices.begin(), virtualVoices.end(), isDone), virtualVoices.end());
+
+	// the listener and the channel volumes may have changed
+	for (CSoundSource::VirtualVoice& voice: virtualVoices) {
+		voice.audibility = CSoundSource::GetAudibility(voice);
+	}
+
+	const size_t numBinds = std::min(virtualVoices.size(), MAX_VIRTUAL_VOICE_BINDS);
+
+	std::partial_sort(virtualVoices.begin(), virtualVoices.begin() + numBinds, virtualVoices.end(), isMoreAudible);
+
+	for (size_t i = 0; i < numBinds; i++) {
+		// copied, sounds cut off below are appended
+		const CSoundSource::VirtualVoice voice = virtualVoices[i];
+
+		CSoundSource* bestSrc = nullptr;
+		CSoundSource::VirtualVoice bestSrcVoice;
+		CSoundSource::VirtualVoice srcVoice;
+
+		// a free source, otherwise the one playing the least audible sound
+		for (CSoundSource& src: soundSources) {
+			if (!src.IsPlaying(false)) {
+				bestSrc = &src;
+				bestSrcVoice = {};
+				break;
+			}
+
+			if (!src.GetVirtualVoice(srcVoice))
+				continue;
+			if (bestSrc != nullptr && !IsLessAudible(srcVoice, bestSrcVoice))
+				continue;
+
+			bestSrc = &src;
+			bestSrcVoice = srcVoice;
+		}
+
+		if (bestSrc == nullptr)
+			break;
+
+		if (bestSrcVoice.id != 0) {
+			const bool lowerPriority = (bestSrcVoice.priority < voice.priority);
+			const bool lessAudible = (bestSrcVoice.priority == voice.priority && (bestSrcVoice.audibility * VIRTUAL_VOICE_STEAL_FACTOR) < voice.audibility);
+
+			// the remaining requests are even less audible
+			if (!lowerPriority && !lessAudible)
+				break;
+		}
+
+		if (!voice.channel->CanPlayVirtualVoice(bestSrc))
+			continue;
+
+		if (bestSrcVoice.id != 0) {
+			// the cut off sound becomes virtual in turn, and may get a source back later
+			virtualVoices.push_back(bestSrcVoice);
+			bestSrc->Stop();
+		}
+
+		voice.channel->SoundSourceStarted(bestSrc);
+
+		if (!bestSrc->PlayVirtual(voice))
+			voice.channel->SoundSourceFinished(bestSrc);
+
+		virtualVoices[i].endTime = spring_notime;
+	}
+
+	virtualVoices.erase(std::remove_if(virtualVoices.begin(), virtualVoices.end(), isDone), virtualVoices.end());
+}
+
 void CSound::PitchAdjust(const float newPitch)
 {
 	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
@@ -699,7 +891,13 @@ void CSound::UpdateThread(int cfgMaxSounds)
 
 		LOG("[Sound::%s][3] #sources=%u #items=%u", __func__, uint32_t(soundSources.size()), uint32_t(soundItems.size()));
 
+		// preload tasks reference us
+		WaitForPreloadedSoundFiles();
+
 		// destruct items before context cleanup
+		for (PlayRequest req; playRequests.try_dequeue(req); ) {}
+
+		virtualVoices.clear();
 		soundSources.clear();
 		soundItems.clear();
 
@@ -721,18 +919,36 @@ void CSound::Update()
 {
 	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
 
-	// limit consumption-rate to prevent source starvation
-	// lock is held, size can not be changed except by loop
-	for (size_t i = 0, n = std::min(size_t(4), preloadSet.size()); i < n; i++) {
-		GetSoundId(*preloadSet.begin());
+	{
+		std::vector<std::string> preloadNames;
+
+		// limit consumption-rate to prevent source starvation, and skip
+		// items whose file is still being decoded so this never blocks
+		for (const std::string& name: preloadSet) {
+			if (preloadNames.size() >= 4)
+				break;
+			if (IsPreloadingSoundFile(GetSoundFileName(name)))
+				continue;
+
+			preloadNames.push_back(name);
+		}
+
+		for (const std::string& name: preloadNames) {
+			GetSoundId(name);
+		}
 	}
 
+	// apply the listener first, the queued requests are culled against it
+	UpdateListenerReal();
+	UpdatePlayRequests();
+
 	for (CSoundSource& source: soundSources) {
 		source.Update();
 	}
 
+	UpdateVirtualVoices();
+
 	CheckError("[Sound::Update]");
-	UpdateListenerReal();
 }
 
 size_t CSound::MakeItemFromDef(const SoundItemNameMap& itemDef)
@@ -757,14 +973,24 @@ size_t CSound::MakeItemFromDef(const SoundItemNameMap& itemDef)
 }
 
 
+void CSound::UpdateListener(const float3& campos, const float3& camdir, const float3& camup)
+{
+	listenerStates[listenerBackIdx] = {campos, camdir, camup};
+
+	// publish the snapshot, UpdateListenerReal picks it up on the next Update
+	listenerBackIdx = listenerMiddleIdx.exchange(listenerBackIdx | LISTENER_STATE_DIRTY) & ~LISTENER_STATE_DIRTY;
+}
+
 void CSound::UpdateListenerReal()
 {
 	// call from sound thread, cause OpenAL calls tend to cause L2 misses and so are slow (no reason to call them from mainthread)
-	if (!updateListener)
+	if ((listenerMiddleIdx.load() & LISTENER_STATE_DIRTY) == 0)
 		return;
 
-	updateListener = false;
+	listenerFrontIdx = listenerMiddleIdx.exchange(listenerFrontIdx) & ~LISTENER_STATE_DIRTY;
 
+	const ListenerState& state = listenerStates[listenerFrontIdx];
+	const float3& myPos = state.pos;
 	const float3 myPosInMeters = myPos * ELMOS_TO_METERS;
 	alListener3f(AL_POSITION, myPosInMeters.x, myPosInMeters.y, myPosInMeters.z);
 
@@ -793,7 +1019,7 @@ void CSound::UpdateListenerReal()
 	alListener3f(AL_VELOCITY, velocityAvg.x, velocityAvg.y, velocityAvg.z);
 	*/
 
-	ALfloat ListenerOri[] = {camDir.x, camDir.y, camDir.z, camUp.x, camUp.y, camUp.z};
+	ALfloat ListenerOri[] = {state.dir.x, state.dir.y, state.dir.z, state.up.x, state.up.y, state.up.z};
 	alListenerfv(AL_ORIENTATION, ListenerOri);
 	CheckError("[Sound::UpdateListener]");
 }
@@ -811,6 +1037,36 @@ void CSound::PrintDebugInfo()
 	LOG_L(L_DEBUG, "# PlayRequests for empty sound: %i", numEmptyPlayRequests);
 	LOG_L(L_DEBUG, "# Samples disrupted: %i", numAbortedPlays);
 	LOG_L(L_DEBUG, "# SoundItems: %i", (int)soundItems.size());
+
+	{
+		std::lock_guard<spring::mutex> lck(preloadMutex);
+		LOG_L(L_DEBUG, "# preloading / preloaded files: %i / %i", (int)preloadingFiles.size(), (int)preloadedFiles.size());
+	}
+
+	std::vector<std::pair<int, size_t>> itemSizes;
+	itemSizes.reserve(soundItems.size());
+
+	// [0] is the dummy item
+	for (size_t i = 1; i < soundItems.size(); i++) {
+		const SoundBuffer& buffer = SoundBuffer::GetById(soundItems[i].GetSoundBufferID());
+
+		if (buffer.GetId() == 0)
+			continue;
+
+		itemSizes.emplace_back(buffer.BufferSize(), i);
+	}
+
+	std::sort(itemSizes.begin(), itemSizes.end(), [](const std::pair<int, size_t>& a, const std::pair<int, size_t>& b) { return (a.first > b.first); });
+
+	// items sharing a file also share its buffer
+	LOG_L(L_DEBUG, "# buffer memory per SoundItem:");
+
+	for (const auto& p: itemSizes) {
+		const SoundItem& item = soundItems[p.second];
+		const SoundBuffer& buffer = SoundBuffer::GetById(item.GetSoundBufferID());
+
+		LOG_L(L_DEBUG, "  %6i kB %5.2fs %s (%s)", p.first / 1024, buffer.GetLength(), item.Name().c_str(), buffer.GetFilename().c_str());
+	}
 }
 
 bool CSound::LoadSoundDefsImpl(LuaParser* defsParser)
@@ -904,50 +1160,105 @@ size_t CSound::LoadSoundBuffer(const std::string& path)
 	if (failureSet.find(path) != failureSet.end())
 		return 0;
 
-	CFileHandler file("", "");
+	SoundBuffer::DecodedData soundData;
 
-	loadBuffer.clear();
-	loadBuffer.reserve(1024 * 1024);
+	// if a preload task is still decoding this file, decoding it again is faster than waiting
+	if (!TakePreloadedSoundFile(path, soundData))
+		DecodeSoundFile(path, loadBuffer, soundData);
 
-	file.GetBuffer() = std::move(loadBuffer);
-	file.Open(path, SPRING_VFS_RAW_FIRST);
+	SoundBuffer soundBuf;
+	soundBuf.Load(path, soundData);
 
-	// steal back
-	loadBuffer = std::move(file.GetBuffer());
+	CheckError("[Sound::LoadSoundBuffer]");
 
-	if (!file.FileExists()) {
-		LOG_L(L_ERROR, "[%s] unable to open audio file \"%s\"", __func__, path.c_str());
+	if (soundBuf.GetLength() <= 0.0f) {
+		LOG_L(L_WARNING, "[%s] failed to load file \"%s\"", __func__, path.c_str());
 		failureSet.insert(path);
 		return 0;
 	}
 
-	if (loadBuffer.empty()) {
-		// copy file into buffer manually if not in VFS
-		loadBuffer.resize(file.FileSize());
-		file.Read(loadBuffer.data(), loadBuffer.size());
-	}
+	return (SoundBuffer::Insert(std::move(soundBuf)));
+}
 
 
-	SoundBuffer soundBuf;
-	const std::string& soundExt = file.GetFileExt();
+std::string CSound::GetSoundFileName(const std::string& name) const
+{
+	const auto itemDefIt = soundItemDefsMap.find(StringToLower(name));
 
-	switch (soundExt[0]) {
-		case 'w': { soundBuf.LoadWAV   (path, loadBuffer); } break; // wav
-		case 'o': { soundBuf.LoadVorbis(path, loadBuffer); } break; // ogg
-		default : {
-			LOG_L(L_WARNING, "[%s] unknown audio format \"%s\"", __func__, soundExt.c_str());
-		} break;
+	if (itemDefIt == soundItemDefsMap.end())
+		return name;
+
+	const auto fileIt = itemDefIt->second.find("file");
+
+	if (fileIt == itemDefIt->second.end())
+		return name;
+
+	return fileIt->second;
+}
+
+void CSound::PreloadSoundFile(const std::string& path)
+{
+	if (!ThreadPool::HasThreads())
+		return;
+	if (SoundBuffer::GetId(path) > 0 || failureSet.find(path) != failureSet.end())
+		return;
+
+	{
+		std::lock_guard<spring::mutex> lck(preloadMutex);
+
+		if (preloadedFiles.find(path) != preloadedFiles.end())
+			return;
+		if (!(preloadingFiles.insert(path)).second)
+			return;
 	}
 
-	CheckError("[Sound::LoadSoundBuffer]");
+	ThreadPool::Enqueue([this, path]() {
+		std::vector<std::uint8_t> fileBuffer;
+		SoundBuffer::DecodedData soundData;
 
-	if (soundBuf.GetLength() <= 0.0f) {
-		LOG_L(L_WARNING, "[%s] failed to load file \"%s\"", __func__, path.c_str());
-		failureSet.insert(path);
-		return 0;
+		// failures are kept too (with zero length), s.t. they are not decoded and logged twice
+		DecodeSoundFile(path, fileBuffer, soundData);
+
+		std::lock_guard<spring::mutex> lck(preloadMutex);
+		preloadingFiles.erase(path);
+		preloadedFiles.emplace(path, std::move(soundData));
+	});
+}
+
+void CSound::WaitForPreloadedSoundFiles()
+{
+	while (true) {
+		{
+			std::lock_guard<spring::mutex> lck(preloadMutex);
+
+			if (preloadingFiles.empty()) {
+				preloadedFiles.clear();
+				return;
+			}
+		}
+
+		spring::this_thread::sleep_for(std::chrono::milliseconds(1));
 	}
+}
 
-	return (SoundBuffer::Insert(std::move(soundBuf)));
+bool CSound::IsPreloadingSoundFile(const std::string& path)
+{
+	std::lock_guard<spring::mutex> lck(preloadMutex);
+	return (preloadingFiles.find(path) != preloadingFiles.end());
+}
+
+bool CSound::TakePreloadedSoundFile(const std::string& path, SoundBuffer::DecodedData& data)
+{
+	std::lock_guard<spring::mutex> lck(preloadMutex);
+
+	const auto iter = preloadedFiles.find(path);
+
+	if (iter == preloadedFiles.end())
+		return false;
+
+	data = std::move(iter->second);
+	preloadedFiles.erase(iter);
+	return true;
 }
 
 void CSound::NewFrame()
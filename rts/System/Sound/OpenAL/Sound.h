@@ -3,6 +3,7 @@
 #ifndef _SOUND_H_
 #define _SOUND_H_
 
+#include <array>
 #include <atomic>
 #include <string>
 #include <vector>
@@ -15,10 +16,18 @@
 #include "System/UnorderedSet.hpp"
 #include "System/Threading/SpringThreading.h"
 
+#include "SoundBuffer.h"
 #include "SoundItem.h"
+#include "SoundSource.h"
+
+// BranchPrediction.h's macros clash with the queue's functions of the same name
+#ifdef   likely
+#undef   likely
+#undef unlikely
+#endif
+
+#include "System/ConcurrentQueue.h"
 
-class CSoundSource;
-class SoundBuffer;
 class SoundItem;
 
 /// Default sound system implementation (OpenAL)
@@ -38,16 +47,11 @@ public:
 
 	SoundItem* GetSoundItem(size_t id);
 	CSoundSource* GetNextBestSource(bool lock = true) override;
+	void AddVirtualVoice(IAudioChannel* channel, size_t id, const float3& pos, const float3& velocity, float volume, bool relative) override;
+	void QueuePlayRequest(IAudioChannel* channel, size_t id, const float3& pos, const float3& velocity, float volume, bool relative) override;
 
 	void NewFrame() override;
-	void UpdateListener(const float3& campos, const float3& camdir, const float3& camup) override {
-		myPos  = campos;
-		camDir = camdir;
-		camUp  = camup;
-
-		// schedule UpdateListenerReal
-		updateListener = true;
-	}
+	void UpdateListener(const float3& campos, const float3& camdir, const float3& camup) override;
 
 	/// @see ConfigHandler::ConfigNotifyCallback
 	void ConfigNotify(const std::string& key, const std::string& value) override;
@@ -66,7 +70,8 @@ public:
 	bool CanLoadSoundDefs() const override { return canLoadDefs; }
 
 	bool LoadSoundDefsImpl(LuaParser* defsParser);
-	const float3& GetListenerPos() const override { return myPos; }
+	/// the position last applied by the sound thread, only meaningful there
+	const float3& GetListenerPos() const override { return listenerStates[listenerFrontIdx].pos; }
 
 	ALCdevice* GetCurrentDevice() { return curDevice; }
 	int GetFrameSize() const { return frameSize; }
@@ -75,6 +80,21 @@ private:
 	typedef spring::unordered_map<std::string, std::string> SoundItemNameMap;
 	typedef spring::unordered_map<std::string, SoundItemNameMap> SoundItemDefsMap;
 
+	struct PlayRequest {
+		IAudioChannel* channel;
+		size_t id;
+		float3 position;
+		float3 velocity;
+		float volume;
+		bool relative;
+	};
+
+	struct ListenerState {
+		float3 pos;
+		float3 dir;
+		float3 up;
+	};
+
 private:
 	void Cleanup();
 	void OpenOpenALDevice(const std::string& deviceName);
@@ -84,6 +104,8 @@ private:
 	void UpdateThread(int cfgMaxSounds);
 
 	void Update();
+	void UpdatePlayRequests();
+	void UpdateVirtualVoices();
 	void UpdateListenerReal();
 
 	int GetMaxMonoSources(ALCdevice* device, int cfgMaxSounds);
@@ -92,6 +114,13 @@ private:
 	size_t MakeItemFromDef(const SoundItemNameMap& itemDef);
 	size_t LoadSoundBuffer(const std::string& filename);
 
+	std::string GetSoundFileName(const std::string& name) const;
+
+	void PreloadSoundFile(const std::string& path);
+	void WaitForPreloadedSoundFiles();
+	bool IsPreloadingSoundFile(const std::string& path);
+	bool TakePreloadedSoundFile(const std::string& path, SoundBuffer::DecodedData& data);
+
 private:
 	ALCdevice* curDevice = nullptr;
 	ALCcontext* curContext = nullptr;
@@ -105,8 +134,17 @@ private:
 	spring::unordered_set<std::string> preloadSet;
 	spring::unordered_set<std::string> failureSet;
 
+	// files decoded by preload tasks but not yet uploaded, and those still being decoded
+	spring::unordered_map<std::string, SoundBuffer::DecodedData> preloadedFiles;
+	spring::unordered_set<std::string> preloadingFiles;
+	spring::mutex preloadMutex;
+
 	std::vector<SoundItem> soundItems;
 	std::vector<CSoundSource> soundSources; // fixed-size
+	std::vector<CSoundSource::VirtualVoice> virtualVoices; // play requests without a source
+
+	// filled by any thread, drained by the sound thread
+	moodycamel::ConcurrentQueue<PlayRequest> playRequests;
 
 	std::vector<std::uint8_t> loadBuffer;
 
@@ -115,10 +153,17 @@ private:
 
 	float masterVolume = 0.0f;
 
-	/// unscaled
-	float3 myPos;
-	float3 camDir;
-	float3 camUp;
+	// listener snapshots (unscaled) written by UpdateListener and read by
+	// UpdateListenerReal; the writer fills the back slot and swaps it with
+	// the middle one, the reader swaps the middle one with the front slot
+	// if it has been touched since. A third slot is what lets both sides
+	// swap without waiting on each other.
+	std::array<ListenerState, 3> listenerStates;
+
+	int listenerBackIdx = 0;
+	int listenerFrontIdx = 1;
+	std::atomic<int> listenerMiddleIdx = {2};
+
 	float3 prevVelocity;
 
 	int pitchAdjustMode = 0;
@@ -129,7 +174,6 @@ private:
 	/// we do not play if minimized / iconified
 	bool appIsIconified = false;
 
-	std::atomic<bool> updateListener = {false};
 	std::atomic<bool> soundThreadQuit = {false};
 	std::atomic<bool> canLoadDefs = {false};
 };
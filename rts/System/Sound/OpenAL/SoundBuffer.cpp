@@ -43,8 +43,6 @@ int	VorbisClose(void* datasource)
 SoundBuffer::bufferMapT SoundBuffer::bufferMap;
 SoundBuffer::bufferVecT SoundBuffer::buffers;
 
-static std::vector<std::uint8_t> decodeBuffer;
-
 
 #pragma pack(push, 1)
 // Header copied from WavLib by Michael McTernan
@@ -66,7 +64,7 @@ struct WAVHeader
 #pragma pack(pop)
 
 
-bool SoundBuffer::LoadWAV(const std::string& file, const std::vector<std::uint8_t>& buffer)
+bool SoundBuffer::DecodeWAV(const std::string& file, const std::vector<std::uint8_t>& buffer, DecodedData& data)
 {
 	WAVHeader* header = (WAVHeader*)(&buffer[0]);
 
@@ -137,17 +135,16 @@ bool SoundBuffer::LoadWAV(const std::string& file, const std::vector<std::uint8_
 		header->datalen = std::uint32_t(buffer.size() - sizeof(WAVHeader))&(~std::uint32_t((header->BitsPerSample*header->channels)/8 -1));
 	}
 
-	if (!AlGenBuffer(file, format, &buffer[sizeof(WAVHeader)], header->datalen, header->SamplesPerSec))
-		LOG_L(L_WARNING, "[%s(%s)] failed generating buffer", __func__, file.c_str());
-
-	filename = file;
-	channels = header->channels;
-	length   = float(header->datalen) / (header->channels * header->SamplesPerSec * header->BitsPerSample);
+	data.samples.assign(buffer.begin() + sizeof(WAVHeader), buffer.begin() + sizeof(WAVHeader) + header->datalen);
+	data.format   = format;
+	data.channels = header->channels;
+	data.length   = float(header->datalen) / (header->channels * header->SamplesPerSec * (header->BitsPerSample / 8));
+	data.rate     = header->SamplesPerSec;
 
 	return true;
 }
 
-bool SoundBuffer::LoadVorbis(const std::string& file, const std::vector<std::uint8_t>& buffer)
+bool SoundBuffer::DecodeVorbis(const std::string& file, const std::vector<std::uint8_t>& buffer, DecodedData& data)
 {
 	VorbisInputBuffer buf;
 	buf.data = &buffer[0];
@@ -185,6 +182,9 @@ bool SoundBuffer::LoadVorbis(const std::string& file, const std::vector<std::uin
 	int section = 0;
 	long read = 0;
 
+	// not shared between calls, decoding may happen on several threads at once
+	std::vector<std::uint8_t>& decodeBuffer = data.samples;
+
 	decodeBuffer.clear();
 	decodeBuffer.resize(512 * 1024); // 512kb read buffer
 
@@ -210,14 +210,29 @@ bool SoundBuffer::LoadVorbis(const std::string& file, const std::vector<std::uin
 		pos += read;
 	} while (read > 0); // read == 0 indicated EOF, read < 0 is error
 
-	if (!AlGenBuffer(file, format, &decodeBuffer[0], pos, vorbisInfo->rate))
-		LOG_L(L_WARNING, "[%s(%s)] failed generating buffer", __func__, file.c_str());
+	decodeBuffer.resize(pos);
 
 	// for non-seekable streams, ov_time_total returns OV_EINVAL (-131) while
 	// ov_time_tell always[?] returns the decoding time offset relative to EOS
+	data.format   = format;
+	data.channels = vorbisInfo->channels;
+	data.length   = (ov_seekable(&oggStream) == 0)? ov_time_tell(&oggStream): ov_time_total(&oggStream, -1);
+	data.rate     = vorbisInfo->rate;
+	return true;
+}
+
+
+bool SoundBuffer::Load(const std::string& file, const DecodedData& data)
+{
+	if (data.length <= 0.0f)
+		return false;
+
+	if (!AlGenBuffer(file, data.format, data.samples.data(), data.samples.size(), data.rate))
+		LOG_L(L_WARNING, "[%s(%s)] failed generating buffer", __func__, file.c_str());
+
 	filename = file;
-	channels = vorbisInfo->channels;
-	length   = (ov_seekable(&oggStream) == 0)? ov_time_tell(&oggStream): ov_time_total(&oggStream, -1);
+	channels = data.channels;
+	length   = data.length;
 	return true;
 }
 
@@ -21,6 +21,18 @@
  */
 class SoundBuffer : spring::noncopyable
 {
+public:
+	/// PCM samples of a sound-file; decoding does not touch OpenAL and can run on any thread
+	struct DecodedData {
+		std::vector<std::uint8_t> samples;
+
+		ALenum format = 0;
+		ALuint channels = 0;
+		ALfloat length = 0.0f;
+
+		int rate = 0;
+	};
+
 public:
 	/// Construct an "empty" buffer
 	/// can be played, but you won't hear anything
@@ -37,8 +49,11 @@ public:
 		return *this;
 	}
 
-	bool LoadWAV(const std::string& file, const std::vector<std::uint8_t>& buffer);
-	bool LoadVorbis(const std::string& file, const std::vector<std::uint8_t>& buffer);
+	static bool DecodeWAV(const std::string& file, const std::vector<std::uint8_t>& buffer, DecodedData& data);
+	static bool DecodeVorbis(const std::string& file, const std::vector<std::uint8_t>& buffer, DecodedData& data);
+
+	/// uploads decoded samples, must be called from the sound thread
+	bool Load(const std::string& file, const DecodedData& data);
 	bool Release();
 
 	const std::string& GetFilename() const { return filename; }
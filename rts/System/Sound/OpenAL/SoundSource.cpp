@@ -2,7 +2,9 @@
 
 #include "SoundSource.h"
 
+#include <algorithm>
 #include <climits>
+#include <cmath>
 #include <alc.h>
 
 #include "ALShared.h"
@@ -58,7 +60,14 @@ void CSoundSource::Update()
 {
 	if (asyncPlayItem.id != 0) {
 		// Sound::Update() holds mutex, soundItems can not be accessed concurrently
-		Play(asyncPlayItem.channel, sound->GetSoundItem(asyncPlayItem.id), asyncPlayItem.position, asyncPlayItem.velocity, asyncPlayItem.volume, asyncPlayItem.relative);
+		IAudioChannel* channel = asyncPlayItem.channel;
+
+		if (!Play(channel, sound->GetSoundItem(asyncPlayItem.id), asyncPlayItem.position, asyncPlayItem.velocity, asyncPlayItem.volume, asyncPlayItem.relative)) {
+			// FindSourceAndPlay already counted us as one of the channel's sources
+			if (curChannel != channel)
+				channel->SoundSourceFinished(this);
+		}
+
 		asyncPlayItem = AsyncSoundItemData();
 	}
 
@@ -124,6 +133,7 @@ int CSoundSource::GetCurrentPriority() const
 	return (curPlayingItem.priority);
 }
 
+
 bool CSoundSource::IsPlaying(const bool checkOpenAl) const
 {
 	if (curStream.Valid())
@@ -179,20 +189,32 @@ void CSoundSource::Stop()
 	CheckError("CSoundSource::Stop");
 }
 
-void CSoundSource::Play(IAudioChannel* channel, SoundItem* item, float3 pos, float3 velocity, float volume, bool relative)
+bool CSoundSource::Play(IAudioChannel* channel, SoundItem* item, float3 pos, float3 velocity, float volume, bool relative, float offset)
 {
 	assert(!curStream.Valid());
 	assert(channel);
 
-	if (!item->PlayNow())
-		return;
-
 	const SoundBuffer& itemBuffer = SoundBuffer::GetById(item->GetSoundBufferID());
+	const float itemLength = itemBuffer.GetLength();
+
+	// a virtual voice that would have ended by now
+	if (item->loopTime == 0 && offset >= itemLength)
+		return false;
+
+	if (!item->PlayNow())
+		return false;
 
 	Stop();
 
+	const spring_time startTime = spring_gettime() - spring_msecs(int(offset * 1000.0f));
+
 	curVolume = volume;
 	curPlayingItem = {item->soundItemID,  item->loopTime, item->priority,  item->GetGain(), item->rolloff};
+	curPlayingItem.position = pos;
+	curPlayingItem.velocity = velocity;
+	curPlayingItem.relative = (relative || !item->in3D);
+	curPlayingItem.startTime = startTime;
+	curPlayingItem.endTime = startTime + spring_msecs((item->loopTime > 0)? int(item->loopTime): int(itemLength * 1000.0f));
 	curChannel = channel;
 
 	alSourcei(id, AL_BUFFER, itemBuffer.GetId());
@@ -203,7 +225,7 @@ void CSoundSource::Play(IAudioChannel* channel, SoundItem* item, float3 pos, flo
 	alSource3f(id, AL_VELOCITY, velocity.x, velocity.y, velocity.z);
 	alSourcei(id, AL_LOOPING, (item->loopTime > 0) ? AL_TRUE : AL_FALSE);
 
-	loopStop = spring_gettime() + spring_msecs(item->loopTime);
+	loopStop = startTime + spring_msecs(item->loopTime);
 
 	if (relative || !item->in3D) {
 		in3D = false;
@@ -259,12 +281,28 @@ void CSoundSource::Play(IAudioChannel* channel, SoundItem* item, float3 pos, flo
 #endif
 
 	}
+
+	if (offset > 0.0f && itemLength > 0.0f)
+		alSourcef(id, AL_SEC_OFFSET, std::fmod(offset, itemLength));
+
 	alSourcePlay(id);
 
 	if (itemBuffer.GetId() == 0)
 		LOG_L(L_WARNING, "CSoundSource::Play: Empty buffer for item %s (file %s)", item->name.c_str(), itemBuffer.GetFilename().c_str());
 
 	CheckError("CSoundSource::Play");
+	return true;
+}
+
+bool CSoundSource::PlayVirtual(const VirtualVoice& voice)
+{
+	SoundItem* item = sound->GetSoundItem(voice.id);
+
+	if (item == nullptr)
+		return false;
+
+	// continue where the voice would be if it had been audible all along
+	return (Play(voice.channel, item, voice.position, voice.velocity, voice.volume, voice.relative, (spring_gettime() - voice.startTime).toSecsf()));
 }
 
 
@@ -283,6 +321,70 @@ void CSoundSource::PlayAsync(IAudioChannel* channel, size_t id, float3 pos, floa
 }
 
 
+CSoundSource::VirtualVoice CSoundSource::MakeVirtualVoice(IAudioChannel* channel, const SoundItem* item, const float3& pos, const float3& velocity, float volume, bool relative)
+{
+	const SoundBuffer& itemBuffer = SoundBuffer::GetById(item->GetSoundBufferID());
+
+	VirtualVoice voice;
+	voice.channel  = channel;
+	voice.id       = item->soundItemID;
+
+	voice.position = pos;
+	voice.velocity = velocity;
+
+	voice.volume   = volume;
+	voice.gain     = item->gain;
+	voice.rolloff  = item->rolloff;
+	voice.priority = item->priority;
+	voice.relative = (relative || !item->in3D);
+
+	voice.startTime = spring_gettime();
+	voice.endTime   = voice.startTime + spring_msecs((item->loopTime > 0)? int(item->loopTime): int(itemBuffer.GetLength() * 1000.0f));
+
+	voice.audibility = GetAudibility(voice);
+	return voice;
+}
+
+bool CSoundSource::GetVirtualVoice(VirtualVoice& voice) const
+{
+	// streams and pending async items are never turned into virtual voices
+	if (curPlayingItem.id == 0 || curStream.Valid() || asyncPlayItem.id != 0 || curChannel == nullptr)
+		return false;
+
+	voice.channel  = curChannel;
+	voice.id       = curPlayingItem.id;
+
+	voice.position = curPlayingItem.position;
+	voice.velocity = curPlayingItem.velocity;
+
+	voice.volume   = curVolume;
+	voice.gain     = curPlayingItem.rndGain;
+	voice.rolloff  = curPlayingItem.rolloff;
+	voice.priority = curPlayingItem.priority;
+	voice.relative = curPlayingItem.relative;
+
+	voice.startTime = curPlayingItem.startTime;
+	voice.endTime   = curPlayingItem.endTime;
+
+	voice.audibility = GetAudibility(voice);
+	return true;
+}
+
+float CSoundSource::GetAudibility(const VirtualVoice& voice)
+{
+	const float gain = voice.volume * voice.gain * voice.channel->volume;
+
+	if (voice.relative)
+		return gain;
+
+	// same as AL_INVERSE_DISTANCE_CLAMPED, the ratio does not depend on the unit
+	const float dist = std::max(voice.position.distance(sound->GetListenerPos()), REFERENCE_DIST);
+	const float rolloff = ROLLOFF_FACTOR * voice.rolloff * heightRolloffModifier;
+
+	return (gain * REFERENCE_DIST / (REFERENCE_DIST + rolloff * (dist - REFERENCE_DIST)));
+}
+
+
 void CSoundSource::PlayStream(IAudioChannel* channel, const std::string& file, float volume)
 {
 	// stop any current playback
@@ -22,6 +22,33 @@ class SoundItem;
  */
 class CSoundSource
 {
+public:
+	/**
+	 * A play request that currently has no source; the sound system keeps it
+	 * running silently until it ends or is audible enough to get one, and it
+	 * then continues from where it would be by now.
+	 */
+	struct VirtualVoice {
+		IAudioChannel* channel = nullptr;
+
+		size_t id = 0;
+
+		float3 position;
+		float3 velocity;
+
+		float volume = 1.0f;
+		float gain = 1.0f;
+		float rolloff = 1.0f;
+		float audibility = 0.0f;
+
+		int priority = 0;
+
+		bool relative = false;
+
+		spring_time startTime;
+		spring_time endTime;
+	};
+
 public:
 	/// is ready after this
 	CSoundSource();
@@ -43,8 +70,9 @@ public:
 	bool IsPlaying(const bool checkOpenAl = false) const;
 	void Stop();
 
-	/// will stop a currently playing sound, if any
-	void Play(IAudioChannel* channel, SoundItem* item, float3 pos, float3 velocity, float volume, bool relative = false);
+	/// will stop a currently playing sound, if any; offset is in seconds
+	bool Play(IAudioChannel* channel, SoundItem* item, float3 pos, float3 velocity, float volume, bool relative = false, float offset = 0.0f);
+	bool PlayVirtual(const VirtualVoice& voice);
 	void PlayAsync(IAudioChannel* channel, size_t id, float3 pos, float3 velocity, float volume, float priority, bool relative = false);
 	void PlayStream(IAudioChannel* channel, const std::string& stream, float volume);
 	void StreamStop();
@@ -52,6 +80,12 @@ public:
 	float GetStreamTime();
 	float GetStreamPlayTime();
 
+	/// turns the currently playing sound-item into a virtual voice, false if there is none
+	bool GetVirtualVoice(VirtualVoice& voice) const;
+
+	static VirtualVoice MakeVirtualVoice(IAudioChannel* channel, const SoundItem* item, const float3& pos, const float3& velocity, float volume, bool relative);
+	static float GetAudibility(const VirtualVoice& voice);
+
 	static void SetPitch(const float& newPitch) { globalPitch = newPitch; }
 	static void SetHeightRolloffModifer(const float& mod) { heightRolloffModifier = mod; }
 
@@ -79,6 +113,14 @@ private:
 
 		float rndGain;
 		float rolloff;
+
+		float3 position;
+		float3 velocity;
+
+		bool relative;
+
+		spring_time startTime;
+		spring_time endTime;
 	};
 
 private:
@@ -5,6 +5,8 @@
 #include <functional>
 #include <iostream>
 #include <chrono>
+#include <limits>
+#include <sstream>
 
 #include <SDL.h>
 #include <gflags/gflags.h>
@@ -42,6 +44,7 @@
 #include "Game/UI/InfoConsole.h"
 #include "Game/UI/MouseHandler.h"
 #include "Lua/LuaOpenGL.h"
+#include "Lua/LuaUI.h"
 #include "Lua/LuaVFSDownload.h"
 #include "Menu/LuaMenuController.h"
 #include "Menu/SelectMenu.h"
@@ -93,6 +96,7 @@
 #include "System/Platform/Threading.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Sound/ISound.h"
+#include "System/StringUtil.h"
 #include "System/Sync/FPUCheck.h"
 #include "System/Threading/ThreadPool.h"
 
@@ -139,6 +143,8 @@ DEFINE_string   (map,                                      "",    "Specify the m
 DEFINE_string   (menu,                                     "",    "Specify a lua menu archive to be used by spring");
 DEFINE_string   (name,                                     "",    "Set your player name");
 DEFINE_bool     (oldmenu,                                  false, "Start the old menu");
+DEFINE_string_EX(replay_list,        "replay-list",        "",    "Replay each demo listed (one path per line) in the given file to its end without drawing, write its statistics to replays/<demo>.json and quit after the last one");
+DEFINE_string_EX(frame_stats,        "frame-stats",        "",    "Profile the game and write its per-frame sim, draw and Lua times, path requests and timer totals as JSON to the given file when it ends");
 
 
 
@@ -509,6 +515,7 @@ void SpringApp::ParseCmdLine(int argc, char* argv[])
 	}
 
 	CTextureAtlas::SetDebug(FLAGS_textureatlas);
+	CGame::SetFrameStatsFile(FLAGS_frame_stats);
 
 	// if this fails, configHandler remains null
 	// logOutput's init depends on configHandler
@@ -538,6 +545,54 @@ CGameController* SpringApp::LoadDemoFile(const std::string& demoFile)
 }
 
 
+void SpringApp::LoadReplayList(const std::string& listFile)
+{
+	LOG("[%s] Loading replay-list from: %s", __func__, listFile.c_str());
+	CFileHandler fh(listFile, SPRING_VFS_PWD_ALL);
+	if (!fh.FileExists())
+		throw content_error("Replay-list does not exist in given location: " + listFile);
+
+	std::string buf;
+	if (!fh.LoadStringData(buf))
+		throw content_error("Replay-list cannot be read: " + listFile);
+
+	std::istringstream lines(buf);
+
+	for (std::string line; std::getline(lines, line); ) {
+		StringTrimInPlace(line);
+
+		if (!line.empty())
+			replayList.push_back(std::move(line));
+	}
+
+	if (!LoadNextReplay())
+		throw content_error("Replay-list contains no demos: " + listFile);
+}
+
+bool SpringApp::LoadNextReplay()
+{
+	if (replayList.empty())
+		return false;
+
+	const std::string demoFile = std::move(replayList.front());
+	replayList.pop_front();
+
+	LOG("[%s] replaying %s (%u more queued)", __func__, demoFile.c_str(), unsigned(replayList.size()));
+
+	clientSetup.reset(new ClientSetup());
+	clientSetup->myPlayerName = configHandler->GetString("name");
+	// have the server skip to the end of the demo as soon as it starts
+	clientSetup->demoStartFrame = std::numeric_limits<int>::max();
+	clientSetup->SanityCheck();
+
+	// set after ResetState, tells CGame to skip drawing and reload when done
+	gu->batchReplay = true;
+
+	activeController = LoadDemoFile(demoFile);
+	return true;
+}
+
+
 CGameController* SpringApp::RunScript(const std::string& buf)
 {
 	try {
@@ -632,6 +687,11 @@ void SpringApp::Startup()
 
 	luaMenuController = new CLuaMenuController(FLAGS_menu);
 
+	if (!FLAGS_replay_list.empty()) {
+		LoadReplayList(FLAGS_replay_list);
+		return;
+	}
+
 	// no argument (either game is given or show selectmenu)
 	if (inputFile.empty()) {
 		clientSetup->isHost = true;
@@ -773,7 +833,10 @@ void SpringApp::Reload(const std::string script)
 
 	LOG("[SpringApp::%s][12] #script=" _STPF_ "", __func__, script.size());
 
-	if (script.empty()) {
+	if (script.empty() && !FLAGS_replay_list.empty()) {
+		// continue with the next demo, or quit after the last one
+		gu->globalQuit = !LoadNextReplay();
+	} else if (script.empty()) {
 		// if no script, drop back to menu
 		LoadSpringMenu();
 	} else {
@@ -807,8 +870,17 @@ bool SpringApp::Update()
 	swap = (retc && activeController != nullptr && activeController->Draw());
 	#endif
 
+	// LuaUI's threaded Update overlaps only with the swap; it has to finish
+	// before input events and the next sim frame can reach the handle
+	if (luaUI != nullptr)
+		luaUI->StartThreadedUpdate();
+
 	// always swap by default, not doing so can upset some drivers
 	globalRendering->SwapBuffers(swap, false);
+
+	if (luaUI != nullptr)
+		luaUI->FinishThreadedUpdate();
+
 	return retc;
 }
 
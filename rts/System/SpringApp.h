@@ -3,6 +3,7 @@
 #ifndef SPRING_APP
 #define SPRING_APP
 
+#include <deque>
 #include <string>
 #include <memory>
 
@@ -55,9 +56,15 @@ private:
 	CGameController* LoadSaveFile(const std::string& saveName); //!< Starts game from a specified save
 	CGameController* LoadDemoFile(const std::string& demoName); //!< Starts game from a specified demo
 
+	void LoadReplayList(const std::string& listFile); //!< Starts replaying the demos listed in a --replay-list file
+	bool LoadNextReplay();                            //!< Starts the next queued replay-list demo, false if none is left
+
 private:
 	std::string inputFile;
 
+	// demos of the --replay-list that have not been replayed yet
+	std::deque<std::string> replayList;
+
 	// this gets passed along to PreGame (or SelectMenu then PreGame),
 	// and from thereon to GameServer if this client is also the host
 	std::shared_ptr<ClientSetup> clientSetup;
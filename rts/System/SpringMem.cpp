@@ -2,6 +2,9 @@
     #include <malloc.h>
 #else
     #include <cstdlib>
+    #include <cstdint>
+    #include <sys/mman.h>
+    #include <unistd.h>
 #endif
 
 #include "SpringMem.h"
@@ -28,4 +31,26 @@ void spring::FreeAlignedMemory(void* ptr)
         free(ptr);
 #endif
     }
-}
\ No newline at end of file
+}
+void spring::AdviseHugePages(void* ptr, size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // smaller ranges can not contain a single (2MB) huge page
+    constexpr size_t MIN_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    if (ptr == nullptr || size < MIN_HUGE_PAGE_SIZE)
+        return;
+
+    static const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+
+    // madvise wants page-aligned ranges, only advise the pages fully inside
+    const uintptr_t beg = (reinterpret_cast<uintptr_t>(ptr) + pageSize - 1) & ~(pageSize - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + size) & ~(pageSize - 1);
+
+    if (end <= beg)
+        return;
+
+    // purely advisory, failure (e.g. THP disabled) is not an error
+    madvise(reinterpret_cast<void*>(beg), end - beg, MADV_HUGEPAGE);
+#endif
+}
@@ -3,9 +3,23 @@
 #ifndef SPRING_MEM_H
 #define SPRING_MEM_H
 
+#include <cstddef>
+#include <vector>
+
 namespace spring {
 	void* AllocateAlignedMemory(size_t size, size_t alignment);
 	void FreeAlignedMemory(void* ptr);
+
+	// asks the OS to back the whole pages of [ptr, ptr + size) with huge pages
+	// (transparent huge pages on Linux); a no-op for small ranges or elsewhere
+	void AdviseHugePages(void* ptr, size_t size);
+
+	// for large per-map arrays, to be called before they are first written so
+	// the advice applies when the pages are faulted in rather than afterwards
+	template<typename T> void ReserveHugePages(std::vector<T>& v, size_t n) {
+		v.reserve(n);
+		AdviseHugePages(v.data(), v.capacity() * sizeof(T));
+	}
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,9 +1,14 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <string>
 #include <fstream>
+#include <future>
 #include <vector>
 #include <list>
+#include <type_traits>
 
 #include "DumpState.h"
 
@@ -32,6 +37,7 @@
 #include "System/StringUtil.h"
 #include "System/Log/ILog.h"
 #include "System/SpringHash.h"
+#include "System/Threading/ThreadPool.h"
 
 static std::fstream file;
 
@@ -495,3 +501,305 @@ void DumpState(int newMinFrameNum, int newMaxFrameNum, int newFramePeriod, bool
 
 	file.flush();
 }
+
+
+
+namespace {
+	// kinds and fields of the records in a binary state dump, their names live in the dump's header
+	enum DumpObjectKind: uint8_t {
+		DUMP_KIND_RNG,
+		DUMP_KIND_TEAM,
+		DUMP_KIND_UNIT,
+		DUMP_KIND_FEATURE,
+		DUMP_KIND_PROJECTILE,
+		DUMP_KIND_HEIGHTMAP,
+		DUMP_NUM_KINDS,
+	};
+
+	enum DumpObjectField: uint16_t {
+		DUMP_FIELD_RNG_STATE,
+
+		DUMP_FIELD_TEAM_RES,
+		DUMP_FIELD_TEAM_RES_STORAGE,
+		DUMP_FIELD_TEAM_RES_PULL,
+		DUMP_FIELD_TEAM_RES_INCOME,
+		DUMP_FIELD_TEAM_RES_EXPENSE,
+		DUMP_FIELD_TEAM_NUM_UNITS,
+		DUMP_FIELD_TEAM_IS_DEAD,
+
+		DUMP_FIELD_UNIT_DEF_ID,
+		DUMP_FIELD_UNIT_TEAM,
+		DUMP_FIELD_UNIT_POS,
+		DUMP_FIELD_UNIT_XDIR,
+		DUMP_FIELD_UNIT_YDIR,
+		DUMP_FIELD_UNIT_ZDIR,
+		DUMP_FIELD_UNIT_SPEED,
+		DUMP_FIELD_UNIT_HEADING,
+		DUMP_FIELD_UNIT_HEALTH,
+		DUMP_FIELD_UNIT_EXPERIENCE,
+		DUMP_FIELD_UNIT_IS_DEAD,
+		DUMP_FIELD_UNIT_PHYSICAL_STATE,
+		DUMP_FIELD_UNIT_FIRE_STATE,
+		DUMP_FIELD_UNIT_MOVE_STATE,
+		DUMP_FIELD_UNIT_PIECE_POS,
+		DUMP_FIELD_UNIT_PIECE_ROT,
+		DUMP_FIELD_UNIT_WEAPON_DIR,
+		DUMP_FIELD_UNIT_WEAPON_AIM_POS,
+		DUMP_FIELD_UNIT_WEAPON_MUZZLE_POS,
+		DUMP_FIELD_UNIT_COMMAND_IDS,
+		DUMP_FIELD_UNIT_COMMAND_PARAMS,
+		DUMP_FIELD_UNIT_GOAL_POS,
+		DUMP_FIELD_UNIT_MAX_SPEED,
+		DUMP_FIELD_UNIT_PROGRESS_STATE,
+
+		DUMP_FIELD_FEATURE_DEF_ID,
+		DUMP_FIELD_FEATURE_POS,
+		DUMP_FIELD_FEATURE_HEALTH,
+		DUMP_FIELD_FEATURE_RECLAIM_LEFT,
+
+		DUMP_FIELD_PROJECTILE_POS,
+		DUMP_FIELD_PROJECTILE_DIR,
+		DUMP_FIELD_PROJECTILE_SPEED,
+		DUMP_FIELD_PROJECTILE_FLAGS,
+
+		DUMP_FIELD_HEIGHTMAP_ROW,
+		DUMP_NUM_FIELDS,
+	};
+
+	constexpr const char* DUMP_KIND_NAMES[DUMP_NUM_KINDS] = {
+		"rng", "team", "unit", "feature", "projectile", "heightmap",
+	};
+	constexpr const char* DUMP_FIELD_NAMES[DUMP_NUM_FIELDS] = {
+		"state",
+		"res", "resStorage", "resPull", "resIncome", "resExpense", "numUnits", "isDead",
+		"unitDefID", "team", "pos", "xdir", "ydir", "zdir", "speed", "heading", "health", "experience", "isDead",
+		"physicalState", "fireState", "moveState", "piecePos", "pieceRot", "weaponDir", "weaponAimFromPos",
+		"weaponMuzzlePos", "commandIDs", "commandParams", "goalPos", "maxSpeed", "progressState",
+		"featureDefID", "pos", "health", "reclaimLeft",
+		"pos", "dir", "speed", "flags",
+		"heights",
+	};
+
+	constexpr uint32_t DUMP_MAGIC = 0x44535053; // "SPSD"
+	constexpr uint32_t DUMP_VERSION = 1;
+
+
+	/**
+	 * Byte image of a binary state dump; building one only copies values
+	 * out of the synced state, formatting and writing happen elsewhere.
+	 * Records are [uint8 kind][int32 id][uint16 field][uint16 size][data],
+	 * see tools/scripts/diff_state_dumps.py for the reader.
+	 */
+	class CStateSnapshot {
+	public:
+		void AddHeader(int32_t frameNum, int32_t playerNum) {
+			Write(DUMP_MAGIC);
+			Write(DUMP_VERSION);
+			Write(frameNum);
+			Write(playerNum);
+			WriteNames(DUMP_KIND_NAMES, DUMP_NUM_KINDS);
+			WriteNames(DUMP_FIELD_NAMES, DUMP_NUM_FIELDS);
+		}
+
+		template<typename T> void AddField(DumpObjectKind kind, int32_t id, DumpObjectField field, const T& value) {
+			static_assert(std::is_trivially_copyable<T>::value, "");
+			AddRecord(kind, id, field, &value, sizeof(T));
+		}
+		template<typename T> void AddArray(DumpObjectKind kind, int32_t id, DumpObjectField field, const std::vector<T>& values) {
+			static_assert(std::is_trivially_copyable<T>::value, "");
+			// sizes are 16 bits, (absurdly) long arrays are cut off at a whole element
+			AddRecord(kind, id, field, values.data(), std::min(values.size(), size_t(0xFFFF) / sizeof(T)) * sizeof(T));
+		}
+
+		void AddRecord(DumpObjectKind kind, int32_t id, DumpObjectField field, const void* data, size_t size) {
+			Write(kind);
+			Write(id);
+			Write(field);
+			Write(static_cast<uint16_t>(size));
+			Write(data, size);
+		}
+
+		std::vector<uint8_t>& GetBuffer() { return buffer; }
+
+	private:
+		template<typename T> void Write(const T& value) { Write(&value, sizeof(T)); }
+
+		void Write(const void* data, size_t size) {
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+			buffer.insert(buffer.end(), bytes, bytes + size);
+		}
+		void WriteNames(const char* const* names, uint16_t numNames) {
+			Write(numNames);
+
+			for (uint16_t n = 0; n < numNames; n++) {
+				const uint8_t len = std::strlen(names[n]);
+
+				Write(len);
+				Write(names[n], len);
+			}
+		}
+
+	private:
+		std::vector<uint8_t> buffer;
+	};
+}
+
+
+void DumpStateSnapshot(int playerNum)
+{
+	CStateSnapshot snapshot;
+
+	std::vector<float3> float3s;
+	std::vector<float> floats;
+	std::vector<int> ints;
+
+	snapshot.GetBuffer().reserve(1024 * 1024);
+	snapshot.AddHeader(gs->frameNum, playerNum);
+	snapshot.AddField(DUMP_KIND_RNG, 0, DUMP_FIELD_RNG_STATE, gsRNG.GetGenState());
+
+	for (int a = 0; a < teamHandler.ActiveTeams(); ++a) {
+		const CTeam* t = teamHandler.Team(a);
+
+		snapshot.AddField(DUMP_KIND_TEAM, a, DUMP_FIELD_TEAM_RES, t->res);
+		snapshot.AddField(DUMP_KIND_TEAM, a, DUMP_FIELD_TEAM_RES_STORAGE, t->resStorage);
+		snapshot.AddField(DUMP_KIND_TEAM, a, DUMP_FIELD_TEAM_RES_PULL, t->resPull);
+		snapshot.AddField(DUMP_KIND_TEAM, a, DUMP_FIELD_TEAM_RES_INCOME, t->resIncome);
+		snapshot.AddField(DUMP_KIND_TEAM, a, DUMP_FIELD_TEAM_RES_EXPENSE, t->resExpense);
+		snapshot.AddField(DUMP_KIND_TEAM, a, DUMP_FIELD_TEAM_NUM_UNITS, t->GetNumUnits());
+		snapshot.AddField(DUMP_KIND_TEAM, a, DUMP_FIELD_TEAM_IS_DEAD, t->isDead);
+	}
+
+	// walk IDs in order so both dumps list the same objects in the same order
+	for (unsigned int id = 0; id < unitHandler.MaxUnits(); id++) {
+		const CUnit* u = unitHandler.GetUnit(id);
+
+		if (u == nullptr)
+			continue;
+
+		const short heading = u->heading;
+		const CCommandQueue& cq = u->commandAI->commandQue;
+		const AMoveType* amt = u->moveType;
+
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_DEF_ID, u->unitDef->id);
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_TEAM, u->team);
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_POS, u->pos);
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_XDIR, float3(u->rightdir));
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_YDIR, float3(u->updir));
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_ZDIR, float3(u->frontdir));
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_SPEED, u->speed);
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_HEADING, heading);
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_HEALTH, u->health);
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_EXPERIENCE, u->experience);
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_IS_DEAD, u->isDead);
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_PHYSICAL_STATE, static_cast<uint32_t>(u->physicalState));
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_FIRE_STATE, u->fireState);
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_MOVE_STATE, u->moveState);
+
+		float3s.clear();
+		for (const LocalModelPiece& lmp: u->localModel.pieces) {
+			float3s.push_back(lmp.GetPosition());
+		}
+		snapshot.AddArray(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_PIECE_POS, float3s);
+
+		float3s.clear();
+		for (const LocalModelPiece& lmp: u->localModel.pieces) {
+			float3s.push_back(lmp.GetRotation());
+		}
+		snapshot.AddArray(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_PIECE_ROT, float3s);
+
+		float3s.clear();
+		for (const CWeapon* w: u->weapons) {
+			float3s.push_back(w->weaponDir);
+		}
+		snapshot.AddArray(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_WEAPON_DIR, float3s);
+
+		float3s.clear();
+		for (const CWeapon* w: u->weapons) {
+			float3s.push_back(w->aimFromPos);
+		}
+		snapshot.AddArray(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_WEAPON_AIM_POS, float3s);
+
+		float3s.clear();
+		for (const CWeapon* w: u->weapons) {
+			float3s.push_back(w->weaponMuzzlePos);
+		}
+		snapshot.AddArray(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_WEAPON_MUZZLE_POS, float3s);
+
+		ints.clear();
+		floats.clear();
+		for (const Command& c: cq) {
+			ints.push_back(c.GetID());
+
+			for (unsigned int n = 0; n < c.GetNumParams(); n++) {
+				floats.push_back(c.GetParam(n));
+			}
+		}
+		snapshot.AddArray(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_COMMAND_IDS, ints);
+		snapshot.AddArray(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_COMMAND_PARAMS, floats);
+
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_GOAL_POS, amt->goalPos);
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_MAX_SPEED, amt->GetMaxSpeed());
+		snapshot.AddField(DUMP_KIND_UNIT, id, DUMP_FIELD_UNIT_PROGRESS_STATE, static_cast<int32_t>(amt->progressState));
+	}
+
+	for (unsigned int id = 0; id < featureHandler.GetMaxFeatures(); id++) {
+		const CFeature* f = featureHandler.GetFeature(id);
+
+		if (f == nullptr)
+			continue;
+
+		snapshot.AddField(DUMP_KIND_FEATURE, id, DUMP_FIELD_FEATURE_DEF_ID, f->def->id);
+		snapshot.AddField(DUMP_KIND_FEATURE, id, DUMP_FIELD_FEATURE_POS, f->pos);
+		snapshot.AddField(DUMP_KIND_FEATURE, id, DUMP_FIELD_FEATURE_HEALTH, f->health);
+		snapshot.AddField(DUMP_KIND_FEATURE, id, DUMP_FIELD_FEATURE_RECLAIM_LEFT, f->reclaimLeft);
+	}
+
+	// container order is deterministic for synced projectiles
+	for (const CProjectile* p: projectileHandler.GetActiveProjectiles(true)) {
+		if (p == nullptr)
+			continue;
+
+		const uint8_t flags = (p->weapon << 0) | (p->piece << 1) | (p->checkCol << 2) | (p->deleteMe << 3);
+
+		snapshot.AddField(DUMP_KIND_PROJECTILE, p->id, DUMP_FIELD_PROJECTILE_POS, p->pos);
+		snapshot.AddField(DUMP_KIND_PROJECTILE, p->id, DUMP_FIELD_PROJECTILE_DIR, p->dir);
+		snapshot.AddField(DUMP_KIND_PROJECTILE, p->id, DUMP_FIELD_PROJECTILE_SPEED, p->speed);
+		snapshot.AddField(DUMP_KIND_PROJECTILE, p->id, DUMP_FIELD_PROJECTILE_FLAGS, flags);
+	}
+
+	{
+		const float* heightMap = readMap->GetCornerHeightMapSynced();
+
+		for (int row = 0; row < mapDims.mapyp1; row++) {
+			snapshot.AddRecord(DUMP_KIND_HEIGHTMAP, row, DUMP_FIELD_HEIGHTMAP_ROW, heightMap + row * mapDims.mapxp1, mapDims.mapxp1 * sizeof(float));
+		}
+	}
+
+	std::string name = (gameServer != nullptr)? "Server": "Client";
+	name += "GameState-";
+	name += IntToString(gs->frameNum);
+	name += "-";
+	name += IntToString(playerNum);
+	name += ".sdump";
+
+	// the sim only pays for the copies above, the file is written off-thread
+	ThreadPool::AddExtJob(std::async(std::launch::async, [name, buffer = std::move(snapshot.GetBuffer())]() {
+		FILE* dumpFile = fopen(name.c_str(), "wb");
+
+		if (dumpFile == nullptr) {
+			LOG_L(L_ERROR, "[DumpStateSnapshot] can not open dump-file \"%s\"", name.c_str());
+			return;
+		}
+
+		const bool written = (fwrite(buffer.data(), buffer.size(), 1, dumpFile) == 1);
+
+		fclose(dumpFile);
+
+		if (!written) {
+			LOG_L(L_ERROR, "[DumpStateSnapshot] can not write dump-file \"%s\"", name.c_str());
+			return;
+		}
+
+		LOG("[DumpStateSnapshot] wrote dump-file \"%s\" (%u bytes)", name.c_str(), static_cast<unsigned int>(buffer.size()));
+	}));
+}
@@ -5,4 +5,8 @@
 
 extern void DumpState(int startFrameNum, int endFrameNum, int newFramePeriod, bool outputFloats);
 
+/// copies the synced state of the current frame into a binary dump that is written off-thread,
+/// two of these can be compared with tools/scripts/diff_state_dumps.py
+extern void DumpStateSnapshot(int playerNum);
+
 #endif /* DUMPSTATE_H */
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -21,6 +22,9 @@ static uint64_t rotr64(uint64_t x, uint64_t i) {
 }
 
 
+static void calc_final_digest(uint64_t state[sha512::NUM_STATE_CONSTS], const uint8_t msg_bytes[], size_t len, uint8_t sha_bytes[sha512::SHA_LEN]);
+
+
 void sha512::read_digest(const hex_digest& hex_chars, raw_digest& sha_bytes) {
 	for (uint8_t i = 0; i < SHA_LEN; i++) {
 		const uint8_t c0 = hex2dec(hex_chars[i * 2 + 0]);
@@ -43,14 +47,23 @@ void sha512::calc_digest(const msg_vector& msg_bytes, raw_digest& sha_bytes) {
 }
 
 void sha512::calc_digest(const uint8_t msg_bytes[], size_t len, uint8_t sha_bytes[SHA_LEN]) {
-	uint8_t block[BLK_LEN] = {0};
 	uint64_t state[NUM_STATE_CONSTS] = {0};
 
-	size_t ofs = len & (~static_cast<size_t>(BLK_LEN - 1));
+	const size_t ofs = len & (~static_cast<size_t>(BLK_LEN - 1));
 
 	static_assert(sizeof(STATE_CONSTS) == (NUM_STATE_CONSTS * sizeof(uint64_t)), "");
 	std::memcpy(&state[0], &STATE_CONSTS[0], sizeof(STATE_CONSTS));
 	dm_compress(state, msg_bytes, ofs);
+	calc_final_digest(state, msg_bytes, len, sha_bytes);
+}
+
+// compresses the partial block and padding that follow the last whole block of a message
+static void calc_final_digest(uint64_t state[sha512::NUM_STATE_CONSTS], const uint8_t msg_bytes[], size_t len, uint8_t sha_bytes[sha512::SHA_LEN]) {
+	using namespace sha512;
+
+	uint8_t block[BLK_LEN] = {0};
+
+	size_t ofs = len & (~static_cast<size_t>(BLK_LEN - 1));
 
 	// handle final blocks
 	if ((len - ofs) > 0)
@@ -145,6 +158,215 @@ void sha512::dm_compress(uint64_t state[NUM_STATE_CONSTS], const uint8_t blocks[
 }
 
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SHA512_MULTI_BUFFER
+#endif
+
+#ifdef SHA512_MULTI_BUFFER
+#include <immintrin.h>
+
+#define SHA512_AVX2 __attribute__((target("avx2")))
+
+template<int i> SHA512_AVX2 static inline __m256i rotr64x4(__m256i x) {
+	return (_mm256_or_si256(_mm256_srli_epi64(x, i), _mm256_slli_epi64(x, 64 - i)));
+}
+
+static inline uint64_t load_be64(const uint8_t bytes[]) {
+	uint64_t v;
+	std::memcpy(&v, bytes, sizeof(v));
+	return (__builtin_bswap64(v));
+}
+
+/**
+ * Compresses one block of each of NUM_LANES messages, lane k of every vector
+ * belonging to message k; the arithmetic is dm_compress's, 64 bits per lane.
+ * states[j][k] is word j of the state of message k.
+ */
+SHA512_AVX2 static void dm_compress_x4(uint64_t states[sha512::NUM_STATE_CONSTS][sha512::NUM_LANES], const uint8_t* const blocks[sha512::NUM_LANES]) {
+	using namespace sha512;
+
+	static_assert(NUM_LANES == 4, "");
+
+	__m256i schedule[NUM_ROUND_CONSTS];
+
+	for (uint8_t j = 0; j < 16; j++) {
+		schedule[j] = _mm256_set_epi64x(
+			load_be64(blocks[3] + j * 8),
+			load_be64(blocks[2] + j * 8),
+			load_be64(blocks[1] + j * 8),
+			load_be64(blocks[0] + j * 8)
+		);
+	}
+
+	for (uint8_t j = 16; j < NUM_ROUND_CONSTS; j++) {
+		const __m256i w15 = schedule[j - 15];
+		const __m256i w2 = schedule[j - 2];
+		const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr64x4< 1>(w15), rotr64x4< 8>(w15)), _mm256_srli_epi64(w15, 7));
+		const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr64x4<19>(w2 ), rotr64x4<61>(w2 )), _mm256_srli_epi64(w2 , 6));
+
+		schedule[j] = _mm256_add_epi64(_mm256_add_epi64(schedule[j - 16], schedule[j - 7]), _mm256_add_epi64(s0, s1));
+	}
+
+	__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states[0]));
+	__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states[1]));
+	__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states[2]));
+	__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states[3]));
+	__m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states[4]));
+	__m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states[5]));
+	__m256i g = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states[6]));
+	__m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states[7]));
+
+	const __m256i a0 = a, b0 = b, c0 = c, d0 = d;
+	const __m256i e0 = e, f0 = f, g0 = g, h0 = h;
+
+	for (uint8_t j = 0; j < NUM_ROUND_CONSTS; j++) {
+		const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr64x4<14>(e), rotr64x4<18>(e)), rotr64x4<41>(e));
+		const __m256i ch = _mm256_xor_si256(g, _mm256_and_si256(e, _mm256_xor_si256(f, g)));
+		const __m256i kw = _mm256_add_epi64(_mm256_set1_epi64x(ROUND_CONSTS[j]), schedule[j]);
+		const __m256i t1 = _mm256_add_epi64(_mm256_add_epi64(h, s1), _mm256_add_epi64(ch, kw));
+
+		const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr64x4<28>(a), rotr64x4<34>(a)), rotr64x4<39>(a));
+		const __m256i mj = _mm256_or_si256(_mm256_and_si256(a, _mm256_or_si256(b, c)), _mm256_and_si256(b, c));
+		const __m256i t2 = _mm256_add_epi64(s0, mj);
+
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi64(d, t1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi64(t1, t2);
+	}
+
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(states[0]), _mm256_add_epi64(a, a0));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(states[1]), _mm256_add_epi64(b, b0));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(states[2]), _mm256_add_epi64(c, c0));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(states[3]), _mm256_add_epi64(d, d0));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(states[4]), _mm256_add_epi64(e, e0));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(states[5]), _mm256_add_epi64(f, f0));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(states[6]), _mm256_add_epi64(g, g0));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(states[7]), _mm256_add_epi64(h, h0));
+}
+#endif
+
+
+bool sha512::have_multi_buffer() {
+	#ifdef SHA512_MULTI_BUFFER
+	// also checks that the OS saves the YMM registers
+	static const bool haveAVX2 = __builtin_cpu_supports("avx2");
+	return haveAVX2;
+	#else
+	return false;
+	#endif
+}
+
+void sha512::calc_digests(const uint8_t* const msg_bytes[], const size_t lens[], uint8_t* const sha_bytes[], size_t count) {
+	if (count < 2 || !have_multi_buffer()) {
+		for (size_t n = 0; n < count; n++) {
+			calc_digest(msg_bytes[n], lens[n], sha_bytes[n]);
+		}
+
+		return;
+	}
+
+	#ifdef SHA512_MULTI_BUFFER
+	struct Lane {
+		size_t msg = 0;
+		size_t numBlocks = 0; // whole blocks left, the lane is idle at 0
+		const uint8_t* block = nullptr;
+	};
+
+	uint64_t states[NUM_STATE_CONSTS][NUM_LANES] = {{0}};
+	uint64_t state[NUM_STATE_CONSTS];
+
+	Lane lanes[NUM_LANES];
+	const uint8_t* blocks[NUM_LANES];
+
+	size_t nextMsg = 0;
+	size_t numActive = 0;
+
+	// hands a lane the next message that has a whole block; shorter ones are finished directly
+	const auto fillLane = [&](size_t k) {
+		for (Lane& lane = lanes[k]; nextMsg < count; ) {
+			lane.msg = nextMsg++;
+			lane.numBlocks = lens[lane.msg] / BLK_LEN;
+			lane.block = msg_bytes[lane.msg];
+
+			if (lane.numBlocks > 0) {
+				for (uint8_t j = 0; j < NUM_STATE_CONSTS; j++) {
+					states[j][k] = STATE_CONSTS[j];
+				}
+
+				numActive++;
+				return;
+			}
+
+			calc_digest(msg_bytes[lane.msg], lens[lane.msg], sha_bytes[lane.msg]);
+		}
+
+		lanes[k].numBlocks = 0;
+	};
+	const auto copyState = [&](size_t k) {
+		for (uint8_t j = 0; j < NUM_STATE_CONSTS; j++) {
+			state[j] = states[j][k];
+		}
+	};
+
+	for (size_t k = 0; k < NUM_LANES; k++) {
+		fillLane(k);
+	}
+
+	// below two busy lanes the scalar path is faster
+	while (numActive >= 2) {
+		for (size_t k = 0; k < NUM_LANES; k++) {
+			// idle lanes compress some busy lane's block again, their state is garbage
+			blocks[k] = (lanes[k].numBlocks > 0)? lanes[k].block: nullptr;
+		}
+		for (size_t k = 0; k < NUM_LANES; k++) {
+			if (blocks[k] == nullptr)
+				blocks[k] = *std::find_if(blocks, blocks + NUM_LANES, [](const uint8_t* b) { return (b != nullptr); });
+		}
+
+		dm_compress_x4(states, blocks);
+
+		for (size_t k = 0; k < NUM_LANES; k++) {
+			Lane& lane = lanes[k];
+
+			if (lane.numBlocks == 0)
+				continue;
+
+			lane.block += BLK_LEN;
+
+			if ((--lane.numBlocks) > 0)
+				continue;
+
+			copyState(k);
+			calc_final_digest(state, msg_bytes[lane.msg], lens[lane.msg], sha_bytes[lane.msg]);
+
+			numActive--;
+			fillLane(k);
+		}
+	}
+
+	for (size_t k = 0; k < NUM_LANES; k++) {
+		const Lane& lane = lanes[k];
+
+		if (lane.numBlocks == 0)
+			continue;
+
+		copyState(k);
+		dm_compress(state, lane.block, lane.numBlocks * BLK_LEN);
+		calc_final_digest(state, msg_bytes[lane.msg], lens[lane.msg], sha_bytes[lane.msg]);
+	}
+
+	for (; nextMsg < count; nextMsg++) {
+		calc_digest(msg_bytes[nextMsg], lens[nextMsg], sha_bytes[nextMsg]);
+	}
+	#endif
+}
+
+
 bool sha512::unit_test(const char* msg_str, const char* sha_str) {
 	msg_vector msg_bytes = {};
 	raw_digest sha_bytes = {0};
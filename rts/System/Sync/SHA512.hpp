@@ -17,6 +17,8 @@ namespace sha512 {
 	static constexpr uint8_t NUM_STATE_CONSTS =  8;
 	static constexpr uint8_t NUM_ROUND_CONSTS = 80;
 
+	static constexpr uint8_t NUM_LANES = 4; // messages calc_digests compresses side by side
+
 	static constexpr uint64_t STATE_CONSTS[NUM_STATE_CONSTS] = {
 		0x6A09E667F3BCC908ull, 0xBB67AE8584CAA73Bull, 0x3C6EF372FE94F82Bull, 0xA54FF53A5F1D36F1ull,
 		0x510E527FADE682D1ull, 0x9B05688C2B3E6C1Full, 0x1F83D9ABFB41BD6Bull, 0x5BE0CD19137E2179ull,
@@ -58,6 +60,10 @@ namespace sha512 {
 	void dump_digest(const raw_digest& sha_bytes, hex_digest& hex_chars); // raw to hex
 	void calc_digest(const msg_vector& msg_bytes, raw_digest& sha_bytes);
 	void calc_digest(const uint8_t msg_bytes[], size_t len, uint8_t sha_bytes[SHA_LEN]);
+	// same digests as calc_digest per message, but blocks of up to NUM_LANES messages are
+	// compressed side by side in AVX2 registers if the CPU has them (checked at runtime)
+	void calc_digests(const uint8_t* const msg_bytes[], const size_t lens[], uint8_t* const sha_bytes[], size_t count);
+	bool have_multi_buffer();
 	void dm_compress(uint64_t state[NUM_STATE_CONSTS], const uint8_t blocks[], size_t len);
 
 	bool unit_test(const char* msg_str = TEST_STR_PAIR[0], const char* sha_str = TEST_STR_PAIR[1]);
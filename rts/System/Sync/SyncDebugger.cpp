@@ -113,7 +113,7 @@ void CSyncDebugger::Initialize(bool useBacktrace, unsigned numPlayers)
 }
 
 
-void CSyncDebugger::Sync(const void* p, unsigned size, const char* op)
+void CSyncDebugger::Sync(unsigned data, const char* op)
 {
 	if (!history && !historybt) {
 		return;
@@ -132,24 +132,7 @@ void CSyncDebugger::Sync(const void* p, unsigned size, const char* op)
 	}
 #endif
 
-	if (size == 4) {
-		// common case
-		h->data = *(const unsigned*) p;
-	}
-	else {
-		// > XOR seems dangerous in that every bit is independent of any other, this is bad.
-		// This isn't the case here, however, because typically we checksum only 1-8 bytes
-		// of data at a time, so most of it fits in the checksum anyway.
-		// (see SyncedPrimitiveBase / SyncedPrimitive, the main client of this method)
-		unsigned i = 0;
-		h->data = 0;
-		// whole dwords
-		for (; i < (size & ~3); i += 4)
-			h->data ^= *(const unsigned*) ((const unsigned char*) p + i);
-		// remaining 0 to 3 bytes
-		for (; i < size; ++i)
-			h->data ^= *((const unsigned char*) p + i);
-	}
+	h->data = data;
 
 	if (++historyIndex == HISTORY_SIZE * BLOCK_SIZE) {
 		historyIndex = 0; // wrap around
@@ -184,10 +184,38 @@ class CSyncDebugger {
 		 * @brief the backbone of the sync debugger
 		 *
 		 * This function adds an item to the history and appends a backtrace and
-		 * an operator (op) to it. p must point to the data to checksum and size
-		 * must be the size of that data.
+		 * an operator (op) to it. data is the checksum of whatever was written,
+		 * see Fold.
 		 */
-		void Sync(const void* p, unsigned size, const char* op);
+		void Sync(unsigned data, const char* op);
+		void Sync(const void* p, unsigned size, const char* op) { Sync(Fold(p, size), op); }
+
+		/**
+		 * @brief checksum of a history item
+		 *
+		 * Inline so that for the fixed-size types SyncedPrimitive wraps this
+		 * reduces to a single load (or a few XORs) at compile time.
+		 */
+		static unsigned Fold(const void* p, unsigned size) {
+			// common case
+			if (size == 4)
+				return *(const unsigned*) p;
+
+			// > XOR seems dangerous in that every bit is independent of any other, this is bad.
+			// This isn't the case here, however, because typically we checksum only 1-8 bytes
+			// of data at a time, so most of it fits in the checksum anyway.
+			// (see SyncedPrimitiveBase / SyncedPrimitive, the main client of this method)
+			unsigned i = 0;
+			unsigned data = 0;
+			// whole dwords
+			for (; i < (size & ~3); i += 4)
+				data ^= *(const unsigned*) ((const unsigned char*) p + i);
+			// remaining 0 to 3 bytes
+			for (; i < size; ++i)
+				data ^= *((const unsigned char*) p + i);
+
+			return data;
+		}
 
 		/**
 		 * @brief initialize
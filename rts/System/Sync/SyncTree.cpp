@@ -0,0 +1,144 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SyncTree.h"
+
+#include <algorithm>
+
+#include "Map/ReadMap.h"
+#include "Sim/Features/Feature.h"
+#include "Sim/Features/FeatureHandler.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/GroundBlockingObjectMap.h"
+#include "Sim/Misc/Team.h"
+#include "Sim/Misc/TeamHandler.h"
+#include "Sim/Projectiles/Projectile.h"
+#include "Sim/Projectiles/ProjectileHandler.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitHandler.h"
+#include "System/SpringHash.h"
+
+
+static std::uint32_t HashUnit(const CUnit* unit, std::uint32_t hash)
+{
+	const short heading = unit->heading;
+
+	hash = spring::LiteHash(unit->id, hash);
+	hash = spring::LiteHash(unit->unitDef->id, hash);
+	hash = spring::LiteHash(unit->team, hash);
+	hash = spring::LiteHash(unit->pos, hash);
+	hash = spring::LiteHash(unit->speed, hash);
+	hash = spring::LiteHash(unit->health, hash);
+	return spring::LiteHash(heading, hash);
+}
+
+static std::uint32_t HashFeature(const CFeature* feature, std::uint32_t hash)
+{
+	hash = spring::LiteHash(feature->id, hash);
+	hash = spring::LiteHash(feature->pos, hash);
+	hash = spring::LiteHash(feature->health, hash);
+	return spring::LiteHash(feature->reclaimLeft, hash);
+}
+
+template<typename GetObjectFunc, typename HashObjectFunc>
+static void HashBuckets(std::vector<std::uint32_t>& buckets, unsigned int numIDs, GetObjectFunc getObject, HashObjectFunc hashObject)
+{
+	buckets.clear();
+	buckets.resize((numIDs + CSyncTree::BUCKET_SIZE - 1) / CSyncTree::BUCKET_SIZE, 0);
+
+	// walk IDs in order; the active-object containers are not ordered by ID
+	for (unsigned int id = 0; id < numIDs; id++) {
+		const auto* object = getObject(id);
+
+		if (object == nullptr)
+			continue;
+
+		std::uint32_t& hash = buckets[id / CSyncTree::BUCKET_SIZE];
+		hash = hashObject(object, hash);
+	}
+}
+
+static std::uint32_t HashChildren(const std::vector<std::uint32_t>& children)
+{
+	return (spring::LiteHash(children.data(), children.size() * sizeof(std::uint32_t), children.size()));
+}
+
+
+void CSyncTree::Update(int _frameNum)
+{
+	frameNum = _frameNum;
+
+	nodeHashes.clear();
+	nodeHashes.resize(SYNCTREE_NUM_NODES, 0);
+
+	for (std::vector<std::uint32_t>& hashes: childHashes) {
+		hashes.clear();
+	}
+
+	{
+		const auto rngState = gsRNG.GetGenState();
+		nodeHashes[SYNCTREE_NODE_RNG] = spring::LiteHash(rngState);
+	}
+	{
+		std::vector<std::uint32_t>& hashes = childHashes[SYNCTREE_NODE_TEAMS];
+		hashes.reserve(teamHandler.ActiveTeams());
+
+		for (int i = 0; i < teamHandler.ActiveTeams(); i++) {
+			const CTeam* team = teamHandler.Team(i);
+
+			std::uint32_t hash = 0;
+			hash = spring::LiteHash(team->res, hash);
+			hash = spring::LiteHash(team->resStorage, hash);
+			hash = spring::LiteHash(team->GetNumUnits(), hash);
+			hashes.push_back(spring::LiteHash(team->isDead, hash));
+		}
+
+		nodeHashes[SYNCTREE_NODE_TEAMS] = HashChildren(hashes);
+	}
+	{
+		std::vector<std::uint32_t>& hashes = childHashes[SYNCTREE_NODE_UNITS];
+		HashBuckets(hashes, unitHandler.MaxUnits(), [](unsigned int id) { return unitHandler.GetUnit(id); }, HashUnit);
+		nodeHashes[SYNCTREE_NODE_UNITS] = HashChildren(hashes);
+	}
+	{
+		std::vector<std::uint32_t>& hashes = childHashes[SYNCTREE_NODE_FEATURES];
+		HashBuckets(hashes, featureHandler.GetMaxFeatures(), [](unsigned int id) { return featureHandler.GetFeature(id); }, HashFeature);
+		nodeHashes[SYNCTREE_NODE_FEATURES] = HashChildren(hashes);
+	}
+	{
+		// container order is deterministic for synced projectiles
+		const ProjectileContainer& projectiles = projectileHandler.GetActiveProjectiles(true);
+
+		std::uint32_t hash = projectiles.size();
+
+		for (const CProjectile* p: projectiles) {
+			if (p == nullptr)
+				continue;
+
+			hash = spring::LiteHash(p->id, hash);
+			hash = spring::LiteHash(p->pos, hash);
+			hash = spring::LiteHash(p->speed, hash);
+		}
+
+		nodeHashes[SYNCTREE_NODE_PROJECTILES] = hash;
+	}
+	{
+		std::vector<std::uint32_t>& hashes = childHashes[SYNCTREE_NODE_HEIGHTMAP];
+
+		const float* heightMap = readMap->GetCornerHeightMapSynced();
+		const unsigned int numRows = mapDims.mapyp1;
+		const unsigned int rowSize = mapDims.mapxp1;
+
+		hashes.reserve((numRows + BUCKET_SIZE - 1) / BUCKET_SIZE);
+
+		// one pass over the whole array per bucket instead of a call per height
+		for (unsigned int row = 0; row < numRows; row += BUCKET_SIZE) {
+			const unsigned int bucketRows = std::min(BUCKET_SIZE, numRows - row);
+			hashes.push_back(spring::LiteHash(heightMap + row * rowSize, bucketRows * rowSize * sizeof(float), row));
+		}
+
+		nodeHashes[SYNCTREE_NODE_HEIGHTMAP] = HashChildren(hashes);
+	}
+
+	nodeHashes[SYNCTREE_NODE_BLOCKINGMAP] = groundBlockingObjectMap.CalcChecksum();
+}
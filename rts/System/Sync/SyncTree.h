@@ -0,0 +1,94 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SYNC_TREE_H
+#define SYNC_TREE_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Sim/Misc/GlobalConstants.h"
+
+/// top-level nodes of the sync tree, in the order their hashes are sent
+enum SyncTreeNode {
+	SYNCTREE_NODE_RNG         = 0,
+	SYNCTREE_NODE_TEAMS       = 1, // children: one per team
+	SYNCTREE_NODE_UNITS       = 2, // children: one per BUCKET_SIZE unit IDs
+	SYNCTREE_NODE_FEATURES    = 3, // children: one per BUCKET_SIZE feature IDs
+	SYNCTREE_NODE_PROJECTILES = 4,
+	SYNCTREE_NODE_HEIGHTMAP   = 5, // children: one per BUCKET_SIZE heightmap rows
+	SYNCTREE_NODE_BLOCKINGMAP = 6,
+	SYNCTREE_NUM_NODES        = 7,
+
+	SYNCTREE_NODE_DUMP        = 0xFE, // NETMSG_SYNCTREE from the server requesting a binary state dump at frameNum
+	SYNCTREE_NODE_ROOT        = 0xFF, // NETMSG_SYNCTREE carrying the top-level hashes
+};
+
+/**
+ * @brief hierarchical sync checksums
+ *
+ * Unlike CSyncChecker's single running checksum, this hashes the synced
+ * state per subsystem (and per bucket of units, features, ... below that)
+ * every UPDATE_INTERVAL frames. Clients send the top-level hashes to the
+ * server, which on a mismatch requests the children of the differing nodes
+ * from the players involved, so a desync can be narrowed down to e.g. a
+ * range of unit IDs in release builds without CSyncDebugger's histories.
+ *
+ * Hashing only reads synced state; only the hashes of the latest update
+ * are kept.
+ */
+class CSyncTree {
+public:
+	static constexpr int UPDATE_INTERVAL = GAME_SPEED * 30;
+	static constexpr unsigned int BUCKET_SIZE = 64;
+
+	static bool HasChildren(unsigned int node) {
+		switch (node) {
+			case SYNCTREE_NODE_TEAMS    : return true;
+			case SYNCTREE_NODE_UNITS    : return true;
+			case SYNCTREE_NODE_FEATURES : return true;
+			case SYNCTREE_NODE_HEIGHTMAP: return true;
+			default                     : break;
+		}
+
+		return false;
+	}
+
+	static const char* GetNodeName(unsigned int node) {
+		constexpr const char* names[SYNCTREE_NUM_NODES] = {"RNG", "teams", "units", "features", "projectiles", "heightmap", "blocking-map"};
+		return ((node < SYNCTREE_NUM_NODES)? names[node]: "unknown");
+	}
+
+	static std::string GetChildName(unsigned int node, unsigned int child) {
+		const unsigned int first = child * BUCKET_SIZE;
+		const unsigned int last = first + BUCKET_SIZE - 1;
+
+		switch (node) {
+			case SYNCTREE_NODE_TEAMS    : return ("team " + std::to_string(child));
+			case SYNCTREE_NODE_UNITS    : return ("unit IDs " + std::to_string(first) + "-" + std::to_string(last));
+			case SYNCTREE_NODE_FEATURES : return ("feature IDs " + std::to_string(first) + "-" + std::to_string(last));
+			case SYNCTREE_NODE_HEIGHTMAP: return ("heightmap rows " + std::to_string(first) + "-" + std::to_string(last));
+			default                     : break;
+		}
+
+		return (std::string(GetNodeName(node)) + " " + std::to_string(child));
+	}
+
+public:
+	/// rehashes the current synced state, call between SimFrames only
+	void Update(int frameNum);
+
+	int GetFrameNum() const { return frameNum; }
+
+	const std::vector<std::uint32_t>& GetNodeHashes() const { return nodeHashes; }
+	const std::vector<std::uint32_t>& GetChildHashes(unsigned int node) const { return childHashes[node]; }
+
+private:
+	int frameNum = -1;
+
+	std::vector<std::uint32_t> nodeHashes;
+	std::array<std::vector<std::uint32_t>, SYNCTREE_NUM_NODES> childHashes;
+};
+
+#endif // SYNC_TREE_H
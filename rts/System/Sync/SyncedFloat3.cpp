@@ -21,8 +21,7 @@ void SyncedFloat3::ClampInBounds()
 {
 	assert(float3::maxxpos > 0.0f); // check if initialized
 
-	x = Clamp((float)x, 0.0f, float3::maxxpos);
-	z = Clamp((float)z, 0.0f, float3::maxzpos);
+	Set(Clamp((float)x, 0.0f, float3::maxxpos), y, Clamp((float)z, 0.0f, float3::maxzpos), "clamp");
 
 	//return *this;
 }
@@ -32,8 +31,7 @@ void SyncedFloat3::ClampInMap()
 {
 	assert(float3::maxxpos > 0.0f); // check if initialized
 
-	x = Clamp((float)x, 0.0f, float3::maxxpos + 1);
-	z = Clamp((float)z, 0.0f, float3::maxzpos + 1);
+	Set(Clamp((float)x, 0.0f, float3::maxxpos + 1), y, Clamp((float)z, 0.0f, float3::maxzpos + 1), "clamp");
 }
 
 #endif // defined(SYNCDEBUG) || defined(SYNCCHECK)
@@ -33,7 +33,7 @@ public:
 	/**
 	 * @brief Conversion from float3
 	 */
-	SyncedFloat3(const float3& f) : x(f.x), y(f.y), z(f.z) {}
+	SyncedFloat3(const float3& f) { Set(f.x, f.y, f.z, "copy"); }
 
 	/**
 	 * @brief Constructor
@@ -43,8 +43,9 @@ public:
 	 *
 	 * With parameters, initializes x/y/z to the given floats.
 	 */
-	SyncedFloat3(const float x = 0.0f, const float y = 0.0f, const float z = 0.0f)
-			: x(x), y(y), z(z) {}
+	SyncedFloat3(const float x = 0.0f, const float y = 0.0f, const float z = 0.0f) {
+		Set(x, y, z, "copy");
+	}
 
 	/**
 	 * @brief float[3] Constructor
@@ -52,7 +53,7 @@ public:
 	 *
 	 * With parameters, initializes x/y/z to the given float[3].
 	 */
-	SyncedFloat3(const float f[3]) : x(f[0]), y(f[1]), z(f[2]) {}
+	SyncedFloat3(const float f[3]) { Set(f[0], f[1], f[2], "copy"); }
 
 	/**
 	 * @brief operator =
@@ -62,9 +63,7 @@ public:
 	 */
 	SyncedFloat3& operator= (const float f[3]) {
 
-		x = f[0];
-		y = f[1];
-		z = f[2];
+		Set(f[0], f[1], f[2], "=");
 
 		return *this;
 	}
@@ -117,9 +116,7 @@ public:
 	 */
 	void operator+= (const float3& f) {
 
-		x += f.x;
-		y += f.y;
-		z += f.z;
+		Set(x + f.x, y + f.y, z + f.z, "+=");
 	}
 
 	/**
@@ -166,9 +163,7 @@ public:
 	 */
 	void operator-= (const float3& f) {
 
-		x -= f.x;
-		y -= f.y;
-		z -= f.z;
+		Set(x - f.x, y - f.y, z - f.z, "-=");
 	}
 
 	/**
@@ -203,9 +198,7 @@ public:
 	 * the new float3 inside this one.
 	 */
 	void operator*= (const float3& f) {
-		x *= f.x;
-		y *= f.y;
-		z *= f.z;
+		Set(x * f.x, y * f.y, z * f.z, "*=");
 	}
 
 	/**
@@ -216,9 +209,7 @@ public:
 	 * the new float3 inside this one.
 	 */
 	void operator*= (const float f) {
-		x *= f;
-		y *= f;
-		z *= f;
+		Set(x * f, y * f, z * f, "*=");
 	}
 
 	/**
@@ -256,9 +247,7 @@ public:
 	 */
 	void operator/= (const float3& f) {
 
-		x /= f.x;
-		y /= f.y;
-		z /= f.z;
+		Set(x / f.x, y / f.y, z / f.z, "/=");
 	}
 
 	/**
@@ -611,12 +600,30 @@ public:
 		assert(!math::isnan(z) && !math::isinf(z));
 	}
 
+private:
+	/**
+	 * @brief writes all components, then checks them as one value
+	 *
+	 * One sync-checker fold (and one sync-debugger history item) per vector
+	 * write instead of one per component; writes to a single component
+	 * (pos.y = ...) are still checked by SyncedFloat itself.
+	 */
+	void Set(const float fx, const float fy, const float fz, const char* op) {
+		x.x = fx;
+		y.x = fy;
+		z.x = fz;
+
+		Sync::Assert(this, sizeof(*this), op);
+	}
+
 public:
 	SyncedFloat x; ///< x component
 	SyncedFloat y; ///< y component
 	SyncedFloat z; ///< z component
 };
 
+static_assert(sizeof(SyncedFloat3) == sizeof(float3), "SyncedFloat3::Set checks the components as one contiguous value");
+
 #else // SYNCDEBUG || SYNCCHECK
 
 typedef float3 SyncedFloat3;
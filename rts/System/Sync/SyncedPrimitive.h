@@ -39,6 +39,9 @@ template <class T>
 struct SyncedPrimitive
 {
 private:
+	// writes its components unchecked and checks all of them at once
+	friend struct SyncedFloat3;
+
 	T x;
 	void Sync(const char* op) {Sync::Assert(x, op);}
 
@@ -25,10 +25,25 @@ namespace Sync {
 
 	/**
 	 * @brief Check sync of the argument x.
+	 *
+	 * sizeof(T) is known here, so the history item's checksum is folded inline.
 	 */
 	template<typename T>
 	static inline void AssertDebugger(const T& x, const char* msg = "assert") {
-		AssertDebugger(&x, sizeof(T), msg);
+	#ifdef SYNCDEBUG
+		CSyncDebugger::GetInstance()->Sync(CSyncDebugger::Fold(&x, sizeof(T)), msg);
+	#endif
+	}
+
+	static inline void AssertChecker(const void* p, unsigned size, const char* msg) {
+#ifdef SYNCCHECK
+		assert(CSyncChecker::InSyncedCode());
+		CSyncChecker::Sync(p, size);
+	#ifdef TRACE_SYNC
+		unsigned int crc = CSyncChecker::GetChecksum();
+		fprintf(stderr, "[Sync::%s] msg=%s chksum=%u\n", __func__, msg, crc);
+	#endif
+#endif
 	}
 
 
@@ -43,14 +58,7 @@ namespace Sync {
 	 */
 	static inline void Assert(const void* p, unsigned size, const char* msg) {
 		AssertDebugger(p, size, msg);
-#ifdef SYNCCHECK
-		assert(CSyncChecker::InSyncedCode());
-		CSyncChecker::Sync(p, size);
-	#ifdef TRACE_SYNC
-		unsigned int crc = CSyncChecker::GetChecksum();
-		fprintf(stderr, "[Sync::%s] msg=%s chksum=%u\n", __func__, msg, crc);
-	#endif
-#endif
+		AssertChecker(p, size, msg);
 	}
 
 	/**
@@ -58,7 +66,8 @@ namespace Sync {
 	 */
 	template<typename T>
 	static inline void Assert(const T& x, const char* msg = "assert") {
-		Assert(&x, sizeof(T), msg);
+		AssertDebugger(x, msg);
+		AssertChecker(&x, sizeof(T), msg);
 	}
 
 }
@@ -16,6 +16,7 @@
 #include "System/Log/ILog.h"
 #include "System/Platform/Threading.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/WorkStealingDeque.h"
 
 #ifdef   likely
 #undef   likely
@@ -40,6 +41,11 @@
 
 #ifndef UNIT_TEST
 CONFIG(int, WorkerThreadCount).defaultValue(-1).safemodeValue(0).minimumValue(-1).description("Number of workers (including the main thread!) used by ThreadPool.");
+CONFIG(bool, ThreadPoolWorkStealing).defaultValue(false).safemodeValue(false).description("Whether ThreadPool workers keep private task deques and steal work from each other when idle, instead of sharing a single queue. Takes effect on (re)start.");
+CONFIG(unsigned, WorkerThreadAffinity).defaultValue(0).description("Bitmask of the CPU cores the ThreadPool's parallel-loop workers are pinned to (one core each). 0 picks them automatically.");
+CONFIG(unsigned, BackgroundThreadAffinity).defaultValue(0).description("Bitmask of the CPU cores the ThreadPool's background (loading, IO, etc.) workers may run on. 0 means all cores except those of the main thread.");
+CONFIG(bool, ThreadPoolReserveMainCore).defaultValue(true).safemodeValue(false).description("Keep all ThreadPool workers off the physical core (and its hyperthreads) the main thread runs on. Ignored if SetCoreAffinity is set or there are fewer than four physical cores.");
+CONFIG(bool, ThreadPoolBackgroundPriority).defaultValue(true).description("Run the ThreadPool's background workers at a lower OS priority than the main thread and the parallel-loop workers.");
 #endif
 
 
@@ -52,6 +58,7 @@ struct ThreadStats {
 	uint64_t sumWaitTime;
 	uint64_t minWaitTime;
 	uint64_t maxWaitTime;
+	uint64_t numTasksStolen;
 };
 
 
@@ -74,7 +81,26 @@ static std::array<bool, ThreadPool::MAX_THREADS> exitFlags;
 static std::array<ThreadStats, ThreadPool::MAX_THREADS> threadStats[2];
 static spring::signal newTasksSignal[2];
 
+// per-worker deques used only in work-stealing mode; a worker pushes the
+// unpinned (wantedThread=0) tasks it spawns onto its own deque and other
+// threads steal from the opposite end when their queues run dry
+// tasks pushed by the main thread (or external threads) still enter via
+// the global queue, which serves as the shared injection point
+typedef WorkStealingDeque<ITaskGroup*, 1024> TaskDeque;
+
+static std::array<TaskDeque, ThreadPool::MAX_THREADS> workerDeques;
+static bool workStealing = false;
+
+// async workers are spawned before SetDefaultThreadCount decides on their
+// cores, so they pick up the mask (whenever its generation changes) from
+// their loop rather than being pinned by a task like the sync ones
+static std::atomic<std::uint32_t> backgroundAffinity = {0};
+static std::atomic<std::uint32_t> backgroundAffinityGen = {0};
+static bool backgroundPriority = false;
+
 static _threadlocal int threadnum(0);
+// non-null only for sync workers, since async workers share their tid's
+static _threadlocal TaskDeque* ownDeque = nullptr;
 
 #ifndef UNITSYNC
 // if enabled, allows OpenGL calls from ThreadPool tasks
@@ -104,6 +130,38 @@ static int GetConfigNumWorkers() {
 	#endif
 }
 
+static bool GetConfigWorkStealing() {
+	#ifndef UNIT_TEST
+	return configHandler->GetBool("ThreadPoolWorkStealing");
+	#else
+	return false;
+	#endif
+}
+
+static std::uint32_t GetConfigWorkerAffinity(bool async) {
+	#ifndef UNIT_TEST
+	return configHandler->GetUnsigned(async? "BackgroundThreadAffinity": "WorkerThreadAffinity");
+	#else
+	return 0;
+	#endif
+}
+
+static bool GetConfigReserveMainCore() {
+	#ifndef UNIT_TEST
+	return configHandler->GetBool("ThreadPoolReserveMainCore");
+	#else
+	return false;
+	#endif
+}
+
+static bool GetConfigBackgroundPriority() {
+	#ifndef UNIT_TEST
+	return configHandler->GetBool("ThreadPoolBackgroundPriority");
+	#else
+	return false;
+	#endif
+}
+
 static int GetDefaultNumWorkers() {
 	const int maxNumThreads = GetMaxThreads(); // min(MAX_THREADS, logicalCpus)
 	const int cfgNumWorkers = GetConfigNumWorkers();
@@ -128,14 +186,41 @@ int GetMaxThreads() { return std::min(MAX_THREADS, Threading::GetLogicalCpuCores
 
 bool HasThreads() { return !workerThreads[false].empty(); }
 
+bool UseWorkStealing() { return workStealing; }
+void SetWorkStealing(bool enable)
+{
+	// switching schedulers while tasks are in flight would strand them
+	assert(!HasThreads());
 
+	if (HasThreads())
+		return;
 
-static bool DoTask(int tid, bool async)
+	workStealing = enable;
+}
+
+
+
+static uint64_t RunTaskGroup(ITaskGroup* tg, int tid, bool async)
 {
-	#ifndef UNIT_TEST
-	SCOPED_MT_TIMER("ThreadPool::RunTask");
+	#ifdef USE_TASK_STATS_TRACKING
+	const uint64_t wdt = tg->GetDeltaTime(spring_now());
+	const uint64_t edt = tg->ExecuteLoop(tid, false);
+
+	threadStats[async][tid].numTasksRun += 1;
+	threadStats[async][tid].sumExecTime += edt;
+	threadStats[async][tid].sumWaitTime += wdt;
+	threadStats[async][tid].minExecTime  = std::min(threadStats[async][tid].minExecTime, edt);
+	threadStats[async][tid].maxExecTime  = std::max(threadStats[async][tid].maxExecTime, edt);
+	threadStats[async][tid].minWaitTime  = std::min(threadStats[async][tid].minWaitTime, wdt);
+	threadStats[async][tid].maxWaitTime  = std::max(threadStats[async][tid].maxWaitTime, wdt);
+	return edt;
+	#else
+	return (tg->ExecuteLoop(tid, false));
 	#endif
+}
 
+static bool DoQueuedTask(int tid, bool async)
+{
 	ITaskGroup* tg = nullptr;
 
 	// any external thread calling WaitForFinished will have
@@ -156,21 +241,7 @@ static bool DoTask(int tid, bool async)
 				NotifyWorkerThreads(true, async);
 
 			assert(!async || tg->IsAsyncTask());
-
-			#ifdef USE_TASK_STATS_TRACKING
-			const uint64_t wdt = tg->GetDeltaTime(spring_now());
-			const uint64_t edt = tg->ExecuteLoop(tid, false);
-
-			threadStats[async][tid].numTasksRun += 1;
-			threadStats[async][tid].sumExecTime += edt;
-			threadStats[async][tid].sumWaitTime += wdt;
-			threadStats[async][tid].minExecTime  = std::min(threadStats[async][tid].minExecTime, edt);
-			threadStats[async][tid].maxExecTime  = std::max(threadStats[async][tid].maxExecTime, edt);
-			threadStats[async][tid].minWaitTime  = std::min(threadStats[async][tid].minWaitTime, wdt);
-			threadStats[async][tid].maxWaitTime  = std::max(threadStats[async][tid].maxWaitTime, wdt);
-			#else
-			tg->ExecuteLoop(tid, false);
-			#endif
+			RunTaskGroup(tg, tid, async);
 		}
 
 		#ifdef USE_BOOST_LOCKFREE_QUEUE
@@ -179,21 +250,7 @@ static bool DoTask(int tid, bool async)
 		while (queue.try_dequeue(tg)) {
 		#endif
 			assert(!async || tg->IsAsyncTask());
-
-			#ifdef USE_TASK_STATS_TRACKING
-			const uint64_t wdt = tg->GetDeltaTime(spring_now());
-			const uint64_t edt = tg->ExecuteLoop(tid, false);
-
-			threadStats[async][tid].numTasksRun += 1;
-			threadStats[async][tid].sumExecTime += edt;
-			threadStats[async][tid].sumWaitTime += wdt;
-			threadStats[async][tid].minExecTime  = std::min(threadStats[async][tid].minExecTime, edt);
-			threadStats[async][tid].maxExecTime  = std::max(threadStats[async][tid].maxExecTime, edt);
-			threadStats[async][tid].minWaitTime  = std::min(threadStats[async][tid].minWaitTime, wdt);
-			threadStats[async][tid].maxWaitTime  = std::max(threadStats[async][tid].maxWaitTime, wdt);
-			#else
-			tg->ExecuteLoop(tid, false);
-			#endif
+			RunTaskGroup(tg, tid, async);
 		}
 	}
 
@@ -202,6 +259,56 @@ static bool DoTask(int tid, bool async)
 }
 
 
+static bool DoStolenTask(int tid)
+{
+	ITaskGroup* tg = nullptr;
+
+	// own deque first (newest task, likely still in cache)
+	if (ownDeque != nullptr && ownDeque->Pop(tg)) {
+		RunTaskGroup(tg, tid, false);
+		return true;
+	}
+
+	// then pinned and injected tasks
+	if (DoQueuedTask(tid, false))
+		return true;
+
+	const int numWorkers = GetNumThreads() - 1;
+
+	// finally raid the other workers, starting next to ourselves
+	// so thieves do not all converge on the same victim deque
+	for (int n = 0; n < numWorkers; n++) {
+		const int victim = 1 + (tid + n) % numWorkers;
+
+		if (&workerDeques[victim] == ownDeque)
+			continue;
+		if (!workerDeques[victim].Steal(tg))
+			continue;
+
+		#ifdef USE_TASK_STATS_TRACKING
+		threadStats[false][tid].numTasksStolen += 1;
+		#endif
+
+		RunTaskGroup(tg, tid, false);
+		return true;
+	}
+
+	return false;
+}
+
+static bool DoTask(int tid, bool async)
+{
+	#ifndef UNIT_TEST
+	SCOPED_MT_TIMER("ThreadPool::RunTask");
+	#endif
+
+	if (workStealing && !async)
+		return (DoStolenTask(tid));
+
+	return (DoQueuedTask(tid, async));
+}
+
+
 __FORCE_ALIGN_STACK__
 static void WorkerLoop(int tid, bool async)
 {
@@ -211,6 +318,21 @@ static void WorkerLoop(int tid, bool async)
 	Threading::SetThreadName(IntToString(tid, "worker%i"));
 	#endif
 
+	if (!async)
+		ownDeque = &workerDeques[tid];
+	if (async && backgroundPriority)
+		Threading::SetThreadBackgroundPriority();
+
+	std::uint32_t affinityGen = 0;
+
+	const auto UpdateAffinity = [&]() {
+		if (!async || affinityGen == backgroundAffinityGen.load(std::memory_order_acquire))
+			return;
+
+		affinityGen = backgroundAffinityGen.load(std::memory_order_acquire);
+		Threading::SetAffinity(backgroundAffinity.load(std::memory_order_relaxed));
+	};
+
 	// make first worker spin a while before sleeping/waiting on the thread signal
 	// this increases the chance that at least one worker is awake when a new task
 	// is inserted, which can then take over the job of waking up sleeping workers
@@ -227,6 +349,7 @@ static void WorkerLoop(int tid, bool async)
 			if (spring_now() < spinlockEnd)
 				continue;
 
+			UpdateAffinity();
 			newTasksSignal[async].wait_for(sleepTime = std::min(sleepTime * 1.25f, maxSleepTime));
 		}
 	}
@@ -300,6 +423,16 @@ void PushTaskGroup(ITaskGroup* taskGroup)
 {
 	auto& queue = taskQueues[ taskGroup->IsAsyncTask() ][ taskGroup->WantedThread() ];
 
+	// unpinned tasks spawned by a worker stay local unless its deque is full
+	if (workStealing && ownDeque != nullptr && !taskGroup->IsAsyncTask() && taskGroup->WantedThread() == 0) {
+		taskGroup->SetTimeStamp(spring_now());
+
+		if (ownDeque->Push(taskGroup)) {
+			NotifyWorkerThreads(false, false);
+			return;
+		}
+	}
+
 	#if 0
 	// fake single-task group, handled by WaitForFinished to
 	// avoid a (delete) race-condition between it and DoTask
@@ -408,6 +541,8 @@ static void KillThreads(int wantedNumThreads, int curNumThreads)
 		while (taskQueues[false][i].try_dequeue(tg));
 		while (taskQueues[ true][i].try_dequeue(tg));
 		#endif
+
+		while (workerDeques[i].Steal(tg));
 	}
 
 	assert((wantedNumThreads != 0) || workerThreads[false].empty());
@@ -456,10 +591,10 @@ void SetThreadCount(int wantedNumThreads)
 	const int wtdNumThreads = Clamp(wantedNumThreads, 1, GetMaxThreads());
 
 	constexpr const char* fmts[] = {
-		"[ThreadPool::%s][1] wanted=%d current=%d maximum=%d (init=%d)",
+		"[ThreadPool::%s][1] wanted=%d current=%d maximum=%d (init=%d, stealing=%d)",
 		"[ThreadPool::%s][2] workers=%lu",
 		"\t[async=%d] threads=%d tasks=%lu {sum,avg}{exec,wait}time={{%.3f, %.3f}, {%.3f, %.3f}}ms",
-		"\t\tthread=%d tasks=%lu {sum,min,max,avg}{exec,wait}time={{%.3f, %.3f, %.3f, %.3f}, {%.3f, %.3f, %.3f, %.3f}}ms",
+		"\t\tthread=%d tasks=%lu stolen=%lu {sum,min,max,avg}{exec,wait}time={{%.3f, %.3f, %.3f, %.3f}, {%.3f, %.3f, %.3f, %.3f}}ms",
 	};
 
 	// total number of tasks executed by pool; total time spent in DoTask
@@ -467,7 +602,7 @@ void SetThreadCount(int wantedNumThreads)
 	uint64_t pSumExecTimes[2] = {0lu, 0lu};
 	uint64_t pSumWaitTimes[2] = {0lu, 0lu};
 
-	LOG(fmts[0], __func__, wantedNumThreads, curNumThreads, GetMaxThreads(), workerThreads[false].empty());
+	LOG(fmts[0], __func__, wantedNumThreads, curNumThreads, GetMaxThreads(), workerThreads[false].empty(), workStealing);
 
 	if (workerThreads[false].empty()) {
 		assert(workerThreads[true].empty());
@@ -487,6 +622,7 @@ void SetThreadCount(int wantedNumThreads)
 				threadStats[async][i].sumWaitTime = std::numeric_limits<uint64_t>::min();
 				threadStats[async][i].minWaitTime = std::numeric_limits<uint64_t>::max();
 				threadStats[async][i].maxWaitTime = std::numeric_limits<uint64_t>::min();
+				threadStats[async][i].numTasksStolen = std::numeric_limits<uint64_t>::min();
 			}
 		}
 		#endif
@@ -551,7 +687,7 @@ void SetThreadCount(int wantedNumThreads)
 				const float tAvgExecTime = tSumExecTime / std::max(ts.numTasksRun, uint64_t(1));
 				const float tAvgWaitTime = tSumWaitTime / std::max(ts.numTasksRun, uint64_t(1));
 
-				LOG(fmts[3], i, ts.numTasksRun,  tSumExecTime, tMinExecTime, tMaxExecTime, tAvgExecTime,  tSumWaitTime, tMinWaitTime, tMaxWaitTime, tAvgWaitTime);
+				LOG(fmts[3], i, ts.numTasksRun, ts.numTasksStolen,  tSumExecTime, tMinExecTime, tMaxExecTime, tAvgExecTime,  tSumWaitTime, tMinWaitTime, tMaxWaitTime, tAvgWaitTime);
 			}
 		}
 	}
@@ -578,6 +714,9 @@ void SetMaximumThreadCount()
 	if (GetConfigNumWorkers() <= 0)
 		return;
 
+	if (!HasThreads())
+		SetWorkStealing(GetConfigWorkStealing());
+
 	SetThreadCount(GetMaxThreads());
 }
 
@@ -590,9 +729,33 @@ void SetDefaultThreadCount()
 	mainAffinity &= configHandler->GetUnsigned("SetCoreAffinity");
 	#endif
 
+	// reserve a whole physical core for the main thread, so neither sync nor
+	// async workers (nor their hyperthreads) compete with the sim and draw
+	// loops; with fewer cores the workers would be starved instead
+	if (mainAffinity == 0 && GetConfigReserveMainCore() && Threading::GetPhysicalCpuCores() >= 4) {
+		mainAffinity = Threading::GetCoreSiblingsMask(systemCores & (~systemCores + 1)) & systemCores;
+
+		LOG("[ThreadPool::%s] reserved core mask %u for the main thread", __func__, mainAffinity);
+	}
+
 	std::uint32_t workerAvailCores = systemCores & ~mainAffinity;
+	std::uint32_t asyncAvailCores = systemCores & ~mainAffinity;
+
+	if (GetConfigWorkerAffinity(false) != 0)
+		workerAvailCores = systemCores & GetConfigWorkerAffinity(false);
+	if (GetConfigWorkerAffinity(true) != 0)
+		asyncAvailCores = systemCores & GetConfigWorkerAffinity(true);
+
+	// background workers float over their cores; (re)applied by WorkerLoop
+	backgroundAffinity.store((asyncAvailCores != 0)? asyncAvailCores: systemCores, std::memory_order_relaxed);
+	backgroundAffinityGen.fetch_add(1, std::memory_order_release);
+	backgroundPriority = GetConfigBackgroundPriority();
+
+	if (!HasThreads())
+		SetWorkStealing(GetConfigWorkStealing());
 
 	SetThreadCount(GetDefaultNumWorkers());
+	NotifyWorkerThreads(true, true);
 
 	{
 		// parallel_reduce now folds over shared_ptrs to futures
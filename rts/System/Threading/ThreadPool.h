@@ -26,6 +26,8 @@ namespace ThreadPool {
 	static inline int GetNumThreads() { return 1; }
 	static inline void NotifyWorkerThreads(bool force, bool async) {}
 	static inline bool HasThreads() { return false; }
+	static inline bool UseWorkStealing() { return false; }
+	static inline void SetWorkStealing(bool enable) {}
 
 	static constexpr int MAX_THREADS = 1;
 }
@@ -105,6 +107,9 @@ namespace ThreadPool {
 	void SetThreadCount(int num);
 	int GetThreadNum();
 	bool HasThreads();
+	// selects the work-stealing scheduler; only allowed while the pool is empty
+	bool UseWorkStealing();
+	void SetWorkStealing(bool enable);
 	int GetMaxThreads();
 	int GetNumThreads();
 	void NotifyWorkerThreads(bool force, bool async);
@@ -705,8 +710,10 @@ static inline void for_mt(int start, int end, int step, F&& f)
 	ThreadPool::PushTaskGroup(taskGroup);
 	#else
 	// store the group in all worker queues s.t. each executes a slice
+	// when work-stealing, leave the slices unpinned so that whichever
+	// workers are idle pick them up instead of waiting on busy ones
 	for (size_t i = 1; i < ThreadPool::GetNumThreads(); ++i) {
-		taskGroup->wantedThread.store(i);
+		taskGroup->wantedThread.store(i * (1 - ThreadPool::UseWorkStealing()));
 		ThreadPool::PushTaskGroup(taskGroup);
 	}
 	#endif
@@ -729,9 +736,13 @@ static inline void for_mt_chunk(int b, int e, F&& f, int chunkOrMinChinkSize = 0
 
 	const int numElems  = e - b;
 
+	// with work-stealing, oversplit so that threads which finish their
+	// chunks early can keep pulling more instead of idling at the end
+	const int numSplits = maxThreads * (1 + 3 * ThreadPool::UseWorkStealing());
+
 	int chunkSize = chunkOrMinChinkSize;
 	if (chunkOrMinChinkSize <= 0) {
-		chunkSize = numElems / maxThreads + (numElems % maxThreads != 0); //split the work evenly. Does for_mt() do the same?
+		chunkSize = numElems / numSplits + (numElems % numSplits != 0); //split the work evenly. Does for_mt() do the same?
 		chunkSize = std::max(chunkSize, -chunkOrMinChinkSize);
 	}
 	chunkSize = std::max(chunkSize, 1);
@@ -745,6 +756,19 @@ static inline void for_mt_chunk(int b, int e, F&& f, int chunkOrMinChinkSize = 0
 		return;
 	}
 
+	if (ThreadPool::UseWorkStealing()) {
+		// hand out chunks dynamically rather than a fixed range per thread
+		for_mt(0, numChunks, 1, [&f, b, e, chunkSize](const int chunkId) {
+			const int bb = b + chunkId * chunkSize;
+			const int ee = std::min(bb + chunkSize, e);
+
+			for (int i = bb; i < ee; ++i)
+				std::forward<F>(f)(i);
+		});
+
+		return;
+	}
+
 	const int chunksPerThread = numChunks / maxThreads + (numChunks % maxThreads != 0);
 	const int numThreads = std::min(numChunks, maxThreads);
 
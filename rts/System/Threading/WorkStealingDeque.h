@@ -0,0 +1,98 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef WORKSTEALINGDEQUE_H
+#define WORKSTEALINGDEQUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// fixed-capacity Chase-Lev deque (see "Correct and Efficient Work-Stealing
+// for Weak Memory Models", Le et al. 2013); the owning thread pushes and
+// pops at the bottom, any other thread may steal from the top
+//
+// Push fails instead of growing the ring when the deque is full, callers
+// are expected to fall back to a shared queue in that case
+template<typename T, size_t N = 1024>
+class WorkStealingDeque {
+public:
+	static_assert((N & (N - 1)) == 0, "WorkStealingDeque capacity must be a power of two");
+	static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque items must be trivially copyable");
+
+	// owner only
+	bool Push(T item) {
+		const int64_t b = bottom.load(std::memory_order_relaxed);
+		const int64_t t = top.load(std::memory_order_acquire);
+
+		if ((b - t) >= int64_t(N))
+			return false;
+
+		items[b & MASK].store(item, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// owner only, LIFO
+	bool Pop(T& item) {
+		const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		if (t > b) {
+			// empty
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		item = items[b & MASK].load(std::memory_order_relaxed);
+
+		if (t != b)
+			return true;
+
+		// single remaining item, race against thieves for it
+		const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	// any thread, FIFO; can fail spuriously if another thief wins the race
+	bool Steal(T& item) {
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t b = bottom.load(std::memory_order_acquire);
+
+		if (t >= b)
+			return false;
+
+		item = items[t & MASK].load(std::memory_order_relaxed);
+		return (top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed));
+	}
+
+	// approximate when called concurrently
+	size_t Size() const {
+		const int64_t b = bottom.load(std::memory_order_relaxed);
+		const int64_t t = top.load(std::memory_order_relaxed);
+		return ((b > t)? (b - t): 0);
+	}
+
+	bool Empty() const { return (Size() == 0); }
+
+	static constexpr size_t Capacity() { return N; }
+
+private:
+	static constexpr int64_t MASK = N - 1;
+
+	// keep the owner- and thief-side indices on separate cache-lines
+	alignas(64) std::atomic<int64_t> top = {0};
+	alignas(64) std::atomic<int64_t> bottom = {0};
+	alignas(64) std::array<std::atomic<T>, N> items;
+};
+
+#endif
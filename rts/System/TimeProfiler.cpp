@@ -2,11 +2,16 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdio>
 #include <cstring>
+#include <limits>
+#include <memory>
+#include <ostream>
 
 #include "System/TimeProfiler.h"
 #include "System/GlobalRNG.h"
 #include "System/StringHash.h"
+#include "System/StringUtil.h"
 #include "System/Log/ILog.h"
 #include "System/Threading/SpringThreading.h"
 
@@ -25,6 +30,59 @@ static spring::unordered_map<unsigned, int> refCounters;
 static CGlobalUnsyncedRNG profileColorRNG;
 
 
+struct TraceEvent {
+	unsigned nameHash;
+
+	int64_t startTime; // ns
+	int64_t endTime; // ns
+};
+
+// single-writer ring, only the owning thread appends to it
+struct TraceBuffer {
+	static constexpr size_t NUM_EVENTS = 1 << 16;
+
+	std::vector<TraceEvent> events;
+	std::atomic<size_t> numEvents = {0}; // total appended, wraps around <events>
+
+	int threadNum = 0; // ThreadPool number of the owning thread
+	bool gpuTimeline = false;
+};
+
+// timings of one thread, recorded without taking profileMutex while the
+// profiler is enabled; single-producer ring, the owning thread appends
+// and FlushSamplesRaw consumes (with profileMutex held)
+struct SampleBuffer {
+	static constexpr size_t NUM_SAMPLES = 1 << 12;
+
+	struct Sample {
+		unsigned nameHash;
+
+		spring_time startTime;
+		spring_time deltaTime;
+
+		bool showGraph;
+		bool threadTimer;
+	};
+
+	std::vector<Sample> samples;
+	std::atomic<size_t> numWritten = {0};
+	std::atomic<size_t> numRead = {0};
+
+	int threadNum = 0; // ThreadPool number of the owning thread
+};
+
+// guarded by profileMutex
+static std::vector< std::unique_ptr<SampleBuffer> > sampleBuffers;
+static thread_local SampleBuffer* threadSampleBuffer = nullptr;
+
+
+static spring::mutex traceBufferMutex;
+static std::vector< std::unique_ptr<TraceBuffer> > traceBuffers;
+static thread_local TraceBuffer* threadTraceBuffer = nullptr;
+// written by the render thread only, see GL::GPUTimerQueries
+static TraceBuffer* gpuTraceBuffer = nullptr;
+
+
 spring_time BasicTimer::GetDuration() const
 {
 	return spring_difftime(spring_gettime(), startTime);
@@ -54,6 +112,9 @@ ScopedTimer::~ScopedTimer()
 	assert(iter != refCounters.end());
 	assert(iter->second > 0);
 
+	if (profiler.IsTracing())
+		profiler.AddTraceEvent(nameHash, startTime, spring_gettime());
+
 	if (--(iter->second) == 0) {
 		profiler.AddTime(nameHash, startTime, GetDuration(), autoShowGraph, specialTimer, false);
 	}
@@ -99,6 +160,9 @@ ScopedMtTimer::ScopedMtTimer(unsigned _nameHash, bool _autoShowGraph)
 
 ScopedMtTimer::~ScopedMtTimer()
 {
+	if (profiler.IsTracing())
+		profiler.AddTraceEvent(nameHash, startTime, spring_gettime());
+
 	profiler.AddTime(nameHash, startTime, GetDuration(), autoShowGraph, false, true);
 }
 
@@ -180,6 +244,12 @@ void CTimeProfiler::ResetState() {
 	profiles.clear();
 	profiles.reserve(128);
 	sortedProfiles.clear();
+	counters.clear();
+
+	// drop whatever was queued before the reset
+	for (const auto& buffer: sampleBuffers) {
+		buffer->numRead.store(buffer->numWritten.load(std::memory_order_acquire), std::memory_order_release);
+	}
 	#ifdef THREADPOOL
 	threadProfiles.clear();
 	threadProfiles.resize(ThreadPool::GetMaxThreads());
@@ -215,6 +285,7 @@ void CTimeProfiler::Update()
 	// FIXME: non-locking threadsafe
 	std::lock_guard<ProfileMutexType> lock(profileMutex);
 
+	FlushSamplesRaw();
 	UpdateRaw();
 	ResortProfilesRaw();
 	RefreshProfilesRaw();
@@ -304,9 +375,32 @@ void CTimeProfiler::RefreshProfiles()
 	// lock so nothing modifies *unsorted* profiles during the refresh
 	std::lock_guard<ProfileMutexType> lock(profileMutex);
 
+	FlushSamplesRaw();
+	ResortProfilesRaw();
 	RefreshProfilesRaw();
 }
 
+void CTimeProfiler::FlushSamplesRaw()
+{
+	const spring_time t0 = spring_now();
+
+	for (const auto& buffer: sampleBuffers) {
+		const size_t numWritten = buffer->numWritten.load(std::memory_order_acquire);
+		const size_t numRead = buffer->numRead.load(std::memory_order_relaxed);
+
+		for (size_t i = numRead; i < numWritten; ++i) {
+			const SampleBuffer::Sample& s = buffer->samples[i & (SampleBuffer::NUM_SAMPLES - 1)];
+
+			AddTimeRaw(s.nameHash, s.startTime, s.deltaTime, s.showGraph, s.threadTimer, buffer->threadNum);
+		}
+
+		// hand the slots back to the owner
+		buffer->numRead.store(numWritten, std::memory_order_release);
+	}
+
+	AddTimeRaw(hashString("Misc::Profiler::AddTime"), t0, spring_now() - t0, false, false);
+}
+
 void CTimeProfiler::RefreshProfilesRaw()
 {
 	// either called from ProfileDrawer or from Update; the latter
@@ -331,6 +425,8 @@ const CTimeProfiler::TimeRecord& CTimeProfiler::GetTimeRecord(const char* name)
 
 	std::lock_guard<ProfileMutexType> lock(profileMutex);
 
+	// not const, but queued samples are logically part of the records
+	const_cast<CTimeProfiler*>(this)->FlushSamplesRaw();
 	return (GetTimeRecordRaw(name));
 }
 
@@ -355,12 +451,33 @@ void CTimeProfiler::AddTime(
 		return;
 	}
 
-	// acquire lock at the start; one inserting thread could
-	// cause a profile rehash and invalidate <pi> for another
-	std::lock_guard<ProfileMutexType> lock(profileMutex);
+	// queue the sample in this thread's ring rather than locking and
+	// inserting it right away, the lock would serialize all timed code
+	// and distort the very measurements; Update and RefreshProfiles pick
+	// the samples up
+	if (threadSampleBuffer == nullptr) {
+		std::lock_guard<ProfileMutexType> lock(profileMutex);
+
+		sampleBuffers.emplace_back(new SampleBuffer());
+		threadSampleBuffer = sampleBuffers.back().get();
+		threadSampleBuffer->samples.resize(SampleBuffer::NUM_SAMPLES);
+		#ifdef THREADPOOL
+		threadSampleBuffer->threadNum = ThreadPool::GetThreadNum();
+		#endif
+	}
 
-	AddTimeRaw(nameHash, startTime, deltaTime, showGraph, threadTimer);
-	AddTimeRaw(hashString("Misc::Profiler::AddTime"), t0, spring_now() - t0, false, false);
+	SampleBuffer* buffer = threadSampleBuffer;
+
+	const size_t n = buffer->numWritten.load(std::memory_order_relaxed);
+
+	if ((n - buffer->numRead.load(std::memory_order_acquire)) >= SampleBuffer::NUM_SAMPLES) {
+		// ring is full, make room by flushing it (and all others) ourselves
+		std::lock_guard<ProfileMutexType> lock(profileMutex);
+		FlushSamplesRaw();
+	}
+
+	buffer->samples[n & (SampleBuffer::NUM_SAMPLES - 1)] = {nameHash, startTime, deltaTime, showGraph, threadTimer};
+	buffer->numWritten.store(n + 1, std::memory_order_release);
 }
 
 void CTimeProfiler::AddTimeRaw(
@@ -368,11 +485,12 @@ void CTimeProfiler::AddTimeRaw(
 	const spring_time startTime,
 	const spring_time deltaTime,
 	const bool showGraph,
-	const bool threadTimer
+	const bool threadTimer,
+	const int threadNum
 ) {
 #ifdef THREADPOOL
 	if (threadTimer)
-		threadProfiles[ThreadPool::GetThreadNum()].emplace_back(startTime, spring_gettime());
+		threadProfiles[(threadNum >= 0)? threadNum: ThreadPool::GetThreadNum()].emplace_back(startTime, startTime + deltaTime);
 #endif
 
 	auto pi = profiles.find(nameHash);
@@ -412,5 +530,223 @@ void CTimeProfiler::PrintProfilingInfo() const
 
 		LOG("%35s %16.2fms %5.2f%%", name.c_str(), tr.total.toMilliSecsf(), tr.stats.y * 100);
 	}
+
+	std::vector< std::pair<const char*, uint64_t> > sortedCounters;
+
+	{
+		std::lock_guard<ProfileMutexType> lock(profileMutex);
+
+		sortedCounters.reserve(counters.size());
+
+		for (const auto& counter: counters) {
+			sortedCounters.push_back(counter.second);
+		}
+	}
+
+	if (sortedCounters.empty())
+		return;
+
+	std::sort(sortedCounters.begin(), sortedCounters.end(), [](const auto& a, const auto& b) { return (strcmp(a.first, b.first) < 0); });
+
+	LOG("%35s|%18s", "Counter", "Total Count");
+
+	for (const auto& counter: sortedCounters) {
+		LOG("%35s %18lu", counter.first, static_cast<unsigned long>(counter.second));
+	}
+}
+
+void CTimeProfiler::OutputJSON(std::ostream& out) const
+{
+	std::vector< std::pair<std::string, spring_time> > sortedTimers;
+	std::vector< std::pair<const char*, uint64_t> > sortedCounters;
+
+	{
+		std::lock_guard<ProfileMutexType> lock(profileMutex);
+		std::lock_guard<HashNamMutexType> nameLock(hashToNameMutex);
+
+		const_cast<CTimeProfiler*>(this)->FlushSamplesRaw();
+
+		sortedTimers.reserve(profiles.size());
+		sortedCounters.reserve(counters.size());
+
+		for (const auto& profile: profiles) {
+			const auto iter = hashToName.find(profile.first);
+
+			if (iter == hashToName.end())
+				continue;
+
+			sortedTimers.emplace_back(iter->second, profile.second.total);
+		}
+
+		for (const auto& counter: counters) {
+			sortedCounters.push_back(counter.second);
+		}
+	}
+
+	std::sort(sortedTimers.begin(), sortedTimers.end(), [](const auto& a, const auto& b) { return (a.first < b.first); });
+	std::sort(sortedCounters.begin(), sortedCounters.end(), [](const auto& a, const auto& b) { return (strcmp(a.first, b.first) < 0); });
+
+	out << "{\"timers\": {";
+
+	for (size_t i = 0; i < sortedTimers.size(); i++) {
+		out << ((i == 0)? "\n": ",\n") << Quote(sortedTimers[i].first) << ": " << sortedTimers[i].second.toMilliSecsf();
+	}
+
+	out << "\n}, \"counters\": {";
+
+	for (size_t i = 0; i < sortedCounters.size(); i++) {
+		out << ((i == 0)? "\n": ",\n") << Quote(sortedCounters[i].first) << ": " << sortedCounters[i].second;
+	}
+
+	out << "\n}}";
+}
+
+
+void CTimeProfiler::AddCounter(const char* name, uint64_t count)
+{
+	std::lock_guard<ProfileMutexType> lock(profileMutex);
+
+	const unsigned nameHash = hashString(name);
+	const auto iter = counters.find(nameHash);
+
+	if (iter == counters.end()) {
+		counters[nameHash] = {name, count};
+		return;
+	}
+
+	iter->second.second += count;
+}
+
+uint64_t CTimeProfiler::GetCounter(const char* name) const
+{
+	std::lock_guard<ProfileMutexType> lock(profileMutex);
+
+	const auto iter = counters.find(hashString(name));
+
+	if (iter == counters.end())
+		return 0;
+
+	return (iter->second.second);
+}
+
+
+
+void CTimeProfiler::SetTracing(bool b)
+{
+	if (b == tracing)
+		return;
+
+	if (b) {
+		// start each recording from empty rings
+		std::lock_guard<spring::mutex> lock(traceBufferMutex);
+
+		for (const auto& buffer: traceBuffers) {
+			buffer->numEvents = 0;
+		}
+	}
+
+	tracing = b;
+}
+
+void CTimeProfiler::AddTraceEvent(unsigned nameHash, const spring_time startTime, const spring_time endTime)
+{
+	if (threadTraceBuffer == nullptr) {
+		std::lock_guard<spring::mutex> lock(traceBufferMutex);
+
+		traceBuffers.emplace_back(new TraceBuffer());
+		threadTraceBuffer = traceBuffers.back().get();
+		threadTraceBuffer->events.resize(TraceBuffer::NUM_EVENTS);
+		#ifdef THREADPOOL
+		threadTraceBuffer->threadNum = ThreadPool::GetThreadNum();
+		#endif
+	}
+
+	const size_t n = threadTraceBuffer->numEvents.load(std::memory_order_relaxed);
+
+	threadTraceBuffer->events[n & (TraceBuffer::NUM_EVENTS - 1)] = {nameHash, startTime.toNanoSecsi(), endTime.toNanoSecsi()};
+	threadTraceBuffer->numEvents.store(n + 1, std::memory_order_release);
+}
+
+void CTimeProfiler::AddGPUTraceEvent(unsigned nameHash, const spring_time startTime, const spring_time endTime)
+{
+	if (gpuTraceBuffer == nullptr) {
+		std::lock_guard<spring::mutex> lock(traceBufferMutex);
+
+		traceBuffers.emplace_back(new TraceBuffer());
+		gpuTraceBuffer = traceBuffers.back().get();
+		gpuTraceBuffer->events.resize(TraceBuffer::NUM_EVENTS);
+		gpuTraceBuffer->gpuTimeline = true;
+	}
+
+	const size_t n = gpuTraceBuffer->numEvents.load(std::memory_order_relaxed);
+
+	gpuTraceBuffer->events[n & (TraceBuffer::NUM_EVENTS - 1)] = {nameHash, startTime.toNanoSecsi(), endTime.toNanoSecsi()};
+	gpuTraceBuffer->numEvents.store(n + 1, std::memory_order_release);
 }
 
+bool CTimeProfiler::WriteTrace(const std::string& fileName) const
+{
+	FILE* file = fopen(fileName.c_str(), "w");
+
+	if (file == nullptr)
+		return false;
+
+	std::lock_guard<spring::mutex> lock(traceBufferMutex);
+	std::lock_guard<HashNamMutexType> nameLock(hashToNameMutex);
+
+	// emit timestamps relative to the earliest recorded scope; events are
+	// appended when scopes end, so this is not necessarily the oldest one
+	int64_t baseTime = std::numeric_limits<int64_t>::max();
+
+	for (const auto& buffer: traceBuffers) {
+		const size_t numEvents = std::min(buffer->numEvents.load(std::memory_order_acquire), TraceBuffer::NUM_EVENTS);
+
+		for (size_t i = 0; i < numEvents; ++i) {
+			baseTime = std::min(baseTime, buffer->events[i].startTime);
+		}
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	const char* sep = "";
+	char hashName[16];
+
+	for (size_t tid = 0; tid < traceBuffers.size(); ++tid) {
+		const TraceBuffer* buffer = traceBuffers[tid].get();
+
+		const size_t numEvents = buffer->numEvents.load(std::memory_order_acquire);
+		const size_t oldestIdx = (numEvents > TraceBuffer::NUM_EVENTS)? (numEvents - TraceBuffer::NUM_EVENTS): 0;
+
+		if (buffer->gpuTimeline) {
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}\n", sep, unsigned(tid));
+		} else {
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"thread %u (pool %d)\"}}\n", sep, unsigned(tid), unsigned(tid), buffer->threadNum);
+		}
+		sep = ",";
+
+		for (size_t i = oldestIdx; i < numEvents; ++i) {
+			const TraceEvent& event = buffer->events[i & (TraceBuffer::NUM_EVENTS - 1)];
+			const auto iter = hashToName.find(event.nameHash);
+
+			// SCOPED_MT_TIMER names are not registered
+			const char* name = hashName;
+
+			if (iter != hashToName.end()) {
+				name = iter->second.c_str();
+			} else {
+				snprintf(hashName, sizeof(hashName), "%u", event.nameHash);
+			}
+
+			fprintf(file, ",{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}\n",
+				name,
+				unsigned(tid),
+				(event.startTime - baseTime) * 1e-3,
+				(event.endTime - event.startTime) * 1e-3
+			);
+		}
+	}
+
+	fprintf(file, "]}\n");
+	fclose(file);
+	return true;
+}
@@ -4,6 +4,8 @@
 #define TIME_PROFILER_H
 
 #include <atomic>
+#include <cstdint>
+#include <iosfwd>
 #include <string>
 #include <deque>
 #include <vector>
@@ -163,9 +165,32 @@ public:
 	void ResortProfilesRaw();
 	void RefreshProfiles();
 	void RefreshProfilesRaw();
+	// moves the samples AddTime queued per thread into the profiles,
+	// caller must hold the profile lock (see ToggleLock)
+	void FlushSamplesRaw();
 
 	void SetEnabled(bool b) { enabled = b; }
+	bool IsEnabled() const { return enabled; }
 	void PrintProfilingInfo() const;
+	// totals of all timers (in ms) and counters as a JSON object, sorted by name
+	void OutputJSON(std::ostream& out) const;
+
+	// plain event counters (e.g. cache hits and misses), printed along with
+	// the timers; unlike those they are not windowed and only reset by
+	// ResetState
+	void AddCounter(const char* name, uint64_t count);
+	uint64_t GetCounter(const char* name) const;
+
+	// timeline recording of every (MT-)timer scope into a per-thread ring
+	// buffer, exportable as a Chrome trace (chrome://tracing, Perfetto) JSON
+	// file; costs one relaxed atomic load per scope while not recording
+	void SetTracing(bool b);
+	bool IsTracing() const { return (tracing.load(std::memory_order_relaxed)); }
+	bool WriteTrace(const std::string& fileName) const;
+
+	void AddTraceEvent(unsigned nameHash, const spring_time startTime, const spring_time endTime);
+	// GPU scopes go into a timeline of their own, their spans do not nest with the CPU ones
+	void AddGPUTraceEvent(unsigned nameHash, const spring_time startTime, const spring_time endTime);
 
 	void AddTime(
 		unsigned nameHash,
@@ -180,7 +205,8 @@ public:
 		const spring_time startTime,
 		const spring_time deltaTime,
 		const bool showGraph,
-		const bool threadTimer
+		const bool threadTimer,
+		const int threadNum = -1
 	);
 
 private:
@@ -189,6 +215,9 @@ private:
 	std::vector< std::pair<std::string, TimeRecord> > sortedProfiles;
 	std::vector< std::deque< std::pair<spring_time, spring_time> > > threadProfiles;
 
+	// names are literals, same as for timers
+	spring::unordered_map<unsigned, std::pair<const char*, uint64_t> > counters;
+
 	spring_time lastBigUpdate;
 
 	/// increases each update, from 0 to (numFrames-1)
@@ -197,6 +226,8 @@ private:
 
 	// if false, AddTime is a no-op for (almost) all timers
 	std::atomic<bool> enabled;
+	// if false, AddTraceEvent is never called; independent of <enabled>
+	std::atomic<bool> tracing = {false};
 };
 
 
@@ -82,11 +82,15 @@ static void WriteZStr(std::ostream& file, const std::string& str)
 template<typename T>
 void ReadVarSizeUInt(std::istream* stream, T* buf)
 {
+	// bypass the istream sentry, this is called for every integer and pointer
+	std::streambuf* sbuf = stream->rdbuf();
 	std::uint64_t val = 0;
 	unsigned offset = 0;
 	while (true) {
-		unsigned char a;
-		stream->read((char*)&a, sizeof(char));
+		const int a = sbuf->sbumpc();
+
+		if (a == std::streambuf::traits_type::eof())
+			throw content_error("Unexpected end of object package");
 
 		val += ((std::uint64_t)(a & 0x7F)) << offset;
 		if ((a & 0x80) == 0)
@@ -101,6 +105,8 @@ void ReadVarSizeUInt(std::istream* stream, T* buf)
 template<typename T>
 void WriteVarSizeUInt(std::ostream* stream, T val)
 {
+	char bytes[(sizeof(std::uint64_t) * 8 + 6) / 7];
+	std::streamsize size = 0;
 	std::uint64_t v = val;
 	do {
 		unsigned char a = v & 0x7F;
@@ -109,8 +115,10 @@ void WriteVarSizeUInt(std::ostream* stream, T val)
 		if (v > 0)
 			a |= 0x80;
 
-		stream->write((char*)&a, sizeof(char));
+		bytes[size++] = a;
 	} while (v > 0);
+
+	stream->write(bytes, size);
 }
 
 void creg::ReadUInt(std::istream* stream, std::uint64_t* buf)
@@ -148,49 +156,27 @@ COutputStreamSerializer::ObjectRef* COutputStreamSerializer::FindObjectRef(void*
 
 void COutputStreamSerializer::SerializeObject(Class* c, void* ptr, ObjectRef* objr)
 {
-	const unsigned objstart = stream->tellp();
+	const unsigned objstart = collectStats? unsigned(stream->tellp()): 0u;
 
 	if (c->base())
 		SerializeObject(c->base(), ptr, objr);
 
-	ObjectMemberGroup omg;
-	omg.membersClass = c;
-	omg.size = 0;
-
 	for (uint a = 0; a < c->members.size(); a++)
 	{
 		creg::Class::Member* m = &c->members[a];
 		if (m->flags & CM_NoSerialize)
 			continue;
 
-		ObjectMember om;
-		om.member = m;
-		om.memberId = a;
 		void* memberAddr = ((char*)ptr) + m->offset;
-		unsigned mstart = stream->tellp();
 		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s", c->name, m->name, m->type->GetName().c_str());
 		m->type->Serialize(this, memberAddr);
-		unsigned mend = stream->tellp();
-		om.size = mend - mstart;
-		omg.members.push_back(om);
-		omg.size += om.size;
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s size:%d", c->name, m->name, m->type->GetName().c_str(), om.size);
 	}
 
-
-	if (c->HasSerialize()) {
-		ObjectMember om;
-		om.member = nullptr;
-		om.memberId = -1;
-		unsigned mstart = stream->tellp();
+	if (c->HasSerialize())
 		c->CallSerializeProc(ptr, this);
-		unsigned mend = stream->tellp();
-		om.size = mend - mstart;
-		omg.members.push_back(om);
-		omg.size += om.size;
-	}
 
-	objr->memberGroups.push_back(omg);
+	if (!collectStats)
+		return;
 
 	const unsigned objend = stream->tellp();
 	const int sz = objend - objstart;
@@ -208,13 +194,11 @@ void COutputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* o
 		ptrToId[inst].push_back(obj);
 	} else if (obj->isEmbedded) {
 		throw std::string("Reserialization of embedded object (") + objClass->name + ")";
+	} else if (!obj->isPending) {
+		throw std::string("Object pointer was serialized (") + objClass->name + ")";
 	} else {
-		std::vector<ObjectRef*>::iterator it = std::find(pendingObjects.begin(), pendingObjects.end(), obj);
-		if (it == pendingObjects.end()) {
-			throw std::string("Object pointer was serialized (") + objClass->name + ")";
-		} else {
-			pendingObjects.erase(it);
-		}
+		// now saved in place, SavePackage skips it
+		obj->isPending = false;
 	}
 	obj->class_ = objClass;
 	obj->isEmbedded = true;
@@ -237,6 +221,7 @@ void COutputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* objCla
 			obj = &objects.back();
 			ptrToId[*ptr].push_back(obj);
 			pendingObjects.push_back(obj);
+			obj->isPending = true;
 		}
 		id = obj->id;
 
@@ -282,6 +267,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	PackageHeader ph;
 
 	stream = s;
+	collectStats = LOG_IS_ENABLED(L_DEBUG);
 	unsigned startOffset = stream->tellp();
 	stream->write((char*)&ph, sizeof(PackageHeader));
 	stream->seekp(startOffset + sizeof(PackageHeader));
@@ -297,16 +283,25 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	obj = &objects.back();
 	ptrToId[rootObj].push_back(obj);
 	pendingObjects.push_back(obj);
+	obj->isPending = true;
+
+	std::vector<ObjectRef*> po;
 
 	// Save until all the referenced objects have been stored
 	while (!pendingObjects.empty())
 	{
-		const std::vector<ObjectRef*> po = pendingObjects;
-		pendingObjects.clear();
+		po.clear();
+		po.swap(pendingObjects);
+
+		// drop objects saved in place since they were referenced; once in
+		// a batch they are no longer pending and can not be embedded anymore
+		po.erase(std::remove_if(po.begin(), po.end(), [](const ObjectRef* o) { return !o->isPending; }), po.end());
 
+		for (ObjectRef* obj: po) {
+			obj->isPending = false;
+		}
 		for (ObjectRef* obj: po) {
 			SerializeObject(obj->class_, obj->ptr, obj);
-			//LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s size:%i", obj->class_->name.c_str(), sz);
 		}
 	}
 
@@ -388,6 +383,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	pendingObjects.clear();
 	objects.clear();
 	classSizes.clear();
+	classCounts.clear();
 }
 
 //-------------------------------------------------------------------------
@@ -413,31 +409,52 @@ bool CInputStreamSerializer::IsWriting()
 	return false;
 }
 
-void CInputStreamSerializer::SerializeObject(Class* c, void* ptr)
+void CInputStreamSerializer::AddClassLayoutEntries(Class* c, ClassLayout& layout)
 {
 	if (c->base())
-		SerializeObject(c->base(), ptr);
+		AddClassLayoutEntries(c->base(), layout);
 
-	for (uint a = 0; a < c->members.size(); a++)
-	{
-		creg::Class::Member* m = &c->members[a];
-		if (m->flags & CM_NoSerialize)
+	for (creg::Class::Member& m: c->members) {
+		if (m.flags & CM_NoSerialize)
 			continue;
 
-		const unsigned oldPos = stream->tellg();
-		void* memberAddr = ((char*)ptr) + m->offset;
-		m->type->Serialize(this, memberAddr);
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Deserialized %s::%s type:%s size:%u", c->name, m->name, m->type->GetName().c_str(), unsigned(stream->tellg()) - oldPos);
+		layout.push_back({c, &m});
 	}
 
-	if (c->HasSerialize()) {
-		c->CallSerializeProc(ptr, this);
+	if (c->HasSerialize())
+		layout.push_back({c, nullptr});
+}
+
+const CInputStreamSerializer::ClassLayout& CInputStreamSerializer::GetClassLayout(Class* c)
+{
+	const auto iter = classLayoutIndices.find(c);
+
+	if (iter != classLayoutIndices.end())
+		return classLayouts[iter->second];
+
+	classLayoutIndices[c] = classLayouts.size();
+	classLayouts.emplace_back();
+	AddClassLayoutEntries(c, classLayouts.back());
+	return classLayouts.back();
+}
+
+void CInputStreamSerializer::SerializeObject(const ClassLayout& layout, void* ptr)
+{
+	for (const LayoutEntry& e: layout) {
+		if (e.member == nullptr) {
+			e.cls->CallSerializeProc(ptr, this);
+			continue;
+		}
+
+		e.member->type->Serialize(this, ((char*)ptr) + e.member->offset);
+		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Deserialized %s::%s type:%s", e.cls->name, e.member->name, e.member->type->GetName().c_str());
 	}
 }
 
 void CInputStreamSerializer::Serialize(void* data, int byteSize)
 {
-	stream->read((char*)data, byteSize);
+	if (stream->rdbuf()->sgetn((char*)data, byteSize) != byteSize)
+		throw content_error("Unexpected end of object package");
 }
 
 void CInputStreamSerializer::SerializeInt(void* data, int byteSize)
@@ -492,7 +509,7 @@ void CInputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* cl
 	assert(o.isEmbedded);
 
 	o.obj = inst;
-	SerializeObject(cls, inst);
+	SerializeObject(GetClassLayout(cls), inst);
 }
 
 void CInputStreamSerializer::AddPostLoadCallback(void (*cb)(void*), void* ud)
@@ -550,6 +567,12 @@ void CInputStreamSerializer::LoadPackage(std::istream* s, void*& root, creg::Cla
 			throw content_error("Metadata checksum error: Package file was saved with a different version");
 	}
 
+	classRefLayouts.clear();
+	classRefLayouts.reserve(classRefs.size());
+
+	for (Class* classRef: classRefs)
+		classRefLayouts.push_back(&GetClassLayout(classRef));
+
 	// Create all non-embedded objects
 	s->seekg(ph.objTableOffset);
 	objects.resize(ph.numObjects);
@@ -586,9 +609,8 @@ void CInputStreamSerializer::LoadPackage(std::istream* s, void*& root, creg::Cla
 		if (object.isEmbedded)
 			continue;
 
-		creg::Class* cls = classRefs[object.classRef];
-		SerializeObject(cls, object.obj);
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Deserialized %s size:%i", cls->name, cls->size);
+		SerializeObject(*classRefLayouts[object.classRef], object.obj);
+		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Deserialized %s size:%i", classRefs[object.classRef]->name, classRefs[object.classRef]->size);
 	}
 
 	// Fix pointers to embedded objects
@@ -621,6 +643,9 @@ void CInputStreamSerializer::LoadPackage(std::istream* s, void*& root, creg::Cla
 
 	unfixedPointers.clear();
 	objects.clear();
+	classRefLayouts.clear();
+	classLayoutIndices.clear();
+	classLayouts.clear();
 }
 
 ISerializer::~ISerializer() = default;
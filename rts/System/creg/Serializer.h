@@ -13,6 +13,8 @@
 #include <deque>
 #include <istream>
 
+#include "System/UnorderedMap.hpp"
+
 namespace creg {
 
 	/**
@@ -23,43 +25,22 @@ namespace creg {
 	class COutputStreamSerializer : public ISerializer
 	{
 	protected:
-		struct ObjectMember {
-			Class::Member* member;
-			int memberId;
-			int size;
-		};
-		struct ObjectMemberGroup {
-			Class* membersClass;
-			std::vector<COutputStreamSerializer::ObjectMember> members;
-			int size;
-		};
 		struct ObjectRef {
-			ObjectRef() {
-				ptr = 0;
-				id=0;
-				classIndex=0;
-				isEmbedded=false;
-				class_=0;
-			}
+			ObjectRef() = default;
 			ObjectRef(void* ptr, int id, bool isEmbedded, Class* class_) {
 				this->ptr = ptr;
-				this->id=id;
-				classIndex=0;
-				this->isEmbedded=isEmbedded;
-				this->class_=class_;
+				this->id = id;
+				this->isEmbedded = isEmbedded;
+				this->class_ = class_;
 			}
-			ObjectRef(const ObjectRef&src) :memberGroups(src.memberGroups){
-				ptr=src.ptr;
-				id=src.id;
-				classIndex=src.classIndex;
-				isEmbedded=src.isEmbedded;
-				class_=src.class_;
-			}
-			void* ptr;
-			int id, classIndex;
-			bool isEmbedded;
-			Class* class_;
-			std::vector<COutputStreamSerializer::ObjectMemberGroup> memberGroups;
+
+			void* ptr = nullptr;
+			int id = 0;
+			int classIndex = 0;
+			bool isEmbedded = false;
+			bool isPending = false; // referenced by pointer, not yet saved
+			Class* class_ = nullptr;
+
 			bool isThisObject(void* objPtr, Class* objClass, bool objEmbedded) const
 			{
 				if (ptr != objPtr) return false;
@@ -81,12 +62,15 @@ namespace creg {
 		struct ClassRef;
 
 		std::ostream* stream;
-		std::map<void*,std::vector<ObjectRef*> > ptrToId;
+		spring::unordered_map<void*, std::vector<ObjectRef*> > ptrToId;
 		std::deque<ObjectRef> objects;
 		std::vector<ObjectRef*> pendingObjects; // these objects still have to be saved
 		std::map<Class*, int> classSizes;
 		std::map<Class*, int> classCounts;
 
+		// per-class size statistics, costs a tellp per object
+		bool collectStats = false;
+
 		// Serialize all class names
 		void WriteObjectInfo();
 		// Helper for instance/ptr saving
@@ -132,10 +116,31 @@ namespace creg {
 	 */
 	class CInputStreamSerializer : public ISerializer
 	{
+	protected:
+		/**
+		 * One step of loading an object, in the order SavePackage wrote them:
+		 * a serialized member, or the custom Serialize proc of <cls> if member
+		 * is null. Base classes come first.
+		 */
+		struct LayoutEntry {
+			Class* cls;
+			Class::Member* member;
+		};
+		typedef std::vector<LayoutEntry> ClassLayout;
+
+		const ClassLayout& GetClassLayout(Class* c);
+		void AddClassLayoutEntries(Class* c, ClassLayout& layout);
+
 	protected:
 		std::istream* stream;
 		std::vector<Class*> classRefs;
 
+		// flattened member lists, built once per class and package; deque
+		// since embedded objects add layouts while an outer one is in use
+		std::deque<ClassLayout> classLayouts;
+		spring::unordered_map<Class*, size_t> classLayoutIndices;
+		std::vector<const ClassLayout*> classRefLayouts;
+
 		struct UnfixedPtr {
 			void** ptrAddr;
 			int objID;
@@ -157,7 +162,7 @@ namespace creg {
 		};
 		std::vector<PostLoadCallback> callbacks;
 
-		void SerializeObject(Class* c, void* ptr);
+		void SerializeObject(const ClassLayout& layout, void* ptr);
 	public:
 		CInputStreamSerializer();
 		~CInputStreamSerializer();
@@ -0,0 +1,24 @@
+# This file is part of the Spring engine (GPL v2 or later), see LICENSE.html
+
+# - Find the Zstandard compression library
+#  ZSTD_INCLUDE_DIR - where to find zstd.h
+#  ZSTD_LIBRARY     - the library to link against
+#  ZSTD_FOUND       - True if zstd was found.
+
+Include(FindPackageHandleStandardArgs)
+
+If     (ZSTD_INCLUDE_DIR)
+  # Already in cache, be silent
+  Set(ZSTD_FIND_QUIETLY TRUE)
+EndIf  (ZSTD_INCLUDE_DIR)
+
+Find_Path(ZSTD_INCLUDE_DIR zstd.h)
+
+Set(ZSTD_NAMES zstd libzstd zstd_static libzstd_static)
+Find_Library(ZSTD_LIBRARY NAMES ${ZSTD_NAMES})
+
+# handle the QUIETLY and REQUIRED arguments and set ZSTD_FOUND to TRUE if
+# all listed variables are TRUE
+Find_Package_Handle_Standard_Args(ZSTD DEFAULT_MSG ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+Mark_As_Advanced(ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
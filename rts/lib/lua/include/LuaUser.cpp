@@ -237,7 +237,7 @@ static constexpr uint64_t MAX_ALLOC_BYTES[] = {
 };
 
 // tracks allocations across all states
-static SLuaAllocState gLuaAllocState = {{0}, {0}, {0}, {0}};
+static SLuaAllocState gLuaAllocState = {{0}, {0}, {0}, {0}, {0}};
 static SLuaAllocError gLuaAllocError = {};
 
 void spring_lua_alloc_log_error(const luaContextData* lcd)
@@ -285,6 +285,13 @@ void* spring_lua_alloc(void* ud, void* ptr, size_t osize, size_t nsize)
 	// ptr is NULL if and only if osize is zero
 	// behaves like realloc when nsize!=0 and osize!=0 (ptr != NULL)
 	// behaves like malloc when nsize!=0 and osize==0 (ptr == NULL)
+	if (nsize > osize) {
+		las->allocSumBytes += (nsize - osize);
+
+		if (lcd->allocProfiler != nullptr)
+			lcd->allocProfiler->RecordAlloc(osize, nsize);
+	}
+
 	const spring_time t0 = spring_gettime();
 	void* mem = lmp->Realloc(ptr, nsize, osize);
 	const spring_time t1 = spring_gettime();
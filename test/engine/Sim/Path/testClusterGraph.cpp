@@ -0,0 +1,368 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Path/TKPFS/ClusterGraph.h"
+#include "Sim/Path/TKPFS/PathConstants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+// low-res block grid of a 32x32 map
+static constexpr int NUM_BLOCKS = 64;
+static constexpr int NUM_QUERIES = 256;
+
+
+// synthetic low-res level: passable blocks with a per-block speed factor,
+// vertex costs laid out exactly like PathingState::vertexCosts (1 path-type)
+struct BlockMap {
+	BlockMap(const char* _name): name(_name) {
+		blocked.resize(NUM_BLOCKS * NUM_BLOCKS, false);
+		speeds.resize(NUM_BLOCKS * NUM_BLOCKS, 1.0f);
+	}
+
+	bool Inside(int2 p) const { return (static_cast<unsigned int>(p.x) < NUM_BLOCKS && static_cast<unsigned int>(p.y) < NUM_BLOCKS); }
+	bool Blocked(int2 p) const { return (!Inside(p) || blocked[p.y * NUM_BLOCKS + p.x]); }
+
+	void CalcVertexCosts(int2 p) {
+		for (unsigned int dir = 0; dir < PATH_DIRECTION_VERTICES; dir++) {
+			const int2 q = p + PE_DIRECTION_VECTORS[dir];
+			const int2 d = PE_DIRECTION_VECTORS[dir];
+
+			float& cost = vertexCosts[(p.y * NUM_BLOCKS + p.x) * PATH_DIRECTION_VERTICES + dir];
+
+			// no corner-cutting, as with the max-res PF connecting block centers
+			if (Blocked(p) || Blocked(q) || Blocked({p.x + d.x, p.y}) || Blocked({p.x, p.y + d.y})) {
+				cost = PATHCOST_INFINITY;
+				continue;
+			}
+
+			cost = ((d.x != 0 && d.y != 0)? 1.4142135f: 1.0f) * LOWRES_PE_BLOCKSIZE * 0.5f * (speeds[p.y * NUM_BLOCKS + p.x] + speeds[q.y * NUM_BLOCKS + q.x]);
+		}
+	}
+
+	void CalcVertexCosts() {
+		vertexCosts.resize(NUM_BLOCKS * NUM_BLOCKS * PATH_DIRECTION_VERTICES);
+
+		for (int z = 0; z < NUM_BLOCKS; z++) {
+			for (int x = 0; x < NUM_BLOCKS; x++) {
+				CalcVertexCosts({x, z});
+			}
+		}
+	}
+
+	float GetVertexCost(int2 p, unsigned int dir) const {
+		return vertexCosts[(p.y * NUM_BLOCKS + p.x) * PATH_DIRECTION_VERTICES + GetBlockVertexOffset(dir, NUM_BLOCKS)];
+	}
+
+	const char* name;
+
+	std::vector<bool> blocked;
+	std::vector<float> speeds;
+	std::vector<float> vertexCosts;
+};
+
+
+struct SearchResult {
+	bool found = false;
+	float cost = 0.0f;
+	unsigned int expanded = 0;
+};
+
+// block-level A* equivalent to the PE's, optionally confined to a corridor
+static SearchResult BlockSearch(const BlockMap& map, int2 src, int2 tgt, const TKPFS::ClusterGraph* graph, const std::vector<std::uint8_t>* corridor)
+{
+	const auto Heuristic = [&](int2 p) {
+		const int dx = std::abs(tgt.x - p.x);
+		const int dz = std::abs(tgt.y - p.y);
+		return (LOWRES_PE_BLOCKSIZE * (std::max(dx, dz) + 0.4142135f * std::min(dx, dz)));
+	};
+
+	std::vector<float> gCosts(NUM_BLOCKS * NUM_BLOCKS, PATHCOST_INFINITY);
+	std::vector<std::uint8_t> closed(NUM_BLOCKS * NUM_BLOCKS, 0);
+	std::vector< std::pair<float, int> > openQueue;
+
+	constexpr std::greater< std::pair<float, int> > cmp;
+
+	SearchResult result;
+
+	gCosts[src.y * NUM_BLOCKS + src.x] = 0.0f;
+	openQueue.emplace_back(Heuristic(src), src.y * NUM_BLOCKS + src.x);
+
+	while (!openQueue.empty()) {
+		std::pop_heap(openQueue.begin(), openQueue.end(), cmp);
+
+		const int idx = openQueue.back().second;
+		const int2 pos = {idx % NUM_BLOCKS, idx / NUM_BLOCKS};
+
+		openQueue.pop_back();
+
+		if (closed[idx] != 0)
+			continue;
+
+		closed[idx] = 1;
+		result.expanded++;
+
+		if (pos == tgt) {
+			result.found = true;
+			result.cost = gCosts[idx];
+			break;
+		}
+
+		for (unsigned int dir = 0; dir < PATH_DIRECTIONS; dir++) {
+			const int2 nbr = pos + PE_DIRECTION_VECTORS[dir];
+
+			if (!map.Inside(nbr))
+				continue;
+			if (corridor != nullptr && !graph->InCorridor(*corridor, nbr))
+				continue;
+
+			const int nbrIdx = nbr.y * NUM_BLOCKS + nbr.x;
+			const float gCost = gCosts[idx] + map.GetVertexCost(pos, dir);
+
+			if (closed[nbrIdx] != 0 || gCost >= gCosts[nbrIdx])
+				continue;
+
+			gCosts[nbrIdx] = gCost;
+
+			openQueue.emplace_back(gCost + Heuristic(nbr), nbrIdx);
+			std::push_heap(openQueue.begin(), openQueue.end(), cmp);
+		}
+	}
+
+	return result;
+}
+
+
+static std::vector<BlockMap> GenerateMaps()
+{
+	std::vector<BlockMap> maps;
+	std::mt19937 rng(1234);
+
+	{
+		maps.emplace_back("open field");
+	}
+	{
+		BlockMap& map = maps.emplace_back("wall with gap");
+
+		for (int z = 0; z < NUM_BLOCKS; z++) {
+			map.blocked[z * NUM_BLOCKS + NUM_BLOCKS / 2] = (std::abs(z - NUM_BLOCKS / 4) > 1);
+		}
+	}
+	{
+		BlockMap& map = maps.emplace_back("rough terrain");
+		std::uniform_real_distribution<float> speedDist(1.0f, 3.0f);
+		std::uniform_int_distribution<int> obstDist(0, 9);
+
+		for (int i = 0; i < NUM_BLOCKS * NUM_BLOCKS; i++) {
+			map.speeds[i] = speedDist(rng);
+			map.blocked[i] = (obstDist(rng) == 0);
+		}
+	}
+	{
+		BlockMap& map = maps.emplace_back("serpentine");
+
+		for (int x = 8; x < NUM_BLOCKS; x += 8) {
+			const bool gapAtTop = (((x / 8) & 1) != 0);
+
+			for (int z = 0; z < NUM_BLOCKS; z++) {
+				map.blocked[z * NUM_BLOCKS + x] = gapAtTop? (z < NUM_BLOCKS - 3): (z > 2);
+			}
+		}
+	}
+
+	for (BlockMap& map: maps) {
+		map.CalcVertexCosts();
+	}
+
+	return maps;
+}
+
+static std::vector< std::pair<int2, int2> > GenerateQueries(const BlockMap& map)
+{
+	std::vector< std::pair<int2, int2> > queries;
+	std::mt19937 rng(5678);
+	std::uniform_int_distribution<int> posDist(0, NUM_BLOCKS - 1);
+
+	while (queries.size() < NUM_QUERIES) {
+		const int2 src = {posDist(rng), posDist(rng)};
+		const int2 tgt = {posDist(rng), posDist(rng)};
+
+		if (map.Blocked(src) || map.Blocked(tgt))
+			continue;
+		// long paths only, short ones never reach the low-res level
+		if (std::max(std::abs(src.x - tgt.x), std::abs(src.y - tgt.y)) < (NUM_BLOCKS / 4))
+			continue;
+
+		queries.emplace_back(src, tgt);
+	}
+
+	return queries;
+}
+
+
+
+TEST_CASE("ClusterGraphEdges")
+{
+	BlockMap map("single gap");
+
+	for (int z = 0; z < NUM_BLOCKS; z++) {
+		map.blocked[z * NUM_BLOCKS + CLUSTER_PE_BLOCKSIZE] = (z != 1);
+	}
+
+	map.CalcVertexCosts();
+
+	TKPFS::ClusterGraph graph;
+	graph.Init({NUM_BLOCKS, NUM_BLOCKS}, CLUSTER_PE_BLOCKSIZE, 1);
+	graph.Rebuild(map.vertexCosts);
+
+	CHECK(graph.GetNumClusters() == ((NUM_BLOCKS / CLUSTER_PE_BLOCKSIZE) * (NUM_BLOCKS / CLUSTER_PE_BLOCKSIZE)));
+
+	// the wall column starts cluster column 1, only the gap leads across
+	CHECK(graph.GetEdgeCost(0, {0, 0}, PATHDIR_LEFT) < PATHCOST_INFINITY);
+	CHECK(graph.GetEdgeCost(0, {1, 0}, PATHDIR_RIGHT) == graph.GetEdgeCost(0, {0, 0}, PATHDIR_LEFT));
+	CHECK(graph.GetEdgeCost(0, {0, 1}, PATHDIR_LEFT) == PATHCOST_INFINITY);
+	CHECK(graph.GetEdgeCost(0, {0, 2}, PATHDIR_LEFT_UP) == PATHCOST_INFINITY);
+	CHECK(graph.GetEdgeCost(0, {0, 0}, PATHDIR_UP) < PATHCOST_INFINITY);
+	// no edges off the map
+	CHECK(graph.GetEdgeCost(0, {0, 0}, PATHDIR_RIGHT_UP) == PATHCOST_INFINITY);
+
+	std::vector<std::uint8_t> corridor;
+
+	// across the wall and back down, corridor has to pass the gap cluster
+	CHECK(graph.FindCorridor(0, {0, NUM_BLOCKS - 1}, {CLUSTER_PE_BLOCKSIZE * 2 + 1, NUM_BLOCKS - 1}, corridor));
+	CHECK(graph.InCorridor(corridor, {0, 1}));
+	CHECK(graph.InCorridor(corridor, {CLUSTER_PE_BLOCKSIZE + 1, 1}));
+	CHECK_FALSE(graph.InCorridor(corridor, {NUM_BLOCKS - 1, NUM_BLOCKS / 2}));
+
+	// neighbouring clusters do not need a corridor
+	CHECK_FALSE(graph.FindCorridor(0, {0, 0}, {CLUSTER_PE_BLOCKSIZE, 0}, corridor));
+}
+
+TEST_CASE("ClusterGraphRepair")
+{
+	std::vector<BlockMap> maps = GenerateMaps();
+	BlockMap& map = maps[2];
+
+	TKPFS::ClusterGraph repairedGraph;
+	repairedGraph.Init({NUM_BLOCKS, NUM_BLOCKS}, CLUSTER_PE_BLOCKSIZE, 1);
+	repairedGraph.Rebuild(map.vertexCosts);
+
+	// drop a few "buildings" and re-open some blocks, as a TerrainChange
+	// would, then update the affected vertices like PathingState does
+	std::mt19937 rng(91011);
+	std::uniform_int_distribution<int> posDist(1, NUM_BLOCKS - 2);
+
+	for (int n = 0; n < 32; n++) {
+		const int2 pos = {posDist(rng), posDist(rng)};
+
+		map.blocked[pos.y * NUM_BLOCKS + pos.x] = !map.blocked[pos.y * NUM_BLOCKS + pos.x];
+
+		for (int z = pos.y - 1; z <= pos.y + 1; z++) {
+			for (int x = pos.x - 1; x <= pos.x + 1; x++) {
+				map.CalcVertexCosts({x, z});
+				repairedGraph.MarkDirtyBlock({x, z});
+			}
+		}
+	}
+
+	CHECK(repairedGraph.GetNumDirtyClusters() > 0);
+	CHECK(repairedGraph.GetNumDirtyClusters() < repairedGraph.GetNumClusters());
+
+	repairedGraph.Repair(map.vertexCosts);
+	CHECK(repairedGraph.GetNumDirtyClusters() == 0);
+
+	TKPFS::ClusterGraph rebuiltGraph;
+	rebuiltGraph.Init({NUM_BLOCKS, NUM_BLOCKS}, CLUSTER_PE_BLOCKSIZE, 1);
+	rebuiltGraph.Rebuild(map.vertexCosts);
+
+	unsigned int numMismatches = 0;
+
+	for (unsigned int idx = 0; idx < rebuiltGraph.GetNumClusters(); idx++) {
+		const int2 pos = rebuiltGraph.ClusterIdxToPos(idx);
+
+		for (unsigned int dir = 0; dir < PATH_DIRECTION_VERTICES; dir++) {
+			numMismatches += (repairedGraph.GetEdgeCost(0, pos, dir) != rebuiltGraph.GetEdgeCost(0, pos, dir));
+		}
+	}
+
+	CHECK(numMismatches == 0);
+}
+
+TEST_CASE("ClusterGraphBenchmark")
+{
+	const std::vector<BlockMap> maps = GenerateMaps();
+
+	for (const BlockMap& map: maps) {
+		TKPFS::ClusterGraph graph;
+		graph.Init({NUM_BLOCKS, NUM_BLOCKS}, CLUSTER_PE_BLOCKSIZE, 1);
+		graph.Rebuild(map.vertexCosts);
+
+		unsigned int numFound[2] = {0, 0};
+		unsigned int numExpanded[2] = {0, 0};
+		unsigned int numFallbacks = 0;
+
+		double totalCost[2] = {0.0, 0.0};
+
+		std::vector<std::uint8_t> corridor;
+
+		for (const auto& query: GenerateQueries(map)) {
+			const SearchResult flatResult = BlockSearch(map, query.first, query.second, nullptr, nullptr);
+
+			// cluster level first; same fallback as CPathManager::ArrangePath
+			unsigned int numExpandedClusters = 0;
+			SearchResult tierResult;
+
+			if (graph.FindCorridor(0, query.first, query.second, corridor, &numExpandedClusters))
+				tierResult = BlockSearch(map, query.first, query.second, &graph, &corridor);
+
+			tierResult.expanded += numExpandedClusters;
+
+			if (!tierResult.found) {
+				const SearchResult fallbackResult = BlockSearch(map, query.first, query.second, nullptr, nullptr);
+
+				tierResult.found = fallbackResult.found;
+				tierResult.cost = fallbackResult.cost;
+				tierResult.expanded += fallbackResult.expanded;
+
+				numFallbacks += flatResult.found;
+			}
+
+			// the corridor must never make a reachable goal unreachable
+			CHECK(tierResult.found == flatResult.found);
+
+			numFound[0] += flatResult.found;
+			numFound[1] += tierResult.found;
+			numExpanded[0] += flatResult.expanded;
+			numExpanded[1] += tierResult.expanded;
+
+			if (!flatResult.found)
+				continue;
+
+			totalCost[0] += flatResult.cost;
+			totalCost[1] += tierResult.cost;
+		}
+
+		const float costRatio = totalCost[1] / std::max(totalCost[0], 1.0);
+
+		printf("[ClusterGraphBenchmark] %-14s found=%u/%u expanded=%u->%u (%.2fx) fallbacks=%u cost=%.3fx\n",
+			map.name,
+			numFound[1], NUM_QUERIES,
+			numExpanded[0], numExpanded[1],
+			numExpanded[0] / std::max(float(numExpanded[1]), 1.0f),
+			numFallbacks,
+			costRatio
+		);
+
+		// optimal block search bounds the corridor result from below
+		CHECK(costRatio > 0.999f);
+		CHECK(costRatio < 1.25f);
+		CHECK(numExpanded[1] < numExpanded[0]);
+	}
+}
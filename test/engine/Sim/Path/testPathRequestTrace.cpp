@@ -0,0 +1,144 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Path/PathRequestTrace.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+using namespace PathRequestTrace;
+
+static std::vector<Request> MakeRequests()
+{
+	std::vector<Request> requests;
+
+	for (int i = 0; i < 16; i++) {
+		Request r;
+
+		r.frame = 30 + (i / 4);
+		r.ownerID = (i % 3 == 0)? -1: (1000 + i);
+		r.moveDefName = (i & 1)? "tank3": "hover_2";
+		r.startPos[0] = 128.5f + i * 17.25f;
+		r.startPos[1] = 12.0f;
+		r.startPos[2] = 256.0f - i * 3.125f;
+		r.goalPos[0] = 4096.0f - i;
+		r.goalPos[1] = -3.5f;
+		r.goalPos[2] = 0.1f * i;
+		r.goalRadius = 8.0f * (i % 5);
+
+		requests.push_back(r);
+	}
+
+	return requests;
+}
+
+static Results MakeResults(const char* pfsName, float lengthScale)
+{
+	Results results;
+
+	results.pfsName = pfsName;
+	results.memUsage = 4096;
+
+	for (int i = 0; i < 8; i++) {
+		Result r;
+
+		r.found = (i != 3);
+		r.numWaypoints = 10 + i;
+		r.numNodes = 100 * (i + 1);
+		r.pathLength = (i + 1) * 64.0f * lengthScale;
+		r.searchTime = 250.0f;
+
+		results.results.push_back(r);
+	}
+
+	return results;
+}
+
+
+TEST_CASE("RequestsRoundTrip")
+{
+	const std::string path = "testPathRequestTrace.requests";
+	const std::vector<Request> written = MakeRequests();
+
+	REQUIRE(WriteRequests(path, "Some Map 1.2", written));
+
+	std::string mapName;
+	std::vector<Request> read;
+
+	REQUIRE(ReadRequests(path, mapName, read));
+	CHECK(mapName == "Some Map 1.2");
+	REQUIRE(read.size() == written.size());
+
+	for (size_t i = 0; i < read.size(); i++) {
+		CHECK(read[i].frame == written[i].frame);
+		CHECK(read[i].ownerID == written[i].ownerID);
+		CHECK(read[i].moveDefName == written[i].moveDefName);
+		CHECK(read[i].goalRadius == written[i].goalRadius);
+
+		for (int c = 0; c < 3; c++) {
+			CHECK(read[i].startPos[c] == written[i].startPos[c]);
+			CHECK(read[i].goalPos[c] == written[i].goalPos[c]);
+		}
+	}
+
+	std::remove(path.c_str());
+}
+
+TEST_CASE("ResultsRoundTrip")
+{
+	const std::string path = "testPathRequestTrace.results";
+	const Results written = MakeResults("TKPFS", 1.0f);
+
+	REQUIRE(WriteResults(path, written));
+
+	Results read;
+
+	REQUIRE(ReadResults(path, read));
+	CHECK(read.pfsName == written.pfsName);
+	CHECK(read.memUsage == written.memUsage);
+	REQUIRE(read.results.size() == written.results.size());
+
+	for (size_t i = 0; i < read.results.size(); i++) {
+		CHECK(read.results[i].found == written.results[i].found);
+		CHECK(read.results[i].numWaypoints == written.results[i].numWaypoints);
+		CHECK(read.results[i].numNodes == written.results[i].numNodes);
+		CHECK(read.results[i].pathLength == written.results[i].pathLength);
+		CHECK(read.results[i].searchTime == written.results[i].searchTime);
+	}
+
+	// requests and results files are not interchangeable
+	std::string mapName;
+	std::vector<Request> requests;
+
+	CHECK_FALSE(ReadRequests(path, mapName, requests));
+	CHECK_FALSE(ReadResults("testPathRequestTrace.missing", read));
+
+	std::remove(path.c_str());
+}
+
+TEST_CASE("Summarize")
+{
+	const Results reference = MakeResults("HAPFS", 1.0f);
+	const Results results = MakeResults("QTPFS", 1.1f);
+
+	const Summary s = Summarize(results, nullptr);
+
+	CHECK(s.numRequests == 8);
+	CHECK(s.numFound == 7);
+	CHECK(s.numNodes == 3600);
+	CHECK(s.numCompared == 0);
+	CHECK(std::fabs(s.searchTime - 0.002f) < 1e-6f);
+	CHECK(std::fabs(s.searchesPerSec - 4000.0f) < 1.0f);
+	CHECK(std::fabs(s.nodesPerSearch - 450.0f) < 1e-3f);
+
+	const Summary d = Summarize(results, &reference);
+
+	// the one request without a path is not compared
+	CHECK(d.numCompared == 7);
+	CHECK(std::fabs(d.meanLengthDelta - 0.1f) < 1e-4f);
+	CHECK(std::fabs(d.maxLengthDelta - 0.1f) < 1e-4f);
+}
@@ -0,0 +1,132 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <vector>
+
+#include "Sim/Units/CommandAI/Command.h"
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static Command MakeCommand(unsigned int numParams)
+{
+	Command c(CMD_MOVE);
+
+	for (unsigned int i = 0; i < numParams; i++) {
+		c.PushParam(i * 1.0f);
+	}
+
+	return c;
+}
+
+static void CheckParams(const Command& c, unsigned int numParams, float offset = 0.0f)
+{
+	REQUIRE(c.GetNumParams() == numParams);
+
+	for (unsigned int i = 0; i < numParams; i++) {
+		CHECK(c.GetParam(i) == (i * 1.0f + offset));
+	}
+}
+
+
+TEST_CASE("InlineParams")
+{
+	const Command a = MakeCommand(MAX_COMMAND_PARAMS);
+	Command b = a;
+
+	CHECK(!a.IsPooledCommand());
+	CHECK(!b.IsPooledCommand());
+
+	b.SetParam(0, 100.0f);
+
+	CHECK(a.GetParam(0) == 0.0f);
+	CHECK(b.GetParam(0) == 100.0f);
+	CheckParams(a, MAX_COMMAND_PARAMS);
+
+	const Command& c = b;
+
+	b = c;
+	CHECK(b.GetParam(0) == 100.0f);
+}
+
+TEST_CASE("SharedPooledParams")
+{
+	const unsigned int numParams = MAX_COMMAND_PARAMS * 4;
+
+	const Command a = MakeCommand(numParams);
+	std::vector<Command> copies(1000, a);
+
+	REQUIRE(a.IsPooledCommand());
+
+	// copies share the page of the original
+	for (const Command& c: copies) {
+		CHECK(c.GetpageIndex() == a.GetpageIndex());
+	}
+
+	// modifying a copy clones its page
+	copies[0].SetParam(1, 100.0f);
+	copies[1].PushParam(numParams * 1.0f);
+
+	CHECK(copies[0].GetpageIndex() != a.GetpageIndex());
+	CHECK(copies[1].GetpageIndex() != a.GetpageIndex());
+	CHECK(copies[0].GetParam(1) == 100.0f);
+
+	CheckParams(a, numParams);
+	CheckParams(copies[1], numParams + 1);
+	CheckParams(copies[2], numParams);
+
+	// releasing all but one reference leaves the page intact
+	copies.resize(3);
+	copies[2] = copies[2];
+
+	CheckParams(copies[2], numParams);
+	CHECK(copies[2].GetpageIndex() == a.GetpageIndex());
+}
+
+TEST_CASE("MovedPooledParams")
+{
+	const unsigned int numParams = MAX_COMMAND_PARAMS + 1;
+
+	Command a = MakeCommand(numParams);
+	const unsigned int pageIndex = a.GetpageIndex();
+
+	Command b = std::move(a);
+
+	CHECK(b.GetpageIndex() == pageIndex);
+	CHECK(a.IsEmptyCommand());
+	CHECK(!a.IsPooledCommand());
+	CheckParams(b, numParams);
+
+	// the page is not shared anymore, so this must not clone it
+	b.SetParam(0, 1.0f);
+	CHECK(b.GetpageIndex() == pageIndex);
+}
+
+TEST_CASE("PoolGrowth")
+{
+	// more pooled commands than the initial page count, none may alias another
+	std::vector<Command> cmds;
+
+	for (unsigned int i = 0; i < 1000; i++) {
+		cmds.push_back(MakeCommand(MAX_COMMAND_PARAMS + 1));
+		cmds.back().SetParam(0, i * 1.0f);
+	}
+
+	for (unsigned int i = 0; i < cmds.size(); i++) {
+		CHECK(cmds[i].GetParam(0) == i * 1.0f);
+	}
+}
+
+TEST_CASE("RawCommand")
+{
+	for (const unsigned int numParams: {0, 3, MAX_COMMAND_PARAMS, MAX_COMMAND_PARAMS * 2}) {
+		Command a = MakeCommand(numParams);
+		Command b;
+
+		b.FromRawCommand(a.ToRawCommand());
+
+		CHECK(b.GetID() == CMD_MOVE);
+		CHECK(b.IsPooledCommand() == a.IsPooledCommand());
+		CheckParams(b, numParams);
+	}
+}
@@ -0,0 +1,101 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "System/Sync/SHA512.hpp"
+#include "System/Misc/SpringTime.h"
+#include "System/Log/ILog.h"
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+InitSpringTime ist;
+
+
+static void CheckDigests(const std::vector<sha512::msg_vector>& msgs)
+{
+	std::vector<const uint8_t*> msgPtrs;
+	std::vector<size_t> msgLens;
+	std::vector<sha512::raw_digest> digests(msgs.size());
+	std::vector<sha512::raw_digest> multiDigests(msgs.size());
+	std::vector<uint8_t*> multiDigestPtrs;
+
+	for (size_t i = 0; i < msgs.size(); i++) {
+		msgPtrs.push_back(msgs[i].data());
+		msgLens.push_back(msgs[i].size());
+		multiDigestPtrs.push_back(multiDigests[i].data());
+
+		sha512::calc_digest(msgs[i], digests[i]);
+	}
+
+	sha512::calc_digests(msgPtrs.data(), msgLens.data(), multiDigestPtrs.data(), msgs.size());
+
+	for (size_t i = 0; i < msgs.size(); i++) {
+		CHECK(digests[i] == multiDigests[i]);
+	}
+}
+
+
+TEST_CASE("SHA512")
+{
+	CHECK(sha512::unit_test());
+	CHECK(sha512::unit_test("abc", "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"));
+}
+
+TEST_CASE("SHA512MultiBuffer")
+{
+	LOG("[SHA512MultiBuffer] multi-buffer hashing %s", sha512::have_multi_buffer()? "enabled": "not supported");
+
+	std::mt19937 rng(123);
+	std::vector<sha512::msg_vector> msgs;
+
+	// lengths around the block and padding boundaries, in lanes that finish at different times
+	for (const size_t len: {0, 1, 111, 112, 127, 128, 129, 255, 256, 1000, 4096, 12345}) {
+		msgs.emplace_back(len);
+
+		for (uint8_t& b: msgs.back()) {
+			b = rng();
+		}
+	}
+
+	for (size_t count = 0; count <= msgs.size(); count++) {
+		CheckDigests({msgs.begin(), msgs.begin() + count});
+	}
+
+	std::shuffle(msgs.begin(), msgs.end(), rng);
+	CheckDigests(msgs);
+}
+
+TEST_CASE("SHA512Benchmark")
+{
+	std::vector<sha512::msg_vector> msgs(16, sha512::msg_vector(4 * 1024 * 1024, 0x5A));
+	std::vector<const uint8_t*> msgPtrs;
+	std::vector<size_t> msgLens;
+	std::vector<sha512::raw_digest> digests(msgs.size());
+	std::vector<sha512::raw_digest> multiDigests(msgs.size());
+	std::vector<uint8_t*> multiDigestPtrs;
+
+	for (size_t i = 0; i < msgs.size(); i++) {
+		msgPtrs.push_back(msgs[i].data());
+		msgLens.push_back(msgs[i].size());
+		multiDigestPtrs.push_back(multiDigests[i].data());
+	}
+
+	const spring_time t0 = spring_gettime();
+
+	for (size_t i = 0; i < msgs.size(); i++) {
+		sha512::calc_digest(msgs[i], digests[i]);
+	}
+
+	const spring_time t1 = spring_gettime();
+
+	sha512::calc_digests(msgPtrs.data(), msgLens.data(), multiDigestPtrs.data(), msgs.size());
+
+	const spring_time t2 = spring_gettime();
+
+	LOG("[SHA512Benchmark] 16x4MB: calc_digest %dms, calc_digests %dms", int((t1 - t0).toMilliSecsi()), int((t2 - t1).toMilliSecsi()));
+
+	CHECK(digests == multiDigests);
+}
@@ -0,0 +1,71 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <vector>
+
+#include "System/GlobalRNG.h"
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static std::vector<uint32_t> DrawValues(CSyncedRNGStream stream, size_t count)
+{
+	std::vector<uint32_t> values(count);
+
+	for (uint32_t& v: values) {
+		v = stream();
+	}
+
+	return values;
+}
+
+
+TEST_CASE("Philox4x32")
+{
+	// known-answer vectors from the Random123 distribution
+	const uint32_t ctrs[3][4] = {{0x00000000, 0x00000000, 0x00000000, 0x00000000}, {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}};
+	const uint32_t keys[3][2] = {{0x00000000, 0x00000000}, {0xffffffff, 0xffffffff}, {0xa4093822, 0x299f31d0}};
+	const uint32_t ress[3][4] = {{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}, {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}, {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+
+	for (size_t i = 0; i < 3; i++) {
+		uint32_t res[4];
+		Philox4x32::Block(ctrs[i], keys[i], res);
+
+		CHECK(std::equal(res, res + 4, ress[i]));
+	}
+
+	// a fresh generator starts at block 0
+	Philox4x32 gen(0, 0, 0, 0);
+
+	for (size_t i = 0; i < 4; i++) {
+		CHECK(gen.next() == ress[0][i]);
+	}
+
+	CHECK(gen.state() == 4);
+}
+
+TEST_CASE("SyncedRNGStream")
+{
+	const std::vector<uint32_t> values = DrawValues({1234, 100, 1, 42}, 1000);
+
+	// same triple and key, same sequence
+	CHECK(values == DrawValues({1234, 100, 1, 42}, 1000));
+
+	// any other frame, subsystem, object or key gives another one
+	CHECK(values != DrawValues({1234, 101, 1, 42}, 1000));
+	CHECK(values != DrawValues({1234, 100, 2, 42}, 1000));
+	CHECK(values != DrawValues({1234, 100, 1, 43}, 1000));
+	CHECK(values != DrawValues({1235, 100, 1, 42}, 1000));
+
+	CSyncedRNGStream stream(1234, 100, 1, 42);
+
+	for (int i = 0; i < 1000; i++) {
+		const float f = stream.NextFloat();
+		const uint32_t n = stream.NextInt(10);
+
+		CHECK(f >= 0.0f);
+		CHECK(f < 1.0f);
+		CHECK(n < 10);
+	}
+}
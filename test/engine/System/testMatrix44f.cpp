@@ -1,5 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <cstring>
+#include <vector>
 #include <xmmintrin.h> //SSE1
 
 #include "System/Matrix44f.h"
@@ -284,3 +286,33 @@ TEST_CASE("Matrix44MatrixMultiply")
 		}
 	}
 }
+
+TEST_CASE("Matrix44BatchMultiply")
+{
+	CMatrix44f bm(float3(10.0f, -20.0f, 30.0f), float3(0.8f, 0.6f, 0.0f), float3(-0.6f, 0.8f, 0.0f), float3(0.0f, 0.0f, 1.0f));
+	bm.Scale({1.5f, 2.5f, 0.5f});
+
+	// odd count so the non-AVX tail runs too
+	std::vector<float3> points(101);
+	std::vector<float4> vectors(101);
+
+	for (size_t i = 0; i < points.size(); i++) {
+		points[i] = {i * 1.25f, i * -3.5f, i / 7.0f};
+		vectors[i] = {i / 3.0f, i * 0.75f, i * -1.5f, (i & 1) * 1.0f};
+	}
+
+	std::vector<float3> batchPoints(points.size());
+	std::vector<float4> batchVectors(vectors);
+
+	bm.Mul(points.data(), batchPoints.data(), points.size());
+	bm.Mul(batchVectors.data(), batchVectors.data(), batchVectors.size());
+
+	// the batched results must equal the single ones bit for bit
+	for (size_t i = 0; i < points.size(); i++) {
+		const float3 p = bm * points[i];
+		const float4 v = bm * vectors[i];
+
+		CHECK(memcmp(&p, &batchPoints[i], sizeof(float3)) == 0);
+		CHECK(memcmp(&v, &batchVectors[i], sizeof(float4)) == 0);
+	}
+}
@@ -0,0 +1,417 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "Lua/LuaMemPool.h"
+#include "System/FastMath.h"
+#include "System/FreeListMap.h"
+#include "System/Matrix44f.h"
+#include "System/SpringMath.h"
+#include "System/UnorderedMap.hpp"
+#include "System/float3.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+InitSpringTime ist;
+
+
+// results of the benchmarked loops end up here, so they can not be optimized out
+static volatile float sink = 0.0f;
+
+static constexpr unsigned NUM_RUNS = 5;
+static constexpr unsigned NUM_ITEMS = 1 << 16;
+
+
+// runs <func> (which covers <numOps> operations) NUM_RUNS times, returns
+// the time per operation of the fastest run; the slower ones are mostly
+// cache warm-up and scheduling noise
+template<typename F>
+static float Benchmark(const char* name, unsigned numOps, F&& func)
+{
+	spring_time bestTime = spring_time::fromSecs(1000);
+
+	for (unsigned run = 0; run < NUM_RUNS; run++) {
+		const spring_time t0 = spring_gettime();
+
+		func();
+
+		bestTime = std::min(bestTime, spring_gettime() - t0);
+	}
+
+	const float opTime = bestTime.toNanoSecsf() / numOps;
+
+	LOG("%-40s %9.2fns/op", name, opTime);
+	return opTime;
+}
+
+
+static std::vector<float> RandomFloats(unsigned count, float min, float max)
+{
+	std::mt19937 rng(count);
+	std::uniform_real_distribution<float> dist(min, max);
+	std::vector<float> v(count);
+
+	for (float& f: v) {
+		f = dist(rng);
+	}
+
+	return v;
+}
+
+static std::vector<float3> RandomVectors(unsigned count)
+{
+	const std::vector<float> f = RandomFloats(count * 3, -1000.0f, 1000.0f);
+	std::vector<float3> v(count);
+
+	for (unsigned i = 0; i < count; i++) {
+		v[i] = {f[i * 3 + 0], f[i * 3 + 1], f[i * 3 + 2]};
+	}
+
+	return v;
+}
+
+static std::vector<int> RandomKeys(unsigned count)
+{
+	std::mt19937 rng(count);
+	std::vector<int> v(count);
+
+	for (int& k: v) {
+		k = rng() & 0x7FFFFFFF;
+	}
+
+	return v;
+}
+
+
+
+TEST_CASE("Float3")
+{
+	const std::vector<float3> a = RandomVectors(NUM_ITEMS);
+	const std::vector<float3> b = RandomVectors(NUM_ITEMS + 1);
+
+	Benchmark("float3::dot", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			sum += a[i].dot(b[i]);
+		}
+
+		sink = sum;
+	});
+	Benchmark("float3::cross", NUM_ITEMS, [&]() {
+		float3 sum;
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			sum += a[i].cross(b[i]);
+		}
+
+		sink = sum.x;
+	});
+	Benchmark("float3::distance", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			sum += a[i].distance(b[i]);
+		}
+
+		sink = sum;
+	});
+	Benchmark("float3::Normalize", NUM_ITEMS, [&]() {
+		float3 sum;
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			sum += (a[i] + b[i]).Normalize();
+		}
+
+		sink = sum.x;
+	});
+	Benchmark("float3::SafeANormalize", NUM_ITEMS, [&]() {
+		float3 sum;
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			sum += (a[i] + b[i]).SafeANormalize();
+		}
+
+		sink = sum.x;
+	});
+
+	CHECK(std::isfinite(sink));
+}
+
+TEST_CASE("Matrix44f")
+{
+	const std::vector<float3> v = RandomVectors(NUM_ITEMS);
+	const std::vector<float> angles = RandomFloats(NUM_ITEMS, -math::PI, math::PI);
+
+	std::vector<CMatrix44f> m(NUM_ITEMS);
+
+	for (unsigned i = 0; i < NUM_ITEMS; i++) {
+		m[i].Translate(v[i]);
+		m[i].RotateY(angles[i]);
+	}
+
+	Benchmark("CMatrix44f * float3", NUM_ITEMS, [&]() {
+		float3 sum;
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			sum += m[i] * v[NUM_ITEMS - 1 - i];
+		}
+
+		sink = sum.x;
+	});
+
+	std::vector<float3> out(NUM_ITEMS);
+
+	// the same matrix for all points, once per point and once batched
+	Benchmark("CMatrix44f * float3 (one matrix)", NUM_ITEMS, [&]() {
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			out[i] = m[0] * v[i];
+		}
+
+		sink = out[NUM_ITEMS - 1].x;
+	});
+	Benchmark("CMatrix44f::Mul (batch)", NUM_ITEMS, [&]() {
+		m[0].Mul(v.data(), out.data(), NUM_ITEMS);
+
+		sink = out[NUM_ITEMS - 1].x;
+	});
+
+	Benchmark("CMatrix44f * CMatrix44f", NUM_ITEMS - 1, [&]() {
+		float sum = 0.0f;
+
+		for (unsigned i = 0; i < NUM_ITEMS - 1; i++) {
+			sum += (m[i] * m[i + 1]).m[12];
+		}
+
+		sink = sum;
+	});
+	Benchmark("CMatrix44f::RotateEulerYXZ", NUM_ITEMS, [&]() {
+		CMatrix44f r;
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			r.RotateEulerYXZ(v[i]);
+		}
+
+		sink = r.m[0];
+	});
+	Benchmark("CMatrix44f::InvertAffine", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			sum += m[i].InvertAffine().m[12];
+		}
+
+		sink = sum;
+	});
+	Benchmark("CMatrix44f::Invert", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			sum += m[i].Invert().m[12];
+		}
+
+		sink = sum;
+	});
+
+	CHECK(std::isfinite(sink));
+}
+
+TEST_CASE("FastMath")
+{
+	const std::vector<float> x = RandomFloats(NUM_ITEMS, 0.01f, 10000.0f);
+	const std::vector<float> r = RandomFloats(NUM_ITEMS, -math::TWOPI, math::TWOPI);
+
+	// the approximations are only worth it if they beat the libm versions
+	Benchmark("std::sqrt", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+		for (unsigned i = 0; i < NUM_ITEMS; i++) { sum += std::sqrt(x[i]); }
+		sink = sum;
+	});
+	Benchmark("math::sqrt", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+		for (unsigned i = 0; i < NUM_ITEMS; i++) { sum += math::sqrt(x[i]); }
+		sink = sum;
+	});
+	Benchmark("fastmath::apxsqrt", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+		for (unsigned i = 0; i < NUM_ITEMS; i++) { sum += fastmath::apxsqrt(x[i]); }
+		sink = sum;
+	});
+	Benchmark("1 / std::sqrt", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+		for (unsigned i = 0; i < NUM_ITEMS; i++) { sum += 1.0f / std::sqrt(x[i]); }
+		sink = sum;
+	});
+	Benchmark("math::isqrt", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+		for (unsigned i = 0; i < NUM_ITEMS; i++) { sum += math::isqrt(x[i]); }
+		sink = sum;
+	});
+	Benchmark("std::sin", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+		for (unsigned i = 0; i < NUM_ITEMS; i++) { sum += std::sin(r[i]); }
+		sink = sum;
+	});
+	Benchmark("fastmath::sin", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+		for (unsigned i = 0; i < NUM_ITEMS; i++) { sum += fastmath::sin(r[i]); }
+		sink = sum;
+	});
+
+	for (unsigned i = 0; i < NUM_ITEMS; i += 64) {
+		CHECK(fastmath::apxsqrt(x[i]) == Approx(std::sqrt(x[i])).epsilon(0.01f));
+		CHECK(math::isqrt(x[i]) == Approx(1.0f / std::sqrt(x[i])).epsilon(0.01f));
+		CHECK(fastmath::sin(r[i]) == Approx(std::sin(r[i])).margin(0.01f));
+	}
+}
+
+template<typename Map>
+static void BenchmarkMap(const char* mapName, const std::vector<int>& keys)
+{
+	const unsigned numKeys = keys.size();
+
+	char name[128];
+	Map map;
+
+	snprintf(name, sizeof(name), "%s::emplace", mapName);
+	Benchmark(name, numKeys, [&]() {
+		map.clear();
+
+		for (unsigned i = 0; i < numKeys; i++) {
+			map.emplace(keys[i], i);
+		}
+	});
+
+	snprintf(name, sizeof(name), "%s::find (hit)", mapName);
+	Benchmark(name, numKeys, [&]() {
+		unsigned sum = 0;
+
+		for (unsigned i = 0; i < numKeys; i++) {
+			sum += map.find(keys[i])->second;
+		}
+
+		sink = sum;
+	});
+
+	snprintf(name, sizeof(name), "%s::find (miss)", mapName);
+	Benchmark(name, numKeys, [&]() {
+		unsigned sum = 0;
+
+		// keys are non-negative
+		for (unsigned i = 0; i < numKeys; i++) {
+			sum += (map.find(-keys[i] - 1) == map.end());
+		}
+
+		sink = sum;
+	});
+
+	snprintf(name, sizeof(name), "%s::iterate", mapName);
+	Benchmark(name, numKeys, [&]() {
+		unsigned sum = 0;
+
+		for (const auto& p: map) {
+			sum += p.second;
+		}
+
+		sink = sum;
+	});
+
+	snprintf(name, sizeof(name), "%s::erase", mapName);
+	Benchmark(name, numKeys, [&]() {
+		Map copy = map;
+
+		for (unsigned i = 0; i < numKeys; i++) {
+			copy.erase(keys[i]);
+		}
+
+		sink = copy.size();
+	});
+
+	CHECK(map.size() <= numKeys);
+}
+
+TEST_CASE("UnorderedMap")
+{
+	const std::vector<int> keys = RandomKeys(NUM_ITEMS);
+
+	BenchmarkMap< std::unordered_map<int, unsigned> >("std::unordered_map", keys);
+	BenchmarkMap< spring::unordered_map<int, unsigned> >("spring::unordered_map", keys);
+}
+
+TEST_CASE("FreeListMap")
+{
+	spring::FreeListMap<float3> map;
+	std::vector<std::size_t> ids(NUM_ITEMS);
+
+	Benchmark("FreeListMap::Add", NUM_ITEMS, [&]() {
+		map = {};
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			ids[i] = map.Add(float3(i, 0.0f, 0.0f));
+		}
+	});
+	Benchmark("FreeListMap::operator[]", NUM_ITEMS, [&]() {
+		float sum = 0.0f;
+		const auto& cmap = map;
+
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			sum += cmap[ids[NUM_ITEMS - 1 - i]].x;
+		}
+
+		sink = sum;
+	});
+	// deleting every other ID and adding as many again recycles all freed slots
+	Benchmark("FreeListMap::Del+Add", NUM_ITEMS, [&]() {
+		for (unsigned i = 0; i < NUM_ITEMS; i += 2) {
+			map.Del(ids[i]);
+		}
+		for (unsigned i = 0; i < NUM_ITEMS; i += 2) {
+			ids[i] = map.Add(float3(i, 0.0f, 0.0f));
+		}
+	});
+
+	for (unsigned i = 0; i < NUM_ITEMS; i += 64) {
+		CHECK(static_cast<const spring::FreeListMap<float3>&>(map)[ids[i]].x == float(i));
+	}
+}
+
+TEST_CASE("LuaMemPool")
+{
+	LuaMemPool::InitStatic(true);
+
+	LuaMemPool* pool = LuaMemPool::AcquirePtr(false, false);
+
+	// Lua allocates mostly small blocks (strings, tables, closures), in about this range
+	const std::vector<float> sizes = RandomFloats(NUM_ITEMS, float(LuaMemPool::MIN_ALLOC_SIZE), 256.0f);
+	std::vector<void*> ptrs(NUM_ITEMS, nullptr);
+
+	Benchmark("malloc+free", NUM_ITEMS, [&]() {
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			ptrs[i] = malloc(size_t(sizes[i]));
+		}
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			free(ptrs[i]);
+		}
+	});
+	Benchmark("LuaMemPool::Alloc+Free", NUM_ITEMS, [&]() {
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			ptrs[i] = pool->Alloc(size_t(sizes[i]));
+		}
+		for (unsigned i = 0; i < NUM_ITEMS; i++) {
+			pool->Free(ptrs[i], size_t(sizes[i]));
+		}
+	});
+
+	CHECK(pool->Alloc(16) != nullptr);
+
+	LuaMemPool::ReleasePtr(pool, nullptr);
+	LuaMemPool::KillStatic();
+}
@@ -7,6 +7,7 @@
 #include "System/SpringMath.h"
 #include "System/GlobalRNG.h"
 
+#include <algorithm>
 #include <vector>
 #include <atomic>
 #include <future>
@@ -338,6 +339,138 @@ TEST_CASE("test_parallel_gtn_cost")
 	LOG("[%s::test_parallel_gtn_cost] %.6fms (avg)", __func__, totalCost / threads);
 }
 
+static void SetScheduler(bool workStealing)
+{
+	// scheduler can only be switched while the pool is empty
+	ThreadPool::SetThreadCount(0);
+	ThreadPool::SetWorkStealing(workStealing);
+	ThreadPool::SetThreadCount(NUM_THREADS);
+}
+
+TEST_CASE("test_work_stealing")
+{
+	LOG("[%s::test_work_stealing]", __func__);
+
+	SetScheduler(true);
+	CHECK(ThreadPool::UseWorkStealing());
+	CHECK(ThreadPool::GetNumThreads() == NUM_THREADS);
+
+	{
+		std::vector<int> nums(NUM_RUNS, 0);
+		std::atomic<int> cnt(0);
+
+		for_mt(0, NUM_RUNS, [&](const int i) {
+			const int threadnum = ThreadPool::GetThreadNum();
+			SAFE_CHECK(threadnum < NUM_THREADS);
+			SAFE_CHECK(threadnum >= 0);
+			nums[i] += 1;
+			++cnt;
+		});
+
+		CHECK(cnt == NUM_RUNS);
+		CHECK(std::count(nums.begin(), nums.end(), 1) == NUM_RUNS);
+	}
+	{
+		// nested loops push their slices onto the worker deques
+		std::atomic<int> cnt(0);
+
+		for_mt(0, 100, [&](const int y) {
+			for_mt(0, 100, [&](const int x) {
+				++cnt;
+			});
+		});
+
+		CHECK(cnt == (100 * 100));
+	}
+	{
+		std::vector<int> nums(NUM_RUNS, 0);
+
+		for_mt_chunk(0, NUM_RUNS, [&](const int i) {
+			nums[i] += 1;
+		});
+
+		CHECK(std::count(nums.begin(), nums.end(), 1) == NUM_RUNS);
+	}
+
+	SetScheduler(false);
+	CHECK(!ThreadPool::UseWorkStealing());
+}
+
+
+
+static spring_time scheduler_throughput_kernel(bool workStealing, int numRuns, int numElems)
+{
+	SetScheduler(workStealing);
+
+	const auto& ExecKernel = [](const spring_time t) {
+		const spring_time finish = spring_now() + t;
+		while (spring_now() < finish) {}
+	};
+
+	const spring_time start = spring_now();
+
+	for (int n = 0; n < numRuns; ++n) {
+		// skewed load: the last few elements are much more expensive than
+		// the rest, which strands a static per-thread split on one worker
+		for_mt_chunk(0, numElems, [&](const int i) {
+			ExecKernel(spring_time::fromMicroSecs(1 + 49 * (i >= (numElems - numElems / 8))));
+		});
+	}
+
+	return (spring_now() - start);
+}
+
+static float scheduler_latency_kernel(bool workStealing, int numRuns)
+{
+	SetScheduler(workStealing);
+
+	float sumWakeupTime = 0.0f;
+
+	for (int n = 0; n < numRuns; ++n) {
+		const spring_time start = spring_now();
+		std::atomic<float> firstWakeupTime = {-1.0f};
+
+		for_mt(0, NUM_THREADS * 4, [&](const int i) {
+			if (ThreadPool::GetThreadNum() == 0)
+				return;
+
+			float expected = -1.0f;
+			firstWakeupTime.compare_exchange_strong(expected, (spring_now() - start).toMilliSecsf());
+		});
+
+		sumWakeupTime += std::max(firstWakeupTime.load(), 0.0f);
+	}
+
+	return (sumWakeupTime / numRuns);
+}
+
+TEST_CASE("test_work_stealing_vs_shared_queue")
+{
+	LOG("[%s::test_work_stealing_vs_shared_queue]", __func__);
+
+	for (const int numElems: {NUM_THREADS * 8, 1000, 4000}) {
+		const spring_time tShared = scheduler_throughput_kernel(false, 20, numElems);
+		const spring_time tSteal  = scheduler_throughput_kernel( true, 20, numElems);
+
+		LOG("\tthroughput (%d skewed elements x 20 runs)", numElems);
+		LOG("\t\tshared queue   took %.4fms", tShared.toMilliSecsf());
+		LOG("\t\twork stealing  took %.4fms", tSteal.toMilliSecsf());
+		LOG("\t\tstealing runtime: %.0f%%", (tSteal.toMilliSecsf() / std::max(tShared.toMilliSecsf(), 1e-3f)) * 100.0f);
+	}
+
+	{
+		const float lShared = scheduler_latency_kernel(false, NUM_RUNS / 10);
+		const float lSteal  = scheduler_latency_kernel( true, NUM_RUNS / 10);
+
+		LOG("\tfirst-worker latency (avg over %d for_mt's)", NUM_RUNS / 10);
+		LOG("\t\tshared queue   %.6fms", lShared);
+		LOG("\t\twork stealing  %.6fms", lSteal);
+	}
+
+	SetScheduler(false);
+	CHECK(!ThreadPool::UseWorkStealing());
+}
+
 TEST_CASE("Cleanup")
 {
 	ThreadPool::SetThreadCount(0);
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+#
+# Compares the --frame-stats summary of a validation run (see run.sh) with
+# a stored baseline and reports the figures that got worse by more than the
+# threshold. The games of two runs need not end on the same frame, so sim,
+# draw and Lua times and path requests are compared per frame (mean and 95th
+# percentile), and so are the totals of the profiler timers. The profiler's
+# other counters are left out, more of them (e.g. cache hits) is not worse.
+#
+# Usage: ./compare-stats.py [-t percent] [-m ms] [-a] <baseline.json> <current.json>
+# Exits with status 1 if any figure regressed by more than the threshold,
+# 2 if either file can not be read.
+
+import argparse
+import json
+import sys
+
+
+def GetFigures(stats):
+	numFrames = max(stats.get("frames", 0), 1)
+	figures = {}
+
+	for name, summary in stats.get("summary", {}).items():
+		figures[name + "::mean"] = summary.get("mean", 0.0)
+		figures[name + "::p95"] = summary.get("p95", 0.0)
+
+	for name, total in stats.get("profile", {}).get("timers", {}).items():
+		figures[name] = total / numFrames
+
+	return figures
+
+
+def main():
+	parser = argparse.ArgumentParser(description = "compare the --frame-stats summary of a validation run against a baseline")
+	parser.add_argument("-t", "--threshold", type = float, default = 10.0, help = "percentage a figure may get worse (default 10)")
+	parser.add_argument("-m", "--min-value", type = float, default = 0.05, help = "ignore figures below this (ms or count per frame) in the baseline (default 0.05)")
+	parser.add_argument("-a", "--all", action = "store_true", help = "list all compared figures, not just the regressed ones")
+	parser.add_argument("baseline")
+	parser.add_argument("current")
+	args = parser.parse_args()
+
+	try:
+		with open(args.baseline) as f:
+			baseStats = json.load(f)
+		with open(args.current) as f:
+			currStats = json.load(f)
+	except (OSError, ValueError) as e:
+		print("could not read frame statistics: %s" % e)
+		return 2
+
+	baseFigures = GetFigures(baseStats)
+	currFigures = GetFigures(currStats)
+
+	numRegressions = 0
+
+	print("baseline %d frames, current %d frames (per-frame figures)" % (baseStats.get("frames", 0), currStats.get("frames", 0)))
+
+	for name in sorted(baseFigures):
+		baseValue = baseFigures[name]
+		currValue = currFigures.get(name, 0.0)
+
+		if baseValue < args.min_value:
+			continue
+
+		change = (currValue / baseValue - 1.0) * 100.0
+		regressed = (change > args.threshold)
+
+		if regressed or args.all:
+			print("\t%-48s %10.3f %10.3f %+7.1f%%%s" % (name, baseValue, currValue, change, "  REGRESSION" if regressed else ""))
+
+		numRegressions += regressed
+
+	return (1 if numRegressions > 0 else 0)
+
+
+if __name__ == "__main__":
+	sys.exit(main())
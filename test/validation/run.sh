@@ -22,12 +22,18 @@ if [ "$(cat /proc/sys/kernel/core_uses_pid)" != "1" ]; then
 	exit 1
 fi
 
-echo "Env: GAME=$GAME MAP=$MAP AI=$AI AIVER=$AIVER"
+# per-frame timings of the host, compared with $BASELINE (a FRAMESTATS file
+# of an earlier run) if given; figures more than $THRESHOLD percent worse fail
+FRAMESTATS=${FRAMESTATS:-$(pwd)/framestats.json}
+THRESHOLD=${THRESHOLD:-10}
+
+echo "Env: GAME=$GAME MAP=$MAP AI=$AI AIVER=$AIVER FRAMESTATS=$FRAMESTATS BASELINE=$BASELINE THRESHOLD=$THRESHOLD"
 
 # enable core dumps
 ulimit -c unlimited
 
 RUNCLIENT=test/validation/run-client.sh
+COMPARESTATS=test/validation/compare-stats.py
 
 if [ ! -x $RUNCLIENT ]; then
 	echo "$RUNCLIENT doesn't exist, please run from the source-root directory"
@@ -42,6 +48,7 @@ ulimit -t 300
 
 # delete path cache
 rm -rf ~/.config/spring/cache/
+rm -f "$FRAMESTATS"
 
 if [ "$GAME" != "devgame:test" ];
 then
@@ -53,7 +60,7 @@ fi
 # start host
 echo "Starting Host"
 set +e #temp disable abort on error
-$@ --nocolor &
+$@ --nocolor --frame-stats "$FRAMESTATS" &
 PID_HOST=$!
 
 # auto kill host after 15mins
@@ -85,5 +92,22 @@ then
 fi
 
 echo Server exited with $EXIT
-exit $EXIT
+
+if [ $EXIT -ne 0 ]; then
+	exit $EXIT
+fi
+
+if [ ! -s "$FRAMESTATS" ]; then
+	echo "$FRAMESTATS wasn't written"
+	exit 1
+fi
+
+if [ -n "$BASELINE" ]; then
+	echo "Comparing $FRAMESTATS with $BASELINE"
+	set +e
+	$COMPARESTATS -t $THRESHOLD "$BASELINE" "$FRAMESTATS"
+	exit $?
+fi
+
+exit 0
 
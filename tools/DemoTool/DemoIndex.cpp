@@ -0,0 +1,390 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DemoIndex.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+
+#include "System/FileSystem/FileSystemAbstraction.h"
+#include "System/LoadSave/DemoReader.h"
+#include "System/Net/RawPacket.h"
+
+namespace {
+	constexpr char INDEX_MAGIC[8] = {'S', 'P', 'R', 'D', 'I', 'D', 'X', 0};
+
+	template<typename T> T ReadAt(const uint8_t* data, size_t offset) {
+		T value;
+		std::memcpy(&value, data + offset, sizeof(T));
+		return value;
+	}
+
+	// null-terminated string starting at offset, if the packet is long enough
+	std::string ReadString(const uint8_t* data, size_t length, size_t offset) {
+		if (offset >= length)
+			return "";
+
+		const char* str = reinterpret_cast<const char*>(data + offset);
+		return {str, strnlen(str, length - offset)};
+	}
+
+
+	template<typename T> void Write(std::ofstream& file, const T& value) {
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+	template<typename T> void WriteVector(std::ofstream& file, const std::vector<T>& values) {
+		Write(file, uint32_t(values.size()));
+		file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+	}
+	void WriteString(std::ofstream& file, const std::string& str) {
+		Write(file, uint32_t(str.size()));
+		file.write(str.data(), str.size());
+	}
+
+	template<typename T> bool Read(std::ifstream& file, T& value) {
+		return (file.read(reinterpret_cast<char*>(&value), sizeof(T)).good());
+	}
+	template<typename T> bool ReadVector(std::ifstream& file, std::vector<T>& values) {
+		uint32_t size = 0;
+
+		if (!Read(file, size))
+			return false;
+
+		values.resize(size);
+		return (file.read(reinterpret_cast<char*>(values.data()), size * sizeof(T)).good() || size == 0);
+	}
+	bool ReadString(std::ifstream& file, std::string& str) {
+		uint32_t size = 0;
+
+		if (!Read(file, size))
+			return false;
+
+		str.resize(size);
+		return (file.read(&str[0], size).good() || size == 0);
+	}
+}
+
+
+void CDemoIndex::Build(const std::string& demoFileName)
+{
+	CDemoReader reader(demoFileName, 0.0f);
+	reader.LoadStats();
+
+	*this = {};
+
+	demoFileSize = FileSystemAbstraction::GetFileSize(demoFileName);
+	demoModTime = FileSystemAbstraction::GetFileModificationTime(demoFileName);
+	gameTime = reader.GetFileHeader().gameTime;
+	playerStats = reader.GetPlayerStats();
+
+	const auto SetPlayerName = [&](uint8_t player, std::string&& name) {
+		if (player >= playerNames.size())
+			playerNames.resize(player + 1);
+
+		playerNames[player] = std::move(name);
+	};
+
+	// same frame counting as TrafficDump
+	int32_t frame = -1;
+
+	while (!reader.ReachedEnd()) {
+		const uint32_t streamPos = reader.GetStreamPos();
+		const std::unique_ptr<netcode::RawPacket> packet(reader.GetData(std::numeric_limits<float>::max()));
+
+		if (packet == nullptr || packet->length == 0)
+			continue;
+
+		const uint8_t* data = packet->data;
+		const uint32_t length = packet->length;
+		const uint8_t type = data[0];
+
+		if (type >= NETMSG_LAST)
+			continue;
+
+		typeCounts[type] += 1;
+		typeBytes[type] += length;
+
+		switch (type) {
+			case NETMSG_KEYFRAME: {
+				frame = (length >= 5)? ReadAt<int32_t>(data, 1): (frame + 1);
+			} break;
+			case NETMSG_NEWFRAME: {
+				frame += 1;
+			} break;
+			default: {
+			} break;
+		}
+
+		while (int64_t(frameTable.size()) * FRAME_TABLE_STRIDE <= frame) {
+			frameTable.push_back(streamPos);
+		}
+
+		switch (type) {
+			case NETMSG_KEYFRAME:
+			case NETMSG_NEWFRAME:
+			case NETMSG_SYNCRESPONSE:
+			case NETMSG_SYNCTREE:
+			case NETMSG_PLAYERINFO:
+			case NETMSG_GAME_FRAME_PROGRESS: {
+				continue;
+			} break;
+
+			case NETMSG_CHAT: {
+				if (length >= 4)
+					chatMessages.push_back({frame, data[2], data[3], ReadString(data, length, 4)});
+			} break;
+			case NETMSG_PLAYERNAME: {
+				if (length >= 3)
+					SetPlayerName(data[2], ReadString(data, length, 3));
+			} break;
+			case NETMSG_CREATE_NEWPLAYER: {
+				if (length >= 6)
+					SetPlayerName(data[3], ReadString(data, length, 6));
+			} break;
+			default: {
+			} break;
+		}
+
+		Packet p = {frame, streamPos, 0, uint16_t(std::min(length, uint32_t(std::numeric_limits<uint16_t>::max()))), type, GetPacketPlayer(data, length)};
+
+		switch (type) {
+			case NETMSG_COMMAND: {
+				if (length >= 8)
+					p.cmdID = ReadAt<int32_t>(data, 4);
+			} break;
+			case NETMSG_AICOMMAND:
+			case NETMSG_AICOMMAND_TRACKED: {
+				if (length >= 11)
+					p.cmdID = ReadAt<int32_t>(data, 7);
+			} break;
+			case NETMSG_AICOMMANDS: {
+				// zero unless all commands of the packet share their ID
+				if (length >= 10)
+					p.cmdID = ReadAt<int32_t>(data, 6);
+			} break;
+			default: {
+			} break;
+		}
+
+		packets.push_back(p);
+	}
+
+	numFrames = frame + 1;
+}
+
+
+bool CDemoIndex::Load(const std::string& indexFileName, const std::string& demoFileName)
+{
+	std::ifstream file(indexFileName, std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	char magic[sizeof(INDEX_MAGIC)];
+	uint32_t version = 0;
+	uint32_t packetSize = 0;
+	uint32_t playerStatSize = 0;
+	uint32_t numTypes = 0;
+
+	if (!file.read(magic, sizeof(magic)).good() || std::memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0)
+		return false;
+	if (!Read(file, version) || !Read(file, packetSize) || !Read(file, playerStatSize) || !Read(file, numTypes))
+		return false;
+	if (version != VERSION || packetSize != sizeof(Packet) || playerStatSize != sizeof(PlayerStatistics) || numTypes != NETMSG_LAST)
+		return false;
+
+	if (!Read(file, demoFileSize) || !Read(file, demoModTime))
+		return false;
+
+	// stale if the demo was replaced (or is still being written)
+	if (demoFileSize != FileSystemAbstraction::GetFileSize(demoFileName))
+		return false;
+	if (demoModTime != FileSystemAbstraction::GetFileModificationTime(demoFileName))
+		return false;
+
+	if (!Read(file, numFrames) || !Read(file, gameTime))
+		return false;
+
+	if (!ReadVector(file, packets) || !ReadVector(file, frameTable))
+		return false;
+	if (!ReadVector(file, typeCounts) || !ReadVector(file, typeBytes) || !ReadVector(file, playerStats))
+		return false;
+
+	uint32_t numNames = 0;
+	uint32_t numChats = 0;
+
+	if (!Read(file, numNames))
+		return false;
+
+	playerNames.resize(numNames);
+
+	for (std::string& name: playerNames) {
+		if (!ReadString(file, name))
+			return false;
+	}
+
+	if (!Read(file, numChats))
+		return false;
+
+	chatMessages.resize(numChats);
+
+	for (ChatMessage& cm: chatMessages) {
+		if (!Read(file, cm.frame) || !Read(file, cm.player) || !Read(file, cm.destination) || !ReadString(file, cm.message))
+			return false;
+	}
+
+	return true;
+}
+
+bool CDemoIndex::Save(const std::string& indexFileName) const
+{
+	// several DemoTool instances may index the same demo, none must see a partial file
+	const std::string tmpFileName = indexFileName + ".tmp";
+
+	{
+		std::ofstream file(tmpFileName, std::ios::out | std::ios::binary);
+
+		if (!file.is_open())
+			return false;
+
+		file.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+
+		Write(file, VERSION);
+		Write(file, uint32_t(sizeof(Packet)));
+		Write(file, uint32_t(sizeof(PlayerStatistics)));
+		Write(file, uint32_t(NETMSG_LAST));
+
+		Write(file, demoFileSize);
+		Write(file, demoModTime);
+		Write(file, numFrames);
+		Write(file, gameTime);
+
+		WriteVector(file, packets);
+		WriteVector(file, frameTable);
+		WriteVector(file, typeCounts);
+		WriteVector(file, typeBytes);
+		WriteVector(file, playerStats);
+
+		Write(file, uint32_t(playerNames.size()));
+
+		for (const std::string& name: playerNames) {
+			WriteString(file, name);
+		}
+
+		Write(file, uint32_t(chatMessages.size()));
+
+		for (const ChatMessage& cm: chatMessages) {
+			Write(file, cm.frame);
+			Write(file, cm.player);
+			Write(file, cm.destination);
+			WriteString(file, cm.message);
+		}
+
+		if (!file.good()) {
+			file.close();
+			std::remove(tmpFileName.c_str());
+			return false;
+		}
+	}
+
+	// rename does not replace an existing file on every platform
+	std::remove(indexFileName.c_str());
+
+	if (std::rename(tmpFileName.c_str(), indexFileName.c_str()) != 0) {
+		std::remove(tmpFileName.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+bool CDemoIndex::IsActionPacket(uint8_t type)
+{
+	switch (type) {
+		case NETMSG_COMMAND:
+		case NETMSG_SELECT:
+		case NETMSG_SELECT_PACKED:
+		case NETMSG_AICOMMAND:
+		case NETMSG_AICOMMANDS:
+		case NETMSG_AICOMMAND_TRACKED: {
+			return true;
+		} break;
+		default: {
+		} break;
+	}
+
+	return false;
+}
+
+uint8_t CDemoIndex::GetPacketPlayer(const uint8_t* data, size_t length)
+{
+	size_t offset = 0;
+
+	switch (data[0]) {
+		// uint8_t playerNum first
+		case NETMSG_PATH_CHECKSUM:
+		case NETMSG_PAUSE:
+		case NETMSG_USER_SPEED:
+		case NETMSG_DIRECT_CONTROL:
+		case NETMSG_DC_UPDATE:
+		case NETMSG_SHARE:
+		case NETMSG_SETSHARE:
+		case NETMSG_PLAYERSTAT:
+		case NETMSG_SYNCRESPONSE:
+		case NETMSG_STARTPOS:
+		case NETMSG_PLAYERINFO:
+		case NETMSG_PLAYERLEFT:
+		case NETMSG_TEAM:
+		case NETMSG_ALLIANCE:
+		case NETMSG_AI_STATE_CHANGED: {
+			offset = 1;
+		} break;
+
+		// preceded by an uint8_t message size
+		case NETMSG_PLAYERNAME:
+		case NETMSG_CHAT:
+		case NETMSG_GAMEOVER:
+		case NETMSG_MAPDRAW:
+		case NETMSG_AI_CREATED: {
+			offset = 2;
+		} break;
+
+		// preceded by an uint16_t message size
+		case NETMSG_COMMAND:
+		case NETMSG_SELECT:
+		case NETMSG_AICOMMAND:
+		case NETMSG_AICOMMANDS:
+		case NETMSG_AICOMMAND_TRACKED:
+		case NETMSG_AISHARE:
+		case NETMSG_SYSTEMMSG:
+		case NETMSG_LUAMSG:
+		case NETMSG_CREATE_NEWPLAYER:
+		case NETMSG_SELECT_PACKED:
+		case NETMSG_SYNCTREE: {
+			offset = 3;
+		} break;
+
+		default: {
+		} break;
+	}
+
+	if (offset == 0 || offset >= length)
+		return NO_PLAYER;
+
+	return data[offset];
+}
+
+
+const std::string& CDemoIndex::GetPlayerName(uint8_t player) const
+{
+	static const std::string UNKNOWN_NAME = "<unknown>";
+
+	if (player >= playerNames.size() || playerNames[player].empty())
+		return UNKNOWN_NAME;
+
+	return playerNames[player];
+}
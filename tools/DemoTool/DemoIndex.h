@@ -0,0 +1,84 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEMO_INDEX_H
+#define DEMO_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Game/Players/PlayerStatistics.h"
+#include "Net/Protocol/NetMessageTypes.h"
+
+/**
+ * What DemoTool queries need from a demo, gathered in one streaming pass over
+ * its packets and cached as <demo>.idx, so later queries over many demos read
+ * the (much smaller) index instead of decompressing and parsing the demo.
+ *
+ * The index is a cache and written in host byte order; it is rebuilt when its
+ * version or the size or modification time of the demo do not match.
+ */
+class CDemoIndex {
+public:
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint8_t NO_PLAYER = 0xFF;
+	// frames between two entries of the seek table
+	static constexpr int32_t FRAME_TABLE_STRIDE = 30;
+
+	struct Packet {
+		int32_t frame;
+		// offset of the packet's chunk in the demo stream, see CDemoReader::GetStreamPos
+		uint32_t streamPos;
+		// command ID of (AI)COMMAND packets, zero otherwise
+		int32_t cmdID;
+		uint16_t length;
+		uint8_t type;
+		uint8_t player;
+	};
+
+	struct ChatMessage {
+		int32_t frame;
+		uint8_t player;
+		uint8_t destination;
+		std::string message;
+	};
+
+public:
+	/// @throw std::runtime_error if the demo can not be opened
+	void Build(const std::string& demoFileName);
+	/// false if there is no index or it does not match the demo (anymore)
+	bool Load(const std::string& indexFileName, const std::string& demoFileName);
+	bool Save(const std::string& indexFileName) const;
+
+	/// command and selection packets, which count towards a player's APM
+	static bool IsActionPacket(uint8_t type);
+	/// sending player of a packet, NO_PLAYER if its type has none
+	static uint8_t GetPacketPlayer(const uint8_t* data, size_t length);
+
+	const std::string& GetPlayerName(uint8_t player) const;
+
+public:
+	uint64_t demoFileSize = 0;
+	uint32_t demoModTime = 0;
+
+	int32_t numFrames = 0;
+	// seconds, from the demo header
+	int32_t gameTime = 0;
+
+	// every packet except the per-frame ones (frame markers, sync responses,
+	// player info), which only show up in typeCounts and typeBytes
+	std::vector<Packet> packets;
+	std::vector<ChatMessage> chatMessages;
+
+	// [i] := stream offset of the first packet at or after frame i * FRAME_TABLE_STRIDE
+	std::vector<uint32_t> frameTable;
+
+	std::vector<uint32_t> typeCounts = std::vector<uint32_t>(NETMSG_LAST, 0);
+	std::vector<uint64_t> typeBytes = std::vector<uint64_t>(NETMSG_LAST, 0);
+
+	// indexed by player number, from PLAYERNAME and CREATE_NEWPLAYER packets
+	std::vector<std::string> playerNames;
+	std::vector<PlayerStatistics> playerStats;
+};
+
+#endif // DEMO_INDEX_H
@@ -3,20 +3,31 @@
 #include <string>
 #include <map>
 #include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
 #include <gflags/gflags.h>
 #include <iomanip> //hex
 
 #include "StringSerializer.h"
+#include "DemoIndex.h"
 
 #include "Net/Protocol/BaseNetProtocol.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/Net/RawPacket.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Units/CommandAI/Command.h"
 
 /*
 Usage:
 Start with the full! path to the demofile as the only argument
 
+With --index, --commands, --apm or --chat any number of demos can be given;
+each is indexed once (see DemoIndex.h) and the queries then run on the index,
+several demos in parallel (--jobs).
+
 Please note that not all NETMSG's are implemented, expand if needed.
 
 When compiling for windows with MinGW, make sure to use the
@@ -32,17 +43,45 @@ no console output (you still could use this.exe > z.tzt though).
 	DEFINE_bool  (teamstats,    false, "Print teamstats");
 	DEFINE_int32 (team,         -1,    "Select team");
 	DEFINE_string(teamsstatcsv, "",    "Write teamstats in a csv file");
+	DEFINE_bool  (index,        false, "Build (or refresh) the index of each given demo");
+	DEFINE_string(indexdir,     "",    "Directory for demo indices, default is next to each demo");
+	DEFINE_int32 (jobs,         0,     "Number of demos processed in parallel, 0 for one per hardware thread");
+	DEFINE_int32 (player,       -1,    "Select player");
+	DEFINE_bool  (commands,     false, "Print the commands of all (or the selected) player(s)");
+	DEFINE_bool  (apm,          false, "Print actions per minute of each player and an APM histogram over all demos");
+	DEFINE_bool  (chat,         false, "Print chat messages");
 
 
 void TrafficDump(CDemoReader& reader, bool trafficStats);
 void WriteTeamstatHistory(CDemoReader& reader, unsigned team, const std::string& file);
+int RunIndexQueries(const std::vector<std::string>& demoFiles);
 
 int main (int argc, char* argv[])
 {
 	std::string filename;
 
-	gflags::SetUsageMessage(std::string("Usage: ") + argv[0] + " [options] path_to_demo.sdfz");
+	gflags::SetUsageMessage(std::string("Usage: ") + argv[0] + " [options] path_to_demo.sdfz [more demos for index queries]");
 	gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+	if (FLAGS_index || FLAGS_commands || FLAGS_apm || FLAGS_chat) {
+		std::vector<std::string> demoFiles;
+
+		if (!FLAGS_demofile.empty())
+			demoFiles.push_back(FLAGS_demofile);
+
+		for (int i = 1; i < argc; i++) {
+			demoFiles.emplace_back(argv[i]);
+		}
+
+		if (demoFiles.empty()) {
+			std::cout << "No demofile given" << std::endl;
+			gflags::ShowUsageWithFlags(argv[0]);
+			return 1;
+		}
+
+		return RunIndexQueries(demoFiles);
+	}
+
 	if (!FLAGS_demofile.empty()) {
 		filename = FLAGS_demofile;
 	} else if (argc >= 2) {
@@ -183,6 +222,194 @@ const std::string& GetCommandName(int commandId)
 	return CMD_NAME_UNKNOWN;
 }
 
+
+// minutes of game time are bucketed in steps of this many APM for the histogram
+static constexpr unsigned APM_HISTOGRAM_STEP = 10;
+
+struct DemoQueryResult {
+	std::ostringstream output;
+	// actions in each minute of each player that gave any
+	std::vector<unsigned> minuteActions;
+	bool failed = false;
+};
+
+std::string GetIndexFileName(const std::string& demoFile)
+{
+	if (FLAGS_indexdir.empty())
+		return demoFile + ".idx";
+
+	const size_t sep = demoFile.find_last_of("/\\");
+	const std::string baseName = (sep == std::string::npos)? demoFile: demoFile.substr(sep + 1);
+
+	return FLAGS_indexdir + "/" + baseName + ".idx";
+}
+
+void PrintIndexCommands(const CDemoIndex& index, std::ostream& out)
+{
+	for (const CDemoIndex::Packet& p: index.packets) {
+		switch (p.type) {
+			case NETMSG_COMMAND:
+			case NETMSG_AICOMMAND:
+			case NETMSG_AICOMMAND_TRACKED:
+			case NETMSG_AICOMMANDS: {
+			} break;
+			default: {
+				continue;
+			} break;
+		}
+
+		if (FLAGS_player >= 0 && p.player != FLAGS_player)
+			continue;
+
+		char buf[16];
+		snprintf(buf, sizeof(buf), "%06d ", p.frame);
+
+		out << buf << "Player: " << (unsigned)p.player << " (" << index.GetPlayerName(p.player) << ")";
+
+		// AICOMMANDS only carries a single ID if all its commands share it
+		if (p.type == NETMSG_AICOMMANDS && p.cmdID == 0) {
+			out << " CommandId: <MIXED>" << std::endl;
+		} else {
+			out << " CommandId: " << GetCommandName(p.cmdID) << "(" << p.cmdID << ")" << std::endl;
+		}
+	}
+}
+
+void PrintIndexAPM(const CDemoIndex& index, DemoQueryResult& result)
+{
+	constexpr int FRAMES_PER_MINUTE = GAME_SPEED * 60;
+
+	const unsigned numMinutes = (std::max(index.numFrames, 1) + FRAMES_PER_MINUTE - 1) / FRAMES_PER_MINUTE;
+	const float gameMinutes = std::max(index.numFrames, 1) / float(FRAMES_PER_MINUTE);
+
+	std::map<unsigned, std::vector<unsigned>> playerMinuteActions;
+
+	for (const CDemoIndex::Packet& p: index.packets) {
+		if (!CDemoIndex::IsActionPacket(p.type) || p.player == CDemoIndex::NO_PLAYER)
+			continue;
+		if (FLAGS_player >= 0 && p.player != FLAGS_player)
+			continue;
+
+		std::vector<unsigned>& minuteActions = playerMinuteActions[p.player];
+
+		minuteActions.resize(numMinutes, 0);
+		minuteActions[std::min(unsigned(std::max(p.frame, 0) / FRAMES_PER_MINUTE), numMinutes - 1)] += 1;
+	}
+
+	for (const auto& pair: playerMinuteActions) {
+		unsigned numActions = 0;
+
+		for (unsigned actions: pair.second) {
+			numActions += actions;
+		}
+
+		result.output << "Player: " << pair.first << " (" << index.GetPlayerName(pair.first) << ")";
+		result.output << " Actions: " << numActions << " Minutes: " << gameMinutes;
+		result.output << " APM: " << (numActions / gameMinutes) << std::endl;
+
+		result.minuteActions.insert(result.minuteActions.end(), pair.second.begin(), pair.second.end());
+	}
+}
+
+void PrintIndexChat(const CDemoIndex& index, std::ostream& out)
+{
+	for (const CDemoIndex::ChatMessage& cm: index.chatMessages) {
+		if (FLAGS_player >= 0 && cm.player != FLAGS_player)
+			continue;
+
+		char buf[16];
+		snprintf(buf, sizeof(buf), "%06d ", cm.frame);
+
+		out << buf << "Player: " << (unsigned)cm.player << " (" << index.GetPlayerName(cm.player) << ")";
+		out << " Destination: " << (unsigned)cm.destination << " Msg: " << cm.message << std::endl;
+	}
+}
+
+void QueryDemo(const std::string& demoFile, DemoQueryResult& result)
+{
+	const std::string indexFile = GetIndexFileName(demoFile);
+
+	CDemoIndex index;
+
+	result.output << "-- " << demoFile << " --" << std::endl;
+
+	if (!index.Load(indexFile, demoFile)) {
+		try {
+			index.Build(demoFile);
+		} catch (const std::runtime_error& e) {
+			result.output << "Could not index demo: " << e.what() << std::endl;
+			result.failed = true;
+			return;
+		}
+
+		if (!index.Save(indexFile))
+			result.output << "Could not write index " << indexFile << std::endl;
+
+		if (FLAGS_index)
+			result.output << "Indexed " << index.packets.size() << " packets, " << index.numFrames << " frames" << std::endl;
+	} else if (FLAGS_index) {
+		result.output << "Index is up to date" << std::endl;
+	}
+
+	if (FLAGS_commands)
+		PrintIndexCommands(index, result.output);
+	if (FLAGS_apm)
+		PrintIndexAPM(index, result);
+	if (FLAGS_chat)
+		PrintIndexChat(index, result.output);
+}
+
+int RunIndexQueries(const std::vector<std::string>& demoFiles)
+{
+	// read-only after this, shared by all workers
+	InitCommandNames();
+
+	std::vector<DemoQueryResult> results(demoFiles.size());
+	std::vector<std::thread> workers;
+	std::atomic<size_t> nextDemo = {0};
+
+	const unsigned numJobs = (FLAGS_jobs > 0)? FLAGS_jobs: std::max(std::thread::hardware_concurrency(), 1u);
+	const auto Work = [&]() {
+		for (size_t i = nextDemo++; i < demoFiles.size(); i = nextDemo++) {
+			QueryDemo(demoFiles[i], results[i]);
+		}
+	};
+
+	for (unsigned i = 1, n = std::min(size_t(numJobs), demoFiles.size()); i < n; i++) {
+		workers.emplace_back(Work);
+	}
+
+	Work();
+
+	for (std::thread& worker: workers) {
+		worker.join();
+	}
+
+	// printed in input order, independent of which worker finished first
+	std::map<unsigned, unsigned> apmHistogram;
+	int ret = 0;
+
+	for (const DemoQueryResult& result: results) {
+		std::cout << result.output.str();
+
+		for (unsigned actions: result.minuteActions) {
+			apmHistogram[actions / APM_HISTOGRAM_STEP] += 1;
+		}
+
+		ret |= int(result.failed);
+	}
+
+	if (FLAGS_apm && !apmHistogram.empty()) {
+		std::cout << "-- APM histogram (player minutes) --" << std::endl;
+
+		for (const auto& pair: apmHistogram) {
+			std::cout << std::setw(4) << (pair.first * APM_HISTOGRAM_STEP) << "-" << std::setw(4) << std::left << ((pair.first + 1) * APM_HISTOGRAM_STEP - 1) << std::right << " " << pair.second << std::endl;
+		}
+	}
+
+	return ret;
+}
+
 void PrintBinary(const unsigned char* const buf, int len)
 {
 	for(int i=0; i<len; i++) {
@@ -342,6 +569,12 @@ void TrafficDump(CDemoReader& reader, bool trafficStats)
 				}
 				std::cout << std::endl;
 				break;
+			case NETMSG_SELECT_PACKED:
+				std::cout << "NETMSG_SELECT_PACKED: Playernum: " << (unsigned)buffer[3];
+				std::cout << " Length: " << (unsigned)packet->length;
+				std::cout << " Encoding: " << (unsigned)buffer[4];
+				std::cout << std::endl;
+				break;
 			case NETMSG_GAMEOVER:
 				std::cout << "NETMSG_GAMEOVER";
 				std::cout << " Length: " << (unsigned)packet->length;
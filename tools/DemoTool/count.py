@@ -1,6 +1,7 @@
 #!/usr/bin/python
 # counts cmds between NEWFRAMES and prints anything above 400
 # usage: ./demotool -d /path/to/some/demo.sdf |./count.py
+# (for per-player command lists or APM over many demos, see demotool --commands / --apm)
 import sys
 import fileinput
 
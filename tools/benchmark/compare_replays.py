@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+#
+# Compares the replay statistics written by two --replay-list runs (see
+# run_replays.sh) and reports timers that got slower than the baseline.
+# Each replays/<demo>.json holds the wall-clock time of the replay and the
+# total time spent in every profiler timer ("profile" object, in ms).
+#
+# A demo replays the same frames on every run, so a differing frame count
+# means the simulation diverged and its timings can not be compared.
+#
+# Usage: ./compare_replays.py [-t percent] [-m ms] [-a] <baseline-dir> <current-dir>
+# Exits with status 1 if any timer (or a whole replay) regressed by more
+# than the threshold, 2 if a replay diverged or is missing.
+
+import argparse
+import glob
+import json
+import os
+import sys
+
+
+def LoadStats(dirName):
+	stats = {}
+
+	for path in sorted(glob.glob(os.path.join(dirName, "*.json"))):
+		with open(path) as f:
+			stats[os.path.basename(path)] = json.load(f)
+
+	return stats
+
+
+def GetTimings(replay):
+	timings = {"<replay>": replay.get("wallTime", 0.0)}
+	timings.update(replay.get("profile", {}).get("timers", {}))
+	return timings
+
+
+def main():
+	parser = argparse.ArgumentParser(description = "compare --replay-list benchmark runs against a baseline")
+	parser.add_argument("-t", "--threshold", type = float, default = 10.0, help = "percentage a timer may get slower (default 10)")
+	parser.add_argument("-m", "--min-time", type = float, default = 50.0, help = "ignore timers below this many ms in the baseline (default 50)")
+	parser.add_argument("-a", "--all", action = "store_true", help = "list all compared timers, not just the regressed ones")
+	parser.add_argument("baseline")
+	parser.add_argument("current")
+	args = parser.parse_args()
+
+	baseStats = LoadStats(args.baseline)
+	currStats = LoadStats(args.current)
+
+	if not baseStats:
+		print("no replay statistics in %s" % args.baseline)
+		return 2
+
+	numRegressions = 0
+	numErrors = 0
+
+	for name, baseReplay in baseStats.items():
+		currReplay = currStats.get(name)
+
+		if currReplay is None:
+			print("%s: missing from %s" % (name, args.current))
+			numErrors += 1
+			continue
+
+		if currReplay["frames"] != baseReplay["frames"]:
+			print("%s: diverged, %d frames instead of %d" % (name, currReplay["frames"], baseReplay["frames"]))
+			numErrors += 1
+			continue
+
+		baseTimings = GetTimings(baseReplay)
+		currTimings = GetTimings(currReplay)
+
+		print("%s (%d frames)" % (name, baseReplay["frames"]))
+
+		for timer in sorted(baseTimings):
+			baseTime = baseTimings[timer]
+			currTime = currTimings.get(timer, 0.0)
+
+			if baseTime < args.min_time:
+				continue
+
+			change = (currTime / baseTime - 1.0) * 100.0
+			regressed = (change > args.threshold)
+
+			if regressed or args.all:
+				print("\t%-40s %12.1fms %12.1fms %+7.1f%%%s" % (timer, baseTime, currTime, change, "  REGRESSION" if regressed else ""))
+
+			numRegressions += regressed
+
+	if numErrors > 0:
+		return 2
+
+	return (1 if numRegressions > 0 else 0)
+
+
+if __name__ == "__main__":
+	sys.exit(main())
@@ -0,0 +1,47 @@
+#!/bin/bash
+#
+# Replays a set of demos on the headless build and collects their statistics
+# (wall-clock time and per-subsystem profiler totals, see compare_replays.py).
+# Demos are deterministic, so recording one per scenario (mass units,
+# projectile spam, terraforming, pathing stress, Lua-heavy games, ...) once
+# and replaying it with every build gives comparable timings.
+#
+# Usage: ./run_replays.sh <demo-list> <result-dir> [runs]
+#   demo-list:  text file with one .sdfz path per line
+#   result-dir: receives <demo>.json for each demo; with more than one run
+#               the fastest replay of each demo is kept (results already
+#               in there count as earlier runs)
+#
+# SPRING selects the executable (default ./spring-headless), WRITEDIR a
+# scratch write-dir (default: a temporary directory).
+
+set -e
+shopt -s nullglob
+
+if [ $# -lt 2 ]; then
+	echo "usage: $0 <demo-list> <result-dir> [runs]"
+	exit 1
+fi
+
+SPRING=${SPRING:-./spring-headless}
+DEMOLIST=$(readlink -f "$1")
+RESULTDIR=$2
+RUNS=${3:-1}
+WRITEDIR=${WRITEDIR:-$(mktemp -d)}
+
+mkdir -p "$RESULTDIR"
+
+for (( i=1; i <= RUNS; i++ )); do
+	echo "Run $i/$RUNS"
+	rm -rf "$WRITEDIR/replays"
+
+	"$SPRING" --write-dir "$WRITEDIR" --replay-list "$DEMOLIST" >"$WRITEDIR/run-$i.log" 2>&1
+
+	for STATS in "$WRITEDIR"/replays/*.json; do
+		RESULT="$RESULTDIR/$(basename "$STATS")"
+
+		if ! [ -s "$RESULT" ] || python3 -c "import json, sys; sys.exit(json.load(open(sys.argv[1]))['wallTime'] >= json.load(open(sys.argv[2]))['wallTime'])" "$STATS" "$RESULT"; then
+			cp "$STATS" "$RESULT"
+		fi
+	done
+done
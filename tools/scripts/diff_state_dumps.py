@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+#
+# Compares two binary state dumps, as written by /DumpStateSnapshot or by
+# every client when the server asks for them on a sync tree mismatch (see
+# the SyncTreeStateDumps setting), and reports where they first diverge.
+# See DumpStateSnapshot in rts/System/Sync/DumpState.cpp for the layout.
+#
+# Objects are compared in dump order (RNG, teams, units, features,
+# projectiles, heightmap rows; IDs ascending), so the first difference is
+# usually the closest one to the cause of a desync.
+#
+# Usage: ./diff_state_dumps.py [-a] [-n count] <dump1> <dump2>
+
+import argparse
+import struct
+import sys
+
+DUMP_MAGIC = 0x44535053
+DUMP_VERSION = 1
+
+
+class StateDump:
+	def __init__(self, path):
+		with open(path, "rb") as f:
+			self.data = f.read()
+
+		self.offset = 0
+		(magic, version, self.frameNum, self.playerNum) = self.Read("<IIii")
+
+		if magic != DUMP_MAGIC or version != DUMP_VERSION:
+			raise ValueError("%s: not a version %d state dump" % (path, DUMP_VERSION))
+
+		self.kindNames = self.ReadNames()
+		self.fieldNames = self.ReadNames()
+
+	def Read(self, fmt):
+		values = struct.unpack_from(fmt, self.data, self.offset)
+		self.offset += struct.calcsize(fmt)
+		return values
+
+	def ReadNames(self):
+		names = []
+
+		for n in range(self.Read("<H")[0]):
+			size = self.Read("<B")[0]
+			names.append(self.data[self.offset: self.offset + size].decode("utf-8"))
+			self.offset += size
+
+		return names
+
+	# yields ((kind, id), {field: bytes}) per object
+	def Objects(self):
+		key = None
+		fields = {}
+
+		while self.offset < len(self.data):
+			(kind, objectID, field, size) = self.Read("<BiHH")
+			value = self.data[self.offset: self.offset + size]
+			self.offset += size
+
+			if (kind, objectID) != key:
+				if key is not None:
+					yield (key, fields)
+
+				key = (kind, objectID)
+				fields = {}
+
+			fields[field] = value
+
+		if key is not None:
+			yield (key, fields)
+
+
+# shows (up to) MAX_SHOWN_ELEMENTS 32-bit words from word <first> on, as hex and as float
+MAX_SHOWN_ELEMENTS = 8
+
+def FormatValue(value, first):
+	if len(value) == 0:
+		return "[]"
+	if len(value) % 4 != 0:
+		return value.hex()
+
+	count = len(value) // 4
+	words = struct.unpack("<%dI" % count, value)
+	floats = struct.unpack("<%df" % count, value)
+	shown = range(first, min(count, first + MAX_SHOWN_ELEMENTS))
+	return ("... " if first > 0 else "") + " ".join("%08x<%g>" % (words[i], floats[i]) for i in shown) + (" ..." if shown.stop < count else "")
+
+def FirstDifferingElement(value1, value2):
+	for i in range(0, min(len(value1), len(value2)), 4):
+		if value1[i: i + 4] != value2[i: i + 4]:
+			return i // 4
+
+	return min(len(value1), len(value2)) // 4
+
+def ObjectName(dump, key):
+	return "%s %d" % (dump.kindNames[key[0]], key[1])
+
+
+def Main():
+	parser = argparse.ArgumentParser(description = "report where two binary state dumps diverge")
+	parser.add_argument("-a", "--all", action = "store_true", help = "report every differing field instead of only the first")
+	parser.add_argument("-n", "--count", type = int, default = 32, help = "maximum number of differences to report with --all")
+	parser.add_argument("dump1")
+	parser.add_argument("dump2")
+	args = parser.parse_args()
+
+	dumps = [StateDump(args.dump1), StateDump(args.dump2)]
+
+	if dumps[0].frameNum != dumps[1].frameNum:
+		print("warning: comparing frame %d against frame %d" % (dumps[0].frameNum, dumps[1].frameNum))
+
+	# both dumps are sorted the same way, walk them as a merge
+	objects = [dumps[0].Objects(), dumps[1].Objects()]
+	current = [next(objects[0], None), next(objects[1], None)]
+	numDiffs = 0
+
+	while (current[0] is not None or current[1] is not None) and (numDiffs == 0 or (args.all and numDiffs < args.count)):
+		keys = [c[0] if c is not None else (0xFF, 0) for c in current]
+
+		if keys[0] != keys[1]:
+			# an object only one of the dumps has
+			side = 0 if keys[0] < keys[1] else 1
+			print("%s: only in %s" % (ObjectName(dumps[side], keys[side]), [args.dump1, args.dump2][side]))
+			current[side] = next(objects[side], None)
+			numDiffs += 1
+			continue
+
+		(fields1, fields2) = (current[0][1], current[1][1])
+
+		for field in sorted(set(fields1) | set(fields2)):
+			(value1, value2) = (fields1.get(field, b""), fields2.get(field, b""))
+
+			if value1 == value2:
+				continue
+
+			element = FirstDifferingElement(value1, value2)
+
+			print("%s, field %s (word %d):" % (ObjectName(dumps[0], keys[0]), dumps[0].fieldNames[field], element))
+			print("\t%s: %s" % (args.dump1, FormatValue(value1, element)))
+			print("\t%s: %s" % (args.dump2, FormatValue(value2, element)))
+			numDiffs += 1
+
+			if not args.all or numDiffs >= args.count:
+				break
+
+		current = [next(objects[0], None), next(objects[1], None)]
+
+	if numDiffs == 0:
+		print("frame %d: no differences" % dumps[0].frameNum)
+
+	return (1 if numDiffs > 0 else 0)
+
+if __name__ == "__main__":
+	sys.exit(Main())
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+#
+# Packs a directory (e.g. an .sdd game or map) into an .sds archive, the
+# per-file zstd format read by rts/System/FileSystem/Archives/ZstdArchive.
+# See ZstdArchive.h for the layout.
+#
+# Small text files (Lua sources, unit/feature/weapon definitions) are
+# compressed with a dictionary trained on them, everything else as a frame
+# of its own; files that do not shrink are stored.
+#
+# Requires the "zstandard" module (pip install zstandard).
+#
+# Usage: ./make_sds.py [-l level] <directory> <archive.sds>
+
+import argparse
+import os
+import struct
+import sys
+
+import zstandard
+
+METHOD_STORED    = 0
+METHOD_ZSTD      = 1
+METHOD_ZSTD_DICT = 2
+
+DICT_EXTENSIONS = (".lua", ".fbi", ".tdf", ".txt", ".glsl", ".vert", ".frag", ".h")
+DICT_MAX_FILE_SIZE = 64 * 1024
+DICT_MIN_SAMPLES = 16
+DICT_SIZE = 112 * 1024
+
+STORED_ALIGNMENT = 4096
+FRAME_ALIGNMENT = 16
+
+
+def ListFiles(rootDir):
+	files = []
+
+	for dirPath, dirNames, fileNames in os.walk(rootDir):
+		dirNames.sort()
+
+		for fileName in sorted(fileNames):
+			fullPath = os.path.join(dirPath, fileName)
+			files.append((os.path.relpath(fullPath, rootDir).replace(os.sep, "/"), fullPath))
+
+	return files
+
+def UsesDictionary(name, data):
+	return (name.lower().endswith(DICT_EXTENSIONS) and len(data) <= DICT_MAX_FILE_SIZE)
+
+def Pad(out, alignment):
+	out.write(b"\0" * ((alignment - out.tell() % alignment) % alignment))
+
+
+def Main():
+	parser = argparse.ArgumentParser(description = "create an .sds (zstd) archive from a directory")
+	parser.add_argument("-l", "--level", type = int, default = 19, help = "zstd compression level")
+	parser.add_argument("directory")
+	parser.add_argument("archive")
+	args = parser.parse_args()
+
+	files = [(name, open(path, "rb").read()) for (name, path) in ListFiles(args.directory)]
+	samples = [data for (name, data) in files if UsesDictionary(name, data) and len(data) > 0]
+
+	dictData = b""
+	dictCompressor = None
+
+	if len(samples) >= DICT_MIN_SAMPLES:
+		dictionary = zstandard.train_dictionary(DICT_SIZE, samples, level = args.level)
+		dictData = dictionary.as_bytes()
+		dictCompressor = zstandard.ZstdCompressor(level = args.level, dict_data = dictionary, write_content_size = True)
+
+	compressor = zstandard.ZstdCompressor(level = args.level, write_content_size = True)
+	records = []
+
+	with open(args.archive, "wb") as out:
+		# header is rewritten once all offsets are known
+		out.write(b"\0" * 32)
+
+		for (name, data) in files:
+			method = METHOD_ZSTD
+			payload = compressor.compress(data)
+
+			if dictCompressor is not None and UsesDictionary(name, data):
+				dictPayload = dictCompressor.compress(data)
+
+				if len(dictPayload) < len(payload):
+					method = METHOD_ZSTD_DICT
+					payload = dictPayload
+
+			if len(payload) >= len(data):
+				method = METHOD_STORED
+				payload = data
+
+			Pad(out, STORED_ALIGNMENT if method == METHOD_STORED else FRAME_ALIGNMENT)
+			records.append((out.tell(), len(payload), len(data), method, name.encode("utf-8")))
+			out.write(payload)
+
+		dictOffset = out.tell()
+		out.write(dictData)
+
+		indexOffset = out.tell()
+
+		for (offset, packedSize, size, method, name) in records:
+			out.write(struct.pack("<QIIBBH", offset, packedSize, size, method, 0, len(name)))
+			out.write(name)
+
+		out.seek(0)
+		out.write(struct.pack("<4sIIIQQ", b"SDSA", 1, len(records), len(dictData), dictOffset, indexOffset))
+
+	packed = sum(r[1] for r in records)
+	unpacked = sum(r[2] for r in records)
+	print("%s: %d files, %d -> %d bytes (dictionary: %d bytes)" % (args.archive, len(records), unpacked, packed, len(dictData)))
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(Main())
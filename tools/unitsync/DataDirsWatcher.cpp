@@ -0,0 +1,183 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DataDirsWatcher.h"
+
+#include <algorithm>
+
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystemAbstraction.h"
+#include "System/Log/ILog.h"
+
+#if defined(_WIN32)
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <sys/inotify.h>
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
+
+#if defined(__linux__)
+static constexpr std::uint32_t ARCHIVE_EVENTS = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+static constexpr std::uint32_t DATADIR_EVENTS = IN_CREATE | IN_MOVED_TO;
+#elif defined(_WIN32)
+static constexpr DWORD ARCHIVE_EVENTS = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+static constexpr DWORD DATADIR_EVENTS = FILE_NOTIFY_CHANGE_DIR_NAME;
+#endif
+
+
+void CDataDirsWatcher::Watch(const std::vector<std::string>& dataDirs, const std::vector<std::string>& roots)
+{
+	Clear();
+
+	changed = !Init();
+
+	for (const std::string& dataDir: dataDirs) {
+		for (const std::string& root: roots) {
+			if (changed)
+				return;
+			if (root.empty())
+				continue;
+
+			changed = !AddRootWatch(dataDir, root);
+		}
+	}
+}
+
+bool CDataDirsWatcher::AddRootWatch(const std::string& dataDir, const std::string& root)
+{
+	if (FileSystemAbstraction::DirExists(dataDir + root))
+		return (AddWatch(dataDir + root, true));
+
+	// the root may be created later, which only the data-dir itself sees
+	if (FileSystemAbstraction::DirExists(dataDir))
+		return (AddWatch(dataDir, false));
+
+	return true;
+}
+
+
+#if defined(__linux__)
+
+bool CDataDirsWatcher::Init()
+{
+	return ((notifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) >= 0);
+}
+
+void CDataDirsWatcher::Clear()
+{
+	if (notifyFD >= 0)
+		close(notifyFD);
+
+	dataDirWatches.clear();
+
+	notifyFD = -1;
+	changed = true;
+}
+
+bool CDataDirsWatcher::AddWatch(const std::string& dir, bool recursive)
+{
+	const int wd = inotify_add_watch(notifyFD, dir.c_str(), recursive? ARCHIVE_EVENTS: DATADIR_EVENTS);
+
+	if (wd < 0) {
+		// most likely fs.inotify.max_user_watches was hit
+		LOG_L(L_WARNING, "[DataDirsWatcher::%s] can not watch \"%s\" (errno=%d), always rescanning", __func__, dir.c_str(), errno);
+		return false;
+	}
+
+	if (!recursive) {
+		// adding the same path twice yields the same descriptor
+		if (std::find(dataDirWatches.begin(), dataDirWatches.end(), wd) == dataDirWatches.end())
+			dataDirWatches.push_back(wd);
+
+		return true;
+	}
+
+	// inotify watches are not recursive, add one per (.sdd, pool, ...) sub-directory
+	std::vector<std::string> subDirs;
+	FileSystemAbstraction::FindFiles(subDirs, dir + "/", "", ".*", FileQueryFlags::RECURSE | FileQueryFlags::INCLUDE_DIRS | FileQueryFlags::ONLY_DIRS);
+
+	for (const std::string& subDir: subDirs) {
+		if (inotify_add_watch(notifyFD, (dir + "/" + subDir).c_str(), ARCHIVE_EVENTS) < 0)
+			return false;
+	}
+
+	return true;
+}
+
+bool CDataDirsWatcher::HasChanges()
+{
+	if (changed)
+		return true;
+
+	alignas(inotify_event) char events[4096];
+
+	for (ssize_t len = 0; (len = read(notifyFD, events, sizeof(events))) > 0; ) {
+		for (const char* ptr = events; ptr < (events + len); ) {
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+
+			ptr += (sizeof(inotify_event) + event->len);
+
+			if ((event->mask & IN_Q_OVERFLOW) != 0)
+				return (changed = true);
+
+			// for data-dirs, only (archive root) directories count
+			if (std::find(dataDirWatches.begin(), dataDirWatches.end(), event->wd) != dataDirWatches.end() && (event->mask & IN_ISDIR) == 0)
+				continue;
+
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+#elif defined(_WIN32)
+
+bool CDataDirsWatcher::Init() { return true; }
+
+void CDataDirsWatcher::Clear()
+{
+	for (void* h: changeHandles) {
+		FindCloseChangeNotification(h);
+	}
+
+	changeHandles.clear();
+	changed = true;
+}
+
+bool CDataDirsWatcher::AddWatch(const std::string& dir, bool recursive)
+{
+	const HANDLE h = FindFirstChangeNotificationA(dir.c_str(), recursive, recursive? ARCHIVE_EVENTS: DATADIR_EVENTS);
+
+	if (h == INVALID_HANDLE_VALUE) {
+		LOG_L(L_WARNING, "[DataDirsWatcher::%s] can not watch \"%s\" (error=%lu), always rescanning", __func__, dir.c_str(), GetLastError());
+		return false;
+	}
+
+	changeHandles.push_back(h);
+	return true;
+}
+
+bool CDataDirsWatcher::HasChanges()
+{
+	if (changed)
+		return true;
+
+	// handles stay signalled until re-armed, which Watch does by recreating them
+	for (void* h: changeHandles) {
+		if (WaitForSingleObject(h, 0) == WAIT_OBJECT_0)
+			return (changed = true);
+	}
+
+	return false;
+}
+
+#else
+
+bool CDataDirsWatcher::Init() { return false; }
+void CDataDirsWatcher::Clear() { changed = true; }
+bool CDataDirsWatcher::AddWatch(const std::string& dir, bool recursive) { return false; }
+bool CDataDirsWatcher::HasChanges() { return true; }
+
+#endif
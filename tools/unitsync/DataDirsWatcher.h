@@ -0,0 +1,57 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _DATA_DIRS_WATCHER_H
+#define _DATA_DIRS_WATCHER_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Tells whether anything below the archive roots (maps/, games/, ...) of
+ * the data-dirs changed since they were last (re)watched, so a repeated
+ * unitsync Init can skip rescanning when no archive was added, removed or
+ * modified. Uses inotify on Linux and change notifications on Windows;
+ * elsewhere, or whenever a watch can not be set up, changes are always
+ * reported. Nothing runs in the background, HasChanges polls for events.
+ */
+class CDataDirsWatcher
+{
+public:
+	CDataDirsWatcher() = default;
+	CDataDirsWatcher(const CDataDirsWatcher&) = delete;
+	~CDataDirsWatcher() { Clear(); }
+
+	CDataDirsWatcher& operator = (const CDataDirsWatcher&) = delete;
+
+	/**
+	 * (Re)starts watching; call this *before* scanning so that nothing
+	 * changed during the scan is missed.
+	 * @param dataDirs data-dir paths, ending with a path separator
+	 * @param roots archive roots relative to each data-dir
+	 */
+	void Watch(const std::vector<std::string>& dataDirs, const std::vector<std::string>& roots);
+	void Clear();
+
+	bool HasChanges();
+
+private:
+	bool Init();
+	bool AddRootWatch(const std::string& dataDir, const std::string& root);
+	bool AddWatch(const std::string& dir, bool recursive);
+
+private:
+	#ifdef _WIN32
+	std::vector<void*> changeHandles;
+	#else
+	// watch descriptors of the data-dirs themselves, these only
+	// report (missing) archive roots being created or moved in
+	std::vector<int> dataDirWatches;
+
+	int notifyFD = -1;
+	#endif
+
+	// sticky until the next Watch
+	bool changed = true;
+};
+
+#endif // _DATA_DIRS_WATCHER_H
@@ -29,6 +29,7 @@ static std::vector<std::string> strKeys;
 
 EXPORT(void) lpClose()
 {
+	UNITSYNC_LOCK;
 	rootTable = LuaTable();
 	currTable = LuaTable();
 
@@ -47,6 +48,7 @@ EXPORT(void) lpClose()
 EXPORT(int) lpOpenFile(const char* filename, const char* fileModes,
 		const char* accessModes)
 {
+	UNITSYNC_LOCK;
 	lpClose();
 	luaParser = new LuaParser(filename, fileModes, accessModes);
 	return 1;
@@ -55,6 +57,7 @@ EXPORT(int) lpOpenFile(const char* filename, const char* fileModes,
 
 EXPORT(int) lpOpenSource(const char* source, const char* accessModes)
 {
+	UNITSYNC_LOCK;
 	lpClose();
 	luaParser = new LuaParser(source, accessModes);
 	return 1;
@@ -63,6 +66,7 @@ EXPORT(int) lpOpenSource(const char* source, const char* accessModes)
 
 EXPORT(int) lpExecute()
 {
+	UNITSYNC_LOCK;
 	if (!luaParser) {
 		return 0;
 	}
@@ -75,6 +79,7 @@ EXPORT(int) lpExecute()
 
 EXPORT(const char*) lpErrorLog()
 {
+	UNITSYNC_LOCK;
 	if (luaParser) {
 		return GetStr(luaParser->GetErrorLog());
 	}
@@ -89,66 +94,77 @@ EXPORT(const char*) lpErrorLog()
 
 EXPORT(void) lpAddTableInt(int key, int override)
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->GetTable(key, override); }
 }
 
 
 EXPORT(void) lpAddTableStr(const char* key, int override)
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->GetTable(key, override); }
 }
 
 
 EXPORT(void) lpEndTable()
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->EndTable(); }
 }
 
 
 EXPORT(void) lpAddIntKeyIntVal(int key, int val)
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->AddInt(key, val); }
 }
 
 
 EXPORT(void) lpAddStrKeyIntVal(const char* key, int val)
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->AddInt(key, val); }
 }
 
 
 EXPORT(void) lpAddIntKeyBoolVal(int key, int val)
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->AddBool(key, val); }
 }
 
 
 EXPORT(void) lpAddStrKeyBoolVal(const char* key, int val)
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->AddBool(key, val); }
 }
 
 
 EXPORT(void) lpAddIntKeyFloatVal(int key, float val)
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->AddFloat(key, val); }
 }
 
 
 EXPORT(void) lpAddStrKeyFloatVal(const char* key, float val)
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->AddFloat(key, val); }
 }
 
 
 EXPORT(void) lpAddIntKeyStrVal(int key, const char* val)
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->AddString(key, val); }
 }
 
 
 EXPORT(void) lpAddStrKeyStrVal(const char* key, const char* val)
 {
+	UNITSYNC_LOCK;
 	if (luaParser) { luaParser->AddString(key, val); }
 }
 
@@ -160,6 +176,7 @@ EXPORT(void) lpAddStrKeyStrVal(const char* key, const char* val)
 
 EXPORT(int) lpRootTable()
 {
+	UNITSYNC_LOCK;
 	currTable = rootTable;
 	luaTables.clear();
 	return currTable.IsValid() ? 1 : 0;
@@ -168,6 +185,7 @@ EXPORT(int) lpRootTable()
 
 EXPORT(int) lpRootTableExpr(const char* expr)
 {
+	UNITSYNC_LOCK;
 	currTable = rootTable.SubTableExpr(expr);
 	luaTables.clear();
 	return currTable.IsValid() ? 1 : 0;
@@ -176,6 +194,7 @@ EXPORT(int) lpRootTableExpr(const char* expr)
 
 EXPORT(int) lpSubTableInt(int key)
 {
+	UNITSYNC_LOCK;
 	luaTables.push_back(currTable);
 	currTable = currTable.SubTable(key);
 	return currTable.IsValid() ? 1 : 0;
@@ -184,6 +203,7 @@ EXPORT(int) lpSubTableInt(int key)
 
 EXPORT(int) lpSubTableStr(const char* key)
 {
+	UNITSYNC_LOCK;
 	luaTables.push_back(currTable);
 	currTable = currTable.SubTable(key);
 	return currTable.IsValid() ? 1 : 0;
@@ -192,6 +212,7 @@ EXPORT(int) lpSubTableStr(const char* key)
 
 EXPORT(int) lpSubTableExpr(const char* expr)
 {
+	UNITSYNC_LOCK;
 	luaTables.push_back(currTable);
 	currTable = currTable.SubTableExpr(expr);
 	return currTable.IsValid() ? 1 : 0;
@@ -200,6 +221,7 @@ EXPORT(int) lpSubTableExpr(const char* expr)
 
 EXPORT(void) lpPopTable()
 {
+	UNITSYNC_LOCK;
 	if (luaTables.empty()) {
 		currTable = rootTable;
 		return;
@@ -217,12 +239,14 @@ EXPORT(void) lpPopTable()
 
 EXPORT(int) lpGetKeyExistsInt(int key)
 {
+	UNITSYNC_LOCK;
 	return currTable.KeyExists(key) ? 1 : 0;
 }
 
 
 EXPORT(int) lpGetKeyExistsStr(const char* key)
 {
+	UNITSYNC_LOCK;
 	return currTable.KeyExists(key) ? 1 : 0;
 }
 
@@ -234,12 +258,14 @@ EXPORT(int) lpGetKeyExistsStr(const char* key)
 
 EXPORT(int) lpGetIntKeyType(int key)
 {
+	UNITSYNC_LOCK;
 	return currTable.GetType(key);
 }
 
 
 EXPORT(int) lpGetStrKeyType(const char* key)
 {
+	UNITSYNC_LOCK;
 	return currTable.GetType(key);
 }
 
@@ -251,6 +277,7 @@ EXPORT(int) lpGetStrKeyType(const char* key)
 
 EXPORT(int) lpGetIntKeyListCount()
 {
+	UNITSYNC_LOCK;
 	if (!currTable.IsValid()) {
 		intKeys.clear();
 		return 0;
@@ -263,6 +290,7 @@ EXPORT(int) lpGetIntKeyListCount()
 
 EXPORT(int) lpGetIntKeyListEntry(int index)
 {
+	UNITSYNC_LOCK;
 	if ((index < 0) || (index >= (int)intKeys.size())) {
 		return 0;
 	}
@@ -272,6 +300,7 @@ EXPORT(int) lpGetIntKeyListEntry(int index)
 
 EXPORT(int) lpGetStrKeyListCount()
 {
+	UNITSYNC_LOCK;
 	if (!currTable.IsValid()) {
 		strKeys.clear();
 		return 0;
@@ -284,6 +313,7 @@ EXPORT(int) lpGetStrKeyListCount()
 
 EXPORT(const char*) lpGetStrKeyListEntry(int index)
 {
+	UNITSYNC_LOCK;
 	if ((index < 0) || (index >= (int)strKeys.size())) {
 		return GetStr("");
 	}
@@ -298,48 +328,56 @@ EXPORT(const char*) lpGetStrKeyListEntry(int index)
 
 EXPORT(int) lpGetIntKeyIntVal(int key, int defVal)
 {
+	UNITSYNC_LOCK;
 	return currTable.GetInt(key, defVal);
 }
 
 
 EXPORT(int) lpGetStrKeyIntVal(const char* key, int defVal)
 {
+	UNITSYNC_LOCK;
 	return currTable.GetInt(key, defVal);
 }
 
 
 EXPORT(int) lpGetIntKeyBoolVal(int key, int defVal)
 {
+	UNITSYNC_LOCK;
 	return currTable.GetBool(key, defVal) ? 1 : 0;
 }
 
 
 EXPORT(int) lpGetStrKeyBoolVal(const char* key, int defVal)
 {
+	UNITSYNC_LOCK;
 	return currTable.GetBool(key, defVal) ? 1 : 0;
 }
 
 
 EXPORT(float) lpGetIntKeyFloatVal(int key, float defVal)
 {
+	UNITSYNC_LOCK;
 	return currTable.GetFloat(key, defVal);
 }
 
 
 EXPORT(float) lpGetStrKeyFloatVal(const char* key, float defVal)
 {
+	UNITSYNC_LOCK;
 	return currTable.GetFloat(key, defVal);
 }
 
 
 EXPORT(const char*) lpGetIntKeyStrVal(int key, const char* defVal)
 {
+	UNITSYNC_LOCK;
 	return GetStr(currTable.GetString(key, defVal));
 }
 
 
 EXPORT(const char*) lpGetStrKeyStrVal(const char* key, const char* defVal)
 {
+	UNITSYNC_LOCK;
 	return GetStr(currTable.GetString(key, defVal));
 }
 
@@ -2,10 +2,15 @@
 
 #include "unitsync.h"
 #include "unitsync_api.h"
+#include "DataDirsWatcher.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <fstream>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <set>
 
@@ -26,6 +31,7 @@
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/DataDirLocater.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/VFSHandler.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileSystemInitializer.h"
@@ -74,6 +80,7 @@ BOOL CALLING_CONV DllMain(HINSTANCE hInst, DWORD dwReason, LPVOID lpReserved)
 
 CONFIG(bool, UnitsyncAutoUnLoadMaps).defaultValue(true).description("Automaticly load and unload the required map for some unitsync functions.");
 CONFIG(bool, UnitsyncAutoUnLoadMapsIsSupported).defaultValue(true).readOnly(true).description("Check for support of UnitsyncAutoUnLoadMaps");
+CONFIG(bool, UnitsyncIncrementalInit).defaultValue(false).description("Keep the archive scanner alive across Init() calls and only rescan archives that changed, skipping the rescan entirely if the data-dirs were not modified. Changes to the data-dir configuration then need an UnInit().");
 
 
 //////////////////////////
@@ -233,6 +240,7 @@ static void _SetLastError(const std::string& err)
 
 EXPORT(const char*) GetNextError()
 {
+	UNITSYNC_LOCK;
 	try {
 		// queue is only 1 element long now for simplicity :-)
 		if (lastError.empty())
@@ -306,6 +314,7 @@ class ScopedMapLoader {
 
 EXPORT(const char*) GetSpringVersion()
 {
+	UNITSYNC_LOCK;
 	if (SpringVersion::IsRelease()) {
 		return GetStr(SpringVersion::GetSync() + "." + SpringVersion::GetPatchSet());
 	}
@@ -315,12 +324,14 @@ EXPORT(const char*) GetSpringVersion()
 
 EXPORT(const char*) GetSpringVersionPatchset()
 {
+	UNITSYNC_LOCK;
 	return "";
 }
 
 
 EXPORT(bool) IsSpringReleaseVersion()
 {
+	UNITSYNC_LOCK;
 	return false;
 }
 
@@ -371,8 +382,38 @@ static void CheckForImportantFilesInVFS()
 }
 
 
+static CDataDirsWatcher dataDirsWatcher;
+
+static void WatchDataDirs()
+{
+	const std::array<std::string, 5>& dataDirRoots = dataDirLocater.GetDataDirRoots();
+
+	dataDirsWatcher.Watch(dataDirLocater.GetDataDirPaths(), {dataDirRoots.begin(), dataDirRoots.end()});
+}
+
+static bool ReInitFileSystem()
+{
+	if (!CheckInit(false) || !configHandler->GetBool("UnitsyncIncrementalInit"))
+		return false;
+
+	// start over with an empty VFS but keep the scanner state
+	CVFSHandler::FreeGlobalInstance();
+	CVFSHandler::SetGlobalInstance(new CVFSHandler("SpringVFS"));
+
+	if (!dataDirsWatcher.HasChanges()) {
+		LOG("[UnitSync::%s] data-dirs unchanged, not rescanning", __func__);
+		return true;
+	}
+
+	WatchDataDirs();
+	archiveScanner->Rescan();
+	return true;
+}
+
+
 EXPORT(int) Init(bool isServer, int id)
 {
+	UNITSYNC_LOCK;
 	static int numCalls = 0;
 	int ret = 0;
 
@@ -391,19 +432,31 @@ EXPORT(int) Init(bool isServer, int id)
 		log_filter_section_setMinLevel(LOG_LEVEL_INFO, LOG_SECTION_UNITSYNC);
 #endif
 
-		// reinitialize filesystem to detect new files
-		if (CheckInit(false))
-			FileSystemInitializer::Cleanup();
-
-		dataDirLocater.UpdateIsolationModeByEnvVar();
-
-		const std::string& configFile = (configHandler != nullptr)? configHandler->GetConfigFile(): "";
 		const std::string& springFull = SpringVersion::GetFull();
 
 		ThreadPool::SetThreadCount(ThreadPool::GetMaxThreads());
-		FileSystemInitializer::PreInitializeConfigHandler(configFile);
-		FileSystemInitializer::InitializeLogOutput("unitsync.log");
-		FileSystemInitializer::Initialize();
+
+		if (!ReInitFileSystem()) {
+			// reinitialize filesystem to detect new files
+			if (CheckInit(false))
+				FileSystemInitializer::Cleanup();
+
+			dataDirLocater.UpdateIsolationModeByEnvVar();
+
+			const std::string& configFile = (configHandler != nullptr)? configHandler->GetConfigFile(): "";
+
+			FileSystemInitializer::PreInitializeConfigHandler(configFile);
+			FileSystemInitializer::InitializeLogOutput("unitsync.log");
+			FileSystemInitializer::Initialize();
+
+			if (configHandler->GetBool("UnitsyncIncrementalInit")) {
+				// the initial scan ran before the watches existed, catch up on
+				// whatever changed meanwhile; all other archives are cached now
+				WatchDataDirs();
+				archiveScanner->Rescan();
+			}
+		}
+
 		// check if VFS is okay (throws if not)
 		CheckForImportantFilesInVFS();
 		ThreadPool::SetThreadCount(0);
@@ -421,8 +474,10 @@ EXPORT(int) Init(bool isServer, int id)
 
 EXPORT(void) UnInit()
 {
+	UNITSYNC_LOCK;
 	try {
 		_Cleanup();
+		dataDirsWatcher.Clear();
 		FileSystemInitializer::Cleanup();
 		ConfigHandler::Deallocate();
 		DataDirLocater::FreeInstance();
@@ -433,6 +488,7 @@ EXPORT(void) UnInit()
 
 EXPORT(const char*) GetWritableDataDirectory()
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		return GetStr(dataDirLocater.GetWriteDirPath());
@@ -443,6 +499,7 @@ EXPORT(const char*) GetWritableDataDirectory()
 
 EXPORT(int) GetDataDirectoryCount()
 {
+	UNITSYNC_LOCK;
 	int count = -1;
 
 	try {
@@ -456,6 +513,7 @@ EXPORT(int) GetDataDirectoryCount()
 
 EXPORT(const char*) GetDataDirectory(int index)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		const std::vector<std::string> datadirs = dataDirLocater.GetDataDirPaths();
@@ -470,6 +528,7 @@ EXPORT(const char*) GetDataDirectory(int index)
 
 EXPORT(int) ProcessUnits()
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		LOG_L(L_DEBUG, "[%s] loaded=%d", __func__, unitDefs.empty());
@@ -482,6 +541,7 @@ EXPORT(int) ProcessUnits()
 
 EXPORT(int) GetUnitCount()
 {
+	UNITSYNC_LOCK;
 	int count = -1;
 
 	try {
@@ -497,6 +557,7 @@ EXPORT(int) GetUnitCount()
 
 EXPORT(const char*) GetUnitName(int unitDefID)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		LOG_L(L_DEBUG, "[%s(UnitDefID=%d)]", __func__, unitDefID);
@@ -509,6 +570,7 @@ EXPORT(const char*) GetUnitName(int unitDefID)
 
 EXPORT(const char*) GetFullUnitName(int unitDefID)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		LOG_L(L_DEBUG, "[%s(UnitDefID=%d)]", __func__, unitDefID);
@@ -523,6 +585,7 @@ EXPORT(const char*) GetFullUnitName(int unitDefID)
 
 EXPORT(void) AddArchive(const char* archiveName)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNullOrEmpty(archiveName);
@@ -536,6 +599,7 @@ EXPORT(void) AddArchive(const char* archiveName)
 
 EXPORT(void) AddAllArchives(const char* rootArchiveName)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNullOrEmpty(rootArchiveName);
@@ -546,6 +610,7 @@ EXPORT(void) AddAllArchives(const char* rootArchiveName)
 
 EXPORT(void) RemoveAllArchives()
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 
@@ -559,6 +624,7 @@ EXPORT(void) RemoveAllArchives()
 
 EXPORT(unsigned int) GetArchiveChecksum(const char* archiveName)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNullOrEmpty(archiveName);
@@ -572,6 +638,7 @@ EXPORT(unsigned int) GetArchiveChecksum(const char* archiveName)
 
 EXPORT(const char*) GetArchivePath(const char* archiveName)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNullOrEmpty(archiveName);
@@ -673,6 +740,7 @@ static bool internal_GetMapInfo(const char* mapName, InternalMapInfo* outInfo)
 
 EXPORT(int) GetMapCount()
 {
+	UNITSYNC_LOCK;
 	int count = -1;
 
 	try {
@@ -694,6 +762,7 @@ EXPORT(int) GetMapCount()
 
 EXPORT(const char*) GetMapName(int index)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckBounds(index, mapNames.size());
@@ -707,6 +776,7 @@ EXPORT(const char*) GetMapName(int index)
 
 EXPORT(const char*) GetMapFileName(int index)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckBounds(index, mapNames.size());
@@ -749,6 +819,7 @@ static void internal_deleteMapInfos()
 
 
 EXPORT(float) GetMapMinHeight(const char* mapName) {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		const std::string mapFile = GetMapFile(mapName);
@@ -771,6 +842,7 @@ EXPORT(float) GetMapMinHeight(const char* mapName) {
 }
 
 EXPORT(float) GetMapMaxHeight(const char* mapName) {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		const std::string mapFile = GetMapFile(mapName);
@@ -797,6 +869,7 @@ EXPORT(float) GetMapMaxHeight(const char* mapName) {
 
 EXPORT(int) GetMapArchiveCount(const char* mapName)
 {
+	UNITSYNC_LOCK;
 	int count = -1;
 
 	try {
@@ -813,6 +886,7 @@ EXPORT(int) GetMapArchiveCount(const char* mapName)
 
 EXPORT(const char*) GetMapArchiveName(int index)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckBounds(index, mapArchives.size());
@@ -826,6 +900,7 @@ EXPORT(const char*) GetMapArchiveName(int index)
 
 EXPORT(unsigned int) GetMapChecksum(int index)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckBounds(index, mapNames.size());
@@ -839,6 +914,7 @@ EXPORT(unsigned int) GetMapChecksum(int index)
 
 EXPORT(unsigned int) GetMapChecksumFromName(const char* mapName)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 
@@ -903,14 +979,13 @@ static unsigned short* GetMinimapSM3(std::string mapFileName, int mipLevel)
 	*/
 }
 
-static unsigned short* GetMinimapSMF(std::string mapFileName, int mipLevel)
+// colors must have room for (1024 >> mipLevel)^2 pixels
+static void DecodeMinimapSMF(CSMFMapFile& in, int mipLevel, unsigned short* colors)
 {
-	CSMFMapFile in(mapFileName);
 	std::vector<uint8_t> buffer;
 	const int mipsize = in.ReadMinimap(buffer, mipLevel);
 
 	// Do stuff
-	unsigned short* colors = (unsigned short*)((void*)imgbuf);
 	unsigned char* temp = &buffer[0];
 
 	const int numblocks = buffer.size() / 8;
@@ -958,12 +1033,119 @@ static unsigned short* GetMinimapSMF(std::string mapFileName, int mipLevel)
 		}
 		temp += 8;
 	}
+}
+
+static unsigned short* GetMinimapSMF(std::string mapFileName, int mipLevel)
+{
+	// too large for the stack of a lobby's thread
+	const std::unique_ptr<CSMFMapFile> in(new CSMFMapFile(mapFileName));
+
+	DecodeMinimapSMF(*in, mipLevel, imgbuf);
+	return imgbuf;
+}
+
+
+//////////////////////////
+//////////////////////////
+
+// minimaps and 8-bit infomaps are cached under the cache dir, keyed by the checksum
+// of the map archive, so lobbies do not have to open every map archive on each run
+
+static std::string GetPreviewCacheFile(const std::string& mapName, const std::string& suffix)
+{
+	const std::string cacheDir = dataDirsAccess.LocateDir(FileSystem::GetCacheDir() + "/unitsync/previews/", FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+
+	if (cacheDir.empty())
+		return "";
+
+	const std::string archiveName = archiveScanner->ArchiveFromName(mapName);
+	const uint32_t checksum = archiveScanner->GetArchiveSingleChecksum(archiveScanner->GetArchivePath(archiveName) + archiveName);
+
+	if (checksum == 0)
+		return "";
+
+	char buf[16];
+	snprintf(buf, sizeof(buf), "%08x.", checksum);
+
+	return (FileSystem::EnsurePathSepAtEnd(cacheDir) + buf + suffix);
+}
+
+static std::string GetMinimapCacheSuffix(int mipLevel) { return ("mip" + IntToString(mipLevel)); }
+
+static bool IsCachedInfoMap(const char* name) { return (strcmp(name, "height") != 0); }
+
+static bool ReadCacheFile(const std::string& cacheFile, void* data, size_t size)
+{
+	if (cacheFile.empty())
+		return false;
+
+	std::ifstream ifs(cacheFile.c_str(), std::ios::in | std::ios::binary);
+	return (ifs.read(reinterpret_cast<char*>(data), size).good());
+}
+
+static void WriteCacheFile(const std::string& cacheFile, const void* header, size_t headerSize, const void* data, size_t size)
+{
+	if (cacheFile.empty())
+		return;
+
+	// write to a temporary first, another unitsync instance may be reading the cache
+	const std::string tmpFile = cacheFile + ".tmp";
+
+	{
+		std::ofstream ofs(tmpFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+		ofs.write(reinterpret_cast<const char*>(header), headerSize);
+		ofs.write(reinterpret_cast<const char*>(data), size);
+
+		if (!ofs.good()) {
+			ofs.close();
+			std::remove(tmpFile.c_str());
+			return;
+		}
+	}
+
+	if (std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0)
+		std::remove(tmpFile.c_str());
+}
+
+static bool ReadCachedMinimap(const std::string& cacheFile, int mipLevel, unsigned short* colors)
+{
+	return ReadCacheFile(cacheFile, colors, Square(1024 >> mipLevel) * sizeof(unsigned short));
+}
 
-	return colors;
+static void WriteCachedMinimap(const std::string& cacheFile, int mipLevel, const unsigned short* colors)
+{
+	WriteCacheFile(cacheFile, nullptr, 0, colors, Square(1024 >> mipLevel) * sizeof(unsigned short));
+}
+
+// infomaps are stored as uint32 width, uint32 height, then the 8-bit pixels
+static bool ReadCachedInfoMap(const std::string& cacheFile, int* width, int* height, unsigned char* data)
+{
+	if (cacheFile.empty())
+		return false;
+
+	std::ifstream ifs(cacheFile.c_str(), std::ios::in | std::ios::binary);
+	uint32_t size[2] = {0, 0};
+
+	if (!ifs.read(reinterpret_cast<char*>(size), sizeof(size)).good())
+		return false;
+
+	if (width != nullptr) *width = size[0];
+	if (height != nullptr) *height = size[1];
+
+	return (data == nullptr || ifs.read(reinterpret_cast<char*>(data), size[0] * size[1]).good());
+}
+
+static void WriteCachedInfoMap(const std::string& cacheFile, const MapBitmapInfo& bmInfo, const unsigned char* data)
+{
+	const uint32_t size[2] = {uint32_t(bmInfo.width), uint32_t(bmInfo.height)};
+
+	WriteCacheFile(cacheFile, size, sizeof(size), data, bmInfo.width * bmInfo.height);
 }
 
 EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNullOrEmpty(mapName);
@@ -972,12 +1154,17 @@ EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 			throw std::out_of_range("Miplevel must be between 0 and 8 (inclusive) in GetMinimap.");
 
 		const std::string mapFile = GetMapFile(mapName);
+		const std::string cacheFile = GetPreviewCacheFile(mapName, GetMinimapCacheSuffix(mipLevel));
+
+		if (ReadCachedMinimap(cacheFile, mipLevel, imgbuf))
+			return imgbuf;
+
 		ScopedMapLoader mapLoader(mapName, mapFile);
 
 		unsigned short* ret = nullptr;
 		const std::string extension = FileSystem::GetExtension(mapFile);
 		if (extension == "smf") {
-			ret = GetMinimapSMF(mapFile, mipLevel);
+			WriteCachedMinimap(cacheFile, mipLevel, ret = GetMinimapSMF(mapFile, mipLevel));
 		} else if (extension == "sm3") {
 			ret = GetMinimapSM3(mapFile, mipLevel);
 		}
@@ -991,6 +1178,7 @@ EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 
 EXPORT(int) GetInfoMapSize(const char* mapName, const char* name, int* width, int* height)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNullOrEmpty(mapName);
@@ -999,6 +1187,10 @@ EXPORT(int) GetInfoMapSize(const char* mapName, const char* name, int* width, in
 		CheckNull(height);
 
 		const std::string mapFile = GetMapFile(mapName);
+
+		if (IsCachedInfoMap(name) && ReadCachedInfoMap(GetPreviewCacheFile(mapName, name), width, height, nullptr))
+			return ((*width) * (*height));
+
 		ScopedMapLoader mapLoader(mapName, mapFile);
 		CSMFMapFile file(mapFile);
 		MapBitmapInfo bmInfo;
@@ -1021,6 +1213,7 @@ EXPORT(int) GetInfoMapSize(const char* mapName, const char* name, int* width, in
 
 EXPORT(int) GetInfoMap(const char* mapName, const char* name, unsigned char* data, int typeHint)
 {
+	UNITSYNC_LOCK;
 	int ret = -1;
 
 	try {
@@ -1030,13 +1223,23 @@ EXPORT(int) GetInfoMap(const char* mapName, const char* name, unsigned char* dat
 		CheckNull(data);
 
 		const std::string mapFile = GetMapFile(mapName);
+		const int actualType = (strcmp(name, "height") == 0)? bm_grayscale_16 : bm_grayscale_8;
+
+		const bool useCache = (IsCachedInfoMap(name) && actualType == typeHint);
+		const std::string cacheFile = useCache? GetPreviewCacheFile(mapName, name): "";
+
+		if (useCache && ReadCachedInfoMap(cacheFile, nullptr, nullptr, data))
+			return 1;
+
 		ScopedMapLoader mapLoader(mapName, mapFile);
 		CSMFMapFile file(mapFile);
 
-		const int actualType = (strcmp(name, "height") == 0)? bm_grayscale_16 : bm_grayscale_8;
-
 		if (actualType == typeHint) {
-			ret = file.ReadInfoMap(name, data);
+			if ((ret = file.ReadInfoMap(name, data)) && useCache) {
+				MapBitmapInfo bmInfo;
+				file.GetInfoMapSize(name, &bmInfo);
+				WriteCachedInfoMap(cacheFile, bmInfo, data);
+			}
 		} else if (actualType == bm_grayscale_16 && typeHint == bm_grayscale_8) {
 			// convert from 16 bits per pixel to 8 bits per pixel
 			MapBitmapInfo bmInfo;
@@ -1066,6 +1269,121 @@ EXPORT(int) GetInfoMap(const char* mapName, const char* name, unsigned char* dat
 }
 
 
+EXPORT(int) PrefetchMapPreviews(const char** mapNames, int count, int mipLevel)
+{
+	UNITSYNC_LOCK;
+	try {
+		CheckInit();
+		CheckNull(mapNames);
+
+		if (mipLevel < 0 || mipLevel > 8)
+			throw std::out_of_range("Miplevel must be between 0 and 8 (inclusive) in PrefetchMapPreviews.");
+
+		struct PreviewJob {
+			std::string archivePath;
+			std::string mapFile;
+			std::string minimapCacheFile;
+			std::string metalCacheFile;
+			std::string error;
+		};
+
+		std::vector<PreviewJob> jobs;
+		std::atomic<int> numCached = {0};
+
+		// everything touching the archive scanner happens here, the workers only open archives
+		for (int i = 0; i < count; i++) {
+			if (mapNames[i] == nullptr || *mapNames[i] == 0)
+				continue;
+
+			const std::string mapName = mapNames[i];
+			const std::string mapFile = archiveScanner->MapNameToMapFile(mapName);
+			const std::string archiveName = archiveScanner->ArchiveFromName(mapName);
+
+			if (mapFile == mapName || archiveName == mapName || FileSystem::GetExtension(mapFile) != "smf")
+				continue;
+
+			PreviewJob job;
+			job.archivePath = archiveScanner->GetArchivePath(archiveName) + archiveName;
+			job.mapFile = mapFile;
+			job.minimapCacheFile = GetPreviewCacheFile(mapName, GetMinimapCacheSuffix(mipLevel));
+			job.metalCacheFile = GetPreviewCacheFile(mapName, "metal");
+
+			if (job.minimapCacheFile.empty() || job.metalCacheFile.empty())
+				continue;
+
+			if (FileSystem::FileExists(job.minimapCacheFile) && FileSystem::FileExists(job.metalCacheFile)) {
+				numCached += 1;
+				continue;
+			}
+
+			jobs.push_back(std::move(job));
+		}
+
+		const auto ExtractPreviews = [mipLevel](PreviewJob& job) {
+			const std::unique_ptr<IArchive> archive(archiveLoader.OpenArchive(job.archivePath));
+
+			if (archive == nullptr)
+				throw content_error("could not open " + job.archivePath);
+
+			std::vector<std::uint8_t> mapFileData;
+
+			if (!archive->GetFile(job.mapFile, mapFileData))
+				throw content_error("could not read " + job.mapFile + " from " + job.archivePath);
+
+			// read from the archive directly, a ScopedMapLoader would swap out the global VFS
+			const std::unique_ptr<CSMFMapFile> file(new CSMFMapFile());
+			file->Open(job.mapFile, std::move(mapFileData));
+
+			std::vector<unsigned short> minimap(Square(1024 >> mipLevel));
+			DecodeMinimapSMF(*file, mipLevel, minimap.data());
+			WriteCachedMinimap(job.minimapCacheFile, mipLevel, minimap.data());
+
+			MapBitmapInfo bmInfo;
+			file->GetInfoMapSize("metal", &bmInfo);
+
+			std::vector<unsigned char> metalMap(bmInfo.width * bmInfo.height);
+
+			if (!metalMap.empty() && file->ReadInfoMap("metal", metalMap.data()))
+				WriteCachedInfoMap(job.metalCacheFile, bmInfo, metalMap.data());
+		};
+
+		std::atomic<size_t> nextJob = {0};
+
+		const auto ExtractJobs = [&]() {
+			for (size_t j = nextJob++; j < jobs.size(); j = nextJob++) {
+				try {
+					ExtractPreviews(jobs[j]);
+					numCached += 1;
+				} catch (const std::exception& e) {
+					jobs[j].error = e.what();
+				}
+			}
+		};
+
+		std::vector<std::thread> workers;
+
+		for (size_t i = 1, n = std::min(size_t(std::max(std::thread::hardware_concurrency(), 1u)), jobs.size()); i < n; i++) {
+			workers.emplace_back(ExtractJobs);
+		}
+
+		ExtractJobs();
+
+		for (std::thread& worker: workers) {
+			worker.join();
+		}
+
+		for (const PreviewJob& job: jobs) {
+			if (!job.error.empty())
+				LOG_L(L_WARNING, "[%s] %s", __func__, job.error.c_str());
+		}
+
+		return numCached;
+	}
+	UNITSYNC_CATCH_BLOCKS;
+	return -1;
+}
+
+
 //////////////////////////
 //////////////////////////
 
@@ -1073,6 +1391,7 @@ std::vector<CArchiveScanner::ArchiveData> modData;
 
 EXPORT(int) GetPrimaryModCount()
 {
+	UNITSYNC_LOCK;
 	int count = -1;
 
 	try {
@@ -1087,6 +1406,7 @@ EXPORT(int) GetPrimaryModCount()
 }
 
 EXPORT(int) GetPrimaryModInfoCount(int modIndex) {
+	UNITSYNC_LOCK;
 
 	try {
 		CheckInit();
@@ -1108,6 +1428,7 @@ EXPORT(int) GetPrimaryModInfoCount(int modIndex) {
 
 EXPORT(const char*) GetPrimaryModArchive(int index)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckBounds(index, modData.size());
@@ -1124,6 +1445,7 @@ std::vector<std::string> primaryArchives;
 
 EXPORT(int) GetPrimaryModArchiveCount(int index)
 {
+	UNITSYNC_LOCK;
 	int count = -1;
 
 	try {
@@ -1140,6 +1462,7 @@ EXPORT(int) GetPrimaryModArchiveCount(int index)
 
 EXPORT(const char*) GetPrimaryModArchiveList(int archiveNr)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckBounds(archiveNr, primaryArchives.size());
@@ -1154,6 +1477,7 @@ EXPORT(const char*) GetPrimaryModArchiveList(int archiveNr)
 
 EXPORT(int) GetPrimaryModIndex(const char* name)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 
@@ -1170,6 +1494,7 @@ EXPORT(int) GetPrimaryModIndex(const char* name)
 
 EXPORT(unsigned int) GetPrimaryModChecksum(int index)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckBounds(index, modData.size());
@@ -1182,6 +1507,7 @@ EXPORT(unsigned int) GetPrimaryModChecksum(int index)
 
 EXPORT(unsigned int) GetPrimaryModChecksumFromName(const char* name)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 
@@ -1197,6 +1523,7 @@ EXPORT(unsigned int) GetPrimaryModChecksumFromName(const char* name)
 
 EXPORT(int) GetSideCount()
 {
+	UNITSYNC_LOCK;
 	int count = -1;
 
 	try {
@@ -1214,6 +1541,7 @@ EXPORT(int) GetSideCount()
 
 EXPORT(const char*) GetSideName(int side)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckBounds(side, sideParser.GetCount());
@@ -1227,6 +1555,7 @@ EXPORT(const char*) GetSideName(int side)
 
 EXPORT(const char*) GetSideStartUnit(int side)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckBounds(side, sideParser.GetCount());
@@ -1274,6 +1603,7 @@ static void CheckOptionType(int optIndex, int type)
 
 EXPORT(int) GetMapOptionCount(const char* name)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNullOrEmpty(name);
@@ -1301,6 +1631,7 @@ EXPORT(int) GetMapOptionCount(const char* name)
 
 EXPORT(int) GetModOptionCount()
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 
@@ -1334,6 +1665,7 @@ EXPORT(int) GetModOptionCount()
 
 EXPORT(int) GetCustomOptionCount(const char* fileName)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 
@@ -1392,6 +1724,7 @@ static int GetNumberOfLuaAIs()
 //////////////////////////
 
 EXPORT(int) GetSkirmishAICount() {
+	UNITSYNC_LOCK;
 
 	int count = -1;
 
@@ -1438,6 +1771,7 @@ static int ToPureLuaAIIndex(int aiIndex) {
 }
 
 EXPORT(int) GetSkirmishAIInfoCount(int aiIndex) {
+	UNITSYNC_LOCK;
 
 	try {
 		CheckSkirmishAIIndex(aiIndex);
@@ -1463,6 +1797,7 @@ EXPORT(int) GetSkirmishAIInfoCount(int aiIndex) {
 }
 
 EXPORT(int) GetMapInfoCount(int index) {
+	UNITSYNC_LOCK;
 	try{
 		infoItems.clear();
 		CheckBounds(index, mapNames.size());
@@ -1512,6 +1847,7 @@ static void CheckInfoValueType(const InfoItem* infoItem, InfoValueType requiredV
 }
 
 EXPORT(const char*) GetInfoKey(int infoIndex) {
+	UNITSYNC_LOCK;
 
 	const char* key = nullptr;
 
@@ -1523,6 +1859,7 @@ EXPORT(const char*) GetInfoKey(int infoIndex) {
 	return key;
 }
 EXPORT(const char*) GetInfoType(int infoIndex) {
+	UNITSYNC_LOCK;
 
 	const char* type = nullptr;
 
@@ -1535,6 +1872,7 @@ EXPORT(const char*) GetInfoType(int infoIndex) {
 }
 
 EXPORT(const char*) GetInfoValueString(int infoIndex) {
+	UNITSYNC_LOCK;
 
 	const char* value = nullptr;
 
@@ -1548,6 +1886,7 @@ EXPORT(const char*) GetInfoValueString(int infoIndex) {
 	return value;
 }
 EXPORT(int) GetInfoValueInteger(int infoIndex) {
+	UNITSYNC_LOCK;
 
 	int value = -1;
 
@@ -1561,6 +1900,7 @@ EXPORT(int) GetInfoValueInteger(int infoIndex) {
 	return value;
 }
 EXPORT(float) GetInfoValueFloat(int infoIndex) {
+	UNITSYNC_LOCK;
 
 	float value = -1.0f;
 
@@ -1574,6 +1914,7 @@ EXPORT(float) GetInfoValueFloat(int infoIndex) {
 	return value;
 }
 EXPORT(bool) GetInfoValueBool(int infoIndex) {
+	UNITSYNC_LOCK;
 
 	bool value = false;
 
@@ -1587,6 +1928,7 @@ EXPORT(bool) GetInfoValueBool(int infoIndex) {
 	return value;
 }
 EXPORT(const char*) GetInfoDescription(int infoIndex) {
+	UNITSYNC_LOCK;
 
 	const char* desc = nullptr;
 
@@ -1599,6 +1941,7 @@ EXPORT(const char*) GetInfoDescription(int infoIndex) {
 }
 
 EXPORT(int) GetSkirmishAIOptionCount(int aiIndex) {
+	UNITSYNC_LOCK;
 
 	try {
 		CheckSkirmishAIIndex(aiIndex);
@@ -1633,6 +1976,7 @@ EXPORT(int) GetSkirmishAIOptionCount(int aiIndex) {
 
 EXPORT(const char*) GetOptionKey(int optIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionIndex(optIndex);
 		return GetStr(options[optIndex].key);
@@ -1643,6 +1987,7 @@ EXPORT(const char*) GetOptionKey(int optIndex)
 
 EXPORT(const char*) GetOptionScope(int optIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionIndex(optIndex);
 		return GetStr(options[optIndex].scope);
@@ -1653,6 +1998,7 @@ EXPORT(const char*) GetOptionScope(int optIndex)
 
 EXPORT(const char*) GetOptionName(int optIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionIndex(optIndex);
 		return GetStr(options[optIndex].name);
@@ -1663,6 +2009,7 @@ EXPORT(const char*) GetOptionName(int optIndex)
 
 EXPORT(const char*) GetOptionSection(int optIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionIndex(optIndex);
 		return GetStr(options[optIndex].section);
@@ -1673,6 +2020,7 @@ EXPORT(const char*) GetOptionSection(int optIndex)
 
 EXPORT(const char*) GetOptionDesc(int optIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionIndex(optIndex);
 		return GetStr(options[optIndex].desc);
@@ -1683,6 +2031,7 @@ EXPORT(const char*) GetOptionDesc(int optIndex)
 
 EXPORT(int) GetOptionType(int optIndex)
 {
+	UNITSYNC_LOCK;
 	int type = -1;
 
 	try {
@@ -1699,6 +2048,7 @@ EXPORT(int) GetOptionType(int optIndex)
 
 EXPORT(int) GetOptionBoolDef(int optIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionType(optIndex, opt_bool);
 		return options[optIndex].boolDef ? 1 : 0;
@@ -1712,6 +2062,7 @@ EXPORT(int) GetOptionBoolDef(int optIndex)
 
 EXPORT(float) GetOptionNumberDef(int optIndex)
 {
+	UNITSYNC_LOCK;
 	float numDef = -1.0f;
 
 	try {
@@ -1725,6 +2076,7 @@ EXPORT(float) GetOptionNumberDef(int optIndex)
 
 EXPORT(float) GetOptionNumberMin(int optIndex)
 {
+	UNITSYNC_LOCK;
 	float numMin = -1.0e30f; // FIXME error return should be -1.0f, or use FLOAT_MIN ?
 
 	try {
@@ -1738,6 +2090,7 @@ EXPORT(float) GetOptionNumberMin(int optIndex)
 
 EXPORT(float) GetOptionNumberMax(int optIndex)
 {
+	UNITSYNC_LOCK;
 	float numMax = +1.0e30f; // FIXME error return should be -1.0f, or use FLOAT_MAX ?
 
 	try {
@@ -1751,6 +2104,7 @@ EXPORT(float) GetOptionNumberMax(int optIndex)
 
 EXPORT(float) GetOptionNumberStep(int optIndex)
 {
+	UNITSYNC_LOCK;
 	float numStep = -1.0f;
 
 	try {
@@ -1767,6 +2121,7 @@ EXPORT(float) GetOptionNumberStep(int optIndex)
 
 EXPORT(const char*) GetOptionStringDef(int optIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionType(optIndex, opt_string);
 		return GetStr(options[optIndex].stringDef);
@@ -1777,6 +2132,7 @@ EXPORT(const char*) GetOptionStringDef(int optIndex)
 
 EXPORT(int) GetOptionStringMaxLen(int optIndex)
 {
+	UNITSYNC_LOCK;
 	int count = -1;
 
 	try {
@@ -1793,6 +2149,7 @@ EXPORT(int) GetOptionStringMaxLen(int optIndex)
 
 EXPORT(int) GetOptionListCount(int optIndex)
 {
+	UNITSYNC_LOCK;
 	int count = -1;
 
 	try {
@@ -1806,6 +2163,7 @@ EXPORT(int) GetOptionListCount(int optIndex)
 
 EXPORT(const char*) GetOptionListDef(int optIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionType(optIndex, opt_list);
 		return GetStr(options[optIndex].listDef);
@@ -1816,6 +2174,7 @@ EXPORT(const char*) GetOptionListDef(int optIndex)
 
 EXPORT(const char*) GetOptionListItemKey(int optIndex, int itemIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionType(optIndex, opt_list);
 		const std::vector<OptionListItem>& list = options[optIndex].list;
@@ -1828,6 +2187,7 @@ EXPORT(const char*) GetOptionListItemKey(int optIndex, int itemIndex)
 
 EXPORT(const char*) GetOptionListItemName(int optIndex, int itemIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionType(optIndex, opt_list);
 		const std::vector<OptionListItem>& list = options[optIndex].list;
@@ -1840,6 +2200,7 @@ EXPORT(const char*) GetOptionListItemName(int optIndex, int itemIndex)
 
 EXPORT(const char*) GetOptionListItemDesc(int optIndex, int itemIndex)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckOptionType(optIndex, opt_list);
 		const std::vector<OptionListItem>& list = options[optIndex].list;
@@ -1925,6 +2286,7 @@ static int LuaGetMapInfo(lua_State* L)
 
 EXPORT(int) GetModValidMapCount()
 {
+	UNITSYNC_LOCK;
 	int count = -1;
 
 	try {
@@ -1960,6 +2322,7 @@ EXPORT(int) GetModValidMapCount()
 
 EXPORT(const char*) GetModValidMap(int index)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckBounds(index, modValidMaps.size());
@@ -1984,6 +2347,7 @@ static void CheckFileHandle(int file)
 
 EXPORT(int) OpenFileVFS(const char* name)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNullOrEmpty(name);
@@ -2006,6 +2370,7 @@ EXPORT(int) OpenFileVFS(const char* name)
 
 EXPORT(void) CloseFileVFS(int file)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckFileHandle(file);
 
@@ -2018,6 +2383,7 @@ EXPORT(void) CloseFileVFS(int file)
 
 EXPORT(int) ReadFileVFS(int file, unsigned char* buf, int numBytes)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckFileHandle(file);
 		CheckNull(buf);
@@ -2032,6 +2398,7 @@ EXPORT(int) ReadFileVFS(int file, unsigned char* buf, int numBytes)
 
 EXPORT(int) FileSizeVFS(int file)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckFileHandle(file);
 
@@ -2044,6 +2411,7 @@ EXPORT(int) FileSizeVFS(int file)
 
 EXPORT(int) InitFindVFS(const char* pattern)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNullOrEmpty(pattern);
@@ -2060,6 +2428,7 @@ EXPORT(int) InitFindVFS(const char* pattern)
 
 EXPORT(int) InitDirListVFS(const char* path, const char* pattern, const char* modes)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 
@@ -2077,6 +2446,7 @@ EXPORT(int) InitDirListVFS(const char* path, const char* pattern, const char* mo
 
 EXPORT(int) InitSubDirsVFS(const char* path, const char* pattern, const char* modes)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 
@@ -2094,6 +2464,7 @@ EXPORT(int) InitSubDirsVFS(const char* path, const char* pattern, const char* mo
 
 EXPORT(int) FindFilesVFS(int file, char* nameBuf, int size)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNull(nameBuf);
@@ -2127,6 +2498,7 @@ static void CheckArchiveHandle(int archive)
 
 EXPORT(int) OpenArchive(const char* name)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckInit();
 		CheckNullOrEmpty(name);
@@ -2145,6 +2517,7 @@ EXPORT(int) OpenArchive(const char* name)
 
 EXPORT(void) CloseArchive(int archive)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckArchiveHandle(archive);
 
@@ -2156,6 +2529,7 @@ EXPORT(void) CloseArchive(int archive)
 
 EXPORT(int) FindFilesArchive(int archive, int file, char* nameBuf, int* size)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckArchiveHandle(archive);
 		CheckNull(nameBuf);
@@ -2187,6 +2561,7 @@ EXPORT(int) FindFilesArchive(int archive, int file, char* nameBuf, int* size)
 
 EXPORT(int) OpenArchiveFile(int archive, const char* name)
 {
+	UNITSYNC_LOCK;
 	int fileID = -1;
 
 	try {
@@ -2206,6 +2581,7 @@ EXPORT(int) OpenArchiveFile(int archive, const char* name)
 
 EXPORT(int) ReadArchiveFile(int archive, int file, unsigned char* buffer, int numBytes)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckArchiveHandle(archive);
 		CheckNull(buffer);
@@ -2225,6 +2601,7 @@ EXPORT(int) ReadArchiveFile(int archive, int file, unsigned char* buffer, int nu
 
 EXPORT(void) CloseArchiveFile(int archive, int file)
 {
+	UNITSYNC_LOCK;
 	try {
 		// nuting
 	}
@@ -2233,6 +2610,7 @@ EXPORT(void) CloseArchiveFile(int archive, int file)
 
 EXPORT(int) SizeArchiveFile(int archive, int file)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckArchiveHandle(archive);
 
@@ -2250,18 +2628,25 @@ EXPORT(int) SizeArchiveFile(int archive, int file)
 //////////////////////////
 //////////////////////////
 
-char strBuf[STRBUF_SIZE];
+std::recursive_mutex& GetUnitsyncMutex()
+{
+	static std::recursive_mutex unitsyncMutex;
+	return unitsyncMutex;
+}
 
 /// defined in unitsync.h. Just returning str.c_str() does not work
 const char* GetStr(const std::string& str)
 {
+	// per thread, so a result stays valid until the caller's next call
+	static thread_local std::string strBuf;
+
 	if (str.length() + 1 > STRBUF_SIZE) {
-		sprintf(strBuf, "Increase STRBUF_SIZE (needs %u bytes)", (unsigned) str.length() + 1);
+		strBuf = "Increase STRBUF_SIZE (needs " + IntToString(str.length() + 1) + " bytes)";
 	} else {
-		STRCPY(strBuf, str.c_str());
+		strBuf = str;
 	}
 
-	return strBuf;
+	return strBuf.c_str();
 }
 
 
@@ -2270,6 +2655,7 @@ const char* GetStr(const std::string& str)
 
 EXPORT(void) SetSpringConfigFile(const char* fileNameAsAbsolutePath)
 {
+	UNITSYNC_LOCK;
 	dataDirLocater.UpdateIsolationModeByEnvVar();
 	FileSystemInitializer::PreInitializeConfigHandler(fileNameAsAbsolutePath);
 }
@@ -2283,6 +2669,7 @@ static void CheckConfigHandler()
 
 EXPORT(const char*) GetSpringConfigFile()
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckConfigHandler();
 		return GetStr(configHandler->GetConfigFile());
@@ -2294,6 +2681,7 @@ EXPORT(const char*) GetSpringConfigFile()
 
 EXPORT(const char*) GetSpringConfigString(const char* name, const char* defValue)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckConfigHandler();
 		std::string res = configHandler->IsSet(name) ? configHandler->GetString(name) : defValue;
@@ -2305,6 +2693,7 @@ EXPORT(const char*) GetSpringConfigString(const char* name, const char* defValue
 
 EXPORT(int) GetSpringConfigInt(const char* name, const int defValue)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckConfigHandler();
 		return configHandler->IsSet(name) ? configHandler->GetInt(name) : defValue;
@@ -2315,6 +2704,7 @@ EXPORT(int) GetSpringConfigInt(const char* name, const int defValue)
 
 EXPORT(float) GetSpringConfigFloat(const char* name, const float defValue)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckConfigHandler();
 		return configHandler->IsSet(name) ? configHandler->GetFloat(name) : defValue;
@@ -2325,6 +2715,7 @@ EXPORT(float) GetSpringConfigFloat(const char* name, const float defValue)
 
 EXPORT(void) SetSpringConfigString(const char* name, const char* value)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckConfigHandler();
 		configHandler->SetString( name, value );
@@ -2334,6 +2725,7 @@ EXPORT(void) SetSpringConfigString(const char* name, const char* value)
 
 EXPORT(void) SetSpringConfigInt(const char* name, const int value)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckConfigHandler();
 		configHandler->Set(name, value);
@@ -2343,6 +2735,7 @@ EXPORT(void) SetSpringConfigInt(const char* name, const int value)
 
 EXPORT(void) SetSpringConfigFloat(const char* name, const float value)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckConfigHandler();
 		configHandler->Set(name, value);
@@ -2352,6 +2745,7 @@ EXPORT(void) SetSpringConfigFloat(const char* name, const float value)
 
 EXPORT(void) DeleteSpringConfigKey(const char* name)
 {
+	UNITSYNC_LOCK;
 	try {
 		CheckConfigHandler();
 		configHandler->Delete(name);
@@ -2361,6 +2755,7 @@ EXPORT(void) DeleteSpringConfigKey(const char* name)
 
 
 EXPORT(const char*) GetSysInfoHash() {
+	UNITSYNC_LOCK;
 	static std::array<char, 16384> infoHashBuf;
 	const std::string& sysInfoHash = Platform::GetSysInfoHash();
 
@@ -2370,6 +2765,7 @@ EXPORT(const char*) GetSysInfoHash() {
 }
 
 EXPORT(const char*) GetMacAddrHash() {
+	UNITSYNC_LOCK;
 	static std::array<char, 16384> macAddrBuf;
 	const std::string& macAddrHash = Platform::GetMacAddrHash();
 
@@ -3,6 +3,7 @@
 #ifndef _UNITSYNC_H
 #define _UNITSYNC_H
 
+#include <mutex>
 #include <string>
 
 #define STRBUF_SIZE 100000
@@ -29,5 +30,12 @@ enum BitmapType {
 
 const char* GetStr(const std::string& str);
 
+/**
+ * Held by every exported function; they share global state (and the VFS)
+ * so calls from several lobby threads are serialized rather than racing.
+ */
+std::recursive_mutex& GetUnitsyncMutex();
+#define UNITSYNC_LOCK std::lock_guard<std::recursive_mutex> unitsyncLock(GetUnitsyncMutex())
+
 #endif // _UNITSYNC_H
 
@@ -93,6 +93,14 @@ EXPORT(bool        ) IsSpringReleaseVersion();
  *
  * The config handler will not be reset. It will however, be initialised if it
  * was not before (with SetSpringConfigFile()).
+ *
+ * With the config variable UnitsyncIncrementalInit set, a repeated call keeps
+ * the archive scanner state and only rescans archives that changed, or skips
+ * the rescan altogether if nothing in the data-dirs was modified since. Use
+ * UnInit() for data-dir configuration changes to take effect.
+ *
+ * All functions may be called from multiple threads; they are serialized and
+ * returned strings stay valid until the same thread calls unitsync again.
  */
 EXPORT(int         ) Init(bool isServer, int id);
 /**
@@ -359,6 +367,22 @@ EXPORT(int         ) GetInfoMapSize(const char* mapName, const char* name, int*
  * conversion from 16 bpp to 8 bpp is implemented.
  */
 EXPORT(int         ) GetInfoMap(const char* mapName, const char* name, unsigned char* data, int typeHint);
+/**
+ * @brief Extracts the minimaps and metal maps of several maps in parallel
+ * @param mapNames  Array of count map names, e.g. "SmallDivide".
+ * @param count     Number of entries in mapNames.
+ * @param mipLevel  Minimap mip-level to extract, as for GetMinimap.
+ * @return negative integer (< 0) on error;
+ *   the number of maps whose previews are cached (>= 0) on success
+ *
+ * The previews are written to a persistent cache (under the cache directory,
+ * keyed by the checksum of each map archive), from which GetMinimap with the
+ * same mip-level, GetInfoMapSize and GetInfoMap with "metal" then return them
+ * without opening the map archive. Those functions also fill the cache
+ * themselves, this just does it for many maps at once, e.g. when a lobby
+ * shows its map list.
+ */
+EXPORT(int         ) PrefetchMapPreviews(const char** mapNames, int count, int mipLevel);
 
 /**
  * @brief Retrieves the number of Skirmish AIs available